@@ -24,6 +24,10 @@ if(WITH_DOUBLE)
     add_definitions(-DPADDLE_TYPE_DOUBLE)
 endif(WITH_DOUBLE)
 
+if(WITH_NEON)
+    add_definitions(-DPADDLE_WITH_NEON)
+endif(WITH_NEON)
+
 if(WITH_ARM_FP16)
     add_definitions(-DPADDLE_ARM_FP16)
     add_definitions("-march=armv8.2-a+fp16+simd")
@@ -225,6 +229,10 @@ if(WITH_BRPC_RDMA)
     add_definitions(-DPADDLE_WITH_BRPC_RDMA)
 endif(WITH_BRPC_RDMA)
 
+if(WITH_VERBS)
+    add_definitions(-DPADDLE_WITH_VERBS)
+endif(WITH_VERBS)
+
 if(ON_INFER)
     add_definitions(-DPADDLE_ON_INFERENCE)
 endif(ON_INFER)
@@ -0,0 +1,61 @@
+# Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+if(MOBILE_INFERENCE OR RPI)
+    return()
+endif()
+
+include (ExternalProject)
+
+# NOTE: zstd is needed when linking with recordio
+
+set(ZSTD_SOURCES_DIR ${THIRD_PARTY_PATH}/zstd)
+set(ZSTD_INSTALL_DIR ${THIRD_PARTY_PATH}/install/zstd)
+set(ZSTD_INCLUDE_DIR "${ZSTD_INSTALL_DIR}/include" CACHE PATH "zstd include directory." FORCE)
+
+ExternalProject_Add(
+    extern_zstd
+    ${EXTERNAL_PROJECT_LOG_ARGS}
+    GIT_REPOSITORY  "https://github.com/facebook/zstd"
+    GIT_TAG         "v1.3.7"
+    PREFIX          ${ZSTD_SOURCES_DIR}
+    UPDATE_COMMAND  ""
+    CONFIGURE_COMMAND
+                    ${CMAKE_COMMAND} ${ZSTD_SOURCES_DIR}/src/extern_zstd/build/cmake
+                    -DCMAKE_CXX_COMPILER=${CMAKE_CXX_COMPILER}
+                    -DCMAKE_C_COMPILER=${CMAKE_C_COMPILER}
+                    -DCMAKE_C_FLAGS=${CMAKE_C_FLAGS}
+                    -DCMAKE_C_FLAGS_DEBUG=${CMAKE_C_FLAGS_DEBUG}
+                    -DCMAKE_C_FLAGS_RELEASE=${CMAKE_C_FLAGS_RELEASE}
+                    -DCMAKE_INSTALL_PREFIX=${ZSTD_INSTALL_DIR}
+                    -DCMAKE_INSTALL_LIBDIR=${ZSTD_INSTALL_DIR}/lib
+                    -DCMAKE_POSITION_INDEPENDENT_CODE=ON
+                    -DZSTD_BUILD_PROGRAMS=OFF
+                    -DZSTD_BUILD_SHARED=OFF
+                    -DZSTD_BUILD_STATIC=ON
+                    -DCMAKE_BUILD_TYPE=${THIRD_PARTY_BUILD_TYPE}
+                    ${EXTERNAL_OPTIONAL_ARGS}
+    TEST_COMMAND    ""
+)
+IF(WIN32)
+    set(ZSTD_LIBRARIES "${ZSTD_INSTALL_DIR}/lib/zstd_static.lib")
+else(WIN32)
+    set(ZSTD_LIBRARIES "${ZSTD_INSTALL_DIR}/lib/libzstd.a")
+endif (WIN32)
+
+add_library(zstd STATIC IMPORTED GLOBAL)
+set_property(TARGET zstd PROPERTY IMPORTED_LOCATION ${ZSTD_LIBRARIES})
+
+include_directories(${ZSTD_INCLUDE_DIR})
+add_dependencies(zstd extern_zstd)
@@ -162,6 +162,18 @@ if (NOT MOBILE_INFERENCE AND NOT RPI)
             DSTS ${dst_dir} ${dst_dir}/lib
             DEPS snappystream)
 
+    set(dst_dir "${FLUID_INSTALL_DIR}/third_party/install/zstd")
+    copy(zstd_lib
+            SRCS ${ZSTD_INCLUDE_DIR} ${ZSTD_LIBRARIES}
+            DSTS ${dst_dir} ${dst_dir}/lib
+            DEPS zstd)
+
+    set(dst_dir "${FLUID_INSTALL_DIR}/third_party/install/lz4")
+    copy(lz4_lib
+            SRCS ${LZ4_INCLUDE_DIR} ${LZ4_LIBRARIES}
+            DSTS ${dst_dir} ${dst_dir}/lib
+            DEPS lz4)
+
     set(dst_dir "${FLUID_INSTALL_DIR}/third_party/install/zlib")
     copy(zlib_lib
             SRCS ${ZLIB_INCLUDE_DIR} ${ZLIB_LIBRARIES}
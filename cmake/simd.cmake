@@ -95,5 +95,17 @@ int main()
     return 0;
 }" AVX512F_FOUND)
 
+# Check the NEON of aarch64, which needs no flag. It is compiled only, so
+# that it also works for the cross compiling.
+set(CMAKE_REQUIRED_FLAGS "")
+CHECK_CXX_SOURCE_COMPILES("
+#include <arm_neon.h>
+int main()
+{
+    float32x4_t a = vdupq_n_f32(1.0f);
+    float32x4_t b = vfmaq_laneq_f32(a, a, a, 1);
+    return static_cast<int>(vaddvq_f32(vdivq_f32(b, a)));
+}" NEON_FOUND)
+
 set(CMAKE_REQUIRED_FLAGS ${CMAKE_REQUIRED_FLAGS_RETAINED})
-mark_as_advanced(MMX_FOUND SSE2_FOUND SSE3_FOUND AVX_FOUND AVX2_FOUND AVX512F_FOUND)
+mark_as_advanced(MMX_FOUND SSE2_FOUND SSE3_FOUND AVX_FOUND AVX2_FOUND AVX512F_FOUND NEON_FOUND)
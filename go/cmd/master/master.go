@@ -39,6 +39,7 @@ func main() {
 	taskTimeoutDur := flag.Duration("task-timout-dur", 20*time.Minute, "task timout duration.")
 	taskTimeoutMax := flag.Int("task-timeout-max", 3, "max timtout count for each task before it being declared failed task.")
 	chunkPerTask := flag.Int("chunk-per-task", 10, "chunk per task.")
+	bytesPerTask := flag.Int64("bytes-per-task", 0, "bytes per task, the tasks are partitioned by the sizes of the chunks instead of chunk-per-task if it is positive.")
 	logLevel := flag.String("log-level", "info",
 		"log level, possible values: debug, info, warn, error, crit")
 	flag.Parse()
@@ -89,7 +90,7 @@ func main() {
 	c := make(chan os.Signal, 1)
 	signal.Notify(c, os.Interrupt)
 
-	s, err := master.NewService(store, *chunkPerTask, *taskTimeoutDur, *taskTimeoutMax)
+	s, err := master.NewService(store, *chunkPerTask, *bytesPerTask, *taskTimeoutDur, *taskTimeoutMax)
 	if err != nil {
 		log.Crit("error creating new service.", log.Ctx{"error": err})
 		panic(err)
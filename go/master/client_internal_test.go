@@ -48,7 +48,7 @@ func TestGetFinishTask(t *testing.T) {
 		panic(err)
 	}
 	go func(l net.Listener) {
-		s, sErr := NewService(&InMemStore{}, chunkPerTask, time.Second, 1)
+		s, sErr := NewService(&InMemStore{}, chunkPerTask, 0, time.Second, 1)
 		if sErr != nil {
 			panic(sErr)
 		}
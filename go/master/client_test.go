@@ -59,7 +59,7 @@ func TestNextRecord(t *testing.T) {
 		panic(err)
 	}
 	go func(l net.Listener) {
-		s, err := master.NewService(&master.InMemStore{}, 1, time.Second*60, 1)
+		s, err := master.NewService(&master.InMemStore{}, 1, 0, time.Second*60, 1)
 		if err != nil {
 			panic(err)
 		}
@@ -57,6 +57,9 @@ type Store interface {
 type Chunk struct {
 	Path  string
 	Index recordio.Index // chunk index
+	// Size is the estimated number of bytes of the chunk, the size of
+	// the file shared by the records of its chunks.
+	Size int64
 }
 
 // TaskMeta is a struct which stores task's meta info.
@@ -88,6 +91,7 @@ type masterState struct {
 // Service is the master server service.
 type Service struct {
 	chunksPerTask int
+	bytesPerTask  int64
 	timeoutDur    time.Duration
 	failureMax    int
 	store         Store
@@ -136,10 +140,51 @@ func partition(chunks []Chunk, chunksPerTask int) []taskEntry {
 	return result
 }
 
-// NewService creates a new service.
-func NewService(store Store, chunksPerTask int, timeoutDur time.Duration, failureMax int) (*Service, error) {
+// partitionBySize partitions the chunks into the tasks of about
+// bytesPerTask bytes, so that the tasks of the files of different
+// chunk sizes take about the same time to train. A task does not
+// span two files once it is half full, so that a trainer mostly reads
+// one file sequentially for a task.
+func partitionBySize(chunks []Chunk, bytesPerTask int64) []taskEntry {
+	randStart := rand.Int()
+	counter := 0
+	timestamp := time.Now().Nanosecond()
+	id := timestamp + randStart + counter
+
+	var result []taskEntry
+	var cur taskEntry
+	var curBytes int64
+	for _, c := range chunks {
+		n := len(cur.Task.Chunks)
+		if n > 0 && (curBytes+c.Size > bytesPerTask ||
+			(c.Path != cur.Task.Chunks[n-1].Path && 2*curBytes >= bytesPerTask)) {
+			cur.Task.Meta.ID = id
+			counter++
+			id = timestamp + randStart + counter
+			result = append(result, cur)
+			cur.Task.Chunks = nil
+			curBytes = 0
+		}
+
+		cur.Task.Chunks = append(cur.Task.Chunks, c)
+		curBytes += c.Size
+	}
+
+	if len(cur.Task.Chunks) > 0 {
+		cur.Task.Meta.ID = id
+		result = append(result, cur)
+	}
+
+	return result
+}
+
+// NewService creates a new service. The chunks are partitioned into
+// the tasks of bytesPerTask bytes if it is positive, or else of
+// chunksPerTask chunks.
+func NewService(store Store, chunksPerTask int, bytesPerTask int64, timeoutDur time.Duration, failureMax int) (*Service, error) {
 	s := &Service{}
 	s.chunksPerTask = chunksPerTask
+	s.bytesPerTask = bytesPerTask
 	s.timeoutDur = timeoutDur
 	s.failureMax = failureMax
 	s.state = masterState{}
@@ -254,6 +299,10 @@ func readChunks(globPaths []string) ([]Chunk, error) {
 		if err != nil {
 			return nil, err
 		}
+		info, err := f.Stat()
+		if err != nil {
+			return nil, err
+		}
 		err = f.Close()
 		if err != nil {
 			return nil, err
@@ -261,10 +310,16 @@ func readChunks(globPaths []string) ([]Chunk, error) {
 
 		count := index.NumChunks()
 		log.Info("reading chunks.", log.Ctx{"path": path, "num chunks": count})
+		numRecords := int64(index.NumRecords())
+		if numRecords == 0 {
+			numRecords = 1
+		}
 		for i := 0; i < count; i++ {
+			chunkIndex := index.ChunkIndex(i)
 			chunk := Chunk{
 				Path:  path,
-				Index: *index.ChunkIndex(i),
+				Index: *chunkIndex,
+				Size:  info.Size() * int64(chunkIndex.NumRecords()) / numRecords,
 			}
 			chunks = append(chunks, chunk)
 		}
@@ -296,7 +351,11 @@ func (s *Service) SetDataset(globPaths []string, _ *int) error {
 		return err
 	}
 
-	s.state.Todo = partition(chunks, s.chunksPerTask)
+	if s.bytesPerTask > 0 {
+		s.state.Todo = partitionBySize(chunks, s.bytesPerTask)
+	} else {
+		s.state.Todo = partition(chunks, s.chunksPerTask)
+	}
 
 	err = s.snapshot()
 	if err != nil {
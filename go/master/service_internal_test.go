@@ -50,3 +50,51 @@ func TestPartionIndex(t *testing.T) {
 		}
 	}
 }
+
+func TestPartitionBySize(t *testing.T) {
+	cs := make([]Chunk, 10)
+	for i := range cs {
+		cs[i].Path = "a"
+		cs[i].Size = int64(i + 1)
+	}
+	// 1+2+3+4, 5+6, 7, 8, 9, 10
+	ts := partitionBySize(cs, 11)
+	if len(ts) != 6 {
+		t.Error(len(ts))
+	}
+	for _, task := range ts {
+		var size int64
+		for _, c := range task.Task.Chunks {
+			size += c.Size
+		}
+		if size > 11 {
+			t.Error(size)
+		}
+	}
+
+	// A chunk bigger than bytesPerTask is a task itself.
+	ts = partitionBySize(cs, 1)
+	if len(ts) != 10 {
+		t.Error(len(ts))
+	}
+}
+
+func TestPartitionBySizeLocality(t *testing.T) {
+	cs := []Chunk{
+		{Path: "a", Size: 6}, {Path: "b", Size: 2}, {Path: "b", Size: 2},
+		{Path: "c", Size: 1}, {Path: "d", Size: 1},
+	}
+	// The task of a is half full when b starts, the task of b is not
+	// when c starts but is when d starts.
+	ts := partitionBySize(cs, 10)
+	if len(ts) != 3 {
+		t.Fatal(len(ts))
+	}
+	if len(ts[0].Task.Chunks) != 1 || len(ts[1].Task.Chunks) != 3 ||
+		len(ts[2].Task.Chunks) != 1 {
+		t.Error(ts)
+	}
+	if ts[1].Task.Meta.ID != ts[0].Task.Meta.ID+1 {
+		t.Error(ts)
+	}
+}
@@ -49,7 +49,7 @@ func TestNewServiceWithEtcd(t *testing.T) {
 		t.Fatal(err)
 	}
 
-	_, err = master.NewService(store, 10, 10, 3)
+	_, err = master.NewService(store, 10, 0, 10, 3)
 	if err != nil {
 		t.Fatal(err)
 	}
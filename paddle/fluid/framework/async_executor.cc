@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/framework/async_executor.h"
+#include <algorithm>
 #include "google/protobuf/io/zero_copy_stream_impl.h"
 #include "google/protobuf/message.h"
 #include "google/protobuf/text_format.h"
@@ -233,14 +234,9 @@ void AsyncExecutor::PrepareDenseThread(const std::string& mode) {
 }
 #endif
 
-void AsyncExecutor::RunFromFile(const ProgramDesc& main_program,
-                                const std::string& data_feed_desc_str,
-                                const std::vector<std::string>& filelist,
-                                const int thread_num,
-                                const std::vector<std::string>& fetch_var_names,
-                                const std::string& mode, const bool debug) {
-  std::vector<std::thread> threads;
-
+void AsyncExecutor::CheckFetchVars(
+    const ProgramDesc& main_program,
+    const std::vector<std::string>& fetch_var_names) {
   auto& block = main_program.Block(0);
   for (auto var_name : fetch_var_names) {
     auto var_desc = block.FindVar(var_name);
@@ -250,6 +246,15 @@ void AsyncExecutor::RunFromFile(const ProgramDesc& main_program,
                    "only variables with the last dimension size 1 supported",
                    var_name);
   }
+}
+
+void AsyncExecutor::RunFromFile(const ProgramDesc& main_program,
+                                const std::string& data_feed_desc_str,
+                                const std::vector<std::string>& filelist,
+                                const int thread_num,
+                                const std::vector<std::string>& fetch_var_names,
+                                const std::string& mode, const bool debug) {
+  CheckFetchVars(main_program, fetch_var_names);
 
   DataFeedDesc data_feed_desc;
   google::protobuf::TextFormat::ParseFromString(data_feed_desc_str,
@@ -279,6 +284,58 @@ void AsyncExecutor::RunFromFile(const ProgramDesc& main_program,
   // todo: should be factory method for creating datafeed
   std::vector<std::shared_ptr<DataFeed>> readers;
   PrepareReaders(readers, actual_thread_num, data_feed_desc, filelist);
+  RunWithReaders(main_program, readers, fetch_var_names, mode, debug);
+}
+
+void AsyncExecutor::LoadIntoMemory(const std::string& data_feed_desc_str,
+                                   const std::vector<std::string>& filelist,
+                                   const int thread_num, const int trainer_id,
+                                   const int trainer_num) {
+  DataFeedDesc data_feed_desc;
+  google::protobuf::TextFormat::ParseFromString(data_feed_desc_str,
+                                                &data_feed_desc);
+  PADDLE_ENFORCE(filelist.size() > 0, "File list cannot be empty");
+  int load_thread_num =
+      std::min(thread_num, static_cast<int>(filelist.size()));
+  memory_data_.reset(new MultiSlotInMemoryData);
+  memory_data_->Load(data_feed_desc, filelist, load_thread_num, trainer_id,
+                     trainer_num);
+}
+
+void AsyncExecutor::LocalShuffle(const unsigned int seed) {
+  PADDLE_ENFORCE_NOT_NULL(memory_data_, "No data has been loaded to memory");
+  memory_data_->LocalShuffle(seed);
+}
+
+void AsyncExecutor::GlobalShuffle(const unsigned int seed) {
+  PADDLE_ENFORCE_NOT_NULL(memory_data_, "No data has been loaded to memory");
+  memory_data_->GlobalShuffle(seed);
+}
+
+void AsyncExecutor::ReleaseMemory() { memory_data_.reset(); }
+
+void AsyncExecutor::RunFromMemory(
+    const ProgramDesc& main_program, const std::string& data_feed_desc_str,
+    const int thread_num, const std::vector<std::string>& fetch_var_names,
+    const std::string& mode, const bool debug) {
+  PADDLE_ENFORCE_NOT_NULL(memory_data_, "No data has been loaded to memory");
+  CheckFetchVars(main_program, fetch_var_names);
+
+  DataFeedDesc data_feed_desc;
+  google::protobuf::TextFormat::ParseFromString(data_feed_desc_str,
+                                                &data_feed_desc);
+  actual_thread_num = thread_num;
+  RunWithReaders(main_program,
+                 memory_data_->CreateReaders(data_feed_desc, thread_num),
+                 fetch_var_names, mode, debug);
+}
+
+void AsyncExecutor::RunWithReaders(
+    const ProgramDesc& main_program,
+    const std::vector<std::shared_ptr<DataFeed>>& readers,
+    const std::vector<std::string>& fetch_var_names, const std::string& mode,
+    const bool debug) {
+  std::vector<std::thread> threads;
 #ifdef PADDLE_WITH_PSLIB
   PrepareDenseThread(mode);
 #endif
@@ -302,6 +359,10 @@ void AsyncExecutor::RunFromFile(const ProgramDesc& main_program,
                   fetch_var_names, root_scope_, thidx, debug);
   }
 
+  // The parameters are initialized by the startup program, the threads look
+  // them up without locking.
+  root_scope_->Seal();
+
   // start executing ops in multiple threads
   for (int thidx = 0; thidx < actual_thread_num; ++thidx) {
     if (debug) {
@@ -67,6 +67,23 @@ class AsyncExecutor {
                    const int thread_num,
                    const std::vector<std::string>& fetch_names,
                    const std::string& mode, const bool debug = false);
+  // Load the instances of filelist into memory, so that the passes run by
+  // RunFromMemory need not read the files again. With trainer_num trainers,
+  // every trainer loads all the files and keeps the instances hashed to it.
+  void LoadIntoMemory(const std::string& data_feed_desc_str,
+                      const std::vector<std::string>& filelist,
+                      const int thread_num, const int trainer_id = 0,
+                      const int trainer_num = 1);
+  // Shuffle the instances loaded by each thread among themselves.
+  void LocalShuffle(const unsigned int seed);
+  // Shuffle all the instances loaded into memory.
+  void GlobalShuffle(const unsigned int seed);
+  void ReleaseMemory();
+  void RunFromMemory(const ProgramDesc& main_program,
+                     const std::string& data_feed_desc_str,
+                     const int thread_num,
+                     const std::vector<std::string>& fetch_names,
+                     const std::string& mode, const bool debug = false);
 #ifdef PADDLE_WITH_PSLIB
   void InitServer(const std::string& dist_desc, int index);
   void InitWorker(const std::string& dist_desc,
@@ -87,6 +104,12 @@ class AsyncExecutor {
                      const std::vector<std::string>& fetch_var_names,
                      Scope* root_scope, const int thread_index,
                      const bool debug);
+  void CheckFetchVars(const ProgramDesc& main_program,
+                      const std::vector<std::string>& fetch_var_names);
+  void RunWithReaders(const ProgramDesc& main_program,
+                      const std::vector<std::shared_ptr<DataFeed>>& readers,
+                      const std::vector<std::string>& fetch_var_names,
+                      const std::string& mode, const bool debug);
 #ifdef PADDLE_WITH_PSLIB
   void PrepareDenseThread(const std::string& mode);
 #endif
@@ -102,6 +125,7 @@ class AsyncExecutor {
 
  private:
   int actual_thread_num;
+  std::unique_ptr<MultiSlotInMemoryData> memory_data_;
 };
 
 }  // namespace framework
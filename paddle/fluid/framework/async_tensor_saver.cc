@@ -0,0 +1,170 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/async_tensor_saver.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include "paddle/fluid/framework/indexed_params.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/platform/enforce.h"
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/fluid/platform/cuda_device_guard.h"
+#endif
+
+DEFINE_int32(async_save_max_inflight, 2,
+             "the max number of the snapshots of the asynchronous saves kept "
+             "in the host memory until they are written");
+
+namespace paddle {
+namespace framework {
+
+AsyncTensorSaver& AsyncTensorSaver::Instance() {
+  static AsyncTensorSaver saver;
+  return saver;
+}
+
+void AsyncTensorSaver::Save(const std::string& filename,
+                            const std::vector<std::string>& names,
+                            const std::vector<const LoDTensor*>& tensors,
+                            const platform::DeviceContext& dev_ctx,
+                            bool indexed_format, Callback callback) {
+  PADDLE_ENFORCE_EQ(names.size(), tensors.size());
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    size_t max_in_flight =
+        static_cast<size_t>(std::max(FLAGS_async_save_max_inflight, 1));
+    finished_.wait(lock, [&] { return in_flight_ < max_in_flight; });
+    ++in_flight_;
+  }
+
+  auto snapshot = std::make_shared<std::vector<LoDTensor>>(tensors.size());
+#ifdef PADDLE_WITH_CUDA
+  cudaEvent_t copied = nullptr;
+  int device = -1;
+#endif
+  try {
+    for (size_t i = 0; i < tensors.size(); ++i) {
+      auto& src = *tensors[i];
+      auto& dst = (*snapshot)[i];
+      dst.set_lod(src.lod());
+      if (platform::is_gpu_place(src.place())) {
+#ifdef PADDLE_WITH_CUDA
+        auto gpu_place = boost::get<platform::CUDAPlace>(src.place());
+        platform::CUDAPinnedPlace pinned;
+        dst.Resize(src.dims());
+        void* dst_ptr = dst.mutable_data(pinned, src.type());
+        memory::Copy(pinned, dst_ptr, gpu_place, src.data<void>(),
+                     src.numel() * SizeOfType(src.type()),
+                     static_cast<const platform::CUDADeviceContext&>(dev_ctx)
+                         .stream());
+        device = gpu_place.device;
+#else
+        PADDLE_THROW("Unexpected branch");
+#endif
+      } else {
+        TensorCopySync(src, platform::CPUPlace(), &dst);
+      }
+    }
+#ifdef PADDLE_WITH_CUDA
+    if (device >= 0) {
+      // The IO thread waits for the copies instead of the training.
+      platform::CUDADeviceGuard guard(device);
+      auto stream =
+          static_cast<const platform::CUDADeviceContext&>(dev_ctx).stream();
+      PADDLE_ENFORCE(
+          cudaEventCreateWithFlags(&copied, cudaEventDisableTiming));
+      PADDLE_ENFORCE(cudaEventRecord(copied, stream));
+    }
+#endif
+  } catch (...) {
+    Finish("");
+    throw;
+  }
+
+  VLOG(3) << "save " << tensors.size() << " tensors to " << filename
+          << " asynchronously";
+  ThreadPoolIO::GetInstanceIO()->Run([=] {
+    std::string error;
+    try {
+#ifdef PADDLE_WITH_CUDA
+      if (copied != nullptr) {
+        PADDLE_ENFORCE(cudaEventSynchronize(copied));
+        PADDLE_ENFORCE(cudaEventDestroy(copied));
+      }
+#endif
+      // The file appears at filename only after it is complete.
+      std::string tmp_filename = filename + ".tmp";
+      if (indexed_format) {
+        std::vector<const LoDTensor*> saved;
+        for (auto& tensor : *snapshot) {
+          saved.push_back(&tensor);
+        }
+        SaveIndexedParams(tmp_filename, names, saved);
+      } else {
+        std::ofstream fout(tmp_filename, std::ios::binary);
+        PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot open %s to write",
+                       tmp_filename);
+        platform::CPUDeviceContext cpu_ctx;
+        for (auto& tensor : *snapshot) {
+          SerializeToStream(fout, tensor, cpu_ctx);
+        }
+        fout.close();
+        PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot write %s",
+                       tmp_filename);
+      }
+      PADDLE_ENFORCE_EQ(std::rename(tmp_filename.c_str(), filename.c_str()),
+                        0, "Cannot rename %s to %s", tmp_filename, filename);
+    } catch (platform::EnforceNotMet& e) {
+      error = e.what();
+      LOG(ERROR) << "the asynchronous save to " << filename
+                 << " failed: " << error;
+    }
+    if (callback) {
+      callback(filename, error);
+    }
+    Finish(error);
+  });
+}
+
+void AsyncTensorSaver::Finish(const std::string& error) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  --in_flight_;
+  if (error_.empty()) {
+    error_ = error;
+  }
+  finished_.notify_all();
+}
+
+void AsyncTensorSaver::Wait() {
+  std::string error;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    finished_.wait(lock, [this] { return in_flight_ == 0; });
+    error.swap(error_);
+  }
+  PADDLE_ENFORCE(error.empty(), "The asynchronous save failed: %s", error);
+}
+
+size_t AsyncTensorSaver::InFlight() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return in_flight_;
+}
+
+}  // namespace framework
+}  // namespace paddle
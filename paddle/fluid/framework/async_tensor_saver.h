@@ -0,0 +1,74 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/macros.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * Save the tensors to a file without blocking the training.
+ *
+ * Save takes a snapshot of the tensors at the current point of the stream of
+ * the device context, by copying the GPU tensors to the pinned memory
+ * asynchronously on the stream, so the later ops on the stream cannot change
+ * the snapshot. The snapshot is then serialized and written on the IO thread
+ * pool, in the format of the save_combine op, or the indexed format, while
+ * the training goes on. At most FLAGS_async_save_max_inflight snapshots are
+ * kept in the host memory, Save waits for the oldest one to be written
+ * before taking another.
+ */
+class AsyncTensorSaver {
+ public:
+  // Called on the IO thread after the file is written, with the error
+  // message, which is empty if it succeeded.
+  using Callback = std::function<void(const std::string& filename,
+                                      const std::string& error)>;
+
+  static AsyncTensorSaver& Instance();
+
+  void Save(const std::string& filename, const std::vector<std::string>& names,
+            const std::vector<const LoDTensor*>& tensors,
+            const platform::DeviceContext& dev_ctx, bool indexed_format,
+            Callback callback = nullptr);
+
+  // Wait for all the files to be written, and throw the first error since
+  // the last Wait.
+  void Wait();
+
+  size_t InFlight();
+
+ private:
+  AsyncTensorSaver() = default;
+  DISABLE_COPY_AND_ASSIGN(AsyncTensorSaver);
+
+  void Finish(const std::string& error);
+
+  std::mutex mutex_;
+  std::condition_variable finished_;
+  size_t in_flight_{0};
+  std::string error_;
+};
+
+}  // namespace framework
+}  // namespace paddle
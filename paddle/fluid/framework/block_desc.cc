@@ -14,12 +14,16 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/block_desc.h"
 #include <queue>
+#include "paddle/fluid/framework/compute_pool.h"
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/framework/program_desc.h"
 
 namespace paddle {
 namespace framework {
 
+// The ops restored or copied by a thread of the pool at least.
+static constexpr int64_t kOpsGrainSize = 256;
+
 VarDesc *BlockDesc::Var(const std::string &name) {
   auto it = vars_.find(name);
   if (it != vars_.end()) {
@@ -195,8 +199,15 @@ BlockDesc::BlockDesc(ProgramDesc *prog, proto::BlockDesc *desc)
   for (const proto::VarDesc &var_desc : desc_->vars()) {
     vars_[var_desc.name()].reset(new VarDesc(var_desc));
   }
-  for (const proto::OpDesc &op_desc : desc_->ops()) {
-    ops_.emplace_back(new OpDesc(op_desc, this));
+  // The ops of a big block are restored in parallel.
+  std::vector<std::unique_ptr<OpDesc>> ops(desc_->ops_size());
+  ParallelFor(0, ops.size(), kOpsGrainSize, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      ops[i].reset(new OpDesc(desc_->ops(i), this));
+    }
+  });
+  for (auto &op : ops) {
+    ops_.emplace_back(std::move(op));
   }
 }
 
@@ -204,8 +215,14 @@ BlockDesc::BlockDesc(const BlockDesc &other, proto::BlockDesc *desc,
                      ProgramDesc *prog)
     : prog_(prog), desc_(desc) {
   need_update_ = true;
-  for (auto &op : other.ops_) {
-    ops_.emplace_back(new OpDesc(*op, this));
+  std::vector<std::unique_ptr<OpDesc>> ops(other.ops_.size());
+  ParallelFor(0, ops.size(), kOpsGrainSize, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      ops[i].reset(new OpDesc(*other.ops_[i], this));
+    }
+  });
+  for (auto &op : ops) {
+    ops_.emplace_back(std::move(op));
   }
   for (auto &it : other.vars_) {
     auto *var = new VarDesc(*it.second);
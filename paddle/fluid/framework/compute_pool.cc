@@ -0,0 +1,220 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/compute_pool.h"
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include "gflags/gflags.h"
+#include "paddle/fluid/platform/enforce.h"
+
+DEFINE_int32(compute_pool_threads, 0,
+             "The number of the threads of the compute pool shared by the "
+             "predictors of the process, 0 for the number of the cpus.");
+DEFINE_int32(intra_op_threads, 0,
+             "The threads an intra-op parallel loop of a thread not sharing "
+             "the compute pool runs on, the calling one included, 0 for the "
+             "threads of the pool and 1 for no intra-op parallelism.");
+
+namespace paddle {
+namespace framework {
+
+static thread_local ComputeQuota* tls_quota = nullptr;
+static thread_local bool tls_in_pool = false;
+// The priority overriding the ones of the quotas, -1 for none.
+static thread_local int tls_priority = -1;
+
+int ComputeQuota::Acquire(int n) {
+  int busy = num_busy_.load();
+  int taken = 0;
+  do {
+    taken = std::min(n, max_threads_ - busy);
+    if (taken <= 0) return 0;
+  } while (!num_busy_.compare_exchange_weak(busy, busy + taken));
+  return taken;
+}
+
+namespace {
+
+// The chunks of a loop are taken in turn by the calling thread and the
+// helpers. A helper started after all the chunks are taken returns at once,
+// and it touches neither fn nor the quota, which may be gone by then.
+struct ParallelJob {
+  ParallelJob(int64_t n, int64_t chunk, const ComputePool::RangeFn* fn)
+      : n(n), chunk(chunk), num_chunks((n + chunk - 1) / chunk), fn(fn) {}
+
+  void Work() {
+    while (true) {
+      int64_t i = next.fetch_add(1);
+      if (i >= num_chunks) return;
+      int64_t begin = i * chunk;
+      try {
+        (*fn)(begin, std::min(n, begin + chunk));
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error) error = std::current_exception();
+      }
+      if (++done == num_chunks) {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished.notify_all();
+      }
+    }
+  }
+
+  const int64_t n;
+  const int64_t chunk;
+  const int64_t num_chunks;
+  const ComputePool::RangeFn* fn;
+  std::atomic<int64_t> next{0};
+  std::atomic<int64_t> done{0};
+  std::mutex mutex;
+  std::condition_variable finished;
+  std::exception_ptr error;
+};
+
+}  // namespace
+
+ComputePool* ComputePool::Instance() {
+  static ComputePool pool(
+      FLAGS_compute_pool_threads > 0
+          ? FLAGS_compute_pool_threads
+          : std::max(std::thread::hardware_concurrency(), 1U));
+  return &pool;
+}
+
+ComputePool::ComputePool(size_t num_threads) {
+  PADDLE_ENFORCE_GT(num_threads, 0UL);
+  threads_.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads_.emplace_back([this] { TaskLoop(); });
+  }
+}
+
+ComputePool::~ComputePool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  scheduled_.notify_all();
+  for (auto& t : threads_) {
+    t.join();
+  }
+}
+
+void ComputePool::ParallelFor(ComputeQuota* quota, int64_t n, int64_t grain,
+                              const RangeFn& fn) {
+  PADDLE_ENFORCE_NOT_NULL(quota);
+  grain = std::max<int64_t>(grain, 1);
+  int64_t max_chunks = (n + grain - 1) / grain;
+  int num_helpers = quota->Acquire(static_cast<int>(
+      std::min<int64_t>(max_chunks - 1, static_cast<int64_t>(NumThreads()))));
+  if (num_helpers == 0) {
+    fn(0, n);
+    return;
+  }
+
+  // Some more chunks than the threads balance the load when a helper starts
+  // late.
+  int64_t num_chunks = std::min<int64_t>(max_chunks, 4 * (num_helpers + 1));
+  auto job = std::make_shared<ParallelJob>(
+      n, (n + num_chunks - 1) / num_chunks, &fn);
+  auto priority = tls_priority >= 0
+                      ? static_cast<ComputePriority>(tls_priority)
+                      : quota->priority();
+  Push(priority, num_helpers, [job] { job->Work(); });
+  job->Work();
+  {
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->finished.wait(lock, [&job] { return job->done == job->num_chunks; });
+  }
+  quota->Release(num_helpers);
+  if (job->error) {
+    std::rethrow_exception(job->error);
+  }
+}
+
+void ComputePool::Push(ComputePriority priority, int num_copies,
+                       const Task& task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    PADDLE_ENFORCE(running_, "Push to a stopped ComputePool");
+    auto& queue = tasks_[static_cast<int>(priority)];
+    for (int i = 0; i < num_copies; ++i) {
+      queue.push_back(task);
+    }
+  }
+  if (num_copies == 1) {
+    scheduled_.notify_one();
+  } else {
+    scheduled_.notify_all();
+  }
+}
+
+void ComputePool::TaskLoop() {
+  tls_in_pool = true;
+  while (true) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      std::deque<Task>* queue = nullptr;
+      scheduled_.wait(lock, [this, &queue] {
+        for (auto& q : tasks_) {
+          if (!q.empty()) {
+            queue = &q;
+            return true;
+          }
+        }
+        return !running_;
+      });
+      if (queue == nullptr) return;
+      task = std::move(queue->front());
+      queue->pop_front();
+    }
+    task();
+  }
+}
+
+ComputeQuota* CurrentComputeQuota() { return tls_quota; }
+
+ComputeQuota* IntraOpQuota() {
+  if (tls_quota != nullptr || tls_in_pool) return tls_quota;
+  // The calling thread is one of the threads of its loops.
+  static ComputeQuota* quota = [] {
+    int num_threads =
+        FLAGS_intra_op_threads > 0
+            ? FLAGS_intra_op_threads
+            : static_cast<int>(ComputePool::Instance()->NumThreads());
+    return num_threads > 1
+               ? new ComputeQuota(num_threads - 1, ComputePriority::kNormal)
+               : nullptr;
+  }();
+  return quota;
+}
+
+ScopedComputeQuota::ScopedComputeQuota(ComputeQuota* quota)
+    : prev_(tls_quota) {
+  tls_quota = quota;
+}
+
+ScopedComputeQuota::~ScopedComputeQuota() { tls_quota = prev_; }
+
+ScopedComputePriority::ScopedComputePriority(ComputePriority priority)
+    : prev_(tls_priority) {
+  tls_priority = static_cast<int>(priority);
+}
+
+ScopedComputePriority::~ScopedComputePriority() { tls_priority = prev_; }
+
+}  // namespace framework
+}  // namespace paddle
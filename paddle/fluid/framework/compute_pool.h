@@ -0,0 +1,198 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+#include "paddle/fluid/platform/macros.h"  // for DISABLE_COPY_AND_ASSIGN
+
+namespace paddle {
+namespace framework {
+
+// The classes of the requests sharing the ComputePool, the queued work of a
+// higher class is always taken first.
+enum class ComputePriority { kHigh = 0, kNormal = 1, kLow = 2 };
+
+// ComputeQuota is the share of the ComputePool of a tenant, e.g. a predictor
+// and its clones: the threads of the pool working for the tenant at the same
+// time are at most max_threads, whatever the number of its requests.
+class ComputeQuota {
+ public:
+  ComputeQuota(int max_threads, ComputePriority priority)
+      : max_threads_(max_threads), priority_(priority) {}
+
+  int max_threads() const { return max_threads_; }
+  ComputePriority priority() const { return priority_; }
+
+  // The threads of the pool taken by the tenant now.
+  int num_busy() const { return num_busy_; }
+
+ private:
+  friend class ComputePool;
+
+  // Takes at most n threads out of the quota, returns the number taken.
+  int Acquire(int n);
+  void Release(int n) { num_busy_ -= n; }
+
+  const int max_threads_;
+  const ComputePriority priority_;
+  std::atomic<int> num_busy_{0};
+};
+
+// ComputePool is the process-wide pool of the threads running the parallel
+// loops of the CPU kernels, so that the predictors hosted by one process
+// share FLAGS_compute_pool_threads threads instead of each one starting the
+// OpenMP threads of its own.
+//
+// The parallelism is cooperative: the calling thread runs the chunks of its
+// loop too, and the threads of the pool only help it with the chunks left.
+// A loop never waits for a thread of the pool to start, so it completes
+// when the pool is busy with the other tenants or a higher priority, and the
+// nested loops run serially on the threads of the pool.
+class ComputePool {
+ public:
+  using RangeFn = std::function<void(int64_t begin, int64_t end)>;
+
+  // Returns the pool shared by the process.
+  static ComputePool* Instance();
+
+  explicit ComputePool(size_t num_threads);
+
+  // Waits until all the queued work is finished.
+  ~ComputePool();
+
+  size_t NumThreads() const { return threads_.size(); }
+
+  // Runs fn on the chunks of [0, n), each of at least grain elements but the
+  // last, and returns when all of them are done. The exception thrown by a
+  // chunk is rethrown after that.
+  void ParallelFor(ComputeQuota* quota, int64_t n, int64_t grain,
+                   const RangeFn& fn);
+
+ private:
+  DISABLE_COPY_AND_ASSIGN(ComputePool);
+
+  using Task = std::function<void()>;
+
+  void Push(ComputePriority priority, int num_copies, const Task& task);
+
+  void TaskLoop();
+
+  std::vector<std::thread> threads_;
+  std::deque<Task> tasks_[3];
+  std::mutex mutex_;
+  std::condition_variable scheduled_;
+  bool running_{true};
+};
+
+// The quota of the ComputePool of the current thread, nullptr if the thread
+// does not share the pool, e.g. a thread of the pool.
+ComputeQuota* CurrentComputeQuota();
+
+// Overrides the priority of the quotas of the current thread during the
+// lifetime of the object, for the requests of a priority of their own.
+class ScopedComputePriority {
+ public:
+  explicit ScopedComputePriority(ComputePriority priority);
+  ~ScopedComputePriority();
+
+ private:
+  DISABLE_COPY_AND_ASSIGN(ScopedComputePriority);
+
+  int prev_;
+};
+
+// The quota of the intra-op parallel loops of the current thread: its own
+// quota if it shares the pool, else the quota of the process of
+// FLAGS_intra_op_threads, and nullptr on a thread of the pool or if the
+// intra-op parallelism is turned off.
+ComputeQuota* IntraOpQuota();
+
+// Sets the quota of the current thread during the lifetime of the object.
+class ScopedComputeQuota {
+ public:
+  explicit ScopedComputeQuota(ComputeQuota* quota);
+  ~ScopedComputeQuota();
+
+ private:
+  DISABLE_COPY_AND_ASSIGN(ScopedComputeQuota);
+
+  ComputeQuota* prev_;
+};
+
+// Runs fn(begin, end) on [0, n) with the ComputePool and the quota of the
+// current thread, or in one call on the current thread if it has no quota.
+inline void ParallelFor(int64_t n, int64_t grain,
+                        const ComputePool::RangeFn& fn) {
+  if (n <= 0) return;
+  auto* quota = CurrentComputeQuota();
+  if (quota == nullptr || n <= grain) {
+    fn(0, n);
+    return;
+  }
+  ComputePool::Instance()->ParallelFor(quota, n, grain, fn);
+}
+
+// Runs fn(begin', end') on the chunks of [begin, end) in parallel with the
+// IntraOpQuota() of the current thread, which, unlike the loops above, are
+// parallel without a quota of the thread too. The kernels with no parallel
+// version in the math library use it for their loops over the batch or the
+// rows.
+inline void ParallelFor(int64_t begin, int64_t end, int64_t grain,
+                        const ComputePool::RangeFn& fn) {
+  int64_t n = end - begin;
+  if (n <= 0) return;
+  auto* quota = IntraOpQuota();
+  if (quota == nullptr || n <= grain) {
+    fn(begin, end);
+    return;
+  }
+  ComputePool::Instance()->ParallelFor(
+      quota, n, grain,
+      [&](int64_t b, int64_t e) { fn(begin + b, begin + e); });
+}
+
+// The grain of the parallel loops whose items are of numel elements each, so
+// that a chunk is worth more than the overhead of a thread of the pool.
+inline int64_t GrainSize(int64_t numel) {
+  constexpr int64_t kMinChunkNumel = 1 << 15;
+  return std::max<int64_t>(kMinChunkNumel / std::max<int64_t>(numel, 1), 1);
+}
+
+// Runs fn(i) for i in [0, n) with the ComputePool if the current thread
+// shares it, else by OpenMP as the kernels do without the pool.
+template <typename Fn>
+inline void ParallelForEach(int64_t n, int64_t grain, Fn fn) {
+  if (CurrentComputeQuota() != nullptr) {
+    ParallelFor(n, grain, [&fn](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) fn(i);
+    });
+    return;
+  }
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int64_t i = 0; i < n; ++i) fn(i);
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,130 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/compute_pool.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace framework = paddle::framework;
+
+TEST(ComputePool, SerialWithoutQuota) {
+  std::thread::id caller = std::this_thread::get_id();
+  int calls = 0;
+  framework::ParallelFor(1000, 1, [&](int64_t begin, int64_t end) {
+    EXPECT_EQ(std::this_thread::get_id(), caller);
+    EXPECT_EQ(begin, 0);
+    EXPECT_EQ(end, 1000);
+    ++calls;
+  });
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(ComputePool, CoversTheRange) {
+  framework::ComputeQuota quota(4, framework::ComputePriority::kNormal);
+  framework::ScopedComputeQuota scope(&quota);
+  std::vector<std::atomic<int>> counts(10007);
+  for (auto& c : counts) c = 0;
+  framework::ParallelFor(counts.size(), 16, [&](int64_t begin, int64_t end) {
+    EXPECT_LT(begin, end);
+    for (int64_t i = begin; i < end; ++i) ++counts[i];
+  });
+  for (auto& c : counts) {
+    ASSERT_EQ(c, 1);
+  }
+  EXPECT_EQ(quota.num_busy(), 0);
+}
+
+TEST(ComputePool, QuotaIsShared) {
+  framework::ComputePool pool(8);
+  framework::ComputeQuota quota(2, framework::ComputePriority::kLow);
+  std::atomic<int> max_busy(0);
+  std::vector<std::thread> callers;
+  for (int t = 0; t < 4; ++t) {
+    callers.emplace_back([&] {
+      for (int k = 0; k < 20; ++k) {
+        pool.ParallelFor(&quota, 64, 1, [&](int64_t begin, int64_t end) {
+          int busy = quota.num_busy();
+          int prev = max_busy;
+          while (busy > prev && !max_busy.compare_exchange_weak(prev, busy)) {
+          }
+          std::this_thread::sleep_for(std::chrono::microseconds(50));
+        });
+      }
+    });
+  }
+  for (auto& t : callers) t.join();
+  EXPECT_LE(max_busy, 2);
+  EXPECT_EQ(quota.num_busy(), 0);
+}
+
+TEST(ComputePool, RethrowsTheException) {
+  framework::ComputePool pool(2);
+  framework::ComputeQuota quota(2, framework::ComputePriority::kHigh);
+  std::atomic<int> done(0);
+  EXPECT_THROW(pool.ParallelFor(&quota, 100, 1,
+                                [&](int64_t begin, int64_t end) {
+                                  if (begin <= 50 && 50 < end) {
+                                    PADDLE_THROW("chunk failed");
+                                  }
+                                  done += end - begin;
+                                }),
+               paddle::platform::EnforceNotMet);
+  EXPECT_GT(done, 0);
+  EXPECT_EQ(quota.num_busy(), 0);
+}
+
+TEST(ComputePool, NestedLoopsRunSerially) {
+  framework::ComputeQuota quota(4, framework::ComputePriority::kNormal);
+  framework::ScopedComputeQuota scope(&quota);
+  std::atomic<int64_t> sum(0);
+  framework::ParallelFor(8, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      framework::ParallelFor(100, 1, [&](int64_t b, int64_t e) {
+        for (int64_t j = b; j < e; ++j) sum += j;
+      });
+    }
+  });
+  EXPECT_EQ(sum, 8 * 4950);
+}
+
+TEST(ComputePool, IntraOpParallelFor) {
+  std::vector<std::atomic<int>> counts(20000);
+  for (auto& c : counts) c = 0;
+  framework::ParallelFor(100, counts.size(), 16,
+                         [&](int64_t begin, int64_t end) {
+                           EXPECT_GE(begin, 100);
+                           for (int64_t i = begin; i < end; ++i) ++counts[i];
+                         });
+  for (size_t i = 0; i < counts.size(); ++i) {
+    ASSERT_EQ(counts[i], i < 100 ? 0 : 1);
+  }
+
+  // The threads of the pool run the nested loops serially.
+  framework::ComputePool pool(1);
+  framework::ComputeQuota quota(1, framework::ComputePriority::kNormal);
+  std::thread::id caller = std::this_thread::get_id();
+  std::atomic<bool> nested_serial(true);
+  pool.ParallelFor(&quota, 64, 1, [&](int64_t begin, int64_t end) {
+    if (std::this_thread::get_id() != caller &&
+        framework::IntraOpQuota() != nullptr) {
+      nested_serial = false;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  });
+  EXPECT_TRUE(nested_serial);
+}
@@ -0,0 +1,187 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/concurrent_id_index.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+
+static constexpr int64_t kEmptyId = std::numeric_limits<int64_t>::min();
+static constexpr size_t kInitialCapacity = 16;
+
+// The finalizer of splitmix64, consecutive ids are scattered over both the
+// shards and the slots.
+static inline uint64_t HashId(int64_t id) {
+  uint64_t x = static_cast<uint64_t>(id);
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+ConcurrentIdIndex::ConcurrentIdIndex(size_t num_shards) {
+  PADDLE_ENFORCE_GT(num_shards, 0UL);
+  num_shards_ = 1;
+  shard_bits_ = 0;
+  while (num_shards_ < num_shards) {
+    num_shards_ <<= 1;
+    ++shard_bits_;
+  }
+  shards_.reset(new Shard[num_shards_]);
+}
+
+size_t ConcurrentIdIndex::FindSlot(const Shard& shard, int64_t id,
+                                   uint64_t hash) const {
+  size_t mask = shard.ids.size() - 1;
+  size_t slot = (hash >> shard_bits_) & mask;
+  while (shard.ids[slot] != id && shard.ids[slot] != kEmptyId) {
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+void ConcurrentIdIndex::InsertNoLock(Shard* shard, int64_t id, uint64_t hash,
+                                     int64_t index) {
+  // Keep the load factor under 0.75.
+  if ((shard->size + 1) * 4 > shard->ids.size() * 3) {
+    Rehash(shard);
+  }
+  size_t slot = FindSlot(*shard, id, hash);
+  shard->ids[slot] = id;
+  shard->indices[slot] = index;
+  ++shard->size;
+}
+
+void ConcurrentIdIndex::Rehash(Shard* shard) {
+  std::vector<int64_t> ids(
+      std::max(kInitialCapacity, shard->ids.size() * 2), kEmptyId);
+  std::vector<int64_t> indices(ids.size(), -1);
+  ids.swap(shard->ids);
+  indices.swap(shard->indices);
+  for (size_t i = 0; i < ids.size(); ++i) {
+    if (ids[i] != kEmptyId) {
+      size_t slot = FindSlot(*shard, ids[i], HashId(ids[i]));
+      shard->ids[slot] = ids[i];
+      shard->indices[slot] = indices[i];
+    }
+  }
+}
+
+int64_t ConcurrentIdIndex::Find(int64_t id) const {
+  uint64_t hash = HashId(id);
+  auto& shard = GetShard(hash);
+  AutoRDLock guard(&shard.lock);
+  if (shard.size == 0 || id == kEmptyId) {
+    return -1;
+  }
+  return shard.indices[FindSlot(shard, id, hash)];
+}
+
+int64_t ConcurrentIdIndex::FindOrInsert(
+    int64_t id, const std::function<int64_t()>& new_index) {
+  PADDLE_ENFORCE_NE(id, kEmptyId, "id %d is reserved", id);
+  uint64_t hash = HashId(id);
+  auto& shard = GetShard(hash);
+  {
+    AutoRDLock guard(&shard.lock);
+    if (shard.size != 0) {
+      size_t slot = FindSlot(shard, id, hash);
+      if (shard.ids[slot] == id) {
+        return shard.indices[slot];
+      }
+    }
+  }
+
+  AutoWRLock guard(&shard.lock);
+  // Another thread may have inserted the id before the write lock is held.
+  if (shard.size != 0) {
+    size_t slot = FindSlot(shard, id, hash);
+    if (shard.ids[slot] == id) {
+      return shard.indices[slot];
+    }
+  }
+  int64_t index = new_index();
+  InsertNoLock(&shard, id, hash, index);
+  return index;
+}
+
+bool ConcurrentIdIndex::Insert(int64_t id, int64_t index) {
+  PADDLE_ENFORCE_NE(id, kEmptyId, "id %d is reserved", id);
+  uint64_t hash = HashId(id);
+  auto& shard = GetShard(hash);
+  AutoWRLock guard(&shard.lock);
+  if (shard.size != 0 && shard.ids[FindSlot(shard, id, hash)] == id) {
+    return false;
+  }
+  InsertNoLock(&shard, id, hash, index);
+  return true;
+}
+
+bool ConcurrentIdIndex::Erase(int64_t id) {
+  uint64_t hash = HashId(id);
+  auto& shard = GetShard(hash);
+  AutoWRLock guard(&shard.lock);
+  if (shard.size == 0 || id == kEmptyId) {
+    return false;
+  }
+  size_t hole = FindSlot(shard, id, hash);
+  if (shard.ids[hole] != id) {
+    return false;
+  }
+  // Shift the following ids of the probe sequence back into the hole, so
+  // that the probing of none of them stops at the emptied slot.
+  size_t mask = shard.ids.size() - 1;
+  for (size_t slot = (hole + 1) & mask; shard.ids[slot] != kEmptyId;
+       slot = (slot + 1) & mask) {
+    size_t home = (HashId(shard.ids[slot]) >> shard_bits_) & mask;
+    if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+      shard.ids[hole] = shard.ids[slot];
+      shard.indices[hole] = shard.indices[slot];
+      hole = slot;
+    }
+  }
+  shard.ids[hole] = kEmptyId;
+  shard.indices[hole] = -1;
+  --shard.size;
+  return true;
+}
+
+size_t ConcurrentIdIndex::Size() const {
+  size_t size = 0;
+  for (size_t i = 0; i < num_shards_; ++i) {
+    AutoRDLock guard(&shards_[i].lock);
+    size += shards_[i].size;
+  }
+  return size;
+}
+
+void ConcurrentIdIndex::Clear() {
+  for (size_t i = 0; i < num_shards_; ++i) {
+    AutoWRLock guard(&shards_[i].lock);
+    shards_[i].ids.clear();
+    shards_[i].indices.clear();
+    shards_[i].size = 0;
+  }
+}
+
+size_t ConcurrentIdIndex::ShardOf(int64_t id, size_t num_shards) {
+  return HashId(id) & (num_shards - 1);
+}
+
+}  // namespace framework
+}  // namespace paddle
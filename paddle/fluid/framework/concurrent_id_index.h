@@ -0,0 +1,109 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "paddle/fluid/framework/rw_lock.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * @brief A concurrent hash map from int64 ids to int64 indices.
+ *
+ *  The ids are spread over a fixed number of shards, each of which is an open
+ *  addressing table with linear probing guarded by its own RWLock, so that
+ *  the lookups only take the read lock of one shard and the inserts of
+ *  different shards do not block each other.
+ */
+class ConcurrentIdIndex {
+ public:
+  explicit ConcurrentIdIndex(size_t num_shards = kDefaultNumShards);
+
+  ConcurrentIdIndex(const ConcurrentIdIndex& other) = delete;
+  ConcurrentIdIndex& operator=(const ConcurrentIdIndex& other) = delete;
+
+  /*
+   * @return the index of the id, or -1 if the id does not exist.
+   */
+  int64_t Find(int64_t id) const;
+
+  /*
+   * @brief Get the index of the id. If the id does not exist, insert it with
+   * the index returned by new_index, which is called with the lock of the
+   * shard held and at most once.
+   */
+  int64_t FindOrInsert(int64_t id, const std::function<int64_t()>& new_index);
+
+  /*
+   * @brief Insert the id if it does not exist.
+   *
+   * @return true if the id is inserted.
+   */
+  bool Insert(int64_t id, int64_t index);
+
+  /*
+   * @brief Remove the id if it exists.
+   *
+   * @return true if the id is removed.
+   */
+  bool Erase(int64_t id);
+
+  /*
+   * @return the number of ids in the map.
+   */
+  size_t Size() const;
+
+  void Clear();
+
+  /*
+   * @return the shard of the id when the ids are spread over num_shards
+   * shards, which must be a power of 2. The ids in one shard of an index
+   * with num_shards or more shards are in the same one of these shards.
+   */
+  static size_t ShardOf(int64_t id, size_t num_shards);
+
+  static constexpr size_t kDefaultNumShards = 64;
+
+ private:
+  struct Shard {
+    mutable RWLock lock;
+    std::vector<int64_t> ids;
+    std::vector<int64_t> indices;
+    size_t size{0};
+  };
+
+  Shard& GetShard(uint64_t hash) const {
+    return shards_[hash & (num_shards_ - 1)];
+  }
+
+  // Return the slot of the id, or the empty slot it should be put in.
+  size_t FindSlot(const Shard& shard, int64_t id, uint64_t hash) const;
+
+  void InsertNoLock(Shard* shard, int64_t id, uint64_t hash, int64_t index);
+
+  void Rehash(Shard* shard);
+
+  size_t num_shards_;
+  size_t shard_bits_;
+  std::unique_ptr<Shard[]> shards_;
+};
+
+}  // namespace framework
+}  // namespace paddle
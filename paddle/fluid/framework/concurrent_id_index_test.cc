@@ -0,0 +1,94 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/concurrent_id_index.h"
+
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+TEST(ConcurrentIdIndex, InsertAndFind) {
+  ConcurrentIdIndex index(4);
+  EXPECT_EQ(index.Find(3), -1);
+  EXPECT_TRUE(index.Insert(3, 0));
+  EXPECT_FALSE(index.Insert(3, 1));
+  EXPECT_EQ(index.Find(3), 0);
+
+  for (int64_t i = 0; i < 10000; ++i) {
+    index.Insert(-i * 7, i);
+  }
+  // -0 is 0, which is not inserted before.
+  EXPECT_EQ(index.Size(), 10001UL);
+  for (int64_t i = 1; i < 10000; ++i) {
+    EXPECT_EQ(index.Find(-i * 7), i);
+  }
+  EXPECT_EQ(index.Find(1), -1);
+
+  index.Clear();
+  EXPECT_EQ(index.Size(), 0UL);
+  EXPECT_EQ(index.Find(3), -1);
+}
+
+TEST(ConcurrentIdIndex, Erase) {
+  ConcurrentIdIndex index(2);
+  for (int64_t i = 0; i < 1000; ++i) {
+    index.Insert(i, i);
+  }
+  EXPECT_FALSE(index.Erase(1000));
+  // Erasing every other id leaves the probe sequences of the rest intact.
+  for (int64_t i = 0; i < 1000; i += 2) {
+    EXPECT_TRUE(index.Erase(i));
+  }
+  EXPECT_FALSE(index.Erase(0));
+  EXPECT_EQ(index.Size(), 500UL);
+  for (int64_t i = 0; i < 1000; ++i) {
+    EXPECT_EQ(index.Find(i), i % 2 == 0 ? -1 : i);
+  }
+  EXPECT_TRUE(index.Insert(0, 7));
+  EXPECT_EQ(index.Find(0), 7);
+}
+
+TEST(ConcurrentIdIndex, MultiThreadFindOrInsert) {
+  ConcurrentIdIndex index;
+  std::atomic<int64_t> next_index(0);
+  const int64_t num_ids = 100000;
+
+  auto func = [&](int64_t begin) {
+    for (int64_t i = 0; i < num_ids; ++i) {
+      int64_t id = (begin + i) % num_ids;
+      int64_t idx1 = index.FindOrInsert(id, [&] { return next_index++; });
+      int64_t idx2 = index.Find(id);
+      ASSERT_EQ(idx1, idx2);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int64_t i = 0; i < 4; ++i) {
+    threads.emplace_back(func, i * num_ids / 4);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  // Every id is inserted exactly once.
+  EXPECT_EQ(index.Size(), static_cast<size_t>(num_ids));
+  EXPECT_EQ(next_index.load(), num_ids);
+}
+
+}  // namespace framework
+}  // namespace paddle
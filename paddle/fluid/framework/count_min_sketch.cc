@@ -0,0 +1,77 @@
+//   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/count_min_sketch.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+
+// The finalizer of splitmix64, seeded by the row.
+static inline uint64_t HashId(int64_t id, size_t row) {
+  uint64_t x = static_cast<uint64_t>(id) + (row + 1) * 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+CountMinSketch::CountMinSketch(size_t width, size_t depth) : depth_(depth) {
+  PADDLE_ENFORCE_GT(width, 0UL);
+  PADDLE_ENFORCE_GT(depth, 0UL);
+  width_ = 1;
+  while (width_ < width) {
+    width_ <<= 1;
+  }
+  counters_.reset(new std::atomic<uint32_t>[width_ * depth_]);
+  for (size_t i = 0; i < width_ * depth_; ++i) {
+    counters_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+size_t CountMinSketch::Counter(int64_t id, size_t row) const {
+  return row * width_ + (HashId(id, row) & (width_ - 1));
+}
+
+uint32_t CountMinSketch::Add(int64_t id) {
+  uint32_t count = std::numeric_limits<uint32_t>::max();
+  for (size_t row = 0; row < depth_; ++row) {
+    uint32_t c =
+        counters_[Counter(id, row)].fetch_add(1, std::memory_order_relaxed);
+    count = std::min(count, c + 1);
+  }
+  return count;
+}
+
+uint32_t CountMinSketch::Estimate(int64_t id) const {
+  uint32_t count = std::numeric_limits<uint32_t>::max();
+  for (size_t row = 0; row < depth_; ++row) {
+    count = std::min(
+        count, counters_[Counter(id, row)].load(std::memory_order_relaxed));
+  }
+  return count;
+}
+
+void CountMinSketch::Decay() {
+  for (size_t i = 0; i < width_ * depth_; ++i) {
+    counters_[i].store(counters_[i].load(std::memory_order_relaxed) / 2,
+                       std::memory_order_relaxed);
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,64 @@
+//   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace paddle {
+namespace framework {
+
+/*
+ * @brief A Count-Min sketch of the occurrences of int64 ids.
+ *
+ *  Each id has a counter in each of the depth rows of width counters, and
+ *  its estimated count is the smallest of them, which is never less than
+ *  the real count. The counts can be added concurrently.
+ */
+class CountMinSketch {
+ public:
+  explicit CountMinSketch(size_t width, size_t depth = kDefaultDepth);
+
+  CountMinSketch(const CountMinSketch& other) = delete;
+  CountMinSketch& operator=(const CountMinSketch& other) = delete;
+
+  /*
+   * @brief Add one occurrence of the id.
+   *
+   * @return the estimated count of the id after the add.
+   */
+  uint32_t Add(int64_t id);
+
+  uint32_t Estimate(int64_t id) const;
+
+  /*
+   * @brief Halve all the counts, so that the estimates favor the recent
+   * occurrences. It should not run with Add concurrently.
+   */
+  void Decay();
+
+  static constexpr size_t kDefaultDepth = 4;
+
+ private:
+  size_t Counter(int64_t id, size_t row) const;
+
+  size_t width_;
+  size_t depth_;
+  std::unique_ptr<std::atomic<uint32_t>[]> counters_;
+};
+
+}  // namespace framework
+}  // namespace paddle
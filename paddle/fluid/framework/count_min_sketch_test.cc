@@ -0,0 +1,68 @@
+//   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/count_min_sketch.h"
+
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+TEST(CountMinSketch, AddAndEstimate) {
+  CountMinSketch sketch(16384);
+  EXPECT_EQ(sketch.Estimate(7), 0U);
+  EXPECT_EQ(sketch.Add(7), 1U);
+  EXPECT_EQ(sketch.Add(7), 2U);
+  EXPECT_EQ(sketch.Estimate(7), 2U);
+
+  // The estimates are never less than the counts.
+  for (int64_t id = 0; id < 4096; ++id) {
+    for (int64_t i = 0; i < id % 3; ++i) {
+      sketch.Add(id);
+    }
+  }
+  size_t exact = 0;
+  for (int64_t id = 8; id < 4096; ++id) {
+    uint32_t estimate = sketch.Estimate(id);
+    EXPECT_GE(estimate, static_cast<uint32_t>(id % 3));
+    exact += estimate == static_cast<uint32_t>(id % 3);
+  }
+  EXPECT_GT(exact, 2048UL);
+
+  uint32_t estimate = sketch.Estimate(7);
+  sketch.Decay();
+  EXPECT_EQ(sketch.Estimate(7), estimate / 2);
+}
+
+TEST(CountMinSketch, MultiThreadAdd) {
+  CountMinSketch sketch(16);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&sketch] {
+      for (int j = 0; j < 10000; ++j) {
+        sketch.Add(3);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_GE(sketch.Estimate(3), 40000U);
+}
+
+}  // namespace framework
+}  // namespace paddle
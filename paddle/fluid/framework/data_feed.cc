@@ -12,6 +12,13 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <random>
+#include <thread>  // NOLINT
+#include <xxhash.h>
+
 #include "google/protobuf/io/zero_copy_stream_impl.h"
 #include "google/protobuf/message.h"
 #include "google/protobuf/text_format.h"
@@ -105,8 +112,16 @@ void PrivateQueueDataFeed<T>::ReadThread() {
     file_.open(filename.c_str());  // is_text_feed
     PADDLE_ENFORCE(file_.good(), "Open file<%s> fail.", filename.c_str());
     T instance;
-    while (ParseOneInstance(&instance)) {
-      queue_->Send(instance);
+    while (true) {
+      {
+        ReaderTimer timer(monitor_, ReaderMonitor::kParse);
+        if (!ParseOneInstance(&instance)) break;
+      }
+      {
+        ReaderTimer timer(monitor_, ReaderMonitor::kProducerWait);
+        queue_->Send(instance);
+      }
+      monitor_->RecordProduced(0);
     }
     file_.close();
   }
@@ -120,11 +135,16 @@ int PrivateQueueDataFeed<T>::Next() {
   T instance;
   T ins_vec;
   while (index < default_batch_size_) {
-    if (!queue_->Receive(&instance)) {
-      break;
+    {
+      ReaderTimer timer(monitor_, ReaderMonitor::kConsumerWait);
+      if (!queue_->Receive(&instance)) {
+        break;
+      }
     }
+    monitor_->RecordConsumed();
     AddInstanceToInsVec(&ins_vec, instance, index++);
   }
+  monitor_->RecordQueueSize(queue_->Size(), queue_->Cap());
   batch_size_ = index;
   if (batch_size_ != 0) {
     PutToFeedVec(ins_vec);
@@ -134,26 +154,23 @@ int PrivateQueueDataFeed<T>::Next() {
 
 #ifdef _WIN32
 template class PrivateQueueDataFeed<std::vector<MultiSlotType>>;
+template class PrivateQueueDataFeed<MultiSlotBinaryRecord>;
 #endif
 
-void MultiSlotDataFeed::Init(
+void DataFeed::InitMultiSlotDesc(
     const paddle::framework::DataFeedDesc& data_feed_desc) {
-  finish_init_ = false;
-  finish_set_filelist_ = false;
-  finish_start_ = false;
-
   PADDLE_ENFORCE(data_feed_desc.has_multi_slot_desc(),
                  "Multi_slot_desc has not been set.");
   paddle::framework::MultiSlotDesc multi_slot_desc =
       data_feed_desc.multi_slot_desc();
   SetBatchSize(data_feed_desc.batch_size());
-  SetQueueSize(data_feed_desc.batch_size());
   size_t all_slot_num = multi_slot_desc.slots_size();
   all_slots_.resize(all_slot_num);
   all_slots_type_.resize(all_slot_num);
   use_slots_index_.resize(all_slot_num);
   use_slots_.clear();
   use_slots_is_dense_.clear();
+  use_slots_type_.clear();
   for (size_t i = 0; i < all_slot_num; ++i) {
     const auto& slot = multi_slot_desc.slots(i);
     all_slots_[i] = slot.name();
@@ -162,9 +179,21 @@ void MultiSlotDataFeed::Init(
     if (slot.is_used()) {
       use_slots_.push_back(all_slots_[i]);
       use_slots_is_dense_.push_back(slot.is_dense());
+      use_slots_type_.push_back(slot.type());
     }
   }
   feed_vec_.resize(use_slots_.size());
+}
+
+void MultiSlotDataFeed::Init(
+    const paddle::framework::DataFeedDesc& data_feed_desc) {
+  finish_init_ = false;
+  finish_set_filelist_ = false;
+  finish_start_ = false;
+
+  InitMultiSlotDesc(data_feed_desc);
+  SetQueueSize(data_feed_desc.batch_size());
+  batch_feasign_num_.assign(use_slots_.size(), 0);
   finish_init_ = true;
 }
 
@@ -279,50 +308,134 @@ bool MultiSlotDataFeed::CheckFile(const char* filename) {
   return true;
 }
 
+// The fast paths of strtol, strtoull and strtof for the ids and feasigns,
+// which are plain decimals separated by spaces in most data. They fall back
+// to the libc functions for anything else, e.g. signs, exponents and
+// overflow, so the results and endptr are the same as the libc ones.
+static inline const char* SkipSpaces(const char* p) {
+  while (*p == ' ' || (*p >= '\t' && *p <= '\r')) ++p;
+  return p;
+}
+
+static inline bool IsDigit(char c) {
+  return static_cast<unsigned char>(c - '0') < 10;
+}
+
+// Parse at most 19 digits, which always fit in uint64_t.
+static inline const char* ParseDigits(const char* p, uint64_t* value) {
+  const char* begin = p;
+  uint64_t v = 0;
+  while (IsDigit(*p) && p - begin < 19) {
+    v = v * 10 + (*p++ - '0');
+  }
+  *value = v;
+  return p;
+}
+
+static inline int ParseInt(const char* str, char** endptr) {
+  uint64_t v;
+  const char* begin = SkipSpaces(str);
+  const char* p = ParseDigits(begin, &v);
+  if (p == begin || IsDigit(*p) || v > INT_MAX) {
+    return strtol(str, endptr, 10);
+  }
+  *endptr = const_cast<char*>(p);
+  return static_cast<int>(v);
+}
+
+static inline uint64_t ParseUint64(const char* str, char** endptr) {
+  uint64_t v;
+  const char* begin = SkipSpaces(str);
+  const char* p = ParseDigits(begin, &v);
+  if (p == begin || IsDigit(*p)) {
+    return strtoull(str, endptr, 10);
+  }
+  *endptr = const_cast<char*>(p);
+  return v;
+}
+
+static inline float ParseFloat(const char* str, char** endptr) {
+  // The decimals of at most 15 digits are exact in double, and so is the
+  // division by the powers of 10 up to 1e22.
+  static const double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                  1e12, 1e13, 1e14, 1e15};
+  const char* p = SkipSpaces(str);
+  bool negative = *p == '-';
+  if (negative) ++p;
+  uint64_t mantissa = 0;
+  int digits = 0;
+  int frac_digits = 0;
+  for (; IsDigit(*p); ++p, ++digits) {
+    mantissa = mantissa * 10 + (*p - '0');
+  }
+  if (*p == '.') {
+    for (++p; IsDigit(*p); ++p, ++digits, ++frac_digits) {
+      mantissa = mantissa * 10 + (*p - '0');
+    }
+  }
+  if (digits == 0 || digits > 15 || isalpha(static_cast<unsigned char>(*p))) {
+    return strtof(str, endptr);
+  }
+  *endptr = const_cast<char*>(p);
+  double v = mantissa / kPow10[frac_digits];
+  return static_cast<float>(negative ? -v : v);
+}
+
+static inline char* SkipToken(char* p) {
+  p = const_cast<char*>(SkipSpaces(p));
+  while (*p != '\0' && !isspace(static_cast<unsigned char>(*p))) ++p;
+  return p;
+}
+
 bool MultiSlotDataFeed::ParseOneInstance(std::vector<MultiSlotType>* instance) {
-  std::string line;
-  if (getline(file_, line)) {
-    int use_slots_num = use_slots_.size();
-    instance->resize(use_slots_num);
-    // parse line
-    const char* str = line.c_str();
-    char* endptr = const_cast<char*>(str);
-    int pos = 0;
-    for (size_t i = 0; i < use_slots_index_.size(); ++i) {
-      int idx = use_slots_index_[i];
-      int num = strtol(&str[pos], &endptr, 10);
-      PADDLE_ENFORCE(
-          num,
-          "The number of ids can not be zero, you need padding "
-          "it in data generator; or if there is something wrong with "
-          "the data, please check if the data contains unresolvable "
-          "characters.\nplease check this error line: %s",
-          str);
-
-      if (idx != -1) {
-        (*instance)[idx].Init(all_slots_type_[i]);
-        if ((*instance)[idx].GetType()[0] == 'f') {  // float
-          for (int j = 0; j < num; ++j) {
-            float feasign = strtof(endptr, &endptr);
-            (*instance)[idx].AddValue(feasign);
-          }
-        } else if ((*instance)[idx].GetType()[0] == 'u') {  // uint64
-          for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
-            (*instance)[idx].AddValue(feasign);
-          }
+  if (getline(file_, line_)) {
+    ParseLine(line_, instance);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void MultiSlotDataFeed::ParseLine(const std::string& line,
+                                  std::vector<MultiSlotType>* instance) {
+  int use_slots_num = use_slots_.size();
+  instance->resize(use_slots_num);
+  // parse line
+  const char* str = line.c_str();
+  char* endptr = const_cast<char*>(str);
+  for (size_t i = 0; i < use_slots_index_.size(); ++i) {
+    int idx = use_slots_index_[i];
+    int num = ParseInt(endptr, &endptr);
+    PADDLE_ENFORCE(
+        num,
+        "The number of ids can not be zero, you need padding "
+        "it in data generator; or if there is something wrong with "
+        "the data, please check if the data contains unresolvable "
+        "characters.\nplease check this error line: %s",
+        str);
+
+    if (idx != -1) {
+      (*instance)[idx].Init(all_slots_type_[i]);
+      if ((*instance)[idx].GetType()[0] == 'f') {  // float
+        auto* feasigns = (*instance)[idx].MutableFloatData();
+        feasigns->resize(num);
+        for (int j = 0; j < num; ++j) {
+          (*feasigns)[j] = ParseFloat(endptr, &endptr);
         }
-        pos = endptr - str;
-      } else {
-        for (int j = 0; j <= num; ++j) {
-          pos = line.find_first_of(' ', pos + 1);
+      } else if ((*instance)[idx].GetType()[0] == 'u') {  // uint64
+        auto* feasigns = (*instance)[idx].MutableUint64Data();
+        feasigns->resize(num);
+        for (int j = 0; j < num; ++j) {
+          (*feasigns)[j] = ParseUint64(endptr, &endptr);
         }
       }
+    } else {
+      for (int j = 0; j < num; ++j) {
+        endptr = SkipToken(endptr);
+      }
     }
-  } else {
-    return false;
   }
-  return true;
 }
 
 void MultiSlotDataFeed::AddInstanceToInsVec(
@@ -333,6 +446,7 @@ void MultiSlotDataFeed::AddInstanceToInsVec(
     for (size_t i = 0; i < instance.size(); ++i) {
       (*ins_vec)[i].Init(instance[i].GetType());
       (*ins_vec)[i].InitOffset();
+      (*ins_vec)[i].Reserve(batch_feasign_num_[i], default_batch_size_);
     }
   }
 
@@ -347,6 +461,7 @@ void MultiSlotDataFeed::PutToFeedVec(
     const auto& type = ins_vec[i].GetType();
     const auto& offset = ins_vec[i].GetOffset();
     int total_instance = static_cast<int>(offset.back());
+    batch_feasign_num_[i] = std::max(batch_feasign_num_[i], offset.back());
 
     if (type[0] == 'f') {  // float
       const auto& feasign = ins_vec[i].GetFloatData();
@@ -370,5 +485,360 @@ void MultiSlotDataFeed::PutToFeedVec(
   }
 }
 
+void MultiSlotInMemoryData::Load(
+    const paddle::framework::DataFeedDesc& data_feed_desc,
+    const std::vector<std::string>& filelist, int thread_num, int trainer_id,
+    int trainer_num) {
+  PADDLE_ENFORCE_GT(thread_num, 0, "Illegal thread num: %d.", thread_num);
+  PADDLE_ENFORCE(trainer_id >= 0 && trainer_id < trainer_num,
+                 "Illegal trainer id %d of %d trainers.", trainer_id,
+                 trainer_num);
+  Release();
+  std::vector<std::unique_ptr<MultiSlotInMemoryDataFeed>> loaders(thread_num);
+  for (auto& loader : loaders) {
+    loader.reset(new MultiSlotInMemoryDataFeed);
+    loader->Init(data_feed_desc);
+  }
+  loaders[0]->SetFileList(filelist);
+  arenas_.resize(thread_num);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_num; ++i) {
+    threads.emplace_back(&MultiSlotInMemoryDataFeed::LoadIntoMemory,
+                         loaders[i].get(), &arenas_[i], trainer_id,
+                         trainer_num);
+  }
+  for (auto& th : threads) {
+    th.join();
+  }
+
+  arena_begin_.clear();
+  for (size_t i = 0; i < arenas_.size(); ++i) {
+    arena_begin_.push_back(order_.size());
+    size_t instance_num =
+        arenas_[i].empty() ? 0 : arenas_[i][0].GetOffset().size() - 1;
+    for (size_t j = 0; j < instance_num; ++j) {
+      order_.emplace_back(i, j);
+    }
+  }
+  arena_begin_.push_back(order_.size());
+  VLOG(3) << "Load " << order_.size() << " instances into memory";
+}
+
+void MultiSlotInMemoryData::LocalShuffle(unsigned int seed) {
+  std::default_random_engine engine(seed);
+  for (size_t i = 0; i + 1 < arena_begin_.size(); ++i) {
+    std::shuffle(order_.begin() + arena_begin_[i],
+                 order_.begin() + arena_begin_[i + 1], engine);
+  }
+}
+
+void MultiSlotInMemoryData::GlobalShuffle(unsigned int seed) {
+  std::default_random_engine engine(seed);
+  std::shuffle(order_.begin(), order_.end(), engine);
+}
+
+std::vector<std::shared_ptr<DataFeed>> MultiSlotInMemoryData::CreateReaders(
+    const paddle::framework::DataFeedDesc& data_feed_desc,
+    int part_num) const {
+  PADDLE_ENFORCE_GT(part_num, 0, "Illegal part num: %d.", part_num);
+  std::vector<std::shared_ptr<DataFeed>> readers;
+  for (int i = 0; i < part_num; ++i) {
+    auto* reader = new MultiSlotInMemoryDataFeed;
+    readers.emplace_back(reader);
+    reader->Init(data_feed_desc);
+    reader->SetData(this, order_.size() * i / part_num,
+                    order_.size() * (i + 1) / part_num);
+  }
+  return readers;
+}
+
+void MultiSlotInMemoryData::Release() {
+  arenas_.clear();
+  order_.clear();
+  arena_begin_.clear();
+}
+
+void MultiSlotInMemoryDataFeed::LoadIntoMemory(
+    std::vector<MultiSlotType>* arena, int trainer_id, int trainer_num) {
+  arena->resize(use_slots_.size());
+  for (size_t i = 0; i < use_slots_.size(); ++i) {
+    (*arena)[i].Init(use_slots_type_[i]);
+    (*arena)[i].InitOffset();
+  }
+  std::string filename;
+  std::vector<MultiSlotType> instance;
+  while (PickOneFile(&filename)) {
+    file_.open(filename.c_str());
+    PADDLE_ENFORCE(file_.good(), "Open file<%s> fail.", filename.c_str());
+    while (getline(file_, line_)) {
+      // The hash of the line is the same on all the trainers, which decides
+      // the trainer of the instance.
+      if (trainer_num > 1 &&
+          static_cast<int>(XXH64(line_.data(), line_.size(), 0) %
+                           trainer_num) != trainer_id) {
+        continue;
+      }
+      ParseLine(line_, &instance);
+      for (size_t i = 0; i < instance.size(); ++i) {
+        (*arena)[i].AddIns(instance[i]);
+      }
+    }
+    file_.close();
+  }
+}
+
+void MultiSlotInMemoryDataFeed::SetData(const MultiSlotInMemoryData* data,
+                                        size_t begin, size_t end) {
+  data_ = data;
+  begin_ = begin;
+  end_ = end;
+}
+
+bool MultiSlotInMemoryDataFeed::Start() {
+  CheckInit();
+  PADDLE_ENFORCE_NOT_NULL(data_, "The data in memory has not been set.");
+  cursor_ = begin_;
+  finish_start_ = true;
+  return true;
+}
+
+int MultiSlotInMemoryDataFeed::Next() {
+  CheckStart();
+  batch_size_ = static_cast<int>(
+      std::min(end_ - cursor_, static_cast<size_t>(default_batch_size_)));
+  if (batch_size_ == 0) {
+    return 0;
+  }
+  ins_vec_.resize(use_slots_.size());
+  for (size_t i = 0; i < ins_vec_.size(); ++i) {
+    ins_vec_[i].Init(use_slots_type_[i]);
+    ins_vec_[i].InitOffset();
+  }
+  for (size_t k = cursor_; k < cursor_ + batch_size_; ++k) {
+    const auto& pos = data_->order_[k];
+    const auto& arena = data_->arenas_[pos.first];
+    for (size_t i = 0; i < ins_vec_.size(); ++i) {
+      ins_vec_[i].AddIns(arena[i], pos.second);
+    }
+  }
+  cursor_ += batch_size_;
+  PutToFeedVec(ins_vec_);
+  return batch_size_;
+}
+
+static constexpr char kMultiSlotBinaryMagic[] = "PDMSLOTB";
+static constexpr uint32_t kMultiSlotBinaryVersion = 1;
+
+// The size of a feasign of the slot type in the binary multi-slot data.
+static size_t MultiSlotBinaryValueSize(const std::string& type) {
+  if (type == "float") return sizeof(float);
+  if (type == "uint64") return sizeof(uint64_t);
+  PADDLE_THROW("This type<%s> is not supported", type);
+}
+
+void MultiSlotBinaryDataFeed::Init(
+    const paddle::framework::DataFeedDesc& data_feed_desc) {
+  finish_init_ = false;
+  finish_set_filelist_ = false;
+  finish_start_ = false;
+
+  InitMultiSlotDesc(data_feed_desc);
+  for (auto& type : all_slots_type_) MultiSlotBinaryValueSize(type);
+  SetQueueSize(data_feed_desc.batch_size());
+  finish_init_ = true;
+}
+
+void MultiSlotBinaryDataFeed::OpenFile(const std::string& filename) {
+  mapped_file_ = memory::allocation::MmapAllocation::MapFile(filename);
+  pos_ = static_cast<const char*>(mapped_file_->ptr());
+  end_ = pos_ + mapped_file_->size();
+
+  size_t magic_size = sizeof(kMultiSlotBinaryMagic) - 1;
+  size_t header_size = magic_size + 2 * sizeof(uint32_t);
+  PADDLE_ENFORCE(static_cast<size_t>(end_ - pos_) >= header_size &&
+                     memcmp(pos_, kMultiSlotBinaryMagic, magic_size) == 0,
+                 "File<%s> is not binary multi-slot data.", filename);
+  pos_ += magic_size;
+  uint32_t version, slot_num;
+  memcpy(&version, pos_, sizeof(uint32_t));
+  memcpy(&slot_num, pos_ + sizeof(uint32_t), sizeof(uint32_t));
+  pos_ += 2 * sizeof(uint32_t);
+  PADDLE_ENFORCE_EQ(version, kMultiSlotBinaryVersion,
+                    "Unsupported version of binary multi-slot file<%s>.",
+                    filename);
+  PADDLE_ENFORCE_EQ(slot_num, all_slots_.size(),
+                    "The slots of file<%s> do not match the desc.", filename);
+  PADDLE_ENFORCE_GE(end_ - pos_, slot_num, "File<%s> is truncated.",
+                    filename);
+  for (size_t i = 0; i < all_slots_.size(); ++i) {
+    PADDLE_ENFORCE_EQ(pos_[i], all_slots_type_[i][0],
+                      "The type of slot<%s> in file<%s> does not match the "
+                      "desc.",
+                      all_slots_[i], filename);
+  }
+  pos_ += slot_num;
+}
+
+bool MultiSlotBinaryDataFeed::CheckFile(const char* filename) {
+  CheckInit();  // get info of slots
+  try {
+    OpenFile(filename);
+    MultiSlotBinaryRecord instance;
+    int instance_cout = 0;
+    while (ParseOneInstance(&instance)) ++instance_cout;
+    VLOG(3) << "instances cout: " << instance_cout;
+  } catch (const platform::EnforceNotMet& e) {
+    VLOG(0) << "error: " << e.what();
+    mapped_file_.reset();
+    return false;
+  }
+  mapped_file_.reset();
+  VLOG(3) << "The file format is correct";
+  return true;
+}
+
+void MultiSlotBinaryDataFeed::ReadThread() {
+  std::string filename;
+  while (PickOneFile(&filename)) {
+    OpenFile(filename);
+    MultiSlotBinaryRecord instance;
+    while (ParseOneInstance(&instance)) {
+      queue_->Send(instance);
+    }
+    mapped_file_.reset();
+  }
+  queue_->Close();
+}
+
+bool MultiSlotBinaryDataFeed::ParseOneInstance(
+    MultiSlotBinaryRecord* instance) {
+  if (pos_ == end_) return false;
+  instance->files.assign(1, mapped_file_);
+  instance->slots.resize(use_slots_.size());
+  for (size_t i = 0; i < all_slots_.size(); ++i) {
+    PADDLE_ENFORCE_GE(static_cast<size_t>(end_ - pos_), sizeof(uint32_t),
+                      "The binary multi-slot data is truncated.");
+    uint32_t num;
+    memcpy(&num, pos_, sizeof(uint32_t));
+    pos_ += sizeof(uint32_t);
+    PADDLE_ENFORCE(num > 0, "The number of ids can not be zero.");
+    size_t size = num * MultiSlotBinaryValueSize(all_slots_type_[i]);
+    PADDLE_ENFORCE_GE(static_cast<size_t>(end_ - pos_), size,
+                      "The binary multi-slot data is truncated.");
+    if (use_slots_index_[i] != -1) {
+      instance->slots[use_slots_index_[i]] = {pos_, num};
+    }
+    pos_ += size;
+  }
+  return true;
+}
+
+void MultiSlotBinaryDataFeed::AddInstanceToInsVec(
+    MultiSlotBinaryRecord* ins_vec, const MultiSlotBinaryRecord& instance,
+    int index) {
+  if (index == 0) {
+    ins_vec->files.clear();
+    ins_vec->slots.clear();
+  }
+  // Keep the mapped files alive until the batch is copied.
+  if (ins_vec->files.empty() || ins_vec->files.back() != instance.files[0]) {
+    ins_vec->files.push_back(instance.files[0]);
+  }
+  ins_vec->slots.insert(ins_vec->slots.end(), instance.slots.begin(),
+                        instance.slots.end());
+}
+
+void MultiSlotBinaryDataFeed::PutToFeedVec(
+    const MultiSlotBinaryRecord& ins_vec) {
+  size_t use_slot_num = use_slots_.size();
+  for (size_t i = 0; i < use_slot_num; ++i) {
+    std::vector<size_t> offset(batch_size_ + 1, 0);
+    for (int j = 0; j < batch_size_; ++j) {
+      offset[j + 1] = offset[j] + ins_vec.slots[j * use_slot_num + i].num;
+    }
+    int total_instance = static_cast<int>(offset.back());
+    const auto& type = use_slots_type_[i];
+    size_t value_size = MultiSlotBinaryValueSize(type);
+    char* tensor_ptr = nullptr;
+    if (type[0] == 'f') {  // float
+      tensor_ptr = reinterpret_cast<char*>(feed_vec_[i]->mutable_data<float>(
+          {total_instance, 1}, platform::CPUPlace()));
+    } else {  // uint64, no uint64_t type in paddlepaddle
+      tensor_ptr = reinterpret_cast<char*>(feed_vec_[i]->mutable_data<int64_t>(
+          {total_instance, 1}, platform::CPUPlace()));
+    }
+    for (int j = 0; j < batch_size_; ++j) {
+      const auto& slot = ins_vec.slots[j * use_slot_num + i];
+      memcpy(tensor_ptr, slot.data, slot.num * value_size);
+      tensor_ptr += slot.num * value_size;
+    }
+
+    LoD data_lod{offset};
+    feed_vec_[i]->set_lod(data_lod);
+    if (use_slots_is_dense_[i]) {
+      int dim = total_instance / batch_size_;
+      feed_vec_[i]->Resize({batch_size_, dim});
+    }
+  }
+}
+
+size_t ConvertMultiSlotTextToBinary(
+    const paddle::framework::DataFeedDesc& data_feed_desc,
+    const std::string& text_file, const std::string& binary_file) {
+  PADDLE_ENFORCE(data_feed_desc.has_multi_slot_desc(),
+                 "Multi_slot_desc has not been set.");
+  const auto& multi_slot_desc = data_feed_desc.multi_slot_desc();
+  uint32_t slot_num = multi_slot_desc.slots_size();
+  std::vector<size_t> value_size(slot_num);
+  std::string types;
+  for (uint32_t i = 0; i < slot_num; ++i) {
+    const auto& type = multi_slot_desc.slots(i).type();
+    value_size[i] = MultiSlotBinaryValueSize(type);
+    types += type[0];
+  }
+
+  std::ifstream fin(text_file);
+  PADDLE_ENFORCE(fin.good(), "Open file<%s> fail.", text_file);
+  std::ofstream fout(binary_file, std::ios::binary);
+  PADDLE_ENFORCE(fout.good(), "Open file<%s> fail.", binary_file);
+  fout.write(kMultiSlotBinaryMagic, sizeof(kMultiSlotBinaryMagic) - 1);
+  fout.write(reinterpret_cast<const char*>(&kMultiSlotBinaryVersion),
+             sizeof(uint32_t));
+  fout.write(reinterpret_cast<const char*>(&slot_num), sizeof(uint32_t));
+  fout.write(types.data(), types.size());
+
+  std::string line;
+  std::string buffer;
+  size_t instance_num = 0;
+  while (getline(fin, line)) {
+    ++instance_num;
+    buffer.clear();
+    char* endptr = const_cast<char*>(line.c_str());
+    for (uint32_t i = 0; i < slot_num; ++i) {
+      int num = strtol(endptr, &endptr, 10);
+      PADDLE_ENFORCE(num > 0,
+                     "The number of ids should be positive, please check "
+                     "line<%d> in file<%s>.",
+                     instance_num, text_file);
+      uint32_t unum = num;
+      buffer.append(reinterpret_cast<const char*>(&unum), sizeof(uint32_t));
+      for (int j = 0; j < num; ++j) {
+        if (types[i] == 'f') {
+          float feasign = strtof(endptr, &endptr);
+          buffer.append(reinterpret_cast<const char*>(&feasign),
+                        value_size[i]);
+        } else {
+          uint64_t feasign = strtoull(endptr, &endptr, 10);
+          buffer.append(reinterpret_cast<const char*>(&feasign),
+                        value_size[i]);
+        }
+      }
+    }
+    fout.write(buffer.data(), buffer.size());
+  }
+  PADDLE_ENFORCE(fout.good(), "Write file<%s> fail.", binary_file);
+  return instance_num;
+}
+
 }  // namespace framework
 }  // namespace paddle
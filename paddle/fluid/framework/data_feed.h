@@ -24,7 +24,9 @@ limitations under the License. */
 #include "paddle/fluid/framework/data_feed.pb.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/reader.h"
+#include "paddle/fluid/framework/reader_stats.h"
 #include "paddle/fluid/framework/variable.h"
+#include "paddle/fluid/memory/allocation/mmap_allocation.h"
 #include "paddle/fluid/operators/reader/blocking_queue.h"
 
 namespace paddle {
@@ -83,6 +85,9 @@ class DataFeed {
   virtual void CheckStart();
   virtual void SetBatchSize(
       int batch);  // batch size will be set in Init() function
+  // Init the slots and the batch size by the multi_slot_desc of
+  // data_feed_desc, which is shared by the multi-slot DataFeeds.
+  void InitMultiSlotDesc(const paddle::framework::DataFeedDesc& data_feed_desc);
   // This function is used to pick one file from the global filelist(thread
   // safe).
   virtual bool PickOneFile(std::string* filename);
@@ -95,6 +100,7 @@ class DataFeed {
   // data_feed_desc(proto object)
   std::vector<std::string> use_slots_;
   std::vector<bool> use_slots_is_dense_;
+  std::vector<std::string> use_slots_type_;
 
   // the alias of all slots, and its order is determined by data_feed_desc(proto
   // object)
@@ -153,6 +159,7 @@ class PrivateQueueDataFeed : public DataFeed {
   size_t queue_size_;
   // The queue for store parsed data
   std::unique_ptr<paddle::operators::reader::BlockingQueue<T>> queue_;
+  ReaderMonitor* monitor_ = GetReaderMonitor("data_feed");
 };
 
 // This class define the data type of instance(ins_vec) in MultiSlotDataFeed
@@ -176,6 +183,15 @@ class MultiSlotType {
     offset_[0] = 0;
   }
   const std::vector<size_t>& GetOffset() const { return offset_; }
+  // Reserve the capacity of a batch, so that AddIns does not reallocate.
+  void Reserve(size_t feasign_num, size_t ins_num) {
+    if (type_[0] == 'f') {
+      float_feasign_.reserve(feasign_num);
+    } else if (type_[0] == 'u') {
+      uint64_feasign_.reserve(feasign_num);
+    }
+    offset_.reserve(ins_num + 1);
+  }
   void AddValue(const float v) {
     CheckFloat();
     float_feasign_.push_back(v);
@@ -184,6 +200,24 @@ class MultiSlotType {
     CheckUint64();
     uint64_feasign_.push_back(v);
   }
+  // Add the index-th instance of ins, which holds a batch of instances.
+  void AddIns(const MultiSlotType& ins, size_t index) {
+    const auto& offset = ins.GetOffset();
+    size_t begin = offset[index];
+    size_t end = offset[index + 1];
+    if (ins.GetType()[0] == 'f') {  // float
+      CheckFloat();
+      auto& vec = ins.GetFloatData();
+      float_feasign_.insert(float_feasign_.end(), vec.begin() + begin,
+                            vec.begin() + end);
+    } else if (ins.GetType()[0] == 'u') {  // uint64
+      CheckUint64();
+      auto& vec = ins.GetUint64Data();
+      uint64_feasign_.insert(uint64_feasign_.end(), vec.begin() + begin,
+                             vec.begin() + end);
+    }
+    offset_.push_back(offset_.back() + end - begin);
+  }
   void AddIns(const MultiSlotType& ins) {
     if (ins.GetType()[0] == 'f') {  // float
       CheckFloat();
@@ -199,6 +233,15 @@ class MultiSlotType {
   }
   const std::vector<float>& GetFloatData() const { return float_feasign_; }
   const std::vector<uint64_t>& GetUint64Data() const { return uint64_feasign_; }
+  // The feasigns to be filled in place by the parser.
+  std::vector<float>* MutableFloatData() {
+    CheckFloat();
+    return &float_feasign_;
+  }
+  std::vector<uint64_t>* MutableUint64Data() {
+    CheckUint64();
+    return &uint64_feasign_;
+  }
   const std::string& GetType() const { return type_; }
 
  private:
@@ -235,6 +278,138 @@ class MultiSlotDataFeed
                                    int index);
   virtual bool ParseOneInstance(std::vector<MultiSlotType>* instance);
   virtual void PutToFeedVec(const std::vector<MultiSlotType>& ins_vec);
+  // Parse the instance of a line read from file_.
+  void ParseLine(const std::string& line, std::vector<MultiSlotType>* instance);
+
+  std::string line_;
+
+ private:
+  // The largest number of feasigns of each used slot in a batch so far,
+  // which is reserved for the next batches.
+  std::vector<size_t> batch_feasign_num_;
 };
+
+// The instances of multi-slot data loaded into memory, so that the passes
+// after the first one are served from memory instead of the files. The
+// instances loaded by each thread are kept in a compact arena of one
+// MultiSlotType per used slot, and the order of all the instances is split
+// into contiguous parts for the readers.
+//
+// Example:
+//   MultiSlotInMemoryData data;
+//   data.Load(data_feed_desc, filelist, thread_num);
+//   for (int pass = 0; pass < pass_num; ++pass) {
+//     data.LocalShuffle(seed + pass);
+//     auto readers = data.CreateReaders(data_feed_desc, thread_num);
+//     // train with the readers as the ones of the files
+//   }
+class MultiSlotInMemoryData {
+ public:
+  // Load the instances of filelist with thread_num threads, each of which
+  // picks the files like the readers. If trainer_num is greater than 1, only
+  // the instances hashed to trainer_id are kept, so that all the trainers
+  // load the same filelist and get disjoint shuffled shares of the data.
+  void Load(const paddle::framework::DataFeedDesc& data_feed_desc,
+            const std::vector<std::string>& filelist, int thread_num,
+            int trainer_id = 0, int trainer_num = 1);
+  // Shuffle the instances within the part of each loading thread.
+  void LocalShuffle(unsigned int seed);
+  // Shuffle all the instances of the trainer.
+  void GlobalShuffle(unsigned int seed);
+  // Create the readers of the part_num parts of the instances.
+  std::vector<std::shared_ptr<DataFeed>> CreateReaders(
+      const paddle::framework::DataFeedDesc& data_feed_desc,
+      int part_num) const;
+  size_t Size() const { return order_.size(); }
+  void Release();
+
+ private:
+  friend class MultiSlotInMemoryDataFeed;
+
+  std::vector<std::vector<MultiSlotType>> arenas_;
+  // The arena and the index in the arena of each instance.
+  std::vector<std::pair<uint32_t, uint32_t>> order_;
+  // The begin of the instances of each arena in order_ before the global
+  // shuffle, and the end of all the instances.
+  std::vector<size_t> arena_begin_;
+};
+
+// This DataFeed is used to feed the instances in MultiSlotInMemoryData,
+// which are loaded by it too. It can only be created by CreateReaders of
+// MultiSlotInMemoryData.
+class MultiSlotInMemoryDataFeed : public MultiSlotDataFeed {
+ public:
+  MultiSlotInMemoryDataFeed() {}
+  virtual ~MultiSlotInMemoryDataFeed() {}
+  virtual bool Start();
+  virtual int Next();
+
+ protected:
+  friend class MultiSlotInMemoryData;
+  // Parse the files picked from the filelist into the arena.
+  void LoadIntoMemory(std::vector<MultiSlotType>* arena, int trainer_id,
+                      int trainer_num);
+  // Feed the instances [begin, end) of the order of data.
+  void SetData(const MultiSlotInMemoryData* data, size_t begin, size_t end);
+
+ private:
+  const MultiSlotInMemoryData* data_{nullptr};
+  size_t begin_{0};
+  size_t end_{0};
+  size_t cursor_{0};
+  std::vector<MultiSlotType> ins_vec_;
+};
+
+// This class define the data type of instance(ins_vec) in
+// MultiSlotBinaryDataFeed. The slots point to the feasigns in the mapped
+// files, which are kept alive by files.
+struct MultiSlotBinaryRecord {
+  struct Slot {
+    const char* data;
+    uint32_t num;
+  };
+  std::vector<std::shared_ptr<memory::allocation::MmapAllocation>> files;
+  // The used slots of all the instances, in the order of instances.
+  std::vector<Slot> slots;
+};
+
+// This DataFeed is used to feed the binary multi-slot data, which needs no
+// parsing. The files are mapped and the feasigns are copied to the feed
+// tensors directly. The format of binary multi-slot data:
+//   "PDMSLOTB" version(uint32) slot_num(uint32) [slot_type(char)]*
+//   [[n(uint32) feasign_0 feasign_1 ... feasign_n]* for each slot]*
+// where the feasigns are packed uint64 or float by the type of the slot, and
+// slot_type is 'u' or 'f'. The files can be converted from the text data of
+// MultiSlotDataFeed by ConvertMultiSlotTextToBinary.
+class MultiSlotBinaryDataFeed
+    : public PrivateQueueDataFeed<MultiSlotBinaryRecord> {
+ public:
+  MultiSlotBinaryDataFeed() {}
+  virtual ~MultiSlotBinaryDataFeed() {}
+  virtual void Init(const paddle::framework::DataFeedDesc& data_feed_desc);
+  virtual bool CheckFile(const char* filename);
+
+ protected:
+  virtual void ReadThread();
+  virtual void AddInstanceToInsVec(MultiSlotBinaryRecord* ins_vec,
+                                   const MultiSlotBinaryRecord& instance,
+                                   int index);
+  virtual bool ParseOneInstance(MultiSlotBinaryRecord* instance);
+  virtual void PutToFeedVec(const MultiSlotBinaryRecord& ins_vec);
+
+ private:
+  // Map the file and check its header.
+  void OpenFile(const std::string& filename);
+
+  std::shared_ptr<memory::allocation::MmapAllocation> mapped_file_;
+  const char* pos_{nullptr};
+  const char* end_{nullptr};
+};
+
+// Convert the text data of MultiSlotDataFeed to the binary data of
+// MultiSlotBinaryDataFeed. Returns the number of instances.
+size_t ConvertMultiSlotTextToBinary(
+    const paddle::framework::DataFeedDesc& data_feed_desc,
+    const std::string& text_file, const std::string& binary_file);
 }  // namespace framework
 }  // namespace paddle
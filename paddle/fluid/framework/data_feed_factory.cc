@@ -60,5 +60,6 @@ std::shared_ptr<DataFeed> DataFeedFactory::CreateDataFeed(
 }
 
 REGISTER_DATAFEED_CLASS(MultiSlotDataFeed);
+REGISTER_DATAFEED_CLASS(MultiSlotBinaryDataFeed);
 }  // namespace framework
 }  // namespace paddle
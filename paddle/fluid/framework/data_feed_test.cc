@@ -124,10 +124,10 @@ class MultiTypeSet {
   std::set<float> float_set_;
 };
 
-void GetElemSetFromReader(std::vector<MultiTypeSet>* reader_elem_set,
-                          const paddle::framework::DataFeedDesc& data_feed_desc,
-                          const std::vector<std::string>& filelist,
-                          const int thread_num) {
+void GetElemSetFromReaders(
+    std::vector<MultiTypeSet>* reader_elem_set,
+    const paddle::framework::DataFeedDesc& data_feed_desc,
+    const std::vector<std::shared_ptr<paddle::framework::DataFeed>>& readers) {
   int used_slot_num = 0;
   for (auto i = 0; i < data_feed_desc.multi_slot_desc().slots_size(); ++i) {
     if (data_feed_desc.multi_slot_desc().slots(i).is_used()) {
@@ -135,15 +135,8 @@ void GetElemSetFromReader(std::vector<MultiTypeSet>* reader_elem_set,
     }
   }
   reader_elem_set->resize(used_slot_num);
+  int thread_num = readers.size();
   std::vector<std::thread> threads;
-  std::vector<std::shared_ptr<paddle::framework::DataFeed>> readers;
-  readers.resize(thread_num);
-  for (int i = 0; i < thread_num; ++i) {
-    readers[i] = paddle::framework::DataFeedFactory::CreateDataFeed(
-        data_feed_desc.name());
-    readers[i]->Init(data_feed_desc);
-  }
-  readers[0]->SetFileList(filelist);
   std::mutex mu;
   for (int idx = 0; idx < thread_num; ++idx) {
     threads.emplace_back(std::thread([&, idx] {
@@ -229,6 +222,21 @@ void GetElemSetFromReader(std::vector<MultiTypeSet>* reader_elem_set,
   }
 }
 
+void GetElemSetFromReader(std::vector<MultiTypeSet>* reader_elem_set,
+                          const paddle::framework::DataFeedDesc& data_feed_desc,
+                          const std::vector<std::string>& filelist,
+                          const int thread_num) {
+  std::vector<std::shared_ptr<paddle::framework::DataFeed>> readers;
+  readers.resize(thread_num);
+  for (int i = 0; i < thread_num; ++i) {
+    readers[i] = paddle::framework::DataFeedFactory::CreateDataFeed(
+        data_feed_desc.name());
+    readers[i]->Init(data_feed_desc);
+  }
+  readers[0]->SetFileList(filelist);
+  GetElemSetFromReaders(reader_elem_set, data_feed_desc, readers);
+}
+
 void CheckIsUnorderedSame(const std::vector<MultiTypeSet>& s1,
                           const std::vector<MultiTypeSet>& s2) {
   EXPECT_EQ(s1.size(), s2.size());
@@ -328,3 +336,133 @@ TEST(DataFeed, MultiSlotUnitTest) {
   GetElemSetFromFile(&file_elem_set, data_feed_desc, filelist);
   CheckIsUnorderedSame(reader_elem_set, file_elem_set);
 }
+
+TEST(DataFeed, MultiSlotBinaryUnitTest) {
+  const char* protofile = "data_feed_desc.prototxt";
+  const char* filelist_name = "filelist.txt";
+  GenerateFileForTest(protofile, filelist_name);
+  const std::vector<std::string> filelist =
+      load_filelist_from_file(filelist_name);
+  paddle::framework::DataFeedDesc data_feed_desc =
+      load_datafeed_param_from_file(protofile);
+  std::vector<std::string> binary_filelist;
+  for (const auto& file : filelist) {
+    binary_filelist.push_back(file + ".bin");
+    EXPECT_EQ(paddle::framework::ConvertMultiSlotTextToBinary(
+                  data_feed_desc, file, binary_filelist.back()),
+              3UL);
+  }
+  paddle::framework::DataFeedDesc binary_data_feed_desc = data_feed_desc;
+  binary_data_feed_desc.set_name("MultiSlotBinaryDataFeed");
+  std::vector<MultiTypeSet> reader_elem_set;
+  std::vector<MultiTypeSet> file_elem_set;
+  GetElemSetFromReader(&reader_elem_set, binary_data_feed_desc,
+                       binary_filelist, 4);
+  GetElemSetFromFile(&file_elem_set, data_feed_desc, filelist);
+  CheckIsUnorderedSame(reader_elem_set, file_elem_set);
+}
+
+TEST(DataFeed, MultiSlotInMemoryUnitTest) {
+  const char* protofile = "data_feed_desc.prototxt";
+  const char* filelist_name = "filelist.txt";
+  GenerateFileForTest(protofile, filelist_name);
+  const std::vector<std::string> filelist =
+      load_filelist_from_file(filelist_name);
+  paddle::framework::DataFeedDesc data_feed_desc =
+      load_datafeed_param_from_file(protofile);
+  std::vector<MultiTypeSet> file_elem_set;
+  GetElemSetFromFile(&file_elem_set, data_feed_desc, filelist);
+
+  paddle::framework::MultiSlotInMemoryData data;
+  data.Load(data_feed_desc, filelist, 2);
+  EXPECT_EQ(data.Size(), 12UL);
+  data.LocalShuffle(0);
+  std::vector<MultiTypeSet> reader_elem_set;
+  GetElemSetFromReaders(&reader_elem_set, data_feed_desc,
+                        data.CreateReaders(data_feed_desc, 2));
+  CheckIsUnorderedSame(reader_elem_set, file_elem_set);
+  // The next pass is served from memory too.
+  data.GlobalShuffle(1);
+  reader_elem_set.clear();
+  GetElemSetFromReaders(&reader_elem_set, data_feed_desc,
+                        data.CreateReaders(data_feed_desc, 3));
+  CheckIsUnorderedSame(reader_elem_set, file_elem_set);
+
+  // The trainers keep disjoint shares of the instances.
+  size_t instance_num = 0;
+  for (int trainer_id = 0; trainer_id < 2; ++trainer_id) {
+    paddle::framework::MultiSlotInMemoryData share;
+    share.Load(data_feed_desc, filelist, 2, trainer_id, 2);
+    instance_num += share.Size();
+  }
+  EXPECT_EQ(instance_num, 12UL);
+}
+
+// Read all the instances of filelist with one reader, and return the number
+// of instances read per second.
+double GetReaderThroughput(
+    const paddle::framework::DataFeedDesc& data_feed_desc,
+    const std::vector<std::string>& filelist) {
+  auto reader =
+      paddle::framework::DataFeedFactory::CreateDataFeed(data_feed_desc.name());
+  reader->Init(data_feed_desc);
+  reader->SetFileList(filelist);
+  paddle::framework::Scope scope;
+  for (const auto& slot : data_feed_desc.multi_slot_desc().slots()) {
+    if (slot.is_used()) {
+      reader->AddFeedVar(scope.Var(slot.name()), slot.name());
+    }
+  }
+  auto start = std::chrono::steady_clock::now();
+  reader->Start();
+  size_t instance_num = 0;
+  while (int batch_size = reader->Next()) {
+    instance_num += batch_size;
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return instance_num / elapsed.count();
+}
+
+TEST(DataFeed, MultiSlotThroughput) {
+  const char* protofile = "data_feed_desc.prototxt";
+  const char* filelist_name = "filelist.txt";
+  GenerateFileForTest(protofile, filelist_name);
+  paddle::framework::DataFeedDesc data_feed_desc =
+      load_datafeed_param_from_file(protofile);
+  data_feed_desc.set_batch_size(128);
+
+  // The slots of the instances have about 10 feasigns each.
+  const std::string text_file = "TestMultiSlotThroughput.data";
+  const int instance_num = 100000;
+  std::ofstream fout(text_file);
+  unsigned int seed = 0;
+  for (int i = 0; i < instance_num; ++i) {
+    for (const auto& slot : data_feed_desc.multi_slot_desc().slots()) {
+      int num = slot.is_dense() ? 10 : 1 + rand_r(&seed) % 20;
+      fout << num;
+      for (int j = 0; j < num; ++j) {
+        if (slot.type() == "float") {
+          fout << " " << rand_r(&seed) % 100000 / 1000.0;
+        } else {
+          fout << " " << rand_r(&seed) * 1000003ULL;
+        }
+      }
+      fout << " ";
+    }
+    fout << "\n";
+  }
+  fout.close();
+
+  double text_throughput = GetReaderThroughput(data_feed_desc, {text_file});
+  LOG(INFO) << "MultiSlotDataFeed: " << text_throughput << " instances/s";
+
+  const std::string binary_file = text_file + ".bin";
+  paddle::framework::ConvertMultiSlotTextToBinary(data_feed_desc, text_file,
+                                                  binary_file);
+  data_feed_desc.set_name("MultiSlotBinaryDataFeed");
+  double binary_throughput =
+      GetReaderThroughput(data_feed_desc, {binary_file});
+  LOG(INFO) << "MultiSlotBinaryDataFeed: " << binary_throughput
+            << " instances/s";
+}
@@ -30,24 +30,6 @@ DDim make_ddim(const std::vector<int>& dims) {
   return DDim(dims.data(), dims.size());
 }
 
-struct DDimEqualityVisitor {
-  explicit DDimEqualityVisitor(const int64_t* d) : d_(d) {}
-
-  template <int D>
-  inline bool operator()(const Dim<D>& self) const {
-    return UnrollCompare<D>::Run(self.Get(), d_);
-  }
-
-  const int64_t* d_;
-};
-
-bool DDim::operator==(const DDim& d) const {
-  return size() == d.size() &&
-         this->apply_visitor(DDimEqualityVisitor(d.Get()));
-}
-
-bool DDim::operator!=(const DDim& d) const { return !(*this == d); }
-
 struct DDimPlusVisitor {
   explicit DDimPlusVisitor(const int64_t* d1, const int64_t* d2)
       : d1_(d1), d2_(d2) {}
@@ -95,38 +77,13 @@ int64_t get(const DDim& ddim, int idx) { return ddim[idx]; }
 void set(DDim& ddim, int idx, int value) { ddim[idx] = value; }  // NOLINT
 
 std::vector<int64_t> vectorize(const DDim& ddim) {
-  std::vector<int64_t> result(DDim::kMaxRank);
-  dynamic_dim_assign(ddim.Get(), result.data(), ddim.size());
-  result.resize(ddim.size());
-  return result;
+  return std::vector<int64_t>(ddim.Get(), ddim.Get() + ddim.size());
 }
 
 // NOTE: framework::vectorize converts to type int64_t
 //       which does not fit cudnn inputs.
 std::vector<int> vectorize2int(const DDim& ddim) {
-  std::vector<int> result(DDim::kMaxRank);
-  dynamic_dim_assign(ddim.Get(), result.data(), ddim.size());
-  result.resize(ddim.size());
-  return result;
-}
-
-struct ProductVisitor {
-  template <int D>
-  inline int64_t operator()(const Dim<D>& dim) {
-    return product(dim);
-  }
-};
-
-int64_t product(const DDim& ddim) {
-  return ddim.apply_visitor(ProductVisitor());
-}
-
-DDim slice_ddim(const DDim& dim, int begin, int end) {
-  PADDLE_ENFORCE(begin >= 0 && end <= dim.size(),
-                 "[begin(%d), end(%d)) must be inside [0, %d) in ddim slice.",
-                 begin, end, dim.size());
-  // Constructor of DDim would check whether end - begin is valid
-  return DDim(dim.Get() + begin, end - begin);
+  return std::vector<int>(ddim.Get(), ddim.Get() + ddim.size());
 }
 
 int arity(const DDim& d) { return d.size(); }
@@ -146,13 +103,6 @@ std::ostream& operator<<(std::ostream& os, const DDim& ddim) {
   return os;
 }
 
-DDim flatten_to_2d(const DDim& src, int num_col_dims) {
-  return DDim({product(slice_ddim(src, 0, num_col_dims)),
-               product(slice_ddim(src, num_col_dims, src.size()))});
-}
-
-DDim flatten_to_1d(const DDim& src) { return DDim({product(src)}); }
-
 DDim stride(const DDim& ddim) {
   DDim strides;
   strides.rank_ = ddim.size();
@@ -14,6 +14,8 @@ limitations under the License. */
 
 #pragma once
 
+#include <algorithm>
+#include <cstring>
 #include <initializer_list>
 #include <stdexcept>
 #include <vector>
@@ -113,9 +115,11 @@ class DDim {
     PADDLE_VISIT_DDIM(rank_, visitor(UnsafeCast<kRank>()));
   }
 
-  bool operator==(const DDim& d) const;
+  inline bool operator==(const DDim& d) const {
+    return rank_ == d.rank_ && std::equal(Get(), Get() + rank_, d.Get());
+  }
 
-  bool operator!=(const DDim& d) const;
+  inline bool operator!=(const DDim& d) const { return !(*this == d); }
 
   DDim operator+(const DDim& d) const;
 
@@ -142,8 +146,12 @@ class DDim {
     return *reinterpret_cast<const Dim<D>*>(p);
   }
 
+  // The whole array is copied, a copy of a fixed size is cheaper than a
+  // switch on the rank.
   inline DDim& CopyFrom(const DDim& ddim) {
-    PADDLE_VISIT_DDIM(ddim.rank_, (*this = ddim.UnsafeCast<kRank>()));
+    std::memcpy(dim_.GetMutable(), ddim.dim_.Get(), sizeof(dim_));
+    rank_ = ddim.rank_;
+    return *this;
   }
 
   friend DDim stride(const DDim& ddim);
@@ -180,7 +188,16 @@ void set(DDim& dim, int idx, int val);  // NOLINT
 std::vector<int64_t> vectorize(const DDim& ddim);
 std::vector<int> vectorize2int(const DDim& ddim);
 
-int64_t product(const DDim& ddim);
+// The product of the dims in [begin, end) of ddim.
+inline int64_t product(const DDim& ddim, int begin, int end) {
+  int64_t p = 1;
+  for (int i = begin; i < end; ++i) p *= ddim[i];
+  return p;
+}
+
+inline int64_t product(const DDim& ddim) {
+  return product(ddim, 0, ddim.size());
+}
 
 /**
  * \brief Slice a ddim
@@ -189,7 +206,13 @@ int64_t product(const DDim& ddim);
  * e.g.  DDim d = make_ddim({1,2,3,4,5});
  *       slice_ddim(d, 1, 3); ====> {2,3}
  */
-DDim slice_ddim(const DDim& dim, int begin, int end);
+inline DDim slice_ddim(const DDim& dim, int begin, int end) {
+  PADDLE_ENFORCE(begin >= 0 && end <= dim.size(),
+                 "[begin(%d), end(%d)) must be inside [0, %d) in ddim slice.",
+                 begin, end, dim.size());
+  // Constructor of DDim would check whether end - begin is valid
+  return DDim(dim.Get() + begin, end - begin);
+}
 
 /**
  * \brief What is the length of this dimension?
@@ -203,9 +226,15 @@ std::ostream& operator<<(std::ostream&, const DDim&);
 
 // Reshape a tensor to a matrix. The matrix's first dimension(column length)
 // will be the product of tensor's first `num_col_dims` dimensions.
-DDim flatten_to_2d(const DDim& src, int num_col_dims);
+inline DDim flatten_to_2d(const DDim& src, int num_col_dims) {
+  PADDLE_ENFORCE(num_col_dims >= 0 && num_col_dims <= src.size(),
+                 "num_col_dims(%d) must be inside [0, %d] in flatten_to_2d.",
+                 num_col_dims, src.size());
+  return DDim({product(src, 0, num_col_dims),
+               product(src, num_col_dims, src.size())});
+}
 
-DDim flatten_to_1d(const DDim& src);
+inline DDim flatten_to_1d(const DDim& src) { return DDim({product(src)}); }
 
 DDim stride(const DDim& ddim);
 
@@ -88,6 +88,30 @@ TEST(DDim, Equality) {
   EXPECT_EQ(ss2[5], 6);
 }
 
+TEST(DDim, Flatten) {
+  paddle::framework::DDim ddim = paddle::framework::make_ddim({2, 3, 4, 5});
+  EXPECT_EQ(paddle::framework::product(ddim, 1, 3), 12);
+  EXPECT_EQ(paddle::framework::flatten_to_2d(ddim, 2),
+            paddle::framework::make_ddim({6, 20}));
+  EXPECT_EQ(paddle::framework::flatten_to_2d(ddim, 0),
+            paddle::framework::make_ddim({1, 120}));
+  EXPECT_EQ(paddle::framework::flatten_to_1d(ddim),
+            paddle::framework::make_ddim({120}));
+  EXPECT_THROW(paddle::framework::flatten_to_2d(ddim, 5),
+               paddle::platform::EnforceNotMet);
+
+  // A copy of a smaller rank keeps neither the rank nor the dims of before.
+  paddle::framework::DDim copy = ddim;
+  copy = paddle::framework::make_ddim({7});
+  EXPECT_EQ(copy.size(), 1);
+  EXPECT_EQ(copy, paddle::framework::make_ddim({7}));
+  EXPECT_NE(copy, ddim);
+  EXPECT_EQ(paddle::framework::vectorize(ddim),
+            std::vector<int64_t>({2, 3, 4, 5}));
+  EXPECT_EQ(paddle::framework::vectorize2int(ddim),
+            std::vector<int>({2, 3, 4, 5}));
+}
+
 TEST(DDim, Print) {
   // print a DDim
   std::stringstream ss;
@@ -67,7 +67,10 @@ std::unique_ptr<ir::Graph> AllReduceDepsPass::ApplyImpl(
   // get allreduce ops.
   for (auto& op : graph_ops) {
     // FIXME(gongwb):add broad cast.
-    if (op->Name() == "all_reduce" || op->Name() == "reduce") {
+    // NOTE: a fused_all_reduce is ordered by its first gradient, which is
+    // the earliest generated one in the bucket.
+    if (op->Name() == "all_reduce" || op->Name() == "fused_all_reduce" ||
+        op->Name() == "reduce") {
       dist_ops.push_back(op);
     }
   }
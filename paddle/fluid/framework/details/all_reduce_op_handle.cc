@@ -14,9 +14,11 @@
 #include <algorithm>
 
 #include "paddle/fluid/framework/details/all_reduce_op_handle.h"
+#include "paddle/fluid/framework/data_type_transform.h"
 #include "paddle/fluid/framework/details/container_cast.h"
 #include "paddle/fluid/framework/details/reduce_and_gather.h"
 #include "paddle/fluid/framework/details/variable_visitor.h"
+#include "paddle/fluid/framework/var_name_allowlist.h"
 #include "paddle/fluid/platform/profiler.h"
 
 // asynchronous nccl allreduce or synchronous issue:
@@ -25,6 +27,12 @@ DEFINE_bool(
     sync_nccl_allreduce, false,
     "If set true, will call `cudaStreamSynchronize(nccl_stream)`"
     "after allreduce, this mode can get better performance in some scenarios.");
+DEFINE_string(allreduce_fp16_compress_vars, "",
+              "Comma separated names of the FP32 gradients that are cast to "
+              "FP16 before being allreduced by NCCL and cast back after it, "
+              "'*' means all the FP32 gradients. It halves the bytes sent at "
+              "the cost of precision, and the sum may overflow FP16 if the "
+              "gradients are not small.");
 
 namespace paddle {
 namespace framework {
@@ -79,46 +87,36 @@ void AllReduceOpHandle::RunImpl() {
   if (platform::is_gpu_place(lod_tensors[0]->place())) {
 #if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
     PADDLE_ENFORCE(nccl_ctxs_, "nccl_ctxs should not be nullptr.");
-    int dtype = -1;
-    size_t numel = 0;
-    std::vector<std::function<void()>> all_reduce_calls;
-    for (size_t i = 0; i < local_scopes_.size(); ++i) {
-      auto &p = places_[i];
-      auto &lod_tensor = *lod_tensors[i];
-      void *buffer = const_cast<void *>(lod_tensor.data<void>());
-
-      if (dtype == -1) {
-        dtype = platform::ToNCCLDataType(lod_tensor.type());
-      }
-
-      if (numel == 0) {
-        numel = static_cast<size_t>(lod_tensor.numel());
+    static VarNameAllowlist fp16_allowlist(FLAGS_allreduce_fp16_compress_vars);
+    bool fp16_compress = lod_tensors[0]->type() == proto::VarType::FP32 &&
+                         fp16_allowlist.Contains(in_var_handles[0]->name_);
+
+    // The FP16 copies are only touched by NCCL, they are released after the
+    // NCCL streams are synchronized below.
+    std::vector<LoDTensor> fp16_tensors(fp16_compress ? lod_tensors.size() : 0);
+    auto type = fp16_compress ? proto::VarType::FP16 : lod_tensors[0]->type();
+    int dtype = platform::ToNCCLDataType(type);
+    size_t numel = static_cast<size_t>(lod_tensors[0]->numel());
+    std::vector<void *> buffers;
+    for (size_t i = 0; i < lod_tensors.size(); ++i) {
+      if (fp16_compress) {
+        CastTensor(*lod_tensors[i], proto::VarType::FP16, &fp16_tensors[i]);
+        buffers.emplace_back(fp16_tensors[i].data<void>());
+      } else {
+        buffers.emplace_back(const_cast<void *>(lod_tensors[i]->data<void>()));
       }
-
-      int dev_id = boost::get<platform::CUDAPlace>(p).device;
-      auto &nccl_ctx = nccl_ctxs_->at(dev_id);
-      auto stream = nccl_ctx.stream();
-      auto comm = nccl_ctx.comm_;
-      all_reduce_calls.emplace_back([=] {
-        PADDLE_ENFORCE(platform::dynload::ncclAllReduce(
-            buffer, buffer, numel, static_cast<ncclDataType_t>(dtype), ncclSum,
-            comm, stream));
-      });
     }
 
-    this->RunAndRecordEvent([&] {
-      if (all_reduce_calls.size() == 1UL) {
-        // Do not use NCCLGroup when manage NCCL by per thread per device
-        all_reduce_calls[0]();
-      } else {
-        platform::NCCLGroupGuard guard;
-        for (auto &call : all_reduce_calls) {
-          call();
-        }
-      }
-    });
+    // Hierarchical allreduce splits the tensor evenly between the local
+    // devices, so fall back to the flat ring if it is not divisible.
+    if (nccl_ctxs_->UseHierarchicalAllReduce() &&
+        numel % nccl_ctxs_->contexts_.size() == 0) {
+      HierarchicalAllReduce(buffers, numel, dtype, SizeOfType(type));
+    } else {
+      FlatAllReduce(buffers, numel, dtype);
+    }
 
-    if (FLAGS_sync_nccl_allreduce) {
+    if (FLAGS_sync_nccl_allreduce || fp16_compress) {
       for (auto &p : places_) {
         int dev_id = boost::get<platform::CUDAPlace>(p).device;
         auto &nccl_ctx = nccl_ctxs_->at(dev_id);
@@ -127,6 +125,11 @@ void AllReduceOpHandle::RunImpl() {
       }
     }
 
+    for (size_t i = 0; i < fp16_tensors.size(); ++i) {
+      CastTensor(fp16_tensors[i], proto::VarType::FP32,
+                 const_cast<LoDTensor *>(lod_tensors[i]));
+    }
+
 #else
     PADDLE_THROW("Not compiled with CUDA");
 #endif
@@ -157,6 +160,90 @@ void AllReduceOpHandle::RunImpl() {
   }
 }
 
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+void AllReduceOpHandle::CastTensor(const LoDTensor &in,
+                                   proto::VarType::Type dst_type,
+                                   LoDTensor *out) {
+  // TransDataType waits for the device context of the place, which is the
+  // one the gradients are generated on.
+  TransDataType(OpKernelType(in.type(), in.place()),
+                OpKernelType(dst_type, in.place()), in, out);
+}
+
+void AllReduceOpHandle::RunNCCLCalls(
+    const std::vector<std::function<void()>> &calls) {
+  if (calls.size() == 1UL) {
+    // Do not use NCCLGroup when manage NCCL by per thread per device
+    calls[0]();
+  } else {
+    platform::NCCLGroupGuard guard;
+    for (auto &call : calls) {
+      call();
+    }
+  }
+}
+
+void AllReduceOpHandle::FlatAllReduce(const std::vector<void *> &buffers,
+                                      size_t numel, int dtype) {
+  std::vector<std::function<void()>> all_reduce_calls;
+  for (size_t i = 0; i < places_.size(); ++i) {
+    void *buffer = buffers[i];
+    auto &nccl_ctx = nccl_ctxs_->at(places_[i]);
+    auto stream = nccl_ctx.stream();
+    auto comm = nccl_ctx.comm_;
+    all_reduce_calls.emplace_back([=] {
+      PADDLE_ENFORCE(platform::dynload::ncclAllReduce(
+          buffer, buffer, numel, static_cast<ncclDataType_t>(dtype), ncclSum,
+          comm, stream));
+    });
+  }
+
+  this->RunAndRecordEvent([&] { RunNCCLCalls(all_reduce_calls); });
+}
+
+// Reduce-scatter inside the node, so that each local device owns the sum of
+// one 1/nlocal slice, allreduce that slice across the nodes with the devices
+// of the same local rank, and finally all-gather the slices inside the node.
+// Only 1/nlocal of the tensor goes through the slow inter-node links.
+void AllReduceOpHandle::HierarchicalAllReduce(
+    const std::vector<void *> &buffers, size_t numel, int dtype,
+    size_t elem_size) {
+  size_t chunk = numel / nccl_ctxs_->contexts_.size();
+  auto nccl_dtype = static_cast<ncclDataType_t>(dtype);
+
+  std::vector<std::function<void()>> reduce_scatter_calls;
+  std::vector<std::function<void()>> inter_all_reduce_calls;
+  std::vector<std::function<void()>> all_gather_calls;
+  for (size_t i = 0; i < places_.size(); ++i) {
+    auto &nccl_ctx = nccl_ctxs_->at(places_[i]);
+    auto stream = nccl_ctx.stream();
+    auto local_comm = nccl_ctx.local_comm_;
+    auto inter_comm = nccl_ctx.inter_comm_;
+    auto *base = static_cast<uint8_t *>(buffers[i]);
+    auto *slice = base + nccl_ctx.local_rank_ * chunk * elem_size;
+
+    reduce_scatter_calls.emplace_back([=] {
+      PADDLE_ENFORCE(platform::dynload::ncclReduceScatter(
+          base, slice, chunk, nccl_dtype, ncclSum, local_comm, stream));
+    });
+    inter_all_reduce_calls.emplace_back([=] {
+      PADDLE_ENFORCE(platform::dynload::ncclAllReduce(
+          slice, slice, chunk, nccl_dtype, ncclSum, inter_comm, stream));
+    });
+    all_gather_calls.emplace_back([=] {
+      PADDLE_ENFORCE(platform::dynload::ncclAllGather(
+          slice, base, chunk, nccl_dtype, local_comm, stream));
+    });
+  }
+
+  this->RunAndRecordEvent([&] {
+    RunNCCLCalls(reduce_scatter_calls);
+    RunNCCLCalls(inter_all_reduce_calls);
+    RunNCCLCalls(all_gather_calls);
+  });
+}
+#endif
+
 std::string AllReduceOpHandle::Name() const { return "all_reduce"; }
 }  // namespace details
 }  // namespace framework
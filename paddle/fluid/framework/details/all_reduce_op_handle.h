@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -47,6 +48,19 @@ struct AllReduceOpHandle : public OpHandleBase {
   void RunImpl() override;
 
  private:
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+  void CastTensor(const LoDTensor &in, proto::VarType::Type dst_type,
+                  LoDTensor *out);
+
+  void RunNCCLCalls(const std::vector<std::function<void()>> &calls);
+
+  void FlatAllReduce(const std::vector<void *> &buffers, size_t numel,
+                     int dtype);
+
+  void HierarchicalAllReduce(const std::vector<void *> &buffers, size_t numel,
+                             int dtype, size_t elem_size);
+#endif
+
   std::vector<Scope *> local_scopes_;
   std::vector<platform::Place> places_;
 #if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
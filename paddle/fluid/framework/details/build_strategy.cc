@@ -20,11 +20,15 @@ limitations under the License. */
 #include "paddle/fluid/framework/details/memory_reuse_types.h"
 #include "paddle/fluid/framework/details/multi_devices_graph_pass.h"
 #include "paddle/fluid/framework/details/multi_devices_graph_print_pass.h"
+#include "paddle/fluid/framework/details/multi_stream_pass.h"
 #include "paddle/fluid/framework/details/reduce_op_handle.h"
 #include "paddle/fluid/framework/details/sequential_execution_pass.h"
 #include "paddle/fluid/framework/ir/graph.h"
 #include "paddle/fluid/framework/ir/graph_helper.h"
 #include "paddle/fluid/framework/ir/graph_viz_pass.h"
+#include "paddle/fluid/framework/ir/inplace_op_pass.h"
+#include "paddle/fluid/framework/ir/mixed_precision_pass.h"
+#include "paddle/fluid/framework/ir/recompute_pass.h"
 
 namespace paddle {
 namespace framework {
@@ -67,6 +71,37 @@ class ParallelExecutorPassBuilder : public ir::PassBuilder {
       }
     }
 
+    if (strategy.sync_batch_norm_) {
+      AppendPass("sync_batch_norm_pass");
+    }
+
+    if (strategy.fuse_fake_quantize_dequantize_ops_) {
+      AppendPass("fuse_fake_quantize_dequantize_pass");
+    }
+
+    // Every device should see the same overflows of the all-reduced
+    // gradients, and the optimizer ops of the trainers.
+    if (strategy.enable_mixed_precision_) {
+      if (strategy.reduce_ == BuildStrategy::ReduceStrategy::kAllReduce &&
+          !strategy.is_distribution_) {
+        AppendPass("mixed_precision_pass");
+      } else {
+        LOG(WARNING) << "enable_mixed_precision only works with AllReduce "
+                        "and the collective mode, skip mixed_precision_pass.";
+      }
+    }
+
+    // The Reduce mode places each optimizer op on the device of its
+    // parameter, so the ops can't be fused.
+    if (strategy.fuse_optimizer_ops_) {
+      if (strategy.reduce_ == BuildStrategy::ReduceStrategy::kAllReduce) {
+        AppendPass("fuse_optimizer_ops_pass");
+      } else {
+        LOG(WARNING) << "fuse_optimizer_ops only works with AllReduce, "
+                        "skip fuse_optimizer_ops_pass.";
+      }
+    }
+
     CollectiveContext *context = CollectiveContext::GetInstance();
     context->endpoints_ = strategy_.trainers_endpoints_;
     context->trainer_id_ = strategy_.trainer_id_;
@@ -83,6 +118,16 @@ class ParallelExecutorPassBuilder : public ir::PassBuilder {
     // the de-fact IR, any reuse on Graph is meaningless.
     // A side-effect of that, memory optimize cannot forsee the fetched vars
     // , so fetchlist should be set persistable before call the Run interface.
+    if (!strategy.recompute_checkpoints_.empty()) {
+      AppendPass("recompute_pass");
+    }
+
+    // The inplace pass renames vars, so it should be before the
+    // analysis_var_pass which collects the lifetime of the vars.
+    if (strategy.enable_inplace_) {
+      AppendPass("inplace_op_pass");
+    }
+
     if (strategy.memory_optimize_) {
       auto analysis_var_pass = AppendPass("analysis_var_pass");
     }
@@ -104,13 +149,30 @@ class ParallelExecutorPassBuilder : public ir::PassBuilder {
     // Verify that the graph is correct for multi-device executor.
     AppendPass("multi_devices_check_pass");
 
+    if (strategy_.swap_activations_) {
+      AppendPass("swap_activation_pass");
+    }
+
     if (SeqOnlyAllReduceOps(strategy)) {
       AppendPass("all_reduce_deps_pass");
     }
 
+    // The op handles that can skip the events depend on their streams, so
+    // this pass should be before modify_op_lock_and_record_event_pass.
+    if (strategy_.num_streams_ > 1) {
+      AppendPass("multi_stream_pass")
+          ->Set<size_t>(kNumStreams, new size_t(strategy_.num_streams_));
+    }
+
     if (strategy_.remove_unnecessary_lock_) {
       AppendPass("modify_op_lock_and_record_event_pass");
     }
+
+    // The priorities depend on the final dependencies between ops, so this
+    // pass should be after all the passes that change them.
+    if (strategy_.enable_priority_scheduling_) {
+      AppendPass("op_priority_pass");
+    }
   }
 
   // Convert graph to run on multi-devices.
@@ -194,6 +256,24 @@ std::unique_ptr<ir::Graph> BuildStrategy::Apply(
       pass->Erase(kAllOpDescs);
       pass->SetNotOwned<const std::vector<OpDesc *>>(kAllOpDescs, all_op_descs);
 
+    } else if (pass->Type() == "recompute_pass") {
+      pass->Erase(ir::kRecomputeCheckpoints);
+      pass->SetNotOwned<const std::vector<std::string>>(
+          ir::kRecomputeCheckpoints, &recompute_checkpoints_);
+    } else if (pass->Type() == "mixed_precision_pass") {
+      PADDLE_ENFORCE(use_cuda, "The mixed precision training needs GPU.");
+      pass->Erase(ir::kMixedPrecisionInitLossScaling);
+      pass->Set<float>(ir::kMixedPrecisionInitLossScaling,
+                       new float(init_loss_scaling_));
+      pass->Erase(ir::kMixedPrecisionDynamicLossScaling);
+      pass->Set<bool>(ir::kMixedPrecisionDynamicLossScaling,
+                      new bool(use_dynamic_loss_scaling_));
+    } else if (pass->Type() == "sync_batch_norm_pass") {
+      PADDLE_ENFORCE(use_cuda, "sync_batch_norm needs GPU.");
+    } else if (pass->Type() == "inplace_op_pass") {
+      pass->Erase(ir::kInplaceSkipVars);
+      pass->Set<std::vector<std::string>>(
+          ir::kInplaceSkipVars, new std::vector<std::string>({loss_var_name}));
     } else if (pass->Type() == "sequential_execution_pass") {
       LOG(INFO) << "set enable_sequential_execution:"
                 << enable_sequential_execution_;
@@ -221,6 +301,10 @@ std::unique_ptr<ir::Graph> BuildStrategy::Apply(
 }  // namespace paddle
 
 USE_PASS(fuse_elewise_add_act_pass);
+USE_PASS(fuse_optimizer_ops_pass);
+USE_PASS(mixed_precision_pass);
+USE_PASS(sync_batch_norm_pass);
+USE_PASS(fuse_fake_quantize_dequantize_pass);
 USE_PASS(graph_viz_pass);
 USE_PASS(multi_batch_merge_pass);
 USE_PASS(reduce_mode_multi_devices_pass);
@@ -229,7 +313,12 @@ USE_PASS(dist_multi_devices_pass);
 USE_PASS(multi_devices_check_pass);
 USE_PASS(multi_devices_print_pass);
 USE_PASS(analysis_var_pass);
+USE_PASS(inplace_op_pass);
+USE_PASS(recompute_pass);
+USE_PASS(swap_activation_pass);
 USE_PASS(sequential_execution_pass);
 USE_PASS(all_reduce_deps_pass);
 USE_PASS(modify_op_lock_and_record_event_pass);
 USE_PASS(lock_free_optimize_pass);
+USE_PASS(op_priority_pass);
+USE_PASS(multi_stream_pass);
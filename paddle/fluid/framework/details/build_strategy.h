@@ -74,14 +74,69 @@ struct BuildStrategy {
 
   bool fuse_elewise_add_act_ops_{false};
 
+  // Only works with ReduceStrategy::kAllReduce. Fuse the adam and momentum
+  // ops with dense gradients into fused_adam and fused_momentum ops, which
+  // update all their parameters in a few kernel launches.
+  bool fuse_optimizer_ops_{false};
+
+  // Only works on GPU with ReduceStrategy::kAllReduce. Run mul, matmul and
+  // the cudnn conv2d and their grad ops in float16 on the Tensor Cores, with
+  // the float32 master weights and the loss scaling starting from
+  // init_loss_scaling_. The steps whose gradients overflow do not update the
+  // parameters, and decrease the loss scaling if use_dynamic_loss_scaling_.
+  bool enable_mixed_precision_{false};
+  float init_loss_scaling_{32768.0f};
+  bool use_dynamic_loss_scaling_{true};
+
   bool memory_optimize_{false};
 
   bool memory_early_delete_{false};
 
+  // The checkpoint vars of recomputation. If not empty, the forward vars
+  // between the checkpoints are recomputed before the backward ops using
+  // them, instead of being kept alive from the forward pass. It saves memory
+  // with the eager deletion or memory_optimize_.
+  std::vector<std::string> recompute_checkpoints_;
+
+  // Let the ops registered with InplaceOpInference, e.g., the activations,
+  // write their outputs into the buffers of their inputs when the inputs are
+  // not used by any other op. The fetched vars except the loss should be set
+  // persistable, as with memory_optimize_.
+  bool enable_inplace_{false};
+
+  // Swap the activations used by the backward ops out to the pinned host
+  // memory after the forward ops, and back in before the backward ops. Only
+  // works on GPU. The fetched vars except the loss should be set persistable.
+  bool swap_activations_{false};
+
+  // Only works on GPU. Replace the batch_norm ops of training by
+  // sync_batch_norm, whose statistics are the ones of the mini-batches of all
+  // the devices of the trainer instead of each device.
+  bool sync_batch_norm_{false};
+
+  // Fuse the fake_quantize_abs_max and fake_dequantize_max_abs pairs of the
+  // quantization-aware training into fake_quantize_dequantize_abs_max ops.
+  bool fuse_fake_quantize_dequantize_ops_{false};
+
   bool enable_sequential_execution_{false};
 
   bool fuse_broadcast_op_{false};
 
+  // Only works with ReduceStrategy::kAllReduce. Group the dense gradients
+  // into buckets of about fuse_all_reduce_bucket_size_mb_ MB in the order
+  // they are generated, and all-reduce each bucket once with a contiguous
+  // buffer.
+  bool fuse_all_reduce_ops_{false};
+  size_t fuse_all_reduce_bucket_size_mb_{32};
+
+  // Schedule the ready ops by the longest path from them to the end of the
+  // graph, with the communication ops weighted up.
+  bool enable_priority_scheduling_{false};
+
+  // Only works on GPU. Run the independent computation ops of each device on
+  // num_streams_ streams, see multi_stream_pass.
+  size_t num_streams_{1};
+
   // FIXME(zcd): is_distribution_ is a temporary field, because in pserver mode,
   // num_trainers is 1, so the current fields of build_strategy doesn't tell if
   // it's distributed model.
@@ -89,8 +144,18 @@ struct BuildStrategy {
   int num_trainers_{1};
   int trainer_id_{0};
   std::vector<std::string> trainers_endpoints_;
+  // Only works with num_trainers_ > 1 in nccl2 mode. Allreduce inside each
+  // node first and only send 1/num_devices of every gradient across the nodes.
+  // Needs the inter-node NCCL ids generated by gen_nccl_id.
+  bool use_hierarchical_allreduce_{false};
   bool remove_unnecessary_lock_{false};
 
+  // Only works on CPU. Every place runs its own copy of the graph on the
+  // batches it reads, without the collective ops, and applies its updates
+  // to the parameters shared by all the places directly, without waiting
+  // for the others (Hogwild!).
+  bool async_mode_{false};
+
   // NOTE:
   // Before you add new options, think if it's a general strategy that works
   // with other strategy. If not, the strategy should be created through
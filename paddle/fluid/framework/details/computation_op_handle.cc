@@ -14,19 +14,27 @@
 
 #include "paddle/fluid/framework/details/computation_op_handle.h"
 
+#include <memory>
 #include <string>
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/fluid/memory/allocation/stream_safe_cuda_allocator.h"
+#endif
 
 namespace paddle {
 namespace framework {
 namespace details {
 ComputationOpHandle::ComputationOpHandle(ir::Node *node, Scope *scope,
                                          platform::Place place,
-                                         size_t scope_idx)
-    : OpHandleBase(node),
-      op_(framework::OpRegistry::CreateOp(*node->Op())),
-      scope_(scope),
-      place_(place),
-      scope_idx_(scope_idx) {}
+                                         size_t scope_idx, bool create_op)
+    : OpHandleBase(node), scope_(scope), place_(place), scope_idx_(scope_idx) {
+  if (create_op) {
+    CreateOp();
+  }
+}
+
+void ComputationOpHandle::CreateOp() {
+  op_ = framework::OpRegistry::CreateOp(*node_->Op());
+}
 
 void ComputationOpHandle::RunImpl() {
   WaitInputVarGenerated(place_);
@@ -35,11 +43,31 @@ void ComputationOpHandle::RunImpl() {
     op_->Run(*scope_->FindVar(kLocalExecScopeName)->Get<Scope *>(), place_);
   };
 
+#ifdef PADDLE_WITH_CUDA
+  // The op runs and allocates on the stream assigned by multi_stream_pass,
+  // if it is not the one of the pool.
+  std::unique_ptr<platform::DeviceContextGuard> ctx_guard;
+  std::unique_ptr<memory::allocation::CUDAAllocationStreamGuard>
+      allocation_guard;
+  auto *dev_ctx = dev_ctxes_.at(place_);
+  if (platform::is_gpu_place(place_) &&
+      dev_ctx !=
+          platform::DeviceContextPool::Instance().GetStreamContext(place_, 0)) {
+    ctx_guard.reset(new platform::DeviceContextGuard(dev_ctx));
+    allocation_guard.reset(new memory::allocation::CUDAAllocationStreamGuard(
+        static_cast<platform::CUDADeviceContext *>(dev_ctx)->stream()));
+  }
+#endif
+
   if (is_lock_and_record_event_free_) {
     run_func();
   } else {
     this->RunAndRecordEvent(run_func);
   }
+
+  if (eager_deletion_callback_) {
+    eager_deletion_callback_();
+  }
 }
 
 bool ComputationOpHandle::NeedWait(VarHandleBase *in_var) {
@@ -49,7 +77,9 @@ bool ComputationOpHandle::NeedWait(VarHandleBase *in_var) {
   return need_wait;
 }
 
-std::string ComputationOpHandle::Name() const { return op_->Type(); }
+std::string ComputationOpHandle::Name() const {
+  return op_ ? op_->Type() : node_->Op()->Type();
+}
 }  // namespace details
 }  // namespace framework
 }  // namespace paddle
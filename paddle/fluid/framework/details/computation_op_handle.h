@@ -14,7 +14,9 @@
 
 #pragma once
 
+#include <functional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "paddle/fluid/framework/details/op_handle_base.h"
@@ -28,8 +30,13 @@ namespace framework {
 namespace details {
 struct ComputationOpHandle : public OpHandleBase {
  public:
+  // The operator is created later by CreateOp if create_op is false, e.g.
+  // the multi-device graph builder creates the operators of all the devices
+  // in parallel.
   ComputationOpHandle(ir::Node *node, Scope *scope, platform::Place place,
-                      size_t scope_idx);
+                      size_t scope_idx, bool create_op = true);
+
+  void CreateOp();
 
   std::string Name() const override;
 
@@ -41,6 +48,12 @@ struct ComputationOpHandle : public OpHandleBase {
 
   size_t GetScopeIdx() const { return scope_idx_; }
 
+  // Run after the op, to free the variables it reads last in the inline
+  // eager deletion mode, see eager_deletion_pass.
+  void SetEagerDeletionCallback(std::function<void()> callback) {
+    eager_deletion_callback_ = std::move(callback);
+  }
+
  protected:
   void RunImpl() override;
 
@@ -52,6 +65,7 @@ struct ComputationOpHandle : public OpHandleBase {
   platform::Place place_;
   size_t scope_idx_;
   bool is_lock_and_record_event_free_{false};
+  std::function<void()> eager_deletion_callback_;
 };
 }  // namespace details
 }  // namespace framework
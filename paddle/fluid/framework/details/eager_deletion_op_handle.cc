@@ -16,50 +16,25 @@
 #include "paddle/fluid/framework/lod_tensor_array.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/framework/selected_rows.h"
-#ifdef PADDLE_WITH_CUDA
-#include "paddle/fluid/platform/cuda_device_guard.h"
-#endif
 
 namespace paddle {
 namespace framework {
 namespace details {
 
-EagerDeletionOpHandle::EagerDeletionOpHandle(
-    ir::Node *node, const Scope *scope, const platform::Place &place,
-    const std::unordered_set<std::string> &var_names, GarbageCollector *gc,
-    AtomicReferenceCountMap *ref_cnts)
-    : OpHandleBase(node),
-      scope_(scope),
-      var_names_(var_names),
-      gc_(gc),
-      ref_cnts_(ref_cnts) {
+EagerDeleter::EagerDeleter(const Scope *scope, const platform::Place &place,
+                           const std::unordered_set<std::string> &var_names,
+                           GarbageCollector *gc,
+                           AtomicReferenceCountMap *ref_cnts)
+    : scope_(scope), var_names_(var_names), gc_(gc), ref_cnts_(ref_cnts) {
 #ifdef PADDLE_WITH_CUDA
   if (platform::is_gpu_place(place)) {
     dev_ctx_ = reinterpret_cast<platform::CUDADeviceContext *>(
         platform::DeviceContextPool::Instance().Get(place));
-    if (dynamic_cast<StreamGarbageCollector *>(gc_)) {
-      platform::CUDADeviceGuard guard(
-          boost::get<platform::CUDAPlace>(place).device);
-      PADDLE_ENFORCE(cudaEventCreateWithFlags(&event_, cudaEventDisableTiming));
-      PADDLE_ENFORCE_NOT_NULL(event_);
-    }
-  }
-#endif
-}
-
-EagerDeletionOpHandle::~EagerDeletionOpHandle() {
-#ifdef PADDLE_WITH_CUDA
-  if (event_) {
-    auto gpu_place = boost::get<platform::CUDAPlace>(dev_ctx_->GetPlace());
-    platform::CUDADeviceGuard guard(gpu_place.device);
-    PADDLE_ENFORCE(cudaEventDestroy(event_));
   }
 #endif
 }
 
-std::string EagerDeletionOpHandle::Name() const { return "eager_deletion"; }
-
-void EagerDeletionOpHandle::RunImpl() {
+void EagerDeleter::Run() {
   auto *exec_scope = scope_->FindVar(kLocalExecScopeName)->Get<Scope *>();
   std::deque<std::shared_ptr<memory::Allocation>> garbages;
   for (auto &name : var_names_) {
@@ -97,16 +72,17 @@ void EagerDeletionOpHandle::RunImpl() {
   }
 }
 
-void EagerDeletionOpHandle::ClearGarbages(
+void EagerDeleter::ClearGarbages(
     std::deque<std::shared_ptr<memory::Allocation>> *garbages) {
 #ifdef PADDLE_WITH_CUDA
-  if (event_) {
+  auto *stream_gc = dynamic_cast<StreamGarbageCollector *>(gc_);
+  if (dev_ctx_ && stream_gc) {
+    // Only called when a batch of the garbages is cleared.
     auto compute_stream = dev_ctx_->stream();
-    auto callback_stream =
-        reinterpret_cast<StreamGarbageCollector *>(gc_)->stream();
     auto callback_func = [=]() {
-      PADDLE_ENFORCE(cudaEventRecord(event_, compute_stream));
-      PADDLE_ENFORCE(cudaStreamWaitEvent(callback_stream, event_, 0));
+      PADDLE_ENFORCE(cudaEventRecord(stream_gc->event(), compute_stream));
+      PADDLE_ENFORCE(
+          cudaStreamWaitEvent(stream_gc->stream(), stream_gc->event(), 0));
     };
     gc_->Add(std::move(*garbages), callback_func);
   } else {
@@ -117,6 +93,16 @@ void EagerDeletionOpHandle::ClearGarbages(
 #endif
 }
 
+EagerDeletionOpHandle::EagerDeletionOpHandle(
+    ir::Node *node, const Scope *scope, const platform::Place &place,
+    const std::unordered_set<std::string> &var_names, GarbageCollector *gc,
+    AtomicReferenceCountMap *ref_cnts)
+    : OpHandleBase(node), deleter_(scope, place, var_names, gc, ref_cnts) {}
+
+std::string EagerDeletionOpHandle::Name() const { return "eager_deletion"; }
+
+void EagerDeletionOpHandle::RunImpl() { deleter_.Run(); }
+
 }  // namespace details
 }  // namespace framework
 }  // namespace paddle
@@ -15,7 +15,9 @@
 #pragma once
 
 #include <deque>
+#include <memory>
 #include <string>
+#include <unordered_set>
 #include "paddle/fluid/framework/details/op_handle_base.h"
 #include "paddle/fluid/framework/details/reference_count_pass_helper.h"
 
@@ -25,6 +27,30 @@ class Scope;
 
 namespace details {
 
+// Free the variables whose reference counts drop to 0, i.e. whose last
+// readers have run. It is run by an EagerDeletionOpHandle after the last
+// readers, or by the last reader itself in the inline eager deletion mode,
+// see eager_deletion_pass.
+class EagerDeleter {
+ public:
+  EagerDeleter(const Scope *scope, const platform::Place &place,
+               const std::unordered_set<std::string> &var_names,
+               GarbageCollector *gc, AtomicReferenceCountMap *ref_cnts);
+
+  void Run();
+
+ private:
+  void ClearGarbages(std::deque<std::shared_ptr<memory::Allocation>> *garbages);
+
+  const Scope *scope_;
+  std::unordered_set<std::string> var_names_;
+  GarbageCollector *gc_;               // not own
+  AtomicReferenceCountMap *ref_cnts_;  // not own
+#ifdef PADDLE_WITH_CUDA
+  platform::CUDADeviceContext *dev_ctx_{nullptr};
+#endif
+};
+
 class EagerDeletionOpHandle : public OpHandleBase {
  public:
   EagerDeletionOpHandle(ir::Node *node, const Scope *scope,
@@ -33,24 +59,13 @@ class EagerDeletionOpHandle : public OpHandleBase {
                         GarbageCollector *gc,
                         AtomicReferenceCountMap *ref_cnts);
 
-  ~EagerDeletionOpHandle();
-
   std::string Name() const override;
 
  protected:
   void RunImpl() override;
 
  private:
-  void ClearGarbages(std::deque<std::shared_ptr<memory::Allocation>> *garbages);
-
-  const Scope *scope_;
-  std::unordered_set<std::string> var_names_;
-  GarbageCollector *gc_;               // not own
-  AtomicReferenceCountMap *ref_cnts_;  // not own
-#ifdef PADDLE_WITH_CUDA
-  platform::CUDADeviceContext *dev_ctx_{nullptr};
-  cudaEvent_t event_{nullptr};
-#endif
+  EagerDeleter deleter_;
 };
 
 }  // namespace details
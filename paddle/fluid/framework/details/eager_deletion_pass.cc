@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
 #include <queue>
 #include <string>
 #include <vector>
@@ -55,10 +56,21 @@ std::unique_ptr<ir::Graph> EagerDeletionPass::ApplyImpl(
     }
   }
 
+  bool inline_mode = IsInlineEagerDeletionModeEnabled();
   for (auto &pair : op_vars_map) {
     auto *op = pair.first;
     auto &var_names = pair.second;
 
+    if (inline_mode) {
+      // The op frees the variables itself, the graph is not changed.
+      std::shared_ptr<EagerDeleter> deleter(new EagerDeleter(
+          op->GetScope(), op->GetPlace(), var_names,
+          gcs.at(places[op->GetScopeIdx()]).get(),
+          &(ref_cnts[op->GetScopeIdx()])));
+      op->SetEagerDeletionCallback([deleter] { deleter->Run(); });
+      continue;
+    }
+
     auto *eager_deletion_node =
         graph->CreateEmptyNode("eager_deletion", ir::Node::Type::kOperation);
     auto *eager_deletion_op = new EagerDeletionOpHandle(
@@ -85,7 +97,9 @@ std::unique_ptr<ir::Graph> EagerDeletionPass::ApplyImpl(
     eager_deletion_op->AddOutput(dummy_leaf);
   }
 
-  VLOG(10) << "Create " << op_vars_map.size() << " EagerDeletionOpHandle(s)";
+  VLOG(10) << "Create " << op_vars_map.size()
+           << (inline_mode ? " inline eager deleter(s)"
+                           : " EagerDeletionOpHandle(s)");
   return graph;
 }
 
@@ -28,6 +28,12 @@ struct ExecutionStrategy {
   size_t num_iteration_per_drop_scope_{1};
   ExecutorType type_{kDefault};
   bool dry_run_{false};
+  // Only used by the experimental executor, run ops in a work stealing thread
+  // pool instead of one shared task queue.
+  bool use_work_stealing_{false};
+  // Return the fetched results on the device of the first place instead of
+  // copying them to CPU, when the results are on GPUs.
+  bool fetch_on_device_{false};
 };
 
 }  //  namespace details
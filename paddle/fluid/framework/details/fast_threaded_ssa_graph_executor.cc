@@ -12,10 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include "paddle/fluid/framework/details/fast_threaded_ssa_graph_executor.h"
+#include <algorithm>
 #include <string>
+#include <utility>
 #include <vector>
 #include "paddle/fluid/framework/details/fetch_op_handle.h"
 #include "paddle/fluid/framework/details/multi_devices_helper.h"
+#include "paddle/fluid/framework/details/op_priority_pass.h"
 #include "paddle/fluid/framework/ir/graph_helper.h"
 
 namespace paddle {
@@ -30,9 +33,17 @@ FastThreadedSSAGraphExecutor::FastThreadedSSAGraphExecutor(
       local_scopes_(local_scopes),
       places_(places),
       graph_(std::move(graph)),
-      pool_(strategy.num_threads_),
       prepare_pool_(1),  // add one more thread for generate op_deps
-      fetch_ctxs_(places) {
+      fetch_ctxs_(places),
+      use_priority_(graph_->Has(kOpPriorityScheduling)) {
+  if (use_priority_) {
+    priority_pool_.reset(new PriorityThreadPool(strategy_.num_threads_));
+  } else if (strategy_.use_work_stealing_) {
+    work_stealing_pool_.reset(
+        new WorkStealingThreadPool(strategy_.num_threads_));
+  } else {
+    pool_.reset(new ::ThreadPool(strategy_.num_threads_));
+  }
   for (auto &op : ir::FilterByNodeWrapper<OpHandleBase>(*graph_)) {
     int dep = static_cast<int>(op->NotReadyInputSize());
     op_deps_.emplace(op, dep);
@@ -41,6 +52,12 @@ FastThreadedSSAGraphExecutor::FastThreadedSSAGraphExecutor(
     }
   }
 
+  if (use_priority_) {
+    // The bootstrap ops are launched together, the first ones may start
+    // before the others are queued.
+    SortByPriority(&bootstrap_ops_);
+  }
+
   PrepareAtomicOpDeps();
 }
 
@@ -75,7 +92,8 @@ FeedFetchList FastThreadedSSAGraphExecutor::Run(
 
     ir::Node *fetch_node =
         graph_->CreateEmptyNode("fetch", ir::Node::Type::kOperation);
-    auto *op = new FetchOpHandle(fetch_node, &fetches, i, &local_scopes_);
+    auto *op = new FetchOpHandle(fetch_node, &fetches, i, &local_scopes_,
+                                 strategy_.fetch_on_device_);
     fetch_ops.emplace_back(op);
 
     for (auto &p : places_) {
@@ -121,12 +139,27 @@ FeedFetchList FastThreadedSSAGraphExecutor::Run(
   return fetches;
 }
 
+// NOTE: When called inside a worker of the work stealing pool, e.g. for the
+// ready successors of an op, the task is pushed to the deque of this worker.
+// The priority is only used by the priority pool.
+template <typename Callback>
+void FastThreadedSSAGraphExecutor::Schedule(int64_t priority,
+                                            Callback &&callback) {
+  if (priority_pool_) {
+    priority_pool_->Run(priority, std::forward<Callback>(callback));
+  } else if (work_stealing_pool_) {
+    work_stealing_pool_->Run(std::forward<Callback>(callback));
+  } else {
+    pool_->enqueue(std::forward<Callback>(callback));
+  }
+}
+
 void FastThreadedSSAGraphExecutor::RunOpAsync(
     std::unordered_map<OpHandleBase *, std::atomic<int>> *op_deps,
     OpHandleBase *op,
     const std::shared_ptr<BlockingQueue<size_t>> &complete_q) {
   ++remaining_;
-  this->pool_.enqueue([=] {
+  Schedule(op->Priority(), [=] {
     OpHandleBase *op_to_run = op;
     size_t complete = 0;
     while (op_to_run != nullptr) {
@@ -143,6 +176,19 @@ void FastThreadedSSAGraphExecutor::RunOpAsync(
       }
       auto &outputs = op_to_run->Outputs();
       op_to_run = nullptr;
+      if (use_priority_) {
+        // All the ready ops go through the ready queue, which runs the most
+        // urgent op queued next, instead of a successor of this op inline.
+        for (auto &output : outputs) {
+          for (auto &pending_op : output->PendingOps()) {
+            std::atomic<int> &deps = op_deps->at(pending_op);
+            if (deps.fetch_sub(1) == 1) {  // pending_op ready
+              RunOpAsync(op_deps, pending_op, complete_q);
+            }
+          }
+        }
+        continue;
+      }
       for (auto &output : outputs) {
         for (auto &pending_op : output->PendingOps()) {
           std::atomic<int> &deps = op_deps->at(pending_op);
@@ -160,6 +206,15 @@ void FastThreadedSSAGraphExecutor::RunOpAsync(
     complete_q->Push(complete);
   });
 }
+
+void FastThreadedSSAGraphExecutor::SortByPriority(
+    std::vector<OpHandleBase *> *ops) {
+  std::stable_sort(ops->begin(), ops->end(),
+                   [](OpHandleBase *a, OpHandleBase *b) {
+                     return a->Priority() > b->Priority();
+                   });
+}
+
 void FastThreadedSSAGraphExecutor::PrepareAtomicOpDeps() {
   atomic_op_deps_ = prepare_pool_.enqueue([&] {
     auto *op_deps = new std::unordered_map<OpHandleBase *, std::atomic<int>>;
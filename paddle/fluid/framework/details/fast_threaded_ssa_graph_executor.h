@@ -20,6 +20,8 @@
 #include "paddle/fluid/framework/details/exception_holder.h"
 #include "paddle/fluid/framework/details/execution_strategy.h"
 #include "paddle/fluid/framework/details/ssa_graph_executor.h"
+#include "paddle/fluid/framework/priority_thread_pool.h"
+#include "paddle/fluid/framework/work_stealing_thread_pool.h"
 
 namespace paddle {
 namespace framework {
@@ -45,15 +47,27 @@ class FastThreadedSSAGraphExecutor : public SSAGraphExecutor {
   std::unordered_map<OpHandleBase *, int> op_deps_;
   std::vector<OpHandleBase *> bootstrap_ops_;
 
-  ::ThreadPool pool_;
+  // Only one of pool_, work_stealing_pool_ and priority_pool_ is created.
+  // priority_pool_ is for the graphs processed by op_priority_pass, and the
+  // others are chosen by ExecutionStrategy::use_work_stealing_.
+  std::unique_ptr<::ThreadPool> pool_;
+  std::unique_ptr<WorkStealingThreadPool> work_stealing_pool_;
+  std::unique_ptr<PriorityThreadPool> priority_pool_;
   ::ThreadPool prepare_pool_;
   platform::DeviceContextPool fetch_ctxs_;
   std::atomic<int> remaining_;
+  // Whether the graph has been processed by op_priority_pass.
+  bool use_priority_;
 
   void RunOpAsync(std::unordered_map<OpHandleBase *, std::atomic<int>> *op_deps,
                   OpHandleBase *op,
                   const std::shared_ptr<BlockingQueue<size_t>> &complete_q);
 
+  template <typename Callback>
+  void Schedule(int64_t priority, Callback &&callback);
+
+  static void SortByPriority(std::vector<OpHandleBase *> *ops);
+
   void PrepareAtomicOpDeps();
 
   std::future<
@@ -22,11 +22,13 @@ namespace framework {
 namespace details {
 
 FetchOpHandle::FetchOpHandle(ir::Node *node, FeedFetchList *data, size_t offset,
-                             std::vector<Scope *> *local_scopes)
+                             std::vector<Scope *> *local_scopes,
+                             bool fetch_on_device)
     : OpHandleBase(node),
       data_(data),
       offset_(offset),
-      local_scopes_(local_scopes) {}
+      local_scopes_(local_scopes),
+      fetch_on_device_(fetch_on_device) {}
 
 FetchOpHandle::~FetchOpHandle() {}
 
@@ -46,8 +48,9 @@ void FetchOpHandle::WaitAndMergeCPUTensors() const {
 void FetchOpHandle::RunImpl() {
   WaitInputVarGenerated(platform::CPUPlace());
 
-  tensors_.resize(inputs_.size());
-  platform::CPUPlace cpu;
+  std::vector<const LoDTensor *> srcs;
+  srcs.reserve(inputs_.size());
+  bool all_on_gpu = true;
   auto &scopes = *local_scopes_;
 
   for (size_t i = 0; i < inputs_.size(); ++i) {
@@ -60,9 +63,42 @@ void FetchOpHandle::RunImpl() {
                             var_handle->name_);
 
     auto &t = var->Get<framework::LoDTensor>();
+    all_on_gpu = all_on_gpu && platform::is_gpu_place(t.place());
+    srcs.emplace_back(&t);
+  }
+
+  if (all_on_gpu && !srcs.empty()) {
+#ifdef PADDLE_WITH_CUDA
+    // The results are gathered and merged on the device of the first one, on
+    // its stream, so that they are copied to CPU by one copy and one wait.
+    auto place = srcs[0]->place();
+    auto *dev_ctx = platform::DeviceContextPool::Instance().Get(place);
+    auto &dst = data_->at(offset_);
+    // The merged tensor is kept until the copy from it is done.
+    LoDTensor merged;
+    if (fetch_on_device_) {
+      dst.MergeLoDTensor(srcs, place);
+    } else {
+      if (srcs.size() == 1) {
+        merged.ShareDataWith(*srcs[0]);
+        merged.set_lod(srcs[0]->lod());
+      } else {
+        merged.MergeLoDTensor(srcs, place);
+      }
+      TensorCopy(merged, platform::CPUPlace(), *dev_ctx, &dst);
+      dst.set_lod(merged.lod());
+    }
+    dev_ctx->Wait();
+#endif
+    return;
+  }
+
+  tensors_.resize(srcs.size());
+  for (size_t i = 0; i < srcs.size(); ++i) {
+    auto &t = *srcs[i];
     if (platform::is_gpu_place(t.place())) {
 #ifdef PADDLE_WITH_CUDA
-      TensorCopySync(t, cpu, &tensors_[i]);
+      TensorCopySync(t, platform::CPUPlace(), &tensors_[i]);
 #endif
     } else {
       tensors_[i].ShareDataWith(t);
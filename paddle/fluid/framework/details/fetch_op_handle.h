@@ -29,7 +29,8 @@ namespace details {
 struct FetchOpHandle : public OpHandleBase {
  public:
   FetchOpHandle(ir::Node *node, FeedFetchList *data, size_t offset,
-                std::vector<Scope *> *local_scopes);
+                std::vector<Scope *> *local_scopes,
+                bool fetch_on_device = false);
 
   ~FetchOpHandle();
 
@@ -48,6 +49,7 @@ struct FetchOpHandle : public OpHandleBase {
   FeedFetchList *data_;
   size_t offset_;
   std::vector<Scope *> *local_scopes_;
+  bool fetch_on_device_;
   std::vector<LoDTensor> tensors_;
 };
 
@@ -0,0 +1,201 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "paddle/fluid/framework/details/fused_all_reduce_op_handle.h"
+#include <algorithm>
+#include "gflags/gflags.h"
+#include "paddle/fluid/framework/details/container_cast.h"
+#include "paddle/fluid/framework/details/reduce_and_gather.h"
+#include "paddle/fluid/framework/details/variable_visitor.h"
+#include "paddle/fluid/platform/profiler.h"
+
+DECLARE_bool(sync_nccl_allreduce);
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+FusedAllReduceOpHandle::FusedAllReduceOpHandle(
+    ir::Node *node, const std::vector<Scope *> &local_scopes,
+    const std::vector<platform::Place> &places,
+    const platform::NCCLContextMap *ctxs)
+    : OpHandleBase(node),
+      local_scopes_(local_scopes),
+      places_(places),
+      nccl_ctxs_(ctxs) {
+  if (nccl_ctxs_) {
+    for (auto &p : places_) {
+      this->SetDeviceContext(p, nccl_ctxs_->DevCtx(p));
+    }
+  }
+}
+#else
+FusedAllReduceOpHandle::FusedAllReduceOpHandle(
+    ir::Node *node, const std::vector<Scope *> &local_scopes,
+    const std::vector<platform::Place> &places)
+    : OpHandleBase(node), local_scopes_(local_scopes), places_(places) {}
+#endif
+
+void FusedAllReduceOpHandle::GetGradTensors(
+    std::vector<std::vector<LoDTensor *>> *grads) const {
+  auto in_var_handles = DynamicCast<VarHandle>(this->Inputs());
+  auto out_var_handles = DynamicCast<VarHandle>(this->Outputs());
+  PADDLE_ENFORCE_EQ(in_var_handles.size() % places_.size(), 0,
+                    "The number of inputs should be a multiple of the number "
+                    "of places.");
+  PADDLE_ENFORCE_EQ(
+      in_var_handles.size(), out_var_handles.size(),
+      "The NoDummyInputSize and NoDummyOutputSize should be equal.");
+
+  grads->clear();
+  grads->resize(places_.size());
+  for (size_t i = 0; i < in_var_handles.size(); ++i) {
+    auto *in = in_var_handles[i];
+    PADDLE_ENFORCE_EQ(in->name_, out_var_handles[i]->name_,
+                      "The name of input and output should be equal.");
+    auto &local_scope = *local_scopes_[in->scope_idx_]
+                             ->FindVar(kLocalExecScopeName)
+                             ->Get<Scope *>();
+    auto *var = local_scope.FindVar(in->name_);
+    PADDLE_ENFORCE_NOT_NULL(var, "Cannot find variable %s", in->name_);
+    (*grads)[in->scope_idx_].emplace_back(var->GetMutable<LoDTensor>());
+  }
+}
+
+void FusedAllReduceOpHandle::RunImpl() {
+  platform::RecordEvent record_event(Name(), dev_ctxes_.cbegin()->second);
+
+  WaitInputVarGenerated();
+  std::vector<std::vector<LoDTensor *>> grads;
+  GetGradTensors(&grads);
+
+  if (platform::is_gpu_place(grads[0][0]->place())) {
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+    GPUAllReduce(grads);
+#else
+    PADDLE_THROW("Not compiled with CUDA");
+#endif
+  } else {
+    CPUAllReduce(grads);
+  }
+}
+
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+void FusedAllReduceOpHandle::GPUAllReduce(
+    const std::vector<std::vector<LoDTensor *>> &grads) {
+  PADDLE_ENFORCE(nccl_ctxs_, "nccl_ctxs should not be nullptr.");
+  auto dtype = grads[0][0]->type();
+  size_t size_of_dtype = SizeOfType(dtype);
+  int64_t numel = 0;
+  for (auto *grad : grads[0]) {
+    PADDLE_ENFORCE_EQ(grad->type(), dtype,
+                      "The gradients in one bucket should have the same type.");
+    numel += grad->numel();
+  }
+  size_t bytes = numel * size_of_dtype;
+
+  buffers_.resize(places_.size());
+  for (size_t i = 0; i < places_.size(); ++i) {
+    if (buffers_[i] == nullptr || buffers_[i]->size() < bytes) {
+      buffers_[i] = memory::Alloc(places_[i], bytes);
+    }
+  }
+
+  this->RunAndRecordEvent([&] {
+    // The copies and the all-reduce of a place are on the same NCCL stream,
+    // so they are executed in order.
+    for (size_t i = 0; i < places_.size(); ++i) {
+      int dev_id = boost::get<platform::CUDAPlace>(places_[i]).device;
+      auto stream = nccl_ctxs_->at(dev_id).stream();
+      auto *buffer = reinterpret_cast<uint8_t *>(buffers_[i]->ptr());
+      for (auto *grad : grads[i]) {
+        size_t grad_bytes = grad->numel() * size_of_dtype;
+        PADDLE_ENFORCE(cudaMemcpyAsync(buffer, grad->data<void>(), grad_bytes,
+                                       cudaMemcpyDeviceToDevice, stream));
+        buffer += grad_bytes;
+      }
+    }
+
+    auto nccl_dtype = platform::ToNCCLDataType(dtype);
+    auto all_reduce = [&](size_t i) {
+      int dev_id = boost::get<platform::CUDAPlace>(places_[i]).device;
+      auto &nccl_ctx = nccl_ctxs_->at(dev_id);
+      void *buffer = buffers_[i]->ptr();
+      PADDLE_ENFORCE(platform::dynload::ncclAllReduce(
+          buffer, buffer, numel, nccl_dtype, ncclSum, nccl_ctx.comm_,
+          nccl_ctx.stream()));
+    };
+    if (places_.size() == 1UL) {
+      // Do not use NCCLGroup when manage NCCL by per thread per device
+      all_reduce(0);
+    } else {
+      platform::NCCLGroupGuard guard;
+      for (size_t i = 0; i < places_.size(); ++i) {
+        all_reduce(i);
+      }
+    }
+
+    for (size_t i = 0; i < places_.size(); ++i) {
+      int dev_id = boost::get<platform::CUDAPlace>(places_[i]).device;
+      auto stream = nccl_ctxs_->at(dev_id).stream();
+      auto *buffer = reinterpret_cast<const uint8_t *>(buffers_[i]->ptr());
+      for (auto *grad : grads[i]) {
+        size_t grad_bytes = grad->numel() * size_of_dtype;
+        PADDLE_ENFORCE(cudaMemcpyAsync(const_cast<void *>(grad->data<void>()),
+                                       buffer, grad_bytes,
+                                       cudaMemcpyDeviceToDevice, stream));
+        buffer += grad_bytes;
+      }
+    }
+  });
+
+  if (FLAGS_sync_nccl_allreduce) {
+    for (auto &p : places_) {
+      int dev_id = boost::get<platform::CUDAPlace>(p).device;
+      cudaStreamSynchronize(nccl_ctxs_->at(dev_id).stream());
+    }
+  }
+}
+#endif
+
+void FusedAllReduceOpHandle::CPUAllReduce(
+    const std::vector<std::vector<LoDTensor *>> &grads) {
+  // Special handle CPU only Operator's gradient. Like CRF
+  size_t num_grads = grads[0].size();
+  for (size_t j = 0; j < num_grads; ++j) {
+    std::vector<const LoDTensor *> lod_tensors;
+    for (size_t i = 0; i < places_.size(); ++i) {
+      lod_tensors.emplace_back(grads[i][j]);
+    }
+
+    // Reduce All Tensor to trg in CPU
+    auto &trg = *grads[0][j];
+    ReduceLoDTensor func(lod_tensors, &trg);
+    VisitDataType(lod_tensors[0]->type(), func);
+
+    for (size_t i = 1; i < places_.size(); ++i) {
+      auto &p = places_[i];
+      auto *dev_ctx = dev_ctxes_.at(p);
+      auto *dst = grads[i][j];
+      RunAndRecordEvent(p, [&trg, dst, dev_ctx, p] {
+        TensorCopy(trg, p, *dev_ctx, dst);
+      });
+    }
+  }
+}
+
+std::string FusedAllReduceOpHandle::Name() const { return "fused_all_reduce"; }
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,78 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/details/op_handle_base.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/memory/malloc.h"
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+#include "paddle/fluid/platform/nccl_helper.h"
+#endif
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+// FusedAllReduceOpHandle all-reduces a bucket of dense gradients with the
+// same data type. On GPU, the gradients of each device are copied into one
+// contiguous buffer, which is all-reduced by a single NCCL call and copied
+// back, so the launch latency is paid once per bucket instead of once per
+// gradient.
+//
+// The inputs and outputs are added gradient by gradient, and for each
+// gradient device by device, the same as AllReduceOpHandle.
+struct FusedAllReduceOpHandle : public OpHandleBase {
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+  FusedAllReduceOpHandle(ir::Node *node,
+                         const std::vector<Scope *> &local_scopes,
+                         const std::vector<platform::Place> &places,
+                         const platform::NCCLContextMap *ctxs);
+#else
+  FusedAllReduceOpHandle(ir::Node *node,
+                         const std::vector<Scope *> &local_scopes,
+                         const std::vector<platform::Place> &places);
+#endif
+  std::string Name() const override;
+
+  bool IsMultiDeviceTransfer() override { return true; };
+
+ protected:
+  void RunImpl() override;
+
+ private:
+  // The gradients of each place, grads[i][j] is the j-th gradient on the
+  // i-th place.
+  void GetGradTensors(std::vector<std::vector<LoDTensor *>> *grads) const;
+
+  void CPUAllReduce(const std::vector<std::vector<LoDTensor *>> &grads);
+
+  std::vector<Scope *> local_scopes_;
+  std::vector<platform::Place> places_;
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+  void GPUAllReduce(const std::vector<std::vector<LoDTensor *>> &grads);
+
+  const platform::NCCLContextMap *nccl_ctxs_;
+  // The contiguous buffer of each place, reused across iterations.
+  std::vector<memory::AllocationPtr> buffers_;
+#endif
+};
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
@@ -30,6 +30,12 @@ static bool IsLockAndRecordEventFreeComputationOpHandle(
     if (tmp == nullptr || !(tmp->GetPlace() == op->GetPlace())) {
       return false;
     }
+    // The pending op waits for the event of op if they are on different
+    // streams, see multi_stream_pass.
+    if (tmp->DeviceContext(op->GetPlace()) !=
+        op->DeviceContext(op->GetPlace())) {
+      return false;
+    }
   }
   return true;
 }
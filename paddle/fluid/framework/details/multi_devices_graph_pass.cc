@@ -12,24 +12,29 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include <algorithm>
+#include <exception>
 #include <fstream>
+#include <future>  // NOLINT
 #include <string>
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 
 #include "paddle/fluid/framework/details/all_reduce_op_handle.h"
 #include "paddle/fluid/framework/details/broadcast_op_handle.h"
 #include "paddle/fluid/framework/details/computation_op_handle.h"
-#include "paddle/fluid/framework/details/data_balance_op_handle.h"
+#include "paddle/fluid/framework/details/fused_all_reduce_op_handle.h"
 #include "paddle/fluid/framework/details/fused_broadcast_op_handle.h"
 #include "paddle/fluid/framework/details/multi_devices_graph_pass.h"
 #include "paddle/fluid/framework/details/reduce_op_handle.h"
 #include "paddle/fluid/framework/details/rpc_op_handle.h"
 #include "paddle/fluid/framework/details/scale_loss_grad_op_handle.h"
+#include "paddle/fluid/framework/details/sharded_lookup_op_handle.h"
 #include "paddle/fluid/framework/ir/graph_helper.h"
 #include "paddle/fluid/framework/ir/node.h"
 #include "paddle/fluid/framework/op_info.h"
 #include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/threadpool.h"
 
 namespace paddle {
 namespace framework {
@@ -136,6 +141,8 @@ void AddOutputToLeafOps(ir::Graph *graph) {
 
 void MultiDevSSAGraphBuilderBase::Init() const {
   all_vars_.clear();
+  sharded_tables_.clear();
+  pending_ops_.clear();
 
   loss_var_name_ = Get<const std::string>(kLossVarName);
   places_ = Get<const std::vector<platform::Place>>(kPlaces);
@@ -181,6 +188,8 @@ std::unique_ptr<ir::Graph> MultiDevSSAGraphBuilderBase::ApplyImpl(
         // It also assumes backward op will always follow the forward op in
         // the block.
         is_forwarding = false;
+      } else if (IsShardedLookupOp(node)) {
+        CreateShardedLookupOp(&result, node);
       } else {
         CreateComputationalOps(&result, node, places_.size());
       }
@@ -204,6 +213,7 @@ std::unique_ptr<ir::Graph> MultiDevSSAGraphBuilderBase::ApplyImpl(
           for (size_t i = 0; i < backward_vars.size(); i += 2) {
             auto &p_name = backward_vars[i];
             auto &g_name = backward_vars[i + 1];
+            if (sharded_tables_.count(p_name)) continue;
             VLOG(10) << "Bcast " << g_name << " for parameter " << p_name;
 
             InsertCollectiveOp(&result, p_name, g_name);
@@ -215,6 +225,7 @@ std::unique_ptr<ir::Graph> MultiDevSSAGraphBuilderBase::ApplyImpl(
   }
 
   InsertPostprocessOps(&result);
+  CreatePendingOps();
 
   /*
   Dependency graph has been constructed. However, there are still data
@@ -384,12 +395,49 @@ void MultiDevSSAGraphBuilderBase::CreateFusedBroadcastOp(
 void MultiDevSSAGraphBuilderBase::CreateComputationalOp(ir::Graph *result,
                                                         ir::Node *node,
                                                         int dev_id) const {
-  result->Get<GraphOps>(kGraphOps).emplace_back(
+  auto *op_handle =
       new ComputationOpHandle(result->CreateOpNode(node->Op()),
-                              local_scopes_[dev_id], places_[dev_id], dev_id));
+                              local_scopes_[dev_id], places_[dev_id], dev_id,
+                              false);
+  result->Get<GraphOps>(kGraphOps).emplace_back(op_handle);
+  pending_ops_.push_back(op_handle);
   CreateOpHandleIOs(result, node, dev_id);
 }
 
+void MultiDevSSAGraphBuilderBase::CreatePendingOps() const {
+  // Creating an operator checks its attributes, which takes most of the time
+  // to build the graph, while the operators of the op handles are independent.
+  size_t num_threads =
+      std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1U),
+                       (pending_ops_.size() + 255) / 256);
+  if (num_threads <= 1) {
+    for (auto *op_handle : pending_ops_) {
+      op_handle->CreateOp();
+    }
+  } else {
+    size_t chunk = (pending_ops_.size() + num_threads - 1) / num_threads;
+    std::vector<std::future<void>> fs;
+    for (size_t begin = 0; begin < pending_ops_.size(); begin += chunk) {
+      size_t end = std::min(begin + chunk, pending_ops_.size());
+      fs.push_back(Async([this, begin, end] {
+        for (size_t i = begin; i < end; ++i) {
+          pending_ops_[i]->CreateOp();
+        }
+      }));
+    }
+    std::exception_ptr error;
+    for (auto &f : fs) {
+      try {
+        f.get();
+      } catch (...) {
+        error = std::current_exception();
+      }
+    }
+    if (error) std::rethrow_exception(error);
+  }
+  pending_ops_.clear();
+}
+
 void MultiDevSSAGraphBuilderBase::CreateAllReduceOp(
     ir::Graph *result, const std::string &og) const {
 #if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
@@ -419,6 +467,79 @@ void MultiDevSSAGraphBuilderBase::CreateAllReduceOp(
   }
 }
 
+bool MultiDevSSAGraphBuilderBase::IsShardedLookupOp(ir::Node *node) const {
+  auto *op = node->Op();
+  if (op->Type() != "lookup_table" && op->Type() != "lookup_table_grad") {
+    return false;
+  }
+  return places_.size() > 1 && op->HasAttr("is_sharded") &&
+         boost::get<bool>(op->GetAttr("is_sharded"));
+}
+
+void MultiDevSSAGraphBuilderBase::CreateShardedLookupOp(ir::Graph *result,
+                                                        ir::Node *node) const {
+  PADDLE_ENFORCE(
+      strategy_.reduce_ == BuildStrategy::ReduceStrategy::kAllReduce,
+      "The sharded lookup table only supports the AllReduce strategy.");
+  PADDLE_ENFORCE_EQ(Get<size_t>(kNRanks), places_.size(),
+                    "The sharded lookup table does not support the "
+                    "distributed training.");
+  auto *op = node->Op();
+  auto &table_name = op->Input("W")[0];
+  auto shape = all_vars_.at(table_name)->GetShape();
+  int64_t height = shape[0];
+  PADDLE_ENFORCE_GE(height, static_cast<int64_t>(places_.size()),
+                    "The sharded table %s should have a row per device.",
+                    table_name);
+  int64_t padding_idx = boost::get<int64_t>(op->GetAttr("padding_idx"));
+  sharded_tables_.insert(table_name);
+
+  OpHandleBase *op_handle = nullptr;
+  if (op->Type() == "lookup_table") {
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+    op_handle = new ShardedLookupOpHandle(
+        result->CreateEmptyNode("sharded_lookup", ir::Node::Type::kOperation),
+        local_scopes_, places_, nccl_ctxs_, height, padding_idx, table_name,
+        op->Input("Ids")[0], op->Output("Out")[0]);
+#else
+    op_handle = new ShardedLookupOpHandle(
+        result->CreateEmptyNode("sharded_lookup", ir::Node::Type::kOperation),
+        local_scopes_, places_, height, padding_idx, table_name,
+        op->Input("Ids")[0], op->Output("Out")[0]);
+#endif
+  } else {
+    auto *handle_node = result->CreateEmptyNode("sharded_lookup_grad",
+                                                ir::Node::Type::kOperation);
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+    op_handle = new ShardedLookupGradOpHandle(
+        handle_node, local_scopes_, places_, nccl_ctxs_, height, padding_idx,
+        op->Input("Ids")[0], op->Input(GradVarName("Out"))[0],
+        op->Output(GradVarName("W"))[0]);
+#else
+    op_handle = new ShardedLookupGradOpHandle(
+        handle_node, local_scopes_, places_, height, padding_idx,
+        op->Input("Ids")[0], op->Input(GradVarName("Out"))[0],
+        op->Output(GradVarName("W"))[0]);
+#endif
+  }
+  result->Get<GraphOps>(kGraphOps).emplace_back(op_handle);
+
+  for (size_t i = 0; i < places_.size(); ++i) {
+    auto &p = places_[i];
+    SetCommunicationContext(op_handle, p);
+    for (ir::Node *input : node->inputs) {
+      op_handle->AddInput(CreateOrGetLatestVarHandle(result, input, p, i));
+    }
+    for (ir::Node *output : node->outputs) {
+      ir::Node *new_node =
+          output->Var() ? result->CreateVarNode(output->Var())
+                        : result->CreateEmptyNode(output->Name(),
+                                                  ir::Node::Type::kVariable);
+      CreateOpOutput(result, op_handle, new_node, p, i);
+    }
+  }
+}
+
 void MultiDevSSAGraphBuilderBase::CreateScaleLossGradOp(
     ir::Graph *result, const std::string &loss_grad_name,
     ir::Node *out_var_node, size_t loss_scale,
@@ -446,8 +567,14 @@ void MultiDevSSAGraphBuilderBase::CreateComputationalOps(
   for (size_t scope_idx = 0; scope_idx < num_places; ++scope_idx) {
     auto p = places_[scope_idx];
     auto s = local_scopes_[scope_idx];
-    result->Get<GraphOps>(kGraphOps).emplace_back(new ComputationOpHandle(
-        result->CreateOpNode(node->Op()), s, p, scope_idx));
+    auto *op_node = result->CreateOpNode(node->Op());
+    if (op_node->Op()->Type() == "read") {
+      // The readers which keep the batches by place read the ones of it.
+      op_node->Op()->SetAttr("device_id", static_cast<int>(scope_idx));
+    }
+    auto *op_handle = new ComputationOpHandle(op_node, s, p, scope_idx, false);
+    result->Get<GraphOps>(kGraphOps).emplace_back(op_handle);
+    pending_ops_.push_back(op_handle);
     CreateOpHandleIOs(result, node, scope_idx);
   }
 }
@@ -491,6 +618,39 @@ bool MultiDevSSAGraphBuilderBase::IsScaleLossOp(ir::Node *node) const {
          !loss_var_name_.empty();  // If loss_var is empty. This is test mode
 }
 
+void MultiDevSSAGraphBuilderBase::CreateFusedAllReduceOp(
+    ir::Graph *result, const std::vector<std::string> &ogs) const {
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+  result->Get<GraphOps>(kGraphOps).emplace_back(new FusedAllReduceOpHandle(
+      result->CreateEmptyNode("fused_allreduce", ir::Node::Type::kOperation),
+      local_scopes_, places_, nccl_ctxs_));
+#else
+  result->Get<GraphOps>(kGraphOps).emplace_back(new FusedAllReduceOpHandle(
+      result->CreateEmptyNode("fused_allreduce", ir::Node::Type::kOperation),
+      local_scopes_, places_));
+#endif
+  auto *op_handle = result->Get<GraphOps>(kGraphOps).back();
+
+  for (size_t i = 0; i < places_.size(); ++i) {
+    SetCommunicationContext(op_handle, places_[i]);
+  }
+  for (auto &og : ogs) {
+    for (size_t i = 0; i < places_.size(); ++i) {
+      auto &p = places_[i];
+      auto &vars = result->Get<GraphVars>(kGraphVars)[i][og];
+      PADDLE_ENFORCE(!vars.empty());
+      auto &prev_grad = vars.back();
+      op_handle->AddInput(prev_grad);
+
+      auto var =
+          new VarHandle(result->CreateEmptyNode(og, ir::Node::Type::kVariable),
+                        vars.size(), i, og, p);
+      vars.emplace_back(var);
+      op_handle->AddOutput(var);
+    }
+  }
+}
+
 bool MultiDevSSAGraphBuilderBase::IsSparseGradient(
     const std::string &og) const {
   PADDLE_ENFORCE(all_vars_.count(og) != 0);
@@ -506,11 +666,76 @@ void AllReduceSSAGraphBuilder::InsertCollectiveOp(
   if (IsSparseGradient(g_name)) {
     CreateReduceOp(result, g_name, 0);
     CreateBroadcastOp(result, g_name, 0);
+  } else if (strategy_.fuse_all_reduce_ops_) {
+    AddToAllReduceBucket(result, g_name);
   } else {
     CreateAllReduceOp(result, g_name);
   }
 }
 
+bool AllReduceSSAGraphBuilder::DealWithSpecialOp(ir::Graph *result,
+                                                 ir::Node *node) const {
+  // The op must read the all-reduced gradients, so all-reduce the bucket
+  // before the op if it reads any gradient in the bucket.
+  if (!bucket_grads_.empty()) {
+    for (auto *in : node->inputs) {
+      if (bucket_grad_set_.count(in->Name())) {
+        FlushAllReduceBucket(result);
+        break;
+      }
+    }
+  }
+  return false;
+}
+
+void AllReduceSSAGraphBuilder::InsertPostprocessOps(ir::Graph *result) const {
+  FlushAllReduceBucket(result);
+}
+
+void AllReduceSSAGraphBuilder::AddToAllReduceBucket(
+    ir::Graph *result, const std::string &g_name) const {
+  auto *var_desc = all_vars_.at(g_name);
+  auto dtype = var_desc->GetDataType();
+  int64_t numel = 1;
+  for (auto dim : var_desc->GetShape()) {
+    numel *= dim;
+  }
+  if (numel <= 0) {
+    // The size is unknown at compile time.
+    CreateAllReduceOp(result, g_name);
+    return;
+  }
+
+  if (!bucket_grads_.empty() && dtype != bucket_dtype_) {
+    FlushAllReduceBucket(result);
+  }
+  bucket_dtype_ = dtype;
+  bucket_grads_.emplace_back(g_name);
+  bucket_grad_set_.insert(g_name);
+  bucket_bytes_ += numel * SizeOfType(dtype);
+
+  size_t bucket_limit = strategy_.fuse_all_reduce_bucket_size_mb_ << 20;
+  if (bucket_bytes_ >= bucket_limit) {
+    FlushAllReduceBucket(result);
+  }
+}
+
+void AllReduceSSAGraphBuilder::FlushAllReduceBucket(ir::Graph *result) const {
+  if (bucket_grads_.empty()) {
+    return;
+  }
+  VLOG(10) << "fuse the all-reduce of " << bucket_grads_.size()
+           << " gradients, " << bucket_bytes_ << " bytes";
+  if (bucket_grads_.size() == 1UL) {
+    CreateAllReduceOp(result, bucket_grads_[0]);
+  } else {
+    CreateFusedAllReduceOp(result, bucket_grads_);
+  }
+  bucket_grads_.clear();
+  bucket_grad_set_.clear();
+  bucket_bytes_ = 0;
+}
+
 int BalanceVarSSAGraphBuilder::GetVarDeviceID(
     const std::string &varname) const {
   auto got = sharded_var_device_.find(varname);
@@ -712,6 +937,17 @@ void DistSSAGraphBuilder::ResetState() const {
   BalanceVarSSAGraphBuilder::ResetState();
   bcast_var_name_set_.clear();
   bcast_var_name_set_.resize(places_.size());
+  has_send_op_ = false;
+}
+
+void DistSSAGraphBuilder::BroadcastReceivedVar(ir::Graph *result,
+                                               const std::string &var_name,
+                                               int dev_id) const {
+  if (has_send_op_) {
+    bcast_var_name_set_[dev_id].emplace(var_name);
+  } else {
+    CreateBroadcastOp(result, var_name, dev_id);
+  }
 }
 
 bool DistSSAGraphBuilder::DealWithSpecialOp(ir::Graph *result,
@@ -727,7 +963,7 @@ bool DistSSAGraphBuilder::DealWithSpecialOp(ir::Graph *result,
               OpProtoAndCheckerMaker::OpRoleVarAttrName()));
       PADDLE_ENFORCE(recv_vars_attr.size() == 2UL);  // [parameter, gradient]
       if (recv_vars_attr[0].find(".block") == std::string::npos) {
-        bcast_var_name_set_[op_dev_id].emplace(recv_vars_attr[0]);
+        BroadcastReceivedVar(result, recv_vars_attr[0], op_dev_id);
       }
     }
     insert_op = true;
@@ -736,7 +972,7 @@ bool DistSSAGraphBuilder::DealWithSpecialOp(ir::Graph *result,
     int op_dev_id = CreateDistTrainOp(result, node);
     if (node->Op()->Type() == "concat") {
       auto origin_param_name = node->Op()->OutputArgumentNames()[0];
-      bcast_var_name_set_[op_dev_id].emplace(origin_param_name);
+      BroadcastReceivedVar(result, origin_param_name, op_dev_id);
     }
     insert_op = true;
   } else {
@@ -771,6 +1007,7 @@ void SetOpInputsAllPlaces(ir::Graph *result, ir::Node *node, int num_places) {
 int DistSSAGraphBuilder::CreateRPCOp(ir::Graph *result, ir::Node *node) const {
   int op_dev_id = -1;
   if (node->Op()->Type() == "send") {
+    has_send_op_ = true;
     // TODO(paddle-dev): getting the first var is not safe.
     op_dev_id = GetVarDeviceID(node->inputs[0]->Name());
     PADDLE_ENFORCE(!ir::IsControlDepVar(*node->inputs[0]),
@@ -836,7 +1073,10 @@ int DistSSAGraphBuilder::CreateRPCOp(ir::Graph *result, ir::Node *node) const {
     SetOpInputsAllPlaces(result, node, places_.size());
     for (ir::Node *output : node->outputs) {
       int outvar_dev_id = op_dev_id;
-      if (node->Op()->Type() == "fetch_barrier") {
+      // the fetch_barrier which reads the received vars only outputs a
+      // dependency var.
+      if (node->Op()->Type() == "fetch_barrier" &&
+          !ir::IsControlDepVar(*output)) {
         outvar_dev_id = GetVarDeviceID(output->Name());
         PADDLE_ENFORCE_NE(outvar_dev_id, -1, "output name %s", output->Name());
       }
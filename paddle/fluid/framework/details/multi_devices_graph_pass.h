@@ -19,6 +19,7 @@
 #include <vector>
 
 #include "paddle/fluid/framework/details/build_strategy.h"
+#include "paddle/fluid/framework/details/computation_op_handle.h"
 #include "paddle/fluid/framework/details/multi_devices_helper.h"
 #include "paddle/fluid/framework/ir/graph.h"
 
@@ -77,6 +78,15 @@ class MultiDevSSAGraphBuilderBase : public ir::Pass {
 
   void CreateAllReduceOp(ir::Graph *result, const std::string &og) const;
 
+  // The lookup_table and lookup_table_grad ops of a table sharded between the
+  // devices by the is_sharded attribute.
+  bool IsShardedLookupOp(ir::Node *node) const;
+
+  void CreateShardedLookupOp(ir::Graph *result, ir::Node *node) const;
+
+  void CreateFusedAllReduceOp(ir::Graph *result,
+                              const std::vector<std::string> &ogs) const;
+
   void CreateBroadcastOp(ir::Graph *result, const std::string &p_name,
                          size_t src_dev_id) const;
 
@@ -92,6 +102,9 @@ class MultiDevSSAGraphBuilderBase : public ir::Pass {
   void CreateOpHandleIOs(ir::Graph *result, ir::Node *node,
                          size_t device_id) const;
 
+  // Create the operators of the computational op handles in parallel.
+  void CreatePendingOps() const;
+
 #if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
   mutable platform::NCCLContextMap *nccl_ctxs_;
 #endif
@@ -102,6 +115,10 @@ class MultiDevSSAGraphBuilderBase : public ir::Pass {
 
   mutable BuildStrategy strategy_;
   mutable std::unordered_map<std::string, VarDesc *> all_vars_;
+  // The gradients of the sharded tables are not all-reduced.
+  mutable std::unordered_set<std::string> sharded_tables_;
+  // The computational op handles whose operators are not created yet.
+  mutable std::vector<ComputationOpHandle *> pending_ops_;
 };
 
 class AllReduceSSAGraphBuilder : public MultiDevSSAGraphBuilderBase {
@@ -109,11 +126,21 @@ class AllReduceSSAGraphBuilder : public MultiDevSSAGraphBuilderBase {
   virtual void InsertCollectiveOp(ir::Graph *result, const std::string &p_name,
                                   const std::string &g_name) const;
 
-  virtual bool DealWithSpecialOp(ir::Graph *result, ir::Node *node) const {
-    return false;
-  }
+  virtual bool DealWithSpecialOp(ir::Graph *result, ir::Node *node) const;
+
+  virtual void InsertPostprocessOps(ir::Graph *result) const;
+
+  // When BuildStrategy::fuse_all_reduce_ops_ is set, the dense gradients are
+  // put into buckets in the order they are generated, and each bucket is
+  // all-reduced by one FusedAllReduceOpHandle.
+  void AddToAllReduceBucket(ir::Graph *result, const std::string &g_name) const;
 
-  virtual void InsertPostprocessOps(ir::Graph *result) const {}
+  void FlushAllReduceBucket(ir::Graph *result) const;
+
+  mutable std::vector<std::string> bucket_grads_;
+  mutable std::unordered_set<std::string> bucket_grad_set_;
+  mutable size_t bucket_bytes_{0};
+  mutable proto::VarType::Type bucket_dtype_;
 };
 
 class BalanceVarSSAGraphBuilder : public MultiDevSSAGraphBuilderBase {
@@ -173,8 +200,14 @@ class DistSSAGraphBuilder : public BalanceVarSSAGraphBuilder {
 
   int CreateDistTrainOp(ir::Graph *result, ir::Node *node) const;
 
+  // Broadcast the received parameter right away if it is received before
+  // the gradients are sent, since the forward ops read it in this step.
+  void BroadcastReceivedVar(ir::Graph *result, const std::string &var_name,
+                            int dev_id) const;
+
   mutable std::vector<std::unordered_set<std::string>> bcast_var_name_set_;
   mutable bool need_broadcast_var_{false};
+  mutable bool has_send_op_{false};
 };
 
 std::unordered_set<std::string> &MultiDevSSAGraphBuilder();
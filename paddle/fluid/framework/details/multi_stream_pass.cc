@@ -0,0 +1,119 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/details/multi_stream_pass.h"
+#include <map>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/details/computation_op_handle.h"
+#include "paddle/fluid/framework/details/op_graph_view.h"
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/scope.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+static ComputationOpHandle *GPUComputationOp(OpHandleBase *op) {
+  auto *compute_op = dynamic_cast<ComputationOpHandle *>(op);
+  if (compute_op == nullptr ||
+      !platform::is_gpu_place(compute_op->GetPlace())) {
+    return nullptr;
+  }
+  return compute_op;
+}
+
+std::unique_ptr<ir::Graph> MultiStreamPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  size_t num_streams = Get<size_t>(kNumStreams);
+  if (num_streams <= 1) {
+    return graph;
+  }
+  if (GetEagerDeletionThreshold() >= 0) {
+    LOG(WARNING) << "The ops run on one stream of each GPU with the eager "
+                    "deletion";
+    return graph;
+  }
+
+  auto all_ops = ir::FilterByNodeWrapper<OpHandleBase>(*graph);
+  OpGraphView graph_view(all_ops);
+
+  std::unordered_map<OpHandleBase *, std::vector<OpHandleBase *>>
+      preceding_ops;
+  std::unordered_map<OpHandleBase *, size_t> preceding_num;
+  for (auto *op : all_ops) {
+    for (auto *pending_op : graph_view.PendingOps(op)) {
+      preceding_ops[pending_op].push_back(op);
+      ++preceding_num[pending_op];
+    }
+  }
+  std::queue<OpHandleBase *> ready;
+  for (auto *op : all_ops) {
+    if (preceding_num[op] == 0) {
+      ready.push(op);
+    }
+  }
+
+  auto &pool = platform::DeviceContextPool::Instance();
+  std::unordered_map<OpHandleBase *, size_t> stream_of;
+  // The ops whose streams are continued by one of their pending ops.
+  std::unordered_set<OpHandleBase *> continued;
+  std::map<platform::Place, size_t> next_stream;
+  size_t visited = 0;
+  while (!ready.empty()) {
+    auto *op = ready.front();
+    ready.pop();
+    ++visited;
+    for (auto *pending_op : graph_view.PendingOps(op)) {
+      if (--preceding_num[pending_op] == 0) {
+        ready.push(pending_op);
+      }
+    }
+
+    auto *compute_op = GPUComputationOp(op);
+    if (compute_op == nullptr) continue;
+    auto &place = compute_op->GetPlace();
+    bool found = false;
+    size_t stream = 0;
+    for (auto *preceding_op : preceding_ops[op]) {
+      auto *preceding_compute_op = GPUComputationOp(preceding_op);
+      if (preceding_compute_op != nullptr &&
+          preceding_compute_op->GetPlace() == place &&
+          continued.count(preceding_op) == 0) {
+        stream = stream_of.at(preceding_op);
+        continued.insert(preceding_op);
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      stream = next_stream[place]++ % num_streams;
+    }
+    stream_of[op] = stream;
+    compute_op->SetDeviceContext(place, pool.GetStreamContext(place, stream));
+    VLOG(10) << "run " << compute_op->Name() << " on the stream " << stream
+             << " of " << place;
+  }
+  PADDLE_ENFORCE_EQ(visited, all_ops.size(), "The graph has circles");
+  return graph;
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(multi_stream_pass, paddle::framework::details::MultiStreamPass)
+    .RequirePassAttr(paddle::framework::details::kNumStreams);
@@ -0,0 +1,45 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+// The number of the streams of each GPU, the attribute of MultiStreamPass.
+constexpr char kNumStreams[] = "num_streams";
+
+// Run the independent computation ops of a GPU on different streams. The ops
+// are visited in topological order, and an op continues the stream of one of
+// its preceding ops on the same GPU which no other op has continued, or
+// starts a new chain on the next stream in round robin. So a chain of ops
+// stays on one stream, and the branches of a fork go to different streams.
+// The op handles wait for the events of their inputs generated on the other
+// streams, as for the ops on different devices.
+//
+// It is skipped with the eager deletion, whose garbage collectors wait for
+// the default stream of each GPU only.
+class MultiStreamPass : public ir::Pass {
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+};
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
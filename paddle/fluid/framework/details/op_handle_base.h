@@ -93,6 +93,12 @@ class OpHandleBase {
 
   ir::Node *Node() { return node_; }
 
+  // The scheduling priority of this op, larger is more urgent. It is set by
+  // op_priority_pass.
+  int64_t Priority() const { return priority_; }
+
+  void SetPriority(int64_t priority) { priority_ = priority; }
+
  protected:
   void RunAndRecordEvent(const std::function<void()> &callback);
 
@@ -105,6 +111,7 @@ class OpHandleBase {
   std::vector<VarHandleBase *> inputs_;
   std::vector<VarHandleBase *> outputs_;
   std::map<platform::Place, platform::DeviceContext *> dev_ctxes_;
+  int64_t priority_{0};
 
 #ifdef PADDLE_WITH_CUDA
   std::unordered_map<int, cudaEvent_t> events_;
@@ -0,0 +1,98 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/details/op_priority_pass.h"
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/details/all_reduce_op_handle.h"
+#include "paddle/fluid/framework/details/fused_all_reduce_op_handle.h"
+#include "paddle/fluid/framework/details/op_graph_view.h"
+#include "paddle/fluid/framework/details/reduce_op_handle.h"
+#include "paddle/fluid/framework/details/rpc_op_handle.h"
+#include "paddle/fluid/framework/ir/graph_helper.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+// The weight of a computation op is 1.
+static constexpr int64_t kCommunicationOpWeight = 10;
+
+static int64_t OpWeight(OpHandleBase *op) {
+  if (dynamic_cast<AllReduceOpHandle *>(op) != nullptr ||
+      dynamic_cast<FusedAllReduceOpHandle *>(op) != nullptr ||
+      dynamic_cast<ReduceOpHandle *>(op) != nullptr ||
+      dynamic_cast<RPCOpHandle *>(op) != nullptr) {
+    return kCommunicationOpWeight;
+  }
+  return 1;
+}
+
+std::unique_ptr<ir::Graph> OpPriorityPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  auto all_ops = ir::FilterByNodeWrapper<OpHandleBase>(*graph);
+  OpGraphView graph_view(all_ops);
+
+  std::unordered_map<OpHandleBase *, std::vector<OpHandleBase *>>
+      preceding_ops;
+  std::unordered_map<OpHandleBase *, size_t> pending_num;
+  std::queue<OpHandleBase *> ready;
+  for (auto *op : all_ops) {
+    auto &pending_ops = graph_view.PendingOps(op);
+    pending_num[op] = pending_ops.size();
+    for (auto *pending_op : pending_ops) {
+      preceding_ops[pending_op].push_back(op);
+    }
+    if (pending_ops.empty()) {
+      ready.push(op);
+    }
+  }
+
+  // Visit the ops in reversed topological order, so the priorities of all
+  // pending ops are known when an op is visited.
+  size_t visited = 0;
+  while (!ready.empty()) {
+    auto *op = ready.front();
+    ready.pop();
+    ++visited;
+
+    int64_t max_pending_priority = 0;
+    for (auto *pending_op : graph_view.PendingOps(op)) {
+      max_pending_priority =
+          std::max(max_pending_priority, pending_op->Priority());
+    }
+    op->SetPriority(OpWeight(op) + max_pending_priority);
+    VLOG(10) << "priority of " << op->DebugString() << " is "
+             << op->Priority();
+
+    for (auto *preceding_op : preceding_ops[op]) {
+      if (--pending_num[preceding_op] == 0) {
+        ready.push(preceding_op);
+      }
+    }
+  }
+  PADDLE_ENFORCE_EQ(visited, all_ops.size(), "The graph has circles");
+
+  graph->Set<bool>(kOpPriorityScheduling, new bool(true));
+  return graph;
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(op_priority_pass, paddle::framework::details::OpPriorityPass);
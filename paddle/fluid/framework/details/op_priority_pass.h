@@ -0,0 +1,41 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+// The graph attribute set by OpPriorityPass. The SSA graph executors
+// schedule the ready ops by OpHandleBase::Priority() if the graph has it.
+constexpr char kOpPriorityScheduling[] = "op_priority_scheduling";
+
+// Set the priority of each op to the weighted length of the longest path
+// from the op to the end of the graph. Communication ops (all_reduce, reduce
+// and rpc ops) are weighted up, so that the ops they depend on and the
+// communication itself start as early as possible and overlap with the
+// remaining computation.
+class OpPriorityPass : public ir::Pass {
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+};
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,97 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/details/op_priority_pass.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/details/op_handle_base.h"
+#include "paddle/fluid/framework/details/var_handle.h"
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/program_desc.h"
+
+USE_PASS(op_priority_pass);
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+class DummyOpHandle : public OpHandleBase {
+ public:
+  explicit DummyOpHandle(ir::Node *node) : OpHandleBase(node) {}
+
+  std::string Name() const override { return node_->Name(); }
+
+ protected:
+  void RunImpl() override {}
+};
+
+static OpHandleBase *AddOp(ir::Graph *graph, const std::string &name,
+                           const std::vector<OpHandleBase *> &inputs) {
+  auto *op = new DummyOpHandle(
+      graph->CreateEmptyNode(name, ir::Node::Type::kOperation));
+  for (auto *input : inputs) {
+    auto *var = new DummyVarHandle(graph->CreateControlDepVar());
+    input->AddOutput(var);
+    op->AddInput(var);
+  }
+  return op;
+}
+
+// a -> b -> c -> d
+//  \-> e
+TEST(OpPriorityPass, LongestPath) {
+  ProgramDesc program;
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(program));
+  auto *a = AddOp(graph.get(), "a", {});
+  auto *b = AddOp(graph.get(), "b", {a});
+  auto *c = AddOp(graph.get(), "c", {b});
+  auto *d = AddOp(graph.get(), "d", {c});
+  auto *e = AddOp(graph.get(), "e", {a});
+
+  auto pass = ir::PassRegistry::Instance().Get("op_priority_pass");
+  graph = pass->Apply(std::move(graph));
+
+  EXPECT_TRUE(graph->Has(kOpPriorityScheduling));
+  EXPECT_EQ(d->Priority(), 1);
+  EXPECT_EQ(c->Priority(), 2);
+  EXPECT_EQ(b->Priority(), 3);
+  EXPECT_EQ(e->Priority(), 1);
+  EXPECT_EQ(a->Priority(), 4);
+}
+
+// The ops of a diamond take the longer of the two paths.
+TEST(OpPriorityPass, Diamond) {
+  ProgramDesc program;
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(program));
+  auto *a = AddOp(graph.get(), "a", {});
+  auto *b = AddOp(graph.get(), "b", {a});
+  auto *c = AddOp(graph.get(), "c", {b});
+  auto *d = AddOp(graph.get(), "d", {a});
+  auto *e = AddOp(graph.get(), "e", {c, d});
+
+  auto pass = ir::PassRegistry::Instance().Get("op_priority_pass");
+  graph = pass->Apply(std::move(graph));
+
+  EXPECT_EQ(e->Priority(), 1);
+  EXPECT_EQ(d->Priority(), 2);
+  EXPECT_EQ(c->Priority(), 2);
+  EXPECT_EQ(b->Priority(), 3);
+  EXPECT_EQ(a->Priority(), 4);
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
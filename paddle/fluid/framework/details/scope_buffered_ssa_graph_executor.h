@@ -49,9 +49,9 @@ class ScopeBufferedSSAGraphExecutor : public SSAGraphExecutor {
 
  private:
   inline void WaitComputationalStreams() {
-    // Wait All computational streams
+    // Wait All computational streams, including the ones of multi_stream_pass
     for (auto p : places_) {
-      platform::DeviceContextPool::Instance().Get(p)->Wait();
+      platform::DeviceContextPool::Instance().WaitAllStreams(p);
     }
   }
 
@@ -0,0 +1,408 @@
+//   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/details/sharded_lookup_op_handle.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/operators/math/sharded_embedding.h"
+#include "paddle/fluid/platform/profiler.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+namespace {
+
+// The output of lookup_table drops the last dimension of Ids, which is 1.
+DDim LookupOutputDims(const DDim &ids_dims, int64_t width) {
+  auto dims = vectorize(slice_ddim(ids_dims, 0, ids_dims.size() - 1));
+  dims.push_back(width);
+  return make_ddim(dims);
+}
+
+template <typename DeviceContext>
+void LookupRowsOfType(const DeviceContext &ctx, const Tensor &table,
+                      const int64_t *ids, int64_t num_ids, int64_t start,
+                      int64_t padding_idx, void *out) {
+  if (table.type() == proto::VarType::FP32) {
+    operators::math::ShardedLookupFunctor<DeviceContext, float>()(
+        ctx, table, ids, num_ids, start, padding_idx,
+        static_cast<float *>(out));
+  } else if (table.type() == proto::VarType::FP64) {
+    operators::math::ShardedLookupFunctor<DeviceContext, double>()(
+        ctx, table, ids, num_ids, start, padding_idx,
+        static_cast<double *>(out));
+  } else {
+    PADDLE_THROW("The sharded lookup table only supports float and double.");
+  }
+}
+
+}  // namespace
+
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+ShardedLookupOpHandleBase::ShardedLookupOpHandleBase(
+    ir::Node *node, const std::vector<Scope *> &local_scopes,
+    const std::vector<platform::Place> &places,
+    const platform::NCCLContextMap *ctxs, int64_t height, int64_t padding_idx)
+    : OpHandleBase(node),
+      padded_ids_(places.size()),
+      gathered_ids_(places.size()),
+      local_scopes_(local_scopes),
+      places_(places),
+      nccl_ctxs_(ctxs),
+      height_(height),
+      padding_idx_(padding_idx) {
+  if (nccl_ctxs_) {
+    for (auto &p : places_) {
+      this->SetDeviceContext(p, nccl_ctxs_->DevCtx(p));
+    }
+  }
+}
+#else
+ShardedLookupOpHandleBase::ShardedLookupOpHandleBase(
+    ir::Node *node, const std::vector<Scope *> &local_scopes,
+    const std::vector<platform::Place> &places, int64_t height,
+    int64_t padding_idx)
+    : OpHandleBase(node),
+      local_scopes_(local_scopes),
+      places_(places),
+      height_(height),
+      padding_idx_(padding_idx) {}
+#endif
+
+Scope *ShardedLookupOpHandleBase::ExecScope(size_t i) const {
+  return local_scopes_[i]->FindVar(kLocalExecScopeName)->Get<Scope *>();
+}
+
+void ShardedLookupOpHandleBase::LookupRows(size_t i, const Tensor &table,
+                                           const int64_t *ids, int64_t num_ids,
+                                           int64_t start, int64_t padding_idx,
+                                           void *out) const {
+  auto *dev_ctx = dev_ctxes_.at(places_[i]);
+  if (platform::is_gpu_place(places_[i])) {
+#ifdef PADDLE_WITH_CUDA
+    LookupRowsOfType(*static_cast<platform::CUDADeviceContext *>(dev_ctx),
+                     table, ids, num_ids, start, padding_idx, out);
+#else
+    PADDLE_THROW("Not compiled with CUDA");
+#endif
+  } else {
+    LookupRowsOfType(*static_cast<platform::CPUDeviceContext *>(dev_ctx),
+                     table, ids, num_ids, start, padding_idx, out);
+  }
+}
+
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+void ShardedLookupOpHandleBase::AllGatherIds(
+    const std::vector<const LoDTensor *> &ids, int64_t max_ids) {
+  size_t num = places_.size();
+  for (size_t i = 0; i < num; ++i) {
+    auto &place = boost::get<platform::CUDAPlace>(places_[i]);
+    auto stream = nccl_ctxs_->at(places_[i]).stream();
+    auto *padded = padded_ids_[i].mutable_data<int64_t>({max_ids}, place);
+    gathered_ids_[i].mutable_data<int64_t>(
+        {static_cast<int64_t>(num) * max_ids}, place);
+    // All the bytes of -1 are 0xff.
+    platform::GpuMemsetAsync(padded, 0xff, max_ids * sizeof(int64_t), stream);
+    memory::Copy(place, padded, place, ids[i]->data<int64_t>(),
+                 ids[i]->numel() * sizeof(int64_t), stream);
+  }
+  platform::NCCLGroupGuard guard;
+  for (size_t i = 0; i < num; ++i) {
+    auto &nccl_ctx = nccl_ctxs_->at(places_[i]);
+    PADDLE_ENFORCE(platform::dynload::ncclAllGather(
+        padded_ids_[i].data<int64_t>(), gathered_ids_[i].data<int64_t>(),
+        max_ids, ncclInt64, nccl_ctx.comm_, nccl_ctx.stream()));
+  }
+}
+#endif
+
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+ShardedLookupOpHandle::ShardedLookupOpHandle(
+    ir::Node *node, const std::vector<Scope *> &local_scopes,
+    const std::vector<platform::Place> &places,
+    const platform::NCCLContextMap *ctxs, int64_t height, int64_t padding_idx,
+    const std::string &table_name, const std::string &ids_name,
+    const std::string &out_name)
+    : ShardedLookupOpHandleBase(node, local_scopes, places, ctxs, height,
+                                padding_idx),
+      table_name_(table_name),
+      ids_name_(ids_name),
+      out_name_(out_name),
+      gathered_rows_(places.size()) {}
+#else
+ShardedLookupOpHandle::ShardedLookupOpHandle(
+    ir::Node *node, const std::vector<Scope *> &local_scopes,
+    const std::vector<platform::Place> &places, int64_t height,
+    int64_t padding_idx, const std::string &table_name,
+    const std::string &ids_name, const std::string &out_name)
+    : ShardedLookupOpHandleBase(node, local_scopes, places, height,
+                                padding_idx),
+      table_name_(table_name),
+      ids_name_(ids_name),
+      out_name_(out_name) {}
+#endif
+
+void ShardedLookupOpHandle::RunImpl() {
+  platform::RecordEvent record_event(Name(), dev_ctxes_.cbegin()->second);
+
+  WaitInputVarGenerated();
+  size_t num = places_.size();
+  std::vector<const LoDTensor *> ids(num);
+  std::vector<const LoDTensor *> tables(num);
+  std::vector<LoDTensor *> outs(num);
+  int64_t max_ids = 0;
+  for (size_t i = 0; i < num; ++i) {
+    auto *scope = ExecScope(i);
+    ids[i] = &scope->FindVar(ids_name_)->Get<LoDTensor>();
+    tables[i] = &scope->FindVar(table_name_)->Get<LoDTensor>();
+    outs[i] = scope->FindVar(out_name_)->GetMutable<LoDTensor>();
+    PADDLE_ENFORCE_EQ(ids[i]->type(), proto::VarType::INT64,
+                      "The ids of the sharded lookup table should be int64.");
+    auto range = ShardRange(height_, num, i);
+    PADDLE_ENFORCE_EQ(tables[i]->dims()[0], range.second - range.first,
+                      "The rows of %s on device %d do not match its shard.",
+                      table_name_, i);
+    max_ids = std::max(max_ids, ids[i]->numel());
+  }
+  int64_t width = tables[0]->dims()[1];
+  auto dtype = tables[0]->type();
+
+  if (platform::is_gpu_place(places_[0])) {
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+    PADDLE_ENFORCE(nccl_ctxs_, "nccl_ctxs should not be nullptr.");
+    if (max_ids == 0) {
+      for (size_t i = 0; i < num; ++i) {
+        outs[i]->Resize(LookupOutputDims(ids[i]->dims(), width));
+        outs[i]->mutable_data(places_[i], dtype);
+      }
+      return;
+    }
+    for (size_t i = 0; i < num; ++i) {
+      gathered_rows_[i].Resize({static_cast<int64_t>(num) * max_ids, width});
+      gathered_rows_[i].mutable_data(places_[i], dtype);
+      // Reduce-scatter into the padded output, which is cut to the ids.
+      outs[i]->Resize({max_ids, width});
+      outs[i]->mutable_data(places_[i], dtype);
+    }
+    this->RunAndRecordEvent([&] {
+      AllGatherIds(ids, max_ids);
+      for (size_t i = 0; i < num; ++i) {
+        auto range = ShardRange(height_, num, i);
+        auto stream = nccl_ctxs_->at(places_[i]).stream();
+        platform::GpuMemsetAsync(gathered_rows_[i].data<void>(), 0,
+                                 gathered_rows_[i].numel() * SizeOfType(dtype),
+                                 stream);
+        LookupRows(i, *tables[i], gathered_ids_[i].data<int64_t>(),
+                   static_cast<int64_t>(num) * max_ids, range.first,
+                   padding_idx_, gathered_rows_[i].data<void>());
+      }
+      platform::NCCLGroupGuard guard;
+      for (size_t i = 0; i < num; ++i) {
+        auto &nccl_ctx = nccl_ctxs_->at(places_[i]);
+        PADDLE_ENFORCE(platform::dynload::ncclReduceScatter(
+            gathered_rows_[i].data<void>(), outs[i]->data<void>(),
+            max_ids * width, platform::ToNCCLDataType(dtype), ncclSum,
+            nccl_ctx.comm_, nccl_ctx.stream()));
+      }
+    });
+    for (size_t i = 0; i < num; ++i) {
+      outs[i]->Resize(LookupOutputDims(ids[i]->dims(), width));
+      outs[i]->set_lod(ids[i]->lod());
+    }
+#else
+    PADDLE_THROW("Not compiled with CUDA");
+#endif
+  } else {
+    // Each id of a device is looked up in the shard of its row directly.
+    for (size_t j = 0; j < num; ++j) {
+      outs[j]->Resize(LookupOutputDims(ids[j]->dims(), width));
+      outs[j]->set_lod(ids[j]->lod());
+      void *out = outs[j]->mutable_data(places_[j], dtype);
+      std::memset(out, 0, outs[j]->numel() * SizeOfType(dtype));
+      for (size_t i = 0; i < num; ++i) {
+        LookupRows(j, *tables[i], ids[j]->data<int64_t>(), ids[j]->numel(),
+                   ShardRange(height_, num, i).first, padding_idx_, out);
+      }
+    }
+  }
+}
+
+std::string ShardedLookupOpHandle::Name() const { return "sharded_lookup"; }
+
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+ShardedLookupGradOpHandle::ShardedLookupGradOpHandle(
+    ir::Node *node, const std::vector<Scope *> &local_scopes,
+    const std::vector<platform::Place> &places,
+    const platform::NCCLContextMap *ctxs, int64_t height, int64_t padding_idx,
+    const std::string &ids_name, const std::string &out_grad_name,
+    const std::string &table_grad_name)
+    : ShardedLookupOpHandleBase(node, local_scopes, places, ctxs, height,
+                                padding_idx),
+      ids_name_(ids_name),
+      out_grad_name_(out_grad_name),
+      table_grad_name_(table_grad_name),
+      padded_grads_(places.size()),
+      gathered_grads_(places.size()),
+      positions_(places.size()) {}
+#else
+ShardedLookupGradOpHandle::ShardedLookupGradOpHandle(
+    ir::Node *node, const std::vector<Scope *> &local_scopes,
+    const std::vector<platform::Place> &places, int64_t height,
+    int64_t padding_idx, const std::string &ids_name,
+    const std::string &out_grad_name, const std::string &table_grad_name)
+    : ShardedLookupOpHandleBase(node, local_scopes, places, height,
+                                padding_idx),
+      ids_name_(ids_name),
+      out_grad_name_(out_grad_name),
+      table_grad_name_(table_grad_name) {}
+#endif
+
+void ShardedLookupGradOpHandle::RunImpl() {
+  platform::RecordEvent record_event(Name(), dev_ctxes_.cbegin()->second);
+
+  WaitInputVarGenerated();
+  size_t num = places_.size();
+  std::vector<const LoDTensor *> ids(num);
+  std::vector<const LoDTensor *> out_grads(num);
+  std::vector<SelectedRows *> table_grads(num);
+  int64_t max_ids = 0;
+  for (size_t i = 0; i < num; ++i) {
+    auto *scope = ExecScope(i);
+    ids[i] = &scope->FindVar(ids_name_)->Get<LoDTensor>();
+    out_grads[i] = &scope->FindVar(out_grad_name_)->Get<LoDTensor>();
+    table_grads[i] =
+        scope->FindVar(table_grad_name_)->GetMutable<SelectedRows>();
+    max_ids = std::max(max_ids, ids[i]->numel());
+  }
+  auto &out_dims = out_grads[0]->dims();
+  int64_t width = out_dims[out_dims.size() - 1];
+  auto dtype = out_grads[0]->type();
+  size_t row_bytes = width * SizeOfType(dtype);
+
+  if (platform::is_gpu_place(places_[0])) {
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+    PADDLE_ENFORCE(nccl_ctxs_, "nccl_ctxs should not be nullptr.");
+    std::vector<int64_t> all_ids(num * max_ids);
+    if (max_ids > 0) {
+      for (size_t i = 0; i < num; ++i) {
+        padded_grads_[i].Resize({max_ids, width});
+        padded_grads_[i].mutable_data(places_[i], dtype);
+        gathered_grads_[i].Resize({static_cast<int64_t>(num) * max_ids, width});
+        gathered_grads_[i].mutable_data(places_[i], dtype);
+      }
+      this->RunAndRecordEvent([&] {
+        AllGatherIds(ids, max_ids);
+        for (size_t i = 0; i < num; ++i) {
+          auto &place = boost::get<platform::CUDAPlace>(places_[i]);
+          // The rows of the padding ids are never read.
+          memory::Copy(place, padded_grads_[i].data<void>(), place,
+                       out_grads[i]->data<void>(),
+                       ids[i]->numel() * row_bytes,
+                       nccl_ctxs_->at(places_[i]).stream());
+        }
+        platform::NCCLGroupGuard guard;
+        for (size_t i = 0; i < num; ++i) {
+          auto &nccl_ctx = nccl_ctxs_->at(places_[i]);
+          PADDLE_ENFORCE(platform::dynload::ncclAllGather(
+              padded_grads_[i].data<void>(), gathered_grads_[i].data<void>(),
+              max_ids * width, platform::ToNCCLDataType(dtype), nccl_ctx.comm_,
+              nccl_ctx.stream()));
+        }
+      });
+      // The gathered ids are the same on all the devices.
+      auto stream = nccl_ctxs_->at(places_[0]).stream();
+      memory::Copy(platform::CPUPlace(), all_ids.data(),
+                   boost::get<platform::CUDAPlace>(places_[0]),
+                   gathered_ids_[0].data<int64_t>(),
+                   all_ids.size() * sizeof(int64_t), stream);
+      PADDLE_ENFORCE(cudaStreamSynchronize(stream));
+    }
+
+    std::vector<std::vector<int64_t>> positions(num);
+    for (size_t i = 0; i < num; ++i) {
+      auto range = ShardRange(height_, num, i);
+      std::vector<int64_t> rows;
+      for (size_t k = 0; k < all_ids.size(); ++k) {
+        int64_t id = all_ids[k];
+        if (id >= range.first && id < range.second && id != padding_idx_) {
+          positions[i].push_back(static_cast<int64_t>(k));
+          rows.push_back(id - range.first);
+        }
+      }
+      table_grads[i]->set_height(range.second - range.first);
+      table_grads[i]->set_rows(rows);
+      auto *value = table_grads[i]->mutable_value();
+      value->Resize({static_cast<int64_t>(rows.size()), width});
+      value->mutable_data(places_[i], dtype);
+    }
+    this->RunAndRecordEvent([&] {
+      for (size_t i = 0; i < num; ++i) {
+        if (positions[i].empty()) continue;
+        TensorFromVector(positions[i], *dev_ctxes_.at(places_[i]),
+                         &positions_[i]);
+        LookupRows(i, gathered_grads_[i], positions_[i].data<int64_t>(),
+                   static_cast<int64_t>(positions[i].size()), 0, -1,
+                   table_grads[i]->mutable_value()->data<void>());
+      }
+    });
+#else
+    PADDLE_THROW("Not compiled with CUDA");
+#endif
+  } else {
+    // Gather the gradients of the ids in the shard of each device from the
+    // gradients of all the devices.
+    for (size_t i = 0; i < num; ++i) {
+      auto range = ShardRange(height_, num, i);
+      std::vector<int64_t> rows;
+      std::vector<std::vector<int64_t>> positions(num);
+      for (size_t j = 0; j < num; ++j) {
+        const int64_t *data = ids[j]->data<int64_t>();
+        for (int64_t k = 0; k < ids[j]->numel(); ++k) {
+          if (data[k] >= range.first && data[k] < range.second &&
+              data[k] != padding_idx_) {
+            positions[j].push_back(k);
+            rows.push_back(data[k] - range.first);
+          }
+        }
+      }
+      table_grads[i]->set_height(range.second - range.first);
+      table_grads[i]->set_rows(rows);
+      auto *value = table_grads[i]->mutable_value();
+      value->Resize({static_cast<int64_t>(rows.size()), width});
+      auto *out =
+          static_cast<uint8_t *>(value->mutable_data(places_[i], dtype));
+      for (size_t j = 0; j < num; ++j) {
+        Tensor out_grad;
+        out_grad.ShareDataWith(*out_grads[j]).Resize({ids[j]->numel(), width});
+        LookupRows(i, out_grad, positions[j].data(),
+                   static_cast<int64_t>(positions[j].size()), 0, -1, out);
+        out += positions[j].size() * row_bytes;
+      }
+    }
+  }
+}
+
+std::string ShardedLookupGradOpHandle::Name() const {
+  return "sharded_lookup_grad";
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,163 @@
+//   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "paddle/fluid/framework/details/op_handle_base.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/scope.h"
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+#include "paddle/fluid/platform/nccl_helper.h"
+#endif
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+// The rows [start, end) of a table of height rows held by device i of the
+// num_shards devices, the sizes of the shards differ by at most one row.
+inline std::pair<int64_t, int64_t> ShardRange(int64_t height,
+                                              size_t num_shards, size_t i) {
+  int64_t n = static_cast<int64_t>(num_shards);
+  int64_t k = static_cast<int64_t>(i);
+  return std::make_pair(height * k / n, height * (k + 1) / n);
+}
+
+// The lookup_table and lookup_table_grad ops of a table sharded by rows
+// between the devices. NCCL has no all-to-all, so the ids of all the devices
+// are all-gathered, each device looks up the ids in its rows, and the rows are
+// reduce-scattered back to the devices of the ids, where only the owner of a
+// row contributes a non-zero value.
+struct ShardedLookupOpHandleBase : public OpHandleBase {
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+  ShardedLookupOpHandleBase(ir::Node *node,
+                            const std::vector<Scope *> &local_scopes,
+                            const std::vector<platform::Place> &places,
+                            const platform::NCCLContextMap *ctxs,
+                            int64_t height, int64_t padding_idx);
+#else
+  ShardedLookupOpHandleBase(ir::Node *node,
+                            const std::vector<Scope *> &local_scopes,
+                            const std::vector<platform::Place> &places,
+                            int64_t height, int64_t padding_idx);
+#endif
+
+  bool IsMultiDeviceTransfer() override { return true; };
+
+ protected:
+  Scope *ExecScope(size_t i) const;
+
+  // Copy the rows of ids in the shard of the table to out.
+  void LookupRows(size_t i, const Tensor &table, const int64_t *ids,
+                  int64_t num_ids, int64_t start, int64_t padding_idx,
+                  void *out) const;
+
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+  // All-gather the ids of the devices, padded to max_ids by -1, into
+  // gathered_ids_ on the NCCL streams.
+  void AllGatherIds(const std::vector<const LoDTensor *> &ids,
+                    int64_t max_ids);
+
+  std::vector<Tensor> padded_ids_;
+  std::vector<Tensor> gathered_ids_;
+#endif
+
+  std::vector<Scope *> local_scopes_;
+  std::vector<platform::Place> places_;
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+  const platform::NCCLContextMap *nccl_ctxs_;
+#endif
+  int64_t height_;
+  int64_t padding_idx_;
+};
+
+struct ShardedLookupOpHandle : public ShardedLookupOpHandleBase {
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+  ShardedLookupOpHandle(ir::Node *node,
+                        const std::vector<Scope *> &local_scopes,
+                        const std::vector<platform::Place> &places,
+                        const platform::NCCLContextMap *ctxs,
+                        int64_t height, int64_t padding_idx,
+                        const std::string &table_name,
+                        const std::string &ids_name,
+                        const std::string &out_name);
+#else
+  ShardedLookupOpHandle(ir::Node *node,
+                        const std::vector<Scope *> &local_scopes,
+                        const std::vector<platform::Place> &places,
+                        int64_t height, int64_t padding_idx,
+                        const std::string &table_name,
+                        const std::string &ids_name,
+                        const std::string &out_name);
+#endif
+
+  std::string Name() const override;
+
+ protected:
+  void RunImpl() override;
+
+ private:
+  std::string table_name_;
+  std::string ids_name_;
+  std::string out_name_;
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+  std::vector<Tensor> gathered_rows_;
+#endif
+};
+
+// The gradient of each device is a SelectedRows of the rows of its shard,
+// which is complete without the all-reduce of the gradients.
+struct ShardedLookupGradOpHandle : public ShardedLookupOpHandleBase {
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+  ShardedLookupGradOpHandle(ir::Node *node,
+                            const std::vector<Scope *> &local_scopes,
+                            const std::vector<platform::Place> &places,
+                            const platform::NCCLContextMap *ctxs,
+                            int64_t height, int64_t padding_idx,
+                            const std::string &ids_name,
+                            const std::string &out_grad_name,
+                            const std::string &table_grad_name);
+#else
+  ShardedLookupGradOpHandle(ir::Node *node,
+                            const std::vector<Scope *> &local_scopes,
+                            const std::vector<platform::Place> &places,
+                            int64_t height, int64_t padding_idx,
+                            const std::string &ids_name,
+                            const std::string &out_grad_name,
+                            const std::string &table_grad_name);
+#endif
+
+  std::string Name() const override;
+
+ protected:
+  void RunImpl() override;
+
+ private:
+  std::string ids_name_;
+  std::string out_grad_name_;
+  std::string table_grad_name_;
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+  std::vector<Tensor> padded_grads_;
+  std::vector<Tensor> gathered_grads_;
+  std::vector<Tensor> positions_;
+#endif
+};
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,206 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/details/swap_activation_pass.h"
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "gflags/gflags.h"
+#include "paddle/fluid/framework/details/computation_op_handle.h"
+#include "paddle/fluid/framework/details/multi_devices_helper.h"
+#include "paddle/fluid/framework/details/swap_op_handle.h"
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+DEFINE_double(swap_activation_min_mb, 1.0,
+              "The activations smaller than this size in MB are kept on "
+              "device by swap_activation_pass.");
+DEFINE_int32(swap_prefetch_distance, 2,
+             "The swap in of an activation starts after the backward op "
+             "which is this number of backward ops before the first one "
+             "using the activation on the same device.");
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+#ifdef PADDLE_WITH_CUDA
+
+static int GetOpRole(OpHandleBase *op) {
+  auto *desc = op->Node()->Op();
+  auto role_attr = OpProtoAndCheckerMaker::OpRoleAttrName();
+  if (desc == nullptr || !desc->HasAttr(role_attr)) {
+    return static_cast<int>(OpRole::kNotSpecified);
+  }
+  return boost::get<int>(desc->GetAttr(role_attr));
+}
+
+static bool IsForwardOp(OpHandleBase *op) {
+  int role = GetOpRole(op);
+  return role == static_cast<int>(OpRole::kForward) ||
+         role == (static_cast<int>(OpRole::kForward) |
+                  static_cast<int>(OpRole::kLoss));
+}
+
+static bool IsBackwardOp(OpHandleBase *op) {
+  return GetOpRole(op) & static_cast<int>(OpRole::kBackward);
+}
+
+static void AddDependency(ir::Graph *graph, OpHandleBase *from,
+                          OpHandleBase *to) {
+  auto *dep_var = new DummyVarHandle(graph->CreateControlDepVar());
+  graph->Get<GraphDepVars>(kGraphDepVars).emplace(dep_var);
+  from->AddOutput(dep_var);
+  to->AddInput(dep_var);
+}
+
+// Whether the var can be swapped out after its forward readers. Return the
+// forward and backward readers of it.
+static bool IsSwappable(VarHandle *var, const GraphVars &graph_vars,
+                        std::vector<ComputationOpHandle *> *fwd_readers,
+                        std::vector<ComputationOpHandle *> *bwd_readers) {
+  auto *desc = var->Node()->Var();
+  if (desc == nullptr || desc->Persistable() ||
+      desc->GetType() != proto::VarType::LOD_TENSOR) {
+    return false;
+  }
+  // The swap ops may not be ordered with the writers of the other versions.
+  if (graph_vars[var->scope_idx_].at(var->name_).size() != 1) return false;
+
+  auto *generator = dynamic_cast<ComputationOpHandle *>(var->GeneratedOp());
+  for (auto *op : var->PendingOps()) {
+    auto *reader = dynamic_cast<ComputationOpHandle *>(op);
+    if (reader == nullptr || reader->GetScope() != generator->GetScope()) {
+      return false;
+    }
+    if (IsBackwardOp(reader)) {
+      bwd_readers->emplace_back(reader);
+    } else if (IsForwardOp(reader)) {
+      fwd_readers->emplace_back(reader);
+    } else {
+      return false;
+    }
+  }
+  return !bwd_readers->empty();
+}
+
+#endif
+
+std::unique_ptr<ir::Graph> SwapActivationPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+#ifdef PADDLE_WITH_CUDA
+  auto *resources = new SwapResources();
+  graph->Set<SwapResources>(kSwapResources, resources);  // take ownership
+
+  auto &graph_vars = graph->Get<GraphVars>(kGraphVars);
+  size_t min_bytes =
+      static_cast<size_t>(FLAGS_swap_activation_min_mb * (1 << 20));
+  int distance = std::max(FLAGS_swap_prefetch_distance, 0);
+
+  // The ops in topological order, and the backward computation ops of each
+  // scope with their positions.
+  std::vector<OpHandleBase *> sorted_ops;
+  std::unordered_map<const Scope *, std::vector<ComputationOpHandle *>>
+      backward_ops;
+  std::unordered_map<OpHandleBase *, size_t> sorted_pos;
+  std::unordered_map<OpHandleBase *, size_t> backward_pos;
+  for (auto *node : ir::TopologySortOperations(*graph)) {
+    if (!node->IsWrappedBy<OpHandleBase>()) continue;
+    auto *op = &node->Wrapper<OpHandleBase>();
+    sorted_pos[op] = sorted_ops.size();
+    sorted_ops.emplace_back(op);
+    auto *compute_op = dynamic_cast<ComputationOpHandle *>(op);
+    if (compute_op != nullptr && IsBackwardOp(compute_op)) {
+      auto &ops = backward_ops[compute_op->GetScope()];
+      backward_pos[compute_op] = ops.size();
+      ops.emplace_back(compute_op);
+    }
+  }
+
+  size_t num_swapped = 0;
+  for (auto *op : sorted_ops) {
+    auto *generator = dynamic_cast<ComputationOpHandle *>(op);
+    if (generator == nullptr || !IsForwardOp(generator) ||
+        !platform::is_gpu_place(generator->GetPlace())) {
+      continue;
+    }
+    for (auto *out : generator->Outputs()) {
+      auto *var = dynamic_cast<VarHandle *>(out);
+      if (var == nullptr) continue;
+      std::vector<ComputationOpHandle *> fwd_readers;
+      std::vector<ComputationOpHandle *> bwd_readers;
+      if (!IsSwappable(var, graph_vars, &fwd_readers, &bwd_readers)) {
+        continue;
+      }
+
+      size_t first_pos = backward_pos.at(bwd_readers[0]);
+      size_t first_sorted_pos = sorted_pos.at(bwd_readers[0]);
+      for (auto *reader : bwd_readers) {
+        first_pos = std::min(first_pos, backward_pos.at(reader));
+        first_sorted_pos = std::min(first_sorted_pos, sorted_pos.at(reader));
+      }
+      // The forward readers must not depend on the backward readers, or the
+      // swap ops make a circle.
+      bool fwd_first = true;
+      for (auto *reader : fwd_readers) {
+        fwd_first &= sorted_pos.at(reader) < first_sorted_pos;
+      }
+      if (!fwd_first) continue;
+      // Not worth swapping if it is used right after the forward pass.
+      if (first_pos < static_cast<size_t>(distance)) continue;
+      auto &ops = backward_ops.at(generator->GetScope());
+      auto *trigger = ops[first_pos - distance];
+
+      auto place = boost::get<platform::CUDAPlace>(generator->GetPlace());
+      auto *space = resources->NewSpace(place.device);
+      auto stream = resources->Stream(place.device);
+      auto *swap_out = new SwapOutOpHandle(
+          graph->CreateEmptyNode("swap_out", ir::Node::Type::kOperation),
+          generator->GetScope(), place, var->name_, min_bytes, space, stream);
+      auto *swap_in = new SwapInOpHandle(
+          graph->CreateEmptyNode("swap_in", ir::Node::Type::kOperation),
+          generator->GetScope(), place, var->name_, space, stream);
+
+      AddDependency(graph.get(), generator, swap_out);
+      for (auto *reader : fwd_readers) {
+        AddDependency(graph.get(), reader, swap_out);
+      }
+      AddDependency(graph.get(), swap_out, swap_in);
+      AddDependency(graph.get(), trigger, swap_in);
+      auto *ready_var = new DummyVarHandle(graph->CreateControlDepVar());
+      graph->Get<GraphDepVars>(kGraphDepVars).emplace(ready_var);
+      swap_in->AddOutput(ready_var);
+      for (auto *reader : bwd_readers) {
+        reader->AddInput(ready_var);
+      }
+      ++num_swapped;
+      VLOG(10) << "swap " << var->name_ << " on " << place << " after "
+               << trigger->DebugString();
+    }
+  }
+  VLOG(3) << "swap_activation_pass inserts " << num_swapped
+          << " pairs of swap ops";
+#else
+  LOG(WARNING) << "swap_activation_pass only works with GPU, it is skipped";
+#endif
+  return graph;
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(swap_activation_pass,
+              paddle::framework::details::SwapActivationPass);
@@ -0,0 +1,47 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+// Swap the activations which are kept alive from the forward ops to the
+// backward ops out to the pinned host memory, and swap them back in before
+// the backward ops using them.
+//
+// For each forward output on GPU which is read by a backward op, a
+// SwapOutOpHandle is inserted after the forward ops using it, and a
+// SwapInOpHandle is inserted before the first backward op using it. The swap
+// in starts after the backward op which is FLAGS_swap_prefetch_distance ops
+// earlier on the same device, so that the copy overlaps with the computation.
+// The activations smaller than FLAGS_swap_activation_min_mb are not swapped.
+//
+// The swap ops are only connected by dummy vars, so the reference counts of
+// the variables are unchanged and the eager deletion still frees them after
+// the backward ops.
+class SwapActivationPass : public ir::Pass {
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+};
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,174 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifdef PADDLE_WITH_CUDA
+
+#include "paddle/fluid/framework/details/swap_op_handle.h"
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/platform/cuda_device_guard.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+SwapSpace::SwapSpace(int device) : device_(device) {
+  platform::CUDADeviceGuard guard(device_);
+  PADDLE_ENFORCE(cudaEventCreateWithFlags(&event_, cudaEventDisableTiming));
+}
+
+SwapSpace::~SwapSpace() {
+  platform::CUDADeviceGuard guard(device_);
+  cudaEventSynchronize(event_);
+  host_buffer_.reset();
+  cudaEventDestroy(event_);
+}
+
+SwapResources::~SwapResources() {
+  spaces_.clear();
+  for (auto &pair : streams_) {
+    platform::CUDADeviceGuard guard(pair.first);
+    cudaStreamDestroy(pair.second);
+  }
+}
+
+cudaStream_t SwapResources::Stream(int device) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto it = streams_.find(device);
+  if (it != streams_.end()) return it->second;
+  platform::CUDADeviceGuard guard(device);
+  cudaStream_t stream;
+  PADDLE_ENFORCE(cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking));
+  streams_.emplace(device, stream);
+  return stream;
+}
+
+SwapSpace *SwapResources::NewSpace(int device) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  spaces_.emplace_back(new SwapSpace(device));
+  return spaces_.back().get();
+}
+
+static LoDTensor *FindLoDTensor(const Scope *scope,
+                                const std::string &var_name) {
+  auto *exec_scope = scope->FindVar(kLocalExecScopeName)->Get<Scope *>();
+  auto *var = exec_scope->FindVar(var_name);
+  if (var == nullptr || !var->IsType<LoDTensor>()) return nullptr;
+  return var->GetMutable<LoDTensor>();
+}
+
+SwapOutOpHandle::SwapOutOpHandle(ir::Node *node, const Scope *scope,
+                                 const platform::CUDAPlace &place,
+                                 const std::string &var_name, size_t min_bytes,
+                                 SwapSpace *space, cudaStream_t stream)
+    : OpHandleBase(node),
+      scope_(scope),
+      place_(place),
+      var_name_(var_name),
+      min_bytes_(min_bytes),
+      space_(space),
+      stream_(stream) {
+  dev_ctx_ = static_cast<platform::CUDADeviceContext *>(
+      platform::DeviceContextPool::Instance().Get(place));
+  SetDeviceContext(place, dev_ctx_);
+}
+
+std::string SwapOutOpHandle::Name() const { return "swap_out"; }
+
+void SwapOutOpHandle::RunImpl() {
+  space_->swapped_ = false;
+  auto *tensor = FindLoDTensor(scope_, var_name_);
+  if (tensor == nullptr || !tensor->IsInitialized() ||
+      !platform::is_gpu_place(tensor->place())) {
+    return;
+  }
+  size_t size = tensor->numel() * SizeOfType(tensor->type());
+  if (size < min_bytes_) return;
+
+  platform::CUDADeviceGuard guard(place_.device);
+  if (space_->host_buffer_ == nullptr || space_->host_buffer_->size() < size) {
+    // The last copy of the old buffer must complete before it is freed.
+    PADDLE_ENFORCE(cudaEventSynchronize(space_->event_));
+    space_->host_buffer_.reset();
+    space_->host_buffer_ = memory::Alloc(platform::CUDAPinnedPlace(), size);
+  }
+
+  PADDLE_ENFORCE(cudaEventRecord(space_->event_, dev_ctx_->stream()));
+  PADDLE_ENFORCE(cudaStreamWaitEvent(stream_, space_->event_, 0));
+  PADDLE_ENFORCE(cudaMemcpyAsync(space_->host_buffer_->ptr(),
+                                 tensor->data<void>(), size,
+                                 cudaMemcpyDeviceToHost, stream_));
+  PADDLE_ENFORCE(cudaEventRecord(space_->event_, stream_));
+  PADDLE_ENFORCE(cudaEventSynchronize(space_->event_));
+
+  VLOG(10) << "Swap out " << var_name_ << " of " << size << " bytes on "
+           << place_;
+  space_->type_ = tensor->type();
+  space_->size_ = size;
+  // The dims and the LoD are kept.
+  tensor->MoveMemoryHolder();
+  space_->swapped_ = true;
+}
+
+SwapInOpHandle::SwapInOpHandle(ir::Node *node, const Scope *scope,
+                               const platform::CUDAPlace &place,
+                               const std::string &var_name, SwapSpace *space,
+                               cudaStream_t stream)
+    : OpHandleBase(node),
+      scope_(scope),
+      place_(place),
+      var_name_(var_name),
+      space_(space),
+      stream_(stream) {
+  dev_ctx_ = static_cast<platform::CUDADeviceContext *>(
+      platform::DeviceContextPool::Instance().Get(place));
+  SetDeviceContext(place, dev_ctx_);
+}
+
+std::string SwapInOpHandle::Name() const { return "swap_in"; }
+
+void SwapInOpHandle::RunImpl() {
+  if (!space_->swapped_) return;
+  auto *tensor = FindLoDTensor(scope_, var_name_);
+  PADDLE_ENFORCE_NOT_NULL(tensor, "The swapped variable %s is not found",
+                          var_name_);
+
+  platform::CUDADeviceGuard guard(place_.device);
+  void *dst = tensor->mutable_data(place_, space_->type_);
+  PADDLE_ENFORCE_EQ(tensor->numel() * SizeOfType(space_->type_), space_->size_,
+                    "The size of %s is changed after swapped out", var_name_);
+
+  // The new device memory may be still used by the ops before it on the
+  // compute stream.
+  auto compute_stream = dev_ctx_->stream();
+  PADDLE_ENFORCE(cudaEventRecord(space_->event_, compute_stream));
+  PADDLE_ENFORCE(cudaStreamWaitEvent(stream_, space_->event_, 0));
+  PADDLE_ENFORCE(cudaMemcpyAsync(dst, space_->host_buffer_->ptr(),
+                                 space_->size_, cudaMemcpyHostToDevice,
+                                 stream_));
+  PADDLE_ENFORCE(cudaEventRecord(space_->event_, stream_));
+  PADDLE_ENFORCE(cudaStreamWaitEvent(compute_stream, space_->event_, 0));
+
+  VLOG(10) << "Swap in " << var_name_ << " of " << space_->size_
+           << " bytes on " << place_;
+  space_->swapped_ = false;
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
+
+#endif
@@ -0,0 +1,125 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#ifdef PADDLE_WITH_CUDA
+
+#include <cuda_runtime.h>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/details/op_handle_base.h"
+#include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/memory/malloc.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace framework {
+class Scope;
+
+namespace details {
+
+// The pinned host buffer of a swapped variable on one device, which is shared
+// by its SwapOutOpHandle and SwapInOpHandle.
+struct SwapSpace {
+  explicit SwapSpace(int device);
+
+  ~SwapSpace();
+
+  int device_;
+  // Recorded after the last copy of the buffer on the swap stream.
+  cudaEvent_t event_{nullptr};
+  memory::AllocationPtr host_buffer_;
+  proto::VarType::Type type_;
+  size_t size_{0};
+  bool swapped_{false};
+};
+
+// The swap streams of the devices and the swap spaces, which are owned by
+// the graph as the attribute kSwapResources.
+class SwapResources {
+ public:
+  ~SwapResources();
+
+  cudaStream_t Stream(int device);
+
+  SwapSpace *NewSpace(int device);
+
+ private:
+  std::mutex mtx_;
+  std::map<int, cudaStream_t> streams_;
+  std::vector<std::unique_ptr<SwapSpace>> spaces_;
+};
+
+constexpr char kSwapResources[] = "swap_resources";
+
+// Copy the LoDTensor to the pinned host memory on the swap stream after the
+// ops before it on the compute stream, and free its device memory. The
+// tensor is kept on device if it is smaller than min_bytes.
+//
+// NOTE: It waits for the copy on the host, so the device memory is freed
+// only after the copy completes, without blocking the compute stream.
+class SwapOutOpHandle : public OpHandleBase {
+ public:
+  SwapOutOpHandle(ir::Node *node, const Scope *scope,
+                  const platform::CUDAPlace &place, const std::string &var_name,
+                  size_t min_bytes, SwapSpace *space, cudaStream_t stream);
+
+  std::string Name() const override;
+
+ protected:
+  void RunImpl() override;
+
+ private:
+  const Scope *scope_;
+  platform::CUDAPlace place_;
+  std::string var_name_;
+  size_t min_bytes_;
+  SwapSpace *space_;     // not own
+  cudaStream_t stream_;  // not own
+  platform::CUDADeviceContext *dev_ctx_;
+};
+
+// Copy the swapped LoDTensor back to the device on the swap stream, and make
+// the compute stream wait for the copy. It does nothing if the tensor was not
+// swapped out.
+class SwapInOpHandle : public OpHandleBase {
+ public:
+  SwapInOpHandle(ir::Node *node, const Scope *scope,
+                 const platform::CUDAPlace &place, const std::string &var_name,
+                 SwapSpace *space, cudaStream_t stream);
+
+  std::string Name() const override;
+
+ protected:
+  void RunImpl() override;
+
+ private:
+  const Scope *scope_;
+  platform::CUDAPlace place_;
+  std::string var_name_;
+  SwapSpace *space_;     // not own
+  cudaStream_t stream_;  // not own
+  platform::CUDADeviceContext *dev_ctx_;
+};
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
+
+#endif
@@ -14,7 +14,9 @@
 
 #include "paddle/fluid/framework/details/threaded_ssa_graph_executor.h"
 
+#include <algorithm>
 #include "paddle/fluid/framework/details/multi_devices_helper.h"
+#include "paddle/fluid/framework/details/op_priority_pass.h"
 #include "paddle/fluid/framework/ir/graph_helper.h"
 #include "paddle/fluid/platform/profiler.h"
 
@@ -26,13 +28,18 @@ ThreadedSSAGraphExecutor::ThreadedSSAGraphExecutor(
     const std::vector<platform::Place> &places,
     std::unique_ptr<ir::Graph> &&graph)
     : graph_(std::move(graph)),
-      pool_(strategy.num_threads_ >= 2 ? new ::ThreadPool(strategy.num_threads_)
-                                       : nullptr),
       local_scopes_(local_scopes),
       places_(places),
       fetch_ctxs_(places),
       running_ops_(0),
-      strategy_(strategy) {}
+      strategy_(strategy) {
+  if (graph_->Has(kOpPriorityScheduling)) {
+    priority_pool_.reset(
+        new PriorityThreadPool(std::max<size_t>(strategy.num_threads_, 1)));
+  } else if (strategy.num_threads_ >= 2) {
+    pool_.reset(new ::ThreadPool(strategy.num_threads_));
+  }
+}
 
 FeedFetchList ThreadedSSAGraphExecutor::Run(
     const std::vector<std::string> &fetch_tensors) {
@@ -169,7 +176,8 @@ void ThreadedSSAGraphExecutor::InsertFetchOps(
 
     ir::Node *fetch_node =
         graph_->CreateEmptyNode("fetch", ir::Node::Type::kOperation);
-    auto *op = new FetchOpHandle(fetch_node, fetch_data, i, &local_scopes_);
+    auto *op = new FetchOpHandle(fetch_node, fetch_data, i, &local_scopes_,
+                                 strategy_.fetch_on_device_);
     fetch_ops->emplace_back(op);
 
     for (auto &p : places_) {
@@ -224,7 +232,10 @@ void ThreadedSSAGraphExecutor::RunOp(
       exception_holder_.Catch(std::current_exception());
     }
   };
-  if (pool_) {
+  if (priority_pool_) {
+    // The ready queue of the pool runs the most urgent op queued first.
+    run_op_futures_.emplace_back(priority_pool_->Run(op->Priority(), op_run));
+  } else if (pool_) {
     run_op_futures_.emplace_back(pool_->enqueue(op_run));
   } else {
     op_run();
@@ -29,6 +29,7 @@
 #include "paddle/fluid/framework/details/fetch_op_handle.h"
 #include "paddle/fluid/framework/details/ssa_graph_executor.h"
 #include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/priority_thread_pool.h"
 
 namespace paddle {
 namespace framework {
@@ -56,7 +57,11 @@ class ThreadedSSAGraphExecutor : public SSAGraphExecutor {
 
  private:
   std::unique_ptr<ir::Graph> graph_;
+  // Only one of pool_ and priority_pool_ is created, priority_pool_ is for
+  // the graphs processed by op_priority_pass. The ops run in the calling
+  // thread if neither is.
   std::unique_ptr<::ThreadPool> pool_;
+  std::unique_ptr<PriorityThreadPool> priority_pool_;
   std::vector<Scope *> local_scopes_;
   std::vector<platform::Place> places_;
   platform::DeviceContextPool fetch_ctxs_;
@@ -13,7 +13,10 @@
 // limitations under the License.
 
 #include "paddle/fluid/framework/dlpack_tensor.h"
+#include <memory>
+#include <unordered_map>
 #include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/memory/allocation/allocator.h"
 namespace paddle {
 namespace framework {
 
@@ -57,6 +60,75 @@ static DLDataType GetDLDataTypeFromTypeIndex(proto::VarType::Type type) {
 #undef REG_DL_DATA_TYPE
 }
 
+static proto::VarType::Type GetTypeFromDLDataType(const ::DLDataType &dtype) {
+  PADDLE_ENFORCE_EQ(dtype.lanes, 1, "Only the tensors of one lane are "
+                                    "supported.");
+  // bool and uint8_t have the same DLDataType, which is uint8_t.
+  if (dtype.code == kDLUInt && dtype.bits == 8) {
+    return proto::VarType::UINT8;
+  }
+  static auto type_to_dtype_map = CreateDLDataTypeMap();
+  for (auto &item : type_to_dtype_map) {
+    if (item.second.code == dtype.code && item.second.bits == dtype.bits) {
+      return static_cast<proto::VarType::Type>(item.first);
+    }
+  }
+  PADDLE_THROW("Unsupported DLDataType, code %d, bits %d", dtype.code,
+               dtype.bits);
+}
+
+static platform::Place GetPlaceFromDLContext(const ::DLContext &ctx) {
+  switch (ctx.device_type) {
+    case kDLCPU:
+      return platform::CPUPlace();
+#ifdef PADDLE_WITH_CUDA
+    case kDLGPU:
+      return platform::CUDAPlace(ctx.device_id);
+    case kDLCPUPinned:
+      return platform::CUDAPinnedPlace();
+#endif
+    default:
+      PADDLE_THROW("Unsupported DLContext, device type %d", ctx.device_type);
+  }
+}
+
+// The memory of a DLManagedTensor, which is returned to its owner when the
+// allocation is freed.
+class DLPackAllocation : public memory::Allocation {
+ public:
+  DLPackAllocation(::DLManagedTensor *src, size_t size,
+                   const platform::Place &place)
+      : Allocation(static_cast<uint8_t *>(src->dl_tensor.data) +
+                       src->dl_tensor.byte_offset,
+                   size, place),
+        src_(src) {}
+
+  ~DLPackAllocation() {
+    if (src_->deleter != nullptr) {
+      src_->deleter(src_);
+    }
+  }
+
+ private:
+  ::DLManagedTensor *src_;
+};
+
+// The manager_ctx of the exported DLManagedTensor, which holds the memory.
+struct DLPackManagerContext {
+  explicit DLPackManagerContext(const Tensor &t)
+      : tensor(t), dl_tensor(tensor) {
+    managed.dl_tensor = dl_tensor;
+    managed.manager_ctx = this;
+    managed.deleter = [](::DLManagedTensor *self) {
+      delete static_cast<DLPackManagerContext *>(self->manager_ctx);
+    };
+  }
+
+  Tensor tensor;
+  DLPackTensor dl_tensor;
+  ::DLManagedTensor managed;
+};
+
 struct DLContextVisitor : public boost::static_visitor<::DLContext> {
   inline ::DLContext operator()(const platform::CPUPlace &place) const {
     ::DLContext ctx;
@@ -120,5 +192,37 @@ DLPackTensor::DLPackTensor(const Tensor &tensor, LaneType lanes) {
   t_.byte_offset = 0;
 }
 
+::DLManagedTensor *ToDLPack(const Tensor &tensor) {
+  auto *ctx = new internal::DLPackManagerContext(tensor);
+  return &ctx->managed;
+}
+
+void FromDLPack(::DLManagedTensor *src, Tensor *dst) {
+  PADDLE_ENFORCE_NOT_NULL(src);
+  // dst owns src from now on, even if src is not supported.
+  std::unique_ptr<::DLManagedTensor, void (*)(::DLManagedTensor *)> guard(
+      src, [](::DLManagedTensor *t) {
+        if (t->deleter != nullptr) t->deleter(t);
+      });
+  const ::DLTensor &t = src->dl_tensor;
+  auto type = internal::GetTypeFromDLDataType(t.dtype);
+  auto place = internal::GetPlaceFromDLContext(t.ctx);
+  std::vector<int64_t> dims(t.shape, t.shape + t.ndim);
+  if (t.strides != nullptr) {
+    int64_t stride = 1;
+    for (int i = t.ndim - 1; i >= 0; --i) {
+      PADDLE_ENFORCE(dims[i] == 1 || t.strides[i] == stride,
+                     "Only the compact DLPack tensors are supported.");
+      stride *= dims[i];
+    }
+  }
+
+  dst->Resize(make_ddim(dims));
+  size_t size = static_cast<size_t>(dst->numel()) * SizeOfType(type);
+  std::shared_ptr<memory::Allocation> holder(
+      new internal::DLPackAllocation(guard.release(), size, place));
+  dst->ResetHolderWithType(holder, type);
+}
+
 }  // namespace framework
 }  // namespace paddle
@@ -41,5 +41,14 @@ class DLPackTensor {
   ShapeType shape_[DDim::kMaxRank];
 };
 
+// Export the tensor as a DLManagedTensor without copying. It shares the memory
+// of the tensor until its deleter is called.
+::DLManagedTensor* ToDLPack(const Tensor& tensor);
+
+// Let dst share the memory of src without copying. dst takes the ownership of
+// src, whose deleter is called when the memory is not used any more. Only the
+// compact tensors with one lane are supported.
+void FromDLPack(::DLManagedTensor* src, Tensor* dst);
+
 }  // namespace framework
 }  // namespace paddle
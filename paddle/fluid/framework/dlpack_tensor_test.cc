@@ -97,5 +97,26 @@ TEST(dlpack, test_all) {
   _ForEachDataType_(TestCallback);
 }
 
+TEST(dlpack, share_memory) {
+  Tensor src;
+  src.Resize({2, 3});
+  float *p = src.mutable_data<float>(platform::CPUPlace());
+
+  ::DLManagedTensor *managed = ToDLPack(src);
+  CHECK_EQ(p, managed->dl_tensor.data);
+  Tensor dst;
+  FromDLPack(managed, &dst);
+  CHECK_EQ(p, dst.data<float>());
+  CHECK_EQ(src.dims(), dst.dims());
+  CHECK_EQ(src.type(), dst.type());
+
+  // The memory is held by dst after src is released.
+  std::weak_ptr<memory::Allocation> holder = src.Holder();
+  src.clear();
+  CHECK_EQ(false, holder.expired());
+  dst.clear();
+  CHECK_EQ(true, holder.expired());
+}
+
 }  // namespace framework
 }  // namespace paddle
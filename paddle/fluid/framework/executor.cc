@@ -20,11 +20,17 @@ limitations under the License. */
 #include "paddle/fluid/framework/lod_tensor_array.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/reader.h"
+#include "paddle/fluid/framework/reader_stats.h"
 #include "paddle/fluid/framework/transfer_scope_cache.h"
 #include "paddle/fluid/framework/variable_helper.h"
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
 #include "paddle/fluid/operators/distributed/distributed.h"
+#ifdef PADDLE_WITH_DISTRIBUTE
+#include "paddle/fluid/operators/distributed/communicator.h"
+#endif
 #include "paddle/fluid/platform/place.h"
 #include "paddle/fluid/platform/profiler.h"
+#include "paddle/fluid/platform/sampling_profiler.h"
 
 #ifdef PADDLE_WITH_NGRAPH
 #include "paddle/fluid/framework/ngraph_operator.h"
@@ -155,6 +161,12 @@ Executor::Executor(const platform::Place& place) : place_(place) {}
 
 void Executor::Close() {
 #ifdef PADDLE_WITH_DISTRIBUTE
+  // Send the gradients still queued in the communicator before completing.
+  auto communicator =
+      paddle::operators::distributed::Communicator::GetInstance();
+  if (communicator != nullptr) {
+    communicator->Stop();
+  }
   // TODO(typhoonzero): complete message will need to use real trainer_id,
   // except 0.
   auto client =
@@ -203,11 +215,16 @@ void Executor::CreateVariables(const ProgramDesc& pdesc, Scope* scope,
 void Executor::Run(const ProgramDesc& pdesc, Scope* scope, int block_id,
                    bool create_local_scope, bool create_vars) {
   platform::RecordBlock b(block_id);
-  if (FLAGS_use_mkldnn) EnableMKLDNN(pdesc);
-  auto ctx = Prepare(pdesc, block_id);
+  auto ctx = PrepareForRun(pdesc, block_id);
   RunPreparedContext(ctx.get(), scope, create_local_scope, create_vars);
 }
 
+std::unique_ptr<ExecutorPrepareContext> Executor::PrepareForRun(
+    const ProgramDesc& program, int block_id) {
+  if (FLAGS_use_mkldnn) EnableMKLDNN(program);
+  return Prepare(program, block_id);
+}
+
 // Check whether the block already has feed operators and feed_holder.
 // Return false if the block does not have any feed operators.
 // If some feed operators have been prepended to the block, check that
@@ -429,7 +446,10 @@ void Executor::RunPreparedContext(ExecutorPrepareContext* ctx, Scope* scope,
     ctx->ResetReferenceCount();
 #ifdef PADDLE_WITH_CUDA
     if (platform::is_gpu_place(place_)) {
-      if (IsFastEagerDeletionModeEnabled()) {
+      // The garbages can be freed without waiting for the stream if the GPU
+      // memory is freed in the stream order.
+      if (IsFastEagerDeletionModeEnabled() ||
+          memory::allocation::AllocatorFacade::IsGPUFreeStreamOrdered()) {
         gc.reset(new UnsafeFastGPUGarbageCollector(
             boost::get<platform::CUDAPlace>(place_), max_memory_size));
       } else {
@@ -445,8 +465,17 @@ void Executor::RunPreparedContext(ExecutorPrepareContext* ctx, Scope* scope,
 #endif
   }
 
+  platform::SampledRun sampled_run;
+  uint64_t step_start_ns = ReaderNowInNsec();
+  uint64_t data_wait_ns = 0;
   for (auto& op : ctx->ops_) {
-    op->Run(*local_scope, place_);
+    if (op->Type() == "read") {
+      uint64_t read_start_ns = ReaderNowInNsec();
+      op->Run(*local_scope, place_);
+      data_wait_ns += ReaderNowInNsec() - read_start_ns;
+    } else {
+      op->Run(*local_scope, place_);
+    }
 
     if (gc) {
       DeleteUnusedTensors(*local_scope, op.get(), gc.get(),
@@ -455,6 +484,7 @@ void Executor::RunPreparedContext(ExecutorPrepareContext* ctx, Scope* scope,
   }
 
   platform::DeviceContextPool::Instance().Get(place_)->Wait();
+  RecordExecutorStep(ReaderNowInNsec() - step_start_ns, data_wait_ns);
 
   if (local_scope != scope) {
     scope->DeleteScope(local_scope);
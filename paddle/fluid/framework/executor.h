@@ -52,6 +52,8 @@ class Executor {
 
   explicit Executor(const platform::Place& place);
 
+  const platform::Place& GetPlace() const { return place_; }
+
   /*
    * Close this Executor.
    * Calling this method will send complete messages to all pserver instances.
@@ -86,6 +88,12 @@ class Executor {
       const std::vector<std::vector<std::string>>& skip_ref_cnt_vars =
           std::vector<std::vector<std::string>>());
 
+  // Prepare the block as Run does on each call, so that the caller can keep
+  // the context and run it by RunPreparedContext without creating the ops
+  // again, e.g. the Python executor with use_program_cache.
+  std::unique_ptr<ExecutorPrepareContext> PrepareForRun(
+      const ProgramDesc& program, int block_id);
+
   void CreateVariables(const ProgramDesc& pdesc, Scope* scope, int block_id);
 
   void RunPreparedContext(ExecutorPrepareContext* ctx, Scope* scope,
@@ -66,6 +66,7 @@ StreamGarbageCollector::StreamGarbageCollector(const platform::CUDAPlace &place,
     : GarbageCollector(place, max_memory_size) {
   platform::CUDADeviceGuard guard(place.device);
   PADDLE_ENFORCE(cudaStreamCreate(&stream_));
+  PADDLE_ENFORCE(cudaEventCreateWithFlags(&event_, cudaEventDisableTiming));
   callback_manager_.reset(new platform::StreamCallbackManager(stream_));
 }
 
@@ -74,10 +75,13 @@ StreamGarbageCollector::~StreamGarbageCollector() {
   platform::CUDADeviceGuard guard(place.device);
   PADDLE_ENFORCE(cudaStreamSynchronize(stream_));
   PADDLE_ENFORCE(cudaStreamDestroy(stream_));
+  PADDLE_ENFORCE(cudaEventDestroy(event_));
 }
 
 cudaStream_t StreamGarbageCollector::stream() const { return stream_; }
 
+cudaEvent_t StreamGarbageCollector::event() const { return event_; }
+
 void StreamGarbageCollector::Wait() const { callback_manager_->Wait(); }
 
 void StreamGarbageCollector::ClearCallback(
@@ -89,11 +89,18 @@ class StreamGarbageCollector : public GarbageCollector {
 
   cudaStream_t stream() const;
 
+  // Recorded on the compute stream when a batch of garbages is cleared, and
+  // waited by the stream of the collector. One event is enough for all the
+  // batches, since the compute stream of a place is unique, and a later
+  // record only makes the collector wait longer.
+  cudaEvent_t event() const;
+
  protected:
   void ClearCallback(const std::function<void()> &callback) override;
 
  private:
   cudaStream_t stream_;
+  cudaEvent_t event_;
   std::unique_ptr<platform::StreamCallbackManager> callback_manager_;
 };
 #endif
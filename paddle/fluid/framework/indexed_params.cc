@@ -0,0 +1,256 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/indexed_params.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include "paddle/fluid/framework/parallel_tensor_loader.h"
+
+namespace paddle {
+namespace framework {
+
+static constexpr char kIndexedParamsMagic[8] = {'P', 'D', 'P', 'A',
+                                                'R', 'A', 'M', 'S'};
+
+namespace {
+
+template <typename T>
+void Append(std::string* buf, const T& value) {
+  buf->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// Parse the header and the index from a buffer with bound checks.
+class IndexParser {
+ public:
+  IndexParser(const char* data, size_t size) : data_(data), size_(size) {}
+
+  template <typename T>
+  T Read() {
+    T value;
+    std::memcpy(&value, Consume(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  const char* Consume(size_t size) {
+    PADDLE_ENFORCE_LE(offset_ + size, size_,
+                      "Unexpected end of the index of the params file");
+    const char* ptr = data_ + offset_;
+    offset_ += size;
+    return ptr;
+  }
+
+ private:
+  const char* data_;
+  size_t size_;
+  size_t offset_{0};
+};
+
+size_t AlignUp(size_t size) {
+  return (size + kIndexedParamsAlignment - 1) / kIndexedParamsAlignment *
+         kIndexedParamsAlignment;
+}
+
+}  // namespace
+
+void SaveIndexedParams(const std::string& path,
+                       const std::vector<std::string>& names,
+                       const std::vector<const LoDTensor*>& tensors) {
+  PADDLE_ENFORCE_EQ(names.size(), tensors.size());
+  // The GPU tensors are copied to CPU before the index is built.
+  std::vector<LoDTensor> cpu_tensors(tensors.size());
+  std::vector<const Tensor*> data(tensors.size());
+  std::vector<size_t> data_sizes(tensors.size());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    data_sizes[i] = tensors[i]->numel() * SizeOfType(tensors[i]->type());
+    // The pinned memory is read in place as well.
+    if (platform::is_cpu_place(tensors[i]->place()) ||
+        platform::is_cuda_pinned_place(tensors[i]->place())) {
+      data[i] = tensors[i];
+    } else {
+      TensorCopySync(*tensors[i], platform::CPUPlace(), &cpu_tensors[i]);
+      data[i] = &cpu_tensors[i];
+    }
+  }
+
+  // The size of each entry does not depend on the data offsets, so the
+  // entries are built with zero offsets and patched afterwards.
+  std::vector<std::string> entries(tensors.size());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    auto& entry = entries[i];
+    Append(&entry, static_cast<uint32_t>(names[i].size()));
+    entry.append(names[i]);
+    Append(&entry, uint64_t(0));
+    Append(&entry, static_cast<uint64_t>(data_sizes[i]));
+    proto::VarType::TensorDesc desc;
+    desc.set_data_type(tensors[i]->type());
+    auto dims = framework::vectorize(tensors[i]->dims());
+    std::copy(dims.begin(), dims.end(),
+              google::protobuf::RepeatedFieldBackInserter(desc.mutable_dims()));
+    std::string desc_bytes = desc.SerializeAsString();
+    Append(&entry, static_cast<int32_t>(desc_bytes.size()));
+    entry.append(desc_bytes);
+    auto& lod = tensors[i]->lod();
+    Append(&entry, static_cast<uint64_t>(lod.size()));
+    for (auto& level : lod) {
+      uint64_t size = level.size() * sizeof(level[0]);
+      Append(&entry, size);
+      entry.append(reinterpret_cast<const char*>(level.data()), size);
+    }
+  }
+
+  size_t index_size = 0;
+  for (auto& entry : entries) index_size += entry.size();
+  size_t header_size = sizeof(kIndexedParamsMagic) + sizeof(uint32_t) * 2 +
+                       sizeof(uint64_t) + index_size;
+  std::vector<uint64_t> offsets(tensors.size());
+  size_t offset = AlignUp(header_size);
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    offsets[i] = offset;
+    offset = AlignUp(offset + data_sizes[i]);
+    size_t pos = sizeof(uint32_t) + names[i].size();
+    std::memcpy(&entries[i][pos], &offsets[i], sizeof(uint64_t));
+  }
+
+  std::ofstream fout(path, std::ios::out | std::ios::binary);
+  PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot open %s to write", path);
+  std::string header(kIndexedParamsMagic, sizeof(kIndexedParamsMagic));
+  Append(&header, kIndexedParamsVersion);
+  Append(&header, static_cast<uint32_t>(tensors.size()));
+  Append(&header, static_cast<uint64_t>(index_size));
+  fout.write(header.data(), header.size());
+  for (auto& entry : entries) fout.write(entry.data(), entry.size());
+  std::string padding(kIndexedParamsAlignment, '\0');
+  size_t written = header_size;
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    fout.write(padding.data(), offsets[i] - written);
+    size_t size = data_sizes[i];
+    if (size > 0) {
+      fout.write(static_cast<const char*>(data[i]->data<void>()), size);
+    }
+    written = offsets[i] + size;
+  }
+  PADDLE_ENFORCE(fout.good(), "Cannot write the params file %s", path);
+}
+
+bool IndexedParamsReader::IsIndexedParamsFile(const std::string& path) {
+  std::ifstream fin(path, std::ios::in | std::ios::binary);
+  char magic[sizeof(kIndexedParamsMagic)];
+  fin.read(magic, sizeof(magic));
+  return fin.good() &&
+         std::memcmp(magic, kIndexedParamsMagic, sizeof(magic)) == 0;
+}
+
+IndexedParamsReader::IndexedParamsReader(const std::string& path,
+                                         bool use_mmap)
+    : path_(path) {
+  // The size of the index is only known after the fixed header is read.
+  std::string buf(sizeof(kIndexedParamsMagic) + sizeof(uint32_t) * 2 +
+                      sizeof(uint64_t),
+                  '\0');
+  std::ifstream fin(path, std::ios::in | std::ios::binary);
+  PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot open file %s", path);
+  fin.read(&buf[0], buf.size());
+  PADDLE_ENFORCE(fin.good(), "Cannot read the header of %s", path);
+  IndexParser header(buf.data(), buf.size());
+  PADDLE_ENFORCE(std::memcmp(header.Consume(sizeof(kIndexedParamsMagic)),
+                             kIndexedParamsMagic,
+                             sizeof(kIndexedParamsMagic)) == 0,
+                 "%s is not an indexed params file", path);
+  auto version = header.Read<uint32_t>();
+  PADDLE_ENFORCE_EQ(version, kIndexedParamsVersion,
+                    "Unsupported version of the params file %s", path);
+  auto num_tensors = header.Read<uint32_t>();
+  auto index_size = header.Read<uint64_t>();
+
+  std::string index_buf(index_size, '\0');
+  fin.read(&index_buf[0], index_size);
+  PADDLE_ENFORCE(fin.good(), "Cannot read the index of %s", path);
+  IndexParser index(index_buf.data(), index_buf.size());
+  names_.reserve(num_tensors);
+  for (uint32_t i = 0; i < num_tensors; ++i) {
+    auto name_size = index.Read<uint32_t>();
+    std::string name(index.Consume(name_size), name_size);
+    Entry entry;
+    entry.data_offset = index.Read<uint64_t>();
+    entry.data_size = index.Read<uint64_t>();
+    auto desc_size = index.Read<int32_t>();
+    PADDLE_ENFORCE_GE(desc_size, 0, "Invalid size of tensor desc");
+    PADDLE_ENFORCE(entry.desc.ParseFromArray(index.Consume(desc_size),
+                                             desc_size),
+                   "Cannot parse tensor desc of %s", name);
+    entry.lod.resize(index.Read<uint64_t>());
+    for (auto& level : entry.lod) {
+      auto size = index.Read<uint64_t>();
+      std::vector<size_t> offsets(size / sizeof(size_t));
+      std::memcpy(offsets.data(), index.Consume(size), size);
+      level = offsets;
+    }
+    PADDLE_ENFORCE(index_.emplace(name, std::move(entry)).second,
+                   "Duplicated tensor %s in %s", name, path);
+    names_.push_back(name);
+  }
+
+  if (use_mmap) {
+    file_ = memory::allocation::MmapAllocation::MapFile(path);
+  }
+  VLOG(3) << "Read the index of " << num_tensors << " tensors from " << path;
+}
+
+void IndexedParamsReader::Load(const std::string& name,
+                               const platform::Place& place,
+                               LoDTensor* tensor) const {
+  Load({name}, {tensor}, place, 1);
+}
+
+void IndexedParamsReader::Load(const std::vector<std::string>& names,
+                               const std::vector<LoDTensor*>& tensors,
+                               const platform::Place& place,
+                               int num_threads) const {
+  PADDLE_ENFORCE_EQ(names.size(), tensors.size());
+  ParallelTensorLoader loader(place);
+  for (size_t i = 0; i < names.size(); ++i) {
+    auto it = index_.find(names[i]);
+    PADDLE_ENFORCE(it != index_.end(), "Cannot find tensor %s in %s",
+                   names[i], path_);
+    auto& entry = it->second;
+    std::vector<int64_t> dims(entry.desc.dims().begin(),
+                              entry.desc.dims().end());
+    auto ddim = make_ddim(dims);
+    PADDLE_ENFORCE_EQ(
+        static_cast<size_t>(product(ddim)) * SizeOfType(entry.desc.data_type()),
+        entry.data_size, "The data size of tensor %s mismatches its dims",
+        names[i]);
+
+    if (file_ && platform::is_cpu_place(place)) {
+      PADDLE_ENFORCE_LE(entry.data_offset + entry.data_size, file_->size(),
+                        "Unexpected end of the params file %s", path_);
+      tensors[i]->Resize(ddim);
+      tensors[i]->set_lod(entry.lod);
+      tensors[i]->ResetHolderWithType(
+          std::make_shared<memory::allocation::MmapSubAllocation>(
+              file_, entry.data_offset, entry.data_size),
+          entry.desc.data_type());
+    } else {
+      loader.AddRaw(path_, entry.data_offset, ddim, entry.desc.data_type(),
+                    entry.lod, tensors[i]);
+    }
+  }
+  loader.Run(num_threads);
+  VLOG(1) << "Load " << names.size() << " tensors from " << path_ << ", "
+          << loader.StatsString();
+}
+
+}  // namespace framework
+}  // namespace paddle
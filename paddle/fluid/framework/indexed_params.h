@@ -0,0 +1,101 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/memory/allocation/mmap_allocation.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * The indexed format of the combined parameters file.
+ *
+ * Unlike the stream written by SerializeToStream, which must be parsed
+ * sequentially, the file starts with an index of all the tensors, so that any
+ * of them can be loaded without reading the others, e.g., in parallel, or
+ * only the part a trainer or pserver needs. The data of each tensor starts at
+ * a multiple of kIndexedParamsAlignment, so that the tensors can alias a
+ * mapped file.
+ *
+ *   char     magic[8]       "PDPARAMS"
+ *   uint32_t version        kIndexedParamsVersion
+ *   uint32_t num_tensors
+ *   uint64_t index_size     the bytes of the index below
+ *   index, for each tensor:
+ *     uint32_t name_size, the name
+ *     uint64_t data_offset  from the start of the file, aligned
+ *     uint64_t data_size
+ *     int32_t  desc_size, the proto::VarType::TensorDesc
+ *     uint64_t lod_level, for each level: uint64_t size, the offsets
+ *   the data of the tensors, zero padded to the alignment
+ *
+ * The first 4 bytes never equal the version 0 of SerializeToStream, so the
+ * two formats can be told apart by IndexedParamsReader::IsIndexedParamsFile.
+ */
+constexpr uint32_t kIndexedParamsVersion = 1;
+constexpr size_t kIndexedParamsAlignment = 64;
+
+// Save the tensors to the file in the indexed format. The GPU tensors are
+// copied to CPU first.
+void SaveIndexedParams(const std::string& path,
+                       const std::vector<std::string>& names,
+                       const std::vector<const LoDTensor*>& tensors);
+
+class IndexedParamsReader {
+ public:
+  // Read the header and the index. If use_mmap is true, the file is mapped
+  // and the tensors loaded to CPU alias the mapped pages.
+  explicit IndexedParamsReader(const std::string& path, bool use_mmap = false);
+
+  // Whether the file starts with the magic of the indexed format.
+  static bool IsIndexedParamsFile(const std::string& path);
+
+  // The names of all the tensors in the order they are saved.
+  const std::vector<std::string>& names() const { return names_; }
+  bool Has(const std::string& name) const { return index_.count(name) > 0; }
+
+  // Load one tensor to the place.
+  void Load(const std::string& name, const platform::Place& place,
+            LoDTensor* tensor) const;
+
+  // Load the tensors with at most num_threads of them concurrently, see
+  // ParallelTensorLoader.
+  void Load(const std::vector<std::string>& names,
+            const std::vector<LoDTensor*>& tensors,
+            const platform::Place& place, int num_threads) const;
+
+ private:
+  struct Entry {
+    uint64_t data_offset;
+    uint64_t data_size;
+    proto::VarType::TensorDesc desc;
+    LoD lod;
+  };
+
+  std::string path_;
+  std::vector<std::string> names_;
+  std::unordered_map<std::string, Entry> index_;
+  std::shared_ptr<memory::allocation::MmapAllocation> file_;
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,99 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/indexed_params.h"
+#include <gtest/gtest.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+static void FillTensor(const DDim& dims, int start, LoDTensor* tensor) {
+  tensor->Resize(dims);
+  float* data = tensor->mutable_data<float>(platform::CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = static_cast<float>(start + i);
+  }
+}
+
+static void ExpectEqual(const LoDTensor& expect, const LoDTensor& actual) {
+  ASSERT_EQ(expect.dims(), actual.dims());
+  EXPECT_EQ(expect.type(), actual.type());
+  EXPECT_EQ(expect.lod(), actual.lod());
+  for (int64_t i = 0; i < expect.numel(); ++i) {
+    EXPECT_EQ(expect.data<float>()[i], actual.data<float>()[i]);
+  }
+}
+
+class IndexedParamsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    names_ = {"fc_w", "fc_b", "emb"};
+    tensors_.resize(names_.size());
+    FillTensor(make_ddim({3, 5}), 0, &tensors_[0]);
+    FillTensor(make_ddim({1}), 100, &tensors_[1]);
+    FillTensor(make_ddim({7, 3}), 200, &tensors_[2]);
+    tensors_[2].set_lod({{0, 2, 7}});
+    std::vector<const LoDTensor*> inputs;
+    for (auto& tensor : tensors_) inputs.push_back(&tensor);
+    SaveIndexedParams(path_, names_, inputs);
+  }
+
+  std::string path_{"indexed_params_test.params"};
+  std::vector<std::string> names_;
+  std::vector<LoDTensor> tensors_;
+};
+
+TEST_F(IndexedParamsTest, LoadAll) {
+  ASSERT_TRUE(IndexedParamsReader::IsIndexedParamsFile(path_));
+  IndexedParamsReader reader(path_);
+  EXPECT_EQ(reader.names(), names_);
+  std::vector<LoDTensor> loaded(names_.size());
+  std::vector<LoDTensor*> outputs;
+  for (auto& tensor : loaded) outputs.push_back(&tensor);
+  reader.Load(names_, outputs, platform::CPUPlace(), 2);
+  for (size_t i = 0; i < names_.size(); ++i) {
+    ExpectEqual(tensors_[i], loaded[i]);
+  }
+}
+
+TEST_F(IndexedParamsTest, LoadPartialMapped) {
+  IndexedParamsReader reader(path_, true /* use_mmap */);
+  EXPECT_FALSE(reader.Has("not_exist"));
+  LoDTensor emb;
+  reader.Load("emb", platform::CPUPlace(), &emb);
+  ExpectEqual(tensors_[2], emb);
+  // The payloads are aligned, so the mapped tensor is aligned too.
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(emb.data<float>()) %
+                kIndexedParamsAlignment,
+            0UL);
+  EXPECT_ANY_THROW(reader.Load("not_exist", platform::CPUPlace(), &emb));
+}
+
+TEST(IndexedParams, NotIndexedFile) {
+  LoDTensor tensor;
+  FillTensor(make_ddim({2, 2}), 0, &tensor);
+  std::string path = "indexed_params_test.stream";
+  {
+    std::ofstream fout(path, std::ios::binary);
+    SerializeToStream(fout, tensor, platform::CPUDeviceContext());
+  }
+  EXPECT_FALSE(IndexedParamsReader::IsIndexedParamsFile(path));
+  EXPECT_ANY_THROW(IndexedParamsReader reader(path));
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,115 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/infer_shape_cache.h"
+#include <atomic>
+#include "paddle/fluid/framework/variable.h"
+
+namespace paddle {
+namespace framework {
+
+static std::atomic<int64_t> g_infer_shape_cache_hits{0};
+static std::atomic<int64_t> g_infer_shape_cache_misses{0};
+
+// Marks the boundary of each variable in the key, so that (dims, lod) of
+// different inputs can not be confused with each other.
+constexpr int64_t kVarSeparator = -1;
+constexpr int64_t kEmptyVar = -2;
+
+bool InferShapeCache::BuildKey(const VariableValueMap& inputs,
+                               std::vector<int64_t>* key) {
+  key->clear();
+  for (auto& var_name_item : inputs) {
+    for (auto* var : var_name_item.second) {
+      if (var == nullptr) {
+        key->push_back(kEmptyVar);
+        continue;
+      }
+      if (!var->IsType<LoDTensor>()) {
+        return false;
+      }
+      auto& tensor = var->Get<LoDTensor>();
+      auto& dims = tensor.dims();
+      key->push_back(dims.size());
+      for (int i = 0; i < dims.size(); ++i) {
+        key->push_back(dims[i]);
+      }
+      auto& lod = tensor.lod();
+      key->push_back(lod.size());
+      for (auto& level : lod) {
+        key->push_back(level.size());
+        for (size_t offset : level) {
+          key->push_back(static_cast<int64_t>(offset));
+        }
+      }
+      key->push_back(kVarSeparator);
+    }
+  }
+  return true;
+}
+
+bool InferShapeCache::Lookup(const VariableValueMap& inputs,
+                             const VariableValueMap& outputs) {
+  if (!valid_ || !BuildKey(inputs, &tmp_key_) || tmp_key_ != key_) {
+    ++g_infer_shape_cache_misses;
+    return false;
+  }
+
+  size_t idx = 0;
+  for (auto& var_name_item : outputs) {
+    for (auto* var : var_name_item.second) {
+      if (var == nullptr) continue;
+      auto* tensor = var->GetMutable<LoDTensor>();
+      tensor->Resize(output_dims_[idx]);
+      tensor->set_lod(output_lods_[idx]);
+      ++idx;
+    }
+  }
+  ++g_infer_shape_cache_hits;
+  return true;
+}
+
+void InferShapeCache::Update(const VariableValueMap& inputs,
+                             const VariableValueMap& outputs) {
+  valid_ = false;
+  output_dims_.clear();
+  output_lods_.clear();
+  for (auto& var_name_item : outputs) {
+    for (auto* var : var_name_item.second) {
+      if (var == nullptr) continue;
+      if (!var->IsType<LoDTensor>()) {
+        return;
+      }
+      auto& tensor = var->Get<LoDTensor>();
+      output_dims_.push_back(tensor.dims());
+      output_lods_.push_back(tensor.lod());
+    }
+  }
+  valid_ = BuildKey(inputs, &key_);
+}
+
+InferShapeCacheStat InferShapeCache::GetStat() {
+  InferShapeCacheStat stat;
+  stat.hits = g_infer_shape_cache_hits;
+  stat.misses = g_infer_shape_cache_misses;
+  return stat;
+}
+
+void InferShapeCache::ResetStat() {
+  g_infer_shape_cache_hits = 0;
+  g_infer_shape_cache_misses = 0;
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,71 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "paddle/fluid/framework/ddim.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/type_defs.h"
+
+namespace paddle {
+namespace framework {
+
+struct InferShapeCacheStat {
+  int64_t hits{0};
+  int64_t misses{0};
+
+  double HitRate() const {
+    int64_t total = hits + misses;
+    return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+  }
+};
+
+/*
+ * InferShapeCache remembers the output dims and LoD computed by the last
+ * InferShape of one operator, keyed by the dims and LoD of its inputs. When
+ * the inputs are the same in the next run, the outputs are restored from the
+ * cache and InferShape can be skipped.
+ *
+ * Only ops whose inputs and outputs are all LoDTensors are cached. The cache
+ * is not thread-safe, an op using it must not run concurrently.
+ */
+class InferShapeCache {
+ public:
+  // Restore the outputs and return true if the inputs match the cached key.
+  bool Lookup(const VariableValueMap& inputs, const VariableValueMap& outputs);
+
+  // Record the outputs produced by InferShape for the current inputs.
+  void Update(const VariableValueMap& inputs, const VariableValueMap& outputs);
+
+  // The statistics of all InferShapeCaches in this process.
+  static InferShapeCacheStat GetStat();
+  static void ResetStat();
+
+ private:
+  // Serialize the dims and LoD of inputs into key, return false if some
+  // input can not be cached.
+  static bool BuildKey(const VariableValueMap& inputs,
+                       std::vector<int64_t>* key);
+
+  bool valid_{false};
+  std::vector<int64_t> key_;
+  std::vector<int64_t> tmp_key_;
+  std::vector<DDim> output_dims_;
+  std::vector<LoD> output_lods_;
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,60 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/infer_shape_cache.h"
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/variable.h"
+
+namespace paddle {
+namespace framework {
+
+TEST(InferShapeCache, lookup) {
+  Variable x, out;
+  x.GetMutable<LoDTensor>()->Resize({2, 3});
+  out.GetMutable<LoDTensor>();
+  VariableValueMap inputs = {{"X", {&x}}};
+  VariableValueMap outputs = {{"Out", {&out}}};
+
+  InferShapeCache::ResetStat();
+  InferShapeCache cache;
+  ASSERT_FALSE(cache.Lookup(inputs, outputs));
+
+  // pretend InferShape has set the output.
+  auto* out_tensor = out.GetMutable<LoDTensor>();
+  out_tensor->Resize({2, 6});
+  out_tensor->set_lod({{0, 1, 2}});
+  cache.Update(inputs, outputs);
+
+  out_tensor->Resize({1});
+  out_tensor->set_lod({});
+  ASSERT_TRUE(cache.Lookup(inputs, outputs));
+  ASSERT_EQ(out_tensor->dims(), make_ddim({2, 6}));
+  ASSERT_EQ(out_tensor->lod().size(), 1UL);
+  ASSERT_EQ(out_tensor->lod()[0][2], 2UL);
+
+  x.GetMutable<LoDTensor>()->Resize({4, 3});
+  ASSERT_FALSE(cache.Lookup(inputs, outputs));
+
+  x.GetMutable<LoDTensor>()->Resize({2, 3});
+  x.GetMutable<LoDTensor>()->set_lod({{0, 2}});
+  ASSERT_FALSE(cache.Lookup(inputs, outputs));
+
+  auto stat = InferShapeCache::GetStat();
+  ASSERT_EQ(stat.hits, 1);
+  ASSERT_EQ(stat.misses, 3);
+  ASSERT_DOUBLE_EQ(stat.HitRate(), 0.25);
+}
+
+}  // namespace framework
+}  // namespace paddle
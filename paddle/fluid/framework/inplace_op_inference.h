@@ -0,0 +1,58 @@
+/* Copyright (c) 2016 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+
+#pragma once
+#include <string>
+#include <unordered_map>
+#include "paddle/fluid/framework/block_desc.h"
+#include "paddle/fluid/framework/op_desc.h"
+#include "paddle/fluid/framework/type_defs.h"
+
+namespace paddle {
+namespace framework {
+
+// InplaceOpInference declares which outputs of an operator can be computed
+// in the buffer of which inputs. It returns a map from the name of the input
+// variable to the name of the output variable. The kernels of the operator
+// must give the right result when the input and the output are the same
+// variable, e.g., an elementwise kernel.
+//
+// The declaration only tells it is possible. The inplace_op_pass decides
+// whether it is safe in the graph, e.g., the input is not read by any other
+// operator.
+class InplaceOpInference {
+ public:
+  virtual ~InplaceOpInference() {}
+  virtual std::unordered_map<std::string, std::string> operator()(
+      const OpDesc& op_desc, BlockDesc* block) const = 0;
+};
+
+// Out can reuse the buffer of X when both of them are single variables.
+class SingleOpInplaceInToOut : public InplaceOpInference {
+ public:
+  std::unordered_map<std::string, std::string> operator()(
+      const OpDesc& op_desc, BlockDesc* block) const override {
+    std::unordered_map<std::string, std::string> ret;
+    auto& x = op_desc.Input("X");
+    auto& out = op_desc.Output("Out");
+    if (x.size() == 1 && out.size() == 1) {
+      ret.emplace(x[0], out[0]);
+    }
+    return ret;
+  }
+};
+
+}  // namespace framework
+}  // namespace paddle
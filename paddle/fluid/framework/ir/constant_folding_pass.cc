@@ -0,0 +1,389 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/constant_folding_pass.h"
+#include <algorithm>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/naive_executor.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/program_desc.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+// The operators which should run on every request, because they have side
+// effects, depend on the random state or run the sub-blocks.
+const std::unordered_set<std::string>& UnfoldableOps() {
+  static const std::unordered_set<std::string> ops = {
+      "feed",
+      "fetch",
+      "conditional_block",
+      "while",
+      "recurrent",
+      "parallel_do",
+      "save",
+      "save_combine",
+      "load",
+      "load_combine",
+      "print",
+      "read",
+      "increment",
+      "uniform_random",
+      "uniform_random_batch_size_like",
+      "gaussian_random",
+      "gaussian_random_batch_size_like",
+      "truncated_gaussian_random",
+      "sampling_id",
+      "random_crop",
+      "dropout",
+  };
+  return ops;
+}
+
+// The operators whose outputs only depend on the attributes and the shapes,
+// but not the data, of their inputs, e.g. the boxes of the detection models
+// which only depend on the shapes of the feature maps and the image.
+const std::unordered_set<std::string>& ShapeOnlyOps() {
+  static const std::unordered_set<std::string> ops = {
+      "prior_box", "density_prior_box", "anchor_generator",
+  };
+  return ops;
+}
+
+// Whether the shape of a variable is known but for the batch size.
+bool HasStaticShape(Node* var) {
+  if (!var->IsVar() || !var->Var() ||
+      var->Var()->GetType() != proto::VarType::LOD_TENSOR) {
+    return false;
+  }
+  auto shape = var->Var()->GetShape();
+  return !shape.empty() && std::all_of(shape.begin() + 1, shape.end(),
+                                       [](int64_t d) { return d > 0; });
+}
+
+Node* FindVarNode(const std::vector<Node*>& vars, const std::string& name) {
+  for (auto* var : vars) {
+    if (var->IsVar() && var->Name() == name) return var;
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+std::unique_ptr<ir::Graph> ConstantFoldingPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  PADDLE_ENFORCE(graph.get());
+  FusePassBase::Init(name_scope_, graph.get());
+  auto* scope = param_scope();
+  PADDLE_ENFORCE(scope);
+
+  // The number of the operators writing each variable, a parameter is a
+  // constant only if no operator left writes it.
+  std::unordered_map<std::string, int> writers;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    for (auto* out : node->outputs) {
+      ++writers[out->Name()];
+    }
+  }
+
+  int num_dropouts = SimplifyDropouts(graph.get(), &writers);
+
+  std::unordered_set<const Node*> removed_ops;
+  int num_folded = FoldConstants(graph.get(), scope, &removed_ops, &writers);
+  int num_branches =
+      RemoveFalseBranches(graph.get(), scope, &removed_ops, &writers);
+  RemoveDeadParams(graph.get(), scope, removed_ops);
+
+  VLOG(3) << "simplify " << num_dropouts << " dropouts, fold " << num_folded
+          << " operators and remove " << num_branches << " false branches";
+  AddStatis(num_dropouts + num_folded + num_branches);
+  return graph;
+}
+
+int ConstantFoldingPass::SimplifyDropouts(
+    Graph* graph, std::unordered_map<std::string, int>* writers) const {
+  std::vector<Node*> dropouts;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op() && node->Op()->Type() == "dropout" &&
+        node->Op()->HasAttr("is_test") &&
+        boost::get<bool>(node->Op()->GetAttr("is_test"))) {
+      dropouts.push_back(node);
+    }
+  }
+
+  std::unordered_set<const Node*> nodes2rm;
+  int count = 0;
+  for (auto* dropout : dropouts) {
+    auto* op = dropout->Op();
+    auto* x = FindVarNode(dropout->inputs, op->Input("X").front());
+    auto* out = FindVarNode(dropout->outputs, op->Output("Out").front());
+    if (!x || !out || !out->Var() || out->Var()->Persistable()) continue;
+    Node* mask = nullptr;
+    if (!op->Output("Mask").empty()) {
+      mask = FindVarNode(dropout->outputs, op->Output("Mask").front());
+      // The mask is not written in test mode, keep the dropout which is
+      // read by the others.
+      if (mask && !mask->outputs.empty()) continue;
+    }
+
+    std::string implementation = "downgrade_in_infer";
+    if (op->HasAttr("dropout_implementation")) {
+      implementation =
+          boost::get<std::string>(op->GetAttr("dropout_implementation"));
+    }
+    float scale = 1.0f;
+    if (implementation != "upscale_in_train") {
+      scale -= boost::get<float>(op->GetAttr("dropout_prob"));
+    }
+
+    // An identity is removed by reading X instead of Out, unless Out is a
+    // fetch target, whose name is the name of the output, or X is written
+    // by more than one operator, which may change it before the readers.
+    bool removable = scale == 1.0f && !out->outputs.empty() &&
+                     (*writers)[x->Name()] <= 1;
+    for (auto* reader : out->outputs) {
+      removable = removable && reader->Op() && reader->Op()->Type() != "fetch";
+    }
+
+    if (removable) {
+      for (auto* reader : out->outputs) {
+        reader->Op()->RenameInput(out->Name(), x->Name());
+        IR_NODE_LINK_TO(x, reader);
+      }
+      --(*writers)[out->Name()];
+      nodes2rm.insert(out);
+    } else {
+      OpDesc desc;
+      desc.SetType("scale");
+      desc.SetInput("X", {x->Name()});
+      desc.SetOutput("Out", {out->Name()});
+      desc.SetAttr("scale", scale);
+      desc.SetAttr("bias", 0.0f);
+      desc.SetAttr("bias_after_scale", true);
+      auto* scale_node = graph->CreateOpNode(&desc);
+      IR_NODE_LINK_TO(x, scale_node);
+      IR_NODE_LINK_TO(scale_node, out);
+    }
+    if (mask) {
+      --(*writers)[mask->Name()];
+      nodes2rm.insert(mask);
+    }
+    nodes2rm.insert(dropout);
+    ++count;
+  }
+  GraphSafeRemoveNodes(graph, nodes2rm);
+  return count;
+}
+
+bool ConstantFoldingPass::IsConstant(
+    Node* var, const Scope& scope,
+    const std::unordered_map<std::string, int>& writers) const {
+  if (!var->IsVar() || !var->Var()) return false;
+  auto* desc = var->Var();
+  if (!desc->Persistable() ||
+      desc->GetType() != proto::VarType::LOD_TENSOR) {
+    return false;
+  }
+  auto it = writers.find(desc->Name());
+  if (it != writers.end() && it->second > 0) return false;
+  auto* scope_var = scope.FindVar(desc->Name());
+  return scope_var && scope_var->IsType<LoDTensor>() &&
+         scope_var->Get<LoDTensor>().IsInitialized();
+}
+
+int ConstantFoldingPass::FoldConstants(
+    Graph* graph, Scope* scope, std::unordered_set<const Node*>* removed_ops,
+    std::unordered_map<std::string, int>* writers) const {
+  int count = 0;
+  // In the topological order, so that the outputs of a folded operator are
+  // constants for the operators after it.
+  for (auto* node : TopologySortOperations(*graph)) {
+    auto* op = node->Op();
+    if (!op || UnfoldableOps().count(op->Type()) || op->HasAttr("sub_block") ||
+        node->outputs.empty()) {
+      continue;
+    }
+    std::vector<Node*> shape_inputs;
+    bool foldable = true;
+    for (auto* in : node->inputs) {
+      if (IsConstant(in, *scope, *writers)) continue;
+      if (ShapeOnlyOps().count(op->Type()) && HasStaticShape(in)) {
+        shape_inputs.push_back(in);
+      } else {
+        foldable = false;
+      }
+    }
+    for (auto* out : node->outputs) {
+      foldable = foldable && out->Var() && !out->Var()->Persistable() &&
+                 out->Var()->GetType() == proto::VarType::LOD_TENSOR &&
+                 out->Name() != kEmptyVarName && (*writers)[out->Name()] == 1;
+    }
+    if (!foldable) continue;
+
+    // Run the operator once on CPU, and its outputs are created in the
+    // parameter scope as the parameters.
+    ProgramDesc program;
+    auto* block = program.MutableBlock(kRootBlockIndex);
+    for (auto* var : node->inputs) {
+      *block->Var(var->Name())->Proto() = *var->Var()->Proto();
+    }
+    // The inputs read by their shapes are uninitialized tensors of the batch
+    // size 1 in a local scope.
+    Scope* run_scope = scope;
+    if (!shape_inputs.empty()) {
+      run_scope = &scope->NewScope();
+      for (auto* var : shape_inputs) {
+        auto shape = var->Var()->GetShape();
+        shape[0] = std::max<int64_t>(shape[0], 1);
+        auto* tensor = run_scope->Var(var->Name())->GetMutable<LoDTensor>();
+        tensor->Resize(make_ddim(shape));
+        tensor->mutable_data(platform::CPUPlace(), var->Var()->GetDataType());
+      }
+    }
+    for (auto* var : node->outputs) {
+      auto* desc = block->Var(var->Name());
+      *desc->Proto() = *var->Var()->Proto();
+      desc->SetPersistable(true);
+    }
+    block->AppendOp()->CopyFrom(*op);
+
+    std::vector<std::string> outputs;
+    for (auto* var : node->outputs) {
+      outputs.push_back(var->Name());
+    }
+    bool succeeded = false;
+    try {
+      NaiveExecutor exe{platform::CPUPlace()};
+      exe.CreateVariables(program, kRootBlockIndex, true, scope);
+      exe.Prepare(run_scope, program, kRootBlockIndex, false);
+      exe.Run();
+      succeeded = std::all_of(
+          outputs.begin(), outputs.end(), [&](const std::string& name) {
+            return scope->FindVar(name)->Get<LoDTensor>().IsInitialized();
+          });
+    } catch (const std::exception& e) {
+      VLOG(3) << "failed to fold " << op->Type() << ": " << e.what();
+    }
+    if (run_scope != scope) {
+      scope->DeleteScope(run_scope);
+    }
+    if (!succeeded) {
+      scope->EraseVars(outputs);
+      continue;
+    }
+
+    for (auto* var : node->outputs) {
+      var->Var()->SetPersistable(true);
+      --(*writers)[var->Name()];
+    }
+    removed_ops->insert(node);
+    ++count;
+  }
+  return count;
+}
+
+int ConstantFoldingPass::RemoveFalseBranches(
+    Graph* graph, Scope* scope, std::unordered_set<const Node*>* removed_ops,
+    std::unordered_map<std::string, int>* writers) const {
+  int count = 0;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp() || !node->Op() ||
+        node->Op()->Type() != "conditional_block" || removed_ops->count(node)) {
+      continue;
+    }
+    auto* op = node->Op();
+    std::vector<const LoDTensor*> conditions;
+    for (auto& name : op->Input("Cond")) {
+      auto* cond = FindVarNode(node->inputs, name);
+      if (!cond || !IsConstant(cond, *scope, *writers)) break;
+      conditions.push_back(&scope->FindVar(name)->Get<LoDTensor>());
+    }
+    if (conditions.empty() || conditions.size() != op->Input("Cond").size()) {
+      continue;
+    }
+
+    // The same as the condition checked in the ConditionalBlockOp.
+    bool need_run = true;
+    if (boost::get<bool>(op->GetAttr("is_scalar_condition"))) {
+      auto* cond = conditions.front();
+      if (conditions.size() != 1 || cond->numel() != 1 ||
+          cond->type() != proto::VarType::BOOL ||
+          !platform::is_cpu_place(cond->place())) {
+        continue;
+      }
+      need_run = cond->data<bool>()[0];
+    } else {
+      need_run = std::all_of(
+          conditions.begin(), conditions.end(),
+          [](const LoDTensor* t) { return t->numel() != 0; });
+    }
+    // The true branch runs the sub-block in a new scope for every request,
+    // which is kept.
+    if (need_run) continue;
+
+    // The outputs keep uninitialized as the skipped block at runtime.
+    for (auto* out : node->outputs) {
+      --(*writers)[out->Name()];
+    }
+    removed_ops->insert(node);
+    ++count;
+  }
+  return count;
+}
+
+void ConstantFoldingPass::RemoveDeadParams(
+    Graph* graph, Scope* scope,
+    const std::unordered_set<const Node*>& removed_ops) const {
+  std::unordered_set<const Node*> nodes2rm(removed_ops.begin(),
+                                           removed_ops.end());
+  auto only_linked_to_removed = [&](const Node* var) {
+    auto removed = [&](const Node* op) { return removed_ops.count(op) > 0; };
+    return std::all_of(var->inputs.begin(), var->inputs.end(), removed) &&
+           std::all_of(var->outputs.begin(), var->outputs.end(), removed);
+  };
+  std::unordered_set<std::string> dead_params;
+  for (auto* op : removed_ops) {
+    for (auto& vars : {op->inputs, op->outputs}) {
+      for (auto* var : vars) {
+        if (!only_linked_to_removed(var)) continue;
+        nodes2rm.insert(var);
+        if (var->Var() && var->Var()->Persistable()) {
+          dead_params.insert(var->Name());
+        }
+      }
+    }
+  }
+  GraphSafeRemoveNodes(graph, nodes2rm);
+
+  // A parameter may have several nodes, erase it if all of them are dead.
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar()) dead_params.erase(node->Name());
+  }
+  scope->EraseVars(
+      std::vector<std::string>(dead_params.begin(), dead_params.end()));
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(constant_folding_pass,
+              paddle::framework::ir::ConstantFoldingPass);
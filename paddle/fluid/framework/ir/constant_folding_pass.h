@@ -0,0 +1,67 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Evaluate the operators whose inputs are all parameters once, and replace
+ * their outputs with parameters, e.g. the fill_constant -> scale chains and
+ * the shape -> reshape of the parameters. The operators which only read the
+ * shapes of their inputs, such as prior_box and anchor_generator, are also
+ * evaluated once if the shapes are known but for the batch size. The
+ * parameters and the operators which become dead are removed, include the
+ * conditional_block whose condition is a constant false. The dropouts in
+ * test mode are replaced with a scale, or removed if they are identities.
+ */
+class ConstantFoldingPass : public FusePassBase {
+ public:
+  virtual ~ConstantFoldingPass() {}
+
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+
+ private:
+  int SimplifyDropouts(Graph* graph,
+                       std::unordered_map<std::string, int>* writers) const;
+  int FoldConstants(Graph* graph, Scope* scope,
+                    std::unordered_set<const Node*>* removed_ops,
+                    std::unordered_map<std::string, int>* writers) const;
+  int RemoveFalseBranches(Graph* graph, Scope* scope,
+                          std::unordered_set<const Node*>* removed_ops,
+                          std::unordered_map<std::string, int>* writers) const;
+  void RemoveDeadParams(
+      Graph* graph, Scope* scope,
+      const std::unordered_set<const Node*>& removed_ops) const;
+
+  bool IsConstant(Node* var, const Scope& scope,
+                  const std::unordered_map<std::string, int>& writers) const;
+
+  const std::string name_scope_{"constant_folding_pass"};
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,191 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/constant_folding_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+OpDesc* AddOp(ProgramDesc* prog, const std::string& type,
+              const std::vector<std::pair<std::string, std::string>>& inputs,
+              const std::vector<std::pair<std::string, std::string>>& outputs) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  for (auto& input : inputs) {
+    op->SetInput(input.first, {input.second});
+  }
+  for (auto& output : outputs) {
+    op->SetOutput(output.first, {output.second});
+  }
+  return op;
+}
+
+// fill_constant->c0
+// c0->scale->c1
+// (c1, p)->elementwise_add->c2
+// (x, c2)->elementwise_add->y
+// y->dropout->(z, mask)
+// z->scale->out
+// (cond, x)->conditional_block->(w, s)
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v : std::vector<std::string>(
+           {"x", "c0", "c1", "c2", "p", "y", "z", "mask", "out", "cond", "w",
+            "s"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(v == "s" ? proto::VarType::STEP_SCOPES
+                          : proto::VarType::LOD_TENSOR);
+    if (v == "p" || v == "cond") {
+      var->SetPersistable(true);
+    }
+  }
+
+  auto* op = AddOp(&prog, "fill_constant", {}, {{"Out", "c0"}});
+  op->SetAttr("shape", std::vector<int64_t>({4}));
+  op->SetAttr("dtype", static_cast<int>(proto::VarType::FP32));
+  op->SetAttr("value", 1.0f);
+  op = AddOp(&prog, "scale", {{"X", "c0"}}, {{"Out", "c1"}});
+  op->SetAttr("scale", 3.0f);
+  AddOp(&prog, "elementwise_add", {{"X", "c1"}, {"Y", "p"}}, {{"Out", "c2"}});
+  AddOp(&prog, "elementwise_add", {{"X", "x"}, {"Y", "c2"}}, {{"Out", "y"}});
+  op = AddOp(&prog, "dropout", {{"X", "y"}}, {{"Out", "z"}, {"Mask", "mask"}});
+  op->SetAttr("is_test", true);
+  op->SetAttr("dropout_prob", 0.5f);
+  op->SetAttr("dropout_implementation", std::string("upscale_in_train"));
+  op = AddOp(&prog, "scale", {{"X", "z"}}, {{"Out", "out"}});
+  op->SetAttr("scale", 2.0f);
+  op = AddOp(&prog, "conditional_block", {{"Cond", "cond"}, {"Input", "x"}},
+             {{"Out", "w"}, {"Scope", "s"}});
+  op->SetAttr("is_scalar_condition", true);
+  return prog;
+}
+
+TEST(ConstantFoldingPass, basic) {
+  Scope scope;
+  auto* p = scope.Var("p")->GetMutable<LoDTensor>();
+  p->Resize({4});
+  std::fill_n(p->mutable_data<float>(platform::CPUPlace()), 4, 0.5f);
+  auto* cond = scope.Var("cond")->GetMutable<LoDTensor>();
+  cond->Resize({1});
+  cond->mutable_data<bool>(platform::CPUPlace())[0] = false;
+
+  auto prog = BuildProgramDesc();
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  graph->Set(kParamScopeAttr, new Scope*(&scope));
+
+  auto pass = PassRegistry::Instance().Get("constant_folding_pass");
+  graph = pass->Apply(std::move(graph));
+
+  std::vector<std::string> op_types;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp()) {
+      op_types.push_back(node->Op()->Type());
+      if (node->Op()->Type() == "elementwise_add") {
+        EXPECT_EQ(node->Op()->Input("Y"), std::vector<std::string>({"c2"}));
+      } else if (node->Op()->Type() == "scale") {
+        // The identity dropout is removed.
+        EXPECT_EQ(node->Op()->Input("X"), std::vector<std::string>({"y"}));
+      }
+    } else if (node->Name() == "c2") {
+      EXPECT_TRUE(node->Var()->Persistable());
+    }
+  }
+  std::sort(op_types.begin(), op_types.end());
+  EXPECT_EQ(op_types, std::vector<std::string>({"elementwise_add", "scale"}));
+
+  // The dead parameters are erased.
+  EXPECT_EQ(scope.FindVar("c0"), nullptr);
+  EXPECT_EQ(scope.FindVar("c1"), nullptr);
+  EXPECT_EQ(scope.FindVar("p"), nullptr);
+  EXPECT_EQ(scope.FindVar("cond"), nullptr);
+
+  auto& c2 = scope.FindVar("c2")->Get<LoDTensor>();
+  ASSERT_EQ(c2.numel(), 4);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(c2.data<float>()[i], 3.5f);
+  }
+}
+
+TEST(ConstantFoldingPass, shape_only) {
+  // (feature, image)->prior_box->(boxes, variances)
+  // (x, boxes)->elementwise_add->y
+  // (x, variances)->elementwise_add->z
+  ProgramDesc prog;
+  for (auto& v : std::vector<std::string>(
+           {"feature", "image", "boxes", "variances", "x", "y", "z"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+  }
+  prog.MutableBlock(0)->Var("feature")->SetShape({-1, 8, 4, 4});
+  prog.MutableBlock(0)->Var("image")->SetShape({-1, 3, 32, 32});
+  auto* op =
+      AddOp(&prog, "prior_box", {{"Input", "feature"}, {"Image", "image"}},
+            {{"Boxes", "boxes"}, {"Variances", "variances"}});
+  op->SetAttr("min_sizes", std::vector<float>({8.0f}));
+  op->SetAttr("max_sizes", std::vector<float>());
+  op->SetAttr("aspect_ratios", std::vector<float>({2.0f}));
+  op->SetAttr("variances", std::vector<float>({0.1f, 0.1f, 0.2f, 0.2f}));
+  op->SetAttr("flip", true);
+  op->SetAttr("clip", true);
+  op->SetAttr("step_w", 0.0f);
+  op->SetAttr("step_h", 0.0f);
+  op->SetAttr("offset", 0.5f);
+  op->SetAttr("min_max_aspect_ratios_order", false);
+  AddOp(&prog, "elementwise_add", {{"X", "x"}, {"Y", "boxes"}}, {{"Out", "y"}});
+  AddOp(&prog, "elementwise_add", {{"X", "x"}, {"Y", "variances"}},
+        {{"Out", "z"}});
+
+  Scope scope;
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  graph->Set(kParamScopeAttr, new Scope*(&scope));
+  auto pass = PassRegistry::Instance().Get("constant_folding_pass");
+  graph = pass->Apply(std::move(graph));
+
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp()) {
+      EXPECT_EQ(node->Op()->Type(), "elementwise_add");
+    } else if (node->Name() == "boxes" || node->Name() == "variances") {
+      EXPECT_TRUE(node->Var()->Persistable());
+    }
+  }
+  // The feature map and the image are not kept in the parameter scope.
+  EXPECT_EQ(scope.FindVar("feature"), nullptr);
+  EXPECT_EQ(scope.FindVar("image"), nullptr);
+
+  // The aspect ratios are 1, 2 and 0.5, the first box is centered at (4, 4)
+  // of the width 8 in the image of 32.
+  auto& boxes = scope.FindVar("boxes")->Get<LoDTensor>();
+  EXPECT_EQ(boxes.dims(), make_ddim({4, 4, 3, 4}));
+  std::vector<float> first(boxes.data<float>(), boxes.data<float>() + 4);
+  EXPECT_EQ(first, std::vector<float>({0.0f, 0.0f, 0.25f, 0.25f}));
+  auto& variances = scope.FindVar("variances")->Get<LoDTensor>();
+  EXPECT_EQ(variances.dims(), make_ddim({4, 4, 3, 4}));
+  EXPECT_EQ(variances.data<float>()[2], 0.2f);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(constant_folding_pass);
+USE_OP(fill_constant);
+USE_OP(scale);
+USE_OP(elementwise_add);
+USE_OP(dropout);
+USE_OP(prior_box);
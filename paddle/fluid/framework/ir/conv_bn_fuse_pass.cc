@@ -114,7 +114,7 @@ std::unique_ptr<ir::Graph> ConvBNFusePass::ApplyImpl(
       gpd.mutable_pattern()
           ->NewNode(patterns::PDNodeName(name_scope_, "conv_input"))
           ->AsInput()
-          ->assert_is_op_input("conv2d", "Input");
+          ->assert_is_ops_input({"conv2d", "depthwise_conv2d"}, "Input");
   patterns::ConvBN conv_bn_pattern(gpd.mutable_pattern(), name_scope_);
   conv_bn_pattern(conv_input, false /*with_eltwise_add*/);
 
@@ -234,7 +234,7 @@ std::unique_ptr<ir::Graph> ConvEltwiseAddBNFusePass::ApplyImpl(
       gpd.mutable_pattern()
           ->NewNode(patterns::PDNodeName(name_scope_, "conv_input"))
           ->AsInput()
-          ->assert_is_op_input("conv2d", "Input");
+          ->assert_is_ops_input({"conv2d", "depthwise_conv2d"}, "Input");
   patterns::ConvBN conv_bn_pattern(gpd.mutable_pattern(), name_scope_);
   conv_bn_pattern(conv_input, true /*with_eltwise_add*/);
 
@@ -37,13 +37,14 @@ namespace ir {
 framework::proto::OpDesc PrepareOpDesc(
     const framework::proto::OpDesc& base_desc, const std::string& bias,
     const std::string& bias1, const std::string& activation,
-    const std::string& output) {
+    float activation_alpha, const std::string& output) {
   auto proto = base_desc;
   framework::OpDesc desc(proto, nullptr);
   desc.SetType("conv2d_fusion");
   desc.SetInput("Bias", {bias});
   desc.SetInput("ResidualData", {bias1});
   desc.SetAttr("activation", activation);
+  desc.SetAttr("activation_alpha", activation_alpha);
   desc.SetOutput("Output", {output});
   desc.SetAttr("is_test", true);
   desc.SetAttr("use_cudnn", false);
@@ -57,8 +58,8 @@ std::unique_ptr<ir::Graph> ConvElementwiseAdd2ActFusePass::ApplyImpl(
   FusePassBase::Init(pattern_name, graph.get());
 
   GraphPatternDetector gpd;
-  auto* x = gpd.mutable_pattern()->NewNode("x")->AsInput()->assert_is_op_input(
-      "conv2d", "Input");
+  auto* x = gpd.mutable_pattern()->NewNode("x")->AsInput()->assert_is_ops_input(
+      {"conv2d", "depthwise_conv2d"}, "Input");
 
   patterns::ConvElementwiseadd2Act pattern(gpd.mutable_pattern(), pattern_name);
   pattern(x);
@@ -72,9 +73,10 @@ std::unique_ptr<ir::Graph> ConvElementwiseAdd2ActFusePass::ApplyImpl(
     std::string bias1_name = elementwise_add_in_y_1->Name();
     std::string act_op_type = act_op->Op()->Type();
     std::string act_op_out = act_out->Name();
+    float act_alpha = patterns::ConvActivationAlpha(*act_op->Op());
 
     auto new_op_proto = PrepareOpDesc(base_op_desc, bias_name, bias1_name,
-                                      act_op_type, act_op_out);
+                                      act_op_type, act_alpha, act_op_out);
     framework::OpDesc new_op_desc(new_op_proto, nullptr);
 
     // Create a new node for the fused op.
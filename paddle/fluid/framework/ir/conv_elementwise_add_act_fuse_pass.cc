@@ -34,13 +34,15 @@ namespace ir {
 // Inherient the basic infomation from `base_desc`, and modify some fields.
 framework::proto::OpDesc PrepareOpDesc(
     const framework::proto::OpDesc& base_desc, const std::string& bias,
-    const std::string& activation, const std::string& output) {
+    const std::string& activation, float activation_alpha,
+    const std::string& output) {
   auto proto = base_desc;
   framework::OpDesc desc(proto, nullptr);
   desc.SetType("conv2d_fusion");
   desc.SetInput("Bias", {bias});
   desc.SetInput("ResidualData", {});
   desc.SetAttr("activation", activation);
+  desc.SetAttr("activation_alpha", activation_alpha);
   desc.SetOutput("Output", {output});
   desc.SetAttr("is_test", true);
   desc.SetAttr("use_cudnn", false);
@@ -56,7 +58,7 @@ std::unique_ptr<ir::Graph> ConvElementwiseAddActFusePass::ApplyImpl(
   GraphPatternDetector gpd;
   auto* x = gpd.mutable_pattern()
                 ->NewNode("x")
-                ->assert_is_op_input("conv2d", "Input")
+                ->assert_is_ops_input({"conv2d", "depthwise_conv2d"}, "Input")
                 ->AsInput();
 
   patterns::ConvElementwiseaddAct pattern(gpd.mutable_pattern(), pattern_name);
@@ -71,8 +73,10 @@ std::unique_ptr<ir::Graph> ConvElementwiseAddActFusePass::ApplyImpl(
     std::string act_op_type = act_op->Op()->Type();
     std::string act_op_out = act_out->Name();
 
-    auto new_op_proto =
-        PrepareOpDesc(base_op_desc, bias_name, act_op_type, act_op_out);
+    float act_alpha = patterns::ConvActivationAlpha(*act_op->Op());
+
+    auto new_op_proto = PrepareOpDesc(base_op_desc, bias_name, act_op_type,
+                                      act_alpha, act_op_out);
     framework::OpDesc new_op_desc(new_op_proto, nullptr);
 
     // Create a new node for the fused op.
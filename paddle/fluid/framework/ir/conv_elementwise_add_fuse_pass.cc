@@ -38,7 +38,7 @@ std::unique_ptr<ir::Graph> ConvElementwiseAddFusePass::ApplyImpl(
   GraphPatternDetector gpd;
   auto* x = gpd.mutable_pattern()
                 ->NewNode("x")
-                ->assert_is_op_input("conv2d", "Input")
+                ->assert_is_ops_input({"conv2d", "depthwise_conv2d"}, "Input")
                 ->AsInput();
 
   patterns::ConvElementwiseadd pattern(gpd.mutable_pattern(), pattern_name);
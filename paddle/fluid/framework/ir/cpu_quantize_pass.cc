@@ -0,0 +1,231 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/cpu_quantize_pass.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+Node* FindVarNode(const std::vector<Node*>& nodes, const std::string& name) {
+  for (auto* node : nodes) {
+    if (node->IsVar() && node->Var() && node->Name() == name) return node;
+  }
+  return nullptr;
+}
+
+bool HasScale(const VarQuantScale& scales, const std::string& name) {
+  return scales.count(name) && scales.at(name).second.numel() > 0;
+}
+
+float GetScale(const VarQuantScale& scales, const std::string& name) {
+  return scales.at(name).second.data<float>()[0];
+}
+
+bool IsUnsigned(const VarQuantScale& scales, const std::string& name) {
+  return scales.at(name).first;
+}
+
+// Replace the var node from with to in the list of nodes.
+void ReplaceNode(std::vector<Node*>* nodes, Node* from, Node* to) {
+  std::replace(nodes->begin(), nodes->end(), from, to);
+}
+
+}  // namespace
+
+void CPUQuantizePass::QuantizeInput(Graph* graph, Node* op, Node* input,
+                                    const std::string& input_name,
+                                    float scale, bool is_unsigned,
+                                    int* counter) const {
+  VarDesc quantized_desc(*input->Var());
+  quantized_desc.SetName(input->Name() + "@quantized_" +
+                         std::to_string((*counter)++));
+  quantized_desc.SetPersistable(false);
+  auto* quantized = graph->CreateVarNode(&quantized_desc);
+
+  OpDesc quantize_desc;
+  quantize_desc.SetType("quantize");
+  quantize_desc.SetInput("Input", {input->Name()});
+  quantize_desc.SetOutput("Output", {quantized->Name()});
+  quantize_desc.SetAttr("Scale", scale);
+  quantize_desc.SetAttr("is_negative_input", !is_unsigned);
+  auto* quantize = graph->CreateOpNode(&quantize_desc);
+
+  // The other consumers of the input still read the float values.
+  ReplaceNode(&input->outputs, op, quantize);
+  quantize->inputs.push_back(input);
+  IR_NODE_LINK_TO(quantize, quantized);
+  ReplaceNode(&op->inputs, input, quantized);
+  quantized->outputs.push_back(op);
+  op->Op()->SetInput(input_name, {quantized->Name()});
+}
+
+void CPUQuantizePass::DequantizeOutput(Graph* graph, Node* op, Node* output,
+                                       const std::string& output_name,
+                                       float scale, int* counter) const {
+  VarDesc quantized_desc(*output->Var());
+  quantized_desc.SetName(output->Name() + "@quantized_" +
+                         std::to_string((*counter)++));
+  quantized_desc.SetPersistable(false);
+  auto* quantized = graph->CreateVarNode(&quantized_desc);
+
+  OpDesc dequantize_desc;
+  dequantize_desc.SetType("dequantize");
+  dequantize_desc.SetInput("Input", {quantized->Name()});
+  dequantize_desc.SetOutput("Output", {output->Name()});
+  dequantize_desc.SetAttr("Scale", scale);
+  auto* dequantize = graph->CreateOpNode(&dequantize_desc);
+
+  ReplaceNode(&op->outputs, output, quantized);
+  quantized->inputs.push_back(op);
+  IR_NODE_LINK_TO(quantized, dequantize);
+  output->inputs.clear();
+  IR_NODE_LINK_TO(dequantize, output);
+  op->Op()->SetOutput(output_name, {quantized->Name()});
+}
+
+void CPUQuantizePass::QuantizeConv(Graph* graph, Node* conv,
+                                   const VarQuantScale& scales,
+                                   int* counter) const {
+  auto* desc = conv->Op();
+  if (desc->Input("Input").size() != 1 || desc->Input("Filter").size() != 1 ||
+      desc->Output("Output").size() != 1) {
+    return;
+  }
+  // The INT8 kernel supports neither conv3d nor dilation.
+  auto strides = boost::get<std::vector<int>>(desc->GetAttr("strides"));
+  auto dilations = boost::get<std::vector<int>>(desc->GetAttr("dilations"));
+  if (strides.size() != 2 ||
+      std::any_of(dilations.begin(), dilations.end(),
+                  [](int d) { return d != 1; })) {
+    return;
+  }
+
+  auto input_name = desc->Input("Input")[0];
+  auto filter_name = desc->Input("Filter")[0];
+  auto output_name = desc->Output("Output")[0];
+  bool fuse_residual =
+      desc->HasAttr("fuse_residual_connection") &&
+      boost::get<bool>(desc->GetAttr("fuse_residual_connection"));
+  std::string residual_name;
+  if (fuse_residual) {
+    if (desc->Input("ResidualData").size() != 1) return;
+    residual_name = desc->Input("ResidualData")[0];
+    if (!HasScale(scales, residual_name)) return;
+  }
+  if (!HasScale(scales, input_name) || !HasScale(scales, filter_name) ||
+      !HasScale(scales, output_name)) {
+    VLOG(3) << "conv2d " << output_name << " has no scales, keep it in FP32";
+    return;
+  }
+
+  auto* input = FindVarNode(conv->inputs, input_name);
+  auto* output = FindVarNode(conv->outputs, output_name);
+  PADDLE_ENFORCE_NOT_NULL(input);
+  PADDLE_ENFORCE_NOT_NULL(output);
+
+  QuantizeInput(graph, conv, input, "Input", GetScale(scales, input_name),
+                IsUnsigned(scales, input_name), counter);
+  if (fuse_residual) {
+    auto* residual = FindVarNode(conv->inputs, residual_name);
+    PADDLE_ENFORCE_NOT_NULL(residual);
+    QuantizeInput(graph, conv, residual, "ResidualData",
+                  GetScale(scales, residual_name),
+                  IsUnsigned(scales, residual_name), counter);
+    desc->SetAttr("Scale_in_eltwise", GetScale(scales, residual_name));
+  }
+
+  auto& filter_scale = scales.at(filter_name).second;
+  const float* filter_scale_data = filter_scale.data<float>();
+  desc->SetAttr("Scale_in", GetScale(scales, input_name));
+  desc->SetAttr("Scale_weights",
+                std::vector<float>(filter_scale_data,
+                                   filter_scale_data + filter_scale.numel()));
+  desc->SetAttr("Scale_out", GetScale(scales, output_name));
+  desc->SetAttr("force_fp32_output", false);
+
+  DequantizeOutput(graph, conv, output, "Output",
+                   GetScale(scales, output_name), counter);
+}
+
+void CPUQuantizePass::QuantizePool(Graph* graph, Node* pool,
+                                   const VarQuantScale& scales,
+                                   int* counter) const {
+  auto* desc = pool->Op();
+  if (desc->Input("X").size() != 1 || desc->Output("Out").size() != 1) return;
+  auto input_name = desc->Input("X")[0];
+  auto output_name = desc->Output("Out")[0];
+  if (!HasScale(scales, input_name)) {
+    VLOG(3) << "pool2d " << output_name << " has no scales, keep it in FP32";
+    return;
+  }
+
+  auto* input = FindVarNode(pool->inputs, input_name);
+  auto* output = FindVarNode(pool->outputs, output_name);
+  PADDLE_ENFORCE_NOT_NULL(input);
+  PADDLE_ENFORCE_NOT_NULL(output);
+
+  // The INT8 pooling keeps the scale of the input.
+  float scale = GetScale(scales, input_name);
+  QuantizeInput(graph, pool, input, "X", scale, IsUnsigned(scales, input_name),
+                counter);
+  DequantizeOutput(graph, pool, output, "Out", scale, counter);
+}
+
+std::unique_ptr<ir::Graph> CPUQuantizePass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  PADDLE_ENFORCE(graph.get());
+  FusePassBase::Init("cpu_quantize_pass", graph.get());
+  const auto& scales = Get<VarQuantScale>("quant_var_scales");
+
+  // Visit the ops in the topological order, so that the names of the new
+  // variables do not depend on the order of the node set.
+  std::vector<Node*> ops;
+  for (auto* node : TopologySortOperations(*graph)) {
+    if (node->Op() && node->Op()->HasAttr("use_mkldnn") &&
+        boost::get<bool>(node->Op()->GetAttr("use_mkldnn"))) {
+      ops.push_back(node);
+    }
+  }
+
+  int counter = 0;
+  int quantized_count = 0;
+  for (auto* op : ops) {
+    int before = counter;
+    if (op->Op()->Type() == "conv2d") {
+      QuantizeConv(graph.get(), op, scales, &counter);
+    } else if (op->Op()->Type() == "pool2d") {
+      QuantizePool(graph.get(), op, scales, &counter);
+    }
+    if (counter != before) ++quantized_count;
+  }
+
+  AddStatis(quantized_count);
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(cpu_quantize_pass, paddle::framework::ir::CPUQuantizePass)
+    .RequirePassAttr("quant_var_scales");
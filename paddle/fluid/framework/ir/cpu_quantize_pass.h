@@ -0,0 +1,75 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * The quantization scales of the variables, keyed by the variable name. The
+ * bool tells whether the variable is unsigned, i.e. quantized to uint8
+ * instead of int8. The tensor holds one scale for an activation, and one
+ * scale per output channel for a conv filter. A scale is the multiplier
+ * mapping the float values to the integer range, e.g. 127 / max(|x|).
+ */
+using VarQuantScale =
+    std::unordered_map<std::string, std::pair<bool, LoDTensor>>;
+
+/*
+ * Run the MKL-DNN conv2d and pool2d with the INT8 kernels. A quantize op is
+ * inserted before each of their float inputs and a dequantize op after each
+ * of their outputs, the INT8 attributes of conv2d are set from the scales in
+ * the attribute "quant_var_scales". The ops whose variables have no scale
+ * are left in FP32.
+ */
+class CPUQuantizePass : public FusePassBase {
+ public:
+  virtual ~CPUQuantizePass() {}
+
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+
+ private:
+  void QuantizeConv(Graph* graph, Node* conv, const VarQuantScale& scales,
+                    int* counter) const;
+
+  void QuantizePool(Graph* graph, Node* pool, const VarQuantScale& scales,
+                    int* counter) const;
+
+  // Insert a quantize op between the input variable and the op.
+  void QuantizeInput(Graph* graph, Node* op, Node* input,
+                     const std::string& input_name, float scale,
+                     bool is_unsigned, int* counter) const;
+
+  // Insert a dequantize op between the op and the output variable.
+  void DequantizeOutput(Graph* graph, Node* op, Node* output,
+                        const std::string& output_name, float scale,
+                        int* counter) const;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,132 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/cpu_quantize_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/op_proto_maker.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetOp(ProgramDesc* prog, const std::string& type,
+           const std::vector<std::string>& inputs,
+           const std::vector<std::string>& outputs, bool use_mkldnn) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  op->SetAttr("use_mkldnn", use_mkldnn);
+  if (type == "conv2d") {
+    op->SetInput("Input", {inputs[0]});
+    op->SetInput("Filter", {inputs[1]});
+    op->SetOutput("Output", outputs);
+    op->SetAttr("strides", std::vector<int>({1, 1}));
+    op->SetAttr("dilations", std::vector<int>({1, 1}));
+    op->SetAttr("fuse_relu", true);
+  } else if (type == "pool2d") {
+    op->SetInput("X", inputs);
+    op->SetOutput("Out", outputs);
+  }
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(OpRole::kForward));
+}
+
+// (a, w1)->conv mkldnn->b
+// b->pool mkldnn->c
+// (c, w2)->conv mkldnn->d, d has no scale
+// d->pool no mkldnn->e
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v :
+       std::vector<std::string>({"a", "b", "c", "d", "e", "w1", "w2"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    if (v == "w1" || v == "w2") {
+      var->SetPersistable(true);
+    }
+  }
+
+  SetOp(&prog, "conv2d", {"a", "w1"}, {"b"}, true);
+  SetOp(&prog, "pool2d", {"b"}, {"c"}, true);
+  SetOp(&prog, "conv2d", {"c", "w2"}, {"d"}, true);
+  SetOp(&prog, "pool2d", {"d"}, {"e"}, false);
+
+  return prog;
+}
+
+VarQuantScale BuildScales() {
+  VarQuantScale scales;
+  for (auto& v : std::vector<std::string>({"a", "b", "c", "w1", "w2"})) {
+    LoDTensor scale;
+    int num = (v == "w1" || v == "w2") ? 4 : 1;
+    float* data = scale.mutable_data<float>({num}, platform::CPUPlace());
+    for (int i = 0; i < num; ++i) data[i] = 2.f + i;
+    scales[v] = std::make_pair(v != "a", scale);
+  }
+  return scales;
+}
+
+TEST(CPUQuantizePass, basic) {
+  auto prog = BuildProgramDesc();
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+
+  auto pass = PassRegistry::Instance().Get("cpu_quantize_pass");
+  pass->Set("quant_var_scales", new VarQuantScale(BuildScales()));
+
+  graph = pass->Apply(std::move(graph));
+
+  int quantize_nodes = 0;
+  int dequantize_nodes = 0;
+  int quantized_convs = 0;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    auto* op = node->Op();
+    if (op->Type() == "quantize") {
+      ++quantize_nodes;
+      auto input = op->Input("Input")[0];
+      EXPECT_TRUE(input == "a" || input == "b");
+      // a is signed, b is the output of conv+relu.
+      EXPECT_EQ(boost::get<bool>(op->GetAttr("is_negative_input")),
+                input == "a");
+    } else if (op->Type() == "dequantize") {
+      ++dequantize_nodes;
+      auto output = op->Output("Output")[0];
+      EXPECT_TRUE(output == "b" || output == "c");
+    } else if (op->Type() == "conv2d" && op->HasAttr("Scale_weights")) {
+      ++quantized_convs;
+      EXPECT_EQ(boost::get<float>(op->GetAttr("Scale_in")), 2.f);
+      EXPECT_EQ(boost::get<float>(op->GetAttr("Scale_out")), 2.f);
+      EXPECT_EQ(boost::get<std::vector<float>>(op->GetAttr("Scale_weights")),
+                std::vector<float>({2.f, 3.f, 4.f, 5.f}));
+    } else if (op->Type() == "pool2d" &&
+               boost::get<bool>(op->GetAttr("use_mkldnn"))) {
+      // The INT8 pool reads and writes the quantized variables.
+      EXPECT_NE(op->Input("X")[0], "b");
+      EXPECT_NE(op->Output("Out")[0], "c");
+    }
+  }
+
+  // The conv without the scale of its output stays in FP32.
+  EXPECT_EQ(quantize_nodes, 2);
+  EXPECT_EQ(dequantize_nodes, 2);
+  EXPECT_EQ(quantized_convs, 1);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(cpu_quantize_pass);
@@ -0,0 +1,118 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/cpu_quantize_squash_pass.h"
+#include <algorithm>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+bool IsOpOf(const Node* node, const std::string& type) {
+  return node->IsOp() && node->Op() && node->Op()->Type() == type;
+}
+
+// Make the op read from instead of the input var to, in both the graph and
+// the OpDesc.
+void RelinkInput(Node* op, Node* from, Node* to) {
+  std::replace(op->inputs.begin(), op->inputs.end(), from, to);
+  to->outputs.push_back(op);
+  op->Op()->RenameInput(from->Name(), to->Name());
+}
+
+}  // namespace
+
+std::unique_ptr<ir::Graph> CPUQuantizeSquashPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  PADDLE_ENFORCE(graph.get());
+  FusePassBase::Init("cpu_quantize_squash_pass", graph.get());
+
+  std::vector<Node*> dequantizes;
+  for (auto* node : TopologySortOperations(*graph)) {
+    if (IsOpOf(node, "dequantize")) dequantizes.push_back(node);
+  }
+
+  std::unordered_set<const Node*> nodes_to_remove;
+  int squashed_count = 0;
+  for (auto* dequantize : dequantizes) {
+    PADDLE_ENFORCE_EQ(dequantize->inputs.size(), 1UL);
+    PADDLE_ENFORCE_EQ(dequantize->outputs.size(), 1UL);
+    auto* int8_in = dequantize->inputs[0];
+    auto* fp32_out = dequantize->outputs[0];
+    float scale_in = boost::get<float>(dequantize->Op()->GetAttr("Scale"));
+
+    std::vector<Node*> quantizes;
+    for (auto* next : fp32_out->outputs) {
+      if (IsOpOf(next, "quantize")) quantizes.push_back(next);
+    }
+
+    for (auto* quantize : quantizes) {
+      PADDLE_ENFORCE_EQ(quantize->outputs.size(), 1UL);
+      auto* int8_out = quantize->outputs[0];
+      float scale_out = boost::get<float>(quantize->Op()->GetAttr("Scale"));
+
+      if (scale_in == scale_out) {
+        // The consumers read the INT8 input of the dequantize directly.
+        for (auto* next : int8_out->outputs) {
+          RelinkInput(next, int8_out, int8_in);
+        }
+        nodes_to_remove.insert(int8_out);
+      } else {
+        OpDesc requantize_desc;
+        requantize_desc.SetType("requantize");
+        requantize_desc.SetInput("Input", {int8_in->Name()});
+        requantize_desc.SetOutput("Output", {int8_out->Name()});
+        requantize_desc.SetAttr("Scale_in", scale_in);
+        requantize_desc.SetAttr("Scale_out", scale_out);
+        auto* requantize = graph->CreateOpNode(&requantize_desc);
+        IR_NODE_LINK_TO(int8_in, requantize);
+        IR_OP_VAR_LINK(requantize, int8_out);
+      }
+      nodes_to_remove.insert(quantize);
+      fp32_out->outputs.erase(std::remove(fp32_out->outputs.begin(),
+                                          fp32_out->outputs.end(), quantize),
+                              fp32_out->outputs.end());
+      ++squashed_count;
+    }
+
+    // Keep the dequantize if the float output is still used, e.g. by an FP32
+    // op or fetched.
+    if (!quantizes.empty() && fp32_out->outputs.empty()) {
+      int8_in->outputs.erase(std::remove(int8_in->outputs.begin(),
+                                         int8_in->outputs.end(), dequantize),
+                             int8_in->outputs.end());
+      nodes_to_remove.insert(dequantize);
+      nodes_to_remove.insert(fp32_out);
+    }
+  }
+  GraphSafeRemoveNodes(graph.get(), nodes_to_remove);
+
+  AddStatis(squashed_count);
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(cpu_quantize_squash_pass,
+              paddle::framework::ir::CPUQuantizeSquashPass);
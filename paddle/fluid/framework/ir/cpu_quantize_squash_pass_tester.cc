@@ -0,0 +1,111 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/cpu_quantize_squash_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetOp(ProgramDesc* prog, const std::string& type,
+           const std::vector<std::string>& inputs,
+           const std::vector<std::string>& outputs, float scale = 1.f) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  if (type == "quantize" || type == "dequantize") {
+    op->SetInput("Input", inputs);
+    op->SetOutput("Output", outputs);
+    op->SetAttr("Scale", scale);
+  } else {
+    op->SetInput("X", inputs);
+    op->SetOutput("Out", outputs);
+  }
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(OpRole::kForward));
+}
+
+// a->OP0->b
+// b->dequantize(2)->c
+// c->quantize(2)->d
+// d->OP1->e
+// e->dequantize(3)->f
+// f->quantize(4)->g
+// g->OP2->h
+// f->OP3->i
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v : std::vector<std::string>(
+           {"a", "b", "c", "d", "e", "f", "g", "h", "i"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+  }
+
+  SetOp(&prog, "OP0", {"a"}, {"b"});
+  SetOp(&prog, "dequantize", {"b"}, {"c"}, 2.f);
+  SetOp(&prog, "quantize", {"c"}, {"d"}, 2.f);
+  SetOp(&prog, "OP1", {"d"}, {"e"});
+  SetOp(&prog, "dequantize", {"e"}, {"f"}, 3.f);
+  SetOp(&prog, "quantize", {"f"}, {"g"}, 4.f);
+  SetOp(&prog, "OP2", {"g"}, {"h"});
+  SetOp(&prog, "OP3", {"f"}, {"i"});
+
+  return prog;
+}
+
+TEST(CPUQuantizeSquashPass, basic) {
+  auto prog = BuildProgramDesc();
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+
+  auto pass = PassRegistry::Instance().Get("cpu_quantize_squash_pass");
+
+  graph = pass->Apply(std::move(graph));
+
+  int quantize_nodes = 0;
+  int dequantize_nodes = 0;
+  int requantize_nodes = 0;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    auto* op = node->Op();
+    if (op->Type() == "quantize") {
+      ++quantize_nodes;
+    } else if (op->Type() == "dequantize") {
+      ++dequantize_nodes;
+      // The float output f is still used by OP3.
+      EXPECT_EQ(op->Output("Output")[0], "f");
+    } else if (op->Type() == "requantize") {
+      ++requantize_nodes;
+      EXPECT_EQ(op->Input("Input")[0], "e");
+      EXPECT_EQ(op->Output("Output")[0], "g");
+      EXPECT_EQ(boost::get<float>(op->GetAttr("Scale_in")), 3.f);
+      EXPECT_EQ(boost::get<float>(op->GetAttr("Scale_out")), 4.f);
+    } else if (op->Type() == "OP1") {
+      // The pair with the same scale is removed.
+      EXPECT_EQ(op->Input("X")[0], "b");
+    }
+  }
+
+  EXPECT_EQ(quantize_nodes, 0);
+  EXPECT_EQ(dequantize_nodes, 1);
+  EXPECT_EQ(requantize_nodes, 1);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(cpu_quantize_squash_pass);
@@ -0,0 +1,143 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/fluid/framework/ir/embedding_seqpool_fuse_pass.h"
+#include <string>
+#include <unordered_set>
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static void BuildEmbeddingSeqPoolPattern(PDPattern* pattern,
+                                         const std::string& name_scope) {
+  // The lookup_table without the padding and the distributed lookup, whose
+  // Ids are the sequences of one id.
+  auto* ids = pattern->NewNode(name_scope + "/ids")
+                  ->assert_is_op_input("lookup_table", "Ids")
+                  ->assert_more([](Node* x) {
+                    auto* desc = x->Var();
+                    if (!desc || desc->GetLoDLevel() != 1) return false;
+                    auto shape = desc->GetShape();
+                    return !shape.empty() && shape.back() == 1;
+                  });
+  auto* w = pattern->NewNode(name_scope + "/w")
+                ->assert_is_op_input("lookup_table", "W")
+                ->assert_is_persistable_var();
+  auto* lookup_table =
+      pattern->NewNode(name_scope + "/lookup_table")
+          ->assert_is_op("lookup_table")
+          ->assert_op_attr<int64_t>("padding_idx", -1)
+          ->assert_more([](Node* x) {
+            auto* op = x->Op();
+            return !(op->HasAttr("is_distributed") &&
+                     boost::get<bool>(op->GetAttr("is_distributed"))) &&
+                   !(op->HasAttr("remote_prefetch") &&
+                     boost::get<bool>(op->GetAttr("remote_prefetch")));
+          });
+  auto* emb_out = pattern->NewNode(name_scope + "/emb_out")
+                      ->assert_is_only_output_of_op("lookup_table")
+                      ->assert_is_op_input("sequence_pool", "X")
+                      ->assert_more([](Node* x) {
+                        return x->outputs.size() == 1;
+                      });
+  // The outputs of sequence_pool except Out (MaxIndex) should be unused.
+  auto* seqpool =
+      pattern->NewNode(name_scope + "/sequence_pool")
+          ->assert_is_op("sequence_pool")
+          ->assert_more([](Node* x) {
+            auto pooltype = boost::get<std::string>(x->Op()->GetAttr(
+                "pooltype"));
+            if (pooltype != "SUM" && pooltype != "AVERAGE") return false;
+            auto out_name = x->Op()->Output("Out");
+            for (auto* out : x->outputs) {
+              if (out_name.empty() || out->Name() != out_name[0]) {
+                if (!out->outputs.empty()) return false;
+              }
+            }
+            return true;
+          });
+  auto* pool_out = pattern->NewNode(name_scope + "/pool_out")
+                       ->assert_is_op_output("sequence_pool", "Out");
+
+  lookup_table->LinksFrom({ids, w}).LinksTo({emb_out});
+  seqpool->LinksFrom({emb_out}).LinksTo({pool_out});
+}
+
+static int BuildFusion(Graph* graph, const std::string& name_scope) {
+  GraphPatternDetector gpd;
+  auto* pattern = gpd.mutable_pattern();
+  BuildEmbeddingSeqPoolPattern(pattern, name_scope);
+
+  auto retrieve_node = [&](const std::string& name,
+                           const GraphPatternDetector::subgraph_t& subgraph)
+      -> Node* {
+    auto* pd_node = gpd.pattern().RetrieveNode(name_scope + "/" + name);
+    PADDLE_ENFORCE(subgraph.count(pd_node), "pattern has no Node called %s",
+                   name.c_str());
+    return subgraph.at(pd_node);
+  };
+
+  int fusion_count{0};
+  auto handler = [&](const GraphPatternDetector::subgraph_t& subgraph,
+                     Graph* g) {
+    VLOG(4) << "handle Embedding SeqPool fuse";
+    Node* ids = retrieve_node("ids", subgraph);
+    Node* w = retrieve_node("w", subgraph);
+    Node* lookup_table = retrieve_node("lookup_table", subgraph);
+    Node* emb_out = retrieve_node("emb_out", subgraph);
+    Node* seqpool = retrieve_node("sequence_pool", subgraph);
+    Node* pool_out = retrieve_node("pool_out", subgraph);
+
+    auto pooltype = boost::get<std::string>(seqpool->Op()->GetAttr("pooltype"));
+    OpDesc op_desc;
+    op_desc.SetType("fused_embedding_seq_pool");
+    op_desc.SetInput("Ids", {ids->Name()});
+    op_desc.SetInput("W", {w->Name()});
+    op_desc.SetOutput("Out", {pool_out->Name()});
+    op_desc.SetAttr("combiner",
+                    std::string(pooltype == "SUM" ? "sum" : "mean"));
+    op_desc.SetAttr("is_sparse", lookup_table->Op()->GetAttr("is_sparse"));
+    auto* op = g->CreateOpNode(&op_desc);
+    IR_NODE_LINK_TO(ids, op);
+    IR_NODE_LINK_TO(w, op);
+    IR_NODE_LINK_TO(op, pool_out);
+
+    std::unordered_set<const Node*> marked_nodes(
+        {lookup_table, emb_out, seqpool});
+    for (auto* out : seqpool->outputs) {
+      if (out != pool_out) marked_nodes.insert(out);
+    }
+    GraphSafeRemoveNodes(g, marked_nodes);
+    ++fusion_count;
+  };
+
+  gpd(graph, handler);
+  return fusion_count;
+}
+
+std::unique_ptr<ir::Graph> EmbeddingSeqPoolFusePass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  FusePassBase::Init(name_scope_, graph.get());
+  int fusion_count = BuildFusion(graph.get(), name_scope_);
+  AddStatis(fusion_count);
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(embedding_seqpool_fuse_pass,
+              paddle::framework::ir::EmbeddingSeqPoolFusePass);
@@ -0,0 +1,56 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/**
+ * Fuse LookupTable and SequencePool(with SUM or AVERAGE pooltype), so that
+ * the lookup result of all the ids is not stored;
+ *
+ * Before fuse:
+ *   Ids     W
+ *     \    /
+ *   lookup_table
+ *        |
+ *   sequence_pool
+ *        |
+ * After fuse:
+ *   Ids     W
+ *     \    /
+ *   fused_embedding_seq_pool
+ *        |
+ */
+class EmbeddingSeqPoolFusePass : public FusePassBase {
+ public:
+  virtual ~EmbeddingSeqPoolFusePass() {}
+
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(std::unique_ptr<ir::Graph> graph) const;
+
+  const std::string name_scope_{"embedding_seqpool_fuse"};
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,148 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/embedding_seqpool_fuse_pass.h"
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetOp(ProgramDesc* prog, const std::string& type,
+           const std::vector<std::string>& inputs,
+           const std::vector<std::string>& outputs) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  if (type == "lookup_table") {
+    op->SetInput("Ids", {inputs[0]});
+    op->SetInput("W", {inputs[1]});
+    op->SetOutput("Out", {outputs[0]});
+    op->SetAttr("padding_idx", static_cast<int64_t>(-1));
+    op->SetAttr("is_sparse", true);
+  } else if (type == "sequence_pool") {
+    op->SetInput("X", {inputs[0]});
+    std::string pooltype = "AVERAGE";
+    op->SetAttr("pooltype", pooltype);
+    op->SetOutput("MaxIndex", {outputs[0]});
+    op->SetOutput("Out", {outputs[1]});
+  } else {
+    op->SetInput("X", inputs);
+    op->SetOutput("Out", outputs);
+  }
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(OpRole::kForward));
+}
+
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v : std::vector<std::string>({"a", "b", "c", "d", "e", "f"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+  }
+  auto* ids = prog.MutableBlock(0)->Var("a");
+  ids->SetLoDLevel(1);
+  ids->SetShape({-1, 1});
+  prog.MutableBlock(0)->Var("b")->SetPersistable(true);
+  return prog;
+}
+
+int CountOpType(const ir::Graph* graph,
+                const std::string& op_type = "fused_embedding_seq_pool") {
+  int count = 0;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op()->Type() == op_type) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+/*
+ * Before fuse:
+ *    a    b
+ *     \  /
+ *   lookup_table
+ *       |
+ *       c
+ *       |
+ *   sequence_pool
+ *     /   \
+ *    d     e
+ *
+ * After fuse:
+ *    a    b
+ *     \  /
+ *   fused_embedding_seq_pool
+ *       |
+ *       e
+ */
+TEST(EmbeddingSeqPoolFusePass, basic) {
+  auto prog = BuildProgramDesc();
+  SetOp(&prog, "lookup_table", {"a", "b"}, {"c"});
+  SetOp(&prog, "sequence_pool", {"c"}, {"d", "e"});
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  int before = graph->Nodes().size();
+  auto pass = PassRegistry::Instance().Get("embedding_seqpool_fuse_pass");
+  graph = pass->Apply(std::move(graph));
+  int after = graph->Nodes().size();
+
+  // Remove 4 Nodes: lookup_table, c, sequence_pool, d
+  // Add 1 Node: fused_embedding_seq_pool
+  EXPECT_EQ(after, before - 3);
+  EXPECT_EQ(CountOpType(graph.get()), 1);
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op()->Type() == "fused_embedding_seq_pool") {
+      EXPECT_EQ(boost::get<std::string>(node->Op()->GetAttr("combiner")),
+                "mean");
+      EXPECT_EQ(node->outputs.size(), 1UL);
+      EXPECT_EQ(node->outputs[0]->Name(), "e");
+    }
+  }
+}
+
+/*
+ * The lookup result c is also used by op1, so it is kept.
+ *    a    b
+ *     \  /
+ *   lookup_table
+ *       |
+ *       c
+ *     /   \
+ *   op1  sequence_pool
+ *    |     /   \
+ *    f    d     e
+ */
+TEST(EmbeddingSeqPoolFusePass, lookup_out_used) {
+  auto prog = BuildProgramDesc();
+  SetOp(&prog, "lookup_table", {"a", "b"}, {"c"});
+  SetOp(&prog, "relu", {"c"}, {"f"});
+  SetOp(&prog, "sequence_pool", {"c"}, {"d", "e"});
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  int before = graph->Nodes().size();
+  auto pass = PassRegistry::Instance().Get("embedding_seqpool_fuse_pass");
+  graph = pass->Apply(std::move(graph));
+  int after = graph->Nodes().size();
+
+  EXPECT_EQ(after, before);
+  EXPECT_EQ(CountOpType(graph.get()), 0);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(embedding_seqpool_fuse_pass);
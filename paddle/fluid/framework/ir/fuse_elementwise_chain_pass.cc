@@ -0,0 +1,220 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/fuse_elementwise_chain_pass.h"
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+// The same as kMaxChainSteps and kMaxChainInputs of the op.
+constexpr size_t kMaxChainSteps = 16;
+constexpr size_t kMaxChainInputs = 8;
+
+bool IsBinaryStep(const std::string& type) {
+  return type == "elementwise_add" || type == "elementwise_sub" ||
+         type == "elementwise_mul" || type == "elementwise_div";
+}
+
+bool IsHalfOrFloat(proto::VarType::Type type) {
+  return type == proto::VarType::FP16 || type == proto::VarType::FP32;
+}
+
+bool IsHalfOrFloatTensor(Node* var) {
+  return var->Var() != nullptr &&
+         var->Var()->GetType() == proto::VarType::LOD_TENSOR &&
+         IsHalfOrFloat(var->Var()->GetDataType());
+}
+
+Node* FindVar(const std::vector<Node*>& vars, const std::string& name) {
+  for (auto* var : vars) {
+    if (var->IsVar() && var->Name() == name) return var;
+  }
+  return nullptr;
+}
+
+bool IsChainStep(Node* op) {
+  static const std::unordered_set<std::string> kUnaryTypes{
+      "relu", "sigmoid", "tanh", "scale", "cast"};
+  auto* desc = op->Op();
+  if (desc == nullptr) return false;
+  const std::string& type = desc->Type();
+  bool binary = IsBinaryStep(type);
+  if (!binary && !kUnaryTypes.count(type)) return false;
+  auto role_attr = OpProtoAndCheckerMaker::OpRoleAttrName();
+  if (desc->HasAttr(role_attr) &&
+      boost::get<int>(desc->GetAttr(role_attr)) !=
+          static_cast<int>(OpRole::kForward)) {
+    return false;
+  }
+  if (desc->HasAttr("use_mkldnn") &&
+      boost::get<bool>(desc->GetAttr("use_mkldnn"))) {
+    return false;
+  }
+  if (desc->Input("X").size() != 1 || desc->Output("Out").size() != 1) {
+    return false;
+  }
+  if (desc->InputArgumentNames().size() != (binary ? 2UL : 1UL)) {
+    return false;
+  }
+  if (binary && (desc->Input("Y").size() != 1 ||
+                 desc->Input("Y")[0] == desc->Input("X")[0])) {
+    return false;
+  }
+  for (auto& name : desc->InputArgumentNames()) {
+    auto* var = FindVar(op->inputs, name);
+    if (var == nullptr || !IsHalfOrFloatTensor(var)) return false;
+  }
+  auto* out = FindVar(op->outputs, desc->Output("Out")[0]);
+  if (out == nullptr || !IsHalfOrFloatTensor(out)) return false;
+  if (type == "cast") {
+    for (auto& attr : {"in_dtype", "out_dtype"}) {
+      if (!IsHalfOrFloat(static_cast<proto::VarType::Type>(
+              boost::get<int>(desc->GetAttr(attr))))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// The op of the chain after op, or nullptr if the output of op is not only
+// the X of a chain step.
+Node* NextChainStep(Node* op) {
+  auto* out = FindVar(op->outputs, op->Op()->Output("Out")[0]);
+  if (out->outputs.size() != 1 || out->Var()->Persistable()) return nullptr;
+  auto* next = out->outputs[0];
+  if (!IsChainStep(next) || next->Op()->Input("X")[0] != out->Name()) {
+    return nullptr;
+  }
+  return next;
+}
+
+void FuseChain(Graph* graph, const std::vector<Node*>& chain) {
+  auto* first = chain.front()->Op();
+  auto* last = chain.back()->Op();
+  Node* x = FindVar(chain.front()->inputs, first->Input("X")[0]);
+  Node* out = FindVar(chain.back()->outputs, last->Output("Out")[0]);
+
+  std::vector<std::string> functors;
+  std::vector<float> alpha, beta;
+  std::vector<int> axis, cast_dtype;
+  std::vector<std::string> ys;
+  std::vector<Node*> y_vars;
+  std::unordered_set<const Node*> marked_nodes;
+  for (auto* op : chain) {
+    auto* desc = op->Op();
+    const std::string& type = desc->Type();
+    functors.push_back(type);
+    float a = 1.f, b = 0.f;
+    int ax = -1, dtype = -1;
+    if (type == "scale") {
+      a = boost::get<float>(desc->GetAttr("scale"));
+      b = boost::get<float>(desc->GetAttr("bias"));
+      if (!boost::get<bool>(desc->GetAttr("bias_after_scale"))) b *= a;
+    } else if (type == "cast") {
+      dtype = boost::get<int>(desc->GetAttr("out_dtype"));
+    } else if (IsBinaryStep(type)) {
+      ax = boost::get<int>(desc->GetAttr("axis"));
+      ys.push_back(desc->Input("Y")[0]);
+      y_vars.push_back(FindVar(op->inputs, ys.back()));
+    }
+    alpha.push_back(a);
+    beta.push_back(b);
+    axis.push_back(ax);
+    cast_dtype.push_back(dtype);
+    marked_nodes.insert(op);
+    if (op != chain.back()) {
+      marked_nodes.insert(FindVar(op->outputs, desc->Output("Out")[0]));
+    }
+  }
+
+  OpDesc desc;
+  desc.SetType("fused_elementwise_chain");
+  desc.SetInput("X", {x->Name()});
+  desc.SetInput("Y", ys);
+  desc.SetOutput("Out", {out->Name()});
+  desc.SetAttr("functor_list", functors);
+  desc.SetAttr("alpha", alpha);
+  desc.SetAttr("beta", beta);
+  desc.SetAttr("axis", axis);
+  desc.SetAttr("cast_dtype", cast_dtype);
+  desc.SetAttr("out_dtype", static_cast<int>(out->Var()->GetDataType()));
+  auto role_attr = OpProtoAndCheckerMaker::OpRoleAttrName();
+  if (first->HasAttr(role_attr)) {
+    desc.SetAttr(role_attr, first->GetAttr(role_attr));
+  }
+  auto* fused_op = graph->CreateOpNode(&desc);
+
+  std::unordered_set<Node*> linked{x};
+  IR_NODE_LINK_TO(x, fused_op);
+  for (auto* y : y_vars) {
+    if (linked.insert(y).second) {
+      IR_NODE_LINK_TO(y, fused_op);
+    }
+  }
+  IR_NODE_LINK_TO(fused_op, out);
+  GraphSafeRemoveNodes(graph, marked_nodes);
+}
+
+}  // namespace
+
+std::unique_ptr<ir::Graph> FuseElementwiseChainPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  FusePassBase::Init(name_scope_, graph.get());
+
+  // The chains are found before the graph is changed, in the topological
+  // order, so that a chain starts at its first op.
+  std::unordered_set<Node*> visited;
+  std::vector<std::vector<Node*>> chains;
+  for (auto* op : TopologySortOperations(*graph)) {
+    if (visited.count(op) || !IsChainStep(op)) continue;
+    std::vector<Node*> chain{op};
+    size_t num_inputs = IsBinaryStep(op->Op()->Type()) ? 1 : 0;
+    for (Node* next = NextChainStep(op); next != nullptr;
+         next = NextChainStep(next)) {
+      size_t next_inputs = IsBinaryStep(next->Op()->Type()) ? 1 : 0;
+      if (chain.size() == kMaxChainSteps ||
+          num_inputs + next_inputs > kMaxChainInputs) {
+        break;
+      }
+      num_inputs += next_inputs;
+      chain.push_back(next);
+    }
+    visited.insert(chain.begin(), chain.end());
+    if (chain.size() > 1) chains.push_back(chain);
+  }
+
+  for (auto& chain : chains) {
+    VLOG(4) << "fuse a chain of " << chain.size() << " elementwise ops";
+    FuseChain(graph.get(), chain);
+  }
+  AddStatis(static_cast<int>(chains.size()));
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(fuse_elementwise_chain_pass,
+              paddle::framework::ir::FuseElementwiseChainPass);
@@ -0,0 +1,70 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Fuse the chains of the elementwise ops into fused_elementwise_chain ops,
+ * which read the input and write the output of a chain once.
+ *
+ * Before fuse:
+ *      x
+ *      |
+ *    scale
+ *      |
+ *     cast        y
+ *      |         /
+ *  elementwise_add
+ *      |
+ *     relu
+ *      |
+ *     out
+ *
+ * After fuse:
+ *      x     y
+ *      |    /
+ *  fused_elementwise_chain
+ *      |
+ *     out
+ *
+ * The steps of a chain are relu, sigmoid, tanh, scale, the casts between
+ * float16 and float32, and the elementwise add, sub, mul and div of a Y,
+ * which is broadcast to the chain. A chain is continued through the X of the
+ * next op, if the intermediate output is used by it only, so that no
+ * intermediate tensor is needed outside of the chain. The chains of one op
+ * are left unfused.
+ */
+class FuseElementwiseChainPass : public FusePassBase {
+ public:
+  virtual ~FuseElementwiseChainPass() {}
+
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+
+  const std::string name_scope_{"fuse_elementwise_chain"};
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,126 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/fuse_elementwise_chain_pass.h"
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetOp(ProgramDesc* prog, const std::string& type,
+           const std::vector<std::string>& inputs,
+           const std::vector<std::string>& outputs) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  op->SetInput("X", {inputs[0]});
+  op->SetOutput("Out", {outputs[0]});
+  if (type == "elementwise_add" || type == "elementwise_mul") {
+    op->SetInput("Y", {inputs[1]});
+    op->SetAttr("axis", -1);
+  } else if (type == "scale") {
+    op->SetAttr("scale", 2.f);
+    op->SetAttr("bias", 1.f);
+    op->SetAttr("bias_after_scale", false);
+  } else if (type == "cast") {
+    op->SetAttr("in_dtype", static_cast<int>(proto::VarType::FP32));
+    op->SetAttr("out_dtype", static_cast<int>(proto::VarType::FP16));
+  }
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(OpRole::kForward));
+}
+
+// a -> scale -> b -> cast -> c -> elementwise_add(y) -> d -> relu -> e,
+// and d is also used by tanh if branched.
+ProgramDesc BuildProgramDesc(bool branched) {
+  ProgramDesc prog;
+  auto* block = prog.MutableBlock(0);
+  for (auto& v :
+       std::vector<std::string>({"a", "b", "c", "d", "e", "f", "y"})) {
+    auto* var = block->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP16);
+  }
+  block->Var("a")->SetDataType(proto::VarType::FP32);
+  block->Var("b")->SetDataType(proto::VarType::FP32);
+
+  SetOp(&prog, "scale", {"a"}, {"b"});
+  SetOp(&prog, "cast", {"b"}, {"c"});
+  SetOp(&prog, "elementwise_add", {"c", "y"}, {"d"});
+  SetOp(&prog, "relu", {"d"}, {"e"});
+  if (branched) {
+    SetOp(&prog, "tanh", {"d"}, {"f"});
+  }
+  return prog;
+}
+
+std::vector<const OpDesc*> GetFusedOps(const ir::Graph* graph) {
+  std::vector<const OpDesc*> fused;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op()->Type() == "fused_elementwise_chain") {
+      fused.push_back(node->Op());
+    }
+  }
+  return fused;
+}
+
+TEST(FuseElementwiseChainPass, basic) {
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(BuildProgramDesc(false)));
+  auto pass = PassRegistry::Instance().Get("fuse_elementwise_chain_pass");
+  int before = graph->Nodes().size();
+  graph = pass->Apply(std::move(graph));
+  // Remove the 4 ops, b, c and d. Add fused_elementwise_chain.
+  EXPECT_EQ(static_cast<int>(graph->Nodes().size()), before - 6);
+
+  auto fused = GetFusedOps(graph.get());
+  ASSERT_EQ(fused.size(), 1UL);
+  auto* op = fused[0];
+  EXPECT_EQ(op->Input("X"), std::vector<std::string>({"a"}));
+  EXPECT_EQ(op->Input("Y"), std::vector<std::string>({"y"}));
+  EXPECT_EQ(op->Output("Out"), std::vector<std::string>({"e"}));
+  EXPECT_EQ(boost::get<std::vector<std::string>>(op->GetAttr("functor_list")),
+            std::vector<std::string>(
+                {"scale", "cast", "elementwise_add", "relu"}));
+  auto alpha = boost::get<std::vector<float>>(op->GetAttr("alpha"));
+  auto beta = boost::get<std::vector<float>>(op->GetAttr("beta"));
+  EXPECT_EQ(alpha[0], 2.f);
+  // The bias before the scale is scaled.
+  EXPECT_EQ(beta[0], 2.f);
+  EXPECT_EQ(boost::get<std::vector<int>>(op->GetAttr("cast_dtype")),
+            std::vector<int>({-1, proto::VarType::FP16, -1, -1}));
+  EXPECT_EQ(boost::get<int>(op->GetAttr("out_dtype")),
+            static_cast<int>(proto::VarType::FP16));
+}
+
+TEST(FuseElementwiseChainPass, branched) {
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(BuildProgramDesc(true)));
+  auto pass = PassRegistry::Instance().Get("fuse_elementwise_chain_pass");
+  int before = graph->Nodes().size();
+  graph = pass->Apply(std::move(graph));
+  // The chain stops at d, which is used by relu and tanh: remove scale,
+  // cast, elementwise_add, b and c, and add fused_elementwise_chain. The
+  // relu and the tanh are chains of one op.
+  EXPECT_EQ(static_cast<int>(graph->Nodes().size()), before - 4);
+
+  auto fused = GetFusedOps(graph.get());
+  ASSERT_EQ(fused.size(), 1UL);
+  EXPECT_EQ(fused[0]->Output("Out"), std::vector<std::string>({"d"}));
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(fuse_elementwise_chain_pass);
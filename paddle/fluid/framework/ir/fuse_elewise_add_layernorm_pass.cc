@@ -0,0 +1,104 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/fuse_elewise_add_layernorm_pass.h"
+#include <string>
+#include <unordered_set>
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+std::unique_ptr<ir::Graph> FuseElewiseAddLayerNormPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  FusePassBase::Init(name_scope_, graph.get());
+
+  GraphPatternDetector gpd;
+  auto* x = gpd.mutable_pattern()->NewNode(name_scope_ + "/x");
+  auto* y = gpd.mutable_pattern()->NewNode(name_scope_ + "/y");
+  patterns::ElewiseAddLayerNorm pattern(gpd.mutable_pattern(), name_scope_);
+  pattern(x, y);
+
+  int found_count = 0;
+  auto handler = [&](const GraphPatternDetector::subgraph_t& subgraph,
+                     Graph* g) {
+    VLOG(4) << "handle ElewiseAddLayerNorm fuse";
+    GET_IR_NODE_FROM_SUBGRAPH(eltwise_add, eltwise_add, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(eltwise_add_out, eltwise_add_out, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(layer_norm, layer_norm, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(layer_norm_out, layer_norm_out, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(layer_norm_mean, layer_norm_mean, pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(layer_norm_variance, layer_norm_variance,
+                              pattern);
+    Node* x_var = subgraph.at(x);
+    Node* y_var = subgraph.at(y);
+
+    // The fused op does not broadcast Y.
+    if (!x_var->Var() || !y_var->Var() ||
+        x_var->Var()->GetShape() != y_var->Var()->GetShape()) {
+      return;
+    }
+
+    auto* ln_desc = layer_norm->Op();
+    OpDesc desc;
+    desc.SetType("fused_elementwise_add_layernorm");
+    desc.SetInput("X", {x_var->Name()});
+    desc.SetInput("Y", {y_var->Name()});
+    std::unordered_set<std::string> args;
+    for (auto& arg : {"Scale", "Bias"}) {
+      if (ln_desc->Inputs().count(arg) && !ln_desc->Input(arg).empty()) {
+        desc.SetInput(arg, ln_desc->Input(arg));
+        args.insert(ln_desc->Input(arg)[0]);
+      }
+    }
+    desc.SetOutput("Out", {layer_norm_out->Name()});
+    bool sum_used = eltwise_add_out->outputs.size() > 1;
+    if (sum_used) {
+      desc.SetOutput("SumOut", {eltwise_add_out->Name()});
+    }
+    desc.SetAttr("epsilon", ln_desc->GetAttr("epsilon"));
+    desc.SetAttr("begin_norm_axis", ln_desc->GetAttr("begin_norm_axis"));
+    auto* fused_op = g->CreateOpNode(&desc);
+
+    IR_NODE_LINK_TO(x_var, fused_op);
+    IR_NODE_LINK_TO(y_var, fused_op);
+    for (auto* in : layer_norm->inputs) {
+      if (args.count(in->Name())) {
+        IR_NODE_LINK_TO(in, fused_op);
+      }
+    }
+    IR_NODE_LINK_TO(fused_op, layer_norm_out);
+
+    std::unordered_set<const Node*> marked_nodes(
+        {eltwise_add, layer_norm, layer_norm_mean, layer_norm_variance});
+    if (sum_used) {
+      IR_NODE_LINK_TO(fused_op, eltwise_add_out);
+    } else {
+      marked_nodes.insert(eltwise_add_out);
+    }
+    GraphSafeRemoveNodes(g, marked_nodes);
+    ++found_count;
+  };
+
+  gpd(graph.get(), handler);
+  AddStatis(found_count);
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(fuse_elewise_add_layernorm_pass,
+              paddle::framework::ir::FuseElewiseAddLayerNormPass);
@@ -0,0 +1,66 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Fuse the elementwise_add of two tensors of the same shape and the
+ * layer_norm of the sum into a fused_elementwise_add_layernorm op, which is
+ * the residual connection and normalization of Transformer.
+ *
+ * Before fuse:
+ *   x     y
+ *    \   /
+ *  elementwise_add
+ *       |
+ *      sum ----> (other ops)
+ *       |
+ *   layer_norm
+ *    |   |   \
+ *  out mean variance
+ *
+ * After fuse:
+ *   x     y
+ *    \   /
+ *  fused_elementwise_add_layernorm
+ *    |     \
+ *   out   (sum) ----> (other ops)
+ *
+ * The sum is kept only if it is used by other ops. The fusion is not applied
+ * if the mean or variance is used, e.g., by layer_norm_grad.
+ */
+class FuseElewiseAddLayerNormPass : public FusePassBase {
+ public:
+  virtual ~FuseElewiseAddLayerNormPass() {}
+
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+
+  const std::string name_scope_{"fuse_elewise_add_layernorm"};
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
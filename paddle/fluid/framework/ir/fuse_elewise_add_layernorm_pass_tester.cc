@@ -0,0 +1,138 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/fuse_elewise_add_layernorm_pass.h"
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetOp(ProgramDesc* prog, const std::string& type,
+           const std::vector<std::string>& inputs,
+           const std::vector<std::string>& outputs) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  if (type == "elementwise_add") {
+    op->SetInput("X", {inputs[0]});
+    op->SetInput("Y", {inputs[1]});
+    op->SetOutput("Out", {outputs[0]});
+    op->SetAttr("axis", -1);
+  } else if (type == "layer_norm") {
+    op->SetInput("X", {inputs[0]});
+    op->SetInput("Scale", {inputs[1]});
+    op->SetInput("Bias", {inputs[2]});
+    op->SetOutput("Y", {outputs[0]});
+    op->SetOutput("Mean", {outputs[1]});
+    op->SetOutput("Variance", {outputs[2]});
+    op->SetAttr("epsilon", 1e-5f);
+    op->SetAttr("begin_norm_axis", 2);
+  } else {
+    op->SetInput("X", inputs);
+    op->SetOutput("Out", outputs);
+  }
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(OpRole::kForward));
+}
+
+// a + b -> c -> layer_norm -> d, and c is also used by relu if sum_used.
+ProgramDesc BuildProgramDesc(bool sum_used, bool same_shape = true) {
+  ProgramDesc prog;
+  auto* block = prog.MutableBlock(0);
+  for (auto& v : std::vector<std::string>(
+           {"a", "b", "c", "d", "mean", "variance", "scale", "bias", "e"})) {
+    auto* var = block->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+  }
+  block->Var("a")->SetShape({-1, 128, 512});
+  block->Var("b")->SetShape({-1, 128, same_shape ? 512 : 1});
+
+  SetOp(&prog, "elementwise_add", {"a", "b"}, {"c"});
+  SetOp(&prog, "layer_norm", {"c", "scale", "bias"}, {"d", "mean", "variance"});
+  if (sum_used) {
+    SetOp(&prog, "relu", {"c"}, {"e"});
+  }
+  return prog;
+}
+
+const OpDesc* GetFusedOp(const ir::Graph* graph) {
+  const OpDesc* fused = nullptr;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() &&
+        node->Op()->Type() == "fused_elementwise_add_layernorm") {
+      EXPECT_EQ(fused, nullptr);
+      fused = node->Op();
+    }
+  }
+  return fused;
+}
+
+TEST(FuseElewiseAddLayerNormPass, basic) {
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(BuildProgramDesc(false)));
+  auto pass = PassRegistry::Instance().Get("fuse_elewise_add_layernorm_pass");
+  int before = graph->Nodes().size();
+  graph = pass->Apply(std::move(graph));
+  // Remove elementwise_add, c, layer_norm, mean and variance.
+  // Add fused_elementwise_add_layernorm.
+  EXPECT_EQ(static_cast<int>(graph->Nodes().size()), before - 4);
+
+  auto* op = GetFusedOp(graph.get());
+  ASSERT_NE(op, nullptr);
+  EXPECT_EQ(op->Input("X"), std::vector<std::string>({"a"}));
+  EXPECT_EQ(op->Input("Y"), std::vector<std::string>({"b"}));
+  EXPECT_EQ(op->Input("Scale"), std::vector<std::string>({"scale"}));
+  EXPECT_EQ(op->Input("Bias"), std::vector<std::string>({"bias"}));
+  EXPECT_EQ(op->Output("Out"), std::vector<std::string>({"d"}));
+  EXPECT_EQ(op->Outputs().count("SumOut"), 0UL);
+  EXPECT_EQ(boost::get<int>(op->GetAttr("begin_norm_axis")), 2);
+}
+
+TEST(FuseElewiseAddLayerNormPass, sum_used) {
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(BuildProgramDesc(true)));
+  auto pass = PassRegistry::Instance().Get("fuse_elewise_add_layernorm_pass");
+  int before = graph->Nodes().size();
+  graph = pass->Apply(std::move(graph));
+  // Remove elementwise_add, layer_norm, mean and variance.
+  // Add fused_elementwise_add_layernorm.
+  EXPECT_EQ(static_cast<int>(graph->Nodes().size()), before - 3);
+
+  auto* op = GetFusedOp(graph.get());
+  ASSERT_NE(op, nullptr);
+  EXPECT_EQ(op->Output("SumOut"), std::vector<std::string>({"c"}));
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar() && node->Name() == "c") {
+      ASSERT_EQ(node->inputs.size(), 1UL);
+      EXPECT_EQ(node->inputs[0]->Op(), op);
+      ASSERT_EQ(node->outputs.size(), 1UL);
+      EXPECT_EQ(node->outputs[0]->Op()->Type(), "relu");
+    }
+  }
+}
+
+TEST(FuseElewiseAddLayerNormPass, broadcast) {
+  std::unique_ptr<ir::Graph> graph(
+      new ir::Graph(BuildProgramDesc(false, false)));
+  auto pass = PassRegistry::Instance().Get("fuse_elewise_add_layernorm_pass");
+  int before = graph->Nodes().size();
+  graph = pass->Apply(std::move(graph));
+  EXPECT_EQ(static_cast<int>(graph->Nodes().size()), before);
+  EXPECT_EQ(GetFusedOp(graph.get()), nullptr);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(fuse_elewise_add_layernorm_pass);
@@ -0,0 +1,110 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/fuse_fake_quantize_dequantize_pass.h"
+#include <cmath>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static ir::Node* FindVar(const std::vector<ir::Node*>& nodes,
+                         const std::string& name) {
+  for (auto* node : nodes) {
+    if (node->IsVar() && node->Name() == name) return node;
+  }
+  return nullptr;
+}
+
+// The dequantize op of the quantize op, if the pair can be fused.
+static ir::Node* FusibleDequantize(ir::Node* quant) {
+  auto* quant_desc = quant->Op();
+  auto* quant_out = FindVar(quant->outputs, quant_desc->Output("Out")[0]);
+  if (quant_out == nullptr || quant_out->outputs.size() != 1) return nullptr;
+  auto* dequant = quant_out->outputs[0];
+  if (!dequant->IsOp() || dequant->Op() == nullptr ||
+      dequant->Op()->Type() != "fake_dequantize_max_abs") {
+    return nullptr;
+  }
+  auto* dequant_desc = dequant->Op();
+  if (dequant_desc->Input("X")[0] != quant_out->Name() ||
+      dequant_desc->Input("Scale")[0] != quant_desc->Output("OutScale")[0]) {
+    return nullptr;
+  }
+  int bit_length = boost::get<int>(quant_desc->GetAttr("bit_length"));
+  float bin_cnt = std::pow(2, bit_length - 1) - 1;
+  float max_range = boost::get<float>(dequant_desc->GetAttr("max_range"));
+  return max_range == bin_cnt ? dequant : nullptr;
+}
+
+std::unique_ptr<ir::Graph> FuseFakeQuantizeDequantizePass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  std::vector<std::pair<ir::Node*, ir::Node*>> pairs;
+  for (auto* node : TopologySortOperations(*graph)) {
+    if (node->Op() == nullptr ||
+        node->Op()->Type() != "fake_quantize_abs_max") {
+      continue;
+    }
+    auto* dequant = FusibleDequantize(node);
+    if (dequant != nullptr) pairs.emplace_back(node, dequant);
+  }
+
+  for (auto& pair : pairs) {
+    auto* quant_desc = pair.first->Op();
+    auto* dequant_desc = pair.second->Op();
+    auto* x = FindVar(pair.first->inputs, quant_desc->Input("X")[0]);
+    auto* quant_out =
+        FindVar(pair.first->outputs, quant_desc->Output("Out")[0]);
+    auto* scale =
+        FindVar(pair.first->outputs, quant_desc->Output("OutScale")[0]);
+    auto* out = FindVar(pair.second->outputs, dequant_desc->Output("Out")[0]);
+    PADDLE_ENFORCE(x && scale && out, "The pair of %s is not linked.",
+                   quant_desc->Output("Out")[0]);
+
+    OpDesc desc;
+    desc.SetType("fake_quantize_dequantize_abs_max");
+    desc.SetInput("X", {x->Name()});
+    desc.SetOutput("Out", {out->Name()});
+    desc.SetOutput("OutScale", {scale->Name()});
+    desc.SetAttr("bit_length", quant_desc->GetAttr("bit_length"));
+    desc.SetAttr("channel_wise", false);
+    auto role_attr = OpProtoAndCheckerMaker::OpRoleAttrName();
+    if (quant_desc->HasAttr(role_attr)) {
+      desc.SetAttr(role_attr, quant_desc->GetAttr(role_attr));
+    }
+    auto* fused_op = graph->CreateOpNode(&desc);
+
+    IR_NODE_LINK_TO(x, fused_op);
+    IR_NODE_LINK_TO(fused_op, out);
+    IR_NODE_LINK_TO(fused_op, scale);
+    GraphSafeRemoveNodes(graph.get(), {pair.first, pair.second, quant_out});
+  }
+  VLOG(3) << "fuse_fake_quantize_dequantize_pass fuses " << pairs.size()
+          << " pairs";
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(fuse_fake_quantize_dequantize_pass,
+              paddle::framework::ir::FuseFakeQuantizeDequantizePass);
@@ -0,0 +1,61 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Fuse the fake_quantize_abs_max and fake_dequantize_max_abs pairs, which the
+ * quantization-aware training inserts before the quantized inputs of the
+ * conv2d and mul ops, into fake_quantize_dequantize_abs_max ops.
+ *
+ * Before fuse:
+ *      x
+ *      |
+ *  fake_quantize_abs_max
+ *      |       \
+ *  x.quantized  x.scale
+ *      |       /
+ *  fake_dequantize_max_abs
+ *      |
+ *  x.quantized.dequantized
+ *
+ * After fuse:
+ *      x
+ *      |
+ *  fake_quantize_dequantize_abs_max
+ *      |       \
+ *  x.quantized.dequantized  x.scale
+ *
+ * A pair is fused if the quantized tensor is used by the dequantize op only,
+ * the dequantize op uses the scale of the quantize op, and its max_range is
+ * the range of the bit_length of the quantize op, so that the fused op
+ * computes the same Out. The scale is kept for the ops after the pair.
+ */
+class FuseFakeQuantizeDequantizePass : public Pass {
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
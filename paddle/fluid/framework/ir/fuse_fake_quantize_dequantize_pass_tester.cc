@@ -0,0 +1,97 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/fuse_fake_quantize_dequantize_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/op_proto_maker.h"
+#include "paddle/fluid/framework/program_desc.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static void AppendQuantDequant(ProgramDesc* prog, const std::string& x,
+                               float max_range) {
+  auto* block = prog->MutableBlock(0);
+  for (auto& suffix : {"", ".quantized", ".scale", ".dequantized"}) {
+    block->Var(x + suffix)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  auto* quant = block->AppendOp();
+  quant->SetType("fake_quantize_abs_max");
+  quant->SetInput("X", {x});
+  quant->SetOutput("Out", {x + ".quantized"});
+  quant->SetOutput("OutScale", {x + ".scale"});
+  quant->SetAttr("bit_length", 8);
+  quant->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+                 static_cast<int>(OpRole::kForward));
+  auto* dequant = block->AppendOp();
+  dequant->SetType("fake_dequantize_max_abs");
+  dequant->SetInput("X", {x + ".quantized"});
+  dequant->SetInput("Scale", {x + ".scale"});
+  dequant->SetOutput("Out", {x + ".dequantized"});
+  dequant->SetAttr("max_range", max_range);
+}
+
+// The pairs of the input and the weight of a mul, where the dequantize op of
+// w has a max_range other than the range of 8 bits.
+static ProgramDesc BuildProgram() {
+  ProgramDesc prog;
+  AppendQuantDequant(&prog, "x", 127.f);
+  AppendQuantDequant(&prog, "w", 100.f);
+  auto* block = prog.MutableBlock(0);
+  block->Var("out")->SetType(proto::VarType::LOD_TENSOR);
+  auto* mul = block->AppendOp();
+  mul->SetType("mul");
+  mul->SetInput("X", {"x.dequantized"});
+  mul->SetInput("Y", {"w.dequantized"});
+  mul->SetOutput("Out", {"out"});
+  return prog;
+}
+
+TEST(FuseFakeQuantizeDequantizePass, basic) {
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(BuildProgram()));
+  auto pass =
+      PassRegistry::Instance().Get("fuse_fake_quantize_dequantize_pass");
+  int before = graph->Nodes().size();
+  graph = pass->Apply(std::move(graph));
+  // Remove the pair of x and x.quantized, and add the fused op.
+  EXPECT_EQ(static_cast<int>(graph->Nodes().size()), before - 2);
+
+  int num_fused = 0;
+  int num_quant = 0;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    auto type = node->Op()->Type();
+    if (type == "fake_quantize_abs_max") ++num_quant;
+    if (type != "fake_quantize_dequantize_abs_max") continue;
+    ++num_fused;
+    auto* op = node->Op();
+    EXPECT_EQ(op->Input("X"), std::vector<std::string>({"x"}));
+    EXPECT_EQ(op->Output("Out"), std::vector<std::string>({"x.dequantized"}));
+    EXPECT_EQ(op->Output("OutScale"), std::vector<std::string>({"x.scale"}));
+    EXPECT_EQ(boost::get<int>(op->GetAttr("bit_length")), 8);
+    ASSERT_EQ(node->inputs.size(), 1UL);
+    EXPECT_EQ(node->inputs[0]->Name(), "x");
+    EXPECT_EQ(node->outputs.size(), 2UL);
+  }
+  EXPECT_EQ(num_fused, 1);
+  EXPECT_EQ(num_quant, 1);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(fuse_fake_quantize_dequantize_pass);
@@ -0,0 +1,244 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/fuse_optimizer_ops_pass.h"
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+struct FusedOpInfo {
+  std::string fused_type;
+  std::vector<std::string> inputs;
+  std::vector<std::string> outputs;
+  std::vector<std::string> attrs;
+};
+
+const std::unordered_map<std::string, FusedOpInfo>& FusedOpInfos() {
+  static const std::unordered_map<std::string, FusedOpInfo> infos = {
+      {"adam",
+       {"fused_adam",
+        {"Param", "Grad", "LearningRate", "Moment1", "Moment2", "Beta1Pow",
+         "Beta2Pow"},
+        {"ParamOut", "Moment1Out", "Moment2Out"},
+        {"beta1", "beta2", "epsilon"}}},
+      {"momentum",
+       {"fused_momentum",
+        {"Param", "Grad", "Velocity", "LearningRate"},
+        {"ParamOut", "VelocityOut"},
+        {"mu", "use_nesterov"}}},
+  };
+  return infos;
+}
+
+// The optional single input shared by the fused ops, e.g., the SkipUpdate of
+// the mixed precision training.
+constexpr char kSharedInput[] = "SkipUpdate";
+
+std::vector<std::string> SharedInput(const OpDesc& desc) {
+  return desc.Inputs().count(kSharedInput) ? desc.Input(kSharedInput)
+                                           : std::vector<std::string>();
+}
+
+ir::Node* FindVarNode(const std::vector<ir::Node*>& nodes,
+                      const std::string& name) {
+  for (auto* node : nodes) {
+    if (node->IsVar() && node->Name() == name) return node;
+  }
+  return nullptr;
+}
+
+bool IsFusable(ir::Node* op) {
+  auto* desc = op->Op();
+  if (desc == nullptr || FusedOpInfos().count(desc->Type()) == 0) {
+    return false;
+  }
+  auto role_attr = OpProtoAndCheckerMaker::OpRoleAttrName();
+  if (!desc->HasAttr(role_attr) ||
+      boost::get<int>(desc->GetAttr(role_attr)) !=
+          static_cast<int>(OpRole::kOptimize)) {
+    return false;
+  }
+  for (auto& slot : FusedOpInfos().at(desc->Type()).inputs) {
+    if (desc->Input(slot).size() != 1) return false;
+  }
+
+  auto* grad = FindVarNode(op->inputs, desc->Input("Grad")[0]);
+  auto* param = FindVarNode(op->inputs, desc->Input("Param")[0]);
+  if (grad == nullptr || grad->Var() == nullptr || param == nullptr ||
+      param->Var() == nullptr) {
+    return false;
+  }
+  auto dtype = param->Var()->GetDataType();
+  return grad->Var()->GetType() == proto::VarType::LOD_TENSOR &&
+         (dtype == proto::VarType::FP32 || dtype == proto::VarType::FP64);
+}
+
+bool CanBeFusedWith(ir::Node* op, ir::Node* other) {
+  auto* desc = op->Op();
+  auto* other_desc = other->Op();
+  if (desc->Type() != other_desc->Type() ||
+      SharedInput(*desc) != SharedInput(*other_desc)) {
+    return false;
+  }
+  for (auto& attr : FusedOpInfos().at(desc->Type()).attrs) {
+    if (!(desc->GetAttr(attr) == other_desc->GetAttr(attr))) return false;
+  }
+  auto dtype = [](ir::Node* op) {
+    return FindVarNode(op->inputs, op->Op()->Input("Param")[0])
+        ->Var()
+        ->GetDataType();
+  };
+  return dtype(op) == dtype(other);
+}
+
+}  // namespace
+
+void FuseOptimizerOpsPass::FuseOps(ir::Graph* graph,
+                                   const std::vector<ir::Node*>& ops) const {
+  auto& info = FusedOpInfos().at(ops[0]->Op()->Type());
+
+  OpDesc desc;
+  desc.SetType(info.fused_type);
+  for (auto* slots : {&info.inputs, &info.outputs}) {
+    for (auto& slot : *slots) {
+      std::vector<std::string> names;
+      for (auto* op : ops) {
+        auto& args = slots == &info.inputs ? op->Op()->Input(slot)
+                                           : op->Op()->Output(slot);
+        names.insert(names.end(), args.begin(), args.end());
+      }
+      if (slots == &info.inputs) {
+        desc.SetInput(slot, names);
+      } else {
+        desc.SetOutput(slot, names);
+      }
+    }
+  }
+  auto shared_input = SharedInput(*ops[0]->Op());
+  if (!shared_input.empty()) desc.SetInput(kSharedInput, shared_input);
+  for (auto& attr : info.attrs) {
+    desc.SetAttr(attr, ops[0]->Op()->GetAttr(attr));
+  }
+  auto role_var_attr = OpProtoAndCheckerMaker::OpRoleVarAttrName();
+  std::vector<std::string> role_vars;
+  for (auto* op : ops) {
+    auto op_role_vars = boost::get<std::vector<std::string>>(
+        op->Op()->GetNullableAttr(role_var_attr));
+    role_vars.insert(role_vars.end(), op_role_vars.begin(),
+                     op_role_vars.end());
+  }
+  desc.SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+               static_cast<int>(OpRole::kOptimize));
+  desc.SetAttr(role_var_attr, role_vars);
+  desc.Flush();
+
+  auto* fused_op = graph->CreateOpNode(&desc);
+  std::unordered_set<ir::Node*> fused(ops.begin(), ops.end());
+  auto relink = [&](std::vector<ir::Node*>* op_nodes) {
+    op_nodes->erase(std::remove_if(op_nodes->begin(), op_nodes->end(),
+                                   [&](ir::Node* n) { return fused.count(n); }),
+                    op_nodes->end());
+    op_nodes->emplace_back(fused_op);
+  };
+  for (auto* op : ops) {
+    for (auto* in : op->inputs) {
+      if (std::find(fused_op->inputs.begin(), fused_op->inputs.end(), in) !=
+          fused_op->inputs.end()) {
+        continue;
+      }
+      fused_op->inputs.emplace_back(in);
+      relink(&in->outputs);
+    }
+    for (auto* out : op->outputs) {
+      fused_op->outputs.emplace_back(out);
+      relink(&out->inputs);
+    }
+  }
+  for (auto* op : ops) {
+    graph->RemoveNode(op);
+  }
+}
+
+std::unique_ptr<ir::Graph> FuseOptimizerOpsPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  // The ops of one kind, i.e., of the same type, data type and attributes,
+  // are fused in one round, on the graph in which the ops of the former
+  // rounds are fused, so that the fused ops of different kinds do not make
+  // cycles either. The ops left alone are skipped in the later rounds.
+  std::unordered_set<ir::Node*> skipped;
+  int fused_num = 0;
+  while (true) {
+    auto sorted_ops = TopologySortOperations(*graph);
+    ir::Node* kind = nullptr;
+    std::unordered_set<ir::Node*> kind_ops;
+    for (auto* op : sorted_ops) {
+      if (skipped.count(op) || !IsFusable(op)) continue;
+      if (kind == nullptr) kind = op;
+      if (CanBeFusedWith(op, kind)) kind_ops.insert(op);
+    }
+    if (kind == nullptr) break;
+
+    // An op is grouped by the most ops of the kind on a path to it, so there
+    // is no path between the ops of a group, and the paths between the
+    // groups go from the lower groups to the higher ones.
+    std::unordered_map<ir::Node*, size_t> levels;
+    std::vector<std::vector<ir::Node*>> groups;
+    for (auto* op : sorted_ops) {
+      size_t level = 0;
+      for (auto* in : op->inputs) {
+        for (auto* prev_op : in->inputs) {
+          level = std::max(level,
+                           levels.at(prev_op) + kind_ops.count(prev_op));
+        }
+      }
+      levels.emplace(op, level);
+      if (kind_ops.count(op) == 0) continue;
+      if (groups.size() <= level) groups.resize(level + 1);
+      groups[level].emplace_back(op);
+    }
+
+    for (auto& ops : groups) {
+      // Keep the order of the ops in the program.
+      std::sort(ops.begin(), ops.end(), [](ir::Node* a, ir::Node* b) {
+        return a->id() < b->id();
+      });
+      if (ops.size() < 2) {
+        skipped.insert(ops.begin(), ops.end());
+        continue;
+      }
+      VLOG(3) << "fuse " << ops.size() << " " << ops[0]->Op()->Type()
+              << " ops";
+      FuseOps(graph.get(), ops);
+      ++fused_num;
+    }
+  }
+  VLOG(3) << "fuse_optimizer_ops_pass creates " << fused_num << " fused ops";
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(fuse_optimizer_ops_pass,
+              paddle::framework::ir::FuseOptimizerOpsPass);
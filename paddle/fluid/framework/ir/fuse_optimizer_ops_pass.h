@@ -0,0 +1,50 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Fuse the optimizer ops with dense gradients, e.g., adam and momentum, into
+ * fused_adam and fused_momentum ops, which update all their parameters in a
+ * few kernel launches instead of one per parameter.
+ *
+ * The ops are fused if they are of the same type, data type and attributes,
+ * and no one of them depends on another, so that the fusion never makes a
+ * cycle.
+ *
+ * The pass should be applied to the graph before multi_devices_pass, and
+ * only in the AllReduce mode, since the Reduce mode places each optimizer op
+ * on the device of its parameter.
+ */
+class FuseOptimizerOpsPass : public Pass {
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+
+ private:
+  void FuseOps(ir::Graph* graph, const std::vector<ir::Node*>& ops) const;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
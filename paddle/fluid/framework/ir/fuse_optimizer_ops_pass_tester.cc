@@ -0,0 +1,175 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/fuse_optimizer_ops_pass.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+#include "paddle/fluid/framework/program_desc.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static void SetVar(ProgramDesc* prog, const std::string& name,
+                   proto::VarType::Type type = proto::VarType::LOD_TENSOR) {
+  auto* var = prog->MutableBlock(0)->Var(name);
+  var->SetType(type);
+  var->SetDataType(proto::VarType::FP32);
+}
+
+static void SetMomentum(ProgramDesc* prog, const std::string& param,
+                        const std::string& grad, float mu = 0.9f) {
+  for (auto& name : {param, grad, param + "_velocity"}) SetVar(prog, name);
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType("momentum");
+  op->SetInput("Param", {param});
+  op->SetInput("Grad", {grad});
+  op->SetInput("Velocity", {param + "_velocity"});
+  op->SetInput("LearningRate", {"lr"});
+  op->SetOutput("ParamOut", {param});
+  op->SetOutput("VelocityOut", {param + "_velocity"});
+  op->SetAttr("mu", mu);
+  op->SetAttr("use_nesterov", false);
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(OpRole::kOptimize));
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName(),
+              std::vector<std::string>({param, grad}));
+}
+
+static void SetAdam(ProgramDesc* prog, const std::string& param,
+                    const std::string& grad) {
+  std::vector<std::string> states = {"Moment1", "Moment2", "Beta1Pow",
+                                     "Beta2Pow"};
+  SetVar(prog, param);
+  SetVar(prog, grad);
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType("adam");
+  op->SetInput("Param", {param});
+  op->SetInput("Grad", {grad});
+  op->SetInput("LearningRate", {"lr"});
+  for (auto& state : states) {
+    SetVar(prog, param + "_" + state);
+    op->SetInput(state, {param + "_" + state});
+  }
+  op->SetOutput("ParamOut", {param});
+  op->SetOutput("Moment1Out", {param + "_Moment1"});
+  op->SetOutput("Moment2Out", {param + "_Moment2"});
+  op->SetAttr("beta1", 0.9f);
+  op->SetAttr("beta2", 0.999f);
+  op->SetAttr("epsilon", 1e-8f);
+  op->SetAttr("lazy_mode", false);
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(OpRole::kOptimize));
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName(),
+              std::vector<std::string>({param, grad}));
+}
+
+static std::vector<ir::Node*> FindOps(const ir::Graph& graph,
+                                      const std::string& type) {
+  std::vector<ir::Node*> ops;
+  for (auto* node : graph.Nodes()) {
+    if (node->IsOp() && node->Op()->Type() == type) ops.emplace_back(node);
+  }
+  return ops;
+}
+
+TEST(FuseOptimizerOpsPass, fuse) {
+  ProgramDesc prog;
+  SetVar(&prog, "lr");
+  SetMomentum(&prog, "a", "a@GRAD");
+  SetAdam(&prog, "b", "b@GRAD");
+  SetMomentum(&prog, "c", "c@GRAD");
+  SetAdam(&prog, "d", "d@GRAD");
+  SetMomentum(&prog, "e", "e@GRAD");
+  // Not fused, for the different attribute and the sparse gradient.
+  SetMomentum(&prog, "f", "f@GRAD", 0.8f);
+  SetMomentum(&prog, "g", "g@GRAD");
+  prog.MutableBlock(0)->Var("g@GRAD")->SetType(proto::VarType::SELECTED_ROWS);
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  auto pass = PassRegistry::Instance().Get("fuse_optimizer_ops_pass");
+  graph = pass->Apply(std::move(graph));
+
+  EXPECT_EQ(FindOps(*graph, "momentum").size(), 2UL);
+  EXPECT_EQ(FindOps(*graph, "adam").size(), 0UL);
+
+  auto fused_momentum = FindOps(*graph, "fused_momentum");
+  ASSERT_EQ(fused_momentum.size(), 1UL);
+  auto* desc = fused_momentum[0]->Op();
+  EXPECT_EQ(desc->Input("Param"), std::vector<std::string>({"a", "c", "e"}));
+  EXPECT_EQ(desc->Input("LearningRate"),
+            std::vector<std::string>({"lr", "lr", "lr"}));
+  EXPECT_EQ(desc->Output("VelocityOut"),
+            std::vector<std::string>(
+                {"a_velocity", "c_velocity", "e_velocity"}));
+  EXPECT_EQ(boost::get<float>(desc->GetAttr("mu")), 0.9f);
+  EXPECT_EQ(boost::get<std::vector<std::string>>(desc->GetAttr(
+                OpProtoAndCheckerMaker::OpRoleVarAttrName())),
+            std::vector<std::string>(
+                {"a", "a@GRAD", "c", "c@GRAD", "e", "e@GRAD"}));
+  // The shared learning rate is one input node of the fused op.
+  EXPECT_EQ(fused_momentum[0]->inputs.size(), 10UL);
+  EXPECT_EQ(fused_momentum[0]->outputs.size(), 6UL);
+
+  auto fused_adam = FindOps(*graph, "fused_adam");
+  ASSERT_EQ(fused_adam.size(), 1UL);
+  EXPECT_EQ(fused_adam[0]->Op()->Input("Beta1Pow"),
+            std::vector<std::string>({"b_Beta1Pow", "d_Beta1Pow"}));
+  EXPECT_FALSE(fused_adam[0]->Op()->HasAttr("lazy_mode"));
+  EXPECT_FALSE(HasCircle(*graph));
+}
+
+TEST(FuseOptimizerOpsPass, dependency) {
+  ProgramDesc prog;
+  SetVar(&prog, "lr");
+  SetMomentum(&prog, "a", "a@GRAD");
+  SetMomentum(&prog, "b", "b@GRAD");
+  // The gradients of c and d are computed from the updated a and b, so the
+  // momentum ops of c and d can not be fused with the ones of a and b.
+  for (auto& pair : {std::make_pair("a", "c@GRAD"),
+                     std::make_pair("b", "d@GRAD")}) {
+    auto* op = prog.MutableBlock(0)->AppendOp();
+    op->SetType("scale");
+    op->SetInput("X", {pair.first});
+    op->SetOutput("Out", {pair.second});
+    op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+                static_cast<int>(OpRole::kBackward));
+  }
+  SetMomentum(&prog, "c", "c@GRAD");
+  SetMomentum(&prog, "d", "d@GRAD");
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  auto pass = PassRegistry::Instance().Get("fuse_optimizer_ops_pass");
+  graph = pass->Apply(std::move(graph));
+
+  EXPECT_EQ(FindOps(*graph, "momentum").size(), 0UL);
+  auto fused_momentum = FindOps(*graph, "fused_momentum");
+  ASSERT_EQ(fused_momentum.size(), 2UL);
+  for (auto* op : fused_momentum) {
+    auto params = op->Op()->Input("Param");
+    std::sort(params.begin(), params.end());
+    EXPECT_TRUE(params == std::vector<std::string>({"a", "b"}) ||
+                params == std::vector<std::string>({"c", "d"}));
+  }
+  EXPECT_FALSE(HasCircle(*graph));
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(fuse_optimizer_ops_pass);
@@ -20,6 +20,7 @@ limitations under the License. */
 #include <ostream>
 #include <unordered_map>
 #include <unordered_set>
+#include "paddle/fluid/framework/data_type.h"
 
 DEFINE_string(print_sub_graph_dir, "",
               "FLAGS_print_sub_graph_dir is used "
@@ -203,6 +204,54 @@ size_t GraphNum(const Graph &graph) {
   return graph_count;
 }
 
+namespace {
+// Collect the dims of the var nodes of the slots, in which the unknown dims,
+// e.g. the batch size, are taken as 1, so that the cost is per sample.
+void CollectCompileTimeDims(
+    const VariableNameMap &var_names, const std::vector<Node *> &var_nodes,
+    std::unordered_map<std::string, std::vector<DDim>> *dims,
+    std::unordered_map<std::string, size_t> *element_sizes) {
+  std::unordered_map<std::string, VarDesc *> var_descs;
+  for (auto *n : var_nodes) {
+    if (n->IsVar() && n->Var() != nullptr &&
+        n->Var()->GetType() == proto::VarType::LOD_TENSOR) {
+      var_descs[n->Name()] = n->Var();
+    }
+  }
+  for (auto &item : var_names) {
+    std::vector<DDim> slot_dims;
+    size_t element_size = 0;
+    for (auto &name : item.second) {
+      auto it = var_descs.find(name);
+      if (it == var_descs.end()) break;
+      auto shape = it->second->GetShape();
+      for (auto &d : shape) d = d < 0 ? 1 : d;
+      slot_dims.emplace_back(make_ddim(shape));
+      element_size = SizeOfType(it->second->GetDataType());
+    }
+    if (!item.second.empty() && slot_dims.size() == item.second.size()) {
+      dims->emplace(item.first, std::move(slot_dims));
+      if (element_sizes != nullptr) {
+        element_sizes->emplace(item.first, element_size);
+      }
+    }
+  }
+}
+}  // namespace
+
+bool GetOpCost(const Node &op_node, OpCost *cost) {
+  PADDLE_ENFORCE(op_node.IsOp() && op_node.Op() != nullptr);
+  auto *op = op_node.Op();
+  auto &registry = OpCostRegistry::Instance();
+  if (!registry.Has(op->Type())) return false;
+  OpCostContext ctx(op->GetAttrMap());
+  CollectCompileTimeDims(op->Inputs(), op_node.inputs, &ctx.input_dims,
+                         &ctx.input_element_sizes);
+  CollectCompileTimeDims(op->Outputs(), op_node.outputs, &ctx.output_dims,
+                         nullptr);
+  return registry.GetCost(op->Type(), ctx, cost);
+}
+
 }  // namespace ir
 }  // namespace framework
 }  // namespace paddle
@@ -20,6 +20,7 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/ir/graph.h"
 #include "paddle/fluid/framework/ir/node.h"
+#include "paddle/fluid/framework/op_cost.h"
 
 namespace paddle {
 namespace framework {
@@ -38,6 +39,10 @@ std::vector<ir::Node *> TopologySortOperations(const Graph &graph);
 std::map<ir::Node *, std::unordered_set<ir::Node *>> BuildOperationAdjList(
     const Graph &graph);
 
+// Get the cost of the op node by the registered cost model and the shapes of
+// its var nodes, return false if the cost is not available.
+bool GetOpCost(const Node &op_node, OpCost *cost);
+
 template <typename T>
 std::vector<T *> FilterByNodeWrapper(const Graph &graph) {
   std::vector<T *> ret;
@@ -211,6 +211,39 @@ TEST(GraphHelperTest, GraphNum) {
   ASSERT_EQ(GraphNum(g3), 2UL);
 }
 
+TEST(GraphHelperTest, GetOpCost) {
+  ProgramDesc prog;
+  auto* block = prog.MutableBlock(0);
+  for (auto& name : {"x", "y", "out"}) {
+    auto* var = block->Var(name);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+  }
+  block->Var("x")->SetShape({-1, 16});
+  block->Var("y")->SetShape({16, 32});
+  block->Var("out")->SetShape({-1, 32});
+  auto* op = block->AppendOp();
+  op->SetType("mul");
+  op->SetInput("X", {"x"});
+  op->SetInput("Y", {"y"});
+  op->SetOutput("Out", {"out"});
+  op->SetAttr("x_num_col_dims", 1);
+  op->SetAttr("y_num_col_dims", 1);
+
+  Graph g(prog);
+  int num_mul = 0;
+  for (auto* n : g.Nodes()) {
+    if (!n->IsOp() || n->Op()->Type() != "mul") continue;
+    ++num_mul;
+    OpCost cost;
+    ASSERT_TRUE(GetOpCost(*n, &cost));
+    // The unknown batch size is taken as 1.
+    EXPECT_DOUBLE_EQ(cost.flops, 2 * 16 * 32);
+    EXPECT_DOUBLE_EQ(cost.bytes, (16 + 16 * 32 + 32) * sizeof(float));
+  }
+  EXPECT_EQ(num_mul, 1);
+}
+
 }  // namespace ir
 }  // namespace framework
 }  // namespace paddle
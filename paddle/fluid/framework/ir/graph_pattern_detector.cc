@@ -102,11 +102,43 @@ bool GraphPatternDetector::MarkPDNodesInGraph(const ir::Graph &graph) {
   VLOG(3) << "mark pdnodes in graph";
   if (graph.Nodes().empty()) return false;
 
-  for (auto &node : GraphTraits::DFS(graph)) {
-    for (const auto &pdnode : pattern_.nodes()) {
-      if (pdnode->Tell(&node)) {
-        VLOG(4) << "Node " << node.Name() << " marked as " << pdnode->name();
-        pdnodes2nodes_[pdnode.get()].insert(&node);
+  // Index the ops by their types, so that a PDNode hinted by op types only
+  // tells the ops of the types or their inputs or outputs, instead of all the
+  // nodes of the graph. The index is built by each detection, so it follows
+  // the passes changing the graph.
+  std::unordered_map<std::string, std::vector<Node *>> ops_of_type;
+  for (auto *node : graph.Nodes()) {
+    if (node->IsOp() && node->Op()) {
+      ops_of_type[node->Op()->Type()].push_back(node);
+    }
+  }
+
+  for (const auto &pdnode : pattern_.nodes()) {
+    auto mark = [&](Node *node) {
+      if (pdnode->Tell(node)) {
+        VLOG(4) << "Node " << node->Name() << " marked as " << pdnode->name();
+        pdnodes2nodes_[pdnode.get()].insert(node);
+      }
+    };
+    if (pdnode->teller_ || pdnode->hint_ == PDNode::Hint::kNone) {
+      for (auto *node : graph.Nodes()) {
+        mark(node);
+      }
+      continue;
+    }
+    for (auto &type : pdnode->hint_op_types_) {
+      auto it = ops_of_type.find(type);
+      if (it == ops_of_type.end()) continue;
+      for (auto *op : it->second) {
+        if (pdnode->hint_ == PDNode::Hint::kOp) {
+          mark(op);
+        } else {
+          auto &vars = pdnode->hint_ == PDNode::Hint::kOpInput ? op->inputs
+                                                                : op->outputs;
+          for (auto *var : vars) {
+            mark(var);
+          }
+        }
       }
     }
   }
@@ -225,20 +257,46 @@ GraphPatternDetector::DetectPatterns() {
     cur_groups.clear();
     if (pre_groups.empty()) break;
     // source -> target
-    for (Node *source : pdnodes2nodes_[edge.first]) {
-      for (Node *target : pdnodes2nodes_[edge.second]) {
+    auto &sources = pdnodes2nodes_[edge.first];
+    auto &targets = pdnodes2nodes_[edge.second];
+    for (const auto &group : pre_groups) {
+      auto extend = [&](Node *source, Node *target) {
         VLOG(8) << "check " << source->id() << " -- " << target->id();
-        // TODO(Superjomn) add some prune strategies.
-        for (const auto &group : pre_groups) {
-          if (IsNodesLink(source, target)) {
-            HitGroup new_group = group;
-            bool flag = new_group.Match(source, edge.first) &&
-                        new_group.Match(target, edge.second);
-            if (flag) {
-              new_group.Register(source, edge.first);
-              new_group.Register(target, edge.second);
-              cur_groups.push_back(new_group);
-              // TODO(Superjomn) need to unique
+        HitGroup new_group = group;
+        bool flag = new_group.Match(source, edge.first) &&
+                    new_group.Match(target, edge.second);
+        if (flag) {
+          new_group.Register(source, edge.first);
+          new_group.Register(target, edge.second);
+          cur_groups.push_back(new_group);
+          // TODO(Superjomn) need to unique
+        }
+      };
+      // Only the links of the nodes already matched by the group can extend
+      // it, so the candidates are the neighbors of the nodes.
+      auto source_it = group.roles.find(edge.first);
+      auto target_it = group.roles.find(edge.second);
+      if (source_it != group.roles.end()) {
+        auto &outputs = source_it->second->outputs;
+        for (auto it = outputs.begin(); it != outputs.end(); ++it) {
+          if (targets.count(*it) && std::find(outputs.begin(), it, *it) == it) {
+            extend(source_it->second, *it);
+          }
+        }
+      } else if (target_it != group.roles.end()) {
+        auto &inputs = target_it->second->inputs;
+        for (auto it = inputs.begin(); it != inputs.end(); ++it) {
+          if (sources.count(*it) && std::find(inputs.begin(), it, *it) == it) {
+            extend(*it, target_it->second);
+          }
+        }
+      } else {
+        for (Node *source : sources) {
+          auto &outputs = source->outputs;
+          for (auto it = outputs.begin(); it != outputs.end(); ++it) {
+            if (targets.count(*it) &&
+                std::find(outputs.begin(), it, *it) == it) {
+              extend(source, *it);
             }
           }
         }
@@ -369,6 +427,7 @@ PDNode *PDNode::assert_is_op() {
 }
 
 PDNode *PDNode::assert_is_op(const std::string &op_type) {
+  HintOpTypes(Hint::kOp, {op_type});
   asserts_.emplace_back([op_type](Node *x) {
     return x && x->IsOp() && x->Op()->Type() == op_type;
   });
@@ -415,6 +474,7 @@ PDNode *PDNode::assert_is_op_nth_input(const std::string &op_type,
 PDNode *PDNode::assert_is_op_nth_output(const std::string &op_type,
                                         const std::string &argument, int nth) {
   assert_is_var();
+  HintOpTypes(Hint::kOpOutput, {op_type});
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
       if (op->IsOp() && op->Op()->Type() == op_type &&
@@ -428,6 +488,7 @@ PDNode *PDNode::assert_is_op_nth_output(const std::string &op_type,
 
 PDNode *PDNode::assert_is_only_input_of_op(const std::string &op_type) {
   assert_is_var();
+  HintOpTypes(Hint::kOpInput, {op_type});
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->outputs) {
       if (op && op->IsOp() && op->Op() && op->Op()->Type() == op_type &&
@@ -442,6 +503,7 @@ PDNode *PDNode::assert_is_only_input_of_op(const std::string &op_type) {
 
 PDNode *PDNode::assert_is_only_output_of_op(const std::string &op_type) {
   assert_is_var();
+  HintOpTypes(Hint::kOpOutput, {op_type});
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
       if (op && op->IsOp() && op->Op() && op->Op()->Type() == op_type &&
@@ -454,8 +516,24 @@ PDNode *PDNode::assert_is_only_output_of_op(const std::string &op_type) {
   return this;
 }
 
+PDNode *PDNode::assert_is_only_output_of_ops(
+    const std::unordered_set<std::string> &op_types) {
+  assert_is_var();
+  asserts_.emplace_back([=](Node *x) {
+    for (auto *op : x->inputs) {
+      if (op && op->IsOp() && op->Op() && op_types.count(op->Op()->Type()) &&
+          op->outputs.size() == 1) {
+        return true;
+      }
+    }
+    return false;
+  });
+  return this;
+}
+
 PDNode *PDNode::assert_is_op_output(const std::string &op_type) {
   assert_is_var();
+  HintOpTypes(Hint::kOpOutput, {op_type});
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
       if (op && op->IsOp() && op->Op() && op->Op()->Type() == op_type) {
@@ -475,6 +553,7 @@ PDNode *PDNode::assert_is_op_output(const std::string &op_type,
 }
 PDNode *PDNode::assert_is_op_input(const std::string &op_type) {
   assert_is_var();
+  HintOpTypes(Hint::kOpInput, {op_type});
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->outputs) {
       if (op && op->IsOp() && op->Op() && op->Op()->Type() == op_type) {
@@ -511,6 +590,7 @@ PDNode *PDNode::assert_more(PDNode::teller_t &&teller) {
 }
 
 PDNode *PDNode::assert_is_ops(const std::unordered_set<std::string> &op_types) {
+  HintOpTypes(Hint::kOp, op_types);
   asserts_.emplace_back([op_types](Node *x) {
     return x && x->IsOp() && op_types.count(x->Op()->Type());
   });
@@ -537,6 +617,7 @@ PDNode *PDNode::assert_is_ops_nth_output(
     const std::unordered_set<std::string> &op_types,
     const std::string &argument, int nth) {
   assert_is_var();
+  HintOpTypes(Hint::kOpOutput, op_types);
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
       if (op->IsOp() && op_types.count(op->Op()->Type()) &&
@@ -550,6 +631,7 @@ PDNode *PDNode::assert_is_ops_nth_output(
 PDNode *PDNode::assert_is_ops_output(
     const std::unordered_set<std::string> &op_types) {
   assert_is_var();
+  HintOpTypes(Hint::kOpOutput, op_types);
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
       if (op && op->IsOp() && op->Op() && op_types.count(op->Op()->Type())) {
@@ -572,6 +654,7 @@ PDNode *PDNode::assert_is_ops_output(
 PDNode *PDNode::assert_is_ops_input(
     const std::unordered_set<std::string> &op_types) {
   assert_is_var();
+  HintOpTypes(Hint::kOpInput, op_types);
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->outputs) {
       if (op && op->IsOp() && op->Op() && op_types.count(op->Op()->Type())) {
@@ -647,11 +730,14 @@ bool VarLinksFromOp(Node *node, const std::string &op_type) {
   return false;
 }
 
+// The conv ops folded with batch_norm, and fused into conv2d_fusion.
+std::unordered_set<std::string> fused_conv_set({"conv2d", "depthwise_conv2d"});
+
 PDNode *patterns::ConvBN::operator()(paddle::framework::ir::PDNode *conv_input,
                                      bool with_eltwise_add) {
   // Create Operators
-  conv_input->assert_is_op_input("conv2d", "Input");
-  auto *conv_op = pattern->NewNode(conv_repr())->assert_is_op("conv2d");
+  conv_input->assert_is_ops_input(fused_conv_set, "Input");
+  auto *conv_op = pattern->NewNode(conv_repr())->assert_is_ops(fused_conv_set);
 
   PDNode *eltwise_op = nullptr;
   if (with_eltwise_add) {
@@ -665,11 +751,11 @@ PDNode *patterns::ConvBN::operator()(paddle::framework::ir::PDNode *conv_input,
   auto *conv_weight_var = pattern->NewNode(conv_weight_repr())
                               ->AsInput()
                               ->assert_is_persistable_var()
-                              ->assert_is_op_input("conv2d", "Filter");
+                              ->assert_is_ops_input(fused_conv_set, "Filter");
 
   auto *conv_out_var = pattern->NewNode(conv_out_repr())
                            ->AsIntermediate()
-                           ->assert_is_only_output_of_op("conv2d");
+                           ->assert_is_only_output_of_ops(fused_conv_set);
 
   PDNode *eltwise_y_in_var = nullptr;
   PDNode *eltwise_out_var = nullptr;
@@ -1101,17 +1187,28 @@ PDNode *patterns::ElementwiseAdd::operator()(PDNode *x_var, PDNode *y_var) {
   return out_var;
 }
 
-std::unordered_set<std::string> conv_act_set({"identity", "relu"});
+std::unordered_set<std::string> conv_act_set(
+    {"identity", "relu", "relu6", "leaky_relu", "sigmoid", "tanh"});
+
+float patterns::ConvActivationAlpha(const OpDesc &act_op) {
+  if (act_op.Type() == "leaky_relu") {
+    return boost::get<float>(act_op.GetAttr("alpha"));
+  } else if (act_op.Type() == "relu6") {
+    return boost::get<float>(act_op.GetAttr("threshold"));
+  }
+  return 0.f;
+}
 
 PDNode *patterns::ConvElementwiseaddAct::operator()(PDNode *conv_in) {
   conv_in->AsInput();
-  auto conv_op = pattern->NewNode(conv_op_repr())->assert_is_op("conv2d");
+  auto conv_op =
+      pattern->NewNode(conv_op_repr())->assert_is_ops(fused_conv_set);
   auto conv_out = pattern->NewNode(conv_out_repr())
-                      ->assert_is_op_output("conv2d")
+                      ->assert_is_ops_output(fused_conv_set)
                       ->assert_is_op_input("elementwise_add", "X")
                       ->AsIntermediate();
   auto conv_filter = pattern->NewNode(conv_filter_repr())
-                         ->assert_is_op_input("conv2d", "Filter")
+                         ->assert_is_ops_input(fused_conv_set, "Filter")
                          ->AsInput();
   auto elementwise_add_op = pattern->NewNode(elementwise_add_op_repr())
                                 ->assert_is_op("elementwise_add");
@@ -1152,12 +1249,13 @@ PDNode *patterns::ConvElementwiseaddAct::operator()(PDNode *conv_in) {
 }
 
 PDNode *patterns::ConvElementwiseadd2Act::operator()(PDNode *conv_in) {
-  auto conv_op = pattern->NewNode(conv_op_repr())->assert_is_op("conv2d");
+  auto conv_op =
+      pattern->NewNode(conv_op_repr())->assert_is_ops(fused_conv_set);
   auto conv_filter = pattern->NewNode(conv_filter_repr())
-                         ->assert_is_op_input("conv2d", "Filter")
+                         ->assert_is_ops_input(fused_conv_set, "Filter")
                          ->AsInput();
   auto conv_out = pattern->NewNode(conv_out_repr())
-                      ->assert_is_op_output("conv2d")
+                      ->assert_is_ops_output(fused_conv_set)
                       ->assert_is_op_input("elementwise_add", "X")
                       ->AsIntermediate();
   auto elementwise_add_op = pattern->NewNode(elementwise_add_op_repr())
@@ -1209,13 +1307,14 @@ PDNode *patterns::ConvElementwiseadd2Act::operator()(PDNode *conv_in) {
 
 PDNode *patterns::ConvElementwiseadd::operator()(PDNode *conv_in) {
   conv_in->AsInput();
-  auto conv_op = pattern->NewNode(conv_op_repr())->assert_is_op("conv2d");
+  auto conv_op =
+      pattern->NewNode(conv_op_repr())->assert_is_ops(fused_conv_set);
   auto conv_out = pattern->NewNode(conv_out_repr())
-                      ->assert_is_op_output("conv2d")
+                      ->assert_is_ops_output(fused_conv_set)
                       ->assert_is_op_input("elementwise_add", "X")
                       ->AsIntermediate();
   auto conv_filter = pattern->NewNode(conv_filter_repr())
-                         ->assert_is_op_input("conv2d", "Filter")
+                         ->assert_is_ops_input(fused_conv_set, "Filter")
                          ->AsInput();
   auto elementwise_add_op = pattern->NewNode(elementwise_add_op_repr())
                                 ->assert_is_op("elementwise_add");
@@ -1369,6 +1468,156 @@ PDNode *patterns::TransposeFlattenConcat::operator()(
   return concat_out;
 }
 
+PDNode *patterns::MultiHeadAttention::operator()(PDNode *q, PDNode *k,
+                                                 PDNode *v, bool with_scale,
+                                                 bool with_bias_qk,
+                                                 bool with_dropout) {
+  // Split the q, k and v into heads.
+  auto split_heads = [&](PDNode *x, PDNode *reshape, PDNode *reshape_out,
+                         PDNode *transpose, PDNode *transpose_out) {
+    x->AsInput()->assert_is_op_input("reshape2", "X");
+    reshape->assert_is_op("reshape2");
+    reshape_out->AsIntermediate()
+        ->assert_is_op_output("reshape2", "Out")
+        ->assert_is_op_input("transpose2", "X");
+    transpose->assert_is_op("transpose2");
+    transpose_out->AsIntermediate()->assert_is_op_output("transpose2", "Out");
+    reshape->LinksFrom({x}).LinksTo({reshape_out});
+    transpose->LinksFrom({reshape_out}).LinksTo({transpose_out});
+  };
+
+  auto *reshape_q = pattern->NewNode(reshape_q_repr());
+  auto *reshape_q_out = pattern->NewNode(reshape_q_out_repr());
+  auto *transpose_q = pattern->NewNode(transpose_q_repr());
+  auto *transpose_q_out = pattern->NewNode(transpose_q_out_repr());
+  split_heads(q, reshape_q, reshape_q_out, transpose_q, transpose_q_out);
+
+  auto *reshape_k = pattern->NewNode(reshape_k_repr());
+  auto *reshape_k_out = pattern->NewNode(reshape_k_out_repr());
+  auto *transpose_k = pattern->NewNode(transpose_k_repr());
+  auto *transpose_k_out = pattern->NewNode(transpose_k_out_repr());
+  split_heads(k, reshape_k, reshape_k_out, transpose_k, transpose_k_out);
+  transpose_k_out->assert_is_op_input("matmul", "Y");
+
+  auto *reshape_v = pattern->NewNode(reshape_v_repr());
+  auto *reshape_v_out = pattern->NewNode(reshape_v_out_repr());
+  auto *transpose_v = pattern->NewNode(transpose_v_repr());
+  auto *transpose_v_out = pattern->NewNode(transpose_v_out_repr());
+  split_heads(v, reshape_v, reshape_v_out, transpose_v, transpose_v_out);
+  transpose_v_out->assert_is_op_input("matmul", "Y");
+
+  PDNode *matmul_qk_x = transpose_q_out;
+  if (with_scale) {
+    transpose_q_out->assert_is_op_input("scale", "X");
+    auto *scale_q = pattern->NewNode(scale_q_repr())->assert_is_op("scale");
+    auto *scale_q_out = pattern->NewNode(scale_q_out_repr())
+                            ->AsIntermediate()
+                            ->assert_is_only_output_of_op("scale");
+    scale_q->LinksFrom({transpose_q_out}).LinksTo({scale_q_out});
+    matmul_qk_x = scale_q_out;
+  }
+  matmul_qk_x->assert_is_op_input("matmul", "X");
+
+  auto *matmul_qk = pattern->NewNode(matmul_qk_repr())->assert_is_op("matmul");
+  auto *matmul_qk_out = pattern->NewNode(matmul_qk_out_repr())
+                            ->AsIntermediate()
+                            ->assert_is_only_output_of_op("matmul");
+  matmul_qk->LinksFrom({matmul_qk_x, transpose_k_out}).LinksTo({matmul_qk_out});
+
+  PDNode *softmax_qk_x = matmul_qk_out;
+  if (with_bias_qk) {
+    matmul_qk_out->assert_is_op_input("elementwise_add", "X");
+    auto *bias_qk = pattern->NewNode(bias_qk_repr())
+                        ->AsInput()
+                        ->assert_is_op_input("elementwise_add", "Y");
+    auto *eltadd_qk =
+        pattern->NewNode(eltadd_qk_repr())->assert_is_op("elementwise_add");
+    auto *eltadd_qk_out = pattern->NewNode(eltadd_qk_out_repr())
+                              ->AsIntermediate()
+                              ->assert_is_only_output_of_op("elementwise_add");
+    eltadd_qk->LinksFrom({matmul_qk_out, bias_qk}).LinksTo({eltadd_qk_out});
+    softmax_qk_x = eltadd_qk_out;
+  }
+  softmax_qk_x->assert_is_op_input("softmax", "X");
+
+  auto *softmax_qk =
+      pattern->NewNode(softmax_qk_repr())->assert_is_op("softmax");
+  auto *softmax_qk_out = pattern->NewNode(softmax_qk_out_repr())
+                             ->AsIntermediate()
+                             ->assert_is_only_output_of_op("softmax");
+  softmax_qk->LinksFrom({softmax_qk_x}).LinksTo({softmax_qk_out});
+
+  PDNode *matmul_qkv_x = softmax_qk_out;
+  if (with_dropout) {
+    softmax_qk_out->assert_is_op_input("dropout", "X");
+    auto *dropout_qk =
+        pattern->NewNode(dropout_qk_repr())->assert_is_op("dropout");
+    auto *dropout_qk_out = pattern->NewNode(dropout_qk_out_repr())
+                               ->AsIntermediate()
+                               ->assert_is_op_output("dropout", "Out");
+    dropout_qk->LinksFrom({softmax_qk_out}).LinksTo({dropout_qk_out});
+    matmul_qkv_x = dropout_qk_out;
+  }
+  matmul_qkv_x->assert_is_op_input("matmul", "X");
+
+  auto *matmul_qkv =
+      pattern->NewNode(matmul_qkv_repr())->assert_is_op("matmul");
+  auto *matmul_qkv_out = pattern->NewNode(matmul_qkv_out_repr())
+                             ->AsIntermediate()
+                             ->assert_is_only_output_of_op("matmul")
+                             ->assert_is_op_input("transpose2", "X");
+  matmul_qkv->LinksFrom({matmul_qkv_x, transpose_v_out})
+      .LinksTo({matmul_qkv_out});
+
+  // Combine the heads.
+  auto *transpose_qkv =
+      pattern->NewNode(transpose_qkv_repr())->assert_is_op("transpose2");
+  auto *transpose_qkv_out = pattern->NewNode(transpose_qkv_out_repr())
+                                ->AsIntermediate()
+                                ->assert_is_op_output("transpose2", "Out")
+                                ->assert_is_op_input("reshape2", "X");
+  transpose_qkv->LinksFrom({matmul_qkv_out}).LinksTo({transpose_qkv_out});
+
+  auto *reshape_qkv =
+      pattern->NewNode(reshape_qkv_repr())->assert_is_op("reshape2");
+  auto *reshape_qkv_out = pattern->NewNode(reshape_qkv_out_repr())
+                              ->AsOutput()
+                              ->assert_is_op_output("reshape2", "Out");
+  reshape_qkv->LinksFrom({transpose_qkv_out}).LinksTo({reshape_qkv_out});
+
+  return reshape_qkv_out;
+}
+
+PDNode *patterns::ElewiseAddLayerNorm::operator()(PDNode *x, PDNode *y) {
+  x->AsInput()->assert_is_op_input("elementwise_add", "X");
+  y->AsInput()->assert_is_op_input("elementwise_add", "Y");
+  auto *eltwise_add =
+      pattern->NewNode(eltwise_add_repr())->assert_is_op("elementwise_add");
+  // The sum may also be used by other ops, e.g., the next residual
+  // connection, so it is not an intermediate node.
+  auto *eltwise_add_out = pattern->NewNode(eltwise_add_out_repr())
+                              ->assert_is_only_output_of_op("elementwise_add")
+                              ->assert_is_op_input("layer_norm", "X");
+
+  auto *layer_norm =
+      pattern->NewNode(layer_norm_repr())->assert_is_op("layer_norm");
+  auto *layer_norm_out = pattern->NewNode(layer_norm_out_repr())
+                             ->AsOutput()
+                             ->assert_is_op_output("layer_norm", "Y");
+  auto *layer_norm_mean = pattern->NewNode(layer_norm_mean_repr())
+                              ->AsIntermediate()
+                              ->assert_is_op_output("layer_norm", "Mean");
+  auto *layer_norm_variance =
+      pattern->NewNode(layer_norm_variance_repr())
+          ->AsIntermediate()
+          ->assert_is_op_output("layer_norm", "Variance");
+
+  eltwise_add->LinksFrom({x, y}).LinksTo({eltwise_add_out});
+  layer_norm->LinksFrom({eltwise_add_out})
+      .LinksTo({layer_norm_out, layer_norm_mean, layer_norm_variance});
+  return layer_norm_out;
+}
+
 }  // namespace ir
 }  // namespace framework
 }  // namespace paddle
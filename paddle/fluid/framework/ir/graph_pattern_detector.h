@@ -20,6 +20,7 @@
 
 #include <numeric>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include "paddle/fluid/framework/ir/graph.h"
@@ -115,6 +116,8 @@ struct PDNode {
   PDNode* assert_more(teller_t&& teller);
 
   PDNode* assert_is_ops_output(const std::unordered_set<std::string>& op_types);
+  PDNode* assert_is_only_output_of_ops(
+      const std::unordered_set<std::string>& op_types);
   PDNode* assert_is_ops(const std::unordered_set<std::string>& op_types);
   PDNode* assert_is_ops_output(const std::unordered_set<std::string>& op_types,
                                const std::string& argument);
@@ -153,10 +156,27 @@ struct PDNode {
   PDNode(PDNode&& other) = default;
 
   friend class PDPattern;
+  friend class GraphPatternDetector;
+
+  // How the ops of hint_op_types_ nominate the candidates of this PDNode,
+  // which only pass the asserts if they are the ops, or the inputs or the
+  // outputs of the ops.
+  enum class Hint { kNone, kOp, kOpInput, kOpOutput };
+
+  // The first hint is kept, each one nominates all the nodes passing the
+  // asserts.
+  void HintOpTypes(Hint hint, const std::unordered_set<std::string>& types) {
+    if (hint_ == Hint::kNone) {
+      hint_ = hint;
+      hint_op_types_ = types;
+    }
+  }
 
   // Will removed latter.
   teller_t teller_;
   std::vector<teller_t> asserts_;
+  Hint hint_{Hint::kNone};
+  std::unordered_set<std::string> hint_op_types_;
   PDPattern* pattern_;
   std::string name_;
   Type type_;
@@ -672,8 +692,13 @@ struct ElementwiseAdd : public PatternBase {
   PATTERN_DECL_NODE(elementwise_add_out);
 };
 
+// The attribute activation_alpha of conv2d_fusion for an activation op in
+// the patterns of the fused conv below.
+float ConvActivationAlpha(const OpDesc& act_op);
+
 // Conv + ElementwiseAdd + an activation
 // This pattern can futher fuse the conv related ops after the conv+bn fusion.
+// The conv can be conv2d or depthwise_conv2d.
 struct ConvElementwiseaddAct : public PatternBase {
   ConvElementwiseaddAct(PDPattern* pattern, const std::string& name_scope)
       : PatternBase(pattern, name_scope, "conv_elementwiseadd_act") {}
@@ -781,6 +806,72 @@ struct TransposeFlattenConcat : public PatternBase {
   }
 };
 
+// The scaled dot-product attention of Transformer, in which the q, k and v
+// are split into heads by reshape2 + transpose2.
+// op: reshape2 + transpose2 (+ scale) of q, reshape2 + transpose2 of k and v,
+//     matmul_qk (+ elementwise_add) + softmax (+ dropout) + matmul_qkv
+//     + transpose2 + reshape2
+// The XShape outputs of reshape2 and transpose2 and the Mask output of
+// dropout are not in the pattern.
+struct MultiHeadAttention : public PatternBase {
+  MultiHeadAttention(PDPattern* pattern, const std::string& name_scope)
+      : PatternBase(pattern, name_scope, "multihead_attention") {}
+
+  PDNode* operator()(PDNode* q, PDNode* k, PDNode* v, bool with_scale,
+                     bool with_bias_qk, bool with_dropout);
+
+  // declare operator node's name
+  PATTERN_DECL_NODE(reshape_q);
+  PATTERN_DECL_NODE(transpose_q);
+  PATTERN_DECL_NODE(scale_q);
+  PATTERN_DECL_NODE(reshape_k);
+  PATTERN_DECL_NODE(transpose_k);
+  PATTERN_DECL_NODE(reshape_v);
+  PATTERN_DECL_NODE(transpose_v);
+  PATTERN_DECL_NODE(matmul_qk);
+  PATTERN_DECL_NODE(eltadd_qk);
+  PATTERN_DECL_NODE(softmax_qk);
+  PATTERN_DECL_NODE(dropout_qk);
+  PATTERN_DECL_NODE(matmul_qkv);
+  PATTERN_DECL_NODE(transpose_qkv);
+  PATTERN_DECL_NODE(reshape_qkv);
+  // declare variable node's name
+  PATTERN_DECL_NODE(reshape_q_out);
+  PATTERN_DECL_NODE(transpose_q_out);
+  PATTERN_DECL_NODE(scale_q_out);
+  PATTERN_DECL_NODE(reshape_k_out);
+  PATTERN_DECL_NODE(transpose_k_out);
+  PATTERN_DECL_NODE(reshape_v_out);
+  PATTERN_DECL_NODE(transpose_v_out);
+  PATTERN_DECL_NODE(matmul_qk_out);
+  PATTERN_DECL_NODE(bias_qk);  // Y of elementwise_add
+  PATTERN_DECL_NODE(eltadd_qk_out);
+  PATTERN_DECL_NODE(softmax_qk_out);
+  PATTERN_DECL_NODE(dropout_qk_out);
+  PATTERN_DECL_NODE(matmul_qkv_out);
+  PATTERN_DECL_NODE(transpose_qkv_out);
+  PATTERN_DECL_NODE(reshape_qkv_out);
+};
+
+// The residual connection and layer_norm of the sublayers of Transformer.
+// op: elementwise_add + layer_norm
+// named nodes:
+// eltwise_add, eltwise_add_out,
+// layer_norm, layer_norm_out, layer_norm_mean, layer_norm_variance
+struct ElewiseAddLayerNorm : public PatternBase {
+  ElewiseAddLayerNorm(PDPattern* pattern, const std::string& name_scope)
+      : PatternBase(pattern, name_scope, "elewise_add_layernorm") {}
+
+  PDNode* operator()(PDNode* x, PDNode* y);
+
+  PATTERN_DECL_NODE(eltwise_add);
+  PATTERN_DECL_NODE(eltwise_add_out);
+  PATTERN_DECL_NODE(layer_norm);
+  PATTERN_DECL_NODE(layer_norm_out);
+  PATTERN_DECL_NODE(layer_norm_mean);
+  PATTERN_DECL_NODE(layer_norm_variance);
+};
+
 }  // namespace patterns
 
 // Link two ir::Nodes from each other.
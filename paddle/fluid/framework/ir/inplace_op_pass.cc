@@ -0,0 +1,167 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+
+#include "paddle/fluid/framework/ir/inplace_op_pass.h"
+#include <algorithm>
+#include <memory>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/op_info.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static bool OpHasSubBlock(const OpDesc& desc) {
+  for (auto& attr : desc.GetAttrMap()) {
+    if (attr.second.type() == typeid(BlockDesc*) ||             // NOLINT
+        attr.second.type() == typeid(std::vector<BlockDesc*>))  // NOLINT
+      return true;
+  }
+  return false;
+}
+
+static ir::Node* FindVarNode(const std::vector<ir::Node*>& nodes,
+                             const std::string& name) {
+  for (auto* node : nodes) {
+    if (node->IsVar() && node->Name() == name) return node;
+  }
+  return nullptr;
+}
+
+std::unique_ptr<ir::Graph> InplaceOpPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  std::unordered_set<std::string> skip_vars;
+  if (Has(kInplaceSkipVars)) {
+    auto& vars = Get<std::vector<std::string>>(kInplaceSkipVars);
+    skip_vars.insert(vars.begin(), vars.end());
+  }
+  // The variables used by a sub-block can not be seen in the graph.
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp() || node->Op() == nullptr) continue;
+    if (!OpHasSubBlock(*node->Op())) continue;
+    for (auto& name : node->Op()->InputArgumentNames()) skip_vars.insert(name);
+    for (auto& name : node->Op()->OutputArgumentNames()) skip_vars.insert(name);
+  }
+
+  auto ops = TopologySortOperations(*graph);
+
+  // The versions of each variable in the order they are written.
+  VarNodeMap var_nodes;
+  std::unordered_set<ir::Node*> visited;
+  for (auto* op : ops) {
+    for (auto* nodes : {&op->inputs, &op->outputs}) {
+      for (auto* node : *nodes) {
+        if (node->IsVar() && visited.insert(node).second) {
+          var_nodes[node->Name()].emplace_back(node);
+        }
+      }
+    }
+  }
+
+  int num_inplaced = 0;
+  for (auto* op : ops) {
+    auto* op_desc = op->Op();
+    if (op_desc == nullptr) continue;
+    auto* info = OpInfoMap::Instance().GetNullable(op_desc->Type());
+    if (info == nullptr || !info->infer_inplace_) continue;
+
+    auto in_to_outs = info->infer_inplace_(*op_desc, op_desc->Block());
+    for (auto& pair : in_to_outs) {
+      auto* in = FindVarNode(op->inputs, pair.first);
+      auto* out = FindVarNode(op->outputs, pair.second);
+      if (in == nullptr || out == nullptr) continue;
+      if (!CanInplace(op, in, out, var_nodes, skip_vars)) continue;
+
+      VLOG(3) << "Inplace " << op_desc->Type() << ": " << out->Name()
+              << " => " << in->Name();
+      RenameOutput(op, in, out, graph.get(), &var_nodes);
+      ++num_inplaced;
+    }
+  }
+  VLOG(3) << "inplace_op_pass reuses the inputs of " << num_inplaced
+          << " outputs";
+  return graph;
+}
+
+bool InplaceOpPass::CanInplace(
+    ir::Node* op, ir::Node* in, ir::Node* out, const VarNodeMap& var_nodes,
+    const std::unordered_set<std::string>& skip_vars) const {
+  if (in->Name() == out->Name()) return false;
+  if (in->IsCtrlVar() || out->IsCtrlVar()) return false;
+  auto* in_desc = in->Var();
+  auto* out_desc = out->Var();
+  if (in_desc == nullptr || out_desc == nullptr) return false;
+  if (in_desc->Persistable() || out_desc->Persistable()) return false;
+  if (in_desc->GetType() != proto::VarType::LOD_TENSOR ||
+      out_desc->GetType() != proto::VarType::LOD_TENSOR ||
+      in_desc->GetDataType() != out_desc->GetDataType()) {
+    return false;
+  }
+  if (skip_vars.count(in->Name()) || skip_vars.count(out->Name())) {
+    return false;
+  }
+
+  // The input is produced by an operator other than feed, only read by op,
+  // and is the last version of its name.
+  if (in->inputs.size() != 1 || in->inputs[0]->Name() == "feed") return false;
+  if (in->outputs.size() != 1 || in->outputs[0] != op) return false;
+  if (var_nodes.at(in->Name()).back() != in) return false;
+
+  // The output is written only once, and is read by other operators but not
+  // fetched.
+  if (var_nodes.at(out->Name()).size() != 1) return false;
+  if (out->outputs.empty()) return false;
+  for (auto* next_op : out->outputs) {
+    if (next_op->Name() == "fetch") return false;
+  }
+  return true;
+}
+
+void InplaceOpPass::RenameOutput(ir::Node* op, ir::Node* in, ir::Node* out,
+                                 ir::Graph* graph,
+                                 VarNodeMap* var_nodes) const {
+  const std::string in_name = in->Name();
+  const std::string out_name = out->Name();
+
+  // The new version of the input keeps the shape of the output.
+  std::unique_ptr<VarDesc> var_desc(new VarDesc(*out->Var()));
+  var_desc->SetName(in_name);
+  ir::Node* new_node = graph->CreateVarNode(var_desc.get());
+
+  new_node->inputs.emplace_back(op);
+  std::replace(op->outputs.begin(), op->outputs.end(), out, new_node);
+  op->Op()->RenameOutput(out_name, in_name);
+  op->Op()->Flush();
+
+  new_node->outputs = out->outputs;
+  for (auto* next_op : out->outputs) {
+    std::replace(next_op->inputs.begin(), next_op->inputs.end(), out,
+                 new_node);
+    if (next_op->Op() != nullptr) {
+      next_op->Op()->RenameInput(out_name, in_name);
+      next_op->Op()->Flush();
+    }
+  }
+
+  graph->RemoveNode(out);
+  var_nodes->erase(out_name);
+  (*var_nodes)[in_name].emplace_back(new_node);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(inplace_op_pass, paddle::framework::ir::InplaceOpPass);
@@ -0,0 +1,68 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+// The names of the variables which can not be renamed, e.g., the loss and the
+// fetched variables of ParallelExecutor. Optional.
+constexpr char kInplaceSkipVars[] = "inplace_skip_vars";
+
+/*
+ * Let the operators write their outputs into the buffers of their inputs, as
+ * declared by the InplaceOpInference registered with the operators.
+ *
+ * The output variable is renamed to the input variable in the graph when
+ *  - the input is only read by this operator, and is not written afterwards,
+ *  - the input is produced by another operator (not fed), and the output is
+ *    read by other operators but is not fetched,
+ *  - neither of them is persistable or used by any sub-block,
+ *  - both of them are LoDTensors of the same data type.
+ *
+ * NOTE: The variables fetched by ParallelExecutor are not in the graph, so
+ * they should be passed by kInplaceSkipVars or be set persistable, just as
+ * what memory_optimize requires.
+ */
+class InplaceOpPass : public Pass {
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+
+ private:
+  using VarNodeMap = std::unordered_map<std::string, std::vector<ir::Node*>>;
+
+  bool CanInplace(ir::Node* op, ir::Node* in, ir::Node* out,
+                  const VarNodeMap& var_nodes,
+                  const std::unordered_set<std::string>& skip_vars) const;
+
+  // Rename the output of op to the name of the input, and update the op
+  // descs of op and the operators reading the output.
+  void RenameOutput(ir::Node* op, ir::Node* in, ir::Node* out,
+                    ir::Graph* graph, VarNodeMap* var_nodes) const;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
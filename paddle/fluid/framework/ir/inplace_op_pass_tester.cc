@@ -0,0 +1,169 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "paddle/fluid/framework/ir/inplace_op_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/program_desc.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+class NOP : public OperatorBase {
+ public:
+  NOP(const std::string& type, const VariableNameMap& inputs,
+      const VariableNameMap& outputs, const AttributeMap& attrs)
+      : OperatorBase(type, inputs, outputs, attrs) {}
+
+ private:
+  void RunImpl(const Scope& scope,
+               const platform::Place& place) const override {}
+};
+
+class NOPMaker : public OpProtoAndCheckerMaker {
+ public:
+  void Make() {
+    AddInput("X", "").AsDuplicable();
+    AddOutput("Out", "").AsDuplicable();
+    AddComment("");
+  }
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_OPERATOR(inplace_test_op, paddle::framework::ir::NOP,
+                  paddle::framework::ir::NOPMaker,
+                  paddle::framework::SingleOpInplaceInToOut);
+REGISTER_OPERATOR(not_inplace_test_op, paddle::framework::ir::NOP,
+                  paddle::framework::ir::NOPMaker);
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static void SetOp(ProgramDesc* prog, const std::string& type,
+                  const std::vector<std::string>& inputs,
+                  const std::vector<std::string>& outputs) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  op->SetInput("X", inputs);
+  op->SetOutput("Out", outputs);
+}
+
+static void AddVars(ProgramDesc* prog, const std::vector<std::string>& vars) {
+  for (auto& name : vars) {
+    auto* var = prog->MutableBlock(0)->Var(name);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+  }
+}
+
+static std::vector<std::string> OpInputs(const ir::Graph& graph,
+                                         const std::string& type) {
+  for (auto* node : graph.Nodes()) {
+    if (node->IsOp() && node->Op() && node->Op()->Type() == type) {
+      return node->Op()->Input("X");
+    }
+  }
+  return {};
+}
+
+static std::unique_ptr<ir::Graph> ApplyInplacePass(const ProgramDesc& prog) {
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  auto pass = PassRegistry::Instance().Get("inplace_op_pass");
+  return pass->Apply(std::move(graph));
+}
+
+// a->not_inplace->b->inplace->c->inplace->d->not_inplace->e
+TEST(InplaceOpPass, chain) {
+  ProgramDesc prog;
+  AddVars(&prog, {"a", "b", "c", "d", "e"});
+  SetOp(&prog, "not_inplace_test_op", {"a"}, {"b"});
+  SetOp(&prog, "inplace_test_op", {"b"}, {"c"});
+  SetOp(&prog, "inplace_test_op", {"c"}, {"d"});
+  SetOp(&prog, "not_inplace_test_op", {"d"}, {"e"});
+
+  auto graph = ApplyInplacePass(prog);
+  // c and d both reuse the buffer of b.
+  const std::vector<std::string> b({"b"});
+  int num_b_inputs = 0;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar()) {
+      ASSERT_NE(node->Name(), "c");
+      ASSERT_NE(node->Name(), "d");
+      continue;
+    }
+    if (node->Op()->Type() == "inplace_test_op") {
+      ASSERT_EQ(node->Op()->Input("X"), b);
+      ASSERT_EQ(node->Op()->Output("Out"), b);
+    } else if (node->Op()->Input("X") == b) {
+      ++num_b_inputs;
+      ASSERT_EQ(node->Op()->Output("Out"), std::vector<std::string>({"e"}));
+    }
+  }
+  ASSERT_EQ(num_b_inputs, 1);
+}
+
+// a->not_inplace->b->inplace->c->not_inplace->d
+//                 b->not_inplace->e
+TEST(InplaceOpPass, input_has_other_readers) {
+  ProgramDesc prog;
+  AddVars(&prog, {"a", "b", "c", "d", "e"});
+  SetOp(&prog, "not_inplace_test_op", {"a"}, {"b"});
+  SetOp(&prog, "inplace_test_op", {"b"}, {"c"});
+  SetOp(&prog, "not_inplace_test_op", {"c"}, {"d"});
+  SetOp(&prog, "not_inplace_test_op", {"b"}, {"e"});
+
+  auto graph = ApplyInplacePass(prog);
+  ASSERT_EQ(OpInputs(*graph, "inplace_test_op"),
+            std::vector<std::string>({"b"}));
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op()->Type() == "inplace_test_op") {
+      ASSERT_EQ(node->Op()->Output("Out"), std::vector<std::string>({"c"}));
+    }
+  }
+}
+
+// a->not_inplace->b->inplace->c, c is persistable or not read by any op.
+TEST(InplaceOpPass, output_may_be_fetched) {
+  for (bool persistable : {true, false}) {
+    ProgramDesc prog;
+    AddVars(&prog, {"a", "b", "c", "d"});
+    SetOp(&prog, "not_inplace_test_op", {"a"}, {"b"});
+    SetOp(&prog, "inplace_test_op", {"b"}, {"c"});
+    if (persistable) {
+      prog.MutableBlock(0)->Var("c")->SetPersistable(true);
+      SetOp(&prog, "not_inplace_test_op", {"c"}, {"d"});
+    }
+
+    auto graph = ApplyInplacePass(prog);
+    for (auto* node : graph->Nodes()) {
+      if (node->IsOp() && node->Op()->Type() == "inplace_test_op") {
+        ASSERT_EQ(node->Op()->Output("Out"), std::vector<std::string>({"c"}));
+      }
+    }
+  }
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(inplace_op_pass);
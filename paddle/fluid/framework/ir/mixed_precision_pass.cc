@@ -0,0 +1,536 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/mixed_precision_pass.h"
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+constexpr char kFP16Suffix[] = "@FP16@";
+constexpr char kFoundInfiniteVarName[] = "@FOUND_INFINITE@";
+constexpr char kUpdateRatioVarName[] = "@LOSS_SCALING_UPDATE_RATIO@";
+constexpr char kLossScalingLRSuffix[] = "@LOSS_SCALING@";
+constexpr char kBetaPowFactorVarName[] = "@LOSS_SCALING_BETA_POW_FACTOR@";
+
+const std::unordered_set<std::string>& DefaultAllowOps() {
+  static const std::unordered_set<std::string> ops{"mul", "matmul", "conv2d"};
+  return ops;
+}
+
+// The optimizer ops which keep all their outputs by the input SkipUpdate.
+const std::unordered_set<std::string>& SkipUpdateOps() {
+  static const std::unordered_set<std::string> ops{
+      "momentum", "adam", "fused_momentum", "fused_adam"};
+  return ops;
+}
+
+int GetOpRole(ir::Node* op) {
+  auto* desc = op->Op();
+  auto role_attr = OpProtoAndCheckerMaker::OpRoleAttrName();
+  if (desc == nullptr || !desc->HasAttr(role_attr)) {
+    return static_cast<int>(OpRole::kNotSpecified);
+  }
+  return boost::get<int>(desc->GetAttr(role_attr));
+}
+
+std::vector<std::string> GetOpRoleVars(ir::Node* op) {
+  auto role_var_attr = OpProtoAndCheckerMaker::OpRoleVarAttrName();
+  if (!op->Op()->HasAttr(role_var_attr)) return {};
+  return boost::get<std::vector<std::string>>(op->Op()->GetAttr(role_var_attr));
+}
+
+bool IsFP32Tensor(ir::Node* var) {
+  return var->IsVar() && var->Var() != nullptr &&
+         var->Var()->GetType() == proto::VarType::LOD_TENSOR &&
+         var->Var()->GetDataType() == proto::VarType::FP32;
+}
+
+bool IsAllowed(ir::Node* op, const std::unordered_set<std::string>& allow_ops) {
+  auto* desc = op->Op();
+  if (desc == nullptr) return false;
+  const std::string& type = desc->Type();
+  static const std::string kGradSuffix = "_grad";
+  std::string fwd_type = type;
+  if (type.size() > kGradSuffix.size() &&
+      type.compare(type.size() - kGradSuffix.size(), kGradSuffix.size(),
+                   kGradSuffix) == 0) {
+    fwd_type = type.substr(0, type.size() - kGradSuffix.size());
+  }
+  if (!allow_ops.count(fwd_type)) return false;
+  // Only the cudnn kernels of conv2d support float16.
+  if (desc->HasAttr("use_cudnn") &&
+      !boost::get<bool>(desc->GetAttr("use_cudnn"))) {
+    return false;
+  }
+  // The casts can not be inserted between the in-place inputs and outputs.
+  auto outputs = desc->OutputArgumentNames();
+  for (auto& name : desc->InputArgumentNames()) {
+    if (std::find(outputs.begin(), outputs.end(), name) != outputs.end()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+ir::Node* CreateVar(ir::Graph* graph, const std::string& name,
+                    proto::VarType::Type dtype, bool persistable) {
+  VarDesc desc(name);
+  desc.SetType(proto::VarType::LOD_TENSOR);
+  desc.SetDataType(dtype);
+  desc.SetShape({1});
+  desc.SetPersistable(persistable);
+  return graph->CreateVarNode(&desc);
+}
+
+// A new version of var, written by the op after the current one.
+ir::Node* CreateVersion(ir::Graph* graph, ir::Node* var) {
+  return graph->CreateVarNode(var->Var());
+}
+
+ir::Node* CreateOp(ir::Graph* graph, OpDesc* desc, int role,
+                   const std::vector<ir::Node*>& inputs,
+                   const std::vector<ir::Node*>& outputs) {
+  desc->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(), role);
+  desc->Flush();
+  auto* op = graph->CreateOpNode(desc);
+  for (auto* in : inputs) {
+    op->inputs.emplace_back(in);
+    in->outputs.emplace_back(op);
+  }
+  for (auto* out : outputs) {
+    op->outputs.emplace_back(out);
+    out->inputs.emplace_back(op);
+  }
+  return op;
+}
+
+ir::Node* CreateCast(ir::Graph* graph, ir::Node* in, ir::Node* out, int role) {
+  OpDesc desc;
+  desc.SetType("cast");
+  desc.SetInput("X", {in->Name()});
+  desc.SetOutput("Out", {out->Name()});
+  desc.SetAttr("in_dtype", static_cast<int>(in->Var()->GetDataType()));
+  desc.SetAttr("out_dtype", static_cast<int>(out->Var()->GetDataType()));
+  return CreateOp(graph, &desc, role, {in}, {out});
+}
+
+ir::Node* CreateFP16Var(ir::Graph* graph, ir::Node* var) {
+  VarDesc desc(*var->Var());
+  desc.SetName(var->Name() + kFP16Suffix + std::to_string(var->id()));
+  desc.SetDataType(proto::VarType::FP16);
+  desc.SetPersistable(false);
+  return graph->CreateVarNode(&desc);
+}
+
+// Let op read new_var instead of var, which have the same name or not.
+void ReplaceInput(ir::Node* op, ir::Node* var, ir::Node* new_var) {
+  std::replace(op->inputs.begin(), op->inputs.end(), var, new_var);
+  var->outputs.erase(std::remove(var->outputs.begin(), var->outputs.end(), op),
+                     var->outputs.end());
+  new_var->outputs.emplace_back(op);
+  if (var->Name() != new_var->Name()) {
+    op->Op()->RenameInput(var->Name(), new_var->Name());
+  }
+}
+
+// Let the readers of var except op read new_var, the version written by op.
+void MoveReaders(ir::Node* var, ir::Node* new_var, ir::Node* op) {
+  std::vector<ir::Node*> readers;
+  for (auto* reader : var->outputs) {
+    if (reader != op &&
+        std::find(readers.begin(), readers.end(), reader) == readers.end()) {
+      readers.emplace_back(reader);
+    }
+  }
+  for (auto* reader : readers) {
+    ReplaceInput(reader, var, new_var);
+  }
+}
+
+// Let new_op take over all the inputs and outputs of op, and remove op.
+void ReplaceOp(ir::Graph* graph, ir::Node* op, ir::Node* new_op) {
+  for (auto* in : op->inputs) {
+    std::replace(in->outputs.begin(), in->outputs.end(), op, new_op);
+    new_op->inputs.emplace_back(in);
+  }
+  for (auto* out : op->outputs) {
+    std::replace(out->inputs.begin(), out->inputs.end(), op, new_op);
+    new_op->outputs.emplace_back(out);
+  }
+  op->inputs.clear();
+  op->outputs.clear();
+  graph->RemoveNode(op);
+}
+
+ir::Node* FindVar(const std::vector<ir::Node*>& nodes,
+                  const std::string& name) {
+  for (auto* node : nodes) {
+    if (node->IsVar() && node->Name() == name) return node;
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+int MixedPrecisionPass::InsertCasts(
+    ir::Graph* graph, const std::unordered_set<std::string>& allow_ops) const {
+  // The float32 variables -> their float16 copies.
+  std::unordered_map<ir::Node*, ir::Node*> fp16_vars;
+  int num_ops = 0;
+  for (auto* op : TopologySortOperations(*graph)) {
+    if (!IsAllowed(op, allow_ops)) continue;
+    int role = GetOpRole(op);
+    // RenameInput and RenameOutput rename the role vars too.
+    auto role_vars = GetOpRoleVars(op);
+    PADDLE_ENFORCE_EQ(role_vars.size() % 2, 0);
+
+    std::vector<ir::Node*> inputs;
+    for (auto* in : op->inputs) {
+      if (IsFP32Tensor(in) &&
+          std::find(inputs.begin(), inputs.end(), in) == inputs.end()) {
+        inputs.emplace_back(in);
+      }
+    }
+    for (auto* in : inputs) {
+      auto it = fp16_vars.find(in);
+      if (it == fp16_vars.end()) {
+        auto* fp16_var = CreateFP16Var(graph, in);
+        CreateCast(graph, in, fp16_var, role);
+        it = fp16_vars.emplace(in, fp16_var).first;
+      }
+      ReplaceInput(op, in, it->second);
+    }
+
+    // The grads written by the casts, whose all-reduce follow the casts.
+    std::unordered_map<std::string, ir::Node*> grad_casts;
+    for (auto* out : std::vector<ir::Node*>(op->outputs)) {
+      if (!IsFP32Tensor(out)) continue;
+      auto* fp16_var = CreateFP16Var(graph, out);
+      std::replace(op->outputs.begin(), op->outputs.end(), out, fp16_var);
+      fp16_var->inputs.emplace_back(op);
+      out->inputs.erase(std::remove(out->inputs.begin(), out->inputs.end(), op),
+                        out->inputs.end());
+      op->Op()->RenameOutput(out->Name(), fp16_var->Name());
+      grad_casts[out->Name()] = CreateCast(graph, fp16_var, out, role);
+      fp16_vars.emplace(out, fp16_var);
+    }
+
+    std::vector<std::string> kept_role_vars;
+    for (size_t i = 0; i < role_vars.size(); i += 2) {
+      auto it = grad_casts.find(role_vars[i + 1]);
+      if (it == grad_casts.end()) {
+        kept_role_vars.emplace_back(role_vars[i]);
+        kept_role_vars.emplace_back(role_vars[i + 1]);
+      } else {
+        it->second->Op()->SetAttr(
+            OpProtoAndCheckerMaker::OpRoleVarAttrName(),
+            std::vector<std::string>({role_vars[i], role_vars[i + 1]}));
+      }
+    }
+    if (!role_vars.empty()) {
+      op->Op()->SetAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName(),
+                        kept_role_vars);
+    }
+    op->Op()->Flush();
+    ++num_ops;
+  }
+  return num_ops;
+}
+
+void MixedPrecisionPass::InsertLossScaling(ir::Graph* graph,
+                                           float init_loss_scaling,
+                                           bool dynamic) const {
+  auto sorted_ops = TopologySortOperations(*graph);
+  const int kLossGradRole =
+      static_cast<int>(OpRole::kBackward) | static_cast<int>(OpRole::kLoss);
+  auto loss_grad_op = std::find_if(
+      sorted_ops.begin(), sorted_ops.end(),
+      [&](ir::Node* op) { return GetOpRole(op) == kLossGradRole; });
+  if (loss_grad_op == sorted_ops.end()) {
+    VLOG(3) << "There is no backward op, skip the loss scaling";
+    return;
+  }
+  auto loss_grad_names = (*loss_grad_op)->Op()->OutputArgumentNames();
+  PADDLE_ENFORCE_EQ(loss_grad_names.size(), 1UL,
+                    "The op of the loss gradient should have one output.");
+  auto* loss_grad = FindVar((*loss_grad_op)->outputs, loss_grad_names[0]);
+
+  // The gradients of the parameters, to be all-reduced after their writers.
+  std::vector<ir::Node*> grads;
+  for (auto* op : sorted_ops) {
+    if (op->Op() == nullptr ||
+        !(GetOpRole(op) & static_cast<int>(OpRole::kBackward))) {
+      continue;
+    }
+    auto role_vars = GetOpRoleVars(op);
+    for (size_t i = 1; i < role_vars.size(); i += 2) {
+      auto* grad = FindVar(op->outputs, role_vars[i]);
+      PADDLE_ENFORCE_NOT_NULL(grad, "The op %s does not write the grad %s.",
+                              op->Op()->Type(), role_vars[i]);
+      if (std::find(grads.begin(), grads.end(), grad) == grads.end()) {
+        grads.emplace_back(grad);
+      }
+    }
+  }
+
+  for (auto* name : {kLossScalingVarName, kLossScalingGoodStepsVarName,
+                     kLossScalingBadStepsVarName, kFoundInfiniteVarName}) {
+    for (auto* node : graph->Nodes()) {
+      PADDLE_ENFORCE(!(node->IsVar() && node->Name() == name),
+                     "The loss scaling has been applied to the graph.");
+    }
+  }
+  // The loss scaling is not updated by the static loss scaling, so there is
+  // no variable of it, and init_loss_scaling is used.
+  ir::Node* loss_scaling = nullptr;
+  std::vector<ir::Node*> loss_scaling_inputs;
+  if (dynamic) {
+    loss_scaling =
+        CreateVar(graph, kLossScalingVarName, proto::VarType::FP32, true);
+    loss_scaling_inputs.emplace_back(loss_scaling);
+  }
+
+  {
+    OpDesc desc;
+    desc.SetType("scale_loss");
+    desc.SetInput("X", {loss_grad->Name()});
+    if (dynamic) desc.SetInput("LossScaling", {kLossScalingVarName});
+    desc.SetOutput("Out", {loss_grad->Name()});
+    desc.SetAttr("init_loss_scaling", init_loss_scaling);
+    auto* scaled_loss_grad = CreateVersion(graph, loss_grad);
+    std::vector<ir::Node*> inputs{loss_grad};
+    inputs.insert(inputs.end(), loss_scaling_inputs.begin(),
+                  loss_scaling_inputs.end());
+    auto* op = CreateOp(graph, &desc, static_cast<int>(OpRole::kBackward),
+                        inputs, {scaled_loss_grad});
+    MoveReaders(loss_grad, scaled_loss_grad, op);
+  }
+  if (grads.empty()) {
+    VLOG(3) << "There is no gradient of the parameters";
+    return;
+  }
+
+  const int kOptimizeRole = static_cast<int>(OpRole::kOptimize);
+  auto* found_inf =
+      CreateVar(graph, kFoundInfiniteVarName, proto::VarType::BOOL, false);
+  {
+    OpDesc desc;
+    desc.SetType("check_finite_and_unscale");
+    std::vector<std::string> names;
+    std::vector<ir::Node*> new_grads;
+    for (auto* grad : grads) {
+      names.emplace_back(grad->Name());
+      new_grads.emplace_back(CreateVersion(graph, grad));
+    }
+    desc.SetInput("X", names);
+    if (dynamic) desc.SetInput("LossScaling", {kLossScalingVarName});
+    desc.SetOutput("Out", names);
+    desc.SetOutput("FoundInfinite", {kFoundInfiniteVarName});
+    desc.SetAttr("init_loss_scaling", init_loss_scaling);
+    std::vector<ir::Node*> inputs(grads);
+    inputs.insert(inputs.end(), loss_scaling_inputs.begin(),
+                  loss_scaling_inputs.end());
+    std::vector<ir::Node*> outputs(new_grads);
+    outputs.emplace_back(found_inf);
+    auto* op = CreateOp(graph, &desc, kOptimizeRole, inputs, outputs);
+    for (size_t i = 0; i < grads.size(); ++i) {
+      MoveReaders(grads[i], new_grads[i], op);
+    }
+  }
+
+  // The float32 FoundInfinite, for the ops reading it as a number.
+  ir::Node* found_inf_fp32 = nullptr;
+  auto get_found_inf_fp32 = [&] {
+    if (found_inf_fp32 == nullptr) {
+      found_inf_fp32 = CreateVar(
+          graph, std::string(kFoundInfiniteVarName) + "FP32",
+          proto::VarType::FP32, false);
+      CreateCast(graph, found_inf, found_inf_fp32, kOptimizeRole);
+    }
+    return found_inf_fp32;
+  };
+  // The variable of value 1 - FoundInfinite.
+  ir::Node* update_ratio = nullptr;
+  auto get_update_ratio = [&] {
+    if (update_ratio == nullptr) {
+      auto* in = get_found_inf_fp32();
+      update_ratio =
+          CreateVar(graph, kUpdateRatioVarName, proto::VarType::FP32, false);
+      OpDesc desc;
+      desc.SetType("scale");
+      desc.SetInput("X", {in->Name()});
+      desc.SetOutput("Out", {update_ratio->Name()});
+      desc.SetAttr("scale", -1.0f);
+      desc.SetAttr("bias", 1.0f);
+      desc.SetAttr("bias_after_scale", true);
+      CreateOp(graph, &desc, kOptimizeRole, {in}, {update_ratio});
+    }
+    return update_ratio;
+  };
+
+  // The optimizer ops supporting SkipUpdate keep the parameters and all their
+  // states in the overflowed steps. The learning rates of the others are
+  // multiplied by 1 - FoundInfinite, which only keeps the parameters.
+  std::unordered_set<std::string> beta_pows;
+  std::unordered_map<ir::Node*, ir::Node*> scaled_lrs;
+  for (auto* op : sorted_ops) {
+    if (op->Op() == nullptr || !(GetOpRole(op) & kOptimizeRole)) continue;
+    auto* desc = op->Op();
+    if (SkipUpdateOps().count(desc->Type())) {
+      desc->SetInput("SkipUpdate", {found_inf->Name()});
+      desc->Flush();
+      op->inputs.emplace_back(found_inf);
+      found_inf->outputs.emplace_back(op);
+      for (auto* slot : {"Beta1Pow", "Beta2Pow"}) {
+        if (!desc->Inputs().count(slot)) continue;
+        for (auto& name : desc->Input(slot)) beta_pows.insert(name);
+      }
+      continue;
+    }
+    if (!desc->Inputs().count("LearningRate")) continue;
+    for (auto& name : desc->Input("LearningRate")) {
+      auto* lr = FindVar(op->inputs, name);
+      if (lr == nullptr) continue;
+      auto it = scaled_lrs.find(lr);
+      if (it == scaled_lrs.end()) {
+        auto* ratio = get_update_ratio();
+        VarDesc var_desc(*lr->Var());
+        var_desc.SetName(lr->Name() + kLossScalingLRSuffix +
+                         std::to_string(lr->id()));
+        var_desc.SetPersistable(false);
+        auto* scaled_lr = graph->CreateVarNode(&var_desc);
+        OpDesc lr_desc;
+        lr_desc.SetType("elementwise_mul");
+        lr_desc.SetInput("X", {lr->Name()});
+        lr_desc.SetInput("Y", {ratio->Name()});
+        lr_desc.SetOutput("Out", {scaled_lr->Name()});
+        lr_desc.SetAttr("axis", -1);
+        CreateOp(graph, &lr_desc, kOptimizeRole, {lr, ratio}, {scaled_lr});
+        it = scaled_lrs.emplace(lr, scaled_lr).first;
+      }
+      ReplaceInput(op, lr, it->second);
+    }
+  }
+
+  // The beta powers of adam are updated by the scale ops after it, which are
+  // replaced by the multiplication of beta + (1 - beta) * FoundInfinite, so
+  // that they are kept in the overflowed steps too.
+  std::map<float, ir::Node*> beta_pow_factors;
+  for (auto* op : sorted_ops) {
+    auto* desc = op->Op();
+    if (desc == nullptr || desc->Type() != "scale" ||
+        !(GetOpRole(op) & kOptimizeRole) || desc->Input("X").size() != 1 ||
+        desc->Output("Out") != desc->Input("X") ||
+        !beta_pows.count(desc->Input("X")[0]) ||
+        (desc->HasAttr("bias") &&
+         boost::get<float>(desc->GetAttr("bias")) != 0.0f)) {
+      continue;
+    }
+    float beta = desc->HasAttr("scale")
+                     ? boost::get<float>(desc->GetAttr("scale"))
+                     : 1.0f;
+    auto it = beta_pow_factors.find(beta);
+    if (it == beta_pow_factors.end()) {
+      auto* in = get_found_inf_fp32();
+      auto* factor = CreateVar(
+          graph,
+          kBetaPowFactorVarName + std::to_string(beta_pow_factors.size()),
+          proto::VarType::FP32, false);
+      OpDesc factor_desc;
+      factor_desc.SetType("scale");
+      factor_desc.SetInput("X", {in->Name()});
+      factor_desc.SetOutput("Out", {factor->Name()});
+      factor_desc.SetAttr("scale", 1.0f - beta);
+      factor_desc.SetAttr("bias", beta);
+      factor_desc.SetAttr("bias_after_scale", true);
+      CreateOp(graph, &factor_desc, kOptimizeRole, {in}, {factor});
+      it = beta_pow_factors.emplace(beta, factor).first;
+    }
+    OpDesc mul_desc;
+    mul_desc.SetType("elementwise_mul");
+    mul_desc.SetInput("X", desc->Input("X"));
+    mul_desc.SetInput("Y", {it->second->Name()});
+    mul_desc.SetOutput("Out", desc->Output("Out"));
+    mul_desc.SetAttr("axis", -1);
+    auto role_var_attr = OpProtoAndCheckerMaker::OpRoleVarAttrName();
+    if (desc->HasAttr(role_var_attr)) {
+      mul_desc.SetAttr(role_var_attr, desc->GetAttr(role_var_attr));
+    }
+    auto* mul = CreateOp(graph, &mul_desc, GetOpRole(op), {it->second}, {});
+    ReplaceOp(graph, op, mul);
+  }
+
+  if (dynamic) {
+    auto* good_steps = CreateVar(graph, kLossScalingGoodStepsVarName,
+                                 proto::VarType::INT32, true);
+    auto* bad_steps = CreateVar(graph, kLossScalingBadStepsVarName,
+                                proto::VarType::INT32, true);
+    OpDesc desc;
+    desc.SetType("update_loss_scaling");
+    desc.SetInput("FoundInfinite", {kFoundInfiniteVarName});
+    desc.SetInput("PrevLossScaling", {kLossScalingVarName});
+    desc.SetInput("InGoodSteps", {kLossScalingGoodStepsVarName});
+    desc.SetInput("InBadSteps", {kLossScalingBadStepsVarName});
+    desc.SetOutput("LossScaling", {kLossScalingVarName});
+    desc.SetOutput("OutGoodSteps", {kLossScalingGoodStepsVarName});
+    desc.SetOutput("OutBadSteps", {kLossScalingBadStepsVarName});
+    desc.SetAttr("init_loss_scaling", init_loss_scaling);
+    CreateOp(graph, &desc, kOptimizeRole,
+             {found_inf, loss_scaling, good_steps, bad_steps},
+             {CreateVersion(graph, loss_scaling),
+              CreateVersion(graph, good_steps),
+              CreateVersion(graph, bad_steps)});
+  }
+}
+
+std::unique_ptr<ir::Graph> MixedPrecisionPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  std::unordered_set<std::string> allow_ops(DefaultAllowOps());
+  if (Has(kMixedPrecisionAllowOps)) {
+    auto& ops = Get<std::vector<std::string>>(kMixedPrecisionAllowOps);
+    allow_ops.insert(ops.begin(), ops.end());
+  }
+  if (Has(kMixedPrecisionDenyOps)) {
+    for (auto& op :
+         Get<std::vector<std::string>>(kMixedPrecisionDenyOps)) {
+      allow_ops.erase(op);
+    }
+  }
+  float init_loss_scaling = Has(kMixedPrecisionInitLossScaling)
+                                ? Get<float>(kMixedPrecisionInitLossScaling)
+                                : 32768.0f;
+  bool dynamic = Has(kMixedPrecisionDynamicLossScaling)
+                     ? Get<bool>(kMixedPrecisionDynamicLossScaling)
+                     : true;
+
+  int num_ops = InsertCasts(graph.get(), allow_ops);
+  VLOG(3) << "mixed_precision_pass runs " << num_ops << " ops in float16";
+  InsertLossScaling(graph.get(), init_loss_scaling, dynamic);
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(mixed_precision_pass, paddle::framework::ir::MixedPrecisionPass);
@@ -0,0 +1,91 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+// The forward op types run in float16 besides the defaults, and the ones
+// which never run in float16, std::vector<std::string>. Their grad ops
+// follow them. Both are optional.
+constexpr char kMixedPrecisionAllowOps[] = "mixed_precision_allow_ops";
+constexpr char kMixedPrecisionDenyOps[] = "mixed_precision_deny_ops";
+// The initial loss scaling, float, and whether to update it by the overflows,
+// bool. Both are optional, 32768 and true by default.
+constexpr char kMixedPrecisionInitLossScaling[] =
+    "mixed_precision_init_loss_scaling";
+constexpr char kMixedPrecisionDynamicLossScaling[] =
+    "mixed_precision_dynamic_loss_scaling";
+
+// The persistable states of the dynamic loss scaling.
+constexpr char kLossScalingVarName[] = "@LOSS_SCALING@";
+constexpr char kLossScalingGoodStepsVarName[] = "@LOSS_SCALING_GOOD_STEPS@";
+constexpr char kLossScalingBadStepsVarName[] = "@LOSS_SCALING_BAD_STEPS@";
+
+/*
+ * Rewrite a training graph to the mixed precision training, which runs the
+ * ops in the allow list, e.g., mul, matmul and the cudnn conv2d, and their
+ * grad ops in float16 on the Tensor Cores, and the other ops in float32.
+ *
+ * The float32 inputs of an allowed op are cast to float16 variables, named
+ * var@FP16@id, and its float32 outputs are written to float16 variables, which
+ * are cast back to the original ones. A variable is cast once however many
+ * allowed ops read it, and an allowed op reads the float16 output of another
+ * one directly. The parameters and their gradients read by the optimizer ops
+ * stay float32, so they are the master weights.
+ *
+ * With the loss scaling, the gradient of the loss is multiplied by the loss
+ * scaling before the backward ops, so that the small float16 gradients do not
+ * underflow. A check_finite_and_unscale op after the backward ops divides the
+ * gradients of the parameters by it, or sets them to zero if any of them has
+ * overflowed. The momentum and adam ops read whether it has overflowed as
+ * their SkipUpdate input, and keep the parameters and their states unchanged
+ * then; the scale ops updating the beta pows of adam are replaced by
+ * elementwise_mul ops by a factor which is 1 in the overflowed steps. The
+ * learning rates of the other optimizer ops are zero in them. The dynamic
+ * loss scaling doubles the loss scaling every 1000 finite steps and halves it
+ * every 2 overflowed steps, by an update_loss_scaling op.
+ *
+ * The states of the loss scaling are persistable variables, which are not
+ * initialized by the startup program, so their ops start from the initial
+ * values if they are not initialized.
+ *
+ * The pass should be applied before multi_devices_pass with the AllReduce
+ * strategy, so that every device sees the same overflows, and only on GPU,
+ * where the float16 kernels are.
+ */
+class MixedPrecisionPass : public Pass {
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+
+ private:
+  int InsertCasts(ir::Graph* graph,
+                  const std::unordered_set<std::string>& allow_ops) const;
+
+  void InsertLossScaling(ir::Graph* graph, float init_loss_scaling,
+                         bool dynamic) const;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
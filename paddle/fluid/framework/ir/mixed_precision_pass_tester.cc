@@ -0,0 +1,406 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/mixed_precision_pass.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <limits>
+#include <map>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/scope.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static OpDesc* AppendOp(ProgramDesc* prog, const std::string& type,
+                        OpRole role) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(role));
+  return op;
+}
+
+// y = mul(x, w), loss = mean(y), and its backward ops and sgd.
+static ProgramDesc BuildProgram() {
+  ProgramDesc prog;
+  for (auto& name : {"x", "w", "y", "loss", "loss@GRAD", "y@GRAD", "w@GRAD",
+                     "lr"}) {
+    auto* var = prog.MutableBlock(0)->Var(name);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+  }
+  prog.MutableBlock(0)->Var("w")->SetPersistable(true);
+  prog.MutableBlock(0)->Var("lr")->SetPersistable(true);
+  auto kLoss = static_cast<OpRole>(static_cast<int>(OpRole::kForward) |
+                                   static_cast<int>(OpRole::kLoss));
+  auto kLossGrad = static_cast<OpRole>(static_cast<int>(OpRole::kBackward) |
+                                       static_cast<int>(OpRole::kLoss));
+  std::vector<std::string> role_vars({"w", "w@GRAD"});
+
+  auto* op = AppendOp(&prog, "mul", OpRole::kForward);
+  op->SetInput("X", {"x"});
+  op->SetInput("Y", {"w"});
+  op->SetOutput("Out", {"y"});
+  op = AppendOp(&prog, "mean", kLoss);
+  op->SetInput("X", {"y"});
+  op->SetOutput("Out", {"loss"});
+  op = AppendOp(&prog, "fill_constant", kLossGrad);
+  op->SetOutput("Out", {"loss@GRAD"});
+  op = AppendOp(&prog, "mean_grad", OpRole::kBackward);
+  op->SetInput("X", {"y"});
+  op->SetInput("Out@GRAD", {"loss@GRAD"});
+  op->SetOutput("X@GRAD", {"y@GRAD"});
+  op = AppendOp(&prog, "mul_grad", OpRole::kBackward);
+  op->SetInput("X", {"x"});
+  op->SetInput("Y", {"w"});
+  op->SetInput("Out@GRAD", {"y@GRAD"});
+  op->SetOutput("Y@GRAD", {"w@GRAD"});
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName(), role_vars);
+  op = AppendOp(&prog, "sgd", OpRole::kOptimize);
+  op->SetInput("Param", {"w"});
+  op->SetInput("Grad", {"w@GRAD"});
+  op->SetInput("LearningRate", {"lr"});
+  op->SetOutput("ParamOut", {"w"});
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleVarAttrName(), role_vars);
+  return prog;
+}
+
+// The gradients of w and u are both loss@GRAD of the value grad, with which
+// adam updates w and momentum updates u.
+static ProgramDesc BuildOptimizerProgram(float grad) {
+  ProgramDesc prog;
+  for (auto& name : {"loss@GRAD", "w", "w@GRAD", "m1", "m2", "b1p", "b2p",
+                     "u", "u@GRAD", "v", "lr"}) {
+    auto* var = prog.MutableBlock(0)->Var(name);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetDataType(proto::VarType::FP32);
+    var->SetPersistable(std::string(name).find("@GRAD") == std::string::npos);
+  }
+  auto kLossGrad = static_cast<OpRole>(static_cast<int>(OpRole::kBackward) |
+                                       static_cast<int>(OpRole::kLoss));
+  auto role_var_attr = OpProtoAndCheckerMaker::OpRoleVarAttrName();
+  std::vector<std::string> w_role_vars({"w", "w@GRAD"});
+  std::vector<std::string> u_role_vars({"u", "u@GRAD"});
+
+  auto* op = AppendOp(&prog, "fill_constant", kLossGrad);
+  op->SetOutput("Out", {"loss@GRAD"});
+  op->SetAttr("shape", std::vector<int64_t>({2}));
+  op->SetAttr("dtype", static_cast<int>(proto::VarType::FP32));
+  op->SetAttr("value", grad);
+  for (auto* role_vars : {&w_role_vars, &u_role_vars}) {
+    op = AppendOp(&prog, "scale", OpRole::kBackward);
+    op->SetInput("X", {"loss@GRAD"});
+    op->SetOutput("Out", {(*role_vars)[1]});
+    op->SetAttr("scale", 1.0f);
+    op->SetAttr(role_var_attr, *role_vars);
+  }
+
+  op = AppendOp(&prog, "adam", OpRole::kOptimize);
+  op->SetInput("Param", {"w"});
+  op->SetInput("Grad", {"w@GRAD"});
+  op->SetInput("LearningRate", {"lr"});
+  op->SetInput("Moment1", {"m1"});
+  op->SetInput("Moment2", {"m2"});
+  op->SetInput("Beta1Pow", {"b1p"});
+  op->SetInput("Beta2Pow", {"b2p"});
+  op->SetOutput("ParamOut", {"w"});
+  op->SetOutput("Moment1Out", {"m1"});
+  op->SetOutput("Moment2Out", {"m2"});
+  op->SetAttr("beta1", 0.9f);
+  op->SetAttr("beta2", 0.999f);
+  op->SetAttr(role_var_attr, w_role_vars);
+  for (auto& pair : std::vector<std::pair<std::string, float>>(
+           {{"b1p", 0.9f}, {"b2p", 0.999f}})) {
+    op = AppendOp(&prog, "scale", OpRole::kOptimize);
+    op->SetInput("X", {pair.first});
+    op->SetOutput("Out", {pair.first});
+    op->SetAttr("scale", pair.second);
+    op->SetAttr("bias", 0.0f);
+    op->SetAttr(role_var_attr, w_role_vars);
+  }
+
+  op = AppendOp(&prog, "momentum", OpRole::kOptimize);
+  op->SetInput("Param", {"u"});
+  op->SetInput("Grad", {"u@GRAD"});
+  op->SetInput("Velocity", {"v"});
+  op->SetInput("LearningRate", {"lr"});
+  op->SetOutput("ParamOut", {"u"});
+  op->SetOutput("VelocityOut", {"v"});
+  op->SetAttr("mu", 0.9f);
+  op->SetAttr(role_var_attr, u_role_vars);
+  return prog;
+}
+
+static std::vector<ir::Node*> FindOps(const ir::Graph& graph,
+                                      const std::string& type) {
+  std::vector<ir::Node*> ops;
+  for (auto* node : graph.Nodes()) {
+    if (node->IsOp() && node->Op()->Type() == type) ops.emplace_back(node);
+  }
+  return ops;
+}
+
+static ir::Node* FindInput(ir::Node* op, const std::string& name) {
+  for (auto* in : op->inputs) {
+    if (in->Name() == name) return in;
+  }
+  return nullptr;
+}
+
+static ir::Node* FindOutput(ir::Node* op, const std::string& name) {
+  for (auto* out : op->outputs) {
+    if (out->Name() == name) return out;
+  }
+  return nullptr;
+}
+
+static std::unique_ptr<ir::Graph> ApplyPass(const ProgramDesc& prog,
+                                            bool dynamic) {
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  auto pass = PassRegistry::Instance().Get("mixed_precision_pass");
+  pass->Set(kMixedPrecisionDynamicLossScaling, new bool(dynamic));
+  graph = pass->Apply(std::move(graph));
+  EXPECT_FALSE(HasCircle(*graph));
+  return graph;
+}
+
+TEST(MixedPrecisionPass, casts) {
+  auto graph = ApplyPass(BuildProgram(), true);
+
+  // x and w are cast once for mul and mul_grad, y@GRAD to float16, and y and
+  // w@GRAD back to float32, besides the cast of the overflow flag.
+  EXPECT_EQ(FindOps(*graph, "cast").size(), 6UL);
+  auto* mul = FindOps(*graph, "mul").at(0);
+  auto* mul_grad = FindOps(*graph, "mul_grad").at(0);
+  for (auto* op : {mul, mul_grad}) {
+    for (auto* in : op->inputs) {
+      if (in->IsCtrlVar()) continue;
+      EXPECT_EQ(in->Var()->GetDataType(), proto::VarType::FP16);
+      EXPECT_NE(in->Name().find("@FP16@"), std::string::npos);
+    }
+    for (auto* out : op->outputs) {
+      if (out->IsCtrlVar()) continue;
+      EXPECT_EQ(out->Var()->GetDataType(), proto::VarType::FP16);
+      ASSERT_EQ(out->outputs.size(), 1UL);
+      EXPECT_EQ(out->outputs[0]->Op()->Type(), "cast");
+    }
+  }
+  EXPECT_EQ(mul->Op()->Input("X"), mul_grad->Op()->Input("X"));
+  EXPECT_EQ(mul->Op()->Input("Y"), mul_grad->Op()->Input("Y"));
+
+  // The all-reduce of w@GRAD follows its cast.
+  auto role_var_attr = OpProtoAndCheckerMaker::OpRoleVarAttrName();
+  EXPECT_TRUE(boost::get<std::vector<std::string>>(
+                  mul_grad->Op()->GetAttr(role_var_attr))
+                  .empty());
+  auto* grad_cast =
+      FindOutput(mul_grad, mul_grad->Op()->Output("Y@GRAD")[0])->outputs[0];
+  EXPECT_EQ(grad_cast->Op()->Output("Out"),
+            std::vector<std::string>({"w@GRAD"}));
+  EXPECT_EQ(boost::get<std::vector<std::string>>(
+                grad_cast->Op()->GetAttr(role_var_attr)),
+            std::vector<std::string>({"w", "w@GRAD"}));
+
+  // sgd reads the float32 master weight.
+  auto* sgd = FindOps(*graph, "sgd").at(0);
+  EXPECT_EQ(FindInput(sgd, "w")->Var()->GetDataType(), proto::VarType::FP32);
+}
+
+TEST(MixedPrecisionPass, dynamic_loss_scaling) {
+  auto graph = ApplyPass(BuildProgram(), true);
+
+  auto* mean_grad = FindOps(*graph, "mean_grad").at(0);
+  auto* loss_grad = FindInput(mean_grad, "loss@GRAD");
+  ASSERT_EQ(loss_grad->inputs.size(), 1UL);
+  EXPECT_EQ(loss_grad->inputs[0]->Op()->Type(), "scale_loss");
+
+  auto* sgd = FindOps(*graph, "sgd").at(0);
+  auto* grad = FindInput(sgd, "w@GRAD");
+  ASSERT_EQ(grad->inputs.size(), 1UL);
+  auto* check = grad->inputs[0];
+  EXPECT_EQ(check->Op()->Type(), "check_finite_and_unscale");
+  EXPECT_EQ(check->Op()->Input("X"), std::vector<std::string>({"w@GRAD"}));
+  EXPECT_EQ(check->Op()->Input("LossScaling"),
+            std::vector<std::string>({kLossScalingVarName}));
+
+  auto lr_names = sgd->Op()->Input("LearningRate");
+  ASSERT_EQ(lr_names.size(), 1UL);
+  EXPECT_NE(lr_names[0], "lr");
+  auto* lr = FindInput(sgd, lr_names[0]);
+  ASSERT_EQ(lr->inputs.size(), 1UL);
+  EXPECT_EQ(lr->inputs[0]->Op()->Type(), "elementwise_mul");
+
+  auto updates = FindOps(*graph, "update_loss_scaling");
+  ASSERT_EQ(updates.size(), 1UL);
+  for (auto* out : updates[0]->outputs) {
+    if (out->IsCtrlVar()) continue;
+    EXPECT_TRUE(out->Var()->Persistable());
+  }
+  // The loss scaling is updated after it scales the gradients.
+  auto sorted_ops = TopologySortOperations(*graph);
+  EXPECT_LT(std::find(sorted_ops.begin(), sorted_ops.end(), check),
+            std::find(sorted_ops.begin(), sorted_ops.end(), updates[0]));
+}
+
+TEST(MixedPrecisionPass, static_loss_scaling) {
+  auto graph = ApplyPass(BuildProgram(), false);
+
+  auto* check = FindOps(*graph, "check_finite_and_unscale").at(0);
+  EXPECT_FALSE(check->Op()->Inputs().count("LossScaling"));
+  EXPECT_TRUE(FindOps(*graph, "update_loss_scaling").empty());
+  for (auto* node : graph->Nodes()) {
+    EXPECT_NE(node->Name(), kLossScalingVarName);
+  }
+}
+
+TEST(MixedPrecisionPass, deny_ops) {
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(BuildProgram()));
+  auto pass = PassRegistry::Instance().Get("mixed_precision_pass");
+  pass->Set(kMixedPrecisionDenyOps, new std::vector<std::string>({"mul"}));
+  graph = pass->Apply(std::move(graph));
+
+  auto* mul = FindOps(*graph, "mul").at(0);
+  EXPECT_EQ(mul->Op()->Input("X"), std::vector<std::string>({"x"}));
+  // Only the overflow flag is cast.
+  EXPECT_EQ(FindOps(*graph, "cast").size(), 1UL);
+}
+
+TEST(MixedPrecisionPass, skip_update) {
+  auto graph = ApplyPass(BuildOptimizerProgram(1.0f), true);
+
+  // adam and momentum skip the overflowed steps by themselves, so their
+  // learning rates are not scaled.
+  for (auto& type : {"adam", "momentum"}) {
+    auto* op = FindOps(*graph, type).at(0);
+    EXPECT_EQ(op->Op()->Input("SkipUpdate"),
+              std::vector<std::string>({"@FOUND_INFINITE@"}));
+    EXPECT_EQ(op->Op()->Input("LearningRate"),
+              std::vector<std::string>({"lr"}));
+    auto* found_inf = FindInput(op, "@FOUND_INFINITE@");
+    ASSERT_NE(found_inf, nullptr);
+    ASSERT_EQ(found_inf->inputs.size(), 1UL);
+    EXPECT_EQ(found_inf->inputs[0]->Op()->Type(), "check_finite_and_unscale");
+  }
+
+  // The beta powers are multiplied by beta + (1 - beta) * FoundInfinite.
+  auto muls = FindOps(*graph, "elementwise_mul");
+  ASSERT_EQ(muls.size(), 2UL);
+  std::vector<float> betas;
+  for (auto* mul : muls) {
+    auto x = mul->Op()->Input("X");
+    EXPECT_EQ(mul->Op()->Output("Out"), x);
+    EXPECT_TRUE(x[0] == "b1p" || x[0] == "b2p");
+    auto* factor = FindInput(mul, mul->Op()->Input("Y")[0]);
+    ASSERT_EQ(factor->inputs.size(), 1UL);
+    auto* factor_op = factor->inputs[0]->Op();
+    EXPECT_EQ(factor_op->Type(), "scale");
+    float beta = boost::get<float>(factor_op->GetAttr("bias"));
+    EXPECT_FLOAT_EQ(boost::get<float>(factor_op->GetAttr("scale")), 1 - beta);
+    betas.emplace_back(beta);
+  }
+  std::sort(betas.begin(), betas.end());
+  EXPECT_EQ(betas, std::vector<float>({0.9f, 0.999f}));
+  for (auto* scale : FindOps(*graph, "scale")) {
+    auto x = scale->Op()->Input("X");
+    EXPECT_TRUE(x[0] != "b1p" && x[0] != "b2p");
+  }
+}
+
+static void SetTensor(Scope* scope, const std::string& name,
+                      const std::vector<float>& values) {
+  auto* tensor = scope->Var(name)->GetMutable<LoDTensor>();
+  auto* data = tensor->mutable_data<float>(
+      make_ddim({static_cast<int64_t>(values.size())}), platform::CPUPlace());
+  std::copy(values.begin(), values.end(), data);
+}
+
+static std::vector<float> GetTensor(const Scope& scope,
+                                    const std::string& name) {
+  auto& tensor = scope.FindVar(name)->Get<LoDTensor>();
+  return std::vector<float>(tensor.data<float>(),
+                            tensor.data<float>() + tensor.numel());
+}
+
+// Run one step of BuildOptimizerProgram(grad) rewritten by the pass, and
+// return the persistable variables after it.
+static std::map<std::string, std::vector<float>> RunStep(float grad) {
+  auto graph = ApplyPass(BuildOptimizerProgram(grad), true);
+  Scope scope;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar() && !node->IsCtrlVar()) {
+      scope.Var(node->Name())->GetMutable<LoDTensor>();
+    }
+  }
+  SetTensor(&scope, "w", {1.0f, 2.0f});
+  SetTensor(&scope, "m1", {0.1f, 0.2f});
+  SetTensor(&scope, "m2", {0.3f, 0.4f});
+  SetTensor(&scope, "b1p", {0.9f});
+  SetTensor(&scope, "b2p", {0.999f});
+  SetTensor(&scope, "u", {1.0f, 2.0f});
+  SetTensor(&scope, "v", {0.5f, 0.5f});
+  SetTensor(&scope, "lr", {0.1f});
+  for (auto* node : TopologySortOperations(*graph)) {
+    OpRegistry::CreateOp(*node->Op())->Run(scope, platform::CPUPlace());
+  }
+  std::map<std::string, std::vector<float>> vars;
+  for (auto& name : {"w", "m1", "m2", "b1p", "b2p", "u", "v"}) {
+    vars[name] = GetTensor(scope, name);
+  }
+  return vars;
+}
+
+TEST(MixedPrecisionPass, run_overflowed_step) {
+  // Nothing changes in the overflowed step, including the moments, the
+  // velocity and the beta powers.
+  auto vars = RunStep(std::numeric_limits<float>::infinity());
+  EXPECT_EQ(vars["w"], std::vector<float>({1.0f, 2.0f}));
+  EXPECT_EQ(vars["m1"], std::vector<float>({0.1f, 0.2f}));
+  EXPECT_EQ(vars["m2"], std::vector<float>({0.3f, 0.4f}));
+  EXPECT_EQ(vars["b1p"], std::vector<float>({0.9f}));
+  EXPECT_EQ(vars["b2p"], std::vector<float>({0.999f}));
+  EXPECT_EQ(vars["u"], std::vector<float>({1.0f, 2.0f}));
+  EXPECT_EQ(vars["v"], std::vector<float>({0.5f, 0.5f}));
+
+  // The finite step updates all of them.
+  vars = RunStep(1.0f);
+  EXPECT_FLOAT_EQ(vars["m1"][0], 0.9f * 0.1f + 0.1f);
+  EXPECT_FLOAT_EQ(vars["m2"][0], 0.999f * 0.3f + 0.001f);
+  EXPECT_LT(vars["w"][0], 1.0f);
+  EXPECT_FLOAT_EQ(vars["b1p"][0], 0.9f * 0.9f);
+  EXPECT_FLOAT_EQ(vars["b2p"][0], 0.999f * 0.999f);
+  EXPECT_FLOAT_EQ(vars["v"][0], 0.9f * 0.5f + 1.0f);
+  EXPECT_FLOAT_EQ(vars["u"][0], 1.0f - 0.1f * (0.9f * 0.5f + 1.0f));
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(mixed_precision_pass);
+USE_OP(fill_constant);
+USE_OP(scale);
+USE_OP(cast);
+USE_OP(elementwise_mul);
+USE_OP(adam);
+USE_OP(momentum);
+USE_OP(scale_loss);
+USE_OP(check_finite_and_unscale);
+USE_OP(update_loss_scaling);
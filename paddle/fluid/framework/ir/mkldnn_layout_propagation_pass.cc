@@ -0,0 +1,168 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/mkldnn_layout_propagation_pass.h"
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/operator.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+// The ops whose MKL-DNN kernels take the data in any MKL-DNN layout, and
+// produce the output in the same layout.
+const std::unordered_set<std::string>& LayoutAgnosticOps() {
+  static std::unordered_set<std::string> ops(
+      {"relu", "tanh", "sqrt", "abs", "elementwise_add", "pool2d",
+       "batch_norm", "lrn", "concat"});
+  return ops;
+}
+
+bool UseMKLDNN(const OpDesc& op) {
+  return op.HasAttr("use_mkldnn") &&
+         boost::get<bool>(op.GetAttr("use_mkldnn"));
+}
+
+bool HasMKLDNNKernel(const std::string& op_type) {
+  auto& all_kernels = OperatorWithKernel::AllOpKernels();
+  auto it = all_kernels.find(op_type);
+  if (it == all_kernels.end()) return false;
+  for (auto& kernel : it->second) {
+    if (kernel.first.library_type_ == LibraryType::kMKLDNN) return true;
+  }
+  return false;
+}
+
+// The maximum flow from the source to the sink of the graph of the unit
+// capacities, which leaves the residual capacities in `capacity`.
+void MaxFlow(int source, int sink,
+             std::vector<std::unordered_map<int, int>>* capacity) {
+  auto& cap = *capacity;
+  while (true) {
+    std::vector<int> parent(cap.size(), -1);
+    parent[source] = source;
+    std::deque<int> queue({source});
+    while (!queue.empty() && parent[sink] < 0) {
+      int u = queue.front();
+      queue.pop_front();
+      for (auto& edge : cap[u]) {
+        if (edge.second > 0 && parent[edge.first] < 0) {
+          parent[edge.first] = u;
+          queue.push_back(edge.first);
+        }
+      }
+    }
+    if (parent[sink] < 0) return;
+    for (int v = sink; v != source; v = parent[v]) {
+      --cap[parent[v]][v];
+      ++cap[v][parent[v]];
+    }
+  }
+}
+
+}  // namespace
+
+std::unique_ptr<ir::Graph> MKLDNNLayoutPropagationPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  VLOG(3) << "Propagates the MKL-DNN layouts.";
+  // The source stands for the ops on MKL-DNN, the sink for the other fixed
+  // ops, the feeds and the fetches.
+  const int source = 0;
+  const int sink = 1;
+  std::unordered_map<Node*, int> candidates;
+  std::vector<Node*> candidate_nodes;
+  for (Node* n : graph->Nodes()) {
+    if (!n->IsOp() || n->Op() == nullptr) continue;
+    auto* op = n->Op();
+    bool has_attr =
+        op->HasAttr("use_mkldnn") || op->HasProtoAttr("use_mkldnn");
+    if (has_attr && !UseMKLDNN(*op) && LayoutAgnosticOps().count(op->Type()) &&
+        HasMKLDNNKernel(op->Type())) {
+      candidates.emplace(n, static_cast<int>(candidate_nodes.size()) + 2);
+      candidate_nodes.push_back(n);
+    }
+  }
+  if (candidates.empty()) return graph;
+
+  auto label = [&](Node* op) {
+    if (op == nullptr) return sink;
+    auto it = candidates.find(op);
+    if (it != candidates.end()) return it->second;
+    return op->Op() != nullptr && UseMKLDNN(*op->Op()) ? source : sink;
+  };
+
+  std::vector<std::unordered_map<int, int>> capacity(candidate_nodes.size() +
+                                                     2);
+  int boundaries = 0;
+  for (Node* n : graph->Nodes()) {
+    // The persistable inputs are reordered once by the MKL-DNN kernels.
+    if (!n->IsVar() || n->Var() == nullptr || n->Var()->Persistable()) {
+      continue;
+    }
+    int producer = label(n->inputs.empty() ? nullptr : n->inputs[0]);
+    std::vector<int> consumers;
+    for (Node* op : n->outputs) {
+      consumers.push_back(label(op));
+    }
+    if (consumers.empty()) consumers.push_back(sink);
+    for (int consumer : consumers) {
+      if (consumer == producer) continue;
+      ++capacity[producer][consumer];
+      ++capacity[consumer][producer];
+      if (producer < 2 && consumer < 2) ++boundaries;
+    }
+  }
+
+  MaxFlow(source, sink, &capacity);
+
+  // The ops reachable from the source in the residual graph are on its side
+  // of the minimum cut.
+  std::vector<bool> reachable(capacity.size(), false);
+  reachable[source] = true;
+  std::deque<int> queue({source});
+  while (!queue.empty()) {
+    int u = queue.front();
+    queue.pop_front();
+    for (auto& edge : capacity[u]) {
+      if (edge.second > 0 && !reachable[edge.first]) {
+        reachable[edge.first] = true;
+        queue.push_back(edge.first);
+      }
+    }
+  }
+  int switched = 0;
+  for (size_t i = 0; i < candidate_nodes.size(); ++i) {
+    if (reachable[i + 2]) {
+      candidate_nodes[i]->Op()->SetAttr("use_mkldnn", true);
+      ++switched;
+    }
+  }
+  VLOG(3) << "Switch " << switched << " of " << candidate_nodes.size()
+          << " layout-agnostic ops to MKL-DNN, " << boundaries
+          << " reorders between the fixed ops remain.";
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(mkldnn_layout_propagation_pass,
+              paddle::framework::ir::MKLDNNLayoutPropagationPass);
@@ -0,0 +1,44 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Run the layout-agnostic ops, e.g. the activations, the elementwise_add and
+ * the pool2d, with their MKL-DNN kernels where the data around them is in the
+ * MKL-DNN layouts, so the data is not reordered to NCHW and back.
+ *
+ * A reorder happens on every edge from an op to a consumer of its output in
+ * the other kind of layout, the feeds and the fetches are in NCHW. The ops
+ * placed on MKL-DNN and the other ops are fixed, the layout-agnostic ops with
+ * MKL-DNN kernels not placed on MKL-DNN are switched to it if that is in the
+ * minimum cut of the edges between the two kinds of the fixed ops, i.e. it
+ * leaves the fewest reorders. The ops are kept on the plain kernels in ties.
+ */
+class MKLDNNLayoutPropagationPass : public Pass {
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,102 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/mkldnn_layout_propagation_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/op_registry.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+class DummyMKLDNNKernel : public OpKernel<float> {
+ public:
+  void Compute(const ExecutionContext& ctx) const override {}
+};
+
+void SetOp(ProgramDesc* prog, const std::string& type, const std::string& name,
+           const std::vector<std::string>& inputs,
+           const std::vector<std::string>& outputs, bool use_mkldnn = false) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  op->SetAttr("use_mkldnn", use_mkldnn);
+  op->SetAttr("name", name);
+  op->SetInput("X", inputs);
+  op->SetOutput("Out", outputs);
+}
+
+// a->conv1 mkldnn->b->relu1->c->pool1->d->conv2 mkldnn->e->relu2->f
+// g->relu3->h
+// e->scale->i
+ProgramDesc BuildProgramDesc() {
+  ProgramDesc prog;
+  for (auto& v : std::vector<std::string>(
+           {"a", "b", "c", "d", "e", "f", "g", "h", "i", "w1", "w2"})) {
+    auto* var = prog.MutableBlock(0)->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    if (v == "w1" || v == "w2") {
+      var->SetPersistable(true);
+    }
+  }
+
+  SetOp(&prog, "conv2d", "conv1", {"a", "w1"}, {"b"}, true);
+  SetOp(&prog, "relu", "relu1", {"b"}, {"c"});
+  SetOp(&prog, "pool2d", "pool1", {"c"}, {"d"});
+  SetOp(&prog, "conv2d", "conv2", {"d", "w2"}, {"e"}, true);
+  // Between an MKL-DNN op and a fetch, it is a tie.
+  SetOp(&prog, "relu", "relu2", {"e"}, {"f"});
+  SetOp(&prog, "relu", "relu3", {"g"}, {"h"});
+  // No MKL-DNN kernel.
+  SetOp(&prog, "scale", "scale1", {"e"}, {"i"});
+
+  return prog;
+}
+
+TEST(MKLDNNLayoutPropagationPass, basic) {
+  auto prog = BuildProgramDesc();
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+
+  auto pass = PassRegistry::Instance().Get("mkldnn_layout_propagation_pass");
+  graph = pass->Apply(std::move(graph));
+
+  std::unordered_map<std::string, bool> use_mkldnn;
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp()) {
+      auto* op = node->Op();
+      use_mkldnn[boost::get<std::string>(op->GetAttr("name"))] =
+          boost::get<bool>(op->GetAttr("use_mkldnn"));
+    }
+  }
+
+  EXPECT_TRUE(use_mkldnn["conv1"]);
+  EXPECT_TRUE(use_mkldnn["relu1"]);
+  EXPECT_TRUE(use_mkldnn["pool1"]);
+  EXPECT_TRUE(use_mkldnn["conv2"]);
+  EXPECT_FALSE(use_mkldnn["relu2"]);
+  EXPECT_FALSE(use_mkldnn["relu3"]);
+  EXPECT_FALSE(use_mkldnn["scale1"]);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_OP_KERNEL(relu, MKLDNN, ::paddle::platform::CPUPlace,
+                   paddle::framework::ir::DummyMKLDNNKernel);
+REGISTER_OP_KERNEL(pool2d, MKLDNN, ::paddle::platform::CPUPlace,
+                   paddle::framework::ir::DummyMKLDNNKernel);
+
+USE_PASS(mkldnn_layout_propagation_pass);
@@ -0,0 +1,199 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/multihead_attention_fuse_pass.h"
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+// Whether the shape of reshape2 is given by the input tensor Shape.
+bool HasShapeTensor(Node* reshape) {
+  auto& inputs = reshape->Op()->Inputs();
+  auto it = inputs.find("Shape");
+  return it != inputs.end() && !it->second.empty();
+}
+
+// The number of heads if the reshape2 splits [B, S, H * D] into
+// [B, S, H, D], or -1.
+int GetHeadNumber(Node* reshape) {
+  if (HasShapeTensor(reshape)) return -1;
+  auto shape = boost::get<std::vector<int>>(reshape->Op()->GetAttr("shape"));
+  if (shape.size() != 4 || shape[0] != 0 || shape[1] != 0 || shape[2] <= 0) {
+    return -1;
+  }
+  return shape[2];
+}
+
+bool IsHeadsTranspose(Node* transpose) {
+  auto axis = boost::get<std::vector<int>>(transpose->Op()->GetAttr("axis"));
+  return axis == std::vector<int>({0, 2, 1, 3});
+}
+
+bool IsMatmul(Node* matmul, bool transpose_y) {
+  return !boost::get<bool>(matmul->Op()->GetAttr("transpose_X")) &&
+         boost::get<bool>(matmul->Op()->GetAttr("transpose_Y")) == transpose_y;
+}
+
+}  // namespace
+
+int MultiHeadAttentionFusePass::BuildFusion(Graph* graph, bool with_scale,
+                                            bool with_bias_qk,
+                                            bool with_dropout) const {
+  GraphPatternDetector gpd;
+  auto* pattern = gpd.mutable_pattern();
+  auto* q = pattern->NewNode(name_scope_ + "/q");
+  auto* k = pattern->NewNode(name_scope_ + "/k");
+  auto* v = pattern->NewNode(name_scope_ + "/v");
+  patterns::MultiHeadAttention mha_pattern(pattern, name_scope_);
+  mha_pattern(q, k, v, with_scale, with_bias_qk, with_dropout);
+
+  int fusion_count = 0;
+  auto handler = [&](const GraphPatternDetector::subgraph_t& subgraph,
+                     Graph* g) {
+    VLOG(4) << "handle MultiHeadAttention fuse";
+    GET_IR_NODE_FROM_SUBGRAPH(reshape_q, reshape_q, mha_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(transpose_q, transpose_q, mha_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(reshape_k, reshape_k, mha_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(transpose_k, transpose_k, mha_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(reshape_v, reshape_v, mha_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(transpose_v, transpose_v, mha_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(matmul_qk, matmul_qk, mha_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(matmul_qkv, matmul_qkv, mha_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(transpose_qkv, transpose_qkv, mha_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(reshape_qkv, reshape_qkv, mha_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(reshape_qkv_out, reshape_qkv_out, mha_pattern);
+    Node* scale_q = with_scale ? subgraph.at(mha_pattern.scale_q_n()) : nullptr;
+    Node* bias_qk =
+        with_bias_qk ? subgraph.at(mha_pattern.bias_qk_n()) : nullptr;
+    Node* dropout_qk =
+        with_dropout ? subgraph.at(mha_pattern.dropout_qk_n()) : nullptr;
+    Node* q_var = subgraph.at(q);
+    Node* k_var = subgraph.at(k);
+    Node* v_var = subgraph.at(v);
+
+    // Check that the ops split and combine the same heads.
+    int head_number = GetHeadNumber(reshape_q);
+    if (head_number <= 0 || GetHeadNumber(reshape_k) != head_number ||
+        GetHeadNumber(reshape_v) != head_number) {
+      return;
+    }
+    for (auto* transpose : {transpose_q, transpose_k, transpose_v,
+                            transpose_qkv}) {
+      if (!IsHeadsTranspose(transpose)) return;
+    }
+    if (HasShapeTensor(reshape_qkv)) return;
+    auto out_shape =
+        boost::get<std::vector<int>>(reshape_qkv->Op()->GetAttr("shape"));
+    if (out_shape.size() != 3 || out_shape[0] != 0 || out_shape[1] != 0) {
+      return;
+    }
+    if (!IsMatmul(matmul_qk, true) || !IsMatmul(matmul_qkv, false)) return;
+
+    float alpha = boost::get<float>(matmul_qk->Op()->GetAttr("alpha"));
+    float out_scale = boost::get<float>(matmul_qkv->Op()->GetAttr("alpha"));
+    if (scale_q) {
+      if (boost::get<float>(scale_q->Op()->GetAttr("bias")) != 0.f) return;
+      alpha *= boost::get<float>(scale_q->Op()->GetAttr("scale"));
+    }
+    if (bias_qk) {
+      auto* desc = bias_qk->Var();
+      if (!desc || desc->GetShape().size() != 4) return;
+    }
+    if (dropout_qk) {
+      auto* op = dropout_qk->Op();
+      if (!boost::get<bool>(op->GetAttr("is_test"))) return;
+      if (boost::get<std::string>(op->GetAttr("dropout_implementation")) ==
+          "downgrade_in_infer") {
+        out_scale *= 1.f - boost::get<float>(op->GetAttr("dropout_prob"));
+      }
+    }
+
+    std::unordered_set<const Node*> marked_nodes;
+    for (auto& item : subgraph) {
+      marked_nodes.insert(item.second);
+    }
+    for (auto* io : {q_var, k_var, v_var, bias_qk, reshape_qkv_out}) {
+      marked_nodes.erase(io);
+    }
+    // The XShape of reshape2 and transpose2 and the Mask of dropout are only
+    // used in training, and are removed with the ops.
+    std::vector<const Node*> extra_outputs;
+    for (auto* node : marked_nodes) {
+      if (!node->IsOp()) continue;
+      for (auto* out : node->outputs) {
+        if (marked_nodes.count(out) || out == reshape_qkv_out) continue;
+        if (!out->outputs.empty()) return;
+        extra_outputs.push_back(out);
+      }
+    }
+    marked_nodes.insert(extra_outputs.begin(), extra_outputs.end());
+
+    OpDesc desc;
+    desc.SetType("fused_multihead_attention");
+    desc.SetInput("Q", {q_var->Name()});
+    desc.SetInput("K", {k_var->Name()});
+    desc.SetInput("V", {v_var->Name()});
+    if (bias_qk) {
+      desc.SetInput("BiasQK", {bias_qk->Name()});
+    }
+    desc.SetOutput("Out", {reshape_qkv_out->Name()});
+    desc.SetAttr("head_number", head_number);
+    desc.SetAttr("alpha", alpha);
+    desc.SetAttr("out_scale", out_scale);
+    auto* fused_op = g->CreateOpNode(&desc);
+
+    IR_NODE_LINK_TO(q_var, fused_op);
+    IR_NODE_LINK_TO(k_var, fused_op);
+    IR_NODE_LINK_TO(v_var, fused_op);
+    if (bias_qk) {
+      IR_NODE_LINK_TO(bias_qk, fused_op);
+    }
+    IR_NODE_LINK_TO(fused_op, reshape_qkv_out);
+
+    GraphSafeRemoveNodes(g, marked_nodes);
+    ++fusion_count;
+  };
+
+  gpd(graph, handler);
+  return fusion_count;
+}
+
+std::unique_ptr<ir::Graph> MultiHeadAttentionFusePass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  FusePassBase::Init(name_scope_, graph.get());
+  int fusion_count = 0;
+  for (bool with_scale : {true, false}) {
+    for (bool with_bias_qk : {true, false}) {
+      for (bool with_dropout : {true, false}) {
+        fusion_count += BuildFusion(graph.get(), with_scale, with_bias_qk,
+                                    with_dropout);
+      }
+    }
+  }
+  AddStatis(fusion_count);
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(multihead_attention_fuse_pass,
+              paddle::framework::ir::MultiHeadAttentionFusePass);
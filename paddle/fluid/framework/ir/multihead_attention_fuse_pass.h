@@ -0,0 +1,77 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Fuse the scaled dot-product attention block of Transformer into a
+ * fused_multihead_attention op.
+ *
+ * Before fuse:
+ *       q                   k                 v
+ *       |                   |                 |
+ *   reshape2            reshape2          reshape2
+ *       |                   |                 |
+ *  transpose2          transpose2        transpose2
+ *       |                   |                 |
+ *   (scale)                 |                 |
+ *        \                 /                  |
+ *   matmul(transpose_Y=true)                  |
+ *              |                              |
+ *    (elementwise_add bias_qk)                |
+ *              |                              |
+ *           softmax                           |
+ *              |                              |
+ *          (dropout)                          |
+ *                \                           /
+ *                          matmul
+ *                            |
+ *                       transpose2
+ *                            |
+ *                        reshape2
+ *
+ * After fuse:
+ *    q   k   v  (bias_qk)
+ *     \  |  /  /
+ *  fused_multihead_attention
+ *            |
+ */
+class MultiHeadAttentionFusePass : public FusePassBase {
+ public:
+  virtual ~MultiHeadAttentionFusePass() {}
+
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+
+ private:
+  int BuildFusion(Graph* graph, bool with_scale, bool with_bias_qk,
+                  bool with_dropout) const;
+
+  const std::string name_scope_{"multihead_attention_fuse"};
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
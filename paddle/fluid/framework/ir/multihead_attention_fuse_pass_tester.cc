@@ -0,0 +1,167 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/multihead_attention_fuse_pass.h"
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void SetOp(ProgramDesc* prog, const std::string& type,
+           const std::vector<std::string>& inputs,
+           const std::vector<std::string>& outputs) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  if (type == "matmul" || type == "elementwise_add") {
+    op->SetInput("X", {inputs[0]});
+    op->SetInput("Y", {inputs[1]});
+  } else {
+    op->SetInput("X", inputs);
+  }
+  op->SetOutput("Out", {outputs[0]});
+  if (type == "reshape2" || type == "transpose2") {
+    op->SetOutput("XShape", {outputs[1]});
+  } else if (type == "dropout") {
+    op->SetOutput("Mask", {outputs[1]});
+  }
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(OpRole::kForward));
+}
+
+OpDesc* LastOp(ProgramDesc* prog) {
+  auto* block = prog->MutableBlock(0);
+  return block->Op(static_cast<int>(block->OpSize()) - 1);
+}
+
+// Build the attention block of Transformer with 8 heads of size 64.
+ProgramDesc BuildProgramDesc(bool with_scale, bool with_bias_qk,
+                             bool with_dropout) {
+  ProgramDesc prog;
+  auto* block = prog.MutableBlock(0);
+  for (auto& v : std::vector<std::string>(
+           {"q", "k", "v", "bias_qk", "reshape_q", "reshape_k", "reshape_v",
+            "transpose_q", "transpose_k", "transpose_v", "scale_q", "qk",
+            "eltadd_qk", "softmax_qk", "dropout_qk", "dropout_mask", "qkv",
+            "transpose_qkv", "out", "xshape_q", "xshape_k", "xshape_v",
+            "xshape_tq", "xshape_tk", "xshape_tv", "xshape_tqkv",
+            "xshape_qkv"})) {
+    auto* var = block->Var(v);
+    var->SetType(proto::VarType::LOD_TENSOR);
+  }
+  block->Var("bias_qk")->SetShape({-1, 8, 16, 16});
+
+  for (auto& x : std::vector<std::string>({"q", "k", "v"})) {
+    SetOp(&prog, "reshape2", {x}, {"reshape_" + x, "xshape_" + x});
+    LastOp(&prog)->SetAttr("shape", std::vector<int>({0, 0, 8, 64}));
+    SetOp(&prog, "transpose2", {"reshape_" + x},
+          {"transpose_" + x, "xshape_t" + x});
+    LastOp(&prog)->SetAttr("axis", std::vector<int>({0, 2, 1, 3}));
+  }
+
+  std::string q_out = "transpose_q";
+  if (with_scale) {
+    SetOp(&prog, "scale", {q_out}, {"scale_q"});
+    LastOp(&prog)->SetAttr("scale", 0.125f);
+    LastOp(&prog)->SetAttr("bias", 0.f);
+    q_out = "scale_q";
+  }
+  SetOp(&prog, "matmul", {q_out, "transpose_k"}, {"qk"});
+  LastOp(&prog)->SetAttr("transpose_X", false);
+  LastOp(&prog)->SetAttr("transpose_Y", true);
+  LastOp(&prog)->SetAttr("alpha", with_scale ? 1.f : 0.125f);
+
+  std::string qk_out = "qk";
+  if (with_bias_qk) {
+    SetOp(&prog, "elementwise_add", {qk_out, "bias_qk"}, {"eltadd_qk"});
+    qk_out = "eltadd_qk";
+  }
+  SetOp(&prog, "softmax", {qk_out}, {"softmax_qk"});
+  qk_out = "softmax_qk";
+  if (with_dropout) {
+    SetOp(&prog, "dropout", {qk_out}, {"dropout_qk", "dropout_mask"});
+    LastOp(&prog)->SetAttr("is_test", true);
+    LastOp(&prog)->SetAttr("dropout_prob", 0.1f);
+    LastOp(&prog)->SetAttr("dropout_implementation",
+                           std::string("downgrade_in_infer"));
+    qk_out = "dropout_qk";
+  }
+  SetOp(&prog, "matmul", {qk_out, "transpose_v"}, {"qkv"});
+  LastOp(&prog)->SetAttr("transpose_X", false);
+  LastOp(&prog)->SetAttr("transpose_Y", false);
+  LastOp(&prog)->SetAttr("alpha", 1.f);
+
+  SetOp(&prog, "transpose2", {"qkv"}, {"transpose_qkv", "xshape_tqkv"});
+  LastOp(&prog)->SetAttr("axis", std::vector<int>({0, 2, 1, 3}));
+  SetOp(&prog, "reshape2", {"transpose_qkv"}, {"out", "xshape_qkv"});
+  LastOp(&prog)->SetAttr("shape", std::vector<int>({0, 0, 512}));
+  return prog;
+}
+
+void TestFuse(bool with_scale, bool with_bias_qk, bool with_dropout) {
+  auto prog = BuildProgramDesc(with_scale, with_bias_qk, with_dropout);
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  auto pass = PassRegistry::Instance().Get("multihead_attention_fuse_pass");
+  graph = pass->Apply(std::move(graph));
+
+  // Only q, k, v, (bias_qk,) out and the fused op are left.
+  int num_nodes = with_bias_qk ? 6 : 5;
+  EXPECT_EQ(graph->Nodes().size(), static_cast<size_t>(num_nodes));
+  int num_fused = 0;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    ASSERT_EQ(node->Op()->Type(), "fused_multihead_attention");
+    ++num_fused;
+    auto* op = node->Op();
+    EXPECT_EQ(op->Input("Q"), std::vector<std::string>({"q"}));
+    EXPECT_EQ(op->Input("K"), std::vector<std::string>({"k"}));
+    EXPECT_EQ(op->Input("V"), std::vector<std::string>({"v"}));
+    EXPECT_EQ(op->Output("Out"), std::vector<std::string>({"out"}));
+    EXPECT_EQ(op->Inputs().count("BiasQK"), with_bias_qk ? 1UL : 0UL);
+    EXPECT_EQ(boost::get<int>(op->GetAttr("head_number")), 8);
+    EXPECT_FLOAT_EQ(boost::get<float>(op->GetAttr("alpha")), 0.125f);
+    EXPECT_FLOAT_EQ(boost::get<float>(op->GetAttr("out_scale")),
+                    with_dropout ? 0.9f : 1.f);
+  }
+  EXPECT_EQ(num_fused, 1);
+}
+
+TEST(MultiHeadAttentionFusePass, basic) {
+  for (bool with_scale : {true, false}) {
+    for (bool with_bias_qk : {true, false}) {
+      for (bool with_dropout : {true, false}) {
+        TestFuse(with_scale, with_bias_qk, with_dropout);
+      }
+    }
+  }
+}
+
+TEST(MultiHeadAttentionFusePass, mismatched_heads) {
+  auto prog = BuildProgramDesc(true, true, true);
+  // v is split into 4 heads.
+  prog.MutableBlock(0)->Op(4)->SetAttr("shape",
+                                      std::vector<int>({0, 0, 4, 32}));
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  int before = graph->Nodes().size();
+  auto pass = PassRegistry::Instance().Get("multihead_attention_fuse_pass");
+  graph = pass->Apply(std::move(graph));
+  EXPECT_EQ(static_cast<int>(graph->Nodes().size()), before);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(multihead_attention_fuse_pass);
@@ -0,0 +1,240 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+
+#include "paddle/fluid/framework/ir/recompute_pass.h"
+#include <algorithm>
+#include <memory>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static constexpr char kRecomputeSuffix[] = "@RECOMPUTE";
+
+static int GetOpRole(ir::Node* op) {
+  auto* desc = op->Op();
+  auto role_attr = OpProtoAndCheckerMaker::OpRoleAttrName();
+  if (desc == nullptr || !desc->HasAttr(role_attr)) {
+    return static_cast<int>(OpRole::kNotSpecified);
+  }
+  return boost::get<int>(desc->GetAttr(role_attr));
+}
+
+static bool IsForwardOp(ir::Node* op) {
+  int role = GetOpRole(op);
+  return role == static_cast<int>(OpRole::kForward) ||
+         role == (static_cast<int>(OpRole::kForward) |
+                  static_cast<int>(OpRole::kLoss));
+}
+
+static bool IsBackwardOp(ir::Node* op) {
+  return op->Op() != nullptr &&
+         (GetOpRole(op) & static_cast<int>(OpRole::kBackward));
+}
+
+static void AddDependency(ir::Graph* graph, ir::Node* from, ir::Node* to) {
+  auto* dep_var = graph->CreateControlDepVar();
+  from->outputs.emplace_back(dep_var);
+  dep_var->inputs.emplace_back(from);
+  dep_var->outputs.emplace_back(to);
+  to->inputs.emplace_back(dep_var);
+}
+
+// The writer of the version of var after the one read by the ops, or nullptr.
+static ir::Node* NextWriter(const std::vector<ir::Node*>& versions,
+                            ir::Node* var) {
+  auto it = std::find(versions.begin(), versions.end(), var);
+  if (it == versions.end() || ++it == versions.end()) return nullptr;
+  return (*it)->inputs.empty() ? nullptr : (*it)->inputs[0];
+}
+
+static bool CanRecomputeOp(const std::unordered_map<
+                               std::string, std::vector<ir::Node*>>& var_nodes,
+                           ir::Node* op) {
+  if (op->Op() == nullptr || !IsForwardOp(op)) return false;
+  auto* desc = op->Op();
+  static const std::unordered_set<std::string> kStatefulOps{"feed", "fetch",
+                                                            "read", "print"};
+  if (kStatefulOps.count(desc->Type())) return false;
+  // The random ops generate different results when they run again.
+  if (desc->HasAttr("seed")) return false;
+  for (auto& attr : desc->GetAttrMap()) {
+    if (attr.second.type() == typeid(BlockDesc*) ||             // NOLINT
+        attr.second.type() == typeid(std::vector<BlockDesc*>))  // NOLINT
+      return false;
+  }
+  // The inputs must keep their values until the backward pass ends, e.g.,
+  // the running mean of batch_norm is updated in place in the forward pass.
+  for (auto* in : op->inputs) {
+    if (in->IsCtrlVar()) continue;
+    auto* writer = NextWriter(var_nodes.at(in->Name()), in);
+    if (writer != nullptr && (IsForwardOp(writer) || IsBackwardOp(writer))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool RecomputePass::NeedRecompute(const Context& ctx, ir::Node* var) const {
+  if (!var->IsVar() || var->IsCtrlVar() || var->Var() == nullptr) return false;
+  auto* desc = var->Var();
+  if (desc->Persistable() || desc->GetType() != proto::VarType::LOD_TENSOR) {
+    return false;
+  }
+  if (ctx.checkpoints.count(var->Name())) return false;
+  if (var->inputs.size() != 1) return false;
+  return CanRecomputeOp(ctx.var_nodes, var->inputs[0]);
+}
+
+ir::Node* RecomputePass::Recompute(
+    Context* ctx, ir::Node* var, const std::vector<ir::Node*>& triggers) const {
+  auto var_it = ctx->recomputed_vars.find(var);
+  if (var_it != ctx->recomputed_vars.end()) return var_it->second;
+
+  auto* graph = ctx->graph;
+  auto* op = var->inputs[0];
+  PADDLE_ENFORCE(ctx->recomputed_ops.count(op) == 0,
+                 "The outputs of %s have been recomputed", op->Name());
+
+  OpDesc desc(*op->Op(), op->Op()->Block());
+  desc.SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+               static_cast<int>(OpRole::kBackward));
+
+  std::vector<ir::Node*> inputs;
+  for (auto* in : op->inputs) {
+    if (in->IsCtrlVar()) continue;
+    if (NeedRecompute(*ctx, in)) {
+      auto* recomputed_in = Recompute(ctx, in, triggers);
+      desc.RenameInput(in->Name(), recomputed_in->Name());
+      inputs.emplace_back(recomputed_in);
+    } else {
+      inputs.emplace_back(in);
+    }
+  }
+
+  // All the outputs are renamed, so that the persistable outputs, e.g., the
+  // running mean of batch_norm, are not updated twice.
+  std::vector<std::pair<ir::Node*, ir::Node*>> outputs;
+  for (auto* out : op->outputs) {
+    if (out->IsCtrlVar()) continue;
+    std::string name = out->Name() + kRecomputeSuffix;
+    desc.RenameOutput(out->Name(), name);
+    ir::Node* new_out = nullptr;
+    if (out->Var() != nullptr) {
+      VarDesc var_desc(*out->Var());
+      var_desc.SetName(name);
+      var_desc.SetPersistable(false);
+      new_out = graph->CreateVarNode(&var_desc);
+    } else {
+      new_out = graph->CreateEmptyNode(name, ir::Node::Type::kVariable);
+    }
+    outputs.emplace_back(out, new_out);
+  }
+  desc.Flush();
+
+  auto* new_op = graph->CreateOpNode(&desc);
+  for (auto* in : inputs) {
+    new_op->inputs.emplace_back(in);
+    in->outputs.emplace_back(new_op);
+    // Write after read, e.g., an optimizer op updating the parameter.
+    auto* writer = NextWriter(ctx->var_nodes.at(in->Name()), in);
+    if (writer != nullptr) AddDependency(graph, new_op, writer);
+  }
+  for (auto& pair : outputs) {
+    new_op->outputs.emplace_back(pair.second);
+    pair.second->inputs.emplace_back(new_op);
+    ctx->recomputed_vars.emplace(pair.first, pair.second);
+  }
+  for (auto* trigger : triggers) {
+    AddDependency(graph, trigger, new_op);
+  }
+  ctx->recomputed_ops.emplace(op, new_op);
+  return ctx->recomputed_vars.at(var);
+}
+
+std::unique_ptr<ir::Graph> RecomputePass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  auto& checkpoints =
+      Get<const std::vector<std::string>>(kRecomputeCheckpoints);
+  if (checkpoints.empty()) {
+    LOG(WARNING) << "No checkpoint is given, skip recompute_pass.";
+    return graph;
+  }
+
+  Context ctx;
+  ctx.graph = graph.get();
+  ctx.checkpoints.insert(checkpoints.begin(), checkpoints.end());
+
+  auto ops = TopologySortOperations(*graph);
+  std::unordered_set<ir::Node*> visited;
+  std::vector<ir::Node*> backward_ops;
+  for (auto* op : ops) {
+    for (auto* nodes : {&op->inputs, &op->outputs}) {
+      for (auto* node : *nodes) {
+        if (node->IsVar() && visited.insert(node).second) {
+          ctx.var_nodes[node->Name()].emplace_back(node);
+        }
+      }
+    }
+    if (IsBackwardOp(op)) backward_ops.emplace_back(op);
+  }
+
+  // The backward ops are visited in the topological order, so the ops
+  // recomputing a var are triggered by the first backward op reading it.
+  for (auto* op : backward_ops) {
+    std::vector<ir::Node*> triggers;
+    for (auto* in : op->inputs) {
+      if (in->inputs.empty()) continue;
+      auto* prev_op = in->inputs[0];
+      if (IsBackwardOp(prev_op) &&
+          std::find(triggers.begin(), triggers.end(), prev_op) ==
+              triggers.end()) {
+        triggers.emplace_back(prev_op);
+      }
+    }
+
+    std::vector<std::pair<ir::Node*, ir::Node*>> replaced;
+    std::unordered_set<ir::Node*> visited_inputs;
+    for (auto* in : op->inputs) {
+      if (!visited_inputs.insert(in).second) continue;
+      if (NeedRecompute(ctx, in)) {
+        replaced.emplace_back(in, Recompute(&ctx, in, triggers));
+      }
+    }
+    for (auto& pair : replaced) {
+      auto* in = pair.first;
+      auto* recomputed_in = pair.second;
+      op->Op()->RenameInput(in->Name(), recomputed_in->Name());
+      std::replace(op->inputs.begin(), op->inputs.end(), in, recomputed_in);
+      in->outputs.erase(std::remove(in->outputs.begin(), in->outputs.end(), op),
+                        in->outputs.end());
+      recomputed_in->outputs.emplace_back(op);
+    }
+    if (!replaced.empty()) op->Op()->Flush();
+  }
+
+  VLOG(3) << "recompute_pass recomputes " << ctx.recomputed_vars.size()
+          << " vars by " << ctx.recomputed_ops.size() << " ops";
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(recompute_pass, paddle::framework::ir::RecomputePass)
+    .RequirePassAttr(paddle::framework::ir::kRecomputeCheckpoints);
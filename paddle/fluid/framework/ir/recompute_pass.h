@@ -0,0 +1,79 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+// The names of the checkpoint variables, const std::vector<std::string>.
+constexpr char kRecomputeCheckpoints[] = "recompute_checkpoints";
+
+/*
+ * Recompute the forward activations between the checkpoints in the backward
+ * pass, instead of keeping them alive from the forward pass.
+ *
+ * Each non-persistable forward variable, except the checkpoints and the
+ * outputs of the non-deterministic ops, which is read by a backward op is
+ * replaced by a recomputed one, named var@RECOMPUTE. It is computed by a copy
+ * of its forward op, whose inputs are recomputed recursively until the
+ * checkpoints, the parameters or the fed variables are reached. So the
+ * original activations are not used by the backward ops any more, and can be
+ * freed by the eager deletion or reused by memory_optimize as soon as the
+ * forward ops finish.
+ *
+ * A copied op depends on the backward ops which generate the gradients read
+ * by the first backward op using it, so that it runs when the backward pass
+ * reaches there, instead of at the beginning.
+ *
+ * The pass should be applied to the graph before multi_devices_pass.
+ */
+class RecomputePass : public Pass {
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+
+ private:
+  using VarNodeMap = std::unordered_map<std::string, std::vector<ir::Node*>>;
+
+  struct Context {
+    ir::Graph* graph;
+    std::unordered_set<std::string> checkpoints;
+    // The versions of each variable in the order they are written.
+    VarNodeMap var_nodes;
+    // Forward op -> its copy; forward var -> the recomputed var.
+    std::unordered_map<ir::Node*, ir::Node*> recomputed_ops;
+    std::unordered_map<ir::Node*, ir::Node*> recomputed_vars;
+  };
+
+  bool NeedRecompute(const Context& ctx, ir::Node* var) const;
+
+  // Return the recomputed var of var, and create the ops computing it if
+  // they are not created yet. The new ops depend on the triggers.
+  ir::Node* Recompute(Context* ctx, ir::Node* var,
+                      const std::vector<ir::Node*>& triggers) const;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
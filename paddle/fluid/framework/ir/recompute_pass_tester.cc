@@ -0,0 +1,152 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "paddle/fluid/framework/ir/recompute_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/op_proto_maker.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/program_desc.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+class NOP : public OperatorBase {
+ public:
+  NOP(const std::string& type, const VariableNameMap& inputs,
+      const VariableNameMap& outputs, const AttributeMap& attrs)
+      : OperatorBase(type, inputs, outputs, attrs) {}
+
+ private:
+  void RunImpl(const Scope& scope,
+               const platform::Place& place) const override {}
+};
+
+class NOPMaker : public OpProtoAndCheckerMaker {
+ public:
+  void Make() {
+    AddInput("X", "").AsDuplicable();
+    AddOutput("Out", "").AsDuplicable();
+    AddComment("");
+  }
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_OPERATOR(recompute_test_op, paddle::framework::ir::NOP,
+                  paddle::framework::ir::NOPMaker);
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static void SetOp(ProgramDesc* prog, OpRole role,
+                  const std::vector<std::string>& inputs,
+                  const std::vector<std::string>& outputs) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType("recompute_test_op");
+  op->SetInput("X", inputs);
+  op->SetOutput("Out", outputs);
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(role));
+}
+
+static ir::Node* FindOpByOutput(const ir::Graph& graph,
+                                const std::string& output) {
+  for (auto* node : graph.Nodes()) {
+    if (node->IsOp() && node->Op()->Output("Out").at(0) == output) {
+      return node;
+    }
+  }
+  return nullptr;
+}
+
+static bool DependsOn(ir::Node* op, ir::Node* prev_op) {
+  for (auto* in : op->inputs) {
+    if (!in->inputs.empty() && in->inputs[0] == prev_op) return true;
+  }
+  return false;
+}
+
+// forward:  a->b, b->c, c->d, d->e
+// backward: ->e@GRAD, (d, e@GRAD)->d@GRAD, (c, d@GRAD)->c@GRAD,
+//           (b, c@GRAD)->b@GRAD
+// c is the checkpoint.
+TEST(RecomputePass, basic) {
+  ProgramDesc prog;
+  for (auto& name : std::vector<std::string>(
+           {"a", "b", "c", "d", "e", "b@GRAD", "c@GRAD", "d@GRAD", "e@GRAD"})) {
+    auto* var = prog.MutableBlock(0)->Var(name);
+    var->SetType(proto::VarType::LOD_TENSOR);
+  }
+  SetOp(&prog, OpRole::kForward, {"a"}, {"b"});
+  SetOp(&prog, OpRole::kForward, {"b"}, {"c"});
+  SetOp(&prog, OpRole::kForward, {"c"}, {"d"});
+  SetOp(&prog, OpRole::kForward, {"d"}, {"e"});
+  SetOp(&prog, OpRole::kBackward, {}, {"e@GRAD"});
+  SetOp(&prog, OpRole::kBackward, {"d", "e@GRAD"}, {"d@GRAD"});
+  SetOp(&prog, OpRole::kBackward, {"c", "d@GRAD"}, {"c@GRAD"});
+  SetOp(&prog, OpRole::kBackward, {"b", "c@GRAD"}, {"b@GRAD"});
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(prog));
+  auto pass = PassRegistry::Instance().Get("recompute_pass");
+  pass->Set(kRecomputeCheckpoints, new std::vector<std::string>({"c"}));
+  graph = pass->Apply(std::move(graph));
+
+  auto* d_grad_op = FindOpByOutput(*graph, "d@GRAD");
+  auto* c_grad_op = FindOpByOutput(*graph, "c@GRAD");
+  auto* b_grad_op = FindOpByOutput(*graph, "b@GRAD");
+  ASSERT_EQ(d_grad_op->Op()->Input("X"),
+            std::vector<std::string>({"d@RECOMPUTE", "e@GRAD"}));
+  ASSERT_EQ(c_grad_op->Op()->Input("X"),
+            std::vector<std::string>({"c", "d@GRAD"}));
+  ASSERT_EQ(b_grad_op->Op()->Input("X"),
+            std::vector<std::string>({"b@RECOMPUTE", "c@GRAD"}));
+
+  // d is recomputed from the checkpoint c after e@GRAD is generated.
+  auto* d_op = FindOpByOutput(*graph, "d@RECOMPUTE");
+  ASSERT_NE(d_op, nullptr);
+  ASSERT_EQ(d_op->Op()->Input("X"), std::vector<std::string>({"c"}));
+  ASSERT_TRUE(DependsOn(d_op, FindOpByOutput(*graph, "e@GRAD")));
+
+  // b is recomputed from a after c@GRAD is generated.
+  auto* b_op = FindOpByOutput(*graph, "b@RECOMPUTE");
+  ASSERT_NE(b_op, nullptr);
+  ASSERT_EQ(b_op->Op()->Input("X"), std::vector<std::string>({"a"}));
+  ASSERT_TRUE(DependsOn(b_op, c_grad_op));
+
+  // The checkpoint is not recomputed, and the original activations are not
+  // read by the backward ops.
+  ASSERT_EQ(FindOpByOutput(*graph, "c@RECOMPUTE"), nullptr);
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar() && (node->Name() == "b" || node->Name() == "d")) {
+      for (auto* op : node->outputs) {
+        ASSERT_EQ(boost::get<int>(op->Op()->GetAttr(
+                      OpProtoAndCheckerMaker::OpRoleAttrName())),
+                  static_cast<int>(OpRole::kForward));
+      }
+    }
+  }
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(recompute_pass);
@@ -0,0 +1,162 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/sparse_weight_pass.h"
+#include <algorithm>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/operators/math/sparse_matmul.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+Node* FindVar(const std::vector<Node*>& nodes, const std::string& name) {
+  for (auto* node : nodes) {
+    if (node->IsVar() && node->Name() == name) return node;
+  }
+  return nullptr;
+}
+
+// The name of the weight of an fc or a mul, and the in_num_col_dims of the
+// sparse_fc, or an empty name if the op is not replaceable.
+std::string WeightOf(Node* op, int* in_num_col_dims) {
+  auto* desc = op->Op();
+  if (desc->Type() == "fc") {
+    *in_num_col_dims = boost::get<int>(desc->GetAttr("in_num_col_dims"));
+    return desc->Input("W")[0];
+  }
+  if (desc->Type() == "mul" &&
+      boost::get<int>(desc->GetAttr("y_num_col_dims")) == 1) {
+    *in_num_col_dims = boost::get<int>(desc->GetAttr("x_num_col_dims"));
+    return desc->Input("Y")[0];
+  }
+  return "";
+}
+
+Node* CreatePersistableVar(Graph* graph, Scope* scope, const std::string& name,
+                           const Tensor& value) {
+  VarDesc desc(name);
+  desc.SetType(proto::VarType::LOD_TENSOR);
+  desc.SetDataType(value.type());
+  desc.SetShape(vectorize(value.dims()));
+  desc.SetPersistable(true);
+  TensorCopySync(value, platform::CPUPlace(),
+                 scope->Var(name)->GetMutable<LoDTensor>());
+  return graph->CreateVarNode(&desc);
+}
+
+}  // namespace
+
+std::unique_ptr<ir::Graph> SparseWeightPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  FusePassBase::Init(name_scope_, graph.get());
+  auto* scope = param_scope();
+  float min_sparsity = Has("min_sparsity") ? Get<float>("min_sparsity") : 0.8f;
+
+  int num_replaced = 0;
+  for (auto* op : TopologySortOperations(*graph)) {
+    int in_num_col_dims = 1;
+    auto w_name = WeightOf(op, &in_num_col_dims);
+    if (w_name.empty()) continue;
+    auto* w = FindVar(op->inputs, w_name);
+    auto* w_var = scope->FindVar(w_name);
+    if (w == nullptr || !w->Var()->Persistable() || w_var == nullptr) {
+      continue;
+    }
+    auto& w_tensor = w_var->Get<LoDTensor>();
+    if (w_tensor.type() != proto::VarType::FP32 ||
+        w_tensor.dims().size() != 2) {
+      continue;
+    }
+    int K = w_tensor.dims()[0];
+    int N = w_tensor.dims()[1];
+    const float* w_data = w_tensor.data<float>();
+    int64_t zeros = std::count(w_data, w_data + w_tensor.numel(), 0.f);
+    if (zeros < min_sparsity * w_tensor.numel()) continue;
+
+    std::vector<int> offsets, indices;
+    std::vector<float> values;
+    operators::math::DenseToCSC(w_data, K, N, &offsets, &indices, &values);
+    Tensor offsets_tensor, indices_tensor, values_tensor;
+    TensorFromVector(offsets, &offsets_tensor);
+    TensorFromVector(indices, &indices_tensor);
+    TensorFromVector(values, &values_tensor);
+    auto* offsets_node = CreatePersistableVar(
+        graph.get(), scope, w_name + ".csc_offsets", offsets_tensor);
+    auto* indices_node = CreatePersistableVar(
+        graph.get(), scope, w_name + ".csc_indices", indices_tensor);
+    auto* values_node = CreatePersistableVar(
+        graph.get(), scope, w_name + ".csc_values", values_tensor);
+
+    auto* desc = op->Op();
+    bool is_fc = desc->Type() == "fc";
+    auto input_name = desc->Input(is_fc ? "Input" : "X")[0];
+    auto* input = FindVar(op->inputs, input_name);
+    auto* out = FindVar(op->outputs, desc->Output("Out")[0]);
+    Node* bias = nullptr;
+    OpDesc sparse_desc;
+    sparse_desc.SetType("sparse_fc");
+    sparse_desc.SetInput("Input", {input_name});
+    sparse_desc.SetInput("WOffsets", {offsets_node->Name()});
+    sparse_desc.SetInput("WIndices", {indices_node->Name()});
+    sparse_desc.SetInput("WValues", {values_node->Name()});
+    if (is_fc && desc->Inputs().count("Bias") &&
+        !desc->Input("Bias").empty()) {
+      bias = FindVar(op->inputs, desc->Input("Bias")[0]);
+      sparse_desc.SetInput("Bias", desc->Input("Bias"));
+    }
+    sparse_desc.SetOutput("Out", {out->Name()});
+    sparse_desc.SetAttr("in_num_col_dims", in_num_col_dims);
+    sparse_desc.SetAttr("weight_dims", std::vector<int>({K, N}));
+    auto* sparse_op = graph->CreateOpNode(&sparse_desc);
+
+    IR_NODE_LINK_TO(input, sparse_op);
+    IR_NODE_LINK_TO(offsets_node, sparse_op);
+    IR_NODE_LINK_TO(indices_node, sparse_op);
+    IR_NODE_LINK_TO(values_node, sparse_op);
+    if (bias) {
+      IR_NODE_LINK_TO(bias, sparse_op);
+    }
+    IR_NODE_LINK_TO(sparse_op, out);
+
+    VLOG(3) << "replace the " << desc->Type() << " of " << w_name << " ["
+            << K << ", " << N << "] of "
+            << static_cast<float>(zeros) / w_tensor.numel()
+            << " sparsity by sparse_fc";
+    std::unordered_set<const Node*> removed{op};
+    if (w->outputs.size() == 1) {
+      removed.insert(w);
+      scope->EraseVars({w_name});
+    }
+    GraphSafeRemoveNodes(graph.get(), removed);
+    ++num_replaced;
+  }
+  AddStatis(num_replaced);
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(sparse_weight_pass, paddle::framework::ir::SparseWeightPass);
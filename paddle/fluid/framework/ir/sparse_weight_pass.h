@@ -0,0 +1,51 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Replace the fc and mul ops of the pruned weights by sparse_fc ops, which
+ * read the nonzeros of the weights in the CSC format.
+ *
+ * The sparsity of every float32 2-D weight of an fc, or of the Y of a mul
+ * with y_num_col_dims 1, is measured in the param scope when the model is
+ * loaded. If the ratio of the zeros is min_sparsity or more, the weight is
+ * converted into the persistable w.csc_offsets, w.csc_indices and
+ * w.csc_values, and the dense weight is erased from the scope if no other op
+ * uses it. The attribute min_sparsity is 0.8 if not set, since the gathers
+ * of the sparse kernel are slower than a dense GEMM of the same nonzeros.
+ */
+class SparseWeightPass : public FusePassBase {
+ public:
+  virtual ~SparseWeightPass() {}
+
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+
+  const std::string name_scope_{"sparse_weight"};
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,133 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/sparse_weight_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+#include "paddle/fluid/framework/scope.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static void AddOp(ProgramDesc* prog, const std::string& type,
+                  const std::string& x, const std::string& w,
+                  const std::string& out) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  if (type == "fc") {
+    op->SetInput("Input", {x});
+    op->SetInput("W", {w});
+    op->SetInput("Bias", {"b"});
+    op->SetAttr("in_num_col_dims", 1);
+  } else {
+    op->SetInput("X", {x});
+    op->SetInput("Y", {w});
+    op->SetAttr("x_num_col_dims", 1);
+    op->SetAttr("y_num_col_dims", 1);
+  }
+  op->SetOutput("Out", {out});
+}
+
+// x -> fc(w1, b) -> y -> mul(w2) -> z -> mul(w3) -> out, where w1 and w3
+// are pruned to 90% of zeros, and w2 is dense.
+static ProgramDesc BuildProgram() {
+  ProgramDesc prog;
+  for (auto& name : {"x", "y", "z", "out", "w1", "w2", "w3", "b"}) {
+    auto* var = prog.MutableBlock(0)->Var(name);
+    var->SetType(proto::VarType::LOD_TENSOR);
+    var->SetPersistable(name[0] == 'w' || name[0] == 'b');
+  }
+  AddOp(&prog, "fc", "x", "w1", "y");
+  AddOp(&prog, "mul", "y", "w2", "z");
+  AddOp(&prog, "mul", "z", "w3", "out");
+  return prog;
+}
+
+static void InitWeight(Scope* scope, const std::string& name, int K, int N,
+                       bool pruned) {
+  auto* tensor = scope->Var(name)->GetMutable<LoDTensor>();
+  tensor->Resize({K, N});
+  float* data = tensor->mutable_data<float>(platform::CPUPlace());
+  for (int i = 0; i < K * N; ++i) {
+    data[i] = pruned && i % 10 != 0 ? 0.f : static_cast<float>(i + 1);
+  }
+}
+
+TEST(SparseWeightPass, basic) {
+  Scope scope;
+  InitWeight(&scope, "w1", 20, 10, true);
+  InitWeight(&scope, "w2", 10, 10, false);
+  InitWeight(&scope, "w3", 10, 5, true);
+  InitWeight(&scope, "b", 1, 10, false);
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(BuildProgram()));
+  graph->Set(kParamScopeAttr, new Scope*(&scope));
+  auto pass = PassRegistry::Instance().Get("sparse_weight_pass");
+  pass->Set("min_sparsity", new float(0.85f));
+  graph = pass->Apply(std::move(graph));
+
+  std::vector<std::string> op_types;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) {
+      // The dense weights are removed with the ops.
+      EXPECT_NE(node->Name(), "w1");
+      EXPECT_NE(node->Name(), "w3");
+      continue;
+    }
+    auto* op = node->Op();
+    op_types.push_back(op->Type());
+    if (op->Type() != "sparse_fc") continue;
+    auto w = op->Input("WValues")[0];
+    auto dims = boost::get<std::vector<int>>(op->GetAttr("weight_dims"));
+    if (op->Input("Input")[0] == "x") {
+      EXPECT_EQ(w, "w1.csc_values");
+      EXPECT_EQ(dims, std::vector<int>({20, 10}));
+      EXPECT_EQ(op->Input("Bias"), std::vector<std::string>({"b"}));
+      EXPECT_EQ(node->inputs.size(), 5UL);
+    } else {
+      EXPECT_EQ(w, "w3.csc_values");
+      EXPECT_EQ(dims, std::vector<int>({10, 5}));
+      EXPECT_EQ(op->Inputs().count("Bias"), 0UL);
+      EXPECT_EQ(node->inputs.size(), 4UL);
+    }
+  }
+  std::sort(op_types.begin(), op_types.end());
+  EXPECT_EQ(op_types,
+            std::vector<std::string>({"mul", "sparse_fc", "sparse_fc"}));
+
+  EXPECT_EQ(scope.FindVar("w1"), nullptr);
+  EXPECT_NE(scope.FindVar("w2"), nullptr);
+  // The nonzeros of w3 are its elements 0, 10, 20, 30 and 40, which are in
+  // the column 0, of the rows 0, 2, 4, 6 and 8.
+  auto& offsets = scope.FindVar("w3.csc_offsets")->Get<LoDTensor>();
+  auto& indices = scope.FindVar("w3.csc_indices")->Get<LoDTensor>();
+  auto& values = scope.FindVar("w3.csc_values")->Get<LoDTensor>();
+  ASSERT_EQ(offsets.numel(), 6);
+  EXPECT_EQ(offsets.data<int>()[1], 5);
+  EXPECT_EQ(offsets.data<int>()[5], 5);
+  ASSERT_EQ(values.numel(), 5);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(indices.data<int>()[i], 2 * i);
+    EXPECT_EQ(values.data<float>()[i], 10.f * i + 1);
+  }
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(sparse_weight_pass);
@@ -0,0 +1,70 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/sync_batch_norm_pass.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static bool IsTrainingBatchNorm(ir::Node* node) {
+  if (!node->IsOp() || node->Op() == nullptr) return false;
+  auto* op = node->Op();
+  if (op->Type() != "batch_norm" && op->Type() != "batch_norm_grad") {
+    return false;
+  }
+  for (auto& attr : {"is_test", "use_global_stats"}) {
+    if (op->HasAttr(attr) && boost::get<bool>(op->GetAttr(attr))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::unique_ptr<ir::Graph> SyncBatchNormPass::ApplyImpl(
+    std::unique_ptr<ir::Graph> graph) const {
+  std::vector<ir::Node*> sync_ops;
+  for (ir::Node* node : graph->Nodes()) {
+    if (IsTrainingBatchNorm(node)) {
+      sync_ops.push_back(node);
+    }
+  }
+  // The op nodes are created in the order of the program.
+  std::sort(sync_ops.begin(), sync_ops.end(),
+            [](ir::Node* a, ir::Node* b) { return a->id() < b->id(); });
+
+  for (size_t i = 0; i < sync_ops.size(); ++i) {
+    auto* op = sync_ops[i]->Op();
+    op->SetType("sync_" + op->Type());
+    op->Flush();
+    if (i == 0) continue;
+    auto* dep_var = graph->CreateControlDepVar();
+    sync_ops[i - 1]->outputs.push_back(dep_var);
+    dep_var->inputs.push_back(sync_ops[i - 1]);
+    dep_var->outputs.push_back(sync_ops[i]);
+    sync_ops[i]->inputs.push_back(dep_var);
+  }
+  VLOG(3) << "sync_batch_norm_pass synchronizes " << sync_ops.size()
+          << " ops";
+  return graph;
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(sync_batch_norm_pass, paddle::framework::ir::SyncBatchNormPass);
@@ -0,0 +1,46 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Replace the batch_norm and batch_norm_grad ops of training by
+ * sync_batch_norm and sync_batch_norm_grad, which compute the statistics of
+ * the mini-batch of all the devices by the NCCL calls on their streams. The
+ * ops with is_test or use_global_stats need no statistics, so they are kept.
+ *
+ * The calls of all the devices should be in the same order, or they hang, so
+ * the pass chains the sync ops by the control dependencies in the order of
+ * the program, which is the same for every device and keeps the data
+ * dependencies.
+ *
+ * The pass should be applied before multi_devices_pass, and only on GPU.
+ */
+class SyncBatchNormPass : public Pass {
+ protected:
+  std::unique_ptr<ir::Graph> ApplyImpl(
+      std::unique_ptr<ir::Graph> graph) const override;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,112 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/sync_batch_norm_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/program_desc.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static OpDesc* AppendBatchNorm(ProgramDesc* prog, const std::string& type,
+                               const std::string& x, const std::string& y,
+                               bool use_global_stats) {
+  auto* op = prog->MutableBlock(0)->AppendOp();
+  op->SetType(type);
+  op->SetAttr("is_test", false);
+  op->SetAttr("use_global_stats", use_global_stats);
+  if (type == "batch_norm") {
+    op->SetInput("X", {x});
+    op->SetOutput("Y", {y});
+  } else {
+    op->SetInput("Y@GRAD", {x});
+    op->SetOutput("X@GRAD", {y});
+  }
+  return op;
+}
+
+// Two batch_norm ops on two branches of x, a third one with the global
+// stats, and the grad ops in the reverse order.
+static ProgramDesc BuildProgram() {
+  ProgramDesc prog;
+  for (auto& name : {"x", "a", "b", "c", "a@GRAD", "b@GRAD", "c@GRAD",
+                     "x@GRAD0", "x@GRAD1", "x@GRAD2"}) {
+    prog.MutableBlock(0)->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  AppendBatchNorm(&prog, "batch_norm", "x", "a", false);
+  AppendBatchNorm(&prog, "batch_norm", "x", "b", false);
+  AppendBatchNorm(&prog, "batch_norm", "x", "c", true);
+  AppendBatchNorm(&prog, "batch_norm_grad", "c@GRAD", "x@GRAD2", true);
+  AppendBatchNorm(&prog, "batch_norm_grad", "b@GRAD", "x@GRAD1", false);
+  AppendBatchNorm(&prog, "batch_norm_grad", "a@GRAD", "x@GRAD0", false);
+  return prog;
+}
+
+static ir::Node* FindOpWithOutput(const ir::Graph& graph,
+                                  const std::string& name) {
+  for (auto* node : graph.Nodes()) {
+    if (!node->IsOp()) continue;
+    for (auto* out : node->outputs) {
+      if (out->Name() == name) return node;
+    }
+  }
+  return nullptr;
+}
+
+static bool DependsOn(ir::Node* op, ir::Node* preceding_op) {
+  for (auto* in : op->inputs) {
+    if (in->IsCtrlVar() && in->inputs.size() == 1 &&
+        in->inputs[0] == preceding_op) {
+      return true;
+    }
+  }
+  return false;
+}
+
+TEST(SyncBatchNormPass, replace_and_chain) {
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(BuildProgram()));
+  auto pass = PassRegistry::Instance().Get("sync_batch_norm_pass");
+  graph = pass->Apply(std::move(graph));
+  EXPECT_FALSE(HasCircle(*graph));
+
+  auto* bn_a = FindOpWithOutput(*graph, "a");
+  auto* bn_b = FindOpWithOutput(*graph, "b");
+  auto* bn_c = FindOpWithOutput(*graph, "c");
+  auto* grad_a = FindOpWithOutput(*graph, "x@GRAD0");
+  auto* grad_b = FindOpWithOutput(*graph, "x@GRAD1");
+  auto* grad_c = FindOpWithOutput(*graph, "x@GRAD2");
+  EXPECT_EQ(bn_a->Op()->Type(), "sync_batch_norm");
+  EXPECT_EQ(bn_b->Op()->Type(), "sync_batch_norm");
+  EXPECT_EQ(grad_b->Op()->Type(), "sync_batch_norm_grad");
+  EXPECT_EQ(grad_a->Op()->Type(), "sync_batch_norm_grad");
+  // The ops with the global stats need no communication.
+  EXPECT_EQ(bn_c->Op()->Type(), "batch_norm");
+  EXPECT_EQ(grad_c->Op()->Type(), "batch_norm_grad");
+
+  // The sync ops run in the order of the program on every device.
+  EXPECT_TRUE(DependsOn(bn_b, bn_a));
+  EXPECT_TRUE(DependsOn(grad_b, bn_b));
+  EXPECT_TRUE(DependsOn(grad_a, grad_b));
+  EXPECT_FALSE(DependsOn(bn_c, bn_b));
+  EXPECT_FALSE(DependsOn(grad_b, grad_c));
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(sync_batch_norm_pass);
@@ -26,6 +26,7 @@ limitations under the License. */
 #include "paddle/fluid/memory/memcpy.h"
 #include "paddle/fluid/memory/memory.h"
 
+#include "paddle/fluid/recordio/piece_stream.h"
 #include "paddle/fluid/recordio/scanner.h"
 #include "paddle/fluid/recordio/writer.h"
 
@@ -298,6 +299,42 @@ void DeserializeFromStream(std::istream &is, LoDTensor *tensor,
   TensorFromStream(is, static_cast<Tensor *>(tensor), dev_ctx);
 }
 
+size_t DeserializeFromMappedFile(
+    const std::shared_ptr<memory::allocation::MmapAllocation> &file,
+    size_t offset, LoDTensor *tensor) {
+  const char *base = static_cast<const char *>(file->ptr());
+  auto read = [&](void *dst, size_t size) {
+    PADDLE_ENFORCE_LE(offset + size, file->size(),
+                      "Unexpected end of the mapped file");
+    std::memcpy(dst, base + offset, size);
+    offset += size;
+  };
+  {
+    // the 1st field, unit32_t version for LoDTensor
+    uint32_t version;
+    read(&version, sizeof(version));
+    PADDLE_ENFORCE(framework::IsTensorVersionSupported(version),
+                   "tensor version %u is not supported.", version);
+    PADDLE_ENFORCE_EQ(version, 0U, "Only version 0 is supported");
+  }
+  {
+    // the 2st field, LoD information
+    uint64_t lod_level;
+    read(&lod_level, sizeof(lod_level));
+    auto &lod = *tensor->mutable_lod();
+    lod.resize(lod_level);
+    for (uint64_t i = 0; i < lod_level; ++i) {
+      uint64_t size;
+      read(&size, sizeof(size));
+      std::vector<size_t> tmp(size / sizeof(size_t));
+      read(tmp.data(), static_cast<size_t>(size));
+      lod[i] = tmp;
+    }
+  }
+  // the 3st filed, Tensor
+  return TensorFromMappedFile(file, offset, static_cast<Tensor *>(tensor));
+}
+
 void WriteToRecordIO(recordio::Writer *writer,
                      const std::vector<LoDTensor> &tensor,
                      const platform::DeviceContext &dev_ctx) {
@@ -316,7 +353,7 @@ bool ReadFromRecordIO(recordio::Scanner *scanner,
   if (!scanner->HasNext()) {
     return false;
   }
-  std::istringstream sin(scanner->Next());
+  recordio::PieceStream sin(scanner->NextPiece());
   uint32_t sz;
   sin.read(reinterpret_cast<char *>(&sz), sizeof(uint32_t));
   auto &result = *result_ptr;
@@ -330,11 +367,23 @@ bool ReadFromRecordIO(recordio::Scanner *scanner,
 
 std::vector<LoDTensor> LoDTensor::SplitLoDTensor(
     const std::vector<platform::Place> places) const {
+  std::vector<LoDTensor> results = SplitLoDTensorSlices(places.size());
+  for (size_t i = 0; i < results.size(); ++i) {
+    LoDTensor dst;
+    framework::TensorCopy(results[i], places[i], &dst);
+    dst.set_lod(results[i].lod());
+    results[i] = dst;
+  }
+  return results;
+}
+
+std::vector<LoDTensor> LoDTensor::SplitLoDTensorSlices(
+    size_t num_places) const {
   check_memory_size();
   int batch_size =
       lod().empty() ? dims()[0] : static_cast<int>(lod()[0].size()) - 1;
-  size_t result_size = std::min(static_cast<size_t>(batch_size), places.size());
-  size_t remainder = batch_size % places.size();
+  size_t result_size = std::min(static_cast<size_t>(batch_size), num_places);
+  size_t remainder = batch_size % num_places;
 
   std::vector<LoDTensor> results;
   results.reserve(result_size);
@@ -343,22 +392,18 @@ std::vector<LoDTensor> LoDTensor::SplitLoDTensor(
   for (size_t i = 0; i < result_size; ++i) {
     int begin = static_cast<int>(i * step_width);
     int end = static_cast<int>((i + 1) * step_width);
-    if (i + 1 == places.size()) {  // last
+    if (i + 1 == num_places) {  // last
       end += remainder;
     }
 
     LoDTensor dst;
     if (lod().empty()) {
-      auto src = Slice(begin, end);
-      auto &dst_place = places[i];
-      framework::TensorCopy(src, dst_place, &dst);
+      dst.ShareDataWith(Slice(begin, end));
     } else {
       auto lod_and_offset = GetSubLoDAndAbsoluteOffset(lod(), begin, end, 0);
 
       auto &offset = lod_and_offset.second;
-      auto src = Slice(offset.first, offset.second);
-      auto &dst_place = places[i];
-      framework::TensorCopy(src, dst_place, &dst);
+      dst.ShareDataWith(Slice(offset.first, offset.second));
 
       LoD my_lod;
       for (auto &l : lod_and_offset.first) {
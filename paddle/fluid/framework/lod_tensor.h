@@ -146,6 +146,10 @@ class LoDTensor : public Tensor {
   std::vector<LoDTensor> SplitLoDTensor(
       const std::vector<platform::Place> places) const;
 
+  // The parts which SplitLoDTensor copies to num_places places, which share
+  // the memory of this tensor.
+  std::vector<LoDTensor> SplitLoDTensorSlices(size_t num_places) const;
+
   void MergeLoDTensor(const std::vector<const LoDTensor*>& lod_tensors,
                       platform::Place place);
 
@@ -216,6 +220,14 @@ void SerializeToStream(std::ostream& os, const LoDTensor& tensor,
 void DeserializeFromStream(std::istream& is, LoDTensor* tensor,
                            const platform::DeviceContext& dev_ctx);
 
+/*
+ * Desiralize the LoDTensor at the offset of a mapped file without copying
+ * its data, see TensorFromMappedFile. Return the offset right after it.
+ */
+size_t DeserializeFromMappedFile(
+    const std::shared_ptr<memory::allocation::MmapAllocation>& file,
+    size_t offset, LoDTensor* tensor);
+
 extern void WriteToRecordIO(recordio::Writer* writer,
                             const std::vector<LoDTensor>& tensor,
                             const platform::DeviceContext& dev_ctx);
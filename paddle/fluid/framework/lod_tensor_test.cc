@@ -156,6 +156,28 @@ TEST(LoD, SplitLoDTensor) {
   EXPECT_EQ(lods[1].lod(), lod1);
 }
 
+TEST(LoD, SplitLoDTensorSlices) {
+  LoD lod;
+  lod.push_back(std::vector<size_t>({0, 2, 4, 5, 6}));
+  lod.push_back(std::vector<size_t>({0, 1, 6, 8, 13, 15, 20}));
+
+  platform::CPUPlace place;
+  LoDTensor lod_tensor;
+  lod_tensor.Resize({20, 1});
+  float* dst_ptr = lod_tensor.mutable_data<float>(place);
+  lod_tensor.set_lod(lod);
+
+  // The slices share the data of the tensor.
+  auto slices = lod_tensor.SplitLoDTensorSlices(2);
+  ASSERT_EQ(slices.size(), 2UL);
+  EXPECT_EQ(slices[0].data<float>(), dst_ptr);
+  EXPECT_EQ(slices[0].dims()[0], 13);
+  EXPECT_EQ(slices[1].data<float>(), dst_ptr + 13);
+  EXPECT_EQ(slices[1].dims()[0], 7);
+  EXPECT_EQ(slices[1].lod()[0], std::vector<size_t>({0, 1, 2}));
+  EXPECT_EQ(slices[1].lod()[1], std::vector<size_t>({0, 2, 7}));
+}
+
 TEST(LoD, MergeLoDTensor) {
   LoD lod;
   lod.push_back(std::vector<size_t>({0, 2, 4, 5, 6}));
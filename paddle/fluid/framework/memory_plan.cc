@@ -0,0 +1,112 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/memory_plan.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+
+static size_t AlignUp(size_t size, size_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+static bool IsOverlapped(const MemoryPlanBlock& a, const MemoryPlanBlock& b) {
+  return a.begin <= b.end && b.begin <= a.end;
+}
+
+size_t PlanMemoryOffsets(std::vector<MemoryPlanBlock>* blocks,
+                         size_t alignment) {
+  PADDLE_ENFORCE_GT(alignment, 0UL);
+  std::vector<size_t> order(blocks->size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [blocks](size_t a, size_t b) {
+    auto& x = (*blocks)[a];
+    auto& y = (*blocks)[b];
+    if (x.size != y.size) return x.size > y.size;
+    return x.begin < y.begin;
+  });
+
+  size_t arena_size = 0;
+  std::vector<const MemoryPlanBlock*> placed;
+  std::vector<const MemoryPlanBlock*> conflicts;
+  for (size_t idx : order) {
+    auto& block = (*blocks)[idx];
+    PADDLE_ENFORCE_LE(block.begin, block.end, "Invalid lifetime [%d, %d]",
+                      block.begin, block.end);
+    size_t size = AlignUp(block.size, alignment);
+
+    conflicts.clear();
+    for (auto* other : placed) {
+      if (IsOverlapped(block, *other)) conflicts.emplace_back(other);
+    }
+    std::sort(conflicts.begin(), conflicts.end(),
+              [](const MemoryPlanBlock* a, const MemoryPlanBlock* b) {
+                return a->offset < b->offset;
+              });
+
+    // Find the smallest gap which fits, or put the block after all the
+    // conflicting ones.
+    size_t offset = 0;
+    size_t best_offset = std::numeric_limits<size_t>::max();
+    size_t best_gap = std::numeric_limits<size_t>::max();
+    for (auto* other : conflicts) {
+      if (other->offset >= offset + size) {
+        size_t gap = other->offset - offset;
+        if (gap < best_gap) {
+          best_gap = gap;
+          best_offset = offset;
+        }
+      }
+      offset = std::max(offset,
+                        other->offset + AlignUp(other->size, alignment));
+    }
+    if (best_offset == std::numeric_limits<size_t>::max()) {
+      best_offset = offset;
+    }
+
+    block.offset = best_offset;
+    arena_size = std::max(arena_size, best_offset + size);
+    placed.emplace_back(&block);
+  }
+  return arena_size;
+}
+
+size_t PeakLiveBytes(const std::vector<MemoryPlanBlock>& blocks,
+                     size_t alignment) {
+  // (op index, size change), the blocks are released after their last ops.
+  std::vector<std::pair<int, int64_t>> events;
+  for (auto& block : blocks) {
+    auto size = static_cast<int64_t>(AlignUp(block.size, alignment));
+    events.emplace_back(block.begin, size);
+    events.emplace_back(block.end + 1, -size);
+  }
+  std::sort(events.begin(), events.end());
+  int64_t live = 0;
+  int64_t peak = 0;
+  for (size_t i = 0; i < events.size(); ++i) {
+    live += events[i].second;
+    if (i + 1 == events.size() || events[i + 1].first != events[i].first) {
+      peak = std::max(peak, live);
+    }
+  }
+  return static_cast<size_t>(peak);
+}
+
+}  // namespace framework
+}  // namespace paddle
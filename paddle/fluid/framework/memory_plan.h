@@ -0,0 +1,47 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+// A buffer used from the op begin to the op end, both inclusive.
+struct MemoryPlanBlock {
+  size_t size;
+  int begin;
+  int end;
+  // Set by PlanMemoryOffsets.
+  size_t offset;
+};
+
+// Assign the offsets of the blocks in a single arena, so that the blocks
+// whose lifetimes overlap do not overlap in the arena. The blocks are placed
+// from the largest one, each into the smallest gap between the placed blocks
+// it conflicts with. Every offset is a multiple of alignment.
+//
+// Return the size of the arena.
+size_t PlanMemoryOffsets(std::vector<MemoryPlanBlock>* blocks,
+                         size_t alignment = 256);
+
+// The maximum total size of the blocks used by the same op, which is the lower
+// bound of the arena size.
+size_t PeakLiveBytes(const std::vector<MemoryPlanBlock>& blocks,
+                     size_t alignment = 256);
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,89 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/memory_plan.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+static void CheckNoConflict(const std::vector<MemoryPlanBlock>& blocks,
+                            size_t arena_size) {
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    auto& a = blocks[i];
+    EXPECT_LE(a.offset + a.size, arena_size);
+    for (size_t j = i + 1; j < blocks.size(); ++j) {
+      auto& b = blocks[j];
+      bool time_overlapped = a.begin <= b.end && b.begin <= a.end;
+      bool space_overlapped =
+          a.offset < b.offset + b.size && b.offset < a.offset + a.size;
+      EXPECT_FALSE(time_overlapped && space_overlapped)
+          << "block " << i << " and " << j << " conflict";
+    }
+  }
+}
+
+TEST(MemoryPlan, chain) {
+  // a -> b -> c -> d, each block is only alive with its neighbours.
+  std::vector<MemoryPlanBlock> blocks{
+      {1024, 0, 1}, {1024, 1, 2}, {1024, 2, 3}, {1024, 3, 4}};
+  size_t arena_size = PlanMemoryOffsets(&blocks, 256);
+  EXPECT_EQ(arena_size, 2048UL);
+  EXPECT_EQ(PeakLiveBytes(blocks, 256), 2048UL);
+  CheckNoConflict(blocks, arena_size);
+  EXPECT_EQ(blocks[0].offset, blocks[2].offset);
+  EXPECT_EQ(blocks[1].offset, blocks[3].offset);
+}
+
+TEST(MemoryPlan, alignment) {
+  std::vector<MemoryPlanBlock> blocks{{1, 0, 0}, {1, 0, 0}, {300, 0, 1}};
+  size_t arena_size = PlanMemoryOffsets(&blocks, 256);
+  EXPECT_EQ(arena_size, 1024UL);
+  for (auto& block : blocks) {
+    EXPECT_EQ(block.offset % 256, 0UL);
+  }
+  CheckNoConflict(blocks, arena_size);
+}
+
+TEST(MemoryPlan, fill_gap) {
+  // The small block at op 2 fits the gap left by the block dead after op 1.
+  std::vector<MemoryPlanBlock> blocks{
+      {4096, 0, 3}, {2048, 0, 1}, {4096, 0, 3}, {1024, 2, 3}};
+  size_t arena_size = PlanMemoryOffsets(&blocks, 256);
+  EXPECT_EQ(arena_size, 4096UL * 2 + 2048);
+  EXPECT_EQ(blocks[3].offset, blocks[1].offset);
+  CheckNoConflict(blocks, arena_size);
+}
+
+TEST(MemoryPlan, random) {
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<int> op_dist(0, 50);
+  std::uniform_int_distribution<size_t> size_dist(1, 1 << 16);
+  for (int round = 0; round < 20; ++round) {
+    std::vector<MemoryPlanBlock> blocks;
+    for (int i = 0; i < 100; ++i) {
+      int begin = op_dist(rng);
+      int end = std::min(50, begin + op_dist(rng) / 10);
+      blocks.push_back({size_dist(rng), begin, end});
+    }
+    size_t arena_size = PlanMemoryOffsets(&blocks, 64);
+    EXPECT_GE(arena_size, PeakLiveBytes(blocks, 64));
+    CheckNoConflict(blocks, arena_size);
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
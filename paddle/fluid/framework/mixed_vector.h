@@ -54,16 +54,19 @@ class Vector {
         : cpu_(dat), flag_(kDataInCPU) {}
     ~VectorData() {}
 
-    VectorData(const VectorData &o) {
-      o.ImmutableCPU();
-      cpu_ = o.cpu_;
-      flag_ = kDataInCPU;
-    }
+    // The copy shares the immutable CUDA data of o, so that a Vector detached
+    // from o, e.g. to be written on CPU, does not upload the same data again.
+    VectorData(const VectorData &o) { *this = o; }
 
     VectorData &operator=(const VectorData &o) {
       o.ImmutableCPU();
       cpu_ = o.cpu_;
       flag_ = kDataInCPU;
+      gpu_ = o.gpu_;
+      uploaded_ = o.uploaded_;
+      if (gpu_ != nullptr && o.IsInCUDA()) {
+        SetFlag(kDataInCUDA);
+      }
       return *this;
     }
 
@@ -163,9 +166,15 @@ class Vector {
 
     // get cuda ptr. mutable
     T *CUDAMutableData(platform::Place place) {
-      const T *ptr = CUDAData(place);
+      CUDAData(place);
+      if (gpu_.use_count() > 1) {
+        // The CUDA data is shared with the copies of this, which should not
+        // see the writes.
+        CopyCUDADataToCUDA();
+      }
+      uploaded_.reset();
       flag_ = kDirty | kDataInCUDA;
-      return const_cast<T *>(ptr);
+      return reinterpret_cast<T *>(gpu_->ptr());
     }
 
     // clear
@@ -230,7 +239,10 @@ class Vector {
     void ImmutableCUDA(platform::Place place) const {
       if (IsDirty()) {
         if (IsInCPU()) {
-          CopyCPUDataToCUDA(place);
+          // The CPU data may only have been read by the mutable accessors.
+          if (!IsUploaded(place)) {
+            CopyCPUDataToCUDA(place);
+          }
           UnsetFlag(kDirty);
           SetFlag(kDataInCUDA);
         } else if (IsInCUDA() && !(place == gpu_->place())) {
@@ -243,10 +255,13 @@ class Vector {
       } else {
         if (!IsInCUDA()) {
           // Even data is not dirty. However, data is not in CUDA. Copy data.
-          CopyCPUDataToCUDA(place);
+          if (!IsUploaded(place)) {
+            CopyCPUDataToCUDA(place);
+          }
           SetFlag(kDataInCUDA);
         } else if (!(place == gpu_->place())) {
-          PADDLE_THROW("This situation should not happen.");
+          // The CUDA data is shared from a copy in another place.
+          CopyCPUDataToCUDA(place);
         } else {
           // Not Dirty && DataInCUDA && Device is same
           // Do nothing.
@@ -254,6 +269,10 @@ class Vector {
       }
     }
 
+    // The CUDA data may be shared by the copies, so a new allocation is
+    // uploaded to instead of the old one. The upload is queued on the stream
+    // of the place and the small ones are remembered, to skip the uploads of
+    // the same data.
     void CopyCPUDataToCUDA(const platform::Place &place) const {
       void *src = cpu_.data();
       gpu_ = memory::Alloc(place, cpu_.size() * sizeof(T));
@@ -263,6 +282,27 @@ class Vector {
       auto stream = dev_ctx->stream();
       paddle::memory::Copy(CUDAPlace().get(), dst, platform::CPUPlace(), src,
                            gpu_->size(), stream);
+      if (cpu_.size() * sizeof(T) <= kMaxUploadedBytes) {
+        uploaded_ = std::make_shared<const std::vector<T>>(cpu_);
+      } else {
+        uploaded_.reset();
+      }
+    }
+
+    void CopyCUDADataToCUDA() const {
+      std::shared_ptr<memory::Allocation> gpu =
+          memory::Alloc(gpu_->place(), gpu_->size());
+      auto *dev_ctx = static_cast<platform::CUDADeviceContext *>(
+          platform::DeviceContextPool::Instance().Get(gpu_->place()));
+      paddle::memory::Copy(CUDAPlace().get(), gpu->ptr(), CUDAPlace().get(),
+                           gpu_->ptr(), gpu_->size(), dev_ctx->stream());
+      gpu_ = std::move(gpu);
+    }
+
+    // Whether the CPU data is the same as the CUDA data in the place.
+    bool IsUploaded(const platform::Place &place) const {
+      return gpu_ != nullptr && uploaded_ != nullptr &&
+             place == gpu_->place() && *uploaded_ == cpu_;
     }
 
     void ImmutableCPU() const {
@@ -283,8 +323,15 @@ class Vector {
 
     bool IsInCPU() const { return flag_ & kDataInCPU; }
 
+    // The largest CUDA data compared with the CPU data before uploading
+    // it, which covers the LoDs of the batches.
+    static constexpr size_t kMaxUploadedBytes = 64 * 1024;
+
     mutable std::vector<T> cpu_;
-    mutable paddle::memory::AllocationPtr gpu_;
+    mutable std::shared_ptr<memory::Allocation> gpu_;
+    // The CPU data uploaded to gpu_, or nullptr if gpu_ is written in CUDA or
+    // is too large to compare.
+    mutable std::shared_ptr<const std::vector<T>> uploaded_;
     mutable int flag_;
 
     mutable std::mutex mtx_;
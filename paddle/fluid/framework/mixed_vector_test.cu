@@ -73,3 +73,30 @@ TEST(mixed_vector, MultiGPU) {
     ASSERT_EQ(tmp[i], i * 100);
   }
 }
+
+TEST(mixed_vector, ShareCUDAData) {
+  vec<int> tmp;
+  for (int i = 0; i < 10; ++i) {
+    tmp.push_back(i);
+  }
+  paddle::platform::CUDAPlace gpu(0);
+  const vec<int>& const_tmp = tmp;
+  const int* gpu_ptr = const_tmp.CUDAData(gpu);
+
+  // Reading the data by the mutable accessors does not upload it again.
+  ASSERT_EQ(tmp[3], 3);
+  ASSERT_EQ(const_tmp.CUDAData(gpu), gpu_ptr);
+
+  // A copy detached to be written shares the CUDA data until it is changed.
+  vec<int> copy(tmp);
+  const vec<int>& const_copy = copy;
+  ASSERT_EQ(copy[3], 3);
+  ASSERT_EQ(const_copy.CUDAData(gpu), gpu_ptr);
+
+  multiply_10<<<1, 1, 0, GetCUDAStream(gpu)>>>(copy.MutableData(gpu));
+  ASSERT_NE(const_copy.CUDAData(gpu), gpu_ptr);
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_EQ(copy[i], i * 10);
+    ASSERT_EQ(const_tmp[i], i);
+  }
+}
@@ -12,20 +12,55 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "paddle/fluid/framework/feed_fetch_method.h"
 #include "paddle/fluid/framework/lod_rank_table.h"
 #include "paddle/fluid/framework/lod_tensor_array.h"
+#include "paddle/fluid/framework/memory_plan.h"
 #include "paddle/fluid/framework/naive_executor.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/reader.h"
+#include "paddle/fluid/framework/run_context.h"
+#include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/framework/variable_helper.h"
+#include "paddle/fluid/platform/sampling_profiler.h"
 #include "paddle/fluid/string/pretty_log.h"
 
+DECLARE_bool(enable_cache_runtime_context);
+
 namespace paddle {
 namespace framework {
+
+#if defined(PADDLE_WITH_CUDA) && CUDA_VERSION >= 10010
+#define PADDLE_WITH_CUDA_GRAPH
+#endif
+
+struct NaiveExecutor::CUDAGraph {
+#ifdef PADDLE_WITH_CUDA_GRAPH
+  ~CUDAGraph() {
+    if (exec != nullptr) {
+      PADDLE_ENFORCE(cudaGraphExecDestroy(exec));
+    }
+  }
+
+  cudaGraphExec_t exec{nullptr};
+#endif
+  // The feed tensors and their buffers in the graph.
+  std::vector<std::pair<LoDTensor *, LoDTensor>> feeds;
+  // The other tensors of the scope as they were captured, which also keep
+  // the buffers of the graph alive.
+  std::vector<std::pair<LoDTensor *, LoDTensor>> tensors;
+};
+
+NaiveExecutor::NaiveExecutor(const platform::Place &place) : place_(place) {}
+
+NaiveExecutor::~NaiveExecutor() {}
+
 void NaiveExecutor::Prepare(Scope *scope, const ProgramDesc &program_desc,
                             int block_id, bool with_feed_fetch_ops) {
   if (!scope) {
@@ -36,6 +71,8 @@ void NaiveExecutor::Prepare(Scope *scope, const ProgramDesc &program_desc,
 
   VLOG(3) << "NaiveExecutor init with scope " << scope;
   CreateOps(program_desc, block_id, with_feed_fetch_ops);
+  variables_bound_ = false;
+  cuda_graphs_.clear();
 }
 
 void NaiveExecutor::Run() {
@@ -49,7 +86,24 @@ void NaiveExecutor::Run() {
                              "setting the cmake flag ON_INFER=ON if you are "
                              "running Paddle Inference";
 #endif  // PADDLE_ON_INFERENCE
+  if (FLAGS_enable_cache_runtime_context && !variables_bound_) {
+    BindVariables();
+  }
+  if (memory_plan_pending_) {
+    RunAndPlanMemory();
+    return;
+  }
+  if (max_cuda_graphs_ > 0 && !cuda_graph_disabled_) {
+    RunWithCUDAGraph();
+    return;
+  }
+  RunOps();
+}
+
+void NaiveExecutor::RunOps() {
+  platform::SampledRun sampled_run;
   for (auto &op : ops_) {
+    CheckRunContext();
     VLOG(3) << std::this_thread::get_id() << " run " << op->Type()
             << " on scope " << scope_;
     op->SetIsCalledByExecutor(false);
@@ -106,6 +160,37 @@ void NaiveExecutor::CreateOps(const ProgramDesc &desc, int block_id,
   }
 }
 
+void NaiveExecutor::BindVariables() {
+  // Each variable is looked up in the scope once, and gets a slot shared by
+  // all the ops using it.
+  std::unordered_map<std::string, size_t> slots;
+  std::vector<Variable *> vars;
+  auto resolve = [&](const VariableNameMap &names) {
+    VariableValueMap values;
+    for (auto &param : names) {
+      auto &args = values[param.first];
+      args.reserve(param.second.size());
+      for (auto &name : param.second) {
+        auto it = slots.find(name);
+        if (it == slots.end()) {
+          it = slots.emplace(name, vars.size()).first;
+          vars.push_back(scope_->FindVar(name));
+        }
+        args.push_back(vars[it->second]);
+      }
+    }
+    return values;
+  };
+  for (auto &op : ops_) {
+    std::unique_ptr<RuntimeContext> ctx(
+        new RuntimeContext(resolve(op->Inputs()), resolve(op->Outputs())));
+    op->BindRuntimeContext(*scope_, std::move(ctx));
+  }
+  VLOG(3) << "Bind " << vars.size() << " variables to " << ops_.size()
+          << " ops";
+  variables_bound_ = true;
+}
+
 LoDTensor *NaiveExecutor::FindTensor(const std::string &name) {
   PADDLE_ENFORCE(scope_, "Need to init scope first");
   auto *var = scope_->FindVar(name);
@@ -114,6 +199,283 @@ LoDTensor *NaiveExecutor::FindTensor(const std::string &name) {
   return tensor;
 }
 
+void NaiveExecutor::EnableMemoryPlan(
+    const std::unordered_map<std::string, std::pair<int, int>> &lifetimes) {
+  memory_plan_lifetimes_ = lifetimes;
+  memory_plan_pending_ = !lifetimes.empty();
+  memory_arena_.reset();
+  // The graphs may use the arena.
+  cuda_graphs_.clear();
+}
+
+static bool IsFeedOrFetch(const OperatorBase &op) {
+  return op.Type() == "feed" || op.Type() == "fetch";
+}
+
+static const memory::Allocation *TensorHolder(const Scope &scope,
+                                              const std::string &name) {
+  auto *var = scope.FindVar(name);
+  if (var == nullptr || !var->IsType<LoDTensor>()) return nullptr;
+  return var->Get<LoDTensor>().Holder().get();
+}
+
+// Run the ops, and record which buffer each planned variable uses after the
+// ops writing it. A variable sharing the buffer of an input of its op is
+// merged into the group of that input, whose lifetime is the union of the
+// group, since the buffer can not be reused until all of them are dead. A
+// variable sharing a buffer not planned, e.g., of a parameter, and a buffer
+// shared by a variable not planned are not planned.
+void NaiveExecutor::RunAndPlanMemory() {
+  std::unordered_map<std::string, std::string> group_of;
+  std::unordered_map<const memory::Allocation *, std::string> group_of_buffer;
+  std::unordered_set<std::string> excluded_groups;
+  // Hold the recorded buffers, so that their addresses are not reused by
+  // other buffers in this Run.
+  std::vector<std::shared_ptr<memory::Allocation>> recorded_buffers;
+
+  for (auto &op : ops_) {
+    // A stopped run leaves the plan pending, it is planned by the next one.
+    CheckRunContext();
+    op->SetIsCalledByExecutor(false);
+    op->Run(*scope_, place_);
+    if (IsFeedOrFetch(*op)) continue;
+
+    for (auto &output : op->Outputs()) {
+      for (auto &name : output.second) {
+        if (memory_plan_lifetimes_.count(name) == 0) {
+          // A variable not planned may share a planned buffer after the
+          // lifetime of it, e.g., a fetched variable reshaped in place.
+          auto buffer_it = group_of_buffer.find(TensorHolder(*scope_, name));
+          if (buffer_it != group_of_buffer.end()) {
+            excluded_groups.insert(buffer_it->second);
+          }
+          continue;
+        }
+        auto *var = scope_->FindVar(name);
+        if (var == nullptr || !var->IsType<LoDTensor>()) {
+          excluded_groups.insert(name);
+          group_of[name] = name;
+          continue;
+        }
+        auto *holder = TensorHolder(*scope_, name);
+        if (holder == nullptr) continue;
+
+        std::string group = name;
+        auto buffer_it = group_of_buffer.find(holder);
+        if (buffer_it != group_of_buffer.end()) {
+          group = buffer_it->second;
+        } else {
+          for (auto &input : op->Inputs()) {
+            for (auto &input_name : input.second) {
+              if (input_name == name ||
+                  TensorHolder(*scope_, input_name) != holder) {
+                continue;
+              }
+              // The buffer is not allocated for a planned variable.
+              excluded_groups.insert(name);
+            }
+          }
+          group_of_buffer[holder] = name;
+          recorded_buffers.emplace_back(var->Get<LoDTensor>().Holder());
+        }
+        auto group_it = group_of.find(name);
+        if (group_it != group_of.end() && group_it->second != group) {
+          // The variable moves to another buffer, which is not expected.
+          excluded_groups.insert(group_it->second);
+          excluded_groups.insert(group);
+        }
+        group_of[name] = group;
+      }
+    }
+  }
+  memory_plan_pending_ = false;
+
+  // The lifetime and the size of each group.
+  std::unordered_map<std::string, MemoryPlanBlock> groups;
+  for (auto &pair : group_of) {
+    auto &lifetime = memory_plan_lifetimes_.at(pair.first);
+    auto *holder = TensorHolder(*scope_, pair.first);
+    size_t size = holder ? holder->size() : 0;
+    auto it = groups.find(pair.second);
+    if (it == groups.end()) {
+      groups.emplace(pair.second,
+                     MemoryPlanBlock{size, lifetime.first, lifetime.second, 0});
+    } else {
+      auto &block = it->second;
+      block.size = std::max(block.size, size);
+      block.begin = std::min(block.begin, lifetime.first);
+      block.end = std::max(block.end, lifetime.second);
+    }
+  }
+
+  std::vector<std::string> names;
+  std::vector<MemoryPlanBlock> blocks;
+  size_t total_size = 0;
+  for (auto &pair : groups) {
+    if (excluded_groups.count(pair.first) || pair.second.size == 0) continue;
+    names.emplace_back(pair.first);
+    blocks.emplace_back(pair.second);
+    total_size += pair.second.size;
+  }
+  recorded_buffers.clear();
+  if (blocks.empty()) return;
+
+  // Release the buffers of the planned groups before allocating the arena.
+  // The other variables of the groups share the planned buffers again in the
+  // next Run.
+  for (auto &pair : group_of) {
+    if (excluded_groups.count(pair.second)) continue;
+    scope_->FindVar(pair.first)->GetMutable<LoDTensor>()->clear();
+  }
+
+  size_t arena_size = PlanMemoryOffsets(&blocks);
+  memory_arena_ = memory::Alloc(place_, arena_size);
+  auto *base = reinterpret_cast<uint8_t *>(memory_arena_->ptr());
+  for (size_t i = 0; i < names.size(); ++i) {
+    auto *tensor = scope_->FindVar(names[i])->GetMutable<LoDTensor>();
+    tensor->ResetHolder(std::make_shared<memory::Allocation>(
+        base + blocks[i].offset, blocks[i].size, place_));
+  }
+
+  LOG(INFO) << "Plan " << blocks.size() << " buffers of " << total_size
+            << " bytes in an arena of " << arena_size
+            << " bytes, the peak of the live buffers is "
+            << PeakLiveBytes(blocks) << " bytes";
+}
+
+void NaiveExecutor::EnableCUDAGraph(const std::vector<std::string> &feed_names,
+                                    size_t max_graphs) {
+#ifdef PADDLE_WITH_CUDA_GRAPH
+  PADDLE_ENFORCE(platform::is_gpu_place(place_),
+                 "The CUDA graphs only work on GPU");
+  cuda_graph_feed_names_ = feed_names;
+  max_cuda_graphs_ = max_graphs;
+  cuda_graph_disabled_ = false;
+  cuda_graphs_.clear();
+#else
+  LOG(WARNING) << "The CUDA graphs need CUDA 10.1 or later, the ops are run "
+                  "without them";
+#endif
+}
+
+void NaiveExecutor::RunWithCUDAGraph() {
+#ifdef PADDLE_WITH_CUDA_GRAPH
+  std::vector<int64_t> key;
+  for (auto &name : cuda_graph_feed_names_) {
+    auto *tensor = FindTensor(name);
+    // The LoD is copied to the device from the host memory by the ops.
+    if (!tensor->IsInitialized() || !platform::is_gpu_place(tensor->place()) ||
+        !tensor->lod().empty()) {
+      RunOps();
+      return;
+    }
+    auto dims = vectorize(tensor->dims());
+    key.push_back(static_cast<int64_t>(dims.size()));
+    key.insert(key.end(), dims.begin(), dims.end());
+  }
+
+  auto &dev_ctx = *static_cast<platform::CUDADeviceContext *>(
+      platform::DeviceContextPool::Instance().Get(place_));
+  auto it = cuda_graphs_.find(key);
+  if (it != cuda_graphs_.end()) {
+    auto &graph = *it->second;
+    for (auto &feed : graph.feeds) {
+      if (feed.first->data<void>() != feed.second.data<void>()) {
+        TensorCopy(*feed.first, place_, dev_ctx, &feed.second);
+      }
+    }
+    // Only the kernels are replayed, the shapes set by the ops are restored
+    // here.
+    for (auto &tensor : graph.tensors) {
+      tensor.first->ShareDataWith(tensor.second);
+      tensor.first->set_lod(tensor.second.lod());
+    }
+    // The graph is replayed as a whole.
+    CheckRunContext();
+    PADDLE_ENFORCE(cudaGraphLaunch(graph.exec, dev_ctx.stream()));
+    return;
+  }
+
+  // Run the ops first, so that the buffers are allocated before the capture,
+  // and their outputs are the results of this Run.
+  RunOps();
+  if (cuda_graphs_.size() >= max_cuda_graphs_) return;
+  for (auto &op : ops_) {
+    for (auto &output : op->Outputs()) {
+      for (auto &name : output.second) {
+        auto *var = scope_->FindVar(name);
+        if (var == nullptr || !var->IsInitialized()) continue;
+        if (!var->IsType<LoDTensor>() ||
+            (var->Get<LoDTensor>().IsInitialized() &&
+             !platform::is_gpu_place(var->Get<LoDTensor>().place()))) {
+          LOG(WARNING) << "The output " << name << " of " << op->Type()
+                       << " is not a LoDTensor on GPU, the CUDA graphs are "
+                          "disabled";
+          cuda_graph_disabled_ = true;
+          return;
+        }
+      }
+    }
+  }
+
+  std::unique_ptr<CUDAGraph> graph(new CUDAGraph);
+  auto stream = dev_ctx.stream();
+  PADDLE_ENFORCE(
+      cudaStreamBeginCapture(stream, cudaStreamCaptureModeThreadLocal));
+  std::string error;
+  try {
+    // The capture is not stopped in the middle, the ops of this Run are done
+    // already.
+    ScopedRunContext no_run_context(nullptr);
+    RunOps();
+  } catch (std::exception &e) {
+    error = e.what();
+  }
+  cudaGraph_t cuda_graph = nullptr;
+  cudaError_t status = cudaStreamEndCapture(stream, &cuda_graph);
+  if (error.empty() && status == cudaSuccess) {
+    status =
+        cudaGraphInstantiate(&graph->exec, cuda_graph, nullptr, nullptr, 0);
+  }
+  if (cuda_graph != nullptr) {
+    PADDLE_ENFORCE(cudaGraphDestroy(cuda_graph));
+  }
+  if (!error.empty() || status != cudaSuccess) {
+    if (error.empty()) error = cudaGetErrorString(status);
+    // Clear the error of the capture.
+    cudaGetLastError();
+    LOG(WARNING) << "Cannot capture the ops into a CUDA graph: " << error
+                 << ", the CUDA graphs are disabled";
+    cuda_graph_disabled_ = true;
+    return;
+  }
+
+  std::unordered_set<std::string> feed_names(cuda_graph_feed_names_.begin(),
+                                             cuda_graph_feed_names_.end());
+  for (auto &name : cuda_graph_feed_names_) {
+    auto *tensor = FindTensor(name);
+    graph->feeds.emplace_back(tensor, LoDTensor());
+    graph->feeds.back().second.ShareDataWith(*tensor);
+  }
+  for (auto &name : scope_->LocalVarNames()) {
+    if (feed_names.count(name)) continue;
+    auto *var = scope_->FindLocalVar(name);
+    if (!var->IsType<LoDTensor>()) continue;
+    auto *tensor = var->GetMutable<LoDTensor>();
+    if (!tensor->IsInitialized()) continue;
+    graph->tensors.emplace_back(tensor, LoDTensor());
+    auto &captured = graph->tensors.back().second;
+    captured.ShareDataWith(*tensor);
+    captured.set_lod(tensor->lod());
+  }
+  VLOG(3) << "Capture " << ops_.size() << " ops into a CUDA graph, "
+          << cuda_graphs_.size() + 1 << " graphs are captured";
+  cuda_graphs_.emplace(key, std::move(graph));
+#else
+  RunOps();
+#endif
+}
+
 void NaiveExecutor::CleanFeedFetchOps() {
   std::vector<std::unique_ptr<OperatorBase>> ops;
   for (auto &op : ops_) {
@@ -14,9 +14,14 @@
 
 #pragma once
 
+#include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/memory/malloc.h"
 #include "paddle/fluid/framework/program_desc.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/platform/device_context.h"
@@ -30,7 +35,8 @@ namespace framework {
  */
 class NaiveExecutor {
  public:
-  explicit NaiveExecutor(const platform::Place& place) : place_(place) {}
+  explicit NaiveExecutor(const platform::Place& place);
+  ~NaiveExecutor();
 
   // Create child scope.
   // Create variables.
@@ -44,7 +50,9 @@ class NaiveExecutor {
   void CreateVariables(const ProgramDesc& desc, int block_id, bool persistable,
                        Scope* scope);
 
-  // Run all the operators.
+  // Run all the operators. The context of the run of the current thread, see
+  // ScopedRunContext, is checked before every op, and the run throws
+  // RunStoppedError at the op after it is cancelled or expired.
   void Run();
 
   // Get an tensor to operating directly, without the need for feed_ops.
@@ -54,15 +62,67 @@ class NaiveExecutor {
 
   void CleanFeedFetchOps();
 
+  // Back the temporary tensors with a single arena. The lifetimes are the
+  // indices of the first and last ops using the variables, not counting the
+  // feed and fetch ops. The buffers of the first Run are recorded, including
+  // the ones shared by ShareDataWith, and the arena is planned after that Run
+  // with the sizes of them. The later Runs reuse the arena without allocating
+  // the tensors, as long as the shapes do not grow.
+  void EnableMemoryPlan(
+      const std::unordered_map<std::string, std::pair<int, int>>& lifetimes);
+
+  // The size of the planned arena, 0 if it is not planned yet.
+  size_t MemoryPlanArenaSize() const {
+    return memory_arena_ ? memory_arena_->size() : 0;
+  }
+
+  // Capture the runs on GPU into CUDA graphs keyed by the shapes of the feed
+  // tensors, and replay them instead of launching the kernels one by one.
+  // The first Run of a shape runs the ops, and captures them again into a
+  // graph, the later Runs of the shape copy the feed tensors into the
+  // buffers of the graph if they are moved, replay it, and restore the
+  // tensors of the scope as they were captured. At most max_graphs shapes
+  // are captured, the others run the ops. The feed tensors with LoD are not
+  // captured, and the graphs are disabled if an op writes a tensor out of
+  // the device, or can not be captured, e.g., it synchronizes the stream.
+  void EnableCUDAGraph(const std::vector<std::string>& feed_names,
+                       size_t max_graphs);
+
+  // The number of the captured CUDA graphs.
+  size_t NumCUDAGraphs() const { return cuda_graphs_.size(); }
+
  protected:
   void CreateOps(const ProgramDesc& desc, int block_id,
                  bool with_feed_fetch_ops);
 
+  void RunOps();
+
+  void RunAndPlanMemory();
+
+  void RunWithCUDAGraph();
+
+  // Resolve the variables of the ops in the scope once, and bind them to the
+  // ops, which run without looking up the scope. It is done in the first Run,
+  // after all the variables are created, if
+  // FLAGS_enable_cache_runtime_context is set.
+  void BindVariables();
+
  private:
   const platform::Place place_;
   // Catch the required resource to avoid recreate.
   std::vector<std::unique_ptr<OperatorBase>> ops_;
   Scope* scope_;
+  bool variables_bound_{false};
+
+  std::unordered_map<std::string, std::pair<int, int>> memory_plan_lifetimes_;
+  bool memory_plan_pending_{false};
+  memory::AllocationPtr memory_arena_;
+
+  struct CUDAGraph;
+  std::vector<std::string> cuda_graph_feed_names_;
+  size_t max_cuda_graphs_{0};
+  bool cuda_graph_disabled_{false};
+  std::map<std::vector<int64_t>, std::unique_ptr<CUDAGraph>> cuda_graphs_;
 };
 
 }  // namespace framework
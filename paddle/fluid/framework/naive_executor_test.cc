@@ -17,6 +17,10 @@
 #include <algorithm>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/run_context.h"
+#include "paddle/fluid/framework/tensor_util.h"
+
+DECLARE_bool(enable_cache_runtime_context);
 
 namespace paddle {
 namespace framework {
@@ -64,6 +68,224 @@ TEST(NaiveExecutor, Basic) {
   }
 }
 
+TEST(NaiveExecutor, MemoryPlan) {
+  ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  for (auto name : {"a", "b", "c", "d", "e", "f"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  // c = a + b, d = c + b, e = d + b, f = e + b
+  const char* outputs[][2] = {{"a", "c"}, {"c", "d"}, {"d", "e"}, {"e", "f"}};
+  for (auto& io : outputs) {
+    auto* add = main_block->AppendOp();
+    add->SetType("elementwise_add");
+    add->SetInput("X", {io[0]});
+    add->SetInput("Y", {"b"});
+    add->SetOutput("Out", {io[1]});
+  }
+
+  auto place = platform::CPUPlace();
+  Scope scope;
+  NaiveExecutor exe(place);
+  exe.CreateVariables(program, 0, false, &scope);
+  exe.Prepare(&scope, program, 0, false);
+  exe.EnableMemoryPlan({{"c", {0, 1}}, {"d", {1, 2}}, {"e", {2, 3}}});
+
+  auto* a_tensor = exe.FindTensor("a");
+  auto* b_tensor = exe.FindTensor("b");
+  a_tensor->Resize({1, 4});
+  b_tensor->Resize({1, 4});
+  float a_arr[] = {0, 1, 2, 3};
+  std::copy_n(a_arr, 4, a_tensor->mutable_data<float>(place));
+  std::fill_n(b_tensor->mutable_data<float>(place), 4, 1.f);
+
+  for (int run = 0; run < 3; ++run) {
+    exe.Run();
+    auto* f_tensor = exe.FindTensor("f");
+    for (int i = 0; i < 4; i++) {
+      EXPECT_NEAR(f_tensor->data<float>()[i], a_arr[i] + 4, 1e-5);
+    }
+    if (run == 0) {
+      // c and e are not alive at the same time.
+      EXPECT_GE(exe.MemoryPlanArenaSize(), 512UL);
+      EXPECT_LT(exe.MemoryPlanArenaSize(), 768UL);
+    } else {
+      EXPECT_EQ(exe.FindTensor("c")->data<float>(),
+                exe.FindTensor("e")->data<float>());
+      EXPECT_NE(exe.FindTensor("c")->data<float>(),
+                exe.FindTensor("d")->data<float>());
+    }
+  }
+}
+
+TEST(NaiveExecutor, BindVariables) {
+  ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  for (auto name : {"a", "b", "c", "d"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  // c = a + b, d = c + a
+  const char* inputs[][3] = {{"a", "b", "c"}, {"c", "a", "d"}};
+  for (auto& io : inputs) {
+    auto* add = main_block->AppendOp();
+    add->SetType("elementwise_add");
+    add->SetInput("X", {io[0]});
+    add->SetInput("Y", {io[1]});
+    add->SetOutput("Out", {io[2]});
+  }
+
+  auto place = platform::CPUPlace();
+  Scope scope;
+  NaiveExecutor exe(place);
+  exe.CreateVariables(program, 0, false, &scope);
+  exe.Prepare(&scope, program, 0, false);
+
+  FLAGS_enable_cache_runtime_context = true;
+  auto* a_tensor = exe.FindTensor("a");
+  auto* b_tensor = exe.FindTensor("b");
+  a_tensor->Resize({1, 4});
+  b_tensor->Resize({1, 4});
+  std::fill_n(b_tensor->mutable_data<float>(place), 4, 1.f);
+  for (int run = 0; run < 3; ++run) {
+    // The bound variables see the new values and shapes of the tensors.
+    a_tensor->Resize({1, 4 + run % 2});
+    std::fill_n(a_tensor->mutable_data<float>(place), 4 + run % 2,
+                static_cast<float>(run));
+    b_tensor->Resize({1, 4 + run % 2});
+    std::fill_n(b_tensor->mutable_data<float>(place), 4 + run % 2, 1.f);
+    exe.Run();
+    auto* d_tensor = exe.FindTensor("d");
+    ASSERT_EQ(d_tensor->numel(), 4 + run % 2);
+    for (int i = 0; i < d_tensor->numel(); i++) {
+      EXPECT_NEAR(d_tensor->data<float>()[i], 2 * run + 1, 1e-5);
+    }
+  }
+  FLAGS_enable_cache_runtime_context = false;
+}
+
+TEST(NaiveExecutor, BindMissingVariables) {
+  ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  // b is not created by CreateVariables.
+  for (auto name : {"a", "c"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  auto* add = main_block->AppendOp();
+  add->SetType("elementwise_add");
+  add->SetInput("X", {"a"});
+  add->SetInput("Y", {"b"});
+  add->SetOutput("Out", {"c"});
+
+  auto place = platform::CPUPlace();
+  Scope scope;
+  NaiveExecutor exe(place);
+  exe.CreateVariables(program, 0, false, &scope);
+  exe.Prepare(&scope, program, 0, false);
+
+  FLAGS_enable_cache_runtime_context = true;
+  auto* a_tensor = exe.FindTensor("a");
+  a_tensor->Resize({1, 4});
+  std::fill_n(a_tensor->mutable_data<float>(place), 4, 1.f);
+  EXPECT_ANY_THROW(exe.Run());
+
+  // b is looked up again after the variables are bound.
+  auto* b_tensor = scope.Var("b")->GetMutable<LoDTensor>();
+  b_tensor->Resize({1, 4});
+  std::fill_n(b_tensor->mutable_data<float>(place), 4, 2.f);
+  exe.Run();
+  auto* c_tensor = exe.FindTensor("c");
+  ASSERT_EQ(c_tensor->numel(), 4);
+  for (int i = 0; i < c_tensor->numel(); i++) {
+    EXPECT_NEAR(c_tensor->data<float>()[i], 3, 1e-5);
+  }
+  FLAGS_enable_cache_runtime_context = false;
+}
+
+TEST(NaiveExecutor, RunContext) {
+  ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  for (auto name : {"a", "b", "c"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  auto* add = main_block->AppendOp();
+  add->SetType("elementwise_add");
+  add->SetInput("X", {"a"});
+  add->SetInput("Y", {"b"});
+  add->SetOutput("Out", {"c"});
+
+  auto place = platform::CPUPlace();
+  Scope scope;
+  NaiveExecutor exe(place);
+  exe.CreateVariables(program, 0, false, &scope);
+  exe.Prepare(&scope, program, 0, false);
+  for (auto name : {"a", "b"}) {
+    auto* tensor = exe.FindTensor(name);
+    tensor->Resize({1, 4});
+    std::fill_n(tensor->mutable_data<float>(place), 4, 1.f);
+  }
+
+  RunContext ctx;
+  {
+    ScopedRunContext run_scope(&ctx);
+    exe.Run();
+    EXPECT_TRUE(exe.FindTensor("c")->IsInitialized());
+    exe.FindTensor("c")->clear();
+
+    // The ops after the cancellation are not run.
+    ctx.Cancel();
+    EXPECT_THROW(exe.Run(), RunStoppedError);
+    EXPECT_FALSE(exe.FindTensor("c")->IsInitialized());
+  }
+  exe.Run();
+  EXPECT_NEAR(exe.FindTensor("c")->data<float>()[0], 2.f, 1e-5);
+}
+
+#if defined(PADDLE_WITH_CUDA) && CUDA_VERSION >= 10010
+TEST(NaiveExecutor, CUDAGraph) {
+  ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  for (auto name : {"a", "b", "c", "d"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  // c = a + b, d = c + b
+  const char* outputs[][2] = {{"a", "c"}, {"c", "d"}};
+  for (auto& io : outputs) {
+    auto* add = main_block->AppendOp();
+    add->SetType("elementwise_add");
+    add->SetInput("X", {io[0]});
+    add->SetInput("Y", {"b"});
+    add->SetOutput("Out", {io[1]});
+  }
+
+  platform::CUDAPlace place(0);
+  Scope scope;
+  NaiveExecutor exe(place);
+  exe.CreateVariables(program, 0, false, &scope);
+  exe.Prepare(&scope, program, 0, false);
+  exe.EnableCUDAGraph({"a", "b"}, 2);
+
+  LoDTensor host;
+  for (int run = 0; run < 6; ++run) {
+    // Two shapes are captured, and replayed with new values.
+    int64_t width = 4 + run % 2;
+    host.Resize({1, width});
+    std::fill_n(host.mutable_data<float>(platform::CPUPlace()), width,
+                static_cast<float>(run));
+    TensorCopySync(host, place, exe.FindTensor("a"));
+    std::fill_n(host.mutable_data<float>(platform::CPUPlace()), width, 1.f);
+    TensorCopySync(host, place, exe.FindTensor("b"));
+    exe.Run();
+    EXPECT_EQ(exe.NumCUDAGraphs(), std::min<size_t>(run + 1, 2));
+
+    TensorCopySync(*exe.FindTensor("d"), platform::CPUPlace(), &host);
+    ASSERT_EQ(host.numel(), width);
+    for (int i = 0; i < width; i++) {
+      EXPECT_NEAR(host.data<float>()[i], run + 2, 1e-5);
+    }
+  }
+}
+#endif
+
 }  // namespace framework
 }  // namespace paddle
 
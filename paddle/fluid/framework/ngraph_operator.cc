@@ -12,10 +12,16 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <gflags/gflags.h>
 #include <glog/logging.h>
 
 #include <algorithm>
+#include <atomic>
+#include <list>
 #include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <utility>
 
 #include "paddle/fluid/framework/feed_fetch_type.h"
 #include "paddle/fluid/framework/framework.pb.h"
@@ -23,11 +29,21 @@ limitations under the License. */
 #include "paddle/fluid/framework/ngraph_bridge.h"
 #include "paddle/fluid/framework/ngraph_operator.h"
 #include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/framework/threadpool.h"
 #include "paddle/fluid/framework/var_desc.h"
 #include "paddle/fluid/framework/var_type.h"
 
 #include "ngraph/ngraph.hpp"
 
+DEFINE_int32(ngraph_function_cache_capacity, 64,
+             "The number of the compiled nGraph functions kept for the "
+             "different ops and input shapes, the least recently used ones "
+             "are dropped beyond it. 0 means no limit.");
+DEFINE_bool(ngraph_async_compile, true,
+            "Compile the nGraph functions of the new input shapes in the "
+            "background, the fused ops run with the Paddle kernels until "
+            "the compilation finishes.");
+
 namespace paddle {
 namespace framework {
 
@@ -56,6 +72,70 @@ typedef enum {                /* nGraph support state on ops          */
                PARTIAL_TEST   /* Support partial list of ops for test */
 } op_state;
 
+// The nGraph functions compiled for the fused ops, keyed by the ops and the
+// shapes of their inputs and outputs, see NgraphEngine::GetCacheKey.
+class NgraphFunctionCache {
+ public:
+  using Handle = decltype(std::declval<ngraph::runtime::Backend&>().compile(
+      std::shared_ptr<ngraph::Function>()));
+
+  struct Entry {
+    explicit Entry(std::shared_ptr<ngraph::Function> func)
+        : function(std::move(func)) {}
+
+    std::shared_ptr<ngraph::Function> function;
+    // Valid once compiled is set.
+    Handle handle;
+    std::atomic<bool> compiled{false};
+  };
+
+  static NgraphFunctionCache& Instance() {
+    static NgraphFunctionCache cache;
+    return cache;
+  }
+
+  // Returns nullptr if the key is not cached.
+  std::shared_ptr<Entry> Get(const std::string& key) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) return nullptr;
+    lru_.splice(lru_.begin(), lru_, it->second.second);
+    return it->second.first;
+  }
+
+  // Add the function of the key, unless another one is added first, and
+  // returns the cached entry. `inserted` tells whether it is new.
+  std::shared_ptr<Entry> Insert(const std::string& key,
+                                std::shared_ptr<ngraph::Function> func,
+                                bool* inserted) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = entries_.find(key);
+    *inserted = it == entries_.end();
+    if (!*inserted) return it->second.first;
+
+    size_t capacity = static_cast<size_t>(
+        std::max(FLAGS_ngraph_function_cache_capacity, 0));
+    while (capacity > 0 && entries_.size() >= capacity) {
+      // The entries being compiled or run are held by their users.
+      entries_.erase(lru_.back());
+      lru_.pop_back();
+    }
+    lru_.push_front(key);
+    auto entry = std::make_shared<Entry>(std::move(func));
+    entries_.emplace(key, std::make_pair(entry, lru_.begin()));
+    return entry;
+  }
+
+ private:
+  std::mutex mutex_;
+  // The keys from the most recently used one.
+  std::list<std::string> lru_;
+  std::unordered_map<std::string,
+                     std::pair<std::shared_ptr<Entry>,
+                               std::list<std::string>::iterator>>
+      entries_;
+};
+
 // perform graph build through bridge and execute computation
 class NgraphEngine {
  public:
@@ -89,8 +169,6 @@ class NgraphEngine {
   void Run(const Scope& scope, const platform::Place& place) const;
 
  private:
-  static std::unordered_map<std::string, std::shared_ptr<ngraph::Function>>
-      func_cache_;
   const Scope& scope_;
   const platform::Place& place_;
   std::vector<std::shared_ptr<OperatorBase>> fused_ops_;
@@ -104,6 +182,8 @@ class NgraphEngine {
   static std::shared_ptr<ngraph::runtime::Backend> backend_;
   // ngraph function to call and execute
   std::shared_ptr<ngraph::Function> ngraph_function_;
+  // the cached function and its compiled handle
+  std::shared_ptr<NgraphFunctionCache::Entry> cache_entry_;
   // var_name of inputs
   std::vector<std::string> var_in_;
   // var_name of outputs from  fetch in order
@@ -128,6 +208,8 @@ class NgraphEngine {
   void BuildNgFunction();
   // Check cache for ngraph function or otherwise build the function
   void GetNgFunction();
+  // Compile the function of the entry, the compilations are serialized.
+  static void Compile(std::shared_ptr<NgraphFunctionCache::Entry> entry);
 };
 
 std::vector<std::vector<std::vector<std::unique_ptr<OperatorBase>>::iterator>>
@@ -271,9 +353,6 @@ void NgraphOperator::RunImpl(const Scope& scope,
   ngraph_engine.Run(scope, place);
 }
 
-std::unordered_map<std::string, std::shared_ptr<ngraph::Function>>
-    NgraphEngine::func_cache_ = {};
-
 std::shared_ptr<ngraph::runtime::Backend> NgraphEngine::backend_ =
     ngraph::runtime::Backend::create("CPU");
 
@@ -445,21 +524,48 @@ std::shared_ptr<std::string> NgraphEngine::GetCacheKey() {
 }
 
 void NgraphEngine::GetNgFunction() {
-  bool cache_on = true;
-  if (cache_on) {
-    std::string cache_key_val = *GetCacheKey();
-    if (func_cache_.find(cache_key_val) != func_cache_.end()) {
-      ngraph_function_ = func_cache_.at(cache_key_val);
-    } else {
-      BuildNgFunction();
-      func_cache_[cache_key_val] = ngraph_function_;
-    }
-  } else {
+  std::string cache_key_val = *GetCacheKey();
+  auto& cache = NgraphFunctionCache::Instance();
+  cache_entry_ = cache.Get(cache_key_val);
+  if (cache_entry_ == nullptr) {
     BuildNgFunction();
+    bool inserted = false;
+    cache_entry_ = cache.Insert(cache_key_val, ngraph_function_, &inserted);
+    if (inserted) {
+      if (FLAGS_ngraph_async_compile) {
+        VLOG(3) << "Compile the nGraph function in the background";
+        auto entry = cache_entry_;
+        framework::Async([entry] { Compile(entry); });
+      } else {
+        Compile(cache_entry_);
+      }
+    }
+  }
+  ngraph_function_ = cache_entry_->function;
+}
+
+void NgraphEngine::Compile(std::shared_ptr<NgraphFunctionCache::Entry> entry) {
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> guard(mutex);
+  try {
+    entry->handle = backend_->compile(entry->function);
+    entry->compiled = true;
+  } catch (std::exception& e) {
+    LOG(ERROR) << "Failed to compile the nGraph function, the Paddle kernels "
+                  "are used instead: "
+               << e.what();
   }
 }
 
 void NgraphEngine::Run(const Scope& scope, const platform::Place& place) const {
+  if (!cache_entry_->compiled) {
+    // The function of the shapes is being compiled, or fails to compile.
+    for (auto& op : fused_ops_) {
+      op->Run(scope, place);
+    }
+    return;
+  }
+
   std::vector<std::shared_ptr<ngraph::runtime::Tensor>> t_in;
   std::vector<std::shared_ptr<ngraph::runtime::Tensor>> t_out;
 
@@ -539,7 +645,7 @@ void NgraphEngine::Run(const Scope& scope, const platform::Place& place) const {
     }
   }
 
-  backend_->call(backend_->compile(ngraph_function_), t_out, t_in);
+  backend_->call(cache_entry_->handle, t_out, t_in);
 }  // NgraphEngine::RunImpl
 }  // namespace framework
 }  // namespace paddle
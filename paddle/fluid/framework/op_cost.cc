@@ -0,0 +1,183 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/op_cost.h"
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/selected_rows.h"
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+double Numel(const DDim& dims) { return static_cast<double>(product(dims)); }
+
+// Out = X * Y, in which X and Y are flattened to the matrices.
+bool MulCost(const OpCostContext& ctx, OpCost* cost) {
+  if (!ctx.HasInput("X") || !ctx.HasInput("Y")) return false;
+  auto x_mat = flatten_to_2d(ctx.InputDim("X"), ctx.Attr("x_num_col_dims", 1));
+  auto y_mat = flatten_to_2d(ctx.InputDim("Y"), ctx.Attr("y_num_col_dims", 1));
+  double m = x_mat[0], k = x_mat[1], n = y_mat[1];
+  cost->flops = 2 * m * k * n;
+  cost->bytes = (m * k + k * n + m * n) * ctx.InputElementSize("X");
+  return true;
+}
+
+bool MatMulCost(const OpCostContext& ctx, OpCost* cost) {
+  if (!ctx.HasInput("X") || !ctx.HasInput("Y") || !ctx.HasOutput("Out")) {
+    return false;
+  }
+  auto& x_dims = ctx.InputDim("X");
+  double k = x_dims[x_dims.size() - 1];
+  if (x_dims.size() > 1 && ctx.Attr("transpose_X", false)) {
+    k = x_dims[x_dims.size() - 2];
+  }
+  double out_numel = Numel(ctx.OutputDim("Out"));
+  cost->flops = 2 * out_numel * k;
+  cost->bytes = (Numel(x_dims) + Numel(ctx.InputDim("Y")) + out_numel) *
+                ctx.InputElementSize("X");
+  return true;
+}
+
+// Every output element is the sum over the Filter of one output channel.
+bool ConvCost(const OpCostContext& ctx, OpCost* cost) {
+  if (!ctx.HasInput("Input") || !ctx.HasInput("Filter") ||
+      !ctx.HasOutput("Output")) {
+    return false;
+  }
+  auto& filter_dims = ctx.InputDim("Filter");
+  double out_numel = Numel(ctx.OutputDim("Output"));
+  double filter_numel = Numel(filter_dims);
+  cost->flops = 2 * out_numel * filter_numel / filter_dims[0];
+  cost->bytes = (Numel(ctx.InputDim("Input")) + filter_numel + out_numel) *
+                ctx.InputElementSize("Input");
+  return true;
+}
+
+bool ElementwiseCost(const OpCostContext& ctx, OpCost* cost) {
+  if (!ctx.HasInput("X") || !ctx.HasInput("Y")) return false;
+  double x_numel = Numel(ctx.InputDim("X"));
+  cost->flops = x_numel;
+  cost->bytes =
+      (2 * x_numel + Numel(ctx.InputDim("Y"))) * ctx.InputElementSize("X");
+  return true;
+}
+
+// The inference normalizes X by the global stats, which is 4 flops for each
+// element, and the training also computes the mean and the variance in
+// another pass over X.
+bool BatchNormCost(const OpCostContext& ctx, OpCost* cost) {
+  if (!ctx.HasInput("X")) return false;
+  double x_numel = Numel(ctx.InputDim("X"));
+  bool global_stats =
+      ctx.Attr("is_test", false) || ctx.Attr("use_global_stats", false);
+  cost->flops = (global_stats ? 4 : 8) * x_numel;
+  cost->bytes = (global_stats ? 2 : 3) * x_numel * ctx.InputElementSize("X");
+  return true;
+}
+
+// Only the rows of the ids are read from the table.
+bool LookupTableCost(const OpCostContext& ctx, OpCost* cost) {
+  if (!ctx.HasInput("Ids") || !ctx.HasInput("W") || !ctx.HasOutput("Out")) {
+    return false;
+  }
+  double out_numel = Numel(ctx.OutputDim("Out"));
+  cost->flops = 0;
+  cost->bytes = 2 * out_numel * ctx.InputElementSize("W") +
+                Numel(ctx.InputDim("Ids")) * ctx.InputElementSize("Ids");
+  return true;
+}
+
+// Collect the dims of the variables of the slots, the slots with a variable
+// of no dims are skipped.
+void CollectRuntimeDims(
+    const VariableNameMap& var_names, const Scope& scope,
+    std::unordered_map<std::string, std::vector<DDim>>* dims,
+    std::unordered_map<std::string, size_t>* element_sizes) {
+  for (auto& item : var_names) {
+    std::vector<DDim> slot_dims;
+    size_t element_size = 0;
+    for (auto& name : item.second) {
+      auto* var = scope.FindVar(name);
+      const Tensor* tensor = nullptr;
+      if (var != nullptr && var->IsType<LoDTensor>()) {
+        tensor = &var->Get<LoDTensor>();
+      } else if (var != nullptr && var->IsType<SelectedRows>()) {
+        tensor = &var->Get<SelectedRows>().value();
+      }
+      if (tensor == nullptr || !tensor->IsInitialized()) break;
+      slot_dims.emplace_back(tensor->dims());
+      element_size = SizeOfType(tensor->type());
+    }
+    if (!item.second.empty() && slot_dims.size() == item.second.size()) {
+      dims->emplace(item.first, std::move(slot_dims));
+      if (element_sizes != nullptr) {
+        element_sizes->emplace(item.first, element_size);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+OpCostRegistry& OpCostRegistry::Instance() {
+  static OpCostRegistry registry;
+  return registry;
+}
+
+OpCostRegistry::OpCostRegistry() {
+  Register("mul", MulCost);
+  Register("matmul", MatMulCost);
+  Register("conv2d", ConvCost);
+  Register("depthwise_conv2d", ConvCost);
+  Register("conv3d", ConvCost);
+  for (auto* type :
+       {"elementwise_add", "elementwise_sub", "elementwise_mul",
+        "elementwise_div", "elementwise_max", "elementwise_min"}) {
+    Register(type, ElementwiseCost);
+  }
+  Register("batch_norm", BatchNormCost);
+  Register("lookup_table", LookupTableCost);
+}
+
+void OpCostRegistry::Register(const std::string& op_type, OpCostFunc func) {
+  PADDLE_ENFORCE(funcs_.count(op_type) == 0,
+                 "The cost of %s has been registered.", op_type);
+  funcs_.emplace(op_type, std::move(func));
+}
+
+bool OpCostRegistry::GetCost(const std::string& op_type,
+                             const OpCostContext& ctx, OpCost* cost) const {
+  auto it = funcs_.find(op_type);
+  if (it == funcs_.end()) return false;
+  return it->second(ctx, cost);
+}
+
+bool OpCostRegistry::GetCost(const std::string& op_type,
+                             const VariableNameMap& inputs,
+                             const VariableNameMap& outputs,
+                             const AttributeMap& attrs, const Scope& scope,
+                             OpCost* cost) const {
+  auto it = funcs_.find(op_type);
+  if (it == funcs_.end()) return false;
+  OpCostContext ctx(attrs);
+  CollectRuntimeDims(inputs, scope, &ctx.input_dims,
+                     &ctx.input_element_sizes);
+  CollectRuntimeDims(outputs, scope, &ctx.output_dims, nullptr);
+  return it->second(ctx, cost);
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,111 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/attribute.h"
+#include "paddle/fluid/framework/ddim.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/type_defs.h"
+
+namespace paddle {
+namespace framework {
+
+// The cost of one run of an operator, in which a multiply-add is counted as
+// 2 flops, and the bytes are the minimal traffic to read the inputs and
+// write the outputs.
+struct OpCost {
+  double flops{0};
+  double bytes{0};
+};
+
+// The dims of the inputs and the outputs of an operator, which are taken
+// from the tensors in the scope at run time, or from the VarDescs at compile
+// time.
+struct OpCostContext {
+  explicit OpCostContext(const AttributeMap& attrs) : attrs(attrs) {}
+
+  bool HasInput(const std::string& name) const {
+    return input_dims.count(name) != 0;
+  }
+  bool HasOutput(const std::string& name) const {
+    return output_dims.count(name) != 0;
+  }
+  // The dims of the first variable of the input slot.
+  const DDim& InputDim(const std::string& name) const {
+    return input_dims.at(name).front();
+  }
+  const DDim& OutputDim(const std::string& name) const {
+    return output_dims.at(name).front();
+  }
+  // The size of the data type of the input slot.
+  size_t InputElementSize(const std::string& name) const {
+    return input_element_sizes.at(name);
+  }
+  template <typename T>
+  T Attr(const std::string& name, const T& default_value) const {
+    auto it = attrs.find(name);
+    return it == attrs.end() ? default_value : boost::get<T>(it->second);
+  }
+
+  const AttributeMap& attrs;
+  // Only the slots whose variables all have dims are kept.
+  std::unordered_map<std::string, std::vector<DDim>> input_dims;
+  std::unordered_map<std::string, std::vector<DDim>> output_dims;
+  std::unordered_map<std::string, size_t> input_element_sizes;
+};
+
+// Compute the cost, return false if the dims needed are not available.
+using OpCostFunc = std::function<bool(const OpCostContext&, OpCost*)>;
+
+/*
+ * The cost models of the operators, which are used by the profiler to
+ * report the achieved GFLOP/s and GB/s, and can be queried by the IR passes,
+ * e.g. by ir::GetOpCost of graph_helper.h. The cost models of mul, matmul,
+ * conv2d, the elementwise ops, batch_norm and lookup_table are registered
+ * by default.
+ */
+class OpCostRegistry {
+ public:
+  static OpCostRegistry& Instance();
+
+  void Register(const std::string& op_type, OpCostFunc func);
+
+  bool Has(const std::string& op_type) const {
+    return funcs_.count(op_type) != 0;
+  }
+
+  // Get the cost by the context, return false if the op has no cost model
+  // or its dims are not available.
+  bool GetCost(const std::string& op_type, const OpCostContext& ctx,
+               OpCost* cost) const;
+
+  // Get the cost of the op at run time by the tensors in the scope.
+  bool GetCost(const std::string& op_type, const VariableNameMap& inputs,
+               const VariableNameMap& outputs, const AttributeMap& attrs,
+               const Scope& scope, OpCost* cost) const;
+
+ private:
+  OpCostRegistry();
+
+  std::unordered_map<std::string, OpCostFunc> funcs_;
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,82 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/op_cost.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace framework {
+
+static void CreateTensor(Scope* scope, const std::string& name,
+                         const std::vector<int64_t>& dims) {
+  auto* tensor = scope->Var(name)->GetMutable<LoDTensor>();
+  tensor->Resize(make_ddim(dims));
+  tensor->mutable_data<float>(platform::CPUPlace());
+}
+
+TEST(OpCostRegistry, Mul) {
+  Scope scope;
+  CreateTensor(&scope, "x", {4, 2, 8});
+  CreateTensor(&scope, "y", {16, 32});
+  CreateTensor(&scope, "out", {4, 32});
+  AttributeMap attrs;
+  attrs["x_num_col_dims"] = 1;
+
+  OpCost cost;
+  ASSERT_TRUE(OpCostRegistry::Instance().GetCost(
+      "mul", {{"X", {"x"}}, {"Y", {"y"}}}, {{"Out", {"out"}}}, attrs, scope,
+      &cost));
+  EXPECT_DOUBLE_EQ(cost.flops, 2 * 4 * 16 * 32);
+  EXPECT_DOUBLE_EQ(cost.bytes, (4 * 16 + 16 * 32 + 4 * 32) * sizeof(float));
+
+  // The dims of y are not available.
+  EXPECT_FALSE(OpCostRegistry::Instance().GetCost(
+      "mul", {{"X", {"x"}}, {"Y", {"z"}}}, {{"Out", {"out"}}}, attrs, scope,
+      &cost));
+  EXPECT_FALSE(OpCostRegistry::Instance().GetCost("relu", {{"X", {"x"}}},
+                                                  {{"Out", {"out"}}}, attrs,
+                                                  scope, &cost));
+}
+
+TEST(OpCostRegistry, Conv2d) {
+  Scope scope;
+  CreateTensor(&scope, "input", {2, 8, 16, 16});
+  CreateTensor(&scope, "filter", {4, 8, 3, 3});
+  CreateTensor(&scope, "output", {2, 4, 14, 14});
+  OpCost cost;
+  ASSERT_TRUE(OpCostRegistry::Instance().GetCost(
+      "conv2d", {{"Input", {"input"}}, {"Filter", {"filter"}}},
+      {{"Output", {"output"}}}, AttributeMap(), scope, &cost));
+  EXPECT_DOUBLE_EQ(cost.flops, 2.0 * 2 * 4 * 14 * 14 * 8 * 3 * 3);
+}
+
+TEST(OpCostRegistry, LookupTable) {
+  Scope scope;
+  auto* ids = scope.Var("ids")->GetMutable<LoDTensor>();
+  ids->Resize({10, 1});
+  ids->mutable_data<int64_t>(platform::CPUPlace());
+  CreateTensor(&scope, "w", {1000, 64});
+  CreateTensor(&scope, "out", {10, 64});
+  OpCost cost;
+  ASSERT_TRUE(OpCostRegistry::Instance().GetCost(
+      "lookup_table", {{"Ids", {"ids"}}, {"W", {"w"}}}, {{"Out", {"out"}}},
+      AttributeMap(), scope, &cost));
+  EXPECT_DOUBLE_EQ(cost.flops, 0);
+  EXPECT_DOUBLE_EQ(cost.bytes,
+                   2 * 10 * 64 * sizeof(float) + 10 * sizeof(int64_t));
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -252,7 +252,15 @@ void OpDesc::CopyFrom(const OpDesc &op_desc) {
   desc_.set_type(op_desc.Type());
   inputs_ = op_desc.inputs_;
   outputs_ = op_desc.outputs_;
-  attrs_ = op_desc.attrs_;
+  if (op_desc.attrs_decoded_.value.load(std::memory_order_acquire)) {
+    attrs_ = op_desc.attrs_;
+    attrs_decoded_.value = true;
+  } else {
+    // The attrs are copied still encoded, and decoded if this op needs them.
+    attrs_.clear();
+    *desc_.mutable_attrs() = op_desc.desc_.attrs();
+    attrs_decoded_.value = false;
+  }
   need_update_ = true;
 }
 
@@ -280,17 +288,27 @@ OpDesc::OpDesc(const proto::OpDesc &desc, BlockDesc *block)
       args.push_back(var.arguments(j));
     }
   }
-  // restore attrs_
+  // attrs_ is restored by DecodeAttrs on the first access.
+  attrs_decoded_.value = false;
+  this->block_ = block;
+}
+
+void OpDesc::DecodeAttrs() const {
+  if (attrs_decoded_.value.load(std::memory_order_acquire)) return;
+  // The ops of a block may be read by several threads, e.g. the passes of
+  // the analysis, so the decoding of them is serialized.
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> lock(mutex);
+  if (attrs_decoded_.value.load(std::memory_order_relaxed)) return;
   for (const proto::OpDesc::Attr &attr : desc_.attrs()) {
-    std::string attr_name = attr.name();
     // The sub_block referred to by the BLOCK attr hasn't been added
     // to ProgramDesc class yet, we skip setting BLOCK/BLOCKS attr here.
     if (attr.type() != proto::AttrType::BLOCK &&
         attr.type() != proto::AttrType::BLOCKS) {
-      attrs_[attr_name] = GetAttrValue(attr);
+      attrs_[attr.name()] = GetAttrValue(attr);
     }
   }
-  this->block_ = block;
+  attrs_decoded_.value.store(true, std::memory_order_release);
 }
 
 proto::OpDesc *OpDesc::Proto() {
@@ -358,12 +376,14 @@ bool OpDesc::HasProtoAttr(const std::string &name) const {
 }
 
 proto::AttrType OpDesc::GetAttrType(const std::string &name) const {
+  DecodeAttrs();
   auto it = attrs_.find(name);
   PADDLE_ENFORCE(it != attrs_.end(), "Attribute %s is not found", name);
   return static_cast<proto::AttrType>(it->second.which() - 1);
 }
 
 std::vector<std::string> OpDesc::AttrNames() const {
+  DecodeAttrs();
   std::vector<std::string> retv;
   retv.reserve(attrs_.size());
   for (auto &attr : attrs_) {
@@ -372,7 +392,22 @@ std::vector<std::string> OpDesc::AttrNames() const {
   return retv;
 }
 
+std::vector<std::string> OpDesc::BlockAttrNames() const {
+  std::vector<std::string> retv;
+  // The BLOCK and BLOCKS attrs are only set by SetBlockAttr and
+  // SetBlocksAttr, which decode the attrs first.
+  if (!attrs_decoded_.value.load(std::memory_order_acquire)) return retv;
+  for (auto &attr : attrs_) {
+    auto type = static_cast<proto::AttrType>(attr.second.which() - 1);
+    if (type == proto::AttrType::BLOCK || type == proto::AttrType::BLOCKS) {
+      retv.push_back(attr.first);
+    }
+  }
+  return retv;
+}
+
 void OpDesc::SetAttr(const std::string &name, const Attribute &v) {
+  DecodeAttrs();
   // NOTICE(minqiyang): pybind11 will take the empty list in python as
   // the std::vector<int> type in C++; so we have to change the attr's type
   // here if we meet this issue
@@ -430,12 +465,14 @@ void OpDesc::SetAttr(const std::string &name, const Attribute &v) {
 }
 
 void OpDesc::SetBlockAttr(const std::string &name, BlockDesc *block) {
+  DecodeAttrs();
   this->attrs_[name] = block;
   need_update_ = true;
 }
 
 void OpDesc::SetBlocksAttr(const std::string &name,
                            std::vector<BlockDesc *> blocks) {
+  DecodeAttrs();
   this->attrs_[name] = blocks;
   need_update_ = true;
 }
@@ -443,10 +480,12 @@ void OpDesc::SetBlocksAttr(const std::string &name,
 void OpDesc::SetAttrMap(
     const std::unordered_map<std::string, Attribute> &attr_map) {
   attrs_ = attr_map;
+  attrs_decoded_.value = true;
   need_update_ = true;
 }
 
 Attribute OpDesc::GetAttr(const std::string &name) const {
+  DecodeAttrs();
   auto it = attrs_.find(name);
   PADDLE_ENFORCE(it != attrs_.end(), "Attribute %s is not found", name);
   return it->second;
@@ -466,6 +505,7 @@ const proto::OpProto::Attr &OpDesc::GetProtoAttr(
 }
 
 Attribute OpDesc::GetNullableAttr(const std::string &name) const {
+  DecodeAttrs();
   auto it = attrs_.find(name);
   if (it != attrs_.end()) {
     return it->second;
@@ -475,6 +515,7 @@ Attribute OpDesc::GetNullableAttr(const std::string &name) const {
 }
 
 std::vector<int> OpDesc::GetBlocksAttrIds(const std::string &name) const {
+  DecodeAttrs();
   auto it = attrs_.find(name);
   PADDLE_ENFORCE(it != attrs_.end(), "Attribute %s is not found", name);
   auto blocks = boost::get<std::vector<BlockDesc *>>(it->second);
@@ -488,12 +529,14 @@ std::vector<int> OpDesc::GetBlocksAttrIds(const std::string &name) const {
 }
 
 int OpDesc::GetBlockAttrId(const std::string &name) const {
+  DecodeAttrs();
   auto it = attrs_.find(name);
   PADDLE_ENFORCE(it != attrs_.end(), "Attribute %s is not found", name);
   return boost::get<BlockDesc *>(it->second)->ID();
 }
 
 const std::unordered_map<std::string, Attribute> &OpDesc::GetAttrMap() const {
+  DecodeAttrs();
   return attrs_;
 }
 
@@ -510,6 +553,7 @@ void OpDesc::RenameOutput(const std::string &old_name,
                  new_name);
   }
 
+  DecodeAttrs();
   auto it = attrs_.find(framework::OpProtoAndCheckerMaker::OpRoleVarAttrName());
   if (it != attrs_.end()) {
     auto &op_vars = boost::get<std::vector<std::string>>(it->second);
@@ -525,6 +569,7 @@ void OpDesc::RenameInput(const std::string &old_name,
     std::replace(input.second.begin(), input.second.end(), old_name, new_name);
   }
 
+  DecodeAttrs();
   auto it = attrs_.find(framework::OpProtoAndCheckerMaker::OpRoleVarAttrName());
   if (it != attrs_.end()) {
     auto &op_vars = boost::get<std::vector<std::string>>(it->second);
@@ -595,14 +640,17 @@ void OpDesc::Flush() {
       VectorToRepeated(opt.second, output->mutable_arguments());
     }
 
-    this->desc_.mutable_attrs()->Clear();
-    for (auto &attr : attrs_) {
-      auto *attr_desc = desc_.add_attrs();
-      attr_desc->set_name(attr.first);
-      attr_desc->set_type(
-          static_cast<proto::AttrType>(attr.second.which() - 1));
-      SetAttrDescVisitor visitor(attr_desc);
-      boost::apply_visitor(visitor, attr.second);
+    // The attrs which are not decoded are still up to date in desc_.
+    if (attrs_decoded_.value.load(std::memory_order_acquire)) {
+      this->desc_.mutable_attrs()->Clear();
+      for (auto &attr : attrs_) {
+        auto *attr_desc = desc_.add_attrs();
+        attr_desc->set_name(attr.first);
+        attr_desc->set_type(
+            static_cast<proto::AttrType>(attr.second.which() - 1));
+        SetAttrDescVisitor visitor(attr_desc);
+        boost::apply_visitor(visitor, attr.second);
+      }
     }
 
     need_update_ = false;
@@ -643,6 +691,7 @@ void OpDesc::CheckAttrs() {
     // not by users.
     return;
   }
+  DecodeAttrs();
   checker->Check(&attrs_);
 }
 
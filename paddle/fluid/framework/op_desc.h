@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -62,6 +63,7 @@ class OpDesc {
                  const std::vector<std::string> &args);
 
   bool HasAttr(const std::string &name) const {
+    DecodeAttrs();
     return attrs_.find(name) != attrs_.end();
   }
 
@@ -71,6 +73,10 @@ class OpDesc {
 
   std::vector<std::string> AttrNames() const;
 
+  // The names of the BLOCK and BLOCKS attrs. Unlike AttrNames, it does not
+  // decode the attrs of an op loaded from a proto.
+  std::vector<std::string> BlockAttrNames() const;
+
   void SetAttr(const std::string &name, const Attribute &v);
 
   void SetBlockAttr(const std::string &name, BlockDesc *block);
@@ -107,6 +113,7 @@ class OpDesc {
   const VariableNameMap &Outputs() const { return outputs_; }
 
   AttributeMap *MutableAttrMap() {
+    DecodeAttrs();
     this->need_update_ = true;
     return &this->attrs_;
   }
@@ -136,13 +143,31 @@ class OpDesc {
     return ret_val;
   }
 
+  // The attrs of an op loaded from a proto are decoded into attrs_ on the
+  // first access, most of the ops of a loaded or cloned program are never
+  // asked for them before they are run.
+  void DecodeAttrs() const;
+
+  // A copyable flag of whether attrs_ holds the attrs, or they are still
+  // only in desc_.
+  struct DecodedFlag {
+    DecodedFlag() = default;
+    DecodedFlag(const DecodedFlag &other) : value(other.value.load()) {}
+    DecodedFlag &operator=(const DecodedFlag &other) {
+      value = other.value.load();
+      return *this;
+    }
+    std::atomic<bool> value{true};
+  };
+
   proto::OpDesc desc_;
   BlockDesc *block_;  // not_own
   // input arg name => input variable names
   VariableNameMap inputs_;
   // output arg name => output variable names
   VariableNameMap outputs_;
-  AttributeMap attrs_;
+  mutable AttributeMap attrs_;
+  mutable DecodedFlag attrs_decoded_;
 
   // need_update_ indicate there some local changes not be synchronized. If
   // local changes should be synchronized, need_update_ should be set to true.
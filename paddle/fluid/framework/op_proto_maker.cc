@@ -81,6 +81,9 @@ void OpProtoAndCheckerMaker::operator()(proto::OpProto* proto,
 
   AddAttr<std::string>(OpNamescopeAttrName(), "Operator name with namesope.")
       .SetDefault("");
+  AddAttr<std::string>(OpDeviceAttrName(),
+                       "The device of the pipeline stage of the operator.")
+      .SetDefault("");
 
   Validate();
 }
@@ -47,6 +47,7 @@ class OpProtoAndCheckerMaker {
   static const char *OpRoleAttrName() { return "op_role"; }
   static const char *OpRoleVarAttrName() { return "op_role_var"; }
   static const char *OpNamescopeAttrName() { return "op_namescope"; }
+  static const char *OpDeviceAttrName() { return "op_device"; }
 
   void operator()(proto::OpProto *proto, OpAttrChecker *attr_checker);
 
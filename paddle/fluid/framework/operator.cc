@@ -19,16 +19,33 @@ limitations under the License. */
 #include "paddle/fluid/framework/data_transform.h"
 #include "paddle/fluid/framework/executor.h"
 #include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_cost.h"
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/framework/shape_inference.h"
 #include "paddle/fluid/framework/transfer_scope_cache.h"
 #include "paddle/fluid/framework/var_type.h"
 #include "paddle/fluid/platform/profiler.h"
+#include "paddle/fluid/platform/sampling_profiler.h"
 
 DECLARE_bool(benchmark);
 DEFINE_bool(check_nan_inf, false,
             "Checking whether operator produce NAN/INF or not. It will be "
             "extremely slow so please use this flag wisely.");
+DEFINE_bool(enable_cache_runtime_context, false,
+            "Cache the RuntimeContext and the chosen kernel of each operator "
+            "across runs. The cache is rebuilt when the scope, the place or "
+            "the data type, place and layout of the inputs change. It should "
+            "only be used when the ops always run in long-lived scopes, "
+            "e.g. NaiveExecutor in inference.");
+DEFINE_bool(enable_cache_infer_shape, false,
+            "Skip InferShape of an operator when the dims and LoD of its "
+            "inputs are the same as the last run, and restore the dims and "
+            "LoD of outputs computed last time instead. The hit rate can be "
+            "queried by InferShapeCache::GetStat.");
+DEFINE_bool(enable_cache_transformed_data, true,
+            "Keep the inputs transformed to the data type, layout or place of "
+            "the kernel across runs, until the memory of the origin inputs "
+            "is written, e.g. the parameters in inference.");
 
 namespace paddle {
 namespace framework {
@@ -173,6 +190,18 @@ void OperatorBase::Run(const Scope& scope, const platform::Place& place) {
     platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
     platform::RecordEvent record_event(Type(), pool.Get(place));
     RunImpl(scope, place);
+    OpCost cost;
+    if (OpCostRegistry::Instance().GetCost(Type(), Inputs(), Outputs(),
+                                           Attrs(), scope, &cost)) {
+      record_event.SetCost(cost.flops, cost.bytes);
+    }
+  } else if (platform::IsRunSampled()) {
+    platform::SampledEvent sampled_event(sampled_event_id_);
+    RunImpl(scope, place);
+    // Wait for the kernels, so that the latency of the op is recorded.
+    if (platform::is_gpu_place(place)) {
+      platform::DeviceContextPool::Instance().Get(place)->Wait();
+    }
   } else {
     RunImpl(scope, place);
   }
@@ -295,7 +324,11 @@ OperatorBase::OperatorBase(const std::string& type,
                            const VariableNameMap& inputs,
                            const VariableNameMap& outputs,
                            const AttributeMap& attrs)
-    : type_(type), inputs_(inputs), outputs_(outputs), attrs_(attrs) {
+    : type_(type),
+      inputs_(inputs),
+      outputs_(outputs),
+      attrs_(attrs),
+      sampled_event_id_(platform::SampledEventId(type)) {
   GenerateTemporaryNames();
   CheckAllInputOutputSet();
 }
@@ -875,9 +908,146 @@ void OperatorWithKernel::RuntimeInferShape(const Scope& scope,
   this->InferShape(&infer_shape_ctx);
 }
 
+// Call `func` on each initialized input tensor of `ctx`, stop when it returns
+// false.
+template <typename Func>
+static void VisitInputTensors(const RuntimeContext& ctx, Func&& func) {
+  for (auto& var_name_item : ctx.inputs) {
+    for (auto* var : var_name_item.second) {
+      if (var == nullptr || !VarIsTensor(*var)) {
+        continue;
+      }
+      auto* tensor = GetLoDTensorOrSelectedRowsValueFromVar(*var);
+      if (!tensor->IsInitialized()) {
+        continue;
+      }
+      if (!func(*tensor)) {
+        return;
+      }
+    }
+  }
+}
+
+static void CollectInputKernelTypes(const RuntimeContext& ctx,
+                                    std::vector<OpKernelType>* types) {
+  types->clear();
+  VisitInputTensors(ctx, [types](const Tensor& tensor) {
+    types->emplace_back(tensor.type(), tensor.place(), tensor.layout());
+    return true;
+  });
+}
+
+static bool InputKernelTypesChanged(const RuntimeContext& ctx,
+                                    const std::vector<OpKernelType>& types) {
+  size_t idx = 0;
+  bool changed = false;
+  VisitInputTensors(ctx, [&](const Tensor& tensor) {
+    changed = idx >= types.size() ||
+              OpKernelType(tensor.type(), tensor.place(), tensor.layout()) !=
+                  types[idx];
+    ++idx;
+    return !changed;
+  });
+  return changed || idx != types.size();
+}
+
 void OperatorWithKernel::RunImpl(const Scope& scope,
                                  const platform::Place& place) const {
-  RuntimeContext ctx(Inputs(), Outputs(), scope);
+  if (runtime_ctx_bound_) {
+    if (runtime_ctx_unresolved_) {
+      ResolveBoundRuntimeContext(scope);
+    }
+    UpdatePreparedCache(scope, place);
+    // The inputs are checked for the transforms in every run of a bound
+    // context, on a copy which PrepareData may change.
+    RuntimeContext ctx(*runtime_ctx_);
+    RunKernel(scope, place, *kernel_type_, kernel_func_, true, &ctx);
+    return;
+  }
+
+  if (!FLAGS_enable_cache_runtime_context) {
+    RuntimeContext ctx(Inputs(), Outputs(), scope);
+    OpKernelFunc kernel_func;
+    auto kernel_type = ChooseKernel(ctx, scope, place, &kernel_func);
+    RunKernel(scope, place, kernel_type, kernel_func, true, &ctx);
+    return;
+  }
+
+  UpdatePreparedCache(scope, place);
+  if (need_prepare_data_) {
+    // PrepareData replaces the transfered inputs in the RuntimeContext, so
+    // run on a copy to keep the cached one pointing to the origin variables.
+    RuntimeContext ctx(*runtime_ctx_);
+    need_prepare_data_ =
+        RunKernel(scope, place, *kernel_type_, kernel_func_, true, &ctx);
+  } else {
+    RunKernel(scope, place, *kernel_type_, kernel_func_, false,
+              runtime_ctx_.get());
+  }
+}
+
+void OperatorWithKernel::BindRuntimeContext(
+    const Scope& scope, std::unique_ptr<RuntimeContext> ctx) {
+  runtime_ctx_ = std::move(ctx);
+  pre_scope_ = &scope;
+  runtime_ctx_bound_ = true;
+  runtime_ctx_unresolved_ = true;
+  kernel_type_.reset();
+}
+
+void OperatorWithKernel::ResolveBoundRuntimeContext(const Scope& scope) const {
+  bool resolved = false;
+  runtime_ctx_unresolved_ = false;
+  auto resolve = [&](const VariableNameMap& names, VariableValueMap* values) {
+    for (auto& param : names) {
+      auto& vars = values->at(param.first);
+      for (size_t i = 0; i < vars.size(); ++i) {
+        if (vars[i] != nullptr) {
+          continue;
+        }
+        vars[i] = scope.FindVar(param.second[i]);
+        if (vars[i] == nullptr) {
+          runtime_ctx_unresolved_ = true;
+        } else {
+          resolved = true;
+        }
+      }
+    }
+  };
+  resolve(Inputs(), &runtime_ctx_->inputs);
+  resolve(Outputs(), &runtime_ctx_->outputs);
+  if (resolved) {
+    kernel_type_.reset();
+  }
+}
+
+void OperatorWithKernel::UpdatePreparedCache(
+    const Scope& scope, const platform::Place& place) const {
+  if (runtime_ctx_ == nullptr || pre_scope_ != &scope) {
+    runtime_ctx_.reset(new RuntimeContext(Inputs(), Outputs(), scope));
+    pre_scope_ = &scope;
+    kernel_type_.reset();
+  } else if (kernel_type_ != nullptr &&
+             (!(pre_place_ == place) ||
+              InputKernelTypesChanged(*runtime_ctx_, input_kernel_types_))) {
+    VLOG(3) << "inputs of " << type_ << " changed, choose kernel again";
+    kernel_type_.reset();
+  }
+
+  if (kernel_type_ == nullptr) {
+    kernel_type_.reset(
+        new OpKernelType(ChooseKernel(*runtime_ctx_, scope, place,
+                                      &kernel_func_)));
+    pre_place_ = place;
+    CollectInputKernelTypes(*runtime_ctx_, &input_kernel_types_);
+    need_prepare_data_ = true;
+  }
+}
+
+OpKernelType OperatorWithKernel::ChooseKernel(const RuntimeContext& ctx,
+                                              const Scope& scope,
+                                              const platform::Place& place,
+                                              OpKernelFunc* kernel_func) const {
   platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
   auto* dev_ctx = pool.Get(place);
 
@@ -911,24 +1081,52 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
                  KernelTypeToString(expected_kernel_key));
   }
 
+  *kernel_func = kernel_iter->second;
+  return expected_kernel_key;
+}
+
+bool OperatorWithKernel::RunKernel(const Scope& scope,
+                                   const platform::Place& place,
+                                   const OpKernelType& kernel_type,
+                                   const OpKernelFunc& kernel_func,
+                                   bool prepare_data,
+                                   RuntimeContext* runtime_ctx) const {
+  platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
+  auto* dev_ctx = pool.Get(place);
+  auto& ctx = *runtime_ctx;
+
   // do data transformScope &transfer_scope;
   std::vector<std::string> transfered_inplace_vars;
-  auto* transfer_scope =
-      PrepareData(scope, expected_kernel_key, &transfered_inplace_vars, &ctx);
+  Scope* transfer_scope = nullptr;
+  if (prepare_data) {
+    transfer_scope =
+        PrepareData(scope, kernel_type, &transfered_inplace_vars, &ctx);
+  }
 
   // exec scope is the scope that kernel actually executed on.
   const Scope& exec_scope =
       (transfer_scope == nullptr ? scope : *transfer_scope);
 
-  if (!(expected_kernel_key.place_ == dev_ctx->GetPlace())) {
-    dev_ctx = pool.Get(expected_kernel_key.place_);
+  if (!(kernel_type.place_ == dev_ctx->GetPlace())) {
+    dev_ctx = pool.Get(kernel_type.place_);
   }
 
-  RuntimeInferShapeContext infer_shape_ctx(*this, exec_scope, ctx);
-  this->InferShape(&infer_shape_ctx);
+  if (!FLAGS_enable_cache_infer_shape) {
+    RuntimeInferShapeContext infer_shape_ctx(*this, exec_scope, ctx);
+    this->InferShape(&infer_shape_ctx);
+  } else {
+    if (infer_shape_cache_ == nullptr) {
+      infer_shape_cache_.reset(new InferShapeCache);
+    }
+    if (!infer_shape_cache_->Lookup(ctx.inputs, ctx.outputs)) {
+      RuntimeInferShapeContext infer_shape_ctx(*this, exec_scope, ctx);
+      this->InferShape(&infer_shape_ctx);
+      infer_shape_cache_->Update(ctx.inputs, ctx.outputs);
+    }
+  }
   // TODO(panyx0718): ExecutionContext should only depend on RuntimeContext
   // not Scope. Imperative mode only pass inputs and get outputs.
-  kernel_iter->second(ExecutionContext(*this, exec_scope, *dev_ctx, ctx));
+  kernel_func(ExecutionContext(*this, exec_scope, *dev_ctx, ctx));
 
   if (!transfered_inplace_vars.empty()) {
     // there is inplace variable has been transfered.
@@ -951,6 +1149,7 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
       }
     }
   }
+  return transfer_scope != nullptr;
 }
 
 void OperatorWithKernel::TransferInplaceVarsBack(
@@ -998,8 +1197,9 @@ Scope* OperatorWithKernel::PrepareData(
       }
 
       auto out_var_names = OutputVars(true);
-      if (std::find(out_var_names.begin(), out_var_names.end(), var_name) !=
-          out_var_names.end()) {
+      bool inplace = std::find(out_var_names.begin(), out_var_names.end(),
+                               var_name) != out_var_names.end();
+      if (inplace) {
         transfered_inplace_vars->emplace_back(var_name);
       }
 
@@ -1029,8 +1229,19 @@ Scope* OperatorWithKernel::PrepareData(
       auto* trans_var = new_scope->Var(var_name);
       input_vars[i] = trans_var;
 
+      // The inplace inputs are written by the kernel, never cache them.
+      bool use_cache = FLAGS_enable_cache_transformed_data && !inplace;
       Tensor out;
-      TransformData(expected_kernel_key, kernel_type_for_var, *tensor_in, &out);
+      if (!use_cache ||
+          !FindTransformedInput(var_name, *tensor_in, kernel_type_for_var,
+                                expected_kernel_key, &out)) {
+        TransformData(expected_kernel_key, kernel_type_for_var, *tensor_in,
+                      &out);
+        if (use_cache) {
+          CacheTransformedInput(var_name, *tensor_in, kernel_type_for_var,
+                                expected_kernel_key, out);
+        }
+      }
       SetTensorToVariable(*var, out, trans_var);
     }
   }
@@ -1038,6 +1249,58 @@ Scope* OperatorWithKernel::PrepareData(
   return new_scope;
 }
 
+OperatorWithKernel::TransformedInput::TransformedInput(const Tensor& in,
+                                                       const OpKernelType& from,
+                                                       const OpKernelType& to)
+    : source(in.Holder()),
+      version(in.Holder()->version()),
+      data(in.data<void>()),
+      dims(in.dims()),
+      from(from),
+      to(to) {}
+
+bool OperatorWithKernel::TransformedInput::Match(
+    const Tensor& in, const OpKernelType& from,
+    const OpKernelType& to) const {
+  // The expired source may be freed and its address reused.
+  auto holder = source.lock();
+  return holder != nullptr && holder == in.Holder() &&
+         version == holder->version() && data == in.data<void>() &&
+         dims == in.dims() && this->from == from && this->to == to;
+}
+
+bool OperatorWithKernel::FindTransformedInput(
+    const std::string& var_name, const Tensor& in,
+    const OpKernelType& kernel_type_for_var,
+    const OpKernelType& expected_kernel_key, Tensor* out) const {
+  std::lock_guard<std::mutex> guard(transformed_inputs_mutex_);
+  auto it = transformed_inputs_.find(var_name);
+  if (it == transformed_inputs_.end() || !it->second.out.IsInitialized() ||
+      !it->second.Match(in, kernel_type_for_var, expected_kernel_key)) {
+    return false;
+  }
+  VLOG(3) << "Reuse the transformed variable " << var_name;
+  out->ShareDataWith(it->second.out);
+  return true;
+}
+
+void OperatorWithKernel::CacheTransformedInput(
+    const std::string& var_name, const Tensor& in,
+    const OpKernelType& kernel_type_for_var,
+    const OpKernelType& expected_kernel_key, const Tensor& out) const {
+  std::lock_guard<std::mutex> guard(transformed_inputs_mutex_);
+  auto it = transformed_inputs_.find(var_name);
+  if (it == transformed_inputs_.end()) {
+    transformed_inputs_.emplace(
+        var_name,
+        TransformedInput(in, kernel_type_for_var, expected_kernel_key));
+  } else if (it->second.Match(in, kernel_type_for_var, expected_kernel_key)) {
+    it->second.out.ShareDataWith(out);
+  } else {
+    it->second = TransformedInput(in, kernel_type_for_var, expected_kernel_key);
+  }
+}
+
 proto::VarType::Type OperatorWithKernel::IndicateDataType(
     const ExecutionContext& ctx) const {
   int data_type = -1;
@@ -16,6 +16,8 @@ limitations under the License. */
 
 #include <algorithm>
 #include <atomic>
+#include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <tuple>
 #include <unordered_map>
@@ -25,6 +27,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/attribute.h"
 #include "paddle/fluid/framework/block_desc.h"
 #include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/framework/infer_shape_cache.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_info.h"
 #include "paddle/fluid/framework/op_kernel_type.h"
@@ -160,6 +163,14 @@ class OperatorBase {
                                  const platform::Place& place,
                                  const RuntimeContext& ctx) const {}
 
+  /// Bind the variables resolved by the caller for the runs in `scope`, so
+  /// that the op does not look them up in the scope. The variables must not
+  /// be erased from the scope while bound, the null ones are looked up again
+  /// in each run until found. Only the ops with kernels keep the context, the
+  /// others look up the scope as usual.
+  virtual void BindRuntimeContext(const Scope& scope,
+                                  std::unique_ptr<RuntimeContext> ctx) {}
+
  protected:
   std::string type_;
   // NOTE: in case of OpGrad, inputs_ contains:
@@ -174,6 +185,8 @@ class OperatorBase {
   AttributeMap attrs_;
   // Whether this operator executes in an Executor.
   bool run_by_executor_{true};
+  // The interned id of the type in the sampling profiler.
+  int sampled_event_id_;
 
  private:
   void GenerateTemporaryNames();
@@ -484,6 +497,9 @@ class OperatorWithKernel : public OperatorBase {
   void RuntimeInferShape(const Scope& scope, const platform::Place& place,
                          const RuntimeContext& ctx) const override;
 
+  void BindRuntimeContext(const Scope& scope,
+                          std::unique_ptr<RuntimeContext> ctx) override;
+
   virtual OpKernelType GetExpectedKernelType(const ExecutionContext& ctx) const;
 
  protected:
@@ -497,6 +513,36 @@ class OperatorWithKernel : public OperatorBase {
   proto::VarType::Type IndicateDataType(const ExecutionContext& ctx) const;
   void RunImpl(const Scope& scope, const platform::Place& place) const final;
 
+  /**
+   * Run the kernel chosen for this op on `runtime_ctx`, the data transform of
+   * inputs is skipped if `prepare_data` is false. Returns true if some input
+   * has been transfered to another scope before running the kernel.
+   */
+  bool RunKernel(const Scope& scope, const platform::Place& place,
+                 const OpKernelType& kernel_type,
+                 const OpKernelFunc& kernel_func, bool prepare_data,
+                 RuntimeContext* runtime_ctx) const;
+
+  /**
+   * Find the kernel of the expected kernel type, the kernel functor is
+   * returned by `kernel_func`.
+   */
+  OpKernelType ChooseKernel(const RuntimeContext& ctx, const Scope& scope,
+                            const platform::Place& place,
+                            OpKernelFunc* kernel_func) const;
+
+  /**
+   * Refresh the cached RuntimeContext and kernel when the scope, the place or
+   * the data type/place/layout of the inputs changed since the last run. Only
+   * used when FLAGS_enable_cache_runtime_context is set, or the context is
+   * bound by BindRuntimeContext.
+   */
+  void UpdatePreparedCache(const Scope& scope,
+                           const platform::Place& place) const;
+
+  // Look up the variables of the bound context which were not in the scope.
+  void ResolveBoundRuntimeContext(const Scope& scope) const;
+
   /**
    * Transfer data from scope to a transfered scope. If there is no data need to
    * be tranfered, it returns nullptr.
@@ -511,6 +557,66 @@ class OperatorWithKernel : public OperatorBase {
   void TransferInplaceVarsBack(const Scope& scope,
                                const std::vector<std::string>& inplace_vars,
                                const Scope& exec_scope) const;
+
+  /**
+   * Find the copy of the input `var_name` transformed by the last runs, which
+   * is still valid if the memory of `in` is not written since then. Returns
+   * false if there is no such copy.
+   */
+  bool FindTransformedInput(const std::string& var_name, const Tensor& in,
+                            const OpKernelType& kernel_type_for_var,
+                            const OpKernelType& expected_kernel_key,
+                            Tensor* out) const;
+
+  /**
+   * Remember `in` transformed to `out`. The copy is kept only when this
+   * version of `in` has been transformed by the last run too, so the inputs
+   * written every run, e.g. the activations, do not hold the extra memory.
+   */
+  void CacheTransformedInput(const std::string& var_name, const Tensor& in,
+                             const OpKernelType& kernel_type_for_var,
+                             const OpKernelType& expected_kernel_key,
+                             const Tensor& out) const;
+
+  // The prepared-op cache, see UpdatePreparedCache. An op with the cache
+  // enabled must not run concurrently, and the scope it runs in must not be
+  // destroyed between runs.
+  mutable std::unique_ptr<RuntimeContext> runtime_ctx_;
+  mutable const Scope* pre_scope_{nullptr};
+  mutable platform::Place pre_place_;
+  mutable std::unique_ptr<OpKernelType> kernel_type_;
+  mutable OpKernelFunc kernel_func_;
+  mutable std::vector<OpKernelType> input_kernel_types_;
+  mutable bool need_prepare_data_{true};
+  // Whether runtime_ctx_ is bound by BindRuntimeContext.
+  bool runtime_ctx_bound_{false};
+  // Whether the bound runtime_ctx_ may hold null variables.
+  mutable bool runtime_ctx_unresolved_{false};
+  // Only created when FLAGS_enable_cache_infer_shape is set.
+  mutable std::unique_ptr<InferShapeCache> infer_shape_cache_;
+
+  // The transformed inputs, see FindTransformedInput.
+  struct TransformedInput {
+    TransformedInput(const Tensor& in, const OpKernelType& from,
+                     const OpKernelType& to);
+
+    // Whether `in` is the same memory of the same version, transformed
+    // between the same kernel types.
+    bool Match(const Tensor& in, const OpKernelType& from,
+               const OpKernelType& to) const;
+
+    std::weak_ptr<memory::Allocation> source;
+    uint64_t version;
+    const void* data;
+    DDim dims;
+    OpKernelType from;
+    OpKernelType to;
+    // Not initialized until the same source is transformed twice.
+    Tensor out;
+  };
+  mutable std::unordered_map<std::string, TransformedInput>
+      transformed_inputs_;
+  mutable std::mutex transformed_inputs_mutex_;
 };
 
 extern bool OpSupportGPU(const std::string& op_type);
@@ -11,6 +11,7 @@ distributed under the License is distributed on an "AS IS" BASIS,
 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
+#include "gflags/gflags.h"
 #include "gtest/gtest.h"
 
 #include "paddle/fluid/framework/op_info.h"
@@ -18,6 +19,9 @@ limitations under the License. */
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/platform/init.h"
 
+DECLARE_bool(enable_cache_runtime_context);
+DECLARE_bool(enable_cache_transformed_data);
+
 namespace paddle {
 namespace framework {
 
@@ -115,6 +119,7 @@ class OpKernelTestProtoAndCheckerMaker : public OpProtoAndCheckerMaker {
 
 static int cpu_kernel_run_num = 0;
 static int cpu_kernel2_run_num = 0;
+static int expected_kernel_type_num = 0;
 
 class OpWithKernelTest : public OperatorWithKernel {
  public:
@@ -124,6 +129,7 @@ class OpWithKernelTest : public OperatorWithKernel {
   void InferShape(framework::InferShapeContext* ctx) const override {}
   OpKernelType GetExpectedKernelType(
       const ExecutionContext& ctx) const override {
+    expected_kernel_type_num++;
     int sub_type = ctx.Attr<int>("kernel_sub_type");
     return OpKernelType(proto::VarType::FP32, ctx.GetPlace(),
                         framework::DataLayout::kAnyLayout,
@@ -255,6 +261,110 @@ TEST(OpKernel, all) {
   ASSERT_EQ(paddle::framework::cpu_kernel2_run_num, 1);
 }
 
+// test the kernel is chosen only once when the runtime context is cached
+TEST(OpKernel, cache_runtime_context) {
+  paddle::framework::InitDevices(true);
+  paddle::framework::proto::OpDesc op_desc;
+  op_desc.set_type("op_with_kernel");
+  BuildVar("x", {"IN1"}, op_desc.add_inputs());
+  BuildVar("y", {"OUT1"}, op_desc.add_outputs());
+
+  auto attr = op_desc.mutable_attrs()->Add();
+  attr->set_name("scale");
+  attr->set_type(paddle::framework::proto::AttrType::FLOAT);
+  attr->set_f(3.14);
+
+  paddle::platform::CPUPlace cpu_place;
+  paddle::framework::Scope scope;
+
+  FLAGS_enable_cache_runtime_context = true;
+  auto op = paddle::framework::OpRegistry::CreateOp(op_desc);
+  int kernel_run_num = paddle::framework::cpu_kernel_run_num;
+  int expected_num = paddle::framework::expected_kernel_type_num;
+  for (int i = 0; i < 3; ++i) {
+    op->Run(scope, cpu_place);
+  }
+  ASSERT_EQ(paddle::framework::cpu_kernel_run_num, kernel_run_num + 3);
+  ASSERT_EQ(paddle::framework::expected_kernel_type_num, expected_num + 1);
+
+  // running in another scope drops the cache.
+  paddle::framework::Scope other_scope;
+  op->Run(other_scope, cpu_place);
+  ASSERT_EQ(paddle::framework::cpu_kernel_run_num, kernel_run_num + 4);
+  ASSERT_EQ(paddle::framework::expected_kernel_type_num, expected_num + 2);
+  FLAGS_enable_cache_runtime_context = false;
+}
+
+namespace paddle {
+namespace framework {
+
+static const void* transformed_x_data = nullptr;
+static float transformed_x_value = 0;
+
+class OpWithTransformedInputTest : public OpWithKernelTest {
+ public:
+  using OpWithKernelTest::OpWithKernelTest;
+
+ protected:
+  OpKernelType GetKernelTypeForVar(
+      const std::string& var_name, const Tensor& tensor,
+      const OpKernelType& expected_kernel_type) const override {
+    return OpKernelType(tensor.type(), tensor.place(), tensor.layout());
+  }
+};
+
+class CPUKernelTransformedInputTest : public OpKernel<float> {
+ public:
+  void Compute(const ExecutionContext& ctx) const {
+    auto* x = ctx.Input<Tensor>("x");
+    ASSERT_EQ(x->type(), proto::VarType::FP32);
+    transformed_x_data = x->data<void>();
+    transformed_x_value = x->data<float>()[0];
+  }
+};
+
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_OP_WITHOUT_GRADIENT(
+    op_with_transformed_input, paddle::framework::OpWithTransformedInputTest,
+    paddle::framework::OpKernelTestProtoAndCheckerMaker);
+REGISTER_OP_CPU_KERNEL(op_with_transformed_input,
+                       paddle::framework::CPUKernelTransformedInputTest);
+
+// test the transformed input is reused until the origin one is written
+TEST(OpKernel, cache_transformed_data) {
+  paddle::framework::InitDevices(true);
+  paddle::framework::proto::OpDesc op_desc;
+  op_desc.set_type("op_with_transformed_input");
+  BuildVar("x", {"IN1"}, op_desc.add_inputs());
+  BuildVar("y", {"OUT1"}, op_desc.add_outputs());
+
+  paddle::platform::CPUPlace cpu_place;
+  paddle::framework::Scope scope;
+  auto* x = scope.Var("IN1")->GetMutable<paddle::framework::LoDTensor>();
+  x->Resize({1});
+  x->mutable_data<double>(cpu_place)[0] = 1.0;
+  scope.Var("OUT1")->GetMutable<paddle::framework::LoDTensor>();
+
+  FLAGS_enable_cache_transformed_data = true;
+  auto op = paddle::framework::OpRegistry::CreateOp(op_desc);
+  std::vector<const void*> data;
+  for (int i = 0; i < 3; ++i) {
+    op->Run(scope, cpu_place);
+    data.push_back(paddle::framework::transformed_x_data);
+    ASSERT_EQ(paddle::framework::transformed_x_value, 1.0f);
+  }
+  // the copy is kept since the second run.
+  ASSERT_EQ(data[1], data[2]);
+
+  x->mutable_data<double>(cpu_place)[0] = 2.0;
+  op->Run(scope, cpu_place);
+  ASSERT_EQ(paddle::framework::transformed_x_value, 2.0f);
+  op->Run(scope, cpu_place);
+  ASSERT_EQ(paddle::framework::transformed_x_value, 2.0f);
+}
+
 REGISTER_OP_WITHOUT_GRADIENT(
     op_multi_inputs_with_kernel, paddle::framework::OpWithKernelTest,
     paddle::framework::OpKernelTestMultiInputsProtoAndCheckerMaker);
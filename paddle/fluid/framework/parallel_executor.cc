@@ -14,9 +14,13 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/parallel_executor.h"
 #include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <map>
 #include <string>
 #include <tuple>
 #include <vector>
+#include "paddle/fluid/framework/compute_pool.h"
 #include "paddle/fluid/framework/ir/graph_helper.h"
 
 #include "paddle/fluid/framework/ir/graph.h"
@@ -26,7 +30,10 @@ limitations under the License. */
 #include "paddle/fluid/framework/details/parallel_ssa_graph_executor.h"
 #include "paddle/fluid/framework/details/reference_count_pass_helper.h"
 #include "paddle/fluid/framework/details/scope_buffered_ssa_graph_executor.h"
+#include "paddle/fluid/framework/details/sharded_lookup_op_handle.h"
 #include "paddle/fluid/framework/details/threaded_ssa_graph_executor.h"
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
+#include "paddle/fluid/memory/memcpy.h"
 #include "paddle/fluid/platform/profiler.h"
 
 #ifdef WITH_GPERFTOOLS
@@ -37,6 +44,10 @@ DEFINE_string(pe_profile_fname, "",
               "Only valid when compiled `WITH_PRIFILER=ON`. Empty if disable.");
 DEFINE_bool(enable_parallel_graph, false,
             "Force disable parallel graph execution mode if set false.");
+DEFINE_int32(bcast_params_fuse_size_mb, 32,
+             "The parameters smaller than it are broadcasted to the GPUs in "
+             "the fused buffers of this size in MB, instead of one NCCL call "
+             "for each, 0 to broadcast them one by one.");
 
 namespace paddle {
 namespace framework {
@@ -63,6 +74,11 @@ class ParallelExecutorPrivate {
   }
 
   ~ParallelExecutorPrivate() {
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+    if (sync_bn_nccl_ctxs_) {
+      SetSyncBatchNormComms(false);
+    }
+#endif
     if (own_local_scope_) {
       for (size_t i = 1; i < local_scopes_.size(); ++i) {
         // Skip the first scope, since it is the global scope.
@@ -79,6 +95,23 @@ class ParallelExecutorPrivate {
 
   inline bool HasGarbageCollectors() const { return !gcs_.empty(); }
 
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+  // Sets the communicators of sync_batch_norm, or nullptr if not set, to the
+  // contexts of all the streams of the devices.
+  void SetSyncBatchNormComms(bool set) {
+    auto &pool = platform::DeviceContextPool::Instance();
+    size_t num_streams = std::max<size_t>(build_strategy_.num_streams_, 1);
+    for (auto &place : places_) {
+      ncclComm_t comm = set ? sync_bn_nccl_ctxs_->at(place).comm_ : nullptr;
+      for (size_t i = 0; i < num_streams; ++i) {
+        static_cast<platform::CUDADeviceContext *>(
+            pool.GetStreamContext(place, i))
+            ->set_nccl_comm(comm);
+      }
+    }
+  }
+#endif
+
   void ResetRuntimeReferenceCount(const std::vector<std::string> &fetch_tensors,
                                   const std::string &fetched_var_name) {
     for (size_t i = 0; i < runtime_ref_cnts_.size(); ++i) {
@@ -101,11 +134,20 @@ class ParallelExecutorPrivate {
 
 #if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
   std::unique_ptr<platform::NCCLContextMap> nccl_ctxs_;
+  // The communicators of the sync_batch_norm ops, set to the device contexts.
+  // They are not the ones of the all-reduce of the gradients, whose calls
+  // may interleave with them in another order.
+  std::unique_ptr<platform::NCCLContextMap> sync_bn_nccl_ctxs_;
 #endif
   bool own_local_scope_;
   bool use_cuda_;
   bool use_all_reduce_;
   size_t nranks_;
+  // The variables broadcast to all the devices at the beginning.
+  std::unordered_set<std::string> bcast_vars_;
+  // The heights of the tables of the sharded lookup_table ops, whose rows are
+  // split between the devices instead of broadcast.
+  std::unordered_map<std::string, int64_t> sharded_tables_;
 
   // global_ref_cnts_ is only initialized when ParallelExecutor constructs, and
   // then keeps unchanged
@@ -125,7 +167,10 @@ std::unique_ptr<ir::Graph> ParallelExecutorPrivate::PrepareGCAndRefCnts(
     std::unique_ptr<GarbageCollector> gc;
 #ifdef PADDLE_WITH_CUDA
     if (platform::is_gpu_place(place)) {
-      if (IsFastEagerDeletionModeEnabled()) {
+      // The garbages can be freed without waiting for the stream if the GPU
+      // memory is freed in the stream order.
+      if (IsFastEagerDeletionModeEnabled() ||
+          memory::allocation::AllocatorFacade::IsGPUFreeStreamOrdered()) {
         gc.reset(new UnsafeFastGPUGarbageCollector(
             boost::get<platform::CUDAPlace>(place), max_memory_size));
       } else {
@@ -195,12 +240,32 @@ ParallelExecutor::ParallelExecutor(
     Scope *scope, const std::vector<Scope *> &local_scopes,
     const ExecutionStrategy &exec_strategy, const BuildStrategy &build_strategy)
     : member_(new ParallelExecutorPrivate(places)) {
+  // Report the time of each phase of the startup, which takes long for the
+  // large programs on many devices.
+  auto phase_start = std::chrono::steady_clock::now();
+  auto end_phase = [&phase_start](const char *phase) {
+    auto now = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::milli> ms = now - phase_start;
+    VLOG(1) << "ParallelExecutor " << phase << " took " << ms.count()
+            << " ms";
+    phase_start = now;
+  };
+
   member_->global_scope_ = scope;
   member_->use_cuda_ = exec_strategy.use_cuda_;
   member_->build_strategy_ = build_strategy;
   member_->use_all_reduce_ =
       build_strategy.reduce_ == BuildStrategy::ReduceStrategy::kAllReduce;
   member_->nranks_ = build_strategy.num_trainers_ * places.size();
+  member_->bcast_vars_ = bcast_vars;
+
+  if (build_strategy.async_mode_) {
+    PADDLE_ENFORCE(!member_->use_cuda_,
+                   "The async mode only supports the training on CPU.");
+    PADDLE_ENFORCE(!build_strategy.is_distribution_ &&
+                       build_strategy.num_trainers_ == 1,
+                   "The async mode does not support the distributed training.");
+  }
 
   if (!member_->use_all_reduce_) {
     PADDLE_ENFORCE(places.size() > 1,
@@ -233,6 +298,21 @@ ParallelExecutor::ParallelExecutor(
   VLOG(1) << "Enable ParallelGraph Execution: "
           << build_strategy.enable_parallel_graph_;
 
+  if (member_->places_.size() > 1 && !build_strategy.enable_parallel_graph_ &&
+      !build_strategy.async_mode_) {
+    auto &block = main_program.Block(0);
+    for (auto *op : block.AllOps()) {
+      if (op->Type() == "lookup_table" && op->HasAttr("is_sharded") &&
+          boost::get<bool>(op->GetAttr("is_sharded"))) {
+        auto &table_name = op->Input("W")[0];
+        auto *table = block.FindVarRecursive(table_name);
+        PADDLE_ENFORCE_NOT_NULL(table, "Cannot find the table %s",
+                                table_name);
+        member_->sharded_tables_[table_name] = table->GetShape()[0];
+      }
+    }
+  }
+
   if (member_->use_cuda_) {
 // Bcast Parameters to all GPUs
 #if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
@@ -251,15 +331,42 @@ ParallelExecutor::ParallelExecutor(
       }
     }
 
+    std::vector<ncclUniqueId *> inter_nccl_ids;
+    if (build_strategy.use_hierarchical_allreduce_ &&
+        build_strategy.num_trainers_ > 1 && member_->places_.size() > 1) {
+      for (size_t i = 0; i < member_->places_.size(); ++i) {
+        auto *inter_id_var = scope->FindVar(platform::InterNCCLIdVarName(i));
+        PADDLE_ENFORCE_NOT_NULL(inter_id_var,
+                                "Hierarchical allreduce needs the variable %s "
+                                "generated by gen_nccl_id.",
+                                platform::InterNCCLIdVarName(i));
+        inter_nccl_ids.emplace_back(inter_id_var->GetMutable<ncclUniqueId>());
+      }
+    }
+
     member_->nccl_ctxs_.reset(new platform::NCCLContextMap(
         member_->places_, nccl_id, build_strategy.num_trainers_,
-        build_strategy.trainer_id_));
+        build_strategy.trainer_id_, inter_nccl_ids));
+
+    // The statistics of sync_batch_norm are the ones of the devices of the
+    // process.
+    if (build_strategy.sync_batch_norm_ && member_->places_.size() > 1) {
+      if (build_strategy.num_trainers_ > 1) {
+        LOG(WARNING) << "sync_batch_norm only synchronizes the devices of "
+                        "a trainer.";
+      }
+      member_->sync_bn_nccl_ctxs_.reset(
+          new platform::NCCLContextMap(member_->places_));
+      member_->SetSyncBatchNormComms(true);
+    }
 #else
     PADDLE_THROW("Not compiled with CUDA");
 #endif
   }
+  end_phase("creating the local scopes and the NCCL contexts");
   if (member_->local_scopes_.size() != 1 && local_scopes.empty()) {
     BCastParamsToDevices(bcast_vars);
+    end_phase("broadcasting the parameters");
   }
   // Startup Program has been run. All local scopes has correct parameters.
 
@@ -267,11 +374,14 @@ ParallelExecutor::ParallelExecutor(
   // ncclOp
   std::vector<std::unique_ptr<ir::Graph>> graphs;
 #if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
-  if (build_strategy.enable_parallel_graph_) {
+  if (build_strategy.enable_parallel_graph_ || build_strategy.async_mode_) {
+    // The places of the async mode train by their own graphs, which have no
+    // collective ops.
+    size_t nranks = build_strategy.async_mode_ ? 1UL : member_->nranks_;
     for (size_t i = 0; i < member_->places_.size(); ++i) {
       std::unique_ptr<ir::Graph> graph = build_strategy.Apply(
           main_program, {member_->places_[i]}, loss_var_name,
-          {member_->local_scopes_[i]}, member_->nranks_, member_->use_cuda_,
+          {member_->local_scopes_[i]}, nranks, member_->use_cuda_,
           member_->nccl_ctxs_.get());
       graphs.push_back(std::move(graph));
     }
@@ -282,17 +392,30 @@ ParallelExecutor::ParallelExecutor(
     graphs.push_back(std::move(graph));
   }
 #else
-  std::unique_ptr<ir::Graph> graph = build_strategy.Apply(
-      main_program, member_->places_, loss_var_name, member_->local_scopes_,
-      member_->nranks_, member_->use_cuda_);
-  graphs.push_back(std::move(graph));
+  if (build_strategy.async_mode_) {
+    // The places of the async mode train by their own graphs, which have no
+    // collective ops.
+    for (size_t i = 0; i < member_->places_.size(); ++i) {
+      std::unique_ptr<ir::Graph> graph = build_strategy.Apply(
+          main_program, {member_->places_[i]}, loss_var_name,
+          {member_->local_scopes_[i]}, 1UL, member_->use_cuda_);
+      graphs.push_back(std::move(graph));
+    }
+  } else {
+    std::unique_ptr<ir::Graph> graph = build_strategy.Apply(
+        main_program, member_->places_, loss_var_name, member_->local_scopes_,
+        member_->nranks_, member_->use_cuda_);
+    graphs.push_back(std::move(graph));
+  }
 #endif
+  end_phase("building the graphs");
   auto max_memory_size = GetEagerDeletionThreshold();
   if (max_memory_size >= 0) {
     for (size_t i = 0; i < graphs.size(); ++i) {
       graphs[i] = member_->PrepareGCAndRefCnts(
           std::move(graphs[i]), static_cast<size_t>(max_memory_size));
     }
+    end_phase("preparing the garbage collectors");
   }
 
   // Step 3. Create vars in each scope. Passes may also create new vars.
@@ -324,7 +447,7 @@ ParallelExecutor::ParallelExecutor(
     }
   }
 
-  if (build_strategy.enable_parallel_graph_) {
+  if (build_strategy.enable_parallel_graph_ || build_strategy.async_mode_) {
     member_->executor_.reset(new details::ParallelSSAGraphExecutor(
         exec_strategy, member_->local_scopes_, member_->places_,
         std::move(graphs)));
@@ -343,10 +466,26 @@ ParallelExecutor::ParallelExecutor(
   member_->executor_.reset(new details::ScopeBufferedSSAGraphExecutor(
       exec_strategy, member_->local_scopes_, std::move(var_infos),
       member_->places_, std::move(member_->executor_)));
+
+  // The parameters are initialized and broadcasted, the threads of all the
+  // devices look them up without locking.
+  member_->global_scope_->Seal();
+  for (auto *local_scope : member_->local_scopes_) {
+    local_scope->Seal();
+  }
+  end_phase("creating the executor");
 }
 
 void ParallelExecutor::BCastParamsToDevices(
     const std::unordered_set<std::string> &vars) const {
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+  size_t fuse_bytes = static_cast<size_t>(
+                          std::max(FLAGS_bcast_params_fuse_size_mb, 0))
+                      << 20;
+  // The names and the sizes of the GPU tensors to fuse by the data types.
+  std::map<proto::VarType::Type, std::vector<std::pair<std::string, size_t>>>
+      fused_vars;
+#endif
   // the initializing bcast, all vars would be bcast from device(0).
   for (auto &var : vars) {
     framework::Variable *main_var = member_->local_scopes_[0]->FindVar(var);
@@ -360,8 +499,32 @@ void ParallelExecutor::BCastParamsToDevices(
       continue;
     }
     auto &dims = main_tensor.dims();
+    auto sharded = member_->sharded_tables_.find(var);
+    if (sharded != member_->sharded_tables_.end()) {
+      // The main scope keeps the first shard after the others are copied,
+      // so broadcasting again, e.g. after ResetNCCLContexts, is a no-op.
+      if (dims[0] != sharded->second) {
+        continue;
+      }
+      size_t num_shards = member_->places_.size();
+      for (size_t i = num_shards; i > 0; --i) {
+        auto range = details::ShardRange(dims[0], num_shards, i - 1);
+        Tensor shard;
+        TensorCopySync(main_tensor.Slice(range.first, range.second),
+                       member_->places_[i - 1], &shard);
+        auto *t =
+            member_->local_scopes_[i - 1]->Var(var)->GetMutable<LoDTensor>();
+        t->ShareDataWith(shard);
+      }
+      continue;
+    }
     if (paddle::platform::is_gpu_place(main_tensor.place())) {
 #if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+      size_t bytes = main_tensor.numel() * SizeOfType(main_tensor.type());
+      if (bytes > 0 && bytes < fuse_bytes) {
+        fused_vars[main_tensor.type()].emplace_back(var, bytes);
+        continue;
+      }
       std::vector<void *> buffers;
       buffers.reserve(member_->places_.size());
       size_t numel = main_tensor.numel();
@@ -402,8 +565,10 @@ void ParallelExecutor::BCastParamsToDevices(
         auto *t = local_scope->Var(var)->GetMutable<LoDTensor>();
 
         // FIXME(zcd): LR_DECAY_COUNTER should not be shared. This is a hot fix.
-        if (member_->use_all_reduce_ || member_->use_cuda_ ||
-            var == "@LR_DECAY_COUNTER@") {
+        // The places of the async mode update the shared parameters.
+        bool share = !member_->use_all_reduce_ ||
+                     member_->build_strategy_.async_mode_;
+        if (!share || member_->use_cuda_ || var == "@LR_DECAY_COUNTER@") {
           t->Resize(dims);
           t->mutable_data(cpu, main_tensor.type());
           paddle::framework::TensorCopy(main_tensor, cpu, t);
@@ -413,6 +578,121 @@ void ParallelExecutor::BCastParamsToDevices(
       }
     }
   }
+
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+  for (auto &dtype_vars : fused_vars) {
+    auto &vars_bytes = dtype_vars.second;
+    // The trainers of NCCL2 must broadcast the same buffers in the same
+    // order.
+    std::sort(vars_bytes.begin(), vars_bytes.end());
+    std::vector<std::string> bucket;
+    size_t bucket_bytes = 0;
+    for (auto &var_bytes : vars_bytes) {
+      if (!bucket.empty() && bucket_bytes + var_bytes.second > fuse_bytes) {
+        BCastFusedParamsToDevices(bucket);
+        bucket.clear();
+        bucket_bytes = 0;
+      }
+      bucket.push_back(var_bytes.first);
+      bucket_bytes += var_bytes.second;
+    }
+    if (!bucket.empty()) {
+      BCastFusedParamsToDevices(bucket);
+    }
+  }
+#endif
+}
+
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+void ParallelExecutor::BCastFusedParamsToDevices(
+    const std::vector<std::string> &vars) const {
+  // Each tensor starts at an aligned offset of the buffer, and the tensors of
+  // the other devices share the slices of their buffers.
+  constexpr size_t kAlignment = 256;
+  auto *main_scope = member_->local_scopes_[0];
+  std::vector<const LoDTensor *> main_tensors;
+  for (auto &var : vars) {
+    main_tensors.push_back(&main_scope->FindVar(var)->Get<LoDTensor>());
+  }
+  auto dtype = main_tensors[0]->type();
+  size_t size_of_type = SizeOfType(dtype);
+  int64_t align = static_cast<int64_t>(kAlignment / size_of_type);
+  std::vector<int64_t> offsets;
+  int64_t numel = 0;
+  for (auto *tensor : main_tensors) {
+    offsets.push_back(numel);
+    numel += (tensor->numel() + align - 1) / align * align;
+  }
+
+  size_t num_places = member_->places_.size();
+  std::vector<Tensor> buffers(num_places);
+  for (size_t i = 0; i < num_places; ++i) {
+    buffers[i].Resize({numel});
+    buffers[i].mutable_data(member_->places_[i], dtype);
+  }
+  auto &main_ctx = member_->nccl_ctxs_->at(member_->places_[0]);
+  auto main_place = boost::get<platform::CUDAPlace>(member_->places_[0]);
+  auto *main_buffer = reinterpret_cast<char *>(buffers[0].data<void>());
+  for (size_t k = 0; k < main_tensors.size(); ++k) {
+    memory::Copy(main_place, main_buffer + offsets[k] * size_of_type,
+                 boost::get<platform::CUDAPlace>(main_tensors[k]->place()),
+                 main_tensors[k]->data<void>(),
+                 main_tensors[k]->numel() * size_of_type, main_ctx.stream());
+  }
+
+  ncclDataType_t data_type = platform::ToNCCLDataType(dtype);
+  {
+    platform::NCCLGroupGuard guard;
+    for (size_t i = 0; i < num_places; ++i) {
+      auto &nccl_ctx = member_->nccl_ctxs_->at(member_->places_[i]);
+      platform::dynload::ncclBcast(buffers[i].data<void>(), numel, data_type,
+                                   0, nccl_ctx.comm_, nccl_ctx.stream());
+    }
+  }
+  member_->nccl_ctxs_->WaitAll();
+
+  for (size_t i = 1; i < num_places; ++i) {
+    for (size_t k = 0; k < vars.size(); ++k) {
+      auto *t =
+          member_->local_scopes_[i]->Var(vars[k])->GetMutable<LoDTensor>();
+      t->ShareDataWith(
+          buffers[i].Slice(offsets[k], offsets[k] + main_tensors[k]->numel()));
+      t->Resize(main_tensors[k]->dims());
+    }
+  }
+}
+#endif
+
+void ParallelExecutor::AbortNCCLContexts() {
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+  PADDLE_ENFORCE_NOT_NULL(member_->nccl_ctxs_,
+                          "ParallelExecutor does not use NCCL");
+  member_->nccl_ctxs_->AbortComms();
+#else
+  PADDLE_THROW("Not compiled with CUDA");
+#endif
+}
+
+void ParallelExecutor::ResetNCCLContexts(const std::string &nccl_id,
+                                         size_t num_trainers,
+                                         size_t trainer_id) {
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+  PADDLE_ENFORCE_NOT_NULL(member_->nccl_ctxs_,
+                          "ParallelExecutor does not use NCCL");
+  PADDLE_ENFORCE_EQ(nccl_id.size(), sizeof(ncclUniqueId),
+                    "invalid size of the NCCL id");
+  PADDLE_ENFORCE_LT(trainer_id, num_trainers);
+  ncclUniqueId id;
+  memcpy(&id, nccl_id.data(), sizeof(id));
+  VLOG(1) << "reset the NCCL communicators to " << num_trainers
+          << " trainers, trainer id " << trainer_id;
+  member_->nccl_ctxs_->ResetComms(&id, num_trainers, trainer_id);
+  // The parameters may be updated by a part of the last step, broadcast
+  // the ones of the new trainer 0.
+  BCastParamsToDevices(member_->bcast_vars_);
+#else
+  PADDLE_THROW("Not compiled with CUDA");
+#endif
 }
 
 void ParallelExecutor::Run(const std::vector<std::string> &fetch_tensors,
@@ -449,21 +729,42 @@ void ParallelExecutor::FeedTensorsIntoLocalScopes(
 
 void ParallelExecutor::FeedAndSplitTensorIntoLocalScopes(
     const std::unordered_map<std::string, LoDTensor> &tensors) {
-  for (auto pair : tensors) {
-    auto lod_tensors = pair.second.SplitLoDTensor(member_->places_);
+  // The parts of all the feeds for a place are copied to it by one batch, so
+  // that the small feeds cost one copy a place, and the places are fed in
+  // parallel.
+  size_t num_places = member_->places_.size();
+  std::vector<const std::string *> names;
+  std::vector<std::vector<LoDTensor>> parts;
+  names.reserve(tensors.size());
+  parts.reserve(tensors.size());
+  for (auto &pair : tensors) {
+    names.emplace_back(&pair.first);
+    parts.emplace_back(pair.second.SplitLoDTensorSlices(num_places));
     PADDLE_ENFORCE_EQ(
-        member_->places_.size(), lod_tensors.size(),
+        num_places, parts.back().size(),
         "The number of samples of current batch is less than the count of "
         "devices, currently, it is not allowed. (%d vs %d)",
-        member_->places_.size(), lod_tensors.size());
-    for (size_t j = 0; j < member_->places_.size(); ++j) {
-      // TODO(panxy0718): Do I need to delete this var?
-      auto t =
-          member_->local_scopes_[j]->Var(pair.first)->GetMutable<LoDTensor>();
-      t->ShareDataWith(lod_tensors[j]);
-      t->set_lod(lod_tensors[j].lod());
-    }
+        num_places, parts.back().size());
   }
+  ParallelFor(0, num_places, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t j = begin; j < end; ++j) {
+      std::vector<LoDTensor> copies(parts.size());
+      std::vector<const Tensor *> srcs;
+      std::vector<Tensor *> dsts;
+      for (size_t k = 0; k < parts.size(); ++k) {
+        srcs.push_back(&parts[k][j]);
+        dsts.push_back(&copies[k]);
+      }
+      TensorCopyBatch(srcs, member_->places_[j], dsts);
+      for (size_t k = 0; k < parts.size(); ++k) {
+        // TODO(panxy0718): Do I need to delete this var?
+        auto t = member_->local_scopes_[j]->Var(*names[k])
+                     ->GetMutable<LoDTensor>();
+        t->ShareDataWith(copies[k]);
+        t->set_lod(parts[k][j].lod());
+      }
+    }
+  });
 }
 
 bool ParallelExecutor::EnableParallelGraphExecution(
@@ -498,7 +799,7 @@ bool ParallelExecutor::EnableParallelGraphExecution(
 
 ParallelExecutor::~ParallelExecutor() {
   for (auto &p : member_->places_) {
-    platform::DeviceContextPool::Instance().Get(p)->Wait();
+    platform::DeviceContextPool::Instance().WaitAllStreams(p);
   }
   delete member_;
 }
@@ -69,8 +69,29 @@ class ParallelExecutor {
   void Run(const std::vector<std::string> &fetch_tensors,
            const std::string &fetched_var_name);
 
+  /**
+   * Abort the NCCL communicators, so that a Run blocked on a lost trainer
+   * returns. It can be called from another thread during Run, and the
+   * communicators must be reset before the next Run.
+   */
+  void AbortNCCLContexts();
+
+  /**
+   * Rebuild the NCCL communicators with the surviving trainers, whose new
+   * ranks are given by trainer_id, and broadcast the parameters from the
+   * new trainer 0. The gradients are still scaled by the number of the
+   * trainers the graph is built with.
+   */
+  void ResetNCCLContexts(const std::string &nccl_id, size_t num_trainers,
+                         size_t trainer_id);
+
  private:
   void BCastParamsToDevices(const std::unordered_set<std::string> &vars) const;
+#if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+  // Broadcast the GPU tensors of the same data type by one NCCL call on a
+  // buffer fusing them.
+  void BCastFusedParamsToDevices(const std::vector<std::string> &vars) const;
+#endif
   bool EnableParallelGraphExecution(const ProgramDesc &main_program,
                                     const ExecutionStrategy &exec_strategy,
                                     const BuildStrategy &build_strategy) const;
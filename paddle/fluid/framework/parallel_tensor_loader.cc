@@ -0,0 +1,201 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/parallel_tensor_loader.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <future>  // NOLINT
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/timer.h"
+#include "paddle/fluid/string/printf.h"
+
+namespace paddle {
+namespace framework {
+
+struct ParallelTensorLoader::Job {
+  std::string path;
+  uint64_t offset;
+  // Whether the file holds only the raw data at the offset.
+  bool raw;
+  DDim dims;
+  proto::VarType::Type type;
+  LoD lod;
+  LoDTensor* tensor;
+  // The host tensor in the pinned memory if the tensor is loaded to GPU.
+  LoDTensor staging;
+};
+
+ParallelTensorLoader::ParallelTensorLoader(const platform::Place& place)
+    : place_(place) {}
+
+ParallelTensorLoader::~ParallelTensorLoader() {}
+
+void ParallelTensorLoader::AddStream(const std::string& path, uint64_t offset,
+                                     LoDTensor* tensor) {
+  std::unique_ptr<Job> job(new Job);
+  job->path = path;
+  job->offset = offset;
+  job->raw = false;
+  job->tensor = tensor;
+  jobs_.push_back(std::move(job));
+}
+
+void ParallelTensorLoader::AddRaw(const std::string& path, uint64_t offset,
+                                  const DDim& dims, proto::VarType::Type type,
+                                  const LoD& lod, LoDTensor* tensor) {
+  std::unique_ptr<Job> job(new Job);
+  job->path = path;
+  job->offset = offset;
+  job->raw = true;
+  job->dims = dims;
+  job->type = type;
+  job->lod = lod;
+  job->tensor = tensor;
+  jobs_.push_back(std::move(job));
+}
+
+void ParallelTensorLoader::AddCombinedStream(
+    const std::string& path, const std::vector<LoDTensor*>& tensors) {
+  platform::Timer timer;
+  timer.Start();
+  std::ifstream fin(path, std::ios::in | std::ios::binary);
+  PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot open file %s", path);
+  // Only the headers are read, see SerializeToStream for the format.
+  for (auto* tensor : tensors) {
+    uint64_t offset = fin.tellg();
+    uint32_t version;
+    fin.read(reinterpret_cast<char*>(&version), sizeof(version));
+    PADDLE_ENFORCE_EQ(version, 0U, "Only version 0 is supported");
+    uint64_t lod_level;
+    fin.read(reinterpret_cast<char*>(&lod_level), sizeof(lod_level));
+    for (uint64_t i = 0; i < lod_level; ++i) {
+      uint64_t size;
+      fin.read(reinterpret_cast<char*>(&size), sizeof(size));
+      fin.seekg(size, std::ios::cur);
+    }
+    fin.read(reinterpret_cast<char*>(&version), sizeof(version));
+    PADDLE_ENFORCE_EQ(version, 0U, "Only version 0 is supported");
+    int32_t desc_size;
+    fin.read(reinterpret_cast<char*>(&desc_size), sizeof(desc_size));
+    PADDLE_ENFORCE(fin.good() && desc_size >= 0, "Cannot read more from %s",
+                   path);
+    std::string desc_bytes(desc_size, '\0');
+    fin.read(&desc_bytes[0], desc_size);
+    proto::VarType::TensorDesc desc;
+    PADDLE_ENFORCE(desc.ParseFromString(desc_bytes),
+                   "Cannot parse tensor desc");
+    int64_t numel = 1;
+    for (auto dim : desc.dims()) numel *= dim;
+    fin.seekg(numel * SizeOfType(desc.data_type()), std::ios::cur);
+    PADDLE_ENFORCE(fin.good(), "Cannot read more from %s", path);
+    AddStream(path, offset, tensor);
+  }
+  timer.Pause();
+  stats_.scan_ms += timer.ElapsedMS();
+}
+
+void ParallelTensorLoader::Run(int num_jobs) {
+  bool to_device = !platform::is_cpu_place(place_);
+  std::unique_ptr<platform::DeviceContext> host_ctx;
+  platform::Place host_place = platform::CPUPlace();
+  if (to_device) {
+#ifdef PADDLE_WITH_CUDA
+    host_place = platform::CUDAPinnedPlace();
+    host_ctx.reset(new platform::CUDAPinnedDeviceContext(
+        boost::get<platform::CUDAPinnedPlace>(host_place)));
+#else
+    PADDLE_THROW("Loading to GPU needs PaddlePaddle compiled with CUDA");
+#endif
+  } else {
+    host_ctx.reset(new platform::CPUDeviceContext());
+  }
+
+  auto read = [&](Job* job) {
+    LoDTensor* dst = to_device ? &job->staging : job->tensor;
+    std::ifstream fin(job->path, std::ios::in | std::ios::binary);
+    PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot open file %s", job->path);
+    fin.seekg(job->offset);
+    if (job->raw) {
+      dst->Resize(job->dims);
+      dst->set_lod(job->lod);
+      size_t size = dst->numel() * SizeOfType(job->type);
+      void* buf = dst->mutable_data(host_place, job->type);
+      fin.read(static_cast<char*>(buf), size);
+    } else {
+      DeserializeFromStream(fin, dst, *host_ctx);
+    }
+    PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot read tensor from %s",
+                   job->path);
+  };
+
+  platform::Timer timer;
+  timer.Start();
+  num_jobs = std::max(1, std::min(num_jobs, static_cast<int>(jobs_.size())));
+  if (num_jobs == 1) {
+    for (auto& job : jobs_) read(job.get());
+  } else {
+    // Each task of the pool takes the next tensor until all are read.
+    std::atomic<size_t> next{0};
+    std::vector<std::future<std::unique_ptr<platform::EnforceNotMet>>> tasks;
+    for (int i = 0; i < num_jobs; ++i) {
+      tasks.emplace_back(ThreadPoolIO::GetInstanceIO()->RunAndGetException(
+          [&] {
+            for (size_t j = next++; j < jobs_.size(); j = next++) {
+              read(jobs_[j].get());
+            }
+          }));
+    }
+    std::unique_ptr<platform::EnforceNotMet> error;
+    for (auto& task : tasks) {
+      auto task_error = task.get();
+      if (task_error && !error) error = std::move(task_error);
+    }
+    if (error) throw *error;
+  }
+  timer.Pause();
+  stats_.read_ms += timer.ElapsedMS();
+
+  for (auto& job : jobs_) {
+    auto& host = to_device ? job->staging : *job->tensor;
+    stats_.bytes += host.numel() * SizeOfType(host.type());
+  }
+
+  if (to_device) {
+    timer.Start();
+    auto& dev_ctx = *platform::DeviceContextPool::Instance().Get(place_);
+    for (auto& job : jobs_) {
+      TensorCopy(job->staging, place_, dev_ctx, job->tensor);
+      job->tensor->set_lod(job->staging.lod());
+    }
+    // The staging buffers must live until the copies are done.
+    dev_ctx.Wait();
+    timer.Pause();
+    stats_.copy_ms += timer.ElapsedMS();
+  }
+  jobs_.clear();
+}
+
+std::string ParallelTensorLoader::StatsString() const {
+  return string::Sprintf(
+      "scan %.2f ms, read %.2f ms, copy to device %.2f ms, %.2f MB",
+      stats_.scan_ms, stats_.read_ms, stats_.copy_ms,
+      stats_.bytes / 1024.0 / 1024.0);
+}
+
+}  // namespace framework
+}  // namespace paddle
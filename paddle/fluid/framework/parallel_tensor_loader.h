@@ -0,0 +1,81 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/ddim.h"
+#include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * ParallelTensorLoader loads many LoDTensors from files on the IO thread
+ * pool, e.g., the persistables of an inference model.
+ *
+ * It runs in two phases. In the read phase, each tensor is deserialized by a
+ * job on the host, into the CUDA pinned memory if the place is GPU. In the
+ * copy phase, all the host to device copies are issued on the stream of the
+ * place and synchronized once, and the pinned staging buffers are released.
+ */
+class ParallelTensorLoader {
+ public:
+  // The time of each phase in ms, and the bytes of tensor data loaded.
+  struct Stats {
+    double scan_ms{0};
+    double read_ms{0};
+    double copy_ms{0};
+    size_t bytes{0};
+  };
+
+  explicit ParallelTensorLoader(const platform::Place& place);
+  ~ParallelTensorLoader();
+
+  // The LoDTensor serialized by SerializeToStream at the offset of the file.
+  void AddStream(const std::string& path, uint64_t offset, LoDTensor* tensor);
+
+  // The raw data of a tensor at the offset of the file, whose dims, data type
+  // and LoD are known already.
+  void AddRaw(const std::string& path, uint64_t offset, const DDim& dims,
+              proto::VarType::Type type, const LoD& lod, LoDTensor* tensor);
+
+  // Add all the LoDTensors of a file saved by save_combine, whose offsets are
+  // found by skipping the data of each tensor. The number of tensors in the
+  // file must be the same as the tensors given.
+  void AddCombinedStream(const std::string& path,
+                         const std::vector<LoDTensor*>& tensors);
+
+  // Run the jobs added, at most num_jobs of them concurrently. The first
+  // error of the jobs is rethrown.
+  void Run(int num_jobs);
+
+  const Stats& stats() const { return stats_; }
+  // The stats as a line of log.
+  std::string StatsString() const;
+
+ private:
+  struct Job;
+
+  platform::Place place_;
+  std::vector<std::unique_ptr<Job>> jobs_;
+  Stats stats_;
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,89 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/parallel_tensor_loader.h"
+#include <gtest/gtest.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+static void FillTensor(const DDim& dims, int start, LoDTensor* tensor) {
+  tensor->Resize(dims);
+  float* data = tensor->mutable_data<float>(platform::CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = static_cast<float>(start + i);
+  }
+  tensor->set_lod({{0, 1, static_cast<size_t>(dims[0])}});
+}
+
+static void ExpectEqual(const LoDTensor& expect, const LoDTensor& actual) {
+  ASSERT_EQ(expect.dims(), actual.dims());
+  EXPECT_EQ(expect.lod(), actual.lod());
+  for (int64_t i = 0; i < expect.numel(); ++i) {
+    EXPECT_EQ(expect.data<float>()[i], actual.data<float>()[i]);
+  }
+}
+
+TEST(ParallelTensorLoader, SeparateAndCombinedFiles) {
+  const int kNum = 10;
+  std::vector<LoDTensor> expects(kNum);
+  platform::CPUDeviceContext ctx;
+  std::ofstream combined("parallel_tensor_loader_test.combined",
+                         std::ios::binary);
+  for (int i = 0; i < kNum; ++i) {
+    FillTensor(make_ddim({i + 2, 3}), i * 100, &expects[i]);
+    std::ofstream fout("parallel_tensor_loader_test." + std::to_string(i),
+                       std::ios::binary);
+    SerializeToStream(fout, expects[i], ctx);
+    SerializeToStream(combined, expects[i], ctx);
+  }
+  combined.close();
+
+  std::vector<LoDTensor> separate(kNum);
+  std::vector<LoDTensor> merged(kNum);
+  std::vector<LoDTensor*> merged_ptrs;
+  platform::CPUPlace place;
+  ParallelTensorLoader loader(place);
+  for (int i = 0; i < kNum; ++i) {
+    loader.AddStream("parallel_tensor_loader_test." + std::to_string(i), 0,
+                     &separate[i]);
+    merged_ptrs.push_back(&merged[i]);
+  }
+  loader.AddCombinedStream("parallel_tensor_loader_test.combined",
+                           merged_ptrs);
+  loader.Run(4);
+
+  size_t bytes = 0;
+  for (int i = 0; i < kNum; ++i) {
+    ExpectEqual(expects[i], separate[i]);
+    ExpectEqual(expects[i], merged[i]);
+    bytes += expects[i].memory_size() * 2;
+  }
+  EXPECT_EQ(loader.stats().bytes, bytes);
+}
+
+TEST(ParallelTensorLoader, MissingFile) {
+  LoDTensor tensor;
+  platform::CPUPlace place;
+  ParallelTensorLoader loader(place);
+  loader.AddStream("parallel_tensor_loader_test.not_exist", 0, &tensor);
+  loader.AddStream("parallel_tensor_loader_test.not_exist", 0, &tensor);
+  EXPECT_THROW(loader.Run(2), platform::EnforceNotMet);
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,579 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/pipeline_executor.h"
+
+#include <algorithm>
+#include <thread>  // NOLINT
+#include <unordered_set>
+#include <utility>
+
+#include "paddle/fluid/framework/feed_fetch_type.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/framework/variable_helper.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+constexpr char kMicroBatchSuffix[] = "@PIPELINE_MICRO";
+
+// Thrown by the stages waiting for a stage that failed.
+struct PipelineAborted {};
+
+int OpRoleOf(const OpDesc& op) {
+  auto name = OpProtoAndCheckerMaker::OpRoleAttrName();
+  if (!op.HasAttr(name)) {
+    return static_cast<int>(OpRole::kNotSpecified);
+  }
+  return boost::get<int>(op.GetAttr(name));
+}
+
+std::string OpDeviceOf(const OpDesc& op) {
+  auto name = OpProtoAndCheckerMaker::OpDeviceAttrName();
+  if (!op.HasAttr(name)) {
+    return "";
+  }
+  return boost::get<std::string>(op.GetAttr(name));
+}
+
+template <typename T>
+void AppendUnique(std::vector<T>* values, const T& value) {
+  if (std::find(values->begin(), values->end(), value) == values->end()) {
+    values->push_back(value);
+  }
+}
+
+}  // namespace
+
+PipelineExecutor::PipelineExecutor(const ProgramDesc& program,
+                                   const platform::Place& place, Scope* scope,
+                                   size_t num_micro_batches)
+    : program_(program),
+      place_(place),
+      scope_(scope),
+      num_micro_batches_(num_micro_batches) {
+  PADDLE_ENFORCE_NOT_NULL(scope_);
+  PADDLE_ENFORCE_GT(num_micro_batches_, 0UL,
+                    "The number of micro-batches should be positive.");
+  BuildGroups();
+  CreateVariables();
+}
+
+PipelineExecutor::~PipelineExecutor() { scope_->DeleteScope(lr_scope_); }
+
+platform::Place PipelineExecutor::DeviceToPlace(
+    const std::string& device) const {
+  if (device.empty()) {
+    return place_;
+  }
+  auto pos = device.find(':');
+  std::string type = device.substr(0, pos);
+  int id = pos == std::string::npos ? 0 : std::stoi(device.substr(pos + 1));
+  if (type == "cpu") {
+    return platform::CPUPlace();
+  }
+  if (type == "gpu") {
+#ifdef PADDLE_WITH_CUDA
+    return platform::CUDAPlace(id);
+#else
+    PADDLE_THROW("Stage %s needs the GPU, but Paddle is not compiled with CUDA.",
+                 device);
+#endif
+  }
+  PADDLE_THROW("Unknown device %s, which should be cpu, cpu:N or gpu:N.",
+               device);
+}
+
+void PipelineExecutor::BuildGroups() {
+  auto& block = program_.Block(0);
+  auto ops = block.AllOps();
+  auto is_micro_var = [&block](const std::string& name) {
+    auto* var = block.FindVar(name);
+    return var != nullptr && !var->Persistable();
+  };
+
+  std::unordered_map<std::string, size_t> device_to_stage;
+  for (auto* op : ops) {
+    if (OpRoleOf(*op) & static_cast<int>(OpRole::kLRSched)) continue;
+    auto device = OpDeviceOf(*op);
+    if (!device.empty() && device_to_stage.count(device) == 0) {
+      device_to_stage[device] = stages_.size();
+      stages_.emplace_back();
+      stages_.back().device = device;
+    }
+  }
+  if (stages_.empty()) {
+    stages_.emplace_back();
+  }
+  for (auto& stage : stages_) {
+    stage.place = DeviceToPlace(stage.device);
+    std::fill(stage.groups, stage.groups + 3, -1);
+    places_.push_back(stage.place);
+  }
+
+  std::unordered_set<std::string> lr_vars;
+  std::unordered_map<std::string, size_t> last_writer;
+  size_t prev_stage = 0;
+  for (auto* op : ops) {
+    int role = OpRoleOf(*op);
+    if (role & static_cast<int>(OpRole::kLRSched)) {
+      for (auto& name : op->OutputArgumentNames()) {
+        lr_vars.insert(name);
+      }
+      lr_ops_.emplace_back(OpRegistry::CreateOp(*op));
+      continue;
+    }
+    Phase phase = kForwardPhase;
+    if (role & static_cast<int>(OpRole::kOptimize)) {
+      phase = kOptimizePhase;
+    } else if (role & static_cast<int>(OpRole::kBackward)) {
+      phase = kBackwardPhase;
+    }
+
+    auto device = OpDeviceOf(*op);
+    size_t stage_id = prev_stage;
+    if (!device.empty()) {
+      stage_id = device_to_stage[device];
+    } else {
+      bool found = false;
+      for (auto& name : op->InputArgumentNames()) {
+        auto it = var_stages_.find(name);
+        if (it != var_stages_.end()) {
+          stage_id = it->second;
+          found = true;
+          break;
+        }
+      }
+      for (auto& name : op->OutputArgumentNames()) {
+        if (found) break;
+        auto pos = name.rfind(kGradVarSuffix);
+        if (pos == std::string::npos) continue;
+        auto it = var_stages_.find(name.substr(0, pos));
+        if (it != var_stages_.end()) {
+          stage_id = it->second;
+          found = true;
+        }
+      }
+    }
+    prev_stage = stage_id;
+    auto& stage = stages_[stage_id];
+    if (stage.groups[phase] < 0) {
+      stage.groups[phase] = static_cast<int>(groups_.size());
+      groups_.emplace_back();
+      groups_.back().stage = stage_id;
+      groups_.back().phase = phase;
+    }
+    size_t group_id = static_cast<size_t>(stage.groups[phase]);
+
+    for (auto& name : op->InputArgumentNames()) {
+      if (name == kEmptyVarName) continue;
+      if (lr_vars.count(name)) {
+        if (!platform::is_same_place(stage.place, place_)) {
+          AppendUnique(&stage.lr_inputs, name);
+        }
+        continue;
+      }
+      auto it = last_writer.find(name);
+      if (it == last_writer.end()) {
+        if (phase != kOptimizePhase && is_micro_var(name)) {
+          AppendUnique(&feed_stages_[name], stage_id);
+        }
+        continue;
+      }
+      size_t writer_id = it->second;
+      if (writer_id == group_id) continue;
+      auto& writer = groups_[writer_id];
+      if (writer.stage == stage_id) {
+        // The forward variables are in the scopes of the micro-batches of the
+        // backward ops.
+        if (phase == kOptimizePhase) {
+          PADDLE_ENFORCE_EQ(writer.phase, kBackwardPhase,
+                            "The optimize op %s can only read the gradients "
+                            "of the micro-batches, but %s is not.",
+                            op->Type(), name);
+          AppendUnique(&stage.grads, name);
+        }
+        continue;
+      }
+      PADDLE_ENFORCE_NE(phase, kOptimizePhase,
+                        "The optimize op %s of stage %d reads %s of stage %d.",
+                        op->Type(), stage_id, name, writer.stage);
+      if (phase == kForwardPhase) {
+        PADDLE_ENFORCE(
+            writer.phase == kForwardPhase && writer.stage < stage_id,
+            "The forward op %s of stage %d can only read the forward "
+            "variables of the previous stages, but %s is of stage %d.",
+            op->Type(), stage_id, name, writer.stage);
+      } else {
+        PADDLE_ENFORCE(
+            writer.phase == kForwardPhase || writer.stage > stage_id,
+            "The backward op %s of stage %d can only read the gradients of "
+            "the next stages, but %s is of stage %d.",
+            op->Type(), stage_id, name, writer.stage);
+      }
+      AppendUnique(&groups_[group_id].deps, writer_id);
+      AppendUnique(&writer.transfers, std::make_pair(name, stage_id));
+    }
+    for (auto& name : op->OutputArgumentNames()) {
+      if (!is_micro_var(name)) continue;
+      last_writer[name] = group_id;
+      if (phase != kOptimizePhase) {
+        var_stages_[name] = stage_id;
+      }
+    }
+    groups_[group_id].ops.emplace_back(OpRegistry::CreateOp(*op));
+  }
+
+  for (size_t i = 0; i < stages_.size(); ++i) {
+    VLOG(3) << "pipeline stage " << i << " on " << stages_[i].place << ": "
+            << stages_[i].grads.size() << " gradients accumulated over "
+            << num_micro_batches_ << " micro-batches";
+  }
+}
+
+void PipelineExecutor::CreateVariables() {
+  auto& block = program_.Block(0);
+  for (auto* var : block.AllVars()) {
+    if (var->Persistable() && scope_->FindVar(var->Name()) == nullptr) {
+      InitializeVariable(scope_->Var(var->Name()), var->GetType());
+    }
+  }
+
+  lr_scope_ = &scope_->NewScope();
+  std::unordered_set<std::string> lr_vars;
+  for (auto& op : lr_ops_) {
+    for (auto& pair : op->Outputs()) {
+      lr_vars.insert(pair.second.begin(), pair.second.end());
+    }
+  }
+  for (auto& name : lr_vars) {
+    auto* var = block.FindVar(name);
+    if (var != nullptr && !var->Persistable()) {
+      InitializeVariable(lr_scope_->Var(name), var->GetType());
+    }
+  }
+
+  auto var_names = [](const OpGroup& group) {
+    std::unordered_set<std::string> names;
+    for (auto& op : group.ops) {
+      for (auto& pair : op->Inputs()) {
+        names.insert(pair.second.begin(), pair.second.end());
+      }
+      for (auto& pair : op->Outputs()) {
+        names.insert(pair.second.begin(), pair.second.end());
+      }
+    }
+    return names;
+  };
+
+  for (auto& stage : stages_) {
+    stage.scope = &lr_scope_->NewScope();
+    std::unordered_set<std::string> micro_names, stage_names;
+    for (int phase = kForwardPhase; phase <= kOptimizePhase; ++phase) {
+      if (stage.groups[phase] < 0) continue;
+      auto names = var_names(groups_[stage.groups[phase]]);
+      (phase == kOptimizePhase ? stage_names : micro_names)
+          .insert(names.begin(), names.end());
+    }
+
+    for (size_t i = 0; i < num_micro_batches_; ++i) {
+      stage.micro_scopes.push_back(&stage.scope->NewScope());
+      for (auto& name : micro_names) {
+        auto* var = block.FindVar(name);
+        if (var == nullptr || var->Persistable() || lr_vars.count(name)) {
+          continue;
+        }
+        InitializeVariable(stage.micro_scopes.back()->Var(name),
+                           var->GetType());
+      }
+    }
+    for (auto& name : stage_names) {
+      auto* var = block.FindVar(name);
+      if (var == nullptr || var->Persistable() || lr_vars.count(name)) {
+        continue;
+      }
+      InitializeVariable(stage.scope->Var(name), var->GetType());
+    }
+    for (auto& name : stage.lr_inputs) {
+      stage.scope->Var(name)->GetMutable<LoDTensor>();
+    }
+
+    for (auto& name : stage.grads) {
+      auto type = block.FindVar(name)->GetType();
+      InitializeVariable(stage.scope->Var(name + kMicroBatchSuffix), type);
+      stage.accumulate_ops.emplace_back(OpRegistry::CreateOp(
+          "sum", {{"X", {name, name + kMicroBatchSuffix}}}, {{"Out", {name}}},
+          AttributeMap{}));
+      stage.scale_ops.emplace_back(OpRegistry::CreateOp(
+          "scale", {{"X", {name}}}, {{"Out", {name}}},
+          {{"scale", 1.0f / num_micro_batches_}}));
+    }
+
+    // Copy the persistable variables on another place to the stage.
+    micro_names.insert(stage_names.begin(), stage_names.end());
+    for (auto& name : micro_names) {
+      auto* var_desc = block.FindVar(name);
+      if (var_desc == nullptr || !var_desc->Persistable()) continue;
+      auto* var = scope_->FindVar(name);
+      if (var == nullptr || !var->IsType<LoDTensor>()) continue;
+      auto& tensor = var->Get<LoDTensor>();
+      auto place = tensor.IsInitialized() ? tensor.place() : place_;
+      if (platform::is_same_place(place, stage.place)) continue;
+      auto* local = stage.scope->Var(name)->GetMutable<LoDTensor>();
+      if (tensor.IsInitialized()) {
+        TensorCopySync(tensor, stage.place, local);
+        local->set_lod(tensor.lod());
+      }
+      stage.persistables.push_back(name);
+    }
+  }
+}
+
+void PipelineExecutor::FeedAndSplitTensorIntoMicroBatches(
+    const std::unordered_map<std::string, LoDTensor>& tensors) {
+  for (auto& pair : tensors) {
+    auto it = feed_stages_.find(pair.first);
+    PADDLE_ENFORCE(it != feed_stages_.end(),
+                   "%s is not an input of the pipeline.", pair.first);
+    for (size_t stage_id : it->second) {
+      auto& stage = stages_[stage_id];
+      auto lod_tensors = pair.second.SplitLoDTensor(
+          std::vector<platform::Place>(num_micro_batches_, stage.place));
+      PADDLE_ENFORCE_EQ(
+          lod_tensors.size(), num_micro_batches_,
+          "The number of samples of current batch is less than the count of "
+          "micro-batches, currently, it is not allowed. (%d vs %d)",
+          lod_tensors.size(), num_micro_batches_);
+      for (size_t i = 0; i < num_micro_batches_; ++i) {
+        auto* t =
+            stage.micro_scopes[i]->Var(pair.first)->GetMutable<LoDTensor>();
+        t->ShareDataWith(lod_tensors[i]);
+        t->set_lod(lod_tensors[i].lod());
+      }
+    }
+  }
+}
+
+void PipelineExecutor::Wait(size_t group_id, size_t micro_batch) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [&] { return done_[group_id][micro_batch] || aborted_; });
+  if (!done_[group_id][micro_batch]) {
+    throw PipelineAborted();
+  }
+}
+
+void PipelineExecutor::Notify(size_t group_id, size_t micro_batch) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  done_[group_id][micro_batch] = true;
+  cv_.notify_all();
+}
+
+void PipelineExecutor::RunGroup(size_t group_id, Scope* scope,
+                                size_t micro_batch) {
+  auto& group = groups_[group_id];
+  auto& place = stages_[group.stage].place;
+  for (size_t dep : group.deps) {
+    Wait(dep, micro_batch);
+  }
+  for (auto& op : group.ops) {
+    VLOG(4) << "stage " << group.stage << " micro-batch " << micro_batch
+            << " run " << op->Type();
+    op->Run(*scope, place);
+  }
+
+  // Copy the tensors on the stream of the GPU, and wait for the copies
+  // before the next stage reads them.
+  auto& pool = platform::DeviceContextPool::Instance();
+  std::vector<platform::DeviceContext*> contexts;
+  for (auto& transfer : group.transfers) {
+    auto* var = scope->FindVar(transfer.first);
+    PADDLE_ENFORCE(var != nullptr && var->IsType<LoDTensor>() &&
+                       var->Get<LoDTensor>().IsInitialized(),
+                   "%s of stage %d is not an initialized LoDTensor.",
+                   transfer.first, group.stage);
+    auto& src = var->Get<LoDTensor>();
+    auto& dst_place = stages_[transfer.second].place;
+    auto* dst = stages_[transfer.second]
+                    .micro_scopes[micro_batch]
+                    ->Var(transfer.first)
+                    ->GetMutable<LoDTensor>();
+    auto* ctx =
+        pool.Get(platform::is_gpu_place(src.place()) ? src.place() : dst_place);
+    TensorCopy(src, dst_place, *ctx, dst);
+    dst->set_lod(src.lod());
+    AppendUnique(&contexts, ctx);
+  }
+  for (auto* ctx : contexts) {
+    ctx->Wait();
+  }
+  Notify(group_id, micro_batch);
+}
+
+void PipelineExecutor::AccumulateGradients(size_t stage_id,
+                                           size_t micro_batch) {
+  auto& stage = stages_[stage_id];
+  for (size_t i = 0; i < stage.grads.size(); ++i) {
+    auto& name = stage.grads[i];
+    auto* micro_var = stage.micro_scopes[micro_batch]->FindVar(name);
+    PADDLE_ENFORCE_NOT_NULL(micro_var, "Gradient %s is not found.", name);
+    auto* var = stage.scope->Var(micro_batch == 0 ? name
+                                                  : name + kMicroBatchSuffix);
+    if (micro_var->IsType<LoDTensor>()) {
+      auto& tensor = micro_var->Get<LoDTensor>();
+      auto* target = var->GetMutable<LoDTensor>();
+      target->ShareDataWith(tensor);
+      target->set_lod(tensor.lod());
+    } else if (micro_var->IsType<SelectedRows>()) {
+      auto& rows = micro_var->Get<SelectedRows>();
+      auto* target = var->GetMutable<SelectedRows>();
+      target->set_rows(rows.rows());
+      target->set_height(rows.height());
+      target->mutable_value()->ShareDataWith(rows.value());
+    } else {
+      PADDLE_THROW("Gradient %s should be LoDTensor or SelectedRows.", name);
+    }
+    if (micro_batch > 0) {
+      stage.accumulate_ops[i]->Run(*stage.scope, stage.place);
+    }
+  }
+}
+
+void PipelineExecutor::RunStage(size_t stage_id) {
+  auto& stage = stages_[stage_id];
+  for (int phase = kForwardPhase; phase <= kBackwardPhase; ++phase) {
+    int group_id = stage.groups[phase];
+    for (size_t i = 0; i < num_micro_batches_; ++i) {
+      if (group_id >= 0) {
+        RunGroup(group_id, stage.micro_scopes[i], i);
+      }
+      if (phase == kBackwardPhase) {
+        AccumulateGradients(stage_id, i);
+      }
+    }
+  }
+  if (num_micro_batches_ > 1) {
+    for (auto& op : stage.scale_ops) {
+      op->Run(*stage.scope, stage.place);
+    }
+  }
+  if (stage.groups[kOptimizePhase] >= 0) {
+    RunGroup(stage.groups[kOptimizePhase], stage.scope, 0);
+  }
+}
+
+void PipelineExecutor::Run(const std::vector<std::string>& fetch_tensors,
+                           const std::string& fetched_var_name) {
+  done_.assign(groups_.size(), std::vector<bool>(num_micro_batches_, false));
+  aborted_ = false;
+  exception_ = nullptr;
+
+  auto& pool = platform::DeviceContextPool::Instance();
+  for (auto& op : lr_ops_) {
+    op->Run(*lr_scope_, place_);
+  }
+  if (!lr_ops_.empty()) {
+    pool.Get(place_)->Wait();
+  }
+  for (auto& stage : stages_) {
+    for (auto& name : stage.lr_inputs) {
+      auto& tensor = lr_scope_->FindVar(name)->Get<LoDTensor>();
+      auto* local = stage.scope->Var(name)->GetMutable<LoDTensor>();
+      TensorCopySync(tensor, stage.place, local);
+      local->set_lod(tensor.lod());
+    }
+  }
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < stages_.size(); ++i) {
+    threads.emplace_back([this, i] {
+      try {
+        RunStage(i);
+      } catch (const PipelineAborted&) {
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (exception_ == nullptr) {
+          exception_ = std::current_exception();
+        }
+        aborted_ = true;
+        cv_.notify_all();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (exception_ != nullptr) {
+    std::rethrow_exception(exception_);
+  }
+  for (auto& stage : stages_) {
+    pool.Get(stage.place)->Wait();
+  }
+
+  auto* fetched = scope_->Var(fetched_var_name)->GetMutable<FeedFetchList>();
+  fetched->clear();
+  fetched->resize(fetch_tensors.size());
+  for (size_t i = 0; i < fetch_tensors.size(); ++i) {
+    auto& name = fetch_tensors[i];
+    auto it = var_stages_.find(name);
+    if (it != var_stages_.end()) {
+      auto& stage = stages_[it->second];
+      std::vector<LoDTensor> tensors(num_micro_batches_);
+      std::vector<const LoDTensor*> tensor_ptrs;
+      for (size_t j = 0; j < num_micro_batches_; ++j) {
+        auto& tensor =
+            stage.micro_scopes[j]->FindVar(name)->Get<LoDTensor>();
+        TensorCopySync(tensor, platform::CPUPlace(), &tensors[j]);
+        tensors[j].set_lod(tensor.lod());
+        tensor_ptrs.push_back(&tensors[j]);
+      }
+      (*fetched)[i].MergeLoDTensor(tensor_ptrs, platform::CPUPlace());
+      continue;
+    }
+    Variable* var = nullptr;
+    for (auto& stage : stages_) {
+      var = stage.scope->FindLocalVar(name);
+      if (var != nullptr) break;
+    }
+    if (var == nullptr) {
+      var = lr_scope_->FindVar(name);
+    }
+    PADDLE_ENFORCE(var != nullptr && var->IsType<LoDTensor>(),
+                   "Cannot fetch %s, which is not a LoDTensor.", name);
+    auto& tensor = var->Get<LoDTensor>();
+    TensorCopySync(tensor, platform::CPUPlace(), &(*fetched)[i]);
+    (*fetched)[i].set_lod(tensor.lod());
+  }
+}
+
+void PipelineExecutor::SyncParameters() {
+  for (auto& stage : stages_) {
+    for (auto& name : stage.persistables) {
+      auto& local = stage.scope->FindLocalVar(name)->Get<LoDTensor>();
+      if (!local.IsInitialized()) continue;
+      auto* tensor = scope_->FindVar(name)->GetMutable<LoDTensor>();
+      auto place = tensor->IsInitialized() ? tensor->place() : place_;
+      TensorCopySync(local, place, tensor);
+      tensor->set_lod(local.lod());
+    }
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,150 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <exception>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * Train a program whose ops are placed on several devices, as the pipeline of
+ * GPipe. The ops of a device, set by the op_device attribute, are a stage, and
+ * the stages are ordered by their first ops. A batch is split into
+ * micro-batches, each stage runs the forward ops of all the micro-batches,
+ * then the backward ones, so that the stages work on different micro-batches
+ * at the same time. The variables read by another stage are copied to it
+ * after each micro-batch. The gradients of the micro-batches are averaged
+ * before the optimize ops of each stage run once for the batch.
+ *
+ * The ops without op_device run on the stage of their inputs, or of the
+ * forward variables of their gradient outputs, otherwise on the stage of the
+ * previous op. The learning rate scheduler ops run once for the batch on the
+ * place of the scope. The activations of all the micro-batches are kept
+ * until the backward ops, as GPipe without the re-computation.
+ */
+class PipelineExecutor {
+ public:
+  // The persistable variables of the stages on another place than the ones in
+  // the scope, which is the place of the startup program, are copied to the
+  // stages here.
+  PipelineExecutor(const ProgramDesc& program, const platform::Place& place,
+                   Scope* scope, size_t num_micro_batches);
+
+  ~PipelineExecutor();
+
+  // Split the tensors along the batch into the micro-batches of the stages
+  // reading them.
+  void FeedAndSplitTensorIntoMicroBatches(
+      const std::unordered_map<std::string, LoDTensor>& tensors);
+
+  // Run a batch, and fetch the variables into the FeedFetchList variable
+  // fetched_var_name of the scope. The variables of the micro-batches are
+  // merged along the batch.
+  void Run(const std::vector<std::string>& fetch_tensors,
+           const std::string& fetched_var_name);
+
+  // Copy the persistable variables updated on the stages back to the scope,
+  // such as before saving them.
+  void SyncParameters();
+
+  size_t NumStages() const { return stages_.size(); }
+
+  const std::vector<platform::Place>& Places() const { return places_; }
+
+ private:
+  enum Phase { kForwardPhase = 0, kBackwardPhase = 1, kOptimizePhase = 2 };
+
+  struct OpGroup {
+    size_t stage;
+    Phase phase;
+    std::vector<std::unique_ptr<OperatorBase>> ops;
+    // The groups producing the inputs of the micro-batch.
+    std::vector<size_t> deps;
+    // The variables copied to other stages after the micro-batch.
+    std::vector<std::pair<std::string, size_t>> transfers;
+  };
+
+  struct Stage {
+    std::string device;
+    platform::Place place;
+    Scope* scope;
+    std::vector<Scope*> micro_scopes;
+    // The groups of the phases, -1 if the stage has no op of the phase.
+    int groups[3];
+    // The variables of the learning rate scheduler copied for each batch.
+    std::vector<std::string> lr_inputs;
+    // The persistable variables copied from the scope.
+    std::vector<std::string> persistables;
+    // The gradients averaged over the micro-batches for the optimize ops.
+    std::vector<std::string> grads;
+    std::vector<std::unique_ptr<OperatorBase>> accumulate_ops;
+    std::vector<std::unique_ptr<OperatorBase>> scale_ops;
+  };
+
+  void BuildGroups();
+
+  void CreateVariables();
+
+  void RunStage(size_t stage_id);
+
+  void RunGroup(size_t group_id, Scope* scope, size_t micro_batch);
+
+  void AccumulateGradients(size_t stage_id, size_t micro_batch);
+
+  // Wait until the group finishes the micro-batch, throw if another stage
+  // fails.
+  void Wait(size_t group_id, size_t micro_batch);
+
+  void Notify(size_t group_id, size_t micro_batch);
+
+  platform::Place DeviceToPlace(const std::string& device) const;
+
+  ProgramDesc program_;
+  platform::Place place_;
+  Scope* scope_;
+  // The scope of the learning rate scheduler, the parent of the stage scopes.
+  Scope* lr_scope_;
+  size_t num_micro_batches_;
+  std::vector<Stage> stages_;
+  std::vector<platform::Place> places_;
+  std::vector<OpGroup> groups_;
+  std::vector<std::unique_ptr<OperatorBase>> lr_ops_;
+  // The stage producing the variables of the micro-batches.
+  std::unordered_map<std::string, size_t> var_stages_;
+  // The stages reading the variables fed to the micro-batches.
+  std::unordered_map<std::string, std::vector<size_t>> feed_stages_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<std::vector<bool>> done_;
+  bool aborted_ = false;
+  std::exception_ptr exception_;
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,175 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/pipeline_executor.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/feed_fetch_type.h"
+#include "paddle/fluid/framework/op_proto_maker.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+USE_OP(elementwise_add);
+USE_OP(mean);
+USE_OP(fill_constant);
+USE_OP(sgd);
+USE_OP(sum);
+USE_OP(scale);
+
+namespace paddle {
+namespace framework {
+
+static OpDesc* AppendOp(BlockDesc* block, const std::string& type,
+                        const VariableNameMap& inputs,
+                        const VariableNameMap& outputs, OpRole role,
+                        const std::string& device = "") {
+  auto* op = block->AppendOp();
+  op->SetType(type);
+  for (auto& pair : inputs) op->SetInput(pair.first, pair.second);
+  for (auto& pair : outputs) op->SetOutput(pair.first, pair.second);
+  op->SetAttr(OpProtoAndCheckerMaker::OpRoleAttrName(),
+              static_cast<int>(role));
+  if (!device.empty()) {
+    op->SetAttr(OpProtoAndCheckerMaker::OpDeviceAttrName(), device);
+  }
+  return op;
+}
+
+static void SetTensor(Scope* scope, const std::string& name,
+                      const std::vector<int64_t>& dims,
+                      const std::vector<float>& values) {
+  auto* tensor = scope->Var(name)->GetMutable<LoDTensor>();
+  float* data =
+      tensor->mutable_data<float>(make_ddim(dims), platform::CPUPlace());
+  std::copy(values.begin(), values.end(), data);
+}
+
+// Y = X + W0 on stage cpu:0, loss = mean(Y + W1) on stage cpu:1, and the
+// backward and the sgd ops, most of which are placed by the inference.
+static void BuildProgram(ProgramDesc* program) {
+  auto* block = program->MutableBlock(0);
+  for (auto name : {"x", "h", "y", "loss", "loss@GRAD", "y@GRAD", "h@GRAD",
+                    "w0@GRAD", "w1@GRAD"}) {
+    block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  for (auto name : {"w0", "w1", "lr"}) {
+    block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+    block->Var(name)->SetPersistable(true);
+  }
+
+  AppendOp(block, "elementwise_add", {{"X", {"x"}}, {"Y", {"w0"}}},
+           {{"Out", {"h"}}}, OpRole::kForward, "cpu:0");
+  AppendOp(block, "elementwise_add", {{"X", {"h"}}, {"Y", {"w1"}}},
+           {{"Out", {"y"}}}, OpRole::kForward, "cpu:1");
+  AppendOp(block, "mean", {{"X", {"y"}}}, {{"Out", {"loss"}}},
+           static_cast<OpRole>(static_cast<int>(OpRole::kForward) |
+                               static_cast<int>(OpRole::kLoss)));
+
+  auto* fill = AppendOp(
+      block, "fill_constant", {}, {{"Out", {"loss@GRAD"}}},
+      static_cast<OpRole>(static_cast<int>(OpRole::kBackward) |
+                          static_cast<int>(OpRole::kLoss)));
+  fill->SetAttr("shape", std::vector<int>{1});
+  fill->SetAttr("value", 1.0f);
+  AppendOp(block, "mean_grad", {{"X", {"y"}}, {"Out@GRAD", {"loss@GRAD"}}},
+           {{"X@GRAD", {"y@GRAD"}}}, OpRole::kBackward);
+  // The grad ops have no checker to set the default attributes.
+  auto* add_grad1 = AppendOp(
+      block, "elementwise_add_grad",
+      {{"X", {"h"}}, {"Y", {"w1"}}, {"Out@GRAD", {"y@GRAD"}}},
+      {{"X@GRAD", {"h@GRAD"}}, {"Y@GRAD", {"w1@GRAD"}}}, OpRole::kBackward);
+  add_grad1->SetAttr("axis", -1);
+  auto* add_grad0 = AppendOp(
+      block, "elementwise_add_grad",
+      {{"X", {"x"}}, {"Y", {"w0"}}, {"Out@GRAD", {"h@GRAD"}}},
+      {{"Y@GRAD", {"w0@GRAD"}}}, OpRole::kBackward, "cpu:0");
+  add_grad0->SetAttr("axis", -1);
+
+  for (auto name : {"w0", "w1"}) {
+    std::string param(name);
+    AppendOp(block, "sgd",
+             {{"Param", {param}},
+              {"Grad", {param + "@GRAD"}},
+              {"LearningRate", {"lr"}}},
+             {{"ParamOut", {param}}}, OpRole::kOptimize);
+  }
+}
+
+TEST(PipelineExecutor, TwoStages) {
+  ProgramDesc program;
+  BuildProgram(&program);
+
+  Scope scope;
+  SetTensor(&scope, "w0", {3}, {0, 0, 0});
+  SetTensor(&scope, "w1", {3}, {0, 0, 0});
+  SetTensor(&scope, "lr", {1}, {0.5});
+
+  PipelineExecutor executor(program, platform::CPUPlace(), &scope, 2);
+  ASSERT_EQ(executor.NumStages(), 2UL);
+
+  LoDTensor x;
+  float* x_data =
+      x.mutable_data<float>(make_ddim({4, 3}), platform::CPUPlace());
+  for (int i = 0; i < 12; ++i) {
+    x_data[i] = i;
+  }
+
+  // The loss of a micro-batch of 2 samples is the mean of its 6 values, so
+  // the gradient of each weight is 1 / 3 for both of the micro-batches.
+  std::vector<float> expected_losses = {2.5, 8.5};
+  for (int step = 0; step < 2; ++step) {
+    executor.FeedAndSplitTensorIntoMicroBatches({{"x", x}});
+    executor.Run({"loss", "w0"}, "fetch");
+    auto& fetched = scope.FindVar("fetch")->Get<FeedFetchList>();
+    ASSERT_EQ(fetched.size(), 2UL);
+    ASSERT_EQ(fetched[0].dims(), make_ddim({2}));
+    for (int i = 0; i < 2; ++i) {
+      EXPECT_NEAR(fetched[0].data<float>()[i],
+                  expected_losses[i] - step * 2.0f / 6, 1e-5);
+    }
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_NEAR(fetched[1].data<float>()[i], -(step + 1) / 6.0f, 1e-5);
+    }
+  }
+
+  executor.SyncParameters();
+  auto& w1 = scope.FindVar("w1")->Get<LoDTensor>();
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_NEAR(w1.data<float>()[i], -2 / 6.0f, 1e-5);
+  }
+}
+
+TEST(PipelineExecutor, ForwardFromNextStage) {
+  ProgramDesc program;
+  auto* block = program.MutableBlock(0);
+  for (auto name : {"x", "h", "y"}) {
+    block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  AppendOp(block, "scale", {{"X", {"x"}}}, {{"Out", {"h"}}}, OpRole::kForward,
+           "cpu:0");
+  AppendOp(block, "scale", {{"X", {"h"}}}, {{"Out", {"y"}}}, OpRole::kForward,
+           "cpu:1");
+  AppendOp(block, "scale", {{"X", {"y"}}}, {{"Out", {"x"}}}, OpRole::kForward,
+           "cpu:0");
+
+  Scope scope;
+  ASSERT_THROW(PipelineExecutor(program, platform::CPUPlace(), &scope, 2),
+               platform::EnforceNotMet);
+}
+
+}  // namespace framework
+}  // namespace paddle
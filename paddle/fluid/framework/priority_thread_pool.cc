@@ -0,0 +1,73 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/priority_thread_pool.h"
+#include <memory>
+#include <utility>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+
+PriorityThreadPool::PriorityThreadPool(size_t num_threads) {
+  PADDLE_ENFORCE_GT(num_threads, 0UL);
+  threads_.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads_.emplace_back([this] { TaskLoop(); });
+  }
+}
+
+PriorityThreadPool::~PriorityThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  scheduled_.notify_all();
+  for (auto& t : threads_) {
+    t.join();
+  }
+}
+
+std::future<void> PriorityThreadPool::Run(int64_t priority, Task task) {
+  auto* queued = new QueuedTask{priority, 0, std::packaged_task<void()>(
+                                                 std::move(task))};
+  auto future = queued->task.get_future();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    PADDLE_ENFORCE(running_, "The PriorityThreadPool is stopped");
+    queued->seq = next_seq_++;
+    tasks_.push(queued);
+  }
+  scheduled_.notify_one();
+  return future;
+}
+
+void PriorityThreadPool::TaskLoop() {
+  while (true) {
+    std::unique_ptr<QueuedTask> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      scheduled_.wait(lock, [this] { return !tasks_.empty() || !running_; });
+      if (tasks_.empty()) {
+        return;
+      }
+      task.reset(tasks_.top());
+      tasks_.pop();
+    }
+    task->task();
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,77 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <queue>
+#include <thread>  // NOLINT
+#include <vector>
+#include "paddle/fluid/platform/macros.h"  // for DISABLE_COPY_AND_ASSIGN
+
+namespace paddle {
+namespace framework {
+
+// PriorityThreadPool shares one ready queue between its threads, which is
+// ordered by the priorities of the tasks instead of their arrival: an idle
+// thread always runs the most urgent task queued, however late it was
+// launched. The tasks of the same priority run in FIFO order.
+class PriorityThreadPool {
+ public:
+  using Task = std::function<void()>;
+
+  explicit PriorityThreadPool(size_t num_threads);
+
+  // Waits until all the launched tasks are finished.
+  ~PriorityThreadPool();
+
+  // Larger priority is more urgent. The future is ready when the task is
+  // finished, and holds the exception the task throws.
+  std::future<void> Run(int64_t priority, Task task);
+
+  size_t NumThreads() const { return threads_.size(); }
+
+ private:
+  DISABLE_COPY_AND_ASSIGN(PriorityThreadPool);
+
+  struct QueuedTask {
+    int64_t priority;
+    // The launch order, which breaks the ties of the priorities.
+    uint64_t seq;
+    std::packaged_task<void()> task;
+  };
+
+  struct LessUrgent {
+    bool operator()(const QueuedTask* a, const QueuedTask* b) const {
+      return a->priority != b->priority ? a->priority < b->priority
+                                        : a->seq > b->seq;
+    }
+  };
+
+  void TaskLoop();
+
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable scheduled_;
+  std::priority_queue<QueuedTask*, std::vector<QueuedTask*>, LessUrgent>
+      tasks_;
+  uint64_t next_seq_{0};
+  bool running_{true};
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,69 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/priority_thread_pool.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <vector>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+
+TEST(PriorityThreadPool, Run) {
+  std::atomic<int> sum(0);
+  int n = 1000;
+  {
+    PriorityThreadPool pool(4);
+    for (int i = 1; i <= n; ++i) {
+      pool.Run(i % 7, [&sum, i] { sum += i; });
+    }
+  }
+  EXPECT_EQ(sum, (n * (n + 1)) / 2);
+}
+
+// The tasks queued behind a running task run by their priorities, the later
+// ones first if they are more urgent.
+TEST(PriorityThreadPool, RunByPriority) {
+  std::mutex mutex;
+  std::vector<int> order;
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  {
+    PriorityThreadPool pool(1);
+    pool.Run(0, [released] { released.wait(); });
+    for (int i = 0; i < 4; ++i) {
+      pool.Run(i % 2, [&, i] {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(i);
+      });
+    }
+    pool.Run(10, [&] {
+      std::lock_guard<std::mutex> lock(mutex);
+      order.push_back(4);
+    });
+    release.set_value();
+  }
+  EXPECT_EQ(order, std::vector<int>({4, 1, 3, 0, 2}));
+}
+
+TEST(PriorityThreadPool, Exception) {
+  PriorityThreadPool pool(2);
+  auto future = pool.Run(0, [] { PADDLE_THROW("error"); });
+  EXPECT_THROW(future.get(), platform::EnforceNotMet);
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -50,7 +50,19 @@ ProgramDesc::ProgramDesc() {
 }
 
 ProgramDesc::ProgramDesc(const ProgramDesc &o) {
-  desc_ = o.desc_;
+  // The vars and ops of the blocks are flushed from the BlockDescs copied
+  // below, so they are not copied with desc_.
+  if (o.desc_.has_version()) {
+    *desc_.mutable_version() = o.desc_.version();
+  }
+  for (const proto::BlockDesc &block : o.desc_.blocks()) {
+    auto *new_block = desc_.add_blocks();
+    new_block->set_idx(block.idx());
+    new_block->set_parent_idx(block.parent_idx());
+    if (block.has_forward_block_idx()) {
+      new_block->set_forward_block_idx(block.forward_block_idx());
+    }
+  }
   for (int i = 0; i < desc_.blocks_size(); ++i) {
     auto *block = desc_.mutable_blocks(i);
     blocks_.emplace_back(new BlockDesc(*o.blocks_[i], block, this));
@@ -60,7 +72,7 @@ ProgramDesc::ProgramDesc(const ProgramDesc &o) {
     for (size_t op_id = 0; op_id < all_ops.size(); ++op_id) {
       auto &op = all_ops[op_id];
 
-      for (const std::string &attr_name : op->AttrNames()) {
+      for (const std::string &attr_name : op->BlockAttrNames()) {
         if (op->GetAttrType(attr_name) == proto::AttrType::BLOCK) {
           int sub_block_id =
               o.Block(block_id).Op(op_id)->GetBlockAttrId(attr_name);
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/framework/program_desc.h"
+#include <string>
+#include <vector>
 #include "gtest/gtest.h"
 #include "paddle/fluid/framework/block_desc.h"
 
@@ -174,5 +176,51 @@ TEST(ProgramDescBind, serialize_and_deserialize) {
               op_origin->Proto()->SerializeAsString());
   }
 }
+
+TEST(ProgramDesc, copy_restored_program) {
+  ProgramDesc program_origin;
+  auto* global_block = program_origin.MutableBlock(0);
+  BlockDesc* sub_block = program_origin.AppendBlock(*global_block);
+  sub_block->AppendOp()->SetType("mul");
+  // More ops than a thread of the pool restores.
+  for (int i = 0; i < 1000; ++i) {
+    auto* op = global_block->AppendOp();
+    op->SetType("scale");
+    op->SetInput("X", {"x" + std::to_string(i)});
+    op->SetOutput("Out", {"x" + std::to_string(i + 1)});
+    op->SetAttr("scale", static_cast<float>(i));
+    op->SetAttr("axes", std::vector<int>{i, i + 1});
+  }
+  auto* op = global_block->AppendOp();
+  op->SetType("op_with_subblock");
+  op->SetAttr("sub_block", sub_block);
+  op->SetAttr("is_test", true);
+
+  std::string binary_str;
+  program_origin.Proto()->SerializeToString(&binary_str);
+  ProgramDesc program_restored(binary_str);
+  // The attrs of the restored ops are copied before they are decoded.
+  ProgramDesc program_copy(program_restored);
+
+  for (auto* program : {&program_restored, &program_copy}) {
+    auto* block = program->MutableBlock(0);
+    ASSERT_EQ(global_block->OpSize(), block->OpSize());
+    for (int i = 0; i < 1000; ++i) {
+      auto* op_restored = block->Op(i);
+      ASSERT_EQ(op_restored->Input("X")[0], "x" + std::to_string(i));
+      ASSERT_EQ(op_restored->Proto()->SerializeAsString(),
+                global_block->Op(i)->Proto()->SerializeAsString());
+      ASSERT_EQ(boost::get<float>(op_restored->GetAttr("scale")),
+                static_cast<float>(i));
+      ASSERT_EQ(boost::get<std::vector<int>>(op_restored->GetAttr("axes")),
+                (std::vector<int>{i, i + 1}));
+    }
+    auto* op_restored = block->Op(1000);
+    ASSERT_EQ(op_restored->BlockAttrNames(),
+              std::vector<std::string>{"sub_block"});
+    ASSERT_EQ(1, op_restored->GetBlockAttrId("sub_block"));
+    ASSERT_TRUE(boost::get<bool>(op_restored->GetAttr("is_test")));
+  }
+}
 }  // namespace framework
 }  // namespace paddle
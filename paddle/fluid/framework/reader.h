@@ -29,6 +29,13 @@ class ReaderBase {
  public:
   virtual void ReadNext(std::vector<LoDTensor>* out);
 
+  // Read the next batch for the device_id-th place of ParallelExecutor. The
+  // readers which do not keep the batches by place read the next one.
+  virtual void ReadNextForDevice(std::vector<LoDTensor>* out,
+                                 size_t device_id) {
+    ReadNext(out);
+  }
+
   virtual void Shutdown();
 
   virtual void Start();
@@ -105,6 +112,11 @@ class ReaderHolder {
     reader_->ReadNext(out);
   }
 
+  void ReadNextForDevice(std::vector<LoDTensor>* out, size_t device_id) {
+    PADDLE_ENFORCE_NOT_NULL(reader_);
+    reader_->ReadNextForDevice(out, device_id);
+  }
+
   void ResetAll() {
     auto end_readers = reader_->GetEndPoints();
     for (auto* reader : end_readers) {
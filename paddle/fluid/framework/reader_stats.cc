@@ -0,0 +1,142 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/reader_stats.h"
+#include <chrono>  // NOLINT
+#include <map>
+#include <mutex>  // NOLINT
+
+namespace paddle {
+namespace framework {
+
+namespace {
+std::mutex g_monitors_mutex;
+std::map<std::string, std::unique_ptr<ReaderMonitor>> g_monitors;
+
+std::atomic<uint64_t> g_num_steps{0};
+std::atomic<uint64_t> g_step_ns{0};
+std::atomic<uint64_t> g_data_wait_ns{0};
+}  // namespace
+
+uint64_t ReaderNowInNsec() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+ReaderMonitor::ReaderMonitor(const std::string& name)
+    : name_(name), queue_size_name_(name + "_queue_size") {
+  wait_event_names_[kProducerWait] = name + "_producer_wait";
+  wait_event_names_[kConsumerWait] = name + "_consumer_wait";
+  wait_event_names_[kParse] = name + "_parse";
+  for (auto& timer : timer_ns_) timer.store(0);
+}
+
+void ReaderMonitor::RecordProduced(uint64_t bytes) {
+  uint64_t now = ReaderNowInNsec();
+  uint64_t zero = 0;
+  first_record_ns_.compare_exchange_strong(zero, now);
+  last_record_ns_.store(now);
+  num_produced_.fetch_add(1);
+  bytes_.fetch_add(bytes);
+}
+
+void ReaderMonitor::RecordQueueSize(size_t size, size_t capacity) {
+  queue_size_.store(size);
+  queue_capacity_.store(capacity);
+  platform::RecordCounter(queue_size_name_, size);
+}
+
+ReaderStats ReaderMonitor::Stats() const {
+  ReaderStats stats;
+  stats.name = name_;
+  stats.num_produced = num_produced_.load();
+  stats.num_consumed = num_consumed_.load();
+  stats.bytes = bytes_.load();
+  uint64_t elapsed_ns = last_record_ns_.load() - first_record_ns_.load();
+  stats.bytes_per_sec = elapsed_ns > 0 ? stats.bytes * 1e9 / elapsed_ns : 0;
+  stats.producer_wait_ms = timer_ns_[kProducerWait].load() / 1e6;
+  stats.consumer_wait_ms = timer_ns_[kConsumerWait].load() / 1e6;
+  stats.parse_ms = timer_ns_[kParse].load() / 1e6;
+  stats.queue_size = queue_size_.load();
+  stats.queue_capacity = queue_capacity_.load();
+  return stats;
+}
+
+void ReaderMonitor::Reset() {
+  num_produced_.store(0);
+  num_consumed_.store(0);
+  bytes_.store(0);
+  first_record_ns_.store(0);
+  last_record_ns_.store(0);
+  for (auto& timer : timer_ns_) timer.store(0);
+}
+
+ReaderTimer::ReaderTimer(ReaderMonitor* monitor, ReaderMonitor::TimerKind kind)
+    : monitor_(monitor), kind_(kind), start_ns_(ReaderNowInNsec()) {
+  if (platform::IsProfileEnabled()) {
+    event_.reset(new platform::RecordEvent(monitor->wait_event_names_[kind],
+                                           nullptr));
+  }
+}
+
+void ReaderTimer::Stop() {
+  if (monitor_ == nullptr) return;
+  event_.reset();
+  monitor_->AddTime(kind_, ReaderNowInNsec() - start_ns_);
+  monitor_ = nullptr;
+}
+
+ReaderMonitor* GetReaderMonitor(const std::string& name) {
+  std::lock_guard<std::mutex> guard(g_monitors_mutex);
+  auto& monitor = g_monitors[name];
+  if (!monitor) monitor.reset(new ReaderMonitor(name));
+  return monitor.get();
+}
+
+std::vector<ReaderStats> GetReaderStats() {
+  std::lock_guard<std::mutex> guard(g_monitors_mutex);
+  std::vector<ReaderStats> stats;
+  for (auto& item : g_monitors) {
+    stats.emplace_back(item.second->Stats());
+  }
+  return stats;
+}
+
+void RecordExecutorStep(uint64_t step_ns, uint64_t data_wait_ns) {
+  g_num_steps.fetch_add(1);
+  g_step_ns.fetch_add(step_ns);
+  g_data_wait_ns.fetch_add(data_wait_ns);
+}
+
+ExecutorStepStats GetExecutorStepStats() {
+  ExecutorStepStats stats;
+  stats.num_steps = g_num_steps.load();
+  stats.step_ms = g_step_ns.load() / 1e6;
+  stats.data_wait_ms = g_data_wait_ns.load() / 1e6;
+  return stats;
+}
+
+void ResetReaderStats() {
+  {
+    std::lock_guard<std::mutex> guard(g_monitors_mutex);
+    for (auto& item : g_monitors) item.second->Reset();
+  }
+  g_num_steps.store(0);
+  g_step_ns.store(0);
+  g_data_wait_ns.store(0);
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,124 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/platform/profiler.h"
+
+namespace paddle {
+namespace framework {
+
+// The snapshot of the stats of a kind of reader, e.g. the buffered_reader.
+struct ReaderStats {
+  std::string name;
+  uint64_t num_produced;
+  uint64_t num_consumed;
+  uint64_t bytes;
+  // Produced bytes per second since the first record of the reader.
+  double bytes_per_sec;
+  // The time spent by the producers waiting for a full queue, and by the
+  // consumers waiting for an empty queue.
+  double producer_wait_ms;
+  double consumer_wait_ms;
+  // The time spent by the producers reading and parsing the data.
+  double parse_ms;
+  // The occupancy of the queue at the last push or pop.
+  uint64_t queue_size;
+  uint64_t queue_capacity;
+};
+
+// The time split of the steps of the Executor, in which data_wait_ms is the
+// time of the read ops waiting for the readers.
+struct ExecutorStepStats {
+  uint64_t num_steps;
+  double step_ms;
+  double data_wait_ms;
+};
+
+/*
+ * The counters of a kind of reader, which are shared by all its instances
+ * and updated by atomics, so that they are always on. The queue occupancy
+ * and the waits are also recorded in the timeline of the profiler when it
+ * is enabled.
+ */
+class ReaderMonitor {
+ public:
+  enum TimerKind { kProducerWait = 0, kConsumerWait, kParse, kNumTimers };
+
+  explicit ReaderMonitor(const std::string& name);
+
+  const std::string& name() const { return name_; }
+
+  void RecordProduced(uint64_t bytes);
+  void RecordConsumed() { num_consumed_.fetch_add(1); }
+  void RecordQueueSize(size_t size, size_t capacity);
+  void AddTime(TimerKind kind, uint64_t ns) { timer_ns_[kind].fetch_add(ns); }
+
+  ReaderStats Stats() const;
+  void Reset();
+
+ private:
+  std::string name_;
+  // The names of the queue size counter and the wait events in the timeline.
+  std::string queue_size_name_;
+  std::string wait_event_names_[kNumTimers];
+  std::atomic<uint64_t> num_produced_{0};
+  std::atomic<uint64_t> num_consumed_{0};
+  std::atomic<uint64_t> bytes_{0};
+  std::atomic<uint64_t> first_record_ns_{0};
+  std::atomic<uint64_t> last_record_ns_{0};
+  std::atomic<uint64_t> timer_ns_[kNumTimers];
+  std::atomic<uint64_t> queue_size_{0};
+  std::atomic<uint64_t> queue_capacity_{0};
+
+  friend class ReaderTimer;
+};
+
+// Add the time of the scope, or till Stop, to the timer of the monitor.
+class ReaderTimer {
+ public:
+  ReaderTimer(ReaderMonitor* monitor, ReaderMonitor::TimerKind kind);
+  ~ReaderTimer() { Stop(); }
+
+  void Stop();
+
+ private:
+  ReaderMonitor* monitor_;
+  ReaderMonitor::TimerKind kind_;
+  uint64_t start_ns_;
+  std::unique_ptr<platform::RecordEvent> event_;
+};
+
+// Get the monitor of the kind of reader, which is never freed.
+ReaderMonitor* GetReaderMonitor(const std::string& name);
+
+std::vector<ReaderStats> GetReaderStats();
+
+void RecordExecutorStep(uint64_t step_ns, uint64_t data_wait_ns);
+
+ExecutorStepStats GetExecutorStepStats();
+
+// Reset the stats of all the readers and the Executor.
+void ResetReaderStats();
+
+uint64_t ReaderNowInNsec();
+
+}  // namespace framework
+}  // namespace paddle
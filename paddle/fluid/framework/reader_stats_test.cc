@@ -0,0 +1,78 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/reader_stats.h"
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+static ReaderStats FindStats(const std::string& name) {
+  for (auto& stats : GetReaderStats()) {
+    if (stats.name == name) return stats;
+  }
+  ADD_FAILURE() << "No stats of " << name;
+  return ReaderStats();
+}
+
+TEST(ReaderMonitor, Stats) {
+  ResetReaderStats();
+  ReaderMonitor* monitor = GetReaderMonitor("test_reader");
+  EXPECT_EQ(GetReaderMonitor("test_reader"), monitor);
+  for (int i = 0; i < 3; ++i) {
+    {
+      ReaderTimer timer(monitor, ReaderMonitor::kParse);
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    monitor->RecordProduced(1024);
+  }
+  monitor->RecordConsumed();
+  monitor->RecordQueueSize(2, 8);
+  {
+    ReaderTimer timer(monitor, ReaderMonitor::kConsumerWait);
+    timer.Stop();
+    // The time after Stop is not counted.
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+
+  auto stats = FindStats("test_reader");
+  EXPECT_EQ(stats.num_produced, 3UL);
+  EXPECT_EQ(stats.num_consumed, 1UL);
+  EXPECT_EQ(stats.bytes, 3072UL);
+  EXPECT_GT(stats.bytes_per_sec, 0);
+  EXPECT_GE(stats.parse_ms, 6);
+  EXPECT_LT(stats.consumer_wait_ms, 10);
+  EXPECT_EQ(stats.queue_size, 2UL);
+  EXPECT_EQ(stats.queue_capacity, 8UL);
+
+  ResetReaderStats();
+  stats = FindStats("test_reader");
+  EXPECT_EQ(stats.num_produced, 0UL);
+  EXPECT_EQ(stats.parse_ms, 0);
+}
+
+TEST(ReaderMonitor, ExecutorStep) {
+  ResetReaderStats();
+  RecordExecutorStep(3000000, 1000000);
+  RecordExecutorStep(5000000, 0);
+  auto stats = GetExecutorStepStats();
+  EXPECT_EQ(stats.num_steps, 2UL);
+  EXPECT_DOUBLE_EQ(stats.step_ms, 8);
+  EXPECT_DOUBLE_EQ(stats.data_wait_ms, 1);
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,180 @@
+//   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/row_spill_file.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <future>  // NOLINT
+
+#include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/platform/enforce.h"
+
+DEFINE_int32(spill_file_read_threads, 4,
+             "the number of the parallel reads of the rows of a sparse table "
+             "spilled to a file");
+
+namespace paddle {
+namespace framework {
+
+RowSpillFile::RowSpillFile(const std::string& path, size_t row_bytes)
+    : path_(path), row_bytes_(row_bytes) {
+  PADDLE_ENFORCE_GT(row_bytes, 0UL);
+#if !defined(_WIN32)
+  fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+  PADDLE_ENFORCE_GE(fd_, 0, "cannot open the spill file %s: %s", path,
+                    std::strerror(errno));
+#else
+  PADDLE_THROW("Spilling the sparse tables is not supported on Windows");
+#endif
+}
+
+RowSpillFile::~RowSpillFile() {
+#if !defined(_WIN32)
+  if (fd_ >= 0) {
+    close(fd_);
+    unlink(path_.c_str());
+  }
+#endif
+}
+
+std::vector<std::pair<size_t, size_t>> RowSpillFile::Runs(
+    const std::vector<std::pair<int64_t, size_t>>& slots) {
+  std::vector<std::pair<size_t, size_t>> runs;
+  for (size_t i = 0; i < slots.size(); ++i) {
+    if (runs.empty() || slots[i].first != slots[i - 1].first + 1) {
+      runs.emplace_back(i, i);
+    }
+    runs.back().second = i + 1;
+  }
+  return runs;
+}
+
+void RowSpillFile::Write(const std::vector<int64_t>& ids,
+                         const std::vector<const char*>& rows) {
+  PADDLE_ENFORCE_EQ(ids.size(), rows.size());
+  std::vector<std::pair<int64_t, size_t>> slots;
+  slots.reserve(ids.size());
+  for (size_t i = 0; i < ids.size(); ++i) {
+    int64_t slot;
+    if (!free_slots_.empty()) {
+      slot = free_slots_.back();
+      free_slots_.pop_back();
+    } else {
+      slot = num_slots_++;
+    }
+    PADDLE_ENFORCE(slots_.emplace(ids[i], slot).second,
+                   "id %d is already in the spill file", ids[i]);
+    slots.emplace_back(slot, i);
+  }
+  std::sort(slots.begin(), slots.end());
+
+#if !defined(_WIN32)
+  std::vector<char> buffer;
+  for (auto& run : Runs(slots)) {
+    size_t bytes = (run.second - run.first) * row_bytes_;
+    buffer.resize(bytes);
+    for (size_t i = run.first; i < run.second; ++i) {
+      std::memcpy(buffer.data() + (i - run.first) * row_bytes_,
+                  rows[slots[i].second], row_bytes_);
+    }
+    off_t offset = static_cast<off_t>(slots[run.first].first * row_bytes_);
+    for (size_t done = 0; done < bytes;) {
+      ssize_t n = pwrite(fd_, buffer.data() + done, bytes - done,
+                         offset + static_cast<off_t>(done));
+      PADDLE_ENFORCE_GT(n, 0, "cannot write the spill file %s: %s", path_,
+                        std::strerror(errno));
+      done += static_cast<size_t>(n);
+    }
+  }
+#endif
+}
+
+void RowSpillFile::Take(const std::vector<int64_t>& ids,
+                        const std::vector<char*>& rows) {
+  PADDLE_ENFORCE_EQ(ids.size(), rows.size());
+  std::vector<std::pair<int64_t, size_t>> slots;
+  slots.reserve(ids.size());
+  for (size_t i = 0; i < ids.size(); ++i) {
+    auto it = slots_.find(ids[i]);
+    PADDLE_ENFORCE(it != slots_.end(), "id %d is not in the spill file",
+                   ids[i]);
+    slots.emplace_back(it->second, i);
+  }
+  std::sort(slots.begin(), slots.end());
+  auto runs = Runs(slots);
+
+#if !defined(_WIN32)
+  auto read_runs = [&](size_t begin, size_t end) {
+    std::vector<char> buffer;
+    for (size_t r = begin; r < end; ++r) {
+      auto& run = runs[r];
+      size_t bytes = (run.second - run.first) * row_bytes_;
+      buffer.resize(bytes);
+      off_t offset = static_cast<off_t>(slots[run.first].first * row_bytes_);
+      for (size_t done = 0; done < bytes;) {
+        ssize_t n = pread(fd_, buffer.data() + done, bytes - done,
+                          offset + static_cast<off_t>(done));
+        PADDLE_ENFORCE_GT(n, 0, "cannot read the spill file %s: %s", path_,
+                          std::strerror(errno));
+        done += static_cast<size_t>(n);
+      }
+      for (size_t i = run.first; i < run.second; ++i) {
+        std::memcpy(rows[slots[i].second],
+                    buffer.data() + (i - run.first) * row_bytes_, row_bytes_);
+      }
+    }
+  };
+  size_t num_runs = runs.size();
+  size_t threads = std::min<size_t>(
+      std::max(FLAGS_spill_file_read_threads, 1), num_runs);
+  if (threads <= 1) {
+    read_runs(0, num_runs);
+  } else {
+    // The SSDs serve the parallel reads of the runs much faster than a
+    // sequence of them.
+    size_t chunk = (num_runs + threads - 1) / threads;
+    std::vector<std::future<void>> fs;
+    for (size_t begin = 0; begin < num_runs; begin += chunk) {
+      size_t end = std::min(begin + chunk, num_runs);
+      fs.push_back(AsyncIO([&, begin, end] { read_runs(begin, end); }));
+    }
+    std::exception_ptr error;
+    for (auto& f : fs) {
+      try {
+        f.get();
+      } catch (...) {
+        error = std::current_exception();
+      }
+    }
+    if (error) std::rethrow_exception(error);
+  }
+#endif
+
+  for (auto id : ids) {
+    auto it = slots_.find(id);
+    free_slots_.push_back(it->second);
+    slots_.erase(it);
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,80 @@
+//   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+/*
+ * @brief The rows of a sparse table spilled to a file, e.g. on an SSD.
+ *
+ *  Each row takes a fixed slot of row_bytes in the file, and the slots of
+ *  the rows read back are reused by the rows written later. The rows of a
+ *  call are sorted by their slots, the adjacent ones are read or written by
+ *  one pread or pwrite, and the runs of a read go on in parallel.
+ *
+ *  It is not thread-safe, the table that spills the rows serializes the
+ *  writes and the reads, while Has can be called concurrently between them.
+ *  The file is removed when RowSpillFile is destroyed.
+ */
+class RowSpillFile {
+ public:
+  RowSpillFile(const std::string& path, size_t row_bytes);
+  ~RowSpillFile();
+
+  RowSpillFile(const RowSpillFile& other) = delete;
+  RowSpillFile& operator=(const RowSpillFile& other) = delete;
+
+  bool Has(int64_t id) const { return slots_.count(id) != 0; }
+
+  /*
+   * @return the number of the rows in the file.
+   */
+  size_t Size() const { return slots_.size(); }
+
+  /*
+   * @brief Write the rows of the unique ids, which are not in the file.
+   */
+  void Write(const std::vector<int64_t>& ids,
+             const std::vector<const char*>& rows);
+
+  /*
+   * @brief Read the rows of the unique ids, which are in the file, and remove
+   * them from the file.
+   */
+  void Take(const std::vector<int64_t>& ids, const std::vector<char*>& rows);
+
+ private:
+  // Group the sorted (slot, i) pairs into the runs of adjacent slots, as the
+  // [begin, end) ranges of the pairs.
+  static std::vector<std::pair<size_t, size_t>> Runs(
+      const std::vector<std::pair<int64_t, size_t>>& slots);
+
+  std::string path_;
+  size_t row_bytes_;
+  int fd_{-1};
+  int64_t num_slots_{0};
+  std::vector<int64_t> free_slots_;
+  std::unordered_map<int64_t, int64_t> slots_;
+};
+
+}  // namespace framework
+}  // namespace paddle
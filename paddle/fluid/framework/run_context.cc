@@ -0,0 +1,43 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+
+#include "paddle/fluid/framework/run_context.h"
+
+namespace paddle {
+namespace framework {
+
+static thread_local RunContext* tls_run_context = nullptr;
+
+constexpr int64_t RunContext::kNoDeadline;
+
+void RunContext::Check() const {
+  if (IsCancelled()) {
+    throw RunStoppedError("The run is cancelled");
+  }
+  if (IsExpired()) {
+    throw RunStoppedError("The deadline of the run is exceeded");
+  }
+}
+
+RunContext* CurrentRunContext() { return tls_run_context; }
+
+ScopedRunContext::ScopedRunContext(RunContext* ctx) : prev_(tls_run_context) {
+  tls_run_context = ctx;
+}
+
+ScopedRunContext::~ScopedRunContext() { tls_run_context = prev_; }
+
+}  // namespace framework
+}  // namespace paddle
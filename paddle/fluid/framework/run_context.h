@@ -0,0 +1,111 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include "paddle/fluid/platform/macros.h"  // for DISABLE_COPY_AND_ASSIGN
+
+namespace paddle {
+namespace framework {
+
+// The error CheckRunContext() throws to stop a run, which the predictors
+// catch to fail the run instead of the process.
+class RunStoppedError : public std::runtime_error {
+ public:
+  explicit RunStoppedError(const std::string& what)
+      : std::runtime_error(what) {}
+};
+
+// RunContext is the deadline and the cancellation of a request. The
+// executors check it between the ops, so that the work of a request whose
+// client has timed out or gone is dropped at the next op instead of run to
+// the end. Cancel() may be called from any thread while the run is in
+// flight, the other setters before the run.
+class RunContext {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  RunContext() = default;
+
+  // The deadline is timeout_ms milliseconds from now, none if <= 0.
+  void SetTimeout(int64_t timeout_ms) {
+    deadline_us_ = timeout_ms > 0
+                       ? ToMicroseconds(Clock::now() +
+                                        std::chrono::milliseconds(timeout_ms))
+                       : kNoDeadline;
+  }
+  void SetDeadline(Clock::time_point deadline) {
+    deadline_us_ = ToMicroseconds(deadline);
+  }
+  bool has_deadline() const { return deadline_us_ != kNoDeadline; }
+
+  void Cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+  bool IsCancelled() const {
+    return cancelled_.load(std::memory_order_relaxed);
+  }
+  bool IsExpired() const {
+    return has_deadline() && ToMicroseconds(Clock::now()) >= deadline_us_;
+  }
+  bool IsStopped() const { return IsCancelled() || IsExpired(); }
+
+  // Throws RunStoppedError if the run is cancelled or expired.
+  void Check() const;
+
+ private:
+  DISABLE_COPY_AND_ASSIGN(RunContext);
+
+  static constexpr int64_t kNoDeadline = INT64_MAX;
+
+  static int64_t ToMicroseconds(Clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               t.time_since_epoch())
+        .count();
+  }
+
+  std::atomic<bool> cancelled_{false};
+  int64_t deadline_us_{kNoDeadline};
+};
+
+// The context of the run of the current thread, nullptr if none.
+RunContext* CurrentRunContext();
+
+// Sets the context of the current thread during the lifetime of the object,
+// nullptr for none, e.g. while the ops are captured into a CUDA graph, which
+// must not be stopped in the middle.
+class ScopedRunContext {
+ public:
+  explicit ScopedRunContext(RunContext* ctx);
+  ~ScopedRunContext();
+
+ private:
+  DISABLE_COPY_AND_ASSIGN(ScopedRunContext);
+
+  RunContext* prev_;
+};
+
+// Throws RunStoppedError if the context of the current thread is cancelled
+// or expired, it costs a thread-local load without a context.
+inline void CheckRunContext() {
+  auto* ctx = CurrentRunContext();
+  if (ctx != nullptr) ctx->Check();
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,67 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+
+#include "paddle/fluid/framework/run_context.h"
+#include <gtest/gtest.h>
+#include <thread>  // NOLINT
+
+namespace framework = paddle::framework;
+
+TEST(RunContext, NoContext) {
+  EXPECT_EQ(framework::CurrentRunContext(), nullptr);
+  EXPECT_NO_THROW(framework::CheckRunContext());
+}
+
+TEST(RunContext, Cancel) {
+  framework::RunContext ctx;
+  framework::ScopedRunContext scope(&ctx);
+  EXPECT_EQ(framework::CurrentRunContext(), &ctx);
+  EXPECT_FALSE(ctx.IsStopped());
+  EXPECT_NO_THROW(framework::CheckRunContext());
+
+  std::thread canceller([&ctx] { ctx.Cancel(); });
+  canceller.join();
+  EXPECT_TRUE(ctx.IsCancelled());
+  EXPECT_FALSE(ctx.IsExpired());
+  EXPECT_THROW(framework::CheckRunContext(), framework::RunStoppedError);
+}
+
+TEST(RunContext, Deadline) {
+  framework::RunContext ctx;
+  EXPECT_FALSE(ctx.has_deadline());
+  ctx.SetTimeout(60 * 1000);
+  EXPECT_TRUE(ctx.has_deadline());
+  EXPECT_FALSE(ctx.IsExpired());
+
+  ctx.SetDeadline(framework::RunContext::Clock::now() -
+                  std::chrono::milliseconds(1));
+  EXPECT_TRUE(ctx.IsExpired());
+  EXPECT_FALSE(ctx.IsCancelled());
+  EXPECT_THROW(ctx.Check(), framework::RunStoppedError);
+
+  ctx.SetTimeout(0);
+  EXPECT_FALSE(ctx.has_deadline());
+  EXPECT_NO_THROW(ctx.Check());
+}
+
+TEST(RunContext, ScopeIsRestored) {
+  framework::RunContext outer;
+  framework::ScopedRunContext outer_scope(&outer);
+  {
+    framework::ScopedRunContext inner_scope(nullptr);
+    EXPECT_EQ(framework::CurrentRunContext(), nullptr);
+  }
+  EXPECT_EQ(framework::CurrentRunContext(), &outer);
+}
@@ -42,6 +42,11 @@ DEFINE_bool(fast_eager_deletion_mode, false,
             "Fast eager deletion mode. If enabled, memory would release "
             "immediately without waiting GPU kernel ends.");
 
+DEFINE_bool(inline_eager_deletion_mode, false,
+            "Inline eager deletion mode. If enabled, variables are freed by "
+            "the ops that read them last, instead of by the extra "
+            "eager_deletion ops in the graph of ParallelExecutor.");
+
 // When in inference scenario, the scopes will not be written by two threads in
 // a mean time, but a scope may be read by multiple threads concurrently, and
 // the mutex will cause serious performance issue.
@@ -70,6 +75,10 @@ int64_t GetEagerDeletionThreshold() {
 
 bool IsFastEagerDeletionModeEnabled() { return FLAGS_fast_eager_deletion_mode; }
 
+bool IsInlineEagerDeletionModeEnabled() {
+  return FLAGS_inline_eager_deletion_mode;
+}
+
 Scope::~Scope() { DropKids(); }
 
 Scope& Scope::NewScope() const {
@@ -82,6 +91,10 @@ Scope& Scope::NewScope() const {
 }
 
 Variable* Scope::Var(const std::string& name) {
+  if (IsSealed()) {
+    auto* var = FindSealedVar(name);
+    if (var != nullptr) return var;
+  }
   SCOPE_VARS_WRITER_LOCK
   return VarInternal(name);
 }
@@ -89,7 +102,7 @@ Variable* Scope::Var(const std::string& name) {
 Variable* Scope::Var(std::string* name) {
   SCOPE_VARS_WRITER_LOCK
   auto new_name = std::to_string(reinterpret_cast<uintptr_t>(this)) + "." +
-                  std::to_string(vars_.size());
+                  std::to_string(vars_.size() + unsealed_vars_.size());
   if (name != nullptr) {
     *name = new_name;
   }
@@ -97,11 +110,23 @@ Variable* Scope::Var(std::string* name) {
 }
 
 Variable* Scope::FindVar(const std::string& name) const {
+  if (IsSealed()) {
+    auto* var = FindSealedVar(name);
+    if (var != nullptr) return var;
+    if (!has_unsealed_vars_.load(std::memory_order_acquire)) {
+      return (parent_ == nullptr) ? nullptr : parent_->FindVar(name);
+    }
+  }
   SCOPE_VARS_READER_LOCK
   return FindVarInternal(name);
 }
 
 Variable* Scope::FindLocalVar(const std::string& name) const {
+  if (IsSealed()) {
+    auto* var = FindSealedVar(name);
+    if (var != nullptr) return var;
+    if (!has_unsealed_vars_.load(std::memory_order_acquire)) return nullptr;
+  }
   SCOPE_VARS_READER_LOCK
   return FindVarLocally(name);
 }
@@ -127,10 +152,13 @@ std::vector<std::string> Scope::LocalVarNames() const {
   std::vector<std::string> known_vars;
   {
     SCOPE_VARS_READER_LOCK
-    known_vars.reserve(this->vars_.size());
+    known_vars.reserve(this->vars_.size() + this->unsealed_vars_.size());
     for (auto& p : vars_) {
       known_vars.emplace_back(p.first);
     }
+    for (auto& p : unsealed_vars_) {
+      known_vars.emplace_back(p.first);
+    }
   }
   return known_vars;
 }
@@ -152,9 +180,16 @@ void Scope::DeleteScope(Scope* scope) const {
 void Scope::EraseVars(const std::vector<std::string>& var_names) {
   std::set<std::string> var_set(var_names.begin(), var_names.end());
   SCOPE_VARS_WRITER_LOCK
-  for (auto it = vars_.begin(); it != vars_.end();) {
+  if (IsSealed()) {
+    for (auto& name : var_set) {
+      PADDLE_ENFORCE(vars_.count(name) == 0,
+                     "Cannot erase the sealed variable %s", name);
+    }
+  }
+  auto& vars = MutableVars();
+  for (auto it = vars.begin(); it != vars.end();) {
     if (var_set.find(it->first) != var_set.end()) {
-      it = vars_.erase(it);
+      it = vars.erase(it);
     } else {
       ++it;
     }
@@ -169,16 +204,25 @@ void Scope::Rename(const std::string& origin_name,
 
 std::string Scope::Rename(const std::string& origin_name) const {
   SCOPE_VARS_WRITER_LOCK
-  auto new_name = string::Sprintf("%p.%d", this, vars_.size());
+  auto new_name =
+      string::Sprintf("%p.%d", this, vars_.size() + unsealed_vars_.size());
   RenameInternal(origin_name, new_name);
   return new_name;
 }
 
+void Scope::Seal() {
+  SCOPE_VARS_WRITER_LOCK
+  sealed_.store(true, std::memory_order_release);
+}
+
 Variable* Scope::VarInternal(const std::string& name) {
   auto* v = FindVarLocally(name);
   if (v != nullptr) return v;
   v = new Variable();
-  vars_.emplace(name, std::unique_ptr<Variable>(v));
+  MutableVars().emplace(name, std::unique_ptr<Variable>(v));
+  if (IsSealed()) {
+    has_unsealed_vars_.store(true, std::memory_order_release);
+  }
   VLOG(3) << "Create variable " << name;
   return v;
 }
@@ -189,19 +233,32 @@ const Scope* Scope::FindScopeInternal(const Variable* var) const {
       return this;
     }
   }
+  for (auto& kv : unsealed_vars_) {
+    if (kv.second.get() == var) {
+      return this;
+    }
+  }
   return (parent_ == nullptr) ? nullptr : parent_->FindScope(var);
 }
 
 void Scope::RenameInternal(const std::string& origin_name,
                            const std::string& new_name) const {
-  auto origin_it = vars_.find(origin_name);
-  PADDLE_ENFORCE(origin_it != vars_.end(),
+  if (IsSealed()) {
+    PADDLE_ENFORCE(vars_.count(origin_name) == 0,
+                   "Cannot rename the sealed variable %s", origin_name);
+    PADDLE_ENFORCE(vars_.count(new_name) == 0,
+                   "The variable with name %s is already in the scope",
+                   new_name);
+  }
+  auto& vars = MutableVars();
+  auto origin_it = vars.find(origin_name);
+  PADDLE_ENFORCE(origin_it != vars.end(),
                  "Cannot find original variable with name %s", origin_name);
-  auto new_it = vars_.find(new_name);
-  PADDLE_ENFORCE(new_it == vars_.end(),
+  auto new_it = vars.find(new_name);
+  PADDLE_ENFORCE(new_it == vars.end(),
                  "The variable with name %s is already in the scope", new_name);
-  vars_[new_name].reset(origin_it->second.release());
-  vars_.erase(origin_it);
+  vars[new_name].reset(origin_it->second.release());
+  vars.erase(origin_it);
 }
 
 Variable* Scope::FindVarInternal(const std::string& name) const {
@@ -213,6 +270,15 @@ Variable* Scope::FindVarInternal(const std::string& name) const {
 }
 
 Variable* Scope::FindVarLocally(const std::string& name) const {
+  auto it = vars_.find(name);
+  if (it != vars_.end()) return it->second.get();
+  if (unsealed_vars_.empty()) return nullptr;
+  it = unsealed_vars_.find(name);
+  if (it != unsealed_vars_.end()) return it->second.get();
+  return nullptr;
+}
+
+Variable* Scope::FindSealedVar(const std::string& name) const {
   auto it = vars_.find(name);
   if (it != vars_.end()) return it->second.get();
   return nullptr;
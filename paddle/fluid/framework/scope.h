@@ -18,6 +18,7 @@ extern "C" {
 #include <xxhash.h>
 }
 
+#include <atomic>
 #include <list>
 #include <memory>
 #include <string>
@@ -34,6 +35,7 @@ namespace framework {
 
 int64_t GetEagerDeletionThreshold();
 bool IsFastEagerDeletionModeEnabled();
+bool IsInlineEagerDeletionModeEnabled();
 
 class Scope;
 
@@ -100,6 +102,15 @@ class Scope {
   // Rename variable to a new name and return the new name
   std::string Rename(const std::string& origin_name) const;
 
+  /// Freeze the variables created so far, e.g. the parameters after the
+  /// initialization, so that the lookups of them do not lock, when the scope
+  /// is read by many threads. The sealed variables can not be erased or
+  /// renamed, and the variables created after sealing are kept apart and
+  /// locked as usual.
+  void Seal();
+
+  bool IsSealed() const { return sealed_.load(std::memory_order_acquire); }
+
  protected:
   struct KeyHasher {
     std::size_t operator()(const std::string& key) const {
@@ -109,6 +120,9 @@ class Scope {
 
   mutable std::unordered_map<std::string, std::unique_ptr<Variable>, KeyHasher>
       vars_;
+  // The variables created after sealing, vars_ is not changed once sealed.
+  mutable std::unordered_map<std::string, std::unique_ptr<Variable>, KeyHasher>
+      unsealed_vars_;
 
  private:
   // Call Scope::NewScope for a sub-scope.
@@ -130,6 +144,16 @@ class Scope {
   // Called by FindVarInternal and Var.
   Variable* FindVarLocally(const std::string& name) const;
 
+  // Find a sealed variable without locking, called by FindVar and
+  // FindLocalVar.
+  Variable* FindSealedVar(const std::string& name) const;
+
+  // The map which the variables are created in and erased from.
+  std::unordered_map<std::string, std::unique_ptr<Variable>, KeyHasher>&
+  MutableVars() const {
+    return IsSealed() ? unsealed_vars_ : vars_;
+  }
+
   // Scope in `kids_` are owned by this class.
   mutable std::list<Scope*> kids_;
   const Scope* parent_{nullptr};
@@ -139,6 +163,10 @@ class Scope {
  private:
   mutable RWLock kids_lock_;
   mutable RWLock vars_lock_;
+  std::atomic<bool> sealed_{false};
+  // Whether unsealed_vars_ is not empty, the lookups missing the sealed
+  // variables lock only if it is set.
+  std::atomic<bool> has_unsealed_vars_{false};
 };
 
 // Generate some debug string about the inherience structure of scope, quite
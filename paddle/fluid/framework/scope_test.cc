@@ -69,3 +69,32 @@ TEST(Scope, GetAllNames) {
 
   EXPECT_STREQ("a", str.c_str());
 }
+
+TEST(Scope, Seal) {
+  Scope s;
+  Scope& ss = s.NewScope();
+  Variable* a = s.Var("a");
+  s.Seal();
+  EXPECT_TRUE(s.IsSealed());
+  EXPECT_FALSE(ss.IsSealed());
+
+  EXPECT_EQ(a, s.Var("a"));
+  EXPECT_EQ(a, ss.FindVar("a"));
+  EXPECT_EQ(nullptr, s.FindVar("b"));
+
+  // The variables created after sealing can be erased and renamed.
+  Variable* b = s.Var("b");
+  EXPECT_EQ(b, ss.FindVar("b"));
+  EXPECT_EQ(b, s.FindLocalVar("b"));
+  EXPECT_EQ(&s, ss.FindScope(b));
+  EXPECT_EQ(2UL, s.LocalVarNames().size());
+  s.Rename("b", "c");
+  EXPECT_EQ(nullptr, s.FindVar("b"));
+  EXPECT_EQ(b, s.FindVar("c"));
+  s.EraseVars({"c"});
+  EXPECT_EQ(nullptr, s.FindVar("c"));
+
+  EXPECT_ANY_THROW(s.EraseVars({"a"}));
+  EXPECT_ANY_THROW(s.Rename("a", "d"));
+  EXPECT_EQ(a, s.FindVar("a"));
+}
@@ -14,6 +14,10 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/selected_rows.h"
 
+#include <cstring>
+#include <ctime>
+#include <unordered_set>
+
 namespace paddle {
 namespace framework {
 
@@ -135,76 +139,497 @@ void DeserializeFromStream(std::istream& is, SelectedRows* selected_rows,
   TensorFromStream(is, selected_rows->mutable_value(), dev_ctx);
 }
 
-bool SelectedRows::HasKey(int64_t key) const {
-  return std::find(rows_.begin(), rows_.end(), key) == rows_.end() ? false
-                                                                   : true;
+void SelectedRows::UpdateIndex() const {
+  auto& state = *index_state_;
+  size_t num_indexed_rows = state.num_indexed_rows.load();
+  if (state.dirty.load() || num_indexed_rows > rows_.size()) {
+    id_to_index_->Clear();
+    num_indexed_rows = 0;
+    state.dirty.store(false);
+  }
+  for (size_t i = num_indexed_rows; i < rows_.size(); ++i) {
+    id_to_index_->Insert(rows_[i], static_cast<int64_t>(i));
+  }
+  state.num_indexed_rows.store(rows_.size(), std::memory_order_release);
 }
 
+int64_t SelectedRows::FindIndex(int64_t key) const {
+  auto& state = *index_state_;
+  auto is_at = [this](int64_t key, int64_t index) {
+    return index >= 0 && static_cast<size_t>(index) < rows_.size() &&
+           rows_[index] == key;
+  };
+  // A key found at its index in rows_ only takes the read locks of its shard
+  // and of rows_, one after the other.
+  if (!state.dirty.load(std::memory_order_acquire)) {
+    int64_t index = id_to_index_->Find(key);
+    AutoRDLock rows_guard(&state.rows_lock);
+    if (state.num_indexed_rows.load(std::memory_order_acquire) ==
+            rows_.size() &&
+        is_at(key, index)) {
+      return index;
+    }
+  }
+  // The writers of rows_ hold the mutex as well.
+  std::lock_guard<std::mutex> guard(state.mutex);
+  UpdateIndex();
+  int64_t index = id_to_index_->Find(key);
+  if (is_at(key, index)) {
+    return index;
+  }
+  // The key is missing or moved, the rows may have been edited in place
+  // through mutable_rows().
+  state.dirty.store(true);
+  UpdateIndex();
+  return id_to_index_->Find(key);
+}
+
+int64_t SelectedRows::Index(int64_t key) const {
+  auto index = FindIndex(key);
+  if (index < 0) {
+    PADDLE_THROW("id %s not in table", key);
+  }
+  return index;
+}
+
+bool SelectedRows::HasKey(int64_t key) const { return FindIndex(key) >= 0; }
+
 int64_t SelectedRows::AutoGrownIndex(int64_t key, bool auto_grown,
                                      bool is_test) {
   if (is_test) {
-    auto iter = id_to_index_.find(key);
-    if (iter == id_to_index_.end()) {
-      return -1;
-    } else {
-      return iter->second;
-    }
-  }
-
-  rwlock_->RDLock();
-  auto iter = id_to_index_.find(key);
-  if (iter == id_to_index_.end()) {
-    rwlock_->UNLock();
-    if (!auto_grown) {
-      PADDLE_THROW("key %d not found", key);
-    }
-    rwlock_->WRLock();
-    auto map_size = id_to_index_.size();
-    auto vector_size = rows_.size();
-    if (map_size != vector_size) {
-      rwlock_->UNLock();
-      PADDLE_THROW(
-          "id_to_index_ size %d should have the same size with rows_ %d",
-          map_size, vector_size);
-    }
-    auto write_iter = id_to_index_.find(key);
-    if (write_iter == id_to_index_.end()) {
-      int row_num = rows_.size();
-      if (row_num == value_->dims()[0]) {
-        rwlock_->UNLock();
-        PADDLE_THROW("selected rows is full, then length exceed %d", row_num);
+    return id_to_index_->Find(key);
+  }
+
+  auto index = id_to_index_->Find(key);
+  if (index >= 0) {
+    return index;
+  }
+  if (!auto_grown) {
+    PADDLE_THROW("key %d not found", key);
+  }
+  if (lifecycle_ != nullptr) {
+    // The admitted ids are added by PinRows.
+    return -1;
+  }
+
+  // Appending to rows_ is serialized, while the lookups of the other keys
+  // only take the read locks of their shards and go on in parallel.
+  std::lock_guard<std::mutex> guard(index_state_->mutex);
+  UpdateIndex();
+  return id_to_index_->FindOrInsert(key, [this, key]() -> int64_t {
+    int row_num = rows_.size();
+    if (row_num == value_->dims()[0]) {
+      PADDLE_THROW("selected rows is full, then length exceed %d", row_num);
+    }
+    // key logic to put a key into id_to_index_
+    AutoWRLock rows_guard(&index_state_->rows_lock);
+    rows_.push_back(key);
+    index_state_->num_indexed_rows.store(rows_.size());
+    return static_cast<int64_t>(rows_.size() - 1);
+  });
+}
+
+void SelectedRows::SyncIndex() {
+  std::lock_guard<std::mutex> guard(index_state_->mutex);
+  index_state_->dirty.store(true);
+  UpdateIndex();
+}
+
+void SelectedRows::EnableSpill(const std::string& path) {
+  PADDLE_ENFORCE(spill_ == nullptr, "The table already spills");
+  PADDLE_ENFORCE(value_->IsInitialized() && value_->dims()[0] > 0,
+                 "The value of the table should be initialized.");
+  PADDLE_ENFORCE(platform::is_cpu_place(value_->place()),
+                 "Only the tables on CPU can spill.");
+  int64_t capacity = value_->dims()[0];
+  size_t row_bytes = value_->numel() / capacity * SizeOfType(value_->type());
+  spill_.reset(new RowSpillFile(path, row_bytes));
+  if (tier_lock_ == nullptr) {
+    tier_lock_.reset(new RWLock);
+  }
+  referenced_.reset(new std::atomic<uint8_t>[capacity]);
+  for (int64_t i = 0; i < capacity; ++i) {
+    referenced_[i].store(0, std::memory_order_relaxed);
+  }
+  clock_hand_ = 0;
+}
+
+void SelectedRows::EnableLifecycle(int64_t admit_count,
+                                   int64_t max_idle_seconds,
+                                   int64_t min_accesses,
+                                   int64_t shrink_seconds) {
+  PADDLE_ENFORCE(lifecycle_ == nullptr,
+                 "The table already manages the lifecycle of the rows");
+  PADDLE_ENFORCE(value_->IsInitialized() && value_->dims()[0] > 0,
+                 "The value of the table should be initialized.");
+  PADDLE_ENFORCE(platform::is_cpu_place(value_->place()),
+                 "Only the tables on CPU manage the lifecycle of the rows.");
+  int64_t capacity = value_->dims()[0];
+  int64_t now = static_cast<int64_t>(std::time(nullptr));
+  lifecycle_.reset(new Lifecycle);
+  lifecycle_->admit_count = admit_count;
+  lifecycle_->max_idle_seconds = max_idle_seconds;
+  lifecycle_->min_accesses = min_accesses;
+  lifecycle_->shrink_seconds = shrink_seconds;
+  if (admit_count > 1) {
+    // Two counters per row of the table in each row of the sketch.
+    lifecycle_->sketch.reset(new CountMinSketch(2 * capacity));
+  }
+  lifecycle_->last_access.reset(new std::atomic<int64_t>[capacity]);
+  lifecycle_->accesses.reset(new std::atomic<uint32_t>[capacity]);
+  for (int64_t i = 0; i < capacity; ++i) {
+    lifecycle_->last_access[i].store(now, std::memory_order_relaxed);
+    lifecycle_->accesses[i].store(0, std::memory_order_relaxed);
+  }
+  lifecycle_->next_shrink.store(now + shrink_seconds);
+  if (tier_lock_ == nullptr) {
+    tier_lock_.reset(new RWLock);
+  }
+}
+
+bool SelectedRows::Admit(int64_t id, bool count) {
+  if (lifecycle_ == nullptr || lifecycle_->sketch == nullptr) {
+    return true;
+  }
+  uint32_t n = count ? lifecycle_->sketch->Add(id)
+                     : lifecycle_->sketch->Estimate(id);
+  return n >= static_cast<uint32_t>(lifecycle_->admit_count);
+}
+
+size_t SelectedRows::Shrink(int64_t max_idle_seconds, int64_t min_accesses) {
+  PADDLE_ENFORCE_NOT_NULL(lifecycle_,
+                          "The table does not manage the lifecycle of the "
+                          "rows");
+  AutoWRLock guard(tier_lock_.get());
+  std::lock_guard<std::mutex> index_guard(index_state_->mutex);
+  auto& lifecycle = *lifecycle_;
+  int64_t now = static_cast<int64_t>(std::time(nullptr));
+  int64_t capacity = value_->dims()[0];
+  size_t row_bytes = value_->numel() / capacity * SizeOfType(value_->type());
+  char* data = reinterpret_cast<char*>(value_->data<void>());
+
+  AutoWRLock rows_guard(&index_state_->rows_lock);
+  size_t num_rows = rows_.size();
+  size_t kept = 0;
+  for (size_t slot = 0; slot < num_rows; ++slot) {
+    int64_t last_access =
+        lifecycle.last_access[slot].load(std::memory_order_relaxed);
+    int64_t accesses = lifecycle.accesses[slot].load(std::memory_order_relaxed);
+    if ((max_idle_seconds > 0 && now - last_access > max_idle_seconds) ||
+        accesses < min_accesses) {
+      if (dirty_ != nullptr) {
+        int64_t id = rows_[slot];
+        size_t shard = static_cast<uint64_t>(id) % DirtyRows::kShards;
+        std::lock_guard<std::mutex> dirty_guard(dirty_->mutexes[shard]);
+        dirty_->updated[shard].erase(id);
+        dirty_->removed.insert(id);
       }
-      // key logic to put a key into id_to_index_
-      rows_.push_back(key);
-      auto index = static_cast<int64_t>(rows_.size() - 1);
-      id_to_index_[key] = index;
-      rwlock_->UNLock();
-      return index;
+      continue;
+    }
+    if (kept != slot) {
+      std::memcpy(data + kept * row_bytes, data + slot * row_bytes, row_bytes);
+      rows_[kept] = rows_[slot];
+      lifecycle.last_access[kept].store(last_access, std::memory_order_relaxed);
+      if (referenced_ != nullptr) {
+        referenced_[kept].store(
+            referenced_[slot].load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+      }
+    }
+    lifecycle.accesses[kept].store(0, std::memory_order_relaxed);
+    ++kept;
+  }
+  std::memset(data + kept * row_bytes, 0, (num_rows - kept) * row_bytes);
+  rows_.resize(kept);
+  index_state_->dirty.store(true);
+  UpdateIndex();
+  clock_hand_ = 0;
+  if (lifecycle.sketch != nullptr) {
+    lifecycle.sketch->Decay();
+  }
+  VLOG(3) << "shrink the table from " << num_rows << " rows to " << kept;
+  return num_rows - kept;
+}
+
+std::unique_ptr<AutoRDLock> SelectedRows::PinRows(const int64_t* ids,
+                                                  int64_t num,
+                                                  bool auto_grown,
+                                                  bool is_test) {
+  if (tier_lock_ == nullptr) {
+    return nullptr;
+  }
+  int64_t now = 0;
+  if (lifecycle_ != nullptr) {
+    now = static_cast<int64_t>(std::time(nullptr));
+    int64_t next_shrink = lifecycle_->next_shrink.load();
+    // One of the lookups after the interval shrinks the table.
+    if (lifecycle_->shrink_seconds > 0 && now >= next_shrink &&
+        lifecycle_->next_shrink.compare_exchange_strong(
+            next_shrink, now + lifecycle_->shrink_seconds)) {
+      Shrink(lifecycle_->max_idle_seconds, lifecycle_->min_accesses);
+    }
+  }
+  bool grow = auto_grown && !is_test;
+  for (bool retry = false;; retry = true) {
+    std::unique_ptr<AutoRDLock> guard(new AutoRDLock(tier_lock_.get()));
+    bool resident = true;
+    for (int64_t i = 0; i < num; ++i) {
+      int64_t index = id_to_index_->Find(ids[i]);
+      if (index >= 0) {
+        TouchRow(index, now);
+        continue;
+      }
+      if (spill_ != nullptr && spill_->Has(ids[i])) {
+        resident = false;
+        continue;
+      }
+      // The lookups of a retry are counted already.
+      if (!grow || !Admit(ids[i], !retry)) {
+        continue;
+      }
+      // The new rows are appended until the table is full.
+      std::lock_guard<std::mutex> index_guard(index_state_->mutex);
+      UpdateIndex();
+      if (id_to_index_->Find(ids[i]) >= 0) {
+        continue;
+      }
+      if (static_cast<int64_t>(rows_.size()) < value_->dims()[0]) {
+        {
+          AutoWRLock rows_guard(&index_state_->rows_lock);
+          rows_.push_back(ids[i]);
+        }
+        index_state_->num_indexed_rows.store(rows_.size());
+        index = static_cast<int64_t>(rows_.size()) - 1;
+        id_to_index_->Insert(ids[i], index);
+        TouchRow(index, now);
+      } else if (spill_ != nullptr) {
+        resident = false;
+      }
+    }
+    if (resident) {
+      return guard;
+    }
+    guard.reset();
+    AutoWRLock write_guard(tier_lock_.get());
+    LoadRows(ids, num, auto_grown, is_test, now);
+  }
+}
+
+void SelectedRows::LoadRows(const int64_t* ids, int64_t num, bool auto_grown,
+                            bool is_test, int64_t now) {
+  std::lock_guard<std::mutex> index_guard(index_state_->mutex);
+  UpdateIndex();
+  int64_t capacity = value_->dims()[0];
+  bool grow = auto_grown && !is_test;
+
+  // The rows of ids in value_ are not spilled for the others.
+  std::unordered_set<int64_t> pinned;
+  std::unordered_set<int64_t> seen;
+  std::vector<int64_t> missing;
+  for (int64_t i = 0; i < num; ++i) {
+    int64_t index = id_to_index_->Find(ids[i]);
+    if (index >= 0) {
+      pinned.insert(index);
+    } else if ((spill_->Has(ids[i]) || (grow && Admit(ids[i], false))) &&
+               seen.insert(ids[i]).second) {
+      missing.push_back(ids[i]);
+    }
+  }
+  if (missing.empty()) {
+    return;
+  }
+
+  std::vector<int64_t> slots;
+  {
+    AutoWRLock rows_guard(&index_state_->rows_lock);
+    while (slots.size() < missing.size() &&
+           static_cast<int64_t>(rows_.size()) < capacity) {
+      rows_.push_back(missing[slots.size()]);
+      slots.push_back(static_cast<int64_t>(rows_.size()) - 1);
+    }
+  }
+  index_state_->num_indexed_rows.store(rows_.size());
+  size_t num_evicted = missing.size() - slots.size();
+  PADDLE_ENFORCE_LE(pinned.size() + missing.size(),
+                    static_cast<size_t>(capacity),
+                    "The rows of a lookup exceed the capacity %d of the table",
+                    capacity);
+
+  // Spill the rows not referenced since the clock hand passed them.
+  int64_t width = value_->numel() / capacity;
+  size_t row_bytes = width * SizeOfType(value_->type());
+  char* data = reinterpret_cast<char*>(value_->data<void>());
+  std::vector<int64_t> evicted_ids;
+  std::vector<const char*> evicted_rows;
+  while (evicted_ids.size() < num_evicted) {
+    int64_t slot = clock_hand_;
+    clock_hand_ = (clock_hand_ + 1) % capacity;
+    if (pinned.count(slot)) {
+      continue;
+    }
+    if (referenced_[slot].exchange(0, std::memory_order_relaxed)) {
+      continue;
+    }
+    pinned.insert(slot);
+    slots.push_back(slot);
+    evicted_ids.push_back(rows_[slot]);
+    evicted_rows.push_back(data + slot * row_bytes);
+  }
+  spill_->Write(evicted_ids, evicted_rows);
+  for (auto id : evicted_ids) {
+    id_to_index_->Erase(id);
+  }
+  VLOG(4) << "spilled " << evicted_ids.size() << " rows of the table, "
+          << spill_->Size() << " rows are in the spill file";
+
+  {
+    AutoWRLock rows_guard(&index_state_->rows_lock);
+    for (size_t i = 0; i < missing.size(); ++i) {
+      rows_[slots[i]] = missing[i];
+    }
+  }
+  std::vector<int64_t> spilled_ids;
+  std::vector<char*> spilled_rows;
+  for (size_t i = 0; i < missing.size(); ++i) {
+    int64_t slot = slots[i];
+    id_to_index_->Insert(missing[i], slot);
+    TouchRow(slot, now);
+    if (spill_->Has(missing[i])) {
+      spilled_ids.push_back(missing[i]);
+      spilled_rows.push_back(data + slot * row_bytes);
+    } else if (i >= slots.size() - num_evicted) {
+      std::memset(data + slot * row_bytes, 0, row_bytes);
+    }
+  }
+  spill_->Take(spilled_ids, spilled_rows);
+}
+
+void SelectedRows::EnableDirtyRows() {
+  PADDLE_ENFORCE(dirty_ == nullptr, "The table already tracks the dirty rows");
+  PADDLE_ENFORCE(value_->IsInitialized() && value_->dims()[0] > 0,
+                 "The value of the table should be initialized.");
+  PADDLE_ENFORCE(platform::is_cpu_place(value_->place()),
+                 "Only the tables on CPU track the dirty rows.");
+  dirty_.reset(new DirtyRows);
+}
+
+void SelectedRows::MarkDirty(const int64_t* ids, int64_t num) {
+  if (dirty_ == nullptr) {
+    return;
+  }
+  // Each lock is taken once for the ids of its shard.
+  std::vector<int64_t> shards[DirtyRows::kShards];
+  for (int64_t i = 0; i < num; ++i) {
+    shards[static_cast<uint64_t>(ids[i]) % DirtyRows::kShards].push_back(
+        ids[i]);
+  }
+  for (size_t shard = 0; shard < DirtyRows::kShards; ++shard) {
+    if (shards[shard].empty()) continue;
+    std::lock_guard<std::mutex> guard(dirty_->mutexes[shard]);
+    dirty_->updated[shard].insert(shards[shard].begin(), shards[shard].end());
+  }
+}
+
+std::vector<int64_t> SelectedRows::CopyRows(const std::vector<int64_t>& ids,
+                                            SelectedRows* out) const {
+  int64_t width = value_->numel() / value_->dims()[0];
+  size_t row_bytes = width * SizeOfType(value_->type());
+  std::vector<int64_t> copied_ids;
+  std::vector<int64_t> indices;
+  std::vector<int64_t> missing;
+  for (auto id : ids) {
+    int64_t index = id_to_index_->Find(id);
+    if (index >= 0) {
+      copied_ids.push_back(id);
+      indices.push_back(index);
     } else {
-      auto index = write_iter->second;
-      rwlock_->UNLock();
-      return index;
+      missing.push_back(id);
     }
-  } else {
-    auto index = iter->second;
-    rwlock_->UNLock();
-    return index;
   }
+
+  auto* value = out->mutable_value();
+  value->Resize({static_cast<int64_t>(indices.size()), width});
+  char* dst = reinterpret_cast<char*>(
+      value->mutable_data(platform::CPUPlace(), value_->type()));
+  const char* src = reinterpret_cast<const char*>(value_->data<void>());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    std::memcpy(dst + i * row_bytes, src + indices[i] * row_bytes, row_bytes);
+  }
+  out->set_rows(Vector<int64_t>(copied_ids));
+  out->set_height(height_);
+  return missing;
 }
 
-void SelectedRows::SyncIndex() {
-  rwlock_->WRLock();
-  id_to_index_.clear();
-  for (size_t i = 0; i < rows_.size(); ++i) {
-    id_to_index_[rows_[i]] = i;
+void SelectedRows::SnapshotDirtyRows(SelectedRows* updated,
+                                     std::vector<int64_t>* removed) {
+  PADDLE_ENFORCE_NOT_NULL(dirty_, "The table does not track the dirty rows");
+  std::vector<int64_t> ids;
+  for (size_t shard = 0; shard < DirtyRows::kShards; ++shard) {
+    std::lock_guard<std::mutex> guard(dirty_->mutexes[shard]);
+    ids.insert(ids.end(), dirty_->updated[shard].begin(),
+               dirty_->updated[shard].end());
+    dirty_->updated[shard].clear();
+  }
+  std::sort(ids.begin(), ids.end());
+
+  // Keeps the rows from being spilled or removed while they are copied.
+  std::unique_ptr<AutoRDLock> tier_guard;
+  if (tier_lock_ != nullptr) {
+    tier_guard.reset(new AutoRDLock(tier_lock_.get()));
+  }
+  {
+    std::lock_guard<std::mutex> index_guard(index_state_->mutex);
+    UpdateIndex();
+    removed->assign(dirty_->removed.begin(), dirty_->removed.end());
+    dirty_->removed.clear();
+  }
+  std::sort(removed->begin(), removed->end());
+  auto missing = CopyRows(ids, updated);
+
+  // The spilled rows are copied by a snapshot after they are read back.
+  std::vector<int64_t> spilled;
+  for (auto id : missing) {
+    if (spill_ != nullptr && spill_->Has(id)) {
+      spilled.push_back(id);
+    }
+  }
+  MarkDirty(spilled.data(), static_cast<int64_t>(spilled.size()));
+}
+
+void SelectedRows::Snapshot(SelectedRows* table) {
+  if (dirty_ != nullptr) {
+    for (size_t shard = 0; shard < DirtyRows::kShards; ++shard) {
+      std::lock_guard<std::mutex> guard(dirty_->mutexes[shard]);
+      dirty_->updated[shard].clear();
+    }
+  }
+
+  std::unique_ptr<AutoRDLock> tier_guard;
+  if (tier_lock_ != nullptr) {
+    tier_guard.reset(new AutoRDLock(tier_lock_.get()));
+  }
+  std::vector<int64_t> ids;
+  {
+    std::lock_guard<std::mutex> index_guard(index_state_->mutex);
+    UpdateIndex();
+    if (dirty_ != nullptr) {
+      dirty_->removed.clear();
+    }
+    const auto& rows = rows_;
+    ids.reserve(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+      ids.push_back(rows[i]);
+    }
   }
-  rwlock_->UNLock();
+  CopyRows(ids, table);
 }
 
 void SelectedRows::Get(const framework::Tensor& ids, framework::Tensor* value,
                        bool auto_grown, bool is_test) {
   PADDLE_ENFORCE(value->IsInitialized(),
                  "The value tensor should be initialized.");
+  // Keeps the rows of ids in value_ if the table spills.
+  auto pin = PinRows(ids.data<int64_t>(), ids.numel(), auto_grown, is_test);
   if (ids.numel() == 0) {
     VLOG(3) << "keys is empty, please check data!";
   } else {
@@ -15,13 +15,18 @@ limitations under the License. */
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <mutex>  // NOLINT
-#include <unordered_map>
+#include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "paddle/fluid/framework/concurrent_id_index.h"
+#include "paddle/fluid/framework/count_min_sketch.h"
 #include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/row_spill_file.h"
 #include "paddle/fluid/framework/rw_lock.h"
 #include "paddle/fluid/framework/tensor.h"
 #include "paddle/fluid/memory/memcpy.h"
@@ -49,13 +54,15 @@ class SelectedRows {
   SelectedRows(const std::vector<int64_t>& rows, const int64_t& height)
       : rows_(rows), height_(height) {
     value_.reset(new Tensor());
-    rwlock_.reset(new RWLock);
+    id_to_index_.reset(new ConcurrentIdIndex);
+    index_state_.reset(new IndexState);
   }
 
   SelectedRows() {
     height_ = 0;
     value_.reset(new Tensor());
-    rwlock_.reset(new RWLock);
+    id_to_index_.reset(new ConcurrentIdIndex);
+    index_state_.reset(new IndexState);
   }
 
   platform::Place place() const { return value_->place(); }
@@ -70,22 +77,26 @@ class SelectedRows {
 
   const Vector<int64_t>& rows() const { return rows_; }
 
+  /*
+   * @brief The rows may be changed through the returned pointer at any time,
+   * which Index() and HasKey() see by checking the index of the keys against
+   * the rows.
+   */
   Vector<int64_t>* mutable_rows() { return &rows_; }
 
-  void set_rows(const Vector<int64_t>& rows) { rows_ = rows; }
+  void set_rows(const Vector<int64_t>& rows) {
+    index_state_->dirty.store(true, std::memory_order_release);
+    rows_ = rows;
+  }
 
   /*
-   * @brief Get the index of key in rows
+   * @brief Get the index of key in rows, the first one if rows has duplicate
+   * members. If the duplicates are made in place through mutable_rows()
+   * after a lookup, it is one of them.
    *
-   * @return -1 if the key does not exists.
+   * @return the index of the key, throw if the key does not exists.
    */
-  int64_t Index(int64_t key) const {
-    auto it = std::find(rows_.begin(), rows_.end(), key);
-    if (it == rows_.end()) {
-      PADDLE_THROW("id %s not in table", key);
-    }
-    return static_cast<int64_t>(std::distance(rows_.begin(), it));
-  }
+  int64_t Index(int64_t key) const;
 
   /*
    * @brief whether has the specified key in the table.
@@ -123,15 +134,96 @@ class SelectedRows {
    * @brief Get the index of the key from id_to_index_ map.
    */
   inline int64_t GetIndexFromId(int64_t key) {
-    auto iter = id_to_index_.find(key);
-    if (iter == id_to_index_.end()) {
-      return -1;
-    } else {
-      return iter->second;
-    }
+    return id_to_index_->Find(key);
   }
 
   void SyncIndex();
+
+  /*
+   * @brief Turn the table into a cache of the rows in value(), whose least
+   * recently used rows are written to the file at path when a row is looked
+   * up in a full table, and read back the next time they are looked up. The
+   * rows new to the table start from zero once the table is full.
+   *
+   * Note!!! this interface is only used when selected_rows is used as
+   * parameters for distribute lookup table, where it should be called before
+   * the table is shared by threads. The rows in the file are not saved.
+   */
+  void EnableSpill(const std::string& path);
+
+  bool HasSpill() const { return spill_ != nullptr; }
+
+  /*
+   * @brief Manage the lifecycle of the rows. A new id is admitted to the
+   * table after it is looked up admit_count times, as estimated by a
+   * Count-Min sketch, and is looked up as zeros before. Every shrink_seconds
+   * the rows not accessed in max_idle_seconds, or accessed fewer than
+   * min_accesses times since the last shrink, are removed by Shrink. The
+   * lookups and the updates are the accesses, and a zero turns the policy
+   * off. The new ids of a full table are looked up as zeros until a shrink
+   * makes room for them, unless the table spills.
+   *
+   * Note!!! this interface is only used when selected_rows is used as
+   * parameters for distribute lookup table, where it should be called before
+   * the table is shared by threads.
+   */
+  void EnableLifecycle(int64_t admit_count, int64_t max_idle_seconds,
+                       int64_t min_accesses, int64_t shrink_seconds);
+
+  bool HasLifecycle() const { return lifecycle_ != nullptr; }
+
+  /*
+   * @brief Remove the rows not accessed in max_idle_seconds, or accessed
+   * fewer than min_accesses times since the last shrink, and pack the rest to
+   * the front of value(), whose freed rows are zeroed. The spilled rows are
+   * kept. It waits for the pinned rows to be released.
+   *
+   * @return the number of the removed rows.
+   */
+  size_t Shrink(int64_t max_idle_seconds, int64_t min_accesses);
+
+  /*
+   * @brief Make the rows of ids resident in value(), reading back the spilled
+   * ones and adding the admitted new ones if auto_grown and not is_test, and
+   * keep them from being spilled or removed until the returned lock is
+   * released. The misses of ids are read back together.
+   *
+   * @return nullptr if the table neither spills nor manages the lifecycle.
+   */
+  std::unique_ptr<AutoRDLock> PinRows(const int64_t* ids, int64_t num,
+                                      bool auto_grown, bool is_test = false);
+
+  /*
+   * @brief Track the ids of the rows updated or removed since the last
+   * snapshot, for the incremental checkpoints. The updates of the table mark
+   * their rows by MarkDirty.
+   *
+   * Note!!! this interface is only used when selected_rows is used as
+   * parameters for distribute lookup table, where it should be called before
+   * the table is shared by threads.
+   */
+  void EnableDirtyRows();
+
+  bool HasDirtyRows() const { return dirty_ != nullptr; }
+
+  /*
+   * @brief Mark the rows of ids updated, if the table tracks the dirty rows.
+   */
+  void MarkDirty(const int64_t* ids, int64_t num);
+
+  /*
+   * @brief Copy the rows updated since the last snapshot to updated, and the
+   * ids removed since then to removed, and track the dirty rows from now on.
+   * The spilled rows are not copied and stay dirty.
+   */
+  void SnapshotDirtyRows(SelectedRows* updated, std::vector<int64_t>* removed);
+
+  /*
+   * @brief Copy the rows resident in value() to table, and track the dirty
+   * rows from now on.
+   */
+  void Snapshot(SelectedRows* table);
+
   /*
    * @brief Get complete Dims before
    */
@@ -142,15 +234,97 @@ class SelectedRows {
   }
 
  private:
+  // Add the members of rows_ that are not in id_to_index_ yet, or rebuild
+  // id_to_index_ if rows_ may have been changed other than appending. It is
+  // called with index_state_->mutex held.
+  void UpdateIndex() const;
+
+  // The index of key in rows_, or -1. The index is checked against rows_,
+  // so that the edits through mutable_rows() are seen.
+  int64_t FindIndex(int64_t key) const;
+
+  struct Lifecycle {
+    int64_t admit_count;
+    int64_t max_idle_seconds;
+    int64_t min_accesses;
+    int64_t shrink_seconds;
+    // nullptr if every id is admitted.
+    std::unique_ptr<CountMinSketch> sketch;
+    // The seconds of the last access and the accesses since the last shrink
+    // of the rows of value_.
+    std::unique_ptr<std::atomic<int64_t>[]> last_access;
+    std::unique_ptr<std::atomic<uint32_t>[]> accesses;
+    std::atomic<int64_t> next_shrink{0};
+  };
+
+  // The ids of the dirty rows, sharded to take the locks of the concurrent
+  // updates apart.
+  struct DirtyRows {
+    static constexpr size_t kShards = 16;
+    std::mutex mutexes[kShards];
+    std::unordered_set<int64_t> updated[kShards];
+    // Guarded by index_state_->mutex.
+    std::unordered_set<int64_t> removed;
+  };
+
+  // Copy the resident rows of ids to out, and return the others.
+  std::vector<int64_t> CopyRows(const std::vector<int64_t>& ids,
+                                SelectedRows* out) const;
+
+  // Make room for the missing rows of ids and read back the spilled ones,
+  // with the write lock of tier_lock_ held.
+  void LoadRows(const int64_t* ids, int64_t num, bool auto_grown, bool is_test,
+                int64_t now);
+
+  // Whether the new id is admitted, counting the lookup if count.
+  bool Admit(int64_t id, bool count);
+
+  // Record an access of the row at index of value_.
+  void TouchRow(int64_t index, int64_t now) {
+    if (referenced_ != nullptr) {
+      referenced_[index].store(1, std::memory_order_relaxed);
+    }
+    if (lifecycle_ != nullptr) {
+      lifecycle_->last_access[index].store(now, std::memory_order_relaxed);
+      lifecycle_->accesses[index].fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
   // Notice: rows can be duplicate. We can have {0, 4, 7, 0, 5, 7, 9} here.
   // SelectedRows are simply concated when adding together. Until a
   // SelectedRows add a Tensor, will the duplicate rows be handled.
   Vector<int64_t> rows_;
-  std::unordered_map<int64_t, int64_t>
-      id_to_index_;  // should not be used when rows_ has duplicate member
+  // Should not be used by AutoGrownIndex when rows_ has duplicate member,
+  // otherwise the first one of the duplicated members is indexed.
+  std::unique_ptr<ConcurrentIdIndex> id_to_index_{nullptr};
   std::unique_ptr<Tensor> value_{nullptr};
   int64_t height_;  // height indicates the underline tensor's height
-  std::unique_ptr<RWLock> rwlock_{nullptr};
+  // The state of id_to_index_, which the lookups read without the mutex.
+  struct IndexState {
+    // Guards the appending of rows_ and the updates of id_to_index_.
+    std::mutex mutex;
+    // Held for read by the lookups which check rows_ without the mutex, and
+    // for write by the changes of rows_ under the mutex. It is never held
+    // with a lock of id_to_index_ by the lookups, so it nests inside them.
+    RWLock rows_lock;
+    // The number of the leading members of rows_ that are in id_to_index_.
+    std::atomic<size_t> num_indexed_rows{0};
+    // Whether rows_ may have been changed other than appending.
+    std::atomic<bool> dirty{false};
+  };
+  std::unique_ptr<IndexState> index_state_{nullptr};
+  // The rows spilled from value_, see EnableSpill.
+  std::unique_ptr<RowSpillFile> spill_{nullptr};
+  // Held for read by the lookups and the updates of the resident rows, and
+  // for write by moving the rows between value_ and spill_ or by Shrink.
+  std::unique_ptr<RWLock> tier_lock_{nullptr};
+  // The reference bits of the rows of value_ for the CLOCK replacement.
+  std::unique_ptr<std::atomic<uint8_t>[]> referenced_{nullptr};
+  int64_t clock_hand_{0};
+  // The admission and the eviction of the rows, see EnableLifecycle.
+  std::unique_ptr<Lifecycle> lifecycle_{nullptr};
+  // The rows changed since the last snapshot, see EnableDirtyRows.
+  std::unique_ptr<DirtyRows> dirty_{nullptr};
 };
 
 /*
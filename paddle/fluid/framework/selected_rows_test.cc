@@ -12,6 +12,11 @@ limitations under the License. */
 #include <time.h>
 #include <thread>  // NOLINT
 
+#include <atomic>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "paddle/fluid/framework/selected_rows.h"
 
@@ -198,5 +203,181 @@ TEST(SelectedRows, MultiThreadAutoIndex) {
   t4.join();
 }
 
+// The lookups of the grown keys go on while rows_ is appended to, and may
+// reallocate.
+TEST(SelectedRows, IndexWhileGrowing) {
+  platform::CPUPlace cpu;
+  SelectedRows table;
+  int64_t table_size = 20000;
+  table.mutable_value()->Resize(framework::make_ddim({table_size, 1}));
+  table.mutable_value()->mutable_data<float>(cpu);
+
+  std::atomic<int64_t> num_grown{0};
+  std::thread grow([&]() {
+    for (int64_t i = 0; i < table_size; ++i) {
+      ASSERT_EQ(table.AutoGrownIndex(i, true), i);
+      num_grown.store(i + 1);
+    }
+  });
+  std::vector<std::thread> lookups;
+  for (int t = 0; t < 4; ++t) {
+    lookups.emplace_back([&, t]() {
+      for (int64_t n = 0; n < table_size;) {
+        n = num_grown.load();
+        for (int64_t i = t; i < n; i += 97) {
+          ASSERT_EQ(table.Index(i), i);
+        }
+      }
+    });
+  }
+  grow.join();
+  for (auto& t : lookups) {
+    t.join();
+  }
+}
+
+// The edits of the rows through a held mutable_rows() after the lookups are
+// seen by the next lookups.
+TEST(SelectedRows, EditRowsAfterLookup) {
+  SelectedRows table({0, 4, 7}, 10);
+  ASSERT_EQ(table.Index(4), 1);
+  ASSERT_TRUE(table.HasKey(7));
+  ASSERT_FALSE(table.HasKey(5));
+
+  auto* rows = table.mutable_rows();
+  (*rows)[1] = 5;
+  EXPECT_FALSE(table.HasKey(4));
+  EXPECT_THROW(table.Index(4), platform::EnforceNotMet);
+  EXPECT_EQ(table.Index(5), 1);
+
+  (*rows)[0] = 7;
+  (*rows)[2] = 0;
+  EXPECT_EQ(table.Index(7), 0);
+  EXPECT_EQ(table.Index(0), 2);
+
+  rows->push_back(9);
+  EXPECT_EQ(table.Index(9), 3);
+  rows->resize(2);
+  EXPECT_FALSE(table.HasKey(9));
+  EXPECT_FALSE(table.HasKey(0));
+  EXPECT_EQ(table.Index(5), 1);
+
+  // The first one of the duplicates set as a whole.
+  table.set_rows(Vector<int64_t>(std::vector<int64_t>{3, 6, 3}));
+  EXPECT_EQ(table.Index(3), 0);
+  EXPECT_EQ(table.Index(6), 1);
+}
+
+// Look up the rows of ids, which should be id + 1.
+void CheckSpilledRows(SelectedRows* table, const std::vector<int64_t>& ids,
+                      int64_t width) {
+  platform::CPUPlace cpu;
+  framework::Tensor ids_t;
+  std::copy(ids.begin(), ids.end(),
+            ids_t.mutable_data<int64_t>(
+                make_ddim({static_cast<int64_t>(ids.size())}), cpu));
+  framework::Tensor value;
+  auto* data = value.mutable_data<float>(
+      make_ddim({static_cast<int64_t>(ids.size()), width}), cpu);
+  table->Get(ids_t, &value, true);
+  for (size_t i = 0; i < ids.size(); ++i) {
+    for (int64_t j = 0; j < width; ++j) {
+      ASSERT_EQ(data[i * width + j], static_cast<float>(ids[i] + 1));
+    }
+  }
+}
+
+TEST(SelectedRows, SpillTable) {
+  platform::CPUPlace cpu;
+  SelectedRows table;
+  int64_t capacity = 4;
+  int64_t width = 3;
+  int64_t num_ids = 16;
+  table.mutable_value()->mutable_data<float>(make_ddim({capacity, width}),
+                                             cpu);
+  table.EnableSpill("selected_rows_test.spill");
+  ASSERT_TRUE(table.HasSpill());
+
+  for (int64_t id = 0; id < num_ids; ++id) {
+    auto pin = table.PinRows(&id, 1, true);
+    ASSERT_TRUE(pin != nullptr);
+    float* row = table.mutable_value()->data<float>() + table.Index(id) * width;
+    if (id >= capacity) {
+      // The new rows of a full table start from zero.
+      ASSERT_EQ(row[0], 0.f);
+    }
+    std::fill(row, row + width, static_cast<float>(id + 1));
+  }
+  // Only the recently used rows are in the table.
+  ASSERT_EQ(table.rows().size(), static_cast<size_t>(capacity));
+  ASSERT_TRUE(table.HasKey(num_ids - 1));
+  ASSERT_FALSE(table.HasKey(0));
+
+  CheckSpilledRows(&table, {0, 5, 0, 9}, width);
+  ASSERT_TRUE(table.HasKey(0));
+  // The missing rows of a lookup are read back together.
+  CheckSpilledRows(&table, {1, 2, 3, 4}, width);
+
+  // The rows pinned by a lookup are not spilled by the others.
+  auto lookup = [&](int64_t seed) {
+    std::mt19937 rng(seed);
+    for (int i = 0; i < 2000; ++i) {
+      CheckSpilledRows(&table, {static_cast<int64_t>(rng() % num_ids)},
+                       width);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int64_t i = 0; i < 3; ++i) {
+    threads.emplace_back(lookup, i);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_EQ(table.rows().size(), static_cast<size_t>(capacity));
+}
+
+TEST(SelectedRows, Lifecycle) {
+  platform::CPUPlace cpu;
+  SelectedRows table;
+  int64_t capacity = 8;
+  int64_t width = 2;
+  auto* data = table.mutable_value()->mutable_data<float>(
+      make_ddim({capacity, width}), cpu);
+  std::fill(data, data + capacity * width, 1.f);
+  table.EnableLifecycle(3, 0, 2, 0);
+  ASSERT_TRUE(table.HasLifecycle());
+
+  framework::Tensor ids;
+  auto* ids_data = ids.mutable_data<int64_t>(make_ddim({2}), cpu);
+  ids_data[0] = 5;
+  ids_data[1] = 6;
+  framework::Tensor value;
+  auto* value_data = value.mutable_data<float>(make_ddim({2, width}), cpu);
+  // The ids are admitted at the third lookup, and looked up as zeros before.
+  for (int i = 0; i < 2; ++i) {
+    table.Get(ids, &value, true);
+    ASSERT_EQ(value_data[0], 0.f);
+    ASSERT_FALSE(table.HasKey(5));
+  }
+  table.Get(ids, &value, true);
+  ASSERT_EQ(value_data[0], 1.f);
+  ASSERT_EQ(table.rows().size(), 2UL);
+
+  ids.Resize(make_ddim({1}));
+  value.Resize(make_ddim({1, width}));
+  ids_data[0] = 6;
+  table.Get(ids, &value, true);
+  // 5 is accessed once since the admission and removed, 6 is packed to the
+  // front.
+  ASSERT_EQ(table.Shrink(0, 2), 1UL);
+  ASSERT_EQ(table.rows().size(), 1UL);
+  ASSERT_EQ(table.Index(6), 0);
+  ASSERT_FALSE(table.HasKey(5));
+  ASSERT_EQ(data[width], 0.f);
+  // The accesses are counted again after a shrink.
+  ASSERT_EQ(table.Shrink(0, 1), 1UL);
+  ASSERT_EQ(table.rows().size(), 0UL);
+}
+
 }  // namespace framework
 }  // namespace paddle
@@ -0,0 +1,267 @@
+//   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/sparse_table_checkpoint.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <unordered_set>
+
+#include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/port.h"
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+size_t RowBytes(const Tensor& value) {
+  auto dims = vectorize(value.dims());
+  int64_t width = 1;
+  for (size_t i = 1; i < dims.size(); ++i) {
+    width *= dims[i];
+  }
+  return width * SizeOfType(value.type());
+}
+
+// Write to a temporary file renamed to path at last, so that a failure never
+// leaves a partial file at path.
+void WriteFile(const std::string& path,
+               const std::function<void(std::ostream&)>& write) {
+  MkDirRecursively(DirName(path).c_str());
+  std::string tmp_path = path + ".tmp";
+  {
+    std::ofstream fout(tmp_path, std::ios::binary);
+    PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot open %s to write",
+                   tmp_path);
+    write(fout);
+    fout.close();
+    PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot write %s", tmp_path);
+  }
+  PADDLE_ENFORCE_EQ(std::rename(tmp_path.c_str(), path.c_str()), 0,
+                    "Cannot rename %s to %s", tmp_path, path);
+}
+
+// Write the rows in the format of SerializeToStream(SelectedRows), with the
+// value padded by zero rows to the capacity of the table, so that the base
+// is loaded as the whole table by the load op.
+void WriteBase(std::ostream& os, const SelectedRows& rows, int64_t capacity) {
+  auto& value = rows.value();
+  PADDLE_ENFORCE_LE(value.dims()[0], capacity);
+  {  // the version of SelectedRows
+    constexpr uint32_t version = 0;
+    os.write(reinterpret_cast<const char*>(&version), sizeof(version));
+  }
+  {
+    uint64_t size = rows.rows().size();
+    os.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    for (uint64_t i = 0; i < size; ++i) {
+      int64_t id = rows.rows()[i];
+      os.write(reinterpret_cast<const char*>(&id), sizeof(id));
+    }
+  }
+  {
+    int64_t height = rows.height();
+    os.write(reinterpret_cast<const char*>(&height), sizeof(height));
+  }
+  {  // the version and the description of the value, see TensorToStream
+    constexpr uint32_t version = 0;
+    os.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    proto::VarType::TensorDesc desc;
+    desc.set_data_type(value.type());
+    auto dims = vectorize(value.dims());
+    dims[0] = capacity;
+    auto* pb_dims = desc.mutable_dims();
+    pb_dims->Resize(static_cast<int>(dims.size()), 0);
+    std::copy(dims.begin(), dims.end(), pb_dims->begin());
+    int32_t size = desc.ByteSize();
+    os.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    auto out = desc.SerializeAsString();
+    os.write(out.data(), size);
+  }
+  size_t row_bytes = RowBytes(value);
+  if (value.numel() > 0) {
+    os.write(reinterpret_cast<const char*>(value.data<void>()),
+             value.dims()[0] * row_bytes);
+  }
+  size_t padding = (capacity - value.dims()[0]) * row_bytes;
+  std::vector<char> zeros(std::min<size_t>(padding, 1 << 20), 0);
+  for (size_t done = 0; done < padding; done += zeros.size()) {
+    os.write(zeros.data(), std::min(zeros.size(), padding - done));
+  }
+}
+
+// A delta is the version, the updated rows and the removed ids.
+void WriteDelta(std::ostream& os, const SelectedRows& updated,
+                const std::vector<int64_t>& removed) {
+  constexpr uint32_t version = 0;
+  os.write(reinterpret_cast<const char*>(&version), sizeof(version));
+  platform::CPUDeviceContext dev_ctx;
+  SerializeToStream(os, updated, dev_ctx);
+  uint64_t size = removed.size();
+  os.write(reinterpret_cast<const char*>(&size), sizeof(size));
+  os.write(reinterpret_cast<const char*>(removed.data()),
+           size * sizeof(int64_t));
+}
+
+void MergeDelta(std::istream& is, SelectedRows* table) {
+  uint32_t version;
+  is.read(reinterpret_cast<char*>(&version), sizeof(version));
+  PADDLE_ENFORCE_EQ(version, 0U, "Only version 0 is supported");
+  SelectedRows updated;
+  platform::CPUDeviceContext dev_ctx;
+  DeserializeFromStream(is, &updated, dev_ctx);
+  uint64_t size;
+  is.read(reinterpret_cast<char*>(&size), sizeof(size));
+  std::vector<int64_t> removed(size);
+  is.read(reinterpret_cast<char*>(removed.data()), size * sizeof(int64_t));
+  PADDLE_ENFORCE(static_cast<bool>(is), "The delta is truncated");
+
+  auto* value = table->mutable_value();
+  size_t row_bytes = RowBytes(*value);
+  char* data = reinterpret_cast<char*>(value->data<void>());
+  if (!removed.empty()) {
+    std::unordered_set<int64_t> removed_set(removed.begin(), removed.end());
+    auto* rows = table->mutable_rows();
+    size_t kept = 0;
+    for (size_t i = 0; i < rows->size(); ++i) {
+      if (removed_set.count((*rows)[i])) continue;
+      if (kept != i) {
+        std::memcpy(data + kept * row_bytes, data + i * row_bytes, row_bytes);
+        (*rows)[kept] = (*rows)[i];
+      }
+      ++kept;
+    }
+    std::memset(data + kept * row_bytes, 0, (rows->size() - kept) * row_bytes);
+    rows->resize(kept);
+  }
+  table->SyncIndex();
+
+  PADDLE_ENFORCE_EQ(RowBytes(updated.value()), row_bytes,
+                    "The rows of the delta do not match the table");
+  auto* src = reinterpret_cast<const char*>(updated.value().data<void>());
+  for (size_t i = 0; i < updated.rows().size(); ++i) {
+    int64_t index = table->AutoGrownIndex(updated.rows()[i], true);
+    PADDLE_ENFORCE_GE(index, 0, "Cannot add id %d to the table",
+                      updated.rows()[i]);
+    std::memcpy(data + index * row_bytes, src + i * row_bytes, row_bytes);
+  }
+}
+
+}  // namespace
+
+SparseTableCheckpoint::SparseTableCheckpoint(SelectedRows* table,
+                                             int full_interval)
+    : table_(table), full_interval_(std::max(full_interval, 1)) {
+  PADDLE_ENFORCE_NOT_NULL(table_);
+  if (!table_->HasDirtyRows()) {
+    table_->EnableDirtyRows();
+  }
+}
+
+SparseTableCheckpoint::~SparseTableCheckpoint() {
+  try {
+    Wait();
+  } catch (std::exception& e) {
+    LOG(WARNING) << "the last checkpoint of the sparse table failed: "
+                 << e.what();
+  }
+}
+
+void SparseTableCheckpoint::Wait() {
+  if (!writing_.valid()) {
+    return;
+  }
+  auto error = writing_.get();
+  if (error) {
+    // The chain is broken, the next checkpoint starts a new one.
+    chain_.clear();
+    throw *error;
+  }
+}
+
+void SparseTableCheckpoint::Save(const std::string& path) {
+  Wait();
+  auto* pool = ThreadPoolIO::GetInstanceIO();
+  int64_t capacity = table_->value().dims()[0];
+  if (chain_.empty() || static_cast<int>(chain_.size()) >= full_interval_) {
+    std::shared_ptr<SelectedRows> base(new SelectedRows);
+    table_->Snapshot(base.get());
+    chain_ = {path};
+    VLOG(3) << "checkpoint " << base->rows().size() << " rows of the table to "
+            << path;
+    writing_ = pool->RunAndGetException([base, path, capacity] {
+      WriteFile(path,
+                [&](std::ostream& os) { WriteBase(os, *base, capacity); });
+      // A stale chain at path would be loaded instead of the base.
+      std::remove((path + ".chain").c_str());
+    });
+  } else {
+    std::shared_ptr<SelectedRows> updated(new SelectedRows);
+    std::shared_ptr<std::vector<int64_t>> removed(new std::vector<int64_t>);
+    table_->SnapshotDirtyRows(updated.get(), removed.get());
+    chain_.push_back(path + ".delta");
+    VLOG(3) << "checkpoint " << updated->rows().size() << " updated rows and "
+            << removed->size() << " removed rows of the table to "
+            << chain_.back();
+    auto chain = chain_;
+    writing_ = pool->RunAndGetException([updated, removed, path, chain] {
+      WriteFile(chain.back(), [&](std::ostream& os) {
+        WriteDelta(os, *updated, *removed);
+      });
+      WriteFile(path + ".chain", [&](std::ostream& os) {
+        for (auto& file : chain) {
+          os << file << "\n";
+        }
+      });
+    });
+  }
+}
+
+void SparseTableCheckpoint::Load(const std::string& path,
+                                 SelectedRows* table) {
+  std::vector<std::string> chain;
+  std::ifstream chain_in(path + ".chain");
+  for (std::string file; std::getline(chain_in, file);) {
+    if (!file.empty()) chain.push_back(file);
+  }
+  if (chain.empty()) {
+    chain.push_back(path);
+  }
+
+  {
+    std::ifstream fin(chain[0], std::ios::binary);
+    PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot open file %s", chain[0]);
+    platform::CPUDeviceContext dev_ctx;
+    DeserializeFromStream(fin, table, dev_ctx);
+  }
+  table->SyncIndex();
+  for (size_t i = 1; i < chain.size(); ++i) {
+    std::ifstream fin(chain[i], std::ios::binary);
+    PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot open file %s", chain[i]);
+    MergeDelta(fin, table);
+  }
+  VLOG(3) << "load " << table->rows().size() << " rows of the table from "
+          << chain.size() << " files of " << path;
+}
+
+}  // namespace framework
+}  // namespace paddle
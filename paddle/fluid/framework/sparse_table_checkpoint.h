@@ -0,0 +1,78 @@
+//   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <future>  // NOLINT
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * @brief The asynchronous incremental checkpoints of a sparse table.
+ *
+ *  Every full_interval-th checkpoint is a full base of the table, and the
+ *  ones between are the deltas of the rows updated or removed since the
+ *  checkpoint before. A checkpoint copies the rows to save and returns,
+ *  while the files are written on the IO thread pool, one checkpoint after
+ *  another.
+ *
+ *  The checkpoint to path writes a base to path, in the format of the save
+ *  op, or a delta to path.delta and the list of the files to restore the
+ *  table from, the base and the deltas after it, to path.chain. Load
+ *  restores the table from either of them.
+ */
+class SparseTableCheckpoint {
+ public:
+  SparseTableCheckpoint(SelectedRows* table, int full_interval);
+  ~SparseTableCheckpoint();
+
+  SparseTableCheckpoint(const SparseTableCheckpoint& other) = delete;
+  SparseTableCheckpoint& operator=(const SparseTableCheckpoint& other) =
+      delete;
+
+  /*
+   * @brief Checkpoint the table to path. It waits for the files of the last
+   * checkpoint to be written, and throws if they failed, when the next
+   * checkpoint is a full one.
+   */
+  void Save(const std::string& path);
+
+  /*
+   * @brief Wait for the files of the last checkpoint to be written.
+   */
+  void Wait();
+
+  /*
+   * @brief Load the table from the checkpoint saved to path, merging the
+   * deltas into the base if it is incremental.
+   */
+  static void Load(const std::string& path, SelectedRows* table);
+
+ private:
+  SelectedRows* table_;
+  int full_interval_;
+  // The files of the last checkpoint, the base first.
+  std::vector<std::string> chain_;
+  std::future<std::unique_ptr<platform::EnforceNotMet>> writing_;
+};
+
+}  // namespace framework
+}  // namespace paddle
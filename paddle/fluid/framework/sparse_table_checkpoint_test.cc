@@ -0,0 +1,125 @@
+//   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/sparse_table_checkpoint.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+void Lookup(SelectedRows* table, const std::vector<int64_t>& ids) {
+  platform::CPUPlace cpu;
+  int64_t width = table->value().dims()[1];
+  Tensor ids_t;
+  auto* ids_data = ids_t.mutable_data<int64_t>(
+      make_ddim({static_cast<int64_t>(ids.size())}), cpu);
+  std::copy(ids.begin(), ids.end(), ids_data);
+  Tensor value;
+  value.mutable_data<float>(
+      make_ddim({static_cast<int64_t>(ids.size()), width}), cpu);
+  table->Get(ids_t, &value, true);
+}
+
+// Set the row of id to v and mark it dirty as an update.
+void Update(SelectedRows* table, int64_t id, float v) {
+  int64_t width = table->value().dims()[1];
+  auto* data = table->mutable_value()->data<float>();
+  int64_t index = table->Index(id);
+  ASSERT_GE(index, 0);
+  std::fill(data + index * width, data + (index + 1) * width, v);
+  table->MarkDirty(&id, 1);
+}
+
+float Row(const SelectedRows& table, int64_t id) {
+  int64_t index = table.Index(id);
+  EXPECT_GE(index, 0);
+  return table.value().data<float>()[index * table.value().dims()[1]];
+}
+
+bool Exists(const std::string& path) {
+  return static_cast<bool>(std::ifstream(path));
+}
+
+}  // namespace
+
+TEST(SparseTableCheckpoint, FullAndDelta) {
+  platform::CPUPlace cpu;
+  SelectedRows table;
+  int64_t capacity = 8;
+  int64_t width = 2;
+  auto* data = table.mutable_value()->mutable_data<float>(
+      make_ddim({capacity, width}), cpu);
+  std::fill(data, data + capacity * width, 0.f);
+  table.EnableLifecycle(0, 0, 0, 0);
+  std::string dir = "./sparse_table_checkpoint_test";
+
+  SparseTableCheckpoint checkpoint(&table, 3);
+  ASSERT_TRUE(table.HasDirtyRows());
+  Lookup(&table, {1, 2, 3});
+  for (int64_t id : {1, 2, 3}) {
+    Update(&table, id, static_cast<float>(id));
+  }
+  checkpoint.Save(dir + "/table0");
+
+  // The rows updated or added after the base are in the first delta.
+  Update(&table, 2, 20.f);
+  Lookup(&table, {4});
+  Update(&table, 4, 4.f);
+  checkpoint.Save(dir + "/table1");
+
+  // The ids removed by a shrink are in the second delta.
+  table.Shrink(0, 1);
+  Lookup(&table, {1, 2, 4});
+  ASSERT_EQ(table.Shrink(0, 1), 1UL);
+  ASSERT_FALSE(table.HasKey(3));
+  checkpoint.Save(dir + "/table2");
+  checkpoint.Wait();
+  ASSERT_FALSE(Exists(dir + "/table0.chain"));
+  ASSERT_TRUE(Exists(dir + "/table2.chain"));
+
+  // The base is loaded as a whole table.
+  SelectedRows base;
+  SparseTableCheckpoint::Load(dir + "/table0", &base);
+  ASSERT_EQ(base.value().dims()[0], capacity);
+  ASSERT_EQ(base.rows().size(), 3UL);
+  ASSERT_EQ(Row(base, 2), 2.f);
+
+  SelectedRows restored;
+  SparseTableCheckpoint::Load(dir + "/table2", &restored);
+  ASSERT_EQ(restored.value().dims()[0], capacity);
+  ASSERT_EQ(restored.rows().size(), 3UL);
+  ASSERT_FALSE(restored.HasKey(3));
+  ASSERT_EQ(Row(restored, 1), 1.f);
+  ASSERT_EQ(Row(restored, 2), 20.f);
+  ASSERT_EQ(Row(restored, 4), 4.f);
+
+  // The chain is full, the next checkpoint is a base.
+  Update(&table, 1, 10.f);
+  checkpoint.Save(dir + "/table3");
+  checkpoint.Wait();
+  ASSERT_FALSE(Exists(dir + "/table3.chain"));
+  SparseTableCheckpoint::Load(dir + "/table3", &restored);
+  ASSERT_EQ(restored.rows().size(), 3UL);
+  ASSERT_EQ(Row(restored, 1), 10.f);
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -18,6 +18,42 @@ limitations under the License. */
 namespace paddle {
 namespace framework {
 extern size_t SizeOfType(proto::VarType::Type type);
+
+static thread_local TensorCapacityPolicy* tls_capacity_policy = nullptr;
+
+size_t TensorCapacityPolicy::RoundUp(size_t size) {
+  constexpr size_t kMinCapacity = 256;
+  if (size <= kMinCapacity) return kMinCapacity;
+  // The step is a quarter of the largest power of 2 not above size.
+  size_t step = kMinCapacity / 4;
+  while (step * 8 <= size) step *= 2;
+  return (size + step - 1) / step * step;
+}
+
+void TensorCapacityPolicy::CountAllocation(size_t bytes, bool shrink) {
+  allocations_.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+  if (shrink) shrinks_.fetch_add(1, std::memory_order_relaxed);
+}
+
+TensorCapacityPolicy::Stats TensorCapacityPolicy::GetStats() const {
+  Stats stats;
+  stats.requests = requests_.load(std::memory_order_relaxed);
+  stats.allocations = allocations_.load(std::memory_order_relaxed);
+  stats.shrinks = shrinks_.load(std::memory_order_relaxed);
+  stats.allocated_bytes = allocated_bytes_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+ScopedTensorCapacityPolicy::ScopedTensorCapacityPolicy(
+    TensorCapacityPolicy* policy)
+    : prev_(tls_capacity_policy) {
+  tls_capacity_policy = policy;
+}
+
+ScopedTensorCapacityPolicy::~ScopedTensorCapacityPolicy() {
+  tls_capacity_policy = prev_;
+}
 void Tensor::check_memory_size() const {
   PADDLE_ENFORCE_NOT_NULL(
       holder_, "Tensor holds no memory. Call Tensor::mutable_data first.");
@@ -48,11 +84,35 @@ void* Tensor::mutable_data(platform::Place place, proto::VarType::Type type,
     size = requested_size;
   }
   /* some versions of boost::variant don't have operator!= */
-  if (holder_ == nullptr || !(holder_->place() == place) ||
-      holder_->size() < size + offset_) {
-    holder_ = memory::AllocShared(place, size, attr);
-    offset_ = 0;
+  bool reallocate = holder_ == nullptr || !(holder_->place() == place) ||
+                    holder_->size() < size + offset_;
+  auto* policy = tls_capacity_policy;
+  if (policy == nullptr) {
+    if (reallocate) {
+      holder_ = memory::AllocShared(place, size, attr);
+      offset_ = 0;
+    }
+  } else {
+    policy->CountRequest();
+    // Only the buffers owned by this tensor alone are shrunk.
+    bool shrink = false;
+    if (!reallocate && policy->shrink_after() > 0 && offset_ == 0 &&
+        holder_.use_count() == 1 && size < holder_->size() / 2) {
+      shrink = ++small_uses_ >= policy->shrink_after();
+    } else {
+      small_uses_ = 0;
+    }
+    if (reallocate || shrink) {
+      size_t capacity = TensorCapacityPolicy::RoundUp(size);
+      // Release the buffer first, so that it can be reused for the new one.
+      holder_.reset();
+      holder_ = memory::AllocShared(place, capacity, attr);
+      offset_ = 0;
+      small_uses_ = 0;
+      policy->CountAllocation(capacity, shrink);
+    }
   }
+  holder_->IncreaseVersion();
   return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(holder_->ptr()) +
                                  offset_);
 }
@@ -111,5 +171,15 @@ void Tensor::ResetHolder(std::shared_ptr<memory::Allocation> holder) {
   holder_ = holder;
 }
 
+void Tensor::ResetHolderWithType(std::shared_ptr<memory::Allocation> holder,
+                                 proto::VarType::Type type) {
+  PADDLE_ENFORCE_NOT_NULL(holder);
+  PADDLE_ENFORCE_GE(holder->size(), numel() * SizeOfType(type),
+                    "The holder is smaller than the tensor");
+  holder_ = holder;
+  type_ = type;
+  offset_ = 0;
+}
+
 }  // namespace framework
 }  // namespace paddle
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <memory>
@@ -33,6 +34,62 @@ namespace framework {
 
 class LoDTensor;
 
+/*! \brief The capacity policy of the buffers allocated by Tensor::mutable_data
+ *  on the threads of ScopedTensorCapacityPolicy.
+ *
+ *  Without a policy, mutable_data allocates the exact size, and reallocates
+ *  whenever a larger size is needed, so the tensors of the variable batch
+ *  sizes or sequence lengths are reallocated by most runs. With it, the
+ *  buffers are rounded up to 4 size classes per power of 2, wasting less
+ *  than a quarter, and the largest recent buffer is kept. A buffer which is
+ *  used for less than a half by shrink_after successive mutable_data calls
+ *  is reallocated to the size class of the last one, or never if it is 0.
+ *  The counters are shared by the threads of the policy. */
+class TensorCapacityPolicy {
+ public:
+  struct Stats {
+    int64_t requests{0};
+    int64_t allocations{0};
+    int64_t shrinks{0};
+    int64_t allocated_bytes{0};
+  };
+
+  explicit TensorCapacityPolicy(int shrink_after = 0)
+      : shrink_after_(shrink_after) {}
+
+  int shrink_after() const { return shrink_after_; }
+
+  /*! \brief The size class of size. */
+  static size_t RoundUp(size_t size);
+
+  void CountRequest() { requests_.fetch_add(1, std::memory_order_relaxed); }
+  void CountAllocation(size_t bytes, bool shrink);
+
+  /*! \brief The mutable_data calls, the allocations of them, the shrinks
+   *  among the allocations and the bytes allocated. */
+  Stats GetStats() const;
+
+ private:
+  int shrink_after_;
+  std::atomic<int64_t> requests_{0};
+  std::atomic<int64_t> allocations_{0};
+  std::atomic<int64_t> shrinks_{0};
+  std::atomic<int64_t> allocated_bytes_{0};
+};
+
+/*! \brief Sets the capacity policy of the current thread during the lifetime
+ *  of the object, nullptr for none. */
+class ScopedTensorCapacityPolicy {
+ public:
+  explicit ScopedTensorCapacityPolicy(TensorCapacityPolicy* policy);
+  ~ScopedTensorCapacityPolicy();
+
+ private:
+  DISABLE_COPY_AND_ASSIGN(ScopedTensorCapacityPolicy);
+
+  TensorCapacityPolicy* prev_;
+};
+
 class Tensor {
 #ifdef PADDLE_WITH_MKLDNN
 
@@ -166,6 +223,11 @@ class Tensor {
 
   void ResetHolder(std::shared_ptr<memory::Allocation> holder);
 
+  // Reset the holder and the data type together, used when the tensor
+  // aliases the memory that is not allocated by itself, e.g., a mapped file.
+  void ResetHolderWithType(std::shared_ptr<memory::Allocation> holder,
+                           proto::VarType::Type type);
+
  private:
   /*! holds the memory block if allocated. */
   std::shared_ptr<memory::Allocation> holder_;
@@ -201,6 +263,10 @@ class Tensor {
    *          PlaceHolder::ptr_ and where the tensor data really begins.
    */
   size_t offset_;
+
+  /*! The successive mutable_data calls using less than a half of holder_,
+   *  see TensorCapacityPolicy. */
+  int small_uses_ = 0;
 };
 
 }  // namespace framework
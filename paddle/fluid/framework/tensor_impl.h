@@ -39,6 +39,8 @@ inline T* Tensor::data() {
   bool valid =
       std::is_same<T, void>::value || type_ == DataTypeTrait<T>::DataType;
   PADDLE_ENFORCE(valid, "Tensor holds the wrong type, it holds %s", type_);
+  // The caller may write the memory.
+  holder_->IncreaseVersion();
   return reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(holder_->ptr()) +
                               offset_);
 }
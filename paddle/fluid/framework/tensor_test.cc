@@ -257,3 +257,33 @@ TEST(Tensor, FP16) {
   // Tensor holds the wrong type, it holds N6paddle8platform7float16E at
   // [/paddle/Paddle/paddle/fluid/framework/tensor_impl.h:43]
 }
+
+TEST(Tensor, CapacityPolicy) {
+  using framework::TensorCapacityPolicy;
+  EXPECT_EQ(TensorCapacityPolicy::RoundUp(1), 256UL);
+  EXPECT_EQ(TensorCapacityPolicy::RoundUp(257), 320UL);
+  EXPECT_EQ(TensorCapacityPolicy::RoundUp(1000), 1024UL);
+  EXPECT_EQ(TensorCapacityPolicy::RoundUp(1025), 1280UL);
+
+  TensorCapacityPolicy policy(/*shrink_after=*/2);
+  framework::ScopedTensorCapacityPolicy scope(&policy);
+  framework::Tensor tensor;
+  // 1000 and 1010 floats are of the same size class.
+  float* p1 = tensor.mutable_data<float>({1000}, platform::CPUPlace());
+  EXPECT_EQ(tensor.memory_size(), 4096UL);
+  float* p2 = tensor.mutable_data<float>({1010}, platform::CPUPlace());
+  EXPECT_EQ(p1, p2);
+  // The buffer is kept for a smaller size, until it is shrunk at the second
+  // successive use of less than a half.
+  p2 = tensor.mutable_data<float>({100}, platform::CPUPlace());
+  EXPECT_EQ(p1, p2);
+  EXPECT_EQ(tensor.memory_size(), 4096UL);
+  tensor.mutable_data<float>({100}, platform::CPUPlace());
+  EXPECT_EQ(tensor.memory_size(), 448UL);
+
+  auto stats = policy.GetStats();
+  EXPECT_EQ(stats.requests, 4);
+  EXPECT_EQ(stats.allocations, 2);
+  EXPECT_EQ(stats.shrinks, 1);
+  EXPECT_EQ(stats.allocated_bytes, 4096 + 448);
+}
@@ -13,6 +13,7 @@
    limitations under the License. */
 #include "paddle/fluid/framework/tensor_util.h"
 #include <algorithm>
+#include <cstring>
 #include <limits>
 #include <vector>
 #include "paddle/fluid/framework/data_type.h"
@@ -163,6 +164,98 @@ void TensorCopySync(const Tensor& src, const platform::Place& dst_place,
 #endif
 }
 
+void TensorCopyBatch(const std::vector<const Tensor*>& srcs,
+                     const platform::Place& dst_place,
+                     const platform::DeviceContext& ctx,
+                     const std::vector<Tensor*>& dsts) {
+  PADDLE_ENFORCE_EQ(srcs.size(), dsts.size(),
+                    "The numbers of the srcs and the dsts do not match.");
+#ifdef PADDLE_WITH_CUDA
+  // The copies of up to kMaxBatchedBytes each are coalesced, the bigger ones
+  // would cost more to pack than the launch of a memcpy. Every tensor starts
+  // at an aligned offset of the buffer.
+  constexpr size_t kMaxBatchedBytes = 1 << 20;
+  constexpr size_t kAlignment = 256;
+  std::vector<size_t> batched;
+  std::vector<size_t> offsets;
+  size_t total = 0;
+  if (platform::is_gpu_place(dst_place)) {
+    for (size_t i = 0; i < srcs.size(); ++i) {
+      const Tensor& src = *srcs[i];
+      size_t bytes = src.numel() * SizeOfType(src.type());
+      if (platform::is_cpu_place(src.place()) && bytes > 0 &&
+          bytes <= kMaxBatchedBytes) {
+        batched.push_back(i);
+        offsets.push_back(total);
+        total += (bytes + kAlignment - 1) / kAlignment * kAlignment;
+      }
+    }
+  }
+  if (batched.size() > 1) {
+    PADDLE_ENFORCE(platform::is_same_place(ctx.GetPlace(), dst_place),
+                   "The context of TensorCopyBatch is not of %s.", dst_place);
+    VLOG(3) << "TensorCopyBatch " << batched.size() << " tensors of " << total
+            << " bytes to " << dst_place;
+    std::shared_ptr<memory::Allocation> staging =
+        memory::AllocShared(platform::CUDAPinnedPlace(), total);
+    auto* host = reinterpret_cast<char*>(staging->ptr());
+    for (size_t k = 0; k < batched.size(); ++k) {
+      const Tensor& src = *srcs[batched[k]];
+      src.check_memory_size();
+      std::memcpy(host + offsets[k], src.data<void>(),
+                  src.numel() * SizeOfType(src.type()));
+    }
+    Tensor buffer;
+    buffer.Resize({static_cast<int64_t>(total)});
+    auto* device = buffer.mutable_data<uint8_t>(dst_place);
+    auto& dev_ctx = reinterpret_cast<const platform::CUDADeviceContext&>(ctx);
+    memory::Copy(boost::get<platform::CUDAPlace>(dst_place), device,
+                 platform::CUDAPinnedPlace(), host, total, dev_ctx.stream());
+    dev_ctx.AddStreamCallback([staging] {});
+    for (size_t k = 0; k < batched.size(); ++k) {
+      const Tensor& src = *srcs[batched[k]];
+      Tensor* dst = dsts[batched[k]];
+      int64_t begin = static_cast<int64_t>(offsets[k]);
+      dst->ShareDataWith(buffer.Slice(
+          begin, begin + src.numel() * SizeOfType(src.type())));
+      dst->Resize(src.dims());
+      dst->set_layout(src.layout());
+      dst->mutable_data(dst_place, src.type());
+    }
+  } else {
+    batched.clear();
+  }
+  // The copies which are not batched.
+  for (size_t i = 0, k = 0; i < srcs.size(); ++i) {
+    if (k < batched.size() && batched[k] == i) {
+      ++k;
+      continue;
+    }
+    TensorCopy(*srcs[i], dst_place, ctx, dsts[i]);
+  }
+#else
+  for (size_t i = 0; i < srcs.size(); ++i) {
+    TensorCopy(*srcs[i], dst_place, ctx, dsts[i]);
+  }
+#endif
+}
+
+void TensorCopyBatch(const std::vector<const Tensor*>& srcs,
+                     const platform::Place& dst_place,
+                     const std::vector<Tensor*>& dsts) {
+  if (platform::is_gpu_place(dst_place)) {
+    TensorCopyBatch(srcs, dst_place,
+                    *platform::DeviceContextPool::Instance().Get(dst_place),
+                    dsts);
+    return;
+  }
+  PADDLE_ENFORCE_EQ(srcs.size(), dsts.size(),
+                    "The numbers of the srcs and the dsts do not match.");
+  for (size_t i = 0; i < srcs.size(); ++i) {
+    TensorCopy(*srcs[i], dst_place, dsts[i]);
+  }
+}
+
 template <typename Predicate, typename DevCtx>
 struct AnyDTypeVisitor {
   Predicate predicate_;
@@ -476,13 +569,65 @@ void TensorFromStream(std::istream& is, Tensor* tensor,
       PADDLE_THROW("Unexpected branch");
 #endif
     } else {
+      // The place of the context is CPU, or CUDA pinned to stage the data
+      // copied to GPU later.
       framework::VisitDataType(
           desc.data_type(),
-          DeserializedDataFunctor(&buf, tensor, ctx.GetPlace()));
+          DeserializedDataFunctor(&buf, tensor, dev_ctx.GetPlace()));
       is.read(static_cast<char*>(buf), size);
     }
   }
 }
 
+size_t TensorFromMappedFile(
+    const std::shared_ptr<memory::allocation::MmapAllocation>& file,
+    size_t offset, Tensor* tensor) {
+  const char* base = static_cast<const char*>(file->ptr());
+  auto read = [&](void* dst, size_t size) {
+    PADDLE_ENFORCE_LE(offset + size, file->size(),
+                      "Unexpected end of the mapped file");
+    std::memcpy(dst, base + offset, size);
+    offset += size;
+  };
+  uint32_t version;
+  read(&version, sizeof(version));
+  PADDLE_ENFORCE_EQ(version, 0U, "Only version 0 is supported");
+  proto::VarType::TensorDesc desc;
+  {  // int32_t size
+     // proto buffer
+    int32_t size;
+    read(&size, sizeof(size));
+    PADDLE_ENFORCE_GE(size, 0, "Invalid size of tensor desc");
+    PADDLE_ENFORCE_LE(offset + size, file->size(),
+                      "Unexpected end of the mapped file");
+    PADDLE_ENFORCE(desc.ParseFromArray(base + offset, size),
+                   "Cannot parse tensor desc");
+    offset += size;
+  }
+  {  // alias tensor
+    std::vector<int64_t> dims;
+    dims.reserve(static_cast<size_t>(desc.dims().size()));
+    std::copy(desc.dims().begin(), desc.dims().end(), std::back_inserter(dims));
+    tensor->Resize(framework::make_ddim(dims));
+    size_t type_size = framework::SizeOfType(desc.data_type());
+    size_t size = tensor->numel() * type_size;
+    PADDLE_ENFORCE_LE(offset + size, file->size(),
+                      "Unexpected end of the mapped file");
+    // The mapping starts at a page boundary, so the offset in the file tells
+    // the alignment of the data.
+    if (offset % type_size == 0) {
+      tensor->ResetHolderWithType(
+          std::make_shared<memory::allocation::MmapSubAllocation>(
+              file, offset, size),
+          desc.data_type());
+    } else {
+      void* buf = tensor->mutable_data(platform::CPUPlace(), desc.data_type());
+      std::memcpy(buf, base + offset, size);
+    }
+    offset += size;
+  }
+  return offset;
+}
+
 }  // namespace framework
 }  // namespace paddle
@@ -18,6 +18,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/framework.pb.h"
 #include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/memory/allocation/mmap_allocation.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/temporary_allocator.h"
 
@@ -46,6 +47,22 @@ void TensorCopy(const Tensor& src, const platform::Place& dst_place,
 void TensorCopySync(const Tensor& src, const platform::Place& dst_place,
                     Tensor* dst);
 
+// Copies every srcs[i] to dsts[i] at dst_place, asynchronously on the stream
+// of ctx as TensorCopy. The small copies from the host to the GPU are
+// coalesced: their sources are packed into one pinned staging buffer, which
+// is copied into one GPU buffer by one memcpy, and those dsts share the
+// slices of it. The staging buffer is released by a callback of the stream
+// after the copy. The other copies are done one by one by TensorCopy.
+void TensorCopyBatch(const std::vector<const Tensor*>& srcs,
+                     const platform::Place& dst_place,
+                     const platform::DeviceContext& ctx,
+                     const std::vector<Tensor*>& dsts);
+
+// Like TensorCopyBatch above, on the stream of dst_place if it is a GPU.
+void TensorCopyBatch(const std::vector<const Tensor*>& srcs,
+                     const platform::Place& dst_place,
+                     const std::vector<Tensor*>& dsts);
+
 template <typename T>
 void TensorFromVector(const std::vector<T>& src,
                       const platform::DeviceContext& ctx, Tensor* dst);
@@ -73,6 +90,14 @@ void TensorToStream(std::ostream& os, const Tensor& tensor,
 void TensorFromStream(std::istream& is, Tensor* tensor,
                       const platform::DeviceContext& dev_ctx);
 
+// Deserialize the tensor written by TensorToStream at the offset of a mapped
+// file, and return the offset right after it. The CPU tensor aliases the
+// mapped pages instead of copying them, unless its data is not aligned to
+// its data type.
+size_t TensorFromMappedFile(
+    const std::shared_ptr<memory::allocation::MmapAllocation>& file,
+    size_t offset, Tensor* tensor);
+
 //
 // The implementation of template functions.
 //
@@ -16,6 +16,7 @@
 #include <gtest/gtest.h>
 #include <cmath>
 #include <string>
+#include <vector>
 
 namespace paddle {
 namespace framework {
@@ -118,6 +119,43 @@ TEST(TensorCopy, Tensor) {
 #endif
 }
 
+TEST(TensorCopyBatch, Tensor) {
+  std::vector<Tensor> src_tensors(3);
+  int* a = src_tensors[0].mutable_data<int>(make_ddim({2, 3}),
+                                            platform::CPUPlace());
+  float* b =
+      src_tensors[1].mutable_data<float>(make_ddim({5}), platform::CPUPlace());
+  src_tensors[2].mutable_data<int>(make_ddim({0, 4}), platform::CPUPlace());
+  for (int i = 0; i < 6; ++i) a[i] = i;
+  for (int i = 0; i < 5; ++i) b[i] = i * 0.5f;
+
+  auto check = [&](const platform::Place& place) {
+    std::vector<Tensor> dst_tensors(3);
+    std::vector<const Tensor*> srcs;
+    std::vector<Tensor*> dsts;
+    for (size_t i = 0; i < src_tensors.size(); ++i) {
+      srcs.push_back(&src_tensors[i]);
+      dsts.push_back(&dst_tensors[i]);
+    }
+    TensorCopyBatch(srcs, place, dsts);
+    for (size_t i = 0; i < src_tensors.size(); ++i) {
+      EXPECT_EQ(dst_tensors[i].dims(), src_tensors[i].dims());
+      EXPECT_TRUE(dst_tensors[i].type() == src_tensors[i].type());
+      EXPECT_TRUE(platform::is_same_place(dst_tensors[i].place(), place));
+    }
+    Tensor dst_a, dst_b;
+    TensorCopySync(dst_tensors[0], platform::CPUPlace(), &dst_a);
+    TensorCopySync(dst_tensors[1], platform::CPUPlace(), &dst_b);
+    for (int i = 0; i < 6; ++i) EXPECT_EQ(dst_a.data<int>()[i], a[i]);
+    for (int i = 0; i < 5; ++i) EXPECT_EQ(dst_b.data<float>()[i], b[i]);
+  };
+
+  check(platform::CPUPlace());
+#ifdef PADDLE_WITH_CUDA
+  check(platform::CUDAPlace(0));
+#endif
+}
+
 TEST(TensorFromVector, Tensor) {
   {
     std::vector<int> src_vec = {1, 2, 3, 4, 5, 6, 7, 8, 9};
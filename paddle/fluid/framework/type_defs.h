@@ -57,5 +57,9 @@ using InferVarTypeFN =
 
 using InferShapeFN = std::function<void(InferShapeContext*)>;
 
+using InferInplaceOpFN = std::function<
+    std::unordered_map<std::string, std::string>(const OpDesc& /*op_desc*/,
+                                                 BlockDesc* /*block*/)>;
+
 }  // namespace framework
 }  // namespace paddle
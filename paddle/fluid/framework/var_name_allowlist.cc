@@ -0,0 +1,50 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/var_name_allowlist.h"
+#include "paddle/fluid/string/split.h"
+
+namespace paddle {
+namespace framework {
+
+VarNameAllowlist::VarNameAllowlist(const std::string& names) {
+  for (auto& name : string::Split(names, ',')) {
+    if (name == "*") {
+      match_all_ = true;
+    } else {
+      names_.insert(name);
+    }
+  }
+}
+
+bool VarNameAllowlist::Contains(const std::string& var_name) const {
+  if (match_all_) {
+    return true;
+  }
+  if (names_.count(var_name)) {
+    return true;
+  }
+  // Strip the ".block0", ".trainer_0" like suffixes one by one.
+  auto pos = var_name.rfind('.');
+  while (pos != std::string::npos && pos > 0) {
+    if (names_.count(var_name.substr(0, pos))) {
+      return true;
+    }
+    pos = var_name.rfind('.', pos - 1);
+  }
+  return false;
+}
+
+}  // namespace framework
+}  // namespace paddle
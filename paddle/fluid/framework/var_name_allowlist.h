@@ -0,0 +1,41 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#pragma once
+
+#include <string>
+#include <unordered_set>
+
+namespace paddle {
+namespace framework {
+
+// A set of variable names parsed from a comma separated string, used by the
+// options that only apply to some variables. An entry matches the variable
+// of the same name and the pieces split from it by the distribute transpiler,
+// e.g. "fc_0.w_0@GRAD" matches "fc_0.w_0@GRAD.block0". The entry "*" matches
+// all the variables.
+class VarNameAllowlist {
+ public:
+  explicit VarNameAllowlist(const std::string& names);
+
+  bool Contains(const std::string& var_name) const;
+
+  bool Empty() const { return !match_all_ && names_.empty(); }
+
+ private:
+  std::unordered_set<std::string> names_;
+  bool match_all_{false};
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,43 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/var_name_allowlist.h"
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+TEST(VarNameAllowlist, match) {
+  VarNameAllowlist allowlist("fc_0.w_0@GRAD,,fc_1.b_0@GRAD");
+  EXPECT_FALSE(allowlist.Empty());
+  EXPECT_TRUE(allowlist.Contains("fc_0.w_0@GRAD"));
+  EXPECT_TRUE(allowlist.Contains("fc_0.w_0@GRAD.block1"));
+  EXPECT_TRUE(allowlist.Contains("fc_1.b_0@GRAD.trainer_0"));
+  EXPECT_FALSE(allowlist.Contains("fc_0.w_0"));
+  EXPECT_FALSE(allowlist.Contains("fc_0.w_0@GRAD_1"));
+  EXPECT_FALSE(allowlist.Contains("fc_1.w_0@GRAD"));
+}
+
+TEST(VarNameAllowlist, empty_and_all) {
+  VarNameAllowlist empty("");
+  EXPECT_TRUE(empty.Empty());
+  EXPECT_FALSE(empty.Contains("fc_0.w_0@GRAD"));
+
+  VarNameAllowlist all("*");
+  EXPECT_FALSE(all.Empty());
+  EXPECT_TRUE(all.Contains("fc_0.w_0@GRAD"));
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,121 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/work_stealing_thread_pool.h"
+#include <utility>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+
+// The pool and the index of the worker running on current thread.
+static thread_local WorkStealingThreadPool* tls_pool = nullptr;
+static thread_local size_t tls_worker_idx = 0;
+
+WorkStealingThreadPool::WorkStealingThreadPool(size_t num_threads) {
+  PADDLE_ENFORCE_GT(num_threads, 0UL);
+  workers_.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    workers_.emplace_back(new Worker);
+  }
+  threads_.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads_.emplace_back([this, i] { TaskLoop(i); });
+  }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    running_ = false;
+  }
+  scheduled_.notify_all();
+  for (auto& t : threads_) {
+    t.join();
+  }
+}
+
+void WorkStealingThreadPool::Run(Task task) {
+  size_t idx = tls_pool == this
+                   ? tls_worker_idx
+                   : next_worker_.fetch_add(1) % workers_.size();
+  {
+    auto& worker = *workers_[idx];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.tasks.emplace_back(std::move(task));
+  }
+  // pending_ is increased before num_sleeping_ is read, while a worker
+  // increases num_sleeping_ before it reads pending_, so either the worker
+  // sees the task or this thread sees the sleeping worker.
+  ++pending_;
+  if (num_sleeping_ > 0) {
+    { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+    scheduled_.notify_one();
+  }
+}
+
+bool WorkStealingThreadPool::PopLocal(size_t idx, Task* task) {
+  auto& worker = *workers_[idx];
+  std::lock_guard<std::mutex> lock(worker.mutex);
+  if (worker.tasks.empty()) {
+    return false;
+  }
+  *task = std::move(worker.tasks.back());
+  worker.tasks.pop_back();
+  return true;
+}
+
+bool WorkStealingThreadPool::Steal(size_t idx, Task* task) {
+  size_t num_workers = workers_.size();
+  for (size_t i = 1; i < num_workers; ++i) {
+    auto& victim = *workers_[(idx + i) % num_workers];
+    std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+    if (!lock.owns_lock() || victim.tasks.empty()) {
+      continue;
+    }
+    *task = std::move(victim.tasks.front());
+    victim.tasks.pop_front();
+    return true;
+  }
+  return false;
+}
+
+void WorkStealingThreadPool::TaskLoop(size_t idx) {
+  tls_pool = this;
+  tls_worker_idx = idx;
+  while (true) {
+    Task task;
+    if (PopLocal(idx, &task) || Steal(idx, &task)) {
+      --pending_;
+      task();
+      continue;
+    }
+    if (pending_ > 0) {
+      // Some victims were locked or the task was pushed just now, retry.
+      std::this_thread::yield();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    ++num_sleeping_;
+    scheduled_.wait(lock, [this] { return pending_ > 0 || !running_; });
+    --num_sleeping_;
+    if (!running_ && pending_ == 0) {
+      return;
+    }
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
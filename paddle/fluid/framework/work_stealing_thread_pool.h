@@ -0,0 +1,80 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+#include "paddle/fluid/platform/macros.h"  // for DISABLE_COPY_AND_ASSIGN
+
+namespace paddle {
+namespace framework {
+
+// WorkStealingThreadPool gives each thread its own task deque instead of one
+// queue shared by all threads. A task launched by a worker thread is pushed
+// to the deque of that worker, which pops tasks from the back (LIFO) so that
+// the latest task, e.g. a successor of the op just finished, runs on a warm
+// cache. An idle worker steals tasks from the front (FIFO) of the others.
+// Tasks launched from outside the pool are distributed round-robin.
+//
+// The tasks should not throw, exceptions must be handled inside the task.
+class WorkStealingThreadPool {
+ public:
+  using Task = std::function<void()>;
+
+  explicit WorkStealingThreadPool(size_t num_threads);
+
+  // Waits until all the launched tasks are finished.
+  ~WorkStealingThreadPool();
+
+  void Run(Task task);
+
+  size_t NumThreads() const { return workers_.size(); }
+
+ private:
+  DISABLE_COPY_AND_ASSIGN(WorkStealingThreadPool);
+
+  struct Worker {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void TaskLoop(size_t idx);
+
+  // Pop from the back of the deque of worker idx.
+  bool PopLocal(size_t idx, Task* task);
+
+  // Pop from the front of the deque of the other workers.
+  bool Steal(size_t idx, Task* task);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+  std::atomic<size_t> next_worker_{0};
+
+  // The number of tasks in all deques.
+  std::atomic<int64_t> pending_{0};
+  std::atomic<int> num_sleeping_{0};
+  std::atomic<bool> running_{true};
+  std::mutex sleep_mutex_;
+  std::condition_variable scheduled_;
+};
+
+}  // namespace framework
+}  // namespace paddle
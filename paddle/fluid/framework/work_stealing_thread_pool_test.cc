@@ -0,0 +1,55 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/work_stealing_thread_pool.h"
+#include <gtest/gtest.h>
+#include <atomic>
+
+namespace paddle {
+namespace framework {
+
+TEST(WorkStealingThreadPool, Run) {
+  std::atomic<int> sum(0);
+  int n = 1000;
+  {
+    WorkStealingThreadPool pool(4);
+    for (int i = 1; i <= n; ++i) {
+      pool.Run([&sum, i] { sum += i; });
+    }
+  }
+  EXPECT_EQ(sum, (n * (n + 1)) / 2);
+}
+
+// Tasks launched inside the pool fan out and are stolen by other workers.
+static void Spawn(WorkStealingThreadPool* pool, std::atomic<int>* cnt,
+                  int depth) {
+  ++(*cnt);
+  if (depth == 0) return;
+  for (int i = 0; i < 2; ++i) {
+    pool->Run([=] { Spawn(pool, cnt, depth - 1); });
+  }
+}
+
+TEST(WorkStealingThreadPool, NestedRun) {
+  std::atomic<int> cnt(0);
+  int depth = 10;
+  {
+    WorkStealingThreadPool pool(4);
+    pool.Run([&] { Spawn(&pool, &cnt, depth); });
+  }
+  EXPECT_EQ(cnt, (1 << (depth + 1)) - 1);
+}
+
+}  // namespace framework
+}  // namespace paddle
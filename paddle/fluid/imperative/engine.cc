@@ -14,10 +14,12 @@
 
 #include "paddle/fluid/imperative/engine.h"
 
-#include <mutex>  // NOLINT
-#include <vector>
-
-#include "glog/logging.h"
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 
 namespace paddle {
 namespace imperative {
@@ -25,27 +27,92 @@ namespace imperative {
 static std::once_flag init_engine;
 static Engine* engine;
 
-class DummyEngine : public Engine {
+class AsyncEngine : public Engine {
  public:
+  AsyncEngine() : worker_([this] { Loop(); }) {}
+
+  ~AsyncEngine() {
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      stopped_ = true;
+    }
+    scheduled_.notify_all();
+    worker_.join();
+  }
+
   void Enqueue(Runnable* runnable) override {
-    queued_runnables_.push_back(runnable);
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      queued_runnables_.emplace_back(runnable);
+      ++size_;
+    }
+    scheduled_.notify_one();
   }
 
-  size_t Size() const override { return queued_runnables_.size(); }
+  size_t Size() const override {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return size_;
+  }
 
   void Sync() override {
-    for (Runnable* l : queued_runnables_) {
-      LOG(INFO) << "running " << reinterpret_cast<void*>(l);
+    // A runnable reading a value must not wait for itself.
+    if (std::this_thread::get_id() == worker_.get_id()) return;
+    std::unique_lock<std::mutex> lock(mutex_);
+    finished_.wait(lock, [this] { return size_ == 0; });
+    if (exception_) {
+      std::exception_ptr exception = exception_;
+      exception_ = nullptr;
+      std::rethrow_exception(exception);
     }
-    queued_runnables_.clear();
   }
 
  private:
-  std::vector<Runnable*> queued_runnables_;
+  void Loop() {
+    while (true) {
+      std::unique_ptr<Runnable> runnable;
+      bool failed;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        scheduled_.wait(lock, [this] {
+          return stopped_ || !queued_runnables_.empty();
+        });
+        if (queued_runnables_.empty()) return;
+        runnable = std::move(queued_runnables_.front());
+        queued_runnables_.pop_front();
+        failed = exception_ != nullptr;
+      }
+
+      // The runnables after a failed one read its outputs, skip them.
+      if (!failed) {
+        try {
+          runnable->callback_();
+        } catch (...) {
+          std::lock_guard<std::mutex> guard(mutex_);
+          exception_ = std::current_exception();
+        }
+      }
+
+      {
+        std::lock_guard<std::mutex> guard(mutex_);
+        --size_;
+      }
+      finished_.notify_all();
+    }
+  }
+
+  mutable std::mutex mutex_;
+  std::condition_variable scheduled_;
+  std::condition_variable finished_;
+  std::deque<std::unique_ptr<Runnable>> queued_runnables_;
+  size_t size_{0};
+  bool stopped_{false};
+  std::exception_ptr exception_;
+  // Started after all the members above are initialized.
+  std::thread worker_;
 };
 
 Engine* GetEngine() {
-  std::call_once(init_engine, []() { engine = new DummyEngine(); });
+  std::call_once(init_engine, []() { engine = new AsyncEngine(); });
   return engine;
 }
 
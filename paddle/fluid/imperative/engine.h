@@ -16,20 +16,35 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <utility>
 
 namespace paddle {
 namespace imperative {
 
-struct Runnable {};
+struct Runnable {
+  explicit Runnable(std::function<void()> callback)
+      : callback_(std::move(callback)) {}
 
+  std::function<void()> callback_;
+};
+
+/* The engine runs the traced operators asynchronously, so that the Python
+ * thread goes on tracing while the kernels are running. The runnables run in
+ * the order of the enqueueing on a worker thread, and the engine owns them.
+ * Everything reading the values of the variables should Sync first.
+ */
 class Engine {
  public:
   virtual ~Engine() {}
 
   virtual void Enqueue(Runnable* runnable) = 0;
 
+  // The number of the runnables which are not finished.
   virtual size_t Size() const = 0;
 
+  // Wait for all the enqueued runnables, and rethrow the first exception
+  // thrown by them. The runnables after a failed one are discarded.
   virtual void Sync() = 0;
 };
 
@@ -0,0 +1,325 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/imperative/jit.h"
+
+#include <sstream>
+
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/imperative/engine.h"
+
+namespace paddle {
+namespace imperative {
+
+namespace {
+
+constexpr char kFeedVarName[] = "feed";
+constexpr char kFetchVarName[] = "fetch";
+
+void ShareTensor(const framework::Variable& src, framework::Variable* dst) {
+  auto& src_tensor = src.Get<framework::LoDTensor>();
+  auto* dst_tensor = dst->GetMutable<framework::LoDTensor>();
+  dst_tensor->ShareDataWith(src_tensor);
+  dst_tensor->set_lod(src_tensor.lod());
+}
+
+// The lifetimes of the temporary variables, as MemoryPlanPass, the feeds and
+// the fetches are excluded.
+std::unordered_map<std::string, std::pair<int, int>> TemporaryLifetimes(
+    const framework::ProgramDesc& program) {
+  auto& block = program.Block(0);
+  std::unordered_set<std::string> candidates;
+  for (auto* var : block.AllVars()) {
+    if (!var->Persistable() &&
+        var->GetType() == framework::proto::VarType::LOD_TENSOR) {
+      candidates.insert(var->Name());
+    }
+  }
+
+  std::unordered_map<std::string, std::pair<int, int>> lifetimes;
+  std::unordered_set<std::string> excluded;
+  int op_idx = -1;
+  for (auto* op : block.AllOps()) {
+    if (op->Type() == "feed" || op->Type() == "fetch") {
+      for (auto& name : op->InputArgumentNames()) excluded.insert(name);
+      for (auto& name : op->OutputArgumentNames()) excluded.insert(name);
+      continue;
+    }
+    ++op_idx;
+    for (auto& name : op->InputArgumentNames()) {
+      if (!candidates.count(name)) continue;
+      auto it = lifetimes.find(name);
+      if (it == lifetimes.end()) {
+        excluded.insert(name);
+      } else {
+        it->second.second = op_idx;
+      }
+    }
+    for (auto& name : op->OutputArgumentNames()) {
+      if (!candidates.count(name)) continue;
+      auto it = lifetimes.find(name);
+      if (it == lifetimes.end()) {
+        lifetimes.emplace(name, std::make_pair(op_idx, op_idx));
+      } else {
+        it->second.second = op_idx;
+      }
+    }
+  }
+  for (auto& name : excluded) {
+    lifetimes.erase(name);
+  }
+  return lifetimes;
+}
+
+}  // namespace
+
+TracedLayer::TracedLayer(Tracer* tracer, const std::vector<std::string>& passes)
+    : tracer_(tracer), passes_(passes) {
+  PADDLE_ENFORCE_NOT_NULL(tracer_);
+}
+
+TracedLayer::~TracedLayer() {
+  if (recording_) {
+    tracer_->SetObserver(nullptr);
+  }
+}
+
+std::string TracedLayer::Signature(const std::vector<VarBase*>& inputs) {
+  // The shapes are known after the pending ops run.
+  GetEngine()->Sync();
+  std::ostringstream os;
+  for (auto* input : inputs) {
+    PADDLE_ENFORCE_NOT_NULL(input->var_);
+    auto& tensor = input->var_->Get<framework::LoDTensor>();
+    PADDLE_ENFORCE(tensor.IsInitialized(), "The input is not initialized.");
+    os << static_cast<int>(tensor.type()) << ':' << tensor.dims() << ':'
+       << tensor.lod() << ';';
+  }
+  return os.str();
+}
+
+void TracedLayer::BeginTrace(const std::vector<VarBase*>& inputs) {
+  PADDLE_ENFORCE(recording_ == nullptr, "The layer is being traced.");
+  recording_.reset(new Recording);
+  recording_->signature = Signature(inputs);
+  for (auto* input : inputs) {
+    PADDLE_ENFORCE_NOT_NULL(input->var_desc_, "The input has no var desc.");
+    AddVar(input);
+    recording_->feeds.push_back(input->var_desc_->Name());
+  }
+  tracer_->SetObserver(this);
+}
+
+void TracedLayer::EndTrace(const std::vector<VarBase*>& outputs) {
+  PADDLE_ENFORCE_NOT_NULL(recording_, "BeginTrace should be called first.");
+  tracer_->SetObserver(nullptr);
+  std::unique_ptr<Recording> recording(std::move(recording_));
+
+  std::unique_ptr<Program> program;
+  if (recording->supported) {
+    program = Compile(*recording, outputs);
+  }
+  if (!program) {
+    VLOG(3) << "The trace can not be compiled, run in the imperative mode";
+  }
+  programs_[recording->signature] = std::move(program);
+}
+
+void TracedLayer::AbortTrace() {
+  if (recording_) {
+    tracer_->SetObserver(nullptr);
+    recording_.reset();
+  }
+}
+
+bool TracedLayer::HasProgram(const std::vector<VarBase*>& inputs) const {
+  auto it = programs_.find(Signature(inputs));
+  return it != programs_.end() && it->second != nullptr;
+}
+
+bool TracedLayer::NeedTrace(const std::vector<VarBase*>& inputs) const {
+  return programs_.count(Signature(inputs)) == 0;
+}
+
+void TracedLayer::AddVar(VarBase* var) {
+  const std::string& name = var->var_desc_->Name();
+  auto* block = recording_->desc.MutableBlock(0);
+  if (!block->HasVar(name)) {
+    *block->Var(name)->Proto() = *var->var_desc_->Proto();
+  }
+  recording_->vars[name] = var;
+}
+
+void TracedLayer::OnTrace(const framework::OpDesc* op_desc,
+                          const VarBasePtrMap& inputs,
+                          const VarBasePtrMap& outputs) {
+  if (!recording_->supported) return;
+  if (op_desc == nullptr) {
+    recording_->supported = false;
+    return;
+  }
+  // The sub-blocks belong to the program of the python side.
+  for (auto& attr : op_desc->GetAttrMap()) {
+    if (attr.second.type() == typeid(framework::BlockDesc*) ||
+        attr.second.type() == typeid(std::vector<framework::BlockDesc*>)) {
+      recording_->supported = false;
+      return;
+    }
+  }
+
+  for (auto& input : inputs) {
+    for (auto* var : input.second) {
+      const std::string& name = var->var_desc_->Name();
+      if (!recording_->written.count(name) && !recording_->vars.count(name)) {
+        recording_->externals.push_back(name);
+      }
+      AddVar(var);
+    }
+  }
+  recording_->desc.MutableBlock(0)->AppendOp()->CopyFrom(*op_desc);
+  for (auto& output : outputs) {
+    for (auto* var : output.second) {
+      AddVar(var);
+      recording_->written.insert(var->var_desc_->Name());
+    }
+  }
+}
+
+std::unique_ptr<TracedLayer::Program> TracedLayer::Compile(
+    const Recording& recording, const std::vector<VarBase*>& outputs) const {
+  std::unique_ptr<Program> program(new Program);
+  program->feeds = recording.feeds;
+  for (auto* output : outputs) {
+    if (output->var_desc_ == nullptr ||
+        !recording.vars.count(output->var_desc_->Name())) {
+      VLOG(3) << "The output is not created in the trace";
+      return nullptr;
+    }
+    program->fetches.push_back(output->var_desc_->Name());
+  }
+
+  framework::ProgramDesc desc(recording.desc);
+  auto* block = desc.MutableBlock(0);
+  std::unordered_set<std::string> feeds(recording.feeds.begin(),
+                                        recording.feeds.end());
+  for (auto& name : recording.externals) {
+    if (feeds.count(name)) continue;
+    VarBase* var = recording.vars.at(name);
+    if (!var->var_desc_->Persistable()) {
+      VLOG(3) << "The temporary variable " << name
+              << " is created before the trace";
+      return nullptr;
+    }
+    program->params.emplace_back(name, var->var_);
+  }
+  for (auto* var : block->AllVars()) {
+    var->SetPersistable(false);
+  }
+  for (auto& param : program->params) {
+    block->FindVar(param.first)->SetPersistable(true);
+  }
+
+  // The feed and fetch ops keep the inputs and outputs from being fused away,
+  // the executor skips them.
+  auto* feed_var = block->Var(kFeedVarName);
+  feed_var->SetType(framework::proto::VarType::FEED_MINIBATCH);
+  feed_var->SetPersistable(true);
+  auto* fetch_var = block->Var(kFetchVarName);
+  fetch_var->SetType(framework::proto::VarType::FETCH_LIST);
+  fetch_var->SetPersistable(true);
+  for (int i = static_cast<int>(program->feeds.size()) - 1; i >= 0; --i) {
+    auto* op = block->PrependOp();
+    op->SetType("feed");
+    op->SetInput("X", {kFeedVarName});
+    op->SetOutput("Out", {program->feeds[i]});
+    op->SetAttr("col", i);
+  }
+  for (size_t i = 0; i < program->fetches.size(); ++i) {
+    auto* op = block->AppendOp();
+    op->SetType("fetch");
+    op->SetInput("X", {program->fetches[i]});
+    op->SetOutput("Out", {kFetchVarName});
+    op->SetAttr("col", static_cast<int>(i));
+  }
+
+  // The passes may read the parameters.
+  program->executor.reset(new framework::NaiveExecutor(platform::CPUPlace()));
+  program->executor->CreateVariables(desc, 0, true, &program->scope);
+  GetEngine()->Sync();
+  ShareParams(program.get());
+
+  std::unique_ptr<framework::ir::Graph> graph(new framework::ir::Graph(desc));
+  graph->Set(framework::ir::kParamScopeAttr,
+             new framework::Scope*(&program->scope));
+  for (auto& pass_name : passes_) {
+    VLOG(3) << "Apply " << pass_name << " to the traced program";
+    graph = framework::ir::PassRegistry::Instance().Get(pass_name)->Apply(
+        std::move(graph));
+  }
+  program->desc.reset(new framework::ProgramDesc(desc));
+  auto to_program =
+      framework::ir::PassRegistry::Instance().Get("graph_to_program_pass");
+  to_program->SetNotOwned("program", program->desc.get());
+  graph = to_program->Apply(std::move(graph));
+
+  program->executor->CreateVariables(*program->desc, 0, true,
+                                     &program->scope);
+  program->executor->CreateVariables(*program->desc, 0, false,
+                                     &program->scope);
+  program->executor->Prepare(&program->scope, *program->desc, 0, false);
+  program->executor->EnableMemoryPlan(TemporaryLifetimes(*program->desc));
+  return program;
+}
+
+void TracedLayer::ShareParams(Program* program) {
+  for (auto& param : program->params) {
+    ShareTensor(*param.second, program->scope.Var(param.first));
+  }
+}
+
+std::vector<VarBase*> TracedLayer::Run(const std::vector<VarBase*>& inputs) {
+  auto it = programs_.find(Signature(inputs));
+  PADDLE_ENFORCE(it != programs_.end() && it->second != nullptr,
+                 "There is no program for the inputs.");
+  Program* program = it->second.get();
+  PADDLE_ENFORCE_EQ(inputs.size(), program->feeds.size());
+
+  ShareParams(program);
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    ShareTensor(*inputs[i]->var_, program->scope.Var(program->feeds[i]));
+  }
+  program->executor->Run();
+
+  std::vector<VarBase*> outputs;
+  for (auto& name : program->fetches) {
+    VarBase* output = new VarBase(true);
+    ShareTensor(*program->scope.FindVar(name), output->var_);
+    outputs.push_back(output);
+  }
+  // The outputs own the buffers, the next Run allocates new ones.
+  for (auto& name : program->fetches) {
+    program->scope.FindVar(name)->GetMutable<framework::LoDTensor>()->clear();
+  }
+  return outputs;
+}
+
+}  // namespace imperative
+}  // namespace paddle
+
+USE_PASS(graph_to_program_pass);
+USE_PASS(fc_fuse_pass);
+USE_PASS(fuse_elewise_add_act_pass);
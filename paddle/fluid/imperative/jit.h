@@ -0,0 +1,112 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "paddle/fluid/framework/naive_executor.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/imperative/layer.h"
+#include "paddle/fluid/imperative/tracer.h"
+#include "paddle/fluid/imperative/type_defs.h"
+
+namespace paddle {
+namespace imperative {
+
+/* Trace a step of the imperative mode into a program, and replay it.
+ *
+ * The ops traced between BeginTrace and EndTrace are recorded into a
+ * ProgramDesc, which is optimized by the IR passes and run by a NaiveExecutor
+ * with the planned memory, for the later steps whose inputs have the same data
+ * types, shapes and LoDs. The variables read but not written by the recorded
+ * ops, other than the inputs, are the parameters. They are shared with the
+ * program on every Run, so that the updates of the optimizers are seen.
+ *
+ * Only the forward ops are replayed, the outputs have no grads. The steps
+ * which call the python layers, or read the temporary variables created
+ * before the trace, are not compiled, and run in the imperative mode.
+ */
+class TracedLayer : public TraceObserver {
+ public:
+  TracedLayer(Tracer* tracer, const std::vector<std::string>& passes);
+
+  ~TracedLayer();
+
+  // Record the ops traced until EndTrace, which run as usual.
+  void BeginTrace(const std::vector<VarBase*>& inputs);
+  // Compile the recorded ops into the program of the inputs, which fetches
+  // the outputs.
+  void EndTrace(const std::vector<VarBase*>& outputs);
+  // Stop recording without a program, e.g. when the layer fails.
+  void AbortTrace();
+
+  // Whether there is a compiled program for the inputs.
+  bool HasProgram(const std::vector<VarBase*>& inputs) const;
+  // Whether the inputs of the same signature are never traced.
+  bool NeedTrace(const std::vector<VarBase*>& inputs) const;
+
+  // Run the program of the inputs. The outputs are owned by the caller.
+  std::vector<VarBase*> Run(const std::vector<VarBase*>& inputs);
+
+  void OnTrace(const framework::OpDesc* op_desc, const VarBasePtrMap& inputs,
+               const VarBasePtrMap& outputs) override;
+
+ private:
+  struct Recording {
+    std::string signature;
+    framework::ProgramDesc desc;
+    std::vector<std::string> feeds;
+    std::unordered_map<std::string, VarBase*> vars;
+    std::unordered_set<std::string> written;
+    // The variables read before written, in the order of the first read.
+    std::vector<std::string> externals;
+    bool supported{true};
+  };
+
+  struct Program {
+    std::unique_ptr<framework::ProgramDesc> desc;
+    std::vector<std::string> feeds;
+    std::vector<std::string> fetches;
+    // The parameters and the variables which hold their values.
+    std::vector<std::pair<std::string, framework::Variable*>> params;
+    framework::Scope scope;
+    std::unique_ptr<framework::NaiveExecutor> executor;
+  };
+
+  // The data types, shapes and LoDs of the inputs.
+  static std::string Signature(const std::vector<VarBase*>& inputs);
+
+  void AddVar(VarBase* var);
+
+  std::unique_ptr<Program> Compile(const Recording& recording,
+                                   const std::vector<VarBase*>& outputs) const;
+
+  static void ShareParams(Program* program);
+
+  Tracer* tracer_;
+  std::vector<std::string> passes_;
+  std::unique_ptr<Recording> recording_;
+  // The signatures which can not be compiled have nullptr.
+  std::unordered_map<std::string, std::unique_ptr<Program>> programs_;
+};
+
+}  // namespace imperative
+}  // namespace paddle
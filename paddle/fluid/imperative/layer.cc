@@ -13,15 +13,23 @@
 // limitations under the License.
 
 #include "paddle/fluid/imperative/layer.h"
+#include <algorithm>
+#include <condition_variable>  // NOLINT
 #include <deque>
+#include <exception>
 #include <limits>
 #include <map>
+#include <mutex>  // NOLINT
 #include <random>
+#include <thread>  // NOLINT
 #include <utility>
 
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/imperative/engine.h"
+#include "paddle/fluid/imperative/op_cache.h"
 #include "paddle/fluid/string/printf.h"
 
 namespace paddle {
@@ -31,6 +39,62 @@ std::map<int, py::object> py_funcs_;
 
 using framework::Variable;
 
+// The grad ops run concurrently, they share the block and may accumulate
+// into the same grad.
+static std::mutex grad_mutex_;
+
+static framework::ThreadPool* BackwardThreadPool() {
+  static framework::ThreadPool pool(
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+  return &pool;
+}
+
+PreparedOp PreparedOp::Prepare(const framework::RuntimeContext& ctx,
+                               const framework::OperatorWithKernel& op,
+                               const platform::Place& place) {
+  platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
+  auto* dev_ctx = pool.Get(place);
+
+  std::string key = KernelCache::Key(op, ctx, place);
+  framework::OperatorWithKernel::OpKernelFunc func;
+  if (KernelCache::Instance().Get(key, &func)) {
+    return PreparedOp(op, ctx, func, dev_ctx);
+  }
+
+  // check if op[type] has kernel registered.
+  auto& all_op_kernels = op.AllOpKernels();
+  auto kernels_iter = all_op_kernels.find(op.Type());
+  if (kernels_iter == all_op_kernels.end()) {
+    PADDLE_THROW(
+        "There are no kernels which are registered in the %s operator.",
+        op.Type());
+  }
+
+  framework::OperatorWithKernel::OpKernelMap& kernels = kernels_iter->second;
+
+  auto expected_kernel_key = op.GetExpectedKernelType(
+      framework::ExecutionContext(op, framework::Scope(), *dev_ctx, ctx));
+  VLOG(3) << "expected_kernel_key:" << expected_kernel_key;
+
+  auto kernel_iter = kernels.find(expected_kernel_key);
+#ifdef PADDLE_WITH_MKLDNN
+  // workaround for missing MKLDNN kernel when FLAGS_use_mkldnn env var is set
+  if (kernel_iter == kernels.end() &&
+      expected_kernel_key.library_type_ == framework::LibraryType::kMKLDNN) {
+    VLOG(3) << "missing MKLDNN kernel: fallbacking to PLAIN one";
+    expected_kernel_key.library_type_ = framework::LibraryType::kPlain;
+    expected_kernel_key.data_layout_ = framework::DataLayout::kAnyLayout;
+    kernel_iter = kernels.find(expected_kernel_key);
+  }
+#endif
+  if (kernel_iter == kernels.end()) {
+    PADDLE_THROW("op %s does not have kernel for %s", op.Type(),
+                 KernelTypeToString(expected_kernel_key));
+  }
+  KernelCache::Instance().Set(key, kernel_iter->second);
+  return PreparedOp(op, ctx, kernel_iter->second, dev_ctx);
+}
+
 void AddTo(Variable* src, Variable* dst) {
   framework::LoDTensor* dst_tensor = dst->GetMutable<framework::LoDTensor>();
   framework::LoDTensor* src_tensor = src->GetMutable<framework::LoDTensor>();
@@ -59,35 +123,74 @@ class Autograd {
     }
     VLOG(3) << "start autograd";
 
+    std::map<OpBase*, int> dep_counts = ComputeDepCounts(var->pre_op_);
+
+    // A grad op is ready when all the grads of its outputs are accumulated,
+    // the independent ready ones run concurrently on the thread pool.
+    std::mutex mutex;
+    std::condition_variable finished;
     std::deque<OpBase*> ready;
     ready.push_back(var->pre_op_);
+    int running = 0;
+    std::exception_ptr exception;
+
+    auto run = [&](OpBase* ready_op) {
+      try {
+        std::map<std::string, std::vector<VarBase*>> input_grads =
+            ready_op->ApplyGrad();
+
+        std::lock_guard<std::mutex> guard(mutex);
+        for (auto it : input_grads) {
+          const std::vector<VarBase*>& ingrads = it.second;
+          for (size_t i = 0; i < ingrads.size(); ++i) {
+            if (!ingrads[i]) continue;
+            if (ready_op->input_vars_[it.first][i]->stop_gradient_) {
+              continue;
+            }
+            OpBase* pre_op = ready_op->pre_ops_[it.first][i];
+            if (!pre_op) continue;
+
+            dep_counts[pre_op] -= 1;
+            PADDLE_ENFORCE(dep_counts[pre_op] >= 0);
+            bool pre_op_ready = dep_counts[pre_op] == 0;
+            if (pre_op_ready) {
+              ready.push_back(pre_op);
+            }
+          }
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (!exception) exception = std::current_exception();
+      }
+    };
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      finished.wait(lock, [&] { return !ready.empty() || running == 0; });
+      if (exception) {
+        finished.wait(lock, [&] { return running == 0; });
+        std::rethrow_exception(exception);
+      }
+      if (ready.empty()) break;
 
-    std::map<OpBase*, int> dep_counts = ComputeDepCounts(var->pre_op_);
-
-    while (!ready.empty()) {
       OpBase* ready_op = ready.front();
       ready.pop_front();
-      std::map<std::string, std::vector<VarBase*>> input_grads =
-          ready_op->ApplyGrad();
-
-      for (auto it : input_grads) {
-        const std::vector<VarBase*>& ingrads = it.second;
-        for (size_t i = 0; i < ingrads.size(); ++i) {
-          if (!ingrads[i]) continue;
-          if (ready_op->input_vars_[it.first][i]->stop_gradient_) {
-            continue;
-          }
-          OpBase* pre_op = ready_op->pre_ops_[it.first][i];
-          if (!pre_op) continue;
-
-          dep_counts[pre_op] -= 1;
-          PADDLE_ENFORCE(dep_counts[pre_op] >= 0);
-          bool pre_op_ready = dep_counts[pre_op] == 0;
-          if (pre_op_ready) {
-            ready.push_back(pre_op);
-          }
-        }
+      ++running;
+      if (running == 1 && ready.empty()) {
+        // Nothing runs in parallel with it, e.g. a chain of grad ops, run it
+        // on this thread to save the thread switches.
+        lock.unlock();
+        run(ready_op);
+        lock.lock();
+        --running;
+        continue;
       }
+      BackwardThreadPool()->RunAndGetException([&, ready_op] {
+        run(ready_op);
+        std::lock_guard<std::mutex> guard(mutex);
+        --running;
+        finished.notify_all();
+      });
     }
   }
 
@@ -119,6 +222,7 @@ class Autograd {
 
 framework::LoDTensor& VarBase::GradValue() {
   VLOG(3) << "get var grad " << var_desc_->Name();
+  GetEngine()->Sync();
   return *(grads_->var_->GetMutable<framework::LoDTensor>());
 }
 
@@ -149,7 +253,10 @@ std::map<std::string, std::vector<VarBase*>> OpBase::ApplyGrad() {
 
     // No need to do compile time infer shape here.
     // grad_op_desc_->InferShape(*block_);
-    grad_op_desc_->InferVarType(block_);
+    {
+      std::lock_guard<std::mutex> guard(grad_mutex_);
+      grad_op_desc_->InferVarType(block_);
+    }
 
     std::unique_ptr<framework::OperatorBase> opbase =
         framework::OpRegistry::CreateOp(*grad_op_desc_);
@@ -164,6 +271,7 @@ std::map<std::string, std::vector<VarBase*>> OpBase::ApplyGrad() {
     p.func(framework::ExecutionContext(p.op, scope, *p.dev_ctx, p.ctx));
   }
 
+  std::lock_guard<std::mutex> guard(grad_mutex_);
   for (auto it : grad_output_vars_) {
     auto& outputs = grad_outputs[it.first];
     auto& origin_outputs = it.second;
@@ -183,6 +291,8 @@ void VarBase::RunBackward() {
   if (!pre_op_) return;
 
   VLOG(3) << "start backward";
+  // Wait for the forward ops.
+  GetEngine()->Sync();
   auto grads_t = grads_->var_->GetMutable<framework::LoDTensor>();
   float* data = grads_t->mutable_data<float>(platform::CPUPlace());
   std::fill(data, data + grads_t->numel(), 1.0);
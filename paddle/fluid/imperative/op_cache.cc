@@ -0,0 +1,240 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/imperative/op_cache.h"
+#include <cctype>
+#include <cstring>
+#include <functional>
+#include <utility>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_info.h"
+#include "paddle/fluid/framework/selected_rows.h"
+
+namespace paddle {
+namespace imperative {
+
+namespace {
+
+constexpr char kPlaceholderPrefix[] = "@IMPERATIVE_VAR@";
+
+void HashCombine(size_t* seed, size_t hash) {
+  *seed ^= hash + 0x9e3779b9 + (*seed << 6) + (*seed >> 2);
+}
+
+struct AttributeHasher : public boost::static_visitor<size_t> {
+  size_t operator()(const boost::blank&) const { return 0; }
+
+  size_t operator()(framework::BlockDesc* block) const {
+    return std::hash<framework::BlockDesc*>()(block);
+  }
+
+  template <typename T>
+  size_t operator()(const T& value) const {
+    return std::hash<T>()(value);
+  }
+
+  template <typename T>
+  size_t operator()(const std::vector<T>& values) const {
+    size_t seed = values.size();
+    for (auto value : values) {
+      HashCombine(&seed, (*this)(static_cast<T>(value)));
+    }
+    return seed;
+  }
+};
+
+template <typename T>
+void AppendBytes(std::string* key, const T& value) {
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  key->append(bytes, sizeof(T));
+}
+
+}  // namespace
+
+size_t HashAttributeMap(const framework::AttributeMap& attrs) {
+  // The sum does not depend on the order of the iteration.
+  size_t hash = attrs.size();
+  for (auto& attr : attrs) {
+    size_t seed = std::hash<std::string>()(attr.first);
+    HashCombine(&seed, boost::apply_visitor(AttributeHasher(), attr.second));
+    hash += seed;
+  }
+  return hash;
+}
+
+KernelCache& KernelCache::Instance() {
+  static KernelCache cache;
+  return cache;
+}
+
+bool KernelCache::Get(const std::string& key,
+                      framework::OperatorWithKernel::OpKernelFunc* func) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = kernels_.find(key);
+  if (it == kernels_.end()) return false;
+  *func = it->second;
+  return true;
+}
+
+void KernelCache::Set(const std::string& key,
+                      const framework::OperatorWithKernel::OpKernelFunc& func) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  kernels_[key] = func;
+}
+
+std::string KernelCache::Key(const framework::OperatorBase& op,
+                             const framework::RuntimeContext& ctx,
+                             const platform::Place& place) {
+  std::string key = op.Type();
+  key.push_back('\0');
+  AppendBytes(&key, HashAttributeMap(op.Attrs()));
+  AppendBytes(&key, place.which());
+  if (platform::is_gpu_place(place)) {
+    AppendBytes(&key, boost::get<platform::CUDAPlace>(place).GetDeviceId());
+  }
+  for (auto& input : ctx.inputs) {
+    key.append(input.first);
+    key.push_back('\0');
+    for (auto* var : input.second) {
+      const framework::Tensor* tensor = nullptr;
+      if (var && var->IsType<framework::LoDTensor>()) {
+        tensor = &var->Get<framework::LoDTensor>();
+      } else if (var && var->IsType<framework::SelectedRows>()) {
+        tensor = &var->Get<framework::SelectedRows>().value();
+      }
+      int type = -1;
+      int layout = -1;
+      int tensor_place = -1;
+      if (tensor && tensor->IsInitialized()) {
+        type = static_cast<int>(tensor->type());
+        layout = static_cast<int>(tensor->layout());
+        tensor_place = tensor->place().which();
+      }
+      AppendBytes(&key, type);
+      AppendBytes(&key, layout);
+      AppendBytes(&key, tensor_place);
+    }
+  }
+  return key;
+}
+
+GradOpCache& GradOpCache::Instance() {
+  static GradOpCache cache;
+  return cache;
+}
+
+std::unique_ptr<framework::OpDesc> GradOpCache::CreateGradOp(
+    const framework::OpDesc& op_desc,
+    const std::vector<framework::BlockDesc*>& grad_sub_block,
+    std::unordered_map<std::string, std::string>* grad_to_var) {
+  const framework::AttributeMap& attrs = op_desc.GetAttrMap();
+  for (auto& attr : attrs) {
+    if (attr.second.type() == typeid(framework::BlockDesc*) ||
+        attr.second.type() == typeid(std::vector<framework::BlockDesc*>)) {
+      return nullptr;
+    }
+  }
+
+  // The variables are numbered in the order of their first appearance, the
+  // key records the numbers of every argument, so the ops with the same
+  // variable in several arguments have their own templates.
+  std::unordered_map<std::string, size_t> indices;
+  std::vector<std::string> names;
+  std::string key = op_desc.Type();
+  key.push_back('\0');
+  auto add_vars = [&](const framework::VariableNameMap& vars) {
+    for (auto& param : vars) {
+      key.append(param.first);
+      key.push_back('\0');
+      AppendBytes(&key, param.second.size());
+      for (auto& name : param.second) {
+        auto it = indices.emplace(name, names.size());
+        if (it.second) names.push_back(name);
+        AppendBytes(&key, it.first->second);
+      }
+    }
+    key.push_back('\0');
+  };
+  add_vars(op_desc.Inputs());
+  add_vars(op_desc.Outputs());
+  AppendBytes(&key, HashAttributeMap(attrs));
+
+  auto to_placeholders = [&](const framework::VariableNameMap& vars) {
+    framework::VariableNameMap placeholders;
+    for (auto& param : vars) {
+      auto& args = placeholders[param.first];
+      for (auto& name : param.second) {
+        args.push_back(kPlaceholderPrefix + std::to_string(indices[name]));
+      }
+    }
+    return placeholders;
+  };
+  // A placeholder or a name derived from it, e.g. its grad.
+  auto from_placeholder = [&](const std::string& name) {
+    size_t prefix_len = sizeof(kPlaceholderPrefix) - 1;
+    if (name.compare(0, prefix_len, kPlaceholderPrefix) != 0) return name;
+    size_t end = prefix_len;
+    while (end < name.size() && std::isdigit(name[end])) ++end;
+    if (end == prefix_len) return name;
+    size_t index = std::stoul(name.substr(prefix_len, end - prefix_len));
+    if (index >= names.size()) return name;
+    return names[index] + name.substr(end);
+  };
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  Template& entry = templates_[key];
+  // The attributes are compared to be safe from the hash collisions.
+  if (!entry.grad_op_desc || entry.attrs != attrs) {
+    framework::OpDesc fwd_op_desc(op_desc.Type(),
+                                  to_placeholders(op_desc.Inputs()),
+                                  to_placeholders(op_desc.Outputs()), attrs);
+    std::unordered_map<std::string, std::string> template_grad_to_var;
+    std::vector<std::unique_ptr<framework::OpDesc>> grad_op_descs =
+        framework::OpInfoMap::Instance()
+            .Get(op_desc.Type())
+            .GradOpMaker()(fwd_op_desc, {}, &template_grad_to_var,
+                           grad_sub_block);
+    PADDLE_ENFORCE(grad_op_descs.size() == 1, "Only support 1 grad op now.");
+    entry.attrs = attrs;
+    entry.grad_op_desc = std::move(grad_op_descs[0]);
+    entry.grad_to_var = std::move(template_grad_to_var);
+  }
+
+  std::unique_ptr<framework::OpDesc> grad_op_desc(
+      new framework::OpDesc(*entry.grad_op_desc, nullptr));
+  for (auto& param : entry.grad_op_desc->Inputs()) {
+    std::vector<std::string> args;
+    for (auto& name : param.second) {
+      args.push_back(from_placeholder(name));
+    }
+    grad_op_desc->SetInput(param.first, args);
+  }
+  for (auto& param : entry.grad_op_desc->Outputs()) {
+    std::vector<std::string> args;
+    for (auto& name : param.second) {
+      args.push_back(from_placeholder(name));
+    }
+    grad_op_desc->SetOutput(param.first, args);
+  }
+  for (auto& item : entry.grad_to_var) {
+    (*grad_to_var)[from_placeholder(item.first)] =
+        from_placeholder(item.second);
+  }
+  return grad_op_desc;
+}
+
+}  // namespace imperative
+}  // namespace paddle
@@ -0,0 +1,85 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/op_desc.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/type_defs.h"
+
+namespace paddle {
+namespace imperative {
+
+// The attributes of the same values have the same hash.
+size_t HashAttributeMap(const framework::AttributeMap& attrs);
+
+/* The kernels chosen by PreparedOp::Prepare, keyed by the op type, the
+ * attributes, the place and the data types and layouts of the inputs, which
+ * decide the expected kernel type of an op.
+ */
+class KernelCache {
+ public:
+  static KernelCache& Instance();
+
+  // Return false if the kernel of the key is not cached.
+  bool Get(const std::string& key,
+           framework::OperatorWithKernel::OpKernelFunc* func) const;
+  void Set(const std::string& key,
+           const framework::OperatorWithKernel::OpKernelFunc& func);
+
+  static std::string Key(const framework::OperatorBase& op,
+                         const framework::RuntimeContext& ctx,
+                         const platform::Place& place);
+
+ private:
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, framework::OperatorWithKernel::OpKernelFunc>
+      kernels_;
+};
+
+/* The grad op descs created by the GradOpDescMakers. The maker runs once for
+ * the ops of the same type, attributes and variable layout, on an op desc in
+ * which the variables are replaced with placeholders, and the grad op desc
+ * of an op is the template with the placeholders replaced with its variables.
+ */
+class GradOpCache {
+ public:
+  static GradOpCache& Instance();
+
+  // Create the grad op desc of op_desc as the GradOpDescMaker, return nullptr
+  // if the op can not be cached, e.g. an op with sub-blocks.
+  std::unique_ptr<framework::OpDesc> CreateGradOp(
+      const framework::OpDesc& op_desc,
+      const std::vector<framework::BlockDesc*>& grad_sub_block,
+      std::unordered_map<std::string, std::string>* grad_to_var);
+
+ private:
+  struct Template {
+    framework::AttributeMap attrs;
+    std::unique_ptr<framework::OpDesc> grad_op_desc;
+    std::unordered_map<std::string, std::string> grad_to_var;
+  };
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, Template> templates_;
+};
+
+}  // namespace imperative
+}  // namespace paddle
@@ -14,6 +14,11 @@
 
 #include "paddle/fluid/imperative/tracer.h"
 
+#include <memory>
+#include <utility>
+
+#include "paddle/fluid/imperative/op_cache.h"
+
 namespace paddle {
 namespace imperative {
 
@@ -22,6 +27,16 @@ void CreateGradOp(const framework::OpDesc& op_desc,
                   const std::vector<framework::BlockDesc*>& grad_sub_block,
                   framework::OpDesc** grad_op_desc,
                   std::unordered_map<std::string, std::string>* grad_to_var) {
+  if (no_grad_set.empty()) {
+    std::unique_ptr<framework::OpDesc> grad_op =
+        GradOpCache::Instance().CreateGradOp(op_desc, grad_sub_block,
+                                             grad_to_var);
+    if (grad_op) {
+      *grad_op_desc = grad_op.release();
+      return;
+    }
+  }
+
   std::vector<std::unique_ptr<framework::OpDesc>> grad_op_descs =
       framework::OpInfoMap::Instance()
           .Get(op_desc.Type())
@@ -48,6 +63,9 @@ void Tracer::Trace(OpBase* op, const VarBasePtrMap& inputs,
   VLOG(3) << "tracer tracing " << op_desc->Type();
   op_desc->InferShape(*block);
   op_desc->InferVarType(block);
+  if (observer_) {
+    observer_->OnTrace(op_desc, inputs, outputs);
+  }
   std::unique_ptr<framework::OperatorBase> op_base =
       framework::OpRegistry::CreateOp(*op_desc);
 
@@ -99,20 +117,13 @@ void Tracer::Trace(OpBase* op, const VarBasePtrMap& inputs,
     }
   }
 
-  VLOG(3) << "tracer running " << op_desc->Type();
-  framework::RuntimeContext ctx(invars_map, outvars_map);
-
   // TODO(panyx0718): Cache p.
   framework::OperatorWithKernel* op_kernel =
       dynamic_cast<framework::OperatorWithKernel*>(op_base.get());
   PADDLE_ENFORCE_NOT_NULL(op_kernel, "only support op with kernel");
 
-  framework::Scope scope;
-  platform::CPUPlace place;
-  PreparedOp p = PreparedOp::Prepare(ctx, *op_kernel, place);
-  p.op.RuntimeInferShape(scope, place, ctx);
-  p.func(framework::ExecutionContext(p.op, scope, *p.dev_ctx, p.ctx));
-
+  // The grads are initialized with the shapes of the vars after the op runs.
+  std::vector<std::pair<framework::Variable*, framework::Variable*>> init_grads;
   if (!stop_gradient) {
     framework::OpDesc* grad_op_desc;
     // TODO(panyx): Is this leaked?
@@ -133,9 +144,7 @@ void Tracer::Trace(OpBase* op, const VarBasePtrMap& inputs,
           grad_in_vars.push_back(fwd_var_it->second->var_);
         } else {
           VarBase* var = vars[var_it->second];
-          if (!var->grads_->var_->IsInitialized()) {
-            InitVar(var->var_, var->grads_->var_);
-          }
+          init_grads.emplace_back(var->var_, var->grads_->var_);
           // Douts.
           grad_in_vars.push_back(var->grads_->var_);
         }
@@ -149,14 +158,32 @@ void Tracer::Trace(OpBase* op, const VarBasePtrMap& inputs,
         auto var_it = grad_to_var->find(grad_outvar);
         PADDLE_ENFORCE(var_it != grad_to_var->end());
         VarBase* var = vars[var_it->second];
-        if (!var->grads_->var_->IsInitialized()) {
-          InitVar(var->var_, var->grads_->var_);
-        }
+        init_grads.emplace_back(var->var_, var->grads_->var_);
         grad_out_vars.push_back(var->grads_->var_);
       }
     }
   }
 
+  // The op runs on the engine, and the python thread goes on tracing.
+  std::shared_ptr<framework::OperatorBase> shared_op(std::move(op_base));
+  GetEngine()->Enqueue(new Runnable([shared_op, op_kernel, invars_map,
+                                     outvars_map, init_grads] {
+    VLOG(3) << "tracer running " << shared_op->Type();
+    framework::RuntimeContext ctx(invars_map, outvars_map);
+
+    framework::Scope scope;
+    platform::CPUPlace place;
+    PreparedOp p = PreparedOp::Prepare(ctx, *op_kernel, place);
+    p.op.RuntimeInferShape(scope, place, ctx);
+    p.func(framework::ExecutionContext(p.op, scope, *p.dev_ctx, p.ctx));
+
+    for (auto& init_grad : init_grads) {
+      if (!init_grad.second->IsInitialized()) {
+        InitVar(init_grad.first, init_grad.second);
+      }
+    }
+  }));
+
   op->block_ = block;
 }
 
@@ -164,6 +191,11 @@ std::vector<VarBase*> Tracer::PyTrace(OpBase* op,
                                       const std::vector<VarBase*>& inputs,
                                       bool stop_gradient) {
   VLOG(3) << "py_trace";
+  // The python function reads the values of the inputs.
+  GetEngine()->Sync();
+  if (observer_) {
+    observer_->OnTrace(nullptr, {{"X", inputs}}, {});
+  }
   op->input_vars_["X"] = inputs;
   op->output_vars_["Out"] = PyLayer::Apply(op->forward_id_, inputs);
   for (VarBase* inp : inputs) {
@@ -34,6 +34,18 @@ void CreateGradOp(const framework::OpDesc& op_desc,
 
 void InitVar(framework::Variable* var, framework::Variable* grad_var);
 
+// Observe the traced ops, e.g. to record them into a program.
+class TraceObserver {
+ public:
+  virtual ~TraceObserver() {}
+
+  // The op_desc is nullptr for the ops without an op desc, e.g. the python
+  // layers.
+  virtual void OnTrace(const framework::OpDesc* op_desc,
+                       const VarBasePtrMap& inputs,
+                       const VarBasePtrMap& outputs) = 0;
+};
+
 class Tracer {
  public:
   explicit Tracer(framework::BlockDesc* root_block) : root_block_(root_block) {}
@@ -48,8 +60,12 @@ class Tracer {
   std::vector<VarBase*> PyTrace(OpBase* op, const std::vector<VarBase*>& inputs,
                                 bool stop_gradient = false);
 
+  // The observer is not owned, nullptr to stop observing.
+  void SetObserver(TraceObserver* observer) { observer_ = observer; }
+
  private:
   framework::BlockDesc* root_block_;
+  TraceObserver* observer_{nullptr};
 };
 
 }  // namespace imperative
@@ -24,6 +24,8 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include "paddle/fluid/framework/ir/graph.h"
 #include "paddle/fluid/framework/program_desc.h"
@@ -46,6 +48,8 @@ struct Argument {
 
   using unique_ptr_t = std::unique_ptr<void, std::function<void(void*)>>;
   using fusion_statis_t = std::unordered_map<std::string, int>;
+  using var_lifetimes_t =
+      std::unordered_map<std::string, std::pair<int, int>>;
 
   bool Has(const std::string& key) const { return valid_fields_.count(key); }
 
@@ -126,6 +130,16 @@ struct Argument {
   DECL_ARGUMENT_FIELD(tensorrt_max_batch_size, TensorRtMaxBatchSize, int);
   DECL_ARGUMENT_FIELD(tensorrt_workspace_size, TensorRtWorkspaceSize, int);
   DECL_ARGUMENT_FIELD(tensorrt_min_subgraph_size, TensorRtMinSubgraphSize, int);
+  DECL_ARGUMENT_FIELD(tensorrt_engine_cache_dir, TensorRtEngineCacheDir,
+                      std::string);
+  DECL_ARGUMENT_FIELD(tensorrt_precision_mode, TensorRtPrecisionMode, int);
+  DECL_ARGUMENT_FIELD(tensorrt_calibration_batch_num,
+                      TensorRtCalibrationBatchNum, int);
+  DECL_ARGUMENT_FIELD(tensorrt_max_shape_engines, TensorRtMaxShapeEngines,
+                      int);
+
+  DECL_ARGUMENT_FIELD(sparse_weight_min_sparsity, SparseWeightMinSparsity,
+                      float);
 
   // The program transformed by IR analysis phase.
   DECL_ARGUMENT_UNIQUE_FIELD(ir_analyzed_program, IrAnalyzedProgram,
@@ -133,6 +147,13 @@ struct Argument {
 
   DECL_ARGUMENT_FIELD(fusion_statis, FusionStatis, fusion_statis_t);
 
+  // Plan the memory of the temporary variables in a single arena.
+  DECL_ARGUMENT_FIELD(static_memory_plan, StaticMemoryPlan, bool);
+  // The indices of the first and last ops using the temporary variables, set
+  // by memory_plan_pass.
+  DECL_ARGUMENT_FIELD(memory_plan_lifetimes, MemoryPlanLifetimes,
+                      var_lifetimes_t);
+
  private:
   std::unordered_set<std::string> valid_fields_;
 };
@@ -13,7 +13,10 @@
 // limitations under the License.
 
 #include "paddle/fluid/inference/analysis/ir_pass_manager.h"
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <string>
+#include <utility>
 #include <vector>
 #include "paddle/fluid/framework/ir/fuse_pass_base.h"
 #include "paddle/fluid/framework/ir/graph.h"
@@ -62,11 +65,33 @@ void IRPassManager::CreatePasses(Argument *argument,
                     argument->mkldnn_enabled_op_types()));
     }
 
+    if (pass_name == "sparse_weight_pass" &&
+        argument->sparse_weight_min_sparsity_valid()) {
+      pass->Set("min_sparsity",
+                new float(argument->sparse_weight_min_sparsity()));
+    }
+
     if (pass_name == "tensorrt_subgraph_pass") {
       pass->Set("workspace_size", new int(argument->tensorrt_workspace_size()));
       pass->Set("max_batch_size", new int(argument->tensorrt_max_batch_size()));
       pass->Set("min_subgraph_size",
                 new int(argument->tensorrt_min_subgraph_size()));
+      pass->Set("engine_cache_dir",
+                new std::string(argument->tensorrt_engine_cache_dir_valid()
+                                    ? argument->tensorrt_engine_cache_dir()
+                                    : ""));
+      pass->Set("precision_mode",
+                new int(argument->tensorrt_precision_mode_valid()
+                            ? argument->tensorrt_precision_mode()
+                            : 0));
+      pass->Set("calibration_batch_num",
+                new int(argument->tensorrt_calibration_batch_num_valid()
+                            ? argument->tensorrt_calibration_batch_num()
+                            : 0));
+      pass->Set("max_shape_engines",
+                new int(argument->tensorrt_max_shape_engines_valid()
+                            ? argument->tensorrt_max_shape_engines()
+                            : 1));
     }
 
     // graph_ = pass->Apply(std::move(graph_));
@@ -82,9 +107,29 @@ std::unique_ptr<Graph> IRPassManager::Apply(std::unique_ptr<Graph> graph) {
   }
   PADDLE_ENFORCE(graph.get());
   // Apply all the passes
+  std::vector<std::pair<double, std::string>> pass_ms;
+  double total_ms = 0;
   for (const auto &pass : passes_) {
     PrettyLogEndl(Style::H2(), "--- Running IR pass [%s]", pass->Type());
+    auto start = std::chrono::steady_clock::now();
     graph = pass->Apply(std::move(graph));
+    std::chrono::duration<double, std::milli> ms =
+        std::chrono::steady_clock::now() - start;
+    pass_ms.emplace_back(ms.count(), pass->Type());
+    total_ms += ms.count();
+  }
+
+  // Report the time of the passes, the slowest first.
+  std::stable_sort(pass_ms.begin(), pass_ms.end(),
+                   [](const std::pair<double, std::string> &a,
+                      const std::pair<double, std::string> &b) {
+                     return a.first > b.first;
+                   });
+  PrettyLogEndl(Style::H2(), "--- IR passes took %.2f ms on %d nodes",
+                total_ms, graph->Nodes().size());
+  for (auto &item : pass_ms) {
+    PrettyLogEndl(Style::detail(), "---  %-40s %10.2f ms", item.second,
+                  item.first);
   }
   return std::move(graph);
 }
@@ -12,7 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <sys/stat.h>
 #include <algorithm>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -31,6 +33,38 @@ using framework::ir::Node;
 std::vector<std::string> ExtractParameters(
     const std::unordered_set<Node *> &nodes);
 
+// The key of the subgraph to cache the serialized TensorRT engine, which
+// should be the same between runs of the same model. So the original op
+// descs are used rather than the renamed ones, for the node ids may change.
+std::string GenerateEngineKey(const std::vector<Node *> &subgraph,
+                              const std::unordered_set<std::string> &inputs,
+                              const std::unordered_set<std::string> &outputs,
+                              int max_batch_size, int workspace_size,
+                              int precision_mode) {
+  std::vector<std::string> items;
+  for (auto *node : subgraph) {
+    items.push_back(node->Op()->Proto()->SerializeAsString());
+  }
+  // The variable names keep the connections of the ops, so that the order
+  // of the ops does not matter.
+  std::sort(items.begin(), items.end());
+  for (auto *names : {&inputs, &outputs}) {
+    std::vector<std::string> sorted_names(names->begin(), names->end());
+    std::sort(sorted_names.begin(), sorted_names.end());
+    items.insert(items.end(), sorted_names.begin(), sorted_names.end());
+    items.push_back("|");
+  }
+  items.push_back(std::to_string(max_batch_size));
+  items.push_back(std::to_string(workspace_size));
+  items.push_back(std::to_string(precision_mode));
+
+  std::string key;
+  for (auto &item : items) {
+    key += std::to_string(item.size()) + ":" + item;
+  }
+  return std::to_string(std::hash<std::string>()(key));
+}
+
 std::unique_ptr<framework::ir::Graph> analysis::TensorRtSubgraphPass::ApplyImpl(
 
     std::unique_ptr<framework::ir::Graph> graph) const {
@@ -197,6 +231,30 @@ void TensorRtSubgraphPass::CreateTensorRTOp(framework::ir::Node *node,
           block_desc.Proto()->SerializeAsString());
   SetAttr(op_desc->Proto(), "max_batch_size", Get<int>("max_batch_size"));
   SetAttr(op_desc->Proto(), "workspace_size", Get<int>("workspace_size"));
+  int precision_mode = Has("precision_mode") ? Get<int>("precision_mode") : 0;
+  SetAttr(op_desc->Proto(), "precision_mode", precision_mode);
+  if (Has("calibration_batch_num")) {
+    SetAttr(op_desc->Proto(), "calibration_batch_num",
+            Get<int>("calibration_batch_num"));
+  }
+  if (Has("max_shape_engines")) {
+    SetAttr(op_desc->Proto(), "max_shape_engines",
+            Get<int>("max_shape_engines"));
+  }
+  std::string cache_dir =
+      Has("engine_cache_dir") ? Get<std::string>("engine_cache_dir") : "";
+  if (!cache_dir.empty()) {
+    if (!PathExists(cache_dir)) {
+      PADDLE_ENFORCE_NE(mkdir(cache_dir.c_str(), 0755), -1,
+                        "Can not create the TensorRT engine cache directory %s",
+                        cache_dir);
+    }
+    SetAttr(op_desc->Proto(), "engine_cache_dir", cache_dir);
+    SetAttr(op_desc->Proto(), "engine_key",
+            GenerateEngineKey(subgraph, input_names, output_names,
+                              Get<int>("max_batch_size"),
+                              Get<int>("workspace_size"), precision_mode));
+  }
   SetAttr(op_desc->Proto(), "parameters", ExtractParameters(graph->Nodes()));
   SetAttr(op_desc->Proto(), "output_name_mapping", output_mapping);
 }
@@ -38,7 +38,7 @@ std::string IrAnalysisComposePass::repr() const {
 void IrAnalysisComposePass::ApplyIrPasses(Argument *argument) {
   std::vector<std::string> passes({
       "ir_graph_build_pass", "ir_analysis_pass",
-      "ir_params_sync_among_devices_pass",
+      "ir_params_sync_among_devices_pass", "memory_plan_pass",
   });
   for (const auto &pass : passes) {
     VLOG(2) << "Run pass " << pass;
@@ -0,0 +1,106 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/analysis/passes/memory_plan_pass.h"
+#include <algorithm>
+#include <string>
+#include <unordered_set>
+#include "paddle/fluid/framework/framework.pb.h"
+
+namespace paddle {
+namespace inference {
+namespace analysis {
+
+using framework::proto::VarType;
+
+void MemoryPlanPass::RunImpl(Argument *argument) {
+  if (!argument->static_memory_plan_valid() ||
+      !argument->static_memory_plan()) {
+    return;
+  }
+  ARGUMENT_CHECK_FIELD(argument, ir_analyzed_program);
+  auto &program = argument->ir_analyzed_program();
+  auto &block = program.blocks(0);
+
+  std::unordered_set<std::string> candidates;
+  for (auto &var : block.vars()) {
+    if (!var.persistable() && var.type().type() == VarType::LOD_TENSOR) {
+      candidates.insert(var.name());
+    }
+  }
+  // The variables used by the sub-blocks may be alive across the iterations.
+  for (int i = 1; i < program.blocks_size(); ++i) {
+    for (auto &op : program.blocks(i).ops()) {
+      for (auto &var : op.inputs()) {
+        for (auto &name : var.arguments()) candidates.erase(name);
+      }
+      for (auto &var : op.outputs()) {
+        for (auto &name : var.arguments()) candidates.erase(name);
+      }
+    }
+  }
+
+  Argument::var_lifetimes_t lifetimes;
+  std::unordered_set<std::string> excluded;
+  int op_idx = -1;
+  for (auto &op : block.ops()) {
+    if (op.type() == "feed" || op.type() == "fetch") {
+      // The inputs are written outside, and the outputs are read outside.
+      for (auto &var : op.inputs()) {
+        for (auto &name : var.arguments()) excluded.insert(name);
+      }
+      for (auto &var : op.outputs()) {
+        for (auto &name : var.arguments()) excluded.insert(name);
+      }
+      continue;
+    }
+    ++op_idx;
+    for (auto &var : op.inputs()) {
+      for (auto &name : var.arguments()) {
+        if (!candidates.count(name)) continue;
+        auto it = lifetimes.find(name);
+        if (it == lifetimes.end()) {
+          // Read before written, it keeps the value of the last run.
+          excluded.insert(name);
+        } else {
+          it->second.second = op_idx;
+        }
+      }
+    }
+    for (auto &var : op.outputs()) {
+      for (auto &name : var.arguments()) {
+        if (!candidates.count(name)) continue;
+        auto it = lifetimes.find(name);
+        if (it == lifetimes.end()) {
+          lifetimes.emplace(name, std::make_pair(op_idx, op_idx));
+        } else {
+          it->second.second = op_idx;
+        }
+      }
+    }
+  }
+  for (auto &name : excluded) {
+    lifetimes.erase(name);
+  }
+
+  VLOG(3) << "Plan the memory of " << lifetimes.size()
+          << " temporary variables";
+  argument->SetMemoryPlanLifetimes(lifetimes);
+}
+
+std::string MemoryPlanPass::repr() const { return "memory-plan-pass"; }
+
+}  // namespace analysis
+}  // namespace inference
+}  // namespace paddle
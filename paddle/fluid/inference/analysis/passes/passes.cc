@@ -17,6 +17,7 @@
 #include "paddle/fluid/inference/analysis/passes/ir_analysis_pass.h"
 #include "paddle/fluid/inference/analysis/passes/ir_graph_build_pass.h"
 #include "paddle/fluid/inference/analysis/passes/ir_params_sync_among_devices_pass.h"
+#include "paddle/fluid/inference/analysis/passes/memory_plan_pass.h"
 
 namespace paddle {
 namespace inference {
@@ -31,6 +32,8 @@ PassRegistry::PassRegistry() {
   passes_.emplace(
       "ir_params_sync_among_devices_pass",
       std::unique_ptr<AnalysisPass>(new IrParamsSyncAmongDevicesPass));
+  passes_.emplace("memory_plan_pass",
+                  std::unique_ptr<AnalysisPass>(new MemoryPlanPass));
 }
 
 }  // namespace analysis
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/inference/api/paddle_analysis_config.h"
@@ -77,26 +78,51 @@ contrib::AnalysisConfig::AnalysisConfig(const contrib::AnalysisConfig &other) {
   CP_MEMBER(params_file_);
   CP_MEMBER(model_from_memory_);  // the memory model reuses prog_file_ and
                                   // params_file_ fields.
+  CP_MEMBER(mmap_params_);
+  CP_MEMBER(params_sharing_);
+  CP_MEMBER(optim_cache_dir_);
   // Gpu releated.
   CP_MEMBER(use_gpu_);
   CP_MEMBER(device_id_);
   CP_MEMBER(memory_pool_init_size_mb_);
+  CP_MEMBER(cudnn_algo_cache_file_);
   // TensorRT releated.
   CP_MEMBER(use_tensorrt_);
   CP_MEMBER(tensorrt_workspace_size_);
   CP_MEMBER(tensorrt_max_batchsize_);
   CP_MEMBER(tensorrt_min_subgraph_size_);
+  CP_MEMBER(tensorrt_engine_cache_dir_);
+  CP_MEMBER(tensorrt_precision_mode_);
+  CP_MEMBER(tensorrt_calibration_batch_num_);
+  CP_MEMBER(tensorrt_max_shape_engines_);
   // MKLDNN releated.
   CP_MEMBER(use_mkldnn_);
   CP_MEMBER(mkldnn_enabled_op_types_);
+  CP_MEMBER(use_mkldnn_quantizer_);
+  CP_MEMBER(mkldnn_quantizer_config_);
+  CP_MEMBER(mkldnn_cache_capacity_);
 
   // Ir related.
   CP_MEMBER(enable_ir_optim_);
   CP_MEMBER(use_feed_fetch_ops_);
   CP_MEMBER(ir_debug_);
+  CP_MEMBER(use_static_memory_plan_);
+  CP_MEMBER(use_tensor_capacity_policy_);
+  CP_MEMBER(tensor_shrink_after_);
+  CP_MEMBER(use_cuda_graph_);
+  CP_MEMBER(cuda_graph_max_shapes_);
+  CP_MEMBER(use_sparse_weights_);
+  CP_MEMBER(sparse_weight_min_sparsity_);
   CP_MEMBER(specify_input_name_);
+  CP_MEMBER(state_vars_);
 
   CP_MEMBER(cpu_math_library_num_threads_);
+  CP_MEMBER(use_numa_binding_);
+  CP_MEMBER(numa_node_);
+  CP_MEMBER(numa_params_replica_);
+  CP_MEMBER(use_shared_compute_pool_);
+  CP_MEMBER(compute_pool_max_threads_);
+  CP_MEMBER(compute_priority_);
 
   CP_MEMBER(serialized_info_cache_);
 
@@ -121,12 +147,40 @@ void contrib::AnalysisConfig::EnableMKLDNN() {
 #endif
 }
 
+void contrib::AnalysisConfig::EnableMkldnnQuantizer() {
+#ifdef PADDLE_WITH_MKLDNN
+  if (!mkldnn_quantizer_config_) {
+    mkldnn_quantizer_config_.reset(new MkldnnQuantizerConfig());
+  }
+  use_mkldnn_quantizer_ = true;
+  pass_builder()->DeletePass("inplace_op_pass");
+#else
+  LOG(ERROR) << "Please compile with MKLDNN first to use MkldnnQuantizer";
+  use_mkldnn_quantizer_ = false;
+#endif
+}
+
+void contrib::AnalysisConfig::SetMkldnnCacheCapacity(int capacity) {
+  PADDLE_ENFORCE_GE(capacity, 0, "The capacity should not be negative.");
+  mkldnn_cache_capacity_ = capacity;
+}
+
+contrib::MkldnnQuantizerConfig *
+contrib::AnalysisConfig::mkldnn_quantizer_config() const {
+  PADDLE_ENFORCE_NOT_NULL(mkldnn_quantizer_config_,
+                          "MkldnnQuantizer was not enabled yet.");
+  return mkldnn_quantizer_config_.get();
+}
+
 void contrib::AnalysisConfig::EnableTensorRtEngine(int workspace_size,
                                                    int max_batch_size,
-                                                   int min_subgraph_size) {
+                                                   int min_subgraph_size,
+                                                   Precision precision) {
   use_tensorrt_ = true;
   tensorrt_workspace_size_ = workspace_size;
   tensorrt_max_batchsize_ = max_batch_size;
+  tensorrt_min_subgraph_size_ = min_subgraph_size;
+  tensorrt_precision_mode_ = precision;
   Update();
 }
 
@@ -164,25 +218,53 @@ void contrib::AnalysisConfig::Update() {
 #endif
   }
 
+  if (use_mkldnn_quantizer_) {
+    if (!use_mkldnn_) {
+      LOG(ERROR) << "EnableMkldnnQuantizer() only works with EnableMKLDNN().";
+    }
+    pass_builder()->DeletePass("inplace_op_pass");
+  }
+
+  if (use_sparse_weights_) {
+    if (use_gpu_) {
+      LOG(ERROR) << "EnableSparseWeights() only works on CPU.";
+    } else {
+      // The fc ops are fused before, and the ops are replaced before the
+      // analysis of the memory reuse.
+      auto& passes = pass_builder()->AllPasses();
+      auto it = std::find(passes.begin(), passes.end(), "is_test_pass");
+      pass_builder()->InsertPass(it - passes.begin(), "sparse_weight_pass");
+    }
+  }
+
   if (ir_debug_) {
     pass_builder()->TurnOnDebug();
   }
 }
 
-std::string contrib::AnalysisConfig::SerializeInfoCache() {
+std::string contrib::AnalysisConfig::SerializeInfoCache() const {
   std::stringstream ss;
   ss << use_gpu_;
   ss << memory_pool_init_size_mb_;
+  ss << cudnn_algo_cache_file_;
 
   ss << use_tensorrt_;
   ss << tensorrt_workspace_size_;
   ss << tensorrt_max_batchsize_;
+  ss << tensorrt_engine_cache_dir_;
+  ss << static_cast<int>(tensorrt_precision_mode_);
+  ss << tensorrt_calibration_batch_num_;
+  ss << tensorrt_max_shape_engines_;
 
   ss << use_mkldnn_;
+  ss << use_mkldnn_quantizer_;
   ss << enable_ir_optim_;
   ss << use_feed_fetch_ops_;
   ss << ir_debug_;
 
+  ss << use_sparse_weights_;
+  ss << sparse_weight_min_sparsity_;
+
   return ss.str();
 }
 
@@ -191,6 +273,36 @@ void contrib::AnalysisConfig::SetCpuMathLibraryNumThreads(
   cpu_math_library_num_threads_ = cpu_math_library_num_threads;
 }
 
+void contrib::AnalysisConfig::EnableNumaBinding(int numa_node,
+                                                bool replicate_params) {
+  use_numa_binding_ = true;
+  numa_node_ = numa_node;
+  numa_params_replica_ = replicate_params;
+}
+
+void contrib::AnalysisConfig::EnableSharedComputePool(
+    int max_threads, ComputePriority priority) {
+  PADDLE_ENFORCE_GT(max_threads, 0);
+  use_shared_compute_pool_ = true;
+  compute_pool_max_threads_ = max_threads;
+  compute_priority_ = priority;
+}
+
+void contrib::AnalysisConfig::EnableCUDAGraph(int max_shapes) {
+  PADDLE_ENFORCE_GT(max_shapes, 0);
+  use_cuda_graph_ = true;
+  cuda_graph_max_shapes_ = max_shapes;
+  use_static_memory_plan_ = true;
+}
+
+void contrib::AnalysisConfig::EnableSparseWeights(float min_sparsity) {
+  PADDLE_ENFORCE(min_sparsity > 0.f && min_sparsity <= 1.f,
+                 "The min_sparsity should be in (0, 1].");
+  use_sparse_weights_ = true;
+  sparse_weight_min_sparsity_ = min_sparsity;
+  Update();
+}
+
 float contrib::AnalysisConfig::fraction_of_gpu_memory_for_pool() const {
 #ifdef PADDLE_WITH_CUDA
   // Get the GPU memory details and calculate the fraction of memory for the
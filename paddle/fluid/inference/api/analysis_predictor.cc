@@ -15,8 +15,15 @@
 #include "paddle/fluid/inference/api/analysis_predictor.h"
 #include <glog/logging.h>
 #include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <memory>
+#include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "paddle/fluid/framework/feed_fetch_method.h"
 #include "paddle/fluid/framework/feed_fetch_type.h"
@@ -24,19 +31,33 @@
 #include "paddle/fluid/framework/ir/pass.h"
 #include "paddle/fluid/framework/naive_executor.h"
 #include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/framework/version.h"
 #include "paddle/fluid/inference/api/helper.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/inference/api/paddle_inference_pass.h"
+#include "paddle/fluid/inference/io.h"
 #if PADDLE_WITH_TENSORRT
 #include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
 #endif
+#ifdef PADDLE_WITH_MKLDNN
+#include "paddle/fluid/inference/api/mkldnn_quantizer.h"
+#endif
 #include "paddle/fluid/inference/utils/singleton.h"
 #include "paddle/fluid/memory/memcpy.h"
 #include "paddle/fluid/platform/cpu_helper.h"
+#include "paddle/fluid/platform/cudnn_algo_cache.h"
 #include "paddle/fluid/platform/gpu_info.h"
+#include "paddle/fluid/platform/numa.h"
+#include "paddle/fluid/platform/port.h"
 #include "paddle/fluid/platform/profiler.h"
 
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/fluid/memory/allocation/stream_safe_cuda_allocator.h"
+#endif
+
 DECLARE_bool(profile);
+DECLARE_int32(load_persistables_threads);
 
 namespace paddle {
 
@@ -51,6 +72,20 @@ bool IsPersistable(const framework::VarDesc *var) {
   }
   return false;
 }
+
+// The persistable LoDTensors of the optimized program in the cache, sorted to
+// have a consistent ordering in the combined file.
+std::vector<std::string> OptimCacheParams(framework::ProgramDesc *program) {
+  std::vector<std::string> params;
+  for (auto *var : program->MutableBlock(0)->AllVars()) {
+    if (IsPersistable(var) &&
+        var->GetType() == framework::proto::VarType::LOD_TENSOR) {
+      params.push_back(var->Name());
+    }
+  }
+  std::sort(params.begin(), params.end());
+  return params;
+}
 }  // namespace
 
 bool AnalysisPredictor::Init(
@@ -65,12 +100,42 @@ bool AnalysisPredictor::Init(
     platform::EnableProfiler(tracking_device);
   }
 
-  // no matter with or without MKLDNN
-  paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
+  // The parameters of the first predictor are loaded on its NUMA node.
+  if (!parent_scope && config_.numa_binding_enabled() && !config_.use_gpu()) {
+    numa_node_ = std::max(config_.numa_node(), 0);
+    BindNumaNode();
+  }
+
+  // The kernels sharing the compute pool run the math library in one thread.
+  if (config_.shared_compute_pool_enabled() && !config_.use_gpu()) {
+    if (!compute_quota_) {
+      compute_quota_.reset(new framework::ComputeQuota(
+          config_.compute_pool_max_threads(),
+          static_cast<framework::ComputePriority>(config_.compute_priority())));
+    }
+    paddle::platform::SetNumThreads(1);
+  } else {
+    // no matter with or without MKLDNN
+    paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
+  }
+
+  if (config_.tensor_capacity_policy_enabled()) {
+    // The planned buffers alias the arena, so they are never shrunk.
+    int shrink_after = config_.static_memory_plan_enabled()
+                           ? 0
+                           : config_.tensor_shrink_after();
+    tensor_capacity_policy_.reset(
+        new framework::TensorCapacityPolicy(shrink_after));
+  }
 
   if (!PrepareScope(parent_scope)) {
     return false;
   }
+  // The clones share the algorithms loaded by the first predictor.
+  if (config_.use_gpu() && !config_.cudnn_algo_cache_file().empty() &&
+      !status_is_cloned_) {
+    platform::CudnnAlgoCache::Instance().Load(config_.cudnn_algo_cache_file());
+  }
   if (!CreateExecutor()) {
     return false;
   }
@@ -86,6 +151,27 @@ bool AnalysisPredictor::Init(
   // Get the feed_target_names and fetch_target_names
   PrepareFeedFetch();
 
+  // The feed tensors of the zero-copy runs key the CUDA graphs.
+  if (config_.use_gpu() && config_.cuda_graph_enabled() &&
+      !config_.use_feed_fetch_ops_enabled()) {
+    std::vector<std::string> feed_names;
+    for (auto &pair : feed_names_) {
+      feed_names.push_back(pair.first);
+    }
+    executor_->EnableCUDAGraph(feed_names, config_.cuda_graph_max_shapes());
+  }
+
+#ifdef PADDLE_WITH_MKLDNN
+  // The program of a clone is already quantized.
+  if (config_.mkldnn_quantizer_enabled() && !status_is_cloned_) {
+    MkldnnQuantizer quantizer(this, config_.mkldnn_quantizer_config());
+    if (!quantizer.Quantize()) {
+      LOG(ERROR) << "Failed to quantize the program with MKL-DNN";
+      return false;
+    }
+  }
+#endif
+
   return true;
 }
 
@@ -115,7 +201,11 @@ bool AnalysisPredictor::PrepareProgram(
     // This will change the scope_ address.
     if (config_.ir_optim()) {
       status_ir_optim_enabled_ = true;
-      OptimizeInferenceProgram();
+      auto cache_dir = OptimCacheDir();
+      if (cache_dir.empty() || !LoadOptimCache(cache_dir)) {
+        OptimizeInferenceProgram();
+        if (!cache_dir.empty()) SaveOptimCache(cache_dir);
+      }
     } else {
       // If the parent_scope is passed, we assert that the persistable variables
       // are already created, so just create the no persistable variables.
@@ -144,6 +234,11 @@ bool AnalysisPredictor::CreateExecutor() {
   if (config_.use_gpu_) {
     status_use_gpu_ = true;
     place_ = paddle::platform::CUDAPlace(config_.device_id_);
+    // Create the CUDA context and the library handles while the program is
+    // loaded and optimized.
+    if (!status_is_cloned_) {
+      platform::DeviceContextPool::Instance().WarmUp({place_});
+    }
   } else {
     place_ = paddle::platform::CPUPlace();
   }
@@ -153,12 +248,50 @@ bool AnalysisPredictor::CreateExecutor() {
 bool AnalysisPredictor::PrepareExecutor() {
   executor_->Prepare(sub_scope_, *inference_program_, 0,
                      config_.use_feed_fetch_ops_);
+  if (config_.static_memory_plan_enabled() &&
+      !config_.mkldnn_quantizer_enabled()) {
+    // Each predictor has its own arena, even if it is cloned.
+    executor_->EnableMemoryPlan(memory_plan_lifetimes_);
+  }
 
   PADDLE_ENFORCE_NOT_NULL(sub_scope_);
 
   return true;
 }
 
+void AnalysisPredictor::BindNumaNode() {
+  // The thread is bound on its first run, the OpenMP threads of the math
+  // library it starts after that inherit the binding.
+  if (numa_node_ >= 0 && platform::GetCurrentThreadNumaNode() != numa_node_) {
+    platform::BindCurrentThreadToNumaNode(numa_node_);
+  }
+}
+
+std::shared_ptr<framework::Scope> AnalysisPredictor::GetNumaScope(int node) {
+  std::lock_guard<std::mutex> lock(numa_scopes_mutex_);
+  auto &replica = numa_scopes_[node];
+  if (replica) return replica;
+
+  replica.reset(new framework::Scope);
+  for (auto &name : scope_->LocalVarNames()) {
+    auto *var = scope_->FindLocalVar(name);
+    if (!var->IsType<framework::LoDTensor>()) {
+      LOG(WARNING) << "Cannot replicate the variable " << name
+                   << " to NUMA node " << node << ", share the parameters";
+      replica = scope_;
+      return replica;
+    }
+    auto &src = var->Get<framework::LoDTensor>();
+    auto *dst = replica->Var(name)->GetMutable<framework::LoDTensor>();
+    if (!src.IsInitialized()) continue;
+    framework::TensorCopySync(src, src.place(), dst);
+    dst->set_lod(src.lod());
+    platform::BindMemoryToNumaNode(dst->data<void>(), dst->memory_size(),
+                                   node);
+  }
+  return replica;
+}
+
 void AnalysisPredictor::SetMkldnnThreadID(int tid) {
 #ifdef PADDLE_WITH_MKLDNN
   platform::set_cur_thread_id(tid);
@@ -167,10 +300,37 @@ void AnalysisPredictor::SetMkldnnThreadID(int tid) {
 #endif
 }
 
+void AnalysisPredictor::SetMkldnnInputShape(framework::Scope *scope) {
+#ifdef PADDLE_WITH_MKLDNN
+  if (!config_.use_mkldnn_ || config_.mkldnn_cache_capacity_ <= 0) return;
+  std::ostringstream os;
+  for (auto *feed : feeds_) {
+    auto *var = scope->FindVar(feed->Output("Out")[0]);
+    if (var == nullptr || !var->IsType<framework::LoDTensor>()) continue;
+    os << var->Get<framework::LoDTensor>().dims() << ';';
+  }
+  platform::set_cur_input_shape_str(os.str());
+  platform::set_cur_input_shape_cache_capacity(config_.mkldnn_cache_capacity_);
+#endif
+}
+
 bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
                             std::vector<PaddleTensor> *output_data,
                             int batch_size) {
+  return RunWithContext(inputs, output_data, nullptr, batch_size);
+}
+
+bool AnalysisPredictor::RunWithContext(const std::vector<PaddleTensor> &inputs,
+                                       std::vector<PaddleTensor> *output_data,
+                                       PaddleRunContext *ctx, int batch_size) {
   VLOG(3) << "Predictor::predict";
+  // The stale requests are dropped before the feeds are copied.
+  if (ctx && ctx->stopped()) return false;
+  BindNumaNode();
+  framework::ScopedComputeQuota compute_scope(compute_quota_.get());
+  framework::ScopedTensorCapacityPolicy capacity_scope(
+      tensor_capacity_policy_.get());
+  RunContextScope run_context_scope(ctx);
   inference::Timer timer;
   timer.tic();
   // set feed variable
@@ -179,13 +339,14 @@ bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
     LOG(ERROR) << "fail to set feed";
     return false;
   }
+  SetMkldnnInputShape(scope);
 
   // Run the inference program
   // if share variables, we need not create variables
-  executor_->Run();
+  bool finished = RunExecutor();
 
   // get fetch variable
-  if (!GetFetch(output_data, scope)) {
+  if (finished && !GetFetch(output_data, scope)) {
     LOG(ERROR) << "fail to get fetches";
     return false;
   }
@@ -198,6 +359,24 @@ bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
   // container again, so that the container will be empty for each batch.
   tensor_array_batch_cleaner_.CollectNoTensorVars(sub_scope_);
   tensor_array_batch_cleaner_.ResetNoTensorVars();
+  return finished;
+}
+
+AnalysisPredictor::RunContextScope::RunContextScope(PaddleRunContext *ctx)
+    : run_context_(ctx ? ctx->ctx_.get() : nullptr) {
+  if (ctx && ctx->has_priority()) {
+    priority_.reset(new framework::ScopedComputePriority(
+        static_cast<framework::ComputePriority>(ctx->priority())));
+  }
+}
+
+bool AnalysisPredictor::RunExecutor() {
+  try {
+    executor_->Run();
+  } catch (const framework::RunStoppedError &e) {
+    VLOG(3) << "The run is stopped: " << e.what();
+    return false;
+  }
   return true;
 }
 
@@ -261,7 +440,16 @@ bool AnalysisPredictor::SetFeed(const std::vector<PaddleTensor> &inputs,
     } else {
       idx = boost::get<int>(feeds_[i]->GetAttr("col"));
     }
-    framework::SetFeedVariable(scope, input, "feed", idx);
+    if (scope == sub_scope_ && feed_list_) {
+      // Skip the lookup of the feed variable by name.
+      if (static_cast<size_t>(idx) >= feed_list_->size()) {
+        feed_list_->resize(idx + 1);
+      }
+      (*feed_list_)[idx].ShareDataWith(input);
+      (*feed_list_)[idx].set_lod(input.lod());
+    } else {
+      framework::SetFeedVariable(scope, input, "feed", idx);
+    }
   }
   return true;
 }
@@ -294,7 +482,9 @@ bool AnalysisPredictor::GetFetch(std::vector<PaddleTensor> *outputs,
     int idx = boost::get<int>(fetchs_[i]->GetAttr("col"));
     PADDLE_ENFORCE((size_t)idx == i);
     framework::LoDTensor &fetch =
-        framework::GetFetchVariable(*scope, "fetch", idx);
+        scope == sub_scope_ && fetch_list_
+            ? fetch_list_->at(idx)
+            : framework::GetFetchVariable(*scope, "fetch", idx);
     auto type = fetch.type();
     auto output = &(outputs->at(i));
     output->name = fetchs_[idx]->Input("X")[0];
@@ -335,12 +525,27 @@ void AnalysisPredictor::OptimizeInferenceProgram() {
     argument_.SetTensorRtWorkspaceSize(config_.tensorrt_workspace_size_);
     argument_.SetTensorRtMaxBatchSize(config_.tensorrt_max_batchsize_);
     argument_.SetTensorRtMinSubgraphSize(config_.tensorrt_min_subgraph_size_);
+    argument_.SetTensorRtEngineCacheDir(config_.tensorrt_engine_cache_dir_);
+    argument_.SetTensorRtPrecisionMode(
+        static_cast<int>(config_.tensorrt_precision_mode_));
+    argument_.SetTensorRtCalibrationBatchNum(
+        config_.tensorrt_calibration_batch_num_);
+    argument_.SetTensorRtMaxShapeEngines(config_.tensorrt_max_shape_engines_);
   }
 
   if (config_.use_mkldnn_) {
     argument_.SetMKLDNNEnabledOpTypes(config_.mkldnn_enabled_op_types_);
   }
 
+  if (config_.sparse_weights_enabled()) {
+    argument_.SetSparseWeightMinSparsity(config_.sparse_weight_min_sparsity());
+  }
+
+  // The quantizer reads the values of all the variables after the warmup run,
+  // so they can not share the arena.
+  argument_.SetStaticMemoryPlan(config_.static_memory_plan_enabled() &&
+                                !config_.mkldnn_quantizer_enabled());
+
   auto passes = config_.pass_builder()->AllPasses();
   if (!config_.ir_optim()) passes.clear();
   argument_.SetIrAnalysisPasses(passes);
@@ -352,6 +557,9 @@ void AnalysisPredictor::OptimizeInferenceProgram() {
   ARGUMENT_CHECK_FIELD((&argument_), ir_analyzed_program);
   inference_program_.reset(
       new framework::ProgramDesc(argument_.ir_analyzed_program()));
+  if (argument_.memory_plan_lifetimes_valid()) {
+    memory_plan_lifetimes_ = argument_.memory_plan_lifetimes();
+  }
   LOG(INFO) << "== optimize end ==";
 }
 
@@ -385,6 +593,9 @@ std::unique_ptr<PaddlePredictor> CreatePaddlePredictor<
     }
   }
 
+  if (config.params_sharing_enabled()) {
+    return AnalysisPredictor::CreateWithSharedParams(config);
+  }
   std::unique_ptr<PaddlePredictor> predictor(new AnalysisPredictor(config));
   if (!dynamic_cast<AnalysisPredictor *>(predictor.get())->Init(nullptr)) {
     return nullptr;
@@ -392,9 +603,62 @@ std::unique_ptr<PaddlePredictor> CreatePaddlePredictor<
   return std::move(predictor);
 }
 
+namespace {
+// The parameters and the program of a model kept by its predictors, see
+// AnalysisConfig::EnableParamsSharing().
+struct SharedParams {
+  std::weak_ptr<framework::Scope> scope;
+  std::weak_ptr<framework::ProgramDesc> program;
+  Argument::var_lifetimes_t memory_plan_lifetimes;
+};
+}  // namespace
+
+std::unique_ptr<PaddlePredictor> AnalysisPredictor::CreateWithSharedParams(
+    const AnalysisConfig &config) {
+  static std::mutex mutex;
+  static std::unordered_map<std::string, SharedParams> all_shared_params;
+
+  // The model from memory is keyed by its buffers.
+  std::stringstream key;
+  key << std::hash<std::string>()(config.prog_file_) << ";"
+      << std::hash<std::string>()(config.params_file_) << ";"
+      << config.model_dir_ << ";" << config.device_id_ << ";"
+      << config.SerializeInfoCache() << ";";
+  for (auto &pass : config.pass_builder()->AllPasses()) {
+    key << pass << ",";
+  }
+
+  // The lock is held while the first predictor loads the model, so that
+  // the predictors created concurrently wait for it instead of loading again.
+  std::lock_guard<std::mutex> lock(mutex);
+  auto &shared = all_shared_params[key.str()];
+  auto scope = shared.scope.lock();
+  auto program = shared.program.lock();
+  std::unique_ptr<PaddlePredictor> _predictor(new AnalysisPredictor(config));
+  auto *predictor = static_cast<AnalysisPredictor *>(_predictor.get());
+  if (scope && program) {
+    VLOG(3) << "share the parameters of the model " << config.model_dir_;
+    predictor->memory_plan_lifetimes_ = shared.memory_plan_lifetimes;
+    if (config.numa_binding_enabled() && !config.use_gpu()) {
+      predictor->numa_node_ = std::max(config.numa_node(), 0);
+    }
+    if (!predictor->Init(scope, program)) return nullptr;
+  } else {
+    if (!predictor->Init(nullptr)) return nullptr;
+    shared.scope = predictor->scope_;
+    shared.program = predictor->inference_program_;
+    shared.memory_plan_lifetimes = predictor->memory_plan_lifetimes_;
+  }
+  return _predictor;
+}
+
 void AnalysisPredictor::PrepareFeedFetch() {
   PADDLE_ENFORCE_NOT_NULL(sub_scope_);
   CreateFeedFetchVar(sub_scope_);
+  feed_list_ =
+      sub_scope_->FindVar("feed")->GetMutable<framework::FeedFetchList>();
+  fetch_list_ =
+      sub_scope_->FindVar("fetch")->GetMutable<framework::FeedFetchList>();
   for (auto *op : inference_program_->Block(0).AllOps()) {
     if (op->Type() == "feed") {
       int idx = boost::get<int>(op->GetAttr("col"));
@@ -442,13 +706,86 @@ std::unique_ptr<ZeroCopyTensor> AnalysisPredictor::GetOutputTensor(
 }
 
 bool AnalysisPredictor::ZeroCopyRun() {
-  executor_->Run();
+  return ZeroCopyRunWithContext(nullptr);
+}
+
+bool AnalysisPredictor::ZeroCopyRunWithContext(PaddleRunContext *ctx) {
+  if (ctx && ctx->stopped()) return false;
+  BindNumaNode();
+  framework::ScopedComputeQuota compute_scope(compute_quota_.get());
+  framework::ScopedTensorCapacityPolicy capacity_scope(
+      tensor_capacity_policy_.get());
+  RunContextScope run_context_scope(ctx);
+  SetMkldnnInputShape(sub_scope_ ? sub_scope_ : scope_.get());
+  // The states are not updated by a stopped run.
+  bool finished = RunExecutor();
+  if (finished) UpdateStates();
   // Fix TensorArray reuse not cleaned bug.
   tensor_array_batch_cleaner_.CollectTensorArrays(sub_scope_);
   tensor_array_batch_cleaner_.ResetTensorArray();
+  return finished;
+}
+
+void AnalysisPredictor::UpdateStates() {
+  auto *scope = executor_->scope();
+  for (auto &state : config_.state_vars()) {
+    auto *out = scope->FindVar(state.second);
+    PADDLE_ENFORCE_NOT_NULL(out, "no state output called %s", state.second);
+    auto *in = scope->FindVar(state.first);
+    PADDLE_ENFORCE_NOT_NULL(in, "no state input called %s", state.first);
+    auto &src = out->Get<framework::LoDTensor>();
+    auto *dst = in->GetMutable<framework::LoDTensor>();
+    // The state stays on the device, and the copy on GPU is queued on the
+    // stream of the run.
+    framework::TensorCopy(src, src.place(), dst);
+    dst->set_lod(src.lod());
+  }
+}
+
+bool AnalysisPredictor::ResetStates() {
+  if (config_.state_vars().empty()) return false;
+  auto *scope = executor_->scope();
+  for (auto &state : config_.state_vars()) {
+    auto *var = scope->FindVar(state.first);
+    PADDLE_ENFORCE_NOT_NULL(var, "no state input called %s", state.first);
+    auto *tensor = var->GetMutable<framework::LoDTensor>();
+    if (!tensor->IsInitialized()) continue;
+    size_t bytes = tensor->numel() * framework::SizeOfType(tensor->type());
+    void *data = tensor->mutable_data(tensor->place(), tensor->type());
+    if (platform::is_cpu_place(tensor->place())) {
+      std::memset(data, 0, bytes);
+    } else {
+#ifdef PADDLE_WITH_CUDA
+      auto *dev_ctx = static_cast<platform::CUDADeviceContext *>(
+          platform::DeviceContextPool::Instance().Get(tensor->place()));
+      PADDLE_ENFORCE(cudaMemsetAsync(data, 0, bytes, dev_ctx->stream()));
+#endif
+    }
+  }
   return true;
 }
 
+bool AnalysisPredictor::ZeroCopyRunAsync(void *stream) {
+#ifdef PADDLE_WITH_CUDA
+  PADDLE_ENFORCE(platform::is_gpu_place(place_),
+                 "ZeroCopyRunAsync only works with GPU");
+  auto &dev_ctx = stream_ctxs_[stream];
+  if (dev_ctx == nullptr) {
+    dev_ctx.reset(new platform::CUDADeviceContext(
+        boost::get<platform::CUDAPlace>(place_),
+        static_cast<cudaStream_t>(stream)));
+  }
+  platform::DeviceContextGuard ctx_guard(dev_ctx.get());
+  memory::allocation::CUDAAllocationStreamGuard allocation_guard(
+      dev_ctx->stream());
+  return ZeroCopyRun();
+#else
+  LOG(ERROR) << "ZeroCopyRunAsync only works with GPU, please re-compile "
+                "with WITH_GPU";
+  return false;
+#endif
+}
+
 bool AnalysisPredictor::LoadProgramDesc() {
   // Initialize the inference program
   std::string filename;
@@ -505,6 +842,8 @@ bool AnalysisPredictor::LoadParameters() {
       new framework::ProgramDesc());
   framework::BlockDesc *load_block = load_program->MutableBlock(0);
   std::vector<std::string> params;
+  // The LoDTensors in separate files loaded in parallel instead of by ops.
+  std::vector<std::string> parallel_params;
 
   for (auto *var : global_block->AllVars()) {
     if (IsPersistable(var)) {
@@ -519,6 +858,9 @@ bool AnalysisPredictor::LoadParameters() {
 
       if (!config_.params_file().empty()) {
         params.push_back(new_var->Name());
+      } else if (FLAGS_load_persistables_threads > 1 &&
+                 var->GetType() == framework::proto::VarType::LOD_TENSOR) {
+        parallel_params.push_back(new_var->Name());
       } else {
         // append_op
         framework::OpDesc *op = load_block->AppendOp();
@@ -538,6 +880,8 @@ bool AnalysisPredictor::LoadParameters() {
     op->SetType("load_combine");
     op->SetOutput("Out", params);
     op->SetAttr("file_path", {config_.params_file()});
+    op->SetAttr("use_mmap", {config_.mmap_params_enabled()});
+    op->SetAttr("num_threads", {FLAGS_load_persistables_threads});
     op->CheckAttrs();
   }
 
@@ -545,16 +889,172 @@ bool AnalysisPredictor::LoadParameters() {
   framework::NaiveExecutor e(place_);
   e.Prepare(scope_.get(), *load_program, 0, false);
   e.Run();
+  if (!parallel_params.empty()) {
+    inference::LoadSeparateParams(scope_.get(), parallel_params,
+                                  config_.model_dir(), place_);
+  }
   VLOG(3) << "get " << scope_->LocalVarNames().size() << " vars after load";
 
   return true;
 }
 
+std::string AnalysisPredictor::OptimCacheDir() {
+  if (config_.optim_cache_dir().empty()) return "";
+  // The TensorRT engines and the lifetimes of the static memory plan are not
+  // in the program, and the model from the memory has no files to key.
+  if (config_.model_from_memory() || config_.tensorrt_engine_enabled() ||
+      config_.static_memory_plan_enabled()) {
+    return "";
+  }
+
+  std::stringstream key;
+  key << inference_program_->Proto()->SerializeAsString() << ";";
+  // The parameters are keyed by the sizes and the modification times of their
+  // files, instead of reading them.
+  auto stamp = [&key](const std::string &path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0) {
+      key << path << ":" << st.st_size << ":" << st.st_mtime << ";";
+    }
+  };
+  if (!config_.params_file().empty()) {
+    stamp(config_.params_file());
+  } else {
+    for (auto *var : inference_program_->MutableBlock(0)->AllVars()) {
+      if (IsPersistable(var)) stamp(config_.model_dir() + "/" + var->Name());
+    }
+  }
+  key << config_.SerializeInfoCache() << config_.device_id_ << ";";
+  for (auto &pass : config_.pass_builder()->AllPasses()) {
+    key << pass << ",";
+  }
+  std::vector<std::string> op_types(config_.mkldnn_enabled_op_types_.begin(),
+                                    config_.mkldnn_enabled_op_types_.end());
+  std::sort(op_types.begin(), op_types.end());
+  for (auto &op_type : op_types) {
+    key << op_type << ",";
+  }
+  // The passes and the kernels of another build may optimize differently.
+  key << framework::kCurProgramVersion << ";" << __DATE__ << " " << __TIME__;
+  return config_.optim_cache_dir() + "/" +
+         std::to_string(std::hash<std::string>()(key.str()));
+}
+
+bool AnalysisPredictor::LoadOptimCache(const std::string &dir) {
+  std::string model_path = dir + "/__model__";
+  if (!FileExists(model_path)) return false;
+  try {
+    std::ifstream fin(model_path, std::ios::in | std::ios::binary);
+    PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot open file %s", model_path);
+    std::string pb_content((std::istreambuf_iterator<char>(fin)),
+                           std::istreambuf_iterator<char>());
+    framework::proto::ProgramDesc proto;
+    PADDLE_ENFORCE(proto.ParseFromString(pb_content),
+                   "Cannot parse the program in %s", model_path);
+    std::shared_ptr<framework::ProgramDesc> program(
+        new framework::ProgramDesc(proto));
+
+    auto params = OptimCacheParams(program.get());
+    if (!params.empty()) {
+      framework::ProgramDesc load_program;
+      framework::BlockDesc *load_block = load_program.MutableBlock(0);
+      for (auto &name : params) {
+        auto *var = program->MutableBlock(0)->FindVar(name);
+        framework::VarDesc *new_var = load_block->Var(name);
+        new_var->SetShape(var->GetShape());
+        new_var->SetDataType(var->GetDataType());
+        new_var->SetType(var->GetType());
+        new_var->SetLoDLevel(var->GetLoDLevel());
+        new_var->SetPersistable(true);
+      }
+      framework::OpDesc *op = load_block->AppendOp();
+      op->SetType("load_combine");
+      op->SetOutput("Out", params);
+      op->SetAttr("file_path", {dir + "/__params__"});
+      op->SetAttr("use_mmap", {config_.mmap_params_enabled()});
+      op->SetAttr("num_threads", {FLAGS_load_persistables_threads});
+      op->CheckAttrs();
+
+      framework::NaiveExecutor e(place_);
+      e.Prepare(scope_.get(), load_program, 0, false);
+      e.Run();
+    }
+    inference_program_ = program;
+  } catch (const std::exception &e) {
+    // The parameters loaded are overwritten by the analysis.
+    LOG(WARNING) << "Cannot load the optimized model cached in " << dir << ": "
+                 << e.what();
+    return false;
+  }
+
+  executor_->CreateVariables(*inference_program_, 0, true, sub_scope_);
+  status_program_optimized_ = true;
+  LOG(INFO) << "load the optimized model cached in " << dir;
+  return true;
+}
+
+void AnalysisPredictor::SaveOptimCache(const std::string &dir) {
+  auto params = OptimCacheParams(inference_program_.get());
+  for (auto &name : params) {
+    auto *var = scope_->FindVar(name);
+    if (!var || !var->IsType<framework::LoDTensor>() ||
+        !var->Get<framework::LoDTensor>().IsInitialized()) {
+      VLOG(3) << "not cache the optimized model, " << name
+              << " is not initialized";
+      return;
+    }
+  }
+
+  // The model is saved to a temporary directory renamed at last, so that the
+  // predictors started concurrently never load a partial cache.
+  static std::atomic<int> seq{0};
+  std::string tmp_dir = string::Sprintf(
+      "%s.%d.%d.tmp", dir,
+      std::chrono::steady_clock::now().time_since_epoch().count(), seq++);
+  std::string model_path = tmp_dir + "/__model__";
+  std::string params_path = tmp_dir + "/__params__";
+  bool saved = false;
+  try {
+    MkDirRecursively(tmp_dir.c_str());
+    std::ofstream fout(model_path, std::ios::out | std::ios::binary);
+    PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot open file %s", model_path);
+    fout << inference_program_->Proto()->SerializeAsString();
+    fout.close();
+
+    if (!params.empty()) {
+      framework::ProgramDesc save_program;
+      framework::OpDesc *op = save_program.MutableBlock(0)->AppendOp();
+      op->SetType("save_combine");
+      op->SetInput("X", params);
+      op->SetAttr("file_path", {params_path});
+      op->CheckAttrs();
+
+      framework::NaiveExecutor e(place_);
+      e.Prepare(scope_.get(), save_program, 0, false);
+      e.Run();
+    }
+    saved = true;
+  } catch (const std::exception &e) {
+    LOG(WARNING) << "Cannot cache the optimized model in " << dir << ": "
+                 << e.what();
+  }
+
+  if (!saved || std::rename(tmp_dir.c_str(), dir.c_str()) != 0) {
+    // The model is cached by another predictor, or failed to save.
+    std::remove(model_path.c_str());
+    std::remove(params_path.c_str());
+    std::remove(tmp_dir.c_str());
+  }
+}
+
 AnalysisPredictor::~AnalysisPredictor() {
   if (FLAGS_profile) {
     platform::DisableProfiler(platform::EventSortingKey::kTotal,
                               "./profile.log");
   }
+  if (config_.use_gpu() && !config_.cudnn_algo_cache_file().empty()) {
+    platform::CudnnAlgoCache::Instance().Save(config_.cudnn_algo_cache_file());
+  }
   if (sub_scope_) {
     scope_->DeleteScope(sub_scope_);
   }
@@ -562,7 +1062,19 @@ AnalysisPredictor::~AnalysisPredictor() {
 
 std::unique_ptr<PaddlePredictor> AnalysisPredictor::Clone() {
   auto *x = new AnalysisPredictor(config_);
-  x->Init(scope_, inference_program_);
+  x->memory_plan_lifetimes_ = memory_plan_lifetimes_;
+  x->compute_quota_ = compute_quota_;
+  auto scope = scope_;
+  if (numa_node_ >= 0) {
+    x->numa_node_ = config_.numa_node() >= 0
+                        ? config_.numa_node()
+                        : (numa_node_ + ++num_numa_clones_) %
+                              platform::GetNumaNodeCount();
+    if (config_.numa_params_replica() && x->numa_node_ != numa_node_) {
+      scope = GetNumaScope(x->numa_node_);
+    }
+  }
+  x->Init(scope, inference_program_);
   return std::unique_ptr<PaddlePredictor>(x);
 }
 
@@ -600,4 +1112,18 @@ USE_TRT_CONVERTER(split);
 USE_TRT_CONVERTER(prelu);
 USE_TRT_CONVERTER(conv2d_transpose);
 USE_TRT_CONVERTER(leaky_relu);
+USE_TRT_CONVERTER(transpose);
+USE_TRT_CONVERTER(transpose2);
+USE_TRT_CONVERTER(reshape);
+USE_TRT_CONVERTER(reshape2);
+USE_TRT_CONVERTER(flatten);
+USE_TRT_CONVERTER(flatten2);
+USE_TRT_CONVERTER(slice);
+USE_TRT_CONVERTER(layer_norm);
+USE_TRT_CONVERTER(matmul);
+USE_TRT_CONVERTER(swish);
+USE_TRT_CONVERTER(hard_sigmoid);
+USE_TRT_CONVERTER(nearest_interp);
+USE_TRT_CONVERTER(bilinear_interp);
+USE_TRT_CONVERTER(affine_channel);
 #endif
@@ -14,14 +14,21 @@
 
 #pragma once
 #include <algorithm>
+#include <atomic>
 #include <map>
+#include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <vector>
+#include "paddle/fluid/framework/compute_pool.h"
+#include "paddle/fluid/framework/feed_fetch_type.h"
 #include "paddle/fluid/framework/naive_executor.h"
+#include "paddle/fluid/framework/run_context.h"
 #include "paddle/fluid/inference/analysis/analyzer.h"
 #include "paddle/fluid/inference/api/api_impl.h"
 #include "paddle/fluid/inference/api/details/reset_tensor_array.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/string/printf.h"
 #ifdef PADDLE_WITH_TESTING
 #include <gtest/gtest.h>
@@ -53,6 +60,10 @@ class AnalysisPredictor : public PaddlePredictor {
            std::vector<PaddleTensor> *output_data,
            int batch_size = -1) override;
 
+  bool RunWithContext(const std::vector<PaddleTensor> &inputs,
+                      std::vector<PaddleTensor> *output_data,
+                      PaddleRunContext *ctx, int batch_size = -1) override;
+
   std::unique_ptr<ZeroCopyTensor> GetInputTensor(
       const std::string &name) override;
   std::unique_ptr<ZeroCopyTensor> GetOutputTensor(
@@ -60,6 +71,12 @@ class AnalysisPredictor : public PaddlePredictor {
 
   bool ZeroCopyRun() override;
 
+  bool ZeroCopyRunWithContext(PaddleRunContext *ctx) override;
+
+  bool ZeroCopyRunAsync(void *stream) override;
+
+  bool ResetStates() override;
+
   void CreateFeedFetchVar(framework::Scope *scope);
   void PrepareFeedFetch();
 
@@ -69,11 +86,26 @@ class AnalysisPredictor : public PaddlePredictor {
 
   std::unique_ptr<PaddlePredictor> Clone() override;
 
+  // Create a predictor sharing the parameters with the alive predictors of
+  // the same model, device and passes, see
+  // AnalysisConfig::EnableParamsSharing().
+  static std::unique_ptr<PaddlePredictor> CreateWithSharedParams(
+      const AnalysisConfig &config);
+
   framework::Scope *scope() { return scope_.get(); }
+  // The counters of the reallocations of the tensors of the runs, nullptr if
+  // the tensor capacity policy is not used.
+  const framework::TensorCapacityPolicy *tensor_capacity_policy() const {
+    return tensor_capacity_policy_.get();
+  }
   framework::ProgramDesc &program() { return *inference_program_; }
 
   void SetMkldnnThreadID(int tid);
 
+  // Turns the MKL-DNN ops into INT8 with the scales from a warmup run, see
+  // AnalysisConfig::EnableMkldnnQuantizer().
+  class MkldnnQuantizer;
+
  protected:
   bool PrepareProgram(const std::shared_ptr<framework::ProgramDesc> &program);
   bool PrepareScope(const std::shared_ptr<framework::Scope> &parent_scope);
@@ -83,6 +115,38 @@ class AnalysisPredictor : public PaddlePredictor {
   bool LoadProgramDesc();
   bool LoadParameters();
 
+  // The directory of the optimized model in AnalysisConfig::optim_cache_dir(),
+  // empty if the model is not cached.
+  std::string OptimCacheDir();
+  // Load the optimized program and parameters from the cache, return false if
+  // they are not cached.
+  bool LoadOptimCache(const std::string &dir);
+  void SaveOptimCache(const std::string &dir);
+
+  // Bind the current thread to the NUMA node of the predictor, if any.
+  void BindNumaNode();
+  // The copy of the parameters on a NUMA node, shared by the clones on it.
+  std::shared_ptr<framework::Scope> GetNumaScope(int node);
+  // Group the MKL-DNN primitives of the current thread by the shapes of the
+  // feeds in `scope`, if the cache capacity is set.
+  void SetMkldnnInputShape(framework::Scope *scope);
+  // Copy the state outputs of a zero copy run into the state inputs, see
+  // AnalysisConfig::AddStateVar().
+  void UpdateStates();
+
+  // Set the context of the run and its priority on the compute pool for the
+  // current thread during the lifetime of the object, see PaddleRunContext.
+  class RunContextScope {
+   public:
+    explicit RunContextScope(PaddleRunContext *ctx);
+
+   private:
+    framework::ScopedRunContext run_context_;
+    std::unique_ptr<framework::ScopedComputePriority> priority_;
+  };
+  // Run the executor, return false if the run is stopped by its context.
+  bool RunExecutor();
+
   bool SetFeed(const std::vector<PaddleTensor> &input_datas,
                framework::Scope *scope);
   bool GetFetch(std::vector<PaddleTensor> *output_data,
@@ -98,6 +162,11 @@ class AnalysisPredictor : public PaddlePredictor {
   FRIEND_TEST(AnalysisPredictor, analysis_off);
   FRIEND_TEST(AnalysisPredictor, analysis_on);
   FRIEND_TEST(AnalysisPredictor, with_gpu);
+  FRIEND_TEST(AnalysisPredictor, numa_binding);
+  FRIEND_TEST(AnalysisPredictor, shared_compute_pool);
+  FRIEND_TEST(AnalysisPredictor, params_sharing);
+  FRIEND_TEST(AnalysisPredictor, optim_cache);
+  FRIEND_TEST(AnalysisPredictor, state_vars);
 #endif
 
  private:
@@ -114,7 +183,29 @@ class AnalysisPredictor : public PaddlePredictor {
   // Memory buffer for feed inputs. The temporary LoDTensor will cause serious
   // concurrency problems, wrong results and memory leak, so cache them.
   std::vector<framework::LoDTensor> feed_tensors_;
+  // The feed and fetch lists in the sub_scope_, which live as long as it.
+  framework::FeedFetchList *feed_list_{nullptr};
+  framework::FeedFetchList *fetch_list_{nullptr};
+  // The lifetimes of the temporary variables for the static memory plan,
+  // which are shared with the clones.
+  Argument::var_lifetimes_t memory_plan_lifetimes_;
   details::TensorArrayBatchCleaner tensor_array_batch_cleaner_;
+  // The NUMA node of the predictor, -1 if not bound, see
+  // AnalysisConfig::EnableNumaBinding().
+  int numa_node_{-1};
+  std::atomic<int> num_numa_clones_{0};
+  std::mutex numa_scopes_mutex_;
+  std::map<int, std::shared_ptr<framework::Scope>> numa_scopes_;
+  // The share of the compute pool of the predictor and its clones, nullptr
+  // if not shared, see AnalysisConfig::EnableSharedComputePool().
+  std::shared_ptr<framework::ComputeQuota> compute_quota_;
+  // The capacity policy of the tensors of the runs, nullptr if not used, see
+  // AnalysisConfig::EnableTensorCapacityPolicy().
+  std::unique_ptr<framework::TensorCapacityPolicy> tensor_capacity_policy_;
+#ifdef PADDLE_WITH_CUDA
+  // The device contexts on the streams of ZeroCopyRunAsync.
+  std::map<void *, std::unique_ptr<platform::CUDADeviceContext>> stream_ctxs_;
+#endif
 
  private:
   // Some status here that help to determine the status inside the predictor.
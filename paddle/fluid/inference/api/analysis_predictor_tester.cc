@@ -15,9 +15,12 @@
 #include "paddle/fluid/inference/api/analysis_predictor.h"
 #include <glog/logging.h>
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <thread>  // NOLINT
 #include "paddle/fluid/inference/api/helper.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/fluid/platform/numa.h"
 
 DEFINE_string(dirname, "", "dirname to tests.");
 
@@ -97,6 +100,254 @@ TEST(AnalysisPredictor, analysis_on) {
   inference::CompareTensor(outputs.front(), naive_outputs.front());
 }
 
+TEST(AnalysisPredictor, numa_binding) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.DisableGpu();
+  config.EnableNumaBinding(-1, true);
+
+  auto _predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  auto* predictor = static_cast<AnalysisPredictor*>(_predictor.get());
+  ASSERT_EQ(predictor->numa_node_, 0);
+  auto _clone = predictor->Clone();
+  auto* clone = static_cast<AnalysisPredictor*>(_clone.get());
+  int num_nodes = platform::GetNumaNodeCount();
+  ASSERT_EQ(clone->numa_node_, 1 % num_nodes);
+  // The clone on another node has its own copy of the parameters.
+  ASSERT_EQ(clone->scope_ != predictor->scope_, num_nodes > 1);
+
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+
+  std::vector<PaddleTensor> inputs(4, tensor);
+  std::vector<PaddleTensor> outputs, clone_outputs;
+  ASSERT_TRUE(predictor->Run(inputs, &outputs));
+  std::thread thread([&] {
+    ASSERT_TRUE(clone->Run(inputs, &clone_outputs));
+    ASSERT_EQ(platform::GetCurrentThreadNumaNode(), clone->numa_node_);
+  });
+  thread.join();
+  ASSERT_EQ(clone_outputs.size(), 1UL);
+  inference::CompareTensor(outputs.front(), clone_outputs.front());
+}
+
+TEST(AnalysisPredictor, shared_compute_pool) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.DisableGpu();
+  config.EnableSharedComputePool(2, AnalysisConfig::ComputePriority::kHigh);
+
+  auto _predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  auto* predictor = static_cast<AnalysisPredictor*>(_predictor.get());
+  ASSERT_TRUE(predictor->compute_quota_ != nullptr);
+  ASSERT_EQ(predictor->compute_quota_->max_threads(), 2);
+  ASSERT_EQ(predictor->compute_quota_->priority(),
+            framework::ComputePriority::kHigh);
+  // The clones take their threads out of the quota of the predictor.
+  auto _clone = predictor->Clone();
+  auto* clone = static_cast<AnalysisPredictor*>(_clone.get());
+  ASSERT_EQ(clone->compute_quota_, predictor->compute_quota_);
+
+  AnalysisConfig native_config;
+  native_config.SetModel(FLAGS_dirname);
+  native_config.DisableGpu();
+  auto native_predictor = CreatePaddlePredictor<AnalysisConfig>(native_config);
+
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+
+  std::vector<PaddleTensor> inputs(4, tensor);
+  std::vector<PaddleTensor> outputs, clone_outputs, native_outputs;
+  ASSERT_TRUE(native_predictor->Run(inputs, &native_outputs));
+  std::thread thread(
+      [&] { ASSERT_TRUE(clone->Run(inputs, &clone_outputs)); });
+  ASSERT_TRUE(predictor->Run(inputs, &outputs));
+  thread.join();
+  ASSERT_EQ(predictor->compute_quota_->num_busy(), 0);
+  ASSERT_EQ(outputs.size(), 1UL);
+  ASSERT_EQ(clone_outputs.size(), 1UL);
+  inference::CompareTensor(outputs.front(), native_outputs.front());
+  inference::CompareTensor(clone_outputs.front(), native_outputs.front());
+}
+
+TEST(AnalysisPredictor, params_sharing) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.DisableGpu();
+  config.EnableParamsSharing();
+
+  auto _predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  auto _other = CreatePaddlePredictor<AnalysisConfig>(config);
+  auto* predictor = static_cast<AnalysisPredictor*>(_predictor.get());
+  auto* other = static_cast<AnalysisPredictor*>(_other.get());
+  ASSERT_EQ(predictor->scope_, other->scope_);
+  ASSERT_EQ(predictor->inference_program_, other->inference_program_);
+  ASSERT_NE(predictor->sub_scope_, other->sub_scope_);
+
+  // The model of the different passes is not shared.
+  AnalysisConfig no_ir_config(config);
+  no_ir_config.SwitchIrOptim(false);
+  auto _no_ir = CreatePaddlePredictor<AnalysisConfig>(no_ir_config);
+  ASSERT_NE(static_cast<AnalysisPredictor*>(_no_ir.get())->scope_,
+            predictor->scope_);
+
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+
+  std::vector<PaddleTensor> inputs(4, tensor);
+  std::vector<PaddleTensor> outputs, other_outputs;
+  ASSERT_TRUE(predictor->Run(inputs, &outputs));
+  ASSERT_TRUE(other->Run(inputs, &other_outputs));
+  ASSERT_EQ(other_outputs.size(), 1UL);
+  inference::CompareTensor(outputs.front(), other_outputs.front());
+}
+
+TEST(AnalysisPredictor, optim_cache) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.DisableGpu();
+  config.SetOptimCacheDir("./optim_cache_" + std::to_string(time(nullptr)));
+
+  // The first predictor optimizes the model and caches it, and the second one
+  // loads the cached model.
+  auto _predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  auto _cached = CreatePaddlePredictor<AnalysisConfig>(config);
+  auto* predictor = static_cast<AnalysisPredictor*>(_predictor.get());
+  auto* cached = static_cast<AnalysisPredictor*>(_cached.get());
+  ASSERT_TRUE(predictor->analysis_argument().ir_analyzed_program_valid());
+  ASSERT_FALSE(cached->analysis_argument().ir_analyzed_program_valid());
+  ASSERT_TRUE(cached->status_program_optimized_);
+  ASSERT_EQ(predictor->inference_program_->Block(0).OpSize(),
+            cached->inference_program_->Block(0).OpSize());
+
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+
+  std::vector<PaddleTensor> inputs(4, tensor);
+  std::vector<PaddleTensor> outputs, cached_outputs;
+  ASSERT_TRUE(predictor->Run(inputs, &outputs));
+  ASSERT_TRUE(cached->Run(inputs, &cached_outputs));
+  ASSERT_EQ(cached_outputs.size(), 1UL);
+  inference::CompareTensor(outputs.front(), cached_outputs.front());
+}
+
+TEST(PredictorPool, checkout) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.DisableGpu();
+  PredictorPool pool(config, 3);
+  ASSERT_EQ(pool.size(), 3);
+
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+  std::vector<PaddleTensor> inputs(4, tensor);
+  ASSERT_TRUE(pool.Warmup(inputs));
+
+  {
+    std::vector<PredictorPool::Handle> handles;
+    for (int i = 0; i < pool.size(); ++i) {
+      handles.push_back(pool.TryCheckout());
+      ASSERT_TRUE(handles.back());
+    }
+    ASSERT_FALSE(pool.TryCheckout());
+    ASSERT_EQ(pool.num_free(), 0);
+    handles.back().Release();
+    ASSERT_EQ(pool.num_free(), 1);
+    ASSERT_TRUE(pool.TryCheckout());
+  }
+  ASSERT_EQ(pool.num_free(), pool.size());
+
+  std::vector<PaddleTensor> ref_outputs;
+  ASSERT_TRUE(pool.Checkout()->Run(inputs, &ref_outputs));
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 6; ++tid) {
+    threads.emplace_back([&] {
+      std::vector<PaddleTensor> outputs;
+      for (int i = 0; i < 10; ++i) {
+        auto predictor = pool.Checkout();
+        ASSERT_TRUE(predictor->Run(inputs, &outputs));
+        inference::CompareTensor(ref_outputs.front(), outputs.front());
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  ASSERT_EQ(pool.num_free(), pool.size());
+}
+
+TEST(AnalysisPredictor, run_context) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.DisableGpu();
+  config.EnableSharedComputePool(2);
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+  std::vector<PaddleTensor> inputs(4, tensor);
+  std::vector<PaddleTensor> ref_outputs;
+  ASSERT_TRUE(predictor->Run(inputs, &ref_outputs));
+
+  {
+    PaddleRunContext ctx;
+    ctx.SetTimeout(60 * 1000);
+    ctx.SetPriority(PaddleRunContext::Priority::kHigh);
+    std::vector<PaddleTensor> outputs;
+    ASSERT_TRUE(predictor->RunWithContext(inputs, &outputs, &ctx));
+    inference::CompareTensor(ref_outputs.front(), outputs.front());
+  }
+  {
+    PaddleRunContext ctx;
+    ctx.Cancel();
+    std::vector<PaddleTensor> outputs;
+    ASSERT_FALSE(predictor->RunWithContext(inputs, &outputs, &ctx));
+    ASSERT_TRUE(outputs.empty());
+  }
+  {
+    PaddleRunContext ctx;
+    ctx.SetTimeout(1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_TRUE(ctx.expired());
+    std::vector<PaddleTensor> outputs;
+    ASSERT_FALSE(predictor->RunWithContext(inputs, &outputs, &ctx));
+  }
+  // The predictor runs as before after the stopped runs.
+  std::vector<PaddleTensor> outputs;
+  ASSERT_TRUE(predictor->RunWithContext(inputs, &outputs, nullptr));
+  inference::CompareTensor(ref_outputs.front(), outputs.front());
+
+  // A request waiting for a predictor is dropped when it is cancelled.
+  PredictorPool pool(config, 1);
+  auto handle = pool.Checkout();
+  PaddleRunContext ctx;
+  std::thread canceller([&ctx] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ctx.Cancel();
+  });
+  ASSERT_FALSE(pool.Checkout(&ctx));
+  canceller.join();
+  handle.Release();
+  ASSERT_FALSE(pool.Checkout(&ctx));
+  ASSERT_TRUE(pool.Checkout());
+}
+
 TEST(AnalysisPredictor, ZeroCopy) {
   AnalysisConfig config;
   config.SetModel(FLAGS_dirname);
@@ -135,6 +386,88 @@ TEST(AnalysisPredictor, ZeroCopy) {
   LOG(INFO) << "output_data: " << out_data;
 }
 
+TEST(AnalysisPredictor, ZeroCopyExternalData) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.SwitchUseFeedFetchOps(false);
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+
+  std::vector<std::vector<int64_t>> inputs(4, {0, 1, 2, 3});
+  std::vector<std::string> names({"firstw", "secondw", "thirdw", "forthw"});
+  for (size_t i = 0; i < names.size(); ++i) {
+    auto w = predictor->GetInputTensor(names[i]);
+    w->ShareExternalData<int64_t>(inputs[i].data(), {4, 1}, PaddlePlace::kCPU);
+
+    PaddlePlace place;
+    int size = 0;
+    ASSERT_EQ(w->data<int64_t>(&place, &size), inputs[i].data());
+    ASSERT_EQ(place, PaddlePlace::kCPU);
+    ASSERT_EQ(size, 4);
+  }
+
+  predictor->ZeroCopyRun();
+
+  auto out = predictor->GetOutputTensor("fc_1.tmp_2");
+  PaddlePlace place;
+  int size = 0;
+  auto* out_data = out->data<float>(&place, &size);
+  ASSERT_NE(out_data, nullptr);
+  // The inputs are not written by the predictor.
+  for (auto& input : inputs) {
+    ASSERT_EQ(input, std::vector<int64_t>({0, 1, 2, 3}));
+  }
+}
+
+TEST(AnalysisPredictor, state_vars) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.SwitchUseFeedFetchOps(false);
+  // Not a streaming model, but secondw is carried over from firstw.
+  config.AddStateVar("secondw", "firstw");
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+
+  std::vector<std::string> names({"firstw", "secondw", "thirdw", "forthw"});
+  auto feed = [&](const std::string& name, std::vector<int64_t> data) {
+    auto w = predictor->GetInputTensor(name);
+    w->Reshape({4, 1});
+    std::copy(data.begin(), data.end(),
+              w->mutable_data<int64_t>(PaddlePlace::kCPU));
+  };
+  auto fetch = [&](const std::string& name) {
+    PaddlePlace place;
+    int size = 0;
+    auto* data = predictor->GetInputTensor(name)->data<int64_t>(&place, &size);
+    return std::vector<int64_t>(data, data + size);
+  };
+  auto output = [&]() {
+    PaddlePlace place;
+    int size = 0;
+    auto* data =
+        predictor->GetOutputTensor("fc_1.tmp_2")->data<float>(&place, &size);
+    return std::vector<float>(data, data + size);
+  };
+
+  for (auto& name : names) feed(name, {0, 1, 2, 3});
+  feed("firstw", {4, 5, 6, 7});
+  ASSERT_TRUE(predictor->ZeroCopyRun());
+  ASSERT_EQ(fetch("secondw"), std::vector<int64_t>({4, 5, 6, 7}));
+  // The second run reads the state of the first one.
+  ASSERT_TRUE(predictor->ZeroCopyRun());
+  auto carried = output();
+
+  auto reference = predictor->Clone();
+  ASSERT_TRUE(predictor->ResetStates());
+  ASSERT_EQ(fetch("secondw"), std::vector<int64_t>({0, 0, 0, 0}));
+
+  // The clone is a session of its own.
+  std::swap(predictor, reference);
+  for (auto& name : names) feed(name, {0, 1, 2, 3});
+  feed("firstw", {4, 5, 6, 7});
+  feed("secondw", {4, 5, 6, 7});
+  ASSERT_TRUE(predictor->ZeroCopyRun());
+  ASSERT_EQ(output(), carried);
+}
+
 TEST(AnalysisPredictor, Clone) {
   AnalysisConfig config;
   config.SetModel(FLAGS_dirname);
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/run_context.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/inference/api/paddle_pass_builder.h"
@@ -97,4 +98,30 @@ void PaddleBuf::Free() {
   }
 }
 
+PaddleRunContext::PaddleRunContext() : ctx_(new framework::RunContext) {}
+
+PaddleRunContext::~PaddleRunContext() = default;
+
+void PaddleRunContext::SetTimeout(int64_t timeout_ms) {
+  ctx_->SetTimeout(timeout_ms);
+}
+
+void PaddleRunContext::Cancel() { ctx_->Cancel(); }
+
+bool PaddleRunContext::cancelled() const { return ctx_->IsCancelled(); }
+
+bool PaddleRunContext::expired() const { return ctx_->IsExpired(); }
+
+bool PaddlePredictor::RunWithContext(const std::vector<PaddleTensor> &inputs,
+                                     std::vector<PaddleTensor> *output_data,
+                                     PaddleRunContext *ctx, int batch_size) {
+  if (ctx && ctx->stopped()) return false;
+  return Run(inputs, output_data, batch_size);
+}
+
+bool PaddlePredictor::ZeroCopyRunWithContext(PaddleRunContext *ctx) {
+  if (ctx && ctx->stopped()) return false;
+  return ZeroCopyRun();
+}
+
 }  // namespace paddle
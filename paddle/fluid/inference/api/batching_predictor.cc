@@ -0,0 +1,355 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/batching_predictor.h"
+#include <glog/logging.h>
+#include <algorithm>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <cstring>
+#include <deque>
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace details {
+
+using Clock = std::chrono::steady_clock;
+
+struct BatchingRequest {
+  const std::vector<PaddleTensor> *inputs;
+  std::vector<PaddleTensor> *outputs;
+  size_t batch_size;
+  Clock::time_point start;
+  std::promise<bool> done;
+};
+
+static size_t NumElements(const std::vector<int> &shape) {
+  size_t n = 1;
+  for (int d : shape) n *= static_cast<size_t>(d);
+  return n;
+}
+
+static size_t BatchSizeOf(const PaddleTensor &tensor) {
+  if (!tensor.lod.empty()) return tensor.lod[0].size() - 1;
+  return tensor.shape.empty() ? 0 : static_cast<size_t>(tensor.shape[0]);
+}
+
+// Concatenate the tensors along dim 0, and merge their LoDs.
+static bool MergeTensors(const std::vector<const PaddleTensor *> &parts,
+                         PaddleTensor *merged) {
+  auto &first = *parts[0];
+  if (first.shape.empty()) return false;
+  for (auto *part : parts) {
+    if (part->dtype != first.dtype || part->lod.size() != first.lod.size() ||
+        part->shape.size() != first.shape.size() ||
+        !std::equal(part->shape.begin() + 1, part->shape.end(),
+                    first.shape.begin() + 1)) {
+      return false;
+    }
+  }
+
+  merged->name = first.name;
+  merged->dtype = first.dtype;
+  merged->shape = first.shape;
+  merged->shape[0] = 0;
+  merged->lod.assign(first.lod.size(), std::vector<size_t>({0}));
+  size_t total_bytes = 0;
+  for (auto *part : parts) {
+    merged->shape[0] += part->shape[0];
+    total_bytes += part->data.length();
+    // The offsets of each level index the items of the next level, or the
+    // rows of the last level.
+    for (size_t level = 0; level < part->lod.size(); ++level) {
+      auto &dst = merged->lod[level];
+      size_t base = dst.back();
+      for (size_t i = 1; i < part->lod[level].size(); ++i) {
+        dst.push_back(base + part->lod[level][i]);
+      }
+    }
+  }
+
+  merged->data.Resize(total_bytes);
+  auto *dst = static_cast<char *>(merged->data.data());
+  for (auto *part : parts) {
+    if (part->data.length() == 0) continue;
+    std::memcpy(dst, part->data.data(), part->data.length());
+    dst += part->data.length();
+  }
+  return true;
+}
+
+// Split the tensor into the parts of the given batch sizes, by the first
+// level of its LoD if it has, or by dim 0.
+static bool SplitTensor(const PaddleTensor &merged,
+                        const std::vector<size_t> &batch_sizes,
+                        std::vector<PaddleTensor> *parts) {
+  size_t total = 0;
+  for (auto size : batch_sizes) total += size;
+  if (merged.shape.empty() || BatchSizeOf(merged) != total) {
+    LOG(ERROR) << "Can not split the output " << merged.name
+               << " into the requests of " << total << " samples";
+    return false;
+  }
+  size_t rows = static_cast<size_t>(merged.shape[0]);
+  size_t row_bytes =
+      rows == 0 ? 0 : NumElements(merged.shape) *
+                          PaddleDtypeSize(merged.dtype) / rows;
+
+  parts->resize(batch_sizes.size());
+  size_t begin = 0;
+  for (size_t i = 0; i < batch_sizes.size(); ++i) {
+    auto &part = (*parts)[i];
+    part.name = merged.name;
+    part.dtype = merged.dtype;
+    part.lod.clear();
+    // The range of the items in the current level, and finally the rows.
+    size_t b = begin, e = begin + batch_sizes[i];
+    for (auto &level : merged.lod) {
+      std::vector<size_t> offsets;
+      for (size_t j = b; j <= e; ++j) {
+        offsets.push_back(level[j] - level[b]);
+      }
+      part.lod.emplace_back(std::move(offsets));
+      b = level[b];
+      e = level[e];
+    }
+    part.shape = merged.shape;
+    part.shape[0] = static_cast<int>(e - b);
+    size_t length = (e - b) * row_bytes;
+    part.data = PaddleBuf();
+    if (length > 0) {
+      part.data.Resize(length);
+      std::memcpy(part.data.data(),
+                  static_cast<const char *>(merged.data.data()) + b * row_bytes,
+                  length);
+    }
+    begin += batch_sizes[i];
+  }
+  return true;
+}
+
+class BatchingQueue {
+ public:
+  BatchingQueue(std::unique_ptr<PaddlePredictor> predictor,
+                const BatchingConfig &config)
+      : config_(config), start_(Clock::now()) {
+    PADDLE_ENFORCE_NOT_NULL(predictor);
+    PADDLE_ENFORCE_GT(config_.max_batch_size, 0);
+    PADDLE_ENFORCE_GE(config_.batch_timeout_us, 0);
+    PADDLE_ENFORCE_GT(config_.num_workers, 0);
+    predictors_.emplace_back(std::move(predictor));
+    for (int i = 1; i < config_.num_workers; ++i) {
+      predictors_.emplace_back(predictors_[0]->Clone());
+      PADDLE_ENFORCE_NOT_NULL(predictors_.back(),
+                              "The predictor can not be cloned");
+    }
+    for (auto &predictor : predictors_) {
+      auto *p = predictor.get();
+      workers_.emplace_back([this, p] { WorkerLoop(p); });
+    }
+  }
+
+  ~BatchingQueue() {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      closed_ = true;
+    }
+    cv_.notify_all();
+    for (auto &worker : workers_) {
+      worker.join();
+    }
+  }
+
+  bool Run(const std::vector<PaddleTensor> &inputs,
+           std::vector<PaddleTensor> *outputs) {
+    PADDLE_ENFORCE(!inputs.empty(), "The inputs should not be empty");
+    PADDLE_ENFORCE_NOT_NULL(outputs);
+    BatchingRequest request;
+    request.inputs = &inputs;
+    request.outputs = outputs;
+    request.batch_size = BatchSizeOf(inputs[0]);
+    request.start = Clock::now();
+    auto done = request.done.get_future();
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      if (closed_) return false;
+      queue_.push_back(&request);
+    }
+    cv_.notify_one();
+    return done.get();
+  }
+
+  BatchingStats GetStats() const {
+    std::lock_guard<std::mutex> lock(stats_mtx_);
+    BatchingStats stats = stats_;
+    double seconds =
+        std::chrono::duration<double>(Clock::now() - start_).count();
+    if (seconds > 0) stats.qps = stats.num_requests / seconds;
+    if (stats.num_batches > 0) {
+      stats.avg_batch_size =
+          static_cast<double>(total_batch_size_) / stats.num_batches;
+    }
+    if (stats.num_requests > 0) {
+      stats.avg_latency_ms = total_latency_ms_ / stats.num_requests;
+    }
+    return stats;
+  }
+
+ private:
+  // Take the requests of the next batch. Return false if the queue is closed
+  // and empty.
+  bool NextBatch(std::vector<BatchingRequest *> *batch) {
+    // Only one worker gathers a batch at a time, so that the concurrent
+    // requests are not scattered into small batches of the idle workers.
+    std::lock_guard<std::mutex> gather_guard(gather_mtx_);
+    std::unique_lock<std::mutex> lock(mtx_);
+    cv_.wait(lock, [this] { return closed_ || !queue_.empty(); });
+    if (queue_.empty()) return false;
+
+    auto max_batch_size = static_cast<size_t>(config_.max_batch_size);
+    auto deadline = queue_.front()->start +
+                    std::chrono::microseconds(config_.batch_timeout_us);
+    size_t size = 0;
+    while (true) {
+      while (!queue_.empty()) {
+        auto *request = queue_.front();
+        if (!batch->empty() && size + request->batch_size > max_batch_size) {
+          return true;
+        }
+        batch->emplace_back(request);
+        queue_.pop_front();
+        size += request->batch_size;
+      }
+      if (size >= max_batch_size || closed_) return true;
+      if (!cv_.wait_until(lock, deadline,
+                          [this] { return closed_ || !queue_.empty(); })) {
+        return true;
+      }
+    }
+  }
+
+  bool RunBatch(PaddlePredictor *predictor,
+                const std::vector<BatchingRequest *> &batch) {
+    if (batch.size() == 1) {
+      return predictor->Run(*batch[0]->inputs, batch[0]->outputs);
+    }
+    size_t num_inputs = batch[0]->inputs->size();
+    std::vector<PaddleTensor> inputs(num_inputs);
+    for (size_t i = 0; i < num_inputs; ++i) {
+      std::vector<const PaddleTensor *> parts;
+      for (auto *request : batch) {
+        if (request->inputs->size() != num_inputs) return false;
+        parts.emplace_back(&(*request->inputs)[i]);
+      }
+      if (!MergeTensors(parts, &inputs[i])) return false;
+    }
+
+    std::vector<PaddleTensor> outputs;
+    if (!predictor->Run(inputs, &outputs)) return false;
+
+    std::vector<size_t> batch_sizes;
+    for (auto *request : batch) {
+      batch_sizes.emplace_back(request->batch_size);
+      request->outputs->resize(outputs.size());
+    }
+    std::vector<PaddleTensor> parts;
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      if (!SplitTensor(outputs[i], batch_sizes, &parts)) return false;
+      for (size_t j = 0; j < batch.size(); ++j) {
+        (*batch[j]->outputs)[i] = std::move(parts[j]);
+      }
+    }
+    return true;
+  }
+
+  void WorkerLoop(PaddlePredictor *predictor) {
+    std::vector<BatchingRequest *> batch;
+    while (NextBatch(&batch)) {
+      std::vector<bool> results(batch.size(), false);
+      if (RunBatch(predictor, batch)) {
+        results.assign(batch.size(), true);
+      } else if (batch.size() > 1) {
+        VLOG(3) << "Run the " << batch.size()
+                << " requests which can not be merged one by one";
+        for (size_t i = 0; i < batch.size(); ++i) {
+          results[i] = predictor->Run(*batch[i]->inputs, batch[i]->outputs);
+        }
+      }
+      UpdateStats(batch, results);
+      for (size_t i = 0; i < batch.size(); ++i) {
+        batch[i]->done.set_value(results[i]);
+      }
+      batch.clear();
+    }
+  }
+
+  void UpdateStats(const std::vector<BatchingRequest *> &batch,
+                   const std::vector<bool> &results) {
+    auto now = Clock::now();
+    std::lock_guard<std::mutex> lock(stats_mtx_);
+    ++stats_.num_batches;
+    for (size_t i = 0; i < batch.size(); ++i) {
+      double latency_ms = std::chrono::duration<double, std::milli>(
+                              now - batch[i]->start)
+                              .count();
+      ++stats_.num_requests;
+      if (!results[i]) ++stats_.num_failed_requests;
+      total_batch_size_ += batch[i]->batch_size;
+      total_latency_ms_ += latency_ms;
+      stats_.max_latency_ms = std::max(stats_.max_latency_ms, latency_ms);
+    }
+  }
+
+  BatchingConfig config_;
+  std::vector<std::unique_ptr<PaddlePredictor>> predictors_;
+  std::vector<std::thread> workers_;
+
+  std::mutex gather_mtx_;
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  std::deque<BatchingRequest *> queue_;
+  bool closed_{false};
+
+  Clock::time_point start_;
+  mutable std::mutex stats_mtx_;
+  BatchingStats stats_;
+  uint64_t total_batch_size_{0};
+  double total_latency_ms_{0};
+};
+
+}  // namespace details
+
+BatchingPredictor::BatchingPredictor(std::unique_ptr<PaddlePredictor> predictor,
+                                     const BatchingConfig &config)
+    : queue_(new details::BatchingQueue(std::move(predictor), config)) {}
+
+bool BatchingPredictor::Run(const std::vector<PaddleTensor> &inputs,
+                            std::vector<PaddleTensor> *output_data,
+                            int batch_size) {
+  return queue_->Run(inputs, output_data);
+}
+
+std::unique_ptr<PaddlePredictor> BatchingPredictor::Clone() {
+  return std::unique_ptr<PaddlePredictor>(new BatchingPredictor(queue_));
+}
+
+BatchingStats BatchingPredictor::GetStats() const { return queue_->GetStats(); }
+
+BatchingPredictor::~BatchingPredictor() {}
+
+}  // namespace paddle
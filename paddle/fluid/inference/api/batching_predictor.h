@@ -0,0 +1,91 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+
+namespace paddle {
+
+struct BatchingConfig {
+  // The maximum number of samples merged into a batch. A request larger than
+  // it runs alone.
+  int max_batch_size{32};
+  // The time in microseconds to wait for more requests after the first
+  // request of a batch arrives.
+  int batch_timeout_us{1000};
+  // The number of batches running concurrently. Each of them runs on its own
+  // predictor, which is cloned from the one given.
+  int num_workers{1};
+};
+
+struct BatchingStats {
+  uint64_t num_requests{0};
+  uint64_t num_failed_requests{0};
+  uint64_t num_batches{0};
+  // The requests per second since the BatchingPredictor is created.
+  double qps{0};
+  double avg_batch_size{0};
+  // The latency of a request, from the Run call to the outputs ready.
+  double avg_latency_ms{0};
+  double max_latency_ms{0};
+};
+
+namespace details {
+class BatchingQueue;
+}  // namespace details
+
+/** BatchingPredictor merges the concurrent Run calls into batches, runs each
+ * batch once with the underlying predictor, and scatters the outputs back to
+ * the callers. It is for the online services with many small requests.
+ *
+ * The inputs of the requests are concatenated along dim 0, and their LoDs
+ * are merged. The size of a request is the number of sequences of its first
+ * input if it has LoD, or the dim 0 of it. A batch is run when it has
+ * max_batch_size samples, or batch_timeout_us after its first request. The
+ * outputs are split by their LoDs if they have, or by dim 0, which must be
+ * the number of samples of the batch. The requests which can not be merged,
+ * e.g., with different shapes other than dim 0, run one by one.
+ *
+ * Run is thread-safe. The clones share the queue and the predictors.
+ */
+class BatchingPredictor : public PaddlePredictor {
+ public:
+  BatchingPredictor(std::unique_ptr<PaddlePredictor> predictor,
+                    const BatchingConfig& config);
+
+  /** Block until the batch of the request is done. batch_size is ignored.
+   */
+  bool Run(const std::vector<PaddleTensor>& inputs,
+           std::vector<PaddleTensor>* output_data,
+           int batch_size = -1) override;
+
+  std::unique_ptr<PaddlePredictor> Clone() override;
+
+  BatchingStats GetStats() const;
+
+  ~BatchingPredictor() override;
+
+ private:
+  explicit BatchingPredictor(std::shared_ptr<details::BatchingQueue> queue)
+      : queue_(std::move(queue)) {}
+
+  std::shared_ptr<details::BatchingQueue> queue_;
+};
+
+}  // namespace paddle
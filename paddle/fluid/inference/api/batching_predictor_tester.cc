@@ -0,0 +1,166 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/batching_predictor.h"
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+
+namespace paddle {
+
+// Output the input multiplied by 2, and record the batch sizes it runs.
+class DoublePredictor : public PaddlePredictor {
+ public:
+  bool Run(const std::vector<PaddleTensor> &inputs,
+           std::vector<PaddleTensor> *output_data,
+           int batch_size = -1) override {
+    auto &input = inputs[0];
+    PaddleTensor output;
+    output.name = "out";
+    output.dtype = PaddleDType::FLOAT32;
+    output.shape = input.shape;
+    output.lod = input.lod;
+    output.data.Resize(input.data.length());
+    auto *src = static_cast<const float *>(input.data.data());
+    auto *dst = static_cast<float *>(output.data.data());
+    for (size_t i = 0; i < input.data.length() / sizeof(float); ++i) {
+      dst[i] = src[i] * 2;
+    }
+    output_data->clear();
+    output_data->emplace_back(std::move(output));
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      batch_rows_.push_back(input.shape[0]);
+    }
+    return true;
+  }
+
+  std::unique_ptr<PaddlePredictor> Clone() override {
+    return std::unique_ptr<PaddlePredictor>(new DoublePredictor);
+  }
+
+  static std::mutex mtx_;
+  static std::vector<int> batch_rows_;
+};
+
+std::mutex DoublePredictor::mtx_;
+std::vector<int> DoublePredictor::batch_rows_;
+
+static PaddleTensor MakeInput(const std::vector<std::vector<float>> &seqs,
+                              bool with_lod) {
+  PaddleTensor tensor;
+  tensor.name = "x";
+  tensor.dtype = PaddleDType::FLOAT32;
+  std::vector<float> data;
+  std::vector<size_t> offsets({0});
+  for (auto &seq : seqs) {
+    data.insert(data.end(), seq.begin(), seq.end());
+    offsets.push_back(data.size());
+  }
+  tensor.shape = {static_cast<int>(data.size()), 1};
+  if (with_lod) tensor.lod.push_back(offsets);
+  tensor.data.Resize(data.size() * sizeof(float));
+  memcpy(tensor.data.data(), data.data(), data.size() * sizeof(float));
+  return tensor;
+}
+
+static void RunConcurrently(PaddlePredictor *predictor, int num_threads,
+                            bool with_lod) {
+  std::atomic<int> num_correct(0);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid] {
+      auto clone = predictor->Clone();
+      // The thread tid sends a sequence of tid + 1 steps, or a row.
+      std::vector<float> seq(with_lod ? tid + 1 : 1, static_cast<float>(tid));
+      std::vector<PaddleTensor> outputs;
+      ASSERT_TRUE(clone->Run({MakeInput({seq}, with_lod)}, &outputs));
+      ASSERT_EQ(outputs.size(), 1UL);
+      auto &out = outputs[0];
+      ASSERT_EQ(out.shape[0], static_cast<int>(seq.size()));
+      if (with_lod) {
+        ASSERT_EQ(out.lod,
+                  std::vector<std::vector<size_t>>({{0, seq.size()}}));
+      }
+      auto *data = static_cast<float *>(out.data.data());
+      for (size_t i = 0; i < seq.size(); ++i) {
+        ASSERT_EQ(data[i], 2.f * tid);
+      }
+      ++num_correct;
+    });
+  }
+  for (auto &t : threads) t.join();
+  ASSERT_EQ(num_correct, num_threads);
+}
+
+TEST(BatchingPredictor, merge_rows) {
+  DoublePredictor::batch_rows_.clear();
+  BatchingConfig config;
+  config.max_batch_size = 4;
+  config.batch_timeout_us = 100000;
+  BatchingPredictor predictor(
+      std::unique_ptr<PaddlePredictor>(new DoublePredictor), config);
+  RunConcurrently(&predictor, 8, false);
+
+  int total_rows = 0;
+  for (int rows : DoublePredictor::batch_rows_) {
+    ASSERT_LE(rows, 4);
+    total_rows += rows;
+  }
+  ASSERT_EQ(total_rows, 8);
+  ASSERT_LT(DoublePredictor::batch_rows_.size(), 8UL);
+
+  auto stats = predictor.GetStats();
+  ASSERT_EQ(stats.num_requests, 8UL);
+  ASSERT_EQ(stats.num_failed_requests, 0UL);
+  ASSERT_EQ(stats.num_batches, DoublePredictor::batch_rows_.size());
+  LOG(INFO) << "qps " << stats.qps << ", avg batch size "
+            << stats.avg_batch_size << ", avg latency "
+            << stats.avg_latency_ms << "ms";
+}
+
+TEST(BatchingPredictor, merge_lod) {
+  BatchingConfig config;
+  config.max_batch_size = 3;
+  config.batch_timeout_us = 100000;
+  config.num_workers = 2;
+  BatchingPredictor predictor(
+      std::unique_ptr<PaddlePredictor>(new DoublePredictor), config);
+  RunConcurrently(&predictor, 10, true);
+  ASSERT_EQ(predictor.GetStats().num_requests, 10UL);
+}
+
+TEST(BatchingPredictor, not_mergeable) {
+  BatchingConfig config;
+  config.batch_timeout_us = 100000;
+  BatchingPredictor predictor(
+      std::unique_ptr<PaddlePredictor>(new DoublePredictor), config);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 4; ++tid) {
+    threads.emplace_back([&, tid] {
+      // Different shapes except dim 0 can not be merged.
+      PaddleTensor input = MakeInput({std::vector<float>(2, 1.f)}, false);
+      input.shape = tid % 2 == 0 ? std::vector<int>({1, 2})
+                                 : std::vector<int>({2, 1});
+      std::vector<PaddleTensor> outputs;
+      ASSERT_TRUE(predictor.Run({input}, &outputs));
+      ASSERT_EQ(outputs[0].shape, input.shape);
+    });
+  }
+  for (auto &t : threads) t.join();
+}
+
+}  // namespace paddle
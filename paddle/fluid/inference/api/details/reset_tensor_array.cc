@@ -51,6 +51,9 @@ void TensorArrayBatchCleaner::CollectNoTensorVars(framework::Scope *scope) {
     for (auto &var_name : scope->LocalVarNames()) {
       auto *var = scope->FindVar(var_name);
       if (!var->IsInitialized()) continue;
+      // The feed and fetch lists are overwritten by every run, keep them so
+      // that the fetched tensors reuse their buffers.
+      if (var_name == "feed" || var_name == "fetch") continue;
       if (!valid_types_.count(var->Type())) {
         no_tensor_vars_.insert(var);
       }
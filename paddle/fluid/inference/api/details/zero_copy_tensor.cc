@@ -12,9 +12,12 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/fluid/memory/allocation/allocator.h"
+#include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/enforce.h"
 
 namespace paddle {
@@ -67,12 +70,66 @@ T *ZeroCopyTensor::data(PaddlePlace *place, int *size) const {
   return res;
 }
 
+template <typename T>
+void ZeroCopyTensor::ShareExternalData(T *data, const std::vector<int> &shape,
+                                       PaddlePlace place, void *stream) {
+  PADDLE_ENFORCE_NOT_NULL(data);
+  platform::Place dst_place;
+  switch (static_cast<int>(place)) {
+    case static_cast<int>(PaddlePlace::kCPU): {
+      dst_place = platform::CPUPlace();
+      break;
+    }
+    case static_cast<int>(PaddlePlace::kGPU): {
+#ifdef PADDLE_WITH_CUDA
+      cudaPointerAttributes attr;
+      PADDLE_ENFORCE(cudaPointerGetAttributes(&attr, data));
+      dst_place = platform::CUDAPlace(attr.device);
+#else
+      PADDLE_THROW("Not compiled with CUDA, should not reach here.");
+#endif
+      break;
+    }
+    default:
+      PADDLE_THROW("Unsupported place: %d", static_cast<int>(place));
+      break;
+  }
+
+  auto *tensor = static_cast<framework::LoDTensor *>(FindTensor());
+  tensor->clear();
+  tensor->Resize(framework::make_ddim(shape));
+  size_t size = tensor->numel() * sizeof(T);
+  // The allocation only wraps the memory, and does not free it.
+  tensor->ResetHolder(
+      std::make_shared<memory::Allocation>(data, size, dst_place));
+  PADDLE_ENFORCE_EQ(tensor->mutable_data<T>(dst_place), data);
+
+#ifdef PADDLE_WITH_CUDA
+  if (stream != nullptr && platform::is_gpu_place(dst_place)) {
+    auto *dev_ctx = static_cast<platform::CUDADeviceContext *>(
+        platform::DeviceContextPool::Instance().Get(dst_place));
+    cudaEvent_t event;
+    PADDLE_ENFORCE(cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+    PADDLE_ENFORCE(
+        cudaEventRecord(event, reinterpret_cast<cudaStream_t>(stream)));
+    PADDLE_ENFORCE(cudaStreamWaitEvent(dev_ctx->stream(), event, 0));
+    PADDLE_ENFORCE(cudaEventDestroy(event));
+  }
+#endif
+}
+
 template float *ZeroCopyTensor::data<float>(PaddlePlace *place,
                                             int *size) const;
 template int64_t *ZeroCopyTensor::data<int64_t>(PaddlePlace *place,
                                                 int *size) const;
 template float *ZeroCopyTensor::mutable_data<float>(PaddlePlace place);
 template int64_t *ZeroCopyTensor::mutable_data<int64_t>(PaddlePlace place);
+template void ZeroCopyTensor::ShareExternalData<float>(
+    float *data, const std::vector<int> &shape, PaddlePlace place,
+    void *stream);
+template void ZeroCopyTensor::ShareExternalData<int64_t>(
+    int64_t *data, const std::vector<int> &shape, PaddlePlace place,
+    void *stream);
 
 void *ZeroCopyTensor::FindTensor() const {
   PADDLE_ENFORCE(!name_.empty(),
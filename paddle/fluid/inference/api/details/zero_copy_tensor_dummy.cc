@@ -28,12 +28,22 @@ T *ZeroCopyTensor::data(PaddlePlace *place, int *size) const {
   return nullptr;
 }
 
+template <typename T>
+void ZeroCopyTensor::ShareExternalData(T *data, const std::vector<int> &shape,
+                                       PaddlePlace place, void *stream) {}
+
 template float *ZeroCopyTensor::data<float>(PaddlePlace *place,
                                             int *size) const;
 template int64_t *ZeroCopyTensor::data<int64_t>(PaddlePlace *place,
                                                 int *size) const;
 template float *ZeroCopyTensor::mutable_data(PaddlePlace place);
 template int64_t *ZeroCopyTensor::mutable_data(PaddlePlace place);
+template void ZeroCopyTensor::ShareExternalData<float>(
+    float *data, const std::vector<int> &shape, PaddlePlace place,
+    void *stream);
+template void ZeroCopyTensor::ShareExternalData<int64_t>(
+    int64_t *data, const std::vector<int> &shape, PaddlePlace place,
+    void *stream);
 
 void *ZeroCopyTensor::FindTensor() const { return nullptr; }
 
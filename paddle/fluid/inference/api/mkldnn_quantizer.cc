@@ -0,0 +1,280 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/mkldnn_quantizer.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <vector>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+
+using framework::LoDTensor;
+using ScalePair = std::pair<bool, LoDTensor>;
+
+namespace {
+
+float QuantRange(bool is_unsigned) { return is_unsigned ? 255.f : 127.f; }
+
+float MaxAbs(const float* data, int64_t n) {
+  float max_abs = 0.f;
+  for (int64_t i = 0; i < n; ++i) {
+    max_abs = std::max(max_abs, std::fabs(data[i]));
+  }
+  return max_abs;
+}
+
+bool IsNonNegative(const LoDTensor& tensor) {
+  const float* data = tensor.data<float>();
+  return std::all_of(data, data + tensor.numel(),
+                     [](float x) { return x >= 0.f; });
+}
+
+ScalePair MakeScale(bool is_unsigned, const std::vector<float>& scales) {
+  LoDTensor tensor;
+  float* data = tensor.mutable_data<float>(
+      {static_cast<int64_t>(scales.size())}, platform::CPUPlace());
+  std::copy(scales.begin(), scales.end(), data);
+  return std::make_pair(is_unsigned, tensor);
+}
+
+void CheckTensor(const LoDTensor& tensor) {
+  PADDLE_ENFORCE(platform::is_cpu_place(tensor.place()),
+                 "MkldnnQuantizer only works with the CPU tensors.");
+  PADDLE_ENFORCE(tensor.type() == framework::proto::VarType::FP32,
+                 "MkldnnQuantizer only works with the FP32 tensors.");
+}
+
+}  // namespace
+
+ScalePair AnalysisPredictor::MkldnnQuantizer::GetMaxScale(
+    const LoDTensor& tensor, bool is_unsigned) {
+  CheckTensor(tensor);
+  float max_abs = MaxAbs(tensor.data<float>(), tensor.numel());
+  // All the values are zero, any scale works.
+  if (max_abs == 0.f) max_abs = 1.f;
+  return MakeScale(is_unsigned, {QuantRange(is_unsigned) / max_abs});
+}
+
+ScalePair AnalysisPredictor::MkldnnQuantizer::GetMaxChScale(
+    const LoDTensor& tensor) {
+  CheckTensor(tensor);
+  PADDLE_ENFORCE_GT(tensor.dims().size(), 1,
+                    "MAX_CH only works with the filters.");
+  int64_t channels = tensor.dims()[0];
+  int64_t channel_size = tensor.numel() / channels;
+  const float* data = tensor.data<float>();
+  std::vector<float> scales(channels);
+  for (int64_t c = 0; c < channels; ++c) {
+    float max_abs = MaxAbs(data + c * channel_size, channel_size);
+    // The conv2d INT8 kernel takes zero as the scale of a zero channel.
+    scales[c] = max_abs == 0.f ? 0.f : QuantRange(false) / max_abs;
+  }
+  return MakeScale(false, scales);
+}
+
+// Choose the threshold of the absolute values, beyond which the values are
+// saturated, by minimizing the KL divergence between the histogram of the
+// values and its quantized version, as TensorRT does.
+ScalePair AnalysisPredictor::MkldnnQuantizer::GetKLScale(
+    const LoDTensor& tensor, bool is_unsigned) {
+  CheckTensor(tensor);
+  const float* data = tensor.data<float>();
+  int64_t n = tensor.numel();
+  float max_abs = MaxAbs(data, n);
+  if (max_abs == 0.f) return GetMaxScale(tensor, is_unsigned);
+
+  constexpr int kNumBins = 2048;
+  const int num_quant_bins = static_cast<int>(QuantRange(is_unsigned));
+  const float bin_width = max_abs / kNumBins;
+  std::vector<float> hist(kNumBins, 0.f);
+  for (int64_t i = 0; i < n; ++i) {
+    int bin = static_cast<int>(std::fabs(data[i]) / bin_width);
+    ++hist[std::min(bin, kNumBins - 1)];
+  }
+
+  constexpr float kEps = 1e-4f;
+  float min_kl = std::numeric_limits<float>::max();
+  int best_bins = kNumBins;
+  std::vector<float> p(kNumBins), q(kNumBins);
+  float outliers = 0.f;
+  for (int i = kNumBins - 1; i >= num_quant_bins; --i) outliers += hist[i];
+  for (int i = num_quant_bins; i <= kNumBins; ++i) {
+    // The reference distribution clipped at the i-th bin.
+    std::copy(hist.begin(), hist.begin() + i, p.begin());
+    p[i - 1] += outliers;
+    if (i < kNumBins) outliers -= hist[i];
+
+    // Merge the first i bins into the quantized bins, and expand them back
+    // over the non-empty bins.
+    std::fill(q.begin(), q.begin() + i, 0.f);
+    for (int j = 0; j < num_quant_bins; ++j) {
+      int begin = j * i / num_quant_bins;
+      int end = (j + 1) * i / num_quant_bins;
+      float sum = 0.f;
+      int non_empty = 0;
+      for (int k = begin; k < end; ++k) {
+        sum += hist[k];
+        if (hist[k] != 0.f) ++non_empty;
+      }
+      if (non_empty == 0) continue;
+      for (int k = begin; k < end; ++k) {
+        if (hist[k] != 0.f) q[k] = sum / non_empty;
+      }
+    }
+
+    float p_sum = std::accumulate(p.begin(), p.begin() + i, 0.f);
+    float q_sum = std::accumulate(q.begin(), q.begin() + i, 0.f);
+    if (q_sum == 0.f) continue;
+    float kl = 0.f;
+    for (int k = 0; k < i; ++k) {
+      if (p[k] == 0.f) continue;
+      float pk = p[k] / p_sum;
+      float qk = std::max(q[k] / q_sum, kEps);
+      kl += pk * std::log(pk / qk);
+    }
+    if (kl < min_kl) {
+      min_kl = kl;
+      best_bins = i;
+    }
+  }
+
+  float threshold = (best_bins + 0.5f) * bin_width;
+  return MakeScale(is_unsigned, {QuantRange(is_unsigned) / threshold});
+}
+
+const LoDTensor& AnalysisPredictor::MkldnnQuantizer::GetTensor(
+    const std::string& var_name) const {
+  auto* var = predictor_.sub_scope_->FindVar(var_name);
+  PADDLE_ENFORCE_NOT_NULL(var, "%s is not found in the scope.", var_name);
+  PADDLE_ENFORCE(var->IsType<LoDTensor>(), "%s is not a LoDTensor.",
+                 var_name);
+  return var->Get<LoDTensor>();
+}
+
+void AnalysisPredictor::MkldnnQuantizer::CalculateScale(
+    const std::string& op_type, const std::string& conn_name,
+    const std::string& var_name, bool is_unsigned) {
+  if (scales_.count(var_name)) return;
+  auto algo = config_.scale_algo(op_type, conn_name);
+  const auto& tensor = GetTensor(var_name);
+  switch (algo) {
+    case ScaleAlgo::NONE:
+      return;
+    case ScaleAlgo::MAX:
+      scales_[var_name] = GetMaxScale(tensor, is_unsigned);
+      break;
+    case ScaleAlgo::MAX_CH:
+      scales_[var_name] = GetMaxChScale(tensor);
+      break;
+    case ScaleAlgo::KL:
+      scales_[var_name] = GetKLScale(tensor, is_unsigned);
+      break;
+  }
+}
+
+// The ops are visited in the program order, so that the scale of an output
+// is computed by its producer, which knows the data type of the output,
+// before it is used by the consumers.
+void AnalysisPredictor::MkldnnQuantizer::CalculateScales() {
+  const auto& enabled_op_types = config_.enabled_op_types();
+  for (auto* op : predictor_.inference_program_->Block(0).AllOps()) {
+    const auto& type = op->Type();
+    if (!enabled_op_types.count(type) || !op->HasAttr("use_mkldnn") ||
+        !boost::get<bool>(op->GetAttr("use_mkldnn"))) {
+      continue;
+    }
+    if (type == "conv2d") {
+      auto input = op->Input("Input")[0];
+      CalculateScale(type, "Input", input, IsNonNegative(GetTensor(input)));
+      CalculateScale(type, "Filter", op->Input("Filter")[0], false);
+      // The output of the INT8 conv2d is uint8 with the fused ReLU, or of the
+      // type of the residual data.
+      bool is_unsigned = op->HasAttr("fuse_relu") &&
+                         boost::get<bool>(op->GetAttr("fuse_relu"));
+      if (op->HasAttr("fuse_residual_connection") &&
+          boost::get<bool>(op->GetAttr("fuse_residual_connection"))) {
+        auto residual = op->Input("ResidualData")[0];
+        CalculateScale(type, "ResidualData", residual,
+                       IsNonNegative(GetTensor(residual)));
+        if (scales_.count(residual)) is_unsigned = scales_[residual].first;
+      }
+      CalculateScale(type, "Output", op->Output("Output")[0], is_unsigned);
+    } else if (type == "pool2d") {
+      auto input = op->Input("X")[0];
+      auto output = op->Output("Out")[0];
+      CalculateScale(type, "X", input, IsNonNegative(GetTensor(input)));
+      // The INT8 pooling keeps the scale of the input.
+      if (scales_.count(input) && !scales_.count(output)) {
+        scales_[output] = scales_[input];
+      }
+    }
+  }
+}
+
+bool AnalysisPredictor::MkldnnQuantizer::RunQuantizePasses() {
+  auto& registry = framework::ir::PassRegistry::Instance();
+  auto& program = *predictor_.inference_program_;
+  std::unique_ptr<framework::ir::Graph> graph(
+      new framework::ir::Graph(program));
+  graph->Set(framework::ir::kParamScopeAttr,
+             new framework::Scope*(predictor_.scope_.get()));
+
+  auto quantize_pass = registry.Get("cpu_quantize_pass");
+  quantize_pass->Set("quant_var_scales", new VarQuantScale(scales_));
+  graph = quantize_pass->Apply(std::move(graph));
+  graph = registry.Get("cpu_quantize_squash_pass")->Apply(std::move(graph));
+
+  std::shared_ptr<framework::ProgramDesc> quantized_program(
+      new framework::ProgramDesc(program));
+  auto to_program_pass = registry.Get("graph_to_program_pass");
+  to_program_pass->SetNotOwned("program", quantized_program.get());
+  graph = to_program_pass->Apply(std::move(graph));
+
+  // Prepare a new executor with the quantized program, the feed and fetch ops
+  // are also the ones in the new program.
+  predictor_.inference_program_ = quantized_program;
+  if (!predictor_.CreateExecutor()) return false;
+  predictor_.executor_->CreateVariables(*predictor_.inference_program_, 0,
+                                        false, predictor_.sub_scope_);
+  if (!predictor_.PrepareExecutor()) return false;
+  predictor_.PrepareFeedFetch();
+  return true;
+}
+
+bool AnalysisPredictor::MkldnnQuantizer::Quantize() {
+  auto warmup_data = config_.warmup_data();
+  if (!warmup_data) {
+    LOG(ERROR) << "The warmup data of MkldnnQuantizer is not set.";
+    return false;
+  }
+
+  std::vector<PaddleTensor> outputs;
+  if (!predictor_.Run(*warmup_data, &outputs)) {
+    LOG(ERROR) << "Failed to run the warmup data.";
+    return false;
+  }
+  CalculateScales();
+  LOG(INFO) << "== computed " << scales_.size() << " quantization scales ==";
+  return RunQuantizePasses();
+}
+
+}  // namespace paddle
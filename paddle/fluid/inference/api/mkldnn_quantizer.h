@@ -0,0 +1,66 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include "paddle/fluid/framework/ir/cpu_quantize_pass.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/inference/api/analysis_predictor.h"
+#include "paddle/fluid/inference/api/paddle_mkldnn_quantizer_config.h"
+
+namespace paddle {
+
+using framework::ir::VarQuantScale;
+
+/*
+ * MkldnnQuantizer turns the MKL-DNN conv2d and pool2d of an initialized
+ * AnalysisPredictor into INT8. It runs the warmup data in FP32, computes the
+ * scales of the inputs, outputs and filters of these ops from the values left
+ * in the scope, and then applies cpu_quantize_pass and
+ * cpu_quantize_squash_pass to the program with the scales.
+ */
+class AnalysisPredictor::MkldnnQuantizer {
+ public:
+  MkldnnQuantizer(AnalysisPredictor* predictor,
+                  const contrib::MkldnnQuantizerConfig* config)
+      : predictor_(*predictor), config_(*config) {}
+
+  bool Quantize();
+
+  const VarQuantScale& scales() const { return scales_; }
+
+  // The scales for the values of the tensor, see VarQuantScale for the
+  // definition of a scale.
+  static std::pair<bool, framework::LoDTensor> GetMaxScale(
+      const framework::LoDTensor& tensor, bool is_unsigned);
+  static std::pair<bool, framework::LoDTensor> GetMaxChScale(
+      const framework::LoDTensor& tensor);
+  static std::pair<bool, framework::LoDTensor> GetKLScale(
+      const framework::LoDTensor& tensor, bool is_unsigned);
+
+ private:
+  const framework::LoDTensor& GetTensor(const std::string& var_name) const;
+  void CalculateScales();
+  void CalculateScale(const std::string& op_type, const std::string& conn_name,
+                      const std::string& var_name, bool is_unsigned);
+  bool RunQuantizePasses();
+
+  AnalysisPredictor& predictor_;
+  const contrib::MkldnnQuantizerConfig& config_;
+  VarQuantScale scales_;
+};
+
+}  // namespace paddle
@@ -0,0 +1,35 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/paddle_mkldnn_quantizer_config.h"
+
+namespace paddle {
+
+contrib::MkldnnQuantizerConfig::MkldnnQuantizerConfig() {
+  enabled_op_types_ = {"conv2d", "pool2d"};
+  // The filters are quantized per output channel.
+  rules_["conv2d"]["Filter"] = ScaleAlgo::MAX_CH;
+}
+
+ScaleAlgo contrib::MkldnnQuantizerConfig::scale_algo(
+    const std::string& op_type, const std::string& conn_name) const {
+  auto op_it = rules_.find(op_type);
+  if (op_it != rules_.end()) {
+    auto it = op_it->second.find(conn_name);
+    if (it != op_it->second.end()) return it->second;
+  }
+  return default_scale_algo_;
+}
+
+}  // namespace paddle
@@ -0,0 +1,77 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/mkldnn_quantizer.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace paddle {
+
+using framework::LoDTensor;
+using Quantizer = AnalysisPredictor::MkldnnQuantizer;
+
+LoDTensor MakeTensor(const std::vector<float>& values,
+                     const framework::DDim& dims) {
+  LoDTensor tensor;
+  float* data = tensor.mutable_data<float>(dims, platform::CPUPlace());
+  std::copy(values.begin(), values.end(), data);
+  return tensor;
+}
+
+TEST(MkldnnQuantizer, max_scale) {
+  auto tensor = MakeTensor({-1.f, 0.5f, -4.f, 2.f}, {4});
+  auto scale = Quantizer::GetMaxScale(tensor, false);
+  EXPECT_FALSE(scale.first);
+  ASSERT_EQ(scale.second.numel(), 1);
+  EXPECT_FLOAT_EQ(scale.second.data<float>()[0], 127.f / 4.f);
+
+  auto unsigned_tensor = MakeTensor({1.f, 0.5f, 5.f, 2.f}, {4});
+  scale = Quantizer::GetMaxScale(unsigned_tensor, true);
+  EXPECT_TRUE(scale.first);
+  EXPECT_FLOAT_EQ(scale.second.data<float>()[0], 255.f / 5.f);
+}
+
+TEST(MkldnnQuantizer, max_ch_scale) {
+  // Three output channels of 2x1x1, the last one is all zero.
+  auto tensor = MakeTensor({1.f, -2.f, 0.5f, 0.25f, 0.f, 0.f}, {3, 2, 1, 1});
+  auto scale = Quantizer::GetMaxChScale(tensor);
+  EXPECT_FALSE(scale.first);
+  ASSERT_EQ(scale.second.numel(), 3);
+  const float* data = scale.second.data<float>();
+  EXPECT_FLOAT_EQ(data[0], 127.f / 2.f);
+  EXPECT_FLOAT_EQ(data[1], 127.f / 0.5f);
+  EXPECT_FLOAT_EQ(data[2], 0.f);
+}
+
+TEST(MkldnnQuantizer, kl_scale) {
+  // The outliers are saturated instead of stretching the range.
+  std::vector<float> values;
+  for (int i = 0; i < 10000; ++i) values.push_back((i % 100) / 100.f);
+  values.push_back(100.f);
+  values.push_back(-80.f);
+  auto tensor = MakeTensor(values, {static_cast<int64_t>(values.size())});
+  auto kl = Quantizer::GetKLScale(tensor, false);
+  auto max = Quantizer::GetMaxScale(tensor, false);
+  EXPECT_FALSE(kl.first);
+  float kl_scale = kl.second.data<float>()[0];
+  EXPECT_GT(kl_scale, 10.f * max.second.data<float>()[0]);
+  // The threshold still covers most of the range of the ordinary values.
+  EXPECT_LT(kl_scale, 127.f / 0.5f);
+
+  auto zeros = MakeTensor({0.f, 0.f}, {2});
+  EXPECT_FLOAT_EQ(Quantizer::GetKLScale(zeros, true).second.data<float>()[0],
+                  255.f);
+}
+
+}  // namespace paddle
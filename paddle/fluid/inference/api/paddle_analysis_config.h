@@ -17,14 +17,16 @@
 #include <memory>
 #include <string>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 /*! \file */
 
 // Here we include some header files with relative paths, for that in deploy,
 // the abstract path of this header file will be changed.
-#include "paddle_api.h"           // NOLINT
-#include "paddle_pass_builder.h"  // NOLINT
+#include "paddle_api.h"                     // NOLINT
+#include "paddle_mkldnn_quantizer_config.h"  // NOLINT
+#include "paddle_pass_builder.h"            // NOLINT
 
 namespace paddle {
 
@@ -37,6 +39,19 @@ namespace contrib {
 
 // NOTE WIP, not stable yet.
 struct AnalysisConfig {
+  // The precision of the TensorRT engines.
+  enum class Precision {
+    kFloat32 = 0,
+    kHalf,
+    kInt8,
+  };
+  // The priority classes of the requests sharing the compute pool.
+  enum class ComputePriority {
+    kHigh = 0,
+    kNormal,
+    kLow,
+  };
+
   AnalysisConfig() = default;
   explicit AnalysisConfig(const AnalysisConfig& other);
   explicit AnalysisConfig(const std::string& model_dir);
@@ -89,6 +104,36 @@ struct AnalysisConfig {
   /** Get the proportion of the initial memory pool size compared to the device.
    */
   float fraction_of_gpu_memory_for_pool() const;
+  /** \brief Persist the cuDNN algorithms found by exhaustive search.
+   *
+   * The algorithms saved in the file are loaded when the predictor is
+   * created, and the newly found ones are written back when it is destroyed,
+   * so that the exhaustive search enabled by FLAGS_cudnn_exhaustive_search is
+   * only done on the first run of the model on a machine.
+   * @param path the file of the cache, which is created if not existed.
+   */
+  void SetCudnnAlgoCacheFile(const std::string& path) {
+    cudnn_algo_cache_file_ = path;
+  }
+  /** Get the file to persist the cuDNN algorithms, empty if not set.
+   */
+  const std::string& cudnn_algo_cache_file() const {
+    return cudnn_algo_cache_file_;
+  }
+
+  /** \brief Cache the optimized program and parameters on the disk.
+   *
+   * The IR optimization of a large model takes seconds on each start of the
+   * predictor, so the optimized model is saved under the directory, keyed by
+   * the program, the parameter files, the config and the passes, and loaded
+   * on the later starts instead of running the analysis again. The models
+   * with TensorRT engines or the static memory plan are not cached.
+   * @param dir the directory of the cache, which is created if not existed.
+   */
+  void SetOptimCacheDir(const std::string& dir) { optim_cache_dir_ = dir; }
+  /** Get the directory of the optimized model cache, empty if not set.
+   */
+  const std::string& optim_cache_dir() const { return optim_cache_dir_; }
 
   /** \brief Control whether to perform IR graph optimization.
    *
@@ -108,6 +153,95 @@ struct AnalysisConfig {
    */
   bool use_feed_fetch_ops_enabled() const { return use_feed_fetch_ops_; }
 
+  /** \brief Back all the temporary tensors with a single arena.
+   *
+   * The lifetimes of the temporary variables are analyzed in the IR
+   * optimization, and the arena is planned with the tensor sizes of the first
+   * run, so it works best when the input shapes are fixed. The later runs do
+   * not allocate the temporary tensors, unless the shapes grow.
+   */
+  void EnableStaticMemoryPlan(bool x = true) { use_static_memory_plan_ = x; }
+  /** A boolean state telling whether the static memory plan is used.
+   */
+  bool static_memory_plan_enabled() const { return use_static_memory_plan_; }
+
+  /** \brief Keep the capacity of the tensor buffers across the runs.
+   *
+   * The buffers of the tensors are rounded up to the size classes, and the
+   * largest recent one of a tensor is kept, so that the runs of the variable
+   * batch sizes or sequence lengths do not reallocate them for every slightly
+   * larger size. A buffer used for less than a half by `shrink_after`
+   * successive runs is reallocated smaller, or never if it is 0. The tensors
+   * of the static memory plan are not shrunk.
+   */
+  void EnableTensorCapacityPolicy(int shrink_after = 16) {
+    use_tensor_capacity_policy_ = true;
+    tensor_shrink_after_ = shrink_after;
+  }
+  /** A boolean state telling whether the tensor capacity policy is used.
+   */
+  bool tensor_capacity_policy_enabled() const {
+    return use_tensor_capacity_policy_;
+  }
+  /** The number of the small uses shrinking a tensor buffer.
+   */
+  int tensor_shrink_after() const { return tensor_shrink_after_; }
+
+  /** \brief Capture the zero-copy runs on GPU into CUDA graphs.
+   *
+   * The first run of an input shape is captured into a graph, and the later
+   * runs of the shape replay it instead of launching the kernels one by one,
+   * which saves the launch overhead of the small batches. It turns on the
+   * static memory plan, so that the tensors keep their addresses. It needs
+   * CUDA 10.1 or later, and the runs with LoD inputs, or with ops writing
+   * to the host memory or synchronizing the stream, are not captured.
+   * @param max_shapes the max number of the input shapes captured.
+   */
+  void EnableCUDAGraph(int max_shapes = 4);
+  /** A boolean state telling whether the CUDA graphs are used.
+   */
+  bool cuda_graph_enabled() const { return use_cuda_graph_; }
+  /** The max number of the input shapes captured into CUDA graphs.
+   */
+  int cuda_graph_max_shapes() const { return cuda_graph_max_shapes_; }
+
+  /** \brief Run the fc and mul ops of the pruned weights by sparse kernels.
+   *
+   * The weights of the fc and mul ops are measured when the model is loaded,
+   * and the ones of `min_sparsity` zeros or more are converted into the CSC
+   * format and run by sparse_fc on CPU, in the time of their nonzeros. The
+   * dense copies of the converted weights are freed. Only works on CPU.
+   */
+  void EnableSparseWeights(float min_sparsity = 0.8f);
+  /** A boolean state telling whether the sparse weights are used.
+   */
+  bool sparse_weights_enabled() const { return use_sparse_weights_; }
+  /** The min ratio of the zeros of a weight run by the sparse kernels.
+   */
+  float sparse_weight_min_sparsity() const {
+    return sparse_weight_min_sparsity_;
+  }
+
+  /** \brief Carry a state of a streaming model across the zero-copy runs.
+   *
+   * After every ZeroCopyRun, the output `state_out`, e.g., the last step of
+   * the hidden of a dynamic_lstm or dynamic_gru, is copied into the input
+   * `state_in`, e.g., the h_0 of it, so that the next run of a chunk of the
+   * stream goes on from there instead of running the whole stream again.
+   * Feed the initial states before the first run as the other inputs; the
+   * states are kept by each predictor, so every clone is a session of its
+   * own, and PaddlePredictor::ResetStates() zeroes them for a new stream.
+   * `state_out` should be kept as a fetch target of the model.
+   */
+  void AddStateVar(const std::string& state_in, const std::string& state_out) {
+    state_vars_.emplace_back(state_in, state_out);
+  }
+  /** The pairs of the state inputs and outputs of AddStateVar.
+   */
+  const std::vector<std::pair<std::string, std::string>>& state_vars() const {
+    return state_vars_;
+  }
+
   /** \brief Control whether to specify the inputs' names.
    *
    * The PaddleTensor type has a `name` member, assign it with the corresponding
@@ -133,12 +267,50 @@ struct AnalysisConfig {
    * better set as small as possible, or performance loss.
    * @param min_subgrpah_size the minimum TensorRT subgraph size needed, if a
    * subgraph is less than this, it will not transfer to TensorRT engine.
+   * @param precision the precision of the TensorRT layers. For kInt8, the
+   * first runs of the predictor are used to calibrate, see
+   * SetTensorRtInt8CalibrationBatchNum.
    */
   void EnableTensorRtEngine(int workspace_size = 1 << 20,
-                            int max_batch_size = 1, int min_subgraph_size = 3);
+                            int max_batch_size = 1, int min_subgraph_size = 3,
+                            Precision precision = Precision::kFloat32);
   /** A boolean state telling whether the TensorRT engine is used.
    */
   bool tensorrt_engine_enabled() const { return use_tensorrt_; }
+  /** \brief Set the number of batches to calibrate the INT8 engines.
+   *
+   * Without a calibration table, the first `batch_num` runs of the predictor
+   * use FP32 engines and feed their inputs, which should be representative
+   * with the same batch size, to the INT8 calibrator. The INT8 engines are
+   * built after that. The calibration table is saved next to the engines if
+   * SetTensorRtEngineCacheDir is set, so the calibration is done only once.
+   */
+  void SetTensorRtInt8CalibrationBatchNum(int batch_num) {
+    tensorrt_calibration_batch_num_ = batch_num;
+  }
+  /** \brief Keep the TensorRT engines of several input shapes.
+   *
+   * A TensorRT engine takes the fixed shapes of the inputs except the
+   * batch, so an engine is built, or loaded from the engine cache, for
+   * every new input shape of a subgraph, e.g., the images of the different
+   * sizes. Up to `max_engines` of them are kept for a subgraph, and the
+   * least recently used one is dropped for a new shape.
+   */
+  void SetTensorRtMaxShapeEngines(int max_engines) {
+    tensorrt_max_shape_engines_ = max_engines;
+  }
+  /** \brief Cache the serialized TensorRT engines in a directory.
+   *
+   * The engines built on the first run are saved in the directory, and are
+   * loaded instead of being built again on the following runs. The engines
+   * are keyed by the subgraph, the input shapes, the parameters, the max
+   * batch size, the workspace size, the GPU model and the TensorRT version.
+   * The engines with plugin layers are not cached.
+   * @param cache_dir the directory, which is created if not existed.
+   */
+  void SetTensorRtEngineCacheDir(const std::string& cache_dir) {
+    tensorrt_engine_cache_dir_ = cache_dir;
+  }
 
   /** Control whther to debug IR graph analysis phase.
    */
@@ -151,6 +323,36 @@ struct AnalysisConfig {
    */
   bool mkldnn_enabled() const { return use_mkldnn_; }
 
+  /** \brief Run the MKL-DNN conv2d and pool2d with the INT8 kernels.
+   *
+   * The predictor runs the warmup data set in mkldnn_quantizer_config() once
+   * in FP32, computes the quantization scales of the variables from their
+   * values, and then inserts the quantize/dequantize ops around the INT8 ops.
+   * It only works with EnableMKLDNN(). The inplace_op_pass and the static
+   * memory plan are turned off, since the variables of the warmup run must
+   * not share their buffers.
+   */
+  void EnableMkldnnQuantizer();
+  /** A boolean state telling whether the MKL-DNN INT8 quantization is used.
+   */
+  bool mkldnn_quantizer_enabled() const { return use_mkldnn_quantizer_; }
+  /** Get the configuration of the MKL-DNN INT8 quantization.
+   */
+  MkldnnQuantizerConfig* mkldnn_quantizer_config() const;
+
+  /** \brief Bound the MKL-DNN primitives kept for the inputs of many shapes.
+   *
+   * The primitives are cached for each shape of the inputs, and those of the
+   * least recently used shapes are dropped when there are more than
+   * `capacity` shapes, e.g. with the variable batch sizes or sequence
+   * lengths. It only works with EnableMKLDNN().
+   * @param capacity the number of the shapes, 0 for no limit.
+   */
+  void SetMkldnnCacheCapacity(int capacity);
+  /** The number of the input shapes whose MKL-DNN primitives are cached.
+   */
+  int mkldnn_cache_capacity() const { return mkldnn_cache_capacity_; }
+
   /** Set and get the number of cpu math library threads.
    */
   void SetCpuMathLibraryNumThreads(int cpu_math_library_num_threads);
@@ -160,6 +362,53 @@ struct AnalysisConfig {
     return cpu_math_library_num_threads_;
   }
 
+  /** \brief Bind the predictor to a NUMA node of the host.
+   *
+   * The threads running the predictor, and so the threads of the CPU math
+   * library they start, are pinned to the cpus of the node, and the memory
+   * they touch first is taken from the node. With numa_node < 0, the
+   * predictor is bound to node 0 and its clones to the nodes in turn. It
+   * takes effect only on Linux with CPU.
+   * @param numa_node the node, or -1 to spread the clones over the nodes.
+   * @param replicate_params whether a clone bound to another node than the
+   * predictor copies the parameters to its node instead of sharing them.
+   */
+  void EnableNumaBinding(int numa_node = -1, bool replicate_params = false);
+  /** A boolean state telling whether the predictor is bound to a NUMA node.
+   */
+  bool numa_binding_enabled() const { return use_numa_binding_; }
+  /** The NUMA node of the predictor, -1 to spread the clones.
+   */
+  int numa_node() const { return numa_node_; }
+  /** A boolean state telling whether the clones replicate the parameters.
+   */
+  bool numa_params_replica() const { return numa_params_replica_; }
+
+  /** \brief Run the CPU kernels on the compute pool shared by the process.
+   *
+   * The parallel loops of the GEMM, elementwise and reduce kernels are split
+   * on the FLAGS_compute_pool_threads threads shared by all the predictors of
+   * the process instead, and the CPU math library runs in one thread, so that
+   * the models hosted together do not oversubscribe the cpus. The predictor
+   * and its clones take at most max_threads threads of the pool at a time,
+   * and the work of a higher priority is taken first.
+   * @param max_threads the quota of the predictor and its clones.
+   * @param priority the priority of the requests of the predictor.
+   */
+  void EnableSharedComputePool(
+      int max_threads, ComputePriority priority = ComputePriority::kNormal);
+  /** A boolean state telling whether the compute pool is shared.
+   */
+  bool shared_compute_pool_enabled() const {
+    return use_shared_compute_pool_;
+  }
+  /** The threads of the shared compute pool the predictor takes at most.
+   */
+  int compute_pool_max_threads() const { return compute_pool_max_threads_; }
+  /** The priority of the requests of the predictor on the compute pool.
+   */
+  ComputePriority compute_priority() const { return compute_priority_; }
+
   /** Transform the AnalysisConfig to NativeConfig.
    */
   NativeConfig ToNativeConfig() const {
@@ -192,6 +441,33 @@ struct AnalysisConfig {
    */
   bool model_from_memory() const { return model_from_memory_; }
 
+  /** Map the composed parameters file into memory instead of reading it, the
+   * CPU parameters alias the mapped pages, so that the predictors of several
+   * processes on one host share the memory of the same file. The pages are
+   * copy-on-write, a parameter modified by an optimization pass gets its own
+   * copy. It takes effect only with the composed parameters file on CPU.
+   * @param x whether to map the parameters file.
+   */
+  void EnableMmapParams(bool x = true) { mmap_params_ = x; }
+  /** A boolean state telling whether the parameters file is mapped.
+   */
+  bool mmap_params_enabled() const { return mmap_params_; }
+
+  /** \brief Share the parameters with the other predictors of the model.
+   *
+   * The predictors created with the same model, device and passes, while
+   * one of them is alive, share the parameters, which are loaded to the
+   * device once, and the optimized program, as Clone() does. Each predictor
+   * only has its own temporary variables. The parameters are read-only when
+   * the predictor runs, so the predictors sharing them can run concurrently,
+   * each in one thread; a predictor itself is not thread-safe.
+   * @param x whether to share the parameters.
+   */
+  void EnableParamsSharing(bool x = true) { params_sharing_ = x; }
+  /** A boolean state telling whether the parameters are shared.
+   */
+  bool params_sharing_enabled() const { return params_sharing_; }
+
   friend class ::paddle::AnalysisPredictor;
 
   /** NOTE just for developer, not an official API, easily to be broken.
@@ -203,18 +479,20 @@ struct AnalysisConfig {
   // Update the config.
   void Update();
 
-  std::string SerializeInfoCache();
+  std::string SerializeInfoCache() const;
 
  protected:
   // Model pathes.
   std::string model_dir_;
   std::string prog_file_;
   std::string params_file_;
+  std::string optim_cache_dir_;
 
   // GPU releated.
   bool use_gpu_{false};
   int device_id_{0};
   uint64_t memory_pool_init_size_mb_{100};  // initial size is 100MB.
+  std::string cudnn_algo_cache_file_;
 
   // TensorRT releated.
   bool use_tensorrt_{false};
@@ -231,18 +509,46 @@ struct AnalysisConfig {
   //  We set this variable to control the minimum number of nodes in the
   //  subgraph, 3 as default value.
   int tensorrt_min_subgraph_size_{3};
+  Precision tensorrt_precision_mode_{Precision::kFloat32};
+  int tensorrt_calibration_batch_num_{10};
+  int tensorrt_max_shape_engines_{1};
+  std::string tensorrt_engine_cache_dir_;
 
   bool use_mkldnn_{false};
   std::unordered_set<std::string> mkldnn_enabled_op_types_;
 
+  bool use_mkldnn_quantizer_{false};
+  std::shared_ptr<MkldnnQuantizerConfig> mkldnn_quantizer_config_;
+  int mkldnn_cache_capacity_{0};
+
   bool model_from_memory_{false};
+  bool mmap_params_{false};
+  bool params_sharing_{false};
+
+  bool use_numa_binding_{false};
+  int numa_node_{-1};
+  bool numa_params_replica_{false};
+
+  bool use_shared_compute_pool_{false};
+  int compute_pool_max_threads_{1};
+  ComputePriority compute_priority_{ComputePriority::kNormal};
 
   bool enable_ir_optim_{true};
   bool use_feed_fetch_ops_{true};
   bool ir_debug_{false};
 
+  bool use_static_memory_plan_{false};
+  bool use_tensor_capacity_policy_{false};
+  int tensor_shrink_after_{16};
+  bool use_cuda_graph_{false};
+  int cuda_graph_max_shapes_{4};
+  bool use_sparse_weights_{false};
+  float sparse_weight_min_sparsity_{0.8f};
+
   bool specify_input_name_{false};
 
+  std::vector<std::pair<std::string, std::string>> state_vars_;
+
   int cpu_math_library_num_threads_{1};
 
   // A runtime cache, shouldn't be transferred to others.
@@ -17,6 +17,7 @@
  */
 
 #include <cassert>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -130,6 +131,19 @@ class ZeroCopyTensor {
   template <typename T>
   T* data(PaddlePlace* place, int* size) const;
 
+  /** Bind the memory allocated outside as the memory of the tensor, without
+   * copy. The memory is not owned by the tensor, and should be available until
+   * the tensor is rebound or the predictor is destroyed.
+   * For GPU memory, the device is the one the memory is on. If stream, a
+   * cudaStream_t, is not null, the predictor waits for the work queued on it
+   * before the next run, e.g., the kernel writing the input.
+   * For the output tensor, the memory should be large enough for the output,
+   * or the output is written into a new allocation.
+   */
+  template <typename T>
+  void ShareExternalData(T* data, const std::vector<int>& shape,
+                         PaddlePlace place, void* stream = nullptr);
+
   std::vector<int64_t> shape() const;
 
   void SetLoD(const std::vector<std::vector<size_t>>& x);
@@ -148,6 +162,74 @@ class ZeroCopyTensor {
   void* scope_{nullptr};
 };
 
+namespace framework {
+class RunContext;
+}  // namespace framework
+
+/** \brief The deadline, the cancellation and the priority of a request.
+ *
+ * A run with the context, see PaddlePredictor::RunWithContext, checks it
+ * between the ops and at the boundaries of the TensorRT subgraphs, and stops
+ * with false at the first check after the context is cancelled or its
+ * deadline has passed, so that the requests whose clients are gone do not
+ * take the cpus of the others under overload. Cancel may be called from any
+ * thread while the run is in flight, the other setters before the run.
+ */
+class PaddleRunContext {
+ public:
+  /** The priority of the work of the request on the compute pool shared by
+   * the predictors, see AnalysisConfig::EnableSharedComputePool, and of the
+   * request waiting for a predictor of a PredictorPool.
+   */
+  enum class Priority {
+    kHigh = 0,
+    kNormal,
+    kLow,
+  };
+
+  PaddleRunContext();
+  ~PaddleRunContext();
+  PaddleRunContext(const PaddleRunContext&) = delete;
+  PaddleRunContext& operator=(const PaddleRunContext&) = delete;
+
+  /** Set the deadline to timeout_ms milliseconds from now, or no deadline
+   * if timeout_ms <= 0.
+   */
+  void SetTimeout(int64_t timeout_ms);
+  /** Stop the run of the request at the next check.
+   */
+  void Cancel();
+  /** A boolean state telling whether the request is cancelled.
+   */
+  bool cancelled() const;
+  /** A boolean state telling whether the deadline has passed.
+   */
+  bool expired() const;
+  /** A boolean state telling whether a run of the request stops.
+   */
+  bool stopped() const { return cancelled() || expired(); }
+
+  /** Set the priority of the request, which overrides the one of the
+   * predictor on the compute pool.
+   */
+  void SetPriority(Priority priority) {
+    priority_ = priority;
+    has_priority_ = true;
+  }
+  /** A boolean state telling whether the priority is set.
+   */
+  bool has_priority() const { return has_priority_; }
+  /** The priority of the request, kNormal if not set.
+   */
+  Priority priority() const { return priority_; }
+
+ private:
+  friend class AnalysisPredictor;
+  std::unique_ptr<framework::RunContext> ctx_;
+  Priority priority_{Priority::kNormal};
+  bool has_priority_{false};
+};
+
 /** A simple Inference API for Paddle.
  */
 class PaddlePredictor {
@@ -181,8 +263,37 @@ class PaddlePredictor {
   }
   virtual bool ZeroCopyRun() { return false; }
 
-  /** Clone a predictor that share the model weights, the Cloned predictor
-   * should be thread-safe.
+  /** Run with the deadline, the cancellation and the priority of ctx, see
+   * PaddleRunContext, which may be nullptr. Return false without the
+   * outputs if the run is stopped by ctx. The predictors not checking the
+   * context between the ops only check it before the run.
+   */
+  virtual bool RunWithContext(const std::vector<PaddleTensor>& inputs,
+                              std::vector<PaddleTensor>* output_data,
+                              PaddleRunContext* ctx, int batch_size = -1);
+  /** The zero copy run with the context, see RunWithContext.
+   */
+  virtual bool ZeroCopyRunWithContext(PaddleRunContext* ctx);
+
+  /** Run the zero copy inference on the CUDA stream of the caller, a
+   * cudaStream_t, and return without waiting for the computation. The outputs
+   * are ready after the work queued on the stream completes, e.g., by
+   * cudaStreamSynchronize or a cudaEvent recorded after this call.
+   * The variables of a predictor are reused by every run, so use a clone of
+   * the predictor for each request in flight to pipeline the requests.
+   */
+  virtual bool ZeroCopyRunAsync(void* stream) { return false; }
+
+  /** Zero the states carried across the zero copy runs of a streaming
+   * model, see AnalysisConfig::AddStateVar, so that the next run starts a new
+   * stream. Return false if the predictor does not carry states.
+   */
+  virtual bool ResetStates() { return false; }
+
+  /** Clone a predictor that share the model weights, which are read-only
+   * when the predictors run, on the same device. The clone has its own
+   * temporary variables, so the predictor and its clones can run
+   * concurrently, each in one thread. A predictor itself is not thread-safe.
    */
   virtual std::unique_ptr<PaddlePredictor> Clone() = 0;
 
@@ -28,6 +28,7 @@ limitations under the License. */
 
 #include "paddle_analysis_config.h"  // NOLINT
 #include "paddle_api.h"              // NOLINT
+#include "paddle_predictor_pool.h"   // NOLINT
 #ifdef WITH_ANAKIN
 #include "paddle_anakin_config.h"  // NOLINT
 #endif
@@ -0,0 +1,86 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+/*! \file */
+
+#include "paddle_api.h"  // NOLINT
+
+namespace paddle {
+
+/** The algorithms to compute the quantization scale of a variable from its
+ * values in the warmup run.
+ */
+enum class ScaleAlgo {
+  NONE,    // Do not compute the scale, the op stays in FP32.
+  MAX,     // The maximum absolute value of the tensor.
+  MAX_CH,  // The maximum absolute value of each output channel, for filters.
+  KL,      // The threshold minimizing the KL divergence of the histograms.
+};
+
+namespace contrib {
+
+/** The configuration of the INT8 quantization of the MKL-DNN kernels, see
+ * AnalysisConfig::EnableMkldnnQuantizer().
+ */
+struct MkldnnQuantizerConfig {
+  MkldnnQuantizerConfig();
+
+  /** Set the algorithm to compute the scale of the variable in the slot
+   * conn_name (e.g. "Input" or "Filter") of the op type.
+   */
+  void SetScaleAlgo(const std::string& op_type, const std::string& conn_name,
+                    ScaleAlgo algo) {
+    rules_[op_type][conn_name] = algo;
+  }
+  /** Get the algorithm of the slot, the default one is KL.
+   */
+  ScaleAlgo scale_algo(const std::string& op_type,
+                       const std::string& conn_name) const;
+
+  /** Set the inputs of the warmup run, which should be a representative batch
+   * of the real data.
+   */
+  void SetWarmupData(std::shared_ptr<std::vector<PaddleTensor>> data) {
+    warmup_data_ = data;
+  }
+  std::shared_ptr<std::vector<PaddleTensor>> warmup_data() const {
+    return warmup_data_;
+  }
+
+  /** Specify the op types to run in INT8, the supported ones are conv2d and
+   * pool2d.
+   */
+  void SetEnabledOpTypes(std::unordered_set<std::string> op_list) {
+    enabled_op_types_ = op_list;
+  }
+  const std::unordered_set<std::string>& enabled_op_types() const {
+    return enabled_op_types_;
+  }
+
+ protected:
+  std::map<std::string, std::map<std::string, ScaleAlgo>> rules_;
+  std::unordered_set<std::string> enabled_op_types_;
+  std::shared_ptr<std::vector<PaddleTensor>> warmup_data_;
+  ScaleAlgo default_scale_algo_{ScaleAlgo::KL};
+};
+
+}  // namespace contrib
+}  // namespace paddle
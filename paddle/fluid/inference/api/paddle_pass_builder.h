@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -87,10 +88,14 @@ class CpuPassStrategy : public PassStrategy {
     // NOTE the large fusions should be located in the front, so that they will
     // not be damaged by smaller ones.
     passes_.assign({
-        "infer_clean_graph_pass",         //
-        "attention_lstm_fuse_pass",       //
-        "seqpool_concat_fuse_pass",       //
-        "seqconv_eltadd_relu_fuse_pass",  //
+        "infer_clean_graph_pass",           //
+        "constant_folding_pass",            //
+        "multihead_attention_fuse_pass",    //
+        "fuse_elewise_add_layernorm_pass",  //
+        "attention_lstm_fuse_pass",         //
+        "seqpool_concat_fuse_pass",         //
+        "embedding_seqpool_fuse_pass",      //
+        "seqconv_eltadd_relu_fuse_pass",    //
         // "embedding_fc_lstm_fuse_pass", //
         "fc_lstm_fuse_pass",             //
         "mul_lstm_fuse_pass",            //
@@ -101,6 +106,7 @@ class CpuPassStrategy : public PassStrategy {
         "conv_bn_fuse_pass",             //
         "conv_eltwiseadd_bn_fuse_pass",  //
         "is_test_pass",                  //
+        "inplace_op_pass",               //
     });
     use_gpu_ = false;
   }
@@ -112,13 +118,16 @@ class CpuPassStrategy : public PassStrategy {
 #ifdef PADDLE_WITH_MKLDNN
     passes_.insert(passes_.begin(), "mkldnn_placement_pass");
 
+    // The fusions should be before the inplace_op_pass, which is the last.
+    auto it = std::find(passes_.begin(), passes_.end(), "inplace_op_pass");
     for (auto &pass :
          std::vector<std::string>({"depthwise_conv_mkldnn_pass",    //
                                    "conv_bias_mkldnn_fuse_pass",    //
                                    "conv3d_bias_mkldnn_fuse_pass",  //
                                    "conv_relu_mkldnn_fuse_pass",    //
-                                   "conv_elementwise_add_mkldnn_fuse_pass"})) {
-      passes_.push_back(pass);
+                                   "conv_elementwise_add_mkldnn_fuse_pass",  //
+                                   "mkldnn_layout_propagation_pass"})) {
+      it = passes_.insert(it, pass) + 1;
     }
 #endif
   }
@@ -133,18 +142,26 @@ class GpuPassStrategy : public PassStrategy {
   GpuPassStrategy() : PassStrategy({}) {
     passes_.assign({
         "infer_clean_graph_pass",                    //
+        "constant_folding_pass",                     //
+        "multihead_attention_fuse_pass",             //
+        "fuse_elewise_add_layernorm_pass",           //
+        "embedding_seqpool_fuse_pass",               //
         "conv_affine_channel_fuse_pass",             //
         "conv_eltwiseadd_affine_channel_fuse_pass",  //
         "conv_bn_fuse_pass",                         //
         "conv_elementwise_add_act_fuse_pass",        //
         "conv_elementwise_add2_act_fuse_pass",       //
         "conv_elementwise_add_fuse_pass",            //
+        "fuse_elementwise_chain_pass",               //
     });
 
     for (int i = 6; i >= 3; i--) {
       passes_.push_back("transpose_flatten" + std::to_string(i) +
                         "_concat_fuse_pass");
     }
+    // Rename the vars after all the fusions, which match the vars by the
+    // graph structure.
+    passes_.push_back("inplace_op_pass");
     use_gpu_ = true;
   }
 
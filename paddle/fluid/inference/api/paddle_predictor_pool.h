@@ -0,0 +1,132 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "paddle_analysis_config.h"  // NOLINT
+#include "paddle_api.h"              // NOLINT
+
+namespace paddle {
+
+/** \brief A fixed set of predictors of a model for the serving threads.
+ *
+ * The predictors are a predictor and its clones, which share the parameters.
+ * A serving thread checks out a free predictor for a request and returns it
+ * after the request, the checkout and the return are lock-free. Each
+ * predictor keeps its variables, the feed/fetch tensors included, between
+ * the runs, so a run does not allocate them again once the predictor is
+ * warmed up with the largest inputs.
+ *
+ * e.g.
+ *
+ * PredictorPool pool(config, 8);
+ * pool.Warmup(inputs);
+ * // In a serving thread.
+ * auto predictor = pool.Checkout();
+ * predictor->Run(inputs, &outputs);
+ *
+ * With AnalysisConfig::EnableNumaBinding(), the thread running a predictor
+ * is bound to its node, use a pool of predictors on one node for the threads
+ * of the node.
+ */
+class PredictorPool {
+ public:
+  /** A predictor checked out of the pool, which is returned to the pool when
+   * the handle is destroyed or released.
+   */
+  class Handle {
+   public:
+    Handle() = default;
+    Handle(Handle&& other);
+    Handle& operator=(Handle&& other);
+    Handle(const Handle&) = delete;
+    Handle& operator=(const Handle&) = delete;
+    ~Handle() { Release(); }
+
+    PaddlePredictor* get() const;
+    PaddlePredictor* operator->() const { return get(); }
+    PaddlePredictor& operator*() const { return *get(); }
+    /** A boolean state telling whether the handle holds a predictor.
+     */
+    explicit operator bool() const { return pool_ != nullptr; }
+
+    /** Return the predictor to the pool before the handle is destroyed.
+     */
+    void Release();
+
+   private:
+    friend class PredictorPool;
+    Handle(PredictorPool* pool, int index) : pool_(pool), index_(index) {}
+
+    PredictorPool* pool_{nullptr};
+    int index_{-1};
+  };
+
+  /** Create the predictor of the config and size - 1 clones of it.
+   */
+  PredictorPool(const contrib::AnalysisConfig& config, int size);
+  /** All the handles should be released before the pool is destroyed.
+   */
+  ~PredictorPool();
+
+  /** Run every predictor on the inputs repeat times, so that the first
+   * requests do not pay for the lazy initialization and the allocations.
+   */
+  bool Warmup(const std::vector<PaddleTensor>& inputs, int repeat = 1);
+
+  /** Check out a free predictor, wait for a predictor to be returned if all
+   * of them are checked out. The waiting requests of a higher priority of
+   * ctx, see PaddleRunContext::Priority, take the returned predictors first,
+   * and the requests with no ctx are of kNormal. Return an empty handle if
+   * ctx is cancelled or expired before a predictor is checked out, so that
+   * the stale requests are dropped before they run.
+   */
+  Handle Checkout(const PaddleRunContext* ctx = nullptr);
+  /** Check out a free predictor, or return an empty handle if all of them
+   * are checked out.
+   */
+  Handle TryCheckout();
+
+  /** The number of the predictors.
+   */
+  int size() const { return static_cast<int>(predictors_.size()); }
+  /** The number of the predictors which are not checked out.
+   */
+  int num_free() const { return num_free_.load(); }
+
+ private:
+  // The free predictors are a lock-free stack: the low 32 bits of head_ are
+  // the top index + 1 (0 if empty), the high 32 bits are a version, which is
+  // increased by every push and pop to make the compare-and-swap fail if the
+  // top is popped and pushed again in between. next_[i] is the free predictor
+  // under i, -1 for the bottom.
+  int Pop();
+  void Push(int index);
+  // Whether the requests of a priority higher than priority are waiting.
+  bool HigherWaiting(int priority) const;
+
+  std::vector<std::unique_ptr<PaddlePredictor>> predictors_;
+  std::unique_ptr<std::atomic<int>[]> next_;
+  std::atomic<uint64_t> head_{0};
+  std::atomic<int> num_free_{0};
+  // The numbers of the waiting requests by the priorities.
+  std::atomic<int> num_waiting_[3];
+};
+
+}  // namespace paddle
@@ -0,0 +1,147 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/paddle_predictor_pool.h"
+#include <glog/logging.h>
+#include <thread>  // NOLINT
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+
+static constexpr uint64_t kIndexMask = 0xffffffffULL;
+
+PredictorPool::Handle::Handle(Handle &&other)
+    : pool_(other.pool_), index_(other.index_) {
+  other.pool_ = nullptr;
+  other.index_ = -1;
+}
+
+PredictorPool::Handle &PredictorPool::Handle::operator=(Handle &&other) {
+  if (this != &other) {
+    Release();
+    pool_ = other.pool_;
+    index_ = other.index_;
+    other.pool_ = nullptr;
+    other.index_ = -1;
+  }
+  return *this;
+}
+
+PaddlePredictor *PredictorPool::Handle::get() const {
+  return pool_ ? pool_->predictors_[index_].get() : nullptr;
+}
+
+void PredictorPool::Handle::Release() {
+  if (pool_) {
+    pool_->Push(index_);
+    pool_ = nullptr;
+    index_ = -1;
+  }
+}
+
+PredictorPool::PredictorPool(const contrib::AnalysisConfig &config, int size) {
+  PADDLE_ENFORCE_GT(size, 0, "The size of the predictor pool should be > 0");
+  for (auto &num : num_waiting_) {
+    num = 0;
+  }
+  predictors_.emplace_back(
+      CreatePaddlePredictor<contrib::AnalysisConfig>(config));
+  PADDLE_ENFORCE_NOT_NULL(predictors_.front(), "Failed to create predictor");
+  for (int i = 1; i < size; ++i) {
+    predictors_.emplace_back(predictors_.front()->Clone());
+  }
+  next_.reset(new std::atomic<int>[size]);
+  for (int i = size - 1; i >= 0; --i) {
+    Push(i);
+  }
+}
+
+PredictorPool::~PredictorPool() {
+  if (num_free() != size()) {
+    LOG(ERROR) << size() - num_free()
+               << " predictors are not returned to the pool";
+  }
+}
+
+bool PredictorPool::Warmup(const std::vector<PaddleTensor> &inputs,
+                           int repeat) {
+  std::vector<PaddleTensor> outputs;
+  for (auto &predictor : predictors_) {
+    for (int i = 0; i < repeat; ++i) {
+      if (!predictor->Run(inputs, &outputs)) return false;
+    }
+  }
+  return true;
+}
+
+PredictorPool::Handle PredictorPool::Checkout(const PaddleRunContext *ctx) {
+  if (ctx && ctx->stopped()) return Handle();
+  int priority = static_cast<int>(
+      ctx ? ctx->priority() : PaddleRunContext::Priority::kNormal);
+  int index = HigherWaiting(priority) ? -1 : Pop();
+  if (index >= 0) return Handle(this, index);
+  num_waiting_[priority].fetch_add(1);
+  while (true) {
+    if (ctx && ctx->stopped()) break;
+    if (!HigherWaiting(priority) && (index = Pop()) >= 0) break;
+    std::this_thread::yield();
+  }
+  num_waiting_[priority].fetch_sub(1);
+  return index < 0 ? Handle() : Handle(this, index);
+}
+
+PredictorPool::Handle PredictorPool::TryCheckout() {
+  int index = Pop();
+  return index < 0 ? Handle() : Handle(this, index);
+}
+
+bool PredictorPool::HigherWaiting(int priority) const {
+  for (int i = 0; i < priority; ++i) {
+    if (num_waiting_[i].load(std::memory_order_relaxed) > 0) return true;
+  }
+  return false;
+}
+
+int PredictorPool::Pop() {
+  uint64_t head = head_.load(std::memory_order_acquire);
+  while (true) {
+    int top = static_cast<int>(head & kIndexMask) - 1;
+    if (top < 0) return -1;
+    // next_[top] may be changed if top is popped and pushed by the others,
+    // then the version of head_ is changed too and the swap fails.
+    int next = next_[top].load(std::memory_order_relaxed);
+    uint64_t new_head = (((head >> 32) + 1) << 32) |
+                        static_cast<uint32_t>(next + 1);
+    if (head_.compare_exchange_weak(head, new_head, std::memory_order_acq_rel,
+                                    std::memory_order_acquire)) {
+      num_free_.fetch_sub(1, std::memory_order_relaxed);
+      return top;
+    }
+  }
+}
+
+void PredictorPool::Push(int index) {
+  num_free_.fetch_add(1, std::memory_order_relaxed);
+  uint64_t head = head_.load(std::memory_order_relaxed);
+  uint64_t new_head;
+  do {
+    next_[index].store(static_cast<int>(head & kIndexMask) - 1,
+                       std::memory_order_relaxed);
+    new_head = (((head >> 32) + 1) << 32) | static_cast<uint32_t>(index + 1);
+  } while (!head_.compare_exchange_weak(head, new_head,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed));
+}
+
+}  // namespace paddle
@@ -19,7 +19,9 @@ limitations under the License. */
 #include <vector>
 #include "paddle/fluid/framework/block_desc.h"
 #include "paddle/fluid/framework/feed_fetch_type.h"
+#include "paddle/fluid/framework/indexed_params.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/parallel_tensor_loader.h"
 #include "paddle/fluid/framework/version.h"
 #include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/pybind/pybind.h"
@@ -28,6 +30,9 @@ DEFINE_string(devices, "", "The devices to be used which is joined by comma.");
 DEFINE_bool(init_p2p, false, "Whether to init p2p.");
 DEFINE_int32(math_num_threads, 1,
              "Number of threads used to run math functions.");
+DEFINE_int32(load_persistables_threads, 8,
+             "The number of persistables loaded concurrently on the IO thread "
+             "pool, 1 to load them one by one.");
 
 namespace paddle {
 namespace inference {
@@ -66,6 +71,20 @@ bool IsPersistable(const framework::VarDesc* var) {
   return false;
 }
 
+void LoadSeparateParams(framework::Scope* scope,
+                        const std::vector<std::string>& names,
+                        const std::string& dirname,
+                        const platform::Place& place) {
+  framework::ParallelTensorLoader loader(place);
+  for (auto& name : names) {
+    loader.AddStream(dirname + "/" + name, 0,
+                     scope->Var(name)->GetMutable<framework::LoDTensor>());
+  }
+  loader.Run(FLAGS_load_persistables_threads);
+  VLOG(1) << "Load " << names.size() << " persistables from " << dirname
+          << ", " << loader.StatsString();
+}
+
 void LoadPersistables(framework::Executor* executor, framework::Scope* scope,
                       const framework::ProgramDesc& main_program,
                       const std::string& dirname,
@@ -76,6 +95,8 @@ void LoadPersistables(framework::Executor* executor, framework::Scope* scope,
   framework::ProgramDesc* load_program = new framework::ProgramDesc();
   framework::BlockDesc* load_block = load_program->MutableBlock(0);
   std::vector<std::string> paramlist;
+  // The LoDTensors in separate files loaded in parallel instead of by ops.
+  std::vector<std::string> parallel_list;
 
   for (auto* var : global_block.AllVars()) {
     if (IsPersistable(var)) {
@@ -90,6 +111,9 @@ void LoadPersistables(framework::Executor* executor, framework::Scope* scope,
 
       if (!param_filename.empty()) {
         paramlist.push_back(new_var->Name());
+      } else if (FLAGS_load_persistables_threads > 1 &&
+                 var->GetType() == framework::proto::VarType::LOD_TENSOR) {
+        parallel_list.push_back(new_var->Name());
       } else {
         // append_op
         framework::OpDesc* op = load_block->AppendOp();
@@ -110,14 +134,33 @@ void LoadPersistables(framework::Executor* executor, framework::Scope* scope,
     op->SetOutput("Out", paramlist);
     op->SetAttr("file_path", {param_filename});
     op->SetAttr("model_from_memory", {model_from_memory});
+    op->SetAttr("num_threads", {FLAGS_load_persistables_threads});
     op->CheckAttrs();
   }
 
   executor->Run(*load_program, scope, 0, true, true);
+  if (!parallel_list.empty()) {
+    LoadSeparateParams(scope, parallel_list, dirname, executor->GetPlace());
+  }
 
   delete load_program;
 }
 
+void LoadIndexedParams(framework::Scope* scope,
+                       const std::string& param_filename,
+                       const std::vector<std::string>& names,
+                       const platform::Place& place, int num_threads,
+                       bool use_mmap) {
+  framework::IndexedParamsReader reader(param_filename, use_mmap);
+  std::vector<framework::LoDTensor*> tensors;
+  for (auto& name : names) {
+    tensors.push_back(scope->Var(name)->GetMutable<framework::LoDTensor>());
+  }
+  reader.Load(names, tensors, place, num_threads);
+  VLOG(3) << "load " << names.size() << " of " << reader.names().size()
+          << " tensors from " << param_filename;
+}
+
 std::unique_ptr<framework::ProgramDesc> Load(framework::Executor* executor,
                                              framework::Scope* scope,
                                              const std::string& dirname) {
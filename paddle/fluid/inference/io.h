@@ -27,12 +27,30 @@ namespace inference {
 
 void Init(const std::vector<std::string> argv);
 
+// Load the LoDTensors of the names, each saved by the save op in its own file
+// of the directory, with FLAGS_load_persistables_threads of them loaded
+// concurrently, see framework::ParallelTensorLoader.
+void LoadSeparateParams(framework::Scope* scope,
+                        const std::vector<std::string>& names,
+                        const std::string& dirname,
+                        const platform::Place& place);
+
 void LoadPersistables(framework::Executor* executor, framework::Scope* scope,
                       const framework::ProgramDesc& main_program,
                       const std::string& dirname,
                       const std::string& param_filename,
                       bool model_from_memory);
 
+// Load the tensors of the names from the params file in the indexed format,
+// see framework/indexed_params.h, to the variables of the scope, which are
+// created if they do not exist. The names can be any subset of the saved
+// tensors, e.g., only the shards a pserver owns.
+void LoadIndexedParams(framework::Scope* scope,
+                       const std::string& param_filename,
+                       const std::vector<std::string>& names,
+                       const platform::Place& place, int num_threads = 1,
+                       bool use_mmap = false);
+
 std::unique_ptr<framework::ProgramDesc> Load(framework::Executor* executor,
                                              framework::Scope* scope,
                                              const std::string& dirname);
@@ -0,0 +1,98 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+/*
+ * AffineChannel converter from fluid to tensorRT, the input should be in
+ * NCHW, which the channel scale layer applies to.
+ */
+class AffineChannelOpConverter : public OpConverter {
+ public:
+  void operator()(const framework::proto::OpDesc& op,
+                  const framework::Scope& scope, bool test_mode) override {
+    VLOG(4) << "convert a fluid affine_channel op to tensorrt scale layer";
+
+    framework::OpDesc op_desc(op, nullptr);
+    PADDLE_ENFORCE_EQ(op_desc.Input("X").size(), 1);
+    PADDLE_ENFORCE_EQ(op_desc.Input("Scale").size(), 1);  // Scale is a weight
+    PADDLE_ENFORCE_EQ(op_desc.Input("Bias").size(), 1);   // Bias is a weight
+    PADDLE_ENFORCE_EQ(op_desc.Output("Out").size(), 1);
+    auto data_layout =
+        boost::get<std::string>(op_desc.GetAttr("data_layout"));
+    PADDLE_ENFORCE_EQ(data_layout, "NCHW",
+                      "Only the NCHW affine_channel is supported.");
+
+    auto* X = engine_->GetITensor(op_desc.Input("X").front());
+    // Declare weights
+    auto* Scale_v = scope.FindVar(op_desc.Input("Scale").front());
+    auto* Bias_v = scope.FindVar(op_desc.Input("Bias").front());
+    PADDLE_ENFORCE_NOT_NULL(Scale_v);
+    PADDLE_ENFORCE_NOT_NULL(Bias_v);
+    auto* Scale_t = Scale_v->GetMutable<framework::LoDTensor>();
+    auto* Bias_t = Bias_v->GetMutable<framework::LoDTensor>();
+    PADDLE_ENFORCE_EQ(Scale_t->numel(), Bias_t->numel());
+
+    // copy data from gpu to cpu
+    platform::CPUPlace cpu_place;
+    std::unique_ptr<framework::LoDTensor> scale_tensor(
+        new framework::LoDTensor());
+    std::unique_ptr<framework::LoDTensor> bias_tensor(
+        new framework::LoDTensor());
+    scale_tensor->Resize(Scale_t->dims());
+    bias_tensor->Resize(Bias_t->dims());
+    TensorCopySync((*Scale_t), cpu_place, scale_tensor.get());
+    TensorCopySync((*Bias_t), cpu_place, bias_tensor.get());
+
+    TensorRTEngine::Weight scale_weights{
+        nvinfer1::DataType::kFLOAT,
+        static_cast<void*>(scale_tensor->mutable_data<float>(cpu_place)),
+        static_cast<size_t>(scale_tensor->numel())};
+    TensorRTEngine::Weight shift_weights{
+        nvinfer1::DataType::kFLOAT,
+        static_cast<void*>(bias_tensor->mutable_data<float>(cpu_place)),
+        static_cast<size_t>(bias_tensor->numel())};
+    TensorRTEngine::Weight power_weights{nvinfer1::DataType::kFLOAT, nullptr,
+                                         0};
+
+    nvinfer1::IScaleLayer* layer =
+        TRT_ENGINE_ADD_LAYER(engine_, Scale, *const_cast<nvinfer1::ITensor*>(X),
+                             nvinfer1::ScaleMode::kCHANNEL, shift_weights.get(),
+                             scale_weights.get(), power_weights.get());
+
+    auto output_name = op_desc.Output("Out").front();
+    layer->setName(("affine_channel (Output: " + output_name + ")").c_str());
+    layer->getOutput(0)->setName(output_name.c_str());
+    engine_->weight_map[op_desc.Input("Scale").front()] =
+        std::move(scale_tensor);
+    engine_->weight_map[op_desc.Input("Bias").front()] =
+        std::move(bias_tensor);
+
+    engine_->SetITensor(output_name, layer->getOutput(0));
+
+    if (test_mode) {
+      engine_->DeclareOutput(output_name);
+    }
+  }
+};
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
+
+REGISTER_TRT_OP_CONVERTER(affine_channel, AffineChannelOpConverter);
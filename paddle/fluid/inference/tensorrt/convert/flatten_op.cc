@@ -0,0 +1,66 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+/*
+ * Flatten converter from fluid to tensorRT, only the axis of 1 is supported,
+ * which flattens every instance of the batch into a vector.
+ */
+class FlattenOpConverter : public OpConverter {
+ public:
+  void operator()(const framework::proto::OpDesc& op,
+                  const framework::Scope& scope, bool test_mode) override {
+    VLOG(4) << "convert a fluid flatten op to tensorrt shuffle layer";
+
+    framework::OpDesc op_desc(op, nullptr);
+    // Declare inputs
+    PADDLE_ENFORCE_EQ(op_desc.Input("X").size(), 1);
+    auto* input = engine_->GetITensor(op_desc.Input("X")[0]);
+    auto input_dims = input->getDimensions();
+    // Get attrs
+    int axis = boost::get<int>(op_desc.GetAttr("axis"));
+    PADDLE_ENFORCE_EQ(axis, 1, "Only the axis of 1 is supported in TensorRT.");
+
+    int volume = 1;
+    for (int i = 0; i < input_dims.nbDims; i++) volume *= input_dims.d[i];
+    nvinfer1::Dims flatten_dims;
+    flatten_dims.nbDims = 1;
+    flatten_dims.d[0] = volume;
+    flatten_dims.type[0] = nvinfer1::DimensionType::kCHANNEL;
+
+    auto* layer = TRT_ENGINE_ADD_LAYER(engine_, Shuffle, *input);
+    PADDLE_ENFORCE(nullptr != layer);
+    layer->setReshapeDimensions(flatten_dims);
+
+    auto output_name = op_desc.Output("Out")[0];
+    layer->setName(("flatten (Output: " + output_name + ")").c_str());
+    layer->getOutput(0)->setName(output_name.c_str());
+    engine_->SetITensor(output_name, layer->getOutput(0));
+    if (test_mode) {
+      engine_->DeclareOutput(output_name);
+    }
+  }
+};
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
+
+REGISTER_TRT_OP_CONVERTER(flatten, FlattenOpConverter);
+REGISTER_TRT_OP_CONVERTER(flatten2, FlattenOpConverter);
@@ -0,0 +1,106 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+// HardSigmoid converter from fluid to tensorRT,
+// y = min(max(slope * x + offset, 0), 1)
+class HardSigmoidOpConverter : public OpConverter {
+ public:
+  void operator()(const framework::proto::OpDesc& op,
+                  const framework::Scope& scope, bool test_mode) override {
+    VLOG(4) << "convert fluid hard_sigmoid op to tensorrt layer";
+
+    framework::OpDesc op_desc(op, nullptr);
+    // Declare inputs
+    int input_num = op_desc.Input("X").size();
+    PADDLE_ENFORCE(input_num == 1);
+    auto* input = engine_->GetITensor(op_desc.Input("X")[0]);
+    // Get output
+    size_t output_num = op_desc.Output("Out").size();
+    PADDLE_ENFORCE(output_num == 1);
+    // Get attrs
+    float slope = boost::get<float>(op_desc.GetAttr("slope"));
+    float offset = boost::get<float>(op_desc.GetAttr("offset"));
+
+    platform::CPUPlace place;
+    std::unique_ptr<framework::LoDTensor> weight_tensor(
+        new framework::LoDTensor());
+    weight_tensor->Resize(framework::make_ddim({4}));
+    float* weight_data = weight_tensor->mutable_data<float>(place);
+    weight_data[0] = slope;
+    weight_data[1] = offset;
+    weight_data[2] = -1.f;
+    weight_data[3] = 1.f;
+    // the clip to [0, 1] is equal to 1 - relu(1 - relu(x))
+    TensorRTEngine::Weight slope_w{nvinfer1::DataType::kFLOAT, &weight_data[0],
+                                   1};
+    TensorRTEngine::Weight offset_w{nvinfer1::DataType::kFLOAT,
+                                    &weight_data[1], 1};
+    TensorRTEngine::Weight neg_w{nvinfer1::DataType::kFLOAT, &weight_data[2],
+                                 1};
+    TensorRTEngine::Weight one_w{nvinfer1::DataType::kFLOAT, &weight_data[3],
+                                 1};
+    TensorRTEngine::Weight power{nvinfer1::DataType::kFLOAT, nullptr, 0};
+    // y_linear = slope * x + offset
+    auto* linear_layer = TRT_ENGINE_ADD_LAYER(
+        engine_, Scale, *input, nvinfer1::ScaleMode::kUNIFORM, offset_w.get(),
+        slope_w.get(), power.get());
+    PADDLE_ENFORCE(nullptr != linear_layer);
+    // y_lower = max(y_linear, 0)
+    auto* lower_layer =
+        TRT_ENGINE_ADD_LAYER(engine_, Activation, *(linear_layer->getOutput(0)),
+                             nvinfer1::ActivationType::kRELU);
+    PADDLE_ENFORCE(nullptr != lower_layer);
+    // y_upper = relu(1 - y_lower)
+    auto* sub_layer = TRT_ENGINE_ADD_LAYER(
+        engine_, Scale, *(lower_layer->getOutput(0)),
+        nvinfer1::ScaleMode::kUNIFORM, one_w.get(), neg_w.get(), power.get());
+    PADDLE_ENFORCE(nullptr != sub_layer);
+    auto* upper_layer =
+        TRT_ENGINE_ADD_LAYER(engine_, Activation, *(sub_layer->getOutput(0)),
+                             nvinfer1::ActivationType::kRELU);
+    PADDLE_ENFORCE(nullptr != upper_layer);
+    // y = 1 - y_upper
+    auto* output_layer = TRT_ENGINE_ADD_LAYER(
+        engine_, Scale, *(upper_layer->getOutput(0)),
+        nvinfer1::ScaleMode::kUNIFORM, one_w.get(), neg_w.get(), power.get());
+    PADDLE_ENFORCE(nullptr != output_layer);
+    // keep the weight tensor to avoid release it's memory
+    std::string weight_name = op_desc.Output("Out")[0] + "_hard_sigmoid";
+    PADDLE_ENFORCE(engine_->weight_map.find(weight_name) ==
+                   engine_->weight_map.end());
+    engine_->weight_map[weight_name] = std::move(weight_tensor);
+
+    std::string layer_name = "hard_sigmoid (Output: ";
+    auto output_name = op_desc.Output("Out")[0];
+    output_layer->getOutput(0)->setName(output_name.c_str());
+    engine_->SetITensor(output_name, output_layer->getOutput(0));
+    layer_name += output_name;
+    if (test_mode) {
+      engine_->DeclareOutput(output_name);
+    }
+    output_layer->setName((layer_name + ")").c_str());
+  }
+};
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
+
+REGISTER_TRT_OP_CONVERTER(hard_sigmoid, HardSigmoidOpConverter);
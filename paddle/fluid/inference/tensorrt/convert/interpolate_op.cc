@@ -0,0 +1,65 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
+#include "paddle/fluid/inference/tensorrt/plugin/interpolate_op_plugin.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+/*
+ * Interpolate converter from fluid to tensorRT, for both nearest_interp and
+ * bilinear_interp of the static out_h and out_w.
+ */
+class InterpolateOpConverter : public OpConverter {
+ public:
+  void operator()(const framework::proto::OpDesc& op,
+                  const framework::Scope& scope, bool test_mode) override {
+    VLOG(4) << "convert a fluid interpolate op to tensorrt interpolate plugin";
+
+    framework::OpDesc op_desc(op, nullptr);
+    // Declare inputs
+    PADDLE_ENFORCE_EQ(op_desc.Input("X").size(), 1);
+    auto* input = engine_->GetITensor(op_desc.Input("X")[0]);
+    // Get attrs
+    std::string interp_method =
+        boost::get<std::string>(op_desc.GetAttr("interp_method"));
+    int out_h = boost::get<int>(op_desc.GetAttr("out_h"));
+    int out_w = boost::get<int>(op_desc.GetAttr("out_w"));
+    PADDLE_ENFORCE(interp_method == "nearest" || interp_method == "bilinear");
+    PADDLE_ENFORCE(out_h > 0 && out_w > 0);
+
+    plugin::InterpolatePlugin* plugin =
+        new plugin::InterpolatePlugin(interp_method, out_h, out_w);
+    nvinfer1::IPluginLayer* layer = engine_->AddPlugin(&input, 1, plugin);
+
+    std::string layer_name = op.type() + " (Output: ";
+    auto output_name = op_desc.Output("Out")[0];
+    layer->getOutput(0)->setName(output_name.c_str());
+    engine_->SetITensor(output_name, layer->getOutput(0));
+    layer_name += output_name;
+    if (test_mode) {
+      engine_->DeclareOutput(output_name);
+    }
+    layer->setName((layer_name + ")").c_str());
+  }
+};
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
+
+REGISTER_TRT_OP_CONVERTER(nearest_interp, InterpolateOpConverter);
+REGISTER_TRT_OP_CONVERTER(bilinear_interp, InterpolateOpConverter);
@@ -0,0 +1,81 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
+#include "paddle/fluid/inference/tensorrt/plugin/layer_norm_op_plugin.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+/*
+ * LayerNorm converter from fluid to tensorRT, only the output Y is converted,
+ * and the Mean and Variance, which are used by the training only, are not.
+ */
+class LayerNormOpConverter : public OpConverter {
+ public:
+  void operator()(const framework::proto::OpDesc& op,
+                  const framework::Scope& scope, bool test_mode) override {
+    VLOG(4) << "convert a fluid layer_norm op to tensorrt layer_norm plugin";
+
+    framework::OpDesc op_desc(op, nullptr);
+    PADDLE_ENFORCE_EQ(op_desc.Input("X").size(), 1);
+    PADDLE_ENFORCE_EQ(op_desc.Input("Scale").size(), 1);  // Scale is a weight
+    PADDLE_ENFORCE_EQ(op_desc.Input("Bias").size(), 1);   // Bias is a weight
+    PADDLE_ENFORCE_EQ(op_desc.Output("Y").size(), 1);
+    auto* input = engine_->GetITensor(op_desc.Input("X").front());
+    // Get attrs
+    int begin_norm_axis = boost::get<int>(op_desc.GetAttr("begin_norm_axis"));
+    float epsilon = boost::get<float>(op_desc.GetAttr("epsilon"));
+    // normalizing with the batch is not supported in TensorRT
+    PADDLE_ENFORCE_GT(begin_norm_axis, 0);
+    PADDLE_ENFORCE_LE(begin_norm_axis, input->getDimensions().nbDims);
+
+    // Declare weights
+    auto* Scale_v = scope.FindVar(op_desc.Input("Scale").front());
+    auto* Bias_v = scope.FindVar(op_desc.Input("Bias").front());
+    PADDLE_ENFORCE_NOT_NULL(Scale_v);
+    PADDLE_ENFORCE_NOT_NULL(Bias_v);
+    // copy data from gpu to cpu
+    platform::CPUPlace cpu_place;
+    framework::LoDTensor scale_tensor, bias_tensor;
+    TensorCopySync(Scale_v->Get<framework::LoDTensor>(), cpu_place,
+                   &scale_tensor);
+    TensorCopySync(Bias_v->Get<framework::LoDTensor>(), cpu_place,
+                   &bias_tensor);
+    std::vector<float> scale, bias;
+    framework::TensorToVector(scale_tensor, &scale);
+    framework::TensorToVector(bias_tensor, &bias);
+
+    plugin::LayerNormPlugin* plugin = new plugin::LayerNormPlugin(
+        scale, bias, begin_norm_axis - 1, epsilon);
+    nvinfer1::IPluginLayer* layer = engine_->AddPlugin(&input, 1, plugin);
+
+    std::string layer_name = "layer_norm (Output: ";
+    auto output_name = op_desc.Output("Y").front();
+    layer->getOutput(0)->setName(output_name.c_str());
+    engine_->SetITensor(output_name, layer->getOutput(0));
+    layer_name += output_name;
+    if (test_mode) {
+      engine_->DeclareOutput(output_name);
+    }
+    layer->setName((layer_name + ")").c_str());
+  }
+};
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
+
+REGISTER_TRT_OP_CONVERTER(layer_norm, LayerNormOpConverter);
@@ -0,0 +1,83 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+/*
+ * MatMul converter from fluid to tensorRT, both X and Y should be the tensors
+ * of the network of the same rank, which are multiplied in the last two dims
+ * for every instance of the batch.
+ */
+class MatMulOpConverter : public OpConverter {
+ public:
+  void operator()(const framework::proto::OpDesc& op,
+                  const framework::Scope& scope, bool test_mode) override {
+    VLOG(4) << "convert a fluid matmul op to tensorrt matrix multiply layer";
+
+    framework::OpDesc op_desc(op, nullptr);
+    // Declare inputs
+    PADDLE_ENFORCE_EQ(op_desc.Input("X").size(), 1);
+    PADDLE_ENFORCE_EQ(op_desc.Input("Y").size(), 1);
+    auto* input1 = engine_->GetITensor(op_desc.Input("X")[0]);
+    auto* input2 = engine_->GetITensor(op_desc.Input("Y")[0]);
+    PADDLE_ENFORCE_GE(input1->getDimensions().nbDims, 2);
+    PADDLE_ENFORCE_EQ(input1->getDimensions().nbDims,
+                      input2->getDimensions().nbDims);
+    // Get attrs
+    bool transpose_X = boost::get<bool>(op_desc.GetAttr("transpose_X"));
+    bool transpose_Y = boost::get<bool>(op_desc.GetAttr("transpose_Y"));
+    float alpha = boost::get<float>(op_desc.GetAttr("alpha"));
+
+    nvinfer1::ILayer* layer = TRT_ENGINE_ADD_LAYER(
+        engine_, MatrixMultiply, *input1, transpose_X, *input2, transpose_Y);
+    PADDLE_ENFORCE(nullptr != layer);
+
+    auto output_name = op_desc.Output("Out")[0];
+    if (alpha != 1.f) {
+      platform::CPUPlace place;
+      std::unique_ptr<framework::LoDTensor> alpha_tensor(
+          new framework::LoDTensor());
+      alpha_tensor->Resize(framework::make_ddim({1}));
+      float* alpha_data = alpha_tensor->mutable_data<float>(place);
+      alpha_data[0] = alpha;
+      TensorRTEngine::Weight scale{nvinfer1::DataType::kFLOAT, alpha_data, 1};
+      TensorRTEngine::Weight shift{nvinfer1::DataType::kFLOAT, nullptr, 0};
+      TensorRTEngine::Weight power{nvinfer1::DataType::kFLOAT, nullptr, 0};
+      layer->setName(("matmul (Output: " + output_name + "_matmul)").c_str());
+      layer = TRT_ENGINE_ADD_LAYER(engine_, Scale, *(layer->getOutput(0)),
+                                   nvinfer1::ScaleMode::kUNIFORM, shift.get(),
+                                   scale.get(), power.get());
+      PADDLE_ENFORCE(nullptr != layer);
+      // keep alpha tensor to avoid release it's memory
+      engine_->weight_map[output_name + "_alpha"] = std::move(alpha_tensor);
+    }
+
+    layer->setName(("matmul (Output: " + output_name + ")").c_str());
+    layer->getOutput(0)->setName(output_name.c_str());
+    engine_->SetITensor(output_name, layer->getOutput(0));
+    if (test_mode) {
+      engine_->DeclareOutput(output_name);
+    }
+  }
+};
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
+
+REGISTER_TRT_OP_CONVERTER(matmul, MatMulOpConverter);
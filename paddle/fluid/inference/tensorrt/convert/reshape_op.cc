@@ -0,0 +1,88 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+/*
+ * Reshape converter from fluid to tensorRT, the batch dim should be kept,
+ * that is, the first dim of the shape should be 0 or -1.
+ */
+class ReshapeOpConverter : public OpConverter {
+ public:
+  void operator()(const framework::proto::OpDesc& op,
+                  const framework::Scope& scope, bool test_mode) override {
+    VLOG(4) << "convert a fluid reshape op to tensorrt shuffle layer";
+
+    framework::OpDesc op_desc(op, nullptr);
+    // Declare inputs
+    PADDLE_ENFORCE_EQ(op_desc.Input("X").size(), 1);
+    auto* input = engine_->GetITensor(op_desc.Input("X")[0]);
+    auto input_dims = input->getDimensions();
+    // Get attrs
+    std::vector<int> shape =
+        boost::get<std::vector<int>>(op_desc.GetAttr("shape"));
+    // reshape on batch is not supported in TensorRT
+    PADDLE_ENFORCE(!shape.empty() && (shape[0] == 0 || shape[0] == -1));
+    PADDLE_ENFORCE(static_cast<int>(shape.size()) - 1 <=
+                   nvinfer1::Dims::MAX_DIMS);
+
+    // The 0 in shape copies the dim of the input, and the -1 is inferred
+    // from the others.
+    int volume = 1;
+    for (int i = 0; i < input_dims.nbDims; i++) volume *= input_dims.d[i];
+    nvinfer1::Dims reshape_dims;
+    reshape_dims.nbDims = static_cast<int>(shape.size()) - 1;
+    int infer_dim = -1;
+    int known = 1;
+    for (int i = 0; i < reshape_dims.nbDims; i++) {
+      int dim = shape[i + 1];
+      if (dim == 0) {
+        PADDLE_ENFORCE_LT(i, input_dims.nbDims);
+        dim = input_dims.d[i];
+      }
+      reshape_dims.d[i] = dim;
+      reshape_dims.type[i] = nvinfer1::DimensionType::kSPATIAL;
+      if (dim == -1) {
+        PADDLE_ENFORCE_EQ(infer_dim, -1, "Only one dim can be inferred.");
+        infer_dim = i;
+      } else {
+        known *= dim;
+      }
+    }
+    if (infer_dim >= 0) reshape_dims.d[infer_dim] = volume / known;
+
+    auto* layer = TRT_ENGINE_ADD_LAYER(engine_, Shuffle, *input);
+    PADDLE_ENFORCE(nullptr != layer);
+    layer->setReshapeDimensions(reshape_dims);
+
+    auto output_name = op_desc.Output("Out")[0];
+    layer->setName(("reshape (Output: " + output_name + ")").c_str());
+    layer->getOutput(0)->setName(output_name.c_str());
+    engine_->SetITensor(output_name, layer->getOutput(0));
+    if (test_mode) {
+      engine_->DeclareOutput(output_name);
+    }
+  }
+};
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
+
+REGISTER_TRT_OP_CONVERTER(reshape, ReshapeOpConverter);
+REGISTER_TRT_OP_CONVERTER(reshape2, ReshapeOpConverter);
@@ -0,0 +1,72 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
+#include "paddle/fluid/inference/tensorrt/plugin/slice_op_plugin.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+/*
+ * Slice converter from fluid to tensorRT, slicing on the batch is not
+ * supported.
+ */
+class SliceOpConverter : public OpConverter {
+ public:
+  void operator()(const framework::proto::OpDesc& op,
+                  const framework::Scope& scope, bool test_mode) override {
+    VLOG(4) << "convert a fluid slice op to tensorrt slice plugin";
+
+    framework::OpDesc op_desc(op, nullptr);
+    // Declare inputs
+    PADDLE_ENFORCE_EQ(op_desc.Input("Input").size(), 1);
+    auto* input = engine_->GetITensor(op_desc.Input("Input")[0]);
+    int rank = input->getDimensions().nbDims + 1;
+    // Get attrs
+    std::vector<int> axes =
+        boost::get<std::vector<int>>(op_desc.GetAttr("axes"));
+    std::vector<int> starts =
+        boost::get<std::vector<int>>(op_desc.GetAttr("starts"));
+    std::vector<int> ends =
+        boost::get<std::vector<int>>(op_desc.GetAttr("ends"));
+    PADDLE_ENFORCE_EQ(axes.size(), starts.size());
+    PADDLE_ENFORCE_EQ(axes.size(), ends.size());
+    for (auto& axis : axes) {
+      if (axis < 0) axis += rank;
+      // slice on batch is not supported in TensorRT
+      PADDLE_ENFORCE(axis > 0 && axis < rank);
+      axis -= 1;
+    }
+
+    plugin::SlicePlugin* plugin = new plugin::SlicePlugin(axes, starts, ends);
+    nvinfer1::IPluginLayer* layer = engine_->AddPlugin(&input, 1, plugin);
+
+    std::string layer_name = "slice (Output: ";
+    auto output_name = op_desc.Output("Out")[0];
+    layer->getOutput(0)->setName(output_name.c_str());
+    engine_->SetITensor(output_name, layer->getOutput(0));
+    layer_name += output_name;
+    if (test_mode) {
+      engine_->DeclareOutput(output_name);
+    }
+    layer->setName((layer_name + ")").c_str());
+  }
+};
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
+
+REGISTER_TRT_OP_CONVERTER(slice, SliceOpConverter);
@@ -0,0 +1,84 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+// Swish converter from fluid to tensorRT, y = x * sigmoid(beta * x)
+class SwishOpConverter : public OpConverter {
+ public:
+  void operator()(const framework::proto::OpDesc& op,
+                  const framework::Scope& scope, bool test_mode) override {
+    VLOG(4) << "convert fluid swish op to tensorrt layer";
+
+    framework::OpDesc op_desc(op, nullptr);
+    // Declare inputs
+    int input_num = op_desc.Input("X").size();
+    PADDLE_ENFORCE(input_num == 1);
+    auto* input = engine_->GetITensor(op_desc.Input("X")[0]);
+    // Get output
+    size_t output_num = op_desc.Output("Out").size();
+    PADDLE_ENFORCE(output_num == 1);
+    // Get attrs
+    float beta = boost::get<float>(op_desc.GetAttr("beta"));
+
+    platform::CPUPlace place;
+    std::unique_ptr<framework::LoDTensor> beta_tensor(
+        new framework::LoDTensor());
+    beta_tensor->Resize(framework::make_ddim({1}));
+    float* beta_data = beta_tensor->mutable_data<float>(place);
+    beta_data[0] = beta;
+    TensorRTEngine::Weight scale{nvinfer1::DataType::kFLOAT, &beta_data[0], 1};
+    TensorRTEngine::Weight shift{nvinfer1::DataType::kFLOAT, nullptr, 0};
+    TensorRTEngine::Weight power{nvinfer1::DataType::kFLOAT, nullptr, 0};
+    // y_scale = beta * x
+    auto* scale_layer = TRT_ENGINE_ADD_LAYER(
+        engine_, Scale, *input, nvinfer1::ScaleMode::kUNIFORM, shift.get(),
+        scale.get(), power.get());
+    PADDLE_ENFORCE(nullptr != scale_layer);
+    // y_sigmoid = sigmoid(beta * x)
+    auto* sigmoid_layer =
+        TRT_ENGINE_ADD_LAYER(engine_, Activation, *(scale_layer->getOutput(0)),
+                             nvinfer1::ActivationType::kSIGMOID);
+    PADDLE_ENFORCE(nullptr != sigmoid_layer);
+    auto* output_layer = TRT_ENGINE_ADD_LAYER(
+        engine_, ElementWise, *input, *(sigmoid_layer->getOutput(0)),
+        nvinfer1::ElementWiseOperation::kPROD);
+    PADDLE_ENFORCE(nullptr != output_layer);
+    // keep beta tensor to avoid release it's memory
+    std::string beta_name = op_desc.Output("Out")[0] + "_beta";
+    PADDLE_ENFORCE(engine_->weight_map.find(beta_name) ==
+                   engine_->weight_map.end());
+    engine_->weight_map[beta_name] = std::move(beta_tensor);
+
+    std::string layer_name = "swish (Output: ";
+    auto output_name = op_desc.Output("Out")[0];
+    output_layer->getOutput(0)->setName(output_name.c_str());
+    engine_->SetITensor(output_name, output_layer->getOutput(0));
+    layer_name += output_name;
+    if (test_mode) {
+      engine_->DeclareOutput(output_name);
+    }
+    output_layer->setName((layer_name + ")").c_str());
+  }
+};
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
+
+REGISTER_TRT_OP_CONVERTER(swish, SwishOpConverter);
@@ -0,0 +1,51 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/inference/tensorrt/convert/ut_helper.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+TEST(AffineChannelOpConverter, main) {
+  framework::Scope scope;
+  std::unordered_set<std::string> parameters({"affine_channel-Scale",
+                                              "affine_channel-Bias"});
+  TRTConvertValidation validator(2, parameters, scope, 1000);
+  validator.DeclInputVar("affine_channel-X", nvinfer1::Dims3(3, 4, 5));
+  validator.DeclParamVar("affine_channel-Scale", std::vector<int>({3}));
+  validator.DeclParamVar("affine_channel-Bias", std::vector<int>({3}));
+  validator.DeclOutputVar("affine_channel-Out", nvinfer1::Dims3(3, 4, 5));
+
+  // Prepare Op description
+  framework::OpDesc desc;
+  desc.SetType("affine_channel");
+  desc.SetInput("X", {"affine_channel-X"});
+  desc.SetInput("Scale", {"affine_channel-Scale"});
+  desc.SetInput("Bias", {"affine_channel-Bias"});
+  desc.SetOutput("Out", {"affine_channel-Out"});
+  desc.SetAttr("data_layout", std::string("NCHW"));
+
+  validator.SetOp(*desc.Proto());
+
+  validator.Execute(2);
+}
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
+
+USE_OP(affine_channel);
@@ -0,0 +1,48 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/inference/tensorrt/convert/ut_helper.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+TEST(HardSigmoidOpConverter, main) {
+  framework::Scope scope;
+  std::unordered_set<std::string> parameters;
+  TRTConvertValidation validator(10, parameters, scope, 1000);
+  validator.DeclInputVar("hard_sigmoid-X", nvinfer1::Dims3(3, 4, 4));
+  validator.DeclOutputVar("hard_sigmoid-Out", nvinfer1::Dims3(3, 4, 4));
+
+  // Prepare Op description
+  framework::OpDesc desc;
+  desc.SetType("hard_sigmoid");
+  desc.SetInput("X", {"hard_sigmoid-X"});
+  desc.SetOutput("Out", {"hard_sigmoid-Out"});
+  // The input in [0, 1] is mapped to [-0.8, 2.2] to be clipped on both ends.
+  desc.SetAttr("slope", 3.0f);
+  desc.SetAttr("offset", -0.8f);
+
+  validator.SetOp(*desc.Proto());
+
+  validator.Execute(5);
+}
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
+
+USE_OP(hard_sigmoid);
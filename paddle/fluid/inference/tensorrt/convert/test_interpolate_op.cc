@@ -0,0 +1,53 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/inference/tensorrt/convert/ut_helper.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+void TestInterpolate(const std::string& interp_method) {
+  framework::Scope scope;
+  std::unordered_set<std::string> parameters;
+  TRTConvertValidation validator(2, parameters, scope, 1000);
+  validator.DeclInputVar("interp-X", nvinfer1::Dims3(2, 3, 4));
+  validator.DeclOutputVar("interp-Out", nvinfer1::Dims3(2, 5, 7));
+
+  // Prepare Op description
+  framework::OpDesc desc;
+  desc.SetType(interp_method + "_interp");
+  desc.SetInput("X", {"interp-X"});
+  desc.SetOutput("Out", {"interp-Out"});
+  desc.SetAttr("out_h", 5);
+  desc.SetAttr("out_w", 7);
+  desc.SetAttr("interp_method", interp_method);
+
+  validator.SetOp(*desc.Proto());
+
+  validator.Execute(2);
+}
+
+TEST(InterpolateOpConverter, nearest) { TestInterpolate("nearest"); }
+
+TEST(InterpolateOpConverter, bilinear) { TestInterpolate("bilinear"); }
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
+
+USE_OP(nearest_interp);
+USE_OP(bilinear_interp);
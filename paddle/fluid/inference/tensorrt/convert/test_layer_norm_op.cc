@@ -0,0 +1,56 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/inference/tensorrt/convert/ut_helper.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+TEST(LayerNormOpConverter, main) {
+  framework::Scope scope;
+  std::unordered_set<std::string> parameters({"layer_norm-Scale",
+                                              "layer_norm-Bias"});
+  TRTConvertValidation validator(2, parameters, scope, 1000);
+  validator.DeclInputVar("layer_norm-X", nvinfer1::Dims3(3, 4, 5));
+  validator.DeclParamVar("layer_norm-Scale", std::vector<int>({20}));
+  validator.DeclParamVar("layer_norm-Bias", std::vector<int>({20}));
+  validator.DeclOutputVar("layer_norm-Y", nvinfer1::Dims3(3, 4, 5));
+  validator.DeclOutputVar("layer_norm-Mean", std::vector<int>({6}));
+  validator.DeclOutputVar("layer_norm-Variance", std::vector<int>({6}));
+
+  // Prepare Op description
+  framework::OpDesc desc;
+  desc.SetType("layer_norm");
+  desc.SetInput("X", {"layer_norm-X"});
+  desc.SetInput("Scale", {"layer_norm-Scale"});
+  desc.SetInput("Bias", {"layer_norm-Bias"});
+  desc.SetOutput("Y", {"layer_norm-Y"});
+  desc.SetOutput("Mean", {"layer_norm-Mean"});
+  desc.SetOutput("Variance", {"layer_norm-Variance"});
+  desc.SetAttr("begin_norm_axis", 2);
+  desc.SetAttr("epsilon", 1e-5f);
+
+  validator.SetOp(*desc.Proto());
+
+  validator.Execute(2, {"layer_norm-Mean", "layer_norm-Variance"});
+}
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
+
+USE_OP(layer_norm);
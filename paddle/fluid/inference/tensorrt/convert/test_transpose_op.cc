@@ -0,0 +1,48 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/inference/tensorrt/convert/ut_helper.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+TEST(TransposeOpConverter, main) {
+  framework::Scope scope;
+  std::unordered_set<std::string> parameters;
+  TRTConvertValidation validator(2, parameters, scope, 1000);
+  validator.DeclInputVar("transpose-X", nvinfer1::Dims3(3, 4, 5));
+  validator.DeclOutputVar("transpose-Out", nvinfer1::Dims3(4, 5, 3));
+  validator.DeclOutputVar("transpose-XShape", nvinfer1::Dims3(3, 4, 5));
+
+  // Prepare Op description
+  framework::OpDesc desc;
+  desc.SetType("transpose2");
+  desc.SetInput("X", {"transpose-X"});
+  desc.SetOutput("Out", {"transpose-Out"});
+  desc.SetOutput("XShape", {"transpose-XShape"});
+  desc.SetAttr("axis", std::vector<int>({0, 2, 3, 1}));
+
+  validator.SetOp(*desc.Proto());
+
+  validator.Execute(2, {"transpose-XShape"});
+}
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
+
+USE_OP(transpose2);
@@ -18,8 +18,10 @@ limitations under the License. */
 #include <cuda.h>
 #include <glog/logging.h>
 #include <string>
+#include <unordered_map>
 #include "paddle/fluid/inference/analysis/helper.h"
 #include "paddle/fluid/inference/tensorrt/helper.h"
+#include "paddle/fluid/memory/malloc.h"
 #include "paddle/fluid/platform/enforce.h"
 
 namespace paddle {
@@ -28,22 +30,53 @@ namespace tensorrt {
 
 int TensorRTEngine::runtime_batch_ = 1;
 
+#if NV_TENSORRT_MAJOR >= 5
+// The device memory of the activations of the engines of this thread on the
+// device. The engines of a thread run one by one, and each of them waits for
+// its stream before the next one, so they share a single buffer of the
+// largest size they need.
+static void *SharedDeviceMemory(int device, size_t size) {
+  thread_local std::unordered_map<int, memory::AllocationPtr> memories;
+  auto &mem = memories[device];
+  if (mem == nullptr || mem->size() < size) {
+    mem.reset();
+    mem = memory::Alloc(platform::CUDAPlace(device), size);
+  }
+  return mem->ptr();
+}
+#endif
+
 void TensorRTEngine::Build(const DescType &paddle_model) {
   PADDLE_ENFORCE(false, "not implemented");
 }
 
 void TensorRTEngine::Execute(int batch_size) {
   freshDeviceId();
-  batch_size_ = batch_size;
   std::vector<void *> buffers;
   for (auto &buf : buffers_) {
-    PADDLE_ENFORCE_NOT_NULL(buf.buffer, "buffer should be allocated");
     PADDLE_ENFORCE_GT(buf.max_size, 0);
     PADDLE_ENFORCE(buf.device == DeviceType::GPU);
-    buffers.push_back(buf.buffer);
+    buffers.push_back(AllocateBuffer(&buf));
+  }
+  Execute(batch_size, &buffers);
+}
+
+void TensorRTEngine::Execute(int batch_size, std::vector<void *> *buffers) {
+  freshDeviceId();
+  batch_size_ = batch_size;
+  PADDLE_ENFORCE_EQ(static_cast<int>(buffers->size()),
+                    infer_engine_->getNbBindings());
+  for (auto *buffer : *buffers) {
+    PADDLE_ENFORCE_NOT_NULL(buffer, "buffer should be set");
   }
   PADDLE_ENFORCE_NOT_NULL(stream_);
-  infer_context_->enqueue(batch_size, buffers.data(), *stream_, nullptr);
+#if NV_TENSORRT_MAJOR >= 5
+  size_t memory_size = infer_engine_->getDeviceMemorySize();
+  if (memory_size > 0) {
+    infer_context_->setDeviceMemory(SharedDeviceMemory(device_, memory_size));
+  }
+#endif
+  infer_context_->enqueue(batch_size, buffers->data(), *stream_, nullptr);
   cudaStreamSynchronize(*stream_);
   SetRuntimeBatch(batch_size);
 }
@@ -70,17 +103,72 @@ void TensorRTEngine::FreezeNetwork() {
   // build engine.
   infer_builder_->setMaxBatchSize(max_batch_);
   infer_builder_->setMaxWorkspaceSize(max_workspace_);
+  if (precision_ == Precision::kHalf) {
+    if (!infer_builder_->platformHasFastFp16()) {
+      LOG(WARNING) << "The GPU has no fast FP16, the engine may be slower";
+    }
+    infer_builder_->setFp16Mode(true);
+  } else if (precision_ == Precision::kInt8) {
+    PADDLE_ENFORCE_NOT_NULL(calibrator_,
+                            "INT8 precision needs a calibrator.");
+    if (!infer_builder_->platformHasFastInt8()) {
+      LOG(WARNING) << "The GPU has no fast INT8, the engine may be slower";
+    }
+    infer_builder_->setInt8Mode(true);
+    infer_builder_->setInt8Calibrator(calibrator_);
+  }
 
   infer_engine_.reset(infer_builder_->buildCudaEngine(*infer_network_));
   PADDLE_ENFORCE(infer_engine_ != nullptr, "build cuda engine failed!");
 
+  CreateExecutionContext();
+  AllocateBuffers();
+}
+
+void TensorRTEngine::CreateExecutionContext() {
+#if NV_TENSORRT_MAJOR >= 5
+  infer_context_.reset(
+      infer_engine_->createExecutionContextWithoutDeviceMemory());
+#else
   infer_context_.reset(infer_engine_->createExecutionContext());
+#endif
+  PADDLE_ENFORCE(infer_context_ != nullptr, "create context failed!");
+}
+
+std::string TensorRTEngine::Serialize() {
+  PADDLE_ENFORCE(infer_engine_ != nullptr, "call FreezeNetwork first.");
+  infer_ptr<nvinfer1::IHostMemory> data(infer_engine_->serialize());
+  PADDLE_ENFORCE(data != nullptr, "serialize cuda engine failed!");
+  return std::string(static_cast<const char *>(data->data()), data->size());
+}
+
+void TensorRTEngine::Deserialize(const std::string &engine_data) {
+  VLOG(3) << "TRT to deserialize engine";
+  freshDeviceId();
+  infer_runtime_.reset(createInferRuntime(&logger_));
+  infer_engine_.reset(infer_runtime_->deserializeCudaEngine(
+      engine_data.data(), engine_data.size(), nullptr));
+  PADDLE_ENFORCE(infer_engine_ != nullptr, "deserialize cuda engine failed!");
+  PADDLE_ENFORCE_LE(infer_engine_->getMaxBatchSize(), max_batch_,
+                    "the engine is built for a larger max batch size");
+
+  CreateExecutionContext();
+
+  // All the buffer sizes are inferred from the engine.
+  buffer_sizes_.clear();
+  for (int i = 0; i < infer_engine_->getNbBindings(); ++i) {
+    buffer_sizes_[infer_engine_->getBindingName(i)] = 0;
+  }
+  AllocateBuffers();
+}
 
-  // allocate GPU buffers.
+void TensorRTEngine::AllocateBuffers() {
+  // set the sizes of the GPU buffers.
   buffers_.resize(buffer_sizes_.size());
   for (auto &item : buffer_sizes_) {
-    // The output buffers are not set in the network building phrase, need to
-    // infer from the TesorRT network.
+    // The output buffers are not set in the network building phrase, neither
+    // are the buffers of a deserialized engine, need to infer from the
+    // TesorRT network.
     if (item.second == 0) {
       auto slot_offset = infer_engine_->getBindingIndex(item.first.c_str());
       auto dims = infer_engine_->getBindingDimensions(slot_offset);
@@ -90,17 +178,24 @@ void TensorRTEngine::FreezeNetwork() {
       PADDLE_ENFORCE_GT(item.second, 0);
     }
 
-    auto &buf = buffer(item.first);
+    auto slot_offset = infer_engine_->getBindingIndex(item.first.c_str());
+    auto &buf = buffers_[slot_offset];
     buf.max_size = item.second * max_batch_;
     CHECK(buf.buffer == nullptr);  // buffer should be allocated only once.
-
-    PADDLE_ENFORCE_EQ(0, cudaMalloc(&buf.buffer, item.second * max_batch_));
     buf.size = 0;
     PADDLE_ENFORCE_LE(buf.max_size, 1 << 30);  // 10G
     buf.device = DeviceType::GPU;
   }
 }
 
+void *TensorRTEngine::AllocateBuffer(Buffer *buf) {
+  if (buf->buffer == nullptr) {
+    freshDeviceId();
+    PADDLE_ENFORCE_EQ(0, cudaMalloc(&buf->buffer, buf->max_size));
+  }
+  return buf->buffer;
+}
+
 nvinfer1::ITensor *TensorRTEngine::DeclareInput(const std::string &name,
                                                 nvinfer1::DataType dtype,
                                                 const nvinfer1::Dims &dims) {
@@ -159,11 +254,12 @@ void *TensorRTEngine::GetOutputInGPU(const std::string &name) {
 void TensorRTEngine::GetOutputInGPU(const std::string &name, void *dst,
                                     size_t max_size) {
   // determine data size
-  auto *output = TensorRTEngine::GetITensor(name);
-  nvinfer1::Dims dims = output->getDimensions();
+  auto slot_offset = infer_engine_->getBindingIndex(name.c_str());
+  nvinfer1::Dims dims = infer_engine_->getBindingDimensions(slot_offset);
   auto dim_size = analysis::AccuDims(dims.d, dims.nbDims);
   size_t dst_size = dim_size * runtime_batch_ *
-                    kDataTypeSize[static_cast<int>(output->getType())];
+                    kDataTypeSize[static_cast<int>(
+                        infer_engine_->getBindingDataType(slot_offset))];
 
   auto it = buffer_sizes_.find(name);
   PADDLE_ENFORCE(it != buffer_sizes_.end());
@@ -181,11 +277,12 @@ void TensorRTEngine::GetOutputInCPU(const std::string &name, void *dst,
                                     size_t max_size) {
   // determine data size
 
-  auto *output = TensorRTEngine::GetITensor(name);
-  nvinfer1::Dims dims = output->getDimensions();
+  auto slot_offset = infer_engine_->getBindingIndex(name.c_str());
+  nvinfer1::Dims dims = infer_engine_->getBindingDimensions(slot_offset);
   auto dim_size = analysis::AccuDims(dims.d, dims.nbDims);
   size_t dst_size = dim_size * runtime_batch_ *
-                    kDataTypeSize[static_cast<int>(output->getType())];
+                    kDataTypeSize[static_cast<int>(
+                        infer_engine_->getBindingDataType(slot_offset))];
   auto it = buffer_sizes_.find(name);
   PADDLE_ENFORCE(it != buffer_sizes_.end());
   PADDLE_ENFORCE_GT(it->second, 0);
@@ -203,7 +300,9 @@ Buffer &TensorRTEngine::buffer(const std::string &name) {
   PADDLE_ENFORCE(it != buffer_sizes_.end(), "tried to access buffer named %s",
                  name);
   auto slot_offset = infer_engine_->getBindingIndex(name.c_str());
-  return buffers_[slot_offset];
+  auto &buf = buffers_[slot_offset];
+  AllocateBuffer(&buf);
+  return buf;
 }
 
 void TensorRTEngine::SetInputFromCPU(const std::string &name, const void *data,
@@ -243,6 +342,25 @@ nvinfer1::ITensor *TensorRTEngine::GetITensor(const std::string &name) {
   return itensor_map_[name];
 }
 
+nvinfer1::Dims TensorRTEngine::GetBindingDims(const std::string &name) {
+  PADDLE_ENFORCE(infer_engine_ != nullptr, "call FreezeNetwork first.");
+  auto slot_offset = infer_engine_->getBindingIndex(name.c_str());
+  PADDLE_ENFORCE_GE(slot_offset, 0, "no input or output called %s", name);
+  return infer_engine_->getBindingDimensions(slot_offset);
+}
+
+int TensorRTEngine::GetBindingIndex(const std::string &name) {
+  PADDLE_ENFORCE(infer_engine_ != nullptr, "call FreezeNetwork first.");
+  auto slot_offset = infer_engine_->getBindingIndex(name.c_str());
+  PADDLE_ENFORCE_GE(slot_offset, 0, "no input or output called %s", name);
+  return slot_offset;
+}
+
+int TensorRTEngine::GetNbBindings() {
+  PADDLE_ENFORCE(infer_engine_ != nullptr, "call FreezeNetwork first.");
+  return infer_engine_->getNbBindings();
+}
+
 void TensorRTEngine::SetRuntimeBatch(size_t batch_size) {
   runtime_batch_ = batch_size;
 }
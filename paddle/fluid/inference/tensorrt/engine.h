@@ -23,12 +23,21 @@ limitations under the License. */
 #include "paddle/fluid/inference/engine.h"
 #include "paddle/fluid/inference/tensorrt/helper.h"
 #include "paddle/fluid/inference/tensorrt/plugin/trt_plugin.h"
+#include "paddle/fluid/inference/tensorrt/trt_int8_calibrator.h"
 #include "paddle/fluid/inference/utils/singleton.h"
 
 namespace paddle {
 namespace inference {
 namespace tensorrt {
 
+// The precision of the layers, the same as contrib::AnalysisConfig::Precision.
+// The inputs and outputs of the engine are always FP32.
+enum class Precision {
+  kFloat32 = 0,
+  kHalf,
+  kInt8,
+};
+
 /*
  * TensorRT Engine.
  *
@@ -72,6 +81,10 @@ class TensorRTEngine : public EngineBase {
   void Build(const DescType& paddle_model) override;
 
   void Execute(int batch_size) override;
+  // Execute with the device memory of the inputs and outputs in buffers,
+  // indexed by GetBindingIndex, e.g. the memory of the fluid tensors, so that
+  // neither the inputs nor the outputs are copied.
+  void Execute(int batch_size, std::vector<void*>* buffers);
 
   // Initialize the inference network, so that TensorRT layers can add to this
   // network.
@@ -79,9 +92,25 @@ class TensorRTEngine : public EngineBase {
     infer_builder_.reset(createInferBuilder(&logger_));
     infer_network_.reset(infer_builder_->createNetwork());
   }
+  // Set the precision of the layers before FreezeNetwork. The INT8 precision
+  // needs a calibrator, which is only used during FreezeNetwork.
+  void SetPrecision(Precision precision) { precision_ = precision; }
+  void SetInt8Calibrator(TRTInt8Calibrator* calibrator) {
+    calibrator_ = calibrator;
+  }
+  Precision precision() const { return precision_; }
   // After finishing adding ops, freeze this network and creates the executation
   // environment.
   void FreezeNetwork();
+  // Serialize the engine built by FreezeNetwork, so that it can be restored by
+  // Deserialize without building again.
+  std::string Serialize();
+  // Create the engine and the executation environment from the data
+  // serialized by Serialize, instead of InitNetwork and FreezeNetwork.
+  void Deserialize(const std::string& engine_data);
+  // The engines with plugin layers can not be deserialized, for no plugin
+  // factory is provided.
+  bool HasPlugin() const { return !owned_plugin_.empty(); }
 
   // Add an input and set its name, data type and dimention.
   nvinfer1::ITensor* DeclareInput(const std::string& name,
@@ -121,6 +150,12 @@ class TensorRTEngine : public EngineBase {
   void SetITensor(const std::string& name, nvinfer1::ITensor* tensor);
   // Get an ITensor called name.
   nvinfer1::ITensor* GetITensor(const std::string& name);
+  // Get the dimensions without the batch of an input or output called name.
+  nvinfer1::Dims GetBindingDims(const std::string& name);
+  // Get the index of an input or output called name in the buffers of
+  // Execute.
+  int GetBindingIndex(const std::string& name);
+  int GetNbBindings();
 
   nvinfer1::ICudaEngine* engine() { return infer_engine_.get(); }
   nvinfer1::INetworkDefinition* network() { return infer_network_.get(); }
@@ -155,6 +190,8 @@ class TensorRTEngine : public EngineBase {
   static int runtime_batch_;
   // the max memory size the engine uses
   int max_workspace_;
+  Precision precision_{Precision::kFloat32};
+  TRTInt8Calibrator* calibrator_{nullptr};
 
   // batch size of the current data, will be updated each Executation.
   int batch_size_{-1};
@@ -185,6 +222,7 @@ class TensorRTEngine : public EngineBase {
   template <typename T>
   using infer_ptr = std::unique_ptr<T, Destroyer<T>>;
   infer_ptr<nvinfer1::IBuilder> infer_builder_;
+  infer_ptr<nvinfer1::IRuntime> infer_runtime_;
   infer_ptr<nvinfer1::INetworkDefinition> infer_network_;
   infer_ptr<nvinfer1::ICudaEngine> infer_engine_;
   infer_ptr<nvinfer1::IExecutionContext> infer_context_;
@@ -192,6 +230,15 @@ class TensorRTEngine : public EngineBase {
   // ensure that the thread is associated with the correct device by calling
   // freshDeviceId().
   void freshDeviceId();
+  // Set the sizes of the GPU buffers of the inputs and outputs of
+  // infer_engine_, which are only allocated when they are used, since the
+  // engine may run on the memory of the fluid tensors instead.
+  void AllocateBuffers();
+  void* AllocateBuffer(Buffer* buf);
+  // Create infer_context_. Since TensorRT 5, the contexts do not own the
+  // device memory of the activations, which is shared by the engines of a
+  // thread on a device, instead of a workspace for each engine.
+  void CreateExecutionContext();
 };  // class TensorRTEngine
 
 // Add an layer__ into engine__ with args ARGS.
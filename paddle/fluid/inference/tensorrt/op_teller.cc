@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "paddle/fluid/inference/tensorrt/op_teller.h"
+#include "paddle/fluid/framework/block_desc.h"
 
 namespace paddle {
 namespace inference {
@@ -32,7 +33,72 @@ struct SimpleOpTypeSetTeller : public Teller {
       {"mul", "conv2d", "pool2d", "relu", "softmax", "sigmoid",
        "depthwise_conv2d", "batch_norm", "concat", "tanh", "pad",
        "elementwise_add", "elementwise_mul", "dropout", "split", "prelu",
-       "conv2d_transpose", "leaky_relu"}};
+       "conv2d_transpose", "leaky_relu", "swish", "hard_sigmoid"}};
+};
+
+// Tell by the op_types and the attrs of the ops, which are converted only if
+// they do not work on the batch dim.
+struct OpConditionTeller : public Teller {
+  OpConditionTeller() {}
+
+  bool operator()(const std::string& op_type,
+                  const framework::OpDesc& desc) override {
+    if (op_type == "transpose" || op_type == "transpose2") {
+      auto axis = boost::get<std::vector<int>>(desc.GetAttr("axis"));
+      return !axis.empty() && axis[0] == 0;
+    }
+    if (op_type == "reshape" || op_type == "reshape2") {
+      if (HasInput(desc, "Shape")) return false;
+      auto shape = boost::get<std::vector<int>>(desc.GetAttr("shape"));
+      return !shape.empty() && (shape[0] == 0 || shape[0] == -1);
+    }
+    if (op_type == "flatten" || op_type == "flatten2") {
+      return boost::get<int>(desc.GetAttr("axis")) == 1;
+    }
+    if (op_type == "slice") {
+      auto axes = boost::get<std::vector<int>>(desc.GetAttr("axes"));
+      for (auto axis : axes) {
+        if (axis <= 0) return false;
+      }
+      return true;
+    }
+    if (op_type == "layer_norm") {
+      return boost::get<int>(desc.GetAttr("begin_norm_axis")) > 0;
+    }
+    if (op_type == "nearest_interp" || op_type == "bilinear_interp") {
+      return !HasInput(desc, "OutSize");
+    }
+    if (op_type == "affine_channel") {
+      auto data_layout =
+          boost::get<std::string>(desc.GetAttr("data_layout"));
+      auto* x = FindVar(desc, desc.Input("X")[0]);
+      return data_layout == "NCHW" && x != nullptr &&
+             x->GetShape().size() == 4;
+    }
+    if (op_type == "matmul") {
+      // Both X and Y should be the outputs of the network, of the same rank,
+      // the matmul of a weight is converted by mul.
+      auto* x = FindVar(desc, desc.Input("X")[0]);
+      auto* y = FindVar(desc, desc.Input("Y")[0]);
+      return x != nullptr && y != nullptr && !x->Persistable() &&
+             !y->Persistable() && x->GetShape().size() >= 3 &&
+             x->GetShape().size() == y->GetShape().size();
+    }
+    return false;
+  }
+
+ private:
+  static bool HasInput(const framework::OpDesc& desc,
+                       const std::string& name) {
+    auto it = desc.Inputs().find(name);
+    return it != desc.Inputs().end() && !it->second.empty();
+  }
+
+  static const framework::VarDesc* FindVar(const framework::OpDesc& desc,
+                                           const std::string& name) {
+    if (desc.Block() == nullptr) return nullptr;
+    return desc.Block()->FindVarRecursive(name);
+  }
 };
 
 bool OpTeller::Tell(const std::string& op_type, const framework::OpDesc& desc) {
@@ -42,7 +108,10 @@ bool OpTeller::Tell(const std::string& op_type, const framework::OpDesc& desc) {
   return false;
 }
 
-OpTeller::OpTeller() { tellers_.emplace_back(new SimpleOpTypeSetTeller); }
+OpTeller::OpTeller() {
+  tellers_.emplace_back(new SimpleOpTypeSetTeller);
+  tellers_.emplace_back(new OpConditionTeller);
+}
 
 }  // namespace tensorrt
 }  // namespace inference
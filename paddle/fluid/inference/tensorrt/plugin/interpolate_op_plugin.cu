@@ -0,0 +1,110 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include "paddle/fluid/inference/tensorrt/plugin/interpolate_op_plugin.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+namespace plugin {
+
+// The same interpolation as KeNearestNeighborInterpFw and KeBilinearInterpFw
+// of the fluid interpolate op, on the planes of [in_h, in_w].
+__global__ void NearestInterpKernel(const float* in, float* out, int planes,
+                                    int in_h, int in_w, int out_h, int out_w,
+                                    float ratio_h, float ratio_w) {
+  int numel = planes * out_h * out_w;
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < numel;
+       i += blockDim.x * gridDim.x) {
+    int plane = i / (out_h * out_w);
+    int y = i / out_w % out_h;
+    int x = i % out_w;
+    int in_y = static_cast<int>(ratio_h * y + 0.5);
+    int in_x = static_cast<int>(ratio_w * x + 0.5);
+    out[i] = in[(plane * in_h + in_y) * in_w + in_x];
+  }
+}
+
+__global__ void BilinearInterpKernel(const float* in, float* out, int planes,
+                                     int in_h, int in_w, int out_h, int out_w,
+                                     float ratio_h, float ratio_w) {
+  int numel = planes * out_h * out_w;
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < numel;
+       i += blockDim.x * gridDim.x) {
+    int plane = i / (out_h * out_w);
+    int y = i / out_w % out_h;
+    int x = i % out_w;
+    int in_y = ratio_h * y;
+    int h_id = (in_y < in_h - 1) ? 1 : 0;
+    float h1lambda = ratio_h * y - in_y;
+    float h2lambda = 1.f - h1lambda;
+    int in_x = ratio_w * x;
+    int w_id = (in_x < in_w - 1) ? 1 : 0;
+    float w1lambda = ratio_w * x - in_x;
+    float w2lambda = 1.f - w1lambda;
+    const float* in_pos = &in[(plane * in_h + in_y) * in_w + in_x];
+    out[i] = h2lambda * (w2lambda * in_pos[0] + w1lambda * in_pos[w_id]) +
+             h1lambda * (w2lambda * in_pos[h_id * in_w] +
+                         w1lambda * in_pos[h_id * in_w + w_id]);
+  }
+}
+
+nvinfer1::Dims InterpolatePlugin::getOutputDimensions(
+    int index, const nvinfer1::Dims* input_dims, int num_inputs) {
+  PADDLE_ENFORCE_EQ(num_inputs, 1);
+  PADDLE_ENFORCE_EQ(index, 0);
+  PADDLE_ENFORCE_EQ(input_dims[0].nbDims, 3);
+  nvinfer1::Dims output_dims = input_dims[0];
+  output_dims.d[1] = out_h_;
+  output_dims.d[2] = out_w_;
+  return output_dims;
+}
+
+int InterpolatePlugin::enqueue(int batch_size, const void* const* inputs,
+                               void** outputs, void* workspace,
+                               cudaStream_t stream) {
+  const auto& input_dims = this->getInputDims(0);
+  int planes = batch_size * input_dims.d[0];
+  int in_h = input_dims.d[1];
+  int in_w = input_dims.d[2];
+  const float* input = reinterpret_cast<const float*>(inputs[0]);
+  float* output = reinterpret_cast<float**>(outputs)[0];
+
+  if (in_h == out_h_ && in_w == out_w_) {
+    cudaMemcpyAsync(output, input, sizeof(float) * planes * in_h * in_w,
+                    cudaMemcpyDeviceToDevice, stream);
+    return cudaGetLastError() != cudaSuccess;
+  }
+  float ratio_h =
+      (out_h_ > 1) ? static_cast<float>(in_h - 1) / (out_h_ - 1) : 0.f;
+  float ratio_w =
+      (out_w_ > 1) ? static_cast<float>(in_w - 1) / (out_w_ - 1) : 0.f;
+  int numel = planes * out_h_ * out_w_;
+  int threads = 512;
+  int grids = std::min((numel + threads - 1) / threads, 65536);
+  if (interp_method_ == "bilinear") {
+    BilinearInterpKernel<<<grids, threads, 0, stream>>>(
+        input, output, planes, in_h, in_w, out_h_, out_w_, ratio_h, ratio_w);
+  } else {
+    NearestInterpKernel<<<grids, threads, 0, stream>>>(
+        input, output, planes, in_h, in_w, out_h_, out_w_, ratio_h, ratio_w);
+  }
+  return cudaGetLastError() != cudaSuccess;
+}
+
+}  // namespace plugin
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
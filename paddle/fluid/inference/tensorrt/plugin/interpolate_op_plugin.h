@@ -0,0 +1,79 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include "paddle/fluid/inference/tensorrt/plugin/trt_plugin.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+namespace plugin {
+
+// Resizes the CHW input to [C, out_h, out_w] by the "nearest" or "bilinear"
+// interpolation, in the same way as the fluid nearest_interp and
+// bilinear_interp, which align the corners.
+class InterpolatePlugin : public PluginTensorRT {
+ public:
+  InterpolatePlugin(std::string const &interp_method, int out_h, int out_w)
+      : interp_method_(interp_method), out_h_(out_h), out_w_(out_w) {}
+
+  // It was used for tensorrt deserialization.
+  // It should not be called by users.
+  InterpolatePlugin(void const *serial_data, size_t serial_length) {
+    deserializeBase(serial_data, serial_length);
+    int bilinear;
+    DeserializeValue(&serial_data, &serial_length, &bilinear);
+    DeserializeValue(&serial_data, &serial_length, &out_h_);
+    DeserializeValue(&serial_data, &serial_length, &out_w_);
+    interp_method_ = bilinear ? "bilinear" : "nearest";
+  }
+
+  InterpolatePlugin *clone() const override {
+    return new InterpolatePlugin(interp_method_, out_h_, out_w_);
+  }
+
+  const char *getPluginType() const override { return "interpolate"; }
+  int getNbOutputs() const override { return 1; }
+  nvinfer1::Dims getOutputDimensions(int index,
+                                     const nvinfer1::Dims *input_dims,
+                                     int num_inputs) override;
+  int enqueue(int batch_size, const void *const *inputs, void **outputs,
+              void *workspace, cudaStream_t stream) override;
+
+ protected:
+  size_t getSerializationSize() override {
+    return SerializedSize(static_cast<int>(0)) + SerializedSize(out_h_) +
+           SerializedSize(out_w_) + getBaseSerializationSize();
+  }
+
+  // TRT will call this func when we need to serialize the configuration of
+  // tensorrt.
+  void serialize(void *buffer) override {
+    serializeBase(buffer);
+    SerializeValue(&buffer, static_cast<int>(interp_method_ == "bilinear"));
+    SerializeValue(&buffer, out_h_);
+    SerializeValue(&buffer, out_w_);
+  }
+
+  std::string interp_method_;
+  int out_h_;
+  int out_w_;
+};
+
+}  // namespace plugin
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,117 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cub/cub.cuh>
+#include "paddle/fluid/inference/tensorrt/plugin/layer_norm_op_plugin.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+namespace plugin {
+
+constexpr int kLayerNormBlockDim = 256;
+
+struct LayerNormSums {
+  float sum;
+  float square_sum;
+};
+
+struct LayerNormSumsAdd {
+  __device__ __forceinline__ LayerNormSums operator()(const LayerNormSums& a,
+                                                      const LayerNormSums& b) {
+    return {a.sum + b.sum, a.square_sum + b.square_sum};
+  }
+};
+
+// Every block normalizes a row of size.
+__global__ void LayerNormKernel(const float* x, const float* scale,
+                                const float* bias, float* y, float epsilon,
+                                int size) {
+  using BlockReduce = cub::BlockReduce<LayerNormSums, kLayerNormBlockDim>;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+  __shared__ float mean;
+  __shared__ float inv_std;
+
+  const float* row = x + static_cast<int64_t>(blockIdx.x) * size;
+  float* out = y + static_cast<int64_t>(blockIdx.x) * size;
+  LayerNormSums sums{0.f, 0.f};
+  for (int i = threadIdx.x; i < size; i += kLayerNormBlockDim) {
+    float v = row[i];
+    sums.sum += v;
+    sums.square_sum += v * v;
+  }
+  sums = BlockReduce(temp_storage).Reduce(sums, LayerNormSumsAdd());
+  if (threadIdx.x == 0) {
+    mean = sums.sum / size;
+    float var = fmaxf(sums.square_sum / size - mean * mean, 0.f);
+    inv_std = rsqrtf(var + epsilon);
+  }
+  __syncthreads();
+  for (int i = threadIdx.x; i < size; i += kLayerNormBlockDim) {
+    out[i] = scale[i] * (row[i] - mean) * inv_std + bias[i];
+  }
+}
+
+nvinfer1::Dims LayerNormPlugin::getOutputDimensions(
+    int index, const nvinfer1::Dims* input_dims, int num_inputs) {
+  PADDLE_ENFORCE_EQ(num_inputs, 1);
+  PADDLE_ENFORCE_EQ(index, 0);
+  return input_dims[0];
+}
+
+int LayerNormPlugin::initialize() {
+  PADDLE_ENFORCE_EQ(scale_.size(), bias_.size());
+  size_t bytes = scale_.size() * sizeof(float);
+  if (cudaMalloc(&scale_gpu_, bytes) != cudaSuccess) return 1;
+  if (cudaMalloc(&bias_gpu_, bytes) != cudaSuccess) return 1;
+  cudaMemcpy(scale_gpu_, scale_.data(), bytes, cudaMemcpyHostToDevice);
+  cudaMemcpy(bias_gpu_, bias_.data(), bytes, cudaMemcpyHostToDevice);
+  return cudaGetLastError() != cudaSuccess;
+}
+
+void LayerNormPlugin::terminate() {
+  if (scale_gpu_) cudaFree(scale_gpu_);
+  if (bias_gpu_) cudaFree(bias_gpu_);
+  scale_gpu_ = nullptr;
+  bias_gpu_ = nullptr;
+}
+
+int LayerNormPlugin::enqueue(int batch_size, const void* const* inputs,
+                             void** outputs, void* workspace,
+                             cudaStream_t stream) {
+  const auto& input_dims = this->getInputDims(0);
+  PADDLE_ENFORCE(begin_norm_axis_ >= 0 && begin_norm_axis_ < input_dims.nbDims);
+  int rows = batch_size;
+  int size = 1;
+  for (int i = 0; i < input_dims.nbDims; ++i) {
+    if (i < begin_norm_axis_) {
+      rows *= input_dims.d[i];
+    } else {
+      size *= input_dims.d[i];
+    }
+  }
+  PADDLE_ENFORCE_EQ(static_cast<size_t>(size), scale_.size());
+  if (rows == 0 || size == 0) return 0;
+
+  const float* input = reinterpret_cast<const float*>(inputs[0]);
+  float* output = reinterpret_cast<float**>(outputs)[0];
+  LayerNormKernel<<<rows, kLayerNormBlockDim, 0, stream>>>(
+      input, scale_gpu_, bias_gpu_, output, epsilon_, size);
+  return cudaGetLastError() != cudaSuccess;
+}
+
+}  // namespace plugin
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
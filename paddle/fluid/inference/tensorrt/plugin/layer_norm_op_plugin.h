@@ -0,0 +1,93 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+#include "paddle/fluid/inference/tensorrt/plugin/trt_plugin.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+namespace plugin {
+
+// Normalizes every instance of the input over the dims from begin_norm_axis,
+// which is a dim of the TensorRT input without the batch, then scales and
+// shifts it by the scale and bias of the normalized size. Only the output Y
+// of the fluid layer_norm is computed.
+class LayerNormPlugin : public PluginTensorRT {
+ public:
+  LayerNormPlugin(std::vector<float> const &scale,
+                  std::vector<float> const &bias, int begin_norm_axis,
+                  float epsilon)
+      : scale_(scale),
+        bias_(bias),
+        begin_norm_axis_(begin_norm_axis),
+        epsilon_(epsilon) {}
+
+  // It was used for tensorrt deserialization.
+  // It should not be called by users.
+  LayerNormPlugin(void const *serial_data, size_t serial_length) {
+    deserializeBase(serial_data, serial_length);
+    DeserializeValue(&serial_data, &serial_length, &scale_);
+    DeserializeValue(&serial_data, &serial_length, &bias_);
+    DeserializeValue(&serial_data, &serial_length, &begin_norm_axis_);
+    DeserializeValue(&serial_data, &serial_length, &epsilon_);
+  }
+
+  LayerNormPlugin *clone() const override {
+    return new LayerNormPlugin(scale_, bias_, begin_norm_axis_, epsilon_);
+  }
+
+  const char *getPluginType() const override { return "layer_norm"; }
+  int getNbOutputs() const override { return 1; }
+  nvinfer1::Dims getOutputDimensions(int index,
+                                     const nvinfer1::Dims *input_dims,
+                                     int num_inputs) override;
+  // The scale and bias are copied to the device in initialize, and released
+  // in terminate.
+  int initialize() override;
+  void terminate() override;
+  int enqueue(int batch_size, const void *const *inputs, void **outputs,
+              void *workspace, cudaStream_t stream) override;
+
+ protected:
+  size_t getSerializationSize() override {
+    return SerializedSize(scale_) + SerializedSize(bias_) +
+           SerializedSize(begin_norm_axis_) + SerializedSize(epsilon_) +
+           getBaseSerializationSize();
+  }
+
+  // TRT will call this func when we need to serialize the configuration of
+  // tensorrt.
+  void serialize(void *buffer) override {
+    serializeBase(buffer);
+    SerializeValue(&buffer, scale_);
+    SerializeValue(&buffer, bias_);
+    SerializeValue(&buffer, begin_norm_axis_);
+    SerializeValue(&buffer, epsilon_);
+  }
+
+  std::vector<float> scale_;
+  std::vector<float> bias_;
+  int begin_norm_axis_;
+  float epsilon_;
+  float *scale_gpu_{nullptr};
+  float *bias_gpu_{nullptr};
+};
+
+}  // namespace plugin
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
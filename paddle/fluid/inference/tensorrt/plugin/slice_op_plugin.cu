@@ -0,0 +1,114 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include "paddle/fluid/inference/tensorrt/plugin/slice_op_plugin.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+namespace plugin {
+
+// The dims with the batch.
+constexpr int kSliceMaxRank = nvinfer1::Dims::MAX_DIMS + 1;
+
+struct SliceLayout {
+  int rank;
+  int out_dims[kSliceMaxRank];
+  int in_strides[kSliceMaxRank];
+  int starts[kSliceMaxRank];
+};
+
+__global__ void SliceKernel(const float* input, float* output,
+                            SliceLayout layout, int numel) {
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < numel;
+       i += blockDim.x * gridDim.x) {
+    int rest = i;
+    int offset = 0;
+    for (int d = layout.rank - 1; d >= 0; --d) {
+      int index = rest % layout.out_dims[d];
+      rest /= layout.out_dims[d];
+      offset += (index + layout.starts[d]) * layout.in_strides[d];
+    }
+    output[i] = input[offset];
+  }
+}
+
+void SlicePlugin::SliceDims(const nvinfer1::Dims& input_dims,
+                            std::vector<int>* starts,
+                            nvinfer1::Dims* output_dims) const {
+  PADDLE_ENFORCE_EQ(axes_.size(), starts_.size());
+  PADDLE_ENFORCE_EQ(axes_.size(), ends_.size());
+  *output_dims = input_dims;
+  starts->assign(input_dims.nbDims, 0);
+  for (size_t i = 0; i < axes_.size(); ++i) {
+    int axis = axes_[i];
+    PADDLE_ENFORCE(axis >= 0 && axis < input_dims.nbDims);
+    int dim = input_dims.d[axis];
+    int start = starts_[i] < 0 ? starts_[i] + dim : starts_[i];
+    int end = ends_[i] < 0 ? ends_[i] + dim : ends_[i];
+    start = std::max(std::min(start, dim), 0);
+    end = std::max(std::min(end, dim), 0);
+    start = std::min(start, end);
+    (*starts)[axis] = start;
+    output_dims->d[axis] = end - start;
+  }
+}
+
+nvinfer1::Dims SlicePlugin::getOutputDimensions(
+    int index, const nvinfer1::Dims* input_dims, int num_inputs) {
+  PADDLE_ENFORCE_EQ(num_inputs, 1);
+  PADDLE_ENFORCE_EQ(index, 0);
+  std::vector<int> starts;
+  nvinfer1::Dims output_dims;
+  SliceDims(input_dims[0], &starts, &output_dims);
+  return output_dims;
+}
+
+int SlicePlugin::enqueue(int batch_size, const void* const* inputs,
+                         void** outputs, void* workspace,
+                         cudaStream_t stream) {
+  const auto& input_dims = this->getInputDims(0);
+  std::vector<int> starts;
+  nvinfer1::Dims output_dims;
+  SliceDims(input_dims, &starts, &output_dims);
+
+  SliceLayout layout;
+  layout.rank = input_dims.nbDims + 1;
+  layout.out_dims[0] = batch_size;
+  layout.starts[0] = 0;
+  int numel = batch_size;
+  for (int d = 0; d < input_dims.nbDims; ++d) {
+    layout.out_dims[d + 1] = output_dims.d[d];
+    layout.starts[d + 1] = starts[d];
+    numel *= output_dims.d[d];
+  }
+  layout.in_strides[layout.rank - 1] = 1;
+  for (int d = layout.rank - 2; d >= 0; --d) {
+    layout.in_strides[d] = layout.in_strides[d + 1] * input_dims.d[d];
+  }
+  if (numel == 0) return 0;
+
+  const float* input = reinterpret_cast<const float*>(inputs[0]);
+  float* output = reinterpret_cast<float**>(outputs)[0];
+  int threads = 512;
+  int grids = std::min((numel + threads - 1) / threads, 65536);
+  SliceKernel<<<grids, threads, 0, stream>>>(input, output, layout, numel);
+  return cudaGetLastError() != cudaSuccess;
+}
+
+}  // namespace plugin
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
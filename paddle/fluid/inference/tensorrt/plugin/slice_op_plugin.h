@@ -0,0 +1,82 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+#include "paddle/fluid/inference/tensorrt/plugin/trt_plugin.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+namespace plugin {
+
+// Slices the input along the axes, which are the dims of the TensorRT input
+// without the batch. As in fluid, the negative starts and ends count from the
+// end of the dims, and the ends are clipped to the dims.
+class SlicePlugin : public PluginTensorRT {
+ public:
+  SlicePlugin(std::vector<int> const &axes, std::vector<int> const &starts,
+              std::vector<int> const &ends)
+      : axes_(axes), starts_(starts), ends_(ends) {}
+
+  // It was used for tensorrt deserialization.
+  // It should not be called by users.
+  SlicePlugin(void const *serial_data, size_t serial_length) {
+    deserializeBase(serial_data, serial_length);
+    DeserializeValue(&serial_data, &serial_length, &axes_);
+    DeserializeValue(&serial_data, &serial_length, &starts_);
+    DeserializeValue(&serial_data, &serial_length, &ends_);
+  }
+
+  SlicePlugin *clone() const override {
+    return new SlicePlugin(axes_, starts_, ends_);
+  }
+
+  const char *getPluginType() const override { return "slice"; }
+  int getNbOutputs() const override { return 1; }
+  nvinfer1::Dims getOutputDimensions(int index,
+                                     const nvinfer1::Dims *input_dims,
+                                     int num_inputs) override;
+  int enqueue(int batch_size, const void *const *inputs, void **outputs,
+              void *workspace, cudaStream_t stream) override;
+
+ protected:
+  size_t getSerializationSize() override {
+    return SerializedSize(axes_) + SerializedSize(starts_) +
+           SerializedSize(ends_) + getBaseSerializationSize();
+  }
+
+  // TRT will call this func when we need to serialize the configuration of
+  // tensorrt.
+  void serialize(void *buffer) override {
+    serializeBase(buffer);
+    SerializeValue(&buffer, axes_);
+    SerializeValue(&buffer, starts_);
+    SerializeValue(&buffer, ends_);
+  }
+
+  // The starts of all the dims of input_dims and the dims of the output.
+  void SliceDims(const nvinfer1::Dims &input_dims, std::vector<int> *starts,
+                 nvinfer1::Dims *output_dims) const;
+
+  std::vector<int> axes_;
+  std::vector<int> starts_;
+  std::vector<int> ends_;
+};
+
+}  // namespace plugin
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
@@ -77,6 +77,54 @@ TEST_F(TensorRTEngineTest, add_layer) {
   ASSERT_EQ(y_cpu, x_v * 2 + 3);
 }
 
+TEST_F(TensorRTEngineTest, execute_on_external_buffers) {
+  float raw_weight[1] = {2.};
+  float raw_bias[1] = {3.};
+  TensorRTEngine::Weight weight(nvinfer1::DataType::kFLOAT, raw_weight, 1);
+  TensorRTEngine::Weight bias(nvinfer1::DataType::kFLOAT, raw_bias, 1);
+  auto* x = engine_->DeclareInput("x", nvinfer1::DataType::kFLOAT,
+                                  nvinfer1::DimsCHW{1, 1, 1});
+  auto* fc_layer = TRT_ENGINE_ADD_LAYER(engine_, FullyConnected, *x, 1,
+                                        weight.get(), bias.get());
+  PADDLE_ENFORCE(fc_layer != nullptr);
+  engine_->DeclareOutput(fc_layer, 0, "y");
+  engine_->FreezeNetwork();
+  ASSERT_EQ(engine_->GetNbBindings(), 2);
+
+  // The inputs and outputs are bound to the memory out of the engine, and
+  // another engine shares the device memory of the activations.
+  const int batch = 4;
+  float x_v[batch] = {1, 2, 3, 4};
+  float *x_gpu, *y_gpu;
+  ASSERT_EQ(cudaMalloc(&x_gpu, sizeof(x_v)), 0);
+  ASSERT_EQ(cudaMalloc(&y_gpu, sizeof(x_v)), 0);
+  ASSERT_EQ(cudaMemcpy(x_gpu, x_v, sizeof(x_v), cudaMemcpyHostToDevice), 0);
+  std::vector<void*> buffers(2);
+  buffers[engine_->GetBindingIndex("x")] = x_gpu;
+  buffers[engine_->GetBindingIndex("y")] = y_gpu;
+
+  TensorRTEngine other(10, 1 << 10);
+  other.InitNetwork();
+  auto* other_x = other.DeclareInput("x", nvinfer1::DataType::kFLOAT,
+                                     nvinfer1::DimsCHW{1, 1, 1});
+  auto* relu_layer = TRT_ENGINE_ADD_LAYER((&other), Activation, *other_x,
+                                          nvinfer1::ActivationType::kRELU);
+  other.DeclareOutput(relu_layer, 0, "y");
+  other.FreezeNetwork();
+
+  for (int i = 0; i < 2; ++i) {
+    engine_->Execute(batch, &buffers);
+    other.Execute(1);
+  }
+  float y_v[batch];
+  ASSERT_EQ(cudaMemcpy(y_v, y_gpu, sizeof(y_v), cudaMemcpyDeviceToHost), 0);
+  for (int i = 0; i < batch; ++i) {
+    ASSERT_EQ(y_v[i], x_v[i] * 2 + 3);
+  }
+  cudaFree(x_gpu);
+  cudaFree(y_gpu);
+}
+
 TEST_F(TensorRTEngineTest, add_layer_multi_dim) {
   // Weight in CPU memory.
   // It seems tensorrt FC use col-major: [[1.0, 3.3], [1.1, 4.4]]
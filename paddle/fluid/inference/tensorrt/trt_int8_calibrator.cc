@@ -0,0 +1,80 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/tensorrt/trt_int8_calibrator.h"
+#include <glog/logging.h>
+#include <fstream>
+#include <iterator>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+TRTInt8Calibrator::TRTInt8Calibrator(int batch_size,
+                                     const std::vector<Batch>& batches,
+                                     const std::string& table_path)
+    : batch_size_(batch_size),
+      batches_(batches),
+      table_path_(table_path),
+      table_(ReadTable(table_path)) {
+  PADDLE_ENFORCE(!table_.empty() || !batches_.empty(),
+                 "INT8 calibration needs either batches or a table");
+}
+
+bool TRTInt8Calibrator::getBatch(void* bindings[], const char* names[],
+                                 int nb_bindings) {
+  if (next_batch_ >= batches_.size()) return false;
+  auto& batch = batches_[next_batch_++];
+  for (int i = 0; i < nb_bindings; ++i) {
+    auto it = batch.find(names[i]);
+    PADDLE_ENFORCE(it != batch.end(), "no calibration data of input %s",
+                   names[i]);
+    bindings[i] = const_cast<void*>(it->second);
+  }
+  VLOG(3) << "INT8 calibration batch " << next_batch_ << "/"
+          << batches_.size();
+  return true;
+}
+
+const void* TRTInt8Calibrator::readCalibrationCache(size_t& length) {
+  length = table_.size();
+  return table_.empty() ? nullptr : table_.data();
+}
+
+void TRTInt8Calibrator::writeCalibrationCache(const void* cache,
+                                              size_t length) {
+  table_.assign(static_cast<const char*>(cache), length);
+  if (table_path_.empty()) return;
+  std::ofstream fout(table_path_, std::ios::out | std::ios::binary);
+  fout.write(table_.data(), table_.size());
+  if (!fout.good()) {
+    LOG(WARNING) << "Failed to save the INT8 calibration table to "
+                 << table_path_;
+    return;
+  }
+  VLOG(3) << "Save the INT8 calibration table to " << table_path_;
+}
+
+std::string TRTInt8Calibrator::ReadTable(const std::string& table_path) {
+  if (table_path.empty()) return "";
+  std::ifstream fin(table_path, std::ios::in | std::ios::binary);
+  if (!fin.is_open()) return "";
+  return std::string((std::istreambuf_iterator<char>(fin)),
+                     std::istreambuf_iterator<char>());
+}
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
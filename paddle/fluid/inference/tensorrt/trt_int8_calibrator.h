@@ -0,0 +1,64 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <NvInfer.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace paddle {
+namespace inference {
+namespace tensorrt {
+
+/*
+ * The entropy calibrator of the INT8 engine.
+ *
+ * The calibration batches are the inputs already in GPU memory, which are
+ * collected from the first runs of the predictor. The calibration table is
+ * read from and written to the table file if it is given, so that the next
+ * build of the same engine needs no batches.
+ */
+class TRTInt8Calibrator : public nvinfer1::IInt8EntropyCalibrator {
+ public:
+  // Each batch maps the input names to their GPU memory.
+  using Batch = std::unordered_map<std::string, const void*>;
+
+  TRTInt8Calibrator(int batch_size, const std::vector<Batch>& batches,
+                    const std::string& table_path);
+  // Calibrate with the table only.
+  explicit TRTInt8Calibrator(const std::string& table_path)
+      : TRTInt8Calibrator(0, {}, table_path) {}
+
+  int getBatchSize() const override { return batch_size_; }
+  bool getBatch(void* bindings[], const char* names[],
+                int nb_bindings) override;
+  const void* readCalibrationCache(size_t& length) override;  // NOLINT
+  void writeCalibrationCache(const void* cache, size_t length) override;
+
+  // Read the table file, empty if it does not exist.
+  static std::string ReadTable(const std::string& table_path);
+
+ private:
+  int batch_size_;
+  std::vector<Batch> batches_;
+  size_t next_batch_{0};
+  std::string table_path_;
+  std::string table_;
+};
+
+}  // namespace tensorrt
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,94 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <fstream>
+#include <iostream>
+#include "paddle/fluid/inference/tests/api/tester_helper.h"
+
+DEFINE_int32(image_height, 800, "The height of the fake images.");
+DEFINE_int32(image_width, 1216, "The width of the fake images.");
+
+namespace paddle {
+namespace inference {
+namespace analysis {
+
+// The benchmark of a two-stage detection model like Faster R-CNN, whose
+// feeds are the images of [N, 3, H, W] and the im_info of [N, 3], with the
+// fake data of the batch size FLAGS_batch_size.
+void SetConfig(AnalysisConfig *cfg, bool use_gpu) {
+  cfg->SetModel(FLAGS_infer_model + "/model", FLAGS_infer_model + "/params");
+  if (use_gpu) {
+    cfg->EnableUseGpu(100, 0);
+  } else {
+    cfg->DisableGpu();
+  }
+  cfg->SwitchIrOptim();
+  cfg->SwitchSpecifyInputNames(false);
+  cfg->SetCpuMathLibraryNumThreads(FLAGS_paddle_num_threads);
+}
+
+void SetInput(std::vector<std::vector<PaddleTensor>> *inputs) {
+  PADDLE_ENFORCE_EQ(FLAGS_test_all_data, 0, "Only have single batch of data.");
+  auto feed_target_shapes =
+      GetFeedTargetShapes(FLAGS_infer_model, true, "model", "params");
+  std::vector<PaddleTensor> input_slots(feed_target_shapes.size());
+  for (size_t i = 0; i < feed_target_shapes.size(); ++i) {
+    auto &input = input_slots[i];
+    input.dtype = PaddleDType::FLOAT32;
+    input.lod.assign({{0, static_cast<size_t>(FLAGS_batch_size)}});
+    if (feed_target_shapes[i].size() == 4) {
+      // The images.
+      input.shape = {FLAGS_batch_size, 3, FLAGS_image_height,
+                     FLAGS_image_width};
+      size_t len = FLAGS_batch_size * 3 * FLAGS_image_height *
+                   FLAGS_image_width;
+      input.data.Resize(len * sizeof(float));
+      float *input_data = static_cast<float *>(input.data.data());
+      for (size_t j = 0; j < len; ++j) {
+        input_data[j] = static_cast<float>(j % 255) / 255.f - 0.5f;
+      }
+    } else {
+      // The im_info of [height, width, scale].
+      input.shape = {FLAGS_batch_size, 3};
+      input.data.Resize(FLAGS_batch_size * 3 * sizeof(float));
+      float *input_data = static_cast<float *>(input.data.data());
+      for (int j = 0; j < FLAGS_batch_size; ++j) {
+        input_data[j * 3] = FLAGS_image_height;
+        input_data[j * 3 + 1] = FLAGS_image_width;
+        input_data[j * 3 + 2] = 1.f;
+      }
+    }
+  }
+  inputs->emplace_back(input_slots);
+}
+
+void profile(bool use_gpu) {
+  AnalysisConfig cfg;
+  SetConfig(&cfg, use_gpu);
+
+  std::vector<PaddleTensor> outputs;
+  std::vector<std::vector<PaddleTensor>> input_slots_all;
+  SetInput(&input_slots_all);
+  TestPrediction(reinterpret_cast<const PaddlePredictor::Config *>(&cfg),
+                 input_slots_all, &outputs, FLAGS_num_threads);
+}
+
+#ifdef PADDLE_WITH_CUDA
+TEST(Analyzer_detect, profile_gpu) { profile(true /* use_gpu */); }
+#endif
+TEST(Analyzer_detect, profile) { profile(false /* use_gpu */); }
+
+}  // namespace analysis
+}  // namespace inference
+}  // namespace paddle
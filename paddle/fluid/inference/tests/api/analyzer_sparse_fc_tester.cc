@@ -0,0 +1,190 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sys/stat.h>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/inference/tests/api/tester_helper.h"
+
+DEFINE_string(sparse_fc_model_dir, "sparse_fc_model",
+              "The directory the synthetic pruned fc model is saved to.");
+DEFINE_int32(sparse_fc_width, 1024, "The width of the fc layers.");
+DEFINE_int32(sparse_fc_layers, 3, "The number of the fc layers.");
+DEFINE_double(sparse_fc_sparsity, 0.9,
+              "The ratio of the zeros of the pruned weights.");
+
+namespace paddle {
+namespace inference {
+namespace analysis {
+
+using framework::LoDTensor;
+
+void SaveParam(const std::string &dirname, const std::string &name,
+               const std::vector<int64_t> &shape, std::mt19937 *engine,
+               double sparsity, framework::BlockDesc *block) {
+  auto *var = block->Var(name);
+  var->SetType(framework::proto::VarType::LOD_TENSOR);
+  var->SetDataType(framework::proto::VarType::FP32);
+  var->SetShape(shape);
+  var->SetPersistable(true);
+
+  LoDTensor tensor;
+  float *data = tensor.mutable_data<float>(framework::make_ddim(shape),
+                                           platform::CPUPlace());
+  std::uniform_real_distribution<float> value(-1.f, 1.f);
+  std::uniform_real_distribution<double> prune(0., 1.);
+  for (int64_t i = 0; i < tensor.numel(); ++i) {
+    data[i] = prune(*engine) < sparsity ? 0.f : value(*engine);
+  }
+  std::ofstream os(dirname + "/" + name, std::ios::binary);
+  platform::CPUDeviceContext ctx;
+  framework::SerializeToStream(os, tensor, ctx);
+}
+
+// The model of FLAGS_sparse_fc_layers fc + relu layers of the width
+// FLAGS_sparse_fc_width, of which the weights are pruned to
+// FLAGS_sparse_fc_sparsity.
+void BuildModel(const std::string &dirname) {
+  mkdir(dirname.c_str(), 0755);
+  framework::ProgramDesc prog;
+  auto *block = prog.MutableBlock(0);
+  std::mt19937 engine(0);
+  int64_t width = FLAGS_sparse_fc_width;
+
+  auto *feed = block->Var("feed");
+  feed->SetType(framework::proto::VarType::FEED_MINIBATCH);
+  feed->SetPersistable(true);
+  auto *fetch = block->Var("fetch");
+  fetch->SetType(framework::proto::VarType::FETCH_LIST);
+  fetch->SetPersistable(true);
+  auto *x = block->Var("x");
+  x->SetType(framework::proto::VarType::LOD_TENSOR);
+  x->SetDataType(framework::proto::VarType::FP32);
+  x->SetShape({-1, width});
+
+  auto *feed_op = block->AppendOp();
+  feed_op->SetType("feed");
+  feed_op->SetInput("X", {"feed"});
+  feed_op->SetOutput("Out", {"x"});
+  feed_op->SetAttr("col", 0);
+
+  std::string input = "x";
+  for (int i = 0; i < FLAGS_sparse_fc_layers; ++i) {
+    auto suffix = std::to_string(i);
+    SaveParam(dirname, "w" + suffix, {width, width}, &engine,
+              FLAGS_sparse_fc_sparsity, block);
+    SaveParam(dirname, "b" + suffix, {1, width}, &engine, 0., block);
+    for (auto &name : {"fc" + suffix, "relu" + suffix}) {
+      auto *var = block->Var(name);
+      var->SetType(framework::proto::VarType::LOD_TENSOR);
+      var->SetDataType(framework::proto::VarType::FP32);
+      var->SetShape({-1, width});
+    }
+    auto *fc = block->AppendOp();
+    fc->SetType("fc");
+    fc->SetInput("Input", {input});
+    fc->SetInput("W", {"w" + suffix});
+    fc->SetInput("Bias", {"b" + suffix});
+    fc->SetOutput("Out", {"fc" + suffix});
+    fc->SetAttr("in_num_col_dims", 1);
+    auto *relu = block->AppendOp();
+    relu->SetType("relu");
+    relu->SetInput("X", {"fc" + suffix});
+    relu->SetOutput("Out", {"relu" + suffix});
+    input = "relu" + suffix;
+  }
+
+  auto *fetch_op = block->AppendOp();
+  fetch_op->SetType("fetch");
+  fetch_op->SetInput("X", {input});
+  fetch_op->SetOutput("Out", {"fetch"});
+  fetch_op->SetAttr("col", 0);
+
+  std::ofstream os(dirname + "/__model__", std::ios::binary);
+  os << prog.Proto()->SerializeAsString();
+}
+
+void SetConfig(AnalysisConfig *cfg, bool use_sparse_weights) {
+  cfg->SetModel(FLAGS_sparse_fc_model_dir);
+  cfg->DisableGpu();
+  cfg->SwitchIrOptim();
+  cfg->SwitchSpecifyInputNames();
+  cfg->SetCpuMathLibraryNumThreads(FLAGS_paddle_num_threads);
+  if (use_sparse_weights) cfg->EnableSparseWeights();
+}
+
+void SetInput(std::vector<std::vector<PaddleTensor>> *inputs) {
+  PaddleTensor x;
+  x.name = "x";
+  x.dtype = PaddleDType::FLOAT32;
+  x.shape = {FLAGS_batch_size, FLAGS_sparse_fc_width};
+  x.data.Resize(FLAGS_batch_size * FLAGS_sparse_fc_width * sizeof(float));
+  std::mt19937 engine(1);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  float *data = static_cast<float *>(x.data.data());
+  for (int i = 0; i < FLAGS_batch_size * FLAGS_sparse_fc_width; ++i) {
+    data[i] = dist(engine);
+  }
+  inputs->push_back({x});
+}
+
+// The outputs of the sparse kernels are the ones of the dense fc.
+TEST(Analyzer_sparse_fc, compare) {
+  BuildModel(FLAGS_sparse_fc_model_dir);
+  std::vector<std::vector<PaddleTensor>> inputs;
+  SetInput(&inputs);
+
+  AnalysisConfig dense_cfg;
+  SetConfig(&dense_cfg, false);
+  std::vector<PaddleTensor> dense_outputs;
+  auto dense_predictor = CreateTestPredictor(
+      reinterpret_cast<const PaddlePredictor::Config *>(&dense_cfg));
+  ASSERT_TRUE(dense_predictor->Run(inputs[0], &dense_outputs));
+
+  AnalysisConfig sparse_cfg;
+  SetConfig(&sparse_cfg, true);
+  std::vector<PaddleTensor> sparse_outputs;
+  auto sparse_predictor = CreateTestPredictor(
+      reinterpret_cast<const PaddlePredictor::Config *>(&sparse_cfg));
+  ASSERT_TRUE(sparse_predictor->Run(inputs[0], &sparse_outputs));
+  CompareResult(sparse_outputs, dense_outputs);
+
+  int num_ops;
+  auto fuse_statis = GetFuseStatis(sparse_predictor.get(), &num_ops);
+  ASSERT_TRUE(fuse_statis.count("sparse_weight"));
+  EXPECT_EQ(fuse_statis.at("sparse_weight"), FLAGS_sparse_fc_layers);
+}
+
+// Easy for profiling the dense and the sparse fc independently.
+TEST(Analyzer_sparse_fc, profile) {
+  BuildModel(FLAGS_sparse_fc_model_dir);
+  std::vector<std::vector<PaddleTensor>> inputs;
+  SetInput(&inputs);
+  for (bool use_sparse_weights : {false, true}) {
+    AnalysisConfig cfg;
+    SetConfig(&cfg, use_sparse_weights);
+    LOG(INFO) << (use_sparse_weights ? "sparse" : "dense") << " weights:";
+    std::vector<PaddleTensor> outputs;
+    TestOneThreadPrediction(
+        reinterpret_cast<const PaddlePredictor::Config *>(&cfg), inputs,
+        &outputs, FLAGS_use_analysis);
+  }
+}
+
+}  // namespace analysis
+}  // namespace inference
+}  // namespace paddle
@@ -45,6 +45,9 @@ DEFINE_bool(use_analysis, true,
             "Running the inference program in analysis mode.");
 DEFINE_bool(record_benchmark, false,
             "Record benchmark after profiling the model");
+DEFINE_string(benchmark_json, "",
+              "Append the latency percentiles, the QPS and the peak memory "
+              "of the runs to the file as a JSON line.");
 DEFINE_double(accuracy, 1e-3, "Result Accuracy.");
 
 DECLARE_bool(profile);
@@ -191,6 +194,21 @@ void GetInputPerBatch(const std::vector<std::vector<int64_t>> &in,
   }
 }
 
+// Record the per-run latencies in ms of all the threads, which run in
+// total_time ms in total.
+void RecordBenchmarkJson(const std::vector<float> &latencies, int num_threads,
+                         double total_time) {
+  Benchmark benchmark;
+  benchmark.SetName(FLAGS_model_name);
+  benchmark.SetBatchSize(FLAGS_batch_size);
+  benchmark.SetNumThreads(num_threads);
+  benchmark.SetLatencies(latencies);
+  benchmark.SetDurationSec(total_time / 1000);
+  benchmark.SetQps(latencies.size() * 1000 / total_time);
+  benchmark.SetPeakHostMemory(GetPeakHostMemory());
+  benchmark.PersistToJsonFile(FLAGS_benchmark_json);
+}
+
 void TestOneThreadPrediction(
     const PaddlePredictor::Config *config,
     const std::vector<std::vector<PaddleTensor>> &inputs,
@@ -213,15 +231,19 @@ void TestOneThreadPrediction(
 
   LOG(INFO) << "Run " << num_times << " times...";
   {
-    Timer run_timer;
+    std::vector<float> latencies;
+    Timer run_timer, step_timer;
     run_timer.tic();
     for (int i = 0; i < num_times; i++) {
       for (size_t j = 0; j < inputs.size(); j++) {
+        step_timer.tic();
         predictor->Run(inputs[j], outputs, batch_size);
+        latencies.push_back(step_timer.toc());
       }
     }
 
-    double latency = run_timer.toc() / num_times;
+    double total_time = run_timer.toc();
+    double latency = total_time / num_times;
     PrintTime(batch_size, num_times, 1, 0, latency, inputs.size());
     if (FLAGS_record_benchmark) {
       Benchmark benchmark;
@@ -230,6 +252,9 @@ void TestOneThreadPrediction(
       benchmark.SetLatency(latency);
       benchmark.PersistToFile("benchmark_record.txt");
     }
+    if (!FLAGS_benchmark_json.empty()) {
+      RecordBenchmarkJson(latencies, 1, total_time);
+    }
   }
 }
 
@@ -244,6 +269,8 @@ void TestMultiThreadPrediction(
   auto main_predictor = CreateTestPredictor(config, use_analysis);
 
   size_t total_time{0};
+  std::vector<std::vector<float>> latencies(num_threads);
+  std::vector<double> thread_times(num_threads);
   for (int tid = 0; tid < num_threads; ++tid) {
     threads.emplace_back([&, tid]() {
       // Each thread should have local inputs and outputs.
@@ -273,15 +300,18 @@ void TestMultiThreadPrediction(
 
       LOG(INFO) << "Thread " << tid << " run " << num_times << " times...";
       {
-        Timer timer;
+        Timer timer, step_timer;
         timer.tic();
         for (int i = 0; i < num_times; i++) {
           for (const auto &input : inputs) {
+            step_timer.tic();
             ASSERT_TRUE(predictor->Run(input, &outputs_tid));
+            latencies[tid].push_back(step_timer.toc());
           }
         }
 
         auto time = timer.toc();
+        thread_times[tid] = time;
         total_time += time;
         PrintTime(batch_size, num_times, num_threads, tid, time / num_times,
                   inputs.size());
@@ -291,6 +321,16 @@ void TestMultiThreadPrediction(
   for (int i = 0; i < num_threads; ++i) {
     threads[i].join();
   }
+  if (!FLAGS_benchmark_json.empty()) {
+    std::vector<float> all_latencies;
+    for (auto &thread_latencies : latencies) {
+      all_latencies.insert(all_latencies.end(), thread_latencies.begin(),
+                           thread_latencies.end());
+    }
+    RecordBenchmarkJson(
+        all_latencies, num_threads,
+        *std::max_element(thread_times.begin(), thread_times.end()));
+  }
 }
 
 void TestPrediction(const PaddlePredictor::Config *config,
@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include "paddle/fluid/inference/utils/benchmark.h"
+#include <algorithm>
+#include <numeric>
 #include <sstream>
 #include "paddle/fluid/platform/enforce.h"
 
@@ -45,5 +47,63 @@ void Benchmark::PersistToFile(const std::string &path) const {
   file.close();
 }
 
+void Benchmark::SetLatencies(std::vector<float> latencies) {
+  PADDLE_ENFORCE(!latencies.empty(), "The latencies should not be empty.");
+  std::sort(latencies.begin(), latencies.end());
+  latencies_ = std::move(latencies);
+  latency_ = std::accumulate(latencies_.begin(), latencies_.end(), 0.0) /
+             latencies_.size();
+}
+
+float Benchmark::LatencyQuantile(float q) const {
+  if (latencies_.empty()) return latency_;
+  // The nearest rank.
+  size_t rank = static_cast<size_t>(q * latencies_.size() + 0.5);
+  rank = std::min(std::max<size_t>(rank, 1), latencies_.size());
+  return latencies_[rank - 1];
+}
+
+std::string Benchmark::SerializeToJson() const {
+  const double mb = 1 << 20;
+  std::stringstream ss;
+  ss << "{\"name\": \"" << name_ << "\", ";
+  ss << "\"batch_size\": " << batch_size_ << ", ";
+  ss << "\"num_threads\": " << num_threads_ << ", ";
+  ss << "\"use_gpu\": " << (use_gpu_ ? "true" : "false") << ", ";
+  ss << "\"num_runs\": " << latencies_.size() << ", ";
+  ss << "\"duration_sec\": " << duration_sec_ << ", ";
+  ss << "\"latency_ms\": {\"avg\": " << latency_;
+  ss << ", \"p50\": " << LatencyQuantile(0.5);
+  ss << ", \"p90\": " << LatencyQuantile(0.9);
+  ss << ", \"p99\": " << LatencyQuantile(0.99);
+  ss << ", \"p999\": " << LatencyQuantile(0.999) << "}, ";
+  ss << "\"qps\": " << qps_ << ", ";
+  ss << "\"samples_per_sec\": " << qps_ * batch_size_ << ", ";
+  ss << "\"peak_host_memory_mb\": " << peak_host_memory_ / mb << ", ";
+  ss << "\"peak_device_memory_mb\": " << peak_device_memory_ / mb << "}";
+  return ss.str();
+}
+
+void Benchmark::PersistToJsonFile(const std::string &path) const {
+  std::ofstream file(path, std::ios::app);
+  PADDLE_ENFORCE(file.is_open(), "Can not open %s to add benchmark", path);
+  file << SerializeToJson() << '\n';
+  file.close();
+}
+
+size_t GetPeakHostMemory() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 6, "VmHWM:") == 0) {
+      std::stringstream ss(line.substr(6));
+      size_t kb = 0;
+      ss >> kb;
+      return kb * 1024;
+    }
+  }
+  return 0;
+}
+
 }  // namespace inference
 }  // namespace paddle
@@ -16,6 +16,7 @@
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <vector>
 
 namespace paddle {
 namespace inference {
@@ -36,19 +37,53 @@ struct Benchmark {
   float latency() const { return latency_; }
   void SetLatency(float x) { latency_ = x; }
 
+  // Set the latency of every run in ms, from which the average latency and
+  // the p50/p90/p99/p999 latency are computed.
+  void SetLatencies(std::vector<float> latencies);
+  // The latency in ms at the quantile q, e.g. 0.99, of the runs.
+  float LatencyQuantile(float q) const;
+
+  // The runs per second of all the threads.
+  float qps() const { return qps_; }
+  void SetQps(float x) { qps_ = x; }
+
+  float duration_sec() const { return duration_sec_; }
+  void SetDurationSec(float x) { duration_sec_ = x; }
+
+  // The high-water marks of the memory of the process and the device.
+  size_t peak_host_memory() const { return peak_host_memory_; }
+  void SetPeakHostMemory(size_t bytes) { peak_host_memory_ = bytes; }
+  size_t peak_device_memory() const { return peak_device_memory_; }
+  void SetPeakDeviceMemory(size_t bytes) { peak_device_memory_ = bytes; }
+
   const std::string& name() const { return name_; }
   void SetName(const std::string& name) { name_ = name; }
 
   std::string SerializeToString() const;
   void PersistToFile(const std::string& path) const;
 
+  // Serialize all the fields to a JSON object, which is written to the path
+  // with one object per line by PersistToJsonFile.
+  std::string SerializeToJson() const;
+  void PersistToJsonFile(const std::string& path) const;
+
  private:
   bool use_gpu_{false};
   int batch_size_{0};
   float latency_;
   int num_threads_{1};
   std::string name_;
+  // The sorted latencies of all the runs.
+  std::vector<float> latencies_;
+  float qps_{0};
+  float duration_sec_{0};
+  size_t peak_host_memory_{0};
+  size_t peak_device_memory_{0};
 };
 
+// The peak resident memory (VmHWM) of the process in bytes, 0 if it is not
+// available.
+size_t GetPeakHostMemory();
+
 }  // namespace inference
 }  // namespace paddle
@@ -0,0 +1,137 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/utils/benchmark_runner.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <memory>
+#include <thread>  // NOLINT
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/string/split.h"
+
+namespace paddle {
+namespace inference {
+
+std::vector<PaddleTensor> MakeFakeInputs(const std::string& input_shapes,
+                                         const std::string& input_dtypes,
+                                         int batch_size, int seq_len) {
+  PADDLE_ENFORCE(!input_shapes.empty(), "The input shapes are not set.");
+  auto shapes = string::Split(input_shapes, ';');
+  std::vector<std::string> dtypes;
+  if (!input_dtypes.empty()) {
+    dtypes = string::Split(input_dtypes, ';');
+    PADDLE_ENFORCE_EQ(dtypes.size(), shapes.size(),
+                      "The numbers of the input dtypes and the input shapes "
+                      "should be the same.");
+  }
+
+  std::vector<PaddleTensor> inputs(shapes.size());
+  for (size_t i = 0; i < shapes.size(); ++i) {
+    auto& input = inputs[i];
+    size_t numel = 1;
+    for (auto& dim : string::Split(shapes[i], ',')) {
+      input.shape.push_back(std::stoi(dim));
+      numel *= input.shape.back();
+    }
+    if (seq_len > 0) {
+      PADDLE_ENFORCE_EQ(input.shape[0], batch_size * seq_len);
+      std::vector<size_t> lod(1, 0);
+      for (int b = 0; b < batch_size; ++b) {
+        lod.push_back(lod.back() + seq_len);
+      }
+      input.lod.push_back(lod);
+    }
+    if (dtypes.empty() || dtypes[i] == "float32") {
+      input.dtype = PaddleDType::FLOAT32;
+      input.data.Resize(numel * sizeof(float));
+      auto* data = static_cast<float*>(input.data.data());
+      for (size_t j = 0; j < numel; ++j) {
+        data[j] = static_cast<float>(j) / numel;
+      }
+    } else if (dtypes[i] == "int64") {
+      input.dtype = PaddleDType::INT64;
+      input.data.Resize(numel * sizeof(int64_t));
+      auto* data = static_cast<int64_t*>(input.data.data());
+      std::fill(data, data + numel, 0);
+    } else {
+      PADDLE_THROW("Unsupported input dtype %s.", dtypes[i]);
+    }
+  }
+  return inputs;
+}
+
+static size_t GetPeakDeviceMemory() {
+  size_t peak = 0;
+  auto all_stats =
+      memory::allocation::AllocatorFacade::Instance().GetAllStats();
+  for (auto& item : all_stats) {
+    if (platform::is_gpu_place(item.first)) {
+      peak = std::max(peak, item.second.peak_bytes);
+    }
+  }
+  return peak;
+}
+
+void RunTimedPredictors(PaddlePredictor* main_predictor,
+                        const std::vector<PaddleTensor>& inputs,
+                        int batch_size, int num_threads, int warmup,
+                        double duration_sec, Benchmark* benchmark) {
+  using clock = std::chrono::steady_clock;
+  std::vector<std::vector<float>> latencies(num_threads);
+  std::vector<std::thread> threads;
+  clock::time_point start;
+  std::atomic<int> num_ready{0};
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid] {
+      auto predictor = main_predictor->Clone();
+      std::vector<PaddleTensor> outputs;
+      for (int i = 0; i < warmup; ++i) {
+        PADDLE_ENFORCE(predictor->Run(inputs, &outputs, batch_size));
+      }
+      // All the threads start the timed runs together.
+      if (++num_ready == num_threads) start = clock::now();
+      while (num_ready < num_threads) std::this_thread::yield();
+      auto end = clock::now() + std::chrono::microseconds(
+                                    static_cast<int64_t>(duration_sec * 1e6));
+      for (auto now = clock::now(); now < end;) {
+        PADDLE_ENFORCE(predictor->Run(inputs, &outputs, batch_size));
+        auto next = clock::now();
+        latencies[tid].push_back(
+            std::chrono::duration<float, std::milli>(next - now).count());
+        now = next;
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  float duration =
+      std::chrono::duration<float>(clock::now() - start).count();
+
+  std::vector<float> all_latencies;
+  for (auto& thread_latencies : latencies) {
+    all_latencies.insert(all_latencies.end(), thread_latencies.begin(),
+                         thread_latencies.end());
+  }
+  benchmark->SetBatchSize(batch_size);
+  benchmark->SetNumThreads(num_threads);
+  benchmark->SetQps(all_latencies.size() / duration);
+  benchmark->SetLatencies(std::move(all_latencies));
+  benchmark->SetDurationSec(duration);
+  benchmark->SetPeakHostMemory(GetPeakHostMemory());
+  benchmark->SetPeakDeviceMemory(GetPeakDeviceMemory());
+}
+
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,43 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#pragma once
+
+#include <string>
+#include <vector>
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/fluid/inference/utils/benchmark.h"
+
+namespace paddle {
+namespace inference {
+
+// The fake inputs of the shapes, e.g. "1,3,224,224;1,1", and the data
+// types, float32 or int64, empty for float32 of all the inputs. With
+// seq_len > 0, the inputs are batch_size sequences of seq_len, whose first
+// dim should be batch_size * seq_len. The inputs are not random, so that
+// the runs are reproducible, and the int64 inputs are 0, which is a valid
+// id of any embedding.
+std::vector<PaddleTensor> MakeFakeInputs(const std::string& shapes,
+                                         const std::string& dtypes,
+                                         int batch_size, int seq_len);
+
+// Runs the clones of the predictor by num_threads threads, warmup runs and
+// then duration_sec of the timed runs each, and sets the latencies, the
+// qps, the duration and the peak memory of the benchmark.
+void RunTimedPredictors(PaddlePredictor* main_predictor,
+                        const std::vector<PaddleTensor>& inputs,
+                        int batch_size, int num_threads, int warmup,
+                        double duration_sec, Benchmark* benchmark);
+
+}  // namespace inference
+}  // namespace paddle
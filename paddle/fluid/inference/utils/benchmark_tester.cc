@@ -36,4 +36,24 @@ TEST(Benchmark, PersistToFile) {
   benchmark.PersistToFile("1.log");
   benchmark.PersistToFile("1.log");
   benchmark.PersistToFile("1.log");
-}
\ No newline at end of file
+}
+
+TEST(Benchmark, Latencies) {
+  Benchmark benchmark;
+  benchmark.SetName("key0");
+  benchmark.SetBatchSize(4);
+  std::vector<float> latencies;
+  for (int i = 1000; i > 0; --i) latencies.push_back(i);
+  benchmark.SetLatencies(latencies);
+  benchmark.SetQps(10);
+  EXPECT_FLOAT_EQ(benchmark.latency(), 500.5);
+  EXPECT_FLOAT_EQ(benchmark.LatencyQuantile(0.5), 500);
+  EXPECT_FLOAT_EQ(benchmark.LatencyQuantile(0.99), 990);
+  EXPECT_FLOAT_EQ(benchmark.LatencyQuantile(0.999), 999);
+  EXPECT_NE(benchmark.SerializeToJson().find(
+                "\"p99\": 990, \"p999\": 999}, \"qps\": 10, "
+                "\"samples_per_sec\": 40"),
+            std::string::npos);
+  benchmark.PersistToJsonFile("1.json");
+  LOG(INFO) << "benchmark:\n" << benchmark.SerializeToJson();
+}
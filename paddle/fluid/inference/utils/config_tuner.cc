@@ -0,0 +1,155 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/utils/config_tuner.h"
+#include <algorithm>
+#include <set>
+#include <sstream>
+
+namespace paddle {
+namespace inference {
+
+void TuneCandidate::Apply(contrib::AnalysisConfig* config) const {
+  config->DisableGpu();
+  config->SetCpuMathLibraryNumThreads(cpu_math_threads);
+  if (use_mkldnn) {
+    config->EnableMKLDNN();
+    if (!mkldnn_ops.empty()) config->SetMKLDNNOp(mkldnn_ops);
+  }
+  config->SwitchIrOptim(ir_optim);
+  config->EnableStaticMemoryPlan(static_memory_plan);
+}
+
+// The ops in the order of name, so that the outputs are reproducible.
+static std::string JoinOps(const std::unordered_set<std::string>& ops,
+                           const std::string& quote) {
+  std::set<std::string> sorted(ops.begin(), ops.end());
+  std::stringstream ss;
+  for (auto it = sorted.begin(); it != sorted.end(); ++it) {
+    if (it != sorted.begin()) ss << ", ";
+    ss << quote << *it << quote;
+  }
+  return ss.str();
+}
+
+std::string TuneCandidate::SerializeToJson() const {
+  std::stringstream ss;
+  ss << "{\"cpu_math_threads\": " << cpu_math_threads << ", ";
+  ss << "\"num_predictors\": " << num_predictors << ", ";
+  ss << "\"batch_size\": " << batch_size << ", ";
+  ss << "\"use_mkldnn\": " << (use_mkldnn ? "true" : "false") << ", ";
+  ss << "\"mkldnn_ops\": [" << JoinOps(mkldnn_ops, "\"") << "], ";
+  ss << "\"ir_optim\": " << (ir_optim ? "true" : "false") << ", ";
+  ss << "\"static_memory_plan\": " << (static_memory_plan ? "true" : "false")
+     << "}";
+  return ss.str();
+}
+
+std::string TuneCandidate::SerializeToCode() const {
+  std::stringstream ss;
+  ss << "config.DisableGpu();\n";
+  ss << "config.SetCpuMathLibraryNumThreads(" << cpu_math_threads << ");\n";
+  if (use_mkldnn) {
+    ss << "config.EnableMKLDNN();\n";
+    if (!mkldnn_ops.empty()) {
+      ss << "config.SetMKLDNNOp({" << JoinOps(mkldnn_ops, "\"") << "});\n";
+    }
+  }
+  ss << "config.SwitchIrOptim(" << (ir_optim ? "true" : "false") << ");\n";
+  ss << "config.EnableStaticMemoryPlan("
+     << (static_memory_plan ? "true" : "false") << ");\n";
+  ss << "// Run " << num_predictors << " predictors of the batch size "
+     << batch_size << " concurrently.\n";
+  return ss.str();
+}
+
+std::vector<TuneCandidate> EnumerateCandidates(const TuneSpace& space) {
+  // No MKLDNN, and then the MKLDNN op sets.
+  std::vector<int> mkldnn_choices(1, -1);
+  for (size_t i = 0; i < space.mkldnn_op_sets.size(); ++i) {
+    mkldnn_choices.push_back(i);
+  }
+  std::vector<TuneCandidate> candidates;
+  for (int threads : space.cpu_math_threads) {
+    for (int predictors : space.num_predictors) {
+      if (space.max_cores > 0 && threads * predictors > space.max_cores) {
+        continue;
+      }
+      for (int batch_size : space.batch_sizes) {
+        for (int mkldnn : mkldnn_choices) {
+          for (bool ir_optim : space.ir_optim) {
+            for (bool static_memory_plan : space.static_memory_plan) {
+              TuneCandidate candidate;
+              candidate.cpu_math_threads = threads;
+              candidate.num_predictors = predictors;
+              candidate.batch_size = batch_size;
+              candidate.use_mkldnn = mkldnn >= 0;
+              if (mkldnn >= 0) {
+                candidate.mkldnn_ops = space.mkldnn_op_sets[mkldnn];
+              }
+              candidate.ir_optim = ir_optim;
+              candidate.static_memory_plan = static_memory_plan;
+              candidates.push_back(candidate);
+            }
+          }
+        }
+      }
+    }
+  }
+  return candidates;
+}
+
+std::vector<size_t> ParetoFront(const std::vector<TuneResult>& results) {
+  std::vector<size_t> order(results.size());
+  for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+  // By the latency, and then the most samples per second first, so a
+  // result is on the front iff it is faster than all the ones before it.
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    if (P99Latency(results[a]) != P99Latency(results[b])) {
+      return P99Latency(results[a]) < P99Latency(results[b]);
+    }
+    return SamplesPerSec(results[a]) > SamplesPerSec(results[b]);
+  });
+  std::vector<size_t> front;
+  for (size_t i : order) {
+    if (front.empty() ||
+        SamplesPerSec(results[i]) > SamplesPerSec(results[front.back()])) {
+      front.push_back(i);
+    }
+  }
+  return front;
+}
+
+std::vector<size_t> RankResults(const std::vector<TuneResult>& results,
+                                float latency_slo_ms) {
+  auto in_slo = [&](size_t i) {
+    return latency_slo_ms <= 0 || P99Latency(results[i]) <= latency_slo_ms;
+  };
+  std::vector<size_t> order(results.size());
+  for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    if (in_slo(a) != in_slo(b)) return in_slo(a);
+    if (in_slo(a)) return SamplesPerSec(results[a]) > SamplesPerSec(results[b]);
+    return P99Latency(results[a]) < P99Latency(results[b]);
+  });
+  return order;
+}
+
+int PickBest(const std::vector<TuneResult>& results, float latency_slo_ms) {
+  if (results.empty()) return -1;
+  return RankResults(results, latency_slo_ms).front();
+}
+
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,92 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#pragma once
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "paddle/fluid/inference/api/paddle_analysis_config.h"
+#include "paddle/fluid/inference/utils/benchmark.h"
+
+namespace paddle {
+namespace inference {
+
+// A point of the configuration space of a model on CPU: the AnalysisConfig
+// of the predictors, how many of them run concurrently in the process, and
+// the batch size of a run.
+struct TuneCandidate {
+  int cpu_math_threads{1};
+  int num_predictors{1};
+  int batch_size{1};
+  bool use_mkldnn{false};
+  // The ops run by MKLDNN, all the ops if empty.
+  std::unordered_set<std::string> mkldnn_ops;
+  bool ir_optim{true};
+  bool static_memory_plan{false};
+
+  // Sets the options of the candidate to the config of the model.
+  void Apply(contrib::AnalysisConfig* config) const;
+
+  std::string SerializeToJson() const;
+  // The calls of AnalysisConfig that make the candidate.
+  std::string SerializeToCode() const;
+};
+
+// The values of every dimension of the search.
+struct TuneSpace {
+  std::vector<int> cpu_math_threads{1};
+  std::vector<int> num_predictors{1};
+  std::vector<int> batch_sizes{1};
+  // The MKLDNN op sets to try besides no MKLDNN, an empty set for all the
+  // ops.
+  std::vector<std::unordered_set<std::string>> mkldnn_op_sets;
+  std::vector<bool> ir_optim{true};
+  std::vector<bool> static_memory_plan{false};
+  // The candidates of more cpu_math_threads * num_predictors are skipped,
+  // no limit if 0.
+  int max_cores{0};
+};
+
+// The grid of the space, skipping the oversubscribed candidates.
+std::vector<TuneCandidate> EnumerateCandidates(const TuneSpace& space);
+
+struct TuneResult {
+  TuneCandidate candidate;
+  Benchmark benchmark;
+};
+
+inline float SamplesPerSec(const TuneResult& result) {
+  return result.benchmark.qps() * result.benchmark.batch_size();
+}
+
+inline float P99Latency(const TuneResult& result) {
+  return result.benchmark.LatencyQuantile(0.99);
+}
+
+// The indices of the results on the Pareto front of the samples per second
+// and the p99 latency, which no result beats in both, in the ascending
+// order of the latency.
+std::vector<size_t> ParetoFront(const std::vector<TuneResult>& results);
+
+// The indices of the results from the best: the ones of a p99 latency
+// within latency_slo_ms by the most samples per second, and then the others
+// by the lowest p99 latency. No SLO if latency_slo_ms <= 0.
+std::vector<size_t> RankResults(const std::vector<TuneResult>& results,
+                                float latency_slo_ms);
+
+// The index of the best result, -1 if there is no result.
+int PickBest(const std::vector<TuneResult>& results, float latency_slo_ms);
+
+}  // namespace inference
+}  // namespace paddle
@@ -0,0 +1,77 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/utils/config_tuner.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using paddle::inference::TuneCandidate;
+using paddle::inference::TuneResult;
+using paddle::inference::TuneSpace;
+
+static TuneResult MakeResult(int batch_size, float qps, float latency) {
+  TuneResult result;
+  result.candidate.batch_size = batch_size;
+  result.benchmark.SetBatchSize(batch_size);
+  result.benchmark.SetQps(qps);
+  result.benchmark.SetLatencies(std::vector<float>(10, latency));
+  return result;
+}
+
+TEST(ConfigTuner, EnumerateCandidates) {
+  TuneSpace space;
+  space.cpu_math_threads = {1, 2, 4};
+  space.num_predictors = {1, 2, 4};
+  space.batch_sizes = {1, 8};
+  space.mkldnn_op_sets = {{}, {"conv2d", "pool2d"}};
+  space.ir_optim = {true, false};
+  space.max_cores = 4;
+  auto candidates = paddle::inference::EnumerateCandidates(space);
+  // 6 of the 9 thread and predictor pairs fit in 4 cores.
+  EXPECT_EQ(candidates.size(), 6UL * 2 * 3 * 2);
+  int mkldnn = 0;
+  for (auto& candidate : candidates) {
+    EXPECT_LE(candidate.cpu_math_threads * candidate.num_predictors, 4);
+    mkldnn += candidate.use_mkldnn;
+  }
+  EXPECT_EQ(mkldnn, 6 * 2 * 2 * 2);
+
+  TuneCandidate candidate = candidates.back();
+  EXPECT_TRUE(candidate.use_mkldnn);
+  EXPECT_NE(candidate.SerializeToCode().find(
+                "config.SetMKLDNNOp({\"conv2d\", \"pool2d\"});"),
+            std::string::npos);
+  EXPECT_NE(candidate.SerializeToJson().find(
+                "\"mkldnn_ops\": [\"conv2d\", \"pool2d\"]"),
+            std::string::npos);
+}
+
+TEST(ConfigTuner, ParetoFrontAndBest) {
+  std::vector<TuneResult> results;
+  results.push_back(MakeResult(1, 100, 5));   // 100 samples/s at 5 ms.
+  results.push_back(MakeResult(4, 50, 12));   // 200 at 12 ms.
+  results.push_back(MakeResult(1, 150, 12));  // 150 at 12 ms, dominated.
+  results.push_back(MakeResult(8, 40, 30));   // 320 at 30 ms.
+  results.push_back(MakeResult(2, 40, 30));   // 80 at 30 ms, dominated.
+
+  auto front = paddle::inference::ParetoFront(results);
+  EXPECT_EQ(front, std::vector<size_t>({0, 1, 3}));
+
+  EXPECT_EQ(paddle::inference::PickBest(results, 0), 3);
+  EXPECT_EQ(paddle::inference::PickBest(results, 20), 1);
+  EXPECT_EQ(paddle::inference::PickBest(results, 5), 0);
+  // None meets the SLO, the lowest latency is the best.
+  EXPECT_EQ(paddle::inference::PickBest(results, 1), 0);
+  EXPECT_EQ(paddle::inference::PickBest({}, 1), -1);
+}
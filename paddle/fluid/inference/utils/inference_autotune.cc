@@ -0,0 +1,231 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/fluid/inference/utils/benchmark_runner.h"
+#include "paddle/fluid/inference/utils/config_tuner.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/string/split.h"
+
+DEFINE_string(model_dir, "", "The directory of the model.");
+DEFINE_string(prog_file, "", "The program of the combined model.");
+DEFINE_string(params_file, "", "The params of the combined model.");
+DEFINE_string(input_shapes, "",
+              "The shapes of the inputs of a sample, in the order of the "
+              "feed targets, whose first dims are multiplied by the batch "
+              "size, e.g. \"1,3,224,224;1,1\".");
+DEFINE_string(input_dtypes, "",
+              "The data types, float32 or int64, of the inputs, default "
+              "float32 for all the inputs, e.g. \"float32;int64\".");
+DEFINE_int32(seq_len, 0,
+             "If positive, a sample is a sequence of seq_len, whose first "
+             "dim should be seq_len.");
+DEFINE_string(batch_sizes, "1", "The batch sizes to try, e.g. \"1,4,16\".");
+DEFINE_string(cpu_math_threads, "1",
+              "The numbers of the threads of the CPU math library to try.");
+DEFINE_string(num_predictors, "1",
+              "The numbers of the predictors running concurrently in the "
+              "process to try.");
+DEFINE_string(mkldnn_op_sets, "",
+              "The MKLDNN op sets to try besides no MKLDNN, separated by "
+              "';', all for all the ops, e.g. \"all;conv2d,pool2d\".");
+DEFINE_bool(tune_ir_optim, false, "Also try without the IR optimization.");
+DEFINE_bool(tune_static_memory_plan, false,
+            "Also try the static memory plan.");
+DEFINE_int32(max_cores, 0,
+             "The most cpu_math_threads * num_predictors to try, default "
+             "the hardware threads.");
+DEFINE_double(latency_slo_ms, 0,
+              "The p99 latency the best configuration should be within, no "
+              "SLO if 0.");
+DEFINE_int32(warmup, 10, "The number of the runs to warm up each thread.");
+DEFINE_double(screen_sec, 2, "The duration of the runs of every candidate.");
+DEFINE_int32(finalists, 3,
+             "The number of the best candidates of the screening, which are "
+             "measured again for --duration_sec.");
+DEFINE_double(duration_sec, 10, "The duration of the runs of the finalists.");
+DEFINE_string(report_json, "",
+              "Write the results to the file as JSON lines, default print "
+              "them to the stdout.");
+
+namespace paddle {
+namespace inference {
+
+static std::vector<int> ParseInts(const std::string& str) {
+  std::vector<int> values;
+  for (auto& item : string::Split(str, ',')) {
+    values.push_back(std::stoi(item));
+  }
+  PADDLE_ENFORCE(!values.empty(), "The list %s should not be empty.", str);
+  return values;
+}
+
+static TuneSpace MakeSpace() {
+  TuneSpace space;
+  space.cpu_math_threads = ParseInts(FLAGS_cpu_math_threads);
+  space.num_predictors = ParseInts(FLAGS_num_predictors);
+  space.batch_sizes = ParseInts(FLAGS_batch_sizes);
+  if (!FLAGS_mkldnn_op_sets.empty()) {
+    for (auto& op_set : string::Split(FLAGS_mkldnn_op_sets, ';')) {
+      std::unordered_set<std::string> ops;
+      if (op_set != "all") {
+        for (auto& op : string::Split(op_set, ',')) ops.insert(op);
+      }
+      space.mkldnn_op_sets.push_back(ops);
+    }
+  }
+  if (FLAGS_tune_ir_optim) space.ir_optim.push_back(false);
+  if (FLAGS_tune_static_memory_plan) space.static_memory_plan.push_back(true);
+  space.max_cores = FLAGS_max_cores > 0
+                        ? FLAGS_max_cores
+                        : static_cast<int>(std::thread::hardware_concurrency());
+  return space;
+}
+
+// The inputs of a batch, whose first dims are the ones of a sample times
+// the batch size.
+static std::vector<PaddleTensor> MakeBatchInputs(int batch_size) {
+  std::string shapes;
+  for (auto& shape : string::Split(FLAGS_input_shapes, ';')) {
+    auto dims = string::Split(shape, ',');
+    PADDLE_ENFORCE(!dims.empty(), "The input shape should not be empty.");
+    dims[0] = std::to_string(std::stoi(dims[0]) * batch_size);
+    if (!shapes.empty()) shapes += ';';
+    for (size_t i = 0; i < dims.size(); ++i) {
+      shapes += (i > 0 ? "," : "") + dims[i];
+    }
+  }
+  return MakeFakeInputs(shapes, FLAGS_input_dtypes, batch_size,
+                        FLAGS_seq_len);
+}
+
+static bool Measure(const TuneCandidate& candidate,
+                    const std::vector<PaddleTensor>& inputs,
+                    double duration_sec, TuneResult* result) {
+  contrib::AnalysisConfig config;
+  if (!FLAGS_model_dir.empty()) {
+    config.SetModel(FLAGS_model_dir);
+  } else {
+    PADDLE_ENFORCE(!FLAGS_prog_file.empty() && !FLAGS_params_file.empty(),
+                   "Please set --model_dir, or --prog_file and --params_file.");
+    config.SetModel(FLAGS_prog_file, FLAGS_params_file);
+  }
+  candidate.Apply(&config);
+  result->candidate = candidate;
+  // A candidate the build does not support, e.g. MKLDNN, is skipped.
+  try {
+    auto predictor = CreatePaddlePredictor(config);
+    RunTimedPredictors(predictor.get(), inputs, candidate.batch_size,
+                       candidate.num_predictors, FLAGS_warmup, duration_sec,
+                       &result->benchmark);
+  } catch (const std::exception& e) {
+    LOG(WARNING) << "Skip " << candidate.SerializeToJson() << ": "
+                 << e.what();
+    return false;
+  }
+  LOG(INFO) << candidate.SerializeToJson() << ": "
+            << SamplesPerSec(*result) << " samples/s, p99 "
+            << P99Latency(*result) << " ms";
+  return true;
+}
+
+int RunAutotune() {
+  auto candidates = EnumerateCandidates(MakeSpace());
+  PADDLE_ENFORCE(!candidates.empty(), "There is no candidate to try.");
+  LOG(INFO) << "Screen " << candidates.size() << " candidates";
+  std::map<int, std::vector<PaddleTensor>> inputs;
+  for (int batch_size : ParseInts(FLAGS_batch_sizes)) {
+    inputs[batch_size] = MakeBatchInputs(batch_size);
+  }
+
+  std::vector<TuneResult> results;
+  for (auto& candidate : candidates) {
+    TuneResult result;
+    if (Measure(candidate, inputs[candidate.batch_size], FLAGS_screen_sec,
+                &result)) {
+      results.push_back(result);
+    }
+  }
+  PADDLE_ENFORCE(!results.empty(), "No candidate could run.");
+
+  // The short runs are noisy, so the best of them are measured again.
+  auto ranks = RankResults(results, FLAGS_latency_slo_ms);
+  std::vector<bool> final_result(results.size(), false);
+  for (size_t r = 0;
+       r < std::min<size_t>(std::max(FLAGS_finalists, 0), ranks.size());
+       ++r) {
+    auto& result = results[ranks[r]];
+    final_result[ranks[r]] = Measure(
+        result.candidate, inputs[result.candidate.batch_size],
+        FLAGS_duration_sec, &result);
+  }
+
+  auto front = ParetoFront(results);
+  std::vector<bool> on_front(results.size(), false);
+  for (size_t i : front) on_front[i] = true;
+  int best = PickBest(results, FLAGS_latency_slo_ms);
+
+  std::ofstream file;
+  if (!FLAGS_report_json.empty()) {
+    file.open(FLAGS_report_json, std::ios::app);
+    PADDLE_ENFORCE(file.is_open(), "Can not open %s to add the report",
+                   FLAGS_report_json);
+  }
+  std::ostream& out = FLAGS_report_json.empty() ? std::cout : file;
+  for (size_t i = 0; i < results.size(); ++i) {
+    out << "{\"candidate\": " << results[i].candidate.SerializeToJson()
+        << ", \"benchmark\": " << results[i].benchmark.SerializeToJson()
+        << ", \"pareto\": " << (on_front[i] ? "true" : "false")
+        << ", \"finalist\": " << (final_result[i] ? "true" : "false")
+        << ", \"best\": " << (static_cast<int>(i) == best ? "true" : "false")
+        << "}\n";
+  }
+  auto& best_result = results[best];
+  if (FLAGS_latency_slo_ms > 0 &&
+      P99Latency(best_result) > FLAGS_latency_slo_ms) {
+    LOG(WARNING) << "No candidate meets the p99 latency SLO of "
+                 << FLAGS_latency_slo_ms << " ms, the lowest is "
+                 << P99Latency(best_result) << " ms.";
+  }
+  std::cerr << "The best configuration, " << SamplesPerSec(best_result)
+            << " samples/s at the p99 latency " << P99Latency(best_result)
+            << " ms:\n"
+            << best_result.candidate.SerializeToCode();
+  return 0;
+}
+
+}  // namespace inference
+}  // namespace paddle
+
+// Searches the CPU configurations of a model for the most throughput within
+// a latency SLO. Every candidate is run for --screen_sec, the finalists for
+// --duration_sec, and the results are reported as JSON lines with the
+// Pareto front of the throughput and the p99 latency.
+// e.g. ./inference_autotune --model_dir=resnet50 --input_shapes=1,3,224,224 \
+//          --batch_sizes=1,4 --cpu_math_threads=1,2,4 --num_predictors=1,2,4 \
+//          --mkldnn_op_sets=all --latency_slo_ms=50
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  return paddle::inference::RunAutotune();
+}
@@ -0,0 +1,106 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <iostream>
+#include <string>
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/fluid/inference/utils/benchmark_runner.h"
+#include "paddle/fluid/platform/enforce.h"
+
+DEFINE_string(model_dir, "", "The directory of the model.");
+DEFINE_string(prog_file, "", "The program of the combined model.");
+DEFINE_string(params_file, "", "The params of the combined model.");
+DEFINE_string(name, "", "The name of the benchmark, default the model path.");
+DEFINE_string(input_shapes, "",
+              "The shapes of the inputs in the order of the feed targets, "
+              "e.g. \"1,3,224,224;1,1\".");
+DEFINE_string(input_dtypes, "",
+              "The data types, float32 or int64, of the inputs, default "
+              "float32 for all the inputs, e.g. \"float32;int64\".");
+DEFINE_int32(batch_size, 1, "The batch size of the inputs.");
+DEFINE_int32(seq_len, 0,
+             "If positive, the inputs are the batch_size sequences of "
+             "seq_len, whose first dim should be batch_size * seq_len.");
+DEFINE_int32(num_threads, 1, "The number of the threads running the model.");
+DEFINE_int32(warmup, 10, "The number of the runs to warm up each thread.");
+DEFINE_double(duration_sec, 10, "The duration of the timed runs.");
+DEFINE_bool(use_gpu, false, "Run the model on the GPU.");
+DEFINE_int32(gpu_id, 0, "The id of the GPU.");
+DEFINE_bool(ir_optim, true, "Enable the IR optimization passes.");
+DEFINE_bool(use_mkldnn, false, "Enable MKLDNN.");
+DEFINE_int32(cpu_math_threads, 1,
+             "The number of the threads of the CPU math library.");
+DEFINE_string(output_json, "",
+              "Append the result to the file as a JSON line, default print "
+              "it to the stdout.");
+
+namespace paddle {
+namespace inference {
+
+static void MakeConfig(contrib::AnalysisConfig* config) {
+  if (!FLAGS_model_dir.empty()) {
+    config->SetModel(FLAGS_model_dir);
+  } else {
+    PADDLE_ENFORCE(!FLAGS_prog_file.empty() && !FLAGS_params_file.empty(),
+                   "Please set --model_dir, or --prog_file and --params_file.");
+    config->SetModel(FLAGS_prog_file, FLAGS_params_file);
+  }
+  if (FLAGS_use_gpu) {
+    config->EnableUseGpu(100, FLAGS_gpu_id);
+  } else {
+    config->DisableGpu();
+    config->SetCpuMathLibraryNumThreads(FLAGS_cpu_math_threads);
+    if (FLAGS_use_mkldnn) config->EnableMKLDNN();
+  }
+  config->SwitchIrOptim(FLAGS_ir_optim);
+}
+
+int RunBenchmark() {
+  auto inputs = MakeFakeInputs(FLAGS_input_shapes, FLAGS_input_dtypes,
+                               FLAGS_batch_size, FLAGS_seq_len);
+  contrib::AnalysisConfig config;
+  MakeConfig(&config);
+  auto main_predictor = CreatePaddlePredictor(config);
+
+  Benchmark benchmark;
+  benchmark.SetName(FLAGS_name.empty()
+                        ? (FLAGS_model_dir.empty() ? FLAGS_prog_file
+                                                   : FLAGS_model_dir)
+                        : FLAGS_name);
+  if (FLAGS_use_gpu) benchmark.SetUseGpu();
+  RunTimedPredictors(main_predictor.get(), inputs, FLAGS_batch_size,
+                     FLAGS_num_threads, FLAGS_warmup, FLAGS_duration_sec,
+                     &benchmark);
+  if (FLAGS_output_json.empty()) {
+    std::cout << benchmark.SerializeToJson() << std::endl;
+  } else {
+    benchmark.PersistToJsonFile(FLAGS_output_json);
+  }
+  return 0;
+}
+
+}  // namespace inference
+}  // namespace paddle
+
+// Benchmark the latency and the throughput of a model with the fake inputs.
+// To use this tool, run command: ./inference_benchmark [options...]
+// e.g. ./inference_benchmark --model_dir=resnet50 \
+//          --input_shapes=1,3,224,224 --num_threads=4 --duration_sec=30
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  return paddle::inference::RunBenchmark();
+}
@@ -27,7 +27,12 @@ bool Allocator::IsAllocThreadSafe() const { return false; }
 
 AllocationPtr Allocator::Allocate(size_t size, Allocator::Attr attr) {
   auto ptr = AllocateImpl(size, attr);
-  ptr->set_allocator(this);
+  // Some allocators, e.g., ZeroSizeAllocator, return the allocation of their
+  // underlying allocator directly. It must be freed by the allocator that
+  // creates it.
+  if (ptr->allocator() == nullptr) {
+    ptr->set_allocator(this);
+  }
   return AllocationPtr(ptr);
 }
 
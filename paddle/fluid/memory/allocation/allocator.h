@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #pragma once
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include "paddle/fluid/platform/place.h"
@@ -76,6 +78,12 @@ class Allocation {
 
   void set_allocator(Allocator* allocator) { allocator_ = allocator; }
 
+  // The version is increased whenever the memory may be written through a
+  // Tensor, so the copies derived from it can tell whether they are stale.
+  uint64_t version() const { return version_.load(std::memory_order_relaxed); }
+
+  void IncreaseVersion() { version_.fetch_add(1, std::memory_order_relaxed); }
+
   virtual ~Allocation();
 
  private:
@@ -83,6 +91,7 @@ class Allocation {
   void* ptr_;
   size_t size_;
   platform::Place place_;
+  std::atomic<uint64_t> version_{0};
 };
 
 using AllocationPtr = std::unique_ptr<Allocation, AllocationDeleter>;
@@ -14,12 +14,17 @@
 
 #include "paddle/fluid/memory/allocation/allocator.h"
 #include <gflags/gflags.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <map>
+#include <mutex>  // NOLINT
 #include <string>
 #include <unordered_map>
 #include <vector>
 #include "paddle/fluid/memory/allocation/aligned_allocator.h"
 #include "paddle/fluid/memory/allocation/allocator_facade.h"
+#include "paddle/fluid/memory/allocation/allocator_stats.h"
 #include "paddle/fluid/memory/allocation/allocator_strategy.h"
 #include "paddle/fluid/memory/allocation/auto_increment_allocator.h"
 #include "paddle/fluid/memory/allocation/best_fit_allocator.h"
@@ -28,12 +33,14 @@
 #include "paddle/fluid/memory/allocation/legacy_allocator.h"
 #include "paddle/fluid/memory/allocation/locked_allocator.h"
 #include "paddle/fluid/memory/allocation/retry_allocator.h"
+#include "paddle/fluid/memory/allocation/thread_cached_allocator.h"
 #include "paddle/fluid/memory/allocation/zero_size_allocator.h"
 #include "paddle/fluid/platform/cpu_info.h"
 #include "paddle/fluid/platform/place.h"
 #ifdef PADDLE_WITH_CUDA
 #include "paddle/fluid/memory/allocation/cuda_allocator.h"
 #include "paddle/fluid/memory/allocation/pinned_allocator.h"
+#include "paddle/fluid/memory/allocation/stream_safe_cuda_allocator.h"
 #include "paddle/fluid/platform/cuda_device_guard.h"
 #include "paddle/fluid/platform/gpu_info.h"
 #endif
@@ -43,6 +50,22 @@ DEFINE_int64(
     "The retry time (milliseconds) when allocator fails "
     "to allocate memory. No retry if this value is not greater than 0");
 
+DEFINE_bool(use_stream_safe_cuda_allocator, false,
+            "Whether to free the GPU memory in the order of the stream it is "
+            "allocated on, so that the garbage collectors and the temporary "
+            "allocators do not need to wait for the stream. It only works "
+            "when FLAGS_allocator_strategy is not legacy. It is off by "
+            "default, because only the stream an allocation is allocated on "
+            "is waited for, so the uses on other streams, e.g., the NCCL and "
+            "the copy streams, must be ordered before the free by the user.");
+
+DEFINE_bool(enable_allocator_stats, false,
+            "Whether to count the current and peak bytes and the sizes of "
+            "the allocations of each place, which can be got by "
+            "AllocatorFacade::GetStats. It is off by default, because the "
+            "counting wraps every allocation in one more heap object and "
+            "updates counters shared by all the threads.");
+
 namespace paddle {
 namespace memory {
 namespace allocation {
@@ -102,6 +125,7 @@ class ChunkedAllocator : public Allocator {
 
   ~ChunkedAllocator() override {
     // Specify destruct order.
+    arenas_.clear();
     default_allocator_.reset();
     chunks_.clear();
     raw_allocator_.reset();
@@ -110,8 +134,13 @@ class ChunkedAllocator : public Allocator {
   std::shared_ptr<Allocator> CreateAllocatorWithChunk() {
     chunks_.emplace_back(raw_allocator_->Allocate(max_chunk_size_));
     auto* allocation = chunks_.back().get();
-    std::unique_ptr<Allocator> allocator(new LockedAllocator(
-        std::unique_ptr<Allocator>(new BestFitAllocator(allocation))));
+    auto* locked_allocator = new LockedAllocator(
+        std::unique_ptr<Allocator>(new BestFitAllocator(allocation)));
+    {
+      std::lock_guard<std::mutex> guard(arenas_mtx_);
+      arenas_.emplace_back(locked_allocator);
+    }
+    std::unique_ptr<Allocator> allocator(locked_allocator);
 
     if (retry_time_ > 0) {
       auto* retry_allocator =
@@ -124,6 +153,21 @@ class ChunkedAllocator : public Allocator {
 
   bool IsAllocThreadSafe() const override { return true; }
 
+  // Fill the pool fields of stats with the free chunks of all the chunks.
+  void GetFreeChunkStats(AllocatorStats* stats) {
+    std::lock_guard<std::mutex> guard(arenas_mtx_);
+    for (auto* arena : arenas_) {
+      arena->RunWithLock([stats](Allocator* allocator) {
+        auto* best_fit_allocator = static_cast<BestFitAllocator*>(allocator);
+        stats->free_bytes += best_fit_allocator->FreeSize();
+        stats->num_free_chunks += best_fit_allocator->NumFreeChunks();
+        stats->largest_free_chunk =
+            std::max(stats->largest_free_chunk,
+                     best_fit_allocator->LargestFreeChunkSize());
+      });
+    }
+  }
+
  protected:
   Allocation* AllocateImpl(size_t size, Allocator::Attr attr) override {
     return default_allocator_->Allocate(size, attr).release();
@@ -133,10 +177,28 @@ class ChunkedAllocator : public Allocator {
   size_t max_chunk_size_;
   int64_t retry_time_;
   std::vector<AllocationPtr> chunks_;
+  // The LockedAllocators of the BestFitAllocators on chunks_, which are
+  // owned by default_allocator_.
+  std::mutex arenas_mtx_;
+  std::vector<LockedAllocator*> arenas_;
   std::shared_ptr<Allocator> raw_allocator_;
   std::shared_ptr<Allocator> default_allocator_;
 };
 
+class CPUChunkedAllocator : public ChunkedAllocator {
+ public:
+  CPUChunkedAllocator()
+      : ChunkedAllocator(std::unique_ptr<Allocator>(new CPUAllocator()),
+                         platform::CpuMaxChunkSize(), GetCapacity(), -1) {}
+
+ private:
+  static size_t GetCapacity() {
+    size_t total = platform::CpuTotalPhysicalMemory();
+    size_t max_chunk_size = platform::CpuMaxChunkSize();
+    return max_chunk_size == 0 ? 0 : total / max_chunk_size;
+  }
+};
+
 #ifdef PADDLE_WITH_CUDA
 
 class CUDAChunkedAllocator : public ChunkedAllocator {
@@ -164,6 +226,35 @@ class CUDAChunkedAllocator : public ChunkedAllocator {
   static int64_t GetRetryTime() { return FLAGS_gpu_allocator_retry_time; }
 };
 
+// Create the CUDAChunkedAllocator of a GPU at the first allocation on it,
+// because getting the memory size of a GPU creates a CUDA context on it,
+// which a process using few of the visible GPUs should not pay for.
+class LazyCUDAChunkedAllocator : public Allocator {
+ public:
+  explicit LazyCUDAChunkedAllocator(int dev_id) : dev_id_(dev_id) {}
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  void GetFreeChunkStats(AllocatorStats* stats) {
+    if (created_.load()) allocator_->GetFreeChunkStats(stats);
+  }
+
+ protected:
+  Allocation* AllocateImpl(size_t size, Allocator::Attr attr) override {
+    std::call_once(once_, [this] {
+      allocator_.reset(new CUDAChunkedAllocator(dev_id_));
+      created_.store(true);
+    });
+    return allocator_->Allocate(size, attr).release();
+  }
+
+ private:
+  int dev_id_;
+  std::once_flag once_;
+  std::atomic<bool> created_{false};
+  std::unique_ptr<CUDAChunkedAllocator> allocator_;
+};
+
 class CUDAPinnedChunkedAllocator : public ChunkedAllocator {
  public:
   CUDAPinnedChunkedAllocator()
@@ -183,7 +274,11 @@ class CUDAPinnedChunkedAllocator : public ChunkedAllocator {
 
 class AllocatorFacadePrivate {
  public:
+  using FreeChunkStatsGetter = std::function<void(AllocatorStats*)>;
+
   std::map<platform::Place, std::shared_ptr<Allocator>> allocators_;
+  std::map<platform::Place, std::shared_ptr<StatAllocator>> stat_allocators_;
+  std::map<platform::Place, FreeChunkStatsGetter> free_chunk_stats_getters_;
 
   ~AllocatorFacadePrivate() = default;
 
@@ -194,8 +289,17 @@ class AllocatorFacadePrivate {
       InitCPUAllocator();
       InitCUDAAllocator();
       InitCUDAPinnedAllocator();
+      if (GetAllocatorStrategy() == AllocatorStrategy::kThreadCachedBestFit) {
+        WrapThreadCachedAllocator();
+      }
+      if (AllocatorFacade::IsGPUFreeStreamOrdered()) {
+        WrapStreamSafeCUDAAllocator();
+      }
       WrapZeroSizeAllocator();
     }
+    if (FLAGS_enable_allocator_stats) {
+      WrapStatAllocator();
+    }
   }
 
  private:
@@ -208,28 +312,71 @@ class AllocatorFacadePrivate {
     places.emplace_back(platform::CUDAPinnedPlace());
 #endif
     for (auto& p : places) {
-      allocators_[p] = std::make_shared<LegacyAllocator>(p);
+      auto allocator = std::make_shared<LegacyAllocator>(p);
+      free_chunk_stats_getters_[p] = [allocator](AllocatorStats* stats) {
+        allocator->GetFreeChunkStats(stats);
+      };
+      allocators_[p] = allocator;
     }
   }
 
   void InitCPUAllocator() {
-    allocators_[platform::CPUPlace()] = std::make_shared<CPUManagedAllocator>();
+    if (GetAllocatorStrategy() == AllocatorStrategy::kThreadCachedBestFit) {
+      // The thread caches are in front of a shared best-fit arena.
+      auto allocator = std::make_shared<CPUChunkedAllocator>();
+      AddFreeChunkStatsGetter(platform::CPUPlace(), allocator);
+      allocators_[platform::CPUPlace()] = allocator;
+    } else {
+      allocators_[platform::CPUPlace()] =
+          std::make_shared<CPUManagedAllocator>();
+    }
   }
 
   void InitCUDAAllocator() {
 #ifdef PADDLE_WITH_CUDA
     int device_count = platform::GetCUDADeviceCount();
     for (int dev_id = 0; dev_id < device_count; ++dev_id) {
-      allocators_[platform::CUDAPlace(dev_id)] =
-          std::make_shared<CUDAChunkedAllocator>(dev_id);
+      auto allocator = std::make_shared<LazyCUDAChunkedAllocator>(dev_id);
+      free_chunk_stats_getters_[platform::CUDAPlace(dev_id)] =
+          [allocator](AllocatorStats* stats) {
+            allocator->GetFreeChunkStats(stats);
+          };
+      allocators_[platform::CUDAPlace(dev_id)] = allocator;
     }
 #endif
   }
 
   void InitCUDAPinnedAllocator() {
 #ifdef PADDLE_WITH_CUDA
-    allocators_[platform::CUDAPinnedPlace()] =
-        std::make_shared<CUDAPinnedChunkedAllocator>();
+    auto allocator = std::make_shared<CUDAPinnedChunkedAllocator>();
+    AddFreeChunkStatsGetter(platform::CUDAPinnedPlace(), allocator);
+    allocators_[platform::CUDAPinnedPlace()] = allocator;
+#endif
+  }
+
+  void AddFreeChunkStatsGetter(const platform::Place& place,
+                               std::shared_ptr<ChunkedAllocator> allocator) {
+    free_chunk_stats_getters_[place] = [allocator](AllocatorStats* stats) {
+      allocator->GetFreeChunkStats(stats);
+    };
+  }
+
+  // Cache the small blocks of CPU and GPU memory per thread. The pinned memory
+  // is mostly allocated and freed by different threads, so it is not cached.
+  void WrapThreadCachedAllocator() {
+    for (auto& pair : allocators_) {
+      if (platform::is_cuda_pinned_place(pair.first)) continue;
+      pair.second = std::make_shared<ThreadCachedAllocator>(pair.second);
+    }
+  }
+
+  void WrapStreamSafeCUDAAllocator() {
+#ifdef PADDLE_WITH_CUDA
+    for (auto& pair : allocators_) {
+      if (!platform::is_gpu_place(pair.first)) continue;
+      pair.second = std::make_shared<StreamSafeCUDAAllocator>(
+          pair.second, boost::get<platform::CUDAPlace>(pair.first));
+    }
 #endif
   }
 
@@ -239,6 +386,16 @@ class AllocatorFacadePrivate {
           std::make_shared<ZeroSizeAllocator>(pair.second, pair.first);
     }
   }
+
+  // Count the allocations requested from the facade, so the blocks cached by
+  // the thread caches or the stream-safe allocators are not counted as used.
+  void WrapStatAllocator() {
+    for (auto& pair : allocators_) {
+      auto allocator = std::make_shared<StatAllocator>(pair.second);
+      stat_allocators_[pair.first] = allocator;
+      pair.second = allocator;
+    }
+  }
 };
 
 // Pimpl. Make interface clean.
@@ -250,6 +407,15 @@ AllocatorFacade& AllocatorFacade::Instance() {
   return instance;
 }
 
+bool AllocatorFacade::IsGPUFreeStreamOrdered() {
+#ifdef PADDLE_WITH_CUDA
+  return GetAllocatorStrategy() != AllocatorStrategy::kLegacy &&
+         FLAGS_use_stream_safe_cuda_allocator;
+#else
+  return false;
+#endif
+}
+
 std::shared_ptr<Allocation> AllocatorFacade::AllocShared(
     const platform::Place& place, size_t size, Allocator::Attr attr) {
   return std::shared_ptr<Allocation>(Alloc(place, size, attr).release(),
@@ -263,7 +429,39 @@ AllocationPtr AllocatorFacade::Alloc(const platform::Place& place, size_t size,
     throw BadAlloc(
         string::Sprintf("No such allocator for the place, %s", place));
   }
-  return m_->allocators_.at(place)->Allocate(size, attr);
+  try {
+    return it->second->Allocate(size, attr);
+  } catch (BadAlloc& e) {
+    // Most out of memory errors with enough free memory in total are caused
+    // by fragmentation, so report the stats of the place.
+    throw BadAlloc(string::Sprintf("%s\nThe allocator stats of %s: %s",
+                                   e.what(), place,
+                                   GetStats(place).DebugString()));
+  }
+}
+
+AllocatorStats AllocatorFacade::GetStats(const platform::Place& place) const {
+  PADDLE_ENFORCE(m_->allocators_.count(place) > 0,
+                 "No such allocator for the place, %s", place);
+  AllocatorStats stats;
+  auto stat_it = m_->stat_allocators_.find(place);
+  if (stat_it != m_->stat_allocators_.end()) {
+    stat_it->second->GetStats(&stats);
+  }
+  auto getter_it = m_->free_chunk_stats_getters_.find(place);
+  if (getter_it != m_->free_chunk_stats_getters_.end()) {
+    getter_it->second(&stats);
+  }
+  return stats;
+}
+
+std::map<platform::Place, AllocatorStats> AllocatorFacade::GetAllStats()
+    const {
+  std::map<platform::Place, AllocatorStats> all_stats;
+  for (auto& pair : m_->allocators_) {
+    all_stats.emplace(pair.first, GetStats(pair.first));
+  }
+  return all_stats;
 }
 
 }  // namespace allocation
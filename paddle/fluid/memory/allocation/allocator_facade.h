@@ -13,8 +13,10 @@
 // limitations under the License.
 
 #pragma once
+#include <map>
 #include <memory>
 #include "paddle/fluid/memory/allocation/allocator.h"
+#include "paddle/fluid/memory/allocation/allocator_stats.h"
 #include "paddle/fluid/platform/place.h"
 
 namespace paddle {
@@ -46,6 +48,17 @@ class AllocatorFacade {
   AllocationPtr Alloc(const platform::Place& place, size_t size,
                       Allocator::Attr attr = Allocator::kDefault);
 
+  // Whether the GPU memory is freed in the order of the stream it is
+  // allocated on. If so, an allocation can be freed right after the kernels
+  // using it are launched, without waiting for the stream.
+  static bool IsGPUFreeStreamOrdered();
+
+  // Get the statistics of the allocations and the memory pool of the place.
+  // The usage fields are zero if FLAGS_enable_allocator_stats is false.
+  AllocatorStats GetStats(const platform::Place& place) const;
+
+  std::map<platform::Place, AllocatorStats> GetAllStats() const;
+
   // TODO(yy): Allocate a Copy-On-Write allocation?
  private:
   AllocatorFacade();
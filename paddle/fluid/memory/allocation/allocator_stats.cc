@@ -0,0 +1,95 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/allocator_stats.h"
+#include <sstream>
+#include <utility>
+#include "paddle/fluid/memory/allocation/allocation_with_underlying.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+constexpr size_t AllocatorStats::kNumSizeBins;
+
+std::string AllocatorStats::DebugString() const {
+  std::ostringstream sout;
+  sout << "current_bytes: " << current_bytes << ", peak_bytes: " << peak_bytes
+       << ", num_allocs: " << num_allocs << ", num_frees: " << num_frees
+       << ", free_bytes: " << free_bytes
+       << ", num_free_chunks: " << num_free_chunks
+       << ", largest_free_chunk: " << largest_free_chunk
+       << ", fragmentation_ratio: " << FragmentationRatio();
+  sout << ", size_histogram: {";
+  bool first = true;
+  for (size_t i = 0; i < kNumSizeBins; ++i) {
+    if (size_histogram[i] == 0) continue;
+    if (!first) sout << ", ";
+    sout << (1UL << i) << ": " << size_histogram[i];
+    first = false;
+  }
+  sout << "}";
+  return sout.str();
+}
+
+StatAllocator::StatAllocator(std::shared_ptr<Allocator> underlying_allocator)
+    : underlying_allocator_(std::move(underlying_allocator)) {
+  PADDLE_ENFORCE_NOT_NULL(underlying_allocator_);
+  for (auto& count : size_histogram_) {
+    count.store(0);
+  }
+}
+
+size_t StatAllocator::SizeBin(size_t size) {
+  size_t bin = 0;
+  for (; size > 1; size >>= 1) ++bin;
+  return bin;
+}
+
+Allocation* StatAllocator::AllocateImpl(size_t size, Allocator::Attr attr) {
+  auto allocation = underlying_allocator_->Allocate(size, attr);
+  size_t bytes = allocation->size();
+  size_t current =
+      current_bytes_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  size_t peak = peak_bytes_.load(std::memory_order_relaxed);
+  while (current > peak &&
+         !peak_bytes_.compare_exchange_weak(peak, current,
+                                            std::memory_order_relaxed)) {
+  }
+  num_allocs_.fetch_add(1, std::memory_order_relaxed);
+  size_histogram_[SizeBin(size)].fetch_add(1, std::memory_order_relaxed);
+  return new AllocationWithUnderlying(std::move(allocation));
+}
+
+void StatAllocator::Free(Allocation* allocation) {
+  current_bytes_.fetch_sub(allocation->size(), std::memory_order_relaxed);
+  num_frees_.fetch_add(1, std::memory_order_relaxed);
+  delete allocation;
+}
+
+void StatAllocator::GetStats(AllocatorStats* stats) const {
+  stats->current_bytes = current_bytes_.load(std::memory_order_relaxed);
+  stats->peak_bytes = peak_bytes_.load(std::memory_order_relaxed);
+  stats->num_allocs = num_allocs_.load(std::memory_order_relaxed);
+  stats->num_frees = num_frees_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < AllocatorStats::kNumSizeBins; ++i) {
+    stats->size_histogram[i] =
+        size_histogram_[i].load(std::memory_order_relaxed);
+  }
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,89 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+#include "paddle/fluid/memory/allocation/allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// The statistics of the allocations of a place.
+struct AllocatorStats {
+  // The number of bins of size_histogram. The bin i counts the allocations
+  // whose size is in [2^i, 2^(i+1)), and bin 0 also counts the empty ones.
+  static constexpr size_t kNumSizeBins = sizeof(size_t) * 8;
+
+  // The bytes of the allocations in use, and the highest value of it.
+  size_t current_bytes{0};
+  size_t peak_bytes{0};
+  size_t num_allocs{0};
+  size_t num_frees{0};
+  std::array<size_t, kNumSizeBins> size_histogram{};
+
+  // The free memory kept by the memory pool of the place, e.g., the buddy
+  // allocator of the legacy strategy, or the best-fit chunks. They are all
+  // zero if the pool is not known.
+  size_t free_bytes{0};
+  size_t num_free_chunks{0};
+  size_t largest_free_chunk{0};
+
+  // 1 - largest_free_chunk / free_bytes. A ratio close to 1 means that a
+  // large allocation may fail even if there is enough free memory in total.
+  double FragmentationRatio() const {
+    if (free_bytes == 0) return 0;
+    return 1.0 - static_cast<double>(largest_free_chunk) / free_bytes;
+  }
+
+  std::string DebugString() const;
+};
+
+// StatAllocator counts the allocations of the underlying allocator. It is
+// thread safe if the underlying allocator is.
+class StatAllocator : public Allocator {
+ public:
+  explicit StatAllocator(std::shared_ptr<Allocator> underlying_allocator);
+
+  bool IsAllocThreadSafe() const override {
+    return underlying_allocator_->IsAllocThreadSafe();
+  }
+
+  // Fill the usage fields of stats. The pool fields are left unchanged.
+  void GetStats(AllocatorStats* stats) const;
+
+  static size_t SizeBin(size_t size);
+
+ protected:
+  void Free(Allocation* allocation) override;
+  Allocation* AllocateImpl(size_t size, Allocator::Attr attr) override;
+
+ private:
+  std::shared_ptr<Allocator> underlying_allocator_;
+
+  std::atomic<size_t> current_bytes_{0};
+  std::atomic<size_t> peak_bytes_{0};
+  std::atomic<size_t> num_allocs_{0};
+  std::atomic<size_t> num_frees_{0};
+  std::array<std::atomic<size_t>, AllocatorStats::kNumSizeBins>
+      size_histogram_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,128 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/allocator_stats.h"
+#include <gtest/gtest.h>
+#include <thread>  // NOLINT
+#include <vector>
+#include "paddle/fluid/memory/allocation/best_fit_allocator.h"
+#include "paddle/fluid/memory/allocation/cpu_allocator.h"
+#include "paddle/fluid/memory/allocation/locked_allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+TEST(allocator_stats, size_bin) {
+  EXPECT_EQ(StatAllocator::SizeBin(0), 0UL);
+  EXPECT_EQ(StatAllocator::SizeBin(1), 0UL);
+  EXPECT_EQ(StatAllocator::SizeBin(2), 1UL);
+  EXPECT_EQ(StatAllocator::SizeBin(3), 1UL);
+  EXPECT_EQ(StatAllocator::SizeBin(1024), 10UL);
+  EXPECT_EQ(StatAllocator::SizeBin(1025), 10UL);
+  EXPECT_EQ(StatAllocator::SizeBin(static_cast<size_t>(-1)),
+            AllocatorStats::kNumSizeBins - 1);
+}
+
+TEST(allocator_stats, fragmentation_ratio) {
+  AllocatorStats stats;
+  EXPECT_EQ(stats.FragmentationRatio(), 0);
+  stats.free_bytes = 1000;
+  stats.largest_free_chunk = 1000;
+  EXPECT_EQ(stats.FragmentationRatio(), 0);
+  stats.largest_free_chunk = 250;
+  EXPECT_DOUBLE_EQ(stats.FragmentationRatio(), 0.75);
+}
+
+TEST(allocator_stats, usage) {
+  CPUAllocator cpu_allocator;
+  auto chunk = cpu_allocator.Allocate(1 << 20);
+  auto* best_fit_allocator = new BestFitAllocator(chunk.get());
+  auto locked_allocator = std::make_shared<LockedAllocator>(
+      std::unique_ptr<Allocator>(best_fit_allocator));
+  StatAllocator allocator(locked_allocator);
+  ASSERT_TRUE(allocator.IsAllocThreadSafe());
+
+  AllocatorStats stats;
+  {
+    auto a = allocator.Allocate(100);
+    auto b = allocator.Allocate(4096);
+    allocator.GetStats(&stats);
+    EXPECT_EQ(stats.current_bytes, 4196UL);
+    EXPECT_EQ(stats.peak_bytes, 4196UL);
+    EXPECT_EQ(stats.num_allocs, 2UL);
+    EXPECT_EQ(stats.num_frees, 0UL);
+    EXPECT_EQ(stats.size_histogram[6], 1UL);
+    EXPECT_EQ(stats.size_histogram[12], 1UL);
+    a.reset();
+    allocator.GetStats(&stats);
+    EXPECT_EQ(stats.current_bytes, 4096UL);
+    EXPECT_EQ(stats.peak_bytes, 4196UL);
+    EXPECT_EQ(stats.num_frees, 1UL);
+  }
+  allocator.GetStats(&stats);
+  EXPECT_EQ(stats.current_bytes, 0UL);
+  EXPECT_EQ(stats.num_frees, 2UL);
+
+  // Hold every other block, so the free memory is split into small chunks.
+  std::vector<AllocationPtr> allocations;
+  for (int i = 0; i < 16; ++i) {
+    allocations.emplace_back(allocator.Allocate(1024));
+  }
+  for (size_t i = 0; i < allocations.size(); i += 2) {
+    allocations[i].reset();
+  }
+  locked_allocator->RunWithLock([&](Allocator* underlying) {
+    ASSERT_EQ(underlying, best_fit_allocator);
+    EXPECT_EQ(best_fit_allocator->NumFreeChunks(), 9UL);
+    EXPECT_EQ(best_fit_allocator->FreeSize(), (1UL << 20) - 8 * 1024);
+    EXPECT_EQ(best_fit_allocator->LargestFreeChunkSize(),
+              (1UL << 20) - 16 * 1024);
+  });
+  allocations.clear();
+}
+
+TEST(allocator_stats, multi_thread) {
+  CPUAllocator cpu_allocator;
+  auto chunk = cpu_allocator.Allocate(16 << 20);
+  auto locked_allocator = std::make_shared<LockedAllocator>(
+      std::unique_ptr<Allocator>(new BestFitAllocator(chunk.get())));
+  StatAllocator allocator(locked_allocator);
+
+  constexpr int kThreadNum = 4;
+  constexpr int kLoop = 1000;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadNum; ++i) {
+    threads.emplace_back([&allocator, i] {
+      for (int j = 0; j < kLoop; ++j) {
+        auto allocation = allocator.Allocate(64 * (i + 1));
+      }
+    });
+  }
+  for (auto& th : threads) {
+    th.join();
+  }
+
+  AllocatorStats stats;
+  allocator.GetStats(&stats);
+  EXPECT_EQ(stats.current_bytes, 0UL);
+  EXPECT_EQ(stats.num_allocs, static_cast<size_t>(kThreadNum * kLoop));
+  EXPECT_EQ(stats.num_frees, static_cast<size_t>(kThreadNum * kLoop));
+  EXPECT_GE(stats.peak_bytes, 256UL);
+  EXPECT_LE(stats.peak_bytes, 640UL);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -18,16 +18,22 @@
 DEFINE_string(
     allocator_strategy, "legacy",
     "The allocation strategy. Legacy means the original allocator of Fluid."
-    "New means the experimental allocators of Fluid. in [legacy, new]");
+    "New means the experimental allocators of Fluid. thread_cached means "
+    "the experimental allocators with per-thread caches of small blocks. "
+    "in [legacy, new, thread_cached]");
 
 namespace paddle {
 namespace memory {
 namespace allocation {
 
 static AllocatorStrategy GetStrategyFromFlag() {
-  return FLAGS_allocator_strategy == "legacy"
-             ? AllocatorStrategy::kLegacy
-             : AllocatorStrategy::kNaiveBestFit;
+  if (FLAGS_allocator_strategy == "legacy") {
+    return AllocatorStrategy::kLegacy;
+  } else if (FLAGS_allocator_strategy == "thread_cached") {
+    return AllocatorStrategy::kThreadCachedBestFit;
+  } else {
+    return AllocatorStrategy::kNaiveBestFit;
+  }
 }
 
 AllocatorStrategy GetAllocatorStrategy() {
@@ -109,6 +109,14 @@ size_t BestFitAllocator::NumFreeChunks() const {
   }
   return num;
 }
+
+size_t BestFitAllocator::LargestFreeChunkSize() const {
+  for (auto it = free_chunks_.rbegin(); it != free_chunks_.rend(); ++it) {
+    if (!it->empty()) return it->rbegin()->first;
+  }
+  return 0;
+}
+
 void BestFitAllocator::Free(Allocation* allocation) {
   auto* bf_allocation = dynamic_cast<BestFitAllocation*>(allocation);
   auto chunk_it = bf_allocation->ChunkIterator();
@@ -108,8 +108,11 @@ class BestFitAllocator : public Allocator {
 
   size_t NumFreeChunks() const;
 
- private:
   size_t FreeSize() const;
+
+  size_t LargestFreeChunkSize() const;
+
+ private:
   using MapIt = typename details::FreeChunkBin::value_type::iterator;
   using ListIt = typename details::ChunkList::iterator;
 
@@ -275,6 +275,29 @@ struct FreeVisitor : public boost::static_visitor<void> {
   void *ptr_;
 };
 
+struct BuddyAllocatorVisitor : public boost::static_visitor<BuddyAllocator *> {
+  BuddyAllocator *operator()(const platform::CPUPlace &cpu) const {
+    return GetCPUBuddyAllocator();
+  }
+
+  BuddyAllocator *operator()(const platform::CUDAPlace &gpu) const {
+#ifdef PADDLE_WITH_CUDA
+    return GetGPUBuddyAllocator(gpu.device);
+#else
+    PADDLE_THROW("'CUDAPlace' is not supported in CPU only device.");
+#endif
+  }
+
+  BuddyAllocator *operator()(
+      const platform::CUDAPinnedPlace &cuda_pinned) const {
+#ifdef PADDLE_WITH_CUDA
+    return GetCUDAPinnedBuddyAllocator();
+#else
+    PADDLE_THROW("'CUDAPinnedPlace' is not supported in CPU only device.");
+#endif
+  }
+};
+
 size_t Usage::operator()(const platform::CPUPlace &cpu) const {
   return Used(cpu);
 }
@@ -308,6 +331,14 @@ void LegacyAllocator::Free(Allocation *allocation) {
                        allocation->place());
   delete allocation;
 }
+
+void LegacyAllocator::GetFreeChunkStats(AllocatorStats *stats) const {
+  auto *buddy_allocator =
+      boost::apply_visitor(legacy::BuddyAllocatorVisitor(), place_);
+  buddy_allocator->GetFreeChunkStats(&stats->free_bytes,
+                                     &stats->num_free_chunks,
+                                     &stats->largest_free_chunk);
+}
 }  // namespace allocation
 }  // namespace memory
 }  // namespace paddle
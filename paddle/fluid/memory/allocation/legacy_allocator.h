@@ -14,6 +14,7 @@
 
 #pragma once
 #include "paddle/fluid/memory/allocation/allocator.h"
+#include "paddle/fluid/memory/allocation/allocator_stats.h"
 #include "paddle/fluid/platform/place.h"
 namespace paddle {
 namespace memory {
@@ -24,6 +25,10 @@ class LegacyAllocator : public Allocator {
  public:
   explicit LegacyAllocator(const platform::Place &p) : place_(p) {}
 
+  // Fill the pool fields of stats with the free chunks of the buddy
+  // allocator of the place.
+  void GetFreeChunkStats(AllocatorStats *stats) const;
+
  protected:
   Allocation *AllocateImpl(size_t size, Allocator::Attr attr) override;
   void Free(Allocation *allocation) override;
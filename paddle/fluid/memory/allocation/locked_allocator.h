@@ -16,6 +16,7 @@
 #include <mutex>   // NOLINT
 #include <thread>  // NOLINT
 #include "paddle/fluid/memory/allocation/allocator.h"
+#include "paddle/fluid/platform/lock_guard_ptr.h"
 
 namespace paddle {
 namespace memory {
@@ -27,6 +28,14 @@ class LockedAllocator : public Allocator {
   explicit LockedAllocator(std::unique_ptr<Allocator> &&underlying_allocator);
   bool IsAllocThreadSafe() const override;
 
+  // Run func with the underlying allocator, while no allocation or free can
+  // happen on it, e.g., to read the free chunks of a BestFitAllocator.
+  template <typename Func>
+  void RunWithLock(Func func) {
+    platform::LockGuardPtr<std::mutex> guard(mtx_);
+    func(underlying_allocator_.get());
+  }
+
  protected:
   void Free(Allocation *allocation) override;
   Allocation *AllocateImpl(size_t size, Allocator::Attr attr) override;
@@ -0,0 +1,79 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/mmap_allocation.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <cerrno>
+#include <cstring>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+MmapAllocation::MmapAllocation(void* ptr, size_t size)
+    : Allocation(ptr, size, platform::CPUPlace()) {}
+
+std::shared_ptr<MmapAllocation> MmapAllocation::MapFile(
+    const std::string& path) {
+#ifdef _WIN32
+  PADDLE_THROW("Mapping file %s is not supported on Windows", path);
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  PADDLE_ENFORCE_GE(fd, 0, "Cannot open file %s: %s", path, strerror(errno));
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    int err = errno;
+    close(fd);
+    PADDLE_THROW("Cannot stat file %s: %s", path, strerror(err));
+  }
+  size_t size = static_cast<size_t>(st.st_size);
+  void* ptr = nullptr;
+  if (size > 0) {
+    ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  }
+  int err = errno;
+  // The mapping stays valid after the file descriptor is closed.
+  close(fd);
+  PADDLE_ENFORCE(ptr != MAP_FAILED, "Cannot map file %s: %s", path,
+                 strerror(err));
+  return std::shared_ptr<MmapAllocation>(new MmapAllocation(ptr, size));
+#endif
+}
+
+MmapAllocation::~MmapAllocation() {
+#ifndef _WIN32
+  if (ptr() != nullptr) {
+    munmap(ptr(), size());
+  }
+#endif
+}
+
+MmapSubAllocation::MmapSubAllocation(std::shared_ptr<MmapAllocation> file,
+                                     size_t offset, size_t size)
+    : Allocation(static_cast<char*>(file->ptr()) + offset, size,
+                 file->place()),
+      file_(std::move(file)) {
+  PADDLE_ENFORCE_LE(offset + size, file_->size(),
+                    "The sub allocation exceeds the mapped file");
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,56 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <memory>
+#include <string>
+#include "paddle/fluid/memory/allocation/allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// MmapAllocation maps a whole file into the CPU memory without reading it.
+//
+// The pages are mapped privately, i.e., copy-on-write. All the processes
+// mapping the same file share its pages in the page cache until one of them
+// writes to a page, which then gets a private copy of that page. The file is
+// never modified.
+//
+// NOTE: the mapping is not supported on Windows.
+class MmapAllocation : public Allocation {
+ public:
+  // Throws if the file cannot be opened or mapped.
+  static std::shared_ptr<MmapAllocation> MapFile(const std::string& path);
+
+  ~MmapAllocation();
+
+ private:
+  MmapAllocation(void* ptr, size_t size);
+};
+
+// A part of a mapped file, which keeps the whole mapping alive. It is used as
+// the holder of the tensors aliasing the file.
+class MmapSubAllocation : public Allocation {
+ public:
+  MmapSubAllocation(std::shared_ptr<MmapAllocation> file, size_t offset,
+                    size_t size);
+
+ private:
+  std::shared_ptr<MmapAllocation> file_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,196 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/stream_safe_cuda_allocator.h"
+#include <array>
+#include <atomic>
+#include <utility>
+#include "paddle/fluid/platform/cuda_device_guard.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+static constexpr int kMaxCUDADevices = 64;
+
+static std::array<std::atomic<cudaStream_t>, kMaxCUDADevices>&
+DefaultStreams() {
+  static std::array<std::atomic<cudaStream_t>, kMaxCUDADevices> streams;
+  return streams;
+}
+
+static thread_local cudaStream_t tls_stream = nullptr;
+static thread_local bool tls_stream_is_set = false;
+
+static cudaStream_t CurrentStream(int device) {
+  if (tls_stream_is_set) return tls_stream;
+  return DefaultStreams()[device].load();
+}
+
+void SetDefaultCUDAAllocationStream(int device, cudaStream_t stream) {
+  PADDLE_ENFORCE(device >= 0 && device < kMaxCUDADevices,
+                 "Invalid device id %d", device);
+  DefaultStreams()[device].store(stream);
+}
+
+CUDAAllocationStreamGuard::CUDAAllocationStreamGuard(cudaStream_t stream)
+    : prev_stream_(tls_stream), prev_is_set_(tls_stream_is_set) {
+  tls_stream = stream;
+  tls_stream_is_set = true;
+}
+
+CUDAAllocationStreamGuard::~CUDAAllocationStreamGuard() {
+  tls_stream = prev_stream_;
+  tls_stream_is_set = prev_is_set_;
+}
+
+StreamSafeCUDAAllocator::StreamSafeCUDAAllocator(
+    std::shared_ptr<Allocator> underlying_allocator,
+    const platform::CUDAPlace& place)
+    : underlying_allocator_(std::move(underlying_allocator)), place_(place) {
+  PADDLE_ENFORCE_NOT_NULL(underlying_allocator_);
+  PADDLE_ENFORCE(underlying_allocator_->IsAllocThreadSafe(),
+                 "The underlying allocator of StreamSafeCUDAAllocator must "
+                 "be thread safe");
+  PADDLE_ENFORCE_LT(place_.device, kMaxCUDADevices);
+}
+
+StreamSafeCUDAAllocator::~StreamSafeCUDAAllocator() {
+  // The CUDA runtime may have been unloaded at exit, so the errors are
+  // ignored here.
+  platform::CUDADeviceGuard guard(place_.device);
+  for (auto& pair : free_blocks_) {
+    for (auto& block : pair.second) {
+      cudaEventSynchronize(block.second.event_);
+      cudaEventDestroy(block.second.event_);
+    }
+  }
+  free_blocks_.clear();
+  for (auto event : free_events_) {
+    cudaEventDestroy(event);
+  }
+}
+
+cudaEvent_t StreamSafeCUDAAllocator::CreateEvent() {
+  if (!free_events_.empty()) {
+    cudaEvent_t event = free_events_.back();
+    free_events_.pop_back();
+    return event;
+  }
+  cudaEvent_t event;
+  PADDLE_ENFORCE(cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+  return event;
+}
+
+AllocationPtr StreamSafeCUDAAllocator::TakeFreeBlock(cudaStream_t stream,
+                                                     size_t size) {
+  // Do not use a block more than twice of the requested size, as what
+  // BufferedAllocator does.
+  auto is_fit = [size](size_t block_size) { return block_size < size * 2; };
+
+  auto it = free_blocks_.find(stream);
+  if (it != free_blocks_.end()) {
+    auto& blocks = it->second;
+    auto block_it = blocks.lower_bound(size);
+    if (block_it != blocks.end() && is_fit(block_it->first)) {
+      AllocationPtr allocation = std::move(block_it->second.allocation_);
+      free_events_.emplace_back(block_it->second.event_);
+      blocks.erase(block_it);
+      return allocation;
+    }
+  }
+
+  for (auto& pair : free_blocks_) {
+    if (pair.first == stream) continue;
+    auto& blocks = pair.second;
+    for (auto block_it = blocks.lower_bound(size);
+         block_it != blocks.end() && is_fit(block_it->first); ++block_it) {
+      auto status = cudaEventQuery(block_it->second.event_);
+      if (status == cudaErrorNotReady) continue;
+      PADDLE_ENFORCE(status);
+      AllocationPtr allocation = std::move(block_it->second.allocation_);
+      free_events_.emplace_back(block_it->second.event_);
+      blocks.erase(block_it);
+      return allocation;
+    }
+  }
+  return nullptr;
+}
+
+Allocation* StreamSafeCUDAAllocator::AllocateImpl(size_t size,
+                                                  Allocator::Attr attr) {
+  cudaStream_t stream = CurrentStream(place_.device);
+  {
+    std::lock_guard<std::mutex> guard(mtx_);
+    auto allocation = TakeFreeBlock(stream, size);
+    if (allocation) {
+      return new StreamSafeCUDAAllocation(std::move(allocation), stream);
+    }
+  }
+
+  AllocationPtr allocation;
+  try {
+    allocation = underlying_allocator_->Allocate(size, attr);
+  } catch (BadAlloc&) {
+    VLOG(2) << "Free the cached blocks on " << place_
+            << " and retry allocating " << size << " bytes";
+    ClearCache();
+    allocation = underlying_allocator_->Allocate(size, attr);
+  }
+  return new StreamSafeCUDAAllocation(std::move(allocation), stream);
+}
+
+void StreamSafeCUDAAllocator::Free(Allocation* allocation) {
+  auto* stream_safe_allocation =
+      dynamic_cast<StreamSafeCUDAAllocation*>(allocation);
+  PADDLE_ENFORCE_NOT_NULL(stream_safe_allocation);
+  cudaStream_t stream = stream_safe_allocation->stream_;
+  {
+    platform::CUDADeviceGuard guard(place_.device);
+    std::lock_guard<std::mutex> lock(mtx_);
+    cudaEvent_t event = CreateEvent();
+    PADDLE_ENFORCE(cudaEventRecord(event, stream));
+    auto& underlying = stream_safe_allocation->underlying_allocation_;
+    size_t size = underlying->size();
+    free_blocks_[stream].emplace(size,
+                                 FreeBlock{std::move(underlying), event});
+  }
+  delete allocation;
+}
+
+void StreamSafeCUDAAllocator::ClearCache() {
+  std::map<cudaStream_t, FreeBlockMap> free_blocks;
+  {
+    std::lock_guard<std::mutex> guard(mtx_);
+    free_blocks.swap(free_blocks_);
+  }
+
+  platform::CUDADeviceGuard guard(place_.device);
+  std::vector<cudaEvent_t> events;
+  for (auto& pair : free_blocks) {
+    for (auto& block : pair.second) {
+      PADDLE_ENFORCE(cudaEventSynchronize(block.second.event_));
+      events.emplace_back(block.second.event_);
+    }
+  }
+  free_blocks.clear();
+
+  std::lock_guard<std::mutex> lock(mtx_);
+  free_events_.insert(free_events_.end(), events.begin(), events.end());
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -0,0 +1,113 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cuda_runtime.h>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+#include "paddle/fluid/memory/allocation/allocator.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+// Set the stream of the GPU allocations on the device, which is used when
+// the allocating thread is not in the scope of a CUDAAllocationStreamGuard.
+// It is the stream of the device context in DeviceContextPool.
+void SetDefaultCUDAAllocationStream(int device, cudaStream_t stream);
+
+// The GPU allocations of the current thread in the scope of this guard are
+// used on the given stream.
+class CUDAAllocationStreamGuard {
+ public:
+  explicit CUDAAllocationStreamGuard(cudaStream_t stream);
+
+  ~CUDAAllocationStreamGuard();
+
+ private:
+  cudaStream_t prev_stream_;
+  bool prev_is_set_;
+};
+
+class StreamSafeCUDAAllocation : public Allocation {
+ public:
+  StreamSafeCUDAAllocation(AllocationPtr underlying_allocation,
+                           cudaStream_t stream)
+      : Allocation(underlying_allocation->ptr(), underlying_allocation->size(),
+                   underlying_allocation->place()),
+        underlying_allocation_(std::move(underlying_allocation)),
+        stream_(stream) {}
+
+  AllocationPtr underlying_allocation_;
+  cudaStream_t stream_;
+};
+
+// StreamSafeCUDAAllocator frees the GPU memory in the order of the stream the
+// memory is allocated on. An allocation can be freed as soon as the kernels
+// using it are launched, instead of waiting for them to finish.
+//
+// Each freed block is cached with its stream and an event recorded on the
+// stream. A block can be reused immediately by the same stream, since the
+// later kernels on the stream run after the earlier ones. It can be reused by
+// another stream only after the event completes.
+//
+// NOTE: If an allocation is used on a stream other than the one it is
+// allocated on, the stream it is allocated on must wait for that use before
+// the allocation is freed, e.g., by cudaStreamWaitEvent, just as the
+// executors do for the dependencies between operators.
+class StreamSafeCUDAAllocator : public Allocator {
+ public:
+  StreamSafeCUDAAllocator(std::shared_ptr<Allocator> underlying_allocator,
+                          const platform::CUDAPlace& place);
+
+  ~StreamSafeCUDAAllocator();
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  // Wait for the cached blocks and free them to the underlying allocator.
+  void ClearCache();
+
+ protected:
+  void Free(Allocation* allocation) override;
+  Allocation* AllocateImpl(size_t size, Allocator::Attr attr) override;
+
+ private:
+  struct FreeBlock {
+    AllocationPtr allocation_;
+    cudaEvent_t event_;
+  };
+
+  using FreeBlockMap = std::multimap<size_t, FreeBlock>;
+
+  // Find a cached block which can be used by the stream. Must be called with
+  // mtx_ held.
+  AllocationPtr TakeFreeBlock(cudaStream_t stream, size_t size);
+
+  cudaEvent_t CreateEvent();
+
+  std::shared_ptr<Allocator> underlying_allocator_;
+  platform::CUDAPlace place_;
+
+  std::mutex mtx_;
+  std::map<cudaStream_t, FreeBlockMap> free_blocks_;
+  std::vector<cudaEvent_t> free_events_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
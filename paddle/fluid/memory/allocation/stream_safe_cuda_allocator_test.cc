@@ -0,0 +1,67 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/stream_safe_cuda_allocator.h"
+#include <gtest/gtest.h>
+#include "paddle/fluid/memory/allocation/cuda_allocator.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+TEST(StreamSafeCUDAAllocator, reuse) {
+  platform::CUDAPlace place(0);
+  StreamSafeCUDAAllocator allocator(std::make_shared<CUDAAllocator>(place),
+                                    place);
+  cudaStream_t stream1, stream2;
+  PADDLE_ENFORCE(cudaStreamCreate(&stream1));
+  PADDLE_ENFORCE(cudaStreamCreate(&stream2));
+
+  void* ptr = nullptr;
+  {
+    CUDAAllocationStreamGuard guard(stream1);
+    auto allocation = allocator.Allocate(1 << 20);
+    ptr = allocation->ptr();
+    PADDLE_ENFORCE(cudaMemsetAsync(ptr, 0, 1 << 20, stream1));
+  }
+  {
+    // The block is reused by the same stream without waiting.
+    CUDAAllocationStreamGuard guard(stream1);
+    auto allocation = allocator.Allocate(1 << 20);
+    ASSERT_EQ(allocation->ptr(), ptr);
+    PADDLE_ENFORCE(cudaMemsetAsync(ptr, 0, 1 << 20, stream1));
+  }
+  PADDLE_ENFORCE(cudaStreamSynchronize(stream1));
+  {
+    // The block is reused by another stream after the event completes.
+    CUDAAllocationStreamGuard guard(stream2);
+    auto allocation = allocator.Allocate(1 << 20);
+    ASSERT_EQ(allocation->ptr(), ptr);
+  }
+  {
+    // A block much larger than the request is not used.
+    CUDAAllocationStreamGuard guard(stream2);
+    auto allocation = allocator.Allocate(1 << 10);
+    ASSERT_NE(allocation->ptr(), ptr);
+  }
+
+  allocator.ClearCache();
+  PADDLE_ENFORCE(cudaStreamDestroy(stream1));
+  PADDLE_ENFORCE(cudaStreamDestroy(stream2));
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
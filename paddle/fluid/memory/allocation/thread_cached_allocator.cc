@@ -0,0 +1,287 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/thread_cached_allocator.h"
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+constexpr size_t ThreadCachedAllocator::kDefaultMaxCachedSize;
+
+static constexpr size_t kNoSizeClass = static_cast<size_t>(-1);
+static constexpr size_t kMinClassSizeLog2 = 6;
+// A batch of refilling or releasing moves about kBatchBytes bytes, and at
+// most kMaxBatchSize blocks.
+static constexpr size_t kBatchBytes = 256 << 10;
+static constexpr size_t kMaxBatchSize = 32;
+
+size_t ThreadCachedAllocator::SizeClassIndex(size_t size) {
+  if (size <= (1UL << kMinClassSizeLog2)) return 0;
+  // 2^b < size <= 2^(b+1), the classes are 1.5 * 2^b and 2^(b+1).
+  size_t b = 0;
+  for (size_t s = size - 1; s > 1; s >>= 1) ++b;
+  size_t base = 1UL << b;
+  size_t idx = 2 * (b - kMinClassSizeLog2);
+  return size <= base + base / 2 ? idx + 1 : idx + 2;
+}
+
+size_t ThreadCachedAllocator::SizeOfClass(size_t size_class) {
+  if (size_class == 0) return 1UL << kMinClassSizeLog2;
+  size_t b = kMinClassSizeLog2 + (size_class - 1) / 2;
+  return (size_class - 1) % 2 == 0 ? (3UL << (b - 1)) : (1UL << (b + 1));
+}
+
+namespace details {
+
+class ThreadCachePool {
+ public:
+  ThreadCachePool(std::shared_ptr<Allocator> underlying_allocator,
+                  size_t max_cached_size)
+      : underlying_allocator_(std::move(underlying_allocator)),
+        max_cached_size_(max_cached_size) {
+    PADDLE_ENFORCE_NOT_NULL(underlying_allocator_);
+    PADDLE_ENFORCE(underlying_allocator_->IsAllocThreadSafe(),
+                   "The underlying allocator of ThreadCachedAllocator must "
+                   "be thread safe");
+    size_t num_classes =
+        ThreadCachedAllocator::SizeClassIndex(max_cached_size_) + 1;
+    for (size_t i = 0; i < num_classes; ++i) {
+      central_lists_.emplace_back(new CentralList());
+    }
+  }
+
+  size_t NumSizeClasses() const { return central_lists_.size(); }
+
+  size_t MaxCachedSize() const { return max_cached_size_; }
+
+  Allocator* UnderlyingAllocator() { return underlying_allocator_.get(); }
+
+  size_t BatchSize(size_t size_class) const {
+    size_t n = kBatchBytes / ThreadCachedAllocator::SizeOfClass(size_class);
+    return std::max<size_t>(1, std::min(n, kMaxBatchSize));
+  }
+
+  // Move at most n blocks of the size class from the central pool to blocks.
+  size_t Fetch(size_t size_class, size_t n,
+               std::vector<AllocationPtr>* blocks) {
+    auto& list = *central_lists_[size_class];
+    std::lock_guard<std::mutex> guard(list.mtx);
+    n = std::min(n, list.blocks.size());
+    for (size_t i = 0; i < n; ++i) {
+      blocks->emplace_back(std::move(list.blocks.back()));
+      list.blocks.pop_back();
+    }
+    return n;
+  }
+
+  // Move the last n blocks of blocks to the central pool.
+  void Release(size_t size_class, size_t n,
+               std::vector<AllocationPtr>* blocks) {
+    if (n == 0) return;
+    auto& list = *central_lists_[size_class];
+    std::lock_guard<std::mutex> guard(list.mtx);
+    for (size_t i = 0; i < n; ++i) {
+      list.blocks.emplace_back(std::move(blocks->back()));
+      blocks->pop_back();
+    }
+  }
+
+  // Allocate at most n blocks of the size class from the underlying
+  // allocator. At least one block is allocated, or BadAlloc is thrown.
+  void AllocateBlocks(size_t size_class, size_t n, Allocator::Attr attr,
+                      std::vector<AllocationPtr>* blocks) {
+    size_t size = ThreadCachedAllocator::SizeOfClass(size_class);
+    try {
+      blocks->emplace_back(underlying_allocator_->Allocate(size, attr));
+    } catch (BadAlloc&) {
+      FreeCentralCache();
+      blocks->emplace_back(underlying_allocator_->Allocate(size, attr));
+    }
+    for (size_t i = 1; i < n; ++i) {
+      try {
+        blocks->emplace_back(underlying_allocator_->Allocate(size, attr));
+      } catch (BadAlloc&) {
+        break;
+      }
+    }
+  }
+
+  void FreeCentralCache() {
+    for (auto& list : central_lists_) {
+      std::lock_guard<std::mutex> guard(list->mtx);
+      list->blocks.clear();
+    }
+  }
+
+ private:
+  struct CentralList {
+    std::mutex mtx;
+    std::vector<AllocationPtr> blocks;
+  };
+
+  std::shared_ptr<Allocator> underlying_allocator_;
+  size_t max_cached_size_;
+  std::vector<std::unique_ptr<CentralList>> central_lists_;
+};
+
+// The cached blocks of one thread. It returns all its blocks to the central
+// pool when the thread exits.
+struct ThreadCache {
+  explicit ThreadCache(std::shared_ptr<ThreadCachePool> pool)
+      : pool_(std::move(pool)), lists_(pool_->NumSizeClasses()) {}
+
+  ~ThreadCache() { ReleaseAll(); }
+
+  void ReleaseAll() {
+    for (size_t i = 0; i < lists_.size(); ++i) {
+      pool_->Release(i, lists_[i].size(), &lists_[i]);
+    }
+  }
+
+  std::shared_ptr<ThreadCachePool> pool_;
+  std::vector<std::vector<AllocationPtr>> lists_;
+};
+
+// The caches of the current thread. The trivially destructible flag tells
+// whether the caches have been destroyed at the exit of the thread, since
+// an allocator may still be used or destroyed after that, e.g., the static
+// AllocatorFacade on the main thread.
+static thread_local bool tls_caches_destroyed = false;
+static thread_local ThreadCachePool* tls_last_pool = nullptr;
+static thread_local ThreadCache* tls_last_cache = nullptr;
+
+struct ThreadCacheMap {
+  ~ThreadCacheMap() {
+    tls_caches_destroyed = true;
+    tls_last_pool = nullptr;
+    tls_last_cache = nullptr;
+  }
+
+  // The map holds a reference of the pool, so that the address of the pool
+  // cannot be reused by another pool when it is the key of the map.
+  std::unordered_map<ThreadCachePool*, std::unique_ptr<ThreadCache>> caches_;
+};
+
+static ThreadCacheMap& ThreadCaches() {
+  static thread_local ThreadCacheMap caches;
+  return caches;
+}
+
+// Return nullptr if the caches of the current thread have been destroyed.
+static ThreadCache* GetThreadCache(const std::shared_ptr<ThreadCachePool>& p) {
+  if (LIKELY(tls_last_pool == p.get())) return tls_last_cache;
+  if (UNLIKELY(tls_caches_destroyed)) return nullptr;
+
+  auto& caches = ThreadCaches().caches_;
+  auto it = caches.find(p.get());
+  if (it == caches.end()) {
+    std::unique_ptr<ThreadCache> cache(new ThreadCache(p));
+    it = caches.emplace(p.get(), std::move(cache)).first;
+  }
+  tls_last_pool = p.get();
+  tls_last_cache = it->second.get();
+  return tls_last_cache;
+}
+
+static void EraseThreadCache(ThreadCachePool* pool) {
+  if (tls_caches_destroyed) return;
+  if (tls_last_pool == pool) {
+    tls_last_pool = nullptr;
+    tls_last_cache = nullptr;
+  }
+  ThreadCaches().caches_.erase(pool);
+}
+
+class ThreadCachedAllocation : public Allocation {
+ public:
+  ThreadCachedAllocation(AllocationPtr block, size_t size_class)
+      : Allocation(block->ptr(), block->size(), block->place()),
+        block_(std::move(block)),
+        size_class_(size_class) {}
+
+  AllocationPtr block_;
+  size_t size_class_;
+};
+
+}  // namespace details
+
+ThreadCachedAllocator::ThreadCachedAllocator(
+    std::shared_ptr<Allocator> underlying_allocator, size_t max_cached_size)
+    : pool_(new details::ThreadCachePool(std::move(underlying_allocator),
+                                         max_cached_size)) {}
+
+ThreadCachedAllocator::~ThreadCachedAllocator() {
+  // The caches of other threads are released when the threads exit.
+  ClearCache();
+}
+
+void ThreadCachedAllocator::ClearCache() {
+  details::EraseThreadCache(pool_.get());
+  pool_->FreeCentralCache();
+}
+
+Allocation* ThreadCachedAllocator::AllocateImpl(size_t size,
+                                                Allocator::Attr attr) {
+  if (size > pool_->MaxCachedSize()) {
+    return new details::ThreadCachedAllocation(
+        pool_->UnderlyingAllocator()->Allocate(size, attr), kNoSizeClass);
+  }
+
+  auto* cache = details::GetThreadCache(pool_);
+  if (UNLIKELY(cache == nullptr)) {
+    return new details::ThreadCachedAllocation(
+        pool_->UnderlyingAllocator()->Allocate(size, attr), kNoSizeClass);
+  }
+
+  size_t size_class = SizeClassIndex(size);
+  auto& blocks = cache->lists_[size_class];
+  if (blocks.empty()) {
+    size_t batch_size = pool_->BatchSize(size_class);
+    if (pool_->Fetch(size_class, batch_size, &blocks) == 0) {
+      pool_->AllocateBlocks(size_class, batch_size, attr, &blocks);
+    }
+  }
+  AllocationPtr block(std::move(blocks.back()));
+  blocks.pop_back();
+  return new details::ThreadCachedAllocation(std::move(block), size_class);
+}
+
+void ThreadCachedAllocator::Free(Allocation* allocation) {
+  auto* cached = dynamic_cast<details::ThreadCachedAllocation*>(allocation);
+  PADDLE_ENFORCE_NOT_NULL(cached, "The allocation must be allocated by "
+                                  "ThreadCachedAllocator");
+  size_t size_class = cached->size_class_;
+  details::ThreadCache* cache = nullptr;
+  if (size_class != kNoSizeClass) {
+    cache = details::GetThreadCache(pool_);
+  }
+  if (cache != nullptr) {
+    auto& blocks = cache->lists_[size_class];
+    blocks.emplace_back(std::move(cached->block_));
+    size_t batch_size = pool_->BatchSize(size_class);
+    if (blocks.size() > 2 * batch_size) {
+      pool_->Release(size_class, batch_size, &blocks);
+    }
+  }
+  delete allocation;
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
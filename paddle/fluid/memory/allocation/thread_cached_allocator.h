@@ -0,0 +1,75 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+#include "paddle/fluid/memory/allocation/allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+namespace details {
+class ThreadCachePool;
+}  // namespace details
+
+// ThreadCachedAllocator keeps a cache of free blocks for each thread in front
+// of a thread-safe underlying allocator, e.g., a LockedAllocator wrapping
+// BestFitAllocator which serializes all the threads.
+//
+// The sizes no larger than max_cached_size are rounded up to size classes
+// (64, 96, 128, 192, 256, ...), so that the blocks can be reused by any
+// request of the same class. A thread allocates from its own cache without
+// any lock. When the cache of a class is empty, it is refilled with a batch
+// of blocks from the central pool shared by all the threads, or from the
+// underlying allocator if the central pool is empty. When a thread caches too
+// many blocks of a class, a batch of them is released to the central pool.
+//
+// The blocks in the central pool are freed to the underlying allocator only
+// when the underlying allocator runs out of memory, or when the
+// ThreadCachedAllocator and all the thread caches are destroyed.
+class ThreadCachedAllocator : public Allocator {
+ public:
+  explicit ThreadCachedAllocator(
+      std::shared_ptr<Allocator> underlying_allocator,
+      size_t max_cached_size = kDefaultMaxCachedSize);
+
+  ~ThreadCachedAllocator();
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  // Return the blocks cached by the calling thread and the central pool to
+  // the underlying allocator. Only used in unittest.
+  void ClearCache();
+
+  static size_t SizeClassIndex(size_t size);
+
+  static size_t SizeOfClass(size_t size_class);
+
+  static constexpr size_t kDefaultMaxCachedSize = 1 << 20;
+
+ protected:
+  void Free(Allocation* allocation) override;
+  Allocation* AllocateImpl(size_t size, Allocator::Attr attr) override;
+
+ private:
+  std::shared_ptr<details::ThreadCachePool> pool_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
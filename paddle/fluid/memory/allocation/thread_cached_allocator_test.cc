@@ -0,0 +1,155 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/thread_cached_allocator.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <thread>  // NOLINT
+#include <vector>
+#include "paddle/fluid/memory/allocation/best_fit_allocator.h"
+#include "paddle/fluid/memory/allocation/cpu_allocator.h"
+#include "paddle/fluid/memory/allocation/locked_allocator.h"
+#include "paddle/fluid/memory/allocation/zero_size_allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+TEST(thread_cached_allocator, size_class) {
+  EXPECT_EQ(ThreadCachedAllocator::SizeClassIndex(1), 0UL);
+  EXPECT_EQ(ThreadCachedAllocator::SizeClassIndex(64), 0UL);
+  EXPECT_EQ(ThreadCachedAllocator::SizeClassIndex(65), 1UL);
+  EXPECT_EQ(ThreadCachedAllocator::SizeClassIndex(96), 1UL);
+  EXPECT_EQ(ThreadCachedAllocator::SizeClassIndex(97), 2UL);
+  EXPECT_EQ(ThreadCachedAllocator::SizeClassIndex(128), 2UL);
+  EXPECT_EQ(ThreadCachedAllocator::SizeClassIndex(129), 3UL);
+
+  for (size_t size = 1; size <= (1 << 20); size += 7) {
+    size_t size_class = ThreadCachedAllocator::SizeClassIndex(size);
+    size_t class_size = ThreadCachedAllocator::SizeOfClass(size_class);
+    EXPECT_GE(class_size, size);
+    if (size_class > 0) {
+      EXPECT_LT(ThreadCachedAllocator::SizeOfClass(size_class - 1), size);
+    }
+  }
+}
+
+class ThreadCachedAllocatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    chunk_ = cpu_allocator_.Allocate(kChunkSize);
+    best_fit_allocator_ = new BestFitAllocator(chunk_.get());
+    locked_allocator_ = std::make_shared<LockedAllocator>(
+        std::unique_ptr<Allocator>(best_fit_allocator_));
+  }
+
+  void TearDown() override {
+    locked_allocator_.reset();
+    chunk_.reset();
+  }
+
+  static constexpr size_t kChunkSize = 32 << 20;
+
+  CPUAllocator cpu_allocator_;
+  AllocationPtr chunk_;
+  BestFitAllocator* best_fit_allocator_;  // owned by locked_allocator_
+  std::shared_ptr<Allocator> locked_allocator_;
+};
+
+TEST_F(ThreadCachedAllocatorTest, reuse_in_thread) {
+  ThreadCachedAllocator allocator(locked_allocator_);
+  ASSERT_TRUE(allocator.IsAllocThreadSafe());
+
+  void* ptr = nullptr;
+  {
+    auto allocation = allocator.Allocate(100);
+    ASSERT_GE(allocation->size(), 100UL);
+    ptr = allocation->ptr();
+  }
+  {
+    // The freed block of the same size class is reused.
+    auto allocation = allocator.Allocate(120);
+    ASSERT_EQ(allocation->ptr(), ptr);
+  }
+  {
+    // The large allocation is not cached.
+    auto allocation = allocator.Allocate(4 << 20);
+    ASSERT_GE(allocation->size(), 4UL << 20);
+  }
+
+  allocator.ClearCache();
+  ASSERT_EQ(best_fit_allocator_->NumFreeChunks(), 1UL);
+}
+
+TEST_F(ThreadCachedAllocatorTest, wrapped_by_zero_size_allocator) {
+  auto allocator = std::make_shared<ThreadCachedAllocator>(locked_allocator_);
+  platform::CPUPlace place;
+  ZeroSizeAllocator zero_size_allocator(allocator, place);
+
+  void* ptr = nullptr;
+  {
+    auto allocation = zero_size_allocator.Allocate(1000);
+    ptr = allocation->ptr();
+  }
+  {
+    // The freed block goes back to the thread cache instead of the
+    // underlying allocator.
+    auto allocation = zero_size_allocator.Allocate(1000);
+    ASSERT_EQ(allocation->ptr(), ptr);
+  }
+  {
+    auto allocation = zero_size_allocator.Allocate(0);
+    ASSERT_EQ(allocation->ptr(), nullptr);
+  }
+}
+
+TEST_F(ThreadCachedAllocatorTest, multi_thread) {
+  {
+    ThreadCachedAllocator allocator(locked_allocator_);
+    auto func = [&allocator](int thread_id) {
+      std::vector<AllocationPtr> allocations;
+      for (int i = 0; i < 1000; ++i) {
+        size_t size = 64 + (i * 37 + thread_id * 101) % 8192;
+        auto allocation = allocator.Allocate(size);
+        std::memset(allocation->ptr(), thread_id, size);
+        allocations.emplace_back(std::move(allocation));
+        if (i % 3 == 0) {
+          // Free the blocks in other order than they are allocated.
+          allocations.erase(allocations.begin());
+        }
+      }
+      for (auto& allocation : allocations) {
+        auto* data = static_cast<uint8_t*>(allocation->ptr());
+        for (size_t j = 0; j < 64; ++j) {
+          ASSERT_EQ(data[j], static_cast<uint8_t>(thread_id));
+        }
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+      threads.emplace_back(func, i);
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+  // All the blocks are returned to the underlying allocator after the
+  // threads exit and the allocator is destroyed.
+  ASSERT_EQ(best_fit_allocator_->NumFreeChunks(), 1UL);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
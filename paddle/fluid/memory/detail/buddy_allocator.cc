@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/memory/detail/buddy_allocator.h"
+#include <algorithm>
 #include "glog/logging.h"
 
 DEFINE_bool(free_idle_memory, false,
@@ -170,6 +171,20 @@ size_t BuddyAllocator::Used() { return total_used_; }
 size_t BuddyAllocator::GetMinChunkSize() { return min_chunk_size_; }
 size_t BuddyAllocator::GetMaxChunkSize() { return max_chunk_size_; }
 
+void BuddyAllocator::GetFreeChunkStats(size_t* free_bytes,
+                                       size_t* num_free_chunks,
+                                       size_t* largest_free_chunk) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  *free_bytes = 0;
+  *num_free_chunks = pool_.size();
+  *largest_free_chunk = 0;
+  for (auto& chunk : pool_) {
+    size_t size = std::get<1>(chunk);
+    *free_bytes += size;
+    *largest_free_chunk = std::max(*largest_free_chunk, size);
+  }
+}
+
 void* BuddyAllocator::SystemAlloc(size_t size) {
   size_t index = 0;
   void* p = system_allocator_->Alloc(&index, size);
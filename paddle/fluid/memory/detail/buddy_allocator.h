@@ -45,6 +45,11 @@ class BuddyAllocator {
   size_t GetMinChunkSize();
   size_t GetMaxChunkSize();
 
+  /*! \brief Get the total size, the number and the largest size of the
+   *         free chunks in the pool */
+  void GetFreeChunkStats(size_t* free_bytes, size_t* num_free_chunks,
+                         size_t* largest_free_chunk);
+
  public:
   // Disable copy and assignment
   BuddyAllocator(const BuddyAllocator&) = delete;
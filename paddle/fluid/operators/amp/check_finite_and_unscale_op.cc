@@ -0,0 +1,89 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/amp/check_finite_and_unscale_op.h"
+
+namespace paddle {
+namespace operators {
+
+class CheckFiniteAndUnscaleOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInputs("X"),
+                   "Inputs(X) of CheckFiniteAndUnscaleOp should not be null.");
+    PADDLE_ENFORCE(
+        ctx->HasOutputs("Out"),
+        "Outputs(Out) of CheckFiniteAndUnscaleOp should not be null.");
+    PADDLE_ENFORCE(
+        ctx->HasOutput("FoundInfinite"),
+        "Output(FoundInfinite) of CheckFiniteAndUnscaleOp should not be null.");
+    // Out is X, which is updated in place.
+    ctx->SetOutputDim("FoundInfinite", {1});
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        framework::GetDataTypeOfVar(ctx.MultiInputVar("X").front()),
+        ctx.GetPlace());
+  }
+};
+
+class CheckFiniteAndUnscaleOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("X",
+             "(vector<LoDTensor|SelectedRows>) The gradients of the "
+             "parameters, scaled by the loss scaling.")
+        .AsDuplicable();
+    AddInput("LossScaling",
+             "(Tensor) A float scalar, the current loss scaling. "
+             "init_loss_scaling is used if it is not initialized.")
+        .AsDispensable();
+    AddOutput("Out",
+              "(vector<LoDTensor|SelectedRows>) The unscaled gradients. "
+              "They must be the same variables as Input(X).")
+        .AsDuplicable();
+    AddOutput("FoundInfinite",
+              "(Tensor) A bool scalar, whether any gradient has Inf or Nan.");
+    AddAttr<float>("init_loss_scaling",
+                   "(float, default 32768) The loss scaling used when "
+                   "Input(LossScaling) is not given or not initialized.")
+        .SetDefault(32768.0f);
+    AddComment(R"DOC(
+Check Finite And Unscale Operator.
+
+Check whether all the gradients are finite. If they are, divide them by the
+loss scaling in place. Otherwise they have overflowed in float16, and are set
+to zero, so that the step is skipped.
+
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(check_finite_and_unscale, ops::CheckFiniteAndUnscaleOp,
+                  ops::CheckFiniteAndUnscaleOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    check_finite_and_unscale,
+    ops::CheckFiniteAndUnscaleKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::CheckFiniteAndUnscaleKernel<paddle::platform::CPUDeviceContext,
+                                     double>);
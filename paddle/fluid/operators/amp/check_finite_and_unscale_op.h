@@ -0,0 +1,70 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <vector>
+#include "paddle/fluid/framework/eigen.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/operators/amp/loss_scaling.h"
+#include "paddle/fluid/operators/math/math_function.h"
+
+namespace paddle {
+namespace operators {
+
+template <typename DeviceContext, typename T>
+class CheckFiniteAndUnscaleKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto xs = ctx.MultiInputVar("X");
+    auto outs = ctx.MultiOutputVar("Out");
+    PADDLE_ENFORCE_EQ(xs.size(), outs.size(),
+                      "X and Out should have the same number of variables.");
+    float scale = GetScalar<float>(ctx.Input<framework::Tensor>("LossScaling"),
+                                   ctx.Attr<float>("init_loss_scaling"));
+
+    bool found_inf = false;
+    for (auto* var : xs) {
+      auto* x = framework::GetLoDTensorOrSelectedRowsValueFromVar(*var);
+      if (x->IsInitialized() && x->numel() > 0 &&
+          !framework::TensorIsfinite(*x)) {
+        found_inf = true;
+        break;
+      }
+    }
+
+    auto& dev_ctx = ctx.template device_context<DeviceContext>();
+    auto& dev = *dev_ctx.eigen_device();
+    auto inv_scale = static_cast<T>(1.0f / scale);
+    for (size_t i = 0; i < xs.size(); ++i) {
+      PADDLE_ENFORCE(xs[i] == outs[i], "Out should be the same as X.");
+      auto* out = framework::GetMutableLoDTensorOrSelectedRowsValueFromVar(
+          outs[i]);
+      if (!out->IsInitialized() || out->numel() == 0) continue;
+      // The updates are skipped with the zero gradients.
+      if (found_inf) {
+        math::SetConstant<DeviceContext, T>()(dev_ctx, out, static_cast<T>(0));
+      } else {
+        auto eigen_out = framework::EigenVector<T>::Flatten(*out);
+        eigen_out.device(dev) = eigen_out * inv_scale;
+      }
+    }
+    SetScalar<bool>(found_inf, ctx.GetPlace(),
+                    ctx.Output<framework::Tensor>("FoundInfinite"));
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
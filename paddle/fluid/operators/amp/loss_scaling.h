@@ -0,0 +1,56 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace operators {
+
+// The states of the loss scaling are persistable variables created by
+// mixed_precision_pass, which are not initialized by the startup program. So
+// an uninitialized state has its default value, e.g., the initial loss
+// scaling before the first update.
+template <typename T>
+T GetScalar(const framework::Tensor* tensor, T default_value) {
+  if (tensor == nullptr || !tensor->IsInitialized()) {
+    return default_value;
+  }
+  PADDLE_ENFORCE_EQ(tensor->numel(), 1, "The tensor should be a scalar.");
+  if (platform::is_cpu_place(tensor->place())) {
+    return tensor->data<T>()[0];
+  }
+  framework::Tensor cpu_tensor;
+  framework::TensorCopySync(*tensor, platform::CPUPlace(), &cpu_tensor);
+  return cpu_tensor.data<T>()[0];
+}
+
+template <typename T>
+void SetScalar(T value, const platform::Place& place,
+               framework::Tensor* tensor) {
+  if (platform::is_cpu_place(place)) {
+    tensor->mutable_data<T>(framework::make_ddim({1}), place)[0] = value;
+    return;
+  }
+  framework::Tensor cpu_tensor;
+  cpu_tensor.mutable_data<T>(framework::make_ddim({1}),
+                             platform::CPUPlace())[0] = value;
+  framework::TensorCopySync(cpu_tensor, place, tensor);
+}
+
+}  // namespace operators
+}  // namespace paddle
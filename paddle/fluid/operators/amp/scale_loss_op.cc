@@ -0,0 +1,76 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/amp/scale_loss_op.h"
+
+namespace paddle {
+namespace operators {
+
+class ScaleLossOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("X"),
+                   "Input(X) of ScaleLossOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("Out"),
+                   "Output(Out) of ScaleLossOp should not be null.");
+    ctx->ShareDim("X", /*->*/ "Out");
+    ctx->ShareLoD("X", /*->*/ "Out");
+  }
+
+ protected:
+  // Input(LossScaling) may not be initialized before the first update.
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        framework::GetDataTypeOfVar(ctx.InputVar("X")), ctx.GetPlace());
+  }
+};
+
+class ScaleLossOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("X", "(Tensor) The gradient of the loss.");
+    AddInput("LossScaling",
+             "(Tensor) A float scalar, the current loss scaling. "
+             "init_loss_scaling is used if it is not initialized.")
+        .AsDispensable();
+    AddOutput("Out", "(Tensor) The scaled gradient of the loss.");
+    AddAttr<float>("init_loss_scaling",
+                   "(float, default 32768) The loss scaling used when "
+                   "Input(LossScaling) is not given or not initialized.")
+        .SetDefault(32768.0f);
+    AddComment(R"DOC(
+Scale Loss Operator.
+
+Multiply the gradient of the loss by the loss scaling before the backward ops
+of the mixed precision training, so that the small gradients computed in
+float16 do not underflow.
+
+$$Out = X * LossScaling$$
+
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(scale_loss, ops::ScaleLossOp, ops::ScaleLossOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    scale_loss, ops::ScaleLossKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::ScaleLossKernel<paddle::platform::CPUDeviceContext, double>);
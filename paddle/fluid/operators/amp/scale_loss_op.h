@@ -0,0 +1,42 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include "paddle/fluid/framework/eigen.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/amp/loss_scaling.h"
+
+namespace paddle {
+namespace operators {
+
+template <typename DeviceContext, typename T>
+class ScaleLossKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* x = ctx.Input<framework::Tensor>("X");
+    auto* out = ctx.Output<framework::Tensor>("Out");
+    float scale = GetScalar<float>(ctx.Input<framework::Tensor>("LossScaling"),
+                                   ctx.Attr<float>("init_loss_scaling"));
+
+    out->mutable_data<T>(ctx.GetPlace());
+    auto eigen_x = framework::EigenVector<T>::Flatten(*x);
+    auto eigen_out = framework::EigenVector<T>::Flatten(*out);
+    auto& dev = *ctx.template device_context<DeviceContext>().eigen_device();
+    eigen_out.device(dev) = eigen_x * static_cast<T>(scale);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,112 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/amp/update_loss_scaling_op.h"
+
+namespace paddle {
+namespace operators {
+
+class UpdateLossScalingOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    for (auto* name : {"FoundInfinite", "PrevLossScaling", "InGoodSteps",
+                       "InBadSteps"}) {
+      PADDLE_ENFORCE(ctx->HasInput(name),
+                     "Input(%s) of UpdateLossScalingOp should not be null.",
+                     name);
+    }
+    for (auto* name : {"LossScaling", "OutGoodSteps", "OutBadSteps"}) {
+      PADDLE_ENFORCE(ctx->HasOutput(name),
+                     "Output(%s) of UpdateLossScalingOp should not be null.",
+                     name);
+      ctx->SetOutputDim(name, {1});
+    }
+  }
+
+ protected:
+  // The states may not be initialized before the first update.
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(framework::proto::VarType::FP32,
+                                   ctx.GetPlace());
+  }
+};
+
+class UpdateLossScalingOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("FoundInfinite",
+             "(Tensor) A bool scalar, whether the gradients of this step "
+             "have Inf or Nan.");
+    AddInput("PrevLossScaling",
+             "(Tensor) A float scalar, the loss scaling of this step.");
+    AddInput("InGoodSteps",
+             "(Tensor) An int scalar, the number of the finite steps since "
+             "the last update of the loss scaling.");
+    AddInput("InBadSteps",
+             "(Tensor) An int scalar, the number of the overflowed steps "
+             "since the last update of the loss scaling.");
+    AddOutput("LossScaling",
+              "(Tensor) The loss scaling of the next step. It can be the same "
+              "variable as Input(PrevLossScaling).");
+    AddOutput("OutGoodSteps", "(Tensor) The updated InGoodSteps.");
+    AddOutput("OutBadSteps", "(Tensor) The updated InBadSteps.");
+    AddAttr<float>("init_loss_scaling",
+                   "(float, default 32768) The loss scaling used when "
+                   "Input(PrevLossScaling) is not initialized.")
+        .SetDefault(32768.0f);
+    AddAttr<int>("incr_every_n_steps",
+                 "(int, default 1000) Increase the loss scaling after this "
+                 "number of consecutive finite steps.")
+        .SetDefault(1000);
+    AddAttr<int>("decr_every_n_nan_or_inf",
+                 "(int, default 2) Decrease the loss scaling after this "
+                 "number of consecutive overflowed steps.")
+        .SetDefault(2);
+    AddAttr<float>("incr_ratio",
+                   "(float, default 2) The ratio to increase the loss "
+                   "scaling by.")
+        .SetDefault(2.0f);
+    AddAttr<float>("decr_ratio",
+                   "(float, default 0.5) The ratio to decrease the loss "
+                   "scaling by. The loss scaling is at least 1.")
+        .SetDefault(0.5f);
+    AddComment(R"DOC(
+Update Loss Scaling Operator.
+
+Update the loss scaling of the dynamic loss scaling by whether the gradients
+of this step have overflowed. The loss scaling is multiplied by incr_ratio
+after incr_every_n_steps finite steps in a row, and by decr_ratio after
+decr_every_n_nan_or_inf overflowed steps in a row, so it stays about the
+largest value with which the float16 gradients do not overflow.
+
+The inputs are read on the host. Any of them except Input(FoundInfinite) can
+be uninitialized, which means the initial state.
+
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(update_loss_scaling, ops::UpdateLossScalingOp,
+                  ops::UpdateLossScalingOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    update_loss_scaling,
+    ops::UpdateLossScalingKernel<paddle::platform::CPUDeviceContext, float>);
@@ -0,0 +1,65 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/amp/loss_scaling.h"
+
+namespace paddle {
+namespace operators {
+
+template <typename DeviceContext, typename T>
+class UpdateLossScalingKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    using framework::Tensor;
+    bool found_inf = GetScalar<bool>(ctx.Input<Tensor>("FoundInfinite"), false);
+    auto init_loss_scaling =
+        static_cast<T>(ctx.Attr<float>("init_loss_scaling"));
+    T scale =
+        GetScalar<T>(ctx.Input<Tensor>("PrevLossScaling"), init_loss_scaling);
+    int good_steps = GetScalar<int>(ctx.Input<Tensor>("InGoodSteps"), 0);
+    int bad_steps = GetScalar<int>(ctx.Input<Tensor>("InBadSteps"), 0);
+
+    if (found_inf) {
+      good_steps = 0;
+      if (++bad_steps >= ctx.Attr<int>("decr_every_n_nan_or_inf")) {
+        auto decr_ratio = static_cast<T>(ctx.Attr<float>("decr_ratio"));
+        scale = std::max(scale * decr_ratio, static_cast<T>(1));
+        bad_steps = 0;
+      }
+    } else {
+      bad_steps = 0;
+      if (++good_steps >= ctx.Attr<int>("incr_every_n_steps")) {
+        T new_scale = scale * static_cast<T>(ctx.Attr<float>("incr_ratio"));
+        if (std::isfinite(new_scale)) {
+          scale = new_scale;
+        }
+        good_steps = 0;
+      }
+    }
+
+    SetScalar<T>(scale, ctx.GetPlace(), ctx.Output<Tensor>("LossScaling"));
+    SetScalar<int>(good_steps, ctx.GetPlace(),
+                   ctx.Output<Tensor>("OutGoodSteps"));
+    SetScalar<int>(bad_steps, ctx.GetPlace(),
+                   ctx.Output<Tensor>("OutBadSteps"));
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
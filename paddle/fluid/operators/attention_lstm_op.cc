@@ -13,11 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/attention_lstm_op.h"
+#include <cstring>
 #include <string>
+#include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/operators/math/blas.h"
-#include "paddle/fluid/operators/math/cpu_vec.h"
 #include "paddle/fluid/operators/math/fc_compute.h"
-#include "paddle/fluid/platform/cpu_info.h"
 
 namespace paddle {
 namespace operators {
@@ -227,31 +227,21 @@ use lstm_x_t as input and compute as standard LSTM.
 }
 
 // y[i] = (x[i] + bias[0]) > 0 ? (x[i] + bias[0]) : 0;
+// The gates of LSTMWeight and LSTMBias are [forget, input, output, tilde],
+// while the jit lstm kernels take [tilde, input, forget, output]. Reorder the
+// column blocks of the (rows x 4D) src once, so that each step can call the
+// jit kernel directly.
 template <typename T>
-inline void bias_relu(const int n, const T* x, const T* bias, T* y) {
-  if (bias) {
-    math::vec_add_bias<T, platform::avx>(n, *bias, x, y);
-    math::vec_relu<T, platform::avx>(n, y, y);
-  } else {
-    math::vec_relu<T, platform::avx>(n, x, y);
-  }
-}
-
-template <typename T>
-inline void vec_softmax(const int n, const T* x, T* y) {
-  T scalar = x[0];
-  // max
-  for (int i = 1; i < n; ++i) {
-    scalar = scalar < x[i] ? x[i] : scalar;
-  }
-  math::vec_add_bias<T, platform::avx>(n, -scalar, x, y);  // sub
-  math::vec_exp<T>(n, y, y);                               // exp
-  // sum
-  scalar = T(0);
-  for (int i = 0; i < n; ++i) {
-    scalar += y[i];
+inline void ReorderGates(const int rows, const int D, const T* src, T* dst) {
+  // the source block of each destination block
+  const int src_blocks[4] = {3, 1, 0, 2};
+  const int D4 = D * 4;
+  for (int r = 0; r < rows; ++r) {
+    for (int b = 0; b < 4; ++b) {
+      std::memcpy(dst + r * D4 + b * D, src + r * D4 + src_blocks[b] * D,
+                  sizeof(T) * D);
+    }
   }
-  math::vec_scal<T>(n, static_cast<T>(1) / scalar, y);  // scale
 }
 
 template <typename T>
@@ -285,8 +275,6 @@ class AttentionLSTMKernel : public framework::OpKernel<T> {
     const int total_T = x_dims[0];
     const int M = x_dims[1];      // x frame size
     const int D = w_dims[1] / 4;  // gate frame size
-    const int D2 = D * 2;
-    const int D3 = D * 3;
     const int D4 = w_dims[1];
     int max_seq_len = x_lod[0][1];
     for (int i = 1; i < N; ++i) {
@@ -297,27 +285,18 @@ class AttentionLSTMKernel : public framework::OpKernel<T> {
     PADDLE_ENFORCE_EQ(c0->dims()[0], N, "C0 dims should be %d x %d.", N, D);
     fc_out->Resize({max_seq_len, 1});
 
-    std::function<void(const int, const T *, T *)> act_gate, act_cell, act_cand;
-    auto& act_gate_str = ctx.Attr<std::string>("gate_activation");
-    auto& act_cell_str = ctx.Attr<std::string>("cell_activation");
-    auto& act_cand_str = ctx.Attr<std::string>("candidate_activation");
-    if (platform::MayIUse(platform::avx)) {
-      math::VecActivations<T, platform::avx> act_functor;
-      act_gate = act_functor(act_gate_str);
-      act_cell = act_functor(act_cell_str);
-      act_cand = act_functor(act_cand_str);
-    } else {
-      math::VecActivations<T, platform::isa_any> act_functor;
-      act_gate = act_functor(act_gate_str);
-      act_cell = act_functor(act_cell_str);
-      act_cand = act_functor(act_cand_str);
-    }
+    const jit::lstm_attr_t attr(
+        D, jit::to_kerneltype(ctx.Attr<std::string>("gate_activation")),
+        jit::to_kerneltype(ctx.Attr<std::string>("candidate_activation")),
+        jit::to_kerneltype(ctx.Attr<std::string>("cell_activation")));
+    auto compute_lstm =
+        jit::Get<jit::kLSTMCtHt, jit::LSTMTuples<T>, platform::CPUPlace>(attr);
+    auto compute_vadd =
+        jit::Get<jit::kVAdd, jit::XYZNTuples<T>, platform::CPUPlace>(D4);
 
     const T* x_data = x->data<T>();
     const T* h0_data = h0 ? h0->data<T>() : NULL;
     const T* c0_data = c0->data<T>();
-    const T* lstm_w_data = lstm_w->data<T>();
-    const T* lstm_b_data = lstm_b->data<T>();
     const T* atten_w_data = atten_w->data<T>();
     const T* atten_b_data = atten_b ? atten_b->data<T>() : NULL;
     const T* atten_scalar_data = atten_scalar ? atten_scalar->data<T>() : NULL;
@@ -331,6 +310,24 @@ class AttentionLSTMKernel : public framework::OpKernel<T> {
     T* lstm_x_data = lstm_x->mutable_data<T>(ctx.GetPlace());
     T* lstm_out_data = lstm_out->mutable_data<T>(ctx.GetPlace());
 
+    Tensor reordered_w, reordered_b;
+    T* lstm_w_data = reordered_w.mutable_data<T>(w_dims, ctx.GetPlace());
+    T* lstm_b_data = reordered_b.mutable_data<T>({1, D4}, ctx.GetPlace());
+    ReorderGates<T>(D + M, D, lstm_w->data<T>(), lstm_w_data);
+    ReorderGates<T>(1, D, lstm_b->data<T>(), lstm_b_data);
+    const T* lstm_wx_data = lstm_w_data + D * D4;
+
+    // lstm_x(1xM) * Wx(Mx4D) = fc_out(1 x seq_len) * (x_seq(seq_len x M) * Wx),
+    // so x_seq * Wx of all the steps can be computed by one GEMM in advance.
+    // It takes seq_len^2 * (4D - M) more flops for one sequence, so only do it
+    // when 4D <= M, which is still faster for GEMM than GEMV of each step.
+    const bool batch_x_fc = D4 <= M;
+    Tensor xw;
+    T* xw_data = nullptr;
+    if (batch_x_fc) {
+      xw_data = xw.mutable_data<T>({max_seq_len, D4}, ctx.GetPlace());
+    }
+
     // x(TxM) * fc (Mx1) part of atten_wgt(M+D)x1
     auto blas = math::GetBlas<DeviceContext, T>(ctx);
     math::FCCompute<DeviceContext, T>(blas, total_T, 1, M, x_data, atten_w_data,
@@ -342,58 +339,73 @@ class AttentionLSTMKernel : public framework::OpKernel<T> {
     const T* prev_hidden_data = NULL;
     T* cur_cell_out_data = cell_out_data;
     T* cur_hidden_out_data = hidden_out_data;
+    jit::lstm_t step_data;
     for (int i = 0; i < N; ++i) {
       int seq_len = x_lod[0][i + 1] - x_lod[0][i];
       prev_cell_data = c0_data + i * D;
       prev_hidden_data = h0_data ? h0_data + i * D : NULL;
+      // the attention scores are computed over the whole sequence
+      auto compute_addbias =
+          jit::Get<jit::kVAddBias, jit::AXYNTuples<T>, platform::CPUPlace>(
+              seq_len);
+      auto compute_relu =
+          jit::Get<jit::kVRelu, jit::XYNTuples<T>, platform::CPUPlace>(seq_len);
+      auto compute_scal =
+          jit::Get<jit::kVScal, jit::AXYNTuples<T>, platform::CPUPlace>(
+              seq_len);
+      auto compute_softmax =
+          jit::Get<jit::kSoftmax, jit::SoftmaxTuples<T>, platform::CPUPlace>(
+              seq_len);
+      if (batch_x_fc) {
+        blas.MatMul(seq_len, D4, M, cur_x_data, lstm_wx_data, xw_data);
+      }
       for (int step = 0; step < seq_len; ++step) {
         /// 1. compute attention vector
         // 1a. prev_cell(1xD) * fc(D) rest part of atten_wgt
         T prev_cell_bias = blas.DOT(D, prev_cell_data, atten_w_data + M);
         // 1b. add cell bias and relu
-        bias_relu<T>(seq_len, cur_atten_x_data, &prev_cell_bias, fc_out_data);
+        compute_addbias(&prev_cell_bias, cur_atten_x_data, fc_out_data,
+                        seq_len);
+        compute_relu(fc_out_data, fc_out_data, seq_len);
         // 1c. fc scalar
         if (atten_scalar_data) {
-          blas.SCAL(seq_len, *atten_scalar_data, fc_out_data);
-          bias_relu<T>(seq_len, fc_out_data, atten_scalar_bias_data,
-                       fc_out_data);
+          compute_scal(atten_scalar_data, fc_out_data, fc_out_data, seq_len);
+          if (atten_scalar_bias_data) {
+            compute_addbias(atten_scalar_bias_data, fc_out_data, fc_out_data,
+                            seq_len);
+          }
+          compute_relu(fc_out_data, fc_out_data, seq_len);
         }
         // 1d. softmax
-        vec_softmax<T>(seq_len, fc_out_data, fc_out_data);
-        // mul x(seq_len*M) and sum pool
-        math::FCCompute<DeviceContext, T>(blas, 1, M, seq_len, fc_out_data,
-                                          cur_x_data, lstm_x_data);
+        compute_softmax(fc_out_data, fc_out_data, seq_len, 1);
 
         /// 2. compute LSTM step
-        // lstm weight : concat[forget , input , output , tilde]
+        // lstm weight : concat[tilde, input, forget, output] after reordered
         // shape : (D + M) x (4 * D)
         // fc inputX(1xM) * weightX(M*(4D))  => 1 x 4D
-        blas.MatMul(1, D4, M, lstm_x_data, lstm_w_data + D * D4, lstm_out_data);
+        if (batch_x_fc) {
+          math::FCCompute<DeviceContext, T>(blas, 1, D4, seq_len, fc_out_data,
+                                            xw_data, lstm_out_data);
+        } else {
+          // mul x(seq_len*M) and sum pool
+          math::FCCompute<DeviceContext, T>(blas, 1, M, seq_len, fc_out_data,
+                                            cur_x_data, lstm_x_data);
+          blas.MatMul(1, D4, M, lstm_x_data, lstm_wx_data, lstm_out_data);
+        }
         if (prev_hidden_data) {
           blas.GEMM(CblasNoTrans, CblasNoTrans, 1, D4, D, static_cast<T>(1),
                     prev_hidden_data, D, lstm_w_data, D4, static_cast<T>(1),
                     lstm_out_data, D4);
         }
         // since input is 1xM, so can use add bias
-        blas.VADD(D4, lstm_b_data, lstm_out_data, lstm_out_data);
-
-        // gate act: sigmoid
-        act_gate(D3, lstm_out_data, lstm_out_data);
-        // candicate act: tanh
-        act_cand(D, lstm_out_data + D3, lstm_out_data + D3);
-
-        // a = forget * prev_cell
-        blas.VMUL(D, lstm_out_data, prev_cell_data, lstm_out_data);
-
-        // b = input * tilde
-        blas.VMUL(D, lstm_out_data + D, lstm_out_data + D3, lstm_out_data + D);
-
-        // cell_out = a + b
-        blas.VADD(D, lstm_out_data, lstm_out_data + D, cur_cell_out_data);
-
-        // state act tanh(cell_out) * output_gate
-        act_cell(D, cur_cell_out_data, lstm_out_data);
-        blas.VMUL(D, lstm_out_data, lstm_out_data + D2, cur_hidden_out_data);
+        compute_vadd(lstm_b_data, lstm_out_data, lstm_out_data, D4);
+
+        // gates act, cell_out and hidden_out by the jit lstm kernel
+        step_data.gates = lstm_out_data;
+        step_data.ct_1 = prev_cell_data;
+        step_data.ct = cur_cell_out_data;
+        step_data.ht = cur_hidden_out_data;
+        compute_lstm(&step_data, &attr);
 
         prev_hidden_data = cur_hidden_out_data;
         prev_cell_data = cur_cell_out_data;
@@ -16,6 +16,7 @@ limitations under the License. */
 #include <string>
 
 #include "paddle/fluid/operators/beam_search_decode_op.h"
+#include "paddle/fluid/operators/math/beam_search.h"
 #include "paddle/fluid/platform/device_context.h"
 
 namespace paddle {
@@ -33,6 +34,8 @@ struct BeamSearchDecodeFunctor {
         id_tensor_(id_tensor),
         score_tensor_(score_tensor) {
     tensor_on_gpu_ = false;
+    backtrace_on_gpu_ = CanBacktraceOnGPU();
+    if (backtrace_on_gpu_) return;
     // First make a copy of GPU data on CPU
     if (platform::is_gpu_place(step_ids_origin_[0].place())) {
       tensor_on_gpu_ = true;
@@ -73,10 +76,34 @@ struct BeamSearchDecodeFunctor {
     }
   }
 
+  // The steps are walked back on GPU if all of them are on GPU and the scores
+  // are float or double, otherwise they are copied to CPU.
+  bool CanBacktraceOnGPU() const {
+#ifdef PADDLE_WITH_CUDA
+    auto score_type = step_scores_origin_[0].type();
+    if (score_type != framework::proto::VarType::FP32 &&
+        score_type != framework::proto::VarType::FP64) {
+      return false;
+    }
+    for (size_t i = 0; i < step_ids_origin_.size(); ++i) {
+      auto& ids = step_ids_origin_[i];
+      auto& scores = step_scores_origin_[i];
+      if ((ids.numel() > 0 && !platform::is_gpu_place(ids.place())) ||
+          (scores.numel() > 0 && !platform::is_gpu_place(scores.place()))) {
+        return false;
+      }
+    }
+    return platform::is_gpu_place(step_ids_origin_[0].place());
+#else
+    return false;
+#endif
+  }
+
   template <typename T>
   void apply() const;
 
   bool tensor_on_gpu_;
+  bool backtrace_on_gpu_;
   size_t beam_size_;
   int end_id_;
   // TODO(Superjomn) Here might result serious performance issue in the
@@ -90,8 +117,50 @@ struct BeamSearchDecodeFunctor {
   LoDTensor* score_tensor_;
 };
 
+#ifdef PADDLE_WITH_CUDA
+template <typename T>
+void BacktraceOnGPU(const platform::CUDADeviceContext& dev_ctx,
+                    const LoDTensorArray& step_ids,
+                    const LoDTensorArray& step_scores, LoDTensor* id_tensor,
+                    LoDTensor* score_tensor, size_t beam_size, int end_id) {
+  PADDLE_THROW("beam search decode op only supports float and double on GPU");
+}
+
+template <>
+void BacktraceOnGPU<float>(const platform::CUDADeviceContext& dev_ctx,
+                           const LoDTensorArray& step_ids,
+                           const LoDTensorArray& step_scores,
+                           LoDTensor* id_tensor, LoDTensor* score_tensor,
+                           size_t beam_size, int end_id) {
+  math::BeamSearchBacktraceFunctor<float>()(dev_ctx, step_ids, step_scores,
+                                            id_tensor, score_tensor,
+                                            beam_size, end_id);
+}
+
+template <>
+void BacktraceOnGPU<double>(const platform::CUDADeviceContext& dev_ctx,
+                            const LoDTensorArray& step_ids,
+                            const LoDTensorArray& step_scores,
+                            LoDTensor* id_tensor, LoDTensor* score_tensor,
+                            size_t beam_size, int end_id) {
+  math::BeamSearchBacktraceFunctor<double>()(dev_ctx, step_ids, step_scores,
+                                             id_tensor, score_tensor,
+                                             beam_size, end_id);
+}
+#endif
+
 template <typename T>
 void BeamSearchDecodeFunctor::apply() const {
+#ifdef PADDLE_WITH_CUDA
+  if (backtrace_on_gpu_) {
+    auto* dev_ctx = static_cast<platform::CUDADeviceContext*>(
+        platform::DeviceContextPool::Instance().Get(
+            step_ids_origin_[0].place()));
+    BacktraceOnGPU<T>(*dev_ctx, step_ids_origin_, step_scores_origin_,
+                      id_tensor_, score_tensor_, beam_size_, end_id_);
+    return;
+  }
+#endif
   BeamSearchDecoder<T> beam_search_decoder(beam_size_, end_id_);
   // Check if the tensor is on GPU. If so, use the CPU copy instead
   if (tensor_on_gpu_) {
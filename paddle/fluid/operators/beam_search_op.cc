@@ -17,6 +17,7 @@ limitations under the License. */
 #include <string>
 #include <vector>
 
+#include "paddle/fluid/framework/compute_pool.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/beam_search_op.h"
@@ -124,20 +125,30 @@ std::vector<std::vector<BeamSearch::Item>> BeamSearch::ToMap(
 std::vector<std::vector<BeamSearch::Item>> BeamSearch::SelectTopBeamSizeItems(
     const framework::LoDTensor &pre_ids,
     const framework::LoDTensor &pre_scores) {
-  std::vector<std::vector<Item>> result;
-  std::vector<Item> items;
+  size_t num_sents = ids_->NumElements(lod_level_);
+  size_t first_sent = std::min(sent_offset_, num_sents);
+  std::vector<std::vector<Item>> result(num_sents - first_sent);
   // for each source sentence, select the top beam_size items across all
-  // candidate sets.
-  while (NextItemSet(pre_ids, pre_scores, &items)) {
-    std::nth_element(
-        std::begin(items), std::begin(items) + beam_size_, std::end(items),
-        [](const Item &a, const Item &b) { return a.score > b.score; });
-    // prune the top beam_size items.
-    if (items.size() > beam_size_) {
-      items.resize(beam_size_);
-    }
-    result.emplace_back(items);
-  }
+  // candidate sets, the sentences are independent of each other.
+  int64_t avg_items =
+      framework::product(ids_->dims()) / std::max<size_t>(num_sents, 1);
+  framework::ParallelFor(
+      0, static_cast<int64_t>(result.size()), framework::GrainSize(avg_items),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          auto &items = result[i];
+          GetItemSet(first_sent + i, pre_ids, pre_scores, &items);
+          std::nth_element(
+              std::begin(items), std::begin(items) + beam_size_,
+              std::end(items),
+              [](const Item &a, const Item &b) { return a.score > b.score; });
+          // prune the top beam_size items.
+          if (items.size() > beam_size_) {
+            items.resize(beam_size_);
+          }
+        }
+      });
+  sent_offset_ = num_sents;
   VLOG(3) << "SelectTopBeamSizeItems result size " << result.size();
   for (auto &items : result) {
     VLOG(3) << "item set:";
@@ -156,6 +167,14 @@ bool BeamSearch::NextItemSet(const framework::LoDTensor &pre_ids,
   if (sent_offset_ >= ids_->NumElements(lod_level_)) {
     return false;
   }
+  GetItemSet(sent_offset_, pre_ids, pre_scores, items);
+  sent_offset_++;
+  return true;
+}
+
+void BeamSearch::GetItemSet(size_t sent, const framework::LoDTensor &pre_ids,
+                            const framework::LoDTensor &pre_scores,
+                            std::vector<BeamSearch::Item> *items) const {
   // find the current candidates
   auto ids = *ids_;
   auto scores = *scores_;
@@ -172,10 +191,11 @@ bool BeamSearch::NextItemSet(const framework::LoDTensor &pre_ids,
 
   auto *pre_ids_data = pre_ids.data<int64_t>();
   auto *pre_scores_data = pre_scores.data<float>();
+  size_t begin = abs_lod[lod_level_][sent];
+  size_t end = abs_lod[lod_level_][sent + 1];
   items->clear();
-  items->reserve(framework::product(ids.dims()));
-  for (size_t offset = abs_lod[lod_level_][sent_offset_];
-       offset < abs_lod[lod_level_][sent_offset_ + 1]; offset++) {
+  items->reserve((end - begin) * instance_dim);
+  for (size_t offset = begin; offset < end; offset++) {
     auto pre_id = pre_ids_data[offset];
     auto pre_score = pre_scores_data[offset];
     if (pre_id == end_id_) {
@@ -190,9 +210,6 @@ bool BeamSearch::NextItemSet(const framework::LoDTensor &pre_ids,
       }
     }
   }
-
-  sent_offset_++;
-  return true;
 }
 
 std::ostream &operator<<(std::ostream &os, const BeamSearch::Item &item) {
@@ -282,8 +299,7 @@ class BeamSearchOp : public framework::OperatorWithKernel {
   framework::OpKernelType GetExpectedKernelType(
       const framework::ExecutionContext &ctx) const override {
     framework::OpKernelType kt = framework::OpKernelType(
-        ctx.Input<framework::LoDTensor>("pre_ids")->type(),
-        platform::CPUPlace());
+        ctx.Input<framework::LoDTensor>("pre_ids")->type(), ctx.GetPlace());
     return kt;
   }
 };
@@ -183,6 +183,11 @@ class BeamSearch {
                    std::vector<Item>* items);
 
  private:
+  // Get the items of the source sequence sent.
+  void GetItemSet(size_t sent, const framework::LoDTensor& pre_ids,
+                  const framework::LoDTensor& pre_scores,
+                  std::vector<Item>* items) const;
+
   size_t beam_size_;
   const framework::LoDTensor* ids_;
   const framework::LoDTensor* scores_;
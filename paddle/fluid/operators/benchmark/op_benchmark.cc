@@ -0,0 +1,477 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/fluid/framework/data_transform.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_cost.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/platform/device_tracer.h"
+#include "paddle/fluid/platform/init.h"
+#include "paddle/fluid/pybind/pybind.h"
+#include "paddle/fluid/string/printf.h"
+#include "paddle/fluid/string/split.h"
+
+DEFINE_string(op_type, "", "The type of the op to benchmark.");
+DEFINE_string(attrs, "",
+              "The attributes of the op, e.g. \"x_num_col_dims=1;axis=-1\", "
+              "the list attributes are separated by comma.");
+DEFINE_string(input_shapes, "",
+              "The shapes of the inputs, e.g. \"X=32,64;Y=64,128\". The "
+              "shapes of the sweep are separated by '|', e.g. "
+              "\"X=32,64;Y=64,128|X=64,64;Y=64,128\".");
+DEFINE_string(input_dtypes, "",
+              "The data types of the inputs, e.g. \"Ids=int64\", the inputs "
+              "not listed are float32.");
+DEFINE_int64(int_upper, 1,
+             "The integer inputs are uniform in [0, int_upper), e.g. the "
+             "vocabulary size of the ids.");
+DEFINE_int32(burning, 10, "Burning times.");
+DEFINE_int32(repeat, 100, "Repeat times.");
+
+namespace paddle {
+namespace operators {
+namespace benchmark {
+
+using framework::DDim;
+using framework::LoDTensor;
+using framework::OpKernelType;
+using framework::proto::AttrType;
+using framework::proto::VarType;
+
+static std::map<std::string, std::string> ParseKeyValues(
+    const std::string& str) {
+  std::map<std::string, std::string> result;
+  for (auto& item : string::Split(str, ';')) {
+    if (item.empty()) continue;
+    auto pos = item.find('=');
+    PADDLE_ENFORCE(pos != std::string::npos, "Invalid item %s, need key=value",
+                   item);
+    result[item.substr(0, pos)] = item.substr(pos + 1);
+  }
+  return result;
+}
+
+template <typename T, typename Func>
+static std::vector<T> ParseList(const std::string& str, Func parse) {
+  std::vector<T> result;
+  for (auto& item : string::Split(str, ',')) {
+    result.push_back(parse(item));
+  }
+  return result;
+}
+
+static bool ParseBool(const std::string& str) {
+  return str == "true" || str == "1";
+}
+
+static framework::Attribute ParseAttr(AttrType type, const std::string& str) {
+  auto to_int = [](const std::string& s) { return std::stoi(s); };
+  auto to_int64 = [](const std::string& s) {
+    return static_cast<int64_t>(std::stoll(s));
+  };
+  auto to_float = [](const std::string& s) { return std::stof(s); };
+  auto to_string = [](const std::string& s) { return s; };
+  switch (type) {
+    case AttrType::INT:
+      return to_int(str);
+    case AttrType::LONG:
+      return to_int64(str);
+    case AttrType::FLOAT:
+      return to_float(str);
+    case AttrType::STRING:
+      return str;
+    case AttrType::BOOLEAN:
+      return ParseBool(str);
+    case AttrType::INTS:
+      return ParseList<int>(str, to_int);
+    case AttrType::LONGS:
+      return ParseList<int64_t>(str, to_int64);
+    case AttrType::FLOATS:
+      return ParseList<float>(str, to_float);
+    case AttrType::STRINGS:
+      return ParseList<std::string>(str, to_string);
+    case AttrType::BOOLEANS:
+      return ParseList<bool>(str, ParseBool);
+    default:
+      PADDLE_THROW("Unsupported attribute type %d", type);
+  }
+}
+
+static VarType::Type ParseDataType(const std::string& str) {
+  if (str == "float32") return VarType::FP32;
+  if (str == "float64") return VarType::FP64;
+  if (str == "int32") return VarType::INT32;
+  if (str == "int64") return VarType::INT64;
+  PADDLE_THROW("Unsupported data type %s", str);
+}
+
+template <typename T>
+static void FillTensor(LoDTensor* tensor, std::mt19937* rng) {
+  auto* data = tensor->data<T>();
+  if (std::is_floating_point<T>::value) {
+    std::uniform_real_distribution<double> dist(-1, 1);
+    for (int64_t i = 0; i < tensor->numel(); ++i) {
+      data[i] = static_cast<T>(dist(*rng));
+    }
+  } else {
+    std::uniform_int_distribution<int64_t> dist(0, FLAGS_int_upper - 1);
+    for (int64_t i = 0; i < tensor->numel(); ++i) {
+      data[i] = static_cast<T>(dist(*rng));
+    }
+  }
+}
+
+static void RandomTensor(const DDim& dims, VarType::Type type,
+                         LoDTensor* tensor, std::mt19937* rng) {
+  tensor->Resize(dims);
+  tensor->mutable_data(platform::CPUPlace(), type);
+  switch (type) {
+    case VarType::FP32:
+      FillTensor<float>(tensor, rng);
+      break;
+    case VarType::FP64:
+      FillTensor<double>(tensor, rng);
+      break;
+    case VarType::INT32:
+      FillTensor<int>(tensor, rng);
+      break;
+    case VarType::INT64:
+      FillTensor<int64_t>(tensor, rng);
+      break;
+    default:
+      PADDLE_THROW("Unsupported data type %d", type);
+  }
+}
+
+// The max absolute and relative difference between two tensors.
+struct Diff {
+  double abs{0};
+  double rel{0};
+};
+
+template <typename T>
+static void CompareTensor(const LoDTensor& a, const LoDTensor& b, Diff* diff) {
+  auto* x = a.data<T>();
+  auto* y = b.data<T>();
+  for (int64_t i = 0; i < a.numel(); ++i) {
+    double d = std::fabs(static_cast<double>(x[i]) - static_cast<double>(y[i]));
+    double base = std::max(std::fabs(static_cast<double>(x[i])), 1e-6);
+    diff->abs = std::max(diff->abs, d);
+    diff->rel = std::max(diff->rel, d / base);
+  }
+}
+
+static void UpdateDiff(const LoDTensor& a, const LoDTensor& b, Diff* diff) {
+  if (a.dims() != b.dims() || a.type() != b.type()) {
+    diff->abs = diff->rel = INFINITY;
+    return;
+  }
+  switch (a.type()) {
+    case VarType::FP32:
+      CompareTensor<float>(a, b, diff);
+      break;
+    case VarType::FP64:
+      CompareTensor<double>(a, b, diff);
+      break;
+    case VarType::INT32:
+      CompareTensor<int>(a, b, diff);
+      break;
+    case VarType::INT64:
+      CompareTensor<int64_t>(a, b, diff);
+      break;
+    default:
+      break;
+  }
+}
+
+static size_t TensorBytes(const LoDTensor& tensor) {
+  if (!tensor.IsInitialized()) return 0;
+  return tensor.numel() * framework::SizeOfType(tensor.type());
+}
+
+// Share or transform the CPU input to the tensor the kernel expects.
+static void PrepareInput(const LoDTensor& src, const OpKernelType& kernel,
+                         LoDTensor* dst) {
+  OpKernelType src_type(src.type(), src.place(), src.layout());
+  OpKernelType dst_type(src.type(), kernel.place_, kernel.data_layout_,
+                        kernel.library_type_);
+  if (framework::NeedTransform(src_type, dst_type)) {
+    framework::TransformData(dst_type, src_type, src, dst);
+  } else {
+    dst->ShareDataWith(src);
+  }
+  dst->set_lod(src.lod());
+}
+
+// Copy the output of the kernel back to a CPU tensor of the plain layout.
+static void FetchOutput(const LoDTensor& src, LoDTensor* dst) {
+  if (src.layout() == framework::DataLayout::kMKLDNN) {
+    OpKernelType src_type(src.type(), src.place(), src.layout(),
+                          framework::LibraryType::kMKLDNN);
+    OpKernelType dst_type(src.type(), platform::CPUPlace(),
+                          framework::DataLayout::kNCHW);
+    framework::TransformData(dst_type, src_type, src, dst);
+  } else {
+    framework::TensorCopySync(src, platform::CPUPlace(), dst);
+  }
+}
+
+struct KernelResult {
+  explicit KernelResult(const OpKernelType& kernel) : kernel(kernel) {}
+
+  OpKernelType kernel;
+  double time_us{0};
+  Diff diff;
+};
+
+class OpBenchmark {
+ public:
+  OpBenchmark(const std::string& op_type,
+              const std::map<std::string, std::string>& attrs,
+              const std::map<std::string, std::string>& dtypes)
+      : op_type_(op_type), dtypes_(dtypes) {
+    auto& info = framework::OpInfoMap::Instance().Get(op_type);
+    PADDLE_ENFORCE(info.HasOpProtoAndChecker(), "Op %s has no proto",
+                   op_type);
+    for (auto& attr : info.Proto().attrs()) {
+      attr_types_[attr.name()] = attr.type();
+    }
+    for (auto& item : attrs) {
+      PADDLE_ENFORCE(attr_types_.count(item.first), "Op %s has no attr %s",
+                     op_type, item.first);
+      attrs_[item.first] = ParseAttr(attr_types_[item.first], item.second);
+    }
+    PADDLE_ENFORCE(framework::OperatorWithKernel::AllOpKernels().count(op_type),
+                   "Op %s has no kernel", op_type);
+  }
+
+  // Run all the kernels of the data type of the op on the inputs of the
+  // shapes, the first kernel is the reference of the numeric diffs.
+  std::vector<KernelResult> Run(
+      const std::map<std::string, std::string>& shapes,
+      framework::OpCost* cost) {
+    auto& proto = framework::OpInfoMap::Instance().Get(op_type_).Proto();
+    framework::Scope scope;
+    framework::VariableNameMap inputs, outputs;
+    std::mt19937 rng(100);
+    for (auto& input : proto.inputs()) {
+      auto it = shapes.find(input.name());
+      if (it == shapes.end()) {
+        PADDLE_ENFORCE(input.dispensable(), "Please set the shape of input %s",
+                       input.name());
+        continue;
+      }
+      auto dtype = dtypes_.count(input.name())
+                       ? ParseDataType(dtypes_.at(input.name()))
+                       : VarType::FP32;
+      auto* tensor = scope.Var(input.name())->GetMutable<LoDTensor>();
+      RandomTensor(framework::make_ddim(ParseList<int>(
+                       it->second, [](const std::string& s) {
+                         return std::stoi(s);
+                       })),
+                   dtype, tensor, &rng);
+      inputs[input.name()] = {input.name()};
+    }
+    for (auto& output : proto.outputs()) {
+      outputs[output.name()] = {output.name() + "@OUT"};
+    }
+    auto op = framework::OpRegistry::CreateOp(op_type_, inputs, outputs,
+                                              attrs_);
+    auto* op_with_kernel =
+        dynamic_cast<framework::OperatorWithKernel*>(op.get());
+    PADDLE_ENFORCE_NOT_NULL(op_with_kernel);
+
+    // Only the kernels of the data type the op chooses by the inputs are
+    // benchmarked, the data types of the other kernels need the inputs cast.
+    auto data_type = ExpectedDataType(*op_with_kernel, scope);
+    std::vector<KernelResult> results;
+    std::map<std::string, LoDTensor> reference;
+    for (auto& kernel : Kernels(data_type)) {
+      KernelResult result(kernel);
+      auto& kernel_scope = scope.NewScope();
+      std::map<std::string, LoDTensor> fetched;
+      result.time_us = RunKernel(*op_with_kernel, scope, kernel, &kernel_scope,
+                                 &fetched, results.empty() ? cost : nullptr);
+      if (results.empty()) {
+        reference = fetched;
+      } else {
+        for (auto& item : reference) {
+          UpdateDiff(item.second, fetched[item.first], &result.diff);
+        }
+      }
+      results.push_back(result);
+      scope.DeleteScope(&kernel_scope);
+    }
+    return results;
+  }
+
+ private:
+  VarType::Type ExpectedDataType(const framework::OperatorWithKernel& op,
+                                 const framework::Scope& scope) const {
+    framework::Scope& tmp_scope = scope.NewScope();
+    for (auto& item : op.Outputs()) {
+      for (auto& name : item.second) {
+        tmp_scope.Var(name)->GetMutable<LoDTensor>();
+      }
+    }
+    framework::RuntimeContext ctx(op.Inputs(), op.Outputs(), tmp_scope);
+    auto* dev_ctx =
+        platform::DeviceContextPool::Instance().Get(platform::CPUPlace());
+    auto data_type =
+        op.GetExpectedKernelType(
+              framework::ExecutionContext(op, tmp_scope, *dev_ctx, ctx))
+            .data_type_;
+    scope.DeleteScope(&tmp_scope);
+    return data_type;
+  }
+
+  // The kernels of the data type, the plain CPU kernel first.
+  std::vector<OpKernelType> Kernels(VarType::Type data_type) const {
+    std::vector<OpKernelType> kernels;
+    for (auto& item :
+         framework::OperatorWithKernel::AllOpKernels().at(op_type_)) {
+      auto& kernel = item.first;
+      if (kernel.data_type_ != data_type) continue;
+#ifdef PADDLE_WITH_CUDA
+      if (platform::is_gpu_place(kernel.place_) &&
+          platform::GetCUDADeviceCount() == 0) {
+        continue;
+      }
+#endif
+      kernels.push_back(kernel);
+    }
+    PADDLE_ENFORCE(!kernels.empty(), "Op %s has no kernel of data type %d",
+                   op_type_, data_type);
+    auto rank = [](const OpKernelType& kernel) {
+      bool is_cpu = platform::is_cpu_place(kernel.place_);
+      bool is_plain = kernel.library_type_ == framework::LibraryType::kPlain;
+      return std::make_tuple(!(is_cpu && is_plain), !is_cpu,
+                             framework::KernelTypeToString(kernel));
+    };
+    std::sort(kernels.begin(), kernels.end(),
+              [&](const OpKernelType& a, const OpKernelType& b) {
+                return rank(a) < rank(b);
+              });
+    return kernels;
+  }
+
+  double RunKernel(const framework::OperatorWithKernel& op,
+                   const framework::Scope& scope, const OpKernelType& kernel,
+                   framework::Scope* kernel_scope,
+                   std::map<std::string, LoDTensor>* fetched,
+                   framework::OpCost* cost) const {
+    for (auto& item : op.Inputs()) {
+      for (auto& name : item.second) {
+        PrepareInput(scope.FindVar(name)->Get<LoDTensor>(), kernel,
+                     kernel_scope->Var(name)->GetMutable<LoDTensor>());
+      }
+    }
+    for (auto& item : op.Outputs()) {
+      for (auto& name : item.second) {
+        kernel_scope->Var(name)->GetMutable<LoDTensor>();
+      }
+    }
+    framework::RuntimeContext ctx(op.Inputs(), op.Outputs(), *kernel_scope);
+    op.RuntimeInferShape(*kernel_scope, kernel.place_, ctx);
+    auto* dev_ctx = platform::DeviceContextPool::Instance().Get(kernel.place_);
+    framework::ExecutionContext exe_ctx(op, *kernel_scope, *dev_ctx, ctx);
+    auto& kernel_func =
+        framework::OperatorWithKernel::AllOpKernels().at(op_type_).at(kernel);
+
+    for (int i = 0; i < FLAGS_burning; ++i) {
+      kernel_func(exe_ctx);
+    }
+    dev_ctx->Wait();
+    auto start = platform::PosixInNsec();
+    for (int i = 0; i < FLAGS_repeat; ++i) {
+      kernel_func(exe_ctx);
+    }
+    dev_ctx->Wait();
+    auto end = platform::PosixInNsec();
+
+    size_t bytes = 0;
+    for (auto* vars : {&op.Inputs(), &op.Outputs()}) {
+      for (auto& item : *vars) {
+        for (auto& name : item.second) {
+          auto& tensor = kernel_scope->FindVar(name)->Get<LoDTensor>();
+          bytes += TensorBytes(tensor);
+          if (tensor.IsInitialized() && vars == &op.Outputs()) {
+            FetchOutput(tensor, &(*fetched)[name]);
+          }
+        }
+      }
+    }
+    if (cost != nullptr &&
+        !framework::OpCostRegistry::Instance().GetCost(
+            op_type_, op.Inputs(), op.Outputs(), op.Attrs(), *kernel_scope,
+            cost)) {
+      cost->flops = 0;
+      cost->bytes = bytes;
+    }
+    return static_cast<double>(end - start) / FLAGS_repeat * 1e-3;
+  }
+
+  std::string op_type_;
+  std::map<std::string, std::string> dtypes_;
+  std::map<std::string, AttrType> attr_types_;
+  framework::AttributeMap attrs_;
+};
+
+void RunBenchmark() {
+  PADDLE_ENFORCE(!FLAGS_op_type.empty(), "Please set --op_type");
+  OpBenchmark benchmark(FLAGS_op_type, ParseKeyValues(FLAGS_attrs),
+                        ParseKeyValues(FLAGS_input_dtypes));
+  std::cout << string::Sprintf("%-24s %-80s %12s %10s %10s %12s %12s\n",
+                               "Shapes", "Kernel", "Time(us)", "GFLOP/s",
+                               "GB/s", "MaxAbsDiff", "MaxRelDiff");
+  for (auto& shapes : string::Split(FLAGS_input_shapes, '|')) {
+    framework::OpCost cost;
+    for (auto& result : benchmark.Run(ParseKeyValues(shapes), &cost)) {
+      double sec = result.time_us * 1e-6;
+      std::cout << string::Sprintf(
+          "%-24s %-80s %12.3f %10.3f %10.3f %12.6g %12.6g\n", shapes,
+          framework::KernelTypeToString(result.kernel), result.time_us,
+          cost.flops / sec * 1e-9, cost.bytes / sec * 1e-9, result.diff.abs,
+          result.diff.rel);
+    }
+  }
+}
+
+}  // namespace benchmark
+}  // namespace operators
+}  // namespace paddle
+
+// Benchmark all the kernels of one op on the shapes of the sweep, the numeric
+// diffs are against the plain CPU kernel, or the first kernel if it has none.
+// e.g. ./op_benchmark --op_type=mul --attrs="x_num_col_dims=1" \
+//          --input_shapes="X=32,64;Y=64,128|X=256,1024;Y=1024,1024"
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  paddle::framework::InitDevices(false);
+  paddle::operators::benchmark::RunBenchmark();
+  return 0;
+}
@@ -60,7 +60,7 @@ class ChunkEvalOp : public framework::OperatorWithKernel {
   framework::OpKernelType GetExpectedKernelType(
       const framework::ExecutionContext &ctx) const override {
     return framework::OpKernelType(framework::proto::VarType::FP32,
-                                   platform::CPUPlace());
+                                   ctx.device_context());
   }
 };
 
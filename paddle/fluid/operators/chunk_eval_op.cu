@@ -0,0 +1,214 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <thrust/binary_search.h>
+#include <thrust/execution_policy.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "cub/cub.cuh"
+#include "paddle/fluid/operators/chunk_eval_op.h"
+#include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+
+struct ChunkTags {
+  int num_tag_types;
+  int other_chunk_type;
+  int tag_begin;
+  int tag_inside;
+  int tag_end;
+  int tag_single;
+};
+
+// Whether a chunk of the sequence x begins at t, as if the sequence were
+// after a tag of other_chunk_type.
+__device__ __forceinline__ bool BeginsAt(const int64_t* x, int t,
+                                         const ChunkTags& tags) {
+  int prev_tag = -1;
+  int prev_type = tags.other_chunk_type;
+  if (t > 0) {
+    prev_tag = x[t - 1] % tags.num_tag_types;
+    prev_type = x[t - 1] / tags.num_tag_types;
+  }
+  return IsChunkBegin(prev_tag, prev_type, x[t] % tags.num_tag_types,
+                      x[t] / tags.num_tag_types, tags.other_chunk_type,
+                      tags.tag_begin, tags.tag_inside, tags.tag_end,
+                      tags.tag_single);
+}
+
+// Whether a chunk of the sequence x of length ends at t. A tag is in a
+// chunk if and only if its type is not other_chunk_type, for all the tag
+// types of a scheme.
+__device__ __forceinline__ bool EndsAt(const int64_t* x, int t, int length,
+                                       const ChunkTags& tags) {
+  int type = x[t] / tags.num_tag_types;
+  if (type == tags.other_chunk_type) return false;
+  if (t == length - 1) return true;
+  return IsChunkEnd(x[t] % tags.num_tag_types, type,
+                    x[t + 1] % tags.num_tag_types,
+                    x[t + 1] / tags.num_tag_types, tags.other_chunk_type,
+                    tags.tag_begin, tags.tag_inside, tags.tag_end,
+                    tags.tag_single);
+}
+
+__device__ __forceinline__ bool Excluded(int type, const int* excluded,
+                                         int num_excluded) {
+  for (int i = 0; i < num_excluded; ++i) {
+    if (excluded[i] == type) return true;
+  }
+  return false;
+}
+
+// Every position counts the chunks which end at it. The chunks of the
+// inference and the label ending at the same position are the same if they
+// begin at the same position, that is, their begins are the same since the
+// end back to the first begin of either one.
+template <int BlockDim>
+__global__ void KeCountChunks(const int64_t* inference, const int64_t* label,
+                              const size_t* lod, int num_seq, int64_t numel,
+                              ChunkTags tags, const int* excluded,
+                              int num_excluded, int64_t* counts) {
+  using BlockReduce = cub::BlockReduce<int64_t, BlockDim>;
+  __shared__ typename BlockReduce::TempStorage storage;
+  int64_t num_infer = 0;
+  int64_t num_label = 0;
+  int64_t num_correct = 0;
+  for (int64_t r = blockIdx.x * BlockDim + threadIdx.x; r < numel;
+       r += BlockDim * gridDim.x) {
+    int i = static_cast<int>(thrust::upper_bound(thrust::seq, lod,
+                                                 lod + num_seq + 1,
+                                                 static_cast<size_t>(r)) -
+                             lod - 1);
+    const int64_t* x = inference + lod[i];
+    const int64_t* y = label + lod[i];
+    int length = static_cast<int>(lod[i + 1] - lod[i]);
+    int t = static_cast<int>(r - lod[i]);
+    bool infer_end = EndsAt(x, t, length, tags);
+    bool label_end = EndsAt(y, t, length, tags);
+    int infer_type = x[t] / tags.num_tag_types;
+    int label_type = y[t] / tags.num_tag_types;
+    if (infer_end && !Excluded(infer_type, excluded, num_excluded)) {
+      ++num_infer;
+    }
+    if (label_end && !Excluded(label_type, excluded, num_excluded)) {
+      ++num_label;
+    }
+    if (infer_end && label_end && infer_type == label_type &&
+        !Excluded(infer_type, excluded, num_excluded)) {
+      bool same = false;
+      for (int k = t; k >= 0; --k) {
+        bool infer_begin = BeginsAt(x, k, tags);
+        if (infer_begin != BeginsAt(y, k, tags)) break;
+        if (infer_begin) {
+          same = true;
+          break;
+        }
+      }
+      if (same) ++num_correct;
+    }
+  }
+  num_infer = BlockReduce(storage).Reduce(num_infer, cub::Sum());
+  __syncthreads();
+  num_label = BlockReduce(storage).Reduce(num_label, cub::Sum());
+  __syncthreads();
+  num_correct = BlockReduce(storage).Reduce(num_correct, cub::Sum());
+  if (threadIdx.x == 0) {
+    platform::CudaAtomicAdd(counts, num_infer);
+    platform::CudaAtomicAdd(counts + 1, num_label);
+    platform::CudaAtomicAdd(counts + 2, num_correct);
+  }
+}
+
+template <typename T>
+__global__ void KeChunkMetrics(const int64_t* counts, T* precision, T* recall,
+                               T* f1, int64_t* num_infer_chunks,
+                               int64_t* num_label_chunks,
+                               int64_t* num_correct_chunks) {
+  int64_t num_infer = counts[0];
+  int64_t num_label = counts[1];
+  int64_t num_correct = counts[2];
+  T p = num_infer ? static_cast<T>(num_correct) / num_infer : 0;
+  T r = num_label ? static_cast<T>(num_correct) / num_label : 0;
+  *precision = p;
+  *recall = r;
+  *f1 = num_correct ? 2 * p * r / (p + r) : 0;
+  *num_infer_chunks = num_infer;
+  *num_label_chunks = num_label;
+  *num_correct_chunks = num_correct;
+}
+
+template <typename T>
+class ChunkEvalCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    ChunkTags tags;
+    GetChunkScheme(context.Attr<std::string>("chunk_scheme"),
+                   &tags.num_tag_types, &tags.tag_begin, &tags.tag_inside,
+                   &tags.tag_end, &tags.tag_single);
+    tags.other_chunk_type = context.Attr<int>("num_chunk_types");
+    auto excluded_attr = context.Attr<std::vector<int>>("excluded_chunk_types");
+    framework::Vector<int> excluded(excluded_attr);
+
+    auto* inference = context.Input<LoDTensor>("Inference");
+    auto* label = context.Input<LoDTensor>("Label");
+    auto lod = label->lod();
+    PADDLE_ENFORCE_EQ(lod.size(), 1UL, "Only support one level sequence now.");
+    PADDLE_ENFORCE(lod == inference->lod(),
+                   "LoD must be same between Inference and Label.");
+
+    auto place = context.GetPlace();
+    auto& dev_ctx =
+        context.template device_context<platform::CUDADeviceContext>();
+    framework::Tensor counts;
+    int64_t* counts_data = counts.mutable_data<int64_t>({3}, place);
+    math::SetConstant<platform::CUDADeviceContext, int64_t>()(
+        dev_ctx, &counts, static_cast<int64_t>(0));
+
+    int num_seq = static_cast<int>(lod[0].size() - 1);
+    int64_t numel = static_cast<int64_t>(lod[0].back());
+    if (numel > 0) {
+      constexpr int kThreads = 256;
+      int grids = static_cast<int>(std::min<int64_t>(
+          (numel + kThreads - 1) / kThreads,
+          std::max(dev_ctx.GetMaxPhysicalThreadCount() / kThreads, 1)));
+      KeCountChunks<kThreads><<<grids, kThreads, 0, dev_ctx.stream()>>>(
+          inference->data<int64_t>(), label->data<int64_t>(),
+          lod[0].CUDAData(place), num_seq, numel, tags,
+          excluded.empty() ? nullptr : excluded.CUDAData(place),
+          static_cast<int>(excluded.size()), counts_data);
+    }
+    // The metrics are left on the device till they are fetched.
+    auto* precision = context.Output<Tensor>("Precision");
+    auto* recall = context.Output<Tensor>("Recall");
+    auto* f1 = context.Output<Tensor>("F1-Score");
+    auto* num_infer_chunks = context.Output<Tensor>("NumInferChunks");
+    auto* num_label_chunks = context.Output<Tensor>("NumLabelChunks");
+    auto* num_correct_chunks = context.Output<Tensor>("NumCorrectChunks");
+    KeChunkMetrics<T><<<1, 1, 0, dev_ctx.stream()>>>(
+        counts_data, precision->mutable_data<T>(place),
+        recall->mutable_data<T>(place), f1->mutable_data<T>(place),
+        num_infer_chunks->mutable_data<int64_t>(place),
+        num_label_chunks->mutable_data<int64_t>(place),
+        num_correct_chunks->mutable_data<int64_t>(place));
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(chunk_eval, ops::ChunkEvalCUDAKernel<float>);
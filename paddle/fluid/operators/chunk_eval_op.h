@@ -19,6 +19,7 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/platform/hostdevice.h"
 
 namespace paddle {
 namespace operators {
@@ -26,6 +27,68 @@ namespace operators {
 using Tensor = framework::Tensor;
 using LoDTensor = framework::LoDTensor;
 
+// Whether the chunk of prev_tag and prev_type ends before tag and type.
+HOSTDEVICE inline bool IsChunkEnd(int prev_tag, int prev_type, int tag,
+                                  int type, int other_chunk_type, int tag_begin,
+                                  int tag_inside, int tag_end, int tag_single) {
+  if (prev_type == other_chunk_type) return false;
+  if (type == other_chunk_type) return true;
+  if (type != prev_type) return true;
+  if (prev_tag == tag_begin) return tag == tag_begin || tag == tag_single;
+  if (prev_tag == tag_inside) return tag == tag_begin || tag == tag_single;
+  if (prev_tag == tag_end) return true;
+  if (prev_tag == tag_single) return true;
+  return false;
+}
+
+// Whether a chunk begins at tag and type after prev_tag and prev_type.
+HOSTDEVICE inline bool IsChunkBegin(int prev_tag, int prev_type, int tag,
+                                    int type, int other_chunk_type,
+                                    int tag_begin, int tag_inside, int tag_end,
+                                    int tag_single) {
+  if (prev_type == other_chunk_type) return type != other_chunk_type;
+  if (type == other_chunk_type) return false;
+  if (type != prev_type) return true;
+  if (tag == tag_begin) return true;
+  if (tag == tag_inside) return prev_tag == tag_end || prev_tag == tag_single;
+  if (tag == tag_end) return prev_tag == tag_end || prev_tag == tag_single;
+  if (tag == tag_single) return true;
+  return false;
+}
+
+// The tag types of the chunk scheme, -1 if the scheme has no such tag.
+inline void GetChunkScheme(const std::string& chunk_scheme, int* num_tag_types,
+                           int* tag_begin, int* tag_inside, int* tag_end,
+                           int* tag_single) {
+  if (chunk_scheme == "IOB") {
+    *num_tag_types = 2;
+    *tag_begin = 0;
+    *tag_inside = 1;
+    *tag_end = -1;
+    *tag_single = -1;
+  } else if (chunk_scheme == "IOE") {
+    *num_tag_types = 2;
+    *tag_begin = -1;
+    *tag_inside = 0;
+    *tag_end = 1;
+    *tag_single = -1;
+  } else if (chunk_scheme == "IOBES") {
+    *num_tag_types = 4;
+    *tag_begin = 0;
+    *tag_inside = 1;
+    *tag_end = 2;
+    *tag_single = 3;
+  } else if (chunk_scheme == "plain") {
+    *num_tag_types = 1;
+    *tag_begin = -1;
+    *tag_inside = -1;
+    *tag_end = -1;
+    *tag_single = -1;
+  } else {
+    PADDLE_THROW("Unknown chunk scheme.");
+  }
+}
+
 template <typename DeviceContext, typename T>
 class ChunkEvalKernel : public framework::OpKernel<T> {
  public:
@@ -83,27 +146,15 @@ class ChunkEvalKernel : public framework::OpKernel<T> {
   bool ChunkEnd(int prev_tag, int prev_type, int tag, int type,
                 int other_chunk_type, int tag_begin, int tag_inside,
                 int tag_end, int tag_single) const {
-    if (prev_type == other_chunk_type) return false;
-    if (type == other_chunk_type) return true;
-    if (type != prev_type) return true;
-    if (prev_tag == tag_begin) return tag == tag_begin || tag == tag_single;
-    if (prev_tag == tag_inside) return tag == tag_begin || tag == tag_single;
-    if (prev_tag == tag_end) return true;
-    if (prev_tag == tag_single) return true;
-    return false;
+    return IsChunkEnd(prev_tag, prev_type, tag, type, other_chunk_type,
+                      tag_begin, tag_inside, tag_end, tag_single);
   }
 
   bool ChunkBegin(int prev_tag, int prev_type, int tag, int type,
                   int other_chunk_type, int tag_begin, int tag_inside,
                   int tag_end, int tag_single) const {
-    if (prev_type == other_chunk_type) return type != other_chunk_type;
-    if (type == other_chunk_type) return false;
-    if (type != prev_type) return true;
-    if (tag == tag_begin) return true;
-    if (tag == tag_inside) return prev_tag == tag_end || prev_tag == tag_single;
-    if (tag == tag_end) return prev_tag == tag_end || prev_tag == tag_single;
-    if (tag == tag_single) return true;
-    return false;
+    return IsChunkBegin(prev_tag, prev_type, tag, type, other_chunk_type,
+                        tag_begin, tag_inside, tag_end, tag_single);
   }
 
   void Compute(const framework::ExecutionContext& context) const override {
@@ -115,33 +166,8 @@ class ChunkEvalKernel : public framework::OpKernel<T> {
     std::vector<Segment> output_segments;
     std::set<int> excluded_chunk_types;
 
-    if (context.Attr<std::string>("chunk_scheme") == "IOB") {
-      num_tag_types = 2;
-      tag_begin = 0;
-      tag_inside = 1;
-      tag_end = -1;
-      tag_single = -1;
-    } else if (context.Attr<std::string>("chunk_scheme") == "IOE") {
-      num_tag_types = 2;
-      tag_begin = -1;
-      tag_inside = 0;
-      tag_end = 1;
-      tag_single = -1;
-    } else if (context.Attr<std::string>("chunk_scheme") == "IOBES") {
-      num_tag_types = 4;
-      tag_begin = 0;
-      tag_inside = 1;
-      tag_end = 2;
-      tag_single = 3;
-    } else if (context.Attr<std::string>("chunk_scheme") == "plain") {
-      num_tag_types = 1;
-      tag_begin = -1;
-      tag_inside = -1;
-      tag_end = -1;
-      tag_single = -1;
-    } else {
-      PADDLE_THROW("Unknown chunk scheme.");
-    }
+    GetChunkScheme(context.Attr<std::string>("chunk_scheme"), &num_tag_types,
+                   &tag_begin, &tag_inside, &tag_end, &tag_single);
     other_chunk_type = num_chunk_types = context.Attr<int>("num_chunk_types");
     excluded_chunk_types.insert(
         context.Attr<std::vector<int>>("excluded_chunk_types").begin(),
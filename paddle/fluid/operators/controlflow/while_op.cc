@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
+#include <mutex>  // NOLINT
+#include <utility>
 #include <vector>
 #include "paddle/fluid/framework/executor.h"
 #include "paddle/fluid/framework/lod_tensor_array.h"
@@ -45,6 +48,60 @@ static std::string GetSkipEagerDeletionVarsDebugString(
   }
   return str;
 }
+
+// The step block prepared once and reused by the runs of a while op. A run
+// takes a prepared block from the pool and puts it back when it is done, so
+// that the concurrent runs do not share the reference counts of the block.
+class PreparedStepBlocks {
+ public:
+  std::unique_ptr<framework::ExecutorPrepareContext> Take(
+      framework::Executor *executor, const framework::BlockDesc &block,
+      const std::vector<std::string> &skip_vars) {
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      for (auto it = pool_.begin(); it != pool_.end(); ++it) {
+        if (platform::is_same_place(it->first, executor->GetPlace())) {
+          auto ctx = std::move(it->second);
+          pool_.erase(it);
+          return ctx;
+        }
+      }
+    }
+    return executor->Prepare(*block.Program(), block.ID(), skip_vars);
+  }
+
+  void Put(const platform::Place &place,
+           std::unique_ptr<framework::ExecutorPrepareContext> ctx) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    pool_.emplace_back(place, std::move(ctx));
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<std::pair<platform::Place,
+                        std::unique_ptr<framework::ExecutorPrepareContext>>>
+      pool_;
+};
+
+// The name the gradient of a step is renamed to while it is added to the
+// gradient of all the steps.
+static std::string StepGradName(const std::string &name) {
+  return framework::GradVarName(name) + "@STEP";
+}
+
+// Clear the step-local variables of a scope reused by the steps, whose
+// arrays would otherwise keep the elements of the previous steps. The
+// allocations of the tensors are kept.
+static void ResetStepScope(const framework::Scope &scope) {
+  for (auto &name : scope.LocalVarNames()) {
+    auto *var = scope.FindLocalVar(name);
+    if (var->IsType<LoDTensor>()) {
+      var->GetMutable<LoDTensor>()->set_lod(framework::LoD());
+    } else if (var->IsType<framework::LoDTensorArray>()) {
+      var->GetMutable<framework::LoDTensorArray>()->clear();
+    }
+  }
+}
 }  // NOLINT
 
 class WhileOp : public framework::OperatorBase {
@@ -76,16 +133,32 @@ class WhileOp : public framework::OperatorBase {
     auto &skip_vars = Attr<std::vector<std::string>>(kSkipEagerDeletionVars);
     VLOG(2) << GetSkipEagerDeletionVarsDebugString(skip_vars);
 
-    auto ctx = executor.Prepare(*program, block->ID(), skip_vars);
-    while (cond.data<bool>()[0]) {
+    auto ctx = prepared_.Take(&executor, *block, skip_vars);
+    if (is_test) {
+      // No step scope is kept for the backward, so all the steps run in one
+      // scope, whose variables are created once.
       auto &current_scope = scope.NewScope();
-      step_scopes->push_back(&current_scope);
-      executor.RunPreparedContext(ctx.get(), &current_scope, false, true, true);
-      if (is_test) {
-        scope.DeleteScope(&current_scope);
+      executor.CreateVariables(*program, &current_scope, block->ID());
+      while (cond.data<bool>()[0]) {
+        ResetStepScope(current_scope);
+        executor.RunPreparedContext(ctx.get(), &current_scope, false, false,
+                                    true);
+        // The kids of a step are not used by the next steps.
+        current_scope.DropKids();
+      }
+      scope.DeleteScope(&current_scope);
+    } else {
+      while (cond.data<bool>()[0]) {
+        auto &current_scope = scope.NewScope();
+        step_scopes->push_back(&current_scope);
+        executor.RunPreparedContext(ctx.get(), &current_scope, false, true,
+                                    true);
       }
     }
+    prepared_.Put(dev_place, std::move(ctx));
   }
+
+  mutable PreparedStepBlocks prepared_;
 };
 
 class WhileOpMaker : public framework::OpProtoAndCheckerMaker {
@@ -139,11 +212,10 @@ class WhileGradOp : public framework::OperatorBase {
     auto &dev_ctx = *pool.Get(dev_place);
     framework::Executor executor(dev_place);
     auto *block = Attr<framework::BlockDesc *>(kStepBlock);
-    auto *program = block->Program();
 
     auto &skip_vars = Attr<std::vector<std::string>>(kSkipEagerDeletionVars);
     VLOG(2) << GetSkipEagerDeletionVarsDebugString(skip_vars);
-    auto ctx = executor.Prepare(*program, block->ID(), skip_vars);
+    auto ctx = prepared_.Take(&executor, *block, skip_vars);
 
     auto *step_scopes =
         scope.FindVar(Input(kStepScopes))->GetMutable<StepScopeVar>();
@@ -154,6 +226,28 @@ class WhileGradOp : public framework::OperatorBase {
 
     PADDLE_ENFORCE_EQ(outside_og_names.size(), inside_og_names.size());
 
+    // The Outputs(kXGRAD) contains the names of the gradient of parameters
+    // and inputs.
+    auto &pg_ig_names = Outputs(kXGRAD);
+    auto &p_names = Inputs(kX);
+    PADDLE_ENFORCE_EQ(pg_ig_names.size(), p_names.size());
+    // The sum ops accumulating the gradients of the steps, created once for
+    // all the steps. The gradient of a step is renamed to the input of the
+    // sum op while it runs.
+    std::vector<std::unique_ptr<framework::OperatorBase>> sum_ops(
+        pg_ig_names.size());
+    for (size_t param_id = 0; param_id < pg_ig_names.size(); ++param_id) {
+      if (pg_ig_names[param_id] == framework::kEmptyVarName) {
+        continue;
+      }
+      sum_ops[param_id] = framework::OpRegistry::CreateOp(
+          "sum",
+          {{"X",
+            {pg_ig_names[param_id], StepGradName(p_names[param_id])}}},
+          {{"Out", {pg_ig_names[param_id]}}},
+          framework::AttributeMap{{"use_mkldnn", {false}}});
+    }
+
     for (auto cur_scope_iter = step_scopes->rbegin();
          cur_scope_iter != step_scopes->rend(); ++cur_scope_iter) {
       VLOG(3) << "Start backward at time_step "
@@ -204,11 +298,6 @@ class WhileGradOp : public framework::OperatorBase {
       executor.RunPreparedContext(ctx.get(), *cur_scope_iter, false, true,
                                   true);
 
-      // The Outputs(kXGRAD) contains the names of the gradient of parameters
-      // and inputs.
-      auto &pg_ig_names = Outputs(kXGRAD);
-      auto &p_names = Inputs(kX);
-      PADDLE_ENFORCE_EQ(pg_ig_names.size(), p_names.size());
       for (size_t param_id = 0; param_id < pg_ig_names.size(); ++param_id) {
         if (pg_ig_names[param_id] == framework::kEmptyVarName) {
           continue;  // parameter doesn't have gradient
@@ -274,18 +363,18 @@ class WhileGradOp : public framework::OperatorBase {
                 ->set_lod(inside_tensor.lod());
           }
         }
-        auto new_inside_name = cur_scope.Rename(inside_grad_name);
-        auto sum_op = framework::OpRegistry::CreateOp(
-            "sum", {{"X", {pg_ig_names[param_id], new_inside_name}}},
-            {{"Out", {pg_ig_names[param_id]}}},
-            framework::AttributeMap{{"use_mkldnn", {false}}});
-        sum_op->Run(cur_scope, dev_place);
-        cur_scope.Rename(new_inside_name, inside_grad_name);
+        auto step_grad_name = StepGradName(p_names[param_id]);
+        cur_scope.Rename(inside_grad_name, step_grad_name);
+        sum_ops[param_id]->Run(cur_scope, dev_place);
+        cur_scope.Rename(step_grad_name, inside_grad_name);
       }
       dev_ctx.Wait();
       const_cast<framework::Scope &>(scope).DeleteScope(&cur_scope);
     }
+    prepared_.Put(dev_place, std::move(ctx));
   }
+
+  mutable PreparedStepBlocks prepared_;
 };
 
 class WhileGradOpDescMaker : public framework::SingleGradOpDescMaker {
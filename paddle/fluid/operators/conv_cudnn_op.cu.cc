@@ -161,6 +161,7 @@ class CUDNNConvOpKernel : public framework::OpKernel<T> {
 
     auto x_dims = framework::vectorize(input->dims());
     auto f_dims = framework::vectorize(filter->dims());
+    int device_id = boost::get<platform::CUDAPlace>(ctx.GetPlace()).device;
     if ((!exhaustive_search) && (!half_float)) {
       CUDNN_ENFORCE(platform::dynload::cudnnGetConvolutionForwardAlgorithm(
           handle, cudnn_input_desc, cudnn_filter_desc, cudnn_conv_desc,
@@ -182,6 +183,12 @@ class CUDNNConvOpKernel : public framework::OpKernel<T> {
       }
       algo = algo_cache->GetAlgorithm(
           x_dims, f_dims, strides, paddings, dilations, 0, [&]() {
+            auto key = ConvAlgoCacheKey<T>(
+                "conv_fwd", device_id, x_dims, f_dims, strides, paddings,
+                dilations, ctx.Attr<int>("groups"), workspace_size_limit);
+            cudnnConvolutionFwdAlgo_t cached_algo;
+            if (FindCachedAlgorithm(key, &cached_algo)) return cached_algo;
+
             int returned_algo_count;
             std::array<cudnnConvolutionFwdAlgoPerf_t, kNUM_CUDNN_FWD_ALGS>
                 fwd_perf_stat;
@@ -202,7 +209,7 @@ class CUDNNConvOpKernel : public framework::OpKernel<T> {
               VLOG(3) << stat.algo << ": " << stat.status << " " << stat.time
                       << " " << stat.memory;
             }
-            return fwd_perf_stat[0].algo;
+            return CacheAlgorithm(key, fwd_perf_stat[0].algo);
           });
       VLOG(3) << "choose algo " << algo;
     } else {
@@ -355,6 +362,7 @@ class CUDNNConvGradOpKernel : public framework::OpKernel<T> {
 
     auto x_dims = framework::vectorize(input->dims());
     auto f_dims = framework::vectorize(filter->dims());
+    int device_id = boost::get<platform::CUDAPlace>(ctx.GetPlace()).device;
     auto handle = dev_ctx.cudnn_handle();
     auto workspace_handle = dev_ctx.cudnn_workspace_handle();
     if (input_grad) {
@@ -376,6 +384,12 @@ class CUDNNConvGradOpKernel : public framework::OpKernel<T> {
         }
         data_algo = data_algo_cache->GetAlgorithm(
             x_dims, f_dims, strides, paddings, dilations, 0, [&]() {
+              auto key = ConvAlgoCacheKey<T>(
+                  "conv_bwd_data", device_id, x_dims, f_dims, strides, paddings,
+                  dilations, ctx.Attr<int>("groups"), workspace_size_limit);
+              cudnnConvolutionBwdDataAlgo_t cached_algo;
+              if (FindCachedAlgorithm(key, &cached_algo)) return cached_algo;
+
               int returned_algo_count;
               std::array<cudnnConvolutionBwdDataAlgoPerf_t,
                          kNUM_CUDNN_BWD_DATA_ALGS>
@@ -400,7 +414,7 @@ class CUDNNConvGradOpKernel : public framework::OpKernel<T> {
                 VLOG(3) << stat.algo << ": " << stat.status << " " << stat.time
                         << " " << stat.memory;
               }
-              return data_perf_stat[0].algo;
+              return CacheAlgorithm(key, data_perf_stat[0].algo);
             });
         VLOG(3) << "cuDNN backward data algo " << data_algo;
       } else if (FLAGS_cudnn_deterministic) {
@@ -445,6 +459,13 @@ class CUDNNConvGradOpKernel : public framework::OpKernel<T> {
         }
         filter_algo = f_algo_cache->GetAlgorithm(
             x_dims, f_dims, strides, paddings, dilations, 0, [&]() {
+              auto key = ConvAlgoCacheKey<T>(
+                  "conv_bwd_filter", device_id, x_dims, f_dims, strides,
+                  paddings, dilations, ctx.Attr<int>("groups"),
+                  workspace_size_limit);
+              cudnnConvolutionBwdFilterAlgo_t cached_algo;
+              if (FindCachedAlgorithm(key, &cached_algo)) return cached_algo;
+
               int returned_algo_count;
               std::array<cudnnConvolutionBwdFilterAlgoPerf_t,
                          kNUM_CUDNN_BWD_FILTER_ALGS>
@@ -462,7 +483,7 @@ class CUDNNConvGradOpKernel : public framework::OpKernel<T> {
               };
               workspace_handle.RunFunc(cudnn_find_bd_f_func,
                                        workspace_size_limit);
-              return filter_perf_stat[0].algo;
+              return CacheAlgorithm(key, filter_perf_stat[0].algo);
             });
         VLOG(3) << "cuDNN backward filter algo " << filter_algo;
       } else if (FLAGS_cudnn_deterministic) {
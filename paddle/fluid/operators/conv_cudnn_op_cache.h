@@ -15,9 +15,13 @@ limitations under the License. */
 #pragma once
 
 #include <functional>
+#include <sstream>
+#include <string>
 #include <unordered_map>
 #include <vector>
+#include "paddle/fluid/platform/cudnn_algo_cache.h"
 #include "paddle/fluid/platform/cudnn_helper.h"
+#include "paddle/fluid/platform/gpu_info.h"
 
 DECLARE_uint64(conv_workspace_size_limit);
 DECLARE_bool(cudnn_exhaustive_search);
@@ -29,6 +33,8 @@ namespace operators {
 static constexpr char kCUDNNFwdAlgoCache[] = "kCUDNNFwdAlgoCache";
 static constexpr char kCUDNNBwdDataAlgoCache[] = "kCUDNNBwdDataAlgoCache";
 static constexpr char kCUDNNBwdFilterAlgoCache[] = "kCUDNNBwdFilterAlgoCache";
+static constexpr char kCUDNNConvTransposeAlgoCache[] =
+    "kCUDNNConvTransposeAlgoCache";
 
 static constexpr size_t kCONV_CUDNN_WORKSPACE_LIMIT_BYTES =
     static_cast<size_t>(1024) * 1024 * 1024;
@@ -141,5 +147,58 @@ TAlgorithm AlgorithmsCache<TAlgorithm>::GetAlgorithm(
   return algo;
 }
 
+template <typename T>
+static void AppendAlgoCacheKey(std::ostringstream* os, const char* name,
+                               const std::vector<T>& values) {
+  *os << ";" << name << "=";
+  for (size_t i = 0; i < values.size(); ++i) {
+    *os << (i ? "," : "") << values[i];
+  }
+}
+
+// The key of a convolution in platform::CudnnAlgoCache. Besides the
+// convolution itself, the best algorithm depends on the GPU model and the
+// cuDNN version, which are recorded too since the cache file may be copied
+// to other machines.
+template <typename T>
+std::string ConvAlgoCacheKey(const std::string& kind, int device_id,
+                             const std::vector<int64_t>& x_dims,
+                             const std::vector<int64_t>& f_dims,
+                             const std::vector<int>& strides,
+                             const std::vector<int>& paddings,
+                             const std::vector<int>& dilations, int groups,
+                             size_t workspace_size_limit) {
+  std::ostringstream os;
+  os << kind << ";gpu=" << platform::GetCUDADeviceName(device_id) << ";sm="
+     << platform::GetCUDAComputeCapability(device_id)
+     << ";cudnn=" << platform::dynload::cudnnGetVersion() << ";dtype="
+     << static_cast<int>(platform::CudnnDataType<T>::type);
+  AppendAlgoCacheKey(&os, "x", x_dims);
+  AppendAlgoCacheKey(&os, "w", f_dims);
+  AppendAlgoCacheKey(&os, "s", strides);
+  AppendAlgoCacheKey(&os, "p", paddings);
+  AppendAlgoCacheKey(&os, "d", dilations);
+  os << ";g=" << groups << ";ws=" << workspace_size_limit;
+  return os.str();
+}
+
+// The algorithms found by exhaustive search are kept in the process-wide
+// platform::CudnnAlgoCache, which may be loaded from the file of a previous
+// run, so that the search is skipped for the convolutions seen before.
+template <typename TAlgorithm>
+bool FindCachedAlgorithm(const std::string& key, TAlgorithm* algo) {
+  int value;
+  if (!platform::CudnnAlgoCache::Instance().Find(key, &value)) return false;
+  VLOG(3) << "Use cached cuDNN algo " << value << " of " << key;
+  *algo = static_cast<TAlgorithm>(value);
+  return true;
+}
+
+template <typename TAlgorithm>
+TAlgorithm CacheAlgorithm(const std::string& key, TAlgorithm algo) {
+  platform::CudnnAlgoCache::Instance().Insert(key, static_cast<int>(algo));
+  return algo;
+}
+
 }  // namespace operators
 }  // namespace paddle
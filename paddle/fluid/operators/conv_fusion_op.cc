@@ -35,9 +35,13 @@ class Conv2DFusionOpMaker : public Conv2DOpMaker {
   void Apply() override {
     AddAttr<std::string>(
         "activation",
-        "The activation type can be 'identity', 'sigmoid', 'relu', 'relu6' "
-        "'relux' , 'tanh', 'band_pass'")
+        "The activation type can be 'identity', 'relu', 'relu6', "
+        "'leaky_relu', 'sigmoid' and 'tanh'.")
         .SetDefault("relu");
+    AddAttr<float>("activation_alpha",
+                   "The alpha of leaky_relu, or the threshold of relu6, which "
+                   "is 6 if it is not positive.")
+        .SetDefault(0.0f);
     AddAttr<std::vector<int>>(
         "split_channels",
         "When `split_channels` are set, there will be multiple outputs, the "
@@ -97,12 +101,27 @@ class Conv2DFusionOpInferShape : public framework::InferShapeBase {
   }
 };
 
+// The fused kernel calls cuDNN by itself, in all the data types.
+class Conv2DFusionOp : public ConvOp {
+ public:
+  using ConvOp::ConvOp;
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    auto input_data_type = ctx.Input<Tensor>("Input")->type();
+    PADDLE_ENFORCE_EQ(input_data_type, ctx.Input<Tensor>("Filter")->type(),
+                      "input and filter data type should be consistent");
+    return framework::OpKernelType(input_data_type, ctx.GetPlace());
+  }
+};
+
 // TODO(qingqing): add gradient operator for conv2d_fusion
 
 }  // namespace operators
 }  // namespace paddle
 
 namespace ops = paddle::operators;
-REGISTER_OPERATOR(conv2d_fusion, ops::ConvOp, ops::Conv2DFusionOpMaker,
-                  ops::Conv2DFusionOpInferShape, ops::ConvOpInferVarType,
-                  paddle::framework::EmptyGradOpMaker);
+REGISTER_OPERATOR(conv2d_fusion, ops::Conv2DFusionOp,
+                  ops::Conv2DFusionOpMaker, ops::Conv2DFusionOpInferShape,
+                  ops::ConvOpInferVarType, paddle::framework::EmptyGradOpMaker);
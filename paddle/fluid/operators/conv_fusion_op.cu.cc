@@ -12,8 +12,11 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <typeindex>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/conv_cudnn_op_cache.h"
+#include "paddle/fluid/operators/math/conv_epilogue.h"
+#include "paddle/fluid/operators/math/depthwise_conv.h"
 #include "paddle/fluid/platform/cudnn_helper.h"
 
 DEFINE_int64(cudnn_exhaustive_search_times, -1,
@@ -33,6 +36,31 @@ using DataLayout = platform::DataLayout;
 template <typename T>
 using ScalingParamType = typename platform::CudnnDataType<T>::ScalingParamType;
 
+// The depthwise convolutions run the kernels of depthwise_conv2d with the
+// epilogue fused in, which are faster than the grouped ones of cuDNN.
+template <typename T>
+static bool RunDepthwiseConvFusion(const platform::CUDADeviceContext& dev_ctx,
+                                   const Tensor& input, const Tensor& filter,
+                                   const std::vector<int>& strides,
+                                   const std::vector<int>& paddings,
+                                   const std::vector<int>& dilations,
+                                   const math::ConvEpilogue<T>& epilogue,
+                                   Tensor* output) {
+  math::DepthwiseConvFunctor<platform::CUDADeviceContext, T> depthwise_conv;
+  depthwise_conv(dev_ctx, input, filter, strides, paddings, dilations, output,
+                 epilogue);
+  return true;
+}
+
+template <>
+bool RunDepthwiseConvFusion<platform::float16>(
+    const platform::CUDADeviceContext& dev_ctx, const Tensor& input,
+    const Tensor& filter, const std::vector<int>& strides,
+    const std::vector<int>& paddings, const std::vector<int>& dilations,
+    const math::ConvEpilogue<platform::float16>& epilogue, Tensor* output) {
+  return false;
+}
+
 template <typename T>
 class CUDNNConvFusionOpKernel : public framework::OpKernel<T> {
  public:
@@ -61,6 +89,27 @@ class CUDNNConvFusionOpKernel : public framework::OpKernel<T> {
     T* output_data = output->mutable_data<T>(ctx.GetPlace());
     const T* residual_data = residual ? residual->data<T>() : output_data;
 
+    math::ConvEpilogue<T> epilogue;
+    epilogue.bias = bias_data;
+    epilogue.residual = residual ? residual_data : nullptr;
+    epilogue.act = math::GetConvActivation(activation);
+    epilogue.alpha = ctx.Attr<float>("activation_alpha");
+    if (epilogue.act == math::ConvActivation::kRelu6 && epilogue.alpha <= 0) {
+      epilogue.alpha = 6.f;
+    }
+    // cuDNN fuses only relu and identity into the convolution.
+    bool cudnn_activation = epilogue.act == math::ConvActivation::kRelu ||
+                            epilogue.act == math::ConvActivation::kIdentity;
+
+    int64_t input_channels = input->dims()[1];
+    if (input->dims().size() == 4 && groups > 1 && groups == input_channels &&
+        output->dims()[1] % input_channels == 0 &&
+        RunDepthwiseConvFusion<T>(dev_ctx, *input, *filter, strides, paddings,
+                                  dilations, epilogue, output)) {
+      SplitOutputs(ctx, *output);
+      return;
+    }
+
     // ------------------- cudnn descriptors ---------------------
     ScopedTensorDescriptor input_desc;
     ScopedTensorDescriptor output_desc;
@@ -88,8 +137,6 @@ class CUDNNConvFusionOpKernel : public framework::OpKernel<T> {
     std::vector<int> bias_dim = {1, static_cast<int>(output->dims()[1]), 1, 1};
     cudnnTensorDescriptor_t cudnn_bias_desc =
         bias_desc.descriptor<T>(layout, bias_dim);
-    cudnnActivationDescriptor_t cudnn_act_desc =
-        act_desc.descriptor<T>(activation);
 
     // ------------------- cudnn conv workspace ---------------------
     size_t workspace_size_in_bytes;  // final workspace to allocate.
@@ -106,8 +153,21 @@ class CUDNNConvFusionOpKernel : public framework::OpKernel<T> {
     auto handle = dev_ctx.cudnn_handle();
     auto workspace_handle = dev_ctx.cudnn_workspace_handle();
 
+#if CUDA_VERSION >= 9000
+    // The Tensor Cores of Volta and later are used for float16.
+    if (dev_ctx.GetComputeCapability() >= 70 &&
+        std::type_index(typeid(T)) ==
+            std::type_index(typeid(platform::float16))) {
+      CUDNN_ENFORCE(platform::dynload::cudnnSetConvolutionMathType(
+          cudnn_conv_desc, CUDNN_TENSOR_OP_MATH));
+    } else {
+      CUDNN_ENFORCE(platform::dynload::cudnnSetConvolutionMathType(
+          cudnn_conv_desc, CUDNN_DEFAULT_MATH));
+    }
+#else
     CUDNN_ENFORCE(platform::dynload::cudnnSetConvolutionMathType(
         cudnn_conv_desc, CUDNN_DEFAULT_MATH));
+#endif
 
     auto x_dims = framework::vectorize(input->dims());
     auto f_dims = framework::vectorize(filter->dims());
@@ -181,7 +241,19 @@ class CUDNNConvFusionOpKernel : public framework::OpKernel<T> {
     PADDLE_ENFORCE_LE(workspace_size_in_bytes, workspace_size_limit,
                       "workspace_size to be allocated exceeds the limit");
 
-    if ((activation == "identity") && (!residual)) {
+    if (!cudnn_activation) {
+      // ------------- cudnn conv forward and the fused epilogue -------------
+      ScalingParamType<T> alpha = 1.0f, beta = 0.0f;
+      auto cudnn_func = [&](void* cudnn_workspace) {
+        CUDNN_ENFORCE(platform::dynload::cudnnConvolutionForward(
+            handle, &alpha, cudnn_input_desc, input_data, cudnn_filter_desc,
+            filter_data, cudnn_conv_desc, algo, cudnn_workspace,
+            workspace_size_in_bytes, &beta, cudnn_output_desc, output_data));
+      };
+      workspace_handle.RunFunc(cudnn_func, workspace_size_in_bytes);
+      math::ConvEpilogueFunctor<platform::CUDADeviceContext, T> apply_epilogue;
+      apply_epilogue(dev_ctx, epilogue, output);
+    } else if ((activation == "identity") && (!residual)) {
       // Only the CUDNN_CONVOLUTION_FWD_ALGO_IMPLICIT_PRECOMP_GEMM algo is
       // enabled with CUDNN_ACTIVATION_IDENTITY in cuDNN lib.
       // But test in some case, the speed is slower, change to use
@@ -203,6 +275,8 @@ class CUDNNConvFusionOpKernel : public framework::OpKernel<T> {
         algo = CUDNN_CONVOLUTION_FWD_ALGO_IMPLICIT_PRECOMP_GEMM;
       }
       // ------------------- cudnn conv+bias+act forward --------------------
+      cudnnActivationDescriptor_t cudnn_act_desc =
+          act_desc.descriptor<T>(activation);
       ScalingParamType<T> alpha1 = 1.0f;
       ScalingParamType<T> alpha2 = residual ? 1.0f : 0.0f;
       auto cudnn_func = [&](void* cudnn_workspace) {
@@ -215,20 +289,26 @@ class CUDNNConvFusionOpKernel : public framework::OpKernel<T> {
       };
       workspace_handle.RunFunc(cudnn_func, workspace_size_in_bytes);
     }
+    SplitOutputs(ctx, *output);
+  }
+
+ private:
+  void SplitOutputs(const framework::ExecutionContext& ctx,
+                    const Tensor& output) const {
     std::vector<int> channels = ctx.Attr<std::vector<int>>("split_channels");
     if (channels.size()) {
       auto outs = ctx.MultiOutput<framework::Tensor>("Outputs");
-      if (x_dims[0] == 1) {
+      auto y_dims = output.dims();
+      if (y_dims[0] == 1) {
         // share data with Output
         framework::Tensor t;
-        t.ShareDataWith(*output);
-        auto y_dims = output->dims();
+        t.ShareDataWith(output);
         t.Resize({y_dims[1], y_dims[2], y_dims[3]});
         int s = 0;
         for (size_t i = 0; i < channels.size(); ++i) {
           int e = s + channels[i];
           outs[i]->ShareDataWith(t.Slice(s, e));
-          outs[i]->Resize({x_dims[0], channels[i], y_dims[2], y_dims[3]});
+          outs[i]->Resize({y_dims[0], channels[i], y_dims[2], y_dims[3]});
           s = e;
         }
       } else {
@@ -245,6 +325,8 @@ class CUDNNConvFusionOpKernel : public framework::OpKernel<T> {
 
 #if CUDNN_VERSION >= 7100
 namespace ops = paddle::operators;
-REGISTER_OP_CUDA_KERNEL(conv2d_fusion, ops::CUDNNConvFusionOpKernel<float>,
-                        ops::CUDNNConvFusionOpKernel<double>);
+REGISTER_OP_CUDA_KERNEL(
+    conv2d_fusion, ops::CUDNNConvFusionOpKernel<float>,
+    ops::CUDNNConvFusionOpKernel<double>,
+    ops::CUDNNConvFusionOpKernel<paddle::platform::float16>);
 #endif
@@ -24,6 +24,11 @@ limitations under the License. */
 #include "paddle/fluid/platform/mkldnn_helper.h"
 #endif
 
+DEFINE_bool(conv_cpu_winograd, true,
+            "compute the 3x3 convolutions of stride 1 on CPU by the Winograd "
+            "algorithm, which saves the multiplications but is slightly less "
+            "accurate than the GEMM");
+
 namespace paddle {
 namespace operators {
 
@@ -22,6 +22,9 @@ limitations under the License. */
 #include "paddle/fluid/operators/math/depthwise_conv.h"
 #include "paddle/fluid/operators/math/im2col.h"
 #include "paddle/fluid/operators/math/vol2col.h"
+#include "paddle/fluid/operators/math/winograd_conv.h"
+
+DECLARE_bool(conv_cpu_winograd);
 
 namespace paddle {
 namespace operators {
@@ -107,6 +110,47 @@ class ConvOpGrad : public framework::OperatorWithKernel {
       const framework::ExecutionContext& ctx) const override;
 };
 
+// Run the 2-D convolution by a kernel without the column buffer of im2col, if
+// there is one faster than im2col and GEMM for the shape. Only the CPU ones
+// are implemented, the GPU convolutions use cuDNN or DepthwiseConvKernel.
+template <typename DeviceContext, typename T>
+inline bool RunConvWithoutIm2Col(const DeviceContext& dev_ctx,
+                                 const Tensor& input, const Tensor& filter,
+                                 const std::vector<int>& strides,
+                                 const std::vector<int>& paddings,
+                                 const std::vector<int>& dilations, int groups,
+                                 Tensor* output) {
+  return false;
+}
+
+template <>
+inline bool RunConvWithoutIm2Col<platform::CPUDeviceContext, float>(
+    const platform::CPUDeviceContext& dev_ctx, const Tensor& input,
+    const Tensor& filter, const std::vector<int>& strides,
+    const std::vector<int>& paddings, const std::vector<int>& dilations,
+    int groups, Tensor* output) {
+  if (input.dims().size() != 4) return false;
+  const int64_t in_channels = input.dims()[1];
+  const int64_t out_channels = output->dims()[1];
+  // The depthwise convolution is a GEMM of a single row per group.
+  if (groups > 1 && groups == in_channels && out_channels % in_channels == 0) {
+    math::DepthwiseConvFunctor<platform::CPUDeviceContext, float> depthwise;
+    depthwise(dev_ctx, input, filter, strides, paddings, dilations, output);
+    return true;
+  }
+  // The transforms of Winograd cost more than they save for a few channels.
+  bool winograd = FLAGS_conv_cpu_winograd && groups == 1 &&
+                  filter.dims()[2] == 3 && filter.dims()[3] == 3 &&
+                  strides[0] == 1 && strides[1] == 1 && dilations[0] == 1 &&
+                  dilations[1] == 1 && in_channels >= 16 && out_channels >= 16;
+  if (!winograd) return false;
+  // The larger tiles save more, but waste the part out of small outputs.
+  int tile_size = output->dims()[2] >= 8 && output->dims()[3] >= 8 ? 4 : 2;
+  math::WinogradConv3x3Functor<platform::CPUDeviceContext, float> conv;
+  conv(dev_ctx, input, filter, paddings, tile_size, output);
+  return true;
+}
+
 template <typename DeviceContext, typename T>
 class GemmConvKernel : public framework::OpKernel<T> {
  public:
@@ -125,6 +169,11 @@ class GemmConvKernel : public framework::OpKernel<T> {
     std::vector<int> dilations = context.Attr<std::vector<int>>("dilations");
 
     auto& dev_ctx = context.template device_context<DeviceContext>();
+    if (RunConvWithoutIm2Col<DeviceContext, T>(dev_ctx, *input, filter,
+                                               strides, paddings, dilations,
+                                               groups, output)) {
+      return;
+    }
 
     const int batch_size = static_cast<int>(input->dims()[0]);
 
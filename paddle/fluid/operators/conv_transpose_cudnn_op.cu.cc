@@ -15,6 +15,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/memory/memory.h"
+#include "paddle/fluid/operators/conv_cudnn_op_cache.h"
 #include "paddle/fluid/operators/conv_transpose_op.h"
 #include "paddle/fluid/platform/assert.h"
 #include "paddle/fluid/platform/cudnn_helper.h"
@@ -85,13 +86,53 @@ class CUDNNConvTransposeOpKernel : public framework::OpKernel<T> {
     cudnnConvolutionBwdDataAlgo_t algo;
     auto& dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
     auto handle = dev_ctx.cudnn_handle();
+    auto workspace_handle = dev_ctx.cudnn_workspace_handle();
     // Get the algorithm
-    CUDNN_ENFORCE(platform::dynload::cudnnGetConvolutionBackwardDataAlgorithm(
-        handle, cudnn_filter_desc, cudnn_input_desc, cudnn_conv_desc,
-        // dxDesc: Handle to the previously initialized output tensor
-        // descriptor.
-        cudnn_output_desc, CUDNN_CONVOLUTION_BWD_DATA_SPECIFY_WORKSPACE_LIMIT,
-        workspace_size_limit, &algo));
+    if (FLAGS_cudnn_exhaustive_search) {
+      auto* algo_cache =
+          const_cast<framework::Scope&>(ctx.scope())
+              .Var(kCUDNNConvTransposeAlgoCache)
+              ->GetMutable<AlgorithmsCache<cudnnConvolutionBwdDataAlgo_t>>();
+      auto x_dims = framework::vectorize(input->dims());
+      auto f_dims = framework::vectorize(filter->dims());
+      int device_id = boost::get<platform::CUDAPlace>(ctx.GetPlace()).device;
+      algo = algo_cache->GetAlgorithm(
+          x_dims, f_dims, strides, paddings, dilations, 0, [&]() {
+            auto key = ConvAlgoCacheKey<T>(
+                "conv_transpose_fwd", device_id, x_dims, f_dims, strides,
+                paddings, dilations, groups, workspace_size_limit);
+            cudnnConvolutionBwdDataAlgo_t cached_algo;
+            if (FindCachedAlgorithm(key, &cached_algo)) return cached_algo;
+
+            int returned_algo_count;
+            std::array<cudnnConvolutionBwdDataAlgoPerf_t,
+                       kNUM_CUDNN_BWD_DATA_ALGS>
+                perf_stat;
+            auto cudnn_find_func = [&](void* cudnn_workspace) {
+              CUDNN_ENFORCE(
+                  platform::dynload::
+                      cudnnFindConvolutionBackwardDataAlgorithmEx(
+                          handle, cudnn_filter_desc, filter_data,
+                          cudnn_input_desc, input_data, cudnn_conv_desc,
+                          cudnn_output_desc, output_data,
+                          kNUM_CUDNN_BWD_DATA_ALGS, &returned_algo_count,
+                          perf_stat.data(), cudnn_workspace,
+                          workspace_size_limit));
+            };
+            workspace_handle.RunFunc(cudnn_find_func, workspace_size_limit);
+            return CacheAlgorithm(key, perf_stat[0].algo);
+          });
+      VLOG(3) << "cuDNN conv transpose algo " << algo;
+    } else {
+      CUDNN_ENFORCE(
+          platform::dynload::cudnnGetConvolutionBackwardDataAlgorithm(
+              handle, cudnn_filter_desc, cudnn_input_desc, cudnn_conv_desc,
+              // dxDesc: Handle to the previously initialized output tensor
+              // descriptor.
+              cudnn_output_desc,
+              CUDNN_CONVOLUTION_BWD_DATA_SPECIFY_WORKSPACE_LIMIT,
+              workspace_size_limit, &algo));
+    }
 
     // get workspace size able to allocate
     CUDNN_ENFORCE(
@@ -104,7 +145,6 @@ class CUDNNConvTransposeOpKernel : public framework::OpKernel<T> {
     int output_offset = output->numel() / output->dims()[0] / groups;
     int filter_offset = filter->numel() / groups;
     T alpha = 1.0f, beta = 0.0f;
-    auto workspace_handle = dev_ctx.cudnn_workspace_handle();
     for (int g = 0; g < groups; g++) {
       auto cudnn_func = [&](void* cudnn_workspace) {
         CUDNN_ENFORCE(platform::dynload::cudnnConvolutionBackwardData(
@@ -119,7 +119,7 @@ class CRFDecodingOp : public framework::OperatorWithKernel {
   framework::OpKernelType GetExpectedKernelType(
       const framework::ExecutionContext& ctx) const override {
     return framework::OpKernelType(ctx.Input<LoDTensor>("Emission")->type(),
-                                   platform::CPUPlace());
+                                   ctx.device_context().GetPlace());
   }
 };
 }  // namespace operators
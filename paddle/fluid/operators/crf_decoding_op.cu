@@ -0,0 +1,142 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <limits>
+#include "paddle/fluid/operators/crf_decoding_op.h"
+#include "paddle/fluid/operators/crf_util.cu.h"
+
+namespace paddle {
+namespace operators {
+
+// The Viterbi decoding of the sequences, a warp a sequence. alpha(k, i) is
+// the score of the best tags of [0, k] ending with the tag i, and track(k, i)
+// is the tag before i of them. If label is not null, the path is whether the
+// decoded tags are the labels.
+template <typename T>
+__global__ void KeCRFDecoding(const T* x, const T* w, const int64_t* label,
+                              const size_t* lod, int seq_num, int tag_num,
+                              bool shared_w, T* alpha, int* track,
+                              int64_t* path) {
+  int lane = threadIdx.x;
+  const T* trans = w;
+  if (shared_w) {
+    T* w_shared = CRFSharedMemory<T>();
+    for (int i = lane; i < (tag_num + 2) * tag_num; i += kCRFWarpSize) {
+      w_shared[i] = w[i];
+    }
+    __syncthreads();
+    trans = w_shared;
+  }
+  // The 1st row of w are the transitions from the start, the 2nd row of w
+  // are the transitions to the end, and the transitions between the tags
+  // begin from the 3rd row.
+  const T* state_trans = trans + 2 * tag_num;
+
+  for (int s = blockIdx.x; s < seq_num; s += gridDim.x) {
+    int start = static_cast<int>(lod[s]);
+    int len = static_cast<int>(lod[s + 1]) - start;
+    if (len == 0) continue;
+    const T* xs = x + start * tag_num;
+    T* as = alpha + start * tag_num;
+    int* ts = track + start * tag_num;
+
+    for (int i = lane; i < tag_num; i += kCRFWarpSize) {
+      as[i] = trans[i] + xs[i];
+    }
+    __syncthreads();
+    for (int k = 1; k < len; ++k) {
+      const T* prev = as + (k - 1) * tag_num;
+      for (int i = lane; i < tag_num; i += kCRFWarpSize) {
+        T max_score = -std::numeric_limits<T>::max();
+        int max_j = 0;
+        for (int j = 0; j < tag_num; ++j) {
+          T score = prev[j] + state_trans[j * tag_num + i];
+          if (score > max_score) {
+            max_score = score;
+            max_j = j;
+          }
+        }
+        as[k * tag_num + i] = max_score + xs[k * tag_num + i];
+        ts[k * tag_num + i] = max_j;
+      }
+      __syncthreads();
+    }
+
+    T max_score = -std::numeric_limits<T>::max();
+    int max_i = 0;
+    for (int i = lane; i < tag_num; i += kCRFWarpSize) {
+      T score = as[(len - 1) * tag_num + i] + trans[tag_num + i];
+      if (score > max_score) {
+        max_score = score;
+        max_i = i;
+      }
+    }
+    CRFWarpArgMax(&max_score, &max_i);
+
+    if (lane == 0) {
+      for (int k = len - 1; k >= 0; --k) {
+        path[start + k] = label ? (label[start + k] == max_i ? 1 : 0) : max_i;
+        if (k > 0) max_i = ts[k * tag_num + max_i];
+      }
+    }
+    __syncthreads();
+  }
+}
+
+template <typename T>
+class CRFDecodingCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* emission_weights = ctx.Input<LoDTensor>("Emission");
+    auto* transition_weights = ctx.Input<Tensor>("Transition");
+    auto* label = ctx.Input<LoDTensor>("Label");
+    auto* decoded_path = ctx.Output<Tensor>("ViterbiPath");
+
+    PADDLE_ENFORCE_EQ(emission_weights->NumLevels(), 1UL,
+                      "The Input(Emission) should be a sequence.");
+    if (label) {
+      PADDLE_ENFORCE_EQ(label->NumLevels(), 1UL,
+                        "The Input(Label) should be a sequence.");
+    }
+    auto& dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
+    auto& lod = emission_weights->lod()[0];
+    int seq_num = static_cast<int>(lod.size() - 1);
+    int tag_num = static_cast<int>(emission_weights->dims()[1]);
+
+    int64_t* path = decoded_path->mutable_data<int64_t>(ctx.GetPlace());
+    math::SetConstant<platform::CUDADeviceContext, int64_t>()(
+        dev_ctx, decoded_path, 0);
+    if (seq_num == 0 || emission_weights->numel() == 0) return;
+
+    Tensor alpha, track;
+    alpha.mutable_data<T>(emission_weights->dims(), ctx.GetPlace());
+    track.mutable_data<int>(emission_weights->dims(), ctx.GetPlace());
+
+    size_t shared_bytes = (tag_num + 2) * tag_num * sizeof(T);
+    bool shared_w = shared_bytes <= kCRFMaxSharedBytes;
+    KeCRFDecoding<T><<<CRFGrids(dev_ctx, seq_num), kCRFWarpSize,
+                       shared_w ? shared_bytes : 0, dev_ctx.stream()>>>(
+        emission_weights->data<T>(), transition_weights->data<T>(),
+        label ? label->data<int64_t>() : nullptr,
+        lod.CUDAData(ctx.GetPlace()), seq_num, tag_num, shared_w,
+        alpha.data<T>(), track.data<int>(), path);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(crf_decoding, ops::CRFDecodingCUDAKernel<float>,
+                        ops::CRFDecodingCUDAKernel<double>);
@@ -13,7 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
+#include <algorithm>
 #include <limits>
+#include "paddle/fluid/framework/compute_pool.h"
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/jit/kernels.h"
@@ -45,13 +47,23 @@ class CRFDecodingOpKernel : public framework::OpKernel<T> {
     int64_t* path = decoded_path->mutable_data<int64_t>(platform::CPUPlace());
     math::SetConstant<DeviceContext, int64_t>()(
         ctx.template device_context<DeviceContext>(), decoded_path, 0);
-    for (size_t i = 0; i < seq_num; ++i) {
-      int start_pos = static_cast<int>(lod[level][i]);
-      int end_pos = static_cast<int>(lod[level][i + 1]);
-      Tensor decoded_path_one_seq = decoded_path->Slice(start_pos, end_pos);
-      Decode(emission_weights->Slice(start_pos, end_pos), *transition_weights,
-             &decoded_path_one_seq);
-    }
+    // A sequence costs about tag_num * tag_num for each of its steps.
+    const size_t* offsets = lod[level].data();
+    int64_t tag_num = emission_weights->dims()[1];
+    int64_t seq_cost = emission_weights->numel() * tag_num /
+                       std::max<int64_t>(static_cast<int64_t>(seq_num), 1);
+    framework::ParallelFor(
+        0, static_cast<int64_t>(seq_num), framework::GrainSize(seq_cost),
+        [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            int start_pos = static_cast<int>(offsets[i]);
+            int end_pos = static_cast<int>(offsets[i + 1]);
+            Tensor decoded_path_one_seq =
+                decoded_path->Slice(start_pos, end_pos);
+            Decode(emission_weights->Slice(start_pos, end_pos),
+                   *transition_weights, &decoded_path_one_seq);
+          }
+        });
 
     if (label) {
       PADDLE_ENFORCE_EQ(label->NumLevels(), 1UL,
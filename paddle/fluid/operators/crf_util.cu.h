@@ -0,0 +1,83 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <algorithm>
+#include "paddle/fluid/platform/cuda_device_function.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+
+// The CRF kernels decode or train a sequence by a warp, whose lanes take the
+// tags by turns.
+constexpr int kCRFWarpSize = 32;
+// The transitions are kept in the shared memory if they fit in this size.
+constexpr size_t kCRFMaxSharedBytes = 32 * 1024;
+
+template <typename T>
+__device__ __forceinline__ T CRFWarpSum(T val) {
+  unsigned mask = 0u;
+  CREATE_SHFL_MASK(mask, true);
+  for (int offset = kCRFWarpSize / 2; offset > 0; offset /= 2) {
+    val += platform::CudaShuffleDownSync(mask, val, offset);
+  }
+  return platform::CudaShuffleSync(mask, val, 0);
+}
+
+template <typename T>
+__device__ __forceinline__ T CRFWarpMax(T val) {
+  unsigned mask = 0u;
+  CREATE_SHFL_MASK(mask, true);
+  for (int offset = kCRFWarpSize / 2; offset > 0; offset /= 2) {
+    T other = platform::CudaShuffleDownSync(mask, val, offset);
+    val = other > val ? other : val;
+  }
+  return platform::CudaShuffleSync(mask, val, 0);
+}
+
+// The max of val over the warp and its index, the smallest one of the ties,
+// as the first max found by a sequential scan.
+template <typename T>
+__device__ __forceinline__ void CRFWarpArgMax(T* val, int* index) {
+  unsigned mask = 0u;
+  CREATE_SHFL_MASK(mask, true);
+  for (int offset = kCRFWarpSize / 2; offset > 0; offset /= 2) {
+    T other = platform::CudaShuffleDownSync(mask, *val, offset);
+    int other_index = platform::CudaShuffleDownSync(mask, *index, offset);
+    if (other > *val || (other == *val && other_index < *index)) {
+      *val = other;
+      *index = other_index;
+    }
+  }
+  *val = platform::CudaShuffleSync(mask, *val, 0);
+  *index = platform::CudaShuffleSync(mask, *index, 0);
+}
+
+// The dynamic shared memory of a CRF kernel, which is aligned for double.
+template <typename T>
+__device__ __forceinline__ T* CRFSharedMemory() {
+  extern __shared__ __align__(sizeof(double)) unsigned char crf_shared[];
+  return reinterpret_cast<T*>(crf_shared);
+}
+
+// The number of the blocks, a block of a warp a sequence.
+inline int CRFGrids(const platform::CUDADeviceContext& ctx, size_t seq_num) {
+  int max_blocks = std::max(ctx.GetMaxPhysicalThreadCount() / kCRFWarpSize, 1);
+  return static_cast<int>(
+      std::max<size_t>(std::min<size_t>(seq_num, max_blocks), 1));
+}
+
+}  // namespace operators
+}  // namespace paddle
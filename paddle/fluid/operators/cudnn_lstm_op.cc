@@ -42,9 +42,19 @@ class CudnnLSTMOp : public framework::OperatorWithKernel {
                    "Output(last_c) of LSTM should not be null.");
 
     auto in_dims = ctx->GetInputDim("Input");
-    PADDLE_ENFORCE_EQ(in_dims.size(), 3, "Input(X)'s rank must be 3.");
-
-    ctx->SetOutputDim("Out", ctx->GetInputDim("Input"));
+    PADDLE_ENFORCE(in_dims.size() == 3 || in_dims.size() == 2,
+                   "Input(X)'s rank must be 3, or 2 for the sequences of a "
+                   "LoDTensor.");
+
+    if (in_dims.size() == 2) {
+      int hidden_size = ctx->Attrs().Get<int>("hidden_size");
+      bool is_bidirec = ctx->Attrs().Get<bool>("is_bidirec");
+      ctx->SetOutputDim(
+          "Out", {in_dims[0], is_bidirec ? hidden_size * 2 : hidden_size});
+      ctx->ShareLoD("Input", "Out");
+    } else {
+      ctx->SetOutputDim("Out", ctx->GetInputDim("Input"));
+    }
     ctx->SetOutputDim("last_h", ctx->GetInputDim("InitH"));
     ctx->SetOutputDim("last_c", ctx->GetInputDim("InitC"));
   }
@@ -62,7 +72,10 @@ class CudnnLSTMOpMaker : public framework::OpProtoAndCheckerMaker {
         "different batch)"
         "batch_size is the instance number of this batch"
         "input_size is the hidden size of the input."
-        "input_hidden_size and the hidden_size in the next may not be same");
+        "input_hidden_size and the hidden_size in the next may not be same. "
+        "It can also be a LoDTensor of the shape (total_len x input_size) "
+        "with one level of LoD, whose sequences are packed by the time steps "
+        "and run without the padding.");
     AddInput("InitH",
              "(Tensor) the initial hidden state of the LSTM"
              "input. This is a tensor with shape (num_layers x batch_size x "
@@ -191,6 +204,9 @@ class CudnnLSTMGradOp : public framework::OperatorWithKernel {
     };
 
     SetOutGradDim("Input");
+    if (ctx->HasOutput(framework::GradVarName("Input"))) {
+      ctx->ShareLoD("Input", framework::GradVarName("Input"));
+    }
     SetOutGradDim("W");
     SetOutGradDim("InitH");
     SetOutGradDim("InitC");
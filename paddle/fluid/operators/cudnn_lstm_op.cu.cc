@@ -12,9 +12,11 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <vector>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/cudnn_rnn_cache.h"
 #include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/operators/math/sequence2batch.h"
 
 namespace paddle {
 namespace operators {
@@ -22,17 +24,51 @@ namespace operators {
 using LoDTensor = framework::LoDTensor;
 using Tensor = framework::Tensor;
 
+// The batch sizes of the steps of the sequences packed by
+// LoDTensor2BatchFunctor, whose batch_starts are the first rows of the steps.
+static std::vector<int> StepBatchSizes(
+    const framework::Vector<size_t> &batch_starts) {
+  std::vector<int> batch_sizes;
+  for (size_t i = 0; i + 1 < batch_starts.size(); ++i) {
+    batch_sizes.push_back(static_cast<int>(batch_starts[i + 1] -
+                                           batch_starts[i]));
+  }
+  return batch_sizes;
+}
+
+// Reorder the (num_layers x batch_size x hidden_size) states between the
+// order of the sequences and the order of the packed sequences. If
+// indexed_src is true, the row i of each layer of dst is the row order[i] of
+// src, otherwise the row order[i] of dst is the row i of src.
+template <typename T>
+static void ReorderStates(const platform::CUDADeviceContext &dev_ctx,
+                          const Tensor &src,
+                          const framework::Vector<size_t> &order, Tensor *dst,
+                          bool indexed_src) {
+  auto dims = src.dims();
+  PADDLE_ENFORCE_EQ(dims[1], static_cast<int64_t>(order.size()),
+                    "the batch size of the states should be the number of "
+                    "the sequences");
+  dst->mutable_data<T>(dims, dev_ctx.GetPlace());
+  math::CopyMatrixRowsFunctor<platform::CUDADeviceContext, T> row_shuffle;
+  for (int64_t i = 0; i < dims[0]; ++i) {
+    Tensor src_i = src.Slice(i, i + 1).Resize({dims[1], dims[2]});
+    Tensor dst_i = dst->Slice(i, i + 1).Resize({dims[1], dims[2]});
+    row_shuffle(dev_ctx, src_i, order, &dst_i, indexed_src);
+  }
+}
+
 template <typename T>
 class CudnnLSTMGPUKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext &ctx) const override {
-    const Tensor *x = ctx.Input<Tensor>("Input");
+    const LoDTensor *x = ctx.Input<LoDTensor>("Input");
     const Tensor *init_h = ctx.Input<Tensor>("InitH");
     const Tensor *init_c = ctx.Input<Tensor>("InitC");
 
     auto w = ctx.Input<Tensor>("W");
 
-    Tensor *out = ctx.Output<Tensor>("Out");
+    LoDTensor *out = ctx.Output<LoDTensor>("Out");
     Tensor *last_h = ctx.Output<Tensor>("last_h");
     Tensor *last_c = ctx.Output<Tensor>("last_c");
 
@@ -81,12 +117,17 @@ class CudnnLSTMGPUKernel : public framework::OpKernel<T> {
       }
 
       auto input_w_numel = w->numel();
-      auto batch_size = x->dims()[1];
+      auto batch_size = x->lod().empty() ? x->dims()[1] : init_h->dims()[1];
       cudnn_rnn_cache->init(handle, ctx.GetPlace(), max_len, batch_size,
                             input_size, hidden_size, num_layers, dropout_prob,
                             is_bidirec, seed, input_w_numel);
     }
 
+    if (!x->lod().empty()) {
+      ComputePacked(ctx, cudnn_rnn_cache, is_test);
+      return;
+    }
+
     auto run_seq_len = x->dims()[0];
 
     if (is_test) {
@@ -113,13 +154,85 @@ class CudnnLSTMGPUKernel : public framework::OpKernel<T> {
           cudnn_rnn_cache->reserve_size_));
     }
   }
+
+ private:
+  // The sequences of a LoDTensor are packed by the steps, in the order of
+  // their lengths, and run by cuDNN without padding each one to the longest.
+  void ComputePacked(const framework::ExecutionContext &ctx,
+                     CudnnRNNCache *cudnn_rnn_cache, bool is_test) const {
+    auto *x = ctx.Input<LoDTensor>("Input");
+    auto *init_h = ctx.Input<Tensor>("InitH");
+    auto *init_c = ctx.Input<Tensor>("InitC");
+    auto *w = ctx.Input<Tensor>("W");
+    auto *out = ctx.Output<LoDTensor>("Out");
+    auto *last_h = ctx.Output<Tensor>("last_h");
+    auto *last_c = ctx.Output<Tensor>("last_c");
+
+    auto &dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
+    auto handle = dev_ctx.cudnn_handle();
+    auto place = ctx.GetPlace();
+
+    LoDTensor batch_x;
+    batch_x.mutable_data<T>(x->dims(), place);
+    math::LoDTensor2BatchFunctor<platform::CUDADeviceContext, T> to_batch;
+    to_batch(dev_ctx, *x, &batch_x, true);
+    auto &order = batch_x.lod()[2];
+    auto batch_sizes = StepBatchSizes(batch_x.lod()[0]);
+    cudnn_rnn_cache->set_packed_batch_sizes(handle, place, batch_sizes);
+
+    Tensor ordered_init_h, ordered_init_c;
+    ReorderStates<T>(dev_ctx, *init_h, order, &ordered_init_h, true);
+    ReorderStates<T>(dev_ctx, *init_c, order, &ordered_init_c, true);
+
+    LoDTensor batch_out;
+    batch_out.mutable_data<T>(out->dims(), place);
+    batch_out.set_lod(batch_x.lod());
+    Tensor ordered_last_h, ordered_last_c;
+    ordered_last_h.mutable_data<T>(last_h->dims(), place);
+    ordered_last_c.mutable_data<T>(last_c->dims(), place);
+
+    int seq_len = static_cast<int>(batch_sizes.size());
+    if (is_test) {
+      CUDNN_ENFORCE(platform::dynload::cudnnRNNForwardInference(
+          handle, cudnn_rnn_cache->rnn_desc_, seq_len,
+          cudnn_rnn_cache->x_desc_, batch_x.data<T>(),
+          cudnn_rnn_cache->hx_desc_, ordered_init_h.data<T>(),
+          cudnn_rnn_cache->cx_desc_, ordered_init_c.data<T>(),
+          cudnn_rnn_cache->w_desc_, w->data<T>(), cudnn_rnn_cache->y_desc_,
+          batch_out.data<T>(), cudnn_rnn_cache->hy_desc_,
+          ordered_last_h.data<T>(), cudnn_rnn_cache->cy_desc_,
+          ordered_last_c.data<T>(),
+          cudnn_rnn_cache->workspace_data_.data<uint8_t>(),
+          cudnn_rnn_cache->workspace_size_));
+    } else {
+      CUDNN_ENFORCE(platform::dynload::cudnnRNNForwardTraining(
+          handle, cudnn_rnn_cache->rnn_desc_, seq_len,
+          cudnn_rnn_cache->x_desc_, batch_x.data<T>(),
+          cudnn_rnn_cache->hx_desc_, ordered_init_h.data<T>(),
+          cudnn_rnn_cache->cx_desc_, ordered_init_c.data<T>(),
+          cudnn_rnn_cache->w_desc_, w->data<T>(), cudnn_rnn_cache->y_desc_,
+          batch_out.data<T>(), cudnn_rnn_cache->hy_desc_,
+          ordered_last_h.data<T>(), cudnn_rnn_cache->cy_desc_,
+          ordered_last_c.data<T>(),
+          cudnn_rnn_cache->workspace_data_.data<uint8_t>(),
+          cudnn_rnn_cache->workspace_size_,
+          cudnn_rnn_cache->reserve_data_.data<uint8_t>(),
+          cudnn_rnn_cache->reserve_size_));
+    }
+
+    out->mutable_data<T>(place);
+    math::Batch2LoDTensorFunctor<platform::CUDADeviceContext, T> to_seq;
+    to_seq(dev_ctx, batch_out, out);
+    ReorderStates<T>(dev_ctx, ordered_last_h, order, last_h, false);
+    ReorderStates<T>(dev_ctx, ordered_last_c, order, last_c, false);
+  }
 };
 
 template <typename T>
 class CudnnLSTMGPUGradKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext &ctx) const override {
-    auto *input = ctx.Input<Tensor>("Input");
+    auto *input = ctx.Input<LoDTensor>("Input");
     auto *weight = ctx.Input<Tensor>("W");
     auto *init_h = ctx.Input<Tensor>("InitH");
     auto *init_c = ctx.Input<Tensor>("InitC");
@@ -146,6 +259,11 @@ class CudnnLSTMGPUGradKernel : public framework::OpKernel<T> {
         const_cast<framework::Variable *>(cache_var)
             ->GetMutable<CudnnRNNCache>();
 
+    if (!input->lod().empty()) {
+      ComputePacked(ctx, cudnn_rnn_cache);
+      return;
+    }
+
     auto input_dims = input->dims();
     auto init_h_dims = init_h->dims();
     auto init_c_dims = init_c->dims();
@@ -251,6 +369,121 @@ class CudnnLSTMGPUGradKernel : public framework::OpKernel<T> {
         weight_grad->data<T>(), cudnn_rnn_cache->reserve_data_.data<uint8_t>(),
         cudnn_rnn_cache->reserve_size_));
   }
+
+ private:
+  void ComputePacked(const framework::ExecutionContext &ctx,
+                     CudnnRNNCache *cudnn_rnn_cache) const {
+    auto *input = ctx.Input<LoDTensor>("Input");
+    auto *weight = ctx.Input<Tensor>("W");
+    auto *init_h = ctx.Input<Tensor>("InitH");
+    auto *init_c = ctx.Input<Tensor>("InitC");
+    auto *out = ctx.Input<LoDTensor>("Out");
+    auto *out_grad = ctx.Input<LoDTensor>(framework::GradVarName("Out"));
+    auto *last_h_grad = ctx.Input<Tensor>(framework::GradVarName("last_h"));
+    auto *last_c_grad = ctx.Input<Tensor>(framework::GradVarName("last_c"));
+
+    auto *in_grad = ctx.Output<LoDTensor>(framework::GradVarName("Input"));
+    auto *weight_grad = ctx.Output<Tensor>(framework::GradVarName("W"));
+    auto *init_h_grad = ctx.Output<Tensor>(framework::GradVarName("InitH"));
+    auto *init_c_grad = ctx.Output<Tensor>(framework::GradVarName("InitC"));
+
+    auto &dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
+    auto handle = dev_ctx.cudnn_handle();
+    auto place = ctx.GetPlace();
+    math::SetConstant<platform::CUDADeviceContext, T> zero;
+
+    // Pack the sequences as the forward did, which sets the same descriptors.
+    LoDTensor batch_x;
+    batch_x.mutable_data<T>(input->dims(), place);
+    math::LoDTensor2BatchFunctor<platform::CUDADeviceContext, T> to_batch;
+    to_batch(dev_ctx, *input, &batch_x, true);
+    auto &order = batch_x.lod()[2];
+    auto batch_sizes = StepBatchSizes(batch_x.lod()[0]);
+    cudnn_rnn_cache->set_packed_batch_sizes(handle, place, batch_sizes);
+
+    LoDTensor batch_out, batch_out_grad;
+    batch_out.mutable_data<T>(out->dims(), place);
+    batch_out.set_lod(batch_x.lod());
+    to_batch(dev_ctx, *out, &batch_out, false);
+    batch_out_grad.mutable_data<T>(out->dims(), place);
+    batch_out_grad.set_lod(batch_x.lod());
+    if (out_grad) {
+      to_batch(dev_ctx, *out_grad, &batch_out_grad, false);
+    } else {
+      zero(dev_ctx, &batch_out_grad, static_cast<T>(0.0));
+    }
+
+    Tensor ordered_init_h, ordered_init_c;
+    ReorderStates<T>(dev_ctx, *init_h, order, &ordered_init_h, true);
+    ReorderStates<T>(dev_ctx, *init_c, order, &ordered_init_c, true);
+    // The missing gradients of the last states are zeros.
+    auto ordered_state_grad = [&](const Tensor *grad, Tensor *ordered) {
+      if (grad) {
+        ReorderStates<T>(dev_ctx, *grad, order, ordered, true);
+      } else {
+        ordered->mutable_data<T>(init_h->dims(), place);
+        zero(dev_ctx, ordered, static_cast<T>(0.0));
+      }
+    };
+    Tensor ordered_last_h_grad, ordered_last_c_grad;
+    ordered_state_grad(last_h_grad, &ordered_last_h_grad);
+    ordered_state_grad(last_c_grad, &ordered_last_c_grad);
+
+    LoDTensor batch_in_grad;
+    batch_in_grad.mutable_data<T>(input->dims(), place);
+    batch_in_grad.set_lod(batch_x.lod());
+    Tensor ordered_init_h_grad, ordered_init_c_grad;
+    ordered_init_h_grad.mutable_data<T>(init_h->dims(), place);
+    ordered_init_c_grad.mutable_data<T>(init_c->dims(), place);
+
+    int seq_len = static_cast<int>(batch_sizes.size());
+    CUDNN_ENFORCE(platform::dynload::cudnnRNNBackwardData(
+        handle, cudnn_rnn_cache->rnn_desc_, seq_len, cudnn_rnn_cache->y_desc_,
+        batch_out.data<T>(), cudnn_rnn_cache->dy_desc_,
+        batch_out_grad.data<T>(), cudnn_rnn_cache->dhy_desc_,
+        ordered_last_h_grad.data<T>(), cudnn_rnn_cache->dcy_desc_,
+        ordered_last_c_grad.data<T>(), cudnn_rnn_cache->w_desc_,
+        weight->data<T>(), cudnn_rnn_cache->hx_desc_,
+        ordered_init_h.data<T>(), cudnn_rnn_cache->cx_desc_,
+        ordered_init_c.data<T>(), cudnn_rnn_cache->dx_desc_,
+        batch_in_grad.data<T>(), cudnn_rnn_cache->dhx_desc_,
+        ordered_init_h_grad.data<T>(), cudnn_rnn_cache->dcx_desc_,
+        ordered_init_c_grad.data<T>(),
+        cudnn_rnn_cache->workspace_data_.data<uint8_t>(),
+        cudnn_rnn_cache->workspace_size_,
+        cudnn_rnn_cache->reserve_data_.data<uint8_t>(),
+        cudnn_rnn_cache->reserve_size_));
+
+    if (weight_grad) {
+      // cuDNN accumulates the gradient of the weights.
+      weight_grad->mutable_data<T>(place);
+      zero(dev_ctx, weight_grad, static_cast<T>(0.0));
+      CUDNN_ENFORCE(platform::dynload::cudnnRNNBackwardWeights(
+          handle, cudnn_rnn_cache->rnn_desc_, seq_len,
+          cudnn_rnn_cache->x_desc_, batch_x.data<T>(),
+          cudnn_rnn_cache->hx_desc_, ordered_init_h.data<T>(),
+          cudnn_rnn_cache->y_desc_, batch_out.data<T>(),
+          cudnn_rnn_cache->workspace_data_.data<uint8_t>(),
+          cudnn_rnn_cache->workspace_size_, cudnn_rnn_cache->dw_desc_,
+          weight_grad->data<T>(),
+          cudnn_rnn_cache->reserve_data_.data<uint8_t>(),
+          cudnn_rnn_cache->reserve_size_));
+    }
+
+    if (in_grad) {
+      in_grad->mutable_data<T>(place);
+      math::Batch2LoDTensorFunctor<platform::CUDADeviceContext, T> to_seq;
+      to_seq(dev_ctx, batch_in_grad, in_grad);
+    }
+    if (init_h_grad) {
+      ReorderStates<T>(dev_ctx, ordered_init_h_grad, order, init_h_grad,
+                       false);
+    }
+    if (init_c_grad) {
+      ReorderStates<T>(dev_ctx, ordered_init_c_grad, order, init_c_grad,
+                       false);
+    }
+  }
 };
 
 }  // namespace operators
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <vector>
 #include "paddle/fluid/framework/tensor.h"
 #include "paddle/fluid/platform/cudnn_helper.h"
 
@@ -216,6 +217,63 @@ struct CudnnRNNCache {
     workspace_data_.mutable_data<uint8_t>(place);
   }
 
+  // Set the descriptors of the steps of the sequences packed by the steps,
+  // where step i holds the batch_sizes[i] sequences longer than i, sorted by
+  // their lengths as cuDNN requires. The workspace and the reserve space are
+  // grown to the packed sequences.
+  void set_packed_batch_sizes(cudnnHandle_t handle,
+                              const platform::Place &place,
+                              const std::vector<int> &batch_sizes) {
+    PADDLE_ENFORCE_LE(batch_sizes.size(), max_length_,
+                      "the longest sequence can NOT be longer than max_len");
+    int dim_a[3];
+    int stride_a[3];
+    for (size_t i = 0; i < batch_sizes.size(); ++i) {
+      dim_a[0] = batch_sizes[i];
+      dim_a[1] = input_size_;
+      dim_a[2] = 1;
+      stride_a[0] = dim_a[2] * dim_a[1];
+      stride_a[1] = dim_a[2];
+      stride_a[2] = 1;
+      CUDNN_ENFORCE(platform::dynload::cudnnSetTensorNdDescriptor(
+          x_desc_[i], CUDNN_DATA_FLOAT, 3, dim_a, stride_a));
+      CUDNN_ENFORCE(platform::dynload::cudnnSetTensorNdDescriptor(
+          dx_desc_[i], CUDNN_DATA_FLOAT, 3, dim_a, stride_a));
+
+      dim_a[1] = is_bidirec_ ? hidden_size_ * 2 : hidden_size_;
+      stride_a[0] = dim_a[2] * dim_a[1];
+      CUDNN_ENFORCE(platform::dynload::cudnnSetTensorNdDescriptor(
+          y_desc_[i], CUDNN_DATA_FLOAT, 3, dim_a, stride_a));
+      CUDNN_ENFORCE(platform::dynload::cudnnSetTensorNdDescriptor(
+          dy_desc_[i], CUDNN_DATA_FLOAT, 3, dim_a, stride_a));
+    }
+
+    dim_a[0] = num_layers_ * (is_bidirec_ ? 2 : 1);
+    dim_a[1] = batch_sizes[0];
+    dim_a[2] = hidden_size_;
+    stride_a[0] = dim_a[2] * dim_a[1];
+    stride_a[1] = dim_a[2];
+    stride_a[2] = 1;
+    for (auto desc : {hx_desc_, cx_desc_, hy_desc_, cy_desc_, dhx_desc_,
+                      dcx_desc_, dhy_desc_, dcy_desc_}) {
+      CUDNN_ENFORCE(platform::dynload::cudnnSetTensorNdDescriptor(
+          desc, CUDNN_DATA_FLOAT, 3, dim_a, stride_a));
+    }
+    batch_size_ = batch_sizes[0];
+
+    int seq_len = static_cast<int>(batch_sizes.size());
+    CUDNN_ENFORCE(platform::dynload::cudnnGetRNNWorkspaceSize(
+        handle, rnn_desc_, seq_len, x_desc_, &workspace_size_));
+    CUDNN_ENFORCE(platform::dynload::cudnnGetRNNTrainingReserveSize(
+        handle, rnn_desc_, seq_len, x_desc_, &reserve_size_));
+    // The tensors keep their memory when they are not grown, so the reserve
+    // space written by the forward is kept for the backward.
+    reserve_data_.Resize({static_cast<int64_t>(reserve_size_)});
+    reserve_data_.mutable_data<uint8_t>(place);
+    workspace_data_.Resize({static_cast<int64_t>(workspace_size_)});
+    workspace_data_.mutable_data<uint8_t>(place);
+  }
+
   void release() {
     for (size_t i = 0; i < max_length_; ++i) {
       CUDNN_ENFORCE(
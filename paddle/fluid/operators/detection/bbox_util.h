@@ -12,6 +12,7 @@ limitations under the License. */
 #include <algorithm>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/hostdevice.h"
 
 namespace paddle {
 namespace operators {
@@ -93,5 +94,45 @@ void BboxOverlaps(const framework::Tensor& r_boxes,
   }
 }
 
+template <class T>
+HOSTDEVICE inline T BBoxArea(const T* box, const bool normalized) {
+  if (box[2] < box[0] || box[3] < box[1]) {
+    // If coordinate values are is invalid
+    // (e.g. xmax < xmin or ymax < ymin), return 0.
+    return static_cast<T>(0.);
+  } else {
+    const T w = box[2] - box[0];
+    const T h = box[3] - box[1];
+    if (normalized) {
+      return w * h;
+    } else {
+      // If coordinate values are not within range [0, 1].
+      return (w + 1) * (h + 1);
+    }
+  }
+}
+
+// The IoU of two boxes of [xmin, ymin, xmax, ymax], which is also used by
+// the CUDA kernels, so std::max and std::min are not used.
+template <class T>
+HOSTDEVICE inline T JaccardOverlap(const T* box1, const T* box2,
+                                   const bool normalized) {
+  if (box2[0] > box1[2] || box2[2] < box1[0] || box2[1] > box1[3] ||
+      box2[3] < box1[1]) {
+    return static_cast<T>(0.);
+  } else {
+    const T inter_xmin = box1[0] > box2[0] ? box1[0] : box2[0];
+    const T inter_ymin = box1[1] > box2[1] ? box1[1] : box2[1];
+    const T inter_xmax = box1[2] < box2[2] ? box1[2] : box2[2];
+    const T inter_ymax = box1[3] < box2[3] ? box1[3] : box2[3];
+    const T inter_w = inter_xmax - inter_xmin;
+    const T inter_h = inter_ymax - inter_ymin;
+    const T inter_area = inter_w * inter_h;
+    const T bbox1_area = BBoxArea<T>(box1, normalized);
+    const T bbox2_area = BBoxArea<T>(box2, normalized);
+    return inter_area / (bbox1_area + bbox2_area - inter_area);
+  }
+}
+
 }  // namespace operators
 }  // namespace paddle
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include <paddle/fluid/memory/allocation/allocator.h>
 #include <stdio.h>
+#include <algorithm>
 #include <string>
 #include <vector>
 #include "cub/cub.cuh"
@@ -21,7 +22,6 @@ limitations under the License. */
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/memory/memory.h"
 #include "paddle/fluid/operators/detail/safe_ref.h"
-#include "paddle/fluid/operators/gather.cu.h"
 #include "paddle/fluid/operators/math/math_function.h"
 #include "paddle/fluid/platform/for_range.h"
 
@@ -42,43 +42,59 @@ int const kThreadsPerBlock = sizeof(uint64_t) * 8;
 
 static const double kBBoxClipDefault = std::log(1000.0 / 16.0);
 
-struct RangeInitFunctor {
-  int start_;
-  int delta_;
-  int *out_;
-  __device__ void operator()(size_t i) { out_[i] = start_ + i * delta_; }
-};
+// Every image is a segment of num_anchors scores.
+static __global__ void InitSegmentKernel(const int num, const int num_anchors,
+                                         int *offsets, int *indices) {
+  CUDA_1D_KERNEL_LOOP(i, num * num_anchors) {
+    indices[i] = i % num_anchors;
+    if (i % num_anchors == 0) offsets[i / num_anchors] = i;
+  }
+  if (blockIdx.x == 0 && threadIdx.x == 0) {
+    offsets[num] = num * num_anchors;
+  }
+}
 
+// Sort the scores of every image in descending order by one segmented sort,
+// value is [num, num_anchors], index_out is the offsets in the images.
 template <typename T>
-static void SortDescending(const platform::CUDADeviceContext &ctx,
-                           const Tensor &value, Tensor *value_out,
-                           Tensor *index_out) {
-  int num = static_cast<int>(value.numel());
-  Tensor index_in_t;
-  int *idx_in = index_in_t.mutable_data<int>({num}, ctx.GetPlace());
-  platform::ForRange<platform::CUDADeviceContext> for_range(ctx, num);
-  for_range(RangeInitFunctor{0, 1, idx_in});
-
-  int *idx_out = index_out->mutable_data<int>({num}, ctx.GetPlace());
+static void SegmentedSortDescending(const platform::CUDADeviceContext &ctx,
+                                    const Tensor &value, int num,
+                                    int num_anchors, Tensor *value_out,
+                                    Tensor *index_out) {
+  int total = num * num_anchors;
+  Tensor offsets_t, index_in_t;
+  int *offsets = offsets_t.mutable_data<int>({num + 1}, ctx.GetPlace());
+  int *idx_in = index_in_t.mutable_data<int>({total}, ctx.GetPlace());
+  int threads = 512;
+  int blocks = std::max(std::min(DIVUP(total, threads), 4096), 1);
+  InitSegmentKernel<<<blocks, threads, 0, ctx.stream()>>>(num, num_anchors,
+                                                          offsets, idx_in);
+
+  int *idx_out = index_out->mutable_data<int>({total}, ctx.GetPlace());
 
   const T *keys_in = value.data<T>();
-  T *keys_out = value_out->mutable_data<T>({num}, ctx.GetPlace());
+  T *keys_out = value_out->mutable_data<T>({total}, ctx.GetPlace());
 
   // Determine temporary device storage requirements
   size_t temp_storage_bytes = 0;
-  cub::DeviceRadixSort::SortPairsDescending<T, int>(
-      nullptr, temp_storage_bytes, keys_in, keys_out, idx_in, idx_out, num);
+  cub::DeviceSegmentedRadixSort::SortPairsDescending<T, int>(
+      nullptr, temp_storage_bytes, keys_in, keys_out, idx_in, idx_out, total,
+      num, offsets, offsets + 1, 0, sizeof(T) * 8, ctx.stream());
   // Allocate temporary storage
   auto place = boost::get<platform::CUDAPlace>(ctx.GetPlace());
   auto d_temp_storage =
       memory::Alloc(place, temp_storage_bytes, memory::Allocator::kScratchpad);
 
   // Run sorting operation
-  cub::DeviceRadixSort::SortPairsDescending<T, int>(
+  cub::DeviceSegmentedRadixSort::SortPairsDescending<T, int>(
       d_temp_storage->ptr(), temp_storage_bytes, keys_in, keys_out, idx_in,
-      idx_out, num);
+      idx_out, total, num, offsets, offsets + 1, 0, sizeof(T) * 8,
+      ctx.stream());
 }
 
+// Decode and clip the top pre_nms_num anchors of every image, the proposal i
+// is the anchor index[i / pre_nms_num * num_anchors + i % pre_nms_num] of the
+// image i / pre_nms_num.
 template <typename T>
 struct BoxDecodeAndClipFunctor {
   const T *anchor;
@@ -86,22 +102,31 @@ struct BoxDecodeAndClipFunctor {
   const T *var;
   const int *index;
   const T *im_info;
+  const int num_anchors;
+  const int pre_nms_num;
 
   T *proposals;
 
   BoxDecodeAndClipFunctor(const T *anchor, const T *deltas, const T *var,
-                          const int *index, const T *im_info, T *proposals)
+                          const int *index, const T *im_info,
+                          const int num_anchors, const int pre_nms_num,
+                          T *proposals)
       : anchor(anchor),
         deltas(deltas),
         var(var),
         index(index),
         im_info(im_info),
+        num_anchors(num_anchors),
+        pre_nms_num(pre_nms_num),
         proposals(proposals) {}
 
   T bbox_clip_default{static_cast<T>(kBBoxClipDefault)};
 
   __device__ void operator()(size_t i) {
-    int k = index[i] * 4;
+    int img = i / pre_nms_num;
+    int k = index[img * num_anchors + i % pre_nms_num] * 4;
+    const T *img_deltas = deltas + img * num_anchors * 4;
+    const T *img_info = im_info + img * 3;
     T axmin = anchor[k];
     T aymin = anchor[k + 1];
     T axmax = anchor[k + 2];
@@ -112,10 +137,10 @@ struct BoxDecodeAndClipFunctor {
     T cx = axmin + 0.5 * w;
     T cy = aymin + 0.5 * h;
 
-    T dxmin = deltas[k];
-    T dymin = deltas[k + 1];
-    T dxmax = deltas[k + 2];
-    T dymax = deltas[k + 3];
+    T dxmin = img_deltas[k];
+    T dymin = img_deltas[k + 1];
+    T dxmax = img_deltas[k + 2];
+    T dymax = img_deltas[k + 3];
 
     T d_cx, d_cy, d_w, d_h;
     if (var) {
@@ -135,10 +160,10 @@ struct BoxDecodeAndClipFunctor {
     T oxmax = d_cx + d_w * 0.5 - 1.;
     T oymax = d_cy + d_h * 0.5 - 1.;
 
-    proposals[i * 4] = Max(Min(oxmin, im_info[1] - 1.), 0.);
-    proposals[i * 4 + 1] = Max(Min(oymin, im_info[0] - 1.), 0.);
-    proposals[i * 4 + 2] = Max(Min(oxmax, im_info[1] - 1.), 0.);
-    proposals[i * 4 + 3] = Max(Min(oymax, im_info[0] - 1.), 0.);
+    proposals[i * 4] = Max(Min(oxmin, img_info[1] - 1.), 0.);
+    proposals[i * 4 + 1] = Max(Min(oymin, img_info[0] - 1.), 0.);
+    proposals[i * 4 + 2] = Max(Min(oxmax, img_info[1] - 1.), 0.);
+    proposals[i * 4 + 3] = Max(Min(oymax, img_info[0] - 1.), 0.);
   }
 
   __device__ __forceinline__ T Min(T a, T b) const { return a > b ? b : a; }
@@ -146,41 +171,49 @@ struct BoxDecodeAndClipFunctor {
   __device__ __forceinline__ T Max(T a, T b) const { return a > b ? a : b; }
 };
 
+// Every block filters the num proposals of the image blockIdx.x in order,
+// keep[img * num, ...) are the kept offsets and keep_num[img] is the number.
 template <typename T, int BlockSize>
 static __global__ void FilterBBoxes(const T *bboxes, const T *im_info,
                                     const T min_size, const int num,
                                     int *keep_num, int *keep) {
-  T im_h = im_info[0];
-  T im_w = im_info[1];
-  T im_scale = im_info[2];
+  const int img = blockIdx.x;
+  bboxes += img * num * 4;
+  keep += img * num;
+  T im_h = im_info[img * 3];
+  T im_w = im_info[img * 3 + 1];
+  T im_scale = im_info[img * 3 + 2];
 
   int cnt = 0;
   __shared__ int keep_index[BlockSize];
 
-  CUDA_1D_KERNEL_LOOP(i, num) {
+  for (int begin = 0; begin < num; begin += BlockSize) {
+    int i = begin + threadIdx.x;
     keep_index[threadIdx.x] = -1;
     __syncthreads();
 
-    int k = i * 4;
-    T xmin = bboxes[k];
-    T ymin = bboxes[k + 1];
-    T xmax = bboxes[k + 2];
-    T ymax = bboxes[k + 3];
+    if (i < num) {
+      int k = i * 4;
+      T xmin = bboxes[k];
+      T ymin = bboxes[k + 1];
+      T xmax = bboxes[k + 2];
+      T ymax = bboxes[k + 3];
 
-    T w = xmax - xmin + 1.0;
-    T h = ymax - ymin + 1.0;
-    T cx = xmin + w / 2.;
-    T cy = ymin + h / 2.;
+      T w = xmax - xmin + 1.0;
+      T h = ymax - ymin + 1.0;
+      T cx = xmin + w / 2.;
+      T cy = ymin + h / 2.;
 
-    T w_s = (xmax - xmin) / im_scale + 1.;
-    T h_s = (ymax - ymin) / im_scale + 1.;
+      T w_s = (xmax - xmin) / im_scale + 1.;
+      T h_s = (ymax - ymin) / im_scale + 1.;
 
-    if (w_s >= min_size && h_s >= min_size && cx <= im_w && cy <= im_h) {
-      keep_index[threadIdx.x] = i;
+      if (w_s >= min_size && h_s >= min_size && cx <= im_w && cy <= im_h) {
+        keep_index[threadIdx.x] = i;
+      }
     }
     __syncthreads();
     if (threadIdx.x == 0) {
-      int size = (num - i) < BlockSize ? num - i : BlockSize;
+      int size = (num - begin) < BlockSize ? num - begin : BlockSize;
       for (int j = 0; j < size; ++j) {
         if (keep_index[j] > -1) {
           keep[cnt++] = keep_index[j];
@@ -190,7 +223,7 @@ static __global__ void FilterBBoxes(const T *bboxes, const T *im_info,
     __syncthreads();
   }
   if (threadIdx.x == 0) {
-    keep_num[0] = cnt;
+    keep_num[img] = cnt;
   }
 }
 
@@ -204,11 +237,22 @@ static __device__ inline float IoU(const float *a, const float *b) {
   return inter_s / (s_a + s_b - inter_s);
 }
 
-static __global__ void NMSKernel(const int n_boxes,
+// The IoU bitmask of the filtered proposals of the image blockIdx.z, whose
+// proposal i is dev_boxes[img * num + keep[img * num + i]].
+static __global__ void NMSKernel(const int num, const int *keep_num,
+                                 const int *keep, const int max_boxes,
                                  const float nms_overlap_thresh,
                                  const float *dev_boxes, uint64_t *dev_mask) {
+  const int img = blockIdx.z;
+  const int n_boxes = keep_num[img];
   const int row_start = blockIdx.y;
   const int col_start = blockIdx.x;
+  if (row_start * kThreadsPerBlock >= n_boxes ||
+      col_start * kThreadsPerBlock >= n_boxes) {
+    return;
+  }
+  dev_boxes += img * num * 4;
+  keep += img * num;
 
   const int row_size =
       min(n_boxes - row_start * kThreadsPerBlock, kThreadsPerBlock);
@@ -217,20 +261,18 @@ static __global__ void NMSKernel(const int n_boxes,
 
   __shared__ float block_boxes[kThreadsPerBlock * 4];
   if (threadIdx.x < col_size) {
-    block_boxes[threadIdx.x * 4 + 0] =
-        dev_boxes[(kThreadsPerBlock * col_start + threadIdx.x) * 4 + 0];
-    block_boxes[threadIdx.x * 4 + 1] =
-        dev_boxes[(kThreadsPerBlock * col_start + threadIdx.x) * 4 + 1];
-    block_boxes[threadIdx.x * 4 + 2] =
-        dev_boxes[(kThreadsPerBlock * col_start + threadIdx.x) * 4 + 2];
-    block_boxes[threadIdx.x * 4 + 3] =
-        dev_boxes[(kThreadsPerBlock * col_start + threadIdx.x) * 4 + 3];
+    const float *box =
+        dev_boxes + keep[kThreadsPerBlock * col_start + threadIdx.x] * 4;
+    block_boxes[threadIdx.x * 4 + 0] = box[0];
+    block_boxes[threadIdx.x * 4 + 1] = box[1];
+    block_boxes[threadIdx.x * 4 + 2] = box[2];
+    block_boxes[threadIdx.x * 4 + 3] = box[3];
   }
   __syncthreads();
 
   if (threadIdx.x < row_size) {
     const int cur_box_idx = kThreadsPerBlock * row_start + threadIdx.x;
-    const float *cur_box = dev_boxes + cur_box_idx * 4;
+    const float *cur_box = dev_boxes + keep[cur_box_idx] * 4;
     int i = 0;
     uint64_t t = 0;
     int start = 0;
@@ -242,120 +284,60 @@ static __global__ void NMSKernel(const int n_boxes,
         t |= 1ULL << i;
       }
     }
-    const int col_blocks = DIVUP(n_boxes, kThreadsPerBlock);
-    dev_mask[cur_box_idx * col_blocks + col_start] = t;
+    const int col_blocks = DIVUP(max_boxes, kThreadsPerBlock);
+    dev_mask[(img * max_boxes + cur_box_idx) * col_blocks + col_start] = t;
   }
 }
 
-template <typename T>
-static void NMS(const platform::CUDADeviceContext &ctx, const Tensor &proposals,
-                const Tensor &sorted_indices, const T nms_threshold,
-                Tensor *keep_out) {
-  int boxes_num = proposals.dims()[0];
-  PADDLE_ENFORCE_EQ(boxes_num, sorted_indices.dims()[0]);
-
-  const int col_blocks = DIVUP(boxes_num, kThreadsPerBlock);
-  dim3 blocks(DIVUP(boxes_num, kThreadsPerBlock),
-              DIVUP(boxes_num, kThreadsPerBlock));
-  dim3 threads(kThreadsPerBlock);
-
-  const T *boxes = proposals.data<T>();
-  auto place = boost::get<platform::CUDAPlace>(ctx.GetPlace());
-  framework::Vector<uint64_t> mask(boxes_num * col_blocks);
-  NMSKernel<<<blocks, threads>>>(
-      boxes_num, nms_threshold, boxes,
-      mask.CUDAMutableData(boost::get<platform::CUDAPlace>(ctx.GetPlace())));
-
-  std::vector<uint64_t> remv(col_blocks);
-  memset(&remv[0], 0, sizeof(uint64_t) * col_blocks);
-
-  std::vector<int> keep_vec;
-  int num_to_keep = 0;
-  for (int i = 0; i < boxes_num; i++) {
-    int nblock = i / kThreadsPerBlock;
-    int inblock = i % kThreadsPerBlock;
-
-    if (!(remv[nblock] & (1ULL << inblock))) {
-      ++num_to_keep;
-      keep_vec.push_back(i);
-      uint64_t *p = &mask[0] + i * col_blocks;
-      for (int j = nblock; j < col_blocks; j++) {
-        remv[j] |= p[j];
+// Every thread greedily keeps the filtered proposals of one image by the
+// bitmask, nms_keep[img * max_boxes, ...) are the kept offsets in the
+// filtered proposals and nms_num[img] is the number.
+static __global__ void NMSReduceKernel(const int num_images,
+                                       const int *keep_num,
+                                       const int max_boxes,
+                                       const uint64_t *dev_mask,
+                                       uint64_t *removed, int *nms_keep,
+                                       int *nms_num) {
+  CUDA_1D_KERNEL_LOOP(img, num_images) {
+    const int n_boxes = keep_num[img];
+    const int col_blocks = DIVUP(max_boxes, kThreadsPerBlock);
+    const int n_blocks = DIVUP(n_boxes, kThreadsPerBlock);
+    uint64_t *remv = removed + img * col_blocks;
+    for (int j = 0; j < n_blocks; ++j) remv[j] = 0;
+
+    int num_to_keep = 0;
+    for (int i = 0; i < n_boxes; i++) {
+      int nblock = i / kThreadsPerBlock;
+      int inblock = i % kThreadsPerBlock;
+
+      if (!(remv[nblock] & (1ULL << inblock))) {
+        nms_keep[img * max_boxes + num_to_keep++] = i;
+        const uint64_t *p = dev_mask + (img * max_boxes + i) * col_blocks;
+        for (int j = nblock; j < n_blocks; j++) {
+          remv[j] |= p[j];
+        }
       }
     }
+    nms_num[img] = num_to_keep;
   }
-  int *keep = keep_out->mutable_data<int>({num_to_keep}, ctx.GetPlace());
-  memory::Copy(place, keep, platform::CPUPlace(), keep_vec.data(),
-               sizeof(int) * num_to_keep, 0);
 }
 
+// Write the output proposal i from the filtered proposal rows[i] of the
+// image rows[i] / pre_nms_num.
 template <typename T>
-static std::pair<Tensor, Tensor> ProposalForOneImage(
-    const platform::CUDADeviceContext &ctx, const Tensor &im_info,
-    const Tensor &anchors, const Tensor &variances,
-    const Tensor &bbox_deltas,  // [M, 4]
-    const Tensor &scores,       // [N, 1]
-    int pre_nms_top_n, int post_nms_top_n, float nms_thresh, float min_size,
-    float eta) {
-  // 1. pre nms
-  Tensor scores_sort, index_sort;
-  SortDescending<T>(ctx, scores, &scores_sort, &index_sort);
-  int num = scores.numel();
-  int pre_nms_num = (pre_nms_top_n <= 0 || pre_nms_top_n > num) ? scores.numel()
-                                                                : pre_nms_top_n;
-  scores_sort.Resize({pre_nms_num, 1});
-  index_sort.Resize({pre_nms_num, 1});
-
-  // 2. box decode and clipping
-  Tensor proposals;
-  proposals.mutable_data<T>({pre_nms_num, 4}, ctx.GetPlace());
-
-  {
-    platform::ForRange<platform::CUDADeviceContext> for_range(ctx, pre_nms_num);
-    for_range(BoxDecodeAndClipFunctor<T>{
-        anchors.data<T>(), bbox_deltas.data<T>(), variances.data<T>(),
-        index_sort.data<int>(), im_info.data<T>(), proposals.data<T>()});
-  }
-
-  // 3. filter
-  Tensor keep_index, keep_num_t;
-  keep_index.mutable_data<int>({pre_nms_num}, ctx.GetPlace());
-  keep_num_t.mutable_data<int>({1}, ctx.GetPlace());
-  min_size = std::max(min_size, 1.0f);
-  auto stream = ctx.stream();
-  FilterBBoxes<T, 512><<<1, 512, 0, stream>>>(
-      proposals.data<T>(), im_info.data<T>(), min_size, pre_nms_num,
-      keep_num_t.data<int>(), keep_index.data<int>());
-  int keep_num;
-  const auto gpu_place = boost::get<platform::CUDAPlace>(ctx.GetPlace());
-  memory::Copy(platform::CPUPlace(), &keep_num, gpu_place,
-               keep_num_t.data<int>(), sizeof(int), 0);
-  keep_index.Resize({keep_num});
-
-  Tensor scores_filter, proposals_filter;
-  proposals_filter.mutable_data<T>({keep_num, 4}, ctx.GetPlace());
-  scores_filter.mutable_data<T>({keep_num, 1}, ctx.GetPlace());
-  GPUGather<T>(ctx, proposals, keep_index, &proposals_filter);
-  GPUGather<T>(ctx, scores_sort, keep_index, &scores_filter);
-
-  if (nms_thresh <= 0) {
-    return std::make_pair(proposals_filter, scores_filter);
-  }
-
-  // 4. nms
-  Tensor keep_nms;
-  NMS<T>(ctx, proposals_filter, keep_index, nms_thresh, &keep_nms);
-  if (post_nms_top_n > 0 && post_nms_top_n < keep_nms.numel()) {
-    keep_nms.Resize({post_nms_top_n});
+static __global__ void GatherProposals(const T *proposals,
+                                       const T *sorted_scores, const int *keep,
+                                       const int *rows, const int num_rows,
+                                       const int num_anchors,
+                                       const int pre_nms_num, T *rois,
+                                       T *roi_probs) {
+  CUDA_1D_KERNEL_LOOP(i, num_rows) {
+    int img = rows[i] / pre_nms_num;
+    int k = keep[rows[i]];
+    const T *box = proposals + (img * pre_nms_num + k) * 4;
+    for (int j = 0; j < 4; ++j) rois[i * 4 + j] = box[j];
+    roi_probs[i] = sorted_scores[img * num_anchors + k];
   }
-
-  Tensor scores_nms, proposals_nms;
-  proposals_nms.mutable_data<T>({keep_nms.numel(), 4}, ctx.GetPlace());
-  scores_nms.mutable_data<T>({keep_nms.numel(), 1}, ctx.GetPlace());
-  GPUGather<T>(ctx, proposals_filter, keep_nms, &proposals_nms);
-  GPUGather<T>(ctx, scores_filter, keep_nms, &scores_nms);
-
-  return std::make_pair(proposals_nms, scores_nms);
 }
 }  // namespace
 
@@ -418,31 +400,102 @@ class CUDAGenerateProposalsKernel : public framework::OpKernel<T> {
     T *rpn_roi_probs_data = rpn_roi_probs->data<T>();
 
     auto place = boost::get<platform::CUDAPlace>(dev_ctx.GetPlace());
+    auto stream = dev_ctx.stream();
+
+    // All the images are processed at once, and only the numbers and the
+    // offsets of the kept proposals are copied to the host.
+    // 1. pre nms
+    int num_images = static_cast<int>(num);
+    int num_anchors = static_cast<int>(h_score * w_score * c_score);
+    Tensor scores_sort, index_sort;
+    SegmentedSortDescending<T>(dev_ctx, scores_swap, num_images, num_anchors,
+                               &scores_sort, &index_sort);
+    int pre_nms_num = (pre_nms_top_n <= 0 || pre_nms_top_n > num_anchors)
+                          ? num_anchors
+                          : pre_nms_top_n;
+
+    // 2. box decode and clipping
+    Tensor proposals;
+    proposals.mutable_data<T>({num_images * pre_nms_num, 4},
+                              dev_ctx.GetPlace());
+    {
+      platform::ForRange<DeviceContext> for_range(dev_ctx,
+                                                  num_images * pre_nms_num);
+      for_range(BoxDecodeAndClipFunctor<T>{
+          anchors.data<T>(), bbox_deltas_swap.data<T>(), variances.data<T>(),
+          index_sort.data<int>(), im_info->data<T>(), num_anchors,
+          pre_nms_num, proposals.data<T>()});
+    }
 
-    int64_t num_proposals = 0;
+    // 3. filter
+    Tensor keep_index, keep_num_t;
+    int *keep = keep_index.mutable_data<int>({num_images * pre_nms_num},
+                                             dev_ctx.GetPlace());
+    int *keep_num =
+        keep_num_t.mutable_data<int>({num_images}, dev_ctx.GetPlace());
+    min_size = std::max(min_size, 1.0f);
+    FilterBBoxes<T, 512><<<num_images, 512, 0, stream>>>(
+        proposals.data<T>(), im_info->data<T>(), min_size, pre_nms_num,
+        keep_num, keep);
+    std::vector<int> cpu_keep_num(num_images);
+    memory::Copy(platform::CPUPlace(), cpu_keep_num.data(), place, keep_num,
+                 sizeof(int) * num_images, stream);
+    dev_ctx.Wait();
+
+    // 4. nms, the kept offsets in the filtered proposals of every image.
+    std::vector<int> cpu_nms_num = cpu_keep_num;
+    std::vector<int> cpu_nms_keep;
+    int max_boxes =
+        *std::max_element(cpu_keep_num.begin(), cpu_keep_num.end());
+    if (nms_thresh > 0 && max_boxes > 0) {
+      const int col_blocks = DIVUP(max_boxes, kThreadsPerBlock);
+      Tensor mask_t, removed_t, nms_keep_t, nms_num_t;
+      auto *mask = reinterpret_cast<uint64_t *>(mask_t.mutable_data<int64_t>(
+          {num_images * max_boxes * col_blocks}, dev_ctx.GetPlace()));
+      auto *removed =
+          reinterpret_cast<uint64_t *>(removed_t.mutable_data<int64_t>(
+              {num_images * col_blocks}, dev_ctx.GetPlace()));
+      int *nms_keep = nms_keep_t.mutable_data<int>({num_images * max_boxes},
+                                                   dev_ctx.GetPlace());
+      int *nms_num =
+          nms_num_t.mutable_data<int>({num_images}, dev_ctx.GetPlace());
+
+      dim3 blocks(col_blocks, col_blocks, num_images);
+      NMSKernel<<<blocks, kThreadsPerBlock, 0, stream>>>(
+          pre_nms_num, keep_num, keep, max_boxes, nms_thresh,
+          proposals.data<T>(), mask);
+      NMSReduceKernel<<<DIVUP(num_images, 512), 512, 0, stream>>>(
+          num_images, keep_num, max_boxes, mask, removed, nms_keep, nms_num);
+
+      cpu_nms_keep.resize(num_images * max_boxes);
+      memory::Copy(platform::CPUPlace(), cpu_nms_num.data(), place, nms_num,
+                   sizeof(int) * num_images, stream);
+      memory::Copy(platform::CPUPlace(), cpu_nms_keep.data(), place, nms_keep,
+                   sizeof(int) * cpu_nms_keep.size(), stream);
+      dev_ctx.Wait();
+    }
+
+    // 5. the output rows, which are the offsets in keep_index.
+    std::vector<int> rows;
     std::vector<size_t> offset(1, 0);
-    for (int64_t i = 0; i < num; ++i) {
-      Tensor im_info_slice = im_info->Slice(i, i + 1);
-      Tensor bbox_deltas_slice = bbox_deltas_swap.Slice(i, i + 1);
-      Tensor scores_slice = scores_swap.Slice(i, i + 1);
-
-      bbox_deltas_slice.Resize({h_bbox * w_bbox * c_bbox / 4, 4});
-      scores_slice.Resize({h_score * w_score * c_score, 1});
-
-      std::pair<Tensor, Tensor> box_score_pair =
-          ProposalForOneImage<T>(dev_ctx, im_info_slice, anchors, variances,
-                                 bbox_deltas_slice, scores_slice, pre_nms_top_n,
-                                 post_nms_top_n, nms_thresh, min_size, eta);
-
-      Tensor &proposals = box_score_pair.first;
-      Tensor &scores = box_score_pair.second;
-
-      memory::Copy(place, rpn_rois_data + num_proposals * 4, place,
-                   proposals.data<T>(), sizeof(T) * proposals.numel(), 0);
-      memory::Copy(place, rpn_roi_probs_data + num_proposals, place,
-                   scores.data<T>(), sizeof(T) * scores.numel(), 0);
-      num_proposals += proposals.dims()[0];
-      offset.emplace_back(num_proposals);
+    for (int i = 0; i < num_images; ++i) {
+      int n = cpu_nms_num[i];
+      if (nms_thresh > 0 && post_nms_top_n > 0 && post_nms_top_n < n) {
+        n = post_nms_top_n;
+      }
+      for (int j = 0; j < n; ++j) {
+        int k = cpu_nms_keep.empty() ? j : cpu_nms_keep[i * max_boxes + j];
+        rows.push_back(i * pre_nms_num + k);
+      }
+      offset.emplace_back(rows.size());
+    }
+    int64_t num_proposals = static_cast<int64_t>(rows.size());
+    if (num_proposals > 0) {
+      framework::Vector<int> dev_rows(rows);
+      GatherProposals<T><<<DIVUP(num_proposals, 512), 512, 0, stream>>>(
+          proposals.data<T>(), scores_sort.data<T>(), keep,
+          dev_rows.CUDAData(dev_ctx.GetPlace()), num_proposals, num_anchors,
+          pre_nms_num, rpn_rois_data, rpn_roi_probs_data);
     }
     framework::LoD lod;
     lod.emplace_back(offset);
@@ -13,6 +13,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 limitations under the License. */
 
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/detection/bbox_util.h"
 #include "paddle/fluid/operators/detection/poly_util.h"
 
 namespace paddle {
@@ -64,9 +65,14 @@ class MultiClassNMSOp : public framework::OperatorWithKernel {
  protected:
   framework::OpKernelType GetExpectedKernelType(
       const framework::ExecutionContext& ctx) const override {
+    // The GPU kernel only supports the boxes of 4 coordinates without the
+    // adaptive NMS, the others are run on CPU.
+    auto* boxes = ctx.Input<framework::LoDTensor>("BBoxes");
+    bool on_gpu = platform::is_gpu_place(ctx.GetPlace()) &&
+                  boxes->dims()[2] == 4 && ctx.Attr<float>("nms_eta") >= 1.;
     return framework::OpKernelType(
         ctx.Input<framework::LoDTensor>("Scores")->type(),
-        platform::CPUPlace());
+        on_gpu ? ctx.GetPlace() : platform::Place(platform::CPUPlace()));
   }
 };
 
@@ -94,44 +100,6 @@ static inline void GetMaxScoreIndex(
   }
 }
 
-template <class T>
-static inline T BBoxArea(const T* box, const bool normalized) {
-  if (box[2] < box[0] || box[3] < box[1]) {
-    // If coordinate values are is invalid
-    // (e.g. xmax < xmin or ymax < ymin), return 0.
-    return static_cast<T>(0.);
-  } else {
-    const T w = box[2] - box[0];
-    const T h = box[3] - box[1];
-    if (normalized) {
-      return w * h;
-    } else {
-      // If coordinate values are not within range [0, 1].
-      return (w + 1) * (h + 1);
-    }
-  }
-}
-
-template <class T>
-static inline T JaccardOverlap(const T* box1, const T* box2,
-                               const bool normalized) {
-  if (box2[0] > box1[2] || box2[2] < box1[0] || box2[1] > box1[3] ||
-      box2[3] < box1[1]) {
-    return static_cast<T>(0.);
-  } else {
-    const T inter_xmin = std::max(box1[0], box2[0]);
-    const T inter_ymin = std::max(box1[1], box2[1]);
-    const T inter_xmax = std::min(box1[2], box2[2]);
-    const T inter_ymax = std::min(box1[3], box2[3]);
-    const T inter_w = inter_xmax - inter_xmin;
-    const T inter_h = inter_ymax - inter_ymin;
-    const T inter_area = inter_w * inter_h;
-    const T bbox1_area = BBoxArea<T>(box1, normalized);
-    const T bbox2_area = BBoxArea<T>(box2, normalized);
-    return inter_area / (bbox1_area + bbox2_area - inter_area);
-  }
-}
-
 template <class T>
 T PolyIoU(const T* box1, const T* box2, const size_t box_size,
           const bool normalized) {
@@ -0,0 +1,350 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "cub/cub.cuh"
+#include "paddle/fluid/framework/mixed_vector.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/memory/memory.h"
+#include "paddle/fluid/operators/detection/bbox_util.h"
+#include "paddle/fluid/operators/math/math_function.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+using LoDTensor = framework::LoDTensor;
+
+namespace {
+
+#define DIVUP(m, n) ((m) / (n) + ((m) % (n) > 0))
+#define CUDA_1D_KERNEL_LOOP(i, n)                              \
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < (n); \
+       i += blockDim.x * gridDim.x)
+
+int const kThreadsPerBlock = sizeof(uint64_t) * 8;
+int const kNumCUDAThreads = 512;
+
+// Every (image, class) pair is a segment of predict_dim scores.
+__global__ void InitSegmentKernel(int num_segments, int predict_dim,
+                                  int* offsets, int* indices) {
+  CUDA_1D_KERNEL_LOOP(i, num_segments * predict_dim) {
+    indices[i] = i % predict_dim;
+    if (i % predict_dim == 0) offsets[i / predict_dim] = i;
+  }
+  if (blockIdx.x == 0 && threadIdx.x == 0) {
+    offsets[num_segments] = num_segments * predict_dim;
+  }
+}
+
+// The number of the candidates of every segment, which is the number of the
+// sorted scores larger than score_threshold, at most top_k if top_k > -1.
+template <typename T>
+__global__ void CandidateNumKernel(const T* sorted_scores, int num_segments,
+                                   int class_num, int predict_dim,
+                                   int background_label, T score_threshold,
+                                   int top_k, int* counts) {
+  CUDA_1D_KERNEL_LOOP(seg, num_segments) {
+    if (seg % class_num == background_label) {
+      counts[seg] = 0;
+      continue;
+    }
+    const T* scores = sorted_scores + seg * predict_dim;
+    int low = 0, high = predict_dim;
+    while (low < high) {
+      int mid = (low + high) / 2;
+      if (scores[mid] > score_threshold) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    counts[seg] = (top_k > -1 && top_k < low) ? top_k : low;
+  }
+}
+
+// The bitmask of the candidates of the segment blockIdx.z, the bit j of
+// masks[(seg * max_num + i) * col_blocks + j / 64] is set if the IoU of the
+// candidates i and j is larger than nms_threshold, for j > i.
+template <typename T>
+__global__ void NMSMaskKernel(const T* bboxes, const int* sorted_indices,
+                              const int* counts, int class_num,
+                              int predict_dim, int max_num, int col_blocks,
+                              T nms_threshold, uint64_t* masks) {
+  const int seg = blockIdx.z;
+  const int n_boxes = counts[seg];
+  const int row_start = blockIdx.y;
+  const int col_start = blockIdx.x;
+  if (row_start * kThreadsPerBlock >= n_boxes ||
+      col_start * kThreadsPerBlock >= n_boxes) {
+    return;
+  }
+
+  const int row_size =
+      min(n_boxes - row_start * kThreadsPerBlock, kThreadsPerBlock);
+  const int col_size =
+      min(n_boxes - col_start * kThreadsPerBlock, kThreadsPerBlock);
+  const T* boxes = bboxes + (seg / class_num) * predict_dim * 4;
+  const int* index = sorted_indices + seg * predict_dim;
+
+  __shared__ T block_boxes[kThreadsPerBlock * 4];
+  if (threadIdx.x < col_size) {
+    const T* box =
+        boxes + index[kThreadsPerBlock * col_start + threadIdx.x] * 4;
+    for (int k = 0; k < 4; ++k) block_boxes[threadIdx.x * 4 + k] = box[k];
+  }
+  __syncthreads();
+
+  if (threadIdx.x < row_size) {
+    const int cur_box_idx = kThreadsPerBlock * row_start + threadIdx.x;
+    const T* cur_box = boxes + index[cur_box_idx] * 4;
+    uint64_t t = 0;
+    int start = row_start == col_start ? threadIdx.x + 1 : 0;
+    for (int i = start; i < col_size; i++) {
+      if (JaccardOverlap<T>(cur_box, block_boxes + i * 4, true) >
+          nms_threshold) {
+        t |= 1ULL << i;
+      }
+    }
+    masks[(static_cast<int64_t>(seg) * max_num + cur_box_idx) * col_blocks +
+          col_start] = t;
+  }
+}
+
+// Every thread greedily keeps the candidates of one segment by the bitmask.
+__global__ void NMSReduceKernel(const uint64_t* masks, const int* counts,
+                                int num_segments, int max_num, int col_blocks,
+                                uint64_t* removed, int* keep, int* keep_nums) {
+  CUDA_1D_KERNEL_LOOP(seg, num_segments) {
+    const int n_boxes = counts[seg];
+    const int n_blocks = DIVUP(n_boxes, kThreadsPerBlock);
+    uint64_t* remv = removed + static_cast<int64_t>(seg) * col_blocks;
+    for (int j = 0; j < n_blocks; ++j) remv[j] = 0;
+
+    int num_keep = 0;
+    for (int i = 0; i < n_boxes; ++i) {
+      int nblock = i / kThreadsPerBlock;
+      int inblock = i % kThreadsPerBlock;
+      if (!(remv[nblock] & (1ULL << inblock))) {
+        keep[static_cast<int64_t>(seg) * max_num + num_keep++] = i;
+        const uint64_t* p =
+            masks + (static_cast<int64_t>(seg) * max_num + i) * col_blocks;
+        for (int j = nblock; j < n_blocks; ++j) remv[j] |= p[j];
+      }
+    }
+    keep_nums[seg] = num_keep;
+  }
+}
+
+// Write the output row i from the candidate rows[i], which is the offset in
+// the sorted scores.
+template <typename T>
+__global__ void NMSOutputKernel(const T* bboxes, const T* sorted_scores,
+                                const int* sorted_indices, const int* rows,
+                                int num_rows, int class_num, int predict_dim,
+                                T* out) {
+  CUDA_1D_KERNEL_LOOP(i, num_rows) {
+    int row = rows[i];
+    int seg = row / predict_dim;
+    const T* box = bboxes +
+                   (static_cast<int64_t>(seg / class_num) * predict_dim +
+                    sorted_indices[row]) *
+                       4;
+    T* out_row = out + i * 6;
+    out_row[0] = seg % class_num;     // label
+    out_row[1] = sorted_scores[row];  // score
+    for (int k = 0; k < 4; ++k) out_row[k + 2] = box[k];
+  }
+}
+
+}  // namespace
+
+// The GPU kernel of multiclass_nms for the boxes of [xmin, ymin, xmax, ymax]
+// without the adaptive NMS, which the op dispatches to CPU. The scores of all
+// the (image, class) pairs are sorted by one segmented sort, and NMS of all
+// of them is done by the IoU bitmask in one launch. Only the numbers and the
+// indices of the kept candidates are copied to the host, to apply keep_top_k
+// of every image and build the LoD, and the boxes never leave the device.
+template <typename T>
+class MultiClassNMSCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* boxes = ctx.Input<Tensor>("BBoxes");
+    auto* scores = ctx.Input<Tensor>("Scores");
+    auto* outs = ctx.Output<LoDTensor>("Out");
+    auto& dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
+    auto place = boost::get<platform::CUDAPlace>(dev_ctx.GetPlace());
+
+    int background_label = ctx.Attr<int>("background_label");
+    int nms_top_k = ctx.Attr<int>("nms_top_k");
+    int keep_top_k = ctx.Attr<int>("keep_top_k");
+    T nms_threshold = static_cast<T>(ctx.Attr<float>("nms_threshold"));
+    T score_threshold = static_cast<T>(ctx.Attr<float>("score_threshold"));
+    PADDLE_ENFORCE_GE(ctx.Attr<float>("nms_eta"), 1.,
+                      "Not support adaptive NMS on GPU.");
+    PADDLE_ENFORCE_EQ(boxes->dims()[2], 4,
+                      "Only support the boxes of 4 coordinates on GPU.");
+
+    auto score_dims = scores->dims();
+    int batch_size = static_cast<int>(score_dims[0]);
+    int class_num = static_cast<int>(score_dims[1]);
+    int predict_dim = static_cast<int>(score_dims[2]);
+    int num_segments = batch_size * class_num;
+    int num_scores = num_segments * predict_dim;
+    const T* boxes_data = boxes->data<T>();
+    int threads = kNumCUDAThreads;
+    int blocks = std::max(
+        std::min(DIVUP(num_scores, threads),
+                 dev_ctx.GetMaxPhysicalThreadCount() / threads),
+        1);
+
+    // 1. Sort the scores of every (image, class) pair in descending order,
+    // the sort is stable as std::stable_sort of the CPU kernel.
+    Tensor offsets_t, indices_t, sorted_scores_t, sorted_indices_t;
+    int* offsets = offsets_t.mutable_data<int>({num_segments + 1}, place);
+    int* indices = indices_t.mutable_data<int>({num_scores}, place);
+    T* sorted_scores = sorted_scores_t.mutable_data<T>({num_scores}, place);
+    int* sorted_indices =
+        sorted_indices_t.mutable_data<int>({num_scores}, place);
+    InitSegmentKernel<<<blocks, threads, 0, dev_ctx.stream()>>>(
+        num_segments, predict_dim, offsets, indices);
+
+    size_t temp_storage_bytes = 0;
+    cub::DeviceSegmentedRadixSort::SortPairsDescending<T, int>(
+        nullptr, temp_storage_bytes, scores->data<T>(), sorted_scores,
+        indices, sorted_indices, num_scores, num_segments, offsets,
+        offsets + 1, 0, sizeof(T) * 8, dev_ctx.stream());
+    auto temp_storage =
+        platform::DeviceTemporaryAllocator::Instance().Get(dev_ctx).Allocate(
+            temp_storage_bytes);
+    cub::DeviceSegmentedRadixSort::SortPairsDescending<T, int>(
+        temp_storage->ptr(), temp_storage_bytes, scores->data<T>(),
+        sorted_scores, indices, sorted_indices, num_scores, num_segments,
+        offsets, offsets + 1, 0, sizeof(T) * 8, dev_ctx.stream());
+
+    // 2. The candidates of every segment, whose max number decides the size
+    // of the bitmask.
+    Tensor counts_t;
+    int* counts = counts_t.mutable_data<int>({num_segments}, place);
+    int seg_blocks = DIVUP(num_segments, threads);
+    CandidateNumKernel<T><<<seg_blocks, threads, 0, dev_ctx.stream()>>>(
+        sorted_scores, num_segments, class_num, predict_dim, background_label,
+        score_threshold, nms_top_k, counts);
+    std::vector<int> cpu_counts(num_segments);
+    memory::Copy(platform::CPUPlace(), cpu_counts.data(), place, counts,
+                 sizeof(int) * num_segments, dev_ctx.stream());
+    dev_ctx.Wait();
+    int max_num = 0;
+    for (auto count : cpu_counts) max_num = std::max(max_num, count);
+
+    // 3. NMS of all the segments.
+    std::vector<int> cpu_keep_nums(num_segments, 0);
+    std::vector<int> cpu_keep;
+    if (max_num > 0) {
+      int col_blocks = DIVUP(max_num, kThreadsPerBlock);
+      PADDLE_ENFORCE_LE(num_segments, 65535,
+                        "The batch size times the class number should not "
+                        "be larger than 65535 on GPU.");
+      Tensor masks_t, removed_t, keep_t, keep_nums_t;
+      auto* masks = reinterpret_cast<uint64_t*>(masks_t.mutable_data<int64_t>(
+          {static_cast<int64_t>(num_segments) * max_num * col_blocks}, place));
+      auto* removed =
+          reinterpret_cast<uint64_t*>(removed_t.mutable_data<int64_t>(
+              {static_cast<int64_t>(num_segments) * col_blocks}, place));
+      int* keep = keep_t.mutable_data<int>(
+          {static_cast<int64_t>(num_segments) * max_num}, place);
+      int* keep_nums = keep_nums_t.mutable_data<int>({num_segments}, place);
+
+      dim3 mask_blocks(col_blocks, col_blocks, num_segments);
+      NMSMaskKernel<T><<<mask_blocks, kThreadsPerBlock, 0,
+                         dev_ctx.stream()>>>(
+          boxes_data, sorted_indices, counts, class_num, predict_dim, max_num,
+          col_blocks, nms_threshold, masks);
+      NMSReduceKernel<<<seg_blocks, threads, 0, dev_ctx.stream()>>>(
+          masks, counts, num_segments, max_num, col_blocks, removed, keep,
+          keep_nums);
+
+      cpu_keep.resize(keep_t.numel());
+      memory::Copy(platform::CPUPlace(), cpu_keep_nums.data(), place,
+                   keep_nums, sizeof(int) * num_segments, dev_ctx.stream());
+      memory::Copy(platform::CPUPlace(), cpu_keep.data(), place, keep,
+                   sizeof(int) * cpu_keep.size(), dev_ctx.stream());
+    }
+    std::vector<T> cpu_scores;
+    if (max_num > 0 && keep_top_k > -1) {
+      cpu_scores.resize(num_scores);
+      memory::Copy(platform::CPUPlace(), cpu_scores.data(), place,
+                   sorted_scores, sizeof(T) * num_scores, dev_ctx.stream());
+    }
+    dev_ctx.Wait();
+
+    // 4. Keep at most keep_top_k of every image, and the output rows are in
+    // the order of the labels, then of the scores.
+    std::vector<int> rows;
+    std::vector<size_t> batch_starts = {0};
+    for (int i = 0; i < batch_size; ++i) {
+      std::vector<int> image_rows;
+      for (int c = 0; c < class_num; ++c) {
+        int seg = i * class_num + c;
+        for (int k = 0; k < cpu_keep_nums[seg]; ++k) {
+          image_rows.push_back(seg * predict_dim +
+                               cpu_keep[seg * max_num + k]);
+        }
+      }
+      if (keep_top_k > -1 && static_cast<int>(image_rows.size()) > keep_top_k) {
+        std::vector<int> order(image_rows.size());
+        for (size_t k = 0; k < order.size(); ++k) order[k] = k;
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+          return cpu_scores[image_rows[a]] > cpu_scores[image_rows[b]];
+        });
+        order.resize(keep_top_k);
+        std::sort(order.begin(), order.end());
+        for (size_t k = 0; k < order.size(); ++k) {
+          image_rows[k] = image_rows[order[k]];
+        }
+        image_rows.resize(keep_top_k);
+      }
+      rows.insert(rows.end(), image_rows.begin(), image_rows.end());
+      batch_starts.push_back(rows.size());
+    }
+
+    int num_kept = static_cast<int>(rows.size());
+    if (num_kept == 0) {
+      outs->mutable_data<T>({1}, ctx.GetPlace());
+      math::SetConstant<platform::CUDADeviceContext, T> set_constant;
+      set_constant(dev_ctx, outs, static_cast<T>(-1));
+    } else {
+      T* out = outs->mutable_data<T>({num_kept, 6}, ctx.GetPlace());
+      framework::Vector<int> dev_rows(rows);
+      int out_blocks = DIVUP(num_kept, threads);
+      NMSOutputKernel<T><<<out_blocks, threads, 0, dev_ctx.stream()>>>(
+          boxes_data, sorted_scores, sorted_indices,
+          dev_rows.CUDAData(dev_ctx.GetPlace()), num_kept, class_num,
+          predict_dim, out);
+    }
+
+    framework::LoD lod;
+    lod.emplace_back(batch_starts);
+    outs->set_lod(lod);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(multiclass_nms, ops::MultiClassNMSCUDAKernel<float>,
+                        ops::MultiClassNMSCUDAKernel<double>);
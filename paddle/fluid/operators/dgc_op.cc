@@ -0,0 +1,122 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/dgc_op.h"
+
+namespace paddle {
+namespace operators {
+
+class DGCOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext *ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("U"), "Input(U) of DGCOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasInput("V"), "Input(V) of DGCOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasInput("Grad"),
+                   "Input(Grad) of DGCOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasInput("CurrentStep"),
+                   "Input(CurrentStep) of DGCOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("UOut"),
+                   "Output(UOut) of DGCOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("VOut"),
+                   "Output(VOut) of DGCOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("EncodeGrad"),
+                   "Output(EncodeGrad) of DGCOp should not be null.");
+
+    auto grad_dims = ctx->GetInputDim("Grad");
+    PADDLE_ENFORCE_GE(grad_dims.size(), 1,
+                      "Input(Grad) of DGCOp should not be a scalar.");
+    ctx->SetOutputDim("UOut", ctx->GetInputDim("U"));
+    ctx->SetOutputDim("VOut", ctx->GetInputDim("V"));
+    // Only the height of EncodeGrad is known before running.
+    ctx->SetOutputDim("EncodeGrad", grad_dims);
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext &ctx) const override {
+    auto data_type = framework::GetDataTypeOfVar(ctx.InputVar("Grad"));
+    return framework::OpKernelType(data_type, ctx.device_context());
+  }
+};
+
+class DGCOpInferVarType : public framework::VarTypeInference {
+ public:
+  void operator()(const framework::OpDesc &op_desc,
+                  framework::BlockDesc *block) const override {
+    for (auto &out_var_n : op_desc.Output("EncodeGrad")) {
+      block->FindRecursiveOrCreateVar(out_var_n)
+          .SetType(framework::proto::VarType::SELECTED_ROWS);
+    }
+  }
+};
+
+class DGCOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("U", "(Tensor) The accumulated velocity of the gradient.");
+    AddInput("V", "(Tensor) The residual that has not been sent yet.");
+    AddInput("Grad", "(Tensor) The dense gradient of this step.");
+    AddInput("CurrentStep",
+             "(Tensor) An int64 Tensor with one element, the current global "
+             "step used for the warm-up of the sparsity.");
+    AddOutput("UOut", "(Tensor) Should share the same memory with U.");
+    AddOutput("VOut", "(Tensor) Should share the same memory with V.");
+    AddOutput("EncodeGrad",
+              "(SelectedRows) The rows of the residual that are sent.");
+    AddAttr<float>("m", "(float, 0.9) The momentum used for the correction.")
+        .SetDefault(0.9f);
+    AddAttr<std::vector<float>>(
+        "sparsity",
+        "(vector<float>) The sparsity used during and after the warm-up, "
+        "e.g. [0.75, 0.9375, 0.984375, 0.996, 0.999].")
+        .SetDefault({0.999f});
+    AddAttr<int>("rampup_begin_step",
+                 "(int, 0) The step from which the gradient is sparsified.")
+        .SetDefault(0);
+    AddAttr<int>("rampup_step",
+                 "(int, 1) The number of steps the sparsity goes through the "
+                 "values of the sparsity attribute.")
+        .SetDefault(1);
+    AddComment(R"DOC(
+DGC operator
+
+Deep gradient compression, see https://arxiv.org/abs/1712.01887. Rows are
+the unit of the sparsification so that the result can be sent and applied by
+the existing SelectedRows paths of the parameter servers.
+
+$$u = m * u + grad$$
+$$v = v + u$$
+
+The rows of $v$ with the largest L2 norms, $(1 - sparsity)$ of all the rows,
+are output as EncodeGrad, and then cleared in both $u$ and $v$. The other
+rows are kept locally and accumulated in the next steps.
+
+Since the momentum is applied here, the parameter servers are expected to use
+plain SGD on EncodeGrad.
+
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(dgc, ops::DGCOp, ops::DGCOpMaker,
+                  paddle::framework::EmptyGradOpMaker, ops::DGCOpInferVarType);
+REGISTER_OP_CPU_KERNEL(
+    dgc, ops::DGCOpKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::DGCOpKernel<paddle::platform::CPUDeviceContext, double>);
@@ -0,0 +1,117 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/selected_rows.h"
+
+namespace paddle {
+namespace operators {
+
+// The sparsity used at the given step: no sparsification before
+// rampup_begin_step, then the values of sparsity one by one, each for
+// rampup_step / sparsity.size() steps, and the last one afterwards.
+inline float GetDGCSparsity(const std::vector<float> &sparsity, int64_t step,
+                            int64_t rampup_begin_step, int64_t rampup_step) {
+  if (sparsity.empty() || step < rampup_begin_step) {
+    return 0.0f;
+  }
+  size_t idx = static_cast<size_t>((step - rampup_begin_step) *
+                                   static_cast<int64_t>(sparsity.size()) /
+                                   std::max<int64_t>(rampup_step, 1));
+  return sparsity[std::min(idx, sparsity.size() - 1)];
+}
+
+template <typename DeviceContext, typename T>
+class DGCOpKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &ctx) const override {
+    auto *u = ctx.Input<framework::Tensor>("U");
+    auto *v = ctx.Input<framework::Tensor>("V");
+    auto *grad = ctx.Input<framework::Tensor>("Grad");
+    auto *current_step = ctx.Input<framework::Tensor>("CurrentStep");
+    auto *u_out = ctx.Output<framework::Tensor>("UOut");
+    auto *v_out = ctx.Output<framework::Tensor>("VOut");
+    auto *encode_grad = ctx.Output<framework::SelectedRows>("EncodeGrad");
+
+    PADDLE_ENFORCE_EQ(u->numel(), grad->numel());
+    PADDLE_ENFORCE_EQ(v->numel(), grad->numel());
+
+    T m = static_cast<T>(ctx.Attr<float>("m"));
+    float sparsity = GetDGCSparsity(
+        ctx.Attr<std::vector<float>>("sparsity"),
+        static_cast<int64_t>(current_step->data<int64_t>()[0]),
+        static_cast<int64_t>(ctx.Attr<int>("rampup_begin_step")),
+        static_cast<int64_t>(ctx.Attr<int>("rampup_step")));
+
+    auto height = grad->dims()[0];
+    auto row_numel = grad->numel() / height;
+    auto *g_data = grad->data<T>();
+    auto *u_data = u->data<T>();
+    auto *v_data = v->data<T>();
+    auto *u_out_data = u_out->mutable_data<T>(ctx.GetPlace());
+    auto *v_out_data = v_out->mutable_data<T>(ctx.GetPlace());
+
+    // Momentum correction: accumulate the velocity instead of the raw
+    // gradient, so that the rows sent late still carry their momentum.
+    std::vector<T> scores(height, static_cast<T>(0));
+    for (int64_t i = 0; i < height; ++i) {
+      for (int64_t j = i * row_numel; j < (i + 1) * row_numel; ++j) {
+        u_out_data[j] = m * u_data[j] + g_data[j];
+        v_out_data[j] = v_data[j] + u_out_data[j];
+        scores[i] += v_out_data[j] * v_out_data[j];
+      }
+    }
+
+    // Send the k rows of the residual with the largest L2 norms.
+    int64_t k = static_cast<int64_t>(
+        std::ceil(static_cast<double>(height) * (1.0 - sparsity)));
+    k = std::min(std::max<int64_t>(k, 1), height);
+    std::vector<int64_t> rows(height);
+    for (int64_t i = 0; i < height; ++i) {
+      rows[i] = i;
+    }
+    if (k < height) {
+      std::nth_element(
+          rows.begin(), rows.begin() + k, rows.end(),
+          [&scores](int64_t a, int64_t b) { return scores[a] > scores[b]; });
+      rows.resize(k);
+      std::sort(rows.begin(), rows.end());
+    }
+
+    encode_grad->set_height(height);
+    encode_grad->set_rows(rows);
+    auto *value = encode_grad->mutable_value();
+    value->Resize(framework::make_ddim({k, row_numel}));
+    auto *value_data = value->mutable_data<T>(ctx.GetPlace());
+
+    // The sent rows leave the residual, and their momentum is cleared too so
+    // that the stale velocity does not push them again.
+    for (int64_t i = 0; i < k; ++i) {
+      int64_t offset = rows[i] * row_numel;
+      std::copy(v_out_data + offset, v_out_data + offset + row_numel,
+                value_data + i * row_numel);
+      std::fill(v_out_data + offset, v_out_data + offset + row_numel,
+                static_cast<T>(0));
+      std::fill(u_out_data + offset, u_out_data + offset + row_numel,
+                static_cast<T>(0));
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
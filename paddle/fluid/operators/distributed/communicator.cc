@@ -0,0 +1,285 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/distributed/communicator.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <utility>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/operators/distributed/distributed.h"
+#include "paddle/fluid/operators/math/selected_rows_functor.h"
+
+DEFINE_bool(communicator_enable, false,
+            "send the gradients and recv the parameters by the background "
+            "threads of the communicator in the async mode of the trainers");
+DEFINE_int32(communicator_send_queue_size, 20,
+             "the max number of the queued gradients of every variable, the "
+             "send op blocks when the queue is full");
+DEFINE_int32(communicator_max_merge_var_num, 20,
+             "the max number of the queued gradients of a variable merged "
+             "into one send");
+DEFINE_int32(communicator_recv_wait_ms, 200,
+             "the interval in milliseconds of receiving the parameters");
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+std::once_flag Communicator::init_flag_;
+std::unique_ptr<Communicator> Communicator::communicator_(nullptr);
+
+// Copy the variable to CPU, the trainer may overwrite it once the send op
+// returns.
+static std::shared_ptr<framework::Variable> CopyToCPU(
+    const framework::Variable& var, const platform::DeviceContext& ctx) {
+  auto copy = std::make_shared<framework::Variable>();
+  platform::CPUPlace cpu;
+  if (var.IsType<framework::LoDTensor>()) {
+    auto& src = var.Get<framework::LoDTensor>();
+    auto* dst = copy->GetMutable<framework::LoDTensor>();
+    framework::TensorCopy(src, cpu, ctx, dst);
+    dst->set_lod(src.lod());
+  } else if (var.IsType<framework::SelectedRows>()) {
+    auto& src = var.Get<framework::SelectedRows>();
+    auto* dst = copy->GetMutable<framework::SelectedRows>();
+    dst->set_height(src.height());
+    dst->set_rows(src.rows());
+    framework::TensorCopy(src.value(), cpu, ctx, dst->mutable_value());
+  } else {
+    PADDLE_THROW("The communicator only sends LoDTensor and SelectedRows");
+  }
+  ctx.Wait();
+  return copy;
+}
+
+template <typename T>
+static void SumTensors(
+    const std::vector<std::shared_ptr<framework::Variable>>& vars,
+    framework::LoDTensor* out) {
+  auto& first = vars[0]->Get<framework::LoDTensor>();
+  out->Resize(first.dims());
+  auto numel = first.numel();
+  T* out_data = out->mutable_data<T>(platform::CPUPlace());
+  const T* first_data = first.data<T>();
+  std::copy(first_data, first_data + numel, out_data);
+  for (size_t i = 1; i < vars.size(); ++i) {
+    auto& in = vars[i]->Get<framework::LoDTensor>();
+    PADDLE_ENFORCE_EQ(in.numel(), numel,
+                      "the merged gradients should have the same shape");
+    const T* in_data = in.data<T>();
+    for (int64_t j = 0; j < numel; ++j) {
+      out_data[j] += in_data[j];
+    }
+  }
+}
+
+template <typename T>
+static void MergeSelectedRows(
+    const std::vector<std::shared_ptr<framework::Variable>>& vars,
+    framework::SelectedRows* out) {
+  std::vector<const framework::SelectedRows*> inputs;
+  for (auto& var : vars) {
+    inputs.push_back(&var->Get<framework::SelectedRows>());
+  }
+  auto& cpu_ctx = *static_cast<platform::CPUDeviceContext*>(
+      platform::DeviceContextPool::Instance().Get(platform::CPUPlace()));
+  math::scatter::MergeAdd<platform::CPUDeviceContext, T> merge_add;
+  merge_add(cpu_ctx, inputs, out);
+}
+
+void MergeVars(const std::vector<std::shared_ptr<framework::Variable>>& vars,
+               framework::Variable* out) {
+  PADDLE_ENFORCE(!vars.empty(), "no gradient to merge");
+  auto& first = *vars[0];
+  if (first.IsType<framework::LoDTensor>()) {
+    auto* out_tensor = out->GetMutable<framework::LoDTensor>();
+    auto type = first.Get<framework::LoDTensor>().type();
+    if (type == framework::proto::VarType::FP32) {
+      SumTensors<float>(vars, out_tensor);
+    } else if (type == framework::proto::VarType::FP64) {
+      SumTensors<double>(vars, out_tensor);
+    } else {
+      PADDLE_THROW("The communicator only merges FP32 and FP64 gradients");
+    }
+  } else if (first.IsType<framework::SelectedRows>()) {
+    auto* out_slr = out->GetMutable<framework::SelectedRows>();
+    auto type = first.Get<framework::SelectedRows>().value().type();
+    if (type == framework::proto::VarType::FP32) {
+      MergeSelectedRows<float>(vars, out_slr);
+    } else if (type == framework::proto::VarType::FP64) {
+      MergeSelectedRows<double>(vars, out_slr);
+    } else {
+      PADDLE_THROW("The communicator only merges FP32 and FP64 gradients");
+    }
+  } else {
+    PADDLE_THROW("The communicator only merges LoDTensor and SelectedRows");
+  }
+}
+
+Communicator* Communicator::Init(int trainer_id) {
+  std::call_once(init_flag_, [trainer_id] {
+    communicator_.reset(new Communicator(trainer_id));
+  });
+  return communicator_.get();
+}
+
+Communicator::Communicator(int trainer_id) : trainer_id_(trainer_id) {
+  PADDLE_ENFORCE_GT(FLAGS_communicator_send_queue_size, 0);
+  PADDLE_ENFORCE_GT(FLAGS_communicator_max_merge_var_num, 0);
+  running_ = true;
+  send_thread_.reset(new std::thread(&Communicator::SendThread, this));
+  recv_thread_.reset(new std::thread(&Communicator::RecvThread, this));
+  VLOG(3) << "Communicator of trainer " << trainer_id_ << " started";
+}
+
+Communicator::~Communicator() { Stop(); }
+
+void Communicator::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(stop_mutex_);
+    if (!running_) return;
+    running_ = false;
+  }
+  stop_cv_.notify_all();
+  send_thread_->join();
+  recv_thread_->join();
+  VLOG(3) << "Communicator of trainer " << trainer_id_ << " stopped";
+}
+
+void Communicator::Send(const std::string& var_name, const std::string& ep,
+                        const framework::Scope& scope,
+                        const platform::DeviceContext& ctx) {
+  PADDLE_ENFORCE(running_.load(), "The communicator is stopped");
+  auto* var = scope.FindVar(var_name);
+  PADDLE_ENFORCE_NOT_NULL(var, "Can not find variable '%s' to send",
+                          var_name);
+  std::shared_ptr<SendQueue> queue;
+  {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    auto it = send_ctxs_.find(var_name);
+    if (it == send_ctxs_.end()) {
+      SendContext send_ctx;
+      send_ctx.ep = ep;
+      send_ctx.queue =
+          std::make_shared<SendQueue>(FLAGS_communicator_send_queue_size);
+      it = send_ctxs_.emplace(var_name, std::move(send_ctx)).first;
+    }
+    queue = it->second.queue;
+  }
+  queue->Send(CopyToCPU(*var, ctx));
+}
+
+void Communicator::RegisterRecv(const std::string& var_name,
+                                const std::string& ep,
+                                const framework::Scope& scope,
+                                const platform::DeviceContext& ctx) {
+  {
+    std::lock_guard<std::mutex> lock(recv_mutex_);
+    if (recv_ctxs_.count(var_name)) return;
+    recv_ctxs_[var_name] = RecvContext{ep, &scope, &ctx};
+  }
+  auto* rpc_client = RPCClient::GetInstance<RPCCLIENT_T>(trainer_id_);
+  PADDLE_ENFORCE(rpc_client->AsyncGetVar(ep, ctx, scope, var_name)->Wait(),
+                 "internal error in RPCClient");
+}
+
+size_t Communicator::SendOnce() {
+  std::vector<std::pair<std::string, SendContext>> send_ctxs;
+  {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    send_ctxs.assign(send_ctxs_.begin(), send_ctxs_.end());
+  }
+
+  auto& cpu_ctx =
+      *platform::DeviceContextPool::Instance().Get(platform::CPUPlace());
+  auto* rpc_client = RPCClient::GetInstance<RPCCLIENT_T>(trainer_id_);
+  std::vector<VarHandlePtr> rets;
+  for (auto& item : send_ctxs) {
+    auto& queue = item.second.queue;
+    std::vector<std::shared_ptr<framework::Variable>> vars;
+    std::shared_ptr<framework::Variable> var;
+    // The send thread is the only consumer, so Receive never blocks here.
+    while (vars.size() < static_cast<size_t>(
+                             FLAGS_communicator_max_merge_var_num) &&
+           queue->Size() > 0 && queue->Receive(&var)) {
+      vars.push_back(var);
+    }
+    if (vars.empty()) continue;
+
+    VLOG(4) << "Communicator merges " << vars.size() << " " << item.first
+            << " and sends it to " << item.second.ep;
+    MergeVars(vars, send_scope_.Var(item.first));
+    rets.push_back(rpc_client->AsyncSendVar(item.second.ep, cpu_ctx,
+                                            send_scope_, item.first));
+  }
+  // The merged variables are reused by the next SendOnce.
+  for (auto& ret : rets) {
+    PADDLE_ENFORCE(ret->Wait(), "internal error in RPCClient");
+  }
+  return rets.size();
+}
+
+void Communicator::RecvOnce() {
+  std::vector<std::pair<std::string, RecvContext>> recv_ctxs;
+  {
+    std::lock_guard<std::mutex> lock(recv_mutex_);
+    recv_ctxs.assign(recv_ctxs_.begin(), recv_ctxs_.end());
+  }
+
+  auto* rpc_client = RPCClient::GetInstance<RPCCLIENT_T>(trainer_id_);
+  std::vector<VarHandlePtr> rets;
+  for (auto& item : recv_ctxs) {
+    auto& recv_ctx = item.second;
+    rets.push_back(rpc_client->AsyncGetVar(recv_ctx.ep, *recv_ctx.ctx,
+                                           *recv_ctx.scope, item.first));
+  }
+  for (auto& ret : rets) {
+    PADDLE_ENFORCE(ret->Wait(), "internal error in RPCClient");
+  }
+}
+
+void Communicator::SendThread() {
+  while (running_) {
+    if (SendOnce() == 0) {
+      std::unique_lock<std::mutex> lock(stop_mutex_);
+      stop_cv_.wait_for(lock, std::chrono::milliseconds(1),
+                        [this] { return !running_; });
+    }
+  }
+  // Flush the gradients queued before Stop.
+  while (SendOnce() > 0) {
+  }
+}
+
+void Communicator::RecvThread() {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(stop_mutex_);
+      if (stop_cv_.wait_for(
+              lock, std::chrono::milliseconds(FLAGS_communicator_recv_wait_ms),
+              [this] { return !running_; })) {
+        break;
+      }
+    }
+    RecvOnce();
+  }
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,124 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/variable.h"
+#include "paddle/fluid/operators/reader/blocking_queue.h"
+#include "paddle/fluid/platform/device_context.h"
+
+DECLARE_bool(communicator_enable);
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// Sum the dense gradients, or merge the SelectedRows gradients by row, into
+// out. All the variables are on CPU.
+void MergeVars(const std::vector<std::shared_ptr<framework::Variable>>& vars,
+               framework::Variable* out);
+
+/*
+ * Communicator sends the gradients and receives the parameters of an async
+ * trainer in the background, so that the send and recv ops do not wait for
+ * RPC at all.
+ *
+ * The send op copies the gradient into the bounded queue of the variable and
+ * returns. The send thread merges up to FLAGS_communicator_max_merge_var_num
+ * queued gradients of every variable and sends the merged ones. The recv op
+ * only registers the parameters, which are then received by the recv thread
+ * every FLAGS_communicator_recv_wait_ms into the scope of the recv op, while
+ * the trainer keeps running as in any async SGD.
+ */
+class Communicator {
+ public:
+  ~Communicator();
+
+  // Create and start the communicator of the process once.
+  static Communicator* Init(int trainer_id);
+  // nullptr if Init is not called.
+  static Communicator* GetInstance() { return communicator_.get(); }
+
+  // Copy the gradient in scope to the queue of the variable, it blocks only
+  // if the queue is full.
+  void Send(const std::string& var_name, const std::string& ep,
+            const framework::Scope& scope, const platform::DeviceContext& ctx);
+
+  // Receive the parameter from ep into scope every
+  // FLAGS_communicator_recv_wait_ms. The parameter is received at once the
+  // first time it is registered.
+  void RegisterRecv(const std::string& var_name, const std::string& ep,
+                    const framework::Scope& scope,
+                    const platform::DeviceContext& ctx);
+
+  // Send all the queued gradients and stop the threads.
+  void Stop();
+
+ private:
+  using SendQueue =
+      reader::BlockingQueue<std::shared_ptr<framework::Variable>>;
+
+  struct SendContext {
+    std::string ep;
+    std::shared_ptr<SendQueue> queue;
+  };
+
+  struct RecvContext {
+    std::string ep;
+    const framework::Scope* scope;
+    const platform::DeviceContext* ctx;
+  };
+
+  explicit Communicator(int trainer_id);
+
+  void SendThread();
+  void RecvThread();
+  // Merge and send the queued gradients, return the number of the sent
+  // variables.
+  size_t SendOnce();
+  void RecvOnce();
+
+  int trainer_id_;
+  std::atomic<bool> running_{false};
+  std::mutex stop_mutex_;
+  std::condition_variable stop_cv_;
+  std::unique_ptr<std::thread> send_thread_;
+  std::unique_ptr<std::thread> recv_thread_;
+
+  std::mutex send_mutex_;
+  std::unordered_map<std::string, SendContext> send_ctxs_;
+  // The merged gradients being sent.
+  framework::Scope send_scope_;
+
+  std::mutex recv_mutex_;
+  std::unordered_map<std::string, RecvContext> recv_ctxs_;
+
+  static std::once_flag init_flag_;
+  static std::unique_ptr<Communicator> communicator_;
+};
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
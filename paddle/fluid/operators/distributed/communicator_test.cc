@@ -0,0 +1,75 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/operators/distributed/communicator.h"
+
+namespace framework = paddle::framework;
+namespace platform = paddle::platform;
+namespace distributed = paddle::operators::distributed;
+
+TEST(Communicator, MergeDenseVars) {
+  std::vector<std::shared_ptr<framework::Variable>> vars;
+  for (int i = 0; i < 3; ++i) {
+    vars.emplace_back(new framework::Variable());
+    auto* tensor = vars.back()->GetMutable<framework::LoDTensor>();
+    tensor->Resize({2, 5});
+    float* data = tensor->mutable_data<float>(platform::CPUPlace());
+    for (int j = 0; j < 10; ++j) data[j] = i + j;
+  }
+
+  framework::Variable out;
+  distributed::MergeVars(vars, &out);
+  auto& out_tensor = out.Get<framework::LoDTensor>();
+  EXPECT_EQ(out_tensor.dims(), framework::make_ddim({2, 5}));
+  const float* out_data = out_tensor.data<float>();
+  for (int j = 0; j < 10; ++j) {
+    EXPECT_FLOAT_EQ(out_data[j], 3 * j + 3);
+  }
+}
+
+TEST(Communicator, MergeSelectedRowsVars) {
+  platform::DeviceContextPool::Init({platform::CPUPlace()});
+  std::vector<std::vector<int64_t>> rows = {{0, 2}, {2, 5}};
+  std::vector<std::shared_ptr<framework::Variable>> vars;
+  for (auto& var_rows : rows) {
+    vars.emplace_back(new framework::Variable());
+    auto* slr = vars.back()->GetMutable<framework::SelectedRows>();
+    slr->set_height(10);
+    for (auto row : var_rows) slr->mutable_rows()->push_back(row);
+    auto* value = slr->mutable_value();
+    value->Resize({static_cast<int64_t>(var_rows.size()), 3});
+    float* data = value->mutable_data<float>(platform::CPUPlace());
+    for (int j = 0; j < value->numel(); ++j) data[j] = 1.0;
+  }
+
+  framework::Variable out;
+  distributed::MergeVars(vars, &out);
+  auto& out_slr = out.Get<framework::SelectedRows>();
+  EXPECT_EQ(out_slr.height(), 10);
+  ASSERT_EQ(out_slr.rows().size(), 3UL);
+  auto& value = out_slr.value();
+  EXPECT_EQ(value.dims(), framework::make_ddim({3, 3}));
+  for (size_t i = 0; i < out_slr.rows().size(); ++i) {
+    float expected = out_slr.rows()[i] == 2 ? 2.0 : 1.0;
+    for (int j = 0; j < 3; ++j) {
+      EXPECT_FLOAT_EQ(value.data<float>()[i * 3 + j], expected);
+    }
+  }
+}
@@ -23,6 +23,13 @@
 #define RPCSERVER_T paddle::operators::distributed::AsyncGRPCServer
 #define RPCCLIENT_T paddle::operators::distributed::GRPCClient
 
+#elif defined(PADDLE_WITH_VERBS)
+
+#include "paddle/fluid/operators/distributed/verbs/verbs_client.h"
+#include "paddle/fluid/operators/distributed/verbs/verbs_server.h"
+#define RPCSERVER_T paddle::operators::distributed::AsyncVerbsServer
+#define RPCCLIENT_T paddle::operators::distributed::VerbsClient
+
 #else  // PADDLE_WITH_GRPC
 
 #include "paddle/fluid/operators/distributed/brpc/brpc_client.h"
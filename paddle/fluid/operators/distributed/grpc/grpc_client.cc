@@ -105,6 +105,60 @@ VarHandlePtr GRPCClient::AsyncSendVar(const std::string& ep,
   return h;
 }
 
+static std::string JoinVarNames(const std::vector<std::string>& var_names) {
+  std::string names;
+  for (auto& name : var_names) {
+    if (!names.empty()) names += ",";
+    names += name;
+  }
+  return names;
+}
+
+std::vector<VarHandlePtr> GRPCClient::AsyncSendVars(
+    const std::string& ep, const platform::DeviceContext& ctx,
+    const framework::Scope& scope, const std::vector<std::string>& var_names,
+    int64_t time_out) {
+  const platform::DeviceContext* p_ctx = &ctx;
+  const std::vector<std::string> var_names_val = var_names;
+  const framework::Scope* p_scope = &scope;
+  const auto ch = GetChannel(ep);
+  SendProcessor* s = new SendProcessor(ch);
+  const std::string method = "SendVarsRPC";
+  VarHandlePtr h(
+      new VarHandle(ep, method, JoinVarNames(var_names), p_ctx, p_scope));
+  s->Prepare(h, time_out);
+
+  framework::AsyncIO([var_names_val, p_scope, p_ctx, s, method, h, this] {
+    std::vector<framework::Variable*> vars;
+    for (auto& var_name : var_names_val) {
+      vars.push_back(p_scope->FindVar(var_name));
+    }
+
+    ::grpc::ByteBuffer req;
+    SerializeVarsToByteBuffer(var_names_val, vars, *p_ctx, &req, trainer_id_);
+
+    VLOG(3) << s->GetVarHandlePtr()->String() << " begin";
+
+    // stub context
+    s->response_call_back_ = nullptr;
+
+    platform::RecordRPCEvent record_event(method, p_ctx);
+
+    auto call = s->stub_g_.PrepareUnaryCall(
+        s->context_.get(), "/sendrecv.SendRecvService/SendVariables", req,
+        &cq_);
+    call->StartCall();
+    call->Finish(&s->reply_, &s->status_, reinterpret_cast<void*>(s));
+
+    if (UNLIKELY(platform::IsProfileEnabled())) {
+      h->Wait();
+    }
+  });
+  req_count_++;
+
+  return {h};
+}
+
 void ProcGetResponse(const VarHandle& var_h,
                      const ::grpc::ByteBuffer& ret_msg) {
   VLOG(100) << "ProcGetResponse";
@@ -115,6 +169,12 @@ void ProcGetResponse(const VarHandle& var_h,
                             &trainer_id);
 }
 
+void ProcGetVarsResponse(const VarHandle& var_h,
+                         const ::grpc::ByteBuffer& ret_msg) {
+  VLOG(100) << "ProcGetVarsResponse";
+  DeserializeVarsFromByteBuffer(ret_msg, *var_h.ctx(), var_h.scope());
+}
+
 template <typename T>
 void RequestToByteBuffer(const T& proto, ::grpc::ByteBuffer* result) {
   ::grpc::Slice slice(proto.ByteSizeLong());
@@ -186,6 +246,54 @@ VarHandlePtr GRPCClient::_AsyncGetVar(const std::string& ep,
   return h;
 }
 
+std::vector<VarHandlePtr> GRPCClient::AsyncGetVars(
+    const std::string& ep, const platform::DeviceContext& ctx,
+    const framework::Scope& scope, const std::vector<std::string>& var_names,
+    int64_t time_out) {
+  const platform::DeviceContext* p_ctx = &ctx;
+  const std::vector<std::string> var_names_val = var_names;
+  const framework::Scope* p_scope = &scope;
+  const auto ch = GetChannel(ep);
+  GetProcessor* s = new GetProcessor(ch);
+  const std::string method = "GetVarsRPC";
+  VarHandlePtr h(
+      new VarHandle(ep, method, JoinVarNames(var_names), p_ctx, p_scope));
+  s->Prepare(h, time_out);
+
+  framework::AsyncIO([var_names_val, s, method, p_ctx, h, this] {
+    // prepare input
+    sendrecv::MultiVariableMessage req;
+    for (auto& var_name : var_names_val) {
+      auto* var_req = req.add_vars();
+      var_req->set_varname(var_name);
+      var_req->set_trainer_id(trainer_id_);
+    }
+    ::grpc::ByteBuffer buf;
+    RequestToByteBuffer<sendrecv::MultiVariableMessage>(req, &buf);
+
+    VLOG(3) << s->GetVarHandlePtr()->String() << " begin";
+
+    // stub context
+    s->response_call_back_ = ProcGetVarsResponse;
+
+    platform::RecordRPCEvent record_event(method, p_ctx);
+
+    auto call = s->stub_g_.PrepareUnaryCall(
+        s->context_.get(), "/sendrecv.SendRecvService/GetVariables", buf,
+        &cq_);
+    call->StartCall();
+    call->Finish(&s->reply_, &s->status_, reinterpret_cast<void*>(s));
+
+    if (UNLIKELY(platform::IsProfileEnabled())) {
+      h->Wait();
+    }
+  });
+
+  req_count_++;
+
+  return {h};
+}
+
 VarHandlePtr GRPCClient::AsyncPrefetchVar(const std::string& ep,
                                           const platform::DeviceContext& ctx,
                                           const framework::Scope& scope,
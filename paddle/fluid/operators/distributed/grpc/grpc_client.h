@@ -50,6 +50,7 @@ namespace operators {
 namespace distributed {
 
 void ProcGetResponse(const VarHandle& var_h, const grpc::ByteBuffer& msg);
+void ProcGetVarsResponse(const VarHandle& var_h, const grpc::ByteBuffer& msg);
 
 class BaseProcessor {
  public:
@@ -188,6 +189,16 @@ class GRPCClient : public RPCClient {
                            const std::string& var_name,
                            int64_t time_out = FLAGS_rpc_deadline) override;
 
+  std::vector<VarHandlePtr> AsyncSendVars(
+      const std::string& ep, const platform::DeviceContext& ctx,
+      const framework::Scope& scope, const std::vector<std::string>& var_names,
+      int64_t time_out = FLAGS_rpc_deadline) override;
+
+  std::vector<VarHandlePtr> AsyncGetVars(
+      const std::string& ep, const platform::DeviceContext& ctx,
+      const framework::Scope& scope, const std::vector<std::string>& var_names,
+      int64_t time_out = FLAGS_rpc_deadline) override;
+
   VarHandlePtr AsyncGetMonomerVariable(
       const std::string& ep, const platform::DeviceContext& ctx,
       const framework::Scope& scope, const std::string& var_name,
@@ -17,6 +17,7 @@ limitations under the License. */
 #endif
 #include <limits>
 #include <thread>  // NOLINT
+#include <utility>
 
 #include "google/protobuf/io/coded_stream.h"
 #include "google/protobuf/io/zero_copy_stream.h"
@@ -154,6 +155,47 @@ void DeserializeFromByteBuffer(const ::grpc::ByteBuffer& msg,
   *trainer_id = resp.GetTrainerId();
 }
 
+void SerializeVarsToByteBuffer(const std::vector<std::string>& names,
+                               const std::vector<framework::Variable*>& vars,
+                               const platform::DeviceContext& ctx,
+                               ::grpc::ByteBuffer* msg, const int trainer_id) {
+  PADDLE_ENFORCE_EQ(names.size(), vars.size());
+  std::vector<::grpc::Slice> slices;
+  for (size_t i = 0; i < names.size(); ++i) {
+    ::grpc::ByteBuffer var_msg;
+    SerializeToByteBuffer(names[i], vars[i], ctx, &var_msg, "", trainer_id);
+    if (var_msg.Length() >= std::numeric_limits<int>::max()) {
+      LOG(FATAL) << "SerializeVarsToByteBuffer varname:" << names[i]
+                 << ", vlen:" << var_msg.Length();
+    }
+
+    std::vector<::grpc::Slice> var_slices;
+    PADDLE_ENFORCE(var_msg.Dump(&var_slices).ok(),
+                   "dump the bytebuffer of %s error", names[i]);
+
+    char buf[16];
+    ProtoEncodeHelper e(buf, sizeof(buf));
+    e.WriteVarlengthBeginning(
+        ::sendrecv::MultiVariableMessage::kVarsFieldNumber,
+        static_cast<uint32_t>(var_msg.Length()));
+    slices.emplace_back(e.data(), e.size());
+    for (auto& slice : var_slices) {
+      slices.push_back(std::move(slice));
+    }
+  }
+
+  ::grpc::ByteBuffer tmp(slices.data(), slices.size());
+  msg->Swap(&tmp);
+}
+
+void DeserializeVarsFromByteBuffer(const ::grpc::ByteBuffer& msg,
+                                   const platform::DeviceContext& ctx,
+                                   const framework::Scope* scope) {
+  platform::RecordRPCEvent record_event("deserial", &ctx);
+  operators::distributed::GRPCMultiVariableResponse resp(scope, &ctx);
+  PADDLE_ENFORCE(resp.Parse(msg) == 0, "parse bytebuffer to tensors error!");
+}
+
 }  // namespace distributed
 }  // namespace operators
 }  // namespace paddle
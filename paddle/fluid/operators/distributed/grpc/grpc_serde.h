@@ -47,6 +47,20 @@ void DeserializeFromByteBuffer(const ::grpc::ByteBuffer& msg,
                                const framework::Scope* scope,
                                framework::Variable** var, int* trainer_id);
 
+// Serialize the variables into one MultiVariableMessage. Every variable is
+// serialized by SerializeToByteBuffer and its slices are appended without
+// copying the tensor data.
+void SerializeVarsToByteBuffer(const std::vector<std::string>& names,
+                               const std::vector<framework::Variable*>& vars,
+                               const platform::DeviceContext& ctx,
+                               ::grpc::ByteBuffer* msg,
+                               const int trainer_id = 0);
+
+// Deserialize all the variables of a MultiVariableMessage into scope.
+void DeserializeVarsFromByteBuffer(const ::grpc::ByteBuffer& msg,
+                                   const platform::DeviceContext& ctx,
+                                   const framework::Scope* scope);
+
 }  // namespace distributed
 }  // namespace operators
 }  // namespace paddle
@@ -15,6 +15,7 @@ limitations under the License. */
 #include <unistd.h>
 #include <string>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "google/protobuf/text_format.h"
 #include "gtest/gtest.h"
@@ -29,6 +30,9 @@ limitations under the License. */
 #include "paddle/fluid/platform/place.h"
 #include "paddle/fluid/string/printf.h"
 
+DECLARE_string(rpc_fp16_compress_vars);
+DECLARE_double(rpc_fp16_compress_loss_scale);
+
 namespace framework = paddle::framework;
 namespace platform = paddle::platform;
 namespace operators = paddle::operators;
@@ -202,6 +206,109 @@ void RunTestLodTensor(platform::Place place, int from_type = 0) {
   for (int i = 0; i < tensor_numel; ++i) EXPECT_FLOAT_EQ(tensor_data2[i], 31.9);
 }
 
+void RunTestFP16CompressedLodTensor(platform::Place place) {
+  framework::Variable var;
+  auto* tensor = var.GetMutable<framework::LoDTensor>();
+  tensor->Resize(framework::make_ddim({512, 8}));
+  int tensor_numel = 512 * 8;
+  platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
+  auto& ctx = *pool.Get(place);
+  tensor->mutable_data<float>(place);
+  math::set_constant(ctx, tensor, 0.5);
+
+  FLAGS_rpc_fp16_compress_vars = "myvar";
+  FLAGS_rpc_fp16_compress_loss_scale = 128.0;
+  ::grpc::ByteBuffer msg;
+  operators::distributed::SerializeToByteBuffer("myvar.block0", &var, ctx,
+                                                &msg);
+  FLAGS_rpc_fp16_compress_vars = "";
+  FLAGS_rpc_fp16_compress_loss_scale = 1.0;
+
+  std::vector<::grpc::Slice> slices;
+  (void)msg.Dump(&slices);
+  std::string tmp;
+  for (const auto& s : slices) {
+    tmp.append(reinterpret_cast<const char*>(s.begin()), s.size());
+  }
+  sendrecv::VariableMessage varmsg;
+  EXPECT_TRUE(varmsg.ParseFromString(tmp));
+  EXPECT_TRUE(varmsg.fp16_compressed());
+  EXPECT_FLOAT_EQ(varmsg.fp16_loss_scale(), 128.0);
+  EXPECT_EQ(varmsg.data_type(), sendrecv::VariableMessage::FP32);
+  EXPECT_EQ(varmsg.serialized().size(),
+            tensor_numel * sizeof(platform::float16));
+
+  framework::Scope scope;
+  scope.Var("myvar.block0");
+  operators::distributed::GRPCVariableResponse resp(&scope, &ctx);
+  EXPECT_EQ(resp.Parse(msg), 0);
+
+  auto tensor2 = resp.GetVar()->Get<framework::LoDTensor>();
+  EXPECT_EQ(tensor2.type(), framework::proto::VarType::FP32);
+  framework::Tensor tmp_tensor;
+  framework::TensorCopySync(tensor2, platform::CPUPlace(), &tmp_tensor);
+  const float* tensor_data2 = tmp_tensor.data<float>();
+  for (int i = 0; i < tensor_numel; ++i) EXPECT_FLOAT_EQ(tensor_data2[i], 0.5);
+}
+
+void RunTestMultiVars(platform::Place place) {
+  platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
+  auto& ctx = *pool.Get(place);
+
+  framework::Scope scope;
+  auto* tensor = scope.Var("x")->GetMutable<framework::LoDTensor>();
+  tensor->Resize(framework::make_ddim({4, 8}));
+  tensor->mutable_data<float>(place);
+  math::set_constant(ctx, tensor, 1.5);
+  auto* slr = scope.Var("y")->GetMutable<framework::SelectedRows>();
+  slr->set_height(100);
+  slr->mutable_value()->Resize(framework::make_ddim({3, 8}));
+  slr->mutable_value()->mutable_data<float>(place);
+  math::set_constant(ctx, slr->mutable_value(), 2.5);
+  for (int64_t row : {7, 1, 42}) slr->mutable_rows()->push_back(row);
+
+  ::grpc::ByteBuffer msg;
+  operators::distributed::SerializeVarsToByteBuffer(
+      {"x", "y"}, {scope.FindVar("x"), scope.FindVar("y")}, ctx, &msg, 3);
+
+  std::vector<::grpc::Slice> slices;
+  (void)msg.Dump(&slices);
+  std::string tmp;
+  for (const auto& s : slices) {
+    tmp.append(reinterpret_cast<const char*>(s.begin()), s.size());
+  }
+  sendrecv::MultiVariableMessage multi_msg;
+  EXPECT_TRUE(multi_msg.ParseFromString(tmp));
+  ASSERT_EQ(multi_msg.vars_size(), 2);
+  EXPECT_EQ(multi_msg.vars(0).varname(), "x");
+  EXPECT_EQ(multi_msg.vars(1).varname(), "y");
+  EXPECT_EQ(multi_msg.vars(1).trainer_id(), 3);
+
+  framework::Scope recv_scope;
+  recv_scope.Var("x");
+  recv_scope.Var("y");
+  operators::distributed::GRPCMultiVariableResponse resp(&recv_scope, &ctx);
+  EXPECT_EQ(resp.Parse(msg), 0);
+  ASSERT_EQ(resp.Vars().size(), 2UL);
+  EXPECT_EQ(resp.Varnames(), "x,y");
+
+  auto& tensor1 = recv_scope.FindVar("x")->Get<framework::LoDTensor>();
+  framework::Tensor tensor2;
+  framework::TensorCopySync(tensor1, platform::CPUPlace(), &tensor2);
+  for (int i = 0; i < 4 * 8; ++i) {
+    EXPECT_FLOAT_EQ(tensor2.data<float>()[i], 1.5);
+  }
+  auto& slr2 = recv_scope.FindVar("y")->Get<framework::SelectedRows>();
+  EXPECT_EQ(slr2.height(), 100);
+  ASSERT_EQ(slr2.rows().size(), 3UL);
+  EXPECT_EQ(slr2.rows()[2], 42);
+  framework::Tensor value2;
+  framework::TensorCopySync(slr2.value(), platform::CPUPlace(), &value2);
+  for (int i = 0; i < 3 * 8; ++i) {
+    EXPECT_FLOAT_EQ(value2.data<float>()[i], 2.5);
+  }
+}
+
 TEST(LodTensor, Run) {
   platform::CPUPlace place;
   RunTestLodTensor(place);
@@ -213,6 +320,24 @@ TEST(LodTensor, Run) {
 #endif
 }
 
+TEST(LodTensor, FP16Compress) {
+  platform::CPUPlace place;
+  RunTestFP16CompressedLodTensor(place);
+#ifdef PADDLE_WITH_CUDA
+  platform::CUDAPlace gpu(0);
+  RunTestFP16CompressedLodTensor(gpu);
+#endif
+}
+
+TEST(MultiVars, Run) {
+  platform::CPUPlace place;
+  RunTestMultiVars(place);
+#ifdef PADDLE_WITH_CUDA
+  platform::CUDAPlace gpu(0);
+  RunTestMultiVars(gpu);
+#endif
+}
+
 TEST(SelectedRows, Run) {
   platform::CPUPlace place;
   RunSerdeTestSelectedRows(place);
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include <limits>
 #include <string>
+#include <vector>
 
 #include "paddle/fluid/operators/distributed/grpc/grpc_serde.h"
 #include "paddle/fluid/operators/distributed/grpc/grpc_server.h"
@@ -158,6 +159,99 @@ class RequestGet final : public RequestBase {
   ServerAsyncResponseWriter<::grpc::ByteBuffer> responder_;
 };
 
+class RequestSendVariables final : public RequestBase {
+ public:
+  explicit RequestSendVariables(GrpcService::AsyncService* service,
+                                ::grpc::ServerCompletionQueue* cq,
+                                RequestHandler* request_handler, int req_id)
+      : RequestBase(service, cq, request_handler, req_id), responder_(&ctx_) {
+    request_.reset(new GRPCMultiVariableResponse(
+        request_handler->scope(), request_handler->dev_ctx(),
+        !request_handler->sync_mode()));
+    int method_id = static_cast<int>(distributed::GrpcMethod::kSendVariables);
+    service_->RequestAsyncUnary(
+        method_id, &ctx_, request_.get(), &responder_, cq_, cq_,
+        reinterpret_cast<void*>(static_cast<intptr_t>(req_id)));
+  }
+  virtual ~RequestSendVariables() {}
+  std::string GetReqName() override { return request_->Varnames(); }
+
+  void Process() override {
+    // Hand the variables to the send handler one by one, as if each of them
+    // was sent by a RequestSend.
+    for (auto& var : request_->Vars()) {
+      std::string varname = var->Varname();
+      VLOG(4) << "RequestSendVariables var_name:" << varname;
+
+      auto scope = var->GetMutableLocalScope();
+      auto invar = var->GetVar();
+      int trainer_id = var->GetTrainerId();
+      framework::Variable* outvar = nullptr;
+
+      request_handler_->Handle(varname, scope, invar, &outvar, trainer_id);
+    }
+    Finish(reply_, &responder_);
+  }
+
+ protected:
+  sendrecv::VoidMessage reply_;
+  std::shared_ptr<GRPCMultiVariableResponse> request_;
+  ServerAsyncResponseWriter<sendrecv::VoidMessage> responder_;
+};
+
+class RequestGetVariables final : public RequestBase {
+ public:
+  explicit RequestGetVariables(GrpcService::AsyncService* service,
+                               ::grpc::ServerCompletionQueue* cq,
+                               RequestHandler* request_handler, int req_id)
+      : RequestBase(service, cq, request_handler, req_id), responder_(&ctx_) {
+    auto method_id = static_cast<int>(distributed::GrpcMethod::kGetVariables);
+    service_->RequestAsyncUnary(
+        method_id, &ctx_, &request_, &responder_, cq_, cq_,
+        reinterpret_cast<void*>(static_cast<intptr_t>(req_id)));
+  }
+
+  virtual ~RequestGetVariables() {}
+
+  std::string GetReqName() override {
+    std::string names;
+    for (auto& var : request_.vars()) {
+      if (!names.empty()) names += ",";
+      names += var.varname();
+    }
+    return names;
+  }
+
+  void Process() override {
+    auto scope = request_handler_->scope();
+    std::vector<std::string> varnames;
+    std::vector<framework::Variable*> outvars;
+    for (auto& var : request_.vars()) {
+      std::string varname = var.varname();
+      VLOG(4) << "RequestGetVariables " << varname;
+
+      auto invar = scope->FindVar(varname);
+      framework::Variable* outvar = nullptr;
+
+      request_handler_->Handle(varname, scope, invar, &outvar,
+                               var.trainer_id());
+      if (outvar) {
+        varnames.push_back(varname);
+        outvars.push_back(outvar);
+      }
+    }
+
+    SerializeVarsToByteBuffer(varnames, outvars, *request_handler_->dev_ctx(),
+                              &reply_);
+    Finish(reply_, &responder_);
+  }
+
+ protected:
+  sendrecv::MultiVariableMessage request_;
+  ::grpc::ByteBuffer reply_;
+  ServerAsyncResponseWriter<::grpc::ByteBuffer> responder_;
+};
+
 class RequestGetMonomerVariable final : public RequestBase {
  public:
   explicit RequestGetMonomerVariable(GrpcService::AsyncService* service,
@@ -460,6 +554,10 @@ void AsyncGRPCServer::TryToRegisterNewOne(const std::string& rpc_name,
     b = new RequestSend(&service_, cq.get(), handler, req_id);
   } else if (rpc_name == kRequestGet) {
     b = new RequestGet(&service_, cq.get(), handler, req_id);
+  } else if (rpc_name == kRequestSendVariables) {
+    b = new RequestSendVariables(&service_, cq.get(), handler, req_id);
+  } else if (rpc_name == kRequestGetVariables) {
+    b = new RequestGetVariables(&service_, cq.get(), handler, req_id);
   } else if (rpc_name == kRequestGetMonomerVariable) {
     b = new RequestGetMonomerVariable(&service_, cq.get(), handler, req_id,
                                       this);
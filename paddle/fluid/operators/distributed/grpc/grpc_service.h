@@ -70,6 +70,38 @@ class SerializationTraits<
     return result;
   }
 };
+
+template <>
+class SerializationTraits<
+    paddle::operators::distributed::GRPCMultiVariableResponse> {
+ public:
+  static Status Serialize(
+      const paddle::operators::distributed::GRPCMultiVariableResponse& msg,
+      grpc_byte_buffer** bp, bool* own_buffer) {
+    PADDLE_ENFORCE(false, "SerializationTraits::Serialize not implemented!");
+    return Status();
+  }
+  static Status Deserialize(
+      grpc_byte_buffer* buffer,
+      paddle::operators::distributed::GRPCMultiVariableResponse* msg,
+      int max_message_size = INT_MAX) {
+    if (buffer == nullptr) {
+      return Status(StatusCode::INTERNAL, "No payload");
+    }
+
+    Status result = g_core_codegen_interface->ok();
+    if (result.ok()) {
+      paddle::operators::distributed::GrpcByteSource source(buffer);
+      int ret = msg->Parse(&source);
+      if (ret != 0) {
+        result = Status(StatusCode::INTERNAL,
+                        "MultiVariableResponse parse error");
+      }
+    }
+    g_core_codegen_interface->grpc_byte_buffer_destroy(buffer);
+    return result;
+  }
+};
 }  // namespace grpc
 
 namespace paddle {
@@ -83,10 +115,12 @@ enum class GrpcMethod {
   kCheckpointNotify,
   kGetMonomerVariable,
   kGetMonomerBarrier,
+  kSendVariables,
+  kGetVariables,
 };
 
 static const int kGrpcNumMethods =
-    static_cast<int>(GrpcMethod::kGetMonomerBarrier) + 1;
+    static_cast<int>(GrpcMethod::kGetVariables) + 1;
 
 inline const char* GrpcMethodName(GrpcMethod id) {
   switch (id) {
@@ -102,6 +136,10 @@ inline const char* GrpcMethodName(GrpcMethod id) {
       return "/sendrecv.SendRecvService/PrefetchVariable";
     case GrpcMethod::kCheckpointNotify:
       return "/sendrecv.SendRecvService/CheckpointNotify";
+    case GrpcMethod::kSendVariables:
+      return "/sendrecv.SendRecvService/SendVariables";
+    case GrpcMethod::kGetVariables:
+      return "/sendrecv.SendRecvService/GetVariables";
   }
 
   // Shouldn't be reached.
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstring>
 #include <string>
 #include <utility>
 #include <vector>
@@ -19,6 +20,7 @@
 #include <nccl.h>
 #endif
 
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
 #include "paddle/fluid/operators/distributed/grpc/grpc_variable_response.h"
 #include "paddle/fluid/platform/profiler.h"
 
@@ -29,6 +31,7 @@ namespace distributed {
 enum WireType {
   WIRETYPE_VARINT = 0,
   WIRETYPE_LENGTH_DELIMITED = 2,
+  WIRETYPE_FIXED32 = 5,
 };
 
 inline int GetTagFieldNumber(uint32_t tag) { return tag >> 3; }
@@ -315,6 +318,24 @@ int GRPCVariableResponse::Parse(Source* source) {
         meta_.set_table_name(temp);
         break;
       }
+      case sendrecv::VariableMessage::kFp16CompressedFieldNumber: {
+        uint64_t v = 0;
+        if ((wt != WIRETYPE_VARINT) || !input.ReadVarint64(&v)) {
+          return tag;
+        }
+        meta_.set_fp16_compressed(v != 0);
+        break;
+      }
+      case sendrecv::VariableMessage::kFp16LossScaleFieldNumber: {
+        uint32_t v = 0;
+        if ((wt != WIRETYPE_FIXED32) || !input.ReadLittleEndian32(&v)) {
+          return tag;
+        }
+        float loss_scale;
+        memcpy(&loss_scale, &v, sizeof(loss_scale));
+        meta_.set_fp16_loss_scale(loss_scale);
+        break;
+      }
       default: {
         // Unknown tag, return unknown error.
         return -1;
@@ -325,6 +346,75 @@ int GRPCVariableResponse::Parse(Source* source) {
   return 0;
 }
 
+namespace {
+
+// The source of one variable of a MultiVariableMessage, the stream is
+// limited to the bytes of the variable.
+class LimitedStreamSource : public Source {
+ public:
+  LimitedStreamSource(::google::protobuf::io::ZeroCopyInputStream* stream,
+                      int64_t limit)
+      : stream_(stream, limit) {}
+
+  ::google::protobuf::io::ZeroCopyInputStream* contents() override {
+    return &stream_;
+  }
+
+ private:
+  ::google::protobuf::io::LimitingInputStream stream_;
+};
+
+}  // namespace
+
+int GRPCMultiVariableResponse::Parse(const ::grpc::ByteBuffer& byte_buffer) {
+  GrpcByteBufferSource source;
+  source.Init(byte_buffer);
+  GrpcByteBufferSourceWrapper r(&source);
+
+  return Parse(&r);
+}
+
+int GRPCMultiVariableResponse::Parse(Source* source) {
+  ::google::protobuf::io::ZeroCopyInputStream* input_stream =
+      source->contents();
+
+  while (true) {
+    int length = 0;
+    {
+      // The CodedInputStream backs the unread bytes up to input_stream when
+      // it is destroyed, so the variable is read from the right position.
+      ::google::protobuf::io::CodedInputStream input(input_stream);
+      auto p = input.ReadTagWithCutoff(127);
+      if (!p.second) {
+        return p.first == 0 ? 0 : -1;
+      }
+      if (GetTagFieldNumber(p.first) !=
+              sendrecv::MultiVariableMessage::kVarsFieldNumber ||
+          GetTagWireType(p.first) != WIRETYPE_LENGTH_DELIMITED ||
+          !ReadVarintSizeAsInt(&input, &length)) {
+        return -1;
+      }
+    }
+
+    LimitedStreamSource var_source(input_stream, length);
+    vars_.emplace_back(
+        new GRPCVariableResponse(scope_, dev_ctx_, create_scope_));
+    int ret = vars_.back()->Parse(&var_source);
+    if (ret != 0) {
+      return ret;
+    }
+  }
+}
+
+std::string GRPCMultiVariableResponse::Varnames() const {
+  std::string names;
+  for (auto& var : vars_) {
+    if (!names.empty()) names += ",";
+    names += var->Varname();
+  }
+  return names;
+}
+
 };  // namespace distributed
 };  // namespace operators
 };  // namespace paddle
@@ -14,7 +14,9 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/lod_tensor.h"
@@ -51,6 +53,37 @@ class GRPCVariableResponse : public VariableResponse {
   int Parse(const ::grpc::ByteBuffer& byte_buffer);
 };
 
+// GRPCMultiVariableResponse parses a MultiVariableMessage, each of its
+// variables is parsed by a GRPCVariableResponse without copying the
+// tensor data twice.
+class GRPCMultiVariableResponse {
+ public:
+  GRPCMultiVariableResponse(const framework::Scope* scope,
+                            const platform::DeviceContext* dev_ctx,
+                            bool create_scope = false)
+      : scope_(scope), dev_ctx_(dev_ctx), create_scope_(create_scope) {}
+
+  // return:
+  // 0:ok.
+  // -1: unkown error.
+  // other: number of error field of the failed variable.
+  int Parse(Source* source);
+  int Parse(const ::grpc::ByteBuffer& byte_buffer);
+
+  const std::vector<std::unique_ptr<GRPCVariableResponse>>& Vars() const {
+    return vars_;
+  }
+
+  // The names of the variables joined by commas, for logging.
+  std::string Varnames() const;
+
+ private:
+  const framework::Scope* scope_;
+  const platform::DeviceContext* dev_ctx_;
+  bool create_scope_;
+  std::vector<std::unique_ptr<GRPCVariableResponse>> vars_;
+};
+
 };  // namespace distributed
 };  // namespace operators
 };  // namespace paddle
@@ -12,11 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include <set>
+#include <algorithm>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "paddle/fluid/operators/distributed/parameter_prefetch.h"
+#include "paddle/fluid/operators/distributed/prefetch_cache.h"
 
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/scope.h"
@@ -61,10 +64,9 @@ static std::vector<int64_t> ToAbsoluteSection(
 static std::vector<std::vector<int64_t>> SplitIds(
     const std::vector<int64_t>& ids_vector,
     const std::vector<int>& height_section, framework::Scope* scope) {
-  std::set<int64_t> all_ids;
-  for (auto id : ids_vector) {
-    all_ids.insert(id);
-  }
+  std::vector<int64_t> all_ids(ids_vector);
+  std::sort(all_ids.begin(), all_ids.end());
+  all_ids.erase(std::unique(all_ids.begin(), all_ids.end()), all_ids.end());
 
   auto abs_sections = ToAbsoluteSection(height_section);
   std::vector<std::vector<int64_t>> splited_ids;
@@ -102,6 +104,8 @@ static void MergeMultipleVarsIntoOneBySection(
     const std::string& out_name, const std::vector<std::string>& out_var_names,
     const std::vector<int>& height_section,
     const std::vector<std::vector<int64_t>>& splited_ids,
+    const std::vector<int64_t>& cached_ids,
+    const std::vector<float>& cached_rows,
     const framework::ExecutionContext& context, framework::Scope* scope,
     platform::DeviceContext* actual_ctx) {
   PADDLE_ENFORCE_EQ(out_var_names.size(), height_section.size(), "");
@@ -130,6 +134,33 @@ static void MergeMultipleVarsIntoOneBySection(
     is_on_cpu_place = false;
   }
 
+  auto copy_row = [&](size_t offset, const float* row, int64_t row_numel) {
+    // should support GPU tensor
+    if (is_on_cpu_place) {
+      memory::Copy(cpu_place, out_tensor_data + offset * row_numel, cpu_place,
+                   row, sizeof(float) * row_numel);
+    } else {
+#ifndef PADDLE_WITH_CUDA
+      PADDLE_THROW("paddle is not compiled with CUDA!");
+#else
+      auto stream =
+          static_cast<platform::CUDADeviceContext*>(actual_ctx)->stream();
+      memory::Copy(boost::get<platform::CUDAPlace>(id_tensor.place()),
+                   out_tensor_data + offset * row_numel, cpu_place, row,
+                   sizeof(float) * row_numel, stream);
+#endif
+    }
+  };
+
+  if (!cached_ids.empty()) {
+    int64_t row_numel = cached_rows.size() / cached_ids.size();
+    for (size_t i = 0; i < cached_ids.size(); ++i) {
+      for (auto& offset : id_to_offset[cached_ids[i]]) {
+        copy_row(offset, cached_rows.data() + i * row_numel, row_numel);
+      }
+    }
+  }
+
   for (size_t section_idx = 0; section_idx < out_var_names.size();
        ++section_idx) {
     auto& ids_in_this_section = splited_ids[section_idx];
@@ -149,23 +180,7 @@ static void MergeMultipleVarsIntoOneBySection(
         auto origin_id = id + abs_sections[section_idx];
         auto& offsets = id_to_offset[origin_id];
         for (auto& offset : offsets) {
-          // should support GPU tensor
-          if (is_on_cpu_place) {
-            memory::Copy(cpu_place, out_tensor_data + offset * row_numel,
-                         cpu_place, out_var_data + i * row_numel,
-                         sizeof(float) * row_numel);
-          } else {
-#ifndef PADDLE_WITH_CUDA
-            PADDLE_THROW("paddle is not compiled with CUDA!");
-#else
-            auto stream =
-                static_cast<platform::CUDADeviceContext*>(actual_ctx)->stream();
-            memory::Copy(boost::get<platform::CUDAPlace>(id_tensor.place()),
-                         out_tensor_data + offset * row_numel, cpu_place,
-                         out_var_data + i * row_numel,
-                         sizeof(float) * row_numel, stream);
-#endif
-          }
+          copy_row(offset, out_var_data + i * row_numel, row_numel);
         }
       }
     } else {
@@ -174,6 +189,28 @@ static void MergeMultipleVarsIntoOneBySection(
   }
 }
 
+// Put the rows fetched from the pservers into the cache.
+static void PutRowsIntoCache(
+    const std::vector<std::string>& out_var_names,
+    const std::vector<int>& height_section,
+    const std::vector<std::vector<int64_t>>& splited_ids,
+    const framework::Scope& scope, PrefetchCache* cache) {
+  auto abs_sections = ToAbsoluteSection(height_section);
+  for (size_t section_idx = 0; section_idx < out_var_names.size();
+       ++section_idx) {
+    auto& ids_in_this_section = splited_ids[section_idx];
+    if (ids_in_this_section.empty()) continue;
+    auto& prefetch_out_var =
+        scope.FindVar(out_var_names[section_idx])->Get<framework::LoDTensor>();
+    const auto* out_var_data = prefetch_out_var.data<float>();
+    auto row_numel = prefetch_out_var.dims()[1];
+    for (size_t i = 0; i < ids_in_this_section.size(); ++i) {
+      cache->Put(ids_in_this_section[i] + abs_sections[section_idx],
+                 out_var_data + i * row_numel, row_numel);
+    }
+  }
+}
+
 void prefetch(const std::string& id_name, const std::string& out_name,
               const std::vector<std::string>& table_names,
               const std::vector<std::string>& epmap,
@@ -224,7 +261,36 @@ void prefetch(const std::string& id_name, const std::string& out_name,
 #endif
   }
 
-  auto splited_ids = SplitIds(ids_vector, height_sections, &local_scope);
+  // Only the ids missing in the cache are fetched from the pservers.
+  std::string table_key;
+  for (auto& table_name : table_names) table_key += table_name + ",";
+  auto* cache = PrefetchCache::GetInstance(table_key);
+  std::vector<int64_t> cached_ids;
+  std::vector<float> cached_rows;
+  std::vector<int64_t> fetch_ids;
+  if (cache != nullptr && !ids_vector.empty()) {
+    cache->Step();
+    auto& out_tensor = scope.FindVar(out_name)->Get<framework::LoDTensor>();
+    int64_t width = out_tensor.numel() / ids_vector.size();
+    std::unordered_set<int64_t> seen;
+    for (auto id : ids_vector) {
+      if (!seen.insert(id).second) continue;
+      cached_rows.resize((cached_ids.size() + 1) * width);
+      if (cache->Get(id, cached_rows.data() + cached_ids.size() * width,
+                     width)) {
+        cached_ids.push_back(id);
+      } else {
+        fetch_ids.push_back(id);
+      }
+    }
+    cached_rows.resize(cached_ids.size() * width);
+    VLOG(3) << "prefetch " << out_name << " hits " << cached_ids.size()
+            << " cached rows of " << seen.size() << " ids";
+  } else {
+    fetch_ids = ids_vector;
+  }
+
+  auto splited_ids = SplitIds(fetch_ids, height_sections, &local_scope);
   SplitIdsIntoMultipleVarsBySection(in_var_names, height_sections, splited_ids,
                                     &local_scope);
 
@@ -250,9 +316,13 @@ void prefetch(const std::string& id_name, const std::string& out_name,
     PADDLE_ENFORCE(rets[i]->Wait(), "internal error in RPCClient");
   }
 
-  MergeMultipleVarsIntoOneBySection(id_name, ids_vector, out_name,
-                                    out_var_names, height_sections, splited_ids,
-                                    context, &local_scope, &actual_ctx);
+  MergeMultipleVarsIntoOneBySection(
+      id_name, ids_vector, out_name, out_var_names, height_sections,
+      splited_ids, cached_ids, cached_rows, context, &local_scope, &actual_ctx);
+  if (cache != nullptr) {
+    PutRowsIntoCache(out_var_names, height_sections, splited_ids, local_scope,
+                     cache);
+  }
   scope.DeleteScope(&local_scope);
 }
 
@@ -0,0 +1,157 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/prefetch_batcher.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <future>  // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_map>
+
+#include "paddle/fluid/framework/threadpool.h"
+
+DEFINE_bool(rpc_prefetch_batch, false,
+            "coalesce the concurrent prefetch requests of a sparse table "
+            "into batched and deduplicated lookups");
+DEFINE_int32(rpc_prefetch_batch_window_us, 100,
+             "the microseconds a batch of prefetch requests waits for more "
+             "requests before the lookup");
+DEFINE_int32(rpc_prefetch_lookup_shards, 4,
+             "the number of the shards of ids looked up in parallel by a "
+             "batch of prefetch requests");
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+void PrefetchBatcher::Lookup(const framework::LoDTensor& ids,
+                             framework::LoDTensor* out) {
+  Request request;
+  request.ids = &ids;
+  request.out = out;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  pending_.push_back(&request);
+  while (!request.done) {
+    if (running_) {
+      cv_.wait(lock);
+      continue;
+    }
+    running_ = true;
+    if (FLAGS_rpc_prefetch_batch_window_us > 0) {
+      lock.unlock();
+      std::this_thread::sleep_for(
+          std::chrono::microseconds(FLAGS_rpc_prefetch_batch_window_us));
+      lock.lock();
+    }
+    std::vector<Request*> batch;
+    batch.swap(pending_);
+    lock.unlock();
+
+    std::exception_ptr error;
+    try {
+      RunBatch(batch);
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    lock.lock();
+    for (auto* r : batch) {
+      r->error = error;
+      r->done = true;
+    }
+    running_ = false;
+    cv_.notify_all();
+  }
+  lock.unlock();
+  if (request.error) std::rethrow_exception(request.error);
+}
+
+void PrefetchBatcher::RunBatch(const std::vector<Request*>& batch) {
+  PADDLE_ENFORCE_EQ(table_->value().type(), framework::proto::VarType::FP32,
+                    "The sparse table only support FP32");
+  // Deduplicate the ids of all the requests.
+  std::unordered_map<int64_t, int64_t> id_to_unique;
+  std::vector<int64_t> unique_ids;
+  std::vector<std::vector<int64_t>> positions(batch.size());
+  for (size_t i = 0; i < batch.size(); ++i) {
+    auto& ids = *batch[i]->ids;
+    const int64_t* ids_data = ids.data<int64_t>();
+    positions[i].reserve(ids.numel());
+    for (int64_t j = 0; j < ids.numel(); ++j) {
+      auto it = id_to_unique.emplace(ids_data[j], unique_ids.size()).first;
+      if (it->second == static_cast<int64_t>(unique_ids.size())) {
+        unique_ids.push_back(ids_data[j]);
+      }
+      positions[i].push_back(it->second);
+    }
+  }
+  VLOG(4) << "prefetch batch of " << batch.size() << " requests looks up "
+          << unique_ids.size() << " ids";
+
+  platform::CPUPlace cpu;
+  int64_t num = unique_ids.size();
+  int64_t width = table_->value().numel() / table_->value().dims()[0];
+  framework::Tensor unique_ids_t;
+  unique_ids_t.Resize({num});
+  std::copy(unique_ids.begin(), unique_ids.end(),
+            unique_ids_t.mutable_data<int64_t>(cpu));
+  framework::Tensor values;
+  values.Resize({num, width});
+  const float* values_data = values.mutable_data<float>(cpu);
+
+  if (num > 0) {
+    // The index of the table takes the locks of its own shards, so that
+    // the shards of ids are looked up in parallel.
+    int64_t shards = std::min<int64_t>(
+        std::max(FLAGS_rpc_prefetch_lookup_shards, 1), num);
+    int64_t shard_size = (num + shards - 1) / shards;
+    std::vector<std::future<void>> fs;
+    for (int64_t begin = 0; begin < num; begin += shard_size) {
+      int64_t end = std::min(begin + shard_size, num);
+      fs.push_back(framework::Async([&, begin, end] {
+        auto ids_shard = unique_ids_t.Slice(begin, end);
+        auto values_shard = values.Slice(begin, end);
+        table_->Get(ids_shard, &values_shard, true, is_test_);
+      }));
+    }
+    std::exception_ptr error;
+    for (auto& f : fs) {
+      try {
+        f.get();
+      } catch (...) {
+        error = std::current_exception();
+      }
+    }
+    if (error) std::rethrow_exception(error);
+  }
+
+  // Scatter the rows back to the requests.
+  for (size_t i = 0; i < batch.size(); ++i) {
+    auto& ids = *batch[i]->ids;
+    auto* out = batch[i]->out;
+    out->Resize({ids.numel(), width});
+    float* out_data = out->mutable_data<float>(cpu);
+    for (size_t j = 0; j < positions[i].size(); ++j) {
+      const float* row = values_data + positions[i][j] * width;
+      std::copy(row, row + width, out_data + j * width);
+    }
+    out->set_lod(ids.lod());
+  }
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,73 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <exception>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/selected_rows.h"
+
+DECLARE_bool(rpc_prefetch_batch);
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+/*
+ * PrefetchBatcher coalesces the concurrent prefetch requests of a sparse
+ * table into batched lookups.
+ *
+ * The first request that finds no batch running leads the next batch: it
+ * waits FLAGS_rpc_prefetch_batch_window_us for the other requests, takes all
+ * the queued ones, looks up their deduplicated ids in the table by
+ * FLAGS_rpc_prefetch_lookup_shards shards in parallel, and scatters the rows
+ * back into the output of every request. The requests that arrive while a
+ * batch is running are queued for the next one.
+ */
+class PrefetchBatcher {
+ public:
+  PrefetchBatcher(framework::SelectedRows* table, bool is_test)
+      : table_(table), is_test_(is_test) {}
+
+  // Look up the FP32 rows of ids into out, which has the lod of ids. It
+  // blocks until the batch of the request is done.
+  void Lookup(const framework::LoDTensor& ids, framework::LoDTensor* out);
+
+ private:
+  struct Request {
+    const framework::LoDTensor* ids;
+    framework::LoDTensor* out;
+    bool done{false};
+    std::exception_ptr error;
+  };
+
+  void RunBatch(const std::vector<Request*>& batch);
+
+  framework::SelectedRows* table_;
+  bool is_test_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<Request*> pending_;
+  bool running_{false};
+};
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,72 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/operators/distributed/prefetch_batcher.h"
+
+namespace framework = paddle::framework;
+namespace platform = paddle::platform;
+namespace distributed = paddle::operators::distributed;
+
+TEST(PrefetchBatcher, ConcurrentLookup) {
+  platform::CPUPlace cpu;
+  const int64_t table_size = 100;
+  const int64_t width = 8;
+  framework::SelectedRows table;
+  table.mutable_value()->Resize({table_size, width});
+  float* data = table.mutable_value()->mutable_data<float>(cpu);
+  for (int64_t i = 0; i < table_size; ++i) {
+    for (int64_t j = 0; j < width; ++j) data[i * width + j] = i;
+    // the row of id i is i
+    ASSERT_EQ(table.AutoGrownIndex(i, true), i);
+  }
+
+  distributed::PrefetchBatcher batcher(&table, false);
+  const int num_threads = 8;
+  std::vector<std::vector<int64_t>> results(num_threads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int iter = 0; iter < 10; ++iter) {
+        framework::LoDTensor ids;
+        int64_t num = 5 + t;
+        ids.Resize({num, 1});
+        int64_t* ids_data = ids.mutable_data<int64_t>(cpu);
+        // the requests of the threads share some ids
+        for (int64_t i = 0; i < num; ++i) ids_data[i] = (t + i * 3) % 10;
+        ids.set_lod({{0, 2, static_cast<size_t>(num)}});
+
+        framework::LoDTensor out;
+        batcher.Lookup(ids, &out);
+        EXPECT_EQ(out.dims(), framework::make_ddim({num, width}));
+        EXPECT_EQ(out.lod(), ids.lod());
+        const float* out_data = out.data<float>();
+        for (int64_t i = 0; i < num; ++i) {
+          for (int64_t j = 0; j < width; ++j) {
+            if (out_data[i * width + j] != ids_data[i]) {
+              results[t].push_back(i);
+            }
+          }
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  for (auto& result : results) {
+    EXPECT_TRUE(result.empty());
+  }
+}
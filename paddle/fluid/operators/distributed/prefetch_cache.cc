@@ -0,0 +1,91 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/distributed/prefetch_cache.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "gflags/gflags.h"
+#include "paddle/fluid/platform/enforce.h"
+
+DEFINE_int32(prefetch_cache_rows, 0,
+             "the max number of the prefetched embedding rows cached by the "
+             "trainer for every table, 0 disables the cache");
+DEFINE_int32(prefetch_cache_expire_steps, 100,
+             "the number of the prefetch steps a cached embedding row is used "
+             "before it is fetched from the pserver again");
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+PrefetchCache* PrefetchCache::GetInstance(const std::string& table_name) {
+  if (FLAGS_prefetch_cache_rows <= 0) return nullptr;
+  static std::mutex mutex;
+  static std::unordered_map<std::string, std::unique_ptr<PrefetchCache>>
+      caches;
+  std::lock_guard<std::mutex> guard(mutex);
+  auto& cache = caches[table_name];
+  if (cache == nullptr) {
+    PADDLE_ENFORCE_GT(FLAGS_prefetch_cache_expire_steps, 0);
+    cache.reset(new PrefetchCache(FLAGS_prefetch_cache_rows,
+                                  FLAGS_prefetch_cache_expire_steps));
+  }
+  return cache.get();
+}
+
+void PrefetchCache::Step() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  ++step_;
+}
+
+bool PrefetchCache::Get(int64_t id, float* row, int64_t width) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = index_.find(id);
+  if (it == index_.end()) return false;
+  auto entry = it->second;
+  if (step_ - entry->step >= expire_steps_ ||
+      static_cast<int64_t>(entry->row.size()) != width) {
+    lru_.erase(entry);
+    index_.erase(it);
+    return false;
+  }
+  lru_.splice(lru_.begin(), lru_, entry);
+  std::copy(entry->row.begin(), entry->row.end(), row);
+  return true;
+}
+
+void PrefetchCache::Put(int64_t id, const float* row, int64_t width) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = index_.find(id);
+  if (it != index_.end()) {
+    lru_.erase(it->second);
+    index_.erase(it);
+  } else if (lru_.size() >= capacity_) {
+    index_.erase(lru_.back().id);
+    lru_.pop_back();
+  }
+  lru_.push_front(Entry{id, step_, std::vector<float>(row, row + width)});
+  index_[id] = lru_.begin();
+}
+
+size_t PrefetchCache::Size() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return lru_.size();
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,71 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+/*
+ * PrefetchCache is the trainer-local LRU cache of the embedding rows
+ * prefetched from the pservers.
+ *
+ * Every prefetch of the table is a step of its cache, and a row cached
+ * expire_steps steps ago is fetched again, so that the rows used by the
+ * trainer are at most expire_steps steps staler than the pservers.
+ */
+class PrefetchCache {
+ public:
+  PrefetchCache(size_t capacity, int64_t expire_steps)
+      : capacity_(capacity), expire_steps_(expire_steps) {}
+
+  // The cache of the table, nullptr if FLAGS_prefetch_cache_rows is 0.
+  static PrefetchCache* GetInstance(const std::string& table_name);
+
+  void Step();
+
+  // Copy the row of id to row if it is cached and not expired.
+  bool Get(int64_t id, float* row, int64_t width);
+
+  void Put(int64_t id, const float* row, int64_t width);
+
+  size_t Size();
+
+ private:
+  struct Entry {
+    int64_t id;
+    int64_t step;
+    std::vector<float> row;
+  };
+
+  size_t capacity_;
+  int64_t expire_steps_;
+
+  std::mutex mutex_;
+  int64_t step_{0};
+  // The most recently used rows are at the front.
+  std::list<Entry> lru_;
+  std::unordered_map<int64_t, std::list<Entry>::iterator> index_;
+};
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
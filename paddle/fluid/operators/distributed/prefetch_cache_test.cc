@@ -0,0 +1,51 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/operators/distributed/prefetch_cache.h"
+
+namespace distributed = paddle::operators::distributed;
+
+TEST(PrefetchCache, LRU) {
+  distributed::PrefetchCache cache(2, 100);
+  std::vector<float> row(3);
+  for (int64_t id = 0; id < 2; ++id) {
+    std::vector<float> value(3, id);
+    cache.Put(id, value.data(), 3);
+  }
+  EXPECT_TRUE(cache.Get(0, row.data(), 3));
+  EXPECT_EQ(row, std::vector<float>(3, 0));
+
+  // 1 is the least recently used one.
+  std::vector<float> value(3, 2);
+  cache.Put(2, value.data(), 3);
+  EXPECT_EQ(cache.Size(), 2UL);
+  EXPECT_FALSE(cache.Get(1, row.data(), 3));
+  EXPECT_TRUE(cache.Get(0, row.data(), 3));
+  EXPECT_TRUE(cache.Get(2, row.data(), 3));
+  EXPECT_EQ(row, std::vector<float>(3, 2));
+}
+
+TEST(PrefetchCache, Expire) {
+  distributed::PrefetchCache cache(10, 2);
+  std::vector<float> row(3, 1);
+  cache.Put(0, row.data(), 3);
+  cache.Step();
+  EXPECT_TRUE(cache.Get(0, row.data(), 3));
+  cache.Step();
+  EXPECT_FALSE(cache.Get(0, row.data(), 3));
+  EXPECT_EQ(cache.Size(), 0UL);
+}
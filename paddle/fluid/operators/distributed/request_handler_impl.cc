@@ -124,8 +124,15 @@ bool RequestPrefetchHandler::Handle(const std::string& varname,
   if (table_name.empty()) {
     auto var_desc = program_->Block(0).FindVar(out_var_name);
     InitializeVariable(*outvar, var_desc->GetType());
-    executor_->RunPreparedContext(
-        (*prefetch_var_name_to_prepared_ctx_)[varname].get(), scope);
+    auto* batcher =
+        FLAGS_rpc_prefetch_batch ? GetBatcher(varname, out_var_name) : nullptr;
+    if (batcher != nullptr) {
+      batcher->Lookup(invar->Get<framework::LoDTensor>(),
+                      (*outvar)->GetMutable<framework::LoDTensor>());
+    } else {
+      executor_->RunPreparedContext(
+          (*prefetch_var_name_to_prepared_ctx_)[varname].get(), scope);
+    }
   } else {
     (*outvar)->GetMutable<framework::LoDTensor>();
     auto lookup_table_op =
@@ -136,6 +143,29 @@ bool RequestPrefetchHandler::Handle(const std::string& varname,
   return true;
 }
 
+PrefetchBatcher* RequestPrefetchHandler::GetBatcher(
+    const std::string& varname, const std::string& out_var_name) {
+  std::lock_guard<std::mutex> guard(batchers_mutex_);
+  auto it = batchers_.find(varname);
+  if (it != batchers_.end()) return it->second.get();
+
+  auto& ops = (*prefetch_var_name_to_prepared_ctx_)[varname]->ops_;
+  std::unique_ptr<PrefetchBatcher> batcher;
+  if (ops.size() == 1 && ops[0]->Type() == "lookup_sparse_table" &&
+      ops[0]->Input("Ids") == varname &&
+      ops[0]->Output("Out") == out_var_name) {
+    auto* table = scope_->FindVar(ops[0]->Input("W"));
+    if (table != nullptr && table->IsType<framework::SelectedRows>()) {
+      batcher.reset(
+          new PrefetchBatcher(table->GetMutable<framework::SelectedRows>(),
+                              ops[0]->Attr<bool>("is_test")));
+    }
+  }
+  VLOG(3) << "prefetch of " << varname
+          << (batcher ? " is batched" : " runs the prefetch block");
+  return (batchers_[varname] = std::move(batcher)).get();
+}
+
 bool RequestCheckpointHandler::Handle(const std::string& varname,
                                       framework::Scope* scope,
                                       framework::Variable* invar,
@@ -147,6 +177,19 @@ bool RequestCheckpointHandler::Handle(const std::string& varname,
       checkpoint_notify_id != -1,
       "when checkpoint_notify_id = -1, there should be no RPC invoke.");
 
+  if (sparse_table_checkpoint_ != nullptr) {
+    try {
+      sparse_table_checkpoint_->Save(out_var_name);
+    } catch (platform::EnforceNotMet& e) {
+      LOG(ERROR) << "checkpoint of the sparse table to " << out_var_name
+                 << " failed: " << e.what();
+      return false;
+    }
+    VLOG(4) << "RequestCheckpointHandler checkpoints the sparse table to "
+            << out_var_name;
+    return true;
+  }
+
   // TODO(tangwei12): find out why scope will be error.
   auto* lt_var = scope_->FindVar(LOOKUP_TABLE_PATH)->GetMutable<std::string>();
   lt_var->clear();
@@ -17,7 +17,10 @@
 #include <time.h>
 
 #include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -28,7 +31,9 @@
 #include "paddle/fluid/framework/program_desc.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/framework/sparse_table_checkpoint.h"
 #include "paddle/fluid/framework/var_type.h"
+#include "paddle/fluid/operators/distributed/prefetch_batcher.h"
 #include "paddle/fluid/operators/distributed/request_handler.h"
 
 namespace paddle {
@@ -86,6 +91,11 @@ class RequestPrefetchHandler final : public RequestHandler {
               const std::string& table_name = "") override;
 
  private:
+  // The batcher of the prefetch block of varname, nullptr if the block is
+  // not a single lookup_sparse_table from varname to out_var_name.
+  PrefetchBatcher* GetBatcher(const std::string& varname,
+                              const std::string& out_var_name);
+
   std::unique_ptr<paddle::framework::OperatorBase> BuildLookupTableOp(
       const std::string& table_name, const std::string& id_name,
       const std::string& out_name) {
@@ -98,6 +108,9 @@ class RequestPrefetchHandler final : public RequestHandler {
     auto op = paddle::framework::OpRegistry::CreateOp(op_desc);
     return op;
   }
+
+  std::mutex batchers_mutex_;
+  std::unordered_map<std::string, std::unique_ptr<PrefetchBatcher>> batchers_;
 };
 
 class RequestCheckpointHandler final : public RequestHandler {
@@ -112,8 +125,16 @@ class RequestCheckpointHandler final : public RequestHandler {
               const int trainer_id, const std::string& out_var_name = "",
               const std::string& table_name = "") override;
 
+  // Checkpoint the sparse table incrementally in the background instead of
+  // running the save block.
+  void SetSparseTableCheckpoint(
+      std::unique_ptr<framework::SparseTableCheckpoint> checkpoint) {
+    sparse_table_checkpoint_ = std::move(checkpoint);
+  }
+
  private:
   int checkpoint_notify_id;
+  std::unique_ptr<framework::SparseTableCheckpoint> sparse_table_checkpoint_;
 };
 
 }  // namespace distributed
@@ -17,6 +17,9 @@
 
 // default to 3min to avoid temprary network failures.
 DEFINE_int32(rpc_deadline, 180000, "deadline timeouts for rpc");
+DEFINE_bool(rpc_batch_vars, false,
+            "send and get all the variables bound for one pserver in one rpc "
+            "instead of one rpc per variable");
 
 namespace paddle {
 namespace operators {
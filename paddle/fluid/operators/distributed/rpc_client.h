@@ -16,6 +16,7 @@
 
 #include <condition_variable>  // NOLINT
 #include <string>
+#include <vector>
 #include "gflags/gflags.h"
 
 #include "paddle/fluid/framework/data_type.h"
@@ -24,6 +25,7 @@
 #include "paddle/fluid/operators/distributed/request_handler.h"
 
 DECLARE_int32(rpc_deadline);
+DECLARE_bool(rpc_batch_vars);
 
 namespace paddle {
 namespace operators {
@@ -45,6 +47,31 @@ class RPCClient {
                                    const std::string& var_name,
                                    int64_t time_out = FLAGS_rpc_deadline) = 0;
 
+  // Send or get all the variables bound for ep. The clients which support
+  // multi-variable messages do it in one RPC and return one handle, the
+  // others fall back to one RPC per variable.
+  virtual std::vector<VarHandlePtr> AsyncSendVars(
+      const std::string& ep, const platform::DeviceContext& ctx,
+      const framework::Scope& scope, const std::vector<std::string>& var_names,
+      int64_t time_out = FLAGS_rpc_deadline) {
+    std::vector<VarHandlePtr> rets;
+    for (auto& var_name : var_names) {
+      rets.push_back(AsyncSendVar(ep, ctx, scope, var_name, time_out));
+    }
+    return rets;
+  }
+
+  virtual std::vector<VarHandlePtr> AsyncGetVars(
+      const std::string& ep, const platform::DeviceContext& ctx,
+      const framework::Scope& scope, const std::vector<std::string>& var_names,
+      int64_t time_out = FLAGS_rpc_deadline) {
+    std::vector<VarHandlePtr> rets;
+    for (auto& var_name : var_names) {
+      rets.push_back(AsyncGetVar(ep, ctx, scope, var_name, time_out));
+    }
+    return rets;
+  }
+
   virtual VarHandlePtr AsyncGetMonomerVariable(
       const std::string& ep, const platform::DeviceContext& ctx,
       const framework::Scope& scope, const std::string& var_name,
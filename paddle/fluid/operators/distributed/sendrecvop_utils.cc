@@ -15,14 +15,31 @@ limitations under the License. */
 #ifdef PADDLE_WITH_CUDA
 #include <nccl.h>
 #endif
+#include <mutex>   // NOLINT
 #include <thread>  // NOLINT
+#include <unordered_map>
 
 #include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/var_name_allowlist.h"
 #include "paddle/fluid/operators/distributed/sendrecvop_utils.h"
 #include "paddle/fluid/operators/distributed/variable_response.h"
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/fluid/platform/cuda_device_guard.h"
+#endif
+#include "paddle/fluid/platform/float16.h"
 #include "paddle/fluid/platform/port.h"
 
 DEFINE_bool(rpc_disable_reuse_port, false, "Disable SO_REUSEPORT or not.");
+DEFINE_string(rpc_fp16_compress_vars, "",
+              "Comma separated names of the FP32 variables that are cast to "
+              "FP16 before being sent by RPC and cast back on receipt, e.g. "
+              "'fc_0.w_0@GRAD,fc_0.b_0@GRAD', '*' means all the FP32 "
+              "variables. It halves the network bytes at the cost of "
+              "precision.");
+DEFINE_double(rpc_fp16_compress_loss_scale, 1.0,
+              "The compressed variables are multiplied by this value before "
+              "being cast to FP16 and divided by it on receipt, so that small "
+              "gradients do not underflow.");
 
 namespace paddle {
 namespace operators {
@@ -30,6 +47,68 @@ namespace distributed {
 
 using VarMsg = sendrecv::VariableMessage;
 
+#ifdef PADDLE_WITH_CUDA
+// The streams of the copies between the tensors and the RPC buffers, one
+// per device.
+class RPCCopyStreams {
+ public:
+  static RPCCopyStreams& Instance() {
+    static RPCCopyStreams streams;
+    return streams;
+  }
+
+  cudaStream_t Stream(int device) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = streams_.find(device);
+    if (it != streams_.end()) return it->second;
+    platform::CUDADeviceGuard guard(device);
+    cudaStream_t stream;
+    PADDLE_ENFORCE(cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking));
+    streams_.emplace(device, stream);
+    return stream;
+  }
+
+ private:
+  RPCCopyStreams() = default;
+
+  std::mutex mtx_;
+  std::unordered_map<int, cudaStream_t> streams_;
+};
+
+template <typename Copy>
+static void RunOnRPCStream(const platform::CUDADeviceContext& ctx, int device,
+                           Copy copy) {
+  platform::CUDADeviceGuard guard(device);
+  cudaStream_t stream = RPCCopyStreams::Instance().Stream(device);
+  cudaEvent_t event;
+  PADDLE_ENFORCE(cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+  PADDLE_ENFORCE(cudaEventRecord(event, ctx.stream()));
+  PADDLE_ENFORCE(cudaStreamWaitEvent(stream, event, 0));
+  copy(stream);
+  PADDLE_ENFORCE(cudaEventRecord(event, stream));
+  PADDLE_ENFORCE(cudaEventSynchronize(event));
+  PADDLE_ENFORCE(cudaEventDestroy(event));
+}
+
+void CopyToPinnedOnRPCStream(const platform::CUDADeviceContext& ctx,
+                             void* dst, const platform::CUDAPlace& src_place,
+                             const void* src, size_t num) {
+  RunOnRPCStream(ctx, src_place.device, [&](cudaStream_t stream) {
+    memory::Copy(platform::CUDAPinnedPlace(), dst, src_place, src, num,
+                 stream);
+  });
+}
+
+void CopyFromPinnedOnRPCStream(const platform::CUDADeviceContext& ctx,
+                               const platform::CUDAPlace& dst_place, void* dst,
+                               const void* src, size_t num) {
+  RunOnRPCStream(ctx, dst_place.device, [&](cudaStream_t stream) {
+    memory::Copy(dst_place, dst, platform::CUDAPinnedPlace(), src, num,
+                 stream);
+  });
+}
+#endif
+
 static TensorPayload GetCommunicationAllocationFromTensor(
     const platform::DeviceContext& ctx, const framework::Tensor& tensor) {
   if (is_gpu_place(ctx.GetPlace())) {
@@ -42,10 +121,11 @@ static TensorPayload GetCommunicationAllocationFromTensor(
     auto result = memory::AllocShared(
         cuda_pinned, copy_size, memory::allocation::Allocator::kCrossDevice);
 
-    memory::Copy(cuda_pinned, result->ptr(),
-                 boost::get<platform::CUDAPlace>(tensor.place()),
-                 tensor.data<void>(), copy_size, gpu_dev_ctx.stream());
-    ctx.Wait();
+    // The pinned allocations are cached by the allocator, so they are not
+    // registered to the driver again for every send.
+    CopyToPinnedOnRPCStream(gpu_dev_ctx, result->ptr(),
+                            boost::get<platform::CUDAPlace>(tensor.place()),
+                            tensor.data<void>(), copy_size);
     return TensorPayload(result);
 #else
     PADDLE_THROW("This situation should not be happened");
@@ -54,6 +134,61 @@ static TensorPayload GetCommunicationAllocationFromTensor(
     return TensorPayload(tensor);
   }
 }
+static TensorPayload GetFP16PayloadFromTensor(
+    const platform::DeviceContext& ctx, const framework::Tensor& tensor,
+    float loss_scale) {
+  framework::Tensor cpu_tensor;
+  const framework::Tensor* src = &tensor;
+  if (is_gpu_place(tensor.place())) {
+    framework::TensorCopy(tensor, platform::CPUPlace(), ctx, &cpu_tensor);
+    ctx.Wait();
+    src = &cpu_tensor;
+  }
+
+  auto numel = src->numel();
+  auto copy_size = numel * sizeof(platform::float16);
+  std::shared_ptr<memory::Allocation> result;
+  if (is_gpu_place(ctx.GetPlace())) {
+#ifdef PADDLE_WITH_CUDA
+    result = memory::AllocShared(platform::CUDAPinnedPlace(), copy_size,
+                                 memory::allocation::Allocator::kCrossDevice);
+#else
+    PADDLE_THROW("This situation should not be happened");
+#endif
+  } else {
+    result = memory::AllocShared(platform::CPUPlace(), copy_size);
+  }
+
+  auto* in = src->data<float>();
+  auto* out = reinterpret_cast<platform::float16*>(result->ptr());
+  for (int64_t i = 0; i < numel; ++i) {
+    out[i] = static_cast<platform::float16>(in[i] * loss_scale);
+  }
+  return TensorPayload(result);
+}
+
+bool NeedFP16Compress(const std::string& varname,
+                      framework::proto::VarType::Type type) {
+  if (type != framework::proto::VarType::FP32 ||
+      FLAGS_rpc_fp16_compress_vars.empty()) {
+    return false;
+  }
+  return framework::VarNameAllowlist(FLAGS_rpc_fp16_compress_vars)
+      .Contains(varname);
+}
+
+static TensorPayload GetPayloadFromTensor(const platform::DeviceContext& ctx,
+                                          const framework::Tensor& tensor,
+                                          VarMsg* request) {
+  if (NeedFP16Compress(request->varname(), tensor.type())) {
+    float loss_scale = static_cast<float>(FLAGS_rpc_fp16_compress_loss_scale);
+    request->set_fp16_compressed(true);
+    request->set_fp16_loss_scale(loss_scale);
+    return GetFP16PayloadFromTensor(ctx, tensor, loss_scale);
+  }
+  return GetCommunicationAllocationFromTensor(ctx, tensor);
+}
+
 TensorPayload GetTensorPayload(framework::Variable* var,
                                const platform::DeviceContext& ctx,
                                VarMsg* request) {
@@ -74,7 +209,7 @@ TensorPayload GetTensorPayload(framework::Variable* var,
       }
     }
   }
-  return GetCommunicationAllocationFromTensor(ctx, tensor);
+  return GetPayloadFromTensor(ctx, tensor, request);
 }
 
 TensorPayload GetSelectedRowsPayload(framework::Variable* var,
@@ -90,7 +225,7 @@ TensorPayload GetSelectedRowsPayload(framework::Variable* var,
   }
 
   auto* tensor = slr->mutable_value();
-  return GetCommunicationAllocationFromTensor(ctx, *tensor);
+  return GetPayloadFromTensor(ctx, *tensor, request);
 }
 
 TensorPayload::TensorPayload(std::shared_ptr<memory::Allocation> allocation)
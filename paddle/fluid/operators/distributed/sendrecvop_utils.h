@@ -65,9 +65,28 @@ TensorPayload GetSelectedRowsPayload(framework::Variable* var,
                                      const platform::DeviceContext& ctx,
                                      VarMsg* request);
 
+#ifdef PADDLE_WITH_CUDA
+// Copy between a GPU tensor and a pinned RPC buffer on the RPC copy stream
+// of the device. The copy starts after the work already queued on ctx, and
+// only the copy is waited for, so neither the kernels queued on ctx later
+// nor the copies of the other RPC threads block it.
+void CopyToPinnedOnRPCStream(const platform::CUDADeviceContext& ctx,
+                             void* dst, const platform::CUDAPlace& src_place,
+                             const void* src, size_t num);
+void CopyFromPinnedOnRPCStream(const platform::CUDADeviceContext& ctx,
+                               const platform::CUDAPlace& dst_place, void* dst,
+                               const void* src, size_t num);
+#endif
+
+// Whether the variable is sent as FP16, see FLAGS_rpc_fp16_compress_vars.
+bool NeedFP16Compress(const std::string& varname,
+                      framework::proto::VarType::Type type);
+
 inline framework::proto::VarType::Type ToVarType(
     sendrecv::VariableMessage::Type type) {
   switch (type) {
+    case sendrecv::VariableMessage::FP16:
+      return framework::proto::VarType::FP16;  // NOLINT
     case sendrecv::VariableMessage::FP32:
       return framework::proto::VarType::FP32;  // NOLINT
     case sendrecv::VariableMessage::FP64:
@@ -13,8 +13,10 @@
 // limitations under the License.
 
 #include "paddle/fluid/operators/distributed/variable_response.h"
+#include <cstring>
 #include <vector>
 #include "paddle/fluid/operators/distributed/sendrecvop_utils.h"
+#include "paddle/fluid/platform/float16.h"
 
 DEFINE_string(rpc_server_profile_path, "./profile_ps",
               "the profile log file path");
@@ -36,9 +38,12 @@ bool VariableResponse::ReadRaw(::google::protobuf::io::CodedInputStream* input,
 #ifdef PADDLE_WITH_CUDA
     auto& gpu_dev_ctx =
         static_cast<const platform::CUDADeviceContext&>(dev_ctx);
-    platform::CPUPlace cpu;
-
-    char* p = reinterpret_cast<char*>(dest);
+    // Gather the chunks of the RPC buffer into one pinned buffer and copy it
+    // to the tensor at once, instead of one synchronous copy from pageable
+    // memory per chunk.
+    auto staging = memory::Alloc(platform::CUDAPinnedPlace(), length,
+                                 memory::Allocator::kCrossDevice);
+    char* p = reinterpret_cast<char*>(staging->ptr());
     while (total_written < length) {
       if (!input->GetDirectBufferPointer(&data, &size_to_write)) {
         return false;
@@ -50,16 +55,16 @@ bool VariableResponse::ReadRaw(::google::protobuf::io::CodedInputStream* input,
         size_to_write = length - total_written;
       }
       // This log is useful to see how long a internal block size is of rpc.
-      VLOG(7) << "copy " << size_to_write << " data to CUDAPlace";
-      memory::Copy(boost::get<platform::CUDAPlace>(place),
-                   reinterpret_cast<void*>(p), cpu, data, size_to_write,
-                   gpu_dev_ctx.stream());
+      VLOG(7) << "copy " << size_to_write << " data to CUDAPinnedPlace";
+      memcpy(p, data, size_to_write);
       p += size_to_write;
       total_written += size_to_write;
 
       input->Skip(size_to_write);
     }
-    gpu_dev_ctx.Wait();
+    CopyFromPinnedOnRPCStream(gpu_dev_ctx,
+                              boost::get<platform::CUDAPlace>(place), dest,
+                              staging->ptr(), length);
 #else
     PADDLE_THROW("Unexpected branch");
 #endif
@@ -113,6 +118,10 @@ bool VariableResponse::CopyLodTensorData(
   }
   tensor->set_lod(lod);
 
+  if (meta_.fp16_compressed()) {
+    return CopyFP16CompressedData(input, ctx, tensor, length);
+  }
+
   void* tensor_data =
       tensor->mutable_data(ctx.GetPlace(), ToVarType(meta_.data_type()));
 
@@ -122,6 +131,40 @@ bool VariableResponse::CopyLodTensorData(
   return ReadRaw(input, ctx, tensor->place(), tensor_data, length);
 }
 
+bool VariableResponse::CopyFP16CompressedData(
+    ::google::protobuf::io::CodedInputStream* input,
+    const platform::DeviceContext& ctx, framework::Tensor* tensor,
+    int length) {
+  PADDLE_ENFORCE_EQ(ToVarType(meta_.data_type()),
+                    framework::proto::VarType::FP32,
+                    "Only FP32 variables can be FP16 compressed.");
+  auto numel = tensor->numel();
+  PADDLE_ENFORCE_EQ(numel * sizeof(platform::float16),
+                    static_cast<size_t>(length));
+
+  std::vector<platform::float16> fp16_data(numel);
+  platform::CPUPlace cpu;
+  if (!ReadRaw(input, ctx, cpu, fp16_data.data(), length)) {
+    return false;
+  }
+
+  float loss_scale =
+      meta_.fp16_loss_scale() > 0.0f ? meta_.fp16_loss_scale() : 1.0f;
+  bool on_cpu = platform::is_cpu_place(ctx.GetPlace());
+  framework::Tensor cpu_tensor;
+  float* data = on_cpu ? tensor->mutable_data<float>(cpu)
+                       : cpu_tensor.mutable_data<float>(tensor->dims(), cpu);
+  for (int64_t i = 0; i < numel; ++i) {
+    data[i] = static_cast<float>(fp16_data[i]) / loss_scale;
+  }
+
+  if (!on_cpu) {
+    framework::TensorCopy(cpu_tensor, ctx.GetPlace(), ctx, tensor);
+    ctx.Wait();
+  }
+  return true;
+}
+
 inline framework::DDim GetDims(
     const ::google::protobuf::RepeatedField<::google::protobuf::int64>& dims) {
   std::vector<int> vecdims;
@@ -139,6 +182,9 @@ bool VariableResponse::CopySelectRowsTensorData(
   slr->set_height(meta_.slr_height());
   auto* tensor = slr->mutable_value();
   tensor->Resize(dims);
+  if (meta_.fp16_compressed()) {
+    return CopyFP16CompressedData(input, ctx, tensor, length);
+  }
   PADDLE_ENFORCE_EQ(
       static_cast<size_t>(tensor->numel()),
       length / framework::SizeOfType(paddle::operators::distributed::ToVarType(
@@ -113,6 +113,11 @@ class VariableResponse {
                          const platform::DeviceContext& ctx,
                          const framework::DDim& dims, int length);
 
+  // Read the FP16 data of a compressed variable and cast it back to FP32.
+  bool CopyFP16CompressedData(::google::protobuf::io::CodedInputStream* input,
+                              const platform::DeviceContext& ctx,
+                              framework::Tensor* tensor, int length);
+
   bool ProcSerializedField(int tag,
                            ::google::protobuf::io::CodedInputStream* input,
                            int64_t num_bytes);
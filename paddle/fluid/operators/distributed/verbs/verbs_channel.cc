@@ -0,0 +1,636 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifdef PADDLE_WITH_VERBS
+
+#include "paddle/fluid/operators/distributed/verbs/verbs_channel.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>  // NOLINT
+
+#include "glog/logging.h"
+#include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/platform/enforce.h"
+
+DEFINE_string(rpc_verbs_device, "",
+              "the ibverbs device used by the verbs rpc, the first one if "
+              "it is empty");
+DEFINE_int32(rpc_verbs_port, 1, "the port of the ibverbs device");
+DEFINE_int32(rpc_verbs_gid_index, -1,
+             "the gid index of the port, which must be set for RoCE, -1 "
+             "addresses the peers by lid");
+DEFINE_int32(rpc_verbs_inline_bytes, 64 * 1024,
+             "the messages longer than it are sent by a rendezvous and a "
+             "one-sided RDMA write instead of a verbs send");
+DEFINE_int32(rpc_verbs_queue_depth, 128,
+             "the depth of the send queue and the receive queue of every "
+             "verbs channel");
+
+DECLARE_int32(rpc_deadline);
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+enum VerbsMessageType : uint32_t {
+  kVerbsData = 0,
+  // request to send a payload longer than FLAGS_rpc_verbs_inline_bytes
+  kVerbsRts = 1,
+  // the address of the buffer the payload is written to
+  kVerbsCts = 2,
+};
+
+// The header of every message sent by a channel.
+struct VerbsMessageHeader {
+  uint32_t type;
+  uint32_t method;
+  uint64_t request_id;
+  uint32_t status;
+  uint32_t meta_size;
+  uint64_t payload_size;
+  uint32_t transfer_id;
+  uint32_t rkey;
+  uint64_t remote_addr;
+};
+
+// The addresses of a queue pair exchanged when the channel is set up.
+struct VerbsQPInfo {
+  uint32_t qpn;
+  uint32_t psn;
+  uint16_t lid;
+  uint8_t gid[16];
+};
+
+static bool WriteFull(int fd, const void* data, size_t size) {
+  const char* p = static_cast<const char*>(data);
+  while (size > 0) {
+    ssize_t n = write(fd, p, size);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    p += n;
+    size -= n;
+  }
+  return true;
+}
+
+static bool ReadFull(int fd, void* data, size_t size) {
+  char* p = static_cast<char*>(data);
+  while (size > 0) {
+    ssize_t n = read(fd, p, size);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    p += n;
+    size -= n;
+  }
+  return true;
+}
+
+static size_t RecvBufferSize() {
+  return sizeof(VerbsMessageHeader) + FLAGS_rpc_verbs_inline_bytes;
+}
+
+VerbsDevice& VerbsDevice::Instance() {
+  // Never destroyed, the messages may be released after the exit handlers.
+  static VerbsDevice* device = new VerbsDevice();
+  return *device;
+}
+
+VerbsDevice::VerbsDevice() {
+  int num = 0;
+  ibv_device** devices = ibv_get_device_list(&num);
+  if (devices == nullptr || num == 0) {
+    if (devices != nullptr) ibv_free_device_list(devices);
+    PADDLE_THROW("no ibverbs device found");
+  }
+  ibv_device* device = nullptr;
+  for (int i = 0; i < num; ++i) {
+    if (FLAGS_rpc_verbs_device.empty() ||
+        FLAGS_rpc_verbs_device == ibv_get_device_name(devices[i])) {
+      device = devices[i];
+      break;
+    }
+  }
+  if (device == nullptr) {
+    ibv_free_device_list(devices);
+    PADDLE_THROW("ibverbs device %s not found", FLAGS_rpc_verbs_device);
+  }
+  VLOG(1) << "verbs rpc uses device " << ibv_get_device_name(device);
+  context_ = ibv_open_device(device);
+  ibv_free_device_list(devices);
+  PADDLE_ENFORCE_NOT_NULL(context_, "failed to open the ibverbs device");
+
+  pd_ = ibv_alloc_pd(context_);
+  PADDLE_ENFORCE_NOT_NULL(pd_, "failed to allocate the protection domain");
+
+  port_ = static_cast<uint8_t>(FLAGS_rpc_verbs_port);
+  PADDLE_ENFORCE_EQ(ibv_query_port(context_, port_, &port_attr_), 0,
+                    "failed to query the port %d", FLAGS_rpc_verbs_port);
+  PADDLE_ENFORCE_EQ(port_attr_.state, IBV_PORT_ACTIVE,
+                    "the port %d of the ibverbs device is not active",
+                    FLAGS_rpc_verbs_port);
+
+  gid_index_ = FLAGS_rpc_verbs_gid_index;
+  memset(&gid_, 0, sizeof(gid_));
+  if (gid_index_ >= 0) {
+    PADDLE_ENFORCE_EQ(ibv_query_gid(context_, port_, gid_index_, &gid_), 0,
+                      "failed to query the gid %d", gid_index_);
+  }
+
+  pool_.reset(new VerbsMemPool(pd_));
+}
+
+std::shared_ptr<VerbsChannel> VerbsChannel::Connect(const std::string& ep,
+                                                    Handler handler) {
+  auto pos = ep.rfind(':');
+  PADDLE_ENFORCE(pos != std::string::npos, "invalid endpoint %s", ep);
+  std::string host = ep.substr(0, pos);
+  std::string port = ep.substr(pos + 1);
+
+  addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* addr = nullptr;
+  PADDLE_ENFORCE_EQ(getaddrinfo(host.c_str(), port.c_str(), &hints, &addr), 0,
+                    "failed to resolve %s", ep);
+
+  // The pserver may not be listening yet, retry until the rpc deadline.
+  auto deadline = std::chrono::steady_clock::now() +
+                  std::chrono::milliseconds(FLAGS_rpc_deadline);
+  int fd = -1;
+  while (true) {
+    fd = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+    PADDLE_ENFORCE_GE(fd, 0, "failed to create the socket");
+    if (connect(fd, addr->ai_addr, addr->ai_addrlen) == 0) break;
+    close(fd);
+    fd = -1;
+    if (std::chrono::steady_clock::now() > deadline) break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  }
+  freeaddrinfo(addr);
+  PADDLE_ENFORCE_GE(fd, 0, "failed to connect to %s", ep);
+
+  std::shared_ptr<VerbsChannel> channel(new VerbsChannel(handler));
+  channel->Setup(fd);
+  VLOG(3) << "verbs channel connected to " << ep;
+  return channel;
+}
+
+std::shared_ptr<VerbsChannel> VerbsChannel::Accept(int fd, Handler handler) {
+  std::shared_ptr<VerbsChannel> channel(new VerbsChannel(handler));
+  channel->Setup(fd);
+  return channel;
+}
+
+void VerbsChannel::Setup(int fd) {
+  int depth = FLAGS_rpc_verbs_queue_depth;
+  comp_channel_ = ibv_create_comp_channel(device_.context());
+  PADDLE_ENFORCE_NOT_NULL(comp_channel_,
+                          "failed to create the completion channel");
+  cq_ = ibv_create_cq(device_.context(), depth * 2, nullptr, comp_channel_, 0);
+  PADDLE_ENFORCE_NOT_NULL(cq_, "failed to create the completion queue");
+
+  ibv_qp_init_attr init_attr;
+  memset(&init_attr, 0, sizeof(init_attr));
+  init_attr.send_cq = cq_;
+  init_attr.recv_cq = cq_;
+  init_attr.qp_type = IBV_QPT_RC;
+  init_attr.cap.max_send_wr = depth;
+  init_attr.cap.max_recv_wr = depth;
+  init_attr.cap.max_send_sge = 1;
+  init_attr.cap.max_recv_sge = 1;
+  qp_ = ibv_create_qp(device_.pd(), &init_attr);
+  PADDLE_ENFORCE_NOT_NULL(qp_, "failed to create the queue pair");
+  send_credits_ = depth;
+
+  ibv_qp_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.qp_state = IBV_QPS_INIT;
+  attr.pkey_index = 0;
+  attr.port_num = device_.port();
+  attr.qp_access_flags = IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_WRITE;
+  PADDLE_ENFORCE_EQ(ibv_modify_qp(qp_, &attr, IBV_QP_STATE | IBV_QP_PKEY_INDEX |
+                                                  IBV_QP_PORT |
+                                                  IBV_QP_ACCESS_FLAGS),
+                    0, "failed to move the queue pair to INIT");
+
+  // The receive buffers are posted before the peer is told the queue pair.
+  for (int i = 0; i < depth; ++i) {
+    PostRecv(device_.pool()->Alloc(RecvBufferSize()));
+  }
+
+  VerbsQPInfo local, remote;
+  memset(&local, 0, sizeof(local));
+  local.qpn = qp_->qp_num;
+  local.psn = lrand48() & 0xffffff;
+  local.lid = device_.port_attr().lid;
+  memcpy(local.gid, device_.gid().raw, sizeof(local.gid));
+  PADDLE_ENFORCE(WriteFull(fd, &local, sizeof(local)) &&
+                     ReadFull(fd, &remote, sizeof(remote)),
+                 "failed to exchange the queue pairs");
+
+  memset(&attr, 0, sizeof(attr));
+  attr.qp_state = IBV_QPS_RTR;
+  attr.path_mtu = device_.port_attr().active_mtu;
+  attr.dest_qp_num = remote.qpn;
+  attr.rq_psn = remote.psn;
+  attr.max_dest_rd_atomic = 1;
+  attr.min_rnr_timer = 12;
+  attr.ah_attr.dlid = remote.lid;
+  attr.ah_attr.sl = 0;
+  attr.ah_attr.src_path_bits = 0;
+  attr.ah_attr.port_num = device_.port();
+  if (device_.gid_index() >= 0) {
+    attr.ah_attr.is_global = 1;
+    memcpy(attr.ah_attr.grh.dgid.raw, remote.gid, sizeof(remote.gid));
+    attr.ah_attr.grh.sgid_index = device_.gid_index();
+    attr.ah_attr.grh.hop_limit = 1;
+  }
+  PADDLE_ENFORCE_EQ(
+      ibv_modify_qp(qp_, &attr, IBV_QP_STATE | IBV_QP_AV | IBV_QP_PATH_MTU |
+                                    IBV_QP_DEST_QPN | IBV_QP_RQ_PSN |
+                                    IBV_QP_MAX_DEST_RD_ATOMIC |
+                                    IBV_QP_MIN_RNR_TIMER),
+      0, "failed to move the queue pair to RTR");
+
+  memset(&attr, 0, sizeof(attr));
+  attr.qp_state = IBV_QPS_RTS;
+  attr.timeout = 14;
+  attr.retry_cnt = 7;
+  // Retry forever when the peer has no receive buffer posted, so that the
+  // receive queue of the peer is the flow control of the sends.
+  attr.rnr_retry = 7;
+  attr.sq_psn = local.psn;
+  attr.max_rd_atomic = 1;
+  PADDLE_ENFORCE_EQ(
+      ibv_modify_qp(qp_, &attr, IBV_QP_STATE | IBV_QP_TIMEOUT |
+                                    IBV_QP_RETRY_CNT | IBV_QP_RNR_RETRY |
+                                    IBV_QP_SQ_PSN | IBV_QP_MAX_QP_RD_ATOMIC),
+      0, "failed to move the queue pair to RTS");
+
+  // Nothing is sent before both of the queue pairs are ready.
+  char sync = 0;
+  PADDLE_ENFORCE(WriteFull(fd, &sync, 1) && ReadFull(fd, &sync, 1),
+                 "failed to synchronize with the peer");
+  close(fd);
+
+  PADDLE_ENFORCE_EQ(ibv_req_notify_cq(cq_, 0), 0);
+  poll_thread_.reset(new std::thread([this] { PollLoop(); }));
+}
+
+VerbsChannel::~VerbsChannel() {
+  Close();
+  if (qp_) ibv_destroy_qp(qp_);
+  if (cq_) ibv_destroy_cq(cq_);
+  if (comp_channel_) ibv_destroy_comp_channel(comp_channel_);
+  // The buffers still posted to the destroyed queue pair are released with
+  // the pool.
+  auto* pool = device_.pool();
+  for (auto& kv : pending_writes_) pool->Free(kv.second.buffer);
+  for (auto& kv : pending_recvs_) pool->Free(kv.second.buffer);
+}
+
+void VerbsChannel::Close() {
+  if (closed_.exchange(true)) return;
+  if (poll_thread_ && poll_thread_->joinable()) poll_thread_->join();
+  send_cond_.notify_all();
+}
+
+void VerbsChannel::Break() {
+  {
+    std::lock_guard<std::mutex> guard(send_mutex_);
+    if (broken_.exchange(true)) return;
+  }
+  send_cond_.notify_all();
+  if (!closed_) handler_(this, nullptr);
+}
+
+void VerbsChannel::PostRecv(VerbsBuffer* buffer) {
+  ibv_sge sge;
+  sge.addr = reinterpret_cast<uint64_t>(buffer->addr);
+  sge.length = static_cast<uint32_t>(buffer->size);
+  sge.lkey = buffer->mr->lkey;
+
+  ibv_recv_wr wr;
+  memset(&wr, 0, sizeof(wr));
+  wr.wr_id = reinterpret_cast<uint64_t>(buffer);
+  wr.sg_list = &sge;
+  wr.num_sge = 1;
+  ibv_recv_wr* bad_wr = nullptr;
+  PADDLE_ENFORCE_EQ(ibv_post_recv(qp_, &wr, &bad_wr), 0,
+                    "failed to post the receive buffer");
+}
+
+void VerbsChannel::PostSend(ibv_send_wr* wr, VerbsBuffer* buffer) {
+  {
+    std::unique_lock<std::mutex> lock(send_mutex_);
+    send_cond_.wait(lock, [this] {
+      return send_credits_ > 0 || broken_.load() || closed_.load();
+    });
+    if (broken_ || closed_) {
+      lock.unlock();
+      device_.pool()->Free(buffer);
+      PADDLE_THROW("the verbs channel is closed");
+    }
+    --send_credits_;
+  }
+
+  wr->wr_id = reinterpret_cast<uint64_t>(buffer);
+  wr->send_flags = IBV_SEND_SIGNALED;
+  ibv_send_wr* bad_wr = nullptr;
+  if (ibv_post_send(qp_, wr, &bad_wr) != 0) {
+    {
+      std::lock_guard<std::mutex> guard(send_mutex_);
+      ++send_credits_;
+    }
+    device_.pool()->Free(buffer);
+    PADDLE_THROW("failed to post the verbs send");
+  }
+}
+
+void VerbsChannel::SendBuffer(VerbsBuffer* buffer, size_t size) {
+  ibv_sge sge;
+  sge.addr = reinterpret_cast<uint64_t>(buffer->addr);
+  sge.length = static_cast<uint32_t>(size);
+  sge.lkey = buffer->mr->lkey;
+
+  ibv_send_wr wr;
+  memset(&wr, 0, sizeof(wr));
+  wr.sg_list = &sge;
+  wr.num_sge = 1;
+  wr.opcode = IBV_WR_SEND;
+  PostSend(&wr, buffer);
+}
+
+void VerbsChannel::SendControl(const VerbsMessageHeader& header,
+                               const std::string& meta) {
+  size_t size = sizeof(VerbsMessageHeader) + meta.size();
+  auto* buffer = device_.pool()->Alloc(size);
+  char* p = static_cast<char*>(buffer->addr);
+  memcpy(p, &header, sizeof(VerbsMessageHeader));
+  memcpy(p + sizeof(VerbsMessageHeader), meta.data(), meta.size());
+  SendBuffer(buffer, size);
+}
+
+void VerbsChannel::Send(uint32_t method, uint64_t request_id, uint32_t status,
+                        const std::string& meta,
+                        const std::vector<VerbsSegment>& payload) {
+  size_t payload_size = 0;
+  for (auto& segment : payload) payload_size += segment.size;
+
+  VerbsMessageHeader header;
+  memset(&header, 0, sizeof(header));
+  header.method = method;
+  header.request_id = request_id;
+  header.status = status;
+  header.meta_size = static_cast<uint32_t>(meta.size());
+  header.payload_size = payload_size;
+
+  size_t inline_limit = static_cast<size_t>(FLAGS_rpc_verbs_inline_bytes);
+  if (meta.size() + payload_size <= inline_limit) {
+    header.type = kVerbsData;
+    size_t size = sizeof(VerbsMessageHeader) + meta.size() + payload_size;
+    auto* buffer = device_.pool()->Alloc(size);
+    char* p = static_cast<char*>(buffer->addr);
+    memcpy(p, &header, sizeof(VerbsMessageHeader));
+    p += sizeof(VerbsMessageHeader);
+    memcpy(p, meta.data(), meta.size());
+    p += meta.size();
+    for (auto& segment : payload) {
+      memcpy(p, segment.data, segment.size);
+      p += segment.size;
+    }
+    SendBuffer(buffer, size);
+    return;
+  }
+
+  PADDLE_ENFORCE_LE(meta.size(), inline_limit,
+                    "the meta of a verbs message is too long");
+  auto* buffer = device_.pool()->Alloc(payload_size);
+  char* p = static_cast<char*>(buffer->addr);
+  for (auto& segment : payload) {
+    memcpy(p, segment.data, segment.size);
+    p += segment.size;
+  }
+  header.type = kVerbsRts;
+  header.transfer_id = next_transfer_id_++;
+  {
+    std::lock_guard<std::mutex> guard(transfer_mutex_);
+    pending_writes_[header.transfer_id] = PendingWrite{buffer, payload_size};
+  }
+  SendControl(header, meta);
+}
+
+void VerbsChannel::WritePayload(uint32_t transfer_id, uint64_t remote_addr,
+                                uint32_t rkey) {
+  PendingWrite pending;
+  {
+    std::lock_guard<std::mutex> guard(transfer_mutex_);
+    auto it = pending_writes_.find(transfer_id);
+    PADDLE_ENFORCE(it != pending_writes_.end(),
+                   "unknown verbs transfer %d", transfer_id);
+    pending = it->second;
+    pending_writes_.erase(it);
+  }
+
+  ibv_sge sge;
+  sge.addr = reinterpret_cast<uint64_t>(pending.buffer->addr);
+  sge.length = static_cast<uint32_t>(pending.size);
+  sge.lkey = pending.buffer->mr->lkey;
+
+  ibv_send_wr wr;
+  memset(&wr, 0, sizeof(wr));
+  wr.sg_list = &sge;
+  wr.num_sge = 1;
+  wr.opcode = IBV_WR_RDMA_WRITE_WITH_IMM;
+  wr.imm_data = htonl(transfer_id);
+  wr.wr.rdma.remote_addr = remote_addr;
+  wr.wr.rdma.rkey = rkey;
+  PostSend(&wr, pending.buffer);
+}
+
+void VerbsChannel::HandleRecv(VerbsBuffer* buffer, size_t size) {
+  auto* pool = device_.pool();
+  VerbsMessageHeader header;
+  PADDLE_ENFORCE_GE(size, sizeof(header), "truncated verbs message");
+  memcpy(&header, buffer->addr, sizeof(header));
+  const char* meta = static_cast<const char*>(buffer->addr) + sizeof(header);
+
+  switch (header.type) {
+    case kVerbsData: {
+      VerbsMessagePtr msg(new VerbsMessage());
+      msg->method = header.method;
+      msg->request_id = header.request_id;
+      msg->status = header.status;
+      msg->meta.assign(meta, header.meta_size);
+      msg->payload = meta + header.meta_size;
+      msg->payload_size = header.payload_size;
+      // The message owns the receive buffer, and a new one takes its place.
+      msg->buffer = buffer;
+      PostRecv(pool->Alloc(RecvBufferSize()));
+      handler_(this, msg);
+      break;
+    }
+    case kVerbsRts: {
+      PendingRecv pending;
+      pending.method = header.method;
+      pending.request_id = header.request_id;
+      pending.status = header.status;
+      pending.meta.assign(meta, header.meta_size);
+      pending.size = header.payload_size;
+      pending.buffer = pool->Alloc(header.payload_size);
+      PostRecv(buffer);
+
+      VerbsMessageHeader cts;
+      memset(&cts, 0, sizeof(cts));
+      cts.type = kVerbsCts;
+      cts.transfer_id = header.transfer_id;
+      cts.remote_addr = reinterpret_cast<uint64_t>(pending.buffer->addr);
+      cts.rkey = pending.buffer->mr->rkey;
+      {
+        std::lock_guard<std::mutex> guard(transfer_mutex_);
+        pending_recvs_[header.transfer_id] = std::move(pending);
+      }
+      // The polling thread must not wait for the send queue, which is
+      // freed by the completions it polls.
+      auto self = shared_from_this();
+      framework::AsyncIO([self, cts] { self->SendControl(cts, ""); });
+      break;
+    }
+    case kVerbsCts: {
+      PostRecv(buffer);
+      auto self = shared_from_this();
+      framework::AsyncIO([self, header] {
+        self->WritePayload(header.transfer_id, header.remote_addr,
+                           header.rkey);
+      });
+      break;
+    }
+    default:
+      PADDLE_THROW("unknown verbs message type %d", header.type);
+  }
+}
+
+void VerbsChannel::HandleWriteWithImm(VerbsBuffer* recv_buffer,
+                                      uint32_t transfer_id) {
+  PostRecv(recv_buffer);
+  PendingRecv pending;
+  {
+    std::lock_guard<std::mutex> guard(transfer_mutex_);
+    auto it = pending_recvs_.find(transfer_id);
+    PADDLE_ENFORCE(it != pending_recvs_.end(),
+                   "unknown verbs transfer %d", transfer_id);
+    pending = std::move(it->second);
+    pending_recvs_.erase(it);
+  }
+
+  VerbsMessagePtr msg(new VerbsMessage());
+  msg->method = pending.method;
+  msg->request_id = pending.request_id;
+  msg->status = pending.status;
+  msg->meta = std::move(pending.meta);
+  msg->payload = static_cast<const char*>(pending.buffer->addr);
+  msg->payload_size = pending.size;
+  msg->buffer = pending.buffer;
+  handler_(this, msg);
+}
+
+void VerbsChannel::HandleCompletion(const ibv_wc& wc) {
+  auto* buffer = reinterpret_cast<VerbsBuffer*>(wc.wr_id);
+  if (wc.status != IBV_WC_SUCCESS) {
+    // The opcode of a failed completion is undefined, but every work request
+    // carries a buffer of the pool.
+    if (!closed_) {
+      LOG(ERROR) << "verbs work request failed: "
+                 << ibv_wc_status_str(wc.status);
+    }
+    device_.pool()->Free(buffer);
+    Break();
+    return;
+  }
+
+  switch (wc.opcode) {
+    case IBV_WC_SEND:
+    case IBV_WC_RDMA_WRITE: {
+      device_.pool()->Free(buffer);
+      {
+        std::lock_guard<std::mutex> guard(send_mutex_);
+        ++send_credits_;
+      }
+      send_cond_.notify_one();
+      break;
+    }
+    case IBV_WC_RECV:
+      HandleRecv(buffer, wc.byte_len);
+      break;
+    case IBV_WC_RECV_RDMA_WITH_IMM:
+      HandleWriteWithImm(buffer, ntohl(wc.imm_data));
+      break;
+    default:
+      LOG(ERROR) << "unexpected verbs completion " << wc.opcode;
+      break;
+  }
+}
+
+void VerbsChannel::PollLoop() {
+  int flags = fcntl(comp_channel_->fd, F_GETFL);
+  fcntl(comp_channel_->fd, F_SETFL, flags | O_NONBLOCK);
+  pollfd pfd;
+  pfd.fd = comp_channel_->fd;
+  pfd.events = POLLIN;
+
+  constexpr int kBatch = 16;
+  ibv_wc wcs[kBatch];
+  while (!closed_) {
+    int n = ibv_poll_cq(cq_, kBatch, wcs);
+    if (n < 0) {
+      LOG(ERROR) << "failed to poll the verbs completion queue";
+      Break();
+      return;
+    }
+    try {
+      for (int i = 0; i < n; ++i) HandleCompletion(wcs[i]);
+    } catch (std::exception& e) {
+      LOG(ERROR) << "verbs channel failed: " << e.what();
+      Break();
+      return;
+    }
+    if (n > 0) continue;
+
+    // Wait for the next completion event, the timeout checks closed_.
+    pfd.revents = 0;
+    if (poll(&pfd, 1, 100) <= 0) continue;
+    ibv_cq* ev_cq = nullptr;
+    void* ev_ctx = nullptr;
+    if (ibv_get_cq_event(comp_channel_, &ev_cq, &ev_ctx) == 0) {
+      ibv_ack_cq_events(ev_cq, 1);
+      // Rearm before polling, the completions after it raise an event.
+      ibv_req_notify_cq(ev_cq, 0);
+    }
+  }
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
+
+#endif
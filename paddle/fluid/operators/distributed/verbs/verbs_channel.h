@@ -0,0 +1,197 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#ifdef PADDLE_WITH_VERBS
+
+#include <infiniband/verbs.h>
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "paddle/fluid/operators/distributed/verbs/verbs_mem_pool.h"
+#include "paddle/fluid/platform/macros.h"
+
+DECLARE_int32(rpc_verbs_inline_bytes);
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+/*
+ * VerbsDevice is the ibverbs device, the protection domain and the pool of
+ * the registered buffers shared by all the channels of the process.
+ */
+class VerbsDevice {
+ public:
+  static VerbsDevice& Instance();
+
+  ibv_context* context() const { return context_; }
+  ibv_pd* pd() const { return pd_; }
+  uint8_t port() const { return port_; }
+  const ibv_port_attr& port_attr() const { return port_attr_; }
+  int gid_index() const { return gid_index_; }
+  const ibv_gid& gid() const { return gid_; }
+  VerbsMemPool* pool() { return pool_.get(); }
+
+ private:
+  VerbsDevice();
+
+  ibv_context* context_{nullptr};
+  ibv_pd* pd_{nullptr};
+  uint8_t port_;
+  ibv_port_attr port_attr_;
+  int gid_index_;
+  ibv_gid gid_;
+  std::unique_ptr<VerbsMemPool> pool_;
+
+  DISABLE_COPY_AND_ASSIGN(VerbsDevice);
+};
+
+// A piece of the payload of a message, copied to a registered buffer when
+// the message is sent.
+struct VerbsSegment {
+  const void* data;
+  size_t size;
+};
+
+// A message received by a channel. The payload lives in a registered buffer
+// which goes back to the pool with the message.
+struct VerbsMessage {
+  uint32_t method;
+  uint64_t request_id;
+  uint32_t status;
+  std::string meta;
+  const char* payload{nullptr};
+  size_t payload_size{0};
+
+  VerbsBuffer* buffer{nullptr};
+
+  ~VerbsMessage() {
+    if (buffer) VerbsDevice::Instance().pool()->Free(buffer);
+  }
+};
+
+typedef std::shared_ptr<VerbsMessage> VerbsMessagePtr;
+
+struct VerbsMessageHeader;
+
+/*
+ * VerbsChannel is a reliable connected queue pair to a peer, brought up by
+ * exchanging the addresses of the queue pairs over a TCP connection.
+ *
+ * A message no longer than FLAGS_rpc_verbs_inline_bytes is sent by a verbs
+ * send into a receive buffer posted by the peer. A longer one is sent by a
+ * rendezvous: the sender sends the header and the meta, the receiver
+ * allocates a registered buffer for the payload and sends back its address,
+ * and the sender writes the payload into it by a one-sided RDMA write with
+ * immediate data, which completes the message on the receiver.
+ *
+ * The completions are polled by a thread of the channel, which hands the
+ * messages to the handler. The handler runs on the polling thread, so it
+ * should pass anything slow to a thread pool.
+ */
+class VerbsChannel : public std::enable_shared_from_this<VerbsChannel> {
+ public:
+  // The handler is called with the messages received by the channel, and
+  // with nullptr once if the channel breaks.
+  typedef std::function<void(VerbsChannel* channel, VerbsMessagePtr msg)>
+      Handler;
+
+  // Connect to the listening endpoint "ip:port" of a VerbsServer.
+  static std::shared_ptr<VerbsChannel> Connect(const std::string& ep,
+                                               Handler handler);
+  // Set up the channel over a socket accepted by a VerbsServer.
+  static std::shared_ptr<VerbsChannel> Accept(int fd, Handler handler);
+
+  ~VerbsChannel();
+
+  // Send a message, which blocks while the send queue is full, but not for
+  // the peer to receive the message.
+  void Send(uint32_t method, uint64_t request_id, uint32_t status,
+            const std::string& meta, const std::vector<VerbsSegment>& payload);
+
+  void Close();
+
+  bool IsBroken() const { return broken_.load(); }
+
+ private:
+  struct PendingWrite {
+    VerbsBuffer* buffer;
+    size_t size;
+  };
+  struct PendingRecv {
+    uint32_t method;
+    uint64_t request_id;
+    uint32_t status;
+    std::string meta;
+    VerbsBuffer* buffer;
+    size_t size;
+  };
+
+  explicit VerbsChannel(Handler handler) : handler_(handler) {}
+
+  void Setup(int fd);
+  void PollLoop();
+  void HandleCompletion(const ibv_wc& wc);
+  void HandleRecv(VerbsBuffer* buffer, size_t size);
+  void HandleWriteWithImm(VerbsBuffer* recv_buffer, uint32_t transfer_id);
+
+  void PostRecv(VerbsBuffer* buffer);
+  // Post a signaled work request, buffer is released when it completes.
+  void PostSend(ibv_send_wr* wr, VerbsBuffer* buffer);
+  // Send the first size bytes of buffer.
+  void SendBuffer(VerbsBuffer* buffer, size_t size);
+  void SendControl(const VerbsMessageHeader& header, const std::string& meta);
+  void WritePayload(uint32_t transfer_id, uint64_t remote_addr,
+                    uint32_t rkey);
+  void Break();
+
+  Handler handler_;
+  VerbsDevice& device_{VerbsDevice::Instance()};
+  ibv_comp_channel* comp_channel_{nullptr};
+  ibv_cq* cq_{nullptr};
+  ibv_qp* qp_{nullptr};
+  std::unique_ptr<std::thread> poll_thread_;
+  std::atomic<bool> closed_{false};
+  std::atomic<bool> broken_{false};
+
+  // The free slots of the send queue.
+  std::mutex send_mutex_;
+  std::condition_variable send_cond_;
+  int send_credits_{0};
+
+  std::mutex transfer_mutex_;
+  std::atomic<uint32_t> next_transfer_id_{0};
+  // The payloads waiting for the addresses of the peer to be written to.
+  std::unordered_map<uint32_t, PendingWrite> pending_writes_;
+  // The messages waiting for the peer to write their payloads.
+  std::unordered_map<uint32_t, PendingRecv> pending_recvs_;
+
+  DISABLE_COPY_AND_ASSIGN(VerbsChannel);
+};
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
+
+#endif
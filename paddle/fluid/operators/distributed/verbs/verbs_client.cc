@@ -0,0 +1,318 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifdef PADDLE_WITH_VERBS
+
+#include "paddle/fluid/operators/distributed/verbs/verbs_client.h"
+
+#include <vector>
+
+#include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/platform/profiler.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// Deserialize the variable in the reply into the scope of the request.
+static void DeserializeReply(const VarHandlePtr& var_h,
+                             const VerbsMessage& reply) {
+  VarMsg meta;
+  PADDLE_ENFORCE(meta.ParseFromString(reply.meta),
+                 "parse verbs reply meta error!");
+  VerbsVariableResponse resp(var_h->scope(), var_h->ctx());
+  PADDLE_ENFORCE(resp.Parse(reply, meta) == 0,
+                 "parse verbs reply to tensor error!");
+}
+
+VerbsClient::~VerbsClient() {
+  Wait();
+  std::lock_guard<std::mutex> guard(chan_mutex_);
+  channels_.clear();
+}
+
+std::shared_ptr<VerbsChannel> VerbsClient::GetChannel(const std::string& ep) {
+  std::lock_guard<std::mutex> guard(chan_mutex_);
+  auto it = channels_.find(ep);
+  if (it != channels_.end()) {
+    return it->second;
+  }
+
+  VLOG(1) << "create verbs channel to pserver:" << ep;
+  auto channel = VerbsChannel::Connect(
+      ep, [this, ep](VerbsChannel* channel, VerbsMessagePtr reply) {
+        HandleReply(ep, reply);
+      });
+  channels_[ep] = channel;
+  return channel;
+}
+
+void VerbsClient::FinishRequest(const VarHandlePtr& var_h, bool ok) {
+  var_h->Finish(ok);
+  DecreaseReqCount();
+}
+
+void VerbsClient::HandleReply(const std::string& ep, VerbsMessagePtr reply) {
+  if (reply == nullptr) {
+    LOG(ERROR) << "verbs channel to pserver " << ep << " is broken";
+    std::vector<VarHandlePtr> failed;
+    {
+      std::lock_guard<std::mutex> guard(pending_mutex_);
+      for (auto it = pending_.begin(); it != pending_.end();) {
+        if (it->second.var_h->ep() == ep) {
+          failed.push_back(it->second.var_h);
+          it = pending_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
+    for (auto& var_h : failed) FinishRequest(var_h, false);
+    return;
+  }
+
+  PendingRequest pending;
+  {
+    std::lock_guard<std::mutex> guard(pending_mutex_);
+    auto it = pending_.find(reply->request_id);
+    if (it == pending_.end()) {
+      LOG(WARNING) << "verbs reply of unknown request " << reply->request_id
+                   << " from " << ep;
+      return;
+    }
+    pending = it->second;
+    pending_.erase(it);
+  }
+
+  // The reply is deserialized on an io thread, not the polling thread of
+  // the channel.
+  framework::AsyncIO([this, pending, reply] {
+    bool ok = reply->status == 0;
+    if (!ok) {
+      LOG(ERROR) << "verbs rpc failed on the pserver: "
+                 << pending.var_h->String();
+    } else if (pending.on_reply) {
+      try {
+        pending.on_reply(*reply);
+      } catch (std::exception& e) {
+        LOG(ERROR) << "failed to handle the verbs reply of "
+                   << pending.var_h->String() << ": " << e.what();
+        ok = false;
+      }
+    }
+    VLOG(4) << "Finish " << pending.var_h->String();
+    FinishRequest(pending.var_h, ok);
+  });
+}
+
+VarHandlePtr VerbsClient::AsyncCall(
+    const std::string& ep, uint32_t method, VarHandlePtr var_h,
+    std::function<void(VarMsg* request, VerbsPayload* payload)> build,
+    ReplyHandler on_reply) {
+  req_count_++;
+  framework::AsyncIO([=] {
+    uint64_t request_id = next_request_id_++;
+    {
+      std::lock_guard<std::mutex> guard(pending_mutex_);
+      pending_[request_id] = PendingRequest{var_h, on_reply};
+    }
+
+    try {
+      auto channel = GetChannel(ep);
+      VarMsg request;
+      VerbsPayload payload;
+      build(&request, &payload);
+
+      platform::RecordRPCEvent record_event(var_h->method(), var_h->ctx());
+      channel->Send(method, request_id, 0, request.SerializeAsString(),
+                    payload.segments());
+    } catch (std::exception& e) {
+      LOG(ERROR) << "failed to send verbs request " << var_h->String() << ": "
+                 << e.what();
+      bool failed = false;
+      {
+        std::lock_guard<std::mutex> guard(pending_mutex_);
+        failed = pending_.erase(request_id) > 0;
+      }
+      if (failed) FinishRequest(var_h, false);
+    }
+
+    if (UNLIKELY(platform::IsProfileEnabled())) {
+      var_h->Wait();
+    }
+  });
+  return var_h;
+}
+
+VarHandlePtr VerbsClient::AsyncSendVar(const std::string& ep,
+                                       const platform::DeviceContext& ctx,
+                                       const framework::Scope& scope,
+                                       const std::string& var_name,
+                                       int64_t time_out) {
+  const platform::DeviceContext* p_ctx = &ctx;
+  const framework::Scope* p_scope = &scope;
+  const std::string var_name_val = var_name;
+  VarHandlePtr var_h(
+      new VarHandle(ep, "SendRPC", var_name_val, p_ctx, p_scope));
+
+  return AsyncCall(ep, kVerbsSendVariable, var_h,
+                   [=](VarMsg* request, VerbsPayload* payload) {
+                     auto* var = p_scope->FindVar(var_name_val);
+                     SerializeToVerbsPayload(var_name_val, var, *p_ctx,
+                                             request, payload, "",
+                                             trainer_id_);
+                   },
+                   nullptr);
+}
+
+VarHandlePtr VerbsClient::AsyncGetVarImpl(const std::string& ep,
+                                          const platform::DeviceContext& ctx,
+                                          const framework::Scope& scope,
+                                          const std::string& var_name,
+                                          uint32_t method,
+                                          const std::string& method_name) {
+  const std::string var_name_val = var_name;
+  VarHandlePtr var_h(
+      new VarHandle(ep, method_name, var_name_val, &ctx, &scope));
+
+  return AsyncCall(ep, method, var_h,
+                   [=](VarMsg* request, VerbsPayload* payload) {
+                     request->set_varname(var_name_val);
+                     request->set_trainer_id(trainer_id_);
+                   },
+                   [var_h](const VerbsMessage& reply) {
+                     DeserializeReply(var_h, reply);
+                   });
+}
+
+VarHandlePtr VerbsClient::AsyncGetVar(const std::string& ep,
+                                      const platform::DeviceContext& ctx,
+                                      const framework::Scope& scope,
+                                      const std::string& var_name,
+                                      int64_t time_out) {
+  return AsyncGetVarImpl(ep, ctx, scope, var_name, kVerbsGetVariable,
+                         "GetRPC");
+}
+
+VarHandlePtr VerbsClient::AsyncGetMonomerVariable(
+    const std::string& ep, const platform::DeviceContext& ctx,
+    const framework::Scope& scope, const std::string& var_name,
+    int64_t time_out) {
+  return AsyncGetVarImpl(ep, ctx, scope, var_name, kVerbsGetMonomerVariable,
+                         "GetMonomerVariable");
+}
+
+VarHandlePtr VerbsClient::AsyncPrefetchVar(const std::string& ep,
+                                           const platform::DeviceContext& ctx,
+                                           const framework::Scope& scope,
+                                           const std::string& in_var_name,
+                                           const std::string& out_var_name,
+                                           const std::string& table_name,
+                                           int64_t time_out) {
+  const platform::DeviceContext* p_ctx = &ctx;
+  const framework::Scope* p_scope = &scope;
+  const std::string in_var_name_val = in_var_name;
+  const std::string out_var_name_val = out_var_name;
+  const std::string table_name_val = table_name;
+  VarHandlePtr var_h(
+      new VarHandle(ep, "PrefetchRPC", out_var_name_val, p_ctx, p_scope));
+
+  return AsyncCall(ep, kVerbsPrefetchVariable, var_h,
+                   [=](VarMsg* request, VerbsPayload* payload) {
+                     auto* var = p_scope->FindVar(in_var_name_val);
+                     SerializeToVerbsPayload(in_var_name_val, var, *p_ctx,
+                                             request, payload,
+                                             out_var_name_val, trainer_id_,
+                                             table_name_val);
+                   },
+                   [var_h](const VerbsMessage& reply) {
+                     DeserializeReply(var_h, reply);
+                   });
+}
+
+VarHandlePtr VerbsClient::AsyncSendMessage(const std::string& ep,
+                                           uint32_t method,
+                                           const std::string& method_name,
+                                           const std::string& message,
+                                           const std::string& out_varname) {
+  VarHandlePtr var_h(new VarHandle(ep, method_name, message));
+  return AsyncCall(ep, method, var_h,
+                   [=](VarMsg* request, VerbsPayload* payload) {
+                     request->set_varname(message);
+                     request->set_trainer_id(trainer_id_);
+                     if (!out_varname.empty()) {
+                       request->set_out_varname(out_varname);
+                     }
+                   },
+                   nullptr);
+}
+
+VarHandlePtr VerbsClient::AsyncSendBatchBarrier(const std::string& ep,
+                                                int64_t time_out) {
+  return AsyncSendMessage(ep, kVerbsSendVariable, "BatchBarrierRPC",
+                          BATCH_BARRIER_MESSAGE);
+}
+
+VarHandlePtr VerbsClient::AsyncSendFetchBarrier(const std::string& ep,
+                                                int64_t time_out) {
+  return AsyncSendMessage(ep, kVerbsGetVariable, "FetchBarrierRPC",
+                          FETCH_BARRIER_MESSAGE);
+}
+
+VarHandlePtr VerbsClient::AsyncGetMonomerBarrier(const std::string& ep,
+                                                 const std::string& var_name,
+                                                 int64_t time_out) {
+  return AsyncSendMessage(ep, kVerbsGetMonomerBarrier, "GetMonomerBarrier",
+                          var_name);
+}
+
+VarHandlePtr VerbsClient::AsyncCheckpointNotify(const std::string& ep,
+                                                const std::string& dir,
+                                                int64_t time_out) {
+  return AsyncSendMessage(ep, kVerbsCheckpointNotify, "CheckPointNotifyRPC",
+                          CHECKPOINT_SAVE_MESSAGE, dir);
+}
+
+VarHandlePtr VerbsClient::AsyncSendComplete(const std::string& ep,
+                                            int64_t time_out) {
+  return AsyncSendMessage(ep, kVerbsSendVariable, "SendCompleteRPC",
+                          COMPLETE_MESSAGE);
+}
+
+void VerbsClient::SendComplete() {
+  std::vector<std::string> eps;
+  {
+    std::lock_guard<std::mutex> guard(chan_mutex_);
+    for (auto& kv : channels_) eps.push_back(kv.first);
+  }
+  for (auto& ep : eps) {
+    AsyncSendComplete(ep);
+  }
+}
+
+bool VerbsClient::Wait() {
+  VLOG(9) << "begin to verbsclient wait";
+  {
+    std::unique_lock<std::mutex> lk(sync_mutex_);
+    sync_cond_.wait(lk, [this] { return req_count_ == 0; });
+  }
+  VLOG(9) << "end to verbsclient wait";
+  return true;
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
+
+#endif
@@ -0,0 +1,151 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#ifdef PADDLE_WITH_VERBS
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/operators/distributed/distributed_pb.h"
+#include "paddle/fluid/operators/distributed/request_handler.h"
+#include "paddle/fluid/operators/distributed/rpc_client.h"
+#include "paddle/fluid/operators/distributed/verbs/verbs_channel.h"
+#include "paddle/fluid/operators/distributed/verbs/verbs_sendrecvop_utils.h"
+#include "paddle/fluid/platform/macros.h"  // for DISABLE_COPY_AND_ASSIGN
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+/*
+ * VerbsClient sends the requests over one VerbsChannel to every pserver,
+ * and matches the replies to the requests by their ids. The deadlines are
+ * not enforced, a request fails when its channel breaks.
+ */
+class VerbsClient : public RPCClient {
+ public:
+  VerbsClient() {}
+  virtual ~VerbsClient();
+
+  VarHandlePtr AsyncSendVar(const std::string& ep,
+                            const platform::DeviceContext& ctx,
+                            const framework::Scope& scope,
+                            const std::string& var_name,
+                            int64_t time_out = FLAGS_rpc_deadline) override;
+
+  VarHandlePtr AsyncGetVar(const std::string& ep,
+                           const platform::DeviceContext& ctx,
+                           const framework::Scope& scope,
+                           const std::string& var_name,
+                           int64_t time_out = FLAGS_rpc_deadline) override;
+
+  VarHandlePtr AsyncGetMonomerBarrier(
+      const std::string& ep, const std::string& var_name,
+      int64_t time_out = FLAGS_rpc_deadline) override;
+
+  VarHandlePtr AsyncGetMonomerVariable(
+      const std::string& ep, const platform::DeviceContext& ctx,
+      const framework::Scope& scope, const std::string& var_name,
+      int64_t time_out = FLAGS_rpc_deadline) override;
+
+  VarHandlePtr AsyncPrefetchVar(const std::string& ep,
+                                const platform::DeviceContext& ctx,
+                                const framework::Scope& scope,
+                                const std::string& in_var_name,
+                                const std::string& out_var_name,
+                                const std::string& table_name = "",
+                                int64_t time_out = FLAGS_rpc_deadline) override;
+
+  VarHandlePtr AsyncSendBatchBarrier(
+      const std::string& ep, int64_t time_out = FLAGS_rpc_deadline) override;
+
+  VarHandlePtr AsyncSendFetchBarrier(
+      const std::string& ep, int64_t time_out = FLAGS_rpc_deadline) override;
+
+  VarHandlePtr AsyncCheckpointNotify(
+      const std::string& ep, const std::string& dir,
+      int64_t time_out = FLAGS_rpc_deadline) override;
+
+  VarHandlePtr AsyncSendComplete(
+      const std::string& ep, int64_t time_out = FLAGS_rpc_deadline) override;
+
+  bool Wait() override;
+
+  void SendComplete() override;
+
+ private:
+  // Called with the reply of the request, on an io thread.
+  typedef std::function<void(const VerbsMessage& reply)> ReplyHandler;
+
+  struct PendingRequest {
+    VarHandlePtr var_h;
+    ReplyHandler on_reply;
+  };
+
+  // Send the request built by the io thread and handle its reply.
+  VarHandlePtr AsyncCall(
+      const std::string& ep, uint32_t method, VarHandlePtr var_h,
+      std::function<void(VarMsg* request, VerbsPayload* payload)> build,
+      ReplyHandler on_reply);
+
+  VarHandlePtr AsyncGetVarImpl(const std::string& ep,
+                               const platform::DeviceContext& ctx,
+                               const framework::Scope& scope,
+                               const std::string& var_name, uint32_t method,
+                               const std::string& method_name);
+
+  VarHandlePtr AsyncSendMessage(const std::string& ep, uint32_t method,
+                                const std::string& method_name,
+                                const std::string& message,
+                                const std::string& out_varname = "");
+
+  std::shared_ptr<VerbsChannel> GetChannel(const std::string& ep);
+  void HandleReply(const std::string& ep, VerbsMessagePtr reply);
+  void FinishRequest(const VarHandlePtr& var_h, bool ok);
+
+  void DecreaseReqCount() {
+    if (--req_count_ <= 0) {
+      sync_cond_.notify_all();
+    }
+  }
+
+ private:
+  // mutex for GetChannel thread safety
+  std::mutex chan_mutex_;
+  std::unordered_map<std::string, std::shared_ptr<VerbsChannel>> channels_;
+
+  std::mutex pending_mutex_;
+  std::unordered_map<uint64_t, PendingRequest> pending_;
+  std::atomic<uint64_t> next_request_id_{0};
+
+  // mutex for Wait client sync
+  std::mutex sync_mutex_;
+  std::condition_variable sync_cond_;
+  std::atomic<int64_t> req_count_{0};
+
+  DISABLE_COPY_AND_ASSIGN(VerbsClient);
+};
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
+
+#endif
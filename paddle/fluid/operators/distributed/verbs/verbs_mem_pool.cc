@@ -0,0 +1,84 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifdef PADDLE_WITH_VERBS
+
+#include "paddle/fluid/operators/distributed/verbs/verbs_mem_pool.h"
+
+#include <stdlib.h>
+
+#include "glog/logging.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// The smallest buffer is a page, the registration works on pages anyway.
+static constexpr size_t kMinBufferSize = 4096;
+
+VerbsMemPool::~VerbsMemPool() {
+  for (auto* buffer : all_) {
+    ibv_dereg_mr(buffer->mr);
+    free(buffer->addr);
+    delete buffer;
+  }
+}
+
+size_t VerbsMemPool::SizeClass(size_t size) {
+  size_t size_class = kMinBufferSize;
+  while (size_class < size) size_class <<= 1;
+  return size_class;
+}
+
+VerbsBuffer* VerbsMemPool::Alloc(size_t size) {
+  size_t size_class = SizeClass(size);
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto& buffers = free_[size_class];
+    if (!buffers.empty()) {
+      auto* buffer = buffers.back();
+      buffers.pop_back();
+      return buffer;
+    }
+  }
+
+  std::unique_ptr<VerbsBuffer> buffer(new VerbsBuffer());
+  PADDLE_ENFORCE_EQ(posix_memalign(&buffer->addr, kMinBufferSize, size_class),
+                    0, "failed to allocate %d bytes for verbs", size_class);
+  buffer->size = size_class;
+  buffer->mr = ibv_reg_mr(pd_, buffer->addr, size_class,
+                          IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_WRITE);
+  if (buffer->mr == nullptr) {
+    free(buffer->addr);
+    PADDLE_THROW("ibv_reg_mr of %d bytes failed", size_class);
+  }
+  VLOG(4) << "register verbs buffer of " << size_class << " bytes";
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  all_.push_back(buffer.get());
+  return buffer.release();
+}
+
+void VerbsMemPool::Free(VerbsBuffer* buffer) {
+  if (buffer == nullptr) return;
+  std::lock_guard<std::mutex> guard(mutex_);
+  free_[buffer->size].push_back(buffer);
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
+
+#endif
@@ -0,0 +1,71 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#ifdef PADDLE_WITH_VERBS
+
+#include <infiniband/verbs.h>
+
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "paddle/fluid/platform/macros.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// A buffer registered to the protection domain of the pool, which can be
+// the local buffer of a verbs work request and the target of a remote
+// RDMA write.
+struct VerbsBuffer {
+  void* addr{nullptr};
+  size_t size{0};
+  ibv_mr* mr{nullptr};
+};
+
+/*
+ * VerbsMemPool caches the registered buffers by the size classes of the
+ * powers of two, because ibv_reg_mr pins and maps the pages and is far too
+ * slow to be called for every message. A freed buffer goes back to the
+ * free list of its class and is never deregistered before the pool is
+ * destroyed.
+ */
+class VerbsMemPool {
+ public:
+  explicit VerbsMemPool(ibv_pd* pd) : pd_(pd) {}
+  ~VerbsMemPool();
+
+  // A buffer of at least size bytes.
+  VerbsBuffer* Alloc(size_t size);
+  void Free(VerbsBuffer* buffer);
+
+ private:
+  static size_t SizeClass(size_t size);
+
+  ibv_pd* pd_;
+  std::mutex mutex_;
+  std::map<size_t, std::vector<VerbsBuffer*>> free_;
+  std::vector<VerbsBuffer*> all_;
+
+  DISABLE_COPY_AND_ASSIGN(VerbsMemPool);
+};
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
+
+#endif
@@ -0,0 +1,113 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#ifdef PADDLE_WITH_VERBS
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/operators/distributed/distributed_pb.h"
+#include "paddle/fluid/operators/distributed/sendrecvop_utils.h"
+#include "paddle/fluid/operators/distributed/variable_response.h"
+#include "paddle/fluid/operators/distributed/verbs/verbs_channel.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// The methods of the verbs rpc, which match the ones of SendRecvService.
+enum VerbsMethod : uint32_t {
+  kVerbsSendVariable = 0,
+  kVerbsGetVariable = 1,
+  kVerbsPrefetchVariable = 2,
+  kVerbsCheckpointNotify = 3,
+  kVerbsGetMonomerVariable = 4,
+  kVerbsGetMonomerBarrier = 5,
+  kVerbsReply = 6,
+};
+
+/*
+ * VerbsPayload is the payload of a serialized variable: the fields of the
+ * VariableMessage which are not in the meta, each one framed by its field
+ * number and length as the attachment of brpc. It refers to the memory of
+ * the variable, so it is only valid until the variable is changed.
+ */
+class VerbsPayload {
+ public:
+  VerbsPayload() {}
+
+  const std::vector<VerbsSegment>& segments() const { return segments_; }
+
+  void Append(int field, const void* data, int64_t size);
+
+  // The tensor the payload refers to, kept alive with the payload.
+  void Hold(std::unique_ptr<TensorPayload> tensor) {
+    tensors_.push_back(std::move(tensor));
+  }
+
+ private:
+  // The 4 bytes field number and the 8 bytes length of the fields, two
+  // at most: serialized and rows.
+  char frames_[2][12];
+  int num_frames_{0};
+  std::vector<VerbsSegment> segments_;
+  std::vector<std::unique_ptr<TensorPayload>> tensors_;
+
+  DISABLE_COPY_AND_ASSIGN(VerbsPayload);
+};
+
+void SerializeToVerbsPayload(const std::string& name, framework::Variable* var,
+                             const platform::DeviceContext& ctx,
+                             VarMsg* request, VerbsPayload* payload,
+                             const std::string& out_varname = std::string(),
+                             const int trainer_id = 0,
+                             const std::string& table_name = std::string());
+
+class VerbsSourceWrapper : public Source {
+ public:
+  VerbsSourceWrapper(const char* data, size_t size)
+      : source_(data, static_cast<int>(size)) {}
+  ::google::protobuf::io::ZeroCopyInputStream* contents() override {
+    return &source_;
+  }
+
+ private:
+  ::google::protobuf::io::ArrayInputStream source_;
+};
+
+class VerbsVariableResponse : public VariableResponse {
+ public:
+  VerbsVariableResponse(const framework::Scope* scope,
+                        const platform::DeviceContext* dev_ctx,
+                        bool create_scope = false)
+      : VariableResponse(scope, dev_ctx, create_scope) {}
+
+  virtual ~VerbsVariableResponse() {}
+
+  int Parse(Source* source) override;
+  int Parse(const VerbsMessage& msg, const sendrecv::VariableMessage& meta) {
+    VerbsSourceWrapper wrapper(msg.payload, msg.payload_size);
+    return VariableResponse::Parse(&wrapper, meta);
+  }
+};
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
+
+#endif
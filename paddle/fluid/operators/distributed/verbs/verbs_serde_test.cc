@@ -0,0 +1,113 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/framework/variable.h"
+#include "paddle/fluid/operators/distributed/verbs/verbs_sendrecvop_utils.h"
+
+namespace framework = paddle::framework;
+namespace platform = paddle::platform;
+namespace distributed = paddle::operators::distributed;
+
+// Concatenate the payload as the channel does when it sends the message,
+// and deserialize from it as if it were received.
+static void Transfer(const distributed::VerbsPayload& payload,
+                     std::string* bytes, distributed::VerbsMessage* msg) {
+  for (auto& segment : payload.segments()) {
+    bytes->append(static_cast<const char*>(segment.data), segment.size);
+  }
+  msg->payload = bytes->data();
+  msg->payload_size = bytes->size();
+}
+
+TEST(VerbsSerde, SelectedRows) {
+  platform::CPUPlace place;
+  platform::CPUDeviceContext ctx(place);
+
+  sendrecv::VariableMessage meta;
+  std::string bytes;
+  distributed::VerbsMessage msg;
+  {
+    framework::Variable var;
+    auto* slr = var.GetMutable<framework::SelectedRows>();
+    slr->set_height(1000);
+    auto* tensor = slr->mutable_value();
+    tensor->Resize(framework::make_ddim({564, 128}));
+    float* data = tensor->mutable_data<float>(place);
+    for (int64_t i = 0; i < tensor->numel(); ++i) data[i] = 32.7;
+    for (int i = 0; i < 564; ++i) slr->mutable_rows()->push_back(i);
+
+    distributed::VerbsPayload payload;
+    distributed::SerializeToVerbsPayload("myvar", &var, ctx, &meta, &payload);
+    Transfer(payload, &bytes, &msg);
+  }
+
+  framework::Scope scope;
+  scope.Var("myvar");
+  distributed::VerbsVariableResponse resp(&scope, &ctx);
+  EXPECT_EQ(resp.Parse(msg, meta), 0);
+
+  auto* slr = resp.GetVar()->GetMutable<framework::SelectedRows>();
+  const float* data = slr->value().data<float>();
+  for (int64_t i = 0; i < slr->value().numel(); ++i) {
+    EXPECT_FLOAT_EQ(data[i], 32.7);
+  }
+  ASSERT_EQ(slr->rows().size(), 564UL);
+  for (size_t i = 0; i < slr->rows().size(); ++i) {
+    EXPECT_EQ(slr->rows()[i], static_cast<int64_t>(i));
+  }
+  EXPECT_EQ(slr->height(), 1000);
+}
+
+TEST(VerbsSerde, LodTensor) {
+  platform::CPUPlace place;
+  platform::CPUDeviceContext ctx(place);
+
+  sendrecv::VariableMessage meta;
+  std::string bytes;
+  distributed::VerbsMessage msg;
+  {
+    framework::Variable var;
+    auto* tensor = var.GetMutable<framework::LoDTensor>();
+    tensor->Resize(framework::make_ddim({512, 8, 4, 2}));
+    tensor->set_lod({{1, 3, 8}});
+    float* data = tensor->mutable_data<float>(place);
+    for (int64_t i = 0; i < tensor->numel(); ++i) data[i] = 31.9;
+
+    distributed::VerbsPayload payload;
+    distributed::SerializeToVerbsPayload("myvar", &var, ctx, &meta, &payload,
+                                         "", 3);
+    Transfer(payload, &bytes, &msg);
+  }
+  EXPECT_EQ(meta.varname(), "myvar");
+  EXPECT_EQ(meta.trainer_id(), 3);
+
+  framework::Scope scope;
+  scope.Var("myvar");
+  distributed::VerbsVariableResponse resp(&scope, &ctx);
+  EXPECT_EQ(resp.Parse(msg, meta), 0);
+  EXPECT_EQ(resp.GetTrainerId(), 3);
+
+  auto& tensor = resp.GetVar()->Get<framework::LoDTensor>();
+  EXPECT_EQ(tensor.dims(), framework::make_ddim({512, 8, 4, 2}));
+  EXPECT_EQ(tensor.lod(), framework::LoD({{1, 3, 8}}));
+  const float* data = tensor.data<float>();
+  for (int64_t i = 0; i < tensor.numel(); ++i) {
+    EXPECT_FLOAT_EQ(data[i], 31.9);
+  }
+}
@@ -0,0 +1,265 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifdef PADDLE_WITH_VERBS
+
+#include "paddle/fluid/operators/distributed/verbs/verbs_server.h"
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "paddle/fluid/operators/distributed/request_handler.h"
+#include "paddle/fluid/operators/distributed/verbs/verbs_sendrecvop_utils.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+// The rpc names of the handlers of the verbs methods.
+static const std::unordered_map<uint32_t, std::string>& MethodRPCNames() {
+  static const std::unordered_map<uint32_t, std::string> names = {
+      {kVerbsSendVariable, kRequestSend},
+      {kVerbsGetVariable, kRequestGet},
+      {kVerbsPrefetchVariable, kRequestPrefetch},
+      {kVerbsCheckpointNotify, kRequestCheckpoint},
+      {kVerbsGetMonomerVariable, kRequestGetMonomerVariable},
+      {kVerbsGetMonomerBarrier, kRequestGetMonomerBarrier},
+  };
+  return names;
+}
+
+AsyncVerbsServer::~AsyncVerbsServer() {
+  std::lock_guard<std::mutex> guard(channels_mutex_);
+  channels_.clear();
+}
+
+RequestHandler* AsyncVerbsServer::GetHandler(const std::string& rpc_name) {
+  auto it = rpc_call_map_.find(rpc_name);
+  PADDLE_ENFORCE(it != rpc_call_map_.end(),
+                 "%s handler should be registed first!", rpc_name);
+  return it->second;
+}
+
+void AsyncVerbsServer::StartServer() {
+  for (auto& kv : MethodRPCNames()) {
+    if (rpc_call_map_.find(kv.second) == rpc_call_map_.end()) continue;
+    // The monomer requests wait for the variables and have no thread num.
+    int thread_num = std::max(GetThreadNum(kv.second), 1);
+    threads_[kv.first].reset(new framework::ThreadPool(thread_num));
+  }
+
+  auto pos = bind_address_.rfind(':');
+  PADDLE_ENFORCE(pos != std::string::npos, "invalid bind address %s",
+                 bind_address_);
+  std::string host = bind_address_.substr(0, pos);
+  std::string port = bind_address_.substr(pos + 1);
+
+  addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE;
+  addrinfo* addr = nullptr;
+  PADDLE_ENFORCE_EQ(getaddrinfo(host.c_str(), port.c_str(), &hints, &addr), 0,
+                    "failed to resolve %s", bind_address_);
+  listen_fd_ = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+  PADDLE_ENFORCE_GE(listen_fd_, 0, "failed to create the socket");
+  int reuse = 1;
+  setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  int ret = bind(listen_fd_, addr->ai_addr, addr->ai_addrlen);
+  freeaddrinfo(addr);
+  PADDLE_ENFORCE_EQ(ret, 0, "failed to bind %s", bind_address_);
+  PADDLE_ENFORCE_EQ(listen(listen_fd_, 128), 0, "failed to listen on %s",
+                    bind_address_);
+
+  sockaddr_in bound;
+  socklen_t len = sizeof(bound);
+  PADDLE_ENFORCE_EQ(
+      getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&bound), &len), 0);
+  selected_port_ = ntohs(bound.sin_port);
+  LOG(INFO) << "Server listening on " << bind_address_
+            << " selected port: " << selected_port_;
+
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_ready_);
+    ready_ = 1;
+  }
+  condition_ready_.notify_all();
+
+  pollfd pfd;
+  pfd.fd = listen_fd_;
+  pfd.events = POLLIN;
+  while (!IsExit()) {
+    pfd.revents = 0;
+    // The timeout checks the exit flag.
+    if (poll(&pfd, 1, 100) <= 0) continue;
+    int fd = accept(listen_fd_, nullptr, nullptr);
+    if (fd < 0) continue;
+    try {
+      auto channel = VerbsChannel::Accept(
+          fd, [this](VerbsChannel* channel, VerbsMessagePtr msg) {
+            HandleRequest(channel, msg);
+          });
+      std::lock_guard<std::mutex> guard(channels_mutex_);
+      channels_.push_back(channel);
+    } catch (std::exception& e) {
+      LOG(ERROR) << "failed to set up the verbs channel: " << e.what();
+    }
+  }
+  close(listen_fd_);
+  listen_fd_ = -1;
+}
+
+void AsyncVerbsServer::ShutDownImpl() {
+  std::lock_guard<std::mutex> guard(channels_mutex_);
+  for (auto& channel : channels_) {
+    channel->Close();
+  }
+}
+
+void AsyncVerbsServer::WaitServerReady() {
+  VLOG(3) << "AsyncVerbsServer is wait server ready";
+  std::unique_lock<std::mutex> lock(this->mutex_ready_);
+  condition_ready_.wait(lock, [=] { return this->ready_ == 1; });
+  VLOG(3) << "AsyncVerbsServer WaitSeverReady";
+}
+
+void AsyncVerbsServer::HandleRequest(VerbsChannel* channel,
+                                     VerbsMessagePtr msg) {
+  if (msg == nullptr) {
+    LOG(WARNING) << "a verbs channel of the trainers is broken";
+    return;
+  }
+  auto it = threads_.find(msg->method);
+  if (it == threads_.end()) {
+    LOG(ERROR) << "no handler of the verbs method " << msg->method;
+    return;
+  }
+
+  auto self = channel->shared_from_this();
+  it->second->Run([this, self, msg] {
+    try {
+      ProcessRequest(self.get(), *msg);
+    } catch (std::exception& e) {
+      LOG(ERROR) << "verbs request " << msg->method << " failed: " << e.what();
+      try {
+        self->Send(kVerbsReply, msg->request_id, 1, "", {});
+      } catch (std::exception& e) {
+        LOG(ERROR) << "failed to reply the verbs request: " << e.what();
+      }
+    }
+  });
+}
+
+void AsyncVerbsServer::ProcessRequest(VerbsChannel* channel,
+                                      const VerbsMessage& msg) {
+  sendrecv::VariableMessage request;
+  PADDLE_ENFORCE(request.ParseFromString(msg.meta),
+                 "parse verbs request meta error!");
+  std::string varname = request.varname();
+  int trainer_id = request.trainer_id();
+  VLOG(3) << "verbs request " << msg.method << " var_name:" << varname
+          << ", trainer_id:" << trainer_id;
+
+  sendrecv::VariableMessage reply;
+  VerbsPayload payload;
+  // The payload refers to the variables of the handler, so the reply is
+  // sent before they are released.
+  auto send_reply = [&] {
+    channel->Send(kVerbsReply, msg.request_id, 0, reply.SerializeAsString(),
+                  payload.segments());
+  };
+  framework::Variable* outvar = nullptr;
+
+  switch (msg.method) {
+    case kVerbsSendVariable: {
+      auto* h = GetHandler(kRequestSend);
+      VerbsVariableResponse resp(h->scope(), h->dev_ctx(), !h->sync_mode());
+      PADDLE_ENFORCE(resp.Parse(msg, request) == 0,
+                     "parse verbs request to tensor error!");
+      h->Handle(varname, resp.GetMutableLocalScope(), resp.GetVar(), &outvar,
+                trainer_id);
+      send_reply();
+      break;
+    }
+    case kVerbsGetVariable: {
+      auto* h = GetHandler(kRequestGet);
+      auto* scope = h->scope();
+      h->Handle(varname, scope, scope->FindVar(varname), &outvar, trainer_id);
+      if (outvar) {
+        SerializeToVerbsPayload(varname, outvar, *h->dev_ctx(), &reply,
+                                &payload);
+      }
+      send_reply();
+      break;
+    }
+    case kVerbsPrefetchVariable: {
+      auto* h = GetHandler(kRequestPrefetch);
+      std::string out_var_name = request.out_varname();
+      VerbsVariableResponse resp(h->scope(), h->dev_ctx(), true);
+      PADDLE_ENFORCE(resp.Parse(msg, request) == 0,
+                     "parse verbs request to tensor error!");
+      auto* scope = resp.GetMutableLocalScope();
+      outvar = scope->Var(out_var_name);
+      h->Handle(varname, scope, scope->FindVar(varname), &outvar, trainer_id,
+                out_var_name, request.table_name());
+      SerializeToVerbsPayload(out_var_name, outvar, *h->dev_ctx(), &reply,
+                              &payload);
+      send_reply();
+      break;
+    }
+    case kVerbsCheckpointNotify: {
+      auto* h = GetHandler(kRequestCheckpoint);
+      VerbsVariableResponse resp(h->scope(), h->dev_ctx());
+      h->Handle(varname, resp.GetMutableLocalScope(), nullptr, nullptr,
+                trainer_id, request.out_varname());
+      send_reply();
+      break;
+    }
+    case kVerbsGetMonomerVariable: {
+      auto* h = GetHandler(kRequestGetMonomerVariable);
+      WaitVarCond(varname);
+      MonomerHandle monomer = GetMonomer(varname);
+      auto* scope = monomer.scope_;
+      h->Handle(varname, scope, scope->FindVar(varname), &outvar, trainer_id);
+      if (outvar) {
+        SerializeToVerbsPayload(varname, outvar, *monomer.dev_ctx_, &reply,
+                                &payload);
+      }
+      send_reply();
+      break;
+    }
+    case kVerbsGetMonomerBarrier: {
+      auto* h = GetHandler(kRequestGetMonomerBarrier);
+      WaitVarCond(varname);
+      h->Handle(varname, nullptr, nullptr, &outvar, trainer_id);
+      send_reply();
+      break;
+    }
+    default:
+      PADDLE_THROW("unknown verbs method %d", msg.method);
+  }
+}
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
+
+#endif
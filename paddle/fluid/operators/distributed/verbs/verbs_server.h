@@ -0,0 +1,73 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#ifdef PADDLE_WITH_VERBS
+
+#include <condition_variable>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/operators/distributed/distributed_pb.h"
+#include "paddle/fluid/operators/distributed/rpc_server.h"
+#include "paddle/fluid/operators/distributed/verbs/verbs_channel.h"
+
+namespace paddle {
+namespace operators {
+namespace distributed {
+
+/*
+ * AsyncVerbsServer listens on the bind address for the TCP connections
+ * which set up the VerbsChannels of the trainers, and runs the requests
+ * received by the channels on the thread pools of their rpc methods.
+ */
+class AsyncVerbsServer final : public RPCServer {
+ public:
+  explicit AsyncVerbsServer(const std::string& address, int client_num)
+      : RPCServer(address, client_num), ready_(0) {}
+
+  virtual ~AsyncVerbsServer();
+  void StartServer() override;
+  void WaitServerReady() override;
+
+ private:
+  void ShutDownImpl() override;
+
+  void HandleRequest(VerbsChannel* channel, VerbsMessagePtr msg);
+  void ProcessRequest(VerbsChannel* channel, const VerbsMessage& msg);
+  RequestHandler* GetHandler(const std::string& rpc_name);
+
+  int listen_fd_{-1};
+
+  std::mutex mutex_ready_;
+  std::condition_variable condition_ready_;
+  int ready_;
+
+  std::mutex channels_mutex_;
+  std::vector<std::shared_ptr<VerbsChannel>> channels_;
+
+  // The thread pools of the rpc methods, keyed by VerbsMethod.
+  std::unordered_map<uint32_t, std::unique_ptr<framework::ThreadPool>>
+      threads_;
+};
+
+}  // namespace distributed
+}  // namespace operators
+}  // namespace paddle
+
+#endif
@@ -51,12 +51,26 @@ class GenNCCLIdOp : public framework::OperatorBase {
   }
 
  private:
+  // The flat NCCL id comes first, followed by the inter-node ids used by
+  // hierarchical allreduce, if any.
+  std::vector<std::string> IdVarNames() const {
+    std::vector<std::string> names{NCCL_ID_VARNAME};
+    if (HasOutputs("InterNCCLID")) {
+      auto& inter_names = Outputs("InterNCCLID");
+      names.insert(names.end(), inter_names.begin(), inter_names.end());
+    }
+    return names;
+  }
+
   void GenerateAndSend(framework::Scope* scope,
                        const platform::DeviceContext& dev_ctx) const {
-    auto var = scope->FindVar(NCCL_ID_VARNAME);
-    PADDLE_ENFORCE_NOT_NULL(var);
-    auto id = var->GetMutable<ncclUniqueId>();
-    PADDLE_ENFORCE(platform::dynload::ncclGetUniqueId(id));
+    std::vector<std::string> id_var_names = IdVarNames();
+    for (auto& name : id_var_names) {
+      auto var = scope->FindVar(name);
+      PADDLE_ENFORCE_NOT_NULL(var);
+      auto id = var->GetMutable<ncclUniqueId>();
+      PADDLE_ENFORCE(platform::dynload::ncclGetUniqueId(id));
+    }
 
     std::vector<std::string> endpoint_list =
         Attr<std::vector<std::string>>("endpoint_list");
@@ -65,7 +79,9 @@ class GenNCCLIdOp : public framework::OperatorBase {
 
     for (auto& ep : endpoint_list) {
       VLOG(3) << "sending nccl id to " << ep;
-      client->AsyncSendVar(ep, dev_ctx, *scope, NCCL_ID_VARNAME);
+      for (auto& name : id_var_names) {
+        client->AsyncSendVar(ep, dev_ctx, *scope, name);
+      }
     }
     client->Wait();
     for (auto& ep : endpoint_list) {
@@ -112,10 +128,17 @@ class GenNCCLIdOpMaker : public framework::OpProtoAndCheckerMaker {
  public:
   void Make() override {
     AddOutput("NCCLID", "Raw variable contains a NCCL UniqueId instaces.");
+    AddOutput("InterNCCLID",
+              "Raw variables contain the NCCL UniqueIds of the inter-node "
+              "communicators, one for each local device, used by "
+              "hierarchical allreduce.")
+        .AsDuplicable()
+        .AsDispensable();
     AddComment(R"DOC(
 GenNCCLId operator
 
 For trainer 0: generate a new UniqueId and send it to all the other trainers.
+The same is done for every InterNCCLID output if hierarchical allreduce is used.
 For trainer 1~n: start a gRPC server to get the UniqueId, once got, stop the server.
 )DOC");
     AddAttr<std::string>("endpoint",
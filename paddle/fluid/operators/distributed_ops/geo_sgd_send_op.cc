@@ -0,0 +1,263 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/operators/distributed/distributed.h"
+
+namespace paddle {
+namespace operators {
+
+// NOTE: the delta suffix is determined by distribute_transpiler.py
+constexpr char kGeoSgdDeltaSuffix[] = ".delta";
+constexpr char kGeoSgdIdsSuffix[] = ".delta_ids";
+constexpr char kGeoSgdRowsSuffix[] = ".delta_rows";
+
+// delta = (param - old) / trainers
+template <typename T>
+static void DenseDelta(const framework::LoDTensor& param,
+                       const framework::LoDTensor& old, int trainers,
+                       framework::LoDTensor* delta) {
+  delta->Resize(param.dims());
+  const T* param_data = param.data<T>();
+  const T* old_data = old.data<T>();
+  T* delta_data = delta->mutable_data<T>(platform::CPUPlace());
+  for (int64_t i = 0; i < param.numel(); ++i) {
+    delta_data[i] = (param_data[i] - old_data[i]) / trainers;
+  }
+}
+
+// Only the rows updated since the last push are sent.
+template <typename T>
+static void SparseDelta(const framework::LoDTensor& param,
+                        const framework::LoDTensor& old, int trainers,
+                        framework::SelectedRows* delta) {
+  int64_t height = param.dims()[0];
+  int64_t width = param.numel() / height;
+  const T* param_data = param.data<T>();
+  const T* old_data = old.data<T>();
+
+  auto* rows = delta->mutable_rows();
+  rows->clear();
+  for (int64_t i = 0; i < height; ++i) {
+    if (!std::equal(param_data + i * width, param_data + (i + 1) * width,
+                    old_data + i * width)) {
+      rows->push_back(i);
+    }
+  }
+  delta->set_height(height);
+
+  auto* value = delta->mutable_value();
+  value->Resize({static_cast<int64_t>(rows->size()), width});
+  T* value_data = value->mutable_data<T>(platform::CPUPlace());
+  for (size_t i = 0; i < rows->size(); ++i) {
+    int64_t offset = (*rows)[i] * width;
+    for (int64_t j = 0; j < width; ++j) {
+      value_data[i * width + j] =
+          (param_data[offset + j] - old_data[offset + j]) / trainers;
+    }
+  }
+}
+
+// Write the fresh rows from the pserver to both param and old.
+template <typename T>
+static void UpdateRows(const framework::Vector<int64_t>& rows,
+                       const framework::LoDTensor& fresh,
+                       framework::LoDTensor* param, framework::LoDTensor* old) {
+  int64_t width = param->numel() / param->dims()[0];
+  const T* fresh_data = fresh.data<T>();
+  T* param_data = param->data<T>();
+  T* old_data = old->data<T>();
+  for (size_t i = 0; i < rows.size(); ++i) {
+    const T* src = fresh_data + i * width;
+    std::copy(src, src + width, param_data + rows[i] * width);
+    std::copy(src, src + width, old_data + rows[i] * width);
+  }
+}
+
+class GeoSgdSendOp : public framework::OperatorBase {
+ public:
+  GeoSgdSendOp(const std::string& type,
+               const framework::VariableNameMap& inputs,
+               const framework::VariableNameMap& outputs,
+               const framework::AttributeMap& attrs)
+      : OperatorBase(type, inputs, outputs, attrs) {}
+
+  void RunImpl(const framework::Scope& scope,
+               const platform::Place& place) const override {
+    auto& step = scope.FindVar(Input("Step"))->Get<framework::LoDTensor>();
+    int push_nums = Attr<int>("push_nums");
+    PADDLE_ENFORCE_GT(push_nums, 0, "push_nums should be positive");
+    if (step.data<int64_t>()[0] % push_nums != 0) return;
+
+    PADDLE_ENFORCE(platform::is_cpu_place(place),
+                   "geo_sgd_send only runs on CPU trainers");
+    auto params = Inputs("X");
+    auto olds = Inputs("Old");
+    PADDLE_ENFORCE_EQ(params.size(), olds.size(),
+                      "every parameter should have its old value");
+    auto epmap = Attr<std::vector<std::string>>("epmap");
+    int trainers = Attr<int>("trainers");
+    auto sparse_params = Attr<std::vector<std::string>>("sparse_params");
+    std::unordered_set<std::string> sparse_set(sparse_params.begin(),
+                                               sparse_params.end());
+
+    platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
+    auto& ctx = *pool.Get(place);
+    distributed::RPCClient* rpc_client =
+        distributed::RPCClient::GetInstance<RPCCLIENT_T>(
+            Attr<int>("trainer_id"));
+    auto& local_scope = scope.NewScope();
+
+    // 1. send the deltas of the local steps to the pservers, which add them
+    // to the global parameters.
+    std::vector<distributed::VarHandlePtr> rets;
+    for (size_t i = 0; i < params.size(); ++i) {
+      auto& param = scope.FindVar(params[i])->Get<framework::LoDTensor>();
+      auto& old = scope.FindVar(olds[i])->Get<framework::LoDTensor>();
+      PADDLE_ENFORCE_EQ(param.dims(), old.dims());
+      std::string delta_name = params[i] + kGeoSgdDeltaSuffix;
+      auto* delta_var = local_scope.Var(delta_name);
+      if (sparse_set.count(params[i])) {
+        auto* delta = delta_var->GetMutable<framework::SelectedRows>();
+        if (param.type() == framework::proto::VarType::FP32) {
+          SparseDelta<float>(param, old, trainers, delta);
+        } else {
+          SparseDelta<double>(param, old, trainers, delta);
+        }
+        if (delta->rows().empty()) continue;
+        // The fresh values of the same rows are fetched in step 2.
+        auto* ids = local_scope.Var(params[i] + kGeoSgdIdsSuffix)
+                        ->GetMutable<framework::LoDTensor>();
+        ids->Resize({static_cast<int64_t>(delta->rows().size()), 1});
+        std::copy(delta->rows().begin(), delta->rows().end(),
+                  ids->mutable_data<int64_t>(platform::CPUPlace()));
+      } else {
+        auto* delta = delta_var->GetMutable<framework::LoDTensor>();
+        if (param.type() == framework::proto::VarType::FP32) {
+          DenseDelta<float>(param, old, trainers, delta);
+        } else {
+          DenseDelta<double>(param, old, trainers, delta);
+        }
+      }
+      VLOG(3) << "geo sgd sends " << delta_name << " to " << epmap[i];
+      rets.push_back(
+          rpc_client->AsyncSendVar(epmap[i], ctx, local_scope, delta_name));
+    }
+    for (auto& ret : rets) {
+      PADDLE_ENFORCE(ret->Wait(), "internal error in RPCClient");
+    }
+
+    // 2. get the fresh parameters, only the sent rows of the sparse ones.
+    rets.clear();
+    for (size_t i = 0; i < params.size(); ++i) {
+      if (sparse_set.count(params[i])) {
+        std::string ids_name = params[i] + kGeoSgdIdsSuffix;
+        if (local_scope.FindLocalVar(ids_name) == nullptr) continue;
+        rets.push_back(rpc_client->AsyncPrefetchVar(
+            epmap[i], ctx, local_scope, ids_name, params[i] + kGeoSgdRowsSuffix,
+            params[i]));
+      } else {
+        rets.push_back(
+            rpc_client->AsyncGetVar(epmap[i], ctx, scope, params[i]));
+      }
+    }
+    for (auto& ret : rets) {
+      PADDLE_ENFORCE(ret->Wait(), "internal error in RPCClient");
+    }
+
+    // 3. the fresh parameters are the old values of the next local steps.
+    for (size_t i = 0; i < params.size(); ++i) {
+      auto* param =
+          scope.FindVar(params[i])->GetMutable<framework::LoDTensor>();
+      auto* old = scope.FindVar(olds[i])->GetMutable<framework::LoDTensor>();
+      if (sparse_set.count(params[i])) {
+        auto* rows_var =
+            local_scope.FindLocalVar(params[i] + kGeoSgdRowsSuffix);
+        if (rows_var == nullptr) continue;
+        auto& rows = local_scope.FindLocalVar(params[i] + kGeoSgdDeltaSuffix)
+                         ->Get<framework::SelectedRows>()
+                         .rows();
+        auto& fresh = rows_var->Get<framework::LoDTensor>();
+        if (param->type() == framework::proto::VarType::FP32) {
+          UpdateRows<float>(rows, fresh, param, old);
+        } else {
+          UpdateRows<double>(rows, fresh, param, old);
+        }
+      } else {
+        framework::TensorCopy(*param, place, ctx, old);
+      }
+    }
+    scope.DeleteScope(&local_scope);
+  }
+};
+
+class GeoSgdSendOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() {
+    AddInput("X", "(LoDTensor) The local parameters.").AsDuplicable();
+    AddInput("Old",
+             "(LoDTensor) The parameters received at the last push, one for "
+             "each of X.")
+        .AsDuplicable();
+    AddInput("Step", "(LoDTensor) The int64 counter of the local steps.");
+    AddOutput("Out", "(LoDTensor) The parameters refreshed by the pservers.")
+        .AsDuplicable();
+    AddOutput("OldOut", "(LoDTensor) The updated old parameters.")
+        .AsDuplicable();
+    AddComment(R"DOC(
+Geo-SGD Send operator
+
+The trainer runs the optimizer locally, and every push_nums steps this
+operator sends the deltas (X - Old) / trainers to the listen_and_serv op at
+the parameter servers, which add them to the global parameters. Then it gets
+the fresh parameters back into X and Old. The deltas of the sparse
+parameters are sent as SelectedRows of the updated rows, and only those rows
+are fetched back.
+)DOC");
+    AddAttr<int>("trainer_id", "trainer id from 0 ~ worker_num.").SetDefault(0);
+    AddAttr<int>("trainers", "the number of trainers.").SetDefault(1);
+    AddAttr<int>("push_nums", "push the deltas every push_nums steps.")
+        .SetDefault(100);
+    AddAttr<std::vector<std::string>>("epmap",
+                                      "(string vector, default 127.0.0.1:6164)"
+                                      "Server endpoints in the order of X")
+        .SetDefault({"127.0.0.1:6164"});
+    AddAttr<std::vector<std::string>>(
+        "sparse_params", "the parameters whose deltas are sent by rows.")
+        .SetDefault({});
+  }
+};
+
+class GeoSgdSendOpShapeInference : public framework::InferShapeBase {
+ public:
+  void operator()(framework::InferShapeContext* ctx) const override {}
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+
+REGISTER_OPERATOR(geo_sgd_send, ops::GeoSgdSendOp,
+                  paddle::framework::EmptyGradOpMaker, ops::GeoSgdSendOpMaker,
+                  ops::GeoSgdSendOpShapeInference);
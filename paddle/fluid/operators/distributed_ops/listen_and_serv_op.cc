@@ -31,6 +31,27 @@ limitations under the License. */
 DEFINE_int32(rpc_send_thread_num, 12, "number of threads for rpc send");
 DEFINE_int32(rpc_get_thread_num, 12, "number of threads for rpc get");
 DEFINE_int32(rpc_prefetch_thread_num, 12, "number of threads for rpc prefetch");
+DEFINE_string(rpc_sparse_table_spill_dir, "",
+              "the directory the sparse tables of the pserver spill their "
+              "least recently used rows to when the tables are full, e.g. "
+              "on an SSD. The tables do not spill if it is empty");
+DEFINE_int32(rpc_sparse_table_admit_count, 0,
+             "the times a new id is looked up before it is admitted to the "
+             "sparse tables of the pserver, every id is admitted if it is 0");
+DEFINE_int32(rpc_sparse_table_max_idle_seconds, 0,
+             "remove the rows of the sparse tables of the pserver not "
+             "accessed in the seconds, never if it is 0");
+DEFINE_int32(rpc_sparse_table_min_accesses, 0,
+             "remove the rows of the sparse tables of the pserver accessed "
+             "fewer times between two shrinks");
+DEFINE_int32(rpc_sparse_table_shrink_seconds, 3600,
+             "the seconds between the shrinks of the sparse tables of the "
+             "pserver that remove the idle or the rare rows");
+DEFINE_int32(rpc_sparse_table_full_checkpoint_interval, 0,
+             "checkpoint the sparse table of the pserver in the background, "
+             "a full checkpoint every so many ones and the deltas of the "
+             "updated rows between them. The save block checkpoints the "
+             "table if it is 0");
 
 namespace paddle {
 namespace operators {
@@ -359,6 +380,14 @@ void ListenAndServOp::RunImpl(const framework::Scope &scope,
                             FLAGS_rpc_prefetch_thread_num);
   rpc_service_->RegisterRPC(distributed::kRequestCheckpoint,
                             request_checkpoint_handler_.get());
+  // The multi-variable messages sent by the trainers with rpc_batch_vars
+  // are fanned out to the same handlers.
+  rpc_service_->RegisterRPC(distributed::kRequestSendVariables,
+                            request_send_handler_.get(),
+                            FLAGS_rpc_send_thread_num);
+  rpc_service_->RegisterRPC(distributed::kRequestGetVariables,
+                            request_get_handler_.get(),
+                            FLAGS_rpc_get_thread_num);
 
   auto optimize_blocks =
       Attr<std::vector<framework::BlockDesc *>>(kOptimizeBlocks);
@@ -404,6 +433,51 @@ void ListenAndServOp::RunImpl(const framework::Scope &scope,
     prefetch_var_name_to_prepared_ctx[prefetch_var_name] = prefetch_prepared[i];
   }
 
+  bool spill = !FLAGS_rpc_sparse_table_spill_dir.empty();
+  bool lifecycle = FLAGS_rpc_sparse_table_admit_count > 1 ||
+                   FLAGS_rpc_sparse_table_max_idle_seconds > 0 ||
+                   FLAGS_rpc_sparse_table_min_accesses > 0;
+  for (auto &ctx : prefetch_prepared) {
+    for (auto &op : ctx->ops_) {
+      if (op->Type() != "lookup_sparse_table") continue;
+      auto table_name = op->Input("W");
+      auto *var = recv_scope.FindVar(table_name);
+      if (var == nullptr || !var->IsType<framework::SelectedRows>()) continue;
+      auto *table = var->GetMutable<framework::SelectedRows>();
+      if (spill && !table->HasSpill()) {
+        VLOG(3) << "sparse table " << table_name << " spills to "
+                << FLAGS_rpc_sparse_table_spill_dir;
+        table->EnableSpill(FLAGS_rpc_sparse_table_spill_dir + "/" +
+                           table_name + ".spill");
+      }
+      if (lifecycle && !table->HasLifecycle()) {
+        table->EnableLifecycle(FLAGS_rpc_sparse_table_admit_count,
+                               FLAGS_rpc_sparse_table_max_idle_seconds,
+                               FLAGS_rpc_sparse_table_min_accesses,
+                               FLAGS_rpc_sparse_table_shrink_seconds);
+      }
+    }
+  }
+
+  if (ckpt_pre_context != nullptr &&
+      FLAGS_rpc_sparse_table_full_checkpoint_interval > 0) {
+    for (auto &op : ckpt_pre_context->ops_) {
+      if (op->Type() != "save") continue;
+      auto table_name = op->Input("X");
+      auto *var = recv_scope.FindVar(table_name);
+      if (var == nullptr || !var->IsType<framework::SelectedRows>()) continue;
+      VLOG(3) << "sparse table " << table_name
+              << " is checkpointed incrementally";
+      auto *handler = static_cast<distributed::RequestCheckpointHandler *>(
+          request_checkpoint_handler_.get());
+      handler->SetSparseTableCheckpoint(
+          std::unique_ptr<framework::SparseTableCheckpoint>(
+              new framework::SparseTableCheckpoint(
+                  var->GetMutable<framework::SelectedRows>(),
+                  FLAGS_rpc_sparse_table_full_checkpoint_interval)));
+    }
+  }
+
   auto f =
       std::bind(FillRequestCtx, std::placeholders::_1, &recv_scope, &dev_ctx,
                 &executor, program, &prefetch_var_name_to_prepared_ctx,
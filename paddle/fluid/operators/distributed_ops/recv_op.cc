@@ -19,7 +19,9 @@ limitations under the License. */
 #include "paddle/fluid/framework/framework.pb.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/distributed/communicator.h"
 #include "paddle/fluid/operators/distributed/distributed.h"
+#include "paddle/fluid/operators/distributed_ops/send_recv_util.h"
 #include "paddle/fluid/platform/profiler.h"
 
 namespace paddle {
@@ -41,14 +43,34 @@ class RecvOp : public framework::OperatorBase {
     platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
     auto& ctx = *pool.Get(place);
 
+    if (!sync_mode && FLAGS_communicator_enable) {
+      // The communicator receives the parameters in the background.
+      auto* communicator =
+          distributed::Communicator::Init(Attr<int>("trainer_id"));
+      for (size_t i = 0; i < outs.size(); i++) {
+        communicator->RegisterRecv(outs[i], epmap[i], scope, ctx);
+      }
+      return;
+    }
+
     distributed::RPCClient* rpc_client =
         distributed::RPCClient::GetInstance<RPCCLIENT_T>(
             Attr<int>("trainer_id"));
 
     std::vector<distributed::VarHandlePtr> rets;
-    for (size_t i = 0; i < outs.size(); i++) {
-      VLOG(3) << "getting " << outs[i] << " from " << epmap[i];
-      rets.push_back(rpc_client->AsyncGetVar(epmap[i], ctx, scope, outs[i]));
+    if (FLAGS_rpc_batch_vars) {
+      for (auto& group : GroupVarsByEndpoint(outs, epmap)) {
+        VLOG(3) << "getting " << group.second.size() << " variables from "
+                << group.first;
+        auto hs =
+            rpc_client->AsyncGetVars(group.first, ctx, scope, group.second);
+        rets.insert(rets.end(), hs.begin(), hs.end());
+      }
+    } else {
+      for (size_t i = 0; i < outs.size(); i++) {
+        VLOG(3) << "getting " << outs[i] << " from " << epmap[i];
+        rets.push_back(rpc_client->AsyncGetVar(epmap[i], ctx, scope, outs[i]));
+      }
     }
     if (sync_mode) {
       for (size_t i = 0; i < rets.size(); i++) {
@@ -19,6 +19,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/distributed/communicator.h"
 #include "paddle/fluid/operators/distributed/distributed.h"
 #include "paddle/fluid/operators/distributed_ops/send_recv_util.h"
 #include "paddle/fluid/platform/profiler.h"
@@ -43,24 +44,57 @@ class SendOp : public framework::OperatorBase {
     platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
     auto& ctx = *pool.Get(place);
 
+    if (!sync_send && FLAGS_communicator_enable) {
+      // The communicator sends the gradients in the background.
+      auto* communicator =
+          distributed::Communicator::Init(Attr<int>("trainer_id"));
+      for (size_t i = 0; i < ins.size(); i++) {
+        if (NeedSend(scope, ins[i])) {
+          communicator->Send(ins[i], epmap[i], scope, ctx);
+        }
+      }
+      return;
+    }
+
     distributed::RPCClient* rpc_client =
         distributed::RPCClient::GetInstance<RPCCLIENT_T>(
             Attr<int>("trainer_id"));
 
     std::vector<distributed::VarHandlePtr> rets;
-    for (size_t i = 0; i < ins.size(); i++) {
-      if (NeedSend(scope, ins[i])) {
-        VLOG(3) << "sending " << ins[i] << " to " << epmap[i];
-        rets.push_back(rpc_client->AsyncSendVar(epmap[i], ctx, scope, ins[i]));
-      } else {
-        VLOG(3) << "don't send no-initialied variable: " << ins[i];
+    if (FLAGS_rpc_batch_vars) {
+      std::vector<std::string> send_vars;
+      std::vector<std::string> send_epmap;
+      for (size_t i = 0; i < ins.size(); i++) {
+        if (NeedSend(scope, ins[i])) {
+          send_vars.push_back(ins[i]);
+          send_epmap.push_back(epmap[i]);
+        } else {
+          VLOG(3) << "don't send no-initialied variable: " << ins[i];
+        }
+      }
+      for (auto& group : GroupVarsByEndpoint(send_vars, send_epmap)) {
+        VLOG(3) << "sending " << group.second.size() << " variables to "
+                << group.first;
+        auto hs =
+            rpc_client->AsyncSendVars(group.first, ctx, scope, group.second);
+        rets.insert(rets.end(), hs.begin(), hs.end());
+      }
+    } else {
+      for (size_t i = 0; i < ins.size(); i++) {
+        if (NeedSend(scope, ins[i])) {
+          VLOG(3) << "sending " << ins[i] << " to " << epmap[i];
+          rets.push_back(
+              rpc_client->AsyncSendVar(epmap[i], ctx, scope, ins[i]));
+        } else {
+          VLOG(3) << "don't send no-initialied variable: " << ins[i];
+        }
       }
     }
     if (sync_send) {
       for (size_t i = 0; i < rets.size(); i++) {
-        VLOG(7) << "before sync_send " << ins[i] << "from " << epmap[i];
+        VLOG(7) << "before sync_send " << rets[i]->String();
         PADDLE_ENFORCE(rets[i]->Wait(), "internal error in RPCClient");
-        VLOG(7) << "after sync_send " << ins[i] << "from " << epmap[i];
+        VLOG(7) << "after sync_send " << rets[i]->String();
       }
     }
   }
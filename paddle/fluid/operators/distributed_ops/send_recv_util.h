@@ -14,6 +14,9 @@ limitations under the License. */
 
 #pragma once
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include "paddle/fluid/framework/ir/node.h"
 
 namespace paddle {
@@ -42,5 +45,24 @@ inline bool NeedSend(const framework::Scope& scope,
   return false;
 }
 
+// Group the variables by their endpoints for the multi-variable RPCs, the
+// endpoints and the variables of each endpoint keep their original order.
+inline std::vector<std::pair<std::string, std::vector<std::string>>>
+GroupVarsByEndpoint(const std::vector<std::string>& varnames,
+                    const std::vector<std::string>& epmap) {
+  PADDLE_ENFORCE_EQ(varnames.size(), epmap.size());
+  std::vector<std::pair<std::string, std::vector<std::string>>> groups;
+  std::unordered_map<std::string, size_t> group_idx;
+  for (size_t i = 0; i < varnames.size(); ++i) {
+    auto it = group_idx.find(epmap[i]);
+    if (it == group_idx.end()) {
+      it = group_idx.emplace(epmap[i], groups.size()).first;
+      groups.emplace_back(epmap[i], std::vector<std::string>());
+    }
+    groups[it->second].second.push_back(varnames[i]);
+  }
+  return groups;
+}
+
 }  // namespace operators
 }  // namespace paddle
@@ -30,7 +30,13 @@ class DropoutOp : public framework::OperatorWithKernel {
     auto x_dims = ctx->GetInputDim("X");
     ctx->SetOutputDim("Out", x_dims);
     if (ctx->Attrs().Get<bool>("is_test") == false) {
-      ctx->SetOutputDim("Mask", x_dims);
+      if (ctx->Attrs().Get<bool>("mask_as_bits")) {
+        int64_t numel = framework::product(x_dims);
+        int64_t mask_size = numel < 0 ? -1 : DropoutBitMaskSize(numel);
+        ctx->SetOutputDim("Mask", framework::make_ddim({mask_size}));
+      } else {
+        ctx->SetOutputDim("Mask", x_dims);
+      }
     }
     ctx->ShareLoD("X", /*->*/ "Out");
   }
@@ -61,6 +67,13 @@ class DropoutOpMaker : public framework::OpProtoAndCheckerMaker {
                   "will be dropped.")
         .SetDefault(false);
     AddAttr<int>("seed", "Dropout random seed.").SetDefault(0);
+    AddAttr<bool>("mask_as_bits",
+                  "(bool, default false) Store the Mask as a uint8 tensor "
+                  "of ceil(numel(X) / 8) bytes, in which bit i % 8 of byte "
+                  "i / 8 is set if unit i is kept, instead of a tensor of "
+                  "the shape and data type of X. It takes 1/32 of the "
+                  "memory of a float32 mask.")
+        .SetDefault(false);
     AddAttr<std::string>(
         "dropout_implementation",
         "[\"downgrade_in_infer\"|\"upscale_in_train\"]"
@@ -116,12 +129,31 @@ class DropoutOpGrad : public framework::OperatorWithKernel {
     PADDLE_ENFORCE_EQ(x_dims, out_dims,
                       "Dimensions of Input(X) and Out@Grad must be the same.");
     auto mask_dims = ctx->GetInputDim("Mask");
-    PADDLE_ENFORCE_EQ(x_dims, mask_dims,
-                      "Dimensions of Input(X) and Mask must be the same.");
+    if (ctx->Attrs().Get<bool>("mask_as_bits")) {
+      if (ctx->IsRuntime()) {
+        PADDLE_ENFORCE_EQ(
+            framework::product(mask_dims),
+            DropoutBitMaskSize(framework::product(x_dims)),
+            "Mask must have a bit for every unit of Input(X) in "
+            "mask_as_bits.");
+      }
+    } else {
+      PADDLE_ENFORCE_EQ(x_dims, mask_dims,
+                        "Dimensions of Input(X) and Mask must be the same.");
+    }
 
     ctx->SetOutputDim(framework::GradVarName("X"), x_dims);
     ctx->ShareLoD("X", /*->*/ framework::GradVarName("X"));
   }
+
+ protected:
+  // The Mask is of uint8 in mask_as_bits.
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(
+        ctx.Input<Tensor>(framework::GradVarName("Out"))->type(),
+        ctx.GetPlace());
+  }
 };
 
 }  // namespace operators
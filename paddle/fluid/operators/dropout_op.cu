@@ -11,57 +11,66 @@ distributed under the License is distributed on an "AS IS" BASIS,
 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
-#include <thrust/device_ptr.h>
-#include <thrust/iterator/counting_iterator.h>
-#include <thrust/random.h>
-#include <thrust/transform.h>
 #include <string>
 #include "paddle/fluid/operators/dropout_op.h"
 #include "paddle/fluid/platform/float16.h"
+#include "paddle/fluid/platform/philox.h"
+#include "paddle/fluid/platform/philox_state.h"
 
 namespace paddle {
 namespace operators {
 
+// Every thread takes the 4 elements of a Philox4x32 group at a time.
 template <typename T>
-__global__ void RandomGenerator(const size_t n, const int seed,
+__global__ void RandomGenerator(const size_t n, platform::PhiloxSeed seed,
                                 const float dropout_prob, const T* src,
-                                T* mask_data, T* dst,
-                                bool is_upscale_in_train) {
-  thrust::minstd_rand rng;
-  rng.seed(seed);
-  thrust::uniform_real_distribution<float> dist(0, 1);
-
-  int idx = blockDim.x * blockIdx.x + threadIdx.x;
-  int step_size = 0;
-
-  T mask;
-  T dest;
-  for (; idx < n; idx += blockDim.x * gridDim.x) {
-    T s = src[idx];
-    if (step_size == 0) {
-      rng.discard(idx);
-      step_size = blockDim.x * gridDim.x;
-    } else {
-      rng.discard(step_size);
+                                T* mask_data, T* dst, const T factor) {
+  platform::Philox4x32 rng(seed.seed, seed.offset);
+  const size_t stride = 4 * static_cast<size_t>(blockDim.x) * gridDim.x;
+  size_t idx = 4 * static_cast<size_t>(blockDim.x * blockIdx.x + threadIdx.x);
+  for (; idx < n; idx += stride) {
+    uint32_t random[4];
+    rng(idx / 4, random);
+#pragma unroll
+    for (int i = 0; i < 4; ++i) {
+      if (idx + i < n) {
+        bool keep = platform::PhiloxUniform(random[i]) >= dropout_prob;
+        mask_data[idx + i] = keep ? factor : static_cast<T>(0);
+        dst[idx + i] = keep ? src[idx + i] * factor : static_cast<T>(0);
+      }
     }
-    if (dist(rng) < dropout_prob) {
-      mask = static_cast<T>(0);
-    } else {
-      if (is_upscale_in_train) {
-        mask = static_cast<T>(1.0f / (1.0f - dropout_prob));
-      } else {
-        mask = static_cast<T>(1);
+  }
+}
+
+// Every thread takes the 8 elements of two Philox4x32 groups at a time and
+// writes their mask to one byte, so the same units are dropped as by
+// RandomGenerator for the same seed.
+template <typename T>
+__global__ void RandomBitMaskGenerator(const size_t n,
+                                       platform::PhiloxSeed seed,
+                                       const float dropout_prob, const T* src,
+                                       uint8_t* mask_bits, T* dst,
+                                       const T factor) {
+  platform::Philox4x32 rng(seed.seed, seed.offset);
+  const size_t stride = 8 * static_cast<size_t>(blockDim.x) * gridDim.x;
+  size_t idx = 8 * static_cast<size_t>(blockDim.x * blockIdx.x + threadIdx.x);
+  for (; idx < n; idx += stride) {
+    uint32_t random[8];
+    rng(idx / 4, random);
+    rng(idx / 4 + 1, random + 4);
+    uint8_t bits = 0;
+#pragma unroll
+    for (int i = 0; i < 8; ++i) {
+      if (idx + i < n) {
+        bool keep = platform::PhiloxUniform(random[i]) >= dropout_prob;
+        bits |= static_cast<uint8_t>(keep) << i;
+        dst[idx + i] = keep ? src[idx + i] * factor : static_cast<T>(0);
       }
     }
-    dest = s * mask;
-    mask_data[idx] = mask;
-    dst[idx] = dest;
+    mask_bits[idx / 8] = bits;
   }
 }
 
-// It seems that Eigen::Tensor::setRandom in GPU will SEGFAULT.
-// Use std::random and thrust::random(thrust is a std library in CUDA) to
-// implement uniform random.
 template <typename Place, typename T>
 class GPUDropoutKernel : public framework::OpKernel<T> {
  public:
@@ -76,21 +85,32 @@ class GPUDropoutKernel : public framework::OpKernel<T> {
     auto& place = *context.template device_context<Place>().eigen_device();
     if (!context.Attr<bool>("is_test")) {
       auto* mask = context.Output<Tensor>("Mask");
-      auto* mask_data = mask->mutable_data<T>(context.GetPlace());
-      size_t size = framework::product(mask->dims());
+      size_t size = x->numel();
       auto* x_data = x->data<T>();
       auto* y_data = y->mutable_data<T>(context.GetPlace());
 
-      std::random_device rnd;
-      int seed =
-          context.Attr<bool>("fix_seed") ? context.Attr<int>("seed") : rnd();
+      // NOTE: fixed seed should only be used in unittest or for debug.
+      // Guarantee to use random seed in training.
+      platform::PhiloxSeed seed =
+          context.Attr<bool>("fix_seed")
+              ? platform::FixedPhiloxSeed(context.Attr<int>("seed"))
+              : platform::PhiloxState::Get(context.GetPlace()).Next();
+
+      const T factor = static_cast<T>(DropoutMaskFactor(context));
 
       int threads = 512;
-      int grid = (x->numel() + threads - 1) / threads;
-      RandomGenerator<
-          T><<<grid, threads, 0, context.cuda_device_context().stream()>>>(
-          size, seed, dropout_prob, x_data, mask_data, y_data,
-          (dropout_implementation == "upscale_in_train"));
+      auto stream = context.cuda_device_context().stream();
+      if (context.Attr<bool>("mask_as_bits")) {
+        auto* mask_bits = mask->mutable_data<uint8_t>(context.GetPlace());
+        int grid = ((size + 7) / 8 + threads - 1) / threads;
+        RandomBitMaskGenerator<T><<<grid, threads, 0, stream>>>(
+            size, seed, dropout_prob, x_data, mask_bits, y_data, factor);
+      } else {
+        auto* mask_data = mask->mutable_data<T>(context.GetPlace());
+        int grid = ((size + 3) / 4 + threads - 1) / threads;
+        RandomGenerator<T><<<grid, threads, 0, stream>>>(
+            size, seed, dropout_prob, x_data, mask_data, y_data, factor);
+      }
     } else {
       auto X = EigenMatrix<T>::Reshape(*x, 1);
       auto Y = EigenMatrix<T>::Reshape(*y, 1);
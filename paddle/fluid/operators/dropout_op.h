@@ -13,11 +13,14 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 #pragma once
 
+#include <algorithm>
 #include <random>
 #include <string>
 
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/platform/for_range.h"
+#include "paddle/fluid/platform/hostdevice.h"
 
 namespace paddle {
 namespace operators {
@@ -27,6 +30,37 @@ template <typename T, int MajorType = Eigen::RowMajor,
           typename IndexType = Eigen::DenseIndex>
 using EigenMatrix = framework::EigenMatrix<T, MajorType, IndexType>;
 
+// The scale of the kept units in upscale_in_train. All the units are
+// dropped if dropout_prob is 1, so it is 0 instead of inf, which would make
+// the masked gradients NaN.
+inline float DropoutUpscaleFactor(float dropout_prob) {
+  return dropout_prob >= 1.0f ? 0.0f : 1.0f / (1.0f - dropout_prob);
+}
+
+// The value of the Mask for the kept units, by which they are scaled.
+inline float DropoutMaskFactor(const framework::ExecutionContext& context) {
+  return context.Attr<std::string>("dropout_implementation") ==
+                 "upscale_in_train"
+             ? DropoutUpscaleFactor(context.Attr<float>("dropout_prob"))
+             : 1.0f;
+}
+
+// With mask_as_bits, the Mask keeps unit i in bit i % 8 of byte i / 8.
+inline int64_t DropoutBitMaskSize(int64_t numel) { return (numel + 7) / 8; }
+
+template <typename T>
+struct DropoutBitMaskGradFunctor {
+  HOSTDEVICE void operator()(size_t i) const {
+    dx_[i] = (mask_[i / 8] >> (i % 8)) & 1 ? dy_[i] * factor_
+                                            : static_cast<T>(0);
+  }
+
+  const uint8_t* mask_;
+  const T* dy_;
+  T* dx_;
+  T factor_;
+};
+
 template <typename DeviceContext, typename T>
 class CPUDropoutKernel : public framework::OpKernel<T> {
  public:
@@ -41,7 +75,15 @@ class CPUDropoutKernel : public framework::OpKernel<T> {
         context.Attr<std::string>("dropout_implementation");
     if (!context.Attr<bool>("is_test")) {
       auto* mask = context.Output<Tensor>("Mask");
-      auto* mask_data = mask->mutable_data<T>(context.GetPlace());
+      bool mask_as_bits = context.Attr<bool>("mask_as_bits");
+      uint8_t* mask_bits = nullptr;
+      T* mask_data = nullptr;
+      if (mask_as_bits) {
+        mask_bits = mask->mutable_data<uint8_t>(context.GetPlace());
+        std::fill(mask_bits, mask_bits + mask->numel(), 0);
+      } else {
+        mask_data = mask->mutable_data<T>(context.GetPlace());
+      }
 
       // NOTE: fixed seed should only be used in unittest or for debug.
       // Guarantee to use random seed in training.
@@ -52,21 +94,17 @@ class CPUDropoutKernel : public framework::OpKernel<T> {
       engine.seed(seed);
 
       std::uniform_real_distribution<float> dist(0, 1);
+      const T factor = static_cast<T>(DropoutMaskFactor(context));
 
-      size_t size = framework::product(mask->dims());
+      size_t size = x->numel();
       for (size_t i = 0; i < size; ++i) {
-        if (dist(engine) < dropout_prob) {
-          mask_data[i] = 0;
-          y_data[i] = 0;
+        bool keep = dist(engine) >= dropout_prob;
+        if (mask_as_bits) {
+          mask_bits[i / 8] |= static_cast<uint8_t>(keep) << (i % 8);
         } else {
-          if (dropout_implementation == "upscale_in_train") {
-            mask_data[i] = 1.0f / static_cast<T>(1.0f - dropout_prob);
-            y_data[i] = x_data[i] / static_cast<T>(1.0f - dropout_prob);
-          } else {
-            mask_data[i] = 1;
-            y_data[i] = x_data[i];
-          }
+          mask_data[i] = keep ? factor : static_cast<T>(0);
         }
+        y_data[i] = keep ? x_data[i] * factor : static_cast<T>(0);
       }
     } else {
       auto X = EigenMatrix<T>::Reshape(*x, 1);
@@ -94,12 +132,20 @@ class DropoutGradKernel : public framework::OpKernel<T> {
     auto* mask = context.Input<Tensor>("Mask");
     grad_x->mutable_data<T>(context.GetPlace());
 
+    auto& dev_ctx = context.template device_context<DeviceContext>();
+    if (context.Attr<bool>("mask_as_bits")) {
+      platform::ForRange<DeviceContext> for_range(dev_ctx, grad_x->numel());
+      for_range(DropoutBitMaskGradFunctor<T>{
+          mask->data<uint8_t>(), grad_y->data<T>(), grad_x->data<T>(),
+          static_cast<T>(DropoutMaskFactor(context))});
+      return;
+    }
+
     auto M = EigenMatrix<T>::Reshape(*mask, 1);
     auto dX = EigenMatrix<T>::Reshape(*grad_x, 1);
     auto dY = EigenMatrix<T>::Reshape(*grad_y, 1);
 
-    auto& place =
-        *context.template device_context<DeviceContext>().eigen_device();
+    auto& place = *dev_ctx.eigen_device();
     dX.device(place) = dY * M;
   }
 };
@@ -24,45 +24,67 @@ namespace operators {
 
 using platform::PADDLE_CUDA_NUM_THREADS;
 
+// The blocks of the pairs keep their anti-diagonals in the shared memory if
+// they fit in this size.
+constexpr size_t kEditDistanceMaxSharedBytes = 32 * 1024;
+
+// Every block computes the edit distances of the pairs of the hypothesis
+// and the reference strings by turns. The distance matrix [m + 1, n + 1] of a
+// pair is computed by its anti-diagonals, each of which depends on the last
+// two only, so the block keeps three anti-diagonals indexed by the rows, in
+// the shared memory or the workspace of the block [3, max_m + 1].
 template <typename T>
-__global__ void FillFirstRow(T* dist, const int N) {
-  int idx = blockDim.x * blockIdx.x + threadIdx.x;
-  if (idx < N + 1) {
-    dist[idx] = idx;
-  }
-}
-
-template <typename T>
-__global__ void FillFirstColumn(T* dist, const int M, const int N) {
-  int idx = blockDim.x * blockIdx.x + threadIdx.x;
-  if (idx < M + 1) {
-    dist[idx * (N + 1)] = idx;
-  }
-}
-
-template <typename T>
-__global__ void Levenshtein(T* dist, const int64_t* x1, const int64_t* x2,
-                            const int M, const int N, const int start) {
-  int idx = blockDim.x * blockIdx.x + threadIdx.x;
-  int offset = N;
-  int index = start + idx * offset;
-  int row = index / (N + 1);
-  int col = index % (N + 1);
-  if (row > 0 && col > 0 && row < M + 1 && col < N + 1) {
-    int cost = x1[row - 1] == x2[col - 1] ? 0 : 1;
-    int dels = dist[(row - 1) * (N + 1) + col] + 1;
-    int ins = dist[row * (N + 1) + col - 1] + 1;
-    int subs = dist[(row - 1) * (N + 1) + (col - 1)] + cost;
-    dist[index] = min(dels, min(ins, subs));
-  }
-}
-
-template <typename T>
-__global__ void SetOutput(T* out, const T* dist, const int M, const int N,
-                          bool normalized) {
-  int idx = blockDim.x * blockIdx.x + threadIdx.x;
-  if (idx == 0) {
-    out[0] = normalized ? dist[M * (N + 1) + N] / N : dist[M * (N + 1) + N];
+__global__ void KeEditDistance(const int64_t* hyps, const int64_t* refs,
+                               const size_t* hyp_lod, const size_t* ref_lod,
+                               int num_strs, int max_m, bool shared,
+                               int* workspace, bool normalized, T* out) {
+  extern __shared__ int diagonals_shared[];
+  int* diagonals =
+      shared ? diagonals_shared : workspace + blockIdx.x * 3 * (max_m + 1);
+  for (int num = blockIdx.x; num < num_strs; num += gridDim.x) {
+    int m = static_cast<int>(hyp_lod[num + 1] - hyp_lod[num]);
+    int n = static_cast<int>(ref_lod[num + 1] - ref_lod[num]);
+    const int64_t* x1 = hyps + hyp_lod[num];
+    const int64_t* x2 = refs + ref_lod[num];
+    int distance = m > n ? m : n;
+    if (m > 0 && n > 0) {
+      int* prev2 = diagonals;
+      int* prev = diagonals + max_m + 1;
+      int* cur = diagonals + 2 * (max_m + 1);
+      for (int slice = 0; slice <= m + n; ++slice) {
+        int row_begin = slice > n ? slice - n : 0;
+        int row_end = slice < m ? slice : m;
+        for (int row = row_begin + threadIdx.x; row <= row_end;
+             row += blockDim.x) {
+          int col = slice - row;
+          int d;
+          if (row == 0) {
+            d = col;
+          } else if (col == 0) {
+            d = row;
+          } else {
+            int cost = x1[row - 1] == x2[col - 1] ? 0 : 1;
+            int dels = prev[row - 1] + 1;
+            int ins = prev[row] + 1;
+            int subs = prev2[row - 1] + cost;
+            d = min(dels, min(ins, subs));
+          }
+          cur[row] = d;
+        }
+        __syncthreads();
+        int* t = prev2;
+        prev2 = prev;
+        prev = cur;
+        cur = t;
+      }
+      distance = prev[m];
+      // Nothing is written before the next pair reads the distance.
+      __syncthreads();
+    }
+    if (threadIdx.x == 0) {
+      out[num] = normalized ? static_cast<T>(distance) / n
+                            : static_cast<T>(distance);
+    }
   }
 }
 
@@ -78,9 +100,7 @@ class EditDistanceGPUKernel : public framework::OpKernel<T> {
     sequence_num->mutable_data<int64_t>(ctx.GetPlace());
 
     auto normalized = ctx.Attr<bool>("normalized");
-    auto stream = reinterpret_cast<const platform::CUDADeviceContext&>(
-                      ctx.device_context())
-                      .stream();
+    auto& dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
 
     auto hyp_lod = x1_t->lod()[0];
     auto ref_lod = x2_t->lod()[0];
@@ -94,56 +114,35 @@ class EditDistanceGPUKernel : public framework::OpKernel<T> {
 
     const size_t num_strs = hyp_lod.size() - 1;
     math::SetConstant<platform::CUDADeviceContext, int64_t> set_constant;
-    set_constant(ctx.template device_context<platform::CUDADeviceContext>(),
-                 sequence_num, static_cast<int64_t>(num_strs));
+    set_constant(dev_ctx, sequence_num, static_cast<int64_t>(num_strs));
 
     out_t->Resize({static_cast<int64_t>(num_strs), 1});
     out_t->mutable_data<T>(ctx.GetPlace());
-    auto out = out_t->data<T>();
-
-    T distance = 0.0;
-    for (size_t num = 0; num < num_strs; num++) {
-      auto m = static_cast<int64_t>(hyp_lod[num + 1] - hyp_lod[num]);
-      auto n = static_cast<int64_t>(ref_lod[num + 1] - ref_lod[num]);
-      if (m == 0 || n == 0) {
-        distance = std::max(m, n);
-        if (normalized) {
-          PADDLE_ENFORCE(n > 0,
-                         "The reference string (#%d) cannot be empty "
-                         "when Attr(normalized) is enabled.",
-                         n);
-          distance = distance / n;
-        }
-        memory::Copy(boost::get<Place>(ctx.GetPlace()), out + num,
-                     platform::CPUPlace(), &distance, sizeof(T), stream);
-      } else {
-        framework::Tensor dist_t;
-        dist_t.Resize({m + 1, n + 1});
-        dist_t.mutable_data<T>(ctx.GetPlace());
-        auto dist = dist_t.data<T>();
-        auto x1 = x1_t->data<int64_t>() + hyp_lod[num];
-        auto x2 = x2_t->data<int64_t>() + ref_lod[num];
-
-        FillFirstColumn<T><<<1 + m / PADDLE_CUDA_NUM_THREADS,
-                             PADDLE_CUDA_NUM_THREADS, 0, stream>>>(dist, m, n);
-
-        FillFirstRow<T><<<1 + n / PADDLE_CUDA_NUM_THREADS,
-                          PADDLE_CUDA_NUM_THREADS, 0, stream>>>(dist, n);
-        // Compute the elements of distance matrix in the anti-diagonal diretion
-        for (int64_t slice = 2; slice < m + n + 1; ++slice) {
-          int z_m = slice < m + 1 ? 0 : slice - m;
-          int z_n = slice < n + 1 ? 0 : slice - n;
-          int size = slice - (z_m + z_n) + 1;  // number of elments in the same
-                                               // anti-diagonal line to update
-          // the start index at which computes from
-          int start = slice < n + 1 ? slice : (z_n + 1) * (n + 1) - 1;
-          Levenshtein<T><<<1 + (size - 1) / PADDLE_CUDA_NUM_THREADS,
-                           PADDLE_CUDA_NUM_THREADS, 0, stream>>>(dist, x1, x2,
-                                                                 m, n, start);
-        }
-        SetOutput<T><<<1, 1, 0, stream>>>(out + num, dist, m, n, normalized);
-      }
+    if (num_strs == 0) return;
+
+    int max_m = 0;
+    for (size_t num = 0; num < num_strs; ++num) {
+      max_m = std::max(max_m,
+                       static_cast<int>(hyp_lod[num + 1] - hyp_lod[num]));
+    }
+    int threads = std::min(PADDLE_CUDA_NUM_THREADS,
+                           std::max(32, (max_m + 32) / 32 * 32));
+    int grids = static_cast<int>(std::min<size_t>(
+        num_strs, std::max(dev_ctx.GetMaxPhysicalThreadCount() / threads, 1)));
+    size_t shared_bytes = 3 * (max_m + 1) * sizeof(int);
+    bool shared = shared_bytes <= kEditDistanceMaxSharedBytes;
+    framework::Tensor workspace;
+    int* workspace_data = nullptr;
+    if (!shared) {
+      workspace_data = workspace.mutable_data<int>(
+          {static_cast<int64_t>(grids) * 3 * (max_m + 1)}, ctx.GetPlace());
     }
+    KeEditDistance<T><<<grids, threads, shared ? shared_bytes : 0,
+                        dev_ctx.stream()>>>(
+        x1_t->data<int64_t>(), x2_t->data<int64_t>(),
+        hyp_lod.CUDAData(ctx.GetPlace()), ref_lod.CUDAData(ctx.GetPlace()),
+        static_cast<int>(num_strs), max_m, shared, workspace_data, normalized,
+        out_t->data<T>());
   }
 };
 
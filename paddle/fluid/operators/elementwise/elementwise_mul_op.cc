@@ -49,7 +49,8 @@ class ElementwiseMulOpMaker : public ElementwiseOpMaker {
 namespace ops = paddle::operators;
 REGISTER_OPERATOR(elementwise_mul, ops::ElementwiseOp,
                   ops::ElementwiseMulOpMaker, ops::ElementwiseOpInferVarType,
-                  ops::ElementwiseMulOpGradDescMaker);
+                  ops::ElementwiseMulOpGradDescMaker,
+                  paddle::framework::SingleOpInplaceInToOut);
 REGISTER_OPERATOR(elementwise_mul_grad, ops::ElementwiseOpGrad);
 
 REGISTER_OP_CPU_KERNEL(
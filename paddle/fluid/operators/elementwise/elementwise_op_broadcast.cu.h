@@ -0,0 +1,343 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "paddle/fluid/framework/ddim.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/hostdevice.h"
+
+namespace paddle {
+namespace operators {
+
+// The compile-time ranks of the broadcast kernel. The dims are merged before
+// the launch, so the ranks above 3 are rare and padded to the max rank.
+constexpr int kElementwiseMaxRank = framework::DDim::kMaxRank;
+constexpr int kElementwiseThreads = 256;
+
+template <typename T, int Size>
+struct alignas(sizeof(T) * Size) ElementwiseAlignedVector {
+  T val[Size];
+};
+
+// 16 bytes, i.e. float4, for the 4 and 8 bytes types, and half2 for float16.
+template <typename T>
+struct ElementwiseVecSize {
+  static constexpr int value =
+      sizeof(T) == 4 || sizeof(T) == 8 ? 16 / sizeof(T)
+                                       : (sizeof(T) == 2 ? 2 : 1);
+};
+
+// Divide by a runtime constant with a multiplication and a shift, for the
+// numerators below 2^31.
+struct ElementwiseFastDivMod {
+  ElementwiseFastDivMod() : divisor(1), multiplier(1), shift(0) {}
+
+  explicit ElementwiseFastDivMod(uint32_t d) : divisor(d) {
+    for (shift = 0; shift < 32; ++shift) {
+      if ((1ULL << shift) >= divisor) break;
+    }
+    uint64_t one = 1;
+    multiplier = static_cast<uint32_t>(
+        ((one << 32) * ((one << shift) - divisor)) / divisor + 1);
+  }
+
+  HOSTDEVICE inline uint32_t Div(uint32_t n) const {
+#ifdef __CUDA_ARCH__
+    uint32_t t = __umulhi(n, multiplier);
+#else
+    uint32_t t = static_cast<uint32_t>(
+        (static_cast<uint64_t>(n) * multiplier) >> 32);
+#endif
+    return (t + n) >> shift;
+  }
+
+  uint32_t divisor;
+  uint32_t multiplier;
+  uint32_t shift;
+};
+
+// Maps the linear index of Out to the offsets of X and Y. The strides of an
+// input are 0 on the dims it is broadcast.
+template <int kRank>
+struct ElementwiseBroadcastIndexer {
+  ElementwiseFastDivMod divmods[kRank];
+  uint32_t strides[2][kRank];
+
+  HOSTDEVICE inline void operator()(uint32_t i, uint32_t *x_offset,
+                                    uint32_t *y_offset) const {
+    uint32_t x = 0;
+    uint32_t y = 0;
+#pragma unroll
+    for (int d = kRank - 1; d > 0; --d) {
+      uint32_t q = divmods[d].Div(i);
+      uint32_t r = i - q * divmods[d].divisor;
+      x += r * strides[0][d];
+      y += r * strides[1][d];
+      i = q;
+    }
+    *x_offset = x + i * strides[0][0];
+    *y_offset = y + i * strides[1][0];
+  }
+};
+
+// Merges the adjacent dims on which both X and Y are either broadcast or not,
+// and drops the dims of size 1. x_dims and y_dims are of the rank of
+// out_dims, and each of their dims is either 1 or the dim of Out.
+inline void MergeElementwiseDims(const framework::DDim &x_dims,
+                                 const framework::DDim &y_dims,
+                                 const framework::DDim &out_dims,
+                                 std::vector<int64_t> *merged_x_dims,
+                                 std::vector<int64_t> *merged_y_dims,
+                                 std::vector<int64_t> *merged_out_dims) {
+  PADDLE_ENFORCE_EQ(x_dims.size(), out_dims.size());
+  PADDLE_ENFORCE_EQ(y_dims.size(), out_dims.size());
+  merged_x_dims->clear();
+  merged_y_dims->clear();
+  merged_out_dims->clear();
+  for (int i = 0; i < out_dims.size(); ++i) {
+    PADDLE_ENFORCE(x_dims[i] == out_dims[i] || x_dims[i] == 1,
+                   "Broadcast dimension mismatch.");
+    PADDLE_ENFORCE(y_dims[i] == out_dims[i] || y_dims[i] == 1,
+                   "Broadcast dimension mismatch.");
+    if (out_dims[i] == 1) continue;
+    bool x_bcast = x_dims[i] == 1;
+    bool y_bcast = y_dims[i] == 1;
+    if (!merged_out_dims->empty() &&
+        (merged_x_dims->back() == 1) == x_bcast &&
+        (merged_y_dims->back() == 1) == y_bcast) {
+      merged_x_dims->back() *= x_dims[i];
+      merged_y_dims->back() *= y_dims[i];
+      merged_out_dims->back() *= out_dims[i];
+    } else {
+      merged_x_dims->push_back(x_dims[i]);
+      merged_y_dims->push_back(y_dims[i]);
+      merged_out_dims->push_back(out_dims[i]);
+    }
+  }
+  if (merged_out_dims->empty()) {
+    merged_x_dims->push_back(1);
+    merged_y_dims->push_back(1);
+    merged_out_dims->push_back(1);
+  }
+}
+
+// The merged dims are aligned to the innermost dim of the indexer, and the
+// outer dims are padded with 1.
+template <int kRank>
+ElementwiseBroadcastIndexer<kRank> MakeElementwiseBroadcastIndexer(
+    const std::vector<int64_t> &x_dims, const std::vector<int64_t> &y_dims,
+    const std::vector<int64_t> &out_dims) {
+  ElementwiseBroadcastIndexer<kRank> indexer;
+  int pad = kRank - static_cast<int>(out_dims.size());
+  const std::vector<int64_t> *in_dims[2] = {&x_dims, &y_dims};
+  for (int k = 0; k < 2; ++k) {
+    uint32_t stride = 1;
+    for (int d = kRank - 1; d >= 0; --d) {
+      int64_t in_dim = d < pad ? 1 : (*in_dims[k])[d - pad];
+      int64_t out_dim = d < pad ? 1 : out_dims[d - pad];
+      indexer.strides[k][d] = in_dim == 1 ? 0 : stride;
+      stride *= static_cast<uint32_t>(in_dim);
+      if (k == 0) {
+        indexer.divmods[d] =
+            ElementwiseFastDivMod(static_cast<uint32_t>(out_dim));
+      }
+    }
+  }
+  return indexer;
+}
+
+template <typename T, int kVecSize>
+HOSTDEVICE inline void LoadElementwiseInput(
+    const T *in, uint32_t offset, uint32_t inner_stride,
+    ElementwiseAlignedVector<T, kVecSize> *vec) {
+  if (kVecSize == 1 || inner_stride == 0) {
+    T val = in[offset];
+#pragma unroll
+    for (int k = 0; k < kVecSize; ++k) vec->val[k] = val;
+  } else {
+    *vec = *reinterpret_cast<const ElementwiseAlignedVector<T, kVecSize> *>(
+        in + offset);
+  }
+}
+
+#ifdef __NVCC__
+template <typename T, typename OutT, typename Functor, int kVecSize>
+__global__ void ElementwiseSameDimsCUDAKernel(const T *x, const T *y,
+                                              OutT *out, int numel,
+                                              Functor func) {
+  using InVec = ElementwiseAlignedVector<T, kVecSize>;
+  using OutVec = ElementwiseAlignedVector<OutT, kVecSize>;
+  int tid = blockIdx.x * blockDim.x + threadIdx.x;
+  int stride = gridDim.x * blockDim.x;
+  int num_vecs = numel / kVecSize;
+  for (int i = tid; i < num_vecs; i += stride) {
+    InVec x_vec = reinterpret_cast<const InVec *>(x)[i];
+    InVec y_vec = reinterpret_cast<const InVec *>(y)[i];
+    OutVec out_vec;
+#pragma unroll
+    for (int k = 0; k < kVecSize; ++k) {
+      out_vec.val[k] = func(x_vec.val[k], y_vec.val[k]);
+    }
+    reinterpret_cast<OutVec *>(out)[i] = out_vec;
+  }
+  for (int i = num_vecs * kVecSize + tid; i < numel; i += stride) {
+    out[i] = func(x[i], y[i]);
+  }
+}
+
+// Every thread computes kVecSize adjacent elements of Out, which share the
+// outer indices since the innermost dim is divisible by kVecSize.
+template <typename T, typename OutT, typename Functor, int kRank,
+          int kVecSize>
+__global__ void ElementwiseBroadcastCUDAKernel(
+    const T *x, const T *y, OutT *out, int numel,
+    ElementwiseBroadcastIndexer<kRank> indexer, Functor func) {
+  using InVec = ElementwiseAlignedVector<T, kVecSize>;
+  using OutVec = ElementwiseAlignedVector<OutT, kVecSize>;
+  int stride = gridDim.x * blockDim.x * kVecSize;
+  for (int i = (blockIdx.x * blockDim.x + threadIdx.x) * kVecSize; i < numel;
+       i += stride) {
+    uint32_t x_offset, y_offset;
+    indexer(i, &x_offset, &y_offset);
+    InVec x_vec, y_vec;
+    LoadElementwiseInput<T, kVecSize>(x, x_offset,
+                                      indexer.strides[0][kRank - 1], &x_vec);
+    LoadElementwiseInput<T, kVecSize>(y, y_offset,
+                                      indexer.strides[1][kRank - 1], &y_vec);
+    OutVec out_vec;
+#pragma unroll
+    for (int k = 0; k < kVecSize; ++k) {
+      out_vec.val[k] = func(x_vec.val[k], y_vec.val[k]);
+    }
+    *reinterpret_cast<OutVec *>(out + i) = out_vec;
+  }
+}
+
+inline int GetElementwiseGridSize(const platform::CUDADeviceContext &ctx,
+                                  int num_threads) {
+  int grid_size =
+      (num_threads + kElementwiseThreads - 1) / kElementwiseThreads;
+  int max_grid_size = ctx.GetMaxPhysicalThreadCount() / kElementwiseThreads;
+  return std::max(std::min(grid_size, max_grid_size), 1);
+}
+
+template <typename T>
+inline bool IsElementwiseAligned(const T *ptr, int vec_size) {
+  return reinterpret_cast<uintptr_t>(ptr) % (sizeof(T) * vec_size) == 0;
+}
+
+template <typename T, typename OutT, typename Functor, int kRank>
+void LaunchElementwiseBroadcastKernel(const platform::CUDADeviceContext &ctx,
+                                      const T *x, const T *y, OutT *out,
+                                      int numel,
+                                      const std::vector<int64_t> &x_dims,
+                                      const std::vector<int64_t> &y_dims,
+                                      const std::vector<int64_t> &out_dims,
+                                      Functor func) {
+  constexpr int kVecSize = ElementwiseVecSize<T>::value;
+  auto indexer = MakeElementwiseBroadcastIndexer<kRank>(x_dims, y_dims,
+                                                        out_dims);
+  bool vectorize = out_dims.back() % kVecSize == 0 &&
+                   IsElementwiseAligned(x, kVecSize) &&
+                   IsElementwiseAligned(y, kVecSize) &&
+                   IsElementwiseAligned(out, kVecSize);
+  if (vectorize) {
+    int grid_size = GetElementwiseGridSize(ctx, numel / kVecSize);
+    ElementwiseBroadcastCUDAKernel<T, OutT, Functor, kRank,
+                                   kVecSize><<<grid_size, kElementwiseThreads,
+                                               0, ctx.stream()>>>(
+        x, y, out, numel, indexer, func);
+  } else {
+    int grid_size = GetElementwiseGridSize(ctx, numel);
+    ElementwiseBroadcastCUDAKernel<T, OutT, Functor, kRank,
+                                   1><<<grid_size, kElementwiseThreads, 0,
+                                        ctx.stream()>>>(x, y, out, numel,
+                                                        indexer, func);
+  }
+}
+
+// Out = func(X, Y) on GPU, in which X and Y are broadcast to Out. x_dims and
+// y_dims are of the rank of out_dims, and each of their dims is either 1 or
+// the dim of Out.
+template <typename T, typename OutT, typename Functor>
+void LaunchElementwiseCUDAKernel(const platform::CUDADeviceContext &ctx,
+                                 const framework::DDim &x_dims, const T *x,
+                                 const framework::DDim &y_dims, const T *y,
+                                 const framework::DDim &out_dims, OutT *out,
+                                 Functor func) {
+  int64_t numel = framework::product(out_dims);
+  if (numel == 0) return;
+  PADDLE_ENFORCE_LE(numel, std::numeric_limits<int32_t>::max(),
+                    "The number of the elements of Out exceeds int32.");
+
+  std::vector<int64_t> merged_x_dims, merged_y_dims, merged_out_dims;
+  MergeElementwiseDims(x_dims, y_dims, out_dims, &merged_x_dims,
+                       &merged_y_dims, &merged_out_dims);
+
+  int n = static_cast<int>(numel);
+  bool same_dims = merged_out_dims.size() == 1 &&
+                   merged_x_dims[0] == merged_out_dims[0] &&
+                   merged_y_dims[0] == merged_out_dims[0];
+  if (same_dims) {
+    constexpr int kVecSize = ElementwiseVecSize<T>::value;
+    if (IsElementwiseAligned(x, kVecSize) &&
+        IsElementwiseAligned(y, kVecSize) &&
+        IsElementwiseAligned(out, kVecSize)) {
+      int grid_size = GetElementwiseGridSize(ctx, n / kVecSize);
+      ElementwiseSameDimsCUDAKernel<T, OutT, Functor,
+                                    kVecSize><<<grid_size, kElementwiseThreads,
+                                                0, ctx.stream()>>>(x, y, out,
+                                                                   n, func);
+    } else {
+      int grid_size = GetElementwiseGridSize(ctx, n);
+      ElementwiseSameDimsCUDAKernel<T, OutT, Functor,
+                                    1><<<grid_size, kElementwiseThreads, 0,
+                                         ctx.stream()>>>(x, y, out, n, func);
+    }
+    return;
+  }
+
+  switch (merged_out_dims.size()) {
+    case 1:
+      LaunchElementwiseBroadcastKernel<T, OutT, Functor, 1>(
+          ctx, x, y, out, n, merged_x_dims, merged_y_dims, merged_out_dims,
+          func);
+      break;
+    case 2:
+      LaunchElementwiseBroadcastKernel<T, OutT, Functor, 2>(
+          ctx, x, y, out, n, merged_x_dims, merged_y_dims, merged_out_dims,
+          func);
+      break;
+    case 3:
+      LaunchElementwiseBroadcastKernel<T, OutT, Functor, 3>(
+          ctx, x, y, out, n, merged_x_dims, merged_y_dims, merged_out_dims,
+          func);
+      break;
+    default:
+      LaunchElementwiseBroadcastKernel<T, OutT, Functor, kElementwiseMaxRank>(
+          ctx, x, y, out, n, merged_x_dims, merged_y_dims, merged_out_dims,
+          func);
+      break;
+  }
+}
+#endif
+
+}  // namespace operators
+}  // namespace paddle
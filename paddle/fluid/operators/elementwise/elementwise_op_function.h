@@ -17,7 +17,9 @@ limitations under the License. */
 #include <glog/logging.h>
 #include <algorithm>
 #include <iterator>
+#include <type_traits>
 #include <vector>
+#include "paddle/fluid/framework/compute_pool.h"
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/operator.h"
@@ -27,6 +29,7 @@ limitations under the License. */
 #include <cuda.h>
 #include <thrust/iterator/iterator_adaptor.h>
 #include "paddle/fluid/platform/cuda_device_function.h"
+#include "paddle/fluid/operators/elementwise/elementwise_op_broadcast.cu.h"
 #include "paddle/fluid/platform/cuda_primitives.h"
 constexpr int ELEMWISE_MAX_BLOCK_DIM = 1024;
 #endif
@@ -89,6 +92,27 @@ inline framework::DDim trim_trailing_singular_dims(
   return actual_dims;
 }
 
+// Extends the dims of Y to the rank of X, in which Y is broadcast on the
+// dims of size 1. For example, shape(X) = (2, 3, 4, 5), shape(Y) = (3, 4)
+// and axis = 1, the dims of Y are extended to (1, 3, 4, 1).
+inline framework::DDim get_broadcast_dims(
+    const framework::DDim &x_dims, const framework::DDim &y_dims_untrimed,
+    int axis) {
+  axis = (axis == -1 ? x_dims.size() - y_dims_untrimed.size() : axis);
+  PADDLE_ENFORCE(axis >= 0 && axis < x_dims.size(),
+                 "Axis should be in range [0, x_dims)");
+  auto y_dims = trim_trailing_singular_dims(y_dims_untrimed);
+  axis = (y_dims.size() == 0) ? x_dims.size() : axis;
+
+  std::vector<int64_t> bcast_dims(x_dims.size(), 1);
+  for (int i = 0; i < y_dims.size(); ++i) {
+    PADDLE_ENFORCE_EQ(x_dims[i + axis], y_dims[i],
+                      "Broadcast dimension mismatch.");
+    bcast_dims[i + axis] = y_dims[i];
+  }
+  return framework::make_ddim(bcast_dims);
+}
+
 template <typename T, typename DeviceContext>
 class RowwiseTransformIterator;
 
@@ -252,6 +276,16 @@ class TransformFunctor {
         func_(func) {}
 
   inline void Run() const {
+    // The same dims are split on the ComputePool if the current thread
+    // shares it.
+    if (std::is_same<DeviceContext, platform::CPUDeviceContext>::value &&
+        framework::CurrentComputeQuota() != nullptr) {
+      framework::ParallelFor(nx_, 1 << 14, [this](int64_t begin, int64_t end) {
+        platform::Transform<DeviceContext> trans;
+        trans(ctx_, x_ + begin, x_ + end, y_ + begin, z_ + begin, func_);
+      });
+      return;
+    }
     platform::Transform<DeviceContext> trans;
     trans(ctx_, x_, x_ + nx_, y_, z_, func_);
   }
@@ -675,13 +709,27 @@ void ElementwiseComputeEx(const framework::ExecutionContext &ctx,
                           const framework::Tensor *x,
                           const framework::Tensor *y, int axis, Functor func,
                           framework::Tensor *z) {
-  TransformFunctor<Functor, T, DeviceContext, OutType> functor(
-      x, y, z, ctx.template device_context<DeviceContext>(), func);
   auto x_dims = x->dims();
   auto y_dims_untrimed = y->dims();
   PADDLE_ENFORCE_GE(x_dims.size(), y_dims_untrimed.size(),
                     "Rank of first input must >= rank of second input.");
 
+#ifdef __NVCC__
+  if (platform::is_gpu_place(ctx.GetPlace())) {
+    auto y_bcast_dims = x_dims == y_dims_untrimed
+                            ? x_dims
+                            : get_broadcast_dims(x_dims, y_dims_untrimed, axis);
+    LaunchElementwiseCUDAKernel<T, OutType>(
+        ctx.template device_context<platform::CUDADeviceContext>(), x_dims,
+        x->data<T>(), y_bcast_dims, y->data<T>(), x_dims,
+        z->mutable_data<OutType>(ctx.GetPlace()), func);
+    return;
+  }
+#endif
+
+  TransformFunctor<Functor, T, DeviceContext, OutType> functor(
+      x, y, z, ctx.template device_context<DeviceContext>(), func);
+
   if (x_dims == y_dims_untrimed) {
     functor.Run();
     return;
@@ -706,6 +754,15 @@ void ElementwiseComputeEx(const framework::ExecutionContext &ctx,
 
 // FusedElemwiseAndAct
 // --- forward
+template <typename T, typename CompoundFunctor>
+struct FusedElemwiseAndActOutFunctor {
+  inline HOSTDEVICE T operator()(T x, T y) const {
+    return compound_functor_.GetOut(x, y);
+  }
+
+  CompoundFunctor compound_functor_;
+};
+
 template <typename T, typename CompoundFunctor, bool KeepIntermediateOut>
 struct FusedElemwiseAndActNoBroadcast {
   HOSTDEVICE void operator()(size_t i) {
@@ -1600,6 +1657,35 @@ void FusedElemwiseAndActComputeEx(const framework::ExecutionContext &ctx,
 
   const framework::DDim &x_dim = x.dims();
   const framework::DDim &y_dim = y.dims();
+#ifdef __NVCC__
+  // Without the intermediate out, the forward is a plain elementwise op of
+  // compound_functor.GetOut.
+  if (!KeepIntermediateOut && platform::is_gpu_place(ctx.GetPlace())) {
+    bool bcast_y = x_dim.size() >= y_dim.size();
+    if (x_dim.size() == y_dim.size()) {
+      for (int i = 0; i < x_dim.size(); ++i) {
+        if (x_dim[i] < y_dim[i]) {
+          bcast_y = false;
+          break;
+        }
+      }
+    }
+    bool same_dims = x_dim == y_dim;
+    auto &out_dim = bcast_y ? x_dim : y_dim;
+    auto x_bcast_dim = bcast_y || same_dims
+                           ? x_dim
+                           : get_broadcast_dims(y_dim, x_dim, axis);
+    auto y_bcast_dim = !bcast_y || same_dims
+                           ? y_dim
+                           : get_broadcast_dims(x_dim, y_dim, axis);
+    LaunchElementwiseCUDAKernel<T, T>(
+        ctx.template device_context<platform::CUDADeviceContext>(),
+        x_bcast_dim, x.data<T>(), y_bcast_dim, y.data<T>(), out_dim,
+        out->mutable_data<T>(ctx.GetPlace()),
+        FusedElemwiseAndActOutFunctor<T, CompoundFunctor>{compound_functor});
+    return;
+  }
+#endif
   if (x.dims() == y.dims()) {
     FusedElemwiseAndActComputeNoBroadcast<DeviceContext, T, CompoundFunctor,
                                           KeepIntermediateOut>(
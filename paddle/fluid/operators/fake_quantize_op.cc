@@ -13,7 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/fake_quantize_op.h"
+#include <algorithm>
 #include <string>
+#include "paddle/fluid/framework/compute_pool.h"
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/operators/clip_op.h"
 #include "paddle/fluid/platform/transform.h"
@@ -92,6 +94,39 @@ struct FindRangeAbsMaxFunctor<platform::CPUDeviceContext, T> {
 
 template struct FindRangeAbsMaxFunctor<platform::CPUDeviceContext, float>;
 
+template <typename T>
+struct FakeQuantDequantAbsMaxFunctor<platform::CPUDeviceContext, T> {
+  void operator()(const platform::CPUDeviceContext& ctx,
+                  const framework::Tensor& in, const int bin_cnt,
+                  const int channel_num, framework::Tensor* out_scale,
+                  framework::Tensor* out) {
+    const T* in_data = in.data<T>();
+    T* scale_data = out_scale->mutable_data<T>(ctx.GetPlace());
+    T* out_data = out->mutable_data<T>(ctx.GetPlace());
+    int64_t channel_size = in.numel() / channel_num;
+    framework::ParallelFor(0, channel_num, 1, [&](int64_t begin,
+                                                  int64_t end) {
+      for (int64_t c = begin; c < end; ++c) {
+        const T* x = in_data + c * channel_size;
+        T* y = out_data + c * channel_size;
+        T s = 0;
+        for (int64_t i = 0; i < channel_size; ++i) {
+          s = std::max(s, std::abs(x[i]));
+        }
+        scale_data[c] = s;
+        T quant = s > 0 ? bin_cnt / s : 0;
+        T dequant = s / bin_cnt;
+        for (int64_t i = 0; i < channel_size; ++i) {
+          y[i] = ClipAndQuantDequant(x[i], s, quant, dequant);
+        }
+      }
+    });
+  }
+};
+
+template struct FakeQuantDequantAbsMaxFunctor<platform::CPUDeviceContext,
+                                              float>;
+
 class FakeQuantizeAbsMaxOp : public framework::OperatorWithKernel {
  public:
   FakeQuantizeAbsMaxOp(const std::string& type,
@@ -212,6 +247,79 @@ $$Out = round(X/scale * range)$$
   }
 };
 
+class FakeQuantizeDequantizeAbsMaxOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(
+        ctx->HasInput("X"),
+        "Input(X) of FakeQuantizeDequantizeAbsMaxOp should not be null.");
+    PADDLE_ENFORCE(
+        ctx->HasOutput("Out"),
+        "Output(Out) of FakeQuantizeDequantizeAbsMaxOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("OutScale"),
+                   "Output(OutScale) of FakeQuantizeDequantizeAbsMaxOp "
+                   "should not be null.");
+    auto x_dims = ctx->GetInputDim("X");
+    if (ctx->Attrs().Get<bool>("channel_wise")) {
+      PADDLE_ENFORCE_GE(x_dims.size(), 2,
+                        "The channel-wise Input(X) should be 2-D at least.");
+      ctx->SetOutputDim("OutScale", {x_dims[0]});
+    } else {
+      ctx->SetOutputDim("OutScale", {1});
+    }
+    ctx->SetOutputDim("Out", x_dims);
+    ctx->ShareLoD("X", /*->*/ "Out");
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(ctx.Input<framework::LoDTensor>("X")->type(),
+                                   ctx.device_context());
+  }
+};
+
+class FakeQuantizeDequantizeAbsMaxOpMaker
+    : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("X", "(Tensor) Input is float data type.");
+    AddOutput("Out",
+              "(Tensor) Output of the quantized and dequantized X, which is "
+              "of float data type.");
+    AddOutput("OutScale",
+              "(Tensor) Current scale, or the scales of the channels if "
+              "channel_wise.");
+    AddAttr<int>("bit_length", "(int, default 8)")
+        .SetDefault(8)
+        .AddCustomChecker([](const int& bit_length) {
+          PADDLE_ENFORCE(bit_length >= 1 && bit_length <= 16,
+                         "'bit_length' should be between 1 and 16.");
+        });
+    AddAttr<bool>("channel_wise",
+                  "(bool, default false) Whether the scales are the ones of "
+                  "the channels of the first dimension of X, e.g. the "
+                  "output channels of the weights of conv2d.")
+        .SetDefault(false);
+    AddComment(R"DOC(
+FakeQuantizeDequantize operator
+
+$$scale = max(abs(X))$$
+$$range = 2^{bit_length - 1} - 1$$
+$$Out = round(X/scale * range) * scale / range$$
+
+It computes fake_quantize_abs_max followed by fake_dequantize_max_abs with
+max_range = range in one pass, without the quantized tensor between them.
+If channel_wise, the scale is the one of each channel of the first
+dimension of X. The pairs of the ops are replaced by this op in a graph by
+fuse_fake_quantize_dequantize_pass.
+
+)DOC");
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
@@ -229,3 +337,10 @@ REGISTER_OPERATOR(fake_quantize_range_abs_max, ops::FakeQuantizeRangeAbsMaxOp,
                   paddle::framework::EmptyGradOpMaker);
 REGISTER_OP_CPU_KERNEL(fake_quantize_range_abs_max,
                        ops::FakeQuantizeRangeAbsMaxKernel<CPU, float>);
+
+REGISTER_OPERATOR(fake_quantize_dequantize_abs_max,
+                  ops::FakeQuantizeDequantizeAbsMaxOp,
+                  ops::FakeQuantizeDequantizeAbsMaxOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+REGISTER_OP_CPU_KERNEL(fake_quantize_dequantize_abs_max,
+                       ops::FakeQuantizeDequantizeAbsMaxKernel<CPU, float>);
@@ -12,63 +12,78 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <algorithm>
 #include <string>
-#include "paddle/fluid/memory/memcpy.h"
 #include "paddle/fluid/operators/fake_quantize_op.h"
+#include "paddle/fluid/platform/cuda_device_function.h"
 #include "paddle/fluid/platform/cuda_primitives.h"
 
 namespace paddle {
 namespace operators {
 
+constexpr int kQuantWarpSize = 32;
+constexpr int kQuantBlockDim = 512;
+
+// The max of the non-negative values of the threads of the block by the
+// warp shuffles, which is returned to all the threads.
 template <typename T>
-__global__ void FindAbsMaxKernel(const T* in, const int n, T* out) {
-  int bid = threadIdx.x + blockIdx.x * blockDim.x;
-  int tid = threadIdx.x;
-
-  extern __shared__ T shared_max_data[];
-  if (gridDim.x > 1) {
-    shared_max_data[tid] = T(0);
-    for (int i = bid; i < n; i += blockDim.x * gridDim.x) {
-      T tmp = fabs(in[i]);
-      if (tmp > shared_max_data[tid]) {
-        shared_max_data[tid] = tmp;
-      }
-    }
-  } else {
-    if (bid < n) {
-      shared_max_data[tid] = fabs(in[bid]);
-    } else {
-      shared_max_data[tid] = T(0);
-    }
+__device__ T BlockAbsMax(T val) {
+  __shared__ T warp_max[kQuantWarpSize];
+  __shared__ T result;
+  unsigned mask = 0u;
+  CREATE_SHFL_MASK(mask, true);
+  int lane = threadIdx.x % kQuantWarpSize;
+  int warp = threadIdx.x / kQuantWarpSize;
+  for (int offset = kQuantWarpSize / 2; offset > 0; offset /= 2) {
+    T other = platform::CudaShuffleDownSync(mask, val, offset);
+    val = val > other ? val : other;
   }
+  if (lane == 0) warp_max[warp] = val;
   __syncthreads();
-
-  for (int i = blockDim.x / 2; i > 0; i >>= 1) {
-    if (tid < i && (shared_max_data[tid] < shared_max_data[tid + i])) {
-      shared_max_data[tid] = shared_max_data[tid + i];
+  if (warp == 0) {
+    val = lane < blockDim.x / kQuantWarpSize ? warp_max[lane] : T(0);
+    for (int offset = kQuantWarpSize / 2; offset > 0; offset /= 2) {
+      T other = platform::CudaShuffleDownSync(mask, val, offset);
+      val = val > other ? val : other;
     }
-    __syncthreads();
+    if (lane == 0) result = val;
   }
-  if (tid == 0) {
-    out[blockIdx.x] = shared_max_data[0];
+  __syncthreads();
+  return result;
+}
+
+// The bits of the non-negative floats are ordered as the floats are.
+__device__ __forceinline__ void AtomicAbsMax(float* address, float val) {
+  atomicMax(reinterpret_cast<int*>(address), __float_as_int(val));
+}
+
+// Every block reduces its part of in, and merges its max into out, which is
+// zeroed before.
+template <typename T>
+__global__ void FindAbsMaxKernel(const T* in, const int n, T* out) {
+  T max = 0;
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += blockDim.x * gridDim.x) {
+    T v = fabs(in[i]);
+    max = max > v ? max : v;
   }
+  max = BlockAbsMax(max);
+  if (threadIdx.x == 0) AtomicAbsMax(out, max);
+}
+
+static int QuantGridDim(const platform::CUDADeviceContext& ctx, int64_t num) {
+  int64_t max_grid = ctx.GetMaxPhysicalThreadCount() / kQuantBlockDim;
+  int64_t grid = (num + kQuantBlockDim - 1) / kQuantBlockDim;
+  return static_cast<int>(std::max<int64_t>(std::min(grid, max_grid), 1));
 }
 
 template <typename T>
 struct FindAbsMaxFunctor<platform::CUDADeviceContext, T> {
   void operator()(const platform::CUDADeviceContext& ctx, const T* in,
                   const int num, T* out) {
-    int block = 1024;
-    int grid = (block - 1 + num) / block;
-    grid = (grid > block) ? block : grid;
-
-    framework::Tensor max;
-    T* max_data =
-        max.mutable_data<T>(framework::make_ddim({grid}), ctx.GetPlace());
-    FindAbsMaxKernel<T><<<grid, block, 1024 * sizeof(T), ctx.stream()>>>(
-        in, num, max_data);
-    FindAbsMaxKernel<T><<<1, block, 1024 * sizeof(T), ctx.stream()>>>(
-        max_data, grid, out);
+    PADDLE_ENFORCE(cudaMemsetAsync(out, 0, sizeof(T), ctx.stream()));
+    FindAbsMaxKernel<T><<<QuantGridDim(ctx, num), kQuantBlockDim, 0,
+                          ctx.stream()>>>(in, num, out);
   }
 };
 
@@ -77,39 +92,45 @@ template struct FindAbsMaxFunctor<platform::CUDADeviceContext, float>;
 template <typename T>
 __global__ void ClipAndQuantKernel(const T* in, const T* scale,
                                    const int bin_cnt, const int n, T* out) {
-  int bid = threadIdx.x + blockIdx.x * blockDim.x;
-  int tid = threadIdx.x;
-
   T s = scale[0];
-  for (int i = bid; i < n; i += blockDim.x * gridDim.x) {
-    T x = in[bid];
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += blockDim.x * gridDim.x) {
+    T x = in[i];
     T v = x > s ? s : x;
     v = v < -s ? -s : v;
     v = bin_cnt / s * v;
-    out[bid] = round(v);
+    out[i] = round(v);
   }
 }
 
+// Updates the window of the scales, and finds the max of the window again
+// if the removed scale was the max, all in one block on the device, so that
+// the host never waits for the decision.
 template <typename T>
-__global__ void FindRangeAbsMaxAndFillArray(const T* cur_scale,
-                                            const T* last_scale,
-                                            const int64_t* iter,
-                                            const int window_size, T* scale_arr,
-                                            T* out_scale, int* need_find_max,
-                                            int* out_size) {
-  int it = iter[0];
+__global__ void FindRangeAbsMaxKernel(const T* cur_scale, const T* last_scale,
+                                      const int64_t* iter,
+                                      const int window_size, T* scale_arr,
+                                      T* out_scale) {
+  int64_t it = iter[0];
   int idx = it % window_size;
   T removed = scale_arr[idx];
   T cur = cur_scale[0];
-  scale_arr[idx] = cur;
   T max = last_scale[0];
-  out_scale[0] = max < cur ? cur : max;
-  if (fabs(removed - max) < 1e-6) {
-    need_find_max[0] = 1;
-    out_size[0] = it > window_size ? window_size : it;
-  } else {
-    need_find_max[0] = 0;
+  __syncthreads();
+  if (threadIdx.x == 0) scale_arr[idx] = cur;
+  if (max < cur || fabs(removed - max) >= 1e-6) {
+    if (threadIdx.x == 0) out_scale[0] = max < cur ? cur : max;
+    return;
   }
+  __syncthreads();
+  int size = it > window_size ? window_size : it;
+  max = 0;
+  for (int i = threadIdx.x; i < size; i += blockDim.x) {
+    T v = fabs(scale_arr[i]);
+    max = max > v ? max : v;
+  }
+  max = BlockAbsMax(max);
+  if (threadIdx.x == 0) out_scale[0] = max;
 }
 
 template <typename T>
@@ -124,44 +145,90 @@ struct FindRangeAbsMaxFunctor<platform::CUDADeviceContext, T> {
     T* scale_arr = scales_arr->mutable_data<T>(gpu_place);
     T* out_scale_data = out_scale->mutable_data<T>(gpu_place);
 
-    framework::Tensor need_find_max, out_size;
-    int* find_max = need_find_max.mutable_data<int>(gpu_place);
-    int* out_size_data = out_size.mutable_data<int>(gpu_place);
-
-    FindRangeAbsMaxAndFillArray<T><<<1, 1, 0, ctx.stream()>>>(
+    FindRangeAbsMaxKernel<T><<<1, kQuantBlockDim, 0, ctx.stream()>>>(
         cur_scale.data<T>(), last_scale.data<T>(), iter.data<int64_t>(),
-        window_size, scale_arr, out_scale_data, find_max, out_size_data);
-
-    int g_find_max;
-    memory::Copy(platform::CPUPlace(), &g_find_max, gpu_place, find_max,
-                 sizeof(int), 0);
-    if (g_find_max) {
-      int len;
-      memory::Copy(platform::CPUPlace(), &len, gpu_place, out_size_data,
-                   sizeof(int), 0);
-      FindAbsMaxFunctor<platform::CUDADeviceContext, T>()(ctx, scale_arr, len,
-                                                          out_scale_data);
-    }
+        window_size, scale_arr, out_scale_data);
   }
 };
 
 template struct FindRangeAbsMaxFunctor<platform::CUDADeviceContext, float>;
 
+template <typename T>
+__global__ void ClipAndQuantDequantKernel(const T* in, const T* scale,
+                                          const int bin_cnt, const int n,
+                                          T* out) {
+  T s = scale[0];
+  T quant = s > 0 ? bin_cnt / s : 0;
+  T dequant = s / bin_cnt;
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += blockDim.x * gridDim.x) {
+    out[i] = ClipAndQuantDequant(in[i], s, quant, dequant);
+  }
+}
+
+// A block a channel, which finds the abs max of the channel and quantizes
+// and dequantizes it by the max in one kernel.
+template <typename T>
+__global__ void ChannelQuantDequantKernel(const T* in,
+                                          const int64_t channel_size,
+                                          const int bin_cnt, T* scale,
+                                          T* out) {
+  const T* x = in + blockIdx.x * channel_size;
+  T* y = out + blockIdx.x * channel_size;
+  T max = 0;
+  for (int64_t i = threadIdx.x; i < channel_size; i += blockDim.x) {
+    T v = fabs(x[i]);
+    max = max > v ? max : v;
+  }
+  T s = BlockAbsMax(max);
+  if (threadIdx.x == 0) scale[blockIdx.x] = s;
+  T quant = s > 0 ? bin_cnt / s : 0;
+  T dequant = s / bin_cnt;
+  for (int64_t i = threadIdx.x; i < channel_size; i += blockDim.x) {
+    y[i] = ClipAndQuantDequant(x[i], s, quant, dequant);
+  }
+}
+
+template <typename T>
+struct FakeQuantDequantAbsMaxFunctor<platform::CUDADeviceContext, T> {
+  void operator()(const platform::CUDADeviceContext& ctx,
+                  const framework::Tensor& in, const int bin_cnt,
+                  const int channel_num, framework::Tensor* out_scale,
+                  framework::Tensor* out) {
+    int num = in.numel();
+    const T* in_data = in.data<T>();
+    T* scale_data = out_scale->mutable_data<T>(ctx.GetPlace());
+    T* out_data = out->mutable_data<T>(ctx.GetPlace());
+    if (channel_num > 1) {
+      ChannelQuantDequantKernel<T><<<channel_num, kQuantBlockDim, 0,
+                                     ctx.stream()>>>(
+          in_data, num / channel_num, bin_cnt, scale_data, out_data);
+      return;
+    }
+    FindAbsMaxFunctor<platform::CUDADeviceContext, T>()(ctx, in_data, num,
+                                                        scale_data);
+    ClipAndQuantDequantKernel<T><<<QuantGridDim(ctx, num), kQuantBlockDim, 0,
+                                   ctx.stream()>>>(in_data, scale_data,
+                                                   bin_cnt, num, out_data);
+  }
+};
+
+template struct FakeQuantDequantAbsMaxFunctor<platform::CUDADeviceContext,
+                                              float>;
+
 template <typename T>
 struct ClipAndFakeQuantFunctor<platform::CUDADeviceContext, T> {
   void operator()(const platform::CUDADeviceContext& ctx,
                   const framework::Tensor& in, const framework::Tensor& scale,
                   const int bin_cnt, framework::Tensor* out) {
     int num = in.numel();
-    int block = 1024;
-    int grid = (block - 1 + num) / block;
-
     const T* in_data = in.data<T>();
     const T* scale_data = scale.data<T>();
     T* out_data = out->mutable_data<T>(ctx.GetPlace());
 
-    ClipAndQuantKernel<T><<<grid, block, 0, ctx.stream()>>>(
-        in_data, scale_data, bin_cnt, num, out_data);
+    ClipAndQuantKernel<T><<<QuantGridDim(ctx, num), kQuantBlockDim, 0,
+                            ctx.stream()>>>(in_data, scale_data, bin_cnt, num,
+                                            out_data);
   }
 };
 
@@ -176,3 +243,5 @@ REGISTER_OP_CUDA_KERNEL(fake_quantize_abs_max,
                         ops::FakeQuantizeAbsMaxKernel<CUDA, float>);
 REGISTER_OP_CUDA_KERNEL(fake_quantize_range_abs_max,
                         ops::FakeQuantizeRangeAbsMaxKernel<CUDA, float>);
+REGISTER_OP_CUDA_KERNEL(fake_quantize_dequantize_abs_max,
+                        ops::FakeQuantizeDequantizeAbsMaxKernel<CUDA, float>);
@@ -14,10 +14,12 @@ limitations under the License. */
 
 #pragma once
 
+#include <cmath>
 #include <string>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/platform/hostdevice.h"
 
 namespace paddle {
 namespace operators {
@@ -42,6 +44,26 @@ struct FindRangeAbsMaxFunctor {
                   framework::Tensor* scales_arr, framework::Tensor* out_scale);
 };
 
+// Quantizes x by the scale s and dequantizes it back, where quant is
+// bin_cnt / s and dequant is s / bin_cnt, which are 0 if s is 0.
+template <typename T>
+HOSTDEVICE inline T ClipAndQuantDequant(T x, T s, T quant, T dequant) {
+  T v = x > s ? s : x;
+  v = v < -s ? -s : v;
+  return round(v * quant) * dequant;
+}
+
+// Out = round(clip(in) / scale * bin_cnt) * scale / bin_cnt in one pass,
+// where in is split into channel_num channels along its first dimension,
+// and the scale of a channel is its abs max. The scales are written to
+// out_scale, which stays in the memory of the device.
+template <typename DeviceContext, typename T>
+struct FakeQuantDequantAbsMaxFunctor {
+  void operator()(const DeviceContext& ctx, const framework::Tensor& in,
+                  const int bin_cnt, const int channel_num,
+                  framework::Tensor* out_scale, framework::Tensor* out);
+};
+
 template <typename DeviceContext, typename T>
 class FakeQuantizeAbsMaxKernel : public framework::OpKernel<T> {
  public:
@@ -105,5 +127,24 @@ class FakeQuantizeRangeAbsMaxKernel : public framework::OpKernel<T> {
   }
 };
 
+template <typename DeviceContext, typename T>
+class FakeQuantizeDequantizeAbsMaxKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    auto* in = context.Input<framework::Tensor>("X");
+    auto* out = context.Output<framework::Tensor>("Out");
+    auto* out_scale = context.Output<framework::Tensor>("OutScale");
+
+    int bit_length = context.Attr<int>("bit_length");
+    int bin_cnt = std::pow(2, bit_length - 1) - 1;
+    int channel_num =
+        context.Attr<bool>("channel_wise") ? in->dims()[0] : 1;
+
+    auto& dev_ctx = context.template device_context<DeviceContext>();
+    FakeQuantDequantAbsMaxFunctor<DeviceContext, T>()(
+        dev_ctx, *in, bin_cnt, channel_num, out_scale, out);
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
@@ -0,0 +1,162 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/fused/fused_elementwise_add_layernorm_op.h"
+#include "paddle/fluid/operators/jit/kernels.h"
+
+namespace paddle {
+namespace operators {
+
+void FusedElementwiseAddLayerNormOp::InferShape(
+    framework::InferShapeContext* ctx) const {
+  PADDLE_ENFORCE(
+      ctx->HasInput("X"),
+      "Input(X) of FusedElementwiseAddLayerNormOp should not be null.");
+  PADDLE_ENFORCE(
+      ctx->HasInput("Y"),
+      "Input(Y) of FusedElementwiseAddLayerNormOp should not be null.");
+  PADDLE_ENFORCE(
+      ctx->HasOutput("Out"),
+      "Output(Out) of FusedElementwiseAddLayerNormOp should not be null.");
+
+  auto x_dims = ctx->GetInputDim("X");
+  auto y_dims = ctx->GetInputDim("Y");
+  PADDLE_ENFORCE_EQ(x_dims, y_dims,
+                    "Input(X) and Input(Y) should have the same shape.");
+  auto begin_norm_axis = ctx->Attrs().Get<int>("begin_norm_axis");
+  PADDLE_ENFORCE_LT(begin_norm_axis, x_dims.size(),
+                    "'begin_norm_axis' must be less than the rank of X.");
+
+  auto matrix_dim = framework::flatten_to_2d(x_dims, begin_norm_axis);
+  int right = static_cast<int>(matrix_dim[1]);
+  if (ctx->HasInput("Scale")) {
+    PADDLE_ENFORCE_EQ(ctx->GetInputDim("Scale").size(), 1UL);
+    PADDLE_ENFORCE_EQ(ctx->GetInputDim("Scale")[0], right);
+  }
+  if (ctx->HasInput("Bias")) {
+    PADDLE_ENFORCE_EQ(ctx->GetInputDim("Bias").size(), 1UL);
+    PADDLE_ENFORCE_EQ(ctx->GetInputDim("Bias")[0], right);
+  }
+
+  ctx->SetOutputDim("Out", x_dims);
+  ctx->ShareLoD("X", /*->*/ "Out");
+  if (ctx->HasOutput("SumOut")) {
+    ctx->SetOutputDim("SumOut", x_dims);
+    ctx->ShareLoD("X", /*->*/ "SumOut");
+  }
+}
+
+framework::OpKernelType FusedElementwiseAddLayerNormOp::GetExpectedKernelType(
+    const framework::ExecutionContext& ctx) const {
+  return framework::OpKernelType(ctx.Input<Tensor>("X")->type(),
+                                 ctx.GetPlace());
+}
+
+void FusedElementwiseAddLayerNormOpMaker::Make() {
+  AddInput("X", "(Tensor) The first input of elementwise_add.");
+  AddInput("Y", "(Tensor) The second input of elementwise_add, which has "
+                "the same shape as X.");
+  AddInput("Scale",
+           "(optional) Scale is a 1-dimensional tensor of size "
+           "H(`begin_norm_axis` splits X to a matrix [N,H]).")
+      .AsDispensable();
+  AddInput("Bias",
+           "(optional) Bias is a 1-dimensional tensor of size "
+           "H(`begin_norm_axis` splits X to a matrix [N,H]).")
+      .AsDispensable();
+  AddOutput("Out", "(Tensor) The result of layer_norm(X + Y).");
+  AddOutput("SumOut",
+            "(optional) The result of X + Y, only needed if it is used by "
+            "other operators.")
+      .AsDispensable();
+  AddAttr<float>("epsilon",
+                 "Constant for numerical stability [default 1e-5].")
+      .SetDefault(1e-5);
+  AddAttr<int>("begin_norm_axis",
+               "the axis of `begin_norm_axis ... Rank(X) - 1` will be "
+               "normalized. [default 1].")
+      .SetDefault(1)
+      .AddCustomChecker([](const int& begin_norm_axis) {
+        PADDLE_ENFORCE_GT(begin_norm_axis, 0,
+                          "'begin_norm_axis' should be greater than zero.");
+      });
+  AddComment(R"DOC(
+Fused elementwise_add and layer_norm for inference.
+
+    SumOut = X + Y
+    Out = layer_norm(SumOut, Scale, Bias)
+
+It is the residual connection and normalization of the sublayers of
+Transformer. Each row of X + Y is normalized while it is computed, so that
+the sum is not written to and read back from memory, unless SumOut is
+required.
+)DOC");
+}
+
+template <typename T>
+class FusedElementwiseAddLayerNormKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* x = ctx.Input<Tensor>("X");
+    auto* y = ctx.Input<Tensor>("Y");
+    auto* scale = ctx.Input<Tensor>("Scale");
+    auto* bias = ctx.Input<Tensor>("Bias");
+    auto* out = ctx.Output<Tensor>("Out");
+    auto* sum_out = ctx.Output<Tensor>("SumOut");
+    const float epsilon = ctx.Attr<float>("epsilon");
+    const int begin_norm_axis = ctx.Attr<int>("begin_norm_axis");
+
+    auto matrix_dim = framework::flatten_to_2d(x->dims(), begin_norm_axis);
+    const int left = static_cast<int>(matrix_dim[0]);
+    const int right = static_cast<int>(matrix_dim[1]);
+
+    const T* x_data = x->data<T>();
+    const T* y_data = y->data<T>();
+    const T* scale_data = scale ? scale->data<T>() : nullptr;
+    const T* bias_data = bias ? bias->data<T>() : nullptr;
+    T* out_data = out->mutable_data<T>(ctx.GetPlace());
+    // Without SumOut, only one row of the sum is kept, which stays in cache
+    // until it is normalized.
+    Tensor sum_row;
+    T* sum_data = sum_out ? sum_out->mutable_data<T>(ctx.GetPlace())
+                          : sum_row.mutable_data<T>({right}, ctx.GetPlace());
+    const int sum_stride = sum_out ? right : 0;
+
+    auto vadd = jit::Get<jit::kVAdd, jit::XYZNTuples<T>, platform::CPUPlace>(
+        right);
+    auto layer_norm =
+        jit::Get<jit::kLayerNorm, jit::LayerNormTuples<T>, platform::CPUPlace>(
+            right);
+    T mean, var;
+    for (int i = 0; i < left; ++i) {
+      T* sum = sum_data + i * sum_stride;
+      vadd(x_data + i * right, y_data + i * right, sum, right);
+      layer_norm(sum, out_data + i * right, &mean, &var, scale_data,
+                 bias_data, 1, epsilon, right);
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(fused_elementwise_add_layernorm,
+                  ops::FusedElementwiseAddLayerNormOp,
+                  ops::FusedElementwiseAddLayerNormOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+
+REGISTER_OP_CPU_KERNEL(fused_elementwise_add_layernorm,
+                       ops::FusedElementwiseAddLayerNormKernel<float>,
+                       ops::FusedElementwiseAddLayerNormKernel<double>);
@@ -0,0 +1,90 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include "paddle/fluid/operators/fused/fused_elementwise_add_layernorm_op.h"
+#include "paddle/fluid/operators/norm_utils.cu.h"
+
+namespace paddle {
+namespace operators {
+
+// Each block normalizes one row of x + y. The mean and variance are computed
+// in a single pass by the Welford algorithm, and reduced by the warp
+// shuffles of WelfordBlockReduce.
+template <typename T>
+__global__ void FusedElementwiseAddLayerNormKernel(
+    const T* x, const T* y, const T* scale, const T* bias, T* out, T* sum_out,
+    float epsilon, int feature_size) {
+  const int64_t offset = static_cast<int64_t>(blockIdx.x) * feature_size;
+  x += offset;
+  y += offset;
+  out += offset;
+  if (sum_out) sum_out += offset;
+
+  WelfordData<T> data = {0, 0, 0};
+  for (int i = threadIdx.x; i < feature_size; i += blockDim.x) {
+    T val = x[i] + y[i];
+    if (sum_out) sum_out[i] = val;
+    WelfordUpdate(val, &data);
+  }
+  data = WelfordBlockReduce(data);
+
+  T mean = data.mean;
+  T rstd = NormRsqrt(data.m2 / feature_size + static_cast<T>(epsilon));
+  for (int i = threadIdx.x; i < feature_size; i += blockDim.x) {
+    T val = sum_out ? sum_out[i] : x[i] + y[i];
+    val = (val - mean) * rstd;
+    if (scale) val *= scale[i];
+    if (bias) val += bias[i];
+    out[i] = val;
+  }
+}
+
+template <typename T>
+class FusedElementwiseAddLayerNormCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* x = ctx.Input<Tensor>("X");
+    auto* y = ctx.Input<Tensor>("Y");
+    auto* scale = ctx.Input<Tensor>("Scale");
+    auto* bias = ctx.Input<Tensor>("Bias");
+    auto* out = ctx.Output<Tensor>("Out");
+    auto* sum_out = ctx.Output<Tensor>("SumOut");
+    const float epsilon = ctx.Attr<float>("epsilon");
+    const int begin_norm_axis = ctx.Attr<int>("begin_norm_axis");
+
+    auto matrix_dim = framework::flatten_to_2d(x->dims(), begin_norm_axis);
+    const int left = static_cast<int>(matrix_dim[0]);
+    const int right = static_cast<int>(matrix_dim[1]);
+
+    const T* scale_data = scale ? scale->data<T>() : nullptr;
+    const T* bias_data = bias ? bias->data<T>() : nullptr;
+    T* out_data = out->mutable_data<T>(ctx.GetPlace());
+    T* sum_data = sum_out ? sum_out->mutable_data<T>(ctx.GetPlace()) : nullptr;
+
+    auto stream = ctx.cuda_device_context().stream();
+    FusedElementwiseAddLayerNormKernel<T><<<left, NormBlockDim(right), 0,
+                                            stream>>>(
+        x->data<T>(), y->data<T>(), scale_data, bias_data, out_data, sum_data,
+        epsilon, right);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(fused_elementwise_add_layernorm,
+                        ops::FusedElementwiseAddLayerNormCUDAKernel<float>,
+                        ops::FusedElementwiseAddLayerNormCUDAKernel<double>);
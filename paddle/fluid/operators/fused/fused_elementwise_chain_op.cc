@@ -0,0 +1,229 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/fused/fused_elementwise_chain_op.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/operators/elementwise/elementwise_op_function.h"
+
+namespace paddle {
+namespace operators {
+
+using framework::proto::VarType;
+
+static ChainStepType ChainStepTypeOf(const std::string& functor) {
+  static const std::unordered_map<std::string, ChainStepType> kTypes = {
+      {"relu", kChainRelu},
+      {"sigmoid", kChainSigmoid},
+      {"tanh", kChainTanh},
+      {"scale", kChainScale},
+      {"cast", kChainRoundHalf},
+      {"elementwise_add", kChainAdd},
+      {"elementwise_sub", kChainSub},
+      {"elementwise_mul", kChainMul},
+      {"elementwise_div", kChainDiv}};
+  auto it = kTypes.find(functor);
+  PADDLE_ENFORCE(it != kTypes.end(),
+                 "%s is not supported by fused_elementwise_chain.", functor);
+  return it->second;
+}
+
+static bool IsHalfOrFloat(VarType::Type type) {
+  return type == VarType::FP16 || type == VarType::FP32;
+}
+
+void BuildChainProgram(const framework::ExecutionContext& ctx,
+                       ChainProgram* program) {
+  auto& functors = ctx.Attr<std::vector<std::string>>("functor_list");
+  auto& alpha = ctx.Attr<std::vector<float>>("alpha");
+  auto& beta = ctx.Attr<std::vector<float>>("beta");
+  auto& axis = ctx.Attr<std::vector<int>>("axis");
+  auto& cast_dtype = ctx.Attr<std::vector<int>>("cast_dtype");
+  auto ys = ctx.MultiInput<Tensor>("Y");
+  auto x_dims = ctx.Input<Tensor>("X")->dims();
+  int num_steps = functors.size();
+  PADDLE_ENFORCE_LE(num_steps, kMaxChainSteps);
+  PADDLE_ENFORCE_LE(ys.size(), static_cast<size_t>(kMaxChainInputs));
+
+  program->num_steps = 0;
+  program->num_inputs = 0;
+  for (int s = 0; s < num_steps; ++s) {
+    ChainStepType type = ChainStepTypeOf(functors[s]);
+    int k = program->num_steps;
+    if (type == kChainRoundHalf) {
+      auto dtype = static_cast<VarType::Type>(cast_dtype.at(s));
+      PADDLE_ENFORCE(IsHalfOrFloat(dtype),
+                     "The casts of fused_elementwise_chain are to float16 "
+                     "or float32.");
+      // The chain is evaluated in float32.
+      if (dtype == VarType::FP32) continue;
+    } else if (type == kChainScale) {
+      program->alpha[k] = alpha.at(s);
+      program->beta[k] = beta.at(s);
+    } else if (type >= kChainAdd) {
+      int i = program->num_inputs++;
+      PADDLE_ENFORCE_LT(i, static_cast<int>(ys.size()),
+                        "The binary steps need an Input(Y) each.");
+      auto* y = ys[i];
+      PADDLE_ENFORCE(IsHalfOrFloat(y->type()),
+                     "The Input(Y) of fused_elementwise_chain should be "
+                     "float16 or float32.");
+      auto y_dims = trim_trailing_singular_dims(y->dims());
+      int y_axis = axis.at(s) == -1 ? x_dims.size() - y->dims().size()
+                                    : axis.at(s);
+      int pre, n, post;
+      get_mid_dims(x_dims, y_dims, y_axis, &pre, &n, &post);
+      auto& input = program->inputs[i];
+      input.data = y->data<void>();
+      input.is_half = y->type() == VarType::FP16;
+      input.n = n;
+      input.post = post;
+      program->input[k] = i;
+    }
+    program->type[k] = type;
+    ++program->num_steps;
+  }
+  PADDLE_ENFORCE_EQ(program->num_inputs, static_cast<int>(ys.size()),
+                    "Every Input(Y) should be used by a binary step.");
+}
+
+class FusedElementwiseChainOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("X"),
+                   "Input(X) of FusedElementwiseChainOp should not be null.");
+    PADDLE_ENFORCE(
+        ctx->HasOutput("Out"),
+        "Output(Out) of FusedElementwiseChainOp should not be null.");
+    auto& functors =
+        ctx->Attrs().Get<std::vector<std::string>>("functor_list");
+    PADDLE_ENFORCE(!functors.empty(), "The chain should not be empty.");
+    for (auto& attr : {"alpha", "beta"}) {
+      PADDLE_ENFORCE_EQ(
+          ctx->Attrs().Get<std::vector<float>>(attr).size(), functors.size(),
+          "The attribute %s should have a value a step.", attr);
+    }
+    for (auto& attr : {"axis", "cast_dtype"}) {
+      PADDLE_ENFORCE_EQ(
+          ctx->Attrs().Get<std::vector<int>>(attr).size(), functors.size(),
+          "The attribute %s should have a value a step.", attr);
+    }
+    ctx->SetOutputDim("Out", ctx->GetInputDim("X"));
+    ctx->ShareLoD("X", /*->*/ "Out");
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(ctx.Input<Tensor>("X")->type(),
+                                   ctx.GetPlace());
+  }
+};
+
+class FusedElementwiseChainOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("X", "(Tensor) The float16 or float32 input of the chain.");
+    AddInput("Y",
+             "(Tensors) The float16 or float32 second inputs of the binary "
+             "steps, in the order of the steps, which are broadcast to X "
+             "as the elementwise ops do.")
+        .AsDuplicable()
+        .AsDispensable();
+    AddOutput("Out", "(Tensor) The result of the chain, of the shape of X.");
+    AddAttr<std::vector<std::string>>(
+        "functor_list",
+        "The steps of the chain, which are relu, sigmoid, tanh, scale, cast, "
+        "elementwise_add, elementwise_sub, elementwise_mul and "
+        "elementwise_div.");
+    AddAttr<std::vector<float>>("alpha",
+                                "The alpha * x + beta of the scale steps.");
+    AddAttr<std::vector<float>>("beta",
+                                "The alpha * x + beta of the scale steps.");
+    AddAttr<std::vector<int>>("axis", "The axis of the binary steps.");
+    AddAttr<std::vector<int>>("cast_dtype",
+                              "The out_dtype of the cast steps.");
+    AddAttr<int>("out_dtype", "The data type of Out.");
+    AddComment(R"DOC(
+FusedElementwiseChain Operator.
+
+Computes a chain of elementwise unary, cast and binary ops on X in one pass:
+every element of X is read once, the steps are applied to it in float32, and
+the result is written to Out once, instead of writing and reading an
+intermediate tensor between every two ops of the chain. A cast to float16 in
+the chain rounds the value to float16, and a binary step reads its Y with the
+broadcast of the elementwise ops. The chains are built by
+fuse_elementwise_chain_pass.
+)DOC");
+  }
+};
+
+class FusedElementwiseChainOpVarTypeInference
+    : public framework::VarTypeInference {
+ public:
+  void operator()(const framework::OpDesc& op_desc,
+                  framework::BlockDesc* block) const override {
+    auto data_type = static_cast<VarType::Type>(
+        boost::get<int>(op_desc.GetAttr("out_dtype")));
+    auto& out_var_name = op_desc.Output("Out").front();
+    block->Var(out_var_name)->SetDataType(data_type);
+  }
+};
+
+template <typename InT, typename OutT>
+static void ComputeChain(const InT* x, OutT* out, int64_t numel,
+                         const ChainProgram& program) {
+  for (int64_t i = 0; i < numel; ++i) {
+    out[i] = static_cast<OutT>(
+        EvaluateChain(program, static_cast<float>(x[i]), i));
+  }
+}
+
+template <typename T>
+class FusedElementwiseChainKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* x = ctx.Input<Tensor>("X");
+    auto* out = ctx.Output<Tensor>("Out");
+    ChainProgram program;
+    BuildChainProgram(ctx, &program);
+    auto out_dtype = static_cast<VarType::Type>(ctx.Attr<int>("out_dtype"));
+    if (out_dtype == VarType::FP16) {
+      ComputeChain(x->data<T>(),
+                   out->mutable_data<platform::float16>(ctx.GetPlace()),
+                   x->numel(), program);
+    } else {
+      PADDLE_ENFORCE(out_dtype == VarType::FP32,
+                     "The Out of fused_elementwise_chain should be float16 "
+                     "or float32.");
+      ComputeChain(x->data<T>(), out->mutable_data<float>(ctx.GetPlace()),
+                   x->numel(), program);
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(fused_elementwise_chain, ops::FusedElementwiseChainOp,
+                  ops::FusedElementwiseChainOpMaker,
+                  ops::FusedElementwiseChainOpVarTypeInference,
+                  paddle::framework::EmptyGradOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    fused_elementwise_chain, ops::FusedElementwiseChainKernel<float>,
+    ops::FusedElementwiseChainKernel<paddle::platform::float16>);
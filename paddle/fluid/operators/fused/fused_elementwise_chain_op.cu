@@ -0,0 +1,76 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include "paddle/fluid/operators/fused/fused_elementwise_chain_op.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+
+using framework::proto::VarType;
+
+// The program is in the parameter space of the kernel, so that the steps
+// are read as the constants of all the threads. The step types are uniform
+// across the warps, and the switch of EvaluateChain does not diverge.
+template <typename InT, typename OutT>
+__global__ void FusedElementwiseChainKernel(const InT* x, OutT* out,
+                                            int64_t numel,
+                                            ChainProgram program) {
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < numel;
+       i += blockDim.x * gridDim.x) {
+    out[i] = static_cast<OutT>(
+        EvaluateChain(program, static_cast<float>(x[i]), i));
+  }
+}
+
+template <typename T>
+class FusedElementwiseChainCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* x = ctx.Input<Tensor>("X");
+    auto* out = ctx.Output<Tensor>("Out");
+    ChainProgram program;
+    BuildChainProgram(ctx, &program);
+    int64_t numel = x->numel();
+    if (numel == 0) return;
+
+    auto& dev_ctx = ctx.cuda_device_context();
+    int block = PADDLE_CUDA_NUM_THREADS;
+    int64_t max_grid = std::max(dev_ctx.GetMaxPhysicalThreadCount() / block, 1);
+    int grid = static_cast<int>(
+        std::min<int64_t>((numel + block - 1) / block, max_grid));
+    auto out_dtype = static_cast<VarType::Type>(ctx.Attr<int>("out_dtype"));
+    if (out_dtype == VarType::FP16) {
+      FusedElementwiseChainKernel<<<grid, block, 0, dev_ctx.stream()>>>(
+          x->data<T>(), out->mutable_data<platform::float16>(ctx.GetPlace()),
+          numel, program);
+    } else {
+      PADDLE_ENFORCE(out_dtype == VarType::FP32,
+                     "The Out of fused_elementwise_chain should be float16 "
+                     "or float32.");
+      FusedElementwiseChainKernel<<<grid, block, 0, dev_ctx.stream()>>>(
+          x->data<T>(), out->mutable_data<float>(ctx.GetPlace()), numel,
+          program);
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(
+    fused_elementwise_chain, ops::FusedElementwiseChainCUDAKernel<float>,
+    ops::FusedElementwiseChainCUDAKernel<paddle::platform::float16>);
@@ -0,0 +1,119 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <cmath>
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/platform/float16.h"
+#include "paddle/fluid/platform/hostdevice.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+
+// The chains longer than these are left unfused by the fuse pass.
+constexpr int kMaxChainSteps = 16;
+constexpr int kMaxChainInputs = 8;
+
+enum ChainStepType {
+  kChainRelu = 0,
+  kChainSigmoid,
+  kChainTanh,
+  // alpha * x + beta.
+  kChainScale,
+  // The rounding of a cast to float16, the casts to float32 are dropped.
+  kChainRoundHalf,
+  kChainAdd,
+  kChainSub,
+  kChainMul,
+  kChainDiv,
+};
+
+// A Y of the binary steps, which is broadcast to X as the elementwise ops
+// do: the element i of X reads the element (i / post) % n of Y.
+struct ChainInput {
+  const void* data;
+  bool is_half;
+  int64_t n;
+  int64_t post;
+};
+
+// The steps of a chain, which are decoded from the functor_list once a run
+// and passed by value to the kernels. The kernels evaluate the steps for
+// every element in registers, so that the chain reads X and the Ys and
+// writes Out once, whatever its length is.
+struct ChainProgram {
+  int num_steps;
+  int type[kMaxChainSteps];
+  float alpha[kMaxChainSteps];
+  float beta[kMaxChainSteps];
+  int input[kMaxChainSteps];
+  int num_inputs;
+  ChainInput inputs[kMaxChainInputs];
+};
+
+HOSTDEVICE inline float ChainLoad(const ChainInput& input, int64_t i) {
+  int64_t j = (i / input.post) % input.n;
+  return input.is_half
+             ? static_cast<float>(
+                   reinterpret_cast<const platform::float16*>(input.data)[j])
+             : reinterpret_cast<const float*>(input.data)[j];
+}
+
+HOSTDEVICE inline float EvaluateChain(const ChainProgram& program, float v,
+                                      int64_t i) {
+  for (int s = 0; s < program.num_steps; ++s) {
+    switch (program.type[s]) {
+      case kChainRelu:
+        v = v > 0.f ? v : 0.f;
+        break;
+      case kChainSigmoid:
+        v = 1.f / (1.f + expf(-v));
+        break;
+      case kChainTanh:
+        v = tanhf(v);
+        break;
+      case kChainScale:
+        v = program.alpha[s] * v + program.beta[s];
+        break;
+      case kChainRoundHalf:
+        v = static_cast<float>(static_cast<platform::float16>(v));
+        break;
+      case kChainAdd:
+        v += ChainLoad(program.inputs[program.input[s]], i);
+        break;
+      case kChainSub:
+        v -= ChainLoad(program.inputs[program.input[s]], i);
+        break;
+      case kChainMul:
+        v *= ChainLoad(program.inputs[program.input[s]], i);
+        break;
+      case kChainDiv:
+        v /= ChainLoad(program.inputs[program.input[s]], i);
+        break;
+    }
+  }
+  return v;
+}
+
+// Decodes the attributes of the op into the program, with the broadcasts
+// of the Ys to X.
+void BuildChainProgram(const framework::ExecutionContext& ctx,
+                       ChainProgram* program);
+
+}  // namespace operators
+}  // namespace paddle
@@ -39,8 +39,14 @@ class FusedEmbeddingSeqPoolOp : public framework::OperatorWithKernel {
                       "The dim size of the 'Ids' tensor must greater than 1.");
     PADDLE_ENFORCE_EQ(ids_dims[ids_dims.size() - 1], 1,
                       "The last dimension of the 'Ids' tensor must be 1.");
-    // we only support sum now
-    PADDLE_ENFORCE_EQ(combiner, "sum");
+    PADDLE_ENFORCE(combiner == "sum" || combiner == "mean",
+                   "The combiner should be sum or mean.");
+    if (ctx->HasInput("WScaleBias")) {
+      auto scale_bias_dims = ctx->GetInputDim("WScaleBias");
+      PADDLE_ENFORCE_EQ(scale_bias_dims.size(), 2);
+      PADDLE_ENFORCE_EQ(scale_bias_dims[1], 2,
+                        "WScaleBias should be [N, 2] of the table [N, D].");
+    }
 
     int64_t last_dim = table_dims[1];
     for (int i = 1; i != ids_dims.size(); ++i) {
@@ -77,7 +83,7 @@ class FusedEmbeddingSeqPoolOp : public framework::OperatorWithKernel {
  protected:
   framework::OpKernelType GetExpectedKernelType(
       const framework::ExecutionContext& ctx) const override {
-    auto data_type = framework::GetDataTypeOfVar(ctx.InputVar("W"));
+    auto data_type = math::LookupDataType(ctx.InputVar("W"));
     return framework::OpKernelType(data_type, ctx.device_context());
   }
 };
@@ -92,12 +98,19 @@ class FusedEmbeddingSeqPoolOpMaker : public framework::OpProtoAndCheckerMaker {
              "An input with type int32 or int64 "
              "contains the ids to be looked up in W. "
              "The last dimension size must be 1.");
-    AddOutput("Out", "The lookup results, which have the same type as W.");
+    AddInput("WScaleBias",
+             "(Tensor, optional) The float [N, 2] scale and bias of the rows "
+             "of the uint8 W, whose row i is W[i] * scale[i] + bias[i].")
+        .AsDispensable();
+    AddOutput("Out",
+              "The lookup results, which have the same type as W, or float "
+              "if W is a float16 or uint8 quantized table.");
     AddAttr<std::string>("combiner",
                          "(string, default sum) "
                          "A string specifying the reduction op. Currently sum "
-                         "are supported, sum computes the weighted sum of the "
-                         "embedding results for each row.")
+                         "and mean are supported, sum computes the sum of the "
+                         "embedding results for each row, and mean computes "
+                         "the average of them.")
         .SetDefault("sum");
     // NOTE(minqiyang): grad_inplace is an temporal attribute,
     // please do NOT set this attribute in python layer.
@@ -121,6 +134,10 @@ and concatenated into a dense tensor.
 The input Ids should carry the LoD (Level of Details) information.
 And the output will change the LoD information with input Ids.
 
+W can be a quantized table of an inference model, float16, or uint8 with
+the scale and the bias of every row in WScaleBias; the looked up rows are
+dequantized into float while they are pooled.
+
 )DOC");
   }
 };
@@ -148,7 +165,7 @@ class FusedEmbeddingSeqPoolOpGrad : public framework::OperatorWithKernel {
  protected:
   framework::OpKernelType GetExpectedKernelType(
       const framework::ExecutionContext& ctx) const override {
-    auto data_type = framework::GetDataTypeOfVar(ctx.InputVar("W"));
+    auto data_type = math::LookupDataType(ctx.InputVar("W"));
     return framework::OpKernelType(data_type, ctx.device_context());
   }
 };
@@ -0,0 +1,205 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <string>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/memory/memory.h"
+#include "paddle/fluid/operators/fused/fused_embedding_seq_pool_op.h"
+#include "paddle/fluid/platform/assert.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+
+// Every warp (threadIdx.y) pools the embeddings of the slot j of the
+// sequence i into the output row i, reading the rows of the table directly,
+// so that the [N, D] lookup result is never stored. The table is read by a
+// math::QuantizedTableReader, which dequantizes the quantized tables.
+template <typename T, typename Reader, int BlockDimX, int BlockDimY>
+__global__ void FusedEmbeddingSeqPool(T *output, const Reader table,
+                                      const int64_t *ids, const size_t *lod,
+                                      const int64_t batch_size,
+                                      const int64_t ids_count,
+                                      const int64_t row_number,
+                                      const int64_t row_width, bool mean) {
+  int64_t idy = blockIdx.x * BlockDimY + threadIdx.y;
+  while (idy < batch_size * ids_count) {
+    int64_t i = idy / ids_count;
+    int64_t j = idy % ids_count;
+    size_t begin = lod[i];
+    size_t end = lod[i + 1];
+    T *out = output + idy * row_width;
+    for (int64_t d = threadIdx.x; d < row_width; d += BlockDimX) {
+      T sum = static_cast<T>(0);
+      for (size_t r = begin; r < end; ++r) {
+        int64_t id = ids[r * ids_count + j];
+        PADDLE_ASSERT_MSG_CODE(id >= 0, "received id:", id);
+        PADDLE_ASSERT_MSG_CODE(id < row_number, "received id:", id);
+        sum += table(id, d);
+      }
+      out[d] = (mean && end > begin) ? sum / static_cast<T>(end - begin) : sum;
+    }
+    idy += gridDim.x * BlockDimY;
+  }
+}
+
+// Every warp writes the gradient of the looked up row k, which is the
+// gradient of the output row of its sequence, scaled by 1 / length if mean.
+template <typename T, int BlockDimX, int BlockDimY>
+__global__ void FusedEmbeddingSeqPoolGrad(T *d_table, const T *d_output,
+                                          const size_t *lod,
+                                          const int64_t batch_size,
+                                          const int64_t ids_count,
+                                          const int64_t ids_num,
+                                          const int64_t row_width, bool mean) {
+  int64_t idy = blockIdx.x * BlockDimY + threadIdx.y;
+  while (idy < ids_num) {
+    int64_t r = idy / ids_count;
+    // The sequence i which has lod[i] <= r < lod[i + 1].
+    int64_t low = 0, high = batch_size;
+    while (high - low > 1) {
+      int64_t mid = (low + high) / 2;
+      if (lod[mid] <= r) {
+        low = mid;
+      } else {
+        high = mid;
+      }
+    }
+    T scale = mean ? static_cast<T>(1.) / static_cast<T>(lod[low + 1] -
+                                                         lod[low])
+                   : static_cast<T>(1.);
+    const T *d_out = d_output + (low * ids_count + idy % ids_count) * row_width;
+    T *d_tab = d_table + idy * row_width;
+    for (int64_t d = threadIdx.x; d < row_width; d += BlockDimX) {
+      d_tab[d] = d_out[d] * scale;
+    }
+    idy += gridDim.x * BlockDimY;
+  }
+}
+
+template <typename T>
+struct FusedEmbeddingSeqPoolLauncher {
+  template <typename Reader>
+  void operator()(const Reader &table) const {
+    dim3 threads(32, 8);
+    int grids = static_cast<int>(
+        std::min<int64_t>((batch_size * ids_count + 7) / 8, 4096));
+    FusedEmbeddingSeqPool<T, Reader, 32,
+                          8><<<grids, threads, 0, dev_ctx.stream()>>>(
+        output, table, ids, lod, batch_size, ids_count, row_number, row_width,
+        mean);
+  }
+
+  const platform::CUDADeviceContext &dev_ctx;
+  T *output;
+  const int64_t *ids;
+  const size_t *lod;
+  int64_t batch_size;
+  int64_t ids_count;
+  int64_t row_number;
+  int64_t row_width;
+  bool mean;
+};
+
+template <typename T>
+class FusedEmbeddingSeqPoolCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto *ids_t = context.Input<LoDTensor>("Ids");
+    auto *output_t = context.Output<LoDTensor>("Out");
+    auto *table_t = context.Input<LoDTensor>("W");
+    const std::string &combiner_type = context.Attr<std::string>("combiner");
+
+    int64_t row_number = table_t->dims()[0];
+    int64_t row_width = table_t->dims()[1];
+    auto &ids_lod = ids_t->lod()[0];
+    int64_t batch_size = static_cast<int64_t>(ids_lod.size()) - 1;
+    int64_t ids_count = ids_t->numel() / ids_lod.back();
+
+    auto *output = output_t->mutable_data<T>(context.GetPlace());
+    if (batch_size * ids_count == 0) return;
+
+    auto &dev_ctx =
+        context.template device_context<platform::CUDADeviceContext>();
+    const size_t *lod = ids_lod.CUDAData(context.GetPlace());
+    FusedEmbeddingSeqPoolLauncher<T> launcher{
+        dev_ctx, output, ids_t->data<int64_t>(), lod, batch_size, ids_count,
+        row_number, row_width, combiner_type == "mean"};
+    if (math::IsQuantizedTable(*table_t)) {
+      math::VisitQuantizedTable<T>(
+          *table_t, context.Input<LoDTensor>("WScaleBias"), launcher);
+    } else {
+      launcher(math::QuantizedTableReader<T, T>(table_t->data<T>(), nullptr,
+                                                row_width));
+    }
+  }
+};
+
+template <typename T>
+class FusedEmbeddingSeqPoolGradCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    bool is_sparse = context.Attr<bool>("is_sparse");
+    if (!is_sparse) {
+      LOG(ERROR) << "Dense is not supported in fused_embedding_seq_pool_op now";
+      return;
+    }
+
+    auto *ids = context.Input<LoDTensor>("Ids");
+    auto *table = context.Input<LoDTensor>("W");
+    auto *d_output = context.Input<LoDTensor>(framework::GradVarName("Out"));
+    auto *d_table = context.Output<SelectedRows>(framework::GradVarName("W"));
+    auto &dev_ctx =
+        context.template device_context<platform::CUDADeviceContext>();
+
+    auto *ids_data = ids->data<int64_t>();
+    int64_t ids_num = ids->numel();
+    auto &lod = ids->lod()[0];
+    int64_t batch_size = static_cast<int64_t>(lod.size()) - 1;
+    int64_t row_width = table->dims()[1];
+
+    framework::Vector<int64_t> new_rows;
+    new_rows.resize(ids_num);
+    auto gpu_place = boost::get<platform::CUDAPlace>(context.GetPlace());
+    memory::Copy(gpu_place, new_rows.CUDAMutableData(context.GetPlace()),
+                 gpu_place, ids_data, ids_num * sizeof(int64_t),
+                 dev_ctx.stream());
+    d_table->set_rows(new_rows);
+    d_table->set_height(table->dims()[0]);
+
+    auto *d_table_value = d_table->mutable_value();
+    d_table_value->Resize({ids_num, row_width});
+    T *d_table_data = d_table_value->mutable_data<T>(context.GetPlace());
+    if (ids_num == 0) return;
+
+    dim3 threads(32, 8);
+    int grids = static_cast<int>(std::min<int64_t>((ids_num + 7) / 8, 4096));
+    FusedEmbeddingSeqPoolGrad<T, 32, 8><<<grids, threads, 0,
+                                          dev_ctx.stream()>>>(
+        d_table_data, d_output->data<T>(), lod.CUDAData(context.GetPlace()),
+        batch_size, ids_num / lod.back(), ids_num, row_width,
+        context.Attr<std::string>("combiner") == "mean");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(fused_embedding_seq_pool,
+                        ops::FusedEmbeddingSeqPoolCUDAKernel<float>,
+                        ops::FusedEmbeddingSeqPoolCUDAKernel<double>);
+REGISTER_OP_CUDA_KERNEL(fused_embedding_seq_pool_grad,
+                        ops::FusedEmbeddingSeqPoolGradCUDAKernel<float>,
+                        ops::FusedEmbeddingSeqPoolGradCUDAKernel<double>);
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -22,6 +23,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/selected_rows.h"
 #include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/quantized_table.h"
 
 namespace paddle {
 namespace operators {
@@ -35,7 +37,7 @@ template <typename T>
 struct EmbeddingVSumFunctor {
   void operator()(const framework::ExecutionContext &context,
                   const LoDTensor *table_t, const LoDTensor *ids_t,
-                  LoDTensor *output_t) {
+                  LoDTensor *output_t, bool mean = false) {
     auto *table = table_t->data<T>();
     int64_t row_number = table_t->dims()[0];
     int64_t row_width = table_t->dims()[1];
@@ -63,8 +65,49 @@ struct EmbeddingVSumFunctor {
         blas.AXPY(row_width, 1., table + ids[r] * row_width,
                   output + i * last_dim + (r % ids_count) * row_width);
       }
+      if (mean && ids_lod[i + 1] > ids_lod[i]) {
+        blas.SCAL(last_dim, static_cast<T>(1.) / (ids_lod[i + 1] - ids_lod[i]),
+                  output + i * last_dim);
+      }
+    }
+  }
+};
+
+// Pools the rows of a quantized table, dequantizing them while they are
+// summed.
+template <typename T>
+struct QuantizedEmbeddingVSum {
+  template <typename Reader>
+  void operator()(const Reader &reader) const {
+    for (int64_t i = 0; i != static_cast<int64_t>(ids_lod.size()) - 1; ++i) {
+      T *out = output + i * last_dim;
+      std::fill(out, out + last_dim, static_cast<T>(0));
+      for (size_t r = ids_lod[i] * ids_count; r < ids_lod[i + 1] * ids_count;
+           ++r) {
+        PADDLE_ENFORCE_LT(ids[r], row_number);
+        PADDLE_ENFORCE_GE(ids[r], 0, "ids %d", i);
+        T *out_row = out + (r % ids_count) * row_width;
+        for (int64_t d = 0; d < row_width; ++d) {
+          out_row[d] += reader(ids[r], d);
+        }
+      }
+      if (mean && ids_lod[i + 1] > ids_lod[i]) {
+        T scale = static_cast<T>(1.) / (ids_lod[i + 1] - ids_lod[i]);
+        for (int64_t d = 0; d < last_dim; ++d) {
+          out[d] *= scale;
+        }
+      }
     }
   }
+
+  const int64_t *ids;
+  const framework::Vector<size_t> &ids_lod;
+  int64_t ids_count;
+  int64_t row_number;
+  int64_t row_width;
+  int64_t last_dim;
+  bool mean;
+  T *output;
 };
 
 template <typename T>
@@ -76,9 +119,19 @@ class FusedEmbeddingSeqPoolKernel : public framework::OpKernel<T> {
     const LoDTensor *table_var = context.Input<LoDTensor>("W");
     const std::string &combiner_type = context.Attr<std::string>("combiner");
 
-    if (combiner_type == "sum") {
+    if (math::IsQuantizedTable(*table_var)) {
+      auto &ids_lod = ids_t->lod()[0];
+      int64_t row_width = table_var->dims()[1];
+      math::VisitQuantizedTable<T>(
+          *table_var, context.Input<LoDTensor>("WScaleBias"),
+          QuantizedEmbeddingVSum<T>{
+              ids_t->data<int64_t>(), ids_lod, ids_t->numel() / ids_lod.back(),
+              table_var->dims()[0], row_width, output_t->dims()[1],
+              combiner_type == "mean",
+              output_t->mutable_data<T>(context.GetPlace())});
+    } else if (combiner_type == "sum" || combiner_type == "mean") {
       EmbeddingVSumFunctor<T> functor;
-      functor(context, table_var, ids_t, output_t);
+      functor(context, table_var, ids_t, output_t, combiner_type == "mean");
     }
   }
 };
@@ -116,12 +169,14 @@ class FusedEmbeddingSeqPoolGradKernel : public framework::OpKernel<T> {
       framework::Vector<int64_t> *new_rows = d_table->mutable_rows();
       new_rows->resize(ids_num);
       std::memcpy(&(*new_rows)[0], ids_data, ids_num * sizeof(int64_t));
+      d_table->set_height(table_dim[0]);
 
       auto *d_table_value = d_table->mutable_value();
       d_table_value->Resize({ids_num, table_dim[1]});
       T *d_table_data = d_table_value->mutable_data<T>(context.GetPlace());
       const T *d_output_data = d_output->data<T>();
 
+      bool mean = context.Attr<std::string>("combiner") == "mean";
       auto blas = math::GetBlas<platform::CPUDeviceContext, T>(context);
       for (int i = 0; i < static_cast<int>(lod.size()) - 1; ++i) {
         int64_t h = static_cast<int64_t>(lod[i + 1] - lod[i]);
@@ -131,6 +186,9 @@ class FusedEmbeddingSeqPoolGradKernel : public framework::OpKernel<T> {
         for (int r = 0; r != h; ++r) {
           blas.VCOPY(row_width, out_pos, in_pos + r * row_width);
         }
+        if (mean && h > 0) {
+          blas.SCAL(h * row_width, static_cast<T>(1.) / h, in_pos);
+        }
       }
     } else {
       LOG(ERROR) << "Dense is not supported in fused_embedding_seq_pool_op now";
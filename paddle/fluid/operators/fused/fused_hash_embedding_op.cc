@@ -0,0 +1,135 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/fused/fused_hash_embedding_op.h"
+#include <string>
+#include "paddle/fluid/framework/var_type_inference.h"
+
+namespace paddle {
+namespace operators {
+
+class FusedHashEmbeddingOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("X"),
+                   "Input(X) of FusedHashEmbeddingOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasInput("W"),
+                   "Input(W) of FusedHashEmbeddingOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("Out"),
+                   "Output(Out) of FusedHashEmbeddingOp should not be null.");
+    auto dims = ctx->GetInputDim("X");
+    PADDLE_ENFORCE_EQ(dims.size(), 2UL,
+                      "The input of fused_hash_embedding must be 2-D.");
+    auto table_dims = ctx->GetInputDim("W");
+    PADDLE_ENFORCE_EQ(table_dims.size(), 2UL);
+    int num_hash = ctx->Attrs().Get<int>("num_hash");
+    ctx->SetOutputDim("Out",
+                      framework::make_ddim({dims[0], num_hash, table_dims[1]}));
+    ctx->ShareLoD("X", /*->*/ "Out");
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(ctx.Input<LoDTensor>("W")->type(),
+                                   ctx.device_context());
+  }
+};
+
+class FusedHashEmbeddingOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("X", "(LoDTensor) The int32 or int64 [N, M] input of the hash.");
+    AddInput("W", "(Tensor) The embedding table [H, D], H >= mod_by.");
+    AddOutput("Out", "(LoDTensor) The looked up rows [N, num_hash, D].");
+    AddAttr<int>("num_hash", "The times of the hash of a row.").SetDefault(1);
+    AddAttr<int>("mod_by", "The ids are the hashes % mod_by.")
+        .SetDefault(100000);
+    AddAttr<bool>("is_sparse",
+                  "(boolean) Whether the gradient of W is SelectedRows.")
+        .SetDefault(false);
+    AddComment(R"DOC(
+FusedHashEmbedding Operator.
+
+Computes lookup_table(W, hash(X)) in one op: the rows of X are hashed as the
+hash op does, and the rows of W of the hashed ids are copied to Out as they
+are computed, without writing and reading the ids tensor between the ops.
+
+Out[i, j] = W[XXH64(X[i], seed = j) % mod_by]
+
+)DOC");
+  }
+};
+
+class FusedHashEmbeddingGradDescMaker
+    : public framework::DefaultGradOpDescMaker<true> {
+  using ::paddle::framework::DefaultGradOpDescMaker<
+      true>::DefaultGradOpDescMaker;
+
+ protected:
+  virtual std::string GradOpType() const {
+    return "fused_hash_embedding_grad";
+  }
+};
+
+class FusedHashEmbeddingOpGrad : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    auto table_dims = ctx->GetInputDim("W");
+    ctx->SetOutputDim(framework::GradVarName("W"), table_dims);
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    auto data_type = framework::GetDataTypeOfVar(ctx.InputVar("Out"));
+    return framework::OpKernelType(data_type, ctx.device_context());
+  }
+};
+
+class FusedHashEmbeddingOpGradVarTypeInference
+    : public framework::VarTypeInference {
+ public:
+  void operator()(const framework::OpDesc& op_desc,
+                  framework::BlockDesc* block) const override {
+    auto out_var_name = op_desc.Output(framework::GradVarName("W")).front();
+    auto& table_var_name = op_desc.Input("W").front();
+    bool is_sparse = boost::get<bool>(op_desc.GetAttr("is_sparse"));
+    block->Var(out_var_name)
+        ->SetType(is_sparse ? framework::proto::VarType::SELECTED_ROWS
+                            : framework::proto::VarType::LOD_TENSOR);
+    block->Var(out_var_name)
+        ->SetDataType(block->Var(table_var_name)->GetDataType());
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(fused_hash_embedding, ops::FusedHashEmbeddingOp,
+                  ops::FusedHashEmbeddingGradDescMaker,
+                  ops::FusedHashEmbeddingOpMaker);
+REGISTER_OPERATOR(fused_hash_embedding_grad, ops::FusedHashEmbeddingOpGrad,
+                  ops::FusedHashEmbeddingOpGradVarTypeInference);
+REGISTER_OP_CPU_KERNEL(fused_hash_embedding,
+                       ops::FusedHashEmbeddingKernel<float>,
+                       ops::FusedHashEmbeddingKernel<double>);
+REGISTER_OP_CPU_KERNEL(fused_hash_embedding_grad,
+                       ops::FusedHashEmbeddingGradKernel<float>,
+                       ops::FusedHashEmbeddingGradKernel<double>);
@@ -0,0 +1,165 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include "paddle/fluid/operators/fused/fused_hash_embedding_op.h"
+#include "paddle/fluid/operators/scatter.cu.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+
+constexpr int kHashEmbeddingBlockDimX = 32;
+constexpr int kHashEmbeddingBlockDimY = 8;
+
+// A warp copies the row of W of a hash of a row of X. The lanes of the warp
+// compute the same hash of the short row in their registers, so they need
+// not wait for a lane of it.
+template <typename T>
+__global__ void HashEmbeddingCUDAKernel(const char* input, int64_t rows,
+                                        size_t stride, size_t bytes,
+                                        int num_hash, int64_t mod_by,
+                                        const T* table, int64_t row_width,
+                                        T* output) {
+  int64_t n = rows * num_hash;
+  for (int64_t i = blockIdx.x * blockDim.y + threadIdx.y; i < n;
+       i += blockDim.y * gridDim.x) {
+    int64_t r = i / num_hash;
+    int ihash = i % num_hash;
+    int64_t id = math::XXHash64(input + r * stride, bytes, ihash) % mod_by;
+    const T* src = table + id * row_width;
+    T* dst = output + i * row_width;
+    for (int64_t j = threadIdx.x; j < row_width; j += blockDim.x) {
+      dst[j] = src[j];
+    }
+  }
+}
+
+__global__ void HashEmbeddingIdsCUDAKernel(const char* input, int64_t rows,
+                                           size_t stride, size_t bytes,
+                                           int num_hash, int64_t mod_by,
+                                           int64_t* ids) {
+  int64_t n = rows * num_hash;
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += blockDim.x * gridDim.x) {
+    ids[i] = math::XXHash64(input + (i / num_hash) * stride, bytes,
+                            i % num_hash) %
+             mod_by;
+  }
+}
+
+// The grid of the blocks of n items, of block_items items and block_threads
+// threads each, which is at most the threads the device holds at once.
+static int HashEmbeddingGrid(const platform::CUDADeviceContext& dev_ctx,
+                             int64_t n, int block_items, int block_threads) {
+  int64_t max_grid =
+      std::max(dev_ctx.GetMaxPhysicalThreadCount() / block_threads, 1);
+  return static_cast<int>(
+      std::min((n + block_items - 1) / block_items, max_grid));
+}
+
+template <typename T>
+class FusedHashEmbeddingCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    auto* x = context.Input<LoDTensor>("X");
+    auto* table_t = context.Input<LoDTensor>("W");
+    auto* out_t = context.Output<LoDTensor>("Out");
+    int num_hash = context.Attr<int>("num_hash");
+    int64_t mod_by = context.Attr<int>("mod_by");
+    PADDLE_ENFORCE_LE(mod_by, table_t->dims()[0],
+                      "The mod_by should not exceed the rows of W.");
+
+    int64_t rows = x->dims()[0];
+    int64_t row_width = table_t->dims()[1];
+    T* output = out_t->mutable_data<T>(context.GetPlace());
+    int64_t n = rows * num_hash;
+    if (n == 0) return;
+    auto& dev_ctx = context.cuda_device_context();
+    dim3 threads(kHashEmbeddingBlockDimX, kHashEmbeddingBlockDimY);
+    int grid = HashEmbeddingGrid(
+        dev_ctx, n, kHashEmbeddingBlockDimY,
+        kHashEmbeddingBlockDimX * kHashEmbeddingBlockDimY);
+    HashEmbeddingCUDAKernel<T><<<grid, threads, 0, dev_ctx.stream()>>>(
+        static_cast<const char*>(x->data<void>()), rows,
+        HashEmbeddingRowStride(*x),
+        HashRowBytes(x->dims()[x->dims().size() - 1]), num_hash, mod_by,
+        table_t->data<T>(), row_width, output);
+  }
+};
+
+template <typename T>
+class FusedHashEmbeddingGradCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    auto& dev_ctx = context.cuda_device_context();
+    auto* x = context.Input<LoDTensor>("X");
+    auto table_dims = context.Input<LoDTensor>("W")->dims();
+    auto* d_output = context.Input<LoDTensor>(framework::GradVarName("Out"));
+    int num_hash = context.Attr<int>("num_hash");
+    int64_t mod_by = context.Attr<int>("mod_by");
+    int64_t ids_num = x->dims()[0] * num_hash;
+    int64_t row_width = table_dims[1];
+
+    // The ids are materialized for the scatter of the gradients only.
+    framework::Tensor ids_t;
+    int64_t* ids = ids_t.mutable_data<int64_t>(
+        framework::make_ddim({ids_num}), context.GetPlace());
+    if (ids_num > 0) {
+      int block = PADDLE_CUDA_NUM_THREADS;
+      int grid = HashEmbeddingGrid(dev_ctx, ids_num, block, block);
+      HashEmbeddingIdsCUDAKernel<<<grid, block, 0, dev_ctx.stream()>>>(
+          static_cast<const char*>(x->data<void>()), x->dims()[0],
+          HashEmbeddingRowStride(*x),
+          HashRowBytes(x->dims()[x->dims().size() - 1]), num_hash, mod_by,
+          ids);
+    }
+
+    if (context.Attr<bool>("is_sparse")) {
+      auto* d_table = context.Output<SelectedRows>(framework::GradVarName("W"));
+      auto gpu_place = boost::get<platform::CUDAPlace>(context.GetPlace());
+      framework::Vector<int64_t> new_rows;
+      new_rows.resize(ids_num);
+      memory::Copy(gpu_place, new_rows.CUDAMutableData(context.GetPlace()),
+                   gpu_place, ids, ids_num * sizeof(int64_t),
+                   dev_ctx.stream());
+      d_table->set_rows(new_rows);
+      d_table->set_height(table_dims[0]);
+      auto* d_table_value = d_table->mutable_value();
+      d_table_value->Resize({ids_num, row_width});
+      memory::Copy(gpu_place,
+                   d_table_value->mutable_data<T>(context.GetPlace()),
+                   gpu_place, d_output->data<T>(),
+                   d_output->numel() * sizeof(T), dev_ctx.stream());
+    } else {
+      auto* d_table_t = context.Output<LoDTensor>(framework::GradVarName("W"));
+      T* d_table = d_table_t->mutable_data<T>(context.GetPlace());
+      auto t = framework::EigenVector<T>::Flatten(*d_table_t);
+      t.device(*dev_ctx.eigen_device()) = t.constant(static_cast<T>(0));
+      GPUScatterAdd<T, int64_t>(dev_ctx, d_output->data<T>(), ids, ids_num,
+                                row_width, table_dims[0], d_table);
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(fused_hash_embedding,
+                        ops::FusedHashEmbeddingCUDAKernel<float>,
+                        ops::FusedHashEmbeddingCUDAKernel<double>);
+REGISTER_OP_CUDA_KERNEL(fused_hash_embedding_grad,
+                        ops::FusedHashEmbeddingGradCUDAKernel<float>,
+                        ops::FusedHashEmbeddingGradCUDAKernel<double>);
@@ -0,0 +1,130 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <cstring>
+#include <vector>
+#include "paddle/fluid/framework/compute_pool.h"
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/operators/hash_op.h"
+
+namespace paddle {
+namespace operators {
+
+using LoDTensor = framework::LoDTensor;
+using SelectedRows = framework::SelectedRows;
+
+// The rows of X [rows, last_dim] are hashed as the hash op does.
+inline size_t HashEmbeddingRowStride(const LoDTensor& x) {
+  auto dims = x.dims();
+  return dims[dims.size() - 1] * framework::SizeOfType(x.type());
+}
+
+// The ids of the hashes of the rows of X, [rows * num_hash], which the
+// gradients are scattered to.
+inline void HashEmbeddingIds(const LoDTensor& x, int num_hash, int64_t mod_by,
+                             int64_t* ids) {
+  auto* input = static_cast<const char*>(x.data<void>());
+  size_t stride = HashEmbeddingRowStride(x);
+  size_t bytes = HashRowBytes(x.dims()[x.dims().size() - 1]);
+  framework::ParallelFor(0, x.dims()[0], framework::GrainSize(num_hash * 16),
+                         [&](int64_t begin, int64_t end) {
+                           for (int64_t r = begin; r < end; ++r) {
+                             int64_t* row_ids = ids + r * num_hash;
+                             HashRow(input + r * stride, bytes, num_hash,
+                                     mod_by, [row_ids](int ihash, int64_t id) {
+                                       row_ids[ihash] = id;
+                                     });
+                           }
+                         });
+}
+
+template <typename T>
+class FusedHashEmbeddingKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    auto* x = context.Input<LoDTensor>("X");
+    auto* table_t = context.Input<LoDTensor>("W");
+    auto* out_t = context.Output<LoDTensor>("Out");
+    int num_hash = context.Attr<int>("num_hash");
+    int64_t mod_by = context.Attr<int>("mod_by");
+    PADDLE_ENFORCE_LE(mod_by, table_t->dims()[0],
+                      "The mod_by should not exceed the rows of W.");
+
+    int64_t row_width = table_t->dims()[1];
+    const T* table = table_t->data<T>();
+    T* output = out_t->mutable_data<T>(context.GetPlace());
+    auto* input = static_cast<const char*>(x->data<void>());
+    size_t stride = HashEmbeddingRowStride(*x);
+    size_t bytes = HashRowBytes(x->dims()[x->dims().size() - 1]);
+    // The rows of W are copied as the hashes are computed, and the ids
+    // are not written.
+    framework::ParallelFor(
+        0, x->dims()[0], framework::GrainSize(num_hash * row_width),
+        [&](int64_t begin, int64_t end) {
+          for (int64_t r = begin; r < end; ++r) {
+            T* out = output + r * num_hash * row_width;
+            HashRow(input + r * stride, bytes, num_hash, mod_by,
+                    [&](int ihash, int64_t id) {
+                      memcpy(out + ihash * row_width, table + id * row_width,
+                             row_width * sizeof(T));
+                    });
+          }
+        });
+  }
+};
+
+template <typename T>
+class FusedHashEmbeddingGradKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    auto* x = context.Input<LoDTensor>("X");
+    auto table_dims = context.Input<LoDTensor>("W")->dims();
+    auto* d_output = context.Input<LoDTensor>(framework::GradVarName("Out"));
+    int num_hash = context.Attr<int>("num_hash");
+    int64_t mod_by = context.Attr<int>("mod_by");
+    int64_t ids_num = x->dims()[0] * num_hash;
+    int64_t row_width = table_dims[1];
+
+    std::vector<int64_t> ids(ids_num);
+    HashEmbeddingIds(*x, num_hash, mod_by, ids.data());
+    const T* d_output_data = d_output->data<T>();
+
+    if (context.Attr<bool>("is_sparse")) {
+      auto* d_table = context.Output<SelectedRows>(framework::GradVarName("W"));
+      d_table->set_rows(ids);
+      d_table->set_height(table_dims[0]);
+      auto* d_table_value = d_table->mutable_value();
+      d_table_value->Resize({ids_num, row_width});
+      T* d_table_data = d_table_value->mutable_data<T>(context.GetPlace());
+      memcpy(d_table_data, d_output_data, sizeof(T) * d_output->numel());
+    } else {
+      auto* d_table = context.Output<LoDTensor>(framework::GradVarName("W"));
+      T* d_table_data = d_table->mutable_data<T>(context.GetPlace());
+      memset(d_table_data, 0, d_table->numel() * sizeof(T));
+      for (int64_t i = 0; i < ids_num; ++i) {
+        for (int64_t j = 0; j < row_width; ++j) {
+          d_table_data[ids[i] * row_width + j] +=
+              d_output_data[i * row_width + j];
+        }
+      }
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,136 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/fused/fused_multihead_attention_op.h"
+#include "paddle/fluid/operators/jit/kernels.h"
+
+namespace paddle {
+namespace operators {
+
+void FusedMultiHeadAttentionOp::InferShape(
+    framework::InferShapeContext* ctx) const {
+  PADDLE_ENFORCE(ctx->HasInput("Q"),
+                 "Input(Q) of FusedMultiHeadAttentionOp should not be null.");
+  PADDLE_ENFORCE(ctx->HasInput("K"),
+                 "Input(K) of FusedMultiHeadAttentionOp should not be null.");
+  PADDLE_ENFORCE(ctx->HasInput("V"),
+                 "Input(V) of FusedMultiHeadAttentionOp should not be null.");
+  PADDLE_ENFORCE(
+      ctx->HasOutput("Out"),
+      "Output(Out) of FusedMultiHeadAttentionOp should not be null.");
+
+  auto q_dims = ctx->GetInputDim("Q");
+  auto k_dims = ctx->GetInputDim("K");
+  auto v_dims = ctx->GetInputDim("V");
+  PADDLE_ENFORCE_EQ(q_dims.size(), 3,
+                    "Input(Q) should be a 3-D tensor of [B, Sq, H * D].");
+  PADDLE_ENFORCE_EQ(k_dims, v_dims,
+                    "Input(K) and Input(V) should have the same shape.");
+  PADDLE_ENFORCE_EQ(k_dims.size(), 3,
+                    "Input(K) should be a 3-D tensor of [B, Sk, H * D].");
+  PADDLE_ENFORCE_EQ(q_dims[2], k_dims[2],
+                    "The last dimension of Q and K should be the same.");
+
+  int head_number = ctx->Attrs().Get<int>("head_number");
+  PADDLE_ENFORCE_GT(head_number, 0, "Attr(head_number) should be positive.");
+  if (q_dims[2] > 0) {
+    PADDLE_ENFORCE_EQ(q_dims[2] % head_number, 0,
+                      "The last dimension of Q should be divisible by "
+                      "Attr(head_number).");
+  }
+
+  if (ctx->HasInput("BiasQK")) {
+    auto bias_dims = ctx->GetInputDim("BiasQK");
+    PADDLE_ENFORCE_EQ(
+        bias_dims.size(), 4,
+        "Input(BiasQK) should be a 4-D tensor of [B, H, Sq, Sk].");
+    if (ctx->IsRuntime()) {
+      PADDLE_ENFORCE_EQ(
+          bias_dims,
+          framework::make_ddim({q_dims[0], head_number, q_dims[1], k_dims[1]}),
+          "Input(BiasQK) should be of the shape [B, H, Sq, Sk].");
+    }
+  }
+
+  ctx->SetOutputDim("Out", q_dims);
+  ctx->ShareLoD("Q", /*->*/ "Out");
+}
+
+framework::OpKernelType FusedMultiHeadAttentionOp::GetExpectedKernelType(
+    const framework::ExecutionContext& ctx) const {
+  return framework::OpKernelType(ctx.Input<Tensor>("Q")->type(),
+                                 ctx.GetPlace());
+}
+
+void FusedMultiHeadAttentionOpMaker::Make() {
+  AddInput("Q", "(Tensor) The queries of the shape [B, Sq, H * D].");
+  AddInput("K", "(Tensor) The keys of the shape [B, Sk, H * D].");
+  AddInput("V", "(Tensor) The values of the shape [B, Sk, H * D].");
+  AddInput("BiasQK",
+           "(Tensor, optional) The bias added to the attention weights "
+           "before softmax, of the shape [B, H, Sq, Sk].")
+      .AsDispensable();
+  AddOutput("Out",
+            "(Tensor) The attention output of the shape [B, Sq, H * D].");
+  AddAttr<int>("head_number", "The number of heads H.").SetDefault(1);
+  AddAttr<float>("alpha", "The scale of Q * K^T, usually 1 / sqrt(D).")
+      .SetDefault(1.0f);
+  AddAttr<float>("out_scale",
+                 "The scale of the output, e.g., 1 - dropout_prob of the "
+                 "removed dropout in inference.")
+      .SetDefault(1.0f);
+  AddComment(R"DOC(
+Fused multi-head scaled dot-product attention for inference.
+
+The operator fuses the block of Transformer
+
+    Q' = transpose(reshape(Q, [B, Sq, H, D]), [0, 2, 1, 3])
+    K' = transpose(reshape(K, [B, Sk, H, D]), [0, 2, 1, 3])
+    V' = transpose(reshape(V, [B, Sk, H, D]), [0, 2, 1, 3])
+    W = softmax(alpha * Q' * K'^T + BiasQK)
+    Out = reshape(transpose(out_scale * W * V', [0, 2, 1, 3]), [B, Sq, H * D])
+
+The products are computed by batched GEMM of B * H matrices.
+)DOC");
+}
+
+template <typename T>
+struct SoftmaxWithBiasFunctor<platform::CPUDeviceContext, T> {
+  void operator()(const platform::CPUDeviceContext& ctx, const T* x,
+                  const T* bias, T* y, int n, int rows) {
+    if (bias) {
+      auto blas = math::GetBlas<platform::CPUDeviceContext, T>(ctx);
+      blas.VADD(n * rows, x, bias, y);
+      x = y;
+    }
+    auto softmax =
+        jit::Get<jit::kSoftmax, jit::SoftmaxTuples<T>, platform::CPUPlace>(n);
+    softmax(x, y, n, rows);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(fused_multihead_attention, ops::FusedMultiHeadAttentionOp,
+                  ops::FusedMultiHeadAttentionOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+
+REGISTER_OP_CPU_KERNEL(
+    fused_multihead_attention,
+    ops::FusedMultiHeadAttentionKernel<paddle::platform::CPUDeviceContext,
+                                       float>,
+    ops::FusedMultiHeadAttentionKernel<paddle::platform::CPUDeviceContext,
+                                       double>);
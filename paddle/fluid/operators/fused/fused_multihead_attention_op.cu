@@ -0,0 +1,100 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <cfloat>
+#include <cub/cub.cuh>  // NOLINT
+#include "paddle/fluid/operators/fused/fused_multihead_attention_op.h"
+
+namespace paddle {
+namespace operators {
+
+__device__ __forceinline__ float real_exp(float x) { return expf(x); }
+__device__ __forceinline__ double real_exp(double x) { return exp(x); }
+
+template <typename T, int BlockDim>
+using BlockReduce = cub::BlockReduce<T, BlockDim>;
+
+template <typename T, int BlockDim>
+using BlockReduceTempStorage = typename BlockReduce<T, BlockDim>::TempStorage;
+
+// Each block computes the softmax of one row, and the bias is added on the
+// fly, so that the attention weights are read and written only once.
+template <typename T, int BlockDim>
+__global__ void SoftmaxWithBiasKernel(const T* x, const T* bias, T* y, int n,
+                                      int rows) {
+  __shared__ BlockReduceTempStorage<T, BlockDim> temp_storage;
+  __shared__ T shared_max_data;
+  __shared__ T shared_sum_data;
+
+  for (int i = blockIdx.x; i < rows; i += gridDim.x) {
+    const T* row_x = x + static_cast<int64_t>(i) * n;
+    const T* row_bias = bias ? bias + static_cast<int64_t>(i) * n : nullptr;
+    T* row_y = y + static_cast<int64_t>(i) * n;
+
+    T max_ele = -FLT_MAX;
+    for (int tid = threadIdx.x; tid < n; tid += blockDim.x) {
+      T ele = row_bias ? row_x[tid] + row_bias[tid] : row_x[tid];
+      row_y[tid] = ele;
+      max_ele = max_ele > ele ? max_ele : ele;
+    }
+    max_ele =
+        BlockReduce<T, BlockDim>(temp_storage).Reduce(max_ele, cub::Max());
+    if (threadIdx.x == 0) {
+      shared_max_data = max_ele;
+    }
+    __syncthreads();
+
+    T sum_data = 0;
+    for (int tid = threadIdx.x; tid < n; tid += blockDim.x) {
+      T ele = real_exp(row_y[tid] - shared_max_data);
+      row_y[tid] = ele;
+      sum_data += ele;
+    }
+    sum_data =
+        BlockReduce<T, BlockDim>(temp_storage).Reduce(sum_data, cub::Sum());
+    if (threadIdx.x == 0) {
+      shared_sum_data = sum_data;
+    }
+    __syncthreads();
+
+    for (int tid = threadIdx.x; tid < n; tid += blockDim.x) {
+      row_y[tid] /= shared_sum_data;
+    }
+    __syncthreads();
+  }
+}
+
+template <typename T>
+struct SoftmaxWithBiasFunctor<platform::CUDADeviceContext, T> {
+  void operator()(const platform::CUDADeviceContext& ctx, const T* x,
+                  const T* bias, T* y, int n, int rows) {
+    const int kThreadsPerBlock = 256;
+    int max_threads = ctx.GetMaxPhysicalThreadCount();
+    int max_blocks = std::max(max_threads / kThreadsPerBlock, 1);
+    int grid = std::min(rows, max_blocks);
+    SoftmaxWithBiasKernel<T, kThreadsPerBlock><<<
+        grid, kThreadsPerBlock, 0, ctx.stream()>>>(x, bias, y, n, rows);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+namespace plat = paddle::platform;
+REGISTER_OP_CUDA_KERNEL(
+    fused_multihead_attention,
+    ops::FusedMultiHeadAttentionKernel<plat::CUDADeviceContext, float>,
+    ops::FusedMultiHeadAttentionKernel<plat::CUDADeviceContext, double>);
@@ -0,0 +1,134 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/math_function.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+
+class FusedMultiHeadAttentionOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override;
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override;
+};
+
+class FusedMultiHeadAttentionOpMaker
+    : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override;
+};
+
+// y = softmax(x + bias) of each row of n elements, where bias can be nullptr.
+template <typename DeviceContext, typename T>
+struct SoftmaxWithBiasFunctor {
+  void operator()(const DeviceContext& ctx, const T* x, const T* bias, T* y,
+                  int n, int rows);
+};
+
+template <typename DeviceContext, typename T>
+static void TransposeHeads(const DeviceContext& ctx, const Tensor& in,
+                           const framework::DDim& in_dims, Tensor* out) {
+  Tensor in_view;
+  in_view.ShareDataWith(in);
+  in_view.Resize(in_dims);
+  math::Transpose<DeviceContext, T, 4> trans;
+  trans(ctx, in_view, out, {0, 2, 1, 3});
+}
+
+// Out = transpose(softmax(Q' * K'^T * alpha + BiasQK) * V' * out_scale),
+// where X' = transpose(reshape(X, [B, S, H, D]), [0, 2, 1, 3]).
+template <typename DeviceContext, typename T>
+class FusedMultiHeadAttentionKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* q = ctx.Input<Tensor>("Q");
+    auto* k = ctx.Input<Tensor>("K");
+    auto* v = ctx.Input<Tensor>("V");
+    auto* bias_qk = ctx.Input<Tensor>("BiasQK");
+    auto* out = ctx.Output<Tensor>("Out");
+    const int head_number = ctx.Attr<int>("head_number");
+    const T alpha = static_cast<T>(ctx.Attr<float>("alpha"));
+    const T out_scale = static_cast<T>(ctx.Attr<float>("out_scale"));
+
+    auto q_dims = q->dims();
+    auto k_dims = k->dims();
+    const int batch = q_dims[0];
+    const int seq_q = q_dims[1];
+    const int seq_k = k_dims[1];
+    const int size_per_head = q_dims[2] / head_number;
+    const int batch_head = batch * head_number;
+
+    auto& dev_ctx = ctx.template device_context<DeviceContext>();
+    auto blas = math::GetBlas<DeviceContext, T>(dev_ctx);
+
+    // All the temporary tensors are in the [B, H, S, D] layout.
+    Tensor q_t, k_t, v_t, qk, out_t;
+    auto q_t_dims =
+        framework::make_ddim({batch, head_number, seq_q, size_per_head});
+    auto k_t_dims =
+        framework::make_ddim({batch, head_number, seq_k, size_per_head});
+    q_t.Resize(q_t_dims);
+    k_t.Resize(k_t_dims);
+    v_t.Resize(k_t_dims);
+    qk.Resize({batch, head_number, seq_q, seq_k});
+    out_t.Resize(q_t_dims);
+    T* q_t_data = q_t.mutable_data<T>(ctx.GetPlace());
+    T* k_t_data = k_t.mutable_data<T>(ctx.GetPlace());
+    T* v_t_data = v_t.mutable_data<T>(ctx.GetPlace());
+    T* qk_data = qk.mutable_data<T>(ctx.GetPlace());
+    T* out_t_data = out_t.mutable_data<T>(ctx.GetPlace());
+
+    TransposeHeads<DeviceContext, T>(
+        dev_ctx, *q, {batch, seq_q, head_number, size_per_head}, &q_t);
+    TransposeHeads<DeviceContext, T>(
+        dev_ctx, *k, {batch, seq_k, head_number, size_per_head}, &k_t);
+    TransposeHeads<DeviceContext, T>(
+        dev_ctx, *v, {batch, seq_k, head_number, size_per_head}, &v_t);
+
+    blas.BatchedGEMM(CblasNoTrans, CblasTrans, seq_q, seq_k, size_per_head,
+                     alpha, q_t_data, k_t_data, static_cast<T>(0), qk_data,
+                     batch_head, static_cast<int64_t>(seq_q) * size_per_head,
+                     static_cast<int64_t>(seq_k) * size_per_head);
+
+    SoftmaxWithBiasFunctor<DeviceContext, T> softmax;
+    softmax(dev_ctx, qk_data, bias_qk ? bias_qk->data<T>() : nullptr, qk_data,
+            seq_k, batch_head * seq_q);
+
+    blas.BatchedGEMM(CblasNoTrans, CblasNoTrans, seq_q, size_per_head, seq_k,
+                     out_scale, qk_data, v_t_data, static_cast<T>(0),
+                     out_t_data, batch_head,
+                     static_cast<int64_t>(seq_q) * seq_k,
+                     static_cast<int64_t>(seq_k) * size_per_head);
+
+    out->Resize({batch, seq_q, head_number, size_per_head});
+    out->mutable_data<T>(ctx.GetPlace());
+    TransposeHeads<DeviceContext, T>(
+        dev_ctx, out_t, {batch, head_number, seq_q, size_per_head}, out);
+    out->Resize(q_dims);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
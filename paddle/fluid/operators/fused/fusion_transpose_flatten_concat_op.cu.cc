@@ -15,14 +15,11 @@ limitations under the License. */
 #include "paddle/fluid/operators/fused/fusion_transpose_flatten_concat_op.h"
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
-#include "paddle/fluid/platform/cudnn_helper.h"
+#include "paddle/fluid/operators/math/transpose_functor.h"
 
 namespace paddle {
 namespace operators {
 
-template <typename T>
-using CudnnDataType = platform::CudnnDataType<T>;
-
 template <typename T>
 class TransposeFlattenConcatFusionKernel : public framework::OpKernel<T> {
  public:
@@ -37,35 +34,21 @@ class TransposeFlattenConcatFusionKernel : public framework::OpKernel<T> {
     int concat_axis = ctx.Attr<int>("concat_axis");
 
     int rank = ins[0]->dims().size();
-    // use at least 4D in cudnnTransformTensor
-    int max_dim = rank < 4 ? 4 : rank;
-    std::vector<int> stride_x(max_dim, 0);
-    std::vector<int> stride_y(max_dim, 0);
-    std::vector<int> dims_y(max_dim, 0);
-
-    cudnnTensorDescriptor_t in_desc;
-    cudnnTensorDescriptor_t out_desc;
-    CUDNN_ENFORCE(platform::dynload::cudnnCreateTensorDescriptor(&in_desc));
-    CUDNN_ENFORCE(platform::dynload::cudnnCreateTensorDescriptor(&out_desc));
-    cudnnDataType_t cudnn_dtype = CudnnDataType<T>::type;
-
     auto& dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
-    auto handle = dev_ctx.cudnn_handle();
+    math::TransposeNormal<platform::CUDADeviceContext, T> trans;
 
     T* odata = out->data<T>();
     for (size_t k = 0; k < ins.size(); ++k) {
       auto perm_shape = GetPermuteShape(trans_axis, ins[k]->dims());
-      int osize = 1;
-      auto idims = ins[k]->dims();
+      int64_t osize = 1;
       for (int i = 0; i < rank; i++) {
-        stride_x[i] = 1;
-        for (int j = trans_axis[i] + 1; j < rank; j++) {
-          stride_x[i] *= idims[j];
-        }
-        dims_y[i] = perm_shape[i];
         osize *= perm_shape[i];
       }
-      stride_y[rank - 1] = 1;
+      // Since concat is aftern flatten, the output is 2D tensor.
+      // If concat_axis is 0, each input's permutated tensor is continuous.
+      // If concat_axis is 1, the stride of 0-th dim of each input's
+      // permutated tensor is odims()[1].
+      std::vector<int64_t> stride_y(rank, 1);
       for (int i = rank - 2; i >= 0; i--) {
         if (((i + 1) == flatten_axis) && (concat_axis == 1)) {
           stride_y[i] = odims[1];
@@ -74,26 +57,8 @@ class TransposeFlattenConcatFusionKernel : public framework::OpKernel<T> {
         }
       }
 
-      // Since concat is aftern flatten, the output is 2D tensor.
-      // If concat_axis is 0, each input's permutated tensor is continuous.
-      // If concat_axis is 1, the stride of 0-th dim of each input's
-      // permutated tensor is odims()[1].
-
-      for (int i = rank; i < max_dim; i++) {
-        stride_x[i] = 1;
-        stride_y[i] = 1;
-        dims_y[i] = 1;
-      }
-
-      CUDNN_ENFORCE(platform::dynload::cudnnSetTensorNdDescriptor(
-          in_desc, cudnn_dtype, max_dim, dims_y.data(), stride_x.data()));
-      CUDNN_ENFORCE(platform::dynload::cudnnSetTensorNdDescriptor(
-          out_desc, cudnn_dtype, max_dim, dims_y.data(), stride_y.data()));
-
-      CUDNN_ENFORCE(platform::dynload::cudnnTransformTensor(
-          handle, CudnnDataType<T>::kOne(), in_desc,
-          static_cast<const void*>(ins[k]->data<T>()),
-          CudnnDataType<T>::kZero(), out_desc, static_cast<void*>(odata)));
+      trans(dev_ctx, ins[k]->data<T>(), ins[k]->dims(), trans_axis, odata,
+            stride_y);
       if (concat_axis == 0) {
         odata += osize;
       } else {
@@ -101,8 +66,6 @@ class TransposeFlattenConcatFusionKernel : public framework::OpKernel<T> {
         odata += flat_shape[1];
       }
     }
-    CUDNN_ENFORCE(platform::dynload::cudnnDestroyTensorDescriptor(in_desc));
-    CUDNN_ENFORCE(platform::dynload::cudnnDestroyTensorDescriptor(out_desc));
   }
 };
 
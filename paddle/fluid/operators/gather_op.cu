@@ -12,6 +12,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <algorithm>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/operators/gather.cu.h"
 #include "paddle/fluid/operators/gather_op.h"
@@ -53,7 +54,13 @@ class GatherGradOpCUDAKernel : public framework::OpKernel<T> {
                        .eigen_device();
     dxt.device(place) = dxt.constant(static_cast<T>(0));
 
-    GPUScatterAssign<T>(ctx.device_context(), *dO, *Index, dX);
+    // The gradients of the repeated indices are added, by the sorted
+    // scatter add if they repeat a lot, which is deterministic.
+    int64_t slice_size = dO->numel() / std::max<int64_t>(dO->dims()[0], 1);
+    GPUScatterAdd<T, int>(
+        ctx.template device_context<platform::CUDADeviceContext>(),
+        dO->data<T>(), Index->data<int>(), static_cast<int>(Index->dims()[0]),
+        slice_size, dX->dims()[0], dX->data<T>());
   }
 };
 
@@ -11,49 +11,33 @@ distributed under the License is distributed on an "AS IS" BASIS,
 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
-#include <thrust/random.h>
-#include <thrust/transform.h>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/platform/for_range.h"
+#include "paddle/fluid/platform/philox.h"
+#include "paddle/fluid/platform/philox_state.h"
 
 namespace paddle {
 namespace operators {
 
-template <typename T>
-struct GaussianGenerator {
-  T mean_, std_;
-  unsigned int seed_;
-
-  __host__ __device__ GaussianGenerator(T mean, T std, int seed)
-      : mean_(mean), std_(std), seed_(seed) {}
-
-  __host__ __device__ T operator()(const unsigned int n) const {
-    thrust::minstd_rand rng;
-    rng.seed(seed_);
-    thrust::normal_distribution<T> dist(mean_, std_);
-    rng.discard(n);
-    return dist(rng);
-  }
-};
-
 template <typename T>
 class GPUGaussianRandomKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext& context) const override {
     auto* tensor = context.Output<framework::Tensor>("Out");
     T* data = tensor->mutable_data<T>(context.GetPlace());
-    unsigned int seed = static_cast<unsigned int>(context.Attr<int>("seed"));
-    if (seed == 0) {
-      std::random_device rd;
-      seed = rd();
-    }
+    auto seed =
+        platform::GetPhiloxSeed(context.GetPlace(), context.Attr<int>("seed"));
     T mean = static_cast<T>(context.Attr<float>("mean"));
     T std = static_cast<T>(context.Attr<float>("std"));
-    thrust::counting_iterator<unsigned int> index_sequence_begin(0);
-    int64_t size = tensor->numel();
-    thrust::transform(index_sequence_begin, index_sequence_begin + size,
-                      thrust::device_ptr<T>(data),
-                      GaussianGenerator<T>(mean, std, seed));
+    using Distribution = platform::PhiloxNormalDistribution<T>;
+    platform::PhiloxFillFunctor<T, Distribution> fill(
+        seed.seed, seed.offset, Distribution(mean, std), data,
+        tensor->numel());
+    platform::ForRange<platform::CUDADeviceContext> for_range(
+        context.template device_context<platform::CUDADeviceContext>(),
+        fill.NumGroups());
+    for_range(fill);
   }
 };
 
@@ -12,65 +12,48 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
-#include <cub/cub.cuh>
+#include <algorithm>
 #include "paddle/fluid/operators/group_norm_op.h"
+#include "paddle/fluid/operators/norm_utils.cu.h"
 
 namespace paddle {
 namespace operators {
 
+// A block normalizes a group of a sample, whose number * imsize values are
+// contiguous: the mean and the variance are reduced by Welford's algorithm
+// in one pass, and y = x * a + b is written with the a and b of the
+// channel, which fuse the normalization, the scale and the bias.
 template <typename T>
-__global__ void GroupNormForwardGetMeanAndVar(const T* x, int N, int C,
-                                              int imsize, int groups,
-                                              int group_size, T* mean, T* var) {
-  int gid = blockIdx.y;
-  int cid = blockIdx.x;
-  int bid = blockIdx.z;
-  int number = min(group_size, static_cast<int>(C - gid * group_size));
-  int ccid = gid * group_size + cid;
-  if (ccid >= C) return;
-  T x_mean = 0, x_var = 0;
-  for (int imid = threadIdx.x; imid < imsize; imid += blockDim.x) {
-    T val = x[(bid * C + ccid) * imsize + imid];
-    x_mean += val;
-    x_var += val * val;
+__global__ void GroupNormForward(const T* x, const T* scale, const T* bias,
+                                 int C, int imsize, int groups,
+                                 int group_size, T epsilon, T* y, T* mean,
+                                 T* var) {
+  int ng = blockIdx.x;
+  int c_begin = ng % groups * group_size;
+  int number = min(group_size, C - c_begin);
+  if (number <= 0) {
+    if (threadIdx.x == 0) mean[ng] = var[ng] = 0;
+    return;
   }
-  x_mean /= number * imsize;
-  x_var /= number * imsize;
-  __shared__ T s_mem[2];
-  if (threadIdx.x == 0) {
-    s_mem[0] = s_mem[1] = 0;
+  int size = number * imsize;
+  int offset = (ng / groups * C + c_begin) * imsize;
+  WelfordData<T> data = {0, 0, 0};
+  for (int i = threadIdx.x; i < size; i += blockDim.x) {
+    WelfordUpdate(x[offset + i], &data);
   }
-  __syncthreads();
-  paddle::platform::CudaAtomicAdd(&s_mem[0], x_mean);
-  paddle::platform::CudaAtomicAdd(&s_mem[1], x_var);
-  __syncthreads();
+  data = WelfordBlockReduce(data);
+  T x_mean = data.mean;
+  T x_var = data.m2 / size;
   if (threadIdx.x == 0) {
-    paddle::platform::CudaAtomicAdd(&mean[bid * groups + gid], s_mem[0]);
-    paddle::platform::CudaAtomicAdd(&var[bid * groups + gid], s_mem[1]);
+    mean[ng] = x_mean;
+    var[ng] = x_var;
   }
-}
-
-template <typename T>
-__global__ void GroupNormForward(const T* x, const T* mean, const T* var,
-                                 const T* scale, const T* bias, int N, int C,
-                                 int imsize, int groups, int group_size,
-                                 T epsilon, T* y, T* real_var) {
-  int gid = blockIdx.y;
-  int cid = blockIdx.x;
-  int bid = blockIdx.z;
-  int ccid = gid * group_size + cid;
-  if (ccid >= C) return;
-  T x_mean = mean[bid * groups + gid];
-  T x_var = var[bid * groups + gid];
-  x_var = x_var - x_mean * x_mean;
-  T var_inv = 1.0 / sqrt(x_var + epsilon);
-  if (cid == 0 && threadIdx.x == 0) real_var[bid * groups + gid] = x_var;
-  for (int imid = threadIdx.x; imid < imsize; imid += blockDim.x) {
-    T val = x[(bid * C + ccid) * imsize + imid];
-    val = (val - x_mean) * var_inv;
-    if (scale) val *= scale[gid * group_size + cid];
-    if (bias) val += bias[gid * group_size + cid];
-    y[(bid * C + ccid) * imsize + imid] = val;
+  T var_inv = NormRsqrt(x_var + epsilon);
+  for (int i = threadIdx.x; i < size; i += blockDim.x) {
+    int c = c_begin + i / imsize;
+    T a = scale ? scale[c] * var_inv : var_inv;
+    T b = (bias ? bias[c] : static_cast<T>(0)) - x_mean * a;
+    y[offset + i] = x[offset + i] * a + b;
   }
 }
 
@@ -92,22 +75,11 @@ class GroupNormKernel<platform::CUDADeviceContext, T>
     const auto x_dims = x->dims();
     const int group_size = (x_dims[1] - 1) / groups + 1;
 
-    y->mutable_data<T>(ctx.GetPlace());
-    mean->mutable_data<T>(ctx.GetPlace());
-    var->mutable_data<T>(ctx.GetPlace());
-    math::SetConstant<platform::CUDADeviceContext, T> set_zero;
-    auto& dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
-    Tensor temp_var;
-    temp_var.mutable_data<T>(var->dims(), ctx.GetPlace());
-
-    set_zero(dev_ctx, mean, static_cast<T>(0));
-    set_zero(dev_ctx, &temp_var, static_cast<T>(0));
-
     auto* x_data = x->data<T>();
-    auto* y_data = y->data<T>();
-    auto* mean_data = mean->data<T>();
-    auto* var_data = var->data<T>();
-    auto* temp_var_data = temp_var.data<T>();
+    auto* y_data = y->mutable_data<T>(ctx.GetPlace());
+    auto* mean_data = mean->mutable_data<T>(ctx.GetPlace());
+    auto* var_data = var->mutable_data<T>(ctx.GetPlace());
+    auto& dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
 
     const T* scale_data = nullptr;
     if (scale) scale_data = scale->data<T>();
@@ -115,93 +87,64 @@ class GroupNormKernel<platform::CUDADeviceContext, T>
     if (bias) bias_data = bias->data<T>();
 
     int imsize = x_dims[2] * x_dims[3];
-    int block_size = std::min(512, imsize);
-    dim3 grid(group_size, groups, x_dims[0]);
-    dim3 threads(block_size, 1, 1);
-    GroupNormForwardGetMeanAndVar<T><<<grid, threads, 0, dev_ctx.stream()>>>(
-        x_data, x_dims[0], x_dims[1], imsize, groups, group_size, mean_data,
-        temp_var_data);
-    GroupNormForward<T><<<grid, threads, 0, dev_ctx.stream()>>>(
-        x_data, mean_data, temp_var_data, scale_data, bias_data, x_dims[0],
-        x_dims[1], imsize, groups, group_size, epsilon, y_data, var_data);
+    int block_size = NormBlockDim(group_size * imsize);
+    GroupNormForward<T><<<x_dims[0] * groups, block_size, 0,
+                          dev_ctx.stream()>>>(
+        x_data, scale_data, bias_data, x_dims[1], imsize, groups, group_size,
+        epsilon, y_data, mean_data, var_data);
   }
 };
 
-template <typename T>
-__global__ void GroupNormBackwardGetMeanAndVar(
-    const T* x, const T* mean, const T* var, const T* scale, const T* d_y,
-    int N, int C, int imsize, int groups, int group_size, T epsilon, T* d_x,
-    T* d_mean, T* d_var, T* d_scale, T* d_bias) {
-  int gid = blockIdx.y;
-  int cid = blockIdx.x;
-  int bid = blockIdx.z;
-  int number = min(group_size, static_cast<int>(C - gid * group_size));
-  int ccid = gid * group_size + cid;
-  if (ccid >= C) return;
-  T x_mean = mean[bid * groups + gid];
-  T x_var = var[bid * groups + gid];
-  T var_inv = 1.0 / sqrt(x_var + epsilon);
-  T d_var_inv = 0, d_x_mean = 0;
-  T d_mean_data = 0, d_var_data = 0, d_scale_data = 0, d_bias_data = 0;
-
-  for (int imid = threadIdx.x; imid < imsize; imid += blockDim.x) {
-    T tmp = x[(bid * C + ccid) * imsize + imid];
-    T val = (tmp - x_mean) * var_inv;
-    T dval = d_y[(bid * C + ccid) * imsize + imid];
-    if (d_bias) d_bias_data += dval;
-    if (d_scale) d_scale_data += val * dval;
-    if (scale) dval = dval * scale[ccid];
-    d_var_data += (tmp - x_mean) * dval;
-    T d_tmp = dval * var_inv;
-    if (d_x) d_x[(bid * C + ccid) * imsize + imid] = d_tmp;
-    d_mean_data -= d_tmp;
-  }
-
-  __shared__ T s_mem[4];
-  if (threadIdx.x == 0) {
-    s_mem[0] = s_mem[1] = 0;
-    if (d_scale) s_mem[2] = 0;
-    if (d_bias) s_mem[3] = 0;
-  }
-  __syncthreads();
-  paddle::platform::CudaAtomicAdd(&s_mem[0], d_mean_data);
-  paddle::platform::CudaAtomicAdd(&s_mem[1], d_var_data);
-  if (d_scale) paddle::platform::CudaAtomicAdd(&s_mem[2], d_scale_data);
-  if (d_bias) paddle::platform::CudaAtomicAdd(&s_mem[3], d_bias_data);
-  __syncthreads();
-  if (threadIdx.x == 0) {
-    paddle::platform::CudaAtomicAdd(&d_mean[bid * groups + gid], s_mem[0]);
-    paddle::platform::CudaAtomicAdd(&d_var[bid * groups + gid], s_mem[1]);
-    if (d_scale) paddle::platform::CudaAtomicAdd(&d_scale[ccid], s_mem[2]);
-    if (d_bias) paddle::platform::CudaAtomicAdd(&d_bias[ccid], s_mem[3]);
-  }
-}
-
+// A block takes the gradients of a group of a sample, in a pass over the
+// channels for the sums of d_y * x_hat and d_y of them, which are the
+// partial sums [N, C] of d_scale and d_bias, and, if d_x is needed, in a
+// pass to write
+//   d_x = var_inv * (d_y * scale - mean(d_y * scale)
+//                    - x_hat * mean(d_y * scale * x_hat)).
 template <typename T>
 __global__ void GroupNormBackward(const T* x, const T* mean, const T* var,
-                                  const T* d_mean, const T* d_var, int N, int C,
+                                  const T* scale, const T* d_y, int C,
                                   int imsize, int groups, int group_size,
-                                  T epsilon, T* d_x) {
-  int gid = blockIdx.y;
-  int cid = blockIdx.x;
-  int bid = blockIdx.z;
-  int number = min(group_size, static_cast<int>(C - gid * group_size));
-  int ccid = gid * group_size + cid;
-  if (ccid >= C) return;
-  T x_mean = mean[bid * groups + gid];
-  T x_var = var[bid * groups + gid];
-  T d_x_mean = d_mean[bid * groups + gid];
-  T d_var_inv = d_var[bid * groups + gid];
-
-  T d_x_var =
-      -1.0 / (2 * (x_var + epsilon) * sqrt(x_var + epsilon)) * d_var_inv;
-  d_x_mean -= 2 * d_x_var * x_mean;
-  d_x_var /= number * imsize;
-  d_x_mean /= number * imsize;
-  for (int imid = threadIdx.x; imid < imsize; imid += blockDim.x) {
-    T tmp = x[(bid * C + ccid) * imsize + imid];
-    if (d_x)
-      d_x[(bid * C + ccid) * imsize + imid] += d_x_mean + tmp * 2 * d_x_var;
+                                  T epsilon, T* d_x, T* partial_scale,
+                                  T* partial_bias) {
+  int ng = blockIdx.x;
+  int n = ng / groups;
+  int c_begin = ng % groups * group_size;
+  int number = min(group_size, C - c_begin);
+  if (number <= 0) return;
+  int offset = (n * C + c_begin) * imsize;
+  T x_mean = mean[ng];
+  T var_inv = NormRsqrt(var[ng] + epsilon);
+
+  T d_mean = 0, d_mean_x_hat = 0;
+  for (int c = 0; c < number; ++c) {
+    const T* x_c = x + offset + c * imsize;
+    const T* d_y_c = d_y + offset + c * imsize;
+    T d_x_hat = 0, d_bias = 0;
+    for (int i = threadIdx.x; i < imsize; i += blockDim.x) {
+      d_x_hat += d_y_c[i] * (x_c[i] - x_mean);
+      d_bias += d_y_c[i];
+    }
+    NormBlockSum2(&d_x_hat, &d_bias);
+    d_x_hat *= var_inv;
+    if (threadIdx.x == 0) {
+      if (partial_scale) partial_scale[n * C + c_begin + c] = d_x_hat;
+      if (partial_bias) partial_bias[n * C + c_begin + c] = d_bias;
+    }
+    T s = scale ? scale[c_begin + c] : static_cast<T>(1);
+    d_mean += s * d_bias;
+    d_mean_x_hat += s * d_x_hat;
+  }
+  if (d_x == nullptr) return;
+
+  int size = number * imsize;
+  d_mean /= size;
+  d_mean_x_hat /= size;
+  for (int i = threadIdx.x; i < size; i += blockDim.x) {
+    T s = scale ? scale[c_begin + i / imsize] : static_cast<T>(1);
+    T x_hat = (x[offset + i] - x_mean) * var_inv;
+    d_x[offset + i] =
+        var_inv * (d_y[offset + i] * s - d_mean - x_hat * d_mean_x_hat);
   }
 }
 
@@ -224,57 +167,43 @@ class GroupNormGradKernel<platform::CUDADeviceContext, T>
     auto* d_bias = ctx.Output<Tensor>(framework::GradVarName("Bias"));
 
     const auto& x_dims = x->dims();
-    const int group_size = (x_dims[1] - 1) / groups + 1;
-
-    T* d_x_data = nullptr;
-    if (d_x) {
-      d_x->mutable_data<T>(ctx.GetPlace());
-      d_x_data = d_x->data<T>();
-    }
-    math::SetConstant<platform::CUDADeviceContext, T> set_zero;
+    const int N = x_dims[0];
+    const int C = x_dims[1];
+    const int group_size = (C - 1) / groups + 1;
     auto& dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
 
-    Tensor temp_var;
-    temp_var.mutable_data<T>(var->dims(), ctx.GetPlace());
-    set_zero(dev_ctx, &temp_var, static_cast<T>(0));
-    T* temp_var_data = temp_var.data<T>();
-
-    Tensor temp_mean;
-    temp_mean.mutable_data<T>(var->dims(), ctx.GetPlace());
-    set_zero(dev_ctx, &temp_mean, static_cast<T>(0));
-    T* temp_mean_data = temp_mean.data<T>();
-
-    auto* x_data = x->data<T>();
-    auto* y_data = d_y->data<T>();
-    auto* mean_data = mean->data<T>();
-    auto* var_data = var->data<T>();
+    T* d_x_data = nullptr;
+    if (d_x) d_x_data = d_x->mutable_data<T>(ctx.GetPlace());
     T* d_scale_data = nullptr;
-    if (d_scale) {
-      d_scale->mutable_data<T>(ctx.GetPlace());
-      set_zero(dev_ctx, d_scale, static_cast<T>(0));
-      d_scale_data = d_scale->data<T>();
-    }
+    if (d_scale) d_scale_data = d_scale->mutable_data<T>(ctx.GetPlace());
     T* d_bias_data = nullptr;
-    if (d_bias) {
-      d_bias->mutable_data<T>(ctx.GetPlace());
-      set_zero(dev_ctx, d_bias, static_cast<T>(0));
-      d_bias_data = d_bias->data<T>();
+    if (d_bias) d_bias_data = d_bias->mutable_data<T>(ctx.GetPlace());
+
+    // The partial sums of d_scale and d_bias of the samples.
+    Tensor partial;
+    T* partial_scale = nullptr;
+    T* partial_bias = nullptr;
+    if (d_scale || d_bias) {
+      partial.mutable_data<T>({2, N, C}, ctx.GetPlace());
+      if (d_scale) partial_scale = partial.data<T>();
+      if (d_bias) partial_bias = partial.data<T>() + N * C;
     }
 
     const T* scale_data = nullptr;
     if (scale) scale_data = scale->data<T>();
 
     int imsize = x_dims[2] * x_dims[3];
-    int block_size = std::min(512, imsize);
-    dim3 grid(group_size, groups, x_dims[0]);
-    dim3 threads(block_size, 1, 1);
-    GroupNormBackwardGetMeanAndVar<T><<<grid, threads, 0, dev_ctx.stream()>>>(
-        x_data, mean_data, var_data, scale_data, y_data, x_dims[0], x_dims[1],
-        imsize, groups, group_size, epsilon, d_x_data, temp_mean_data,
-        temp_var_data, d_scale_data, d_bias_data);
-    GroupNormBackward<T><<<grid, threads, 0, dev_ctx.stream()>>>(
-        x_data, mean_data, var_data, temp_mean_data, temp_var_data, x_dims[0],
-        x_dims[1], imsize, groups, group_size, epsilon, d_x_data);
+    int block_size = NormBlockDim(imsize);
+    GroupNormBackward<T><<<N * groups, block_size, 0, dev_ctx.stream()>>>(
+        x->data<T>(), mean->data<T>(), var->data<T>(), scale_data,
+        d_y->data<T>(), C, imsize, groups, group_size, epsilon, d_x_data,
+        partial_scale, partial_bias);
+    if (d_scale || d_bias) {
+      int threads = NormBlockDim(C);
+      NormColumnSum<T><<<(C + threads - 1) / threads, threads, 0,
+                         dev_ctx.stream()>>>(partial_scale, partial_bias, N,
+                                             C, d_scale_data, d_bias_data);
+    }
   }
 };
 
@@ -0,0 +1,73 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include "paddle/fluid/operators/hash_op.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+
+// A thread computes a hash of a row. The rows of the id feeds are short, so
+// a thread hashes a row in its registers.
+template <typename T>
+__global__ void HashRowsCUDAKernel(const T* input, int64_t rows,
+                                   int64_t last_dim, size_t bytes,
+                                   int num_hash, int64_t mod_by, T* output) {
+  int64_t n = rows * num_hash;
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += blockDim.x * gridDim.x) {
+    int64_t row = i / num_hash;
+    int ihash = i % num_hash;
+    output[i] = static_cast<T>(
+        math::XXHash64(input + row * last_dim, bytes, ihash) % mod_by);
+  }
+}
+
+template <typename T>
+class HashCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    auto* out_t = context.Output<framework::LoDTensor>("Out");
+    auto* in_t = context.Input<framework::LoDTensor>("X");
+    int mod_by = context.Attr<int>("mod_by");
+    int num_hash = context.Attr<int>("num_hash");
+    auto* output = out_t->mutable_data<T>(context.GetPlace());
+
+    auto in_dims = in_t->dims();
+    auto in_lod = in_t->lod();
+    PADDLE_ENFORCE_EQ(
+        static_cast<uint64_t>(in_dims[0]), in_lod[0].back(),
+        "The actual input data's size mismatched with LoD information.");
+
+    int64_t rows = in_dims[0];
+    int64_t last_dim = in_dims[in_dims.size() - 1];
+    int64_t n = rows * num_hash;
+    if (n == 0) return;
+    auto& dev_ctx = context.cuda_device_context();
+    int block = PADDLE_CUDA_NUM_THREADS;
+    int64_t max_grid = std::max(dev_ctx.GetMaxPhysicalThreadCount() / block, 1);
+    int grid = static_cast<int>(std::min((n + block - 1) / block, max_grid));
+    HashRowsCUDAKernel<T><<<grid, block, 0, dev_ctx.stream()>>>(
+        in_t->data<T>(), rows, last_dim, HashRowBytes(last_dim), num_hash,
+        mod_by, output);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(hash, ops::HashCUDAKernel<int>,
+                        ops::HashCUDAKernel<int64_t>);
@@ -14,14 +14,44 @@ limitations under the License. */
 
 #pragma once
 
-extern "C" {
-#include <xxhash.h>
-}
+#include "paddle/fluid/framework/compute_pool.h"
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/xxhash64.h"
 
 namespace paddle {
 namespace operators {
+
+constexpr int kHashLanes = 4;
+
+// Hashes a row of bytes with the seeds [0, num_hash), and calls
+// fn(ihash, id) with the id hash % mod_by of every seed. The seeds are
+// hashed kHashLanes at once.
+template <typename Fn>
+inline void HashRow(const void* row, size_t bytes, int num_hash,
+                    int64_t mod_by, Fn fn) {
+  uint64_t seeds[kHashLanes];
+  uint64_t hashes[kHashLanes];
+  int ihash = 0;
+  for (; ihash + kHashLanes <= num_hash; ihash += kHashLanes) {
+    for (int l = 0; l < kHashLanes; ++l) seeds[l] = ihash + l;
+    math::XXHash64Lanes<kHashLanes>(row, bytes, seeds, hashes);
+    for (int l = 0; l < kHashLanes; ++l) {
+      fn(ihash + l, static_cast<int64_t>(hashes[l] % mod_by));
+    }
+  }
+  for (; ihash < num_hash; ++ihash) {
+    fn(ihash, static_cast<int64_t>(math::XXHash64(row, bytes, ihash) % mod_by));
+  }
+}
+
+// A row of the input [rows, last_dim] is hashed as its first
+// sizeof(int) * last_dim bytes, whatever its type is, which are the bytes
+// the hashes of the trained models are of.
+inline size_t HashRowBytes(int64_t last_dim) {
+  return sizeof(int) * last_dim;
+}
+
 // template <typename DeviceContext, typename T>
 template <typename T>
 class HashKerel : public framework::OpKernel<T> {
@@ -42,13 +72,18 @@ class HashKerel : public framework::OpKernel<T> {
     auto seq_length = in_dims[0];
     auto last_dim = in_dims[in_dims.size() - 1];
     auto* input = in_t->data<T>();
-    for (int idx = 0; idx < seq_length; ++idx) {
-      for (int ihash = 0; ihash != num_hash; ++ihash) {
-        output[idx * num_hash + ihash] =
-            XXH64(input, sizeof(int) * last_dim, ihash) % mod_by;
-      }
-      input += last_dim;
-    }
+    size_t bytes = HashRowBytes(last_dim);
+    framework::ParallelFor(
+        0, seq_length, framework::GrainSize(num_hash * 16),
+        [&](int64_t begin, int64_t end) {
+          for (int64_t idx = begin; idx < end; ++idx) {
+            T* out = output + idx * num_hash;
+            HashRow(input + idx * last_dim, bytes, num_hash, mod_by,
+                    [out](int ihash, int64_t id) {
+                      out[ihash] = static_cast<T>(id);
+                    });
+          }
+        });
   }
 };
 
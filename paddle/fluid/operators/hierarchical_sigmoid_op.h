@@ -234,11 +234,12 @@ class HierarchicalSigmoidGradOpKernel : public framework::OpKernel<T> {
       zero(dev_ctx, w_grad, static_cast<T>(0.0));
       bit_code->MulGradWeight(pre_out_grad, w_grad, in);
     } else {
-      framework::Vector<int64_t> real_rows = PathToRows(*path);
+      // Only the rows on the paths of the batch are touched, with or without
+      // the custom paths.
+      framework::Vector<int64_t> real_rows = bit_code->Rows(in.dims()[0]);
       auto* w_grad =
           ctx.Output<framework::SelectedRows>(framework::GradVarName("W"));
       w_grad->set_rows(real_rows);
-      // Build a map of id -> row_index to speed up finding the index of one id
       w_grad->set_height(w.dims()[0]);
       auto* w_grad_value = w_grad->mutable_value();
       framework::DDim temp_dim(w.dims());
@@ -0,0 +1,197 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/image/crop_resize_normalize_op.h"
+
+#include <cmath>
+#include <string>
+
+namespace paddle {
+namespace operators {
+
+std::vector<CropBox> GenerateCropBoxes(const framework::ExecutionContext& ctx,
+                                       const framework::Tensor& image_shape,
+                                       const std::vector<size_t>& pixels,
+                                       std::minstd_rand* engine) {
+  size_t num_images = pixels.size() - 1;
+  PADDLE_ENFORCE_EQ(static_cast<size_t>(image_shape.dims()[0]), num_images,
+                    "The LoD of Input(X) does not match Input(ImageShape).");
+  bool random_crop = ctx.Attr<bool>("random_crop");
+  bool random_flip = ctx.Attr<bool>("random_flip");
+  float crop_ratio = ctx.Attr<float>("crop_ratio");
+  auto area_range = ctx.Attr<std::vector<float>>("area_range");
+  auto aspect_ratio_range = ctx.Attr<std::vector<float>>("aspect_ratio_range");
+
+  std::uniform_real_distribution<float> uniform(0, 1);
+  const int* shapes = image_shape.data<int>();
+  std::vector<CropBox> boxes(num_images);
+  for (size_t i = 0; i < num_images; ++i) {
+    CropBox& box = boxes[i];
+    box.offset = static_cast<int64_t>(pixels[i]);
+    box.height = shapes[2 * i];
+    box.width = shapes[2 * i + 1];
+    PADDLE_ENFORCE_EQ(static_cast<size_t>(box.height) * box.width,
+                      pixels[i + 1] - pixels[i],
+                      "The pixels of image %d do not match its shape.", i);
+    PADDLE_ENFORCE(box.height > 0 && box.width > 0, "Image %d is empty.", i);
+
+    // The center crop is the fallback of the random one.
+    box.h = box.height * crop_ratio;
+    box.w = box.width * crop_ratio;
+    box.y = (box.height - box.h) / 2;
+    box.x = (box.width - box.w) / 2;
+    if (random_crop) {
+      // Sample the area and the log aspect ratio of the crop uniformly, as
+      // the random sized crop of the Inception training.
+      float area = static_cast<float>(box.height) * box.width;
+      float log_min = std::log(aspect_ratio_range[0]);
+      float log_max = std::log(aspect_ratio_range[1]);
+      for (int attempt = 0; attempt < 10; ++attempt) {
+        float target_area =
+            area * (area_range[0] +
+                    (area_range[1] - area_range[0]) * uniform(*engine));
+        float ratio =
+            std::exp(log_min + (log_max - log_min) * uniform(*engine));
+        float w = std::round(std::sqrt(target_area * ratio));
+        float h = std::round(std::sqrt(target_area / ratio));
+        if (w > 0 && h > 0 && w <= box.width && h <= box.height) {
+          box.h = h;
+          box.w = w;
+          box.y = std::floor((box.height - h + 1) * uniform(*engine));
+          box.x = std::floor((box.width - w + 1) * uniform(*engine));
+          break;
+        }
+      }
+    }
+    box.flip = random_flip && uniform(*engine) < 0.5f;
+  }
+  return boxes;
+}
+
+class CropResizeNormalizeOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("X"),
+                   "Input(X) of CropResizeNormalizeOp should not be null.");
+    PADDLE_ENFORCE(
+        ctx->HasInput("ImageShape"),
+        "Input(ImageShape) of CropResizeNormalizeOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("Out"),
+                   "Output(Out) of CropResizeNormalizeOp should not be null.");
+    auto x_dims = ctx->GetInputDim("X");
+    PADDLE_ENFORCE_EQ(x_dims.size(), 2,
+                      "Input(X) should be the pixels of shape [N, channels].");
+    auto shape_dims = ctx->GetInputDim("ImageShape");
+    PADDLE_ENFORCE(shape_dims.size() == 2 && shape_dims[1] == 2,
+                   "Input(ImageShape) should be of shape [images, 2].");
+    auto size = ctx->Attrs().Get<std::vector<int>>("size");
+    PADDLE_ENFORCE(size.size() == 2 && size[0] > 0 && size[1] > 0,
+                   "Attr(size) should be the positive height and width.");
+    ctx->SetOutputDim("Out", {shape_dims[0], x_dims[1], size[0], size[1]});
+    if (ctx->HasOutput("SeedOut")) {
+      ctx->SetOutputDim("SeedOut", {1});
+    }
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(ctx.Input<framework::LoDTensor>("X")->type(),
+                                   ctx.device_context());
+  }
+
+  // The shapes and the seed are read on the host.
+  framework::OpKernelType GetKernelTypeForVar(
+      const std::string& var_name, const framework::Tensor& tensor,
+      const framework::OpKernelType& expected_kernel_type) const override {
+    if (var_name == "ImageShape" || var_name == "Seed") {
+      return expected_kernel_type;
+    }
+    return framework::OperatorWithKernel::GetKernelTypeForVar(
+        var_name, tensor, expected_kernel_type);
+  }
+};
+
+class CropResizeNormalizeOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("X",
+             "(LoDTensor<uint8>) The pixels of the images in the HWC layout, "
+             "of shape [total pixels, channels], e.g. the output of "
+             "decode_jpeg. Each sequence of the LoD is an image.");
+    AddInput("ImageShape",
+             "(Tensor<int32>) The height and the width of the images, of "
+             "shape [number of images, 2].");
+    AddInput("Seed", "(Tensor<int64>) The random seed.").AsDispensable();
+    AddOutput("Out",
+              "(Tensor<float>) The normalized images in the NCHW layout, of "
+              "shape [number of images, channels, height, width].");
+    AddOutput("SeedOut", "The random seed after the crops.")
+        .AsDispensable()
+        .AsIntermediate();
+    AddAttr<std::vector<int>>("size", "The height and the width of Out.");
+    AddAttr<bool>("random_crop",
+                  "Crop a random region as the Inception training, otherwise "
+                  "crop the center.")
+        .SetDefault(false);
+    AddAttr<float>("crop_ratio",
+                   "The ratio of the sides of the center crop to the image.")
+        .SetDefault(1.0f);
+    AddAttr<std::vector<float>>(
+        "area_range", "The range of the area ratio of the random crops.")
+        .SetDefault({0.08f, 1.0f});
+    AddAttr<std::vector<float>>(
+        "aspect_ratio_range",
+        "The range of the aspect ratio, width / height, of the random crops.")
+        .SetDefault({3.0f / 4, 4.0f / 3});
+    AddAttr<bool>("random_flip", "Flip the images horizontally at random.")
+        .SetDefault(false);
+    AddAttr<std::vector<float>>(
+        "mean", "The mean of the pixels of the channels, or of all of them.")
+        .SetDefault({});
+    AddAttr<std::vector<float>>(
+        "std", "The std of the pixels of the channels, or of all of them.")
+        .SetDefault({});
+    AddAttr<int>("startup_seed",
+                 "The random seed if the input 'Seed' is not initialized.")
+        .SetDefault(0);
+    AddComment(R"DOC(
+CropResizeNormalize Operator.
+
+Crop the images of different sizes, resize the crops to the same size by the
+bilinear interpolation, and normalize them, in one kernel without the
+intermediate images:
+
+$$Out = (Resize(Crop(X)) - mean) / std$$
+
+The pixels are in the range of [0, 255] before the normalization. The crops
+and the flips are sampled on the host, the kernel runs on the place of the op,
+so the uint8 images are copied to the device instead of the float ones.
+
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(crop_resize_normalize, ops::CropResizeNormalizeOp,
+                  ops::CropResizeNormalizeOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    crop_resize_normalize,
+    ops::CropResizeNormalizeKernel<paddle::platform::CPUDeviceContext>);
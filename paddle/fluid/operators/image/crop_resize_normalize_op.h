@@ -0,0 +1,177 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/platform/for_range.h"
+
+namespace paddle {
+namespace operators {
+
+// The region of an image to resize, in the source pixels.
+struct CropBox {
+  // The first pixel of the image in Input(X).
+  int64_t offset;
+  int height;
+  int width;
+  float y;
+  float x;
+  float h;
+  float w;
+  int flip;
+};
+
+// Sample the crop boxes of the images on the host, draws from the engine only
+// for the random crops and flips.
+std::vector<CropBox> GenerateCropBoxes(const framework::ExecutionContext& ctx,
+                                       const framework::Tensor& image_shape,
+                                       const std::vector<size_t>& pixels,
+                                       std::minstd_rand* engine);
+
+// Resize a channel of a pixel of the output by the bilinear interpolation, and
+// normalize it.
+template <typename T>
+struct CropResizeNormalizeFunctor {
+  const uint8_t* x;
+  const CropBox* boxes;
+  // The mean and the reciprocal of the std of the channels.
+  const float* mean;
+  const float* inv_std;
+  int channels;
+  int out_h;
+  int out_w;
+  T* out;
+
+  HOSTDEVICE void operator()(size_t i) const {
+    int ox = static_cast<int>(i % out_w);
+    size_t rest = i / out_w;
+    int oy = static_cast<int>(rest % out_h);
+    rest /= out_h;
+    int c = static_cast<int>(rest % channels);
+    const CropBox& box = boxes[rest / channels];
+    if (box.flip) ox = out_w - 1 - ox;
+
+    // The centers of the pixels are aligned, as the align_corners=False of
+    // image_resize.
+    float sy = box.y + (oy + 0.5f) * box.h / out_h - 0.5f;
+    float sx = box.x + (ox + 0.5f) * box.w / out_w - 0.5f;
+    sy = sy < 0 ? 0 : (sy > box.height - 1 ? box.height - 1 : sy);
+    sx = sx < 0 ? 0 : (sx > box.width - 1 ? box.width - 1 : sx);
+    int y0 = static_cast<int>(sy);
+    int x0 = static_cast<int>(sx);
+    int y1 = y0 + 1 < box.height ? y0 + 1 : y0;
+    int x1 = x0 + 1 < box.width ? x0 + 1 : x0;
+    float ly = sy - y0;
+    float lx = sx - x0;
+
+    const uint8_t* image = x + box.offset * channels + c;
+    auto at = [&](int row, int col) {
+      return static_cast<float>(
+          image[(static_cast<int64_t>(row) * box.width + col) * channels]);
+    };
+    float value = (1 - ly) * ((1 - lx) * at(y0, x0) + lx * at(y0, x1)) +
+                  ly * ((1 - lx) * at(y1, x0) + lx * at(y1, x1));
+    out[i] = static_cast<T>((value - mean[c]) * inv_std[c]);
+  }
+};
+
+template <typename DeviceContext>
+class CropResizeNormalizeKernel : public framework::OpKernel<uint8_t> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* x = ctx.Input<framework::LoDTensor>("X");
+    auto* out = ctx.Output<framework::Tensor>("Out");
+    auto& dev_ctx = ctx.template device_context<DeviceContext>();
+    auto place = ctx.GetPlace();
+
+    // The shapes and the seed are small, and are read on the host.
+    framework::Tensor image_shape;
+    framework::TensorCopySync(*ctx.Input<framework::Tensor>("ImageShape"),
+                              platform::CPUPlace(), &image_shape);
+    int64_t seed = ctx.Attr<int>("startup_seed");
+    auto* seed_tensor = ctx.Input<framework::Tensor>("Seed");
+    if (seed_tensor != nullptr && seed_tensor->IsInitialized()) {
+      framework::Tensor cpu_seed;
+      framework::TensorCopySync(*seed_tensor, platform::CPUPlace(), &cpu_seed);
+      seed = *cpu_seed.data<int64_t>();
+    }
+    std::minstd_rand engine(seed);
+
+    std::vector<size_t> pixels;
+    if (x->lod().empty()) {
+      pixels = {0, static_cast<size_t>(x->dims()[0])};
+    } else {
+      pixels = x->lod()[0];
+    }
+    std::vector<CropBox> boxes =
+        GenerateCropBoxes(ctx, image_shape, pixels, &engine);
+
+    int channels = static_cast<int>(x->dims()[1]);
+    auto mean = ctx.Attr<std::vector<float>>("mean");
+    auto stddev = ctx.Attr<std::vector<float>>("std");
+    std::vector<float> params(2 * channels, 1);
+    for (int c = 0; c < channels; ++c) {
+      params[c] = mean.empty() ? 0 : mean[mean.size() == 1 ? 0 : c];
+      if (!stddev.empty()) {
+        params[channels + c] = 1 / stddev[stddev.size() == 1 ? 0 : c];
+      }
+    }
+
+    // Copy the boxes and the parameters to the place of the kernel.
+    framework::Tensor cpu_args, args;
+    size_t boxes_bytes = boxes.size() * sizeof(CropBox);
+    size_t params_bytes = params.size() * sizeof(float);
+    auto* cpu_data = cpu_args.mutable_data<int8_t>(
+        framework::make_ddim(
+            {static_cast<int64_t>(boxes_bytes + params_bytes)}),
+        platform::CPUPlace());
+    std::memcpy(cpu_data, boxes.data(), boxes_bytes);
+    std::memcpy(cpu_data + boxes_bytes, params.data(), params_bytes);
+    framework::TensorCopySync(cpu_args, place, &args);
+    const int8_t* args_data = args.data<int8_t>();
+
+    auto size = ctx.Attr<std::vector<int>>("size");
+    CropResizeNormalizeFunctor<float> functor;
+    functor.x = x->data<uint8_t>();
+    functor.boxes = reinterpret_cast<const CropBox*>(args_data);
+    functor.mean = reinterpret_cast<const float*>(args_data + boxes_bytes);
+    functor.inv_std = functor.mean + channels;
+    functor.channels = channels;
+    functor.out_h = size[0];
+    functor.out_w = size[1];
+    functor.out = out->mutable_data<float>(
+        framework::make_ddim({static_cast<int64_t>(boxes.size()), channels,
+                              size[0], size[1]}),
+        place);
+    platform::ForRange<DeviceContext> for_range(dev_ctx, out->numel());
+    for_range(functor);
+
+    auto* seed_out = ctx.Output<framework::Tensor>("SeedOut");
+    if (seed_out != nullptr) {
+      *seed_out->mutable_data<int64_t>(framework::make_ddim({1}),
+                                       platform::CPUPlace()) = engine();
+    }
+    // The arguments are released after the kernel finishes.
+    dev_ctx.Wait();
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,167 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <vector>
+
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/platform/dynload/turbojpeg.h"
+
+namespace paddle {
+namespace operators {
+
+namespace {
+
+class TurboJPEGDecompressor {
+ public:
+  TurboJPEGDecompressor() : handle_(platform::dynload::tjInitDecompress()) {
+    PADDLE_ENFORCE_NOT_NULL(handle_, "tjInitDecompress failed: %s",
+                            platform::dynload::tjGetErrorStr());
+  }
+
+  ~TurboJPEGDecompressor() { platform::dynload::tjDestroy(handle_); }
+
+  tjhandle get() const { return handle_; }
+
+ private:
+  tjhandle handle_;
+};
+
+}  // namespace
+
+class DecodeJpegOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    PADDLE_ENFORCE(ctx->HasInput("X"),
+                   "Input(X) of DecodeJpegOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("Out"),
+                   "Output(Out) of DecodeJpegOp should not be null.");
+    PADDLE_ENFORCE(ctx->HasOutput("ImageShape"),
+                   "Output(ImageShape) of DecodeJpegOp should not be null.");
+    auto x_dims = ctx->GetInputDim("X");
+    PADDLE_ENFORCE(x_dims.size() == 1 || (x_dims.size() == 2 && x_dims[1] == 1),
+                   "Input(X) should be the bytes of shape [N] or [N, 1].");
+    int channels = ctx->Attrs().Get<int>("channels");
+    ctx->SetOutputDim("Out", {-1, channels});
+    ctx->SetOutputDim("ImageShape", {-1, 2});
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(framework::proto::VarType::UINT8,
+                                   platform::CPUPlace());
+  }
+};
+
+class DecodeJpegOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("X",
+             "(LoDTensor<uint8>) The bytes of the JPEG files, each sequence "
+             "of the LoD is a file. The tensor without LoD is one file.");
+    AddOutput("Out",
+              "(LoDTensor<uint8>) The pixels of the images in the HWC "
+              "layout, of shape [total pixels, channels]. Each sequence of "
+              "the LoD is the pixels of an image.");
+    AddOutput("ImageShape",
+              "(Tensor<int32>) The height and the width of the images, of "
+              "shape [number of images, 2].");
+    AddAttr<int>("channels",
+                 "The channels of the decoded images, 3 for RGB and 1 for "
+                 "the grayscale.")
+        .SetDefault(3)
+        .AddCustomChecker([](const int& channels) {
+          PADDLE_ENFORCE(channels == 1 || channels == 3,
+                         "The channels should be 1 or 3.");
+        });
+    AddAttr<bool>("fast_dct",
+                  "Use the fastest inverse DCT, which is less accurate.")
+        .SetDefault(false);
+    AddComment(R"DOC(
+DecodeJpeg Operator.
+
+Decode a batch of JPEG files on CPU with the TurboJPEG API of libjpeg-turbo,
+which is loaded at runtime from the path of FLAGS_turbojpeg_dir or the system
+library path. The images may have different sizes, so they are packed into
+one LoDTensor, which can be cropped and resized into a batch of the same size
+by crop_resize_normalize.
+
+)DOC");
+  }
+};
+
+class DecodeJpegKernel : public framework::OpKernel<uint8_t> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto* x = ctx.Input<framework::LoDTensor>("X");
+    auto* out = ctx.Output<framework::LoDTensor>("Out");
+    auto* image_shape = ctx.Output<framework::Tensor>("ImageShape");
+    int channels = ctx.Attr<int>("channels");
+    int pixel_format = channels == 3 ? TJPF_RGB : TJPF_GRAY;
+    int flags = ctx.Attr<bool>("fast_dct") ? TJFLAG_FASTDCT : 0;
+
+    std::vector<size_t> files;
+    if (x->lod().empty()) {
+      files = {0, static_cast<size_t>(x->numel())};
+    } else {
+      PADDLE_ENFORCE_EQ(x->lod().size(), 1UL,
+                        "Input(X) should have at most one level of LoD.");
+      files = x->lod()[0];
+    }
+    size_t num_images = files.size() - 1;
+    auto* bytes = x->data<uint8_t>();
+
+    TurboJPEGDecompressor decompressor;
+    int* shapes = image_shape->mutable_data<int>(
+        framework::make_ddim({static_cast<int64_t>(num_images), 2}),
+        platform::CPUPlace());
+    framework::Vector<size_t> pixels(num_images + 1);
+    pixels[0] = 0;
+    for (size_t i = 0; i < num_images; ++i) {
+      int subsamp, colorspace;
+      int ret = platform::dynload::tjDecompressHeader3(
+          decompressor.get(), bytes + files[i], files[i + 1] - files[i],
+          &shapes[2 * i + 1], &shapes[2 * i], &subsamp, &colorspace);
+      PADDLE_ENFORCE_EQ(ret, 0, "The header of image %d is invalid: %s", i,
+                        platform::dynload::tjGetErrorStr());
+      pixels[i + 1] = pixels[i] + static_cast<size_t>(shapes[2 * i]) *
+                                      static_cast<size_t>(shapes[2 * i + 1]);
+    }
+
+    auto* data = out->mutable_data<uint8_t>(
+        framework::make_ddim({static_cast<int64_t>(pixels.back()), channels}),
+        platform::CPUPlace());
+    for (size_t i = 0; i < num_images; ++i) {
+      int height = shapes[2 * i];
+      int width = shapes[2 * i + 1];
+      int ret = platform::dynload::tjDecompress2(
+          decompressor.get(), bytes + files[i], files[i + 1] - files[i],
+          data + pixels[i] * channels, width, width * channels, height,
+          pixel_format, flags);
+      PADDLE_ENFORCE_EQ(ret, 0, "Decoding image %d failed: %s", i,
+                        platform::dynload::tjGetErrorStr());
+    }
+    out->set_lod({pixels});
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(decode_jpeg, ops::DecodeJpegOp, ops::DecodeJpegOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+REGISTER_OP_CPU_KERNEL(decode_jpeg, ops::DecodeJpegKernel);
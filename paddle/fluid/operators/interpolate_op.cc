@@ -34,8 +34,11 @@ class InterpolateOp : public framework::OperatorWithKernel {
     PADDLE_ENFORCE(
         "bilinear" == interp_method || "nearest" == interp_method,
         "Interpolation method can only be \"bilinear\" or \"nearest\".");
+    auto data_layout = ctx->Attrs().Get<std::string>("data_layout");
+    PADDLE_ENFORCE("NCHW" == data_layout || "NHWC" == data_layout,
+                   "Data layout can only be \"NCHW\" or \"NHWC\".");
 
-    auto dim_x = ctx->GetInputDim("X");  // NCHW format
+    auto dim_x = ctx->GetInputDim("X");  // NCHW or NHWC format
     int out_h = ctx->Attrs().Get<int>("out_h");
     int out_w = ctx->Attrs().Get<int>("out_w");
     PADDLE_ENFORCE_EQ(dim_x.size(), 4, "X's dimension must be 4");
@@ -49,6 +52,9 @@ class InterpolateOp : public framework::OperatorWithKernel {
       return;
     }
     std::vector<int64_t> dim_out({dim_x[0], dim_x[1], out_h, out_w});
+    if (data_layout == "NHWC") {
+      dim_out = {dim_x[0], out_h, out_w, dim_x[3]};
+    }
     ctx->SetOutputDim("Out", framework::make_ddim(dim_out));
   }
 
@@ -65,14 +71,16 @@ class InterpolateOpMaker : public framework::OpProtoAndCheckerMaker {
   void Make() override {
     AddInput("X",
              "The input tensor of interpolate operator, "
-             "This is a 4-D tensor with shape of [N,  C, H, w].");
+             "This is a 4-D tensor with shape of [N,  C, H, w], "
+             "or [N, H, W, C] of the data_layout NHWC.");
     AddInput("OutSize",
              "This is a 1-D tensor with two numbers to specify output size. "
              "The first number is height and the second number is width.")
         .AsDispensable();
     AddOutput("Out",
               "The output tensor of interpolate operator, "
-              "This is a 4-D tensor with shape of [N, C, H, W].");
+              "This is a 4-D tensor with shape of [N, C, H, W], "
+              "or [N, H, W, C] of the data_layout NHWC.");
 
     AddAttr<int>("out_h", "output height of interpolate op.");
     AddAttr<int>("out_w", "output width of interpolate op.");
@@ -82,6 +90,10 @@ class InterpolateOpMaker : public framework::OpProtoAndCheckerMaker {
                          "bilinear interpolation and \"nearest\" for nearest "
                          "neighbor interpolation.")
         .SetDefault("bilinear");
+    AddAttr<std::string>("data_layout",
+                         "(string, default \"NCHW\"), the layout of X and "
+                         "Out, \"NCHW\" or \"NHWC\".")
+        .SetDefault("NCHW");
     AddComment(R"DOC(
           This operator samples input X to given output shape by using specified
           interpolation method, the interpolation methods can be \"nearest\"
@@ -103,6 +115,10 @@ class InterpolateOpMaker : public framework::OpProtoAndCheckerMaker {
 
           For details of bilinear interpolation, please refer to Wikipedia: 
           https://en.wikipedia.org/wiki/Bilinear_interpolation
+
+          The source rows and columns of the outputs and their weights are
+          computed once an axis, and in the data_layout NHWC the channels
+          of a pixel are interpolated together.
          )DOC");
   }
 };
@@ -9,6 +9,8 @@
    See the License for the specific language governing permissions and
    limitations under the License. */
 
+#include <algorithm>
+#include <cstdint>
 #include <string>
 #include "paddle/fluid/operators/interpolate_op.h"
 #include "paddle/fluid/platform/cuda_primitives.h"
@@ -18,138 +20,187 @@ namespace operators {
 
 using framework::Tensor;
 
-template <typename T>
-__global__ void KeNearestNeighborInterpFw(
-    const T* in, const size_t in_img_h, const size_t in_img_w,
-    const size_t input_h, const size_t input_w, T* out, const size_t out_img_h,
-    const size_t out_img_w, const size_t output_h, const size_t output_w,
-    const size_t num_channels, const float ratio_h, const float ratio_w) {
-  int nthreads = output_h * output_w;
-  int tid = blockIdx.x * blockDim.x + threadIdx.x;
-  int stride = blockDim.x * gridDim.x;
-  for (; tid < nthreads; tid += stride) {
-    int out_id_h = tid / output_w;
-    int out_id_w = tid % output_w;
-    int in_img_size = input_w / num_channels;
-    int out_img_size = output_w / num_channels;
-    int channel_id = out_id_w / out_img_size;
+// The tables of an InterpAxis on the device.
+struct InterpAxisCUDA {
+  const int* src0;
+  const int* src1;
+  const float* lambda;
+  const int* grad_offsets;
+  const int* grad_outputs;
+  const float* grad_weights;
+};
 
-    int out_img_idy = (out_id_w % out_img_size) / out_img_w;
-    int in_img_idy = static_cast<int>(ratio_h * out_img_idy + 0.5);
+static InterpAxisCUDA InterpAxisToCUDA(const InterpAxis& axis,
+                                       const platform::Place& place,
+                                       bool with_grad) {
+  InterpAxisCUDA tables;
+  tables.src0 = with_grad ? nullptr : axis.src0.CUDAData(place);
+  tables.src1 = with_grad ? nullptr : axis.src1.CUDAData(place);
+  tables.lambda = with_grad ? nullptr : axis.lambda.CUDAData(place);
+  tables.grad_offsets = with_grad ? axis.grad_offsets.CUDAData(place) : nullptr;
+  tables.grad_outputs = with_grad ? axis.grad_outputs.CUDAData(place) : nullptr;
+  tables.grad_weights = with_grad ? axis.grad_weights.CUDAData(place) : nullptr;
+  return tables;
+}
 
-    int out_img_idx = tid % out_img_w;
-    int in_img_idx = static_cast<int>(ratio_w * out_img_idx + 0.5);
+template <typename T, int Size>
+struct alignas(sizeof(T) * Size) InterpVector {
+  T val[Size];
+};
 
-    out[tid] = in[out_id_h * input_w + channel_id * in_img_size +
-                  in_img_idy * in_img_w + in_img_idx];
+// The channels of NHWC are interpolated by the vectors of 16 bytes if the
+// rows of the channels and the tensors are aligned to them.
+template <typename T>
+static int InterpVectorSize(const T* in, const T* out, int c) {
+  constexpr int kSize =
+      (sizeof(T) < 16 && 16 % sizeof(T) == 0) ? 16 / sizeof(T) : 1;
+  if (c % kSize != 0 || reinterpret_cast<uintptr_t>(in) % 16 != 0 ||
+      reinterpret_cast<uintptr_t>(out) % 16 != 0) {
+    return 1;
   }
+  return kSize;
 }
 
-template <typename T>
-__global__ void KeNearestNeighborInterpBw(
-    T* in, const size_t in_img_h, const size_t in_img_w, const size_t input_h,
-    const size_t input_w, const T* out, const size_t out_img_h,
-    const size_t out_img_w, const size_t output_h, const size_t output_w,
-    const size_t num_channels, const float ratio_h, const float ratio_w) {
-  int nthreads = output_h * output_w;
-  int tid = blockIdx.x * blockDim.x + threadIdx.x;
-  int stride = blockDim.x * gridDim.x;
-  for (; tid < nthreads; tid += stride) {
-    int out_id_h = tid / output_w;
-    int out_id_w = tid % output_w;
-    int in_img_size = input_w / num_channels;
-    int out_img_size = output_w / num_channels;
-    int channel_id = out_id_w / out_img_size;
-
-    int out_img_idy = (out_id_w % out_img_size) / out_img_w;
-    int in_img_idy = static_cast<int>(ratio_h * out_img_idy + 0.5);
-
-    int out_img_idx = tid % out_img_w;
-    int in_img_idx = static_cast<int>(ratio_w * out_img_idx + 0.5);
+// Every thread interpolates an output of NCHW.
+template <typename T, bool Bilinear>
+__global__ void KeInterpNCHW(const T* in, T* out, int nthreads, int in_h,
+                             int in_w, int out_h, int out_w, InterpAxisCUDA h,
+                             InterpAxisCUDA w) {
+  for (int tid = blockIdx.x * blockDim.x + threadIdx.x; tid < nthreads;
+       tid += blockDim.x * gridDim.x) {
+    int l = tid % out_w;
+    int k = tid / out_w % out_h;
+    const T* plane = in + tid / (out_w * out_h) * in_h * in_w;
+    const T* r0 = plane + h.src0[k] * in_w;
+    int x0 = w.src0[l];
+    if (!Bilinear) {
+      out[tid] = r0[x0];
+      continue;
+    }
+    const T* r1 = plane + h.src1[k] * in_w;
+    int x1 = w.src1[l];
+    float h1 = h.lambda[k];
+    float w1 = w.lambda[l];
+    float h0 = 1.f - h1;
+    float w0 = 1.f - w1;
+    out[tid] = static_cast<T>(h0 * (w0 * r0[x0] + w1 * r0[x1]) +
+                              h1 * (w0 * r1[x0] + w1 * r1[x1]));
+  }
+}
 
-    T* in_pos = &in[out_id_h * input_w + channel_id * in_img_size +
-                    in_img_idy * in_img_w + in_img_idx];
-    const T out_pos = out[out_id_h * output_w + out_id_w];
-    platform::CudaAtomicAdd(in_pos, out_pos);
+// Every thread interpolates VecSize channels of an output pixel of NHWC.
+template <typename T, int VecSize, bool Bilinear>
+__global__ void KeInterpNHWC(const T* in, T* out, int nthreads, int c,
+                             int in_h, int in_w, int out_h, int out_w,
+                             InterpAxisCUDA h, InterpAxisCUDA w) {
+  using VecT = InterpVector<T, VecSize>;
+  int vecs = c / VecSize;
+  for (int tid = blockIdx.x * blockDim.x + threadIdx.x; tid < nthreads;
+       tid += blockDim.x * gridDim.x) {
+    int j = tid % vecs;
+    int pixel = tid / vecs;
+    int l = pixel % out_w;
+    int k = pixel / out_w % out_h;
+    const T* image = in + pixel / (out_w * out_h) * in_h * in_w * c;
+    const T* r0 = image + h.src0[k] * in_w * c;
+    VecT* dst = reinterpret_cast<VecT*>(out + pixel * c) + j;
+    const VecT v00 = reinterpret_cast<const VecT*>(r0 + w.src0[l] * c)[j];
+    if (!Bilinear) {
+      *dst = v00;
+      continue;
+    }
+    const T* r1 = image + h.src1[k] * in_w * c;
+    const VecT v01 = reinterpret_cast<const VecT*>(r0 + w.src1[l] * c)[j];
+    const VecT v10 = reinterpret_cast<const VecT*>(r1 + w.src0[l] * c)[j];
+    const VecT v11 = reinterpret_cast<const VecT*>(r1 + w.src1[l] * c)[j];
+    float h1 = h.lambda[k];
+    float w1 = w.lambda[l];
+    float h0 = 1.f - h1;
+    float w0 = 1.f - w1;
+    VecT result;
+#pragma unroll
+    for (int e = 0; e < VecSize; ++e) {
+      result.val[e] =
+          static_cast<T>(h0 * (w0 * v00.val[e] + w1 * v01.val[e]) +
+                         h1 * (w0 * v10.val[e] + w1 * v11.val[e]));
+    }
+    *dst = result;
   }
 }
 
+// Every thread gathers the gradient of an input of NCHW from the outputs
+// of the tables, so no atomics are needed, whatever the scales are.
 template <typename T>
-__global__ void KeBilinearInterpFw(
-    const T* in, const size_t in_img_h, const size_t in_img_w,
-    const size_t input_h, const size_t input_w, T* out, const size_t out_img_h,
-    const size_t out_img_w, const size_t output_h, const size_t output_w,
-    const size_t num_channels, const float ratio_h, const float ratio_w) {
-  int nthreads = output_h * output_w;
-  int tid = blockIdx.x * blockDim.x + threadIdx.x;
-  int stride = blockDim.x * gridDim.x;
-  for (; tid < nthreads; tid += stride) {
-    int out_id_h = tid / output_w;
-    int out_id_w = tid % output_w;
-    int in_img_size = input_w / num_channels;
-    int out_img_size = output_w / num_channels;
-    int channel_id = out_id_w / out_img_size;
-
-    int out_img_idy = (out_id_w % out_img_size) / out_img_w;
-    int in_img_idy = ratio_h * out_img_idy;
-    int h_id = (in_img_idy < in_img_h - 1) ? 1 : 0;
-    T h1lambda = ratio_h * out_img_idy - in_img_idy;
-    T h2lambda = 1.f - h1lambda;
-
-    int out_img_idx = tid % out_img_w;
-    int in_img_idx = ratio_w * out_img_idx;
-    int w_id = (in_img_idx < in_img_w - 1) ? 1 : 0;
-    T w1lambda = ratio_w * out_img_idx - in_img_idx;
-    T w2lambda = 1.f - w1lambda;
-
-    const T* in_pos = &in[out_id_h * input_w + channel_id * in_img_size +
-                          in_img_idy * in_img_w + in_img_idx];
-
-    // bilinear interpolation
-    out[out_id_h * output_w + out_id_w] =
-        h2lambda * (w2lambda * in_pos[0] + w1lambda * in_pos[w_id]) +
-        h1lambda * (w2lambda * in_pos[h_id * in_img_w] +
-                    w1lambda * in_pos[h_id * in_img_w + w_id]);
+__global__ void KeInterpGradNCHW(const T* out_grad, T* in_grad, int nthreads,
+                                 int in_h, int in_w, int out_h, int out_w,
+                                 InterpAxisCUDA h, InterpAxisCUDA w) {
+  for (int tid = blockIdx.x * blockDim.x + threadIdx.x; tid < nthreads;
+       tid += blockDim.x * gridDim.x) {
+    int x = tid % in_w;
+    int y = tid / in_w % in_h;
+    const T* plane = out_grad + tid / (in_w * in_h) * out_h * out_w;
+    T sum = 0;
+    for (int e = h.grad_offsets[y]; e < h.grad_offsets[y + 1]; ++e) {
+      const T* row = plane + h.grad_outputs[e] * out_w;
+      T row_sum = 0;
+      for (int f = w.grad_offsets[x]; f < w.grad_offsets[x + 1]; ++f) {
+        row_sum += static_cast<T>(w.grad_weights[f]) * row[w.grad_outputs[f]];
+      }
+      sum += static_cast<T>(h.grad_weights[e]) * row_sum;
+    }
+    in_grad[tid] = sum;
   }
 }
 
+// The threads of the channels of an input pixel of NHWC read the adjacent
+// channels of the outputs.
 template <typename T>
-__global__ void KeBilinearInterpBw(
-    T* in, const size_t in_img_h, const size_t in_img_w, const size_t input_h,
-    const size_t input_w, const T* out, const size_t out_img_h,
-    const size_t out_img_w, const size_t output_h, const size_t output_w,
-    const size_t num_channels, const T ratio_h, const T ratio_w) {
-  int nthreads = output_h * output_w;
-  int tid = blockIdx.x * blockDim.x + threadIdx.x;
-  int stride = blockDim.x * gridDim.x;
-  for (; tid < nthreads; tid += stride) {
-    int out_id_h = tid / output_w;
-    int out_id_w = tid % output_w;
-    int in_img_size = input_w / num_channels;
-    int out_img_size = output_w / num_channels;
-    int channel_id = out_id_w / out_img_size;
-
-    int out_img_idy = (out_id_w % out_img_size) / out_img_w;
-    int in_img_idy = ratio_h * out_img_idy;
-    int h_id = (in_img_idy < in_img_h - 1) ? 1 : 0;
-    T h1lambda = ratio_h * out_img_idy - in_img_idy;
-    T h2lambda = 1.f - h1lambda;
+__global__ void KeInterpGradNHWC(const T* out_grad, T* in_grad, int nthreads,
+                                 int c, int in_h, int in_w, int out_h,
+                                 int out_w, InterpAxisCUDA h,
+                                 InterpAxisCUDA w) {
+  for (int tid = blockIdx.x * blockDim.x + threadIdx.x; tid < nthreads;
+       tid += blockDim.x * gridDim.x) {
+    int j = tid % c;
+    int pixel = tid / c;
+    int x = pixel % in_w;
+    int y = pixel / in_w % in_h;
+    const T* image = out_grad + pixel / (in_w * in_h) * out_h * out_w * c + j;
+    T sum = 0;
+    for (int e = h.grad_offsets[y]; e < h.grad_offsets[y + 1]; ++e) {
+      const T* row = image + h.grad_outputs[e] * out_w * c;
+      T row_sum = 0;
+      for (int f = w.grad_offsets[x]; f < w.grad_offsets[x + 1]; ++f) {
+        row_sum +=
+            static_cast<T>(w.grad_weights[f]) * row[w.grad_outputs[f] * c];
+      }
+      sum += static_cast<T>(h.grad_weights[e]) * row_sum;
+    }
+    in_grad[tid] = sum;
+  }
+}
 
-    int out_img_idx = tid % out_img_w;
-    int in_img_idx = ratio_w * out_img_idx;
-    int w_id = (in_img_idx < in_img_w - 1) ? 1 : 0;
-    T w1lambda = ratio_w * out_img_idx - in_img_idx;
-    T w2lambda = 1.f - w1lambda;
+static int InterpGrids(const platform::CUDADeviceContext& context,
+                       int nthreads, int threads) {
+  int grids = (nthreads + threads - 1) / threads;
+  return std::max(
+      std::min(grids, context.GetMaxPhysicalThreadCount() / threads), 1);
+}
 
-    T* in_pos = &in[out_id_h * input_w + channel_id * in_img_size +
-                    in_img_idy * in_img_w + in_img_idx];
-    const T* out_pos = &out[out_id_h * output_w + out_id_w];
-    platform::CudaAtomicAdd(&in_pos[0], h2lambda * w2lambda * out_pos[0]);
-    platform::CudaAtomicAdd(&in_pos[w_id], h2lambda * w1lambda * out_pos[0]);
-    platform::CudaAtomicAdd(&in_pos[h_id * in_img_w],
-                            h1lambda * w2lambda * out_pos[0]);
-    platform::CudaAtomicAdd(&in_pos[h_id * in_img_w + w_id],
-                            h1lambda * w1lambda * out_pos[0]);
+template <typename T, int VecSize>
+static void InterpNHWC(const platform::CUDADeviceContext& context, const T* in,
+                       T* out, int n, int c, int in_h, int in_w, int out_h,
+                       int out_w, bool bilinear, const InterpAxisCUDA& h,
+                       const InterpAxisCUDA& w) {
+  int threads = 512;
+  int nthreads = n * out_h * out_w * (c / VecSize);
+  int grids = InterpGrids(context, nthreads, threads);
+  if (bilinear) {
+    KeInterpNHWC<T, VecSize, true><<<grids, threads, 0, context.stream()>>>(
+        in, out, nthreads, c, in_h, in_w, out_h, out_w, h, w);
+  } else {
+    KeInterpNHWC<T, VecSize, false><<<grids, threads, 0, context.stream()>>>(
+        in, out, nthreads, c, in_h, in_w, out_h, out_w, h, w);
   }
 }
 
@@ -164,6 +215,7 @@ class InterpolateOpCUDAKernel : public framework::OpKernel<T> {
     auto* input_data = input->data<T>();
 
     auto interp_method = ctx.Attr<std::string>("interp_method");
+    auto data_layout = ctx.Attr<std::string>("data_layout");
     int out_h = ctx.Attr<int>("out_h");
     int out_w = ctx.Attr<int>("out_w");
     auto out_size = ctx.Input<Tensor>("OutSize");
@@ -175,43 +227,49 @@ class InterpolateOpCUDAKernel : public framework::OpKernel<T> {
       out_w = size_data[1];
     }
 
-    int n = input->dims()[0];
-    int c = input->dims()[1];
-    int in_h = input->dims()[2];
-    int in_w = input->dims()[3];
-
-    auto* output_data =
-        output->mutable_data<T>({n, c, out_h, out_w}, ctx.GetPlace());
+    int n, c, in_h, in_w;
+    ExtractInterpDims(input->dims(), data_layout, &n, &c, &in_h, &in_w);
 
-    int in_hw = in_h * in_w;
-    int out_hw = out_h * out_w;
-    int in_chw = c * in_hw;
-    int out_chw = c * out_hw;
-
-    float ratio_h =
-        (out_h > 1) ? static_cast<float>(in_h - 1) / (out_h - 1) : 0.f;
-    float ratio_w =
-        (out_w > 1) ? static_cast<float>(in_w - 1) / (out_w - 1) : 0.f;
+    auto* output_data = output->mutable_data<T>(
+        InterpDims(n, c, out_h, out_w, data_layout), ctx.GetPlace());
 
     if (in_h == out_h && in_w == out_w) {
       framework::TensorCopy(*input, ctx.GetPlace(), output);
       return;
     }
 
-    int pixelNum = n * out_chw;
-    int grid_dim = (pixelNum + 512 - 1) / 512;
-    grid_dim = grid_dim > 8 ? 8 : grid_dim;
+    bool bilinear = "bilinear" == interp_method;
+    InterpAxis h_axis, w_axis;
+    ComputeInterpAxis(in_h, out_h, bilinear, &h_axis);
+    ComputeInterpAxis(in_w, out_w, bilinear, &w_axis);
+    auto h = InterpAxisToCUDA(h_axis, ctx.GetPlace(), false);
+    auto w = InterpAxisToCUDA(w_axis, ctx.GetPlace(), false);
+
+    auto& dev_ctx = ctx.cuda_device_context();
+    if (data_layout == "NHWC") {
+      int vec_size = InterpVectorSize(input_data, output_data, c);
+      if (vec_size == 4) {
+        InterpNHWC<T, 4>(dev_ctx, input_data, output_data, n, c, in_h, in_w,
+                         out_h, out_w, bilinear, h, w);
+      } else if (vec_size == 2) {
+        InterpNHWC<T, 2>(dev_ctx, input_data, output_data, n, c, in_h, in_w,
+                         out_h, out_w, bilinear, h, w);
+      } else {
+        InterpNHWC<T, 1>(dev_ctx, input_data, output_data, n, c, in_h, in_w,
+                         out_h, out_w, bilinear, h, w);
+      }
+      return;
+    }
 
-    if ("nearest" == interp_method) {
-      KeNearestNeighborInterpFw<
-          T><<<grid_dim, 512, 0, ctx.cuda_device_context().stream()>>>(
-          input_data, in_h, in_w, n, in_chw, output_data, out_h, out_w, n,
-          out_chw, c, ratio_h, ratio_w);
-    } else if ("bilinear" == interp_method) {
-      KeBilinearInterpFw<
-          T><<<grid_dim, 512, 0, ctx.cuda_device_context().stream()>>>(
-          input_data, in_h, in_w, n, in_chw, output_data, out_h, out_w, n,
-          out_chw, c, ratio_h, ratio_w);
+    int threads = 512;
+    int nthreads = n * c * out_h * out_w;
+    int grids = InterpGrids(dev_ctx, nthreads, threads);
+    if (bilinear) {
+      KeInterpNCHW<T, true><<<grids, threads, 0, dev_ctx.stream()>>>(
+          input_data, output_data, nthreads, in_h, in_w, out_h, out_w, h, w);
+    } else {
+      KeInterpNCHW<T, false><<<grids, threads, 0, dev_ctx.stream()>>>(
+          input_data, output_data, nthreads, in_h, in_w, out_h, out_w, h, w);
     }
   }
 };
@@ -225,12 +283,8 @@ class InterpolateGradOpCUDAKernel : public framework::OpKernel<T> {
     auto* output_grad_data = output_grad->data<T>();
     auto* input_grad_data = input_grad->mutable_data<T>(ctx.GetPlace());
 
-    auto& device_ctx =
-        ctx.template device_context<platform::CUDADeviceContext>();
-    math::SetConstant<platform::CUDADeviceContext, T> zero;
-    zero(device_ctx, input_grad, static_cast<T>(0.0));
-
     auto interp_method = ctx.Attr<std::string>("interp_method");
+    auto data_layout = ctx.Attr<std::string>("data_layout");
     int out_h = ctx.Attr<int>("out_h");
     int out_w = ctx.Attr<int>("out_w");
     auto out_size = ctx.Input<Tensor>("OutSize");
@@ -242,40 +296,34 @@ class InterpolateGradOpCUDAKernel : public framework::OpKernel<T> {
       out_w = size_data[1];
     }
 
-    int n = input_grad->dims()[0];
-    int c = input_grad->dims()[1];
-    int in_h = input_grad->dims()[2];
-    int in_w = input_grad->dims()[3];
-
-    int in_hw = in_h * in_w;
-    int out_hw = out_h * out_w;
-    int in_chw = c * in_hw;
-    int out_chw = c * out_hw;
-
-    float ratio_h =
-        (out_h > 1) ? static_cast<float>(in_h - 1) / (out_h - 1) : 0.f;
-    float ratio_w =
-        (out_w > 1) ? static_cast<float>(in_w - 1) / (out_w - 1) : 0.f;
+    int n, c, in_h, in_w;
+    ExtractInterpDims(input_grad->dims(), data_layout, &n, &c, &in_h, &in_w);
 
     if (in_h == out_h && in_w == out_w) {
       framework::TensorCopy(*output_grad, ctx.GetPlace(), input_grad);
       return;
     }
 
-    int pixelNum = n * out_chw;
-    int grid_dim = (pixelNum + 512 - 1) / 512;
-    grid_dim = grid_dim > 8 ? 8 : grid_dim;
-
-    if ("nearest" == interp_method) {
-      KeNearestNeighborInterpBw<
-          T><<<grid_dim, 512, 0, ctx.cuda_device_context().stream()>>>(
-          input_grad_data, in_h, in_w, n, in_chw, output_grad_data, out_h,
-          out_w, n, out_chw, c, ratio_h, ratio_w);
-    } else if ("bilinear" == interp_method) {
-      KeBilinearInterpBw<
-          T><<<grid_dim, 512, 0, ctx.cuda_device_context().stream()>>>(
-          input_grad_data, in_h, in_w, n, in_chw, output_grad_data, out_h,
-          out_w, n, out_chw, c, ratio_h, ratio_w);
+    // Every input gradient is written by the gather, so it is not zeroed.
+    bool bilinear = "bilinear" == interp_method;
+    InterpAxis h_axis, w_axis;
+    ComputeInterpAxis(in_h, out_h, bilinear, &h_axis);
+    ComputeInterpAxis(in_w, out_w, bilinear, &w_axis);
+    auto h = InterpAxisToCUDA(h_axis, ctx.GetPlace(), true);
+    auto w = InterpAxisToCUDA(w_axis, ctx.GetPlace(), true);
+
+    auto& dev_ctx = ctx.cuda_device_context();
+    int threads = 512;
+    int nthreads = n * c * in_h * in_w;
+    int grids = InterpGrids(dev_ctx, nthreads, threads);
+    if (data_layout == "NHWC") {
+      KeInterpGradNHWC<T><<<grids, threads, 0, dev_ctx.stream()>>>(
+          output_grad_data, input_grad_data, nthreads, c, in_h, in_w, out_h,
+          out_w, h, w);
+    } else {
+      KeInterpGradNCHW<T><<<grids, threads, 0, dev_ctx.stream()>>>(
+          output_grad_data, input_grad_data, nthreads, in_h, in_w, out_h,
+          out_w, h, w);
     }
   }
 };
@@ -10,126 +10,246 @@
    limitations under the License. */
 
 #pragma once
+#include <algorithm>
 #include <string>
+#include <vector>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/math/math_function.h"
 
 namespace paddle {
 namespace operators {
 
-template <typename T, size_t D, int MajorType = Eigen::RowMajor,
-          typename IndexType = Eigen::DenseIndex>
-using EigenTensor = framework::EigenTensor<T, D, MajorType, IndexType>;
 using Tensor = framework::Tensor;
 
+// The interpolation of an axis of out_size outputs from in_size inputs: the
+// output k is (1 - lambda[k]) * input src0[k] + lambda[k] * input src1[k].
+// The transpose of it, the outputs an input i gathers its gradient from, is
+// grad_outputs[grad_offsets[i], grad_offsets[i + 1]) of the weights of
+// grad_weights, so that the gradient needs no atomics on GPU.
+struct InterpAxis {
+  framework::Vector<int> src0;
+  framework::Vector<int> src1;
+  framework::Vector<float> lambda;
+  framework::Vector<int> grad_offsets;
+  framework::Vector<int> grad_outputs;
+  framework::Vector<float> grad_weights;
+};
+
+// The sources of an axis are computed once, instead of for every element.
+static inline void ComputeInterpAxis(int in_size, int out_size, bool bilinear,
+                                     InterpAxis* axis) {
+  float ratio =
+      (out_size > 1) ? static_cast<float>(in_size - 1) / (out_size - 1) : 0.f;
+  axis->src0.resize(out_size);
+  axis->src1.resize(out_size);
+  axis->lambda.resize(out_size);
+  std::vector<int> counts(in_size + 1, 0);
+  for (int k = 0; k < out_size; ++k) {
+    int s;
+    float lambda = 0.f;
+    if (bilinear) {
+      s = static_cast<int>(ratio * k);
+      lambda = ratio * k - s;
+    } else {
+      s = static_cast<int>(ratio * k + 0.5);
+    }
+    axis->src0[k] = s;
+    axis->src1[k] = bilinear ? std::min(s + 1, in_size - 1) : s;
+    axis->lambda[k] = lambda;
+    if (1.f - lambda != 0.f) ++counts[s + 1];
+    if (lambda != 0.f) ++counts[axis->src1[k] + 1];
+  }
+  for (int i = 0; i < in_size; ++i) counts[i + 1] += counts[i];
+  axis->grad_offsets.assign(counts.begin(), counts.end());
+  axis->grad_outputs.resize(counts[in_size]);
+  axis->grad_weights.resize(counts[in_size]);
+  for (int k = 0; k < out_size; ++k) {
+    float lambda = axis->lambda[k];
+    if (1.f - lambda != 0.f) {
+      int pos = counts[axis->src0[k]]++;
+      axis->grad_outputs[pos] = k;
+      axis->grad_weights[pos] = 1.f - lambda;
+    }
+    if (lambda != 0.f) {
+      int pos = counts[axis->src1[k]]++;
+      axis->grad_outputs[pos] = k;
+      axis->grad_weights[pos] = lambda;
+    }
+  }
+}
+
+// The dims of a 4-D tensor of the data_layout, NCHW or NHWC.
+static inline void ExtractInterpDims(const framework::DDim& dims,
+                                     const std::string& data_layout, int* n,
+                                     int* c, int* h, int* w) {
+  *n = dims[0];
+  if (data_layout == "NHWC") {
+    *h = dims[1];
+    *w = dims[2];
+    *c = dims[3];
+  } else {
+    *c = dims[1];
+    *h = dims[2];
+    *w = dims[3];
+  }
+}
+
+static inline framework::DDim InterpDims(int n, int c, int h, int w,
+                                         const std::string& data_layout) {
+  return data_layout == "NHWC" ? framework::make_ddim({n, h, w, c})
+                               : framework::make_ddim({n, c, h, w});
+}
+
 template <typename T>
-static void NearestNeighborInterpolate(const Tensor& input, Tensor* output,
-                                       const float ratio_h, const float ratio_w,
-                                       const int n, const int c,
-                                       const int out_h, const int out_w) {
-  auto input_t = EigenTensor<T, 4>::From(input);
-  auto output_t = EigenTensor<T, 4>::From(*output);
-  for (int k = 0; k < out_h; k++) {  // loop for images
-    int in_k = static_cast<int>(ratio_h * k + 0.5);
-
-    for (int l = 0; l < out_w; l++) {
-      int in_l = static_cast<int>(ratio_w * l + 0.5);
-
-      for (int i = 0; i < n; i++) {    // loop for batches
-        for (int j = 0; j < c; j++) {  // loop for channels
-          output_t(i, j, k, l) = input_t(i, j, in_k, in_l);
+static void InterpolateNCHW(const T* in, T* out, int nc, int in_h, int in_w,
+                            int out_h, int out_w, bool bilinear,
+                            const InterpAxis& h, const InterpAxis& w) {
+  const int* hs0 = h.src0.data();
+  const int* hs1 = h.src1.data();
+  const float* hl = h.lambda.data();
+  const int* ws0 = w.src0.data();
+  const int* ws1 = w.src1.data();
+  const float* wl = w.lambda.data();
+  for (int i = 0; i < nc; ++i) {
+    const T* plane = in + i * in_h * in_w;
+    for (int k = 0; k < out_h; ++k) {
+      const T* r0 = plane + hs0[k] * in_w;
+      const T* r1 = plane + hs1[k] * in_w;
+      float h1 = hl[k];
+      float h0 = 1.f - h1;
+      if (!bilinear) {
+        for (int l = 0; l < out_w; ++l) out[l] = r0[ws0[l]];
+      } else {
+        for (int l = 0; l < out_w; ++l) {
+          int x0 = ws0[l];
+          int x1 = ws1[l];
+          float w1 = wl[l];
+          float w0 = 1.f - w1;
+          out[l] = static_cast<T>(h0 * (w0 * r0[x0] + w1 * r0[x1]) +
+                                  h1 * (w0 * r1[x0] + w1 * r1[x1]));
         }
       }
+      out += out_w;
     }
   }
 }
 
+// The channels are contiguous in NHWC, so the inner loop runs over them.
 template <typename T>
-static void BilinearInterpolation(const Tensor& input, Tensor* output,
-                                  const float ratio_h, const float ratio_w,
-                                  const int in_h, const int in_w, const int n,
-                                  const int c, const int out_h,
-                                  const int out_w) {
-  auto input_t = EigenTensor<T, 4>::From(input);
-  auto output_t = EigenTensor<T, 4>::From(*output);
-  for (int k = 0; k < out_h; k++) {  // loop for images
-    int y_n = static_cast<int>(ratio_h * k);
-    int y_s = (y_n + 1) < (in_h - 1) ? (y_n + 1) : (in_h - 1);
-    float d_n = ratio_h * k - y_n;
-    float d_s = 1.f - d_n;
-
-    for (int l = 0; l < out_w; l++) {
-      int x_w = static_cast<int>(ratio_w * l);
-      int x_e = (x_w + 1) < (in_w - 1) ? (x_w + 1) : (in_w - 1);
-      float d_w = ratio_w * l - x_w;
-      float d_e = 1.f - d_w;
-
-      for (int i = 0; i < n; i++) {    // loop for batches
-        for (int j = 0; j < c; j++) {  // loop for channels
-          // bilinear interpolation
-          output_t(i, j, k, l) = input_t(i, j, y_n, x_w) * d_s * d_e +
-                                 input_t(i, j, y_s, x_w) * d_n * d_e +
-                                 input_t(i, j, y_n, x_e) * d_s * d_w +
-                                 input_t(i, j, y_s, x_e) * d_n * d_w;
+static void InterpolateNHWC(const T* in, T* out, int n, int c, int in_h,
+                            int in_w, int out_h, int out_w, bool bilinear,
+                            const InterpAxis& h, const InterpAxis& w) {
+  const int* hs0 = h.src0.data();
+  const int* hs1 = h.src1.data();
+  const float* hl = h.lambda.data();
+  const int* ws0 = w.src0.data();
+  const int* ws1 = w.src1.data();
+  const float* wl = w.lambda.data();
+  for (int i = 0; i < n; ++i) {
+    const T* image = in + i * in_h * in_w * c;
+    for (int k = 0; k < out_h; ++k) {
+      const T* r0 = image + hs0[k] * in_w * c;
+      const T* r1 = image + hs1[k] * in_w * c;
+      float h1 = hl[k];
+      float h0 = 1.f - h1;
+      for (int l = 0; l < out_w; ++l) {
+        const T* p00 = r0 + ws0[l] * c;
+        if (!bilinear) {
+          std::copy(p00, p00 + c, out);
+        } else {
+          const T* p01 = r0 + ws1[l] * c;
+          const T* p10 = r1 + ws0[l] * c;
+          const T* p11 = r1 + ws1[l] * c;
+          float w1 = wl[l];
+          float w0 = 1.f - w1;
+          for (int j = 0; j < c; ++j) {
+            out[j] = static_cast<T>(h0 * (w0 * p00[j] + w1 * p01[j]) +
+                                    h1 * (w0 * p10[j] + w1 * p11[j]));
+          }
         }
+        out += c;
       }
     }
   }
 }
 
+// The gradients are scattered to the sources, the input_grad is zero.
 template <typename T>
-static void NearestNeighborInterpolateGrad(const Tensor& output_grad,
-                                           Tensor* input_grad,
-                                           const float ratio_h,
-                                           const float ratio_w, const int n,
-                                           const int c, const int out_h,
-                                           const int out_w) {
-  auto input_grad_t = EigenTensor<T, 4>::From(*input_grad);
-  auto output_grad_t = EigenTensor<T, 4>::From(output_grad);
-  for (int k = 0; k < out_h; k++) {  // loop for images
-    int in_k = static_cast<int>(ratio_h * k + 0.5);
-
-    for (int l = 0; l < out_w; l++) {
-      int in_l = static_cast<int>(ratio_w * l + 0.5);
-
-      for (int i = 0; i < n; i++) {    // loop for batches
-        for (int j = 0; j < c; j++) {  // loop for channels
-          input_grad_t(i, j, in_k, in_l) += output_grad_t(i, j, k, l);
+static void InterpolateGradNCHW(const T* out_grad, T* in_grad, int nc,
+                                int in_h, int in_w, int out_h, int out_w,
+                                bool bilinear, const InterpAxis& h,
+                                const InterpAxis& w) {
+  const int* hs0 = h.src0.data();
+  const int* hs1 = h.src1.data();
+  const float* hl = h.lambda.data();
+  const int* ws0 = w.src0.data();
+  const int* ws1 = w.src1.data();
+  const float* wl = w.lambda.data();
+  for (int i = 0; i < nc; ++i) {
+    T* plane = in_grad + i * in_h * in_w;
+    for (int k = 0; k < out_h; ++k) {
+      T* r0 = plane + hs0[k] * in_w;
+      T* r1 = plane + hs1[k] * in_w;
+      float h1 = hl[k];
+      float h0 = 1.f - h1;
+      for (int l = 0; l < out_w; ++l) {
+        if (!bilinear) {
+          r0[ws0[l]] += out_grad[l];
+          continue;
         }
+        int x0 = ws0[l];
+        int x1 = ws1[l];
+        float w1 = wl[l];
+        float w0 = 1.f - w1;
+        const T g = out_grad[l];
+        r0[x0] += static_cast<T>(g * h0 * w0);
+        r0[x1] += static_cast<T>(g * h0 * w1);
+        r1[x0] += static_cast<T>(g * h1 * w0);
+        r1[x1] += static_cast<T>(g * h1 * w1);
       }
+      out_grad += out_w;
     }
   }
 }
 
 template <typename T>
-static void BilinearInterpolationGrad(const Tensor& output_grad,
-                                      Tensor* input_grad, const float ratio_h,
-                                      const float ratio_w, const int in_h,
-                                      const int in_w, const int n, const int c,
-                                      const int out_h, const int out_w) {
-  auto input_grad_t = EigenTensor<T, 4>::From(*input_grad);
-  auto output_grad_t = EigenTensor<T, 4>::From(output_grad);
-  for (int k = 0; k < out_h; k++) {  // loop for images
-    int y_n = static_cast<int>(ratio_h * k);
-    int y_s = (y_n + 1) < (in_h - 1) ? (y_n + 1) : (in_h - 1);
-    float d_n = ratio_h * k - y_n;
-    float d_s = 1.f - d_n;
-
-    for (int l = 0; l < out_w; l++) {
-      int x_w = static_cast<int>(ratio_w * l);
-      int x_e = (x_w + 1) < (in_w - 1) ? (x_w + 1) : (in_w - 1);
-      float d_w = ratio_w * l - x_w;
-      float d_e = 1.f - d_w;
-
-      for (int i = 0; i < n; i++) {    // loop for batches
-        for (int j = 0; j < c; j++) {  // loop for channels
-          // bilinear interpolation grad
-          const T grad = output_grad_t(i, j, k, l);
-          input_grad_t(i, j, y_n, x_w) += static_cast<T>(grad * d_s * d_e);
-          input_grad_t(i, j, y_s, x_w) += static_cast<T>(grad * d_n * d_e);
-          input_grad_t(i, j, y_n, x_e) += static_cast<T>(grad * d_s * d_w);
-          input_grad_t(i, j, y_s, x_e) += static_cast<T>(grad * d_n * d_w);
+static void InterpolateGradNHWC(const T* out_grad, T* in_grad, int n, int c,
+                                int in_h, int in_w, int out_h, int out_w,
+                                bool bilinear, const InterpAxis& h,
+                                const InterpAxis& w) {
+  const int* hs0 = h.src0.data();
+  const int* hs1 = h.src1.data();
+  const float* hl = h.lambda.data();
+  const int* ws0 = w.src0.data();
+  const int* ws1 = w.src1.data();
+  const float* wl = w.lambda.data();
+  for (int i = 0; i < n; ++i) {
+    T* image = in_grad + i * in_h * in_w * c;
+    for (int k = 0; k < out_h; ++k) {
+      T* r0 = image + hs0[k] * in_w * c;
+      T* r1 = image + hs1[k] * in_w * c;
+      float h1 = hl[k];
+      float h0 = 1.f - h1;
+      for (int l = 0; l < out_w; ++l) {
+        T* p00 = r0 + ws0[l] * c;
+        if (!bilinear) {
+          for (int j = 0; j < c; ++j) p00[j] += out_grad[j];
+          out_grad += c;
+          continue;
         }
+        T* p01 = r0 + ws1[l] * c;
+        T* p10 = r1 + ws0[l] * c;
+        T* p11 = r1 + ws1[l] * c;
+        float w1 = wl[l];
+        float w0 = 1.f - w1;
+        for (int j = 0; j < c; ++j) {
+          const T g = out_grad[j];
+          p00[j] += static_cast<T>(g * h0 * w0);
+          p01[j] += static_cast<T>(g * h0 * w1);
+          p10[j] += static_cast<T>(g * h1 * w0);
+          p11[j] += static_cast<T>(g * h1 * w1);
+        }
+        out_grad += c;
       }
     }
   }
@@ -143,6 +263,7 @@ class InterpolateKernel : public framework::OpKernel<T> {
     auto* output = ctx.Output<Tensor>("Out");
 
     std::string interp_method = ctx.Attr<std::string>("interp_method");
+    std::string data_layout = ctx.Attr<std::string>("data_layout");
     int out_h = ctx.Attr<int>("out_h");
     int out_w = ctx.Attr<int>("out_w");
     auto out_size = ctx.Input<Tensor>("OutSize");
@@ -152,33 +273,27 @@ class InterpolateKernel : public framework::OpKernel<T> {
       out_w = out_size_data[1];
     }
 
-    const int n = input->dims()[0];
-    const int c = input->dims()[1];
-    const int in_h = input->dims()[2];
-    const int in_w = input->dims()[3];
+    int n, c, in_h, in_w;
+    ExtractInterpDims(input->dims(), data_layout, &n, &c, &in_h, &in_w);
 
-    output->mutable_data<T>({n, c, out_h, out_w}, ctx.GetPlace());
-    auto& device_ctx =
-        ctx.template device_context<platform::CPUDeviceContext>();
-    math::SetConstant<platform::CPUDeviceContext, T> zero;
-    zero(device_ctx, output, static_cast<T>(0.0));
+    T* output_data = output->mutable_data<T>(
+        InterpDims(n, c, out_h, out_w, data_layout), ctx.GetPlace());
 
     if (in_h == out_h && in_w == out_w) {
       framework::TensorCopy(*input, ctx.GetPlace(), output);
       return;
     }
 
-    float ratio_h =
-        (out_h > 1) ? static_cast<float>(in_h - 1) / (out_h - 1) : 0.f;
-    float ratio_w =
-        (out_w > 1) ? static_cast<float>(in_w - 1) / (out_w - 1) : 0.f;
-
-    if ("bilinear" == interp_method) {
-      BilinearInterpolation<T>(*input, output, ratio_h, ratio_w, in_h, in_w, n,
-                               c, out_h, out_w);
-    } else if ("nearest" == interp_method) {
-      NearestNeighborInterpolate<T>(*input, output, ratio_h, ratio_w, n, c,
-                                    out_h, out_w);
+    bool bilinear = "bilinear" == interp_method;
+    InterpAxis h, w;
+    ComputeInterpAxis(in_h, out_h, bilinear, &h);
+    ComputeInterpAxis(in_w, out_w, bilinear, &w);
+    if (data_layout == "NHWC") {
+      InterpolateNHWC<T>(input->data<T>(), output_data, n, c, in_h, in_w,
+                         out_h, out_w, bilinear, h, w);
+    } else {
+      InterpolateNCHW<T>(input->data<T>(), output_data, n * c, in_h, in_w,
+                         out_h, out_w, bilinear, h, w);
     }
   }
 };
@@ -192,6 +307,7 @@ class InterpolateGradKernel : public framework::OpKernel<T> {
     auto* output_grad = ctx.Input<Tensor>(framework::GradVarName("Out"));
 
     std::string interp_method = ctx.Attr<std::string>("interp_method");
+    std::string data_layout = ctx.Attr<std::string>("data_layout");
     int out_h = ctx.Attr<int>("out_h");
     int out_w = ctx.Attr<int>("out_w");
     auto out_size = ctx.Input<Tensor>("OutSize");
@@ -201,33 +317,32 @@ class InterpolateGradKernel : public framework::OpKernel<T> {
       out_w = out_size_data[1];
     }
 
-    const int n = input->dims()[0];
-    const int c = input->dims()[1];
-    const int in_h = input->dims()[2];
-    const int in_w = input->dims()[3];
+    int n, c, in_h, in_w;
+    ExtractInterpDims(input->dims(), data_layout, &n, &c, &in_h, &in_w);
 
-    input_grad->mutable_data<T>({n, c, in_h, in_w}, ctx.GetPlace());
-    auto& device_ctx =
-        ctx.template device_context<platform::CPUDeviceContext>();
-    math::SetConstant<platform::CPUDeviceContext, T> zero;
-    zero(device_ctx, input_grad, static_cast<T>(0.0));
+    T* input_grad_data =
+        input_grad->mutable_data<T>(input->dims(), ctx.GetPlace());
 
     if (in_h == out_h && in_w == out_w) {
       framework::TensorCopy(*output_grad, ctx.GetPlace(), input_grad);
       return;
     }
 
-    float ratio_h =
-        (out_h > 1) ? static_cast<float>(in_h - 1) / (out_h - 1) : 0.f;
-    float ratio_w =
-        (out_w > 1) ? static_cast<float>(in_w - 1) / (out_w - 1) : 0.f;
-
-    if ("bilinear" == interp_method) {
-      BilinearInterpolationGrad<T>(*output_grad, input_grad, ratio_h, ratio_w,
-                                   in_h, in_w, n, c, out_h, out_w);
-    } else if ("nearest" == interp_method) {
-      NearestNeighborInterpolateGrad<T>(*output_grad, input_grad, ratio_h,
-                                        ratio_w, n, c, out_h, out_w);
+    auto& device_ctx =
+        ctx.template device_context<platform::CPUDeviceContext>();
+    math::SetConstant<platform::CPUDeviceContext, T> zero;
+    zero(device_ctx, input_grad, static_cast<T>(0.0));
+
+    bool bilinear = "bilinear" == interp_method;
+    InterpAxis h, w;
+    ComputeInterpAxis(in_h, out_h, bilinear, &h);
+    ComputeInterpAxis(in_w, out_w, bilinear, &w);
+    if (data_layout == "NHWC") {
+      InterpolateGradNHWC<T>(output_grad->data<T>(), input_grad_data, n, c,
+                             in_h, in_w, out_h, out_w, bilinear, h, w);
+    } else {
+      InterpolateGradNCHW<T>(output_grad->data<T>(), input_grad_data, n * c,
+                             in_h, in_w, out_h, out_w, bilinear, h, w);
     }
   }
 };
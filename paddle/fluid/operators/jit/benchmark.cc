@@ -80,8 +80,23 @@ void BenchAllImpls(const typename KernelTuples::attr_type& attr, Args... args) {
   if (jitcode) {
     infos.push_back(std::make_pair("JitCode", benchmark(jitcode, args...)));
   }
-  // test all impls in more
+  // test all jitcode creators can be used, e.g., AVX512 and AVX
   jit::KernelKey kkey(KT, PlaceType());
+  auto& creator_map = jit::JitCodeCreatorPool().Instance().AllCreators();
+  auto creator_iter = creator_map.find(kkey);
+  if (creator_iter != creator_map.end() && creator_iter->second.size() > 1) {
+    using Attr = typename KernelTuples::attr_type;
+    using Func = typename KernelTuples::func_type;
+    for (auto& cur : creator_iter->second) {
+      auto i = dynamic_cast<const jit::JitCodeCreator<Attr>*>(cur.get());
+      if (i && i->UseMe(attr)) {
+        auto code = i->CreateJitCode(attr);
+        infos.push_back(std::make_pair(
+            code->name(), benchmark(code->template getCode<Func>(), args...)));
+      }
+    }
+  }
+  // test all impls in more
   auto& pool = jit::KernelPool().Instance().AllKernels();
   auto iter = pool.find(kkey);
   if (iter != pool.end()) {
@@ -193,7 +208,8 @@ void BenchGRUKernel() {
 template <paddle::operators::jit::KernelType KT, typename T, typename PlaceType>
 void BenchSeqPoolKernel() {
   std::vector<jit::SeqPoolType> pool_types = {
-      jit::SeqPoolType::kSum, jit::SeqPoolType::kAvg, jit::SeqPoolType::kSqrt};
+      jit::SeqPoolType::kSum, jit::SeqPoolType::kAvg, jit::SeqPoolType::kSqrt,
+      jit::SeqPoolType::kMax};
   for (auto type : pool_types) {
     for (int w : TestSizes()) {
       jit::seq_pool_attr_t attr(w, type);
@@ -210,6 +226,59 @@ void BenchSeqPoolKernel() {
   }
 }
 
+template <paddle::operators::jit::KernelType KT, typename T, typename PlaceType>
+void BenchSoftmaxKernel() {
+  for (int bs : {1, 2, 10}) {
+    for (int n : TestSizes()) {
+      std::vector<T> x(bs * n), y(bs * n);
+      RandomVec<T>(bs * n, x.data(), -2.f, 2.f);
+      const T* x_data = x.data();
+      T* y_data = y.data();
+      BenchAllImpls<KT, jit::SoftmaxTuples<T>, PlaceType>(n, x_data, y_data, n,
+                                                          bs);
+    }
+  }
+}
+
+template <paddle::operators::jit::KernelType KT, typename T, typename PlaceType>
+void BenchSoftmaxCrossEntropyKernel() {
+  for (int bs : {1, 2, 10}) {
+    for (int n : TestSizes()) {
+      std::vector<T> x(bs * n), y(bs * n), loss(bs);
+      std::vector<int64_t> label(bs);
+      RandomVec<T>(bs * n, x.data(), -2.f, 2.f);
+      for (int i = 0; i < bs; ++i) {
+        label[i] = i % n;
+      }
+      const T* x_data = x.data();
+      const int64_t* label_data = label.data();
+      T* y_data = y.data();
+      T* loss_data = loss.data();
+      BenchAllImpls<KT, jit::SoftmaxCrossEntropyTuples<T>, PlaceType>(
+          n, x_data, label_data, y_data, loss_data, n, bs, -100);
+    }
+  }
+}
+
+template <paddle::operators::jit::KernelType KT, typename T, typename PlaceType>
+void BenchMatMulKernel() {
+  for (int m : {1, 2, 3, 4, 8, 16}) {
+    for (int n : {8, 64, 128, 256}) {
+      for (int k : {64, 128, 256}) {
+        const jit::matmul_attr_t attr{m, n, k};
+        std::vector<T> a(m * k), b(k * n), c(m * n);
+        RandomVec<T>(m * k, a.data(), -2.f, 2.f);
+        RandomVec<T>(k * n, b.data(), -2.f, 2.f);
+        const T* a_data = a.data();
+        const T* b_data = b.data();
+        T* c_data = c.data();
+        BenchAllImpls<KT, jit::MatMulTuples<T>, PlaceType>(attr, a_data, b_data,
+                                                           c_data, &attr);
+      }
+    }
+  }
+}
+
 // Benchmark all jit kernels including jitcode, mkl and refer.
 // To use this tool, run command: ./benchmark [options...]
 // Options:
@@ -251,4 +320,11 @@ int main(int argc, char* argv[]) {
 
   // seq pool function
   BenchSeqPoolKernel<jit::kSeqPool, T, PlaceType>();
+
+  // matmul
+  BenchMatMulKernel<jit::kMatMul, T, PlaceType>();
+
+  // softmax
+  BenchSoftmaxKernel<jit::kSoftmax, T, PlaceType>();
+  BenchSoftmaxCrossEntropyKernel<jit::kSoftmaxCrossEntropy, T, PlaceType>();
 }
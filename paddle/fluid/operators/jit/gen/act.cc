@@ -44,6 +44,10 @@ const int ALIGN32_BEG exp_int_0x7f[] ALIGN32_END = {REPEAT_8TIMES(0x7f)};
 int ALIGN32_BEG g_tmp_mem[16] ALIGN32_END = {0};
 
 void VActJitCode::genCode() {
+  if (isa_ == platform::avx512f) {
+    genZmmCode();
+    return;
+  }
   int offset = 0;
   for (int i = 0; i < num_ / YMM_FLOAT_BLOCK; ++i) {
     vmovups(ymm_src, ptr[param1 + offset]);
@@ -78,47 +82,94 @@ void VActJitCode::genCode() {
   ret();
 }
 
-#define DECLARE_ACT_CREATOR(name)                                            \
-  class name##Creator : public JitCodeCreator<int> {                         \
+void VActJitCode::genZmmCode() {
+  int offset = 0;
+  int rest = num_ % ZMM_FLOAT_BLOCK;
+  for (int i = 0; i < num_ / ZMM_FLOAT_BLOCK; ++i) {
+    vmovups(zmm_src, ptr[param1 + offset]);
+    act<zmm_t>(zmm_dst, zmm_src, type_);
+    vmovups(ptr[param2 + offset], zmm_dst);
+    offset += sizeof(float) * ZMM_FLOAT_BLOCK;
+  }
+  if (rest > 0) {
+    // the masked off elements are zeros, which are safe for all the acts
+    mov(reg_tail, (1 << rest) - 1);
+    kmovw(k_tail, reg_tail);
+    vmovups(zmm_src | k_tail | Xbyak::T_z, ptr[param1 + offset]);
+    act<zmm_t>(zmm_dst, zmm_src, type_);
+    vmovups(ptr[param2 + offset] | k_tail, zmm_dst);
+  }
+  ret();
+}
+
+#define DECLARE_ACT_CREATOR(name, isa_name, isa)                             \
+  class name##isa_name##Creator : public JitCodeCreator<int> {               \
    public:                                                                   \
     bool UseMe(const int& attr) const override {                             \
-      return platform::MayIUse(platform::avx);                               \
+      return platform::MayIUse(isa);                                         \
     }                                                                        \
     size_t CodeSize(const int& d) const override;                            \
     std::unique_ptr<GenBase> CreateJitCode(const int& attr) const override { \
-      return make_unique<name##JitCode>(attr, CodeSize(attr));               \
+      return make_unique<name##JitCode>(attr, isa, CodeSize(attr));          \
     }                                                                        \
   }
 
-DECLARE_ACT_CREATOR(VRelu);
-DECLARE_ACT_CREATOR(VIdentity);
-DECLARE_ACT_CREATOR(VExp);
-DECLARE_ACT_CREATOR(VSigmoid);
-DECLARE_ACT_CREATOR(VTanh);
+DECLARE_ACT_CREATOR(VRelu, AVX, platform::avx);
+DECLARE_ACT_CREATOR(VIdentity, AVX, platform::avx);
+DECLARE_ACT_CREATOR(VExp, AVX, platform::avx);
+DECLARE_ACT_CREATOR(VSigmoid, AVX, platform::avx);
+DECLARE_ACT_CREATOR(VTanh, AVX, platform::avx);
+
+DECLARE_ACT_CREATOR(VRelu, AVX512, platform::avx512f);
+DECLARE_ACT_CREATOR(VIdentity, AVX512, platform::avx512f);
+DECLARE_ACT_CREATOR(VExp, AVX512, platform::avx512f);
+DECLARE_ACT_CREATOR(VSigmoid, AVX512, platform::avx512f);
+DECLARE_ACT_CREATOR(VTanh, AVX512, platform::avx512f);
 
 // TODO(TJ): tuning use me
-size_t VReluCreator::CodeSize(const int& d) const {
+size_t VReluAVXCreator::CodeSize(const int& d) const {
   return 96 /* init size */ +
          (d / YMM_FLOAT_BLOCK + 3) * 4 /* instructions */ *
              8 /* average bytes for each instruction */;
 }
 
-size_t VIdentityCreator::CodeSize(const int& d) const {
+size_t VIdentityAVXCreator::CodeSize(const int& d) const {
   return 96 + (d / YMM_FLOAT_BLOCK + 3) * 4 * 8;
 }
 
-size_t VExpCreator::CodeSize(const int& d) const {
+size_t VExpAVXCreator::CodeSize(const int& d) const {
   return 96 + (d / YMM_FLOAT_BLOCK + 3) * 70 * 8;
 }
 
-size_t VSigmoidCreator::CodeSize(const int& d) const {
+size_t VSigmoidAVXCreator::CodeSize(const int& d) const {
   return 96 + (d / YMM_FLOAT_BLOCK + 3) * 82 * 8;
 }
 
-size_t VTanhCreator::CodeSize(const int& d) const {
+size_t VTanhAVXCreator::CodeSize(const int& d) const {
   return 96 + (d / YMM_FLOAT_BLOCK + 3) * 84 * 8;
 }
 
+// the EVEX instructions are longer, but there is only one tail block
+size_t VReluAVX512Creator::CodeSize(const int& d) const {
+  return 96 + (d / ZMM_FLOAT_BLOCK + 1) * 4 * 10;
+}
+
+size_t VIdentityAVX512Creator::CodeSize(const int& d) const {
+  return 96 + (d / ZMM_FLOAT_BLOCK + 1) * 4 * 10;
+}
+
+size_t VExpAVX512Creator::CodeSize(const int& d) const {
+  return 96 + (d / ZMM_FLOAT_BLOCK + 1) * 70 * 10;
+}
+
+size_t VSigmoidAVX512Creator::CodeSize(const int& d) const {
+  return 96 + (d / ZMM_FLOAT_BLOCK + 1) * 82 * 10;
+}
+
+size_t VTanhAVX512Creator::CodeSize(const int& d) const {
+  return 96 + (d / ZMM_FLOAT_BLOCK + 1) * 84 * 10;
+}
+
 #undef DECLARE_ACT_CREATOR
 
 }  // namespace gen
@@ -128,8 +179,12 @@ size_t VTanhCreator::CodeSize(const int& d) const {
 
 namespace gen = paddle::operators::jit::gen;
 
-REGISTER_JITKERNEL_GEN(kVRelu, gen::VReluCreator);
-REGISTER_JITKERNEL_GEN(kVIdentity, gen::VIdentityCreator);
-REGISTER_JITKERNEL_GEN(kVExp, gen::VExpCreator);
-REGISTER_JITKERNEL_GEN(kVSigmoid, gen::VSigmoidCreator);
-REGISTER_JITKERNEL_GEN(kVTanh, gen::VTanhCreator);
+// The AVX512 creators are registered first, so that they are preferred when
+// the CPU supports avx512f.
+REGISTER_JITKERNEL_GEN(kVRelu, gen::VReluAVX512Creator, gen::VReluAVXCreator);
+REGISTER_JITKERNEL_GEN(kVIdentity, gen::VIdentityAVX512Creator,
+                       gen::VIdentityAVXCreator);
+REGISTER_JITKERNEL_GEN(kVExp, gen::VExpAVX512Creator, gen::VExpAVXCreator);
+REGISTER_JITKERNEL_GEN(kVSigmoid, gen::VSigmoidAVX512Creator,
+                       gen::VSigmoidAVXCreator);
+REGISTER_JITKERNEL_GEN(kVTanh, gen::VTanhAVX512Creator, gen::VTanhAVXCreator);
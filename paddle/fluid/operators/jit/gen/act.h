@@ -15,8 +15,10 @@
 #pragma once
 
 #include <string>
+#include <type_traits>
 #include "glog/logging.h"
 #include "paddle/fluid/operators/jit/gen/jitcode.h"
+#include "paddle/fluid/platform/cpu_info.h"
 
 namespace paddle {
 namespace operators {
@@ -67,15 +69,35 @@ class VActFunc : public JitCode {
   virtual void genCode() = 0;
 
  protected:
-  // compute RELU with ymm, xmm
+  // vxorps on zmm needs avx512dq, so use vpxord which only needs avx512f
+  template <typename JMM>
+  void zero_jmm(JMM& jmm) {  // NOLINT
+    if (std::is_same<JMM, zmm_t>::value) {
+      vpxord(jmm, jmm, jmm);
+    } else {
+      vxorps(jmm, jmm, jmm);
+    }
+  }
+
+  // the constants only have YMM_FLOAT_BLOCK elements, so broadcast for zmm
+  template <typename JMM>
+  void load_const_jmm(JMM& dst, const Xbyak::Address& addr) {  // NOLINT
+    if (std::is_same<JMM, zmm_t>::value) {
+      vbroadcastss(dst, addr);
+    } else {
+      vmovaps(dst, addr);
+    }
+  }
+
+  // compute RELU with zmm, ymm, xmm
   template <typename JMM>
   void relu_jmm(JMM& dst, JMM& src, int zero_idx = 15) {  // NOLINT
     JMM zero = JMM(zero_idx);
-    vxorps(zero, zero, zero);
+    zero_jmm<JMM>(zero);
     vmaxps(dst, src, zero);
   }
 
-  // compute EXP with ymm, xmm
+  // compute EXP with zmm, ymm, xmm
   template <typename JMM>
   void exp_jmm(JMM& dst, JMM& src, int src_idx = 11, int fx_idx = 12,  // NOLINT
                int fy_idx = 13, int mask_idx = 14, int tmp_idx = 15) {
@@ -90,49 +112,58 @@ class VActFunc : public JitCode {
     push(reg_ptr_global);
     vmovaps(jmm_src, src);
     mov(reg_ptr_global, reinterpret_cast<size_t>(exp_float_consts));
-    vmovaps(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_HIG]);
+    load_const_jmm<JMM>(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_HIG]);
     vminps(jmm_src, jmm_src, jmm_tmp);
-    vmovaps(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_LOW]);
+    load_const_jmm<JMM>(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_LOW]);
     vmaxps(jmm_src, jmm_src, jmm_tmp);
     // express exp(x) as exp(g + n*log(2))
-    vmovaps(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_LOG2EF]);
+    load_const_jmm<JMM>(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_LOG2EF]);
     vmulps(jmm_fx, jmm_src, jmm_tmp);
-    vmovaps(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_0P5]);
+    load_const_jmm<JMM>(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_0P5]);
     vaddps(jmm_fx, jmm_fx, jmm_tmp);
-    vroundps(jmm_fy, jmm_fx, 0x01);
-    // if greater, substract 1
-    vcmpgtps(jmm_mask, jmm_fy, jmm_fx);
-    vmovaps(jmm_tmp, ptr[reg_ptr_global]);
-    vandps(jmm_mask, jmm_mask, jmm_tmp);
-    vsubps(jmm_fx, jmm_fy, jmm_mask);
-    vmovaps(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_C1]);
+    if (std::is_same<JMM, zmm_t>::value) {
+      // round down, which is never greater than fx
+      vrndscaleps(jmm_fx, jmm_fx, 0x01);
+    } else {
+      vroundps(jmm_fy, jmm_fx, 0x01);
+      // if greater, substract 1
+      vcmpgtps(jmm_mask, jmm_fy, jmm_fx);
+      load_const_jmm<JMM>(jmm_tmp, ptr[reg_ptr_global]);
+      vandps(jmm_mask, jmm_mask, jmm_tmp);
+      vsubps(jmm_fx, jmm_fy, jmm_mask);
+    }
+    load_const_jmm<JMM>(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_C1]);
     vmulps(jmm_fy, jmm_fx, jmm_tmp);
-    vmovaps(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_C2]);
+    load_const_jmm<JMM>(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_C2]);
     JMM ymm_z = JMM(jmm_mask.getIdx());
     vmulps(ymm_z, jmm_fx, jmm_tmp);
     vsubps(jmm_src, jmm_src, jmm_fy);
     vsubps(jmm_src, jmm_src, ymm_z);
     vmulps(ymm_z, jmm_src, jmm_src);
-    vmovaps(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_P0]);
+    load_const_jmm<JMM>(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_P0]);
     vmulps(dst, jmm_src, jmm_tmp);
     for (size_t i = OFFSET_EXP_P1; i < OFFSET_EXP_P5;
          i += (YMM_FLOAT_BLOCK * sizeof(float))) {
-      vmovaps(jmm_tmp, ptr[reg_ptr_global + i]);  // P1~P4
+      load_const_jmm<JMM>(jmm_tmp, ptr[reg_ptr_global + i]);  // P1~P4
       vaddps(dst, dst, jmm_tmp);
       vmulps(dst, dst, jmm_src);
     }
-    vmovaps(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_P5]);
+    load_const_jmm<JMM>(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_P5]);
     vaddps(dst, dst, jmm_tmp);
     vmulps(dst, dst, ymm_z);
     vaddps(dst, dst, jmm_src);
-    vmovaps(jmm_tmp, ptr[reg_ptr_global]);
+    load_const_jmm<JMM>(jmm_tmp, ptr[reg_ptr_global]);
     vaddps(dst, dst, jmm_tmp);
     // build 2^n
     JMM ymm_int = jmm_fx;
     vcvttps2dq(ymm_int, jmm_fx);
     mov(reg_ptr_global, reinterpret_cast<size_t>(exp_int_0x7f));
-    vmovdqa(jmm_tmp, ptr[reg_ptr_global]);
-    if (MayIUse(avx2) || std::is_same<JMM, xmm_t>::value) {
+    if (std::is_same<JMM, zmm_t>::value) {
+      vpbroadcastd(jmm_tmp, ptr[reg_ptr_global]);
+    } else {
+      vmovdqa(jmm_tmp, ptr[reg_ptr_global]);
+    }
+    if (MayIUse(avx2) || !std::is_same<JMM, ymm_t>::value) {
       vpaddd(ymm_int, ymm_int, jmm_tmp);
       vpslld(ymm_int, ymm_int, 23);
     } else if (MayIUse(avx)) {
@@ -159,7 +190,7 @@ class VActFunc : public JitCode {
     pop(reg_ptr_global);
   }
 
-  // compute SIGMOID with ymm, xmm
+  // compute SIGMOID with zmm, ymm, xmm
   template <typename JMM>
   void sigmoid_jmm(JMM& dst, JMM& src, int src_idx = 11,  // NOLINT
                    int fx_idx = 12, int fy_idx = 13, int mask_idx = 14,
@@ -171,20 +202,20 @@ class VActFunc : public JitCode {
     push(reg_ptr_global);
     vmovaps(jmm_src, src);
     mov(reg_ptr_global, reinterpret_cast<size_t>(exp_float_consts));
-    vmovaps(jmm_tmp, ptr[reg_ptr_global + OFFSET_SIGMOID_MAX]);
+    load_const_jmm<JMM>(jmm_tmp, ptr[reg_ptr_global + OFFSET_SIGMOID_MAX]);
     vminps(jmm_src, jmm_src, jmm_tmp);
-    vmovaps(jmm_tmp, ptr[reg_ptr_global + OFFSET_SIGMOID_MIN]);
+    load_const_jmm<JMM>(jmm_tmp, ptr[reg_ptr_global + OFFSET_SIGMOID_MIN]);
     vmaxps(jmm_src, jmm_src, jmm_tmp);
-    vxorps(jmm_tmp, jmm_tmp, jmm_tmp);
+    zero_jmm<JMM>(jmm_tmp);
     vsubps(jmm_src, jmm_tmp, jmm_src);
     exp_jmm<JMM>(dst, jmm_src, src_idx, fx_idx, fy_idx, mask_idx, tmp_idx);
-    vmovaps(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_ONE]);
+    load_const_jmm<JMM>(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_ONE]);
     vaddps(dst, dst, jmm_tmp);
     vdivps(dst, jmm_tmp, dst);
     pop(reg_ptr_global);
   }
 
-  // compute TANH with ymm, xmm
+  // compute TANH with zmm, ymm, xmm
   template <typename JMM>
   void tanh_jmm(JMM& dst, JMM& src, int src_idx = 11,  // NOLINT
                 int fx_idx = 12, int fy_idx = 13, int mask_idx = 14,
@@ -197,25 +228,25 @@ class VActFunc : public JitCode {
     push(reg_ptr_global);
     vmovaps(jmm_src, src);
     mov(reg_ptr_global, reinterpret_cast<size_t>(exp_float_consts));
-    vmovaps(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_TWO]);
-    vxorps(jmm_zero, jmm_zero, jmm_zero);
+    load_const_jmm<JMM>(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_TWO]);
+    zero_jmm<JMM>(jmm_zero);
     vsubps(jmm_tmp, jmm_zero, jmm_tmp);
     vmulps(jmm_src, jmm_src, jmm_tmp);
     exp_jmm<JMM>(dst, jmm_src, src_idx, fx_idx, fy_idx, mask_idx, tmp_idx);
-    vmovaps(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_ONE]);
+    load_const_jmm<JMM>(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_ONE]);
     vaddps(dst, dst, jmm_tmp);
-    vmovaps(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_TWO]);
+    load_const_jmm<JMM>(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_TWO]);
     vdivps(dst, jmm_tmp, dst);
-    vmovaps(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_ONE]);
+    load_const_jmm<JMM>(jmm_tmp, ptr[reg_ptr_global + OFFSET_EXP_ONE]);
     vsubps(dst, dst, jmm_tmp);
     pop(reg_ptr_global);
   }
 
-  // compute IDENTITY with ymm, xmm
+  // compute IDENTITY with zmm, ymm, xmm
   template <typename JMM>
   void identity_jmm(JMM& dst, JMM& src, int zero_idx) {  // NOLINT
     JMM zero = JMM(zero_idx);
-    vxorps(zero, zero, zero);
+    zero_jmm<JMM>(zero);
     vaddps(dst, src, zero);
     // TODO(TJ): use below
     // dst.setIdx(src.getIdx());
@@ -249,9 +280,9 @@ class VActFunc : public JitCode {
 
 class VActJitCode : public VActFunc {
  public:
-  explicit VActJitCode(int d, operand_type type, size_t code_size,
-                       void* code_ptr = nullptr)
-      : VActFunc(code_size, code_ptr), num_(d), type_(type) {
+  explicit VActJitCode(int d, operand_type type, platform::cpu_isa_t isa,
+                       size_t code_size, void* code_ptr = nullptr)
+      : VActFunc(code_size, code_ptr), num_(d), type_(type), isa_(isa) {
     if (!(type_ == operand_type::RELU || type_ == operand_type::EXP ||
           type_ == operand_type::SIGMOID || type_ == operand_type::TANH ||
           type_ == operand_type::IDENTITY)) {
@@ -281,28 +312,41 @@ class VActJitCode : public VActFunc {
       default:
         break;
     }
-    return base.c_str();
+    base += (isa_ == platform::avx512f ? "_AVX512" : "");
+    // keep the name alive after returning
+    name_ = base;
+    return name_.c_str();
   }
   void genCode() override;
 
  protected:
+  // use zmm and load or store the tail with mask
+  void genZmmCode();
+
   int num_;
   operand_type type_;
+  platform::cpu_isa_t isa_;
+  mutable std::string name_;
   reg64_t param1{abi_param1};
   reg64_t param2{abi_param2};
+  reg32_t reg_tail{r10d};
+  opmask_t k_tail{k1};
 
   xmm_t xmm_src = xmm_t(0);
   ymm_t ymm_src = ymm_t(0);
+  zmm_t zmm_src = zmm_t(0);
 
   xmm_t xmm_dst = xmm_t(1);
   ymm_t ymm_dst = ymm_t(1);
+  zmm_t zmm_dst = zmm_t(1);
 };
 
-#define DECLARE_ACT_JITCODE(name, op_type)                                    \
-  class name##JitCode : public VActJitCode {                                  \
-   public:                                                                    \
-    explicit name##JitCode(int d, size_t code_size, void* code_ptr = nullptr) \
-        : VActJitCode(d, op_type, code_size, code_ptr) {}                     \
+#define DECLARE_ACT_JITCODE(name, op_type)                                   \
+  class name##JitCode : public VActJitCode {                                 \
+   public:                                                                   \
+    explicit name##JitCode(int d, platform::cpu_isa_t isa, size_t code_size, \
+                           void* code_ptr = nullptr)                         \
+        : VActJitCode(d, op_type, isa, code_size, code_ptr) {}               \
   };
 
 DECLARE_ACT_JITCODE(VRelu, operand_type::RELU);
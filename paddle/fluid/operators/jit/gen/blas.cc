@@ -22,6 +22,10 @@ namespace jit {
 namespace gen {
 
 void VXXJitCode::genCode() {
+  if (isa_ == platform::avx512f) {
+    genZmmCode();
+    return;
+  }
   // do not need push stack, and do not need save avx512reg if do not use avx512
   int offset = 0;
   if (with_relu_) {
@@ -104,6 +108,58 @@ void VXXJitCode::genCode() {
   ret();
 }
 
+void VXXJitCode::genZmmCode() {
+  // only zmm0~zmm3 are used, which do not need to be saved
+  int offset = 0;
+  int rest = num_ % ZMM_FLOAT_BLOCK;
+  int num_blocks = num_ / ZMM_FLOAT_BLOCK + (rest > 0 ? 1 : 0);
+  if (with_relu_) {
+    vpxord(zmm_zero, zmm_zero, zmm_zero);
+  }
+  if (scalar_index_ == 1) {
+    vbroadcastss(zmm_src1, ptr[param1]);
+  } else if (scalar_index_ == 2) {
+    vbroadcastss(zmm_src2, ptr[param2]);
+  }
+  if (rest > 0) {
+    // the last block only loads and stores the rest elements with the mask
+    mov(reg_tail, (1 << rest) - 1);
+    kmovw(k_tail, reg_tail);
+  }
+  for (int i = 0; i < num_blocks; ++i) {
+    bool is_tail = rest > 0 && i == num_blocks - 1;
+    if (scalar_index_ != 1) {
+      if (is_tail) {
+        vmovups(zmm_src1 | k_tail | Xbyak::T_z, ptr[param1 + offset]);
+      } else {
+        vmovups(zmm_src1, ptr[param1 + offset]);
+      }
+    }
+    if (scalar_index_ != 2) {
+      if (is_tail) {
+        vmovups(zmm_src2 | k_tail | Xbyak::T_z, ptr[param2 + offset]);
+      } else {
+        vmovups(zmm_src2, ptr[param2 + offset]);
+      }
+    }
+    if (type_ == operand_type::MUL) {
+      vmulps(zmm_dst, zmm_src1, zmm_src2);
+    } else if (type_ == operand_type::ADD) {
+      vaddps(zmm_dst, zmm_src1, zmm_src2);
+    }
+    if (with_relu_) {
+      vmaxps(zmm_dst, zmm_zero, zmm_dst);
+    }
+    if (is_tail) {
+      vmovups(ptr[param3 + offset] | k_tail, zmm_dst);
+    } else {
+      vmovups(ptr[param3 + offset], zmm_dst);
+    }
+    offset += sizeof(float) * ZMM_FLOAT_BLOCK;
+  }
+  ret();
+}
+
 void NCHW16CMulNCJitCode::genCode() {
   // RDI is ptr x_input
   // RSI is ptr y_input
@@ -146,26 +202,33 @@ class NCHW16CMulNCCreator : public JitCodeCreator<int> {
   }
 };
 
-#define DECLARE_BLAS_CREATOR(name)                                           \
-  class name##Creator : public JitCodeCreator<int> {                         \
+#define DECLARE_BLAS_CREATOR(name, isa_name, isa, block)                    \
+  class name##isa_name##Creator : public JitCodeCreator<int> {               \
    public:                                                                   \
     bool UseMe(const int& attr) const override {                             \
-      return platform::MayIUse(platform::avx);                               \
+      return platform::MayIUse(isa);                                         \
     }                                                                        \
     size_t CodeSize(const int& d) const override {                           \
-      return 96 + d / YMM_FLOAT_BLOCK * 4 * 8;                               \
+      return 96 + (d / block + 1) * 4 * 8;                                   \
     }                                                                        \
     std::unique_ptr<GenBase> CreateJitCode(const int& attr) const override { \
-      return make_unique<name##JitCode>(attr, CodeSize(attr));               \
+      return make_unique<name##JitCode>(attr, isa, CodeSize(attr));          \
     }                                                                        \
   }
 
-DECLARE_BLAS_CREATOR(VMul);
-DECLARE_BLAS_CREATOR(VAdd);
-DECLARE_BLAS_CREATOR(VSub);
-DECLARE_BLAS_CREATOR(VAddRelu);
-DECLARE_BLAS_CREATOR(VScal);
-DECLARE_BLAS_CREATOR(VAddBias);
+DECLARE_BLAS_CREATOR(VMul, AVX, platform::avx, YMM_FLOAT_BLOCK);
+DECLARE_BLAS_CREATOR(VAdd, AVX, platform::avx, YMM_FLOAT_BLOCK);
+DECLARE_BLAS_CREATOR(VSub, AVX, platform::avx, YMM_FLOAT_BLOCK);
+DECLARE_BLAS_CREATOR(VAddRelu, AVX, platform::avx, YMM_FLOAT_BLOCK);
+DECLARE_BLAS_CREATOR(VScal, AVX, platform::avx, YMM_FLOAT_BLOCK);
+DECLARE_BLAS_CREATOR(VAddBias, AVX, platform::avx, YMM_FLOAT_BLOCK);
+
+DECLARE_BLAS_CREATOR(VMul, AVX512, platform::avx512f, ZMM_FLOAT_BLOCK);
+DECLARE_BLAS_CREATOR(VAdd, AVX512, platform::avx512f, ZMM_FLOAT_BLOCK);
+DECLARE_BLAS_CREATOR(VSub, AVX512, platform::avx512f, ZMM_FLOAT_BLOCK);
+DECLARE_BLAS_CREATOR(VAddRelu, AVX512, platform::avx512f, ZMM_FLOAT_BLOCK);
+DECLARE_BLAS_CREATOR(VScal, AVX512, platform::avx512f, ZMM_FLOAT_BLOCK);
+DECLARE_BLAS_CREATOR(VAddBias, AVX512, platform::avx512f, ZMM_FLOAT_BLOCK);
 
 #undef DECLARE_BLAS_CREATOR
 
@@ -176,11 +239,15 @@ DECLARE_BLAS_CREATOR(VAddBias);
 
 namespace gen = paddle::operators::jit::gen;
 
-REGISTER_JITKERNEL_GEN(kVMul, gen::VMulCreator);
-REGISTER_JITKERNEL_GEN(kVAdd, gen::VAddCreator);
+// The AVX512 creators are registered first, so that they are preferred when
+// the CPU supports avx512f.
+REGISTER_JITKERNEL_GEN(kVMul, gen::VMulAVX512Creator, gen::VMulAVXCreator);
+REGISTER_JITKERNEL_GEN(kVAdd, gen::VAddAVX512Creator, gen::VAddAVXCreator);
 // TODO(TJ): enable sub
-// REGISTER_JITKERNEL_GEN(kVSub, gen::VSubCreator);
-REGISTER_JITKERNEL_GEN(kVAddRelu, gen::VAddReluCreator);
-REGISTER_JITKERNEL_GEN(kVScal, gen::VScalCreator);
-REGISTER_JITKERNEL_GEN(kVAddBias, gen::VAddBiasCreator);
+// REGISTER_JITKERNEL_GEN(kVSub, gen::VSubAVX512Creator, gen::VSubAVXCreator);
+REGISTER_JITKERNEL_GEN(kVAddRelu, gen::VAddReluAVX512Creator,
+                       gen::VAddReluAVXCreator);
+REGISTER_JITKERNEL_GEN(kVScal, gen::VScalAVX512Creator, gen::VScalAVXCreator);
+REGISTER_JITKERNEL_GEN(kVAddBias, gen::VAddBiasAVX512Creator,
+                       gen::VAddBiasAVXCreator);
 REGISTER_JITKERNEL_GEN(kNCHW16CMulNC, gen::NCHW16CMulNCCreator);
@@ -0,0 +1,113 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/fluid/operators/jit/gen/matmul.h"
+#include <algorithm>  // for min
+#include "paddle/fluid/operators/jit/registry.h"
+#include "paddle/fluid/platform/cpu_info.h"
+
+namespace paddle {
+namespace operators {
+namespace jit {
+namespace gen {
+
+void MatMulJitCode::genCode() {
+  constexpr int block = YMM_FLOAT_BLOCK;
+  constexpr int max_num_regs = 12;
+  // The registers after the accumulators.
+  const ymm_t ymm_a = ymm_t(max_num_regs);
+  const ymm_t ymm_tmp = ymm_t(max_num_regs + 1);
+  const bool use_fma = platform::MayIUse(platform::avx2);
+  const int num_block = n_ / block;
+  const int row_a_bytes = k_ * sizeof(float);
+  const int row_bc_bytes = n_ * sizeof(float);
+
+  mov(reg_row_a, param_a);
+  mov(reg_row_c, param_c);
+  xor_(reg_m_i, reg_m_i);
+  Label l_next_m;
+  L(l_next_m);
+  for (int g = 0; g * max_num_regs < num_block; ++g) {
+    const int num_regs = std::min(max_num_regs, num_block - g * max_num_regs);
+    const int group_offset = g * max_num_regs * block * sizeof(float);
+    for (int i = 0; i < num_regs; ++i) {
+      vxorps(ymm_t(i), ymm_t(i), ymm_t(i));
+    }
+    mov(reg_ptr_a, reg_row_a);
+    mov(reg_ptr_b, param_b);
+    if (group_offset > 0) {
+      add(reg_ptr_b, group_offset);
+    }
+    xor_(reg_k_i, reg_k_i);
+    Label l_next_k;
+    L(l_next_k);
+    {
+      vbroadcastss(ymm_a, ptr[reg_ptr_a]);
+      for (int i = 0; i < num_regs; ++i) {
+        const int offset = i * block * sizeof(float);
+        if (use_fma) {
+          vfmadd231ps(ymm_t(i), ymm_a, ptr[reg_ptr_b + offset]);
+        } else {
+          vmulps(ymm_tmp, ymm_a, ptr[reg_ptr_b + offset]);
+          vaddps(ymm_t(i), ymm_t(i), ymm_tmp);
+        }
+      }
+      add(reg_ptr_a, sizeof(float));
+      add(reg_ptr_b, row_bc_bytes);
+      inc(reg_k_i);
+      cmp(reg_k_i, k_);
+      jl(l_next_k, T_NEAR);
+    }
+    for (int i = 0; i < num_regs; ++i) {
+      const int offset = group_offset + i * block * sizeof(float);
+      vmovups(ptr[reg_row_c + offset], ymm_t(i));
+    }
+  }
+  add(reg_row_a, row_a_bytes);
+  add(reg_row_c, row_bc_bytes);
+  inc(reg_m_i);
+  cmp(reg_m_i, m_);
+  jl(l_next_m, T_NEAR);
+  ret();
+}
+
+class MatMulCreator : public JitCodeCreator<matmul_attr_t> {
+ public:
+  // The calling overhead of BLAS dominates only with small M.
+  bool UseMe(const matmul_attr_t& attr) const override {
+    return platform::MayIUse(platform::avx) && attr.m <= 16 &&
+           attr.n % YMM_FLOAT_BLOCK == 0;
+  }
+  size_t CodeSize(const matmul_attr_t& attr) const override {
+    return 96 + (attr.n / YMM_FLOAT_BLOCK * 4 /* zero, fma and save */ +
+                 (attr.n / YMM_FLOAT_BLOCK / 12 + 1) * 32 /* loops */) *
+                    8;
+  }
+  std::unique_ptr<GenBase> CreateJitCode(
+      const matmul_attr_t& attr) const override {
+    PADDLE_ENFORCE_GT(attr.m, 0);
+    PADDLE_ENFORCE_GT(attr.n, 0);
+    PADDLE_ENFORCE_GT(attr.k, 0);
+    return make_unique<MatMulJitCode>(attr, CodeSize(attr));
+  }
+};
+
+}  // namespace gen
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
+
+namespace gen = paddle::operators::jit::gen;
+
+REGISTER_JITKERNEL_GEN(kMatMul, gen::MatMulCreator);
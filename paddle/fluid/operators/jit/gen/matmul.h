@@ -0,0 +1,64 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#pragma once
+
+#include "glog/logging.h"
+#include "paddle/fluid/operators/jit/gen/jitcode.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace jit {
+namespace gen {
+
+// C = A * B with the sizes M, N and K specialized. For each row of C, the
+// columns are computed by groups of max_num_regs ymm registers, and each
+// group accumulates the broadcasted A(m, k) times the row k of B.
+// N should be a multiple of YMM_FLOAT_BLOCK.
+class MatMulJitCode : public JitCode {
+ public:
+  explicit MatMulJitCode(const matmul_attr_t& attr,
+                         size_t code_size = 256 * 1024,
+                         void* code_ptr = nullptr)
+      : JitCode(code_size, code_ptr), m_(attr.m), n_(attr.n), k_(attr.k) {
+    PADDLE_ENFORCE_EQ(n_ % YMM_FLOAT_BLOCK, 0, "N should be multiple of %d",
+                      YMM_FLOAT_BLOCK);
+    this->genCode();
+  }
+
+  DECLARE_JIT_CODE(MatMulJitCode);
+  void genCode() override;
+
+ private:
+  int m_, n_, k_;
+
+  reg64_t param_a{abi_param1};
+  reg64_t param_b{abi_param2};
+  reg64_t param_c{abi_param3};
+  reg64_t param_attr{abi_param4};
+
+  // Only the caller-saved registers are used, so no need to save them.
+  reg64_t reg_ptr_a{rax};
+  reg64_t reg_ptr_b{param_attr};
+  reg64_t reg_row_a{r8};
+  reg64_t reg_row_c{r9};
+  reg64_t reg_m_i{r10};
+  reg64_t reg_k_i{r11};
+};
+
+}  // namespace gen
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
@@ -31,8 +31,8 @@ class SeqPoolJitCode : public JitCode {
                           void* code_ptr = nullptr)
       : JitCode(code_size, code_ptr), w_(attr.w), type_(attr.type) {
     if (!(type_ == SeqPoolType::kSum || type_ == SeqPoolType::kAvg ||
-          type_ == SeqPoolType::kSqrt)) {
-      LOG(FATAL) << "Only support sum pool yet ";
+          type_ == SeqPoolType::kSqrt || type_ == SeqPoolType::kMax)) {
+      LOG(FATAL) << "Only support sum, avg, sqrt and max pool yet ";
     }
     fp_h_[0] = 1.f;
     this->genCode();
@@ -46,6 +46,8 @@ class SeqPoolJitCode : public JitCode {
       base += "_Avg";
     } else if (type_ == SeqPoolType::kSqrt) {
       base += "_Sqrt";
+    } else if (type_ == SeqPoolType::kMax) {
+      base += "_Max";
     }
     base += ("_W" + std::to_string(w_));
     return base.c_str();
@@ -71,8 +73,11 @@ class SeqPoolJitCode : public JitCode {
       mov(reg_ptr_src_i, reg_tmp);
       for (int i = 0; i < max_num_regs; ++i) {
         vmovups(JMM(i + max_num_regs), ptr[reg_ptr_src_i]);
-        // sum anyway
-        vaddps(JMM(i), JMM(i), JMM(i + max_num_regs));
+        if (type_ == SeqPoolType::kMax) {
+          vmaxps(JMM(i), JMM(i), JMM(i + max_num_regs));
+        } else {
+          vaddps(JMM(i), JMM(i), JMM(i + max_num_regs));
+        }
         add(reg_ptr_src_i, sizeof(float) * block);
       }
       inc(reg_h_i);
@@ -128,7 +133,11 @@ class SeqPoolJitCode : public JitCode {
       PADDLE_ENFORCE_EQ(reg_idx, rest_used_num_regs,
                         "All heights should use same regs");
       for (int i = 0; i < reg_idx; ++i) {
-        vaddps(xmm_t(i), xmm_t(i), xmm_t(i + max_num_regs));
+        if (type_ == SeqPoolType::kMax) {
+          vmaxps(xmm_t(i), xmm_t(i), xmm_t(i + max_num_regs));
+        } else {
+          vaddps(xmm_t(i), xmm_t(i), xmm_t(i + max_num_regs));
+        }
       }
       inc(reg_h_i);
       add(reg_tmp, w_ * sizeof(float));
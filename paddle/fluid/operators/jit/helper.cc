@@ -47,6 +47,9 @@ const char* to_string(KernelType kt) {
     ONE_CASE(kLayerNorm);
     ONE_CASE(kNCHW16CMulNC);
     ONE_CASE(kSeqPool);
+    ONE_CASE(kMatMul);
+    ONE_CASE(kSoftmax);
+    ONE_CASE(kSoftmaxCrossEntropy);
     default:
       PADDLE_THROW("Not support type: %d, or forget to add it.", kt);
       return "NOT JITKernel";
@@ -60,6 +63,7 @@ const char* to_string(SeqPoolType tp) {
     ONE_CASE(kSum);
     ONE_CASE(kAvg);
     ONE_CASE(kSqrt);
+    ONE_CASE(kMax);
     default:
       PADDLE_THROW("Not support type: %d, or forget to add it.", tp);
       return "NOT PoolType";
@@ -140,6 +140,10 @@ inline std::ostream& operator<<(std::ostream& os, const seq_pool_attr_t& attr) {
      << to_string(attr.type) << "]";
   return os;
 }
+inline std::ostream& operator<<(std::ostream& os, const matmul_attr_t& attr) {
+  os << "M[" << attr.m << "],N[" << attr.n << "],K[" << attr.k << "]";
+  return os;
+}
 
 }  // namespace jit
 }  // namespace operators
@@ -13,6 +13,7 @@
  * limitations under the License. */
 
 #pragma once
+#include <cstdint>
 #include "paddle/fluid/operators/jit/macro.h"
 #include "paddle/fluid/platform/macros.h"
 
@@ -42,6 +43,9 @@ typedef enum {
   kLayerNorm,
   kNCHW16CMulNC,
   kSeqPool,
+  kMatMul,
+  kSoftmax,
+  kSoftmaxCrossEntropy,
 } KernelType;
 
 typedef enum {
@@ -49,6 +53,7 @@ typedef enum {
   kSum = 1,
   kAvg,
   kSqrt,
+  kMax,
 } SeqPoolType;
 
 template <typename T>
@@ -135,6 +140,38 @@ struct SeqPoolTuples {
   typedef void (*func_type)(const T*, T*, const seq_pool_attr_t*);
 };
 
+typedef struct matmul_attr_s {
+  int m, n, k;
+  matmul_attr_s() = default;
+  explicit matmul_attr_s(int m_, int n_, int k_) : m(m_), n(n_), k(k_) {}
+} matmul_attr_t;
+
+// C = A * B, where A, B and C are row major matrices of M x K, K x N and M x N
+template <typename T>
+struct MatMulTuples {
+  typedef T data_type;
+  typedef matmul_attr_t attr_type;
+  typedef void (*func_type)(const T*, const T*, T*, const matmul_attr_t*);
+};
+
+// y = softmax(x), where x and y are bs rows of n elements
+template <typename T>
+struct SoftmaxTuples {
+  typedef T data_type;
+  typedef int attr_type;
+  typedef void (*func_type)(const T*, T*, int, int);
+};
+
+// y = softmax(x) and loss = -log(y[label]) of each row, where the loss is 0
+// if the label equals ignore_index.
+// func(x, label, y, loss, n, bs, ignore_index)
+template <typename T>
+struct SoftmaxCrossEntropyTuples {
+  typedef T data_type;
+  typedef int attr_type;
+  typedef void (*func_type)(const T*, const int64_t*, T*, T*, int, int, int);
+};
+
 template <typename T>
 struct CRFDecodingTuples {
   typedef T data_type;
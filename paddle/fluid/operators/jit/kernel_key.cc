@@ -49,6 +49,15 @@ size_t JitCodeKey<seq_pool_attr_t>(const seq_pool_attr_t& attr) {
   return (key << pool_type_shift) + static_cast<int>(attr.type);
 }
 
+template <>
+size_t JitCodeKey<matmul_attr_t>(const matmul_attr_t& attr) {
+  // Suppose M, N and K are all less than 2^20.
+  constexpr int shift = 20;
+  size_t key = attr.m;
+  key = (key << shift) + attr.n;
+  return (key << shift) + attr.k;
+}
+
 }  // namespace jit
 }  // namespace operators
 }  // namespace paddle
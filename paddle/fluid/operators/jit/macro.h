@@ -22,6 +22,8 @@ namespace jit {
 #define SIGMOID_THRESHOLD_MIN -40.0
 #define SIGMOID_THRESHOLD_MAX 13.0
 #define EXP_MAX_INPUT 40.0
+// the shifted logits of softmax are clipped to avoid too small probability
+#define SOFTMAX_SHIFT_MIN -64.0
 
 #define XMM_FLOAT_BLOCK 4
 #define YMM_FLOAT_BLOCK 8
@@ -13,6 +13,7 @@
  * limitations under the License. */
 
 #include "paddle/fluid/operators/jit/more/mix/mix.h"
+#include <cmath>
 #include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/operators/jit/registry.h"
 #include "paddle/fluid/platform/cpu_info.h"
@@ -179,6 +180,62 @@ void GRUHtPart2(gru_t* step, const gru_attr_t* attr) {
   }
 }
 
+// Shift the row by its max value and clip, the loops are simple enough to be
+// vectorized by the compiler.
+static inline void SoftmaxShift(const T* x, T* y, int n) {
+  T max = x[0];
+  for (int i = 1; i < n; ++i) {
+    max = x[i] > max ? x[i] : max;
+  }
+  const T min = static_cast<T>(SOFTMAX_SHIFT_MIN);
+  for (int i = 0; i < n; ++i) {
+    T shifted = x[i] - max;
+    y[i] = shifted < min ? min : shifted;
+  }
+}
+
+static inline T Sum(const T* x, int n) {
+  T sum = static_cast<T>(0);
+  for (int i = 0; i < n; ++i) {
+    sum += x[i];
+  }
+  return sum;
+}
+
+// Each row is computed with all passes while it is still in cache, and the
+// exp and scale use the jitcode.
+void Softmax(const T* x, T* y, int n, int bs) {
+  auto compute_exp = Get<kVExp, XYNTuples<T>, platform::CPUPlace>(n);
+  auto compute_scal = Get<kVScal, AXYNTuples<T>, platform::CPUPlace>(n);
+  for (int i = 0; i < bs; ++i) {
+    SoftmaxShift(x, y, n);
+    compute_exp(y, y, n);
+    T scalar = static_cast<T>(1) / Sum(y, n);
+    compute_scal(&scalar, y, y, n);
+    x += n;
+    y += n;
+  }
+}
+
+void SoftmaxCrossEntropy(const T* x, const int64_t* label, T* y, T* loss,
+                         int n, int bs, int ignore_index) {
+  auto compute_exp = Get<kVExp, XYNTuples<T>, platform::CPUPlace>(n);
+  auto compute_scal = Get<kVScal, AXYNTuples<T>, platform::CPUPlace>(n);
+  for (int i = 0; i < bs; ++i) {
+    SoftmaxShift(x, y, n);
+    const bool ignored = label[i] == ignore_index;
+    T shifted = ignored ? static_cast<T>(0) : y[label[i]];
+    compute_exp(y, y, n);
+    T sum = Sum(y, n);
+    T scalar = static_cast<T>(1) / sum;
+    compute_scal(&scalar, y, y, n);
+    // -log(exp(shifted) / sum), which does not lose precision of small y
+    loss[i] = ignored ? static_cast<T>(0) : std::log(sum) - shifted;
+    x += n;
+    y += n;
+  }
+}
+
 // TODO(TJ): tuning me
 bool VSigmoidKernel::UseMe(const int& d) const { return true; }
 
@@ -194,6 +251,10 @@ bool GRUHtPart1Kernel::UseMe(const gru_attr_t& attr) const { return true; }
 
 bool GRUHtPart2Kernel::UseMe(const gru_attr_t& attr) const { return true; }
 
+bool SoftmaxKernel::UseMe(const int& d) const { return true; }
+
+bool SoftmaxCrossEntropyKernel::UseMe(const int& d) const { return true; }
+
 }  // namespace mix
 }  // namespace more
 }  // namespace jit
@@ -212,5 +273,7 @@ REGISTER_MORE_KERNEL(kLSTMC1H1, LSTMC1H1);
 REGISTER_MORE_KERNEL(kGRUH1, GRUH1);
 REGISTER_MORE_KERNEL(kGRUHtPart1, GRUHtPart1);
 REGISTER_MORE_KERNEL(kGRUHtPart2, GRUHtPart2);
+REGISTER_MORE_KERNEL(kSoftmax, Softmax);
+REGISTER_MORE_KERNEL(kSoftmaxCrossEntropy, SoftmaxCrossEntropy);
 
 #undef REGISTER_MORE_KERNEL
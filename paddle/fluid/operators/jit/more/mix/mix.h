@@ -33,6 +33,10 @@ void GRUH1(gru_t* step, const gru_attr_t* attr);
 void GRUHtPart1(gru_t* step, const gru_attr_t* attr);
 void GRUHtPart2(gru_t* step, const gru_attr_t* attr);
 
+void Softmax(const T* x, T* y, int n, int bs);
+void SoftmaxCrossEntropy(const T* x, const int64_t* label, T* y, T* loss,
+                         int n, int bs, int ignore_index);
+
 #define DECLARE_MORE_KERNEL(name, tuples)                            \
   class name##Kernel : public KernelMore<tuples<T>> {                \
    public:                                                           \
@@ -52,6 +56,9 @@ DECLARE_MORE_KERNEL(GRUH1, GRUTuples);
 DECLARE_MORE_KERNEL(GRUHtPart1, GRUTuples);
 DECLARE_MORE_KERNEL(GRUHtPart2, GRUTuples);
 
+DECLARE_MORE_KERNEL(Softmax, SoftmaxTuples);
+DECLARE_MORE_KERNEL(SoftmaxCrossEntropy, SoftmaxCrossEntropyTuples);
+
 #undef DECLARE_MORE_KERNEL
 
 }  // namespace mix
@@ -24,6 +24,22 @@ namespace jit {
 namespace more {
 namespace mkl {
 
+template <>
+void MatMul<float>(const float* a, const float* b, float* c,
+                   const matmul_attr_t* attr) {
+  platform::dynload::cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans,
+                                 attr->m, attr->n, attr->k, 1.f, a, attr->k,
+                                 b, attr->n, 0.f, c, attr->n);
+}
+
+template <>
+void MatMul<double>(const double* a, const double* b, double* c,
+                    const matmul_attr_t* attr) {
+  platform::dynload::cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans,
+                                 attr->m, attr->n, attr->k, 1.0, a, attr->k,
+                                 b, attr->n, 0.0, c, attr->n);
+}
+
 template <>
 void VMul<float>(const float* x, const float* y, float* z, int n) {
   platform::dynload::vsMul(n, x, y, z);
@@ -125,11 +141,21 @@ bool VTanhKernel<float>::UseMe(const int& d) const {
 
 template <>
 bool SeqPoolKernel<float>::UseMe(const seq_pool_attr_t& attr) const {
-  return true;
+  return attr.type != SeqPoolType::kMax;
 }
 
 template <>
 bool SeqPoolKernel<double>::UseMe(const seq_pool_attr_t& attr) const {
+  return attr.type != SeqPoolType::kMax;
+}
+
+template <>
+bool MatMulKernel<float>::UseMe(const matmul_attr_t& attr) const {
+  return true;
+}
+
+template <>
+bool MatMulKernel<double>::UseMe(const matmul_attr_t& attr) const {
   return true;
 }
 
@@ -166,5 +192,6 @@ REGISTER_MKL_KERNEL(kVExp, VExp);
 REGISTER_MKL_KERNEL(kVSigmoid, VSigmoid);
 REGISTER_MKL_KERNEL(kVTanh, VTanh);
 REGISTER_MKL_KERNEL(kSeqPool, SeqPool);
+REGISTER_MKL_KERNEL(kMatMul, MatMul);
 
 #undef REGISTER_MKL_KERNEL
@@ -24,6 +24,9 @@ namespace jit {
 namespace more {
 namespace mkl {
 
+template <typename T>
+void MatMul(const T* a, const T* b, T* c, const matmul_attr_t* attr);
+
 template <typename T>
 void VMul(const T* x, const T* y, T* z, int n);
 
@@ -107,6 +110,8 @@ DECLARE_MKL_KERNEL(VTanh, XYNTuples);
 
 DECLARE_MKL_KERNEL(SeqPool, SeqPoolTuples);
 
+DECLARE_MKL_KERNEL(MatMul, MatMulTuples);
+
 #undef DECLARE_MKL_KERNEL
 
 }  // namespace mkl
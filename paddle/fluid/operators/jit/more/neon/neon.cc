@@ -0,0 +1,486 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "paddle/fluid/operators/jit/more/neon/neon.h"
+#include <arm_neon.h>
+#include <algorithm>
+#include <cmath>
+#include "paddle/fluid/operators/jit/registry.h"
+
+namespace paddle {
+namespace operators {
+namespace jit {
+namespace more {
+namespace neon {
+
+static constexpr int kBlock = XMM_FLOAT_BLOCK;
+
+// exp of Cephes, the input is clipped so that the result is finite.
+static inline float32x4_t Exp(float32x4_t x) {
+  x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(-88.f)), vdupq_n_f32(88.f));
+  // exp(x) = 2^n * exp(r), n = floor(x / ln2 + 0.5), r = x - n * ln2
+  float32x4_t fx = vfmaq_f32(vdupq_n_f32(0.5f), x, vdupq_n_f32(1.44269504f));
+  fx = vrndmq_f32(fx);
+  x = vfmsq_f32(x, fx, vdupq_n_f32(0.693359375f));
+  x = vfmsq_f32(x, fx, vdupq_n_f32(-2.12194440e-4f));
+  float32x4_t y = vdupq_n_f32(1.9875691500e-4f);
+  y = vfmaq_f32(vdupq_n_f32(1.3981999507e-3f), y, x);
+  y = vfmaq_f32(vdupq_n_f32(8.3334519073e-3f), y, x);
+  y = vfmaq_f32(vdupq_n_f32(4.1665795894e-2f), y, x);
+  y = vfmaq_f32(vdupq_n_f32(1.6666665459e-1f), y, x);
+  y = vfmaq_f32(vdupq_n_f32(5.0000001201e-1f), y, x);
+  y = vfmaq_f32(vaddq_f32(x, vdupq_n_f32(1.f)), y, vmulq_f32(x, x));
+  int32x4_t n = vaddq_s32(vcvtq_s32_f32(fx), vdupq_n_s32(127));
+  return vmulq_f32(y, vreinterpretq_f32_s32(vshlq_n_s32(n, 23)));
+}
+
+static inline float32x4_t Sigmoid(float32x4_t x) {
+  x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(SIGMOID_THRESHOLD_MIN)),
+                vdupq_n_f32(SIGMOID_THRESHOLD_MAX));
+  const float32x4_t one = vdupq_n_f32(1.f);
+  return vdivq_f32(one, vaddq_f32(one, Exp(vnegq_f32(x))));
+}
+
+// tanh(x) = 2 * sigmoid(2x) - 1, the same as the refer kernel.
+static inline float32x4_t Tanh(float32x4_t x) {
+  const float32x4_t two = vdupq_n_f32(2.f);
+  return vfmaq_f32(vdupq_n_f32(-1.f), two, Sigmoid(vmulq_f32(two, x)));
+}
+
+static inline T Sigmoid(T x) {
+  const T min = SIGMOID_THRESHOLD_MIN;
+  const T max = SIGMOID_THRESHOLD_MAX;
+  x = (x < min) ? min : ((x > max) ? max : x);
+  return static_cast<T>(1) / (static_cast<T>(1) + std::exp(-x));
+}
+
+static inline T Tanh(T x) {
+  return static_cast<T>(2) * Sigmoid(static_cast<T>(2) * x) -
+         static_cast<T>(1);
+}
+
+static inline T Sum(float32x4_t x) { return vaddvq_f32(x); }
+
+void VMul(const T* x, const T* y, T* z, int n) {
+  int i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    vst1q_f32(z + i, vmulq_f32(vld1q_f32(x + i), vld1q_f32(y + i)));
+  }
+  for (; i < n; ++i) {
+    z[i] = x[i] * y[i];
+  }
+}
+
+void VAdd(const T* x, const T* y, T* z, int n) {
+  int i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    vst1q_f32(z + i, vaddq_f32(vld1q_f32(x + i), vld1q_f32(y + i)));
+  }
+  for (; i < n; ++i) {
+    z[i] = x[i] + y[i];
+  }
+}
+
+void VAddRelu(const T* x, const T* y, T* z, int n) {
+  const float32x4_t zero = vdupq_n_f32(0.f);
+  int i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    float32x4_t sum = vaddq_f32(vld1q_f32(x + i), vld1q_f32(y + i));
+    vst1q_f32(z + i, vmaxq_f32(sum, zero));
+  }
+  for (; i < n; ++i) {
+    T sum = x[i] + y[i];
+    z[i] = sum > 0 ? sum : 0;
+  }
+}
+
+void VSub(const T* x, const T* y, T* z, int n) {
+  int i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    vst1q_f32(z + i, vsubq_f32(vld1q_f32(x + i), vld1q_f32(y + i)));
+  }
+  for (; i < n; ++i) {
+    z[i] = x[i] - y[i];
+  }
+}
+
+void VScal(const T* a, const T* x, T* y, int n) {
+  const float32x4_t scalar = vdupq_n_f32(*a);
+  int i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    vst1q_f32(y + i, vmulq_f32(scalar, vld1q_f32(x + i)));
+  }
+  for (; i < n; ++i) {
+    y[i] = a[0] * x[i];
+  }
+}
+
+void VAddBias(const T* a, const T* x, T* y, int n) {
+  const float32x4_t bias = vdupq_n_f32(*a);
+  int i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    vst1q_f32(y + i, vaddq_f32(bias, vld1q_f32(x + i)));
+  }
+  for (; i < n; ++i) {
+    y[i] = a[0] + x[i];
+  }
+}
+
+void VRelu(const T* x, T* y, int n) {
+  const float32x4_t zero = vdupq_n_f32(0.f);
+  int i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    vst1q_f32(y + i, vmaxq_f32(vld1q_f32(x + i), zero));
+  }
+  for (; i < n; ++i) {
+    y[i] = x[i] > 0 ? x[i] : 0;
+  }
+}
+
+void VExp(const T* x, T* y, int n) {
+  int i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    vst1q_f32(y + i, Exp(vld1q_f32(x + i)));
+  }
+  for (; i < n; ++i) {
+    y[i] = std::exp(x[i]);
+  }
+}
+
+void VSigmoid(const T* x, T* y, int n) {
+  int i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    vst1q_f32(y + i, Sigmoid(vld1q_f32(x + i)));
+  }
+  for (; i < n; ++i) {
+    y[i] = Sigmoid(x[i]);
+  }
+}
+
+void VTanh(const T* x, T* y, int n) {
+  int i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    vst1q_f32(y + i, Tanh(vld1q_f32(x + i)));
+  }
+  for (; i < n; ++i) {
+    y[i] = Tanh(x[i]);
+  }
+}
+
+// gates: W_ch, W_ih, W_fh, W_oh
+void LSTMCtHt(lstm_t* step, const lstm_attr_t* attr) {
+  const T* gates = reinterpret_cast<const T*>(step->gates);
+  const T* ct_1 = reinterpret_cast<const T*>(step->ct_1);
+  T* ct = reinterpret_cast<T*>(step->ct);
+  T* ht = reinterpret_cast<T*>(step->ht);
+  const T* wp = reinterpret_cast<const T*>(step->wp);
+  const int d = attr->d;
+  const bool peephole = attr->use_peephole;
+  int i = 0;
+  for (; i + kBlock <= d; i += kBlock) {
+    float32x4_t c_1 = vld1q_f32(ct_1 + i);
+    float32x4_t ig = vld1q_f32(gates + d + i);
+    float32x4_t fg = vld1q_f32(gates + 2 * d + i);
+    float32x4_t og = vld1q_f32(gates + 3 * d + i);
+    if (peephole) {
+      ig = vfmaq_f32(ig, vld1q_f32(wp + i), c_1);
+      fg = vfmaq_f32(fg, vld1q_f32(wp + d + i), c_1);
+    }
+    // C_t = C_t-1 * fgated + cand_gated * igated
+    float32x4_t c = vmulq_f32(Tanh(vld1q_f32(gates + i)), Sigmoid(ig));
+    c = vfmaq_f32(c, c_1, Sigmoid(fg));
+    vst1q_f32(ct + i, c);
+    if (peephole) {
+      og = vfmaq_f32(og, vld1q_f32(wp + 2 * d + i), c);
+    }
+    // H_t = act_cell(C_t) * ogated
+    vst1q_f32(ht + i, vmulq_f32(Tanh(c), Sigmoid(og)));
+  }
+  for (; i < d; ++i) {
+    T ig = gates[d + i];
+    T fg = gates[2 * d + i];
+    T og = gates[3 * d + i];
+    if (peephole) {
+      ig += wp[i] * ct_1[i];
+      fg += wp[d + i] * ct_1[i];
+    }
+    T c = Tanh(gates[i]) * Sigmoid(ig) + ct_1[i] * Sigmoid(fg);
+    ct[i] = c;
+    if (peephole) {
+      og += wp[2 * d + i] * c;
+    }
+    ht[i] = Tanh(c) * Sigmoid(og);
+  }
+}
+
+// compute c1 and h1 without c0 or h0
+void LSTMC1H1(lstm_t* step, const lstm_attr_t* attr) {
+  const T* gates = reinterpret_cast<const T*>(step->gates);
+  T* ct = reinterpret_cast<T*>(step->ct);
+  T* ht = reinterpret_cast<T*>(step->ht);
+  const T* wp = reinterpret_cast<const T*>(step->wp);
+  const int d = attr->d;
+  const bool peephole = attr->use_peephole;
+  int i = 0;
+  for (; i + kBlock <= d; i += kBlock) {
+    float32x4_t c = vmulq_f32(Tanh(vld1q_f32(gates + i)),
+                              Sigmoid(vld1q_f32(gates + d + i)));
+    vst1q_f32(ct + i, c);
+    float32x4_t og = vld1q_f32(gates + 3 * d + i);
+    if (peephole) {
+      og = vfmaq_f32(og, vld1q_f32(wp + 2 * d + i), c);
+    }
+    vst1q_f32(ht + i, vmulq_f32(Tanh(c), Sigmoid(og)));
+  }
+  for (; i < d; ++i) {
+    T c = Tanh(gates[i]) * Sigmoid(gates[d + i]);
+    ct[i] = c;
+    T og = gates[3 * d + i];
+    if (peephole) {
+      og += wp[2 * d + i] * c;
+    }
+    ht[i] = Tanh(c) * Sigmoid(og);
+  }
+}
+
+// compute h1 without h0
+void GRUH1(gru_t* step, const gru_attr_t* attr) {
+  const T* gates = reinterpret_cast<const T*>(step->gates);
+  T* ht = reinterpret_cast<T*>(step->ht);
+  const int d = attr->d;
+  int i = 0;
+  for (; i + kBlock <= d; i += kBlock) {
+    vst1q_f32(ht + i, vmulq_f32(Sigmoid(vld1q_f32(gates + i)),
+                                Tanh(vld1q_f32(gates + 2 * d + i))));
+  }
+  for (; i < d; ++i) {
+    ht[i] = Sigmoid(gates[i]) * Tanh(gates[2 * d + i]);
+  }
+}
+
+// compute the first part of GRU: ht = act_gate(r) * ht_1
+void GRUHtPart1(gru_t* step, const gru_attr_t* attr) {
+  const T* gates = reinterpret_cast<const T*>(step->gates);
+  T* ht = reinterpret_cast<T*>(step->ht);
+  const T* ht_1 = reinterpret_cast<const T*>(step->ht_1);
+  const int d = attr->d;
+  int i = 0;
+  for (; i + kBlock <= d; i += kBlock) {
+    vst1q_f32(ht + i, vmulq_f32(Sigmoid(vld1q_f32(gates + d + i)),
+                                vld1q_f32(ht_1 + i)));
+  }
+  for (; i < d; ++i) {
+    ht[i] = Sigmoid(gates[d + i]) * ht_1[i];
+  }
+}
+
+// compute the second part of GRU:
+// ht = act_gate(u) * act_cand(s) + (1-act_gate(u)) * ht_1
+void GRUHtPart2(gru_t* step, const gru_attr_t* attr) {
+  const T* gates = reinterpret_cast<const T*>(step->gates);
+  T* ht = reinterpret_cast<T*>(step->ht);
+  const T* ht_1 = reinterpret_cast<const T*>(step->ht_1);
+  const int d = attr->d;
+  int i = 0;
+  for (; i + kBlock <= d; i += kBlock) {
+    float32x4_t u = Sigmoid(vld1q_f32(gates + i));
+    float32x4_t s = Tanh(vld1q_f32(gates + 2 * d + i));
+    float32x4_t h_1 = vld1q_f32(ht_1 + i);
+    // u * s + (1 - u) * ht_1 = ht_1 + u * (s - ht_1)
+    vst1q_f32(ht + i, vfmaq_f32(h_1, u, vsubq_f32(s, h_1)));
+  }
+  for (; i < d; ++i) {
+    T u = Sigmoid(gates[i]);
+    ht[i] = u * Tanh(gates[2 * d + i]) + (static_cast<T>(1) - u) * ht_1[i];
+  }
+}
+
+void SeqPool(const T* x, T* y, const seq_pool_attr_t* attr) {
+  const int w = attr->w;
+  if (attr->type == SeqPoolType::kMax) {
+    int j = 0;
+    for (; j + kBlock <= w; j += kBlock) {
+      float32x4_t max = vld1q_f32(x + j);
+      for (int h = 1; h < attr->h; ++h) {
+        max = vmaxq_f32(max, vld1q_f32(x + h * w + j));
+      }
+      vst1q_f32(y + j, max);
+    }
+    for (; j < w; ++j) {
+      T max = x[j];
+      for (int h = 1; h < attr->h; ++h) {
+        max = std::max(max, x[h * w + j]);
+      }
+      y[j] = max;
+    }
+    return;
+  }
+  T scalar = static_cast<T>(1);
+  if (attr->type == SeqPoolType::kAvg) {
+    scalar = scalar / static_cast<T>(attr->h);
+  } else if (attr->type == SeqPoolType::kSqrt) {
+    scalar = scalar / std::sqrt(static_cast<T>(attr->h));
+  }
+  // Sum a block of the columns of all the rows in the registers.
+  int j = 0;
+  for (; j + kBlock <= w; j += kBlock) {
+    float32x4_t sum = vdupq_n_f32(0.f);
+    for (int h = 0; h < attr->h; ++h) {
+      sum = vaddq_f32(sum, vld1q_f32(x + h * w + j));
+    }
+    vst1q_f32(y + j, vmulq_f32(sum, vdupq_n_f32(scalar)));
+  }
+  for (; j < w; ++j) {
+    T sum = static_cast<T>(0);
+    for (int h = 0; h < attr->h; ++h) {
+      sum += x[h * w + j];
+    }
+    y[j] = sum * scalar;
+  }
+}
+
+void LayerNorm(T* x, T* out, T* mean, T* var, const T* scale, const T* bias,
+               int height, const float epsilon, int right) {
+  const int end = right - right % kBlock;
+  const T inv_right = static_cast<T>(1) / right;
+  for (int i = 0; i < height; ++i) {
+    const T* row = x + i * right;
+    T* out_row = out + i * right;
+
+    float32x4_t sum = vdupq_n_f32(0.f);
+    for (int j = 0; j < end; j += kBlock) {
+      sum = vaddq_f32(sum, vld1q_f32(row + j));
+    }
+    T mean_i = Sum(sum);
+    for (int j = end; j < right; ++j) {
+      mean_i += row[j];
+    }
+    mean_i *= inv_right;
+    mean[i] = mean_i;
+
+    const float32x4_t mean_vec = vdupq_n_f32(mean_i);
+    sum = vdupq_n_f32(0.f);
+    for (int j = 0; j < end; j += kBlock) {
+      float32x4_t diff = vsubq_f32(vld1q_f32(row + j), mean_vec);
+      sum = vfmaq_f32(sum, diff, diff);
+    }
+    T var_i = Sum(sum);
+    for (int j = end; j < right; ++j) {
+      var_i += (row[j] - mean_i) * (row[j] - mean_i);
+    }
+    var_i *= inv_right;
+    var[i] = var_i;
+
+    const T inv_std = static_cast<T>(1) / std::sqrt(var_i + epsilon);
+    const float32x4_t inv_std_vec = vdupq_n_f32(inv_std);
+    for (int j = 0; j < end; j += kBlock) {
+      float32x4_t y =
+          vmulq_f32(vsubq_f32(vld1q_f32(row + j), mean_vec), inv_std_vec);
+      if (scale) {
+        y = vmulq_f32(y, vld1q_f32(scale + j));
+      }
+      if (bias) {
+        y = vaddq_f32(y, vld1q_f32(bias + j));
+      }
+      vst1q_f32(out_row + j, y);
+    }
+    for (int j = end; j < right; ++j) {
+      T y = (row[j] - mean_i) * inv_std;
+      if (scale) {
+        y *= scale[j];
+      }
+      if (bias) {
+        y += bias[j];
+      }
+      out_row[j] = y;
+    }
+  }
+}
+
+#define USE_ME_WITH_BLOCK(func) \
+  bool func##Kernel::UseMe(const int& d) const { return d >= kBlock; }
+
+USE_ME_WITH_BLOCK(VMul);
+USE_ME_WITH_BLOCK(VAdd);
+USE_ME_WITH_BLOCK(VAddRelu);
+USE_ME_WITH_BLOCK(VSub);
+USE_ME_WITH_BLOCK(VScal);
+USE_ME_WITH_BLOCK(VAddBias);
+USE_ME_WITH_BLOCK(VRelu);
+USE_ME_WITH_BLOCK(VExp);
+USE_ME_WITH_BLOCK(VSigmoid);
+USE_ME_WITH_BLOCK(VTanh);
+USE_ME_WITH_BLOCK(LayerNorm);
+
+#undef USE_ME_WITH_BLOCK
+
+static inline bool IsSigmoidTanh(const rnn_attr_s& attr) {
+  return attr.act_gate == kVSigmoid && attr.act_cand == kVTanh &&
+         attr.d >= kBlock;
+}
+
+bool LSTMCtHtKernel::UseMe(const lstm_attr_t& attr) const {
+  return IsSigmoidTanh(attr) && attr.act_cell == kVTanh;
+}
+
+bool LSTMC1H1Kernel::UseMe(const lstm_attr_t& attr) const {
+  return IsSigmoidTanh(attr) && attr.act_cell == kVTanh;
+}
+
+bool GRUH1Kernel::UseMe(const gru_attr_t& attr) const {
+  return IsSigmoidTanh(attr);
+}
+
+bool GRUHtPart1Kernel::UseMe(const gru_attr_t& attr) const {
+  return attr.act_gate == kVSigmoid && attr.d >= kBlock;
+}
+
+bool GRUHtPart2Kernel::UseMe(const gru_attr_t& attr) const {
+  return IsSigmoidTanh(attr);
+}
+
+bool SeqPoolKernel::UseMe(const seq_pool_attr_t& attr) const {
+  return attr.w >= kBlock;
+}
+
+}  // namespace neon
+}  // namespace more
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
+
+namespace neon = paddle::operators::jit::more::neon;
+
+#define REGISTER_NEON_KERNEL(key, func) \
+  REGISTER_JITKERNEL_MORE(key, neon, neon::func##Kernel)
+
+REGISTER_NEON_KERNEL(kVMul, VMul);
+REGISTER_NEON_KERNEL(kVAdd, VAdd);
+REGISTER_NEON_KERNEL(kVAddRelu, VAddRelu);
+REGISTER_NEON_KERNEL(kVSub, VSub);
+REGISTER_NEON_KERNEL(kVScal, VScal);
+REGISTER_NEON_KERNEL(kVAddBias, VAddBias);
+REGISTER_NEON_KERNEL(kVRelu, VRelu);
+REGISTER_NEON_KERNEL(kVExp, VExp);
+REGISTER_NEON_KERNEL(kVSigmoid, VSigmoid);
+REGISTER_NEON_KERNEL(kVTanh, VTanh);
+REGISTER_NEON_KERNEL(kLSTMCtHt, LSTMCtHt);
+REGISTER_NEON_KERNEL(kLSTMC1H1, LSTMC1H1);
+REGISTER_NEON_KERNEL(kGRUH1, GRUH1);
+REGISTER_NEON_KERNEL(kGRUHtPart1, GRUHtPart1);
+REGISTER_NEON_KERNEL(kGRUHtPart2, GRUHtPart2);
+REGISTER_NEON_KERNEL(kSeqPool, SeqPool);
+REGISTER_NEON_KERNEL(kLayerNorm, LayerNorm);
+
+#undef REGISTER_NEON_KERNEL
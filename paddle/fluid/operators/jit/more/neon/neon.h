@@ -0,0 +1,94 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#pragma once
+
+#include <type_traits>
+#include "paddle/fluid/operators/jit/kernel_base.h"
+
+namespace paddle {
+namespace operators {
+namespace jit {
+namespace more {
+namespace neon {
+using T = float;
+
+void VMul(const T* x, const T* y, T* z, int n);
+void VAdd(const T* x, const T* y, T* z, int n);
+void VAddRelu(const T* x, const T* y, T* z, int n);
+void VSub(const T* x, const T* y, T* z, int n);
+
+void VScal(const T* a, const T* x, T* y, int n);
+void VAddBias(const T* a, const T* x, T* y, int n);
+
+void VRelu(const T* x, T* y, int n);
+void VExp(const T* x, T* y, int n);
+void VSigmoid(const T* x, T* y, int n);
+void VTanh(const T* x, T* y, int n);
+
+// The cells are fused into a single pass with the sigmoid gates and the tanh
+// candidates and cells, the other activations use the mixed kernels.
+void LSTMCtHt(lstm_t* step, const lstm_attr_t* attr);
+void LSTMC1H1(lstm_t* step, const lstm_attr_t* attr);
+void GRUH1(gru_t* step, const gru_attr_t* attr);
+void GRUHtPart1(gru_t* step, const gru_attr_t* attr);
+void GRUHtPart2(gru_t* step, const gru_attr_t* attr);
+
+void SeqPool(const T* x, T* y, const seq_pool_attr_t* attr);
+
+void LayerNorm(T* x, T* out, T* mean, T* var, const T* scale, const T* bias,
+               int height, const float epsilon, int right);
+
+#define DECLARE_NEON_KERNEL(name, tuples)                            \
+  class name##Kernel : public KernelMore<tuples<T>> {                \
+   public:                                                           \
+    name##Kernel() { this->func = name; }                            \
+    bool UseMe(const typename tuples<T>::attr_type&) const override; \
+    const char* ImplType() const override { return "NEON"; }         \
+  }
+
+// XYZN
+DECLARE_NEON_KERNEL(VMul, XYZNTuples);
+DECLARE_NEON_KERNEL(VAdd, XYZNTuples);
+DECLARE_NEON_KERNEL(VAddRelu, XYZNTuples);
+DECLARE_NEON_KERNEL(VSub, XYZNTuples);
+
+// AXYN
+DECLARE_NEON_KERNEL(VScal, AXYNTuples);
+DECLARE_NEON_KERNEL(VAddBias, AXYNTuples);
+
+// XYN
+DECLARE_NEON_KERNEL(VRelu, XYNTuples);
+DECLARE_NEON_KERNEL(VExp, XYNTuples);
+DECLARE_NEON_KERNEL(VSigmoid, XYNTuples);
+DECLARE_NEON_KERNEL(VTanh, XYNTuples);
+
+DECLARE_NEON_KERNEL(LSTMCtHt, LSTMTuples);
+DECLARE_NEON_KERNEL(LSTMC1H1, LSTMTuples);
+
+DECLARE_NEON_KERNEL(GRUH1, GRUTuples);
+DECLARE_NEON_KERNEL(GRUHtPart1, GRUTuples);
+DECLARE_NEON_KERNEL(GRUHtPart2, GRUTuples);
+
+DECLARE_NEON_KERNEL(SeqPool, SeqPoolTuples);
+
+DECLARE_NEON_KERNEL(LayerNorm, LayerNormTuples);
+
+#undef DECLARE_NEON_KERNEL
+
+}  // namespace neon
+}  // namespace more
+}  // namespace jit
+}  // namespace operators
+}  // namespace paddle
@@ -49,4 +49,9 @@ REGISTER_REFER_KERNEL(kNCHW16CMulNC, NCHW16CMulNC);
 
 REGISTER_REFER_KERNEL(kSeqPool, SeqPool);
 
+REGISTER_REFER_KERNEL(kMatMul, MatMul);
+
+REGISTER_REFER_KERNEL(kSoftmax, Softmax);
+REGISTER_REFER_KERNEL(kSoftmaxCrossEntropy, SoftmaxCrossEntropy);
+
 #undef REGISTER_REFER_KERNEL
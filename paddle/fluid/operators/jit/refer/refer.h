@@ -334,6 +334,18 @@ void NCHW16CMulNC(const T* x, const T* y, T* z, int height, int width) {
 
 template <typename T>
 void SeqPool(const T* x, T* y, const seq_pool_attr_t* attr) {
+  if (attr->type == SeqPoolType::kMax) {
+    for (int w = 0; w < attr->w; ++w) {
+      const T* src = x + w;
+      T* dst = y + w;
+      *dst = *src;
+      for (int h = 1; h < attr->h; ++h) {
+        src += attr->w;
+        *dst = *src > *dst ? *src : *dst;
+      }
+    }
+    return;
+  }
   for (int w = 0; w < attr->w; ++w) {
     const T* src = x + w;
     T* dst = y + w;
@@ -354,6 +366,77 @@ void SeqPool(const T* x, T* y, const seq_pool_attr_t* attr) {
   }
 }
 
+template <typename T>
+void MatMul(const T* a, const T* b, T* c, const matmul_attr_t* attr) {
+  int M = attr->m;
+  int N = attr->n;
+  int K = attr->k;
+  for (int m = 0; m < M; ++m) {
+    const T* pa = a + m * K;
+    T* pc = c + m * N;
+    for (int n = 0; n < N; ++n) {
+      const T* pb = b + n;
+      T sum = static_cast<T>(0);
+      for (int k = 0; k < K; ++k) {
+        sum += (pa[k] * pb[k * N]);
+      }
+      *(pc + n) = sum;
+    }
+  }
+}
+
+// Shift the row by its max value and clip, return the max value.
+template <typename T>
+T SoftmaxShift(const T* x, T* y, int n) {
+  T max = x[0];
+  for (int i = 1; i < n; ++i) {
+    max = x[i] > max ? x[i] : max;
+  }
+  const T min = static_cast<T>(SOFTMAX_SHIFT_MIN);
+  for (int i = 0; i < n; ++i) {
+    y[i] = x[i] - max;
+    y[i] = y[i] < min ? min : y[i];
+  }
+  return max;
+}
+
+template <typename T>
+void Softmax(const T* x, T* y, int n, int bs) {
+  for (int i = 0; i < bs; ++i) {
+    SoftmaxShift<T>(x, y, n);
+    VExp<T>(y, y, n);
+    T sum = static_cast<T>(0);
+    for (int j = 0; j < n; ++j) {
+      sum += y[j];
+    }
+    T scalar = static_cast<T>(1) / sum;
+    VScal<T>(&scalar, y, y, n);
+    x += n;
+    y += n;
+  }
+}
+
+// loss = -log(exp(shifted[label]) / sum) = log(sum) - shifted[label]
+template <typename T>
+void SoftmaxCrossEntropy(const T* x, const int64_t* label, T* y, T* loss,
+                         int n, int bs, int ignore_index) {
+  for (int i = 0; i < bs; ++i) {
+    SoftmaxShift<T>(x, y, n);
+    const bool ignored = label[i] == ignore_index;
+    T shifted = ignored ? static_cast<T>(0) : y[label[i]];
+    VExp<T>(y, y, n);
+    T sum = static_cast<T>(0);
+    for (int j = 0; j < n; ++j) {
+      sum += y[j];
+    }
+    T scalar = static_cast<T>(1) / sum;
+    VScal<T>(&scalar, y, y, n);
+    loss[i] = ignored ? static_cast<T>(0) : std::log(sum) - shifted;
+    x += n;
+    y += n;
+  }
+}
+
 #define DECLARE_REFER_KERNEL(name, tuples)             \
   template <typename T>                                \
   class name##Kernel : public ReferKernel<tuples<T>> { \
@@ -394,6 +477,11 @@ DECLARE_REFER_KERNEL(NCHW16CMulNC, NCHW16CMulNCTuples);
 
 DECLARE_REFER_KERNEL(SeqPool, SeqPoolTuples);
 
+DECLARE_REFER_KERNEL(MatMul, MatMulTuples);
+
+DECLARE_REFER_KERNEL(Softmax, SoftmaxTuples);
+DECLARE_REFER_KERNEL(SoftmaxCrossEntropy, SoftmaxCrossEntropyTuples);
+
 #undef DECLARE_REFER_KERNEL
 
 }  // namespace refer
@@ -229,6 +229,101 @@ struct TestFuncWithRefer<jit::SeqPoolTuples<T>, std::vector<T>,
   }
 };
 
+template <typename T>
+struct TestFuncWithRefer<jit::MatMulTuples<T>, std::vector<T>, std::vector<T>,
+                         std::vector<T>> {
+  void operator()(const typename jit::MatMulTuples<T>::func_type tgt,
+                  const std::vector<T>& a, const std::vector<T>& b,
+                  const std::vector<T>& cref,
+                  const typename jit::MatMulTuples<T>::attr_type& attr) {
+    EXPECT_TRUE(tgt != nullptr);
+    EXPECT_EQ(a.size(), static_cast<size_t>(attr.m * attr.k));
+    EXPECT_EQ(b.size(), static_cast<size_t>(attr.k * attr.n));
+    EXPECT_EQ(cref.size(), static_cast<size_t>(attr.m * attr.n));
+    std::vector<T> c(cref.size());
+    const T* a_data = a.data();
+    const T* b_data = b.data();
+    const T* cref_data = cref.data();
+    T* c_data = c.data();
+    tgt(a_data, b_data, c_data, &attr);
+    ExpectEQ<T>(c_data, cref_data, attr.m * attr.n);
+  }
+};
+
+template <typename T>
+struct TestFuncWithRefer<jit::LayerNormTuples<T>, std::vector<T>,
+                         std::vector<T>, std::vector<T>, std::vector<T>,
+                         std::vector<T>, std::vector<T>, int, float, int> {
+  void operator()(const typename jit::LayerNormTuples<T>::func_type tgt,
+                  const std::vector<T>& x, const std::vector<T>& outref,
+                  const std::vector<T>& meanref, const std::vector<T>& varref,
+                  const std::vector<T>& scale, const std::vector<T>& bias,
+                  int height, float epsilon, int right) {
+    EXPECT_TRUE(tgt != nullptr);
+    EXPECT_EQ(x.size(), static_cast<size_t>(height * right));
+    std::vector<T> xtgt(x), outtgt(x.size()), meantgt(height), vartgt(height);
+    const T* scale_data = scale.empty() ? nullptr : scale.data();
+    const T* bias_data = bias.empty() ? nullptr : bias.data();
+    tgt(xtgt.data(), outtgt.data(), meantgt.data(), vartgt.data(), scale_data,
+        bias_data, height, epsilon, right);
+    ExpectEQ<T>(xtgt.data(), x.data(), height * right);
+    ExpectEQ<T>(outtgt.data(), outref.data(), height * right);
+    ExpectEQ<T>(meantgt.data(), meanref.data(), height);
+    ExpectEQ<T>(vartgt.data(), varref.data(), height);
+  }
+};
+
+template <typename T>
+struct TestFuncWithRefer<jit::SoftmaxTuples<T>, std::vector<T>, std::vector<T>,
+                         int, int> {
+  void operator()(const typename jit::SoftmaxTuples<T>::func_type tgt,
+                  const std::vector<T>& x, const std::vector<T>& yref, int n,
+                  int bs) {
+    EXPECT_TRUE(tgt != nullptr);
+    EXPECT_EQ(yref.size(), x.size());
+    EXPECT_EQ(x.size(), static_cast<size_t>(n * bs));
+    const T* x_data = x.data();
+    const T* yref_data = yref.data();
+    std::vector<T> ytgt(n * bs);
+    T* ytgt_data = ytgt.data();
+    // test normal
+    tgt(x_data, ytgt_data, n, bs);
+    ExpectEQ<T>(ytgt_data, yref_data, n * bs);
+    // test inplace x
+    std::copy(x.begin(), x.end(), ytgt.begin());
+    tgt(ytgt_data, ytgt_data, n, bs);
+    ExpectEQ<T>(ytgt_data, yref_data, n * bs);
+  }
+};
+
+template <typename T>
+struct TestFuncWithRefer<jit::SoftmaxCrossEntropyTuples<T>, std::vector<T>,
+                         std::vector<int64_t>, std::vector<T>, std::vector<T>,
+                         int, int, int> {
+  void operator()(
+      const typename jit::SoftmaxCrossEntropyTuples<T>::func_type tgt,
+      const std::vector<T>& x, const std::vector<int64_t>& label,
+      const std::vector<T>& yref, const std::vector<T>& lossref, int n, int bs,
+      int ignore_index) {
+    EXPECT_TRUE(tgt != nullptr);
+    EXPECT_EQ(x.size(), static_cast<size_t>(n * bs));
+    EXPECT_EQ(label.size(), static_cast<size_t>(bs));
+    std::vector<T> ytgt(n * bs), losstgt(bs);
+    const T* x_data = x.data();
+    T* ytgt_data = ytgt.data();
+    T* losstgt_data = losstgt.data();
+    // test normal
+    tgt(x_data, label.data(), ytgt_data, losstgt_data, n, bs, ignore_index);
+    ExpectEQ<T>(ytgt_data, yref.data(), n * bs);
+    ExpectEQ<T>(losstgt_data, lossref.data(), bs);
+    // test inplace x
+    std::copy(x.begin(), x.end(), ytgt.begin());
+    tgt(ytgt_data, label.data(), ytgt_data, losstgt_data, n, bs, ignore_index);
+    ExpectEQ<T>(ytgt_data, yref.data(), n * bs);
+    ExpectEQ<T>(losstgt_data, lossref.data(), bs);
+  }
+};
+
 template <paddle::operators::jit::KernelType KT, typename KernelTuples,
           typename PlaceType, typename... Args>
 void TestAllImpls(const typename KernelTuples::attr_type& attr, Args... args) {
@@ -239,8 +334,24 @@ void TestAllImpls(const typename KernelTuples::attr_type& attr, Args... args) {
     VLOG(10) << "Test Jitcode Kernel ";
     test(jitcode, args...);
   }
-  // test all impls in more
+  // test all jitcode creators can be used, since only the first one is used
+  // by GetJitCode, e.g., both AVX512 and AVX code on an avx512f machine
   jit::KernelKey kkey(KT, PlaceType());
+  auto& creator_map = jit::JitCodeCreatorPool().Instance().AllCreators();
+  auto creator_iter = creator_map.find(kkey);
+  if (creator_iter != creator_map.end()) {
+    using Attr = typename KernelTuples::attr_type;
+    using Func = typename KernelTuples::func_type;
+    for (auto& cur : creator_iter->second) {
+      auto i = dynamic_cast<const jit::JitCodeCreator<Attr>*>(cur.get());
+      if (i && i->UseMe(attr)) {
+        auto code = i->CreateJitCode(attr);
+        VLOG(10) << "Test Jitcode Kernel : " << code->name();
+        test(code->template getCode<Func>(), args...);
+      }
+    }
+  }
+  // test all impls in more
   auto& pool = jit::KernelPool().Instance().AllKernels();
   auto iter = pool.find(kkey);
   if (iter != pool.end()) {
@@ -437,7 +548,8 @@ template <paddle::operators::jit::KernelType KT, typename T, typename PlaceType>
 void TestSeqPoolKernel() {
   VLOG(10) << "===== Test JITKernel " << jit::to_string(KT);
   std::vector<jit::SeqPoolType> pool_types = {
-      jit::SeqPoolType::kSum, jit::SeqPoolType::kAvg, jit::SeqPoolType::kSqrt};
+      jit::SeqPoolType::kSum, jit::SeqPoolType::kAvg, jit::SeqPoolType::kSqrt,
+      jit::SeqPoolType::kMax};
   for (auto type : pool_types) {
     for (int w : TestSizes()) {
       jit::seq_pool_attr_t attr(w, type);
@@ -458,6 +570,122 @@ void TestSeqPoolKernel() {
   }
 }
 
+template <paddle::operators::jit::KernelType KT, typename T, typename PlaceType>
+void TestLayerNormKernel() {
+  VLOG(10) << "===== Test JITKernel " << jit::to_string(KT);
+  const float epsilon = 1e-5f;
+  for (int right : TestSizes()) {
+    for (int height : {1, 2, 5}) {
+      for (bool affine : {false, true}) {
+        auto ref = jit::GetRefer<KT, jit::LayerNormTuples<T>>();
+        EXPECT_TRUE(ref != nullptr);
+        std::vector<T> x(height * right), outref(height * right);
+        std::vector<T> meanref(height), varref(height), scale, bias;
+        RandomVec<T>(height * right, x.data(), -2.f, 2.f);
+        if (affine) {
+          scale.resize(right);
+          bias.resize(right);
+          RandomVec<T>(right, scale.data(), -2.f, 2.f);
+          RandomVec<T>(right, bias.data(), -2.f, 2.f);
+        }
+        std::vector<T> xref(x);
+        ref(xref.data(), outref.data(), meanref.data(), varref.data(),
+            affine ? scale.data() : nullptr, affine ? bias.data() : nullptr,
+            height, epsilon, right);
+        TestAllImpls<KT, jit::LayerNormTuples<T>, PlaceType, std::vector<T>,
+                     std::vector<T>, std::vector<T>, std::vector<T>,
+                     std::vector<T>, std::vector<T>, int, float, int>(
+            right, x, outref, meanref, varref, scale, bias, height, epsilon,
+            right);
+      }
+    }
+  }
+}
+
+template <paddle::operators::jit::KernelType KT, typename T, typename PlaceType>
+void TestMatMulKernel() {
+  VLOG(10) << "===== Test JITKernel " << jit::to_string(KT);
+  for (int m : {1, 2, 3, 5, 8, 16, 17}) {
+    for (int n : {1, 7, 8, 16, 24, 64, 100, 128}) {
+      for (int k : {1, 3, 8, 64, 100}) {
+        auto ref = jit::GetRefer<KT, jit::MatMulTuples<T>>();
+        EXPECT_TRUE(ref != nullptr);
+        std::vector<T> a(m * k), b(k * n), c(m * n);
+        RandomVec<T>(m * k, a.data(), -0.2f, 0.2f);
+        RandomVec<T>(k * n, b.data(), -0.2f, 0.2f);
+        const T* a_data = a.data();
+        const T* b_data = b.data();
+        T* c_data = c.data();
+        const jit::matmul_attr_t attr{m, n, k};
+        ref(a_data, b_data, c_data, &attr);
+        TestAllImpls<KT, jit::MatMulTuples<T>, PlaceType, std::vector<T>,
+                     std::vector<T>, std::vector<T>>(attr, a, b, c, attr);
+      }
+    }
+  }
+}
+
+template <paddle::operators::jit::KernelType KT, typename T, typename PlaceType>
+void TestSoftmaxKernel() {
+  VLOG(10) << "===== Test JITKernel " << jit::to_string(KT);
+  for (int bs : {1, 2, 10}) {
+    for (int n : TestSizes()) {
+      auto ref = jit::GetRefer<KT, jit::SoftmaxTuples<T>>();
+      EXPECT_TRUE(ref != nullptr);
+      std::vector<T> x(bs * n), y(bs * n);
+      RandomVec<T>(bs * n, x.data(), -2.f, 2.f);
+      const T* x_data = x.data();
+      T* y_data = y.data();
+
+      std::vector<T> xinp(x.size());  // inplace test
+      std::copy(x.begin(), x.end(), xinp.begin());
+      ref(x_data, y_data, n, bs);
+      T* xinp_data = xinp.data();
+      ref(xinp_data, xinp_data, n, bs);
+      ExpectEQ<T>(xinp_data, y_data, n * bs);
+
+      TestAllImpls<KT, jit::SoftmaxTuples<T>, PlaceType, std::vector<T>,
+                   std::vector<T>, int, int>(n, x, y, n, bs);
+    }
+  }
+}
+
+template <paddle::operators::jit::KernelType KT, typename T, typename PlaceType>
+void TestSoftmaxCrossEntropyKernel() {
+  VLOG(10) << "===== Test JITKernel " << jit::to_string(KT);
+  const int ignore_index = -100;
+  for (int bs : {1, 2, 10}) {
+    for (int n : TestSizes()) {
+      auto ref = jit::GetRefer<KT, jit::SoftmaxCrossEntropyTuples<T>>();
+      EXPECT_TRUE(ref != nullptr);
+      std::vector<T> x(bs * n), y(bs * n), loss(bs);
+      std::vector<int64_t> label(bs);
+      RandomVec<T>(bs * n, x.data(), -2.f, 2.f);
+      for (int i = 0; i < bs; ++i) {
+        label[i] = (i * 7) % n;
+      }
+      if (bs > 1) {
+        label[bs - 1] = ignore_index;
+      }
+      ref(x.data(), label.data(), y.data(), loss.data(), n, bs, ignore_index);
+      if (bs > 1) {
+        EXPECT_EQ(loss[bs - 1], static_cast<T>(0));
+      }
+
+      // the softmax part should be the same with kSoftmax
+      auto softmax = jit::GetRefer<jit::kSoftmax, jit::SoftmaxTuples<T>>();
+      std::vector<T> ysoftmax(bs * n);
+      softmax(x.data(), ysoftmax.data(), n, bs);
+      ExpectEQ<T>(y.data(), ysoftmax.data(), n * bs);
+
+      TestAllImpls<KT, jit::SoftmaxCrossEntropyTuples<T>, PlaceType,
+                   std::vector<T>, std::vector<int64_t>, std::vector<T>,
+                   std::vector<T>, int, int, int>(n, x, label, y, loss, n, bs,
+                                                  ignore_index);
+    }
+  }
+}
+
 template <paddle::operators::jit::KernelType KT, typename T, typename PlaceType>
 void TestNCHW16CMulNCKernel() {
   VLOG(10) << "===== Test JITKernel " << jit::to_string(KT);
@@ -618,6 +846,26 @@ TEST(JITKernel, kSeqPool) {
   TestSeqPoolKernel<jit::kSeqPool, double, paddle::platform::CPUPlace>();
 }
 
+TEST(JITKernel, kMatMul) {
+  namespace jit = paddle::operators::jit;
+  TestMatMulKernel<jit::kMatMul, float, paddle::platform::CPUPlace>();
+  TestMatMulKernel<jit::kMatMul, double, paddle::platform::CPUPlace>();
+}
+
+TEST(JITKernel, kSoftmax) {
+  namespace jit = paddle::operators::jit;
+  TestSoftmaxKernel<jit::kSoftmax, float, paddle::platform::CPUPlace>();
+  TestSoftmaxKernel<jit::kSoftmax, double, paddle::platform::CPUPlace>();
+}
+
+TEST(JITKernel, kSoftmaxCrossEntropy) {
+  namespace jit = paddle::operators::jit;
+  TestSoftmaxCrossEntropyKernel<jit::kSoftmaxCrossEntropy, float,
+                                paddle::platform::CPUPlace>();
+  TestSoftmaxCrossEntropyKernel<jit::kSoftmaxCrossEntropy, double,
+                                paddle::platform::CPUPlace>();
+}
+
 TEST(JITKernel, kNCHW16CMulNC) {
   namespace jit = paddle::operators::jit;
   TestNCHW16CMulNCKernel<jit::kNCHW16CMulNC, float,
@@ -626,7 +874,13 @@ TEST(JITKernel, kNCHW16CMulNC) {
                          paddle::platform::CPUPlace>();
 }
 
-// TODO(yihua/TJ): add crf decoding and layer norm unit tests
+TEST(JITKernel, kLayerNorm) {
+  namespace jit = paddle::operators::jit;
+  TestLayerNormKernel<jit::kLayerNorm, float, paddle::platform::CPUPlace>();
+  TestLayerNormKernel<jit::kLayerNorm, double, paddle::platform::CPUPlace>();
+}
+
+// TODO(yihua/TJ): add crf decoding unit tests
 
 TEST(JITKernel, pool) {
   // TODO(TJ): add some test
@@ -12,418 +12,150 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
-#include <cub/cub.cuh>
+#include <algorithm>
 #include "paddle/fluid/operators/layer_norm_op.h"
+#include "paddle/fluid/operators/norm_utils.cu.h"
 
 namespace paddle {
 namespace operators {
 
-inline static int GetDesiredBlockDim(int block_dim) {
-  const int kMaxBlockDim = 512;
-  return block_dim >= kMaxBlockDim
-             ? kMaxBlockDim
-             : (1 << (static_cast<int>(std::log2f(block_dim))));
-}
-
-#define FIXED_BLOCK_DIM_CASE_BASE(log2_block_dim, ...)  \
-  case (1 << (log2_block_dim)): {                       \
-    constexpr auto kBlockDim = (1 << (log2_block_dim)); \
-    __VA_ARGS__;                                        \
-  } break
-
-#define FIXED_BLOCK_DIM_CASE(...)              \
-  FIXED_BLOCK_DIM_CASE_BASE(9, ##__VA_ARGS__); \
-  FIXED_BLOCK_DIM_CASE_BASE(8, ##__VA_ARGS__); \
-  FIXED_BLOCK_DIM_CASE_BASE(7, ##__VA_ARGS__); \
-  FIXED_BLOCK_DIM_CASE_BASE(6, ##__VA_ARGS__); \
-  FIXED_BLOCK_DIM_CASE_BASE(5, ##__VA_ARGS__); \
-  FIXED_BLOCK_DIM_CASE_BASE(4, ##__VA_ARGS__); \
-  FIXED_BLOCK_DIM_CASE_BASE(3, ##__VA_ARGS__); \
-  FIXED_BLOCK_DIM_CASE_BASE(2, ##__VA_ARGS__); \
-  FIXED_BLOCK_DIM_CASE_BASE(1, ##__VA_ARGS__)
-
-static __device__ __forceinline__ float real_sqrt(float x) { return sqrtf(x); }
-static __device__ __forceinline__ double real_sqrt(double x) { return sqrt(x); }
-
-template <typename T>
-struct PairForLayerNorm {
-  __device__ __forceinline__ PairForLayerNorm() {}
-  __device__ __forceinline__ PairForLayerNorm(const T &first, const T &second)
-      : first_(first), second_(second) {}
-
-  T first_;
-  T second_;
-};
+// The partial sums of d_scale and d_bias of a block are kept in the shared
+// memory if they fit in this size.
+constexpr size_t kLayerNormMaxSharedBytes = 32 * 1024;
 
+// A block normalizes a row: the mean and the variance are reduced by
+// Welford's algorithm in one pass, and y = x * a + b is written with the a
+// and b of the column, which fuse the normalization, the scale and the bias.
 template <typename T>
-struct PairForLayerNormAddFunctor {
-  __device__ __forceinline__ PairForLayerNorm<T> operator()(
-      const PairForLayerNorm<T> &p1, const PairForLayerNorm<T> &p2) {
-    return PairForLayerNorm<T>(p1.first_ + p2.first_, p1.second_ + p2.second_);
-  }
-};
-
-template <typename T, int BlockDim>
 __global__ void LayerNormForward(const T *x, const T *scale, const T *bias,
                                  T *y, T *mean, T *var, float epsilon,
                                  int feature_size) {
-  using BlockReduce = cub::BlockReduce<PairForLayerNorm<double>, BlockDim>;
-  __shared__ typename BlockReduce::TempStorage temp_storage;
-
-  int beg_idx = blockIdx.x * feature_size + threadIdx.x;
-  int end_idx = (blockIdx.x + 1) * feature_size;
-
-  // Step 1: Reduce to calculate mean and var
-  double mean_val = 0;
-  double var_val = 0;
-  for (int i = beg_idx; i < end_idx; i += BlockDim) {
-    T tmp = x[i];
-    mean_val += tmp;
-    var_val += (tmp * tmp);
-  }
-  auto pair = BlockReduce(temp_storage)
-                  .Reduce(PairForLayerNorm<double>(mean_val, var_val),
-                          PairForLayerNormAddFunctor<double>());
+  int offset = blockIdx.x * feature_size;
+  WelfordData<T> data = {0, 0, 0};
+  for (int i = threadIdx.x; i < feature_size; i += blockDim.x) {
+    WelfordUpdate(x[offset + i], &data);
+  }
+  data = WelfordBlockReduce(data);
+  T x_mean = data.mean;
+  T x_var = data.m2 / feature_size;
   if (threadIdx.x == 0) {
-    auto tmp = pair.first_ / feature_size;
-    mean[blockIdx.x] = static_cast<T>(tmp);
-    var[blockIdx.x] = static_cast<T>(pair.second_ / feature_size - tmp * tmp);
+    mean[blockIdx.x] = x_mean;
+    var[blockIdx.x] = x_var;
   }
-  __syncthreads();
-  mean_val = mean[blockIdx.x];
-  var_val = static_cast<T>(real_sqrt(var[blockIdx.x] + epsilon));
-
-  // Step 2: Calculate y
-  if (scale != nullptr) {
-    if (bias != nullptr) {
-      for (int i = beg_idx, j = threadIdx.x; i < end_idx;
-           i += BlockDim, j += BlockDim) {
-        y[i] = scale[j] * (x[i] - mean_val) / var_val + bias[j];
-      }
-    } else {
-      for (int i = beg_idx, j = threadIdx.x; i < end_idx;
-           i += BlockDim, j += BlockDim) {
-        y[i] = scale[j] * (x[i] - mean_val) / var_val;
-      }
-    }
-  } else {  // scale == nullptr
-    if (bias != nullptr) {
-      for (int i = beg_idx, j = threadIdx.x; i < end_idx;
-           i += BlockDim, j += BlockDim) {
-        y[i] = (x[i] - mean_val) / var_val + bias[j];
-      }
-    } else {
-      for (int i = beg_idx, j = threadIdx.x; i < end_idx;
-           i += BlockDim, j += BlockDim) {
-        y[i] = (x[i] - mean_val) / var_val;
-      }
-    }
+  T var_inv = NormRsqrt(x_var + static_cast<T>(epsilon));
+  for (int i = threadIdx.x; i < feature_size; i += blockDim.x) {
+    T a = scale ? scale[i] * var_inv : var_inv;
+    T b = (bias ? bias[i] : static_cast<T>(0)) - x_mean * a;
+    y[offset + i] = x[offset + i] * a + b;
   }
 }
 
-// Make sure that d_scale != nullptr && d_bias != nullptr
-// Since d_scale != nullptr, scale would not be nullptr
-template <typename T, int BlockDim, bool HasDx>
-__global__ void LayerNormBackwardGradientAll(const T *x, const T *d_y,
-                                             T *d_scale, T *d_bias, T *d_x,
-                                             const T *mean, const T *var,
-                                             const T *scale, float epsilon,
-                                             int batch_size, int feature_size) {
-  using BlockReduce = cub::BlockReduce<PairForLayerNorm<T>, BlockDim>;
-  __shared__ typename BlockReduce::TempStorage temp_storage;
-
-  int beg_idx = threadIdx.x * feature_size + blockIdx.x;
-  int end_idx = batch_size * feature_size + blockIdx.x;
-  int stride = BlockDim * feature_size;
-
-  T d_scale_partial = 0, d_bias_partial = 0;
-
-  for (int i = beg_idx; i < end_idx; i += stride) {
-    int row_idx = i / feature_size;
-    auto var_val = static_cast<T>(real_sqrt(var[row_idx] + epsilon));
-    d_scale_partial += d_y[i] * (x[i] - mean[row_idx]) / var_val;
-    d_bias_partial += d_y[i];
-    if (HasDx) {
-      d_x[i] = d_y[i] * scale[blockIdx.x] / var_val;
+// A block takes the rows blockIdx.x, blockIdx.x + gridDim.x, ..., for
+//   d_x = var_inv * (d_y * scale - mean(d_y * scale)
+//                    - x_hat * mean(d_y * scale * x_hat))
+// of a row, and, at the same time, for the sums of d_y * x_hat and d_y of
+// the columns of its rows, which are the first level of d_scale and d_bias,
+// in the row blockIdx.x of partial_scale and partial_bias [gridDim.x,
+// feature_size]. A thread owns the columns threadIdx.x + k * blockDim.x of
+// them, so that no atomics are needed, and keeps them in the shared memory
+// if use_shared.
+template <typename T>
+__global__ void LayerNormBackward(const T *x, const T *d_y, const T *mean,
+                                  const T *var, const T *scale, float epsilon,
+                                  int batch_size, int feature_size,
+                                  bool use_shared, T *d_x, T *partial_scale,
+                                  T *partial_bias) {
+  extern __shared__ __align__(sizeof(double)) unsigned char shared_sums[];
+  T *sum_scale = partial_scale;
+  T *sum_bias = partial_bias;
+  if (use_shared) {
+    if (sum_scale) sum_scale = reinterpret_cast<T *>(shared_sums);
+    if (sum_bias) {
+      sum_bias = reinterpret_cast<T *>(shared_sums) + feature_size;
     }
-  }
-
-  auto pair = BlockReduce(temp_storage)
-                  .Reduce(PairForLayerNorm<T>(d_scale_partial, d_bias_partial),
-                          PairForLayerNormAddFunctor<T>());
-
-  if (threadIdx.x == 0) {
-    d_scale[blockIdx.x] = pair.first_;
-    d_bias[blockIdx.x] = pair.second_;
-  }
-}
-
-// Make sure that there is only one true expression: d_scale != nullptr
-// or d_bias != nullptr
-// Notice: scale may be nullptr
-template <typename T, int BlockDim, bool HasDx, bool HasDScale>
-__global__ void LayerNormBackwardGradientScaleOrBias(
-    const T *x, const T *d_y, T *d_scale, T *d_bias, T *d_x, const T *mean,
-    const T *var, const T *scale, float epsilon, int batch_size,
-    int feature_size) {
-  using BlockReduce = cub::BlockReduce<T, BlockDim>;
-  __shared__ typename BlockReduce::TempStorage temp_storage;
-  int beg_idx = threadIdx.x * feature_size + blockIdx.x;
-  int end_idx = batch_size * feature_size + blockIdx.x;
-  int stride = BlockDim * feature_size;
-  T d_scale_or_d_bias_partial = 0;
-
-  for (int i = beg_idx; i < end_idx; i += stride) {
-    int row_idx = i / feature_size;
-    auto var_val = static_cast<T>(real_sqrt(var[row_idx] + epsilon));
-    if (HasDScale) {
-      d_scale_or_d_bias_partial += d_y[i] * (x[i] - mean[row_idx]) / var_val;
-    } else {  // d_bias != nullptr
-      d_scale_or_d_bias_partial += d_y[i];
+  } else {
+    if (sum_scale) sum_scale += blockIdx.x * feature_size;
+    if (sum_bias) sum_bias += blockIdx.x * feature_size;
+  }
+  for (int j = threadIdx.x; j < feature_size; j += blockDim.x) {
+    if (sum_scale) sum_scale[j] = 0;
+    if (sum_bias) sum_bias[j] = 0;
+  }
+
+  for (int row = blockIdx.x; row < batch_size; row += gridDim.x) {
+    int offset = row * feature_size;
+    T x_mean = mean[row];
+    T var_inv = NormRsqrt(var[row] + static_cast<T>(epsilon));
+    T d_mean = 0, d_mean_x_hat = 0;
+    for (int j = threadIdx.x; j < feature_size; j += blockDim.x) {
+      T dy = d_y[offset + j];
+      T x_hat = (x[offset + j] - x_mean) * var_inv;
+      if (sum_scale) sum_scale[j] += dy * x_hat;
+      if (sum_bias) sum_bias[j] += dy;
+      if (scale) dy *= scale[j];
+      d_mean += dy;
+      d_mean_x_hat += dy * x_hat;
     }
-
-    if (HasDx) {
-      if (scale != nullptr) {
-        d_x[i] = d_y[i] * scale[blockIdx.x] / var_val;
-      } else {
-        d_x[i] = d_y[i] / var_val;
-      }
+    if (d_x == nullptr) continue;
+
+    NormBlockSum2(&d_mean, &d_mean_x_hat);
+    d_mean /= feature_size;
+    d_mean_x_hat /= feature_size;
+    for (int j = threadIdx.x; j < feature_size; j += blockDim.x) {
+      T dy = scale ? d_y[offset + j] * scale[j] : d_y[offset + j];
+      T x_hat = (x[offset + j] - x_mean) * var_inv;
+      d_x[offset + j] = var_inv * (dy - d_mean - x_hat * d_mean_x_hat);
     }
   }
 
-  d_scale_or_d_bias_partial =
-      BlockReduce(temp_storage).Reduce(d_scale_or_d_bias_partial, cub::Sum());
-
-  if (threadIdx.x == 0) {
-    if (HasDScale) {
-      d_scale[blockIdx.x] = d_scale_or_d_bias_partial;
-    } else {
-      d_bias[blockIdx.x] = d_scale_or_d_bias_partial;
+  if (use_shared) {
+    T *out_scale = partial_scale + blockIdx.x * feature_size;
+    T *out_bias = partial_bias + blockIdx.x * feature_size;
+    for (int j = threadIdx.x; j < feature_size; j += blockDim.x) {
+      if (sum_scale) out_scale[j] = sum_scale[j];
+      if (sum_bias) out_bias[j] = sum_bias[j];
     }
   }
 }
 
-template <typename T, int BlockDim>
-__global__ void LayerNormBackwardPostProcessToCalculateDX(const T *x, T *d_x,
-                                                          const T *mean,
-                                                          const T *var,
-                                                          float epsilon,
-                                                          int feature_size) {
-  using BlockReduce = cub::BlockReduce<PairForLayerNorm<T>, BlockDim>;
-  __shared__ typename BlockReduce::TempStorage temp_storage;
-  __shared__ T d_x_reduce_tmp[2];
-
-  int beg_idx = blockIdx.x * feature_size + threadIdx.x;
-  int end_idx = (blockIdx.x + 1) * feature_size;
-
-  T block_mean = mean[blockIdx.x];
-  T block_var = var[blockIdx.x];
-  T d_x_mean_partial = 0, d_x_var_partial = 0;
-  for (int i = beg_idx; i < end_idx; i += BlockDim) {
-    d_x_mean_partial += d_x[i];
-    d_x_var_partial += d_x[i] * (x[i] - block_mean);
-  }
-
-  auto pair =
-      BlockReduce(temp_storage)
-          .Reduce(PairForLayerNorm<T>(d_x_mean_partial, d_x_var_partial),
-                  PairForLayerNormAddFunctor<T>());
-
-  if (threadIdx.x == 0) {
-    d_x_reduce_tmp[0] = pair.first_ / feature_size;
-    d_x_reduce_tmp[1] = pair.second_ / (feature_size * (block_var + epsilon));
-  }
-  __syncthreads();
-
-  d_x_mean_partial = d_x_reduce_tmp[0];
-  d_x_var_partial = d_x_reduce_tmp[1];
-  for (int i = beg_idx; i < end_idx; i += BlockDim) {
-    d_x[i] -= d_x_mean_partial;
-    d_x[i] -= (x[i] - block_mean) * d_x_var_partial;
-  }
-}
-
-// Here, we only calculate d_x
-template <typename T, int BlockDim>
-__global__ void LayerNormBackwardGradientOnlyDX(const T *x, const T *d_y,
-                                                T *d_x, const T *mean,
-                                                const T *var, const T *scale,
-                                                float epsilon,
-                                                int feature_size) {
-  using BlockReduce = cub::BlockReduce<PairForLayerNorm<T>, BlockDim>;
-  __shared__ typename BlockReduce::TempStorage temp_storage;
-  __shared__ T d_x_reduce_tmp[2];
-
-  int beg_idx = blockIdx.x * feature_size + threadIdx.x;
-  int end_idx = (blockIdx.x + 1) * feature_size;
-
-  T block_mean = mean[blockIdx.x], block_var = var[blockIdx.x];
-  T d_x_mean_partial = 0, d_x_var_partial = 0;
-  for (int i = beg_idx; i < end_idx; i += BlockDim) {
-    auto var_val = static_cast<T>(real_sqrt(block_var + epsilon));
-    if (scale != nullptr) {
-      int col_idx = i % feature_size;
-      d_x[i] = d_y[i] * scale[col_idx] / var_val;
-    } else {
-      d_x[i] = d_y[i] / var_val;
-    }
-    d_x_mean_partial += d_x[i];
-    d_x_var_partial += d_x[i] * (x[i] - block_mean);
-  }
-
-  auto pair =
-      BlockReduce(temp_storage)
-          .Reduce(PairForLayerNorm<T>(d_x_mean_partial, d_x_var_partial),
-                  PairForLayerNormAddFunctor<T>());
-
-  if (threadIdx.x == 0) {
-    d_x_reduce_tmp[0] = pair.first_ / feature_size;
-    d_x_reduce_tmp[1] = pair.second_ / (feature_size * (block_var + epsilon));
-  }
-  __syncthreads();
-
-  d_x_mean_partial = d_x_reduce_tmp[0];
-  d_x_var_partial = d_x_reduce_tmp[1];
-  for (int i = beg_idx; i < end_idx; i += BlockDim) {
-    d_x[i] -= d_x_mean_partial;
-    d_x[i] -= (x[i] - block_mean) * d_x_var_partial;
-  }
-}
-
 template <typename T>
-__global__ void LayerNormBackwardWhenBatchSizeIsOne(
-    const T *x, const T *d_y, T *d_x, T *d_scale, T *d_bias, const T *mean,
-    const T *var, const T *scale, float epsilon, int feature_size) {
-  int idx = threadIdx.x + blockIdx.x * blockDim.x;
-  if (idx < feature_size) {
-    auto var_val = static_cast<T>(real_sqrt(var[idx] + epsilon));
-    if (d_x != nullptr) {
-      if (d_scale == nullptr) {
-        d_x[idx] = d_y[idx] / var_val;
-      } else {
-        d_x[idx] = d_y[idx] * scale[idx] / var_val;
-      }
-    }
-
-    if (d_scale != nullptr) {
-      d_scale[idx] = d_y[idx] * (x[idx] - mean[idx]) / var_val;
-    }
-
-    if (d_bias != nullptr) d_bias[idx] = d_y[idx];
-  }
-}
-
-template <typename T>
-static void LayerNormBackward(const T *x, const T *d_y, const T *scale,
+static void LayerNormBackward(const platform::CUDADeviceContext &dev_ctx,
+                              const T *x, const T *d_y, const T *scale,
                               const T *mean, const T *var, T *d_x, T *d_scale,
                               T *d_bias, float epsilon, int batch_size,
-                              int feature_size, cudaStream_t stream) {
-  const int kMaxBlockDim = 512;
-  int gradient_flag = ((d_x != nullptr ? 1 : 0) << 2) |
-                      ((d_scale != nullptr ? 1 : 0) << 1) |
-                      ((d_bias != nullptr ? 1 : 0));
-  if (gradient_flag == 0) return;
-
-  if (batch_size == 1) {
-    LayerNormBackwardWhenBatchSizeIsOne<
-        T><<<(feature_size + kMaxBlockDim - 1) / kMaxBlockDim, kMaxBlockDim, 0,
-             stream>>>(x, d_y, d_x, d_scale, d_bias, mean, var, scale, epsilon,
-                       feature_size);
-
-    if (d_x != nullptr) {
-      switch (GetDesiredBlockDim(feature_size)) {
-        FIXED_BLOCK_DIM_CASE(LayerNormBackwardPostProcessToCalculateDX<
-                             T, kBlockDim><<<1, kBlockDim, 0, stream>>>(
-            x, d_x, mean, var, epsilon, feature_size));
-      }
-    }
-    return;
-  }
-
-  auto block_dim = GetDesiredBlockDim(batch_size);
-  switch (gradient_flag) {
-    case 1:  // d_x == nulptr, d_scale == nullptr, d_bias != nullptr
-      switch (block_dim) {
-        FIXED_BLOCK_DIM_CASE(LayerNormBackwardGradientScaleOrBias<
-                             T, kBlockDim, false,
-                             false><<<feature_size, kBlockDim, 0, stream>>>(
-            x, d_y, d_scale, d_bias, d_x, mean, var, scale, epsilon, batch_size,
-            feature_size));
-      }
-      break;
-    case 2:  // d_x == nullptr, d_scale != nullptr, d_bias == nullptr
-      switch (block_dim) {
-        FIXED_BLOCK_DIM_CASE(LayerNormBackwardGradientScaleOrBias<
-                             T, kBlockDim, false,
-                             true><<<feature_size, kBlockDim, 0, stream>>>(
-            x, d_y, d_scale, d_bias, d_x, mean, var, scale, epsilon, batch_size,
-            feature_size));
-      }
-      break;
-    case 3:  // d_x == nullptr, d_scale != nulptr, d_bias != nullptr
-      switch (block_dim) {
-        FIXED_BLOCK_DIM_CASE(
-            LayerNormBackwardGradientAll<
-                T, kBlockDim, false><<<feature_size, kBlockDim, 0, stream>>>(
-                x, d_y, d_scale, d_bias, d_x, mean, var, scale, epsilon,
-                batch_size, feature_size));
-      }
-      break;
-    case 4:  // d_x != nullptr, d_scale == nullptr, d_bias == nullptr
-      switch (GetDesiredBlockDim(feature_size)) {
-        FIXED_BLOCK_DIM_CASE(
-            LayerNormBackwardGradientOnlyDX<
-                T, kBlockDim><<<batch_size, kBlockDim, 0, stream>>>(
-                x, d_y, d_x, mean, var, scale, epsilon, feature_size));
-      }
-      break;
-    case 5:  // d_x != nulptr, d_scale == nullptr, d_bias != nullptr
-      switch (block_dim) {
-        FIXED_BLOCK_DIM_CASE(LayerNormBackwardGradientScaleOrBias<
-                             T, kBlockDim, true,
-                             false><<<feature_size, kBlockDim, 0, stream>>>(
-            x, d_y, d_scale, d_bias, d_x, mean, var, scale, epsilon, batch_size,
-            feature_size));
-      }
-      switch (GetDesiredBlockDim(feature_size)) {
-        FIXED_BLOCK_DIM_CASE(
-            LayerNormBackwardPostProcessToCalculateDX<
-                T, kBlockDim><<<batch_size, kBlockDim, 0, stream>>>(
-                x, d_x, mean, var, epsilon, feature_size));
-      }
-      break;
-    case 6:  // d_x != nullptr, d_scale != nullptr, d_bias == nullptr
-      switch (block_dim) {
-        FIXED_BLOCK_DIM_CASE(LayerNormBackwardGradientScaleOrBias<
-                             T, kBlockDim, true,
-                             true><<<feature_size, kBlockDim, 0, stream>>>(
-            x, d_y, d_scale, d_bias, d_x, mean, var, scale, epsilon, batch_size,
-            feature_size));
-      }
-      switch (GetDesiredBlockDim(feature_size)) {
-        FIXED_BLOCK_DIM_CASE(
-            LayerNormBackwardPostProcessToCalculateDX<
-                T, kBlockDim><<<batch_size, kBlockDim, 0, stream>>>(
-                x, d_x, mean, var, epsilon, feature_size));
-      }
-      break;
-    case 7:  // d_x != nullptr, d_scale != nullptr, d_bias != nullptr
-      switch (block_dim) {
-        FIXED_BLOCK_DIM_CASE(
-            LayerNormBackwardGradientAll<
-                T, kBlockDim, true><<<feature_size, kBlockDim, 0, stream>>>(
-                x, d_y, d_scale, d_bias, d_x, mean, var, scale, epsilon,
-                batch_size, feature_size));
-      }
-      switch (GetDesiredBlockDim(feature_size)) {
-        FIXED_BLOCK_DIM_CASE(
-            LayerNormBackwardPostProcessToCalculateDX<
-                T, kBlockDim><<<batch_size, kBlockDim, 0, stream>>>(
-                x, d_x, mean, var, epsilon, feature_size));
-      }
-      break;
-    default:
-      break;
+                              int feature_size) {
+  if (d_x == nullptr && d_scale == nullptr && d_bias == nullptr) return;
+  int block_dim = NormBlockDim(feature_size);
+  int grid_dim = std::min(
+      batch_size,
+      std::max(dev_ctx.GetMaxPhysicalThreadCount() / block_dim, 1));
+
+  // The first level of d_scale and d_bias is written to them directly if
+  // there is a block only.
+  Tensor partial;
+  T *partial_scale = d_scale;
+  T *partial_bias = d_bias;
+  if ((d_scale || d_bias) && grid_dim > 1) {
+    T *partial_data = partial.mutable_data<T>({2, grid_dim, feature_size},
+                                              dev_ctx.GetPlace());
+    if (d_scale) partial_scale = partial_data;
+    if (d_bias) partial_bias = partial_data + grid_dim * feature_size;
+  }
+  size_t shared_bytes = 0;
+  if (d_scale) shared_bytes += feature_size * sizeof(T);
+  if (d_bias) shared_bytes += feature_size * sizeof(T);
+  bool use_shared = shared_bytes <= kLayerNormMaxSharedBytes;
+  LayerNormBackward<T><<<grid_dim, block_dim, use_shared ? shared_bytes : 0,
+                         dev_ctx.stream()>>>(
+      x, d_y, mean, var, scale, epsilon, batch_size, feature_size, use_shared,
+      d_x, partial_scale, partial_bias);
+
+  if ((d_scale || d_bias) && grid_dim > 1) {
+    int threads = NormBlockDim(feature_size);
+    NormColumnSum<T><<<(feature_size + threads - 1) / threads, threads, 0,
+                       dev_ctx.stream()>>>(partial_scale, partial_bias,
+                                           grid_dim, feature_size, d_scale,
+                                           d_bias);
   }
 }
 
@@ -454,18 +186,14 @@ class LayerNormKernel<platform::CUDADeviceContext, T>
     int batch_size = static_cast<int>(matrix_dim[0]);
     int feature_size = static_cast<int>(matrix_dim[1]);
 
-    auto stream = ctx.cuda_device_context().stream();
+    PADDLE_ENFORCE_GT(
+        feature_size, 1,
+        "Product from begin_norm_axis to end must be larger than 1");
 
-    switch (GetDesiredBlockDim(feature_size)) {
-      FIXED_BLOCK_DIM_CASE(
-          LayerNormForward<T, kBlockDim><<<batch_size, kBlockDim, 0, stream>>>(
-              x_data, scale_data, bias_data, y_data, mean_data, var_data,
-              epsilon, feature_size));
-      default:
-        PADDLE_THROW(
-            "Product from begin_norm_axis to end must be larger than 1");
-        break;
-    }
+    auto stream = ctx.cuda_device_context().stream();
+    LayerNormForward<T><<<batch_size, NormBlockDim(feature_size), 0, stream>>>(
+        x_data, scale_data, bias_data, y_data, mean_data, var_data, epsilon,
+        feature_size);
   }
 };
 
@@ -505,16 +233,13 @@ class LayerNormGradKernel<platform::CUDADeviceContext, T>
     int batch_size = static_cast<int>(matrix_dim[0]);
     int feature_size = static_cast<int>(matrix_dim[1]);
 
-    auto stream = ctx.cuda_device_context().stream();
-
-    LayerNormBackward<T>(x_data, d_y_data, scale_data, mean_data, var_data,
-                         d_x_data, d_scale_data, d_bias_data, epsilon,
-                         batch_size, feature_size, stream);
+    LayerNormBackward<T>(ctx.cuda_device_context(), x_data, d_y_data,
+                         scale_data, mean_data, var_data, d_x_data,
+                         d_scale_data, d_bias_data, epsilon, batch_size,
+                         feature_size);
   }
 };
 
-#undef FIXED_BLOCK_DIM_CASE_BASE
-#undef FIXED_BLOCK_DIM_CASE
 }  // namespace operators
 }  // namespace paddle
 
@@ -185,7 +185,7 @@ class LinearChainCRFOp : public framework::OperatorWithKernel {
   framework::OpKernelType GetExpectedKernelType(
       const framework::ExecutionContext& ctx) const override {
     return framework::OpKernelType(ctx.Input<LoDTensor>("Emission")->type(),
-                                   platform::CPUPlace());
+                                   ctx.device_context().GetPlace());
   }
 };
 
@@ -246,7 +246,7 @@ class LinearChainCRFGradOp : public framework::OperatorWithKernel {
       const framework::ExecutionContext& ctx) const override {
     return framework::OpKernelType(
         ctx.Input<LoDTensor>(framework::GradVarName("LogLikelihood"))->type(),
-        platform::CPUPlace());
+        ctx.device_context().GetPlace());
   }
 };
 
@@ -12,16 +12,335 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include "paddle/fluid/operators/crf_util.cu.h"
 #include "paddle/fluid/operators/linear_chain_crf_op.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+
+// The 1st row of the transitions are the ones from the start, the 2nd row are
+// the ones to the end, and the transitions between the tags begin from the
+// 3rd row, as the CPU kernels.
+constexpr int kStateTransBaseIdx = 2;
+
+template <typename T>
+__global__ void KeCRFExp(const T* in, T* out, int n) {
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += blockDim.x * gridDim.x) {
+    out[i] = exp(in[i]);
+  }
+}
+
+// The forward algorithm of a sequence by a warp. The emissions of a step are
+// scaled by the exp of their max, and the forward vectors alpha are L1
+// normalized, the same as the CPU kernel, so that the gradient kernels of
+// both places read the same alpha.
+template <typename T>
+__global__ void KeCRFForward(const T* x, const T* w, const T* w_exps,
+                             const int64_t* label, const size_t* lod,
+                             int seq_num, int tag_num, bool shared_w,
+                             T* x_exps, T* alpha, T* ll) {
+  int lane = threadIdx.x;
+  const T* trans_exps = w_exps;
+  if (shared_w) {
+    T* w_shared = CRFSharedMemory<T>();
+    for (int i = lane; i < (tag_num + 2) * tag_num; i += kCRFWarpSize) {
+      w_shared[i] = w_exps[i];
+    }
+    __syncthreads();
+    trans_exps = w_shared;
+  }
+  const T* state_trans_exps = trans_exps + kStateTransBaseIdx * tag_num;
+
+  for (int s = blockIdx.x; s < seq_num; s += gridDim.x) {
+    int start = static_cast<int>(lod[s]);
+    int len = static_cast<int>(lod[s + 1]) - start;
+    if (len == 0) {
+      // The cost of an empty sequence is 0.
+      if (lane == 0) ll[s] = 0;
+      continue;
+    }
+    const T* xs = x + start * tag_num;
+    const int64_t* ls = label + start;
+    T* es = x_exps + start * tag_num;
+    T* as = alpha + start * tag_num;
+
+    // log(Z), the log of the sum of the scores of all the tags.
+    T log_z = 0;
+    for (int k = 0; k < len; ++k) {
+      T row_max = xs[k * tag_num];
+      for (int i = lane; i < tag_num; i += kCRFWarpSize) {
+        row_max = max(row_max, xs[k * tag_num + i]);
+      }
+      row_max = CRFWarpMax(row_max);
+
+      T part = 0;
+      for (int i = lane; i < tag_num; i += kCRFWarpSize) {
+        T e = exp(xs[k * tag_num + i] - row_max);
+        es[k * tag_num + i] = e;
+        T a;
+        if (k == 0) {
+          a = trans_exps[i] * e;
+        } else {
+          T sum = 0;
+          for (int j = 0; j < tag_num; ++j) {
+            sum += as[(k - 1) * tag_num + j] *
+                   state_trans_exps[j * tag_num + i];
+          }
+          a = e * sum;
+        }
+        as[k * tag_num + i] = a;
+        part += a;
+      }
+      T sum = CRFWarpSum(part);
+      for (int i = lane; i < tag_num; i += kCRFWarpSize) {
+        as[k * tag_num + i] /= sum;
+      }
+      log_z += row_max + log(sum);
+      __syncthreads();
+    }
+    T part = 0;
+    for (int i = lane; i < tag_num; i += kCRFWarpSize) {
+      part += as[(len - 1) * tag_num + i] * trans_exps[tag_num + i];
+    }
+    log_z += log(CRFWarpSum(part));
+
+    // The score of the labels.
+    T score = 0;
+    for (int k = lane; k < len; k += kCRFWarpSize) {
+      int64_t l = ls[k];
+      score += xs[k * tag_num + l];
+      score += k == 0 ? w[l]
+                      : w[(ls[k - 1] + kStateTransBaseIdx) * tag_num + l];
+      if (k == len - 1) score += w[tag_num + l];
+    }
+    score = CRFWarpSum(score);
+    if (lane == 0) ll[s] = log_z - score;
+  }
+}
+
+// The backward algorithm of a sequence by a warp, and the gradients. The
+// lane of a tag writes the gradients of the transitions to the tag, so the
+// gradients of the sequences of a block are summed in the shared memory
+// without atomics before they are added to the gradient of the transitions.
+template <typename T>
+__global__ void KeCRFBackward(const T* x_exps, const T* w_exps, const T* alpha,
+                              const int64_t* label, const T* ll_grad,
+                              const size_t* lod, int seq_num, int tag_num,
+                              bool shared, T* beta, T* x_grad, T* w_grad) {
+  int lane = threadIdx.x;
+  int w_size = (tag_num + 2) * tag_num;
+  const T* trans_exps = w_exps;
+  T* trans_grad = w_grad;
+  if (shared) {
+    T* w_shared = CRFSharedMemory<T>();
+    trans_grad = w_shared + w_size;
+    for (int i = lane; i < w_size; i += kCRFWarpSize) {
+      w_shared[i] = w_exps[i];
+      trans_grad[i] = 0;
+    }
+    __syncthreads();
+    trans_exps = w_shared;
+  }
+  const T* state_trans_exps = trans_exps + kStateTransBaseIdx * tag_num;
+  auto add_grad = [&](int index, T val) {
+    if (shared) {
+      trans_grad[index] += val;
+    } else {
+      platform::CudaAtomicAdd(trans_grad + index, val);
+    }
+  };
+
+  for (int s = blockIdx.x; s < seq_num; s += gridDim.x) {
+    int start = static_cast<int>(lod[s]);
+    int len = static_cast<int>(lod[s + 1]) - start;
+    if (len == 0) continue;
+    const T* es = x_exps + start * tag_num;
+    const T* as = alpha + start * tag_num;
+    const int64_t* ls = label + start;
+    T* bs = beta + start * tag_num;
+    T* gs = x_grad + start * tag_num;
+    T dy = ll_grad[s];
+
+    // The backward vectors beta, which are L1 normalized.
+    for (int k = len - 1; k >= 0; --k) {
+      T part = 0;
+      for (int i = lane; i < tag_num; i += kCRFWarpSize) {
+        T b;
+        if (k == len - 1) {
+          b = trans_exps[tag_num + i];
+        } else {
+          b = 0;
+          for (int j = 0; j < tag_num; ++j) {
+            b += state_trans_exps[i * tag_num + j] *
+                 es[(k + 1) * tag_num + j] * bs[(k + 1) * tag_num + j];
+          }
+        }
+        bs[k * tag_num + i] = b;
+        part += b;
+      }
+      T sum = CRFWarpSum(part);
+      for (int i = lane; i < tag_num; i += kCRFWarpSize) {
+        bs[k * tag_num + i] /= sum;
+      }
+      __syncthreads();
+    }
+
+    // The gradients of the emissions, which are the marginal probabilities
+    // of the tags but for the labels.
+    for (int k = 0; k < len; ++k) {
+      T part = 0;
+      for (int i = lane; i < tag_num; i += kCRFWarpSize) {
+        part += as[k * tag_num + i] * bs[k * tag_num + i];
+      }
+      T row_sum = CRFWarpSum(part);
+      for (int i = lane; i < tag_num; i += kCRFWarpSize) {
+        T g = as[k * tag_num + i] * bs[k * tag_num + i] / row_sum * dy;
+        if (ls[k] == i) g -= dy;
+        gs[k * tag_num + i] = g;
+        if (w_grad) {
+          if (k == 0) add_grad(i, g);
+          if (k == len - 1) add_grad(tag_num + i, g);
+        }
+      }
+    }
+    if (!w_grad) continue;
+
+    // The gradients of the transitions between the tags.
+    for (int k = 1; k < len; ++k) {
+      T part = 0;
+      for (int j = lane; j < tag_num; j += kCRFWarpSize) {
+        part += bs[k * tag_num + j] * es[k * tag_num + j];
+      }
+      T row_sum = CRFWarpSum(part);
+      part = 0;
+      for (int j = lane; j < tag_num; j += kCRFWarpSize) {
+        T p = bs[k * tag_num + j] * es[k * tag_num + j] / row_sum;
+        for (int i = 0; i < tag_num; ++i) {
+          part += state_trans_exps[i * tag_num + j] *
+                  as[(k - 1) * tag_num + i] * p;
+        }
+      }
+      T scale = dy / CRFWarpSum(part);
+      for (int j = lane; j < tag_num; j += kCRFWarpSize) {
+        T p = bs[k * tag_num + j] * es[k * tag_num + j] / row_sum * scale;
+        for (int i = 0; i < tag_num; ++i) {
+          add_grad((i + kStateTransBaseIdx) * tag_num + j,
+                   state_trans_exps[i * tag_num + j] *
+                       as[(k - 1) * tag_num + i] * p);
+        }
+        if (ls[k] == j) {
+          add_grad((ls[k - 1] + kStateTransBaseIdx) * tag_num + j, -dy);
+        }
+      }
+    }
+  }
+
+  if (shared && w_grad) {
+    __syncthreads();
+    for (int i = lane; i < w_size; i += kCRFWarpSize) {
+      platform::CudaAtomicAdd(w_grad + i, trans_grad[i]);
+    }
+  }
+}
+
+template <typename T>
+class LinearChainCRFCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    const LoDTensor* emission_weights = ctx.Input<LoDTensor>("Emission");
+    const Tensor* transition_weights = ctx.Input<Tensor>("Transition");
+    const LoDTensor* label = ctx.Input<LoDTensor>("Label");
+    PADDLE_ENFORCE_EQ(emission_weights->NumLevels(), 1UL,
+                      "The Input(Emission) should be a sequence.");
+    PADDLE_ENFORCE_EQ(label->NumLevels(), 1UL,
+                      "The Input(Label) should be a sequence.");
+    auto& lod = label->lod()[0];
+    int seq_num = static_cast<int>(lod.size() - 1);
+    int tag_num = static_cast<int>(emission_weights->dims()[1]);
+
+    Tensor* emission_exps = ctx.Output<Tensor>("EmissionExps");
+    Tensor* transition_exps = ctx.Output<Tensor>("TransitionExps");
+    Tensor* alpha = ctx.Output<Tensor>("Alpha");
+    Tensor* ll = ctx.Output<Tensor>("LogLikelihood");
+    emission_exps->mutable_data<T>(ctx.GetPlace());
+    transition_exps->mutable_data<T>(ctx.GetPlace());
+    alpha->mutable_data<T>(ctx.GetPlace());
+    ll->Resize({seq_num, 1});
+    ll->mutable_data<T>(ctx.GetPlace());
+
+    auto& dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
+    int w_size = (tag_num + 2) * tag_num;
+    int threads = 256;
+    KeCRFExp<T><<<(w_size + threads - 1) / threads, threads, 0,
+                  dev_ctx.stream()>>>(transition_weights->data<T>(),
+                                      transition_exps->data<T>(), w_size);
+    if (seq_num == 0) return;
+
+    size_t shared_bytes = w_size * sizeof(T);
+    bool shared_w = shared_bytes <= kCRFMaxSharedBytes;
+    KeCRFForward<T><<<CRFGrids(dev_ctx, seq_num), kCRFWarpSize,
+                      shared_w ? shared_bytes : 0, dev_ctx.stream()>>>(
+        emission_weights->data<T>(), transition_weights->data<T>(),
+        transition_exps->data<T>(), label->data<int64_t>(),
+        lod.CUDAData(ctx.GetPlace()), seq_num, tag_num, shared_w,
+        emission_exps->data<T>(), alpha->data<T>(), ll->data<T>());
+  }
+};
+
+template <typename T>
+class LinearChainCRFGradCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    const LoDTensor* label = ctx.Input<LoDTensor>("Label");
+    const Tensor* emission_exps = ctx.Input<Tensor>("EmissionExps");
+    const Tensor* transition_exps = ctx.Input<Tensor>("TransitionExps");
+    const Tensor* alpha = ctx.Input<Tensor>("Alpha");
+    const Tensor* ll_grad =
+        ctx.Input<Tensor>(framework::GradVarName("LogLikelihood"));
+    Tensor* emission_grad =
+        ctx.Output<Tensor>(framework::GradVarName("Emission"));
+    Tensor* transition_grad =
+        ctx.Output<Tensor>(framework::GradVarName("Transition"));
+    PADDLE_ENFORCE(emission_grad, "Output(Emission@Grad) should not be null.");
+
+    auto& dev_ctx = ctx.template device_context<platform::CUDADeviceContext>();
+    auto& lod = label->lod()[0];
+    int seq_num = static_cast<int>(lod.size() - 1);
+    int tag_num = static_cast<int>(emission_exps->dims()[1]);
+
+    emission_grad->mutable_data<T>(ctx.GetPlace());
+    T* w_grad = nullptr;
+    if (transition_grad) {
+      w_grad = transition_grad->mutable_data<T>(ctx.GetPlace());
+      math::SetConstant<platform::CUDADeviceContext, T>()(
+          dev_ctx, transition_grad, static_cast<T>(0));
+    }
+    if (seq_num == 0) return;
+
+    Tensor beta;
+    beta.mutable_data<T>(emission_exps->dims(), ctx.GetPlace());
+    // Both the transitions and the gradients of the block are shared.
+    size_t shared_bytes = 2 * (tag_num + 2) * tag_num * sizeof(T);
+    bool shared = shared_bytes <= kCRFMaxSharedBytes;
+    KeCRFBackward<T><<<CRFGrids(dev_ctx, seq_num), kCRFWarpSize,
+                       shared ? shared_bytes : 0, dev_ctx.stream()>>>(
+        emission_exps->data<T>(), transition_exps->data<T>(),
+        alpha->data<T>(), label->data<int64_t>(), ll_grad->data<T>(),
+        lod.CUDAData(ctx.GetPlace()), seq_num, tag_num, shared,
+        beta.data<T>(), emission_grad->data<T>(), w_grad);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
 
 namespace ops = paddle::operators;
 
-REGISTER_OP_CUDA_KERNEL(
-    linear_chain_crf,
-    ops::LinearChainCRFOpKernel<paddle::platform::CUDADeviceContext, float>,
-    ops::LinearChainCRFOpKernel<paddle::platform::CUDADeviceContext, double>);
-REGISTER_OP_CUDA_KERNEL(
-    linear_chain_crf_grad,
-    ops::LinearChainCRFGradOpKernel<paddle::platform::CUDADeviceContext, float>,
-    ops::LinearChainCRFGradOpKernel<paddle::platform::CUDADeviceContext,
-                                    double>);
+REGISTER_OP_CUDA_KERNEL(linear_chain_crf,
+                        ops::LinearChainCRFCUDAKernel<float>,
+                        ops::LinearChainCRFCUDAKernel<double>);
+REGISTER_OP_CUDA_KERNEL(linear_chain_crf_grad,
+                        ops::LinearChainCRFGradCUDAKernel<float>,
+                        ops::LinearChainCRFGradCUDAKernel<double>);
@@ -13,7 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 #include <fstream>
 #include "paddle/fluid/framework/data_type_transform.h"
+#include "paddle/fluid/framework/indexed_params.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/parallel_tensor_loader.h"
 #include "paddle/fluid/platform/device_context.h"
 
 namespace paddle {
@@ -33,11 +35,25 @@ class LoadCombineOp : public framework::OperatorBase {
     auto filename = Attr<std::string>("file_path");
     auto load_as_fp16 = Attr<bool>("load_as_fp16");
     auto model_from_memory = Attr<bool>("model_from_memory");
+    auto use_mmap = Attr<bool>("use_mmap");
     auto out_var_names = Outputs("Out");
     PADDLE_ENFORCE_GT(
         static_cast<int>(out_var_names.size()), 0,
         "The number of output variables should be greater than 0.");
-    if (!model_from_memory) {
+    if (!model_from_memory &&
+        framework::IndexedParamsReader::IsIndexedParamsFile(filename)) {
+      LoadIndexedParams(scope, place, filename, use_mmap && !load_as_fp16,
+                        load_as_fp16, out_var_names);
+      return;
+    }
+    // Only the CPU tensors loaded without conversion can alias the file.
+    if (use_mmap && !model_from_memory && !load_as_fp16 &&
+        platform::is_cpu_place(place)) {
+      LoadParamsFromMappedFile(scope, filename, out_var_names);
+    } else if (!model_from_memory && Attr<int>("num_threads") > 1) {
+      LoadParamsInParallel(scope, place, filename, load_as_fp16,
+                           out_var_names);
+    } else if (!model_from_memory) {
       std::ifstream fin(filename, std::ios::binary);
       PADDLE_ENFORCE(static_cast<bool>(fin),
                      "Cannot open file %s for load_combine op", filename);
@@ -48,6 +64,71 @@ class LoadCombineOp : public framework::OperatorBase {
       LoadParamsFromBuffer(scope, place, &fin, load_as_fp16, out_var_names);
     }
   }
+  // The tensors of the indexed file are loaded by the names of the outputs,
+  // so the outputs can be any subset of the saved tensors in any order.
+  void LoadIndexedParams(const framework::Scope &scope,
+                         const platform::Place &place,
+                         const std::string &filename, bool use_mmap,
+                         bool load_as_fp16,
+                         const std::vector<std::string> &out_var_names) const {
+    framework::IndexedParamsReader reader(filename, use_mmap);
+    std::vector<framework::LoDTensor *> tensors;
+    for (auto &name : out_var_names) {
+      auto *out_var = scope.FindVar(name);
+      PADDLE_ENFORCE(out_var != nullptr, "Output variable %s cannot be found",
+                     name);
+      tensors.push_back(out_var->GetMutable<framework::LoDTensor>());
+    }
+    reader.Load(out_var_names, tensors, place, Attr<int>("num_threads"));
+
+    if (!load_as_fp16) return;
+    for (size_t i = 0; i < out_var_names.size(); i++) {
+      auto *out_var = scope.FindVar(out_var_names[i]);
+      ConvertToFP16(place, out_var);
+    }
+  }
+
+  void LoadParamsInParallel(
+      const framework::Scope &scope, const platform::Place &place,
+      const std::string &filename, bool load_as_fp16,
+      const std::vector<std::string> &out_var_names) const {
+    std::vector<framework::LoDTensor *> tensors;
+    for (auto &name : out_var_names) {
+      auto *out_var = scope.FindVar(name);
+      PADDLE_ENFORCE(out_var != nullptr, "Output variable %s cannot be found",
+                     name);
+      tensors.push_back(out_var->GetMutable<framework::LoDTensor>());
+    }
+    framework::ParallelTensorLoader loader(place);
+    loader.AddCombinedStream(filename, tensors);
+    loader.Run(Attr<int>("num_threads"));
+    VLOG(1) << "Load " << out_var_names.size() << " parameters from "
+            << filename << ", " << loader.StatsString();
+
+    if (!load_as_fp16) return;
+    for (auto &name : out_var_names) {
+      ConvertToFP16(place, scope.FindVar(name));
+    }
+  }
+
+  void LoadParamsFromMappedFile(
+      const framework::Scope &scope, const std::string &filename,
+      const std::vector<std::string> &out_var_names) const {
+    auto file = memory::allocation::MmapAllocation::MapFile(filename);
+    size_t offset = 0;
+    for (size_t i = 0; i < out_var_names.size(); i++) {
+      auto *out_var = scope.FindVar(out_var_names[i]);
+
+      PADDLE_ENFORCE(out_var != nullptr, "Output variable %s cannot be found",
+                     out_var_names[i]);
+
+      auto *tensor = out_var->GetMutable<framework::LoDTensor>();
+      offset = DeserializeFromMappedFile(file, offset, tensor);
+    }
+    VLOG(3) << "Map " << out_var_names.size() << " parameters from "
+            << filename;
+  }
+
   void LoadParamsFromBuffer(
       const framework::Scope &scope, const platform::Place &place,
       std::istream *buffer, bool load_as_fp16,
@@ -69,28 +150,35 @@ class LoadCombineOp : public framework::OperatorBase {
       // Get data from fin to tensor
       DeserializeFromStream(*buffer, tensor, dev_ctx);
 
-      auto in_dtype = tensor->type();
-      auto out_dtype =
-          load_as_fp16 ? framework::proto::VarType::FP16 : in_dtype;
-
-      if (in_dtype != out_dtype) {
-        // convert to float16 tensor
-        auto in_kernel_type = framework::OpKernelType(in_dtype, place);
-        auto out_kernel_type = framework::OpKernelType(out_dtype, place);
-        framework::LoDTensor fp16_tensor;
-        // copy LoD info to the new tensor
-        fp16_tensor.set_lod(tensor->lod());
-        framework::TransDataType(in_kernel_type, out_kernel_type, *tensor,
-                                 &fp16_tensor);
-
-        // reset output tensor
-        out_var->Clear();
-        tensor = out_var->GetMutable<framework::LoDTensor>();
-        tensor->set_lod(fp16_tensor.lod());
-        tensor->ShareDataWith(fp16_tensor);
+      if (load_as_fp16) {
+        ConvertToFP16(place, out_var);
       }
     }
   }
+
+  void ConvertToFP16(const platform::Place &place,
+                     framework::Variable *out_var) const {
+    auto *tensor = out_var->GetMutable<framework::LoDTensor>();
+    auto in_dtype = tensor->type();
+    auto out_dtype = framework::proto::VarType::FP16;
+
+    if (in_dtype != out_dtype) {
+      // convert to float16 tensor
+      auto in_kernel_type = framework::OpKernelType(in_dtype, place);
+      auto out_kernel_type = framework::OpKernelType(out_dtype, place);
+      framework::LoDTensor fp16_tensor;
+      // copy LoD info to the new tensor
+      fp16_tensor.set_lod(tensor->lod());
+      framework::TransDataType(in_kernel_type, out_kernel_type, *tensor,
+                               &fp16_tensor);
+
+      // reset output tensor
+      out_var->Clear();
+      tensor = out_var->GetMutable<framework::LoDTensor>();
+      tensor->set_lod(fp16_tensor.lod());
+      tensor->ShareDataWith(fp16_tensor);
+    }
+  }
 };
 
 class LoadCombineOpProtoMaker : public framework::OpProtoAndCheckerMaker {
@@ -117,6 +205,20 @@ class LoadCombineOpProtoMaker : public framework::OpProtoAndCheckerMaker {
                   "If true, file_path is in memory, and LoDTensors will be "
                   "loaded directly from memory")
         .SetDefault(false);
+    AddAttr<bool>("use_mmap",
+                  "(boolean, default false)"
+                  "If true, the file is mapped into memory and the CPU "
+                  "LoDTensors alias the mapped pages instead of copying "
+                  "them, so that the processes loading the same file share "
+                  "the memory. It is ignored for the other places, or if "
+                  "model_from_memory or load_as_fp16 is true.")
+        .SetDefault(false);
+    AddAttr<int>("num_threads",
+                 "(int, default 1)"
+                 "The number of tensors loaded concurrently on the IO "
+                 "thread pool. It is ignored if model_from_memory or "
+                 "use_mmap is true.")
+        .SetDefault(1);
     AddComment(R"DOC(
 LoadCombine Operator.
 
@@ -129,6 +231,10 @@ in the SaveCombine operator. Hence, the LoadCombine operator is tightly coupled
 with the SaveCombine operator, and can only deserialize one or more LoDTensors 
 that were saved using the SaveCombine operator.
 
+If the file is saved in the indexed format, the LoDTensors are loaded by the
+names of the outputs instead of their positions, so the outputs can be a
+subset of the saved LoDTensors.
+
 )DOC");
   }
 };
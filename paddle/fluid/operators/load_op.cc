@@ -15,6 +15,7 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/data_type_transform.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/sparse_table_checkpoint.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/profiler.h"
 
@@ -34,16 +35,25 @@ class LoadOp : public framework::OperatorBase {
     // FIXME(yuyang18): We save variable to local file now, but we should change
     // it to save an output stream.
     auto filename = Attr<std::string>("file_path");
-    std::ifstream fin(filename, std::ios::binary);
-    PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot open file %s for load op",
-                   filename);
-
     auto out_var_name = Output("Out");
     auto *out_var = scope.FindVar(out_var_name);
     PADDLE_ENFORCE(out_var != nullptr,
                    "Output variable %s cannot be found in scope %p",
                    out_var_name, &scope);
 
+    // The incremental checkpoint of a sparse table on the pserver is loaded
+    // from the base and the deltas of its chain.
+    if (out_var->IsType<framework::SelectedRows>() &&
+        std::ifstream(filename + ".chain").good()) {
+      framework::SparseTableCheckpoint::Load(
+          filename, out_var->GetMutable<framework::SelectedRows>());
+      return;
+    }
+
+    std::ifstream fin(filename, std::ios::binary);
+    PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot open file %s for load op",
+                   filename);
+
     if (out_var->IsType<framework::LoDTensor>()) {
       LoadLodTensor(fin, place, out_var);
     } else if (out_var->IsType<framework::SelectedRows>()) {
@@ -37,6 +37,12 @@ class LookupTableOp : public framework::OperatorWithKernel {
     PADDLE_ENFORCE_EQ(table_dims.size(), 2);
     PADDLE_ENFORCE_EQ(ids_dims[ids_rank - 1], 1,
                       "The last dimension of the 'Ids' tensor must be 1.");
+    if (ctx->HasInput("WScaleBias")) {
+      auto scale_bias_dims = ctx->GetInputDim("WScaleBias");
+      PADDLE_ENFORCE_EQ(scale_bias_dims.size(), 2);
+      PADDLE_ENFORCE_EQ(scale_bias_dims[1], 2,
+                        "WScaleBias should be [N, 2] of the table [N, D].");
+    }
 
     auto output_dims =
         framework::vectorize(framework::slice_ddim(ids_dims, 0, ids_rank - 1));
@@ -52,7 +58,7 @@ class LookupTableOp : public framework::OperatorWithKernel {
  protected:
   framework::OpKernelType GetExpectedKernelType(
       const framework::ExecutionContext& ctx) const override {
-    auto data_type = framework::GetDataTypeOfVar(ctx.InputVar("W"));
+    auto data_type = math::LookupDataType(ctx.InputVar("W"));
     return framework::OpKernelType(data_type, ctx.device_context());
   }
 };
@@ -67,7 +73,13 @@ class LookupTableOpMaker : public framework::OpProtoAndCheckerMaker {
              "An input with type int32 or int64 "
              "contains the ids to be looked up in W. "
              "The last dimension size must be 1.");
-    AddOutput("Out", "The lookup results, which have the same type as W.");
+    AddInput("WScaleBias",
+             "(Tensor, optional) The float [N, 2] scale and bias of the rows "
+             "of the uint8 W, whose row i is W[i] * scale[i] + bias[i].")
+        .AsDispensable();
+    AddOutput("Out",
+              "The lookup results, which have the same type as W, or float "
+              "if W is a float16 or uint8 quantized table.");
     AddAttr<bool>("is_sparse",
                   "(boolean, default false) "
                   "Sparse update.")
@@ -75,6 +87,11 @@ class LookupTableOpMaker : public framework::OpProtoAndCheckerMaker {
     AddAttr<bool>("is_distributed",
                   "(boolean, default false) distributed lookup table.")
         .SetDefault(false);
+    AddAttr<bool>("is_sharded",
+                  "(boolean, default false) Shard the rows of W between the "
+                  "devices of ParallelExecutor, which exchange the ids and "
+                  "the rows by NCCL. The gradient should be sparse.")
+        .SetDefault(false);
     AddAttr<int64_t>("padding_idx",
                      "(int64, default -1) "
                      "If the value is -1, it makes no effect to lookup. "
@@ -115,6 +132,10 @@ then concatenated into a dense tensor.
 The input Ids can carry the LoD (Level of Details) information,
 or not. And the output only shares the LoD information with input Ids.
 
+W can be a quantized table of an inference model, float16, or uint8 with
+the scale and the bias of every row in WScaleBias; the looked up rows are
+dequantized into float.
+
 )DOC");
   }
 };
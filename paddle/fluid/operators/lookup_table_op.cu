@@ -15,15 +15,18 @@ limitations under the License. */
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/lookup_table_op.h"
+#include "paddle/fluid/operators/scatter.cu.h"
 #include "paddle/fluid/platform/assert.h"
 #include "paddle/fluid/platform/cuda_primitives.h"
 
 namespace paddle {
 namespace operators {
 
-template <typename T, int BlockDimX, int BlockDimY, int GridDimX,
-          bool PaddingFlag>
-__global__ void LookupTable(T *output, const T *table, const int64_t *ids,
+// The table is read by a math::QuantizedTableReader, which dequantizes the
+// rows of the float16 and uint8 tables.
+template <typename T, typename Reader, int BlockDimX, int BlockDimY,
+          int GridDimX, bool PaddingFlag>
+__global__ void LookupTable(T *output, const Reader table, const int64_t *ids,
                             const int64_t N, const int64_t K, const int64_t D,
                             const int64_t padding_idx) {
   int idx = threadIdx.x;
@@ -34,40 +37,44 @@ __global__ void LookupTable(T *output, const T *table, const int64_t *ids,
     PADDLE_ASSERT_MSG_CODE(id >= 0, "received id:", id);
     PADDLE_ASSERT_MSG_CODE(id < N, "received id:", id);
     T *out = output + idy * D;
-    const T *tab = table + id * D;
     for (int i = idx; i < D; i += BlockDimX) {
       if (PaddingFlag) {
         if (id == padding_idx)
           out[i] = static_cast<T>(0);
         else
-          out[i] = tab[i];
+          out[i] = table(id, i);
       } else {
-        out[i] = tab[i];
+        out[i] = table(id, i);
       }
     }
     idy += BlockDimY * GridDimX;
   }
 }
 
-template <typename T, int BlockDimX, int BlockDimY, int GridDimX>
-__global__ void LookupTableGrad(T *table, const T *output, const int64_t *ids,
-                                const int64_t N, const int64_t K,
-                                const int64_t D) {
-  int idx = threadIdx.x;
-  int idy = blockIdx.x + threadIdx.y * GridDimX;
-
-  while (idy < K) {
-    int64_t id = ids[idy];
-    PADDLE_ASSERT_MSG_CODE(id >= 0, "received id:", id);
-    PADDLE_ASSERT_MSG_CODE(id < N, "received id:", id);
-    const T *out = output + idy * D;
-    T *tab = table + id * D;
-    for (int i = idx; i < D; i += BlockDimX) {
-      paddle::platform::CudaAtomicAdd(&tab[i], out[i]);
-    }
-    idy += BlockDimY * GridDimX;
+template <typename T>
+struct LookupTableLauncher {
+  template <typename Reader>
+  void operator()(const Reader &table) const {
+    dim3 threads(128, 8);
+    dim3 grids(8, 1);
+    if (padding_idx == -1)
+      LookupTable<T, Reader, 128, 8, 8,
+                  false><<<grids, threads, 0, dev_ctx.stream()>>>(
+          output, table, ids, N, K, D, padding_idx);
+    else
+      LookupTable<T, Reader, 128, 8, 8,
+                  true><<<grids, threads, 0, dev_ctx.stream()>>>(
+          output, table, ids, N, K, D, padding_idx);
   }
-}
+
+  const platform::CUDADeviceContext &dev_ctx;
+  T *output;
+  const int64_t *ids;
+  int64_t N;
+  int64_t K;
+  int64_t D;
+  int64_t padding_idx;
+};
 
 template <typename T>
 class LookupTableCUDAKernel : public framework::OpKernel<T> {
@@ -105,20 +112,22 @@ class LookupTableCUDAKernel : public framework::OpKernel<T> {
       size_t K = ids_t->numel();
 
       auto *ids = ids_t->data<int64_t>();
-      auto *table = table_t->data<T>();
       auto *output = output_t->mutable_data<T>(context.GetPlace());
 
-      dim3 threads(128, 8);
-      dim3 grids(8, 1);
-
-      if (padding_idx == -1)
-        LookupTable<T, 128, 8, 8, false><<<
-            grids, threads, 0, context.cuda_device_context().stream()>>>(
-            output, table, ids, N, K, D, padding_idx);
-      else
-        LookupTable<T, 128, 8, 8, true><<<
-            grids, threads, 0, context.cuda_device_context().stream()>>>(
-            output, table, ids, N, K, D, padding_idx);
+      LookupTableLauncher<T> launcher{context.cuda_device_context(),
+                                      output,
+                                      ids,
+                                      static_cast<int64_t>(N),
+                                      static_cast<int64_t>(K),
+                                      static_cast<int64_t>(D),
+                                      padding_idx};
+      if (math::IsQuantizedTable(*table_t)) {
+        math::VisitQuantizedTable<T>(
+            *table_t, context.Input<LoDTensor>("WScaleBias"), launcher);
+      } else {
+        launcher(math::QuantizedTableReader<T, T>(table_t->data<T>(), nullptr,
+                                                  D));
+      }
     }
   }
 };
@@ -143,26 +152,43 @@ class LookupTableGradCUDAKernel : public framework::OpKernel<T> {
       int64_t ids_num = ids->numel();
 
       auto stream = dev_ctx.stream();
+      auto gpu_place = boost::get<platform::CUDAPlace>(context.GetPlace());
+      int64_t D = table->dims()[1];
+      auto d_output_dims = d_output->dims();
+      PADDLE_ENFORCE_EQ(
+          framework::make_ddim({ids_num, D}),
+          framework::flatten_to_2d(d_output_dims, d_output_dims.size() - 1));
+      auto *d_table_value = d_table->mutable_value();
+
+      // If the ids repeat a lot, the rows of the same id are summed by the
+      // sorted scatter add, so that the gradient holds the unique rows.
+      int unique = CountUniqueIndex(dev_ctx, ids_data, ids_num,
+                                    table->dims()[0]);
+      if (UseSortedScatterAdd(ids_num, unique)) {
+        framework::Vector<int64_t> new_rows;
+        new_rows.resize(unique);
+        d_table_value->Resize({unique, D});
+        GPUSortedScatterAdd<T, int64_t>(
+            dev_ctx, d_output->data<T>(), ids_data, ids_num, D,
+            table->dims()[0], unique,
+            d_table_value->mutable_data<T>(context.GetPlace()),
+            new_rows.CUDAMutableData(context.GetPlace()));
+        d_table->set_rows(new_rows);
+        return;
+      }
+
       // copy GPU memory to CPU pinned memory
       framework::Vector<int64_t> new_rows;
       new_rows.resize(ids_num);
-      auto gpu_place = boost::get<platform::CUDAPlace>(context.GetPlace());
 
       // TODO(yuyang18): Strange code here.
       memory::Copy(gpu_place, new_rows.CUDAMutableData(context.GetPlace()),
                    gpu_place, ids_data, ids_num * sizeof(int64_t), stream);
       d_table->set_rows(new_rows);
 
-      auto *d_table_value = d_table->mutable_value();
-      d_table_value->Resize({ids_num, table->dims()[1]});
-      d_table_value->mutable_data<T>(context.GetPlace());
-
-      auto *d_table_data = d_table_value->data<T>();
+      d_table_value->Resize({ids_num, D});
+      auto *d_table_data = d_table_value->mutable_data<T>(context.GetPlace());
       auto *d_output_data = d_output->data<T>();
-      auto d_output_dims = d_output->dims();
-      PADDLE_ENFORCE_EQ(
-          d_table_value->dims(),
-          framework::flatten_to_2d(d_output_dims, d_output_dims.size() - 1));
       memory::Copy(gpu_place, d_table_data, gpu_place, d_output_data,
                    d_output->numel() * sizeof(T), stream);
 
@@ -181,10 +207,10 @@ class LookupTableGradCUDAKernel : public framework::OpKernel<T> {
       auto t = framework::EigenVector<T>::Flatten(*d_table_t);
       t.device(*dev_ctx.eigen_device()) = t.constant(static_cast<T>(0));
 
-      dim3 threads(128, 8);
-      dim3 grids(8, 1);
-      LookupTableGrad<T, 128, 8, 8><<<grids, threads, 0, dev_ctx.stream()>>>(
-          d_table, d_output, ids, N, K, D);
+      // If the ids repeat a lot, their rows are summed in order by the
+      // sorted scatter add, which is deterministic and free of the
+      // contention of atomicAdd on the hot ids.
+      GPUScatterAdd<T, int64_t>(dev_ctx, d_output, ids, K, D, N, d_table);
     }
   }
 };
@@ -17,11 +17,13 @@ limitations under the License. */
 #include <string>
 #include <vector>
 
+#include "paddle/fluid/framework/compute_pool.h"
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/selected_rows.h"
 #include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/quantized_table.h"
 
 #ifdef PADDLE_WITH_DISTRIBUTE
 #include "paddle/fluid/operators/distributed/parameter_prefetch.h"
@@ -37,6 +39,38 @@ using DDim = framework::DDim;
 
 constexpr int64_t kNoPadding = -1;
 
+// Looks up the rows of ids in a quantized table, dequantizing them into the
+// output.
+template <typename T>
+struct LookupQuantizedRows {
+  template <typename Reader>
+  void operator()(const Reader &reader) const {
+    framework::ParallelFor(
+        0, ids_numel, framework::GrainSize(row_width),
+        [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            T *out = output + i * row_width;
+            if (padding_idx != kNoPadding && ids[i] == padding_idx) {
+              memset(out, 0, row_width * sizeof(T));
+            } else {
+              PADDLE_ENFORCE_LT(ids[i], row_number);
+              PADDLE_ENFORCE_GE(ids[i], 0, "ids %d", i);
+              for (int64_t d = 0; d < row_width; ++d) {
+                out[d] = reader(ids[i], d);
+              }
+            }
+          }
+        });
+  }
+
+  const int64_t *ids;
+  int64_t ids_numel;
+  int64_t row_number;
+  int64_t row_width;
+  int64_t padding_idx;
+  T *output;
+};
+
 template <typename T>
 class LookupTableKernel : public framework::OpKernel<T> {
  public:
@@ -75,25 +109,40 @@ class LookupTableKernel : public framework::OpKernel<T> {
         auto *table_t = context.Input<LoDTensor>("W");
         int64_t row_number = table_t->dims()[0];
         int64_t row_width = table_t->dims()[1];
-
-        auto *table = table_t->data<T>();
         auto *output = output_t->mutable_data<T>(context.GetPlace());
 
-        for (int64_t i = 0; i < ids_numel; ++i) {
-          if (padding_idx != kNoPadding && ids[i] == padding_idx) {
-            memset(output + i * row_width, 0, row_width * sizeof(T));
-          } else {
-            PADDLE_ENFORCE_LT(ids[i], row_number);
-            PADDLE_ENFORCE_GE(ids[i], 0, "ids %d", i);
-            memcpy(output + i * row_width, table + ids[i] * row_width,
-                   row_width * sizeof(T));
-          }
+        if (math::IsQuantizedTable(*table_t)) {
+          math::VisitQuantizedTable<T>(
+              *table_t, context.Input<LoDTensor>("WScaleBias"),
+              LookupQuantizedRows<T>{ids, ids_numel, row_number, row_width,
+                                     padding_idx, output});
+          return;
         }
+
+        auto *table = table_t->data<T>();
+
+        framework::ParallelFor(
+            0, ids_numel, framework::GrainSize(row_width),
+            [&](int64_t begin, int64_t end) {
+              for (int64_t i = begin; i < end; ++i) {
+                if (padding_idx != kNoPadding && ids[i] == padding_idx) {
+                  memset(output + i * row_width, 0, row_width * sizeof(T));
+                } else {
+                  PADDLE_ENFORCE_LT(ids[i], row_number);
+                  PADDLE_ENFORCE_GE(ids[i], 0, "ids %d", i);
+                  memcpy(output + i * row_width, table + ids[i] * row_width,
+                         row_width * sizeof(T));
+                }
+              }
+            });
       } else if (table_var->IsType<SelectedRows>()) {
         const auto &table_t = table_var->Get<SelectedRows>();
         int64_t row_width = table_t.value().dims()[1];
         const auto *table = table_t.value().data<T>();
         auto *output = output_t->mutable_data<T>(context.GetPlace());
+        // Keeps the rows of ids in the table if it spills.
+        auto pin =
+            const_cast<SelectedRows &>(table_t).PinRows(ids, ids_numel, false);
 
         auto blas = math::GetBlas<platform::CPUDeviceContext, T>(context);
         for (int64_t i = 0; i < ids_numel; ++i) {
@@ -0,0 +1,477 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <vector>
+#include "cub/cub.cuh"
+#include "paddle/fluid/framework/mixed_vector.h"
+#include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/operators/math/beam_search.h"
+#include "paddle/fluid/operators/math/math_function.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+static constexpr int kBeamSearchThreads = 256;
+
+// A candidate of a source sentence, index is the offset in ids, which is
+// negative if there is no candidate.
+struct BeamCandidate {
+  float score;
+  int64_t index;
+};
+
+// Whether a comes before b in the order of (score descending, index
+// ascending), which breaks the ties of the scores.
+__device__ __forceinline__ bool BetterCandidate(const BeamCandidate& a,
+                                                const BeamCandidate& b) {
+  if (a.index < 0) return false;
+  if (b.index < 0) return true;
+  return a.score > b.score || (a.score == b.score && a.index < b.index);
+}
+
+struct BetterCandidateOp {
+  __device__ __forceinline__ BeamCandidate
+  operator()(const BeamCandidate& a, const BeamCandidate& b) const {
+    return BetterCandidate(a, b) ? a : b;
+  }
+};
+
+// The prefixes [*begin, *end) of the source src, which are the offsets of
+// level_lod mapped by next_lod if the level is not the last one.
+__device__ __forceinline__ void SourcePrefixes(const size_t* level_lod,
+                                               const size_t* next_lod,
+                                               int src, size_t* begin,
+                                               size_t* end) {
+  *begin = level_lod[src];
+  *end = level_lod[src + 1];
+  if (next_lod != nullptr) {
+    *begin = next_lod[*begin];
+    *end = next_lod[*end];
+  }
+}
+
+// Every block selects the candidates of one source by beam_size rounds of
+// block reduce, each of which finds the best candidate after the one of the
+// last round. The selected candidates are stored in the order of the
+// prefixes.
+__global__ void BeamSearchSelectKernel(
+    const int64_t* pre_ids, const float* pre_scores, const int64_t* ids,
+    const float* scores, const size_t* level_lod, const size_t* next_lod,
+    int64_t width, int beam_size, int end_id, int64_t* selected_offsets,
+    int64_t* selected_ids, float* selected_scores, int64_t* selected_nums) {
+  using BlockReduce = cub::BlockReduce<BeamCandidate, kBeamSearchThreads>;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+  __shared__ BeamCandidate picks[kBeamSearchMaxBeamSize];
+
+  int src = blockIdx.x;
+  size_t begin, end;
+  SourcePrefixes(level_lod, next_lod, src, &begin, &end);
+  int64_t candidate_end = static_cast<int64_t>(end) * width;
+
+  int num_picks = 0;
+  BeamCandidate last;
+  last.index = -1;
+  for (; num_picks < beam_size; ++num_picks) {
+    BeamCandidate best;
+    best.index = -1;
+    for (int64_t i = static_cast<int64_t>(begin) * width + threadIdx.x;
+         i < candidate_end; i += kBeamSearchThreads) {
+      int64_t offset = i / width;
+      BeamCandidate candidate;
+      candidate.index = i;
+      if (pre_ids[offset] == end_id) {
+        // The ended prefix only has the candidate end_id.
+        if (i != offset * width) continue;
+        candidate.score = pre_scores[offset];
+      } else {
+        candidate.score = scores[i];
+      }
+      if (num_picks > 0 && !BetterCandidate(last, candidate)) continue;
+      if (BetterCandidate(candidate, best)) best = candidate;
+    }
+    BeamCandidate top = BlockReduce(temp_storage).Reduce(best,
+                                                         BetterCandidateOp());
+    if (threadIdx.x == 0) picks[num_picks] = top;
+    __syncthreads();
+    last = picks[num_picks];
+    if (last.index < 0) break;
+  }
+
+  if (threadIdx.x != 0) return;
+  // Prune the source if all the branches have ended.
+  bool finished = true;
+  for (int k = 0; k < num_picks && finished; ++k) {
+    int64_t offset = picks[k].index / width;
+    finished = pre_ids[offset] == end_id;
+  }
+  if (finished) num_picks = 0;
+
+  // Sort the picks by the prefixes, the picks of the same prefix are kept in
+  // the order of the scores.
+  for (int k = 1; k < num_picks; ++k) {
+    BeamCandidate pick = picks[k];
+    int j = k - 1;
+    for (; j >= 0 && picks[j].index / width > pick.index / width; --j) {
+      picks[j + 1] = picks[j];
+    }
+    picks[j + 1] = pick;
+  }
+  for (int k = 0; k < num_picks; ++k) {
+    int64_t offset = picks[k].index / width;
+    int64_t out = static_cast<int64_t>(src) * beam_size + k;
+    selected_offsets[out] = offset;
+    selected_ids[out] =
+        pre_ids[offset] == end_id ? end_id : ids[picks[k].index];
+    selected_scores[out] = picks[k].score;
+  }
+  selected_nums[src] = num_picks;
+}
+
+// Build the LoD of the outputs by one block. source_starts[src] is the first
+// output row of the source src, and source_starts[src_num] is the number of
+// the output rows.
+__global__ void BeamSearchLoDKernel(const size_t* level_lod,
+                                    const size_t* next_lod, int src_num,
+                                    int beam_size,
+                                    const int64_t* selected_offsets,
+                                    const int64_t* selected_nums,
+                                    int64_t* source_starts, size_t* high_level,
+                                    size_t* low_level) {
+  if (threadIdx.x == 0) {
+    int64_t start = 0;
+    for (int src = 0; src < src_num; ++src) {
+      source_starts[src] = start;
+      start += selected_nums[src];
+    }
+    source_starts[src_num] = start;
+  }
+  __syncthreads();
+
+  for (int src = threadIdx.x; src < src_num; src += blockDim.x) {
+    size_t begin, end;
+    SourcePrefixes(level_lod, next_lod, src, &begin, &end);
+    high_level[src] = begin;
+    if (src == src_num - 1) {
+      high_level[src_num] = end;
+      low_level[end] = source_starts[src_num];
+    }
+    const int64_t* offsets = selected_offsets + src * beam_size;
+    int64_t num = selected_nums[src];
+    int64_t k = 0;
+    for (size_t prefix = begin; prefix < end; ++prefix) {
+      while (k < num && offsets[k] < static_cast<int64_t>(prefix)) ++k;
+      low_level[prefix] = source_starts[src] + k;
+    }
+  }
+}
+
+__global__ void BeamSearchWriteKernel(const int64_t* selected_ids,
+                                      const float* selected_scores,
+                                      const int64_t* selected_nums,
+                                      const int64_t* source_starts,
+                                      int beam_size, int64_t* out_ids,
+                                      float* out_scores) {
+  int src = blockIdx.x;
+  int64_t start = source_starts[src];
+  for (int k = threadIdx.x; k < selected_nums[src]; k += blockDim.x) {
+    int64_t in = static_cast<int64_t>(src) * beam_size + k;
+    out_ids[start + k] = selected_ids[in];
+    out_scores[start + k] = selected_scores[in];
+  }
+}
+
+void BeamSearchFunctor::operator()(const platform::CUDADeviceContext& context,
+                                   const framework::LoDTensor& pre_ids,
+                                   const framework::LoDTensor& pre_scores,
+                                   const framework::LoDTensor& ids,
+                                   const framework::LoDTensor& scores,
+                                   framework::LoDTensor* selected_ids,
+                                   framework::LoDTensor* selected_scores,
+                                   size_t level, size_t beam_size,
+                                   int end_id) {
+  auto& lod = ids.lod();
+  PADDLE_ENFORCE_LT(level, lod.size());
+  PADDLE_ENFORCE_LE(lod.size() - level, 2UL,
+                    "Only the last two LoD levels of ids can be searched.");
+  PADDLE_ENFORCE_LE(beam_size, static_cast<size_t>(kBeamSearchMaxBeamSize),
+                    "beam_size should not be larger than %d on GPU.",
+                    kBeamSearchMaxBeamSize);
+  auto place = context.GetPlace();
+  int src_num = static_cast<int>(lod[level].size()) - 1;
+  int64_t num_prefixes = ids.dims()[0];
+  int64_t width = ids.numel() / std::max<int64_t>(num_prefixes, 1);
+  const size_t* level_lod = lod[level].CUDAData(place);
+  const size_t* next_lod =
+      level + 1 < lod.size() ? lod[level + 1].CUDAData(place) : nullptr;
+  int beam = static_cast<int>(beam_size);
+  int64_t slots = static_cast<int64_t>(src_num) * beam;
+
+  framework::Tensor offsets, sel_ids, sel_scores, nums, starts;
+  int64_t* offsets_data = offsets.mutable_data<int64_t>({slots}, place);
+  int64_t* sel_ids_data = sel_ids.mutable_data<int64_t>({slots}, place);
+  float* sel_scores_data = sel_scores.mutable_data<float>({slots}, place);
+  int64_t* nums_data = nums.mutable_data<int64_t>({src_num}, place);
+  int64_t* starts_data = starts.mutable_data<int64_t>({src_num + 1}, place);
+
+  framework::Vector<size_t> high_level(src_num + 1);
+  framework::Vector<size_t> low_level(num_prefixes + 1);
+  if (src_num > 0) {
+    if (num_prefixes > 0) {
+      BeamSearchSelectKernel<<<src_num, kBeamSearchThreads, 0,
+                               context.stream()>>>(
+          pre_ids.data<int64_t>(), pre_scores.data<float>(),
+          ids.data<int64_t>(), scores.data<float>(), level_lod, next_lod,
+          width, beam, end_id, offsets_data, sel_ids_data, sel_scores_data,
+          nums_data);
+    } else {
+      SetConstant<platform::CUDADeviceContext, int64_t> set_zero;
+      set_zero(context, &nums, static_cast<int64_t>(0));
+    }
+    BeamSearchLoDKernel<<<1, kBeamSearchThreads, 0, context.stream()>>>(
+        level_lod, next_lod, src_num, beam, offsets_data, nums_data,
+        starts_data, high_level.CUDAMutableData(place),
+        low_level.CUDAMutableData(place));
+  }
+
+  // The number of the selected candidates is the only thing needed on the
+  // host, to resize the outputs.
+  int64_t num_selected = 0;
+  if (src_num > 0) {
+    memory::Copy(platform::CPUPlace(), &num_selected,
+                 boost::get<platform::CUDAPlace>(place), starts_data + src_num,
+                 sizeof(int64_t), context.stream());
+    context.Wait();
+  }
+
+  auto dims = framework::make_ddim({num_selected, 1});
+  selected_ids->Resize(dims);
+  selected_scores->Resize(dims);
+  int64_t* out_ids = selected_ids->mutable_data<int64_t>(place);
+  float* out_scores = selected_scores->mutable_data<float>(place);
+  if (num_selected > 0) {
+    BeamSearchWriteKernel<<<src_num, kBeamSearchMaxBeamSize, 0,
+                            context.stream()>>>(sel_ids_data, sel_scores_data,
+                                                nums_data, starts_data, beam,
+                                                out_ids, out_scores);
+  }
+
+  framework::LoD out_lod;
+  out_lod.push_back(high_level);
+  out_lod.push_back(low_level);
+  selected_ids->set_lod(out_lod);
+  selected_scores->set_lod(out_lod);
+}
+
+// Every thread walks back the hypotheses of one source, the same as
+// BeamSearchDecoder<T>::Backtrace. The words of the hypothesis h are stored
+// from the last step in words[h * step_num, h * step_num + lengths[h]).
+template <typename T>
+__global__ void BeamSearchBacktraceKernel(
+    const int64_t* const* step_ids, const T* const* step_scores,
+    const size_t* const* source_lods, const size_t* const* sentence_lods,
+    int step_num, int src_num, int beam_size, int end_id, int64_t* prefixes,
+    int64_t* hyp_nums, int64_t* lengths, T* final_scores, int64_t* word_ids,
+    T* word_scores) {
+  int src = blockIdx.x * blockDim.x + threadIdx.x;
+  if (src >= src_num) return;
+  int64_t first = static_cast<int64_t>(src) * beam_size;
+  int64_t* prefix = prefixes + first;
+  int64_t* length = lengths + first;
+  for (int h = 0; h < beam_size; ++h) length[h] = 0;
+
+  int hyp_num = 0;
+  for (int step = step_num - 1; step >= 0; --step) {
+    const int64_t* ids = step_ids[step];
+    const T* scores = step_scores[step];
+    const size_t* sentence_lod = sentence_lods[step];
+    size_t prefix_start = source_lods[step][src];
+    size_t prefix_end = source_lods[step][src + 1];
+    if (hyp_num == 0) {
+      // The source is finished and pruned at this step, or this is the last
+      // step, the hypotheses start from all its candidates.
+      for (size_t p = prefix_start; p < prefix_end; ++p) {
+        for (size_t c = sentence_lod[p];
+             c < sentence_lod[p + 1] && hyp_num < beam_size; ++c) {
+          int64_t h = first + hyp_num;
+          prefix[hyp_num++] = p;
+          word_ids[h * step_num] = ids[c];
+          word_scores[h * step_num] = scores[c];
+          final_scores[h] = scores[c];
+          length[h - first] = 1;
+        }
+      }
+    } else {
+      size_t candidate_start = sentence_lod[prefix_start];
+      size_t p = prefix_start;
+      size_t candidate_num = sentence_lod[p + 1] - sentence_lod[p];
+      for (int idx = 0; idx < hyp_num; ++idx) {
+        size_t c = prefix[idx];
+        int64_t h = first + idx;
+        if (ids[c] != end_id || length[idx] == 0) {
+          // to skip redundant end tokens
+          word_ids[h * step_num + length[idx]] = ids[c];
+          word_scores[h * step_num + length[idx]] = scores[c];
+          ++length[idx];
+        }
+        while (candidate_start + candidate_num <= c) {
+          ++p;
+          candidate_num += sentence_lod[p + 1] - sentence_lod[p];
+        }
+        prefix[idx] = p;
+      }
+    }
+  }
+  hyp_nums[src] = hyp_num;
+}
+
+// Write the words of the hypotheses order[i] to [sentence_lod[i],
+// sentence_lod[i + 1]) of the outputs, in the order of the steps.
+template <typename T>
+__global__ void BeamSearchGatherKernel(const int64_t* word_ids,
+                                       const T* word_scores,
+                                       const int64_t* order,
+                                       const size_t* sentence_lod,
+                                       int64_t hyp_count, int step_num,
+                                       int64_t* out_ids, T* out_scores) {
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < hyp_count;
+       i += blockDim.x * gridDim.x) {
+    size_t start = sentence_lod[i];
+    int64_t length = sentence_lod[i + 1] - start;
+    int64_t in = order[i] * step_num + length - 1;
+    for (int64_t j = 0; j < length; ++j) {
+      out_ids[start + j] = word_ids[in - j];
+      out_scores[start + j] = word_scores[in - j];
+    }
+  }
+}
+
+template <typename T>
+void BeamSearchBacktraceFunctor<T>::operator()(
+    const platform::CUDADeviceContext& context,
+    const framework::LoDTensorArray& step_ids,
+    const framework::LoDTensorArray& step_scores,
+    framework::LoDTensor* id_tensor, framework::LoDTensor* score_tensor,
+    size_t beam_size, int end_id) {
+  auto place = context.GetPlace();
+  auto gpu_place = boost::get<platform::CUDAPlace>(place);
+  int step_num = static_cast<int>(step_ids.size());
+  int src_num = static_cast<int>(step_ids[0].lod()[0].size()) - 1;
+  int beam = static_cast<int>(beam_size);
+  int64_t hyp_slots = static_cast<int64_t>(src_num) * beam;
+
+  // The tables of the steps, stored as one array of pointers.
+  std::vector<const void*> tables(4 * step_num);
+  for (int step = 0; step < step_num; ++step) {
+    auto& ids = step_ids[step];
+    auto& scores = step_scores[step];
+    tables[step] = ids.numel() > 0 ? ids.data<int64_t>() : nullptr;
+    tables[step_num + step] = scores.numel() > 0 ? scores.data<T>() : nullptr;
+    tables[2 * step_num + step] = ids.lod()[0].CUDAData(place);
+    tables[3 * step_num + step] = ids.lod()[1].CUDAData(place);
+  }
+  size_t tables_bytes = tables.size() * sizeof(void*);
+  auto tables_buf =
+      platform::DeviceTemporaryAllocator::Instance().Get(context).Allocate(
+          tables_bytes);
+  memory::Copy(gpu_place, tables_buf->ptr(), platform::CPUPlace(),
+               tables.data(), tables_bytes, context.stream());
+  auto* dev_tables = reinterpret_cast<const void* const*>(tables_buf->ptr());
+
+  framework::Tensor prefixes, hyp_nums, lengths, final_scores, words, scores;
+  int64_t* hyp_nums_data = hyp_nums.mutable_data<int64_t>({src_num}, place);
+  int64_t* lengths_data = lengths.mutable_data<int64_t>({hyp_slots}, place);
+  T* final_scores_data = final_scores.mutable_data<T>({hyp_slots}, place);
+  int64_t* words_data =
+      words.mutable_data<int64_t>({hyp_slots * step_num}, place);
+  T* scores_data = scores.mutable_data<T>({hyp_slots * step_num}, place);
+
+  int threads = std::min(src_num, kBeamSearchThreads);
+  int blocks = (src_num + threads - 1) / threads;
+  BeamSearchBacktraceKernel<T><<<blocks, threads, 0, context.stream()>>>(
+      reinterpret_cast<const int64_t* const*>(dev_tables),
+      reinterpret_cast<const T* const*>(dev_tables + step_num),
+      reinterpret_cast<const size_t* const*>(dev_tables + 2 * step_num),
+      reinterpret_cast<const size_t* const*>(dev_tables + 3 * step_num),
+      step_num, src_num, beam, end_id,
+      prefixes.mutable_data<int64_t>({hyp_slots}, place), hyp_nums_data,
+      lengths_data, final_scores_data, words_data, scores_data);
+
+  std::vector<int64_t> cpu_hyp_nums(src_num);
+  std::vector<int64_t> cpu_lengths(hyp_slots);
+  std::vector<T> cpu_final_scores(hyp_slots);
+  memory::Copy(platform::CPUPlace(), cpu_hyp_nums.data(), gpu_place,
+               hyp_nums_data, src_num * sizeof(int64_t), context.stream());
+  memory::Copy(platform::CPUPlace(), cpu_lengths.data(), gpu_place,
+               lengths_data, hyp_slots * sizeof(int64_t), context.stream());
+  memory::Copy(platform::CPUPlace(), cpu_final_scores.data(), gpu_place,
+               final_scores_data, hyp_slots * sizeof(T), context.stream());
+  context.Wait();
+
+  // Sort the hypotheses of every source by the final scores, the same as
+  // BeamSearchDecoder<T>::ConvertSentenceVectorToLodTensor, where every
+  // source has beam_size hypotheses and the empty ones are placed last.
+  std::vector<int64_t> order(hyp_slots);
+  std::vector<size_t> source_level = {0};
+  std::vector<size_t> sentence_level = {0};
+  for (int src = 0; src < src_num; ++src) {
+    auto first = order.begin() + src * beam;
+    for (int h = 0; h < beam; ++h) first[h] = src * beam + h;
+    std::sort(first, first + beam, [&](int64_t a, int64_t b) {
+      if (cpu_lengths[a] == 0) return false;
+      if (cpu_lengths[b] == 0) return true;
+      return cpu_final_scores[a] > cpu_final_scores[b];
+    });
+    for (int h = 0; h < beam; ++h) {
+      sentence_level.push_back(sentence_level.back() + cpu_lengths[first[h]]);
+    }
+    source_level.push_back(source_level.back() + beam);
+  }
+
+  framework::LoD lod;
+  lod.emplace_back(source_level);
+  lod.emplace_back(sentence_level);
+  int64_t num_words = static_cast<int64_t>(sentence_level.back());
+  id_tensor->set_lod(lod);
+  id_tensor->Resize({num_words});
+  score_tensor->set_lod(lod);
+  score_tensor->Resize({num_words});
+  int64_t* out_ids = id_tensor->mutable_data<int64_t>(place);
+  T* out_scores = score_tensor->mutable_data<T>(place);
+  if (num_words == 0) return;
+
+  size_t order_bytes = order.size() * sizeof(int64_t);
+  auto order_buf =
+      platform::DeviceTemporaryAllocator::Instance().Get(context).Allocate(
+          order_bytes);
+  memory::Copy(gpu_place, order_buf->ptr(), platform::CPUPlace(),
+               order.data(), order_bytes, context.stream());
+  int gather_threads = kBeamSearchThreads;
+  int gather_blocks = static_cast<int>(
+      std::min<int64_t>((hyp_slots + gather_threads - 1) / gather_threads,
+                        context.GetMaxPhysicalThreadCount() / gather_threads));
+  BeamSearchGatherKernel<T><<<std::max(gather_blocks, 1), gather_threads, 0,
+                              context.stream()>>>(
+      words_data, scores_data, static_cast<const int64_t*>(order_buf->ptr()),
+      id_tensor->lod()[1].CUDAData(place), hyp_slots, step_num, out_ids,
+      out_scores);
+}
+
+template class BeamSearchBacktraceFunctor<float>;
+template class BeamSearchBacktraceFunctor<double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
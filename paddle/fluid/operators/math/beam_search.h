@@ -0,0 +1,75 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/lod_tensor_array.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+#ifdef PADDLE_WITH_CUDA
+// The max beam_size supported by BeamSearchFunctor.
+constexpr int kBeamSearchMaxBeamSize = 128;
+
+/*
+ * One step of the beam search on the device, which has the same semantics
+ * as the BeamSearch of beam_search_op.h: for every source sentence at the
+ * given LoD level of ids, select the top beam_size candidates of all its
+ * prefixes, the ended prefixes (pre_ids == end_id) having the only candidate
+ * end_id with pre_scores, and prune the source if all its selected
+ * candidates end the ended prefixes.
+ *
+ * The LoD of ids is read and the LoD of the outputs is written on the
+ * device, only the number of the selected candidates is copied to the host
+ * to resize the outputs.
+ */
+class BeamSearchFunctor {
+ public:
+  void operator()(const platform::CUDADeviceContext& context,
+                  const framework::LoDTensor& pre_ids,
+                  const framework::LoDTensor& pre_scores,
+                  const framework::LoDTensor& ids,
+                  const framework::LoDTensor& scores,
+                  framework::LoDTensor* selected_ids,
+                  framework::LoDTensor* selected_scores, size_t level,
+                  size_t beam_size, int end_id);
+};
+
+/*
+ * The backtrace of beam_search_decode on the device, which has the same
+ * semantics as the BeamSearchDecoder of beam_search_decode_op.h. The
+ * hypotheses of every source sentence are walked back by one thread from
+ * the last step it has candidates, and only the lengths and the final
+ * scores of the hypotheses are copied to the host to sort them and build
+ * the LoD of the outputs, which are on the device.
+ */
+template <typename T>
+class BeamSearchBacktraceFunctor {
+ public:
+  void operator()(const platform::CUDADeviceContext& context,
+                  const framework::LoDTensorArray& step_ids,
+                  const framework::LoDTensorArray& step_scores,
+                  framework::LoDTensor* id_tensor,
+                  framework::LoDTensor* score_tensor, size_t beam_size,
+                  int end_id);
+};
+#endif
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -176,6 +176,17 @@ class Blas {
                    int K, T alpha, const T* A, const T* B, T beta, T* C,
                    int batchCount, int64_t strideA, int64_t strideB) const;
 
+  // Batched GEMM of the matrices with the same N and K but different number
+  // of rows M[i], e.g. the sequences of a LoDTensor, so that the sequences
+  // are multiplied without being padded to the same length. The matrices with
+  // M[i] <= 0 are skipped. The pointer arrays are on the host.
+  template <typename T>
+  void VarLenBatchedGEMM(CBLAS_TRANSPOSE transA, CBLAS_TRANSPOSE transB,
+                         const std::vector<int>& M, int N, int K, T alpha,
+                         const std::vector<const T*>& A, int lda,
+                         const std::vector<const T*>& B, int ldb, T beta,
+                         const std::vector<T*>& C, int ldc) const;
+
   template <typename T>
   void MatMul(const framework::Tensor& mat_a, const MatDescriptor& dim_a,
               const framework::Tensor& mat_b, const MatDescriptor& dim_b,
@@ -285,6 +296,11 @@ class BlasT : private Blas<DeviceContext> {
     Base()->template BatchedGEMM<T>(args...);
   }
 
+  template <typename... ARGS>
+  void VarLenBatchedGEMM(ARGS... args) const {
+    Base()->template VarLenBatchedGEMM<T>(args...);
+  }
+
   template <typename... ARGS>
   void VINV(ARGS... args) const {
     Base()->template VINV<T>(args...);
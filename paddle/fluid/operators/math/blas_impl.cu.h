@@ -14,11 +14,15 @@
 
 #pragma once
 
+#include <map>
+#include <vector>
+#include "paddle/fluid/memory/memory.h"
 #include "paddle/fluid/operators/math/math_function.h"
 #include "paddle/fluid/platform/dynload/cublas.h"
 #include "paddle/fluid/platform/gpu_info.h"
 
 DECLARE_bool(enable_cublas_tensor_op_math);
+DECLARE_bool(cublas_fp16_gemm_padding);
 
 namespace paddle {
 namespace operators {
@@ -53,6 +57,11 @@ struct CUBlas<float> {
 #endif
   }
 
+  template <typename... ARGS>
+  static void GEMM_BATCH(ARGS... args) {
+    PADDLE_ENFORCE(platform::dynload::cublasSgemmBatched(args...));
+  }
+
   // NOTES: GEMM_EX can use Tensor Core to accelerate matrix multiply.
   // https://docs.nvidia.com/cuda/cublas/index.html#cublassetmathmode
   template <typename... ARGS>
@@ -105,6 +114,11 @@ struct CUBlas<double> {
 #endif
   }
 
+  template <typename... ARGS>
+  static void GEMM_BATCH(ARGS... args) {
+    PADDLE_ENFORCE(platform::dynload::cublasDgemmBatched(args...));
+  }
+
   template <typename... ARGS>
   static void GEMM_EX(ARGS... args) {
     PADDLE_THROW("Currently there are not cublasDgemmEx.");
@@ -152,6 +166,11 @@ struct CUBlas<platform::float16> {
 #endif
   }
 
+  template <typename... ARGS>
+  static void GEMM_BATCH(ARGS... args) {
+    PADDLE_THROW("float16 GEMM_BATCH is not supported on GPU");
+  }
+
   // NOTES: GEMM_EX can use Tensor Core to accelerate matrix multiply.
   // https://docs.nvidia.com/cuda/cublas/index.html#cublassetmathmode
   template <typename... ARGS>
@@ -217,49 +236,139 @@ void Blas<platform::CUDADeviceContext>::GEMM(CBLAS_TRANSPOSE transA,
 #endif  // CUDA_VERSION >= 8000
 }
 
-template <>
-template <>
-inline void Blas<platform::CUDADeviceContext>::GEMM(
-    CBLAS_TRANSPOSE transA, CBLAS_TRANSPOSE transB, int M, int N, int K,
-    platform::float16 alpha, const platform::float16 *A,
-    const platform::float16 *B, platform::float16 beta,
-    platform::float16 *C) const {
-  // Note that cublas follows fortran order, so the order is different from
-  // the cblas convention.
-  int lda = (transA == CblasNoTrans) ? K : M;
-  int ldb = (transB == CblasNoTrans) ? N : K;
-  cublasOperation_t cuTransA =
-      (transA == CblasNoTrans) ? CUBLAS_OP_N : CUBLAS_OP_T;
-  cublasOperation_t cuTransB =
-      (transB == CblasNoTrans) ? CUBLAS_OP_N : CUBLAS_OP_T;
+// The tensor cores are used by the fp16 cublasGemmEx only if m, k and the
+// leading dims are multiples of 8.
+constexpr int kFP16GemmAlignment = 8;
+
+inline int AlignFP16Gemm(int n) {
+  return (n + kFP16GemmAlignment - 1) / kFP16GemmAlignment *
+         kFP16GemmAlignment;
+}
 
+// Copies the row-major [rows, cols] matrix src of the leading dim ld into a
+// temporary [rows_p, cols_p] one whose padding is zero.
+inline memory::allocation::AllocationPtr PadFP16Matrix(
+    const platform::CUDADeviceContext &context, const platform::float16 *src,
+    int rows, int cols, int ld, int rows_p, int cols_p) {
+  size_t bytes = sizeof(platform::float16) * rows_p * cols_p;
+  auto buf =
+      platform::DeviceTemporaryAllocator::Instance().Get(context).Allocate(
+          bytes);
+  if (rows_p != rows || cols_p != cols) {
+    PADDLE_ENFORCE(cudaMemsetAsync(buf->ptr(), 0, bytes, context.stream()));
+  }
+  PADDLE_ENFORCE(cudaMemcpy2DAsync(
+      buf->ptr(), sizeof(platform::float16) * cols_p, src,
+      sizeof(platform::float16) * ld, sizeof(platform::float16) * cols, rows,
+      cudaMemcpyDeviceToDevice, context.stream()));
+  return buf;
+}
+
+// The row-major C = alpha * op(A) * op(B) + beta * C of fp16, which is
+// computed in fp32 by cublasGemmEx. If FLAGS_cublas_fp16_gemm_padding is
+// set and the tensor cores are available, the operands whose K, N or
+// leading dims are not multiples of 8 are zero padded into temporary
+// workspaces, so that the GEMM runs on the tensor cores.
+inline void FP16GEMM(const platform::CUDADeviceContext &context, bool transA,
+                     bool transB, int M, int N, int K, float alpha,
+                     const platform::float16 *A, int lda,
+                     const platform::float16 *B, int ldb, float beta,
+                     platform::float16 *C, int ldc) {
   // TODO(kexinzhao): add processing code for compute capability < 53 case
-  PADDLE_ENFORCE_GE(context_.GetComputeCapability(), 53,
+  PADDLE_ENFORCE_GE(context.GetComputeCapability(), 53,
                     "cublas fp16 gemm requires GPU compute capability >= 53");
-
-  float h_alpha = static_cast<float>(alpha);
-  float h_beta = static_cast<float>(beta);
+  // Note that cublas follows fortran order, so the order is different from
+  // the cblas convention.
+  cublasOperation_t cuTransA = transA ? CUBLAS_OP_T : CUBLAS_OP_N;
+  cublasOperation_t cuTransB = transB ? CUBLAS_OP_T : CUBLAS_OP_N;
 
 #if CUDA_VERSION >= 8000
+  memory::allocation::AllocationPtr a_buf, b_buf, c_buf;
+  platform::float16 *c = C;
+  int ldc_p = ldc;
+  int N_p = N;
+  int K_p = K;
+  if (FLAGS_cublas_fp16_gemm_padding && context.tensor_core_available() &&
+      K > 0) {
+    N_p = AlignFP16Gemm(N);
+    K_p = AlignFP16Gemm(K);
+    // A is [M, K], or [K, M] if transA, and B is [K, N], or [N, K].
+    int a_rows = transA ? K : M;
+    int a_cols = transA ? M : K;
+    int a_rows_p = transA ? K_p : M;
+    int a_cols_p = AlignFP16Gemm(a_cols);
+    if (a_rows_p != a_rows || a_cols_p != a_cols ||
+        lda % kFP16GemmAlignment != 0) {
+      a_buf = PadFP16Matrix(context, A, a_rows, a_cols, lda, a_rows_p,
+                            a_cols_p);
+      A = reinterpret_cast<const platform::float16 *>(a_buf->ptr());
+      lda = a_cols_p;
+    }
+    int b_rows = transB ? N : K;
+    int b_cols = transB ? K : N;
+    int b_rows_p = transB ? N_p : K_p;
+    int b_cols_p = AlignFP16Gemm(b_cols);
+    if (b_rows_p != b_rows || b_cols_p != b_cols ||
+        ldb % kFP16GemmAlignment != 0) {
+      b_buf = PadFP16Matrix(context, B, b_rows, b_cols, ldb, b_rows_p,
+                            b_cols_p);
+      B = reinterpret_cast<const platform::float16 *>(b_buf->ptr());
+      ldb = b_cols_p;
+    }
+    // The padded columns of C are computed into a workspace, which has C
+    // copied in only if it is accumulated.
+    if (N_p != N || ldc % kFP16GemmAlignment != 0) {
+      if (beta != 0) {
+        c_buf = PadFP16Matrix(context, C, M, N, ldc, M, N_p);
+      } else {
+        c_buf = platform::DeviceTemporaryAllocator::Instance()
+                    .Get(context)
+                    .Allocate(sizeof(platform::float16) * M * N_p);
+      }
+      c = reinterpret_cast<platform::float16 *>(c_buf->ptr());
+      ldc_p = N_p;
+    }
+  }
+
   // cublasHgemm does true FP16 computation which is slow for non-Volta
   // GPUs. So use cublasGemmEx instead which does pesudo FP16 computation:
   // input/output in fp16, computation in fp32, which can also be accelerated
   // using tensor cores in volta GPUs.
-  auto &cuda_ctx = const_cast<platform::CUDADeviceContext &>(context_);
+  auto &cuda_ctx = const_cast<platform::CUDADeviceContext &>(context);
   CUBlas<platform::float16>::GEMM_EX(
-      &cuda_ctx, cuTransB, cuTransA, N, M, K, &h_alpha, B, CUDA_R_16F, ldb, A,
-      CUDA_R_16F, lda, &h_beta, C, CUDA_R_16F, N, CUDA_R_32F);
+      &cuda_ctx, cuTransB, cuTransA, N_p, M, K_p, &alpha, B, CUDA_R_16F, ldb,
+      A, CUDA_R_16F, lda, &beta, c, CUDA_R_16F, ldc_p, CUDA_R_32F);
+  if (c != C) {
+    PADDLE_ENFORCE(cudaMemcpy2DAsync(
+        C, sizeof(platform::float16) * ldc, c,
+        sizeof(platform::float16) * ldc_p, sizeof(platform::float16) * N, M,
+        cudaMemcpyDeviceToDevice, context.stream()));
+  }
 #else
   // CUDA 7.5 does not support cublasGemmEx, hence we fall back to use hgemm
-
-  context_.CublasCall([&](cublasHandle_t handle) {
+  platform::float16 h_alpha(alpha);
+  platform::float16 h_beta(beta);
+  context.CublasCall([&](cublasHandle_t handle) {
     CUBlas<platform::float16>::GEMM(handle, cuTransB, cuTransA, N, M, K,
-                                    &h_alpha, h_B, ldb, h_A, lda, &h_beta, h_C,
-                                    N);
+                                    &h_alpha, B, ldb, A, lda, &h_beta, C, ldc);
   });
 #endif  // CUDA_VERSION >= 8000
 }
 
+template <>
+template <>
+inline void Blas<platform::CUDADeviceContext>::GEMM(
+    CBLAS_TRANSPOSE transA, CBLAS_TRANSPOSE transB, int M, int N, int K,
+    platform::float16 alpha, const platform::float16 *A,
+    const platform::float16 *B, platform::float16 beta,
+    platform::float16 *C) const {
+  int lda = (transA == CblasNoTrans) ? K : M;
+  int ldb = (transB == CblasNoTrans) ? N : K;
+  FP16GEMM(context_, transA == CblasTrans, transB == CblasTrans, M, N, K,
+           static_cast<float>(alpha), A, lda, B, ldb, static_cast<float>(beta),
+           C, N);
+}
+
 template <>
 template <typename T>
 void Blas<platform::CUDADeviceContext>::GEMM(bool transA, bool transB, int M,
@@ -296,15 +405,8 @@ inline void Blas<platform::CUDADeviceContext>::GEMM(
     bool transA, bool transB, int M, int N, int K, platform::float16 alpha,
     const platform::float16 *A, int lda, const platform::float16 *B, int ldb,
     platform::float16 beta, platform::float16 *C, int ldc) const {
-  // Note that cublas follows fortran order, so the order is different from
-  // the cblas convention.
-  cublasOperation_t cuTransA = transA ? CUBLAS_OP_T : CUBLAS_OP_N;
-  cublasOperation_t cuTransB = transB ? CUBLAS_OP_T : CUBLAS_OP_N;
-
-  context_.CublasCall([&](cublasHandle_t handle) {
-    CUBlas<platform::float16>::GEMM(handle, cuTransB, cuTransA, N, M, K, &alpha,
-                                    B, ldb, A, lda, &beta, C, ldc);
-  });
+  FP16GEMM(context_, transA, transB, M, N, K, static_cast<float>(alpha), A,
+           lda, B, ldb, static_cast<float>(beta), C, ldc);
 }
 
 template <>
@@ -375,6 +477,110 @@ void Blas<platform::CUDADeviceContext>::BatchedGEMM(
 #endif  // CUDA_VERSION >= 9010
 }
 
+// The batches of fp16 are computed in fp32 by cublasGemmStridedBatchedEx,
+// which uses the tensor cores if they are available.
+template <>
+template <>
+inline void Blas<platform::CUDADeviceContext>::BatchedGEMM(
+    CBLAS_TRANSPOSE transA, CBLAS_TRANSPOSE transB, int M, int N, int K,
+    platform::float16 alpha, const platform::float16 *A,
+    const platform::float16 *B, platform::float16 beta, platform::float16 *C,
+    int batchCount, int64_t strideA, int64_t strideB) const {
+  // Note that cublas follows fortran order, so the order is different from
+  // the cblas convention.
+  int lda = (transA == CblasNoTrans) ? K : M;
+  int ldb = (transB == CblasNoTrans) ? N : K;
+  int ldc = N;
+  cublasOperation_t cuTransA =
+      (transA == CblasNoTrans) ? CUBLAS_OP_N : CUBLAS_OP_T;
+  cublasOperation_t cuTransB =
+      (transB == CblasNoTrans) ? CUBLAS_OP_N : CUBLAS_OP_T;
+  const int64_t strideC = M * N;
+
+#if CUDA_VERSION >= 9010
+  PADDLE_ENFORCE_GE(context_.GetComputeCapability(), 53,
+                    "cublas fp16 gemm requires GPU compute capability >= 53");
+  float f_alpha = static_cast<float>(alpha);
+  float f_beta = static_cast<float>(beta);
+  cublasGemmAlgo_t algo = context_.tensor_core_available()
+                              ? CUBLAS_GEMM_DFALT_TENSOR_OP
+                              : CUBLAS_GEMM_DFALT;
+  context_.TensorCoreCublasCallIfAvailable([&](cublasHandle_t handle) {
+    PADDLE_ENFORCE(platform::dynload::cublasGemmStridedBatchedEx(
+        handle, cuTransB, cuTransA, N, M, K, &f_alpha, B, CUDA_R_16F, ldb,
+        strideB, A, CUDA_R_16F, lda, strideA, &f_beta, C, CUDA_R_16F, ldc,
+        strideC, batchCount, CUDA_R_32F, algo));
+  });
+#else
+  context_.CublasCall([&](cublasHandle_t handle) {
+    CUBlas<platform::float16>::GEMM_STRIDED_BATCH(
+        handle, cuTransB, cuTransA, N, M, K, &alpha, B, ldb, strideB, A, lda,
+        strideA, &beta, C, ldc, strideC, batchCount);
+  });
+#endif  // CUDA_VERSION >= 9010
+}
+
+template <>
+template <typename T>
+void Blas<platform::CUDADeviceContext>::VarLenBatchedGEMM(
+    CBLAS_TRANSPOSE transA, CBLAS_TRANSPOSE transB, const std::vector<int> &M,
+    int N, int K, T alpha, const std::vector<const T *> &A, int lda,
+    const std::vector<const T *> &B, int ldb, T beta,
+    const std::vector<T *> &C, int ldc) const {
+  PADDLE_ENFORCE_EQ(A.size(), M.size());
+  PADDLE_ENFORCE_EQ(B.size(), M.size());
+  PADDLE_ENFORCE_EQ(C.size(), M.size());
+  // cublas<t>gemmBatched only batches the matrices of the same shape, so the
+  // matrices are batched by the number of rows.
+  std::map<int, std::vector<size_t>> groups;
+  for (size_t i = 0; i < M.size(); ++i) {
+    if (M[i] > 0) groups[M[i]].push_back(i);
+  }
+
+  cublasOperation_t cuTransA =
+      (transA == CblasNoTrans) ? CUBLAS_OP_N : CUBLAS_OP_T;
+  cublasOperation_t cuTransB =
+      (transB == CblasNoTrans) ? CUBLAS_OP_N : CUBLAS_OP_T;
+  auto place = boost::get<platform::CUDAPlace>(context_.GetPlace());
+  for (auto &group : groups) {
+    int m = group.first;
+    auto &ids = group.second;
+    if (ids.size() == 1 || std::is_same<T, platform::float16>::value) {
+      for (auto i : ids) {
+        this->template GEMM<T>(transA == CblasTrans, transB == CblasTrans, m,
+                               N, K, alpha, A[i], lda, B[i], ldb, beta, C[i],
+                               ldc);
+      }
+      continue;
+    }
+
+    int batch_count = static_cast<int>(ids.size());
+    std::vector<const void *> ptrs(3 * batch_count);
+    for (int j = 0; j < batch_count; ++j) {
+      ptrs[j] = A[ids[j]];
+      ptrs[batch_count + j] = B[ids[j]];
+      ptrs[2 * batch_count + j] = C[ids[j]];
+    }
+    size_t bytes = ptrs.size() * sizeof(void *);
+    auto ptrs_buf =
+        platform::DeviceTemporaryAllocator::Instance().Get(context_).Allocate(
+            bytes);
+    memory::Copy(place, ptrs_buf->ptr(), platform::CPUPlace(), ptrs.data(),
+                 bytes, context_.stream());
+    auto *a_array = reinterpret_cast<const T **>(ptrs_buf->ptr());
+    auto *b_array = a_array + batch_count;
+    auto *c_array = reinterpret_cast<T **>(a_array + 2 * batch_count);
+
+    // Note that cublas follows fortran order, so the order is different from
+    // the cblas convention.
+    context_.CublasCall([&](cublasHandle_t handle) {
+      CUBlas<T>::GEMM_BATCH(handle, cuTransB, cuTransA, N, m, K, &alpha,
+                            b_array, ldb, a_array, lda, &beta, c_array, ldc,
+                            batch_count);
+    });
+  }
+}
+
 }  // namespace math
 }  // namespace operators
 }  // namespace paddle
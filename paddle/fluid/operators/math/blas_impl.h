@@ -12,10 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #pragma once
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <vector>
+#include "paddle/fluid/framework/compute_pool.h"
 #include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/operators/math/neon_sgemm.h"
 
 namespace paddle {
 namespace operators {
@@ -229,10 +232,22 @@ struct CBlas<double> {
 
 template <>
 struct CBlas<float> {
+#if defined(PADDLE_WITH_NEON) && !defined(PADDLE_USE_OPENBLAS)
+  static void GEMM(CBLAS_ORDER order, CBLAS_TRANSPOSE transA,
+                   CBLAS_TRANSPOSE transB, int M, int N, int K, float alpha,
+                   const float *A, int lda, const float *B, int ldb,
+                   float beta, float *C, int ldc) {
+    PADDLE_ENFORCE(order == CblasRowMajor,
+                   "The NEON sgemm supports only the row major matrices.");
+    NeonSgemm(transA != CblasNoTrans, transB != CblasNoTrans, M, N, K, alpha,
+              A, lda, B, ldb, beta, C, ldc);
+  }
+#else
   template <typename... ARGS>
   static void GEMM(ARGS... args) {
     cblas_sgemm(args...);
   }
+#endif
 
   template <typename... ARGS>
   static void AXPY(ARGS... args) {
@@ -296,6 +311,24 @@ struct CBlas<platform::float16> {
 #endif
 };
 
+// The rows of C are split on the ComputePool when the current thread shares
+// it, each block of the rows is at least kMinBlockMACs multiply-adds.
+template <typename T>
+inline void ParallelGEMM(CBLAS_TRANSPOSE transA, CBLAS_TRANSPOSE transB,
+                         int M, int N, int K, T alpha, const T *A, int lda,
+                         const T *B, int ldb, T beta, T *C, int ldc) {
+  constexpr int64_t kMinBlockMACs = 1 << 20;
+  int64_t row_macs = std::max<int64_t>(static_cast<int64_t>(N) * K, 1);
+  framework::ParallelFor(
+      M, std::max<int64_t>(kMinBlockMACs / row_macs, 1),
+      [&](int64_t begin, int64_t end) {
+        const T *a = transA == CblasNoTrans ? A + begin * lda : A + begin;
+        CBlas<T>::GEMM(CblasRowMajor, transA, transB,
+                       static_cast<int>(end - begin), N, K, alpha, a, lda, B,
+                       ldb, beta, C + begin * ldc, ldc);
+      });
+}
+
 #ifdef PADDLE_WITH_MKLML
 template <>
 template <typename T>
@@ -340,8 +373,7 @@ void Blas<platform::CPUDeviceContext>::GEMM(CBLAS_TRANSPOSE transA,
   int lda = (transA == CblasNoTrans) ? K : M;
   int ldb = (transB == CblasNoTrans) ? N : K;
   int ldc = N;
-  CBlas<T>::GEMM(CblasRowMajor, transA, transB, M, N, K, alpha, A, lda, B, ldb,
-                 beta, C, ldc);
+  ParallelGEMM(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
 }
 
 template <>
@@ -350,9 +382,9 @@ void Blas<platform::CPUDeviceContext>::GEMM(bool transA, bool transB, int M,
                                             int N, int K, T alpha, const T *A,
                                             int lda, const T *B, int ldb,
                                             T beta, T *C, int ldc) const {
-  CBlas<T>::GEMM(CblasRowMajor, transA == false ? CblasNoTrans : CblasTrans,
-                 transB == false ? CblasNoTrans : CblasTrans, M, N, K, alpha, A,
-                 lda, B, ldb, beta, C, ldc);
+  ParallelGEMM(transA == false ? CblasNoTrans : CblasTrans,
+               transB == false ? CblasNoTrans : CblasTrans, M, N, K, alpha, A,
+               lda, B, ldb, beta, C, ldc);
 }
 
 template <>
@@ -362,8 +394,7 @@ void Blas<platform::CPUDeviceContext>::GEMM(CBLAS_TRANSPOSE transA,
                                             int N, int K, T alpha, const T *A,
                                             int lda, const T *B, int ldb,
                                             T beta, T *C, int ldc) const {
-  CBlas<T>::GEMM(CblasRowMajor, transA, transB, M, N, K, alpha, A, lda, B, ldb,
-                 beta, C, ldc);
+  ParallelGEMM(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
 }
 
 template <typename DeviceContext>
@@ -553,6 +584,58 @@ void Blas<platform::CPUDeviceContext>::BatchedGEMM(
 #endif
 }
 
+template <>
+template <typename T>
+void Blas<platform::CPUDeviceContext>::VarLenBatchedGEMM(
+    CBLAS_TRANSPOSE transA, CBLAS_TRANSPOSE transB, const std::vector<int> &M,
+    int N, int K, T alpha, const std::vector<const T *> &A, int lda,
+    const std::vector<const T *> &B, int ldb, T beta,
+    const std::vector<T *> &C, int ldc) const {
+  PADDLE_ENFORCE_EQ(A.size(), M.size());
+  PADDLE_ENFORCE_EQ(B.size(), M.size());
+  PADDLE_ENFORCE_EQ(C.size(), M.size());
+#ifdef PADDLE_WITH_MKLML
+  // Every matrix is a group of its own size in cblas_?gemm_batch.
+  std::vector<int> m_array;
+  std::vector<const T *> a_array;
+  std::vector<const T *> b_array;
+  std::vector<T *> c_array;
+  for (size_t i = 0; i < M.size(); ++i) {
+    if (M[i] <= 0) continue;
+    m_array.push_back(M[i]);
+    a_array.push_back(A[i]);
+    b_array.push_back(B[i]);
+    c_array.push_back(C[i]);
+  }
+  int group_count = static_cast<int>(m_array.size());
+  if (group_count == 0) return;
+  std::vector<CBLAS_TRANSPOSE> trans_a(group_count, transA);
+  std::vector<CBLAS_TRANSPOSE> trans_b(group_count, transB);
+  std::vector<int> n_array(group_count, N);
+  std::vector<int> k_array(group_count, K);
+  std::vector<int> lda_array(group_count, lda);
+  std::vector<int> ldb_array(group_count, ldb);
+  std::vector<int> ldc_array(group_count, ldc);
+  std::vector<int> group_size(group_count, 1);
+  std::vector<T> alpha_array(group_count, alpha);
+  std::vector<T> beta_array(group_count, beta);
+
+  CBlas<T>::GEMM_BATCH(CblasRowMajor, trans_a.data(), trans_b.data(),
+                       m_array.data(), n_array.data(), k_array.data(),
+                       alpha_array.data(), a_array.data(), lda_array.data(),
+                       b_array.data(), ldb_array.data(), beta_array.data(),
+                       c_array.data(), ldc_array.data(), group_count,
+                       group_size.data());
+#else
+  for (size_t i = 0; i < M.size(); ++i) {
+    if (M[i] <= 0) continue;
+    this->template GEMM<T>(transA == CblasTrans, transB == CblasTrans, M[i],
+                           N, K, alpha, A[i], lda, B[i], ldb, beta, C[i],
+                           ldc);
+  }
+#endif
+}
+
 template <typename DeviceContext>
 template <typename T>
 void Blas<DeviceContext>::MatMul(const int M, const int N, const int K,
@@ -585,8 +668,8 @@ void Blas<platform::CPUDeviceContext>::MatMul(const int M, const int N,
   return;
 #endif
 
-  CBlas<T>::GEMM(CblasRowMajor, CblasNoTrans, CblasNoTrans, M, N, K,
-                 static_cast<T>(1), A, K, B, N, static_cast<T>(0), C, N);
+  ParallelGEMM(CblasNoTrans, CblasNoTrans, M, N, K, static_cast<T>(1), A, K, B,
+               N, static_cast<T>(0), C, N);
 }
 
 template <typename DeviceContext>
@@ -18,13 +18,14 @@ limitations under the License. */
 #include "paddle/fluid/operators/math/concat_and_split.h"
 #include "paddle/fluid/platform/cuda_primitives.h"
 #include "paddle/fluid/platform/float16.h"
+#include "paddle/fluid/platform/hostdevice.h"
 
 namespace paddle {
 namespace operators {
 namespace math {
 
-template <typename T>
-__global__ void ConcatKernel(T** inputs, const int* input_cols, int col_size,
+template <typename T, typename PtrsT, typename ColsT>
+__global__ void ConcatKernel(PtrsT inputs, ColsT input_cols, int col_size,
                              const int output_rows, const int output_cols,
                              T* output) {
   int tid_x = blockIdx.x * blockDim.x + threadIdx.x;
@@ -49,8 +50,8 @@ __global__ void ConcatKernel(T** inputs, const int* input_cols, int col_size,
   }
 }
 
-template <typename T>
-__global__ void ConcatKernel(T** inputs_data, const int fixed_in_col,
+template <typename T, typename PtrsT>
+__global__ void ConcatKernel(PtrsT inputs_data, const int fixed_in_col,
                              const int out_rows, const int out_cols,
                              T* output_data) {
   int tid_x = blockIdx.x * blockDim.x + threadIdx.x;
@@ -66,10 +67,10 @@ __global__ void ConcatKernel(T** inputs_data, const int fixed_in_col,
   }
 }
 
-template <typename T>
+template <typename T, typename PtrsT, typename ColsT>
 __global__ void SplitKernel(const T* input_data, const int in_row,
-                            const int in_col, const int* out_cols,
-                            int out_cols_size, T** outputs_data) {
+                            const int in_col, ColsT out_cols,
+                            int out_cols_size, PtrsT outputs_data) {
   int tid_x = blockIdx.x * blockDim.x + threadIdx.x;
   int curr_segment = 0;
   int curr_offset = out_cols[0];
@@ -93,10 +94,10 @@ __global__ void SplitKernel(const T* input_data, const int in_row,
   }
 }
 
-template <typename T>
+template <typename T, typename PtrsT>
 __global__ void SplitKernel(const T* input_data, const int in_row,
                             const int in_col, const int fixed_out_col,
-                            T** outputs_data) {
+                            PtrsT outputs_data) {
   int tid_x = blockIdx.x * blockDim.x + threadIdx.x;
   for (; tid_x < in_col; tid_x += blockDim.x * gridDim.x) {
     int split = tid_x / fixed_out_col;
@@ -111,6 +112,59 @@ __global__ void SplitKernel(const T* input_data, const int in_row,
   }
 }
 
+// The pointers (or the column offsets) of at most Size tensors passed to the
+// kernels by value, so that no pointer table is copied to the device.
+template <typename T, int Size>
+struct ArgArray {
+  T data[Size];
+  HOSTDEVICE inline const T& operator[](int i) const { return data[i]; }
+};
+
+// The max number of the tensors whose pointers are passed by value.
+static constexpr int kMaxArgTensors = 64;
+
+template <typename T, int Size>
+static void ConcatByArgs(const platform::CUDADeviceContext& context,
+                         dim3 grid_size, dim3 block_size,
+                         const std::vector<const T*>& inputs_data,
+                         const std::vector<int>& inputs_col, bool same_shape,
+                         int in_col, int out_row, int out_col, T* output) {
+  ArgArray<T*, Size> ins;
+  for (size_t i = 0; i < inputs_data.size(); ++i) {
+    ins.data[i] = const_cast<T*>(inputs_data[i]);
+  }
+  if (same_shape) {
+    ConcatKernel<<<grid_size, block_size, 0, context.stream()>>>(
+        ins, in_col, out_row, out_col, output);
+  } else {
+    ArgArray<int, Size + 1> cols;
+    std::copy(inputs_col.begin(), inputs_col.end(), cols.data);
+    ConcatKernel<<<grid_size, block_size, 0, context.stream()>>>(
+        ins, cols, static_cast<int>(inputs_col.size()), out_row, out_col,
+        output);
+  }
+}
+
+template <typename T, int Size>
+static void SplitByArgs(const platform::CUDADeviceContext& context,
+                        dim3 grid_size, dim3 block_size, const T* input,
+                        const std::vector<T*>& outputs_data,
+                        const std::vector<int>& outputs_cols, bool same_shape,
+                        int in_row, int in_col, int out0_col) {
+  ArgArray<T*, Size> outs;
+  std::copy(outputs_data.begin(), outputs_data.end(), outs.data);
+  if (same_shape) {
+    SplitKernel<<<grid_size, block_size, 0, context.stream()>>>(
+        input, in_row, in_col, out0_col, outs);
+  } else {
+    ArgArray<int, Size + 1> cols;
+    std::copy(outputs_cols.begin(), outputs_cols.end(), cols.data);
+    SplitKernel<<<grid_size, block_size, 0, context.stream()>>>(
+        input, in_row, in_col, cols, static_cast<int>(outputs_cols.size()),
+        outs);
+  }
+}
+
 /*
  * All tensors' dimension should be the same and the values of
  * each dimension must be the same, except the axis dimension.
@@ -166,6 +220,19 @@ class ConcatFunctor<platform::CUDADeviceContext, T> {
         std::min(max_blocks / grid_cols, std::max(out_row / block_rows, 1));
     dim3 grid_size = dim3(grid_cols, grid_rows, 1);
 
+    if (in_num <= 8) {
+      ConcatByArgs<T, 8>(context, grid_size, block_size, inputs_data,
+                         inputs_col, sameShape, in_col, out_row, out_col,
+                         output->data<T>());
+      return;
+    } else if (in_num <= kMaxArgTensors) {
+      ConcatByArgs<T, kMaxArgTensors>(context, grid_size, block_size,
+                                      inputs_data, inputs_col, sameShape,
+                                      in_col, out_row, out_col,
+                                      output->data<T>());
+      return;
+    }
+
     auto tmp_dev_ins_data =
         platform::DeviceTemporaryAllocator::Instance().Get(context).Allocate(
             inputs_data.size() * sizeof(T*));
@@ -254,6 +321,19 @@ class SplitFunctor<platform::CUDADeviceContext, T> {
         std::min(max_blocks / grid_cols, std::max(out_row / block_rows, 1));
     dim3 grid_size = dim3(grid_cols, grid_rows, 1);
 
+    if (o_num <= 8) {
+      SplitByArgs<T, 8>(context, grid_size, block_size, input.data<T>(),
+                        outputs_data, outputs_cols, sameShape, in_row, in_col,
+                        out0_col);
+      return;
+    } else if (o_num <= kMaxArgTensors) {
+      SplitByArgs<T, kMaxArgTensors>(context, grid_size, block_size,
+                                     input.data<T>(), outputs_data,
+                                     outputs_cols, sameShape, in_row, in_col,
+                                     out0_col);
+      return;
+    }
+
     auto tmp_dev_outs_data =
         platform::DeviceTemporaryAllocator::Instance().Get(context).Allocate(
             outputs_data.size() * sizeof(T*));
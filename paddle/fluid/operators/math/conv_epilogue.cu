@@ -0,0 +1,63 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include "paddle/fluid/operators/math/conv_epilogue.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+using platform::PADDLE_CUDA_NUM_THREADS;
+
+template <typename T>
+__global__ void ConvEpilogueKernel(const ConvEpilogue<T> epilogue,
+                                   const int channels, const int spatial_size,
+                                   const int numel, T* output) {
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < numel;
+       i += blockDim.x * gridDim.x) {
+    output[i] = epilogue(output[i], (i / spatial_size) % channels, i);
+  }
+}
+
+template <typename T>
+class ConvEpilogueFunctor<platform::CUDADeviceContext, T> {
+ public:
+  void operator()(const platform::CUDADeviceContext& context,
+                  const ConvEpilogue<T>& epilogue, framework::Tensor* output) {
+    auto dims = output->dims();
+    PADDLE_ENFORCE_EQ(dims.size(), 4, "The output should be in NCHW");
+    int numel = static_cast<int>(output->numel());
+    if (numel == 0) return;
+    int channels = static_cast<int>(dims[1]);
+    int spatial_size = static_cast<int>(dims[2] * dims[3]);
+    int blocks = std::min(
+        (numel + PADDLE_CUDA_NUM_THREADS - 1) / PADDLE_CUDA_NUM_THREADS,
+        context.GetMaxPhysicalThreadCount() / PADDLE_CUDA_NUM_THREADS);
+    ConvEpilogueKernel<T><<<std::max(blocks, 1), PADDLE_CUDA_NUM_THREADS, 0,
+                            context.stream()>>>(
+        epilogue, channels, spatial_size, numel,
+        output->mutable_data<T>(context.GetPlace()));
+  }
+};
+
+template class ConvEpilogueFunctor<platform::CUDADeviceContext, float>;
+template class ConvEpilogueFunctor<platform::CUDADeviceContext, double>;
+template class ConvEpilogueFunctor<platform::CUDADeviceContext,
+                                   platform::float16>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,116 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <cmath>
+#include <string>
+#include <type_traits>
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/float16.h"
+#include "paddle/fluid/platform/hostdevice.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+enum class ConvActivation {
+  kIdentity = 0,
+  kRelu,
+  kRelu6,
+  kLeakyRelu,
+  kSigmoid,
+  kTanh,
+};
+
+inline ConvActivation GetConvActivation(const std::string& type) {
+  if (type == "identity") {
+    return ConvActivation::kIdentity;
+  } else if (type == "relu") {
+    return ConvActivation::kRelu;
+  } else if (type == "relu6") {
+    return ConvActivation::kRelu6;
+  } else if (type == "leaky_relu") {
+    return ConvActivation::kLeakyRelu;
+  } else if (type == "sigmoid") {
+    return ConvActivation::kSigmoid;
+  } else if (type == "tanh") {
+    return ConvActivation::kTanh;
+  }
+  PADDLE_THROW("The activation %s is not supported by the fused conv", type);
+}
+
+/*
+ * The epilogue of the fused convolutions, which computes
+ *   output = act(conv + bias + residual)
+ * on the result of the convolution, where the bias is of the output channels
+ * and the residual is of the shape of the output. Both of them are optional.
+ * The float16 values are computed in float.
+ */
+template <typename T>
+struct ConvEpilogue {
+  using ComputeType =
+      typename std::conditional<std::is_same<T, platform::float16>::value,
+                                float, T>::type;
+
+  const T* bias{nullptr};
+  const T* residual{nullptr};
+  ConvActivation act{ConvActivation::kIdentity};
+  // The slope of leaky_relu, or the threshold of relu6.
+  float alpha{0.f};
+
+  HOSTDEVICE inline T operator()(T value, int channel, int index) const {
+    ComputeType x = static_cast<ComputeType>(value);
+    if (bias != nullptr) x += static_cast<ComputeType>(bias[channel]);
+    if (residual != nullptr) x += static_cast<ComputeType>(residual[index]);
+    ComputeType zero = static_cast<ComputeType>(0);
+    ComputeType one = static_cast<ComputeType>(1);
+    switch (act) {
+      case ConvActivation::kRelu:
+        x = x > zero ? x : zero;
+        break;
+      case ConvActivation::kRelu6:
+        x = x > zero ? (x < alpha ? x : static_cast<ComputeType>(alpha)) : zero;
+        break;
+      case ConvActivation::kLeakyRelu:
+        x = x > zero ? x : static_cast<ComputeType>(alpha) * x;
+        break;
+      case ConvActivation::kSigmoid:
+        x = one / (one + exp(-x));
+        break;
+      case ConvActivation::kTanh:
+        x = tanh(x);
+        break;
+      default:
+        break;
+    }
+    return static_cast<T>(x);
+  }
+};
+
+/*
+ * \brief Apply the epilogue to the output of a convolution in NCHW in place,
+ * in a single pass over the output.
+ */
+template <typename DeviceContext, typename T>
+class ConvEpilogueFunctor {
+ public:
+  void operator()(const DeviceContext& context, const ConvEpilogue<T>& epilogue,
+                  framework::Tensor* output);
+};
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,184 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/ctc_loss.h"
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include "paddle/fluid/framework/compute_pool.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+void CTCStates(const framework::Vector<size_t>& logits_lod,
+               const framework::Vector<size_t>& label_lod, const int* labels,
+               framework::Vector<int64_t>* state_offsets,
+               framework::Vector<int>* first_same_label,
+               framework::Vector<int>* next_same_label) {
+  size_t num_seq = logits_lod.size() - 1;
+  state_offsets->resize(num_seq + 1);
+  (*state_offsets)[0] = 0;
+  size_t num_labels = label_lod[num_seq];
+  first_same_label->resize(num_labels);
+  next_same_label->resize(num_labels);
+  std::unordered_map<int, int> last;
+  for (size_t i = 0; i < num_seq; ++i) {
+    int64_t length = logits_lod[i + 1] - logits_lod[i];
+    int64_t label_length = label_lod[i + 1] - label_lod[i];
+    (*state_offsets)[i + 1] =
+        (*state_offsets)[i] + (2 * label_length + 1) * length;
+    last.clear();
+    for (size_t j = label_lod[i]; j < label_lod[i + 1]; ++j) {
+      (*next_same_label)[j] = -1;
+      auto it = last.find(labels[j]);
+      if (it == last.end()) {
+        (*first_same_label)[j] = j;
+      } else {
+        (*first_same_label)[j] = (*first_same_label)[it->second];
+        (*next_same_label)[it->second] = j;
+      }
+      last[labels[j]] = j;
+    }
+  }
+}
+
+template <typename T>
+class CTCLossFunctor<platform::CPUDeviceContext, T> {
+ public:
+  void operator()(const platform::CPUDeviceContext& context,
+                  const framework::Tensor& logits,
+                  const framework::Vector<size_t>& logits_lod,
+                  const framework::Tensor& labels,
+                  const framework::Vector<size_t>& label_lod, int blank,
+                  bool norm_by_times, framework::Tensor* loss,
+                  framework::Tensor* gradient) {
+    int64_t num_seq = logits_lod.size() - 1;
+    int64_t width = logits.numel() / std::max<int64_t>(logits.dims()[0], 1);
+    const T* x = logits.data<T>();
+    const int* label = labels.data<int>();
+    T* loss_data = loss->mutable_data<T>(
+        framework::make_ddim({num_seq, 1}), platform::CPUPlace());
+    T* grad = gradient ? gradient->mutable_data<T>(logits.dims(),
+                                                   platform::CPUPlace())
+                       : nullptr;
+    framework::ParallelFor(0, num_seq, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        loss_data[i] = Sequence(x + logits_lod[i] * width,
+                                logits_lod[i + 1] - logits_lod[i], width,
+                                label + label_lod[i],
+                                label_lod[i + 1] - label_lod[i], blank,
+                                norm_by_times,
+                                grad ? grad + logits_lod[i] * width : nullptr);
+      }
+    });
+  }
+
+ private:
+  // The loss of a sequence x [length, width], and the gradient of it.
+  static T Sequence(const T* x, int64_t length, int64_t width,
+                    const int* label, int64_t label_length, int blank,
+                    bool norm_by_times, T* grad) {
+    const T kLogZero = -std::numeric_limits<T>::infinity();
+    if (length == 0) return 0;
+    int64_t num_states = 2 * label_length + 1;
+    auto state_label = [&](int64_t s) {
+      return s % 2 == 0 ? blank : label[(s - 1) / 2];
+    };
+    // The log softmax of the rows is x - lse.
+    std::vector<T> lse(length);
+    for (int64_t t = 0; t < length; ++t) {
+      const T* row = x + t * width;
+      T max = *std::max_element(row, row + width);
+      T sum = 0;
+      for (int64_t k = 0; k < width; ++k) sum += std::exp(row[k] - max);
+      lse[t] = max + std::log(sum);
+    }
+    auto log_prob = [&](int64_t t, int k) { return x[t * width + k] - lse[t]; };
+
+    std::vector<T> alpha(length * num_states, kLogZero);
+    std::vector<T> beta(length * num_states, kLogZero);
+    alpha[0] = log_prob(0, blank);
+    if (num_states > 1) alpha[1] = log_prob(0, state_label(1));
+    for (int64_t t = 1; t < length; ++t) {
+      const T* prev = &alpha[(t - 1) * num_states];
+      T* cur = &alpha[t * num_states];
+      for (int64_t s = 0; s < num_states; ++s) {
+        int l = state_label(s);
+        T a = prev[s];
+        if (s >= 1) a = LogAdd(a, prev[s - 1]);
+        if (s >= 2 && l != blank && l != state_label(s - 2)) {
+          a = LogAdd(a, prev[s - 2]);
+        }
+        cur[s] = a == kLogZero ? kLogZero : a + log_prob(t, l);
+      }
+    }
+    const T* last_alpha = &alpha[(length - 1) * num_states];
+    T log_p = last_alpha[num_states - 1];
+    if (num_states > 1) log_p = LogAdd(log_p, last_alpha[num_states - 2]);
+    if (log_p == kLogZero) {
+      if (grad) std::fill(grad, grad + length * width, static_cast<T>(0));
+      return 0;
+    }
+    if (grad == nullptr) return -log_p;
+
+    T* last_beta = &beta[(length - 1) * num_states];
+    last_beta[num_states - 1] = log_prob(length - 1, blank);
+    if (num_states > 1) {
+      last_beta[num_states - 2] =
+          log_prob(length - 1, state_label(num_states - 2));
+    }
+    for (int64_t t = length - 2; t >= 0; --t) {
+      const T* next = &beta[(t + 1) * num_states];
+      T* cur = &beta[t * num_states];
+      for (int64_t s = 0; s < num_states; ++s) {
+        int l = state_label(s);
+        T b = next[s];
+        if (s + 1 < num_states) b = LogAdd(b, next[s + 1]);
+        if (s + 2 < num_states && l != blank && l != state_label(s + 2)) {
+          b = LogAdd(b, next[s + 2]);
+        }
+        cur[s] = b == kLogZero ? kLogZero : b + log_prob(t, l);
+      }
+    }
+
+    // grad = softmax - sum(alpha * beta over the states of k) / (y * p).
+    T scale = norm_by_times ? static_cast<T>(1) / length : static_cast<T>(1);
+    std::vector<T> state_sum(width, kLogZero);
+    for (int64_t t = 0; t < length; ++t) {
+      const T* a = &alpha[t * num_states];
+      const T* b = &beta[t * num_states];
+      for (int64_t s = 0; s < num_states; ++s) {
+        int l = state_label(s);
+        state_sum[l] = LogAdd(state_sum[l], a[s] + b[s]);
+      }
+      T* g = grad + t * width;
+      for (int64_t k = 0; k < width; ++k) {
+        T lp = log_prob(t, k);
+        g[k] = (std::exp(lp) - std::exp(state_sum[k] - lp - log_p)) * scale;
+      }
+      for (int64_t s = 0; s < num_states; ++s) {
+        state_sum[state_label(s)] = kLogZero;
+      }
+    }
+    return -log_p;
+  }
+};
+
+template class CTCLossFunctor<platform::CPUDeviceContext, float>;
+template class CTCLossFunctor<platform::CPUDeviceContext, double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
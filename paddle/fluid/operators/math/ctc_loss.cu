@@ -0,0 +1,283 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <thrust/binary_search.h>
+#include <thrust/execution_policy.h>
+#include <cub/cub.cuh>  // NOLINT
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/operators/math/ctc_loss.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+constexpr int kCTCBlockDim = 256;
+
+template <typename T>
+struct CTCLogAddOp {
+  __device__ __forceinline__ T operator()(const T& a, const T& b) const {
+    return LogAdd(a, b);
+  }
+};
+
+template <typename T>
+struct CTCMaxOp {
+  __device__ __forceinline__ T operator()(const T& a, const T& b) const {
+    return a < b ? b : a;
+  }
+};
+
+// The log of the sum of the exp of every row of x [rows, width].
+template <typename T, int BlockDim>
+__global__ void KeRowLogSumExp(const T* x, int64_t rows, int64_t width,
+                               T* lse) {
+  using BlockReduce = cub::BlockReduce<T, BlockDim>;
+  __shared__ typename BlockReduce::TempStorage storage;
+  __shared__ T row_max;
+  for (int64_t r = blockIdx.x; r < rows; r += gridDim.x) {
+    const T* row = x + r * width;
+    T max = static_cast<T>(-INFINITY);
+    for (int64_t k = threadIdx.x; k < width; k += BlockDim) {
+      max = row[k] > max ? row[k] : max;
+    }
+    max = BlockReduce(storage).Reduce(max, CTCMaxOp<T>());
+    if (threadIdx.x == 0) row_max = max;
+    __syncthreads();
+    T sum = 0;
+    for (int64_t k = threadIdx.x; k < width; k += BlockDim) {
+      sum += exp(row[k] - row_max);
+    }
+    sum = BlockReduce(storage).Sum(sum);
+    if (threadIdx.x == 0) lse[r] = row_max + log(sum);
+    __syncthreads();
+  }
+}
+
+template <typename T>
+__device__ __forceinline__ T LogProb(const T* x, const T* lse, int64_t width,
+                                     int64_t row, int k) {
+  return x[row * width + k] - lse[row];
+}
+
+// Every block computes the alpha and beta of a sequence, a time step after
+// another, and the loss of it.
+template <typename T, int BlockDim>
+__global__ void KeCTCAlphaBeta(const T* x, const T* lse, int64_t width,
+                               const size_t* seq_offsets,
+                               const int* labels, const size_t* label_offsets,
+                               int blank, const int64_t* state_offsets,
+                               T* alpha, T* beta, T* loss) {
+  const T kLogZero = static_cast<T>(-INFINITY);
+  int64_t i = blockIdx.x;
+  int64_t begin = seq_offsets[i];
+  int64_t length = seq_offsets[i + 1] - begin;
+  const int* label = labels + label_offsets[i];
+  int64_t num_states = 2 * (label_offsets[i + 1] - label_offsets[i]) + 1;
+  if (length == 0) {
+    if (threadIdx.x == 0) loss[i] = 0;
+    return;
+  }
+  T* a = alpha + state_offsets[i];
+  T* b = beta + state_offsets[i];
+  auto state_label = [&](int64_t s) {
+    return s % 2 == 0 ? blank : label[(s - 1) / 2];
+  };
+
+  for (int64_t s = threadIdx.x; s < num_states; s += BlockDim) {
+    a[s] = s < 2 ? LogProb(x, lse, width, begin, state_label(s)) : kLogZero;
+  }
+  __syncthreads();
+  for (int64_t t = 1; t < length; ++t) {
+    const T* prev = a + (t - 1) * num_states;
+    T* cur = a + t * num_states;
+    for (int64_t s = threadIdx.x; s < num_states; s += BlockDim) {
+      int l = state_label(s);
+      T v = prev[s];
+      if (s >= 1) v = LogAdd(v, prev[s - 1]);
+      if (s >= 2 && l != blank && l != state_label(s - 2)) {
+        v = LogAdd(v, prev[s - 2]);
+      }
+      cur[s] = v == kLogZero ? kLogZero
+                             : v + LogProb(x, lse, width, begin + t, l);
+    }
+    __syncthreads();
+  }
+
+  T* last = b + (length - 1) * num_states;
+  for (int64_t s = threadIdx.x; s < num_states; s += BlockDim) {
+    last[s] = s + 2 >= num_states
+                  ? LogProb(x, lse, width, begin + length - 1, state_label(s))
+                  : kLogZero;
+  }
+  __syncthreads();
+  for (int64_t t = length - 2; t >= 0; --t) {
+    const T* next = b + (t + 1) * num_states;
+    T* cur = b + t * num_states;
+    for (int64_t s = threadIdx.x; s < num_states; s += BlockDim) {
+      int l = state_label(s);
+      T v = next[s];
+      if (s + 1 < num_states) v = LogAdd(v, next[s + 1]);
+      if (s + 2 < num_states && l != blank && l != state_label(s + 2)) {
+        v = LogAdd(v, next[s + 2]);
+      }
+      cur[s] = v == kLogZero ? kLogZero
+                             : v + LogProb(x, lse, width, begin + t, l);
+    }
+    __syncthreads();
+  }
+
+  if (threadIdx.x == 0) {
+    const T* end = a + (length - 1) * num_states;
+    T log_p = end[num_states - 1];
+    if (num_states > 1) log_p = LogAdd(log_p, end[num_states - 2]);
+    // The infeasible sequences have the loss of 0, as in warp-ctc.
+    loss[i] = log_p == kLogZero ? 0 : -log_p;
+  }
+}
+
+// Every block computes the gradient of a row of the logits, the softmax
+// minus the sum of alpha * beta of the states of every label over p * y.
+// The states of a label of the same value are summed by the thread of the
+// first of them, and those of the blank by the block.
+template <typename T, int BlockDim>
+__global__ void KeCTCGrad(const T* x, const T* lse, int64_t rows,
+                          int64_t width, const size_t* seq_offsets,
+                          int num_seq, const int* labels,
+                          const size_t* label_offsets,
+                          const int* first_same_label,
+                          const int* next_same_label, int blank,
+                          const int64_t* state_offsets, const T* alpha,
+                          const T* beta, bool norm_by_times, T* grad) {
+  using BlockReduce = cub::BlockReduce<T, BlockDim>;
+  __shared__ typename BlockReduce::TempStorage storage;
+  for (int64_t r = blockIdx.x; r < rows; r += gridDim.x) {
+    int i = static_cast<int>(
+        thrust::upper_bound(thrust::seq, seq_offsets, seq_offsets + num_seq,
+                            static_cast<size_t>(r)) -
+        seq_offsets - 1);
+    int64_t t = r - seq_offsets[i];
+    int64_t length = seq_offsets[i + 1] - seq_offsets[i];
+    T* g = grad + r * width;
+    int64_t label_begin = label_offsets[i];
+    int64_t num_labels = label_offsets[i + 1] - label_begin;
+    int64_t num_states = 2 * num_labels + 1;
+    const T* a = alpha + state_offsets[i] + t * num_states;
+    const T* b = beta + state_offsets[i] + t * num_states;
+    // log p(label) is that of the last two states at the end.
+    const T* end = alpha + state_offsets[i] + (length - 1) * num_states;
+    T log_p = end[num_states - 1];
+    if (num_states > 1) log_p = LogAdd(log_p, end[num_states - 2]);
+    if (log_p == static_cast<T>(-INFINITY)) {
+      for (int64_t k = threadIdx.x; k < width; k += BlockDim) g[k] = 0;
+      continue;
+    }
+    T scale = norm_by_times ? static_cast<T>(1) / length : static_cast<T>(1);
+
+    for (int64_t k = threadIdx.x; k < width; k += BlockDim) {
+      g[k] = exp(LogProb(x, lse, width, r, k)) * scale;
+    }
+    __syncthreads();
+
+    T blank_sum = static_cast<T>(-INFINITY);
+    for (int64_t s = 2 * threadIdx.x; s < num_states; s += 2 * BlockDim) {
+      blank_sum = LogAdd(blank_sum, a[s] + b[s]);
+    }
+    blank_sum = BlockReduce(storage).Reduce(blank_sum, CTCLogAddOp<T>());
+    if (threadIdx.x == 0) {
+      T lp = LogProb(x, lse, width, r, blank);
+      g[blank] -= exp(blank_sum - lp - log_p) * scale;
+    }
+    for (int64_t j = threadIdx.x; j < num_labels; j += BlockDim) {
+      int first = first_same_label[label_begin + j];
+      if (first != label_begin + j) continue;
+      T sum = static_cast<T>(-INFINITY);
+      for (int n = first; n >= 0; n = next_same_label[n]) {
+        int64_t s = 2 * (n - label_begin) + 1;
+        sum = LogAdd(sum, a[s] + b[s]);
+      }
+      int l = labels[first];
+      T lp = LogProb(x, lse, width, r, l);
+      g[l] -= exp(sum - lp - log_p) * scale;
+    }
+    __syncthreads();
+  }
+}
+
+static int CTCGrids(int64_t n) {
+  return static_cast<int>(std::min<int64_t>(std::max<int64_t>(n, 1), 65536));
+}
+
+template <typename T>
+class CTCLossFunctor<platform::CUDADeviceContext, T> {
+ public:
+  void operator()(const platform::CUDADeviceContext& context,
+                  const framework::Tensor& logits,
+                  const framework::Vector<size_t>& logits_lod,
+                  const framework::Tensor& labels,
+                  const framework::Vector<size_t>& label_lod, int blank,
+                  bool norm_by_times, framework::Tensor* loss,
+                  framework::Tensor* gradient) {
+    auto place = context.GetPlace();
+    int num_seq = static_cast<int>(logits_lod.size() - 1);
+    int64_t rows = logits.dims()[0];
+    int64_t width = logits.numel() / std::max<int64_t>(rows, 1);
+    const T* x = logits.data<T>();
+    T* loss_data = loss->mutable_data<T>(
+        framework::make_ddim({static_cast<int64_t>(num_seq), 1}), place);
+    if (num_seq == 0) return;
+
+    // The chains of the labels are made on the host, which has the labels
+    // copied as warp-ctc does.
+    framework::Tensor cpu_labels;
+    framework::TensorCopySync(labels, platform::CPUPlace(), &cpu_labels);
+    framework::Vector<int64_t> state_offsets;
+    framework::Vector<int> first_same_label, next_same_label;
+    CTCStates(logits_lod, label_lod, cpu_labels.data<int>(), &state_offsets,
+              &first_same_label, &next_same_label);
+
+    framework::Tensor lse_t, alpha_t, beta_t;
+    T* lse = lse_t.mutable_data<T>(framework::make_ddim({rows}), place);
+    auto state_dims =
+        framework::make_ddim({std::max<int64_t>(state_offsets[num_seq], 1)});
+    T* alpha = alpha_t.mutable_data<T>(state_dims, place);
+    T* beta = beta_t.mutable_data<T>(state_dims, place);
+
+    auto stream = context.stream();
+    KeRowLogSumExp<T, kCTCBlockDim><<<CTCGrids(rows), kCTCBlockDim, 0,
+                                      stream>>>(x, rows, width, lse);
+    const size_t* seq_offsets = logits_lod.CUDAData(place);
+    const size_t* label_offsets = label_lod.CUDAData(place);
+    const int64_t* states = state_offsets.CUDAData(place);
+    KeCTCAlphaBeta<T, kCTCBlockDim><<<num_seq, kCTCBlockDim, 0, stream>>>(
+        x, lse, width, seq_offsets, labels.data<int>(), label_offsets, blank,
+        states, alpha, beta, loss_data);
+    if (gradient == nullptr) return;
+
+    T* grad = gradient->mutable_data<T>(logits.dims(), place);
+    KeCTCGrad<T, kCTCBlockDim><<<CTCGrids(rows), kCTCBlockDim, 0, stream>>>(
+        x, lse, rows, width, seq_offsets, num_seq, labels.data<int>(),
+        label_offsets, first_same_label.CUDAData(place),
+        next_same_label.CUDAData(place), blank, states, alpha, beta,
+        norm_by_times, grad);
+  }
+};
+
+template class CTCLossFunctor<platform::CUDADeviceContext, float>;
+template class CTCLossFunctor<platform::CUDADeviceContext, double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,87 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/hostdevice.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+/*
+ * \brief The CTC loss of the variable-length sequences, and its gradient with
+ *        respect to the unscaled logits, in the layouts of the LoD.
+ *
+ * Unlike warp-ctc, the logits are not padded into [max_length, batch,
+ * width]: the log softmax, the forward and backward variables (alpha and
+ * beta, in the log space, of 2 * label_length + 1 states a time step) and
+ * the gradient are computed on the packed rows of every sequence.
+ *
+ * \param context        Device context of this functor.
+ * \param logits         The unscaled logits [Lp, C] of the sequences.
+ * \param logits_lod     The absolute offsets of the sequences in logits.
+ * \param labels         The int labels [Lg, 1] of the sequences.
+ * \param label_lod      The absolute offsets of the labels.
+ * \param blank          The blank label in [0, C).
+ * \param norm_by_times  Whether to divide the gradient of a sequence by its
+ *                       length.
+ * \param loss           The loss [N, 1] of the sequences, -log p(label).
+ * \param gradient       The gradient [Lp, C] of the losses with respect to
+ *                       logits, or nullptr if it is not needed. As in
+ *                       warp-ctc, both the loss and the gradient of a
+ *                       sequence which can not be aligned to its label are
+ *                       zero.
+ */
+template <typename DeviceContext, typename T>
+class CTCLossFunctor {
+ public:
+  void operator()(const DeviceContext& context,
+                  const framework::Tensor& logits,
+                  const framework::Vector<size_t>& logits_lod,
+                  const framework::Tensor& labels,
+                  const framework::Vector<size_t>& label_lod, int blank,
+                  bool norm_by_times, framework::Tensor* loss,
+                  framework::Tensor* gradient);
+};
+
+// log(exp(a) + exp(b)), where -inf is the log of 0.
+template <typename T>
+HOSTDEVICE inline T LogAdd(T a, T b) {
+  if (a < b) {
+    T t = a;
+    a = b;
+    b = t;
+  }
+  if (b == static_cast<T>(-INFINITY)) return a;
+  return a + log1p(exp(b - a));
+}
+
+// The offsets of the alpha and beta of the sequences on GPU, the sequence i
+// has (2 * label_length + 1) * length of them. The labels of the same value
+// in a label are chained: first_same_label[j] is the first label of the
+// value of labels[j], and next_same_label[j] the next one, or -1.
+void CTCStates(const framework::Vector<size_t>& logits_lod,
+               const framework::Vector<size_t>& label_lod, const int* labels,
+               framework::Vector<int64_t>* state_offsets,
+               framework::Vector<int>* first_same_label,
+               framework::Vector<int>* next_same_label);
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,135 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/ctc_loss.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace framework = paddle::framework;
+namespace math = paddle::operators::math;
+
+// -log p(label | x) by the sum over all the paths of a sequence.
+static double BruteForceLoss(const double* x, int length, int width,
+                             const std::vector<int>& label, int blank) {
+  std::vector<double> log_softmax(length * width);
+  for (int t = 0; t < length; ++t) {
+    double sum = 0;
+    for (int k = 0; k < width; ++k) sum += std::exp(x[t * width + k]);
+    for (int k = 0; k < width; ++k) {
+      log_softmax[t * width + k] = x[t * width + k] - std::log(sum);
+    }
+  }
+  int num_paths = 1;
+  for (int t = 0; t < length; ++t) num_paths *= width;
+  double p = 0;
+  std::vector<int> path(length);
+  for (int n = 0; n < num_paths; ++n) {
+    int rest = n;
+    for (int t = 0; t < length; ++t) {
+      path[t] = rest % width;
+      rest /= width;
+    }
+    std::vector<int> collapsed;
+    for (int t = 0; t < length; ++t) {
+      if (path[t] != blank && (t == 0 || path[t] != path[t - 1])) {
+        collapsed.push_back(path[t]);
+      }
+    }
+    if (collapsed != label) continue;
+    double log_p = 0;
+    for (int t = 0; t < length; ++t) log_p += log_softmax[t * width + path[t]];
+    p += std::exp(log_p);
+  }
+  return -std::log(p);
+}
+
+TEST(ctc_loss, cpu_matches_brute_force) {
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceContext context(place);
+  const int width = 4;
+  const int blank = 0;
+  // The labels with a repeat, with no label, and one which can not be
+  // aligned to its sequence of 2, whose loss and gradient are 0.
+  std::vector<size_t> lengths = {5, 3, 4, 2};
+  std::vector<std::vector<int>> labels = {{1, 2, 2}, {3}, {}, {1, 1}};
+
+  framework::Vector<size_t> logits_lod(1, 0), label_lod(1, 0);
+  for (size_t i = 0; i < lengths.size(); ++i) {
+    logits_lod.push_back(logits_lod.back() + lengths[i]);
+    label_lod.push_back(label_lod.back() + labels[i].size());
+  }
+  framework::Tensor logits, label, loss, grad;
+  int64_t rows = logits_lod.back();
+  double* x =
+      logits.mutable_data<double>(framework::make_ddim({rows, width}), place);
+  for (int64_t i = 0; i < rows * width; ++i) {
+    x[i] = std::sin(0.7 * i) * 2;
+  }
+  int* label_data = label.mutable_data<int>(
+      framework::make_ddim({static_cast<int64_t>(label_lod.back()), 1}),
+      place);
+  for (size_t i = 0; i < labels.size(); ++i) {
+    std::copy(labels[i].begin(), labels[i].end(), label_data + label_lod[i]);
+  }
+
+  math::CTCLossFunctor<paddle::platform::CPUDeviceContext, double> ctc;
+  ctc(context, logits, logits_lod, label, label_lod, blank, false, &loss,
+      &grad);
+  const double* loss_data = loss.data<double>();
+  for (size_t i = 0; i < lengths.size(); ++i) {
+    double expected = BruteForceLoss(x + logits_lod[i] * width, lengths[i],
+                                     width, labels[i], blank);
+    if (std::isinf(expected)) {
+      EXPECT_EQ(loss_data[i], 0);
+    } else {
+      EXPECT_NEAR(loss_data[i], expected, 1e-9);
+    }
+  }
+
+  // The gradient is the one by the finite differences of the loss.
+  const double* grad_data = grad.data<double>();
+  for (size_t i = 0; i < lengths.size(); ++i) {
+    double* seq = x + logits_lod[i] * width;
+    bool feasible =
+        !std::isinf(BruteForceLoss(seq, lengths[i], width, labels[i], blank));
+    for (size_t j = 0; j < lengths[i] * width; ++j) {
+      double g = grad_data[logits_lod[i] * width + j];
+      if (!feasible) {
+        EXPECT_EQ(g, 0);
+        continue;
+      }
+      double origin = seq[j];
+      seq[j] = origin + 1e-6;
+      double plus = BruteForceLoss(seq, lengths[i], width, labels[i], blank);
+      seq[j] = origin - 1e-6;
+      double minus = BruteForceLoss(seq, lengths[i], width, labels[i], blank);
+      seq[j] = origin;
+      EXPECT_NEAR(g, (plus - minus) / 2e-6, 1e-5);
+    }
+  }
+
+  // The gradient normalized by times.
+  framework::Tensor norm_loss, norm_grad;
+  ctc(context, logits, logits_lod, label, label_lod, blank, true, &norm_loss,
+      &norm_grad);
+  for (size_t i = 0; i < lengths.size(); ++i) {
+    for (size_t j = logits_lod[i] * width; j < logits_lod[i + 1] * width;
+         ++j) {
+      EXPECT_NEAR(norm_grad.data<double>()[j], grad_data[j] / lengths[i],
+                  1e-12);
+    }
+  }
+}
@@ -0,0 +1,130 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/depthwise_conv.h"
+#include <algorithm>
+#include <vector>
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The first output column of a row which reads the input column
+// ow * stride + offset in [0, input_width), and the end of them.
+static inline void ValidColumns(int offset, int stride, int input_width,
+                                int output_width, int* begin, int* end) {
+  *begin = offset >= 0 ? 0 : (-offset + stride - 1) / stride;
+  int last = input_width - 1 - offset;
+  *end = last < 0 ? 0 : std::min(last / stride + 1, output_width);
+  *begin = std::min(*begin, *end);
+}
+
+/*
+ * The depthwise convolution on CPU is computed directly instead of by im2col
+ * and a GEMM of a single row per channel. Each output row accumulates the
+ * products of a filter element and a shifted input row, so the inner loop
+ * runs over contiguous memory and is vectorized by the compiler when the
+ * stride is 1, and the padding is skipped by the bounds of the loops.
+ */
+template <typename T>
+class DepthwiseConvFunctor<platform::CPUDeviceContext, T> {
+ public:
+  void operator()(const platform::CPUDeviceContext& context,
+                  const framework::Tensor& input,
+                  const framework::Tensor& filter,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::vector<int>& dilations, framework::Tensor* output,
+                  const ConvEpilogue<T>& epilogue) {
+    const int batch_size = input.dims()[0];
+    const int input_channels = input.dims()[1];
+    const int input_height = input.dims()[2];
+    const int input_width = input.dims()[3];
+    const int output_channels = output->dims()[1];
+    const int output_height = output->dims()[2];
+    const int output_width = output->dims()[3];
+    const int ksize_height = filter.dims()[2];
+    const int ksize_width = filter.dims()[3];
+    const int stride_height = strides[0];
+    const int stride_width = strides[1];
+    const int padding_height = paddings[0];
+    const int padding_width = paddings[1];
+    const int dilate_height = dilations[0];
+    const int dilate_width = dilations[1];
+
+    const T* input_data = input.data<T>();
+    const T* filter_data = filter.data<T>();
+    T* output_data = output->mutable_data<T>(context.GetPlace());
+
+    const int filter_multiplier = output_channels / input_channels;
+    const int input_size = input_height * input_width;
+    const int output_size = output_height * output_width;
+    const bool has_epilogue = epilogue.bias != nullptr ||
+                              epilogue.residual != nullptr ||
+                              epilogue.act != ConvActivation::kIdentity;
+
+    std::vector<int> col_begin(ksize_width);
+    std::vector<int> col_end(ksize_width);
+    for (int kw = 0; kw < ksize_width; ++kw) {
+      ValidColumns(kw * dilate_width - padding_width, stride_width,
+                   input_width, output_width, &col_begin[kw], &col_end[kw]);
+    }
+
+    for (int n = 0; n < batch_size; ++n) {
+      for (int c_out = 0; c_out < output_channels; ++c_out) {
+        const int c_in = c_out / filter_multiplier;
+        const T* in = input_data + (n * input_channels + c_in) * input_size;
+        const T* weight = filter_data + c_out * ksize_height * ksize_width;
+        const int out_offset = (n * output_channels + c_out) * output_size;
+        T* out = output_data + out_offset;
+        std::fill(out, out + output_size, static_cast<T>(0));
+
+        for (int oh = 0; oh < output_height; ++oh) {
+          T* out_row = out + oh * output_width;
+          for (int kh = 0; kh < ksize_height; ++kh) {
+            int ih = oh * stride_height - padding_height + kh * dilate_height;
+            if (ih < 0 || ih >= input_height) continue;
+            const T* in_row = in + ih * input_width;
+            for (int kw = 0; kw < ksize_width; ++kw) {
+              const T w = weight[kh * ksize_width + kw];
+              const int offset = kw * dilate_width - padding_width;
+              if (stride_width == 1) {
+                for (int ow = col_begin[kw]; ow < col_end[kw]; ++ow) {
+                  out_row[ow] += w * in_row[ow + offset];
+                }
+              } else {
+                for (int ow = col_begin[kw]; ow < col_end[kw]; ++ow) {
+                  out_row[ow] += w * in_row[ow * stride_width + offset];
+                }
+              }
+            }
+          }
+        }
+
+        if (has_epilogue) {
+          for (int i = 0; i < output_size; ++i) {
+            out[i] = epilogue(out[i], c_out, out_offset + i);
+          }
+        }
+      }
+    }
+  }
+};
+
+template class DepthwiseConvFunctor<platform::CPUDeviceContext, float>;
+template class DepthwiseConvFunctor<platform::CPUDeviceContext, double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
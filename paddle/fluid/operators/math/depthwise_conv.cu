@@ -54,10 +54,11 @@ __forceinline__ __device__ unsigned warp_id() {
       const int filter_multiplier, const int filter_height,                    \
       const int filter_width, const int stride_height, const int stride_width, \
       const int padding_height, const int padding_width,                       \
-      const int dilate_height, const int dilate_width, T *const output_data
+      const int dilate_height, const int dilate_width,                         \
+      T *const output_data, const ConvEpilogue<T> epilogue
 
 // A Cuda kernel to compute the depthwise convolution forward pass
-// in NCHW format.
+// in NCHW format, followed by the epilogue.
 template <typename T>
 __device__ __inline__ void KernelDepthwiseConv(ARG_DEFINE_KernelDepthwiseConv) {
   for (int w_out = threadIdx.x; w_out < output_width; w_out += blockDim.x) {
@@ -95,7 +96,7 @@ __device__ __inline__ void KernelDepthwiseConv(ARG_DEFINE_KernelDepthwiseConv) {
       int index =
           ((batch * gridDim.x + c_out) * output_height + h_out) * output_width +
           w_out;
-      output_data[index] = value;
+      output_data[index] = epilogue(value, c_out, index);
     }
   }
 }
@@ -144,7 +145,7 @@ __device__ __inline__ void KernelDepthwiseConvCFilter(
       int index =
           ((batch * gridDim.x + c_out) * output_height + h_out) * output_width +
           w_out;
-      output_data[index] = value;
+      output_data[index] = epilogue(value, c_out, index);
     }
   }
 }
@@ -158,14 +159,14 @@ __global__ void KernelDepthwiseConvSp(ARG_DEFINE_KernelDepthwiseConv) {
           output_width, input_channels, input_height, input_width,
           filter_multiplier, filter_height, filter_width, stride_height,
           stride_width, padding_height, padding_width, dilate_height,
-          dilate_width, output_data);
+          dilate_width, output_data, epilogue);
     else
       KernelDepthwiseConvCFilter<T, c_filter>(
           input_data, filter_data, batch_size, output_channels, output_height,
           output_width, input_channels, input_height, input_width,
           filter_multiplier, filter_height, filter_width, stride_height,
           stride_width, padding_height, padding_width, dilate_height,
-          dilate_width, output_data);
+          dilate_width, output_data, epilogue);
   } else {
     if (c_filter == -1)
       KernelDepthwiseConv<T>(input_data, filter_data, batch_size,
@@ -173,14 +174,15 @@ __global__ void KernelDepthwiseConvSp(ARG_DEFINE_KernelDepthwiseConv) {
                              input_channels, input_height, input_width,
                              c_filter_multiplier, filter_height, filter_height,
                              c_stride, c_stride, padding_height, padding_width,
-                             dilate_height, dilate_width, output_data);
+                             dilate_height, dilate_width, output_data,
+                             epilogue);
     else
       KernelDepthwiseConvCFilter<T, c_filter>(
           input_data, filter_data, batch_size, output_channels, output_height,
           output_width, input_channels, input_height, input_width,
           c_filter_multiplier, filter_height, filter_height, c_stride, c_stride,
           padding_height, padding_width, dilate_height, dilate_width,
-          output_data);
+          output_data, epilogue);
   }
 }
 
@@ -423,8 +425,8 @@ class DepthwiseConvFunctor<platform::CUDADeviceContext, T> {
                   const framework::Tensor& filter,
                   const std::vector<int>& strides,
                   const std::vector<int>& paddings,
-                  const std::vector<int>& dilations,
-                  framework::Tensor* output) {
+                  const std::vector<int>& dilations, framework::Tensor* output,
+                  const ConvEpilogue<T>& epilogue) {
     const int batch_size = input.dims()[0];
     const int input_channels = input.dims()[1];
     const int input_height = input.dims()[2];
@@ -462,7 +464,7 @@ class DepthwiseConvFunctor<platform::CUDADeviceContext, T> {
         output_width, input_channels, input_height, input_width,             \
         filter_multiplier, ksize_height, ksize_width, stride_height,         \
         stride_width, padding_height, padding_width, dilate_height,          \
-        dilate_width, output_data);                                          \
+        dilate_width, output_data, epilogue);                                \
     return;                                                                  \
   }
     check_case(1, 1, 3);
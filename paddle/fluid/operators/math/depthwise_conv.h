@@ -15,6 +15,7 @@ limitations under the License. */
 #pragma once
 #include <vector>
 #include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/operators/math/conv_epilogue.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/hostdevice.h"
 
@@ -24,7 +25,8 @@ namespace math {
 
 /*
  * \brief Compute the depthwise convolution which include
- * forward process and backpropagation process
+ * forward process and backpropagation process. The forward process can fuse
+ * an epilogue of the bias, the residual and the activation into the kernel.
  */
 template <typename DeviceContext, typename T>
 class DepthwiseConvFunctor {
@@ -33,7 +35,8 @@ class DepthwiseConvFunctor {
                   const framework::Tensor& filter,
                   const std::vector<int>& strides,
                   const std::vector<int>& paddings,
-                  const std::vector<int>& dilations, framework::Tensor* output);
+                  const std::vector<int>& dilations, framework::Tensor* output,
+                  const ConvEpilogue<T>& epilogue = ConvEpilogue<T>());
 };
 
 template <typename DeviceContext, typename T>
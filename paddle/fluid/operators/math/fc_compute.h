@@ -14,6 +14,8 @@ limitations under the License. */
 
 #pragma once
 
+#include <algorithm>
+#include "paddle/fluid/framework/compute_pool.h"
 #include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/operators/math/blas.h"
 
@@ -25,7 +27,17 @@ template <typename DeviceContext, typename T>
 inline void FCCompute(const BlasT<DeviceContext, T>& blas, const int M,
                       const int N, const int K, const T* X, const T* W, T* Y,
                       const T* B = NULL, bool relu = false) {
-  blas.MatMul(M, N, K, X, W, Y);
+  // The JIT code of small GEMM avoids the calling overhead of BLAS, which
+  // dominates when M is small.
+  jit::matmul_attr_t attr(M, N, K);
+  auto matmul =
+      jit::GetJitCode<jit::kMatMul, jit::MatMulTuples<T>, platform::CPUPlace>(
+          attr);
+  if (matmul) {
+    matmul(X, W, Y, &attr);
+  } else {
+    blas.MatMul(M, N, K, X, W, Y);
+  }
   if (B == NULL) {
     return;
   }
@@ -39,13 +51,10 @@ inline void FCCompute(const BlasT<DeviceContext, T>& blas, const int M,
   } else {
     auto compute =
         jit::Get<jit::kVAdd, jit::XYZNTuples<T>, platform::CPUPlace>(N);
-#ifdef PADDLE_WITH_MKLML
-#pragma omp parallel for
-#endif
-    for (int i = 0; i < M; i++) {
+    framework::ParallelForEach(M, (1 << 15) / std::max(N, 1), [&](int64_t i) {
       T* dst = Y + i * N;
       compute(B, dst, dst, N);
-    }
+    });
   }
 }
 
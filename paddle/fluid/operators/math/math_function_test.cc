@@ -282,3 +282,50 @@ TEST(math_function, gemm_warp) {
   GemmWarpTest<double>(8, 5, 6, 1.0, 0.0);
   GemmWarpTest<double>(8, 5, 6, 2.0, 1.0);
 }
+
+template <typename T>
+void VarLenBatchedGemmTest(const std::vector<int>& lengths, int n, int k,
+                           T alpha, T beta) {
+  int m = 0;
+  for (auto length : lengths) m += length;
+  std::vector<T> A(m * k);
+  std::vector<T> B(lengths.size() * k * n);
+  std::vector<T> CREF(m * n);
+  for (size_t i = 0; i < A.size(); ++i) A[i] = static_cast<T>(i % 7);
+  for (size_t i = 0; i < B.size(); ++i) B[i] = static_cast<T>(i % 5 + 1);
+  for (size_t i = 0; i < CREF.size(); ++i) CREF[i] = static_cast<T>(i % 3);
+  std::vector<T> C(CREF);
+
+  std::vector<const T*> a_array;
+  std::vector<const T*> b_array;
+  std::vector<T*> c_array;
+  int offset = 0;
+  for (size_t i = 0; i < lengths.size(); ++i) {
+    a_array.push_back(A.data() + offset * k);
+    b_array.push_back(B.data() + i * k * n);
+    c_array.push_back(C.data() + offset * n);
+    if (lengths[i] > 0) {
+      paddle::operators::math::CBlas<T>::GEMM(
+          CblasRowMajor, CblasNoTrans, CblasNoTrans, lengths[i], n, k, alpha,
+          a_array.back(), k, b_array.back(), n, beta,
+          CREF.data() + offset * n, n);
+    }
+    offset += lengths[i];
+  }
+
+  paddle::platform::CPUPlace cpu_place;
+  paddle::platform::CPUDeviceContext context(cpu_place);
+  GetBlas<T>(context).VarLenBatchedGEMM(CblasNoTrans, CblasNoTrans, lengths, n,
+                                        k, alpha, a_array, k, b_array, n, beta,
+                                        c_array, n);
+
+  for (size_t i = 0; i < C.size(); ++i) {
+    EXPECT_FLOAT_EQ(CREF[i], C[i]);
+  }
+}
+
+TEST(math_function, var_len_batched_gemm) {
+  VarLenBatchedGemmTest<float>({3, 0, 1, 4}, 5, 6, 1.f, 0.f);
+  VarLenBatchedGemmTest<float>({3, 0, 1, 4}, 5, 6, 2.f, 1.f);
+  VarLenBatchedGemmTest<double>({2, 7, 7, 1}, 3, 4, 1.0, 1.0);
+}
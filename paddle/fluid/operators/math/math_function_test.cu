@@ -16,6 +16,8 @@
 #include "paddle/fluid/operators/math/math_function.h"
 #include "paddle/fluid/platform/device_context.h"
 
+DECLARE_bool(cublas_fp16_gemm_padding);
+
 void fill_fp16_data(paddle::platform::float16* in_ptr, size_t size,
                     const std::vector<float>& data) {
   PADDLE_ENFORCE_EQ(size, data.size());
@@ -465,3 +467,113 @@ TEST(math_function, gemv) {
   GemvTest<float>(3, 13, true);
   GemvTest<double>(3, 13, true);
 }
+
+// C[m, n] of the leading dim n + 3 = op(A) * op(B) + C by fp16 GEMM, whose
+// shapes are not multiples of 8 and are padded if padding.
+void Fp16GemmPaddingTest(bool trans_a, bool trans_b, bool padding) {
+  paddle::platform::CPUPlace cpu_place;
+  paddle::platform::CUDAPlace gpu_place(0);
+  paddle::platform::CUDADeviceContext context(gpu_place);
+  if (context.GetComputeCapability() < 53) return;
+
+  int m = 5, n = 7, k = 13;
+  int ldc = n + 3;
+  std::vector<float> a(m * k), b(k * n), c(m * ldc);
+  for (size_t i = 0; i < a.size(); ++i) a[i] = i % 3;
+  for (size_t i = 0; i < b.size(); ++i) b[i] = i % 4 - 1;
+  for (size_t i = 0; i < c.size(); ++i) c[i] = i % 5;
+
+  paddle::framework::Tensor a_t, b_t, c_t, a_gpu, b_gpu, c_gpu;
+  fill_fp16_data(a_t.mutable_data<paddle::platform::float16>(
+                     {static_cast<int64_t>(a.size())}, cpu_place),
+                 a.size(), a);
+  fill_fp16_data(b_t.mutable_data<paddle::platform::float16>(
+                     {static_cast<int64_t>(b.size())}, cpu_place),
+                 b.size(), b);
+  fill_fp16_data(c_t.mutable_data<paddle::platform::float16>(
+                     {static_cast<int64_t>(c.size())}, cpu_place),
+                 c.size(), c);
+  paddle::framework::TensorCopySync(a_t, gpu_place, &a_gpu);
+  paddle::framework::TensorCopySync(b_t, gpu_place, &b_gpu);
+  paddle::framework::TensorCopySync(c_t, gpu_place, &c_gpu);
+
+  FLAGS_cublas_fp16_gemm_padding = padding;
+  GetBlas<paddle::platform::float16>(context).GEMM(
+      trans_a, trans_b, m, n, k, static_cast<paddle::platform::float16>(1),
+      a_gpu.data<paddle::platform::float16>(), trans_a ? m : k,
+      b_gpu.data<paddle::platform::float16>(), trans_b ? k : n,
+      static_cast<paddle::platform::float16>(1),
+      c_gpu.data<paddle::platform::float16>(), ldc);
+  FLAGS_cublas_fp16_gemm_padding = false;
+  paddle::framework::TensorCopySync(c_gpu, cpu_place, &c_t);
+  context.Wait();
+
+  auto* out = c_t.data<paddle::platform::float16>();
+  for (int i = 0; i < m; ++i) {
+    for (int j = 0; j < ldc; ++j) {
+      float expected = c[i * ldc + j];
+      if (j < n) {
+        for (int l = 0; l < k; ++l) {
+          expected += (trans_a ? a[l * m + i] : a[i * k + l]) *
+                      (trans_b ? b[j * k + l] : b[l * n + j]);
+        }
+      }
+      ASSERT_EQ(static_cast<float>(out[i * ldc + j]), expected);
+    }
+  }
+}
+
+TEST(math_function, gemm_fp16_padding) {
+  for (bool padding : {false, true}) {
+    Fp16GemmPaddingTest(false, false, padding);
+    Fp16GemmPaddingTest(true, false, padding);
+    Fp16GemmPaddingTest(false, true, padding);
+    Fp16GemmPaddingTest(true, true, padding);
+  }
+}
+
+TEST(math_function, batched_gemm_fp16) {
+  paddle::platform::CPUPlace cpu_place;
+  paddle::platform::CUDAPlace gpu_place(0);
+  paddle::platform::CUDADeviceContext context(gpu_place);
+  if (context.GetComputeCapability() < 53) return;
+
+  int batch = 3, m = 4, n = 6, k = 5;
+  std::vector<float> a(batch * m * k), b(batch * k * n);
+  for (size_t i = 0; i < a.size(); ++i) a[i] = i % 3;
+  for (size_t i = 0; i < b.size(); ++i) b[i] = i % 4 - 1;
+
+  paddle::framework::Tensor a_t, b_t, c_t, a_gpu, b_gpu, c_gpu;
+  fill_fp16_data(a_t.mutable_data<paddle::platform::float16>(
+                     {static_cast<int64_t>(a.size())}, cpu_place),
+                 a.size(), a);
+  fill_fp16_data(b_t.mutable_data<paddle::platform::float16>(
+                     {static_cast<int64_t>(b.size())}, cpu_place),
+                 b.size(), b);
+  paddle::framework::TensorCopySync(a_t, gpu_place, &a_gpu);
+  paddle::framework::TensorCopySync(b_t, gpu_place, &b_gpu);
+  auto* c = c_gpu.mutable_data<paddle::platform::float16>(
+      {static_cast<int64_t>(batch * m * n)}, gpu_place);
+
+  GetBlas<paddle::platform::float16>(context).BatchedGEMM(
+      CblasNoTrans, CblasNoTrans, m, n, k,
+      static_cast<paddle::platform::float16>(1),
+      a_gpu.data<paddle::platform::float16>(),
+      b_gpu.data<paddle::platform::float16>(),
+      static_cast<paddle::platform::float16>(0), c, batch, m * k, k * n);
+  paddle::framework::TensorCopySync(c_gpu, cpu_place, &c_t);
+  context.Wait();
+
+  auto* out = c_t.data<paddle::platform::float16>();
+  for (int i = 0; i < batch; ++i) {
+    for (int r = 0; r < m; ++r) {
+      for (int j = 0; j < n; ++j) {
+        float expected = 0;
+        for (int l = 0; l < k; ++l) {
+          expected += a[i * m * k + r * k + l] * b[i * k * n + l * n + j];
+        }
+        ASSERT_EQ(static_cast<float>(out[i * m * n + r * n + j]), expected);
+      }
+    }
+  }
+}
@@ -13,8 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/math/matrix_bit_code.h"
-#include <iostream>
-#include <map>
+#include <algorithm>
+#include <vector>
 
 namespace paddle {
 namespace operators {
@@ -168,12 +168,6 @@ void MatrixBitCodeFunctor<T>::Mul(framework::Tensor *tmat,
   code_table_.apply_visitor(func);
 }
 
-template <typename T, size_t N>
-class ReservedVector : public std::vector<T> {
- public:
-  ReservedVector() { this->reserve(N); }
-};
-
 template <typename T>
 struct MatrixBitCodeFunctorMulGradWeight : public boost::static_visitor<void> {
   const framework::Tensor &tmat_;
@@ -195,23 +189,14 @@ struct MatrixBitCodeFunctorMulGradWeight : public boost::static_visitor<void> {
     auto weight_value = weight_->data<T>();
     auto input_value = input_.data<T>();
 
-    std::map<int, ReservedVector<std::pair<T, const T *>, 8u>> ops;
     for (size_t i = 0; i < num_samples; ++i) {
       auto code = code_table.get_code(i);
       int code_length = code.get_length();
-      const T *input_value_row = input_value + input_width * i;
+      const T *input_row = input_value + input_width * i;
       const T *tmat_row = tmat_value + i * tmat_width;
       for (int j = 0; j < code_length; ++j) {
-        ops[code.calc_index(j)].emplace_back(tmat_row[j], input_value_row);
-      }
-    }
-    for (auto &op : ops) {
-      auto &op_in_row = op.second;
-      for (auto &pair : op_in_row) {
-        auto &scale = pair.first;
-        auto *input_row = pair.second;
-        T *weight_row = weight_value + op.first * weight_width;
-        blas.AXPY(input_width, scale, input_row, weight_row);
+        T *weight_row = weight_value + code.calc_index(j) * weight_width;
+        blas.AXPY(input_width, tmat_row[j], input_row, weight_row);
       }
     }
   }
@@ -249,27 +234,17 @@ struct MatrixBitCodeFunctorMulGradWeightSR
     auto weight_value = weight_->mutable_value()->data<T>();
     auto input_value = input_.data<T>();
 
-    std::unordered_map<int, std::vector<std::pair<T, const T *>>> ops;
-    ops.reserve(weight_->rows().size());
-
+    // The rows of the weight are the ones on the paths, see Rows.
     for (size_t i = 0; i < num_samples; ++i) {
       auto code = code_table.get_code(i);
       int code_length = code.get_length();
-      const T *input_value_row = input_value + input_width * i;
+      const T *input_row = input_value + input_width * i;
       const T *tmat_row = tmat_value + i * tmat_width;
       for (int j = 0; j < code_length; ++j) {
-        ops[code.calc_index(j)].emplace_back(tmat_row[j], input_value_row);
-      }
-    }
-
-    for (auto &row : weight_->rows()) {
-      auto &op_in_row = ops[row];
-      for (auto &pair : op_in_row) {
-        auto &scale = pair.first;
-        auto *input_row = pair.second;
-        blas.AXPY(input_width, scale, input_row, weight_value);
+        int64_t index = weight_->Index(code.calc_index(j));
+        blas.AXPY(input_width, tmat_row[j], input_row,
+                  weight_value + index * weight_width);
       }
-      weight_value += weight_width;
     }
   }
 };
@@ -294,6 +269,8 @@ struct MatrixBitCodeFunctorMulGradError : public boost::static_visitor<void> {
       : tmat_(tmat), weight_(weight), input_(input) {}
   template <typename CodeTable>
   void operator()(const CodeTable &code_table) {
+    auto blas =
+        GetBlas<platform::CPUDeviceContext, T>(platform::CPUDeviceContext());
     size_t num_samples = tmat_.dims()[0];
     size_t tmat_width = tmat_.dims()[1];
     size_t input_width = input_->dims()[1];
@@ -305,14 +282,11 @@ struct MatrixBitCodeFunctorMulGradError : public boost::static_visitor<void> {
     for (size_t i = 0; i < num_samples; ++i) {
       auto code = code_table.get_code(i);
       int code_length = code.get_length();
+      T *input_row = input_value + input_width * i;
+      const T *tmat_row = tmat_value + i * tmat_width;
       for (int j = 0; j < code_length; ++j) {
-        size_t index = code.calc_index(j);
-
-        for (size_t k = 0; k < input_width; ++k) {
-          input_value[input_width * i + k] +=
-              tmat_value[i * tmat_width + j] *
-              weight_value[weight_width * index + k];
-        }
+        const T *weight_row = weight_value + weight_width * code.calc_index(j);
+        blas.AXPY(input_width, tmat_row[j], weight_row, input_row);
       }
     }
   }
@@ -355,6 +329,35 @@ void MatrixBitCodeFunctor<T>::Sub(framework::Tensor *tmat) {
   code_table_.apply_visitor(func);
 }
 
+struct MatrixBitCodeFunctorRows : public boost::static_visitor<void> {
+  int64_t num_samples_;
+  std::vector<int64_t> *rows_;
+
+  MatrixBitCodeFunctorRows(int64_t num_samples, std::vector<int64_t> *rows)
+      : num_samples_(num_samples), rows_(rows) {}
+
+  template <typename CodeTable>
+  void operator()(const CodeTable &code_table) {
+    for (int64_t i = 0; i < num_samples_; ++i) {
+      auto code = code_table.get_code(i);
+      int code_length = code.get_length();
+      for (int j = 0; j < code_length; ++j) {
+        rows_->push_back(static_cast<int64_t>(code.calc_index(j)));
+      }
+    }
+    std::sort(rows_->begin(), rows_->end());
+    rows_->erase(std::unique(rows_->begin(), rows_->end()), rows_->end());
+  }
+};
+
+template <typename T>
+std::vector<int64_t> MatrixBitCodeFunctor<T>::Rows(int64_t num_samples) {
+  std::vector<int64_t> rows;
+  MatrixBitCodeFunctorRows func(num_samples, &rows);
+  code_table_.apply_visitor(func);
+  return rows;
+}
+
 template class MatrixBitCodeFunctor<float>;
 template class MatrixBitCodeFunctor<double>;
 
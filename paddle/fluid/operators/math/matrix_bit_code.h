@@ -258,6 +258,11 @@ class MatrixBitCodeFunctor {
   void MulGradError(const framework::Tensor& tmat,
                     const framework::Tensor& weight, framework::Tensor* input);
 
+  /* The sorted indices of the weight rows on the paths of the samples, which
+     are the rows of the SelectedRows gradient of the weight.
+  */
+  std::vector<int64_t> Rows(int64_t num_samples);
+
   size_t num_classes_;
   const int64_t* ids_;
   CodeTable code_table_;
@@ -0,0 +1,192 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#ifdef PADDLE_WITH_NEON
+
+#include "paddle/fluid/operators/math/neon_sgemm.h"
+#include <arm_neon.h>
+#include <algorithm>
+#include <vector>
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The tile of C in the registers, and the blocks of A and B in the L1 and
+// L2 cache.
+static constexpr int kMR = 8;
+static constexpr int kNR = 8;
+static constexpr int kMC = 128;
+static constexpr int kKC = 256;
+static constexpr int kNC = 1024;
+
+// Pack op(B)[k0:k0+kc, j0:j0+nc] into the panels of kNR columns, each of
+// which is kc rows of kNR contiguous values, padded with 0.
+static void PackB(bool trans, const float* B, int ldb, int k0, int j0, int kc,
+                  int nc, float* packed) {
+  for (int j = 0; j < nc; j += kNR) {
+    const int n = std::min(kNR, nc - j);
+    for (int k = 0; k < kc; ++k) {
+      for (int jj = 0; jj < kNR; ++jj) {
+        float value = 0.f;
+        if (jj < n) {
+          const int col = j0 + j + jj;
+          const int row = k0 + k;
+          value = trans ? B[col * ldb + row] : B[row * ldb + col];
+        }
+        *packed++ = value;
+      }
+    }
+  }
+}
+
+// Pack op(A)[i0:i0+mc, k0:k0+kc] into the panels of kMR rows, each of which
+// is kc columns of kMR contiguous values, padded with 0.
+static void PackA(bool trans, const float* A, int lda, int i0, int k0, int mc,
+                  int kc, float* packed) {
+  for (int i = 0; i < mc; i += kMR) {
+    const int m = std::min(kMR, mc - i);
+    for (int k = 0; k < kc; ++k) {
+      for (int ii = 0; ii < kMR; ++ii) {
+        float value = 0.f;
+        if (ii < m) {
+          const int row = i0 + i + ii;
+          const int col = k0 + k;
+          value = trans ? A[col * lda + row] : A[row * lda + col];
+        }
+        *packed++ = value;
+      }
+    }
+  }
+}
+
+#define NEON_SGEMM_ROW(r, a, lane)                  \
+  c##r##0 = vfmaq_laneq_f32(c##r##0, b0, a, lane); \
+  c##r##1 = vfmaq_laneq_f32(c##r##1, b1, a, lane)
+
+#define NEON_SGEMM_STORE_ROW(r)          \
+  vst1q_f32(tile + r * kNR, c##r##0);    \
+  vst1q_f32(tile + r * kNR + 4, c##r##1)
+
+// tile[8][8] = the product of a panel of A and a panel of B.
+static void MicroKernel(int kc, const float* a, const float* b, float* tile) {
+  float32x4_t c00 = vdupq_n_f32(0.f), c01 = vdupq_n_f32(0.f);
+  float32x4_t c10 = vdupq_n_f32(0.f), c11 = vdupq_n_f32(0.f);
+  float32x4_t c20 = vdupq_n_f32(0.f), c21 = vdupq_n_f32(0.f);
+  float32x4_t c30 = vdupq_n_f32(0.f), c31 = vdupq_n_f32(0.f);
+  float32x4_t c40 = vdupq_n_f32(0.f), c41 = vdupq_n_f32(0.f);
+  float32x4_t c50 = vdupq_n_f32(0.f), c51 = vdupq_n_f32(0.f);
+  float32x4_t c60 = vdupq_n_f32(0.f), c61 = vdupq_n_f32(0.f);
+  float32x4_t c70 = vdupq_n_f32(0.f), c71 = vdupq_n_f32(0.f);
+  for (int k = 0; k < kc; ++k) {
+    float32x4_t a0 = vld1q_f32(a);
+    float32x4_t a1 = vld1q_f32(a + 4);
+    float32x4_t b0 = vld1q_f32(b);
+    float32x4_t b1 = vld1q_f32(b + 4);
+    NEON_SGEMM_ROW(0, a0, 0);
+    NEON_SGEMM_ROW(1, a0, 1);
+    NEON_SGEMM_ROW(2, a0, 2);
+    NEON_SGEMM_ROW(3, a0, 3);
+    NEON_SGEMM_ROW(4, a1, 0);
+    NEON_SGEMM_ROW(5, a1, 1);
+    NEON_SGEMM_ROW(6, a1, 2);
+    NEON_SGEMM_ROW(7, a1, 3);
+    a += kMR;
+    b += kNR;
+  }
+  NEON_SGEMM_STORE_ROW(0);
+  NEON_SGEMM_STORE_ROW(1);
+  NEON_SGEMM_STORE_ROW(2);
+  NEON_SGEMM_STORE_ROW(3);
+  NEON_SGEMM_STORE_ROW(4);
+  NEON_SGEMM_STORE_ROW(5);
+  NEON_SGEMM_STORE_ROW(6);
+  NEON_SGEMM_STORE_ROW(7);
+}
+
+#undef NEON_SGEMM_ROW
+#undef NEON_SGEMM_STORE_ROW
+
+// C[m][n] = alpha * tile + beta * C, the old C is not read if beta is 0, so
+// that it may be uninitialized.
+static void StoreTile(const float* tile, int m, int n, float alpha,
+                      float beta, float* C, int ldc) {
+  for (int i = 0; i < m; ++i) {
+    float* c = C + i * ldc;
+    const float* t = tile + i * kNR;
+    if (beta == 0.f) {
+      for (int j = 0; j < n; ++j) {
+        c[j] = alpha * t[j];
+      }
+    } else {
+      for (int j = 0; j < n; ++j) {
+        c[j] = alpha * t[j] + beta * c[j];
+      }
+    }
+  }
+}
+
+static void ScaleC(int M, int N, float beta, float* C, int ldc) {
+  for (int i = 0; i < M; ++i) {
+    float* c = C + i * ldc;
+    for (int j = 0; j < N; ++j) {
+      c[j] = beta == 0.f ? 0.f : beta * c[j];
+    }
+  }
+}
+
+void NeonSgemm(bool trans_a, bool trans_b, int M, int N, int K, float alpha,
+               const float* A, int lda, const float* B, int ldb, float beta,
+               float* C, int ldc) {
+  if (M <= 0 || N <= 0) return;
+  if (K <= 0 || alpha == 0.f) {
+    ScaleC(M, N, beta, C, ldc);
+    return;
+  }
+
+  const int kc_max = std::min(K, kKC);
+  const int nc_max = std::min(N, kNC);
+  const int mc_max = std::min(M, kMC);
+  std::vector<float> packed_b(kc_max * ((nc_max + kNR - 1) / kNR * kNR));
+  std::vector<float> packed_a(kc_max * ((mc_max + kMR - 1) / kMR * kMR));
+  float tile[kMR * kNR];
+
+  for (int j0 = 0; j0 < N; j0 += kNC) {
+    const int nc = std::min(kNC, N - j0);
+    for (int k0 = 0; k0 < K; k0 += kKC) {
+      const int kc = std::min(kKC, K - k0);
+      // The later blocks of K accumulate on the former ones.
+      const float block_beta = k0 == 0 ? beta : 1.f;
+      PackB(trans_b, B, ldb, k0, j0, kc, nc, packed_b.data());
+      for (int i0 = 0; i0 < M; i0 += kMC) {
+        const int mc = std::min(kMC, M - i0);
+        PackA(trans_a, A, lda, i0, k0, mc, kc, packed_a.data());
+        for (int j = 0; j < nc; j += kNR) {
+          const float* b = packed_b.data() + j * kc;
+          for (int i = 0; i < mc; i += kMR) {
+            MicroKernel(kc, packed_a.data() + i * kc, b, tile);
+            StoreTile(tile, std::min(kMR, mc - i), std::min(kNR, nc - j),
+                      alpha, block_beta, C + (i0 + i) * ldc + j0 + j, ldc);
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
+
+#endif
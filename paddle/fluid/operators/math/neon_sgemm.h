@@ -0,0 +1,40 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#ifdef PADDLE_WITH_NEON
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+/*
+ * C = alpha * op(A) * op(B) + beta * C of the row major matrices by NEON,
+ * used by Blas on ARM when OpenBLAS is not configured, since the reference
+ * CBLAS is several times slower.
+ *
+ * The blocks of op(B) and op(A) are packed into the panels of 8 columns and
+ * 8 rows, which makes the transposes free, and every 8x8 tile of C is kept
+ * in the registers over a block of K.
+ */
+void NeonSgemm(bool trans_a, bool trans_b, int M, int N, int K, float alpha,
+               const float* A, int lda, const float* B, int ldb, float beta,
+               float* C, int ldc);
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
+
+#endif
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 #include "paddle/fluid/operators/math/pooling.h"
 #include <algorithm>
+#include <string>
 #include <vector>
 
 namespace paddle {
@@ -20,13 +21,68 @@ namespace operators {
 namespace math {
 
 /*
- * All tensors are in NCHW format.
+ * All tensors are in NCHW format, or NHWC of the data_format.
  * Ksize, strides, paddings are two elements. These two elements represent
  * height and width, respectively.
  */
 template <typename PoolProcess, typename T>
 class Pool2dFunctor<platform::CPUDeviceContext, PoolProcess, T> {
  public:
+  void operator()(const platform::CPUDeviceContext& context,
+                  const framework::Tensor& input, const std::vector<int>& ksize,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::string& data_format, PoolProcess pool_process,
+                  bool exclusive, bool adaptive, framework::Tensor* output) {
+    if (data_format != "NHWC") {
+      (*this)(context, input, ksize, strides, paddings, pool_process,
+              exclusive, adaptive, output);
+      return;
+    }
+    const int batch_size = input.dims()[0];
+    const int input_height = input.dims()[1];
+    const int input_width = input.dims()[2];
+    const int channels = input.dims()[3];
+    const int output_height = output->dims()[1];
+    const int output_width = output->dims()[2];
+
+    const T* input_data = input.data<T>();
+    T* output_data = output->mutable_data<T>(context.GetPlace());
+
+    for (int i = 0; i < batch_size; ++i) {
+      for (int ph = 0; ph < output_height; ++ph) {
+        int hstart, hend;
+        PoolWindow(ph, input_height, output_height, ksize[0], strides[0],
+                   paddings[0], adaptive, &hstart, &hend);
+        for (int pw = 0; pw < output_width; ++pw) {
+          int wstart, wend;
+          PoolWindow(pw, input_width, output_width, ksize[1], strides[1],
+                     paddings[1], adaptive, &wstart, &wend);
+          T* out = output_data +
+                   ((i * output_height + ph) * output_width + pw) * channels;
+          for (int c = 0; c < channels; ++c) out[c] = pool_process.initial();
+          // The loops over the contiguous channels are vectorized.
+          for (int h = hstart; h < hend; ++h) {
+            for (int w = wstart; w < wend; ++w) {
+              const T* in = input_data +
+                            ((i * input_height + h) * input_width + w) *
+                                channels;
+              for (int c = 0; c < channels; ++c) {
+                pool_process.compute(in[c], out + c);
+              }
+            }
+          }
+          int pool_size = (exclusive || adaptive)
+                              ? (hend - hstart) * (wend - wstart)
+                              : ksize[0] * ksize[1];
+          for (int c = 0; c < channels; ++c) {
+            pool_process.finalize(static_cast<T>(pool_size), out + c);
+          }
+        }
+      }
+    }
+  }
+
   void operator()(const platform::CPUDeviceContext& context,
                   const framework::Tensor& input, const std::vector<int>& ksize,
                   const std::vector<int>& strides,
@@ -95,13 +151,71 @@ class Pool2dFunctor<platform::CPUDeviceContext, PoolProcess, T> {
 };
 
 /*
-* All tensors are in NCHW format.
+* All tensors are in NCHW format, or NHWC of the data_format.
 * Ksize, strides, paddings are two elements. These two elements represent height
 * and width, respectively.
 */
 template <typename PoolProcess, class T>
 class Pool2dGradFunctor<platform::CPUDeviceContext, PoolProcess, T> {
  public:
+  void operator()(
+      const platform::CPUDeviceContext& context, const framework::Tensor& input,
+      const framework::Tensor& output, const framework::Tensor& output_grad,
+      const std::vector<int>& ksize, const std::vector<int>& strides,
+      const std::vector<int>& paddings, const std::string& data_format,
+      PoolProcess pool_grad_process, bool exclusive, bool adaptive,
+      framework::Tensor* input_grad) {
+    if (data_format != "NHWC") {
+      (*this)(context, input, output, output_grad, ksize, strides, paddings,
+              pool_grad_process, exclusive, adaptive, input_grad);
+      return;
+    }
+    const int batch_size = input.dims()[0];
+    const int input_height = input.dims()[1];
+    const int input_width = input.dims()[2];
+    const int channels = input.dims()[3];
+    const int output_height = output.dims()[1];
+    const int output_width = output.dims()[2];
+
+    const T* input_data = input.data<T>();
+    const T* output_data = output.data<T>();
+    const T* output_grad_data = output_grad.data<T>();
+    T* input_grad_data = input_grad->mutable_data<T>(context.GetPlace());
+
+    for (int i = 0; i < batch_size; ++i) {
+      for (int ph = 0; ph < output_height; ++ph) {
+        int hstart, hend;
+        PoolWindow(ph, input_height, output_height, ksize[0], strides[0],
+                   paddings[0], adaptive, &hstart, &hend);
+        for (int pw = 0; pw < output_width; ++pw) {
+          int wstart, wend;
+          PoolWindow(pw, input_width, output_width, ksize[1], strides[1],
+                     paddings[1], adaptive, &wstart, &wend);
+          int pool_size = (exclusive || adaptive)
+                              ? (hend - hstart) * (wend - wstart)
+                              : ksize[0] * ksize[1];
+          T scale = static_cast<T>(1.0 / pool_size);
+          int output_idx =
+              ((i * output_height + ph) * output_width + pw) * channels;
+          const T* out = output_data + output_idx;
+          const T* out_grad = output_grad_data + output_idx;
+          for (int h = hstart; h < hend; ++h) {
+            for (int w = wstart; w < wend; ++w) {
+              int input_idx =
+                  ((i * input_height + h) * input_width + w) * channels;
+              const T* in = input_data + input_idx;
+              T* in_grad = input_grad_data + input_idx;
+              for (int c = 0; c < channels; ++c) {
+                pool_grad_process.compute(in[c], out[c], out_grad[c], scale,
+                                          in_grad + c);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
   void operator()(
       const platform::CPUDeviceContext& context, const framework::Tensor& input,
       const framework::Tensor& output, const framework::Tensor& output_grad,
@@ -176,13 +290,71 @@ class Pool2dGradFunctor<platform::CPUDeviceContext, PoolProcess, T> {
 };
 
 /*
- * All tensors are in NCHW format.
+ * All tensors are in NCHW format, or NHWC of the data_format.
  * Ksize, strides, paddings are two elements. These two elements represent
  * height and width, respectively.
  */
 template <class T>
 class MaxPool2dGradFunctor<platform::CPUDeviceContext, T> {
  public:
+  void operator()(
+      const platform::CPUDeviceContext& context, const framework::Tensor& input,
+      const framework::Tensor& output, const framework::Tensor& output_grad,
+      const std::vector<int>& ksize, const std::vector<int>& strides,
+      const std::vector<int>& paddings, const std::string& data_format,
+      framework::Tensor* input_grad) {
+    if (data_format != "NHWC") {
+      (*this)(context, input, output, output_grad, ksize, strides, paddings,
+              input_grad);
+      return;
+    }
+    const int batch_size = input.dims()[0];
+    const int input_height = input.dims()[1];
+    const int input_width = input.dims()[2];
+    const int channels = input.dims()[3];
+    const int output_height = output.dims()[1];
+    const int output_width = output.dims()[2];
+
+    const T* input_data = input.data<T>();
+    const T* output_data = output.data<T>();
+    const T* output_grad_data = output_grad.data<T>();
+    T* input_grad_data = input_grad->mutable_data<T>(context.GetPlace());
+
+    // Whether the first max of a channel in the window is found.
+    std::vector<char> found(channels);
+    for (int i = 0; i < batch_size; ++i) {
+      for (int ph = 0; ph < output_height; ++ph) {
+        int hstart, hend;
+        PoolWindow(ph, input_height, output_height, ksize[0], strides[0],
+                   paddings[0], false, &hstart, &hend);
+        for (int pw = 0; pw < output_width; ++pw) {
+          int wstart, wend;
+          PoolWindow(pw, input_width, output_width, ksize[1], strides[1],
+                     paddings[1], false, &wstart, &wend);
+          int output_idx =
+              ((i * output_height + ph) * output_width + pw) * channels;
+          const T* out = output_data + output_idx;
+          const T* out_grad = output_grad_data + output_idx;
+          std::fill(found.begin(), found.end(), 0);
+          for (int h = hstart; h < hend; ++h) {
+            for (int w = wstart; w < wend; ++w) {
+              int input_idx =
+                  ((i * input_height + h) * input_width + w) * channels;
+              const T* in = input_data + input_idx;
+              T* in_grad = input_grad_data + input_idx;
+              for (int c = 0; c < channels; ++c) {
+                if (!found[c] && in[c] == out[c]) {
+                  in_grad[c] += out_grad[c];
+                  found[c] = 1;
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
   void operator()(
       const platform::CPUDeviceContext& context, const framework::Tensor& input,
       const framework::Tensor& output, const framework::Tensor& output_grad,
@@ -13,7 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include <algorithm>
+#include <cstdint>
+#include <string>
 #include <vector>
+#include "cub/cub.cuh"
 #include "paddle/fluid/operators/math/pooling.h"
 #include "paddle/fluid/platform/cuda_primitives.h"
 
@@ -182,6 +185,241 @@ __global__ void KernelMaxPool2DGrad(
   }
 }
 
+// The vector of Size elements of T which are loaded and stored at once.
+template <typename T, int Size>
+struct alignas(sizeof(T) * Size) PoolVector {
+  T val[Size];
+};
+
+// The number of the channels which are pooled at once in NHWC, of 16 bytes
+// if the channels and the data are aligned to it.
+template <typename T>
+static int PoolVectorSize(int channels, const void* input, const void* output) {
+  constexpr int kSize = sizeof(T) < 16 ? 16 / sizeof(T) : 1;
+  if (channels % kSize == 0 && reinterpret_cast<uintptr_t>(input) % 16 == 0 &&
+      reinterpret_cast<uintptr_t>(output) % 16 == 0) {
+    return kSize;
+  }
+  return 1;
+}
+
+// Every thread pools VecSize contiguous channels, so that the loads are
+// coalesced and vectorized.
+template <typename PoolProcess, typename T, int VecSize>
+__global__ void KernelPool2DNHWC(
+    const int nthreads, const T* input_data, const int channels,
+    const int input_height, const int input_width, const int output_height,
+    const int output_width, const int ksize_height, const int ksize_width,
+    const int stride_height, const int stride_width, const int padding_height,
+    const int padding_width, PoolProcess pool_process, bool exclusive,
+    bool adaptive, T* output_data) {
+  using VecT = PoolVector<T, VecSize>;
+  const int channel_vectors = channels / VecSize;
+  for (int index = blockIdx.x * blockDim.x + threadIdx.x; index < nthreads;
+       index += blockDim.x * gridDim.x) {
+    int cv = index % channel_vectors;
+    int pw = (index / channel_vectors) % output_width;
+    int ph = (index / channel_vectors / output_width) % output_height;
+    int batch_idx = index / channel_vectors / output_width / output_height;
+
+    int hstart, hend;
+    int wstart, wend;
+    PoolWindow(ph, input_height, output_height, ksize_height, stride_height,
+               padding_height, adaptive, &hstart, &hend);
+    PoolWindow(pw, input_width, output_width, ksize_width, stride_width,
+               padding_width, adaptive, &wstart, &wend);
+
+    const VecT* in = reinterpret_cast<const VecT*>(input_data) +
+                     batch_idx * input_height * input_width * channel_vectors +
+                     cv;
+    T ele[VecSize];
+#pragma unroll
+    for (int k = 0; k < VecSize; ++k) ele[k] = pool_process.initial();
+    for (int h = hstart; h < hend; ++h) {
+      for (int w = wstart; w < wend; ++w) {
+        VecT x = in[(h * input_width + w) * channel_vectors];
+#pragma unroll
+        for (int k = 0; k < VecSize; ++k) {
+          pool_process.compute(x.val[k], &ele[k]);
+        }
+      }
+    }
+    int pool_size = (exclusive || adaptive) ? (hend - hstart) * (wend - wstart)
+                                            : ksize_height * ksize_width;
+    VecT y;
+#pragma unroll
+    for (int k = 0; k < VecSize; ++k) {
+      pool_process.finalize(static_cast<T>(pool_size), &ele[k]);
+      y.val[k] = ele[k];
+    }
+    reinterpret_cast<VecT*>(output_data)[index] = y;
+  }
+}
+
+template <typename PoolProcess, typename T>
+struct PoolCombine {
+  PoolProcess pool_process;
+  __device__ __forceinline__ T operator()(const T& a, const T& b) const {
+    PoolProcess process = pool_process;
+    T y = a;
+    process.compute(b, &y);
+    return y;
+  }
+};
+
+// The thresholds of the bins of the adaptive pooling, over which a bin is
+// pooled by a block.
+constexpr int kAdaptivePoolBlockDim = 256;
+constexpr int kAdaptivePoolBlockBinSize = 1024;
+
+// Every block pools a bin of the adaptive pooling of NCHW, such as the
+// global pooling of [N, C, 1, 1], in which a thread would loop over a large
+// strided bin.
+template <typename PoolProcess, typename T, int BlockDim>
+__global__ void KernelAdaptivePool2D(const int nthreads, const T* input_data,
+                                     const int input_height,
+                                     const int input_width,
+                                     const int output_height,
+                                     const int output_width,
+                                     PoolProcess pool_process,
+                                     T* output_data) {
+  using BlockReduce = cub::BlockReduce<T, BlockDim>;
+  __shared__ typename BlockReduce::TempStorage storage;
+  PoolCombine<PoolProcess, T> combine{pool_process};
+  for (int index = blockIdx.x; index < nthreads; index += gridDim.x) {
+    int pw = index % output_width;
+    int ph = (index / output_width) % output_height;
+    int plane = index / output_width / output_height;
+    int hstart = AdaptStartIndex(ph, input_height, output_height);
+    int hend = AdaptEndIndex(ph, input_height, output_height);
+    int wstart = AdaptStartIndex(pw, input_width, output_width);
+    int wend = AdaptEndIndex(pw, input_width, output_width);
+    int bin_width = wend - wstart;
+    int bin_size = (hend - hstart) * bin_width;
+
+    const T* in = input_data + plane * input_height * input_width;
+    T ele = pool_process.initial();
+    for (int k = threadIdx.x; k < bin_size; k += BlockDim) {
+      int h = hstart + k / bin_width;
+      int w = wstart + k % bin_width;
+      pool_process.compute(in[h * input_width + w], &ele);
+    }
+    ele = BlockReduce(storage).Reduce(ele, combine);
+    if (threadIdx.x == 0) {
+      pool_process.finalize(static_cast<T>(bin_size), &ele);
+      output_data[index] = ele;
+    }
+    __syncthreads();
+  }
+}
+
+// The range [*start, *end) of the outputs whose windows may cover the
+// input i along an axis. Those of the adaptive pooling are checked by
+// PoolWindow.
+__device__ __forceinline__ void PoolOutputRange(int i, int input_size,
+                                                int output_size, int ksize,
+                                                int stride, int padding,
+                                                bool adaptive, int* start,
+                                                int* end) {
+  if (adaptive) {
+    *start = i * output_size / input_size;
+    *end = min((i + 1) * output_size / input_size + 1, output_size);
+  } else {
+    int offset = i + padding;
+    *start = offset < ksize ? 0 : (offset - ksize) / stride + 1;
+    *end = min(offset / stride + 1, output_size);
+  }
+}
+
+// Every thread gathers the gradient of an input of NHWC from the outputs
+// whose windows cover it, without atomics.
+template <typename PoolProcess, typename T>
+__global__ void KernelPool2DGradNHWC(
+    const int nthreads, const T* input_data, const T* output_data,
+    const T* output_grad, const int channels, const int input_height,
+    const int input_width, const int output_height, const int output_width,
+    const int ksize_height, const int ksize_width, const int stride_height,
+    const int stride_width, const int padding_height, const int padding_width,
+    PoolProcess pool_process, bool exclusive, bool adaptive, T* input_grad) {
+  for (int index = blockIdx.x * blockDim.x + threadIdx.x; index < nthreads;
+       index += blockDim.x * gridDim.x) {
+    int c = index % channels;
+    int w = (index / channels) % input_width;
+    int h = (index / channels / input_width) % input_height;
+    int batch_idx = index / channels / input_width / input_height;
+
+    int phstart, phend;
+    int pwstart, pwend;
+    PoolOutputRange(h, input_height, output_height, ksize_height,
+                    stride_height, padding_height, adaptive, &phstart, &phend);
+    PoolOutputRange(w, input_width, output_width, ksize_width, stride_width,
+                    padding_width, adaptive, &pwstart, &pwend);
+    T gradient = 0;
+    T input = input_data[index];
+    int output_offset = batch_idx * output_height * output_width * channels + c;
+    for (int ph = phstart; ph < phend; ++ph) {
+      int hstart, hend;
+      PoolWindow(ph, input_height, output_height, ksize_height, stride_height,
+                 padding_height, adaptive, &hstart, &hend);
+      if (h < hstart || h >= hend) continue;
+      for (int pw = pwstart; pw < pwend; ++pw) {
+        int wstart, wend;
+        PoolWindow(pw, input_width, output_width, ksize_width, stride_width,
+                   padding_width, adaptive, &wstart, &wend);
+        if (w < wstart || w >= wend) continue;
+        int pool_size = (exclusive || adaptive)
+                            ? (hend - hstart) * (wend - wstart)
+                            : ksize_height * ksize_width;
+        int output_idx = output_offset + (ph * output_width + pw) * channels;
+        pool_process.compute(input, output_data[output_idx],
+                             output_grad[output_idx],
+                             static_cast<T>(1.0 / pool_size), &gradient);
+      }
+    }
+    input_grad[index] = gradient;
+  }
+}
+
+template <typename T>
+__global__ void KernelMaxPool2DGradNHWC(
+    const int nthreads, const T* input_data, const T* output_data,
+    const T* output_grad, const int channels, const int input_height,
+    const int input_width, const int output_height, const int output_width,
+    const int ksize_height, const int ksize_width, const int stride_height,
+    const int stride_width, const int padding_height, const int padding_width,
+    T* input_grad) {
+  for (int index = blockIdx.x * blockDim.x + threadIdx.x; index < nthreads;
+       index += blockDim.x * gridDim.x) {
+    int c = index % channels;
+    int pw = (index / channels) % output_width;
+    int ph = (index / channels / output_width) % output_height;
+    int batch_idx = index / channels / output_width / output_height;
+
+    int hstart, hend;
+    int wstart, wend;
+    PoolWindow(ph, input_height, output_height, ksize_height, stride_height,
+               padding_height, false, &hstart, &hend);
+    PoolWindow(pw, input_width, output_width, ksize_width, stride_width,
+               padding_width, false, &wstart, &wend);
+
+    int input_offset = batch_idx * input_height * input_width * channels + c;
+    T ele = output_data[index];
+    int max_index = -1;
+    for (int h = hstart; h < hend && max_index == -1; ++h) {
+      for (int w = wstart; w < wend; ++w) {
+        int input_idx = input_offset + (h * input_width + w) * channels;
+        if (ele == input_data[input_idx]) {
+          max_index = input_idx;
+          break;
+        }
+      }
+    }
+    if (max_index != -1) {
+      platform::CudaAtomicAdd(input_grad + max_index, output_grad[index]);
+    }
+  }
+}
+
 template <typename PoolProcess, typename T>
 void Pool2dDirectCUDAFunctor<PoolProcess, T>::operator()(
     const T* input, const std::vector<int>& input_shape,
@@ -214,13 +452,58 @@ void Pool2dDirectCUDAFunctor<PoolProcess, T>::operator()(
 }
 
 /*
- * All tensors are in NCHW format.
+ * All tensors are in NCHW format, or NHWC of the data_format.
  * Ksize, strides, paddings are two elements. These two elements represent
  * height and width, respectively.
  */
 template <typename PoolProcess, typename T>
 class Pool2dFunctor<platform::CUDADeviceContext, PoolProcess, T> {
  public:
+  void operator()(const platform::CUDADeviceContext& context,
+                  const framework::Tensor& input, const std::vector<int>& ksize,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::string& data_format, PoolProcess pool_process,
+                  bool exclusive, bool adaptive, framework::Tensor* output) {
+    if (data_format != "NHWC") {
+      (*this)(context, input, ksize, strides, paddings, pool_process,
+              exclusive, adaptive, output);
+      return;
+    }
+    const int batch_size = input.dims()[0];
+    const int input_height = input.dims()[1];
+    const int input_width = input.dims()[2];
+    const int channels = input.dims()[3];
+    const int output_height = output->dims()[1];
+    const int output_width = output->dims()[2];
+
+    const T* input_data = input.data<T>();
+    T* output_data = output->mutable_data<T>(context.GetPlace());
+
+    int vec_size = PoolVectorSize<T>(channels, input_data, output_data);
+    int nthreads =
+        batch_size * output_height * output_width * channels / vec_size;
+    int blocks = (nthreads + 1024 - 1) / 1024;
+    dim3 threads(1024, 1);
+    dim3 grid(blocks, 1);
+    constexpr int kVecSize = sizeof(T) < 16 ? 16 / sizeof(T) : 1;
+    if (vec_size == kVecSize) {
+      KernelPool2DNHWC<PoolProcess, T,
+                       kVecSize><<<grid, threads, 0, context.stream()>>>(
+          nthreads, input_data, channels, input_height, input_width,
+          output_height, output_width, ksize[0], ksize[1], strides[0],
+          strides[1], paddings[0], paddings[1], pool_process, exclusive,
+          adaptive, output_data);
+    } else {
+      KernelPool2DNHWC<PoolProcess, T,
+                       1><<<grid, threads, 0, context.stream()>>>(
+          nthreads, input_data, channels, input_height, input_width,
+          output_height, output_width, ksize[0], ksize[1], strides[0],
+          strides[1], paddings[0], paddings[1], pool_process, exclusive,
+          adaptive, output_data);
+    }
+  }
+
   void operator()(const platform::CUDADeviceContext& context,
                   const framework::Tensor& input, const std::vector<int>& ksize,
                   const std::vector<int>& strides,
@@ -244,6 +527,19 @@ class Pool2dFunctor<platform::CUDADeviceContext, PoolProcess, T> {
     T* output_data = output->mutable_data<T>(context.GetPlace());
 
     int nthreads = batch_size * output_channels * output_height * output_width;
+    int max_bin_size = ((input_height + output_height - 1) / output_height) *
+                       ((input_width + output_width - 1) / output_width);
+    if (adaptive && max_bin_size >= kAdaptivePoolBlockBinSize) {
+      int blocks = std::min(
+          nthreads, std::max(context.GetMaxPhysicalThreadCount() /
+                                 kAdaptivePoolBlockDim,
+                             1));
+      KernelAdaptivePool2D<PoolProcess, T, kAdaptivePoolBlockDim><<<
+          blocks, kAdaptivePoolBlockDim, 0, context.stream()>>>(
+          nthreads, input_data, input_height, input_width, output_height,
+          output_width, pool_process, output_data);
+      return;
+    }
     int blocks = (nthreads + 1024 - 1) / 1024;
     dim3 threads(1024, 1);
     dim3 grid(blocks, 1);
@@ -257,13 +553,53 @@ class Pool2dFunctor<platform::CUDADeviceContext, PoolProcess, T> {
 };
 
 /*
- * All tensors are in NCHW format.
+ * All tensors are in NCHW format, or NHWC of the data_format.
  * Ksize, strides, paddings are two elements. These two elements represent
  * height and width, respectively.
  */
 template <typename PoolProcess, typename T>
 class Pool2dGradFunctor<platform::CUDADeviceContext, PoolProcess, T> {
  public:
+  void operator()(const platform::CUDADeviceContext& context,
+                  const framework::Tensor& input,
+                  const framework::Tensor& output,
+                  const framework::Tensor& output_grad,
+                  const std::vector<int>& ksize,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::string& data_format, PoolProcess pool_process,
+                  bool exclusive, bool adaptive,
+                  framework::Tensor* input_grad) {
+    if (data_format != "NHWC") {
+      (*this)(context, input, output, output_grad, ksize, strides, paddings,
+              pool_process, exclusive, adaptive, input_grad);
+      return;
+    }
+    const int batch_size = input.dims()[0];
+    const int input_height = input.dims()[1];
+    const int input_width = input.dims()[2];
+    const int channels = input.dims()[3];
+    const int output_height = output.dims()[1];
+    const int output_width = output.dims()[2];
+
+    const T* input_data = input.data<T>();
+    const T* output_data = output.data<T>();
+    const T* output_grad_data = output_grad.data<T>();
+    T* input_grad_data = input_grad->mutable_data<T>(context.GetPlace());
+
+    int nthreads = batch_size * input_height * input_width * channels;
+    int blocks = (nthreads + 1024 - 1) / 1024;
+    dim3 threads(1024, 1);
+    dim3 grid(blocks, 1);
+
+    KernelPool2DGradNHWC<PoolProcess,
+                         T><<<grid, threads, 0, context.stream()>>>(
+        nthreads, input_data, output_data, output_grad_data, channels,
+        input_height, input_width, output_height, output_width, ksize[0],
+        ksize[1], strides[0], strides[1], paddings[0], paddings[1],
+        pool_process, exclusive, adaptive, input_grad_data);
+  }
+
   void operator()(const platform::CUDADeviceContext& context,
                   const framework::Tensor& input,
                   const framework::Tensor& output,
@@ -305,13 +641,51 @@ class Pool2dGradFunctor<platform::CUDADeviceContext, PoolProcess, T> {
 };
 
 /*
- * All tensors are in NCHW format.
+ * All tensors are in NCHW format, or NHWC of the data_format.
  * Ksize, strides, paddings are two elements. These two elements represent
  * height and width, respectively.
  */
 template <typename T>
 class MaxPool2dGradFunctor<platform::CUDADeviceContext, T> {
  public:
+  void operator()(const platform::CUDADeviceContext& context,
+                  const framework::Tensor& input,
+                  const framework::Tensor& output,
+                  const framework::Tensor& output_grad,
+                  const std::vector<int>& ksize,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::string& data_format,
+                  framework::Tensor* input_grad) {
+    if (data_format != "NHWC") {
+      (*this)(context, input, output, output_grad, ksize, strides, paddings,
+              input_grad);
+      return;
+    }
+    const int batch_size = input.dims()[0];
+    const int input_height = input.dims()[1];
+    const int input_width = input.dims()[2];
+    const int channels = input.dims()[3];
+    const int output_height = output.dims()[1];
+    const int output_width = output.dims()[2];
+
+    const T* input_data = input.data<T>();
+    const T* output_data = output.data<T>();
+    const T* output_grad_data = output_grad.data<T>();
+    T* input_grad_data = input_grad->mutable_data<T>(context.GetPlace());
+
+    int nthreads = batch_size * output_height * output_width * channels;
+    int blocks = (nthreads + 1024 - 1) / 1024;
+    dim3 threads(1024, 1);
+    dim3 grid(blocks, 1);
+
+    KernelMaxPool2DGradNHWC<T><<<grid, threads, 0, context.stream()>>>(
+        nthreads, input_data, output_data, output_grad_data, channels,
+        input_height, input_width, output_height, output_width, ksize[0],
+        ksize[1], strides[0], strides[1], paddings[0], paddings[1],
+        input_grad_data);
+  }
+
   void operator()(const platform::CUDADeviceContext& context,
                   const framework::Tensor& input,
                   const framework::Tensor& output,
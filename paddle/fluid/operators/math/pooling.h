@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
+#include <string>
 #include <vector>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/tensor.h"
@@ -80,11 +81,29 @@ HOSTDEVICE inline int AdaptEndIndex(int ph, int input_size, int output_size) {
       ceil(static_cast<double>((ph + 1) * input_size) / output_size));
 }
 
+/* The window [*start, *end) of the output index p along an axis, which is
+ * clipped to the input.
+ */
+HOSTDEVICE inline void PoolWindow(int p, int input_size, int output_size,
+                                  int ksize, int stride, int padding,
+                                  bool adaptive, int* start, int* end) {
+  if (adaptive) {
+    *start = AdaptStartIndex(p, input_size, output_size);
+    *end = AdaptEndIndex(p, input_size, output_size);
+  } else {
+    int begin = p * stride - padding;
+    *end = begin + ksize < input_size ? begin + ksize : input_size;
+    *start = begin > 0 ? begin : 0;
+  }
+}
+
 /*
  * \brief Getting pooling results, and calculating gradient.
  *
  * In pool2d, all tensors are in NCHW format. Where N is batch size, C is the
- * number of channels, H and W is the height and width of feature.
+ * number of channels, H and W is the height and width of feature. The
+ * functors of pool2d which take a data_format pool the tensors of NHWC too,
+ * over the contiguous channels.
  * In pool3d, all tensors are in NCDHW format. Where N is batch size, C is the
  * number of channels, D, H and W is the depth, height and width of feature.
  *
@@ -115,6 +134,12 @@ class Pool2dFunctor {
                   const std::vector<int>& strides,
                   const std::vector<int>& paddings, PoolProcess pool_compute,
                   bool exclusive, bool adaptive, framework::Tensor* output);
+  void operator()(const DeviceContext& context, const framework::Tensor& input,
+                  const std::vector<int>& ksize,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::string& data_format, PoolProcess pool_compute,
+                  bool exclusive, bool adaptive, framework::Tensor* output);
 };
 
 template <typename DeviceContext, typename PoolProcess, typename T>
@@ -127,6 +152,14 @@ class Pool2dGradFunctor {
                   const std::vector<int>& strides,
                   const std::vector<int>& paddings, PoolProcess pool_compute,
                   bool exclusive, bool adaptive, framework::Tensor* input_grad);
+  void operator()(const DeviceContext& context, const framework::Tensor& input,
+                  const framework::Tensor& output,
+                  const framework::Tensor& output_grad,
+                  const std::vector<int>& ksize,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::string& data_format, PoolProcess pool_compute,
+                  bool exclusive, bool adaptive, framework::Tensor* input_grad);
 };
 
 template <typename DeviceContext, class T>
@@ -139,6 +172,14 @@ class MaxPool2dGradFunctor {
                   const std::vector<int>& strides,
                   const std::vector<int>& paddings,
                   framework::Tensor* input_grad);
+  void operator()(const DeviceContext& context, const framework::Tensor& input,
+                  const framework::Tensor& output,
+                  const framework::Tensor& output_grad,
+                  const std::vector<int>& ksize,
+                  const std::vector<int>& strides,
+                  const std::vector<int>& paddings,
+                  const std::string& data_format,
+                  framework::Tensor* input_grad);
 };
 
 template <typename DeviceContext, typename PoolProcess, typename T>
@@ -0,0 +1,115 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/float16.h"
+#include "paddle/fluid/platform/hostdevice.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+/*
+ * The embedding tables W [N, D] of the inference models can be stored
+ * quantized, as
+ *  - float16: W holds the rows in float16;
+ *  - uint8: W holds the rows in uint8, quantized by row with the scale and
+ *    the bias of the row in WScaleBias [N, 2], w = q * scale + bias, where
+ *    the bias is the min of the row and the scale is (max - min) / 255.
+ * The lookup ops read the rows by the readers below, which dequantize them
+ * into the float output, so that the table is never stored in float.
+ * The tables are trained in float and quantized at the export.
+ */
+template <typename T, typename TW>
+struct QuantizedTableReader {
+  HOSTDEVICE QuantizedTableReader(const TW* table, const float* scale_bias,
+                                  int64_t width)
+      : table_(table), width_(width) {}
+
+  HOSTDEVICE inline T operator()(int64_t id, int64_t d) const {
+    return static_cast<T>(table_[id * width_ + d]);
+  }
+
+  const TW* table_;
+  int64_t width_;
+};
+
+template <typename T>
+struct QuantizedTableReader<T, uint8_t> {
+  HOSTDEVICE QuantizedTableReader(const uint8_t* table,
+                                  const float* scale_bias, int64_t width)
+      : table_(table), scale_bias_(scale_bias), width_(width) {}
+
+  HOSTDEVICE inline T operator()(int64_t id, int64_t d) const {
+    return static_cast<T>(static_cast<float>(table_[id * width_ + d]) *
+                              scale_bias_[2 * id] +
+                          scale_bias_[2 * id + 1]);
+  }
+
+  const uint8_t* table_;
+  const float* scale_bias_;
+  int64_t width_;
+};
+
+inline bool IsQuantizedTable(const framework::Tensor& table) {
+  return table.type() == framework::proto::VarType::FP16 ||
+         table.type() == framework::proto::VarType::UINT8;
+}
+
+// The data type of the kernels which look up the table var, the quantized
+// tables are looked up into float.
+inline framework::proto::VarType::Type LookupDataType(
+    const framework::Variable* table) {
+  auto data_type = framework::GetDataTypeOfVar(table);
+  if (data_type == framework::proto::VarType::FP16 ||
+      data_type == framework::proto::VarType::UINT8) {
+    return framework::proto::VarType::FP32;
+  }
+  return data_type;
+}
+
+// Calls visitor(reader) with the QuantizedTableReader<T, TW> of the
+// quantized table, scale_bias is the WScaleBias of an uint8 table.
+template <typename T, typename Visitor>
+void VisitQuantizedTable(const framework::Tensor& table,
+                         const framework::Tensor* scale_bias,
+                         const Visitor& visitor) {
+  int64_t width = table.dims()[1];
+  switch (table.type()) {
+    case framework::proto::VarType::FP16:
+      visitor(QuantizedTableReader<T, platform::float16>(
+          table.data<platform::float16>(), nullptr, width));
+      break;
+    case framework::proto::VarType::UINT8:
+      PADDLE_ENFORCE_NOT_NULL(scale_bias,
+                              "The uint8 table needs Input(WScaleBias).");
+      PADDLE_ENFORCE_EQ(scale_bias->dims(),
+                        framework::make_ddim({table.dims()[0], 2}),
+                        "WScaleBias should be [N, 2] of the table [N, D].");
+      visitor(QuantizedTableReader<T, uint8_t>(
+          table.data<uint8_t>(), scale_bias->data<float>(), width));
+      break;
+    default:
+      PADDLE_THROW("The quantized table should be float16 or uint8.");
+  }
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,283 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <cub/cub.cuh>  // NOLINT
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/float16.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+/*
+ * The segmented sort and top k of the GPU ops, argsort and top_k.
+ *
+ * The top k of a segment are selected by the radix select: the bits of the
+ * k-th largest key are found 8 bits a pass, by the histogram of the digits of
+ * the keys which have the bits found so far, then the keys greater than it
+ * and enough keys equal to it are gathered in the order of index, and sorted
+ * by the stable cub::DeviceSegmentedRadixSort. The passes read every segment
+ * sizeof(T) + 1 times whatever k is, which is much faster than the extraction
+ * of the max k times for the large k and the long segments.
+ */
+
+// The order preserving unsigned bits of the floats, Encode(x) < Encode(y)
+// iff x < y, which are the keys of the radix select and sort.
+template <typename T>
+struct RadixTraits;
+
+template <>
+struct RadixTraits<float> {
+  using Bits = uint32_t;
+
+  static __device__ __forceinline__ Bits Encode(float v) {
+    Bits x = __float_as_uint(v);
+    return (x & 0x80000000u) ? ~x : (x | 0x80000000u);
+  }
+
+  static __device__ __forceinline__ float Decode(Bits x) {
+    return __uint_as_float((x & 0x80000000u) ? (x ^ 0x80000000u) : ~x);
+  }
+};
+
+template <>
+struct RadixTraits<double> {
+  using Bits = uint64_t;
+
+  static __device__ __forceinline__ Bits Encode(double v) {
+    Bits x = static_cast<Bits>(__double_as_longlong(v));
+    return (x & 0x8000000000000000ull) ? ~x : (x | 0x8000000000000000ull);
+  }
+
+  static __device__ __forceinline__ double Decode(Bits x) {
+    x = (x & 0x8000000000000000ull) ? (x ^ 0x8000000000000000ull) : ~x;
+    return __longlong_as_double(static_cast<long long>(x));  // NOLINT
+  }
+};
+
+template <>
+struct RadixTraits<platform::float16> {
+  using Bits = uint16_t;
+
+  static __device__ __forceinline__ Bits Encode(platform::float16 v) {
+    Bits x = v.x;
+    return (x & 0x8000u) ? static_cast<Bits>(~x)
+                         : static_cast<Bits>(x | 0x8000u);
+  }
+
+  static __device__ __forceinline__ platform::float16 Decode(Bits x) {
+    platform::float16 v;
+    v.x = (x & 0x8000u) ? static_cast<Bits>(x ^ 0x8000u)
+                        : static_cast<Bits>(~x);
+    return v;
+  }
+};
+
+constexpr int kRadixBits = 8;
+constexpr int kRadixSize = 1 << kRadixBits;
+constexpr int kRadixTopKBlockDim = 512;
+
+// Every block selects the top count = min(k, length) keys of its segment
+// in[begin, end), which is [in_offsets[i], in_offsets[i + 1]), or
+// [i * width, (i + 1) * width) if in_offsets is null. The encoded keys and
+// their indices in the segment are written in the order of index from
+// out_offsets[i].
+template <typename T, int BlockSize>
+__global__ void KeRadixSelectTopK(const T* in, const size_t* in_offsets,
+                                  int64_t width, int k, const int* out_offsets,
+                                  typename RadixTraits<T>::Bits* out_keys,
+                                  int64_t* out_indices) {
+  using Traits = RadixTraits<T>;
+  using Bits = typename Traits::Bits;
+  using BlockScan = cub::BlockScan<int, BlockSize>;
+  __shared__ typename BlockScan::TempStorage scan_storage;
+  __shared__ int hist[kRadixSize];
+  __shared__ int s_digit;
+  __shared__ int s_remaining;
+
+  int64_t seg = blockIdx.x;
+  int64_t begin = in_offsets ? static_cast<int64_t>(in_offsets[seg])
+                             : seg * width;
+  int64_t len = in_offsets ? static_cast<int64_t>(in_offsets[seg + 1]) - begin
+                           : width;
+  int count = static_cast<int>(min(static_cast<int64_t>(k), len));
+  if (count == 0) return;
+  const T* x = in + begin;
+
+  // The bits of the k-th largest key, and the number of the keys equal to it
+  // in the top k.
+  Bits prefix = 0;
+  Bits mask = 0;
+  int remaining = count;
+  for (int shift = sizeof(Bits) * 8 - kRadixBits; shift >= 0;
+       shift -= kRadixBits) {
+    for (int i = threadIdx.x; i < kRadixSize; i += BlockSize) {
+      hist[i] = 0;
+    }
+    __syncthreads();
+    for (int64_t j = threadIdx.x; j < len; j += BlockSize) {
+      Bits b = Traits::Encode(x[j]);
+      if ((b & mask) == prefix) {
+        atomicAdd(&hist[(b >> shift) & (kRadixSize - 1)], 1);
+      }
+    }
+    __syncthreads();
+    if (threadIdx.x == 0) {
+      int greater = 0;
+      for (int d = kRadixSize - 1; d >= 0; --d) {
+        if (greater + hist[d] >= remaining) {
+          s_digit = d;
+          s_remaining = remaining - greater;
+          break;
+        }
+        greater += hist[d];
+      }
+    }
+    __syncthreads();
+    prefix |= static_cast<Bits>(s_digit) << shift;
+    mask |= static_cast<Bits>(kRadixSize - 1) << shift;
+    remaining = s_remaining;
+  }
+
+  Bits* keys = out_keys + out_offsets[seg];
+  int64_t* indices = out_indices + out_offsets[seg];
+  int num_greater = count - remaining;
+  int greater_base = 0;
+  int equal_base = 0;
+  for (int64_t j0 = 0; j0 < len; j0 += BlockSize) {
+    int64_t j = j0 + threadIdx.x;
+    Bits b = j < len ? Traits::Encode(x[j]) : 0;
+    int greater = (j < len && b > prefix) ? 1 : 0;
+    int equal = (j < len && b == prefix) ? 1 : 0;
+    int greater_pos, greater_sum, equal_pos, equal_sum;
+    BlockScan(scan_storage).ExclusiveSum(greater, greater_pos, greater_sum);
+    __syncthreads();
+    BlockScan(scan_storage).ExclusiveSum(equal, equal_pos, equal_sum);
+    __syncthreads();
+    if (greater) {
+      keys[greater_base + greater_pos] = b;
+      indices[greater_base + greater_pos] = j;
+    }
+    if (equal && equal_base + equal_pos < remaining) {
+      keys[num_greater + equal_base + equal_pos] = b;
+      indices[num_greater + equal_base + equal_pos] = j;
+    }
+    greater_base += greater_sum;
+    equal_base += equal_sum;
+    if (greater_base >= num_greater && equal_base >= remaining) break;
+  }
+}
+
+template <typename T>
+__global__ void KeDecodeRadixKeys(const typename RadixTraits<T>::Bits* keys,
+                                  int n, T* out) {
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+       i += blockDim.x * gridDim.x) {
+    out[i] = RadixTraits<T>::Decode(keys[i]);
+  }
+}
+
+template <typename IndexT>
+__global__ void KeUniformSegmentOffsets(IndexT num_segments, IndexT width,
+                                        IndexT* offsets) {
+  for (IndexT i = blockIdx.x * blockDim.x + threadIdx.x; i <= num_segments;
+       i += blockDim.x * gridDim.x) {
+    offsets[i] = i * width;
+  }
+}
+
+// The num_segments + 1 offsets of the segments of width on the device.
+inline const int* UniformSegmentOffsets(
+    const platform::CUDADeviceContext& dev_ctx, int num_segments, int width,
+    framework::Tensor* offsets) {
+  int* data = offsets->mutable_data<int>(
+      framework::make_ddim({num_segments + 1}), dev_ctx.GetPlace());
+  int threads = 256;
+  int grids = std::min((num_segments + threads) / threads, 4096);
+  KeUniformSegmentOffsets<int><<<grids, threads, 0, dev_ctx.stream()>>>(
+      num_segments, width, data);
+  return data;
+}
+
+// Sorts the pairs of every segment [offsets[i], offsets[i + 1]) by the key,
+// stably, offsets are the num_segments + 1 ints on the device.
+template <typename KeyT, typename ValueT>
+void SegmentedSortPairs(const platform::CUDADeviceContext& dev_ctx,
+                        const KeyT* keys_in, KeyT* keys_out,
+                        const ValueT* values_in, ValueT* values_out,
+                        int num_items, int num_segments, const int* offsets,
+                        bool descending) {
+  size_t temp_bytes = 0;
+  auto sort = [&](void* temp_storage) {
+    if (descending) {
+      PADDLE_ENFORCE(cub::DeviceSegmentedRadixSort::SortPairsDescending(
+          temp_storage, temp_bytes, keys_in, keys_out, values_in, values_out,
+          num_items, num_segments, offsets, offsets + 1, 0, sizeof(KeyT) * 8,
+          dev_ctx.stream()));
+    } else {
+      PADDLE_ENFORCE(cub::DeviceSegmentedRadixSort::SortPairs(
+          temp_storage, temp_bytes, keys_in, keys_out, values_in, values_out,
+          num_items, num_segments, offsets, offsets + 1, 0, sizeof(KeyT) * 8,
+          dev_ctx.stream()));
+    }
+  };
+  sort(nullptr);
+  framework::Tensor temp;
+  sort(temp.mutable_data<uint8_t>(
+      framework::make_ddim({static_cast<int64_t>(temp_bytes)}),
+      dev_ctx.GetPlace()));
+}
+
+// Selects the top min(k, length) of every segment of in, in the descending
+// order, into out and indices from out_offsets[i], the segments are as
+// KeRadixSelectTopK, the indices are the ones in the segment, and the ties
+// are in the order of index.
+template <typename T>
+void RadixTopK(const platform::CUDADeviceContext& dev_ctx, const T* in,
+               const size_t* in_offsets, int64_t width, int num_segments,
+               int k, const int* out_offsets, int num_out, T* out,
+               int64_t* indices) {
+  if (num_segments == 0 || num_out == 0) return;
+  using Bits = typename RadixTraits<T>::Bits;
+  // The bits have no data type of Tensor, they are allocated as bytes.
+  auto key_dims =
+      framework::make_ddim({static_cast<int64_t>(num_out * sizeof(Bits))});
+  framework::Tensor keys_t, sorted_keys_t, indices_t;
+  auto* keys = reinterpret_cast<Bits*>(
+      keys_t.mutable_data<uint8_t>(key_dims, dev_ctx.GetPlace()));
+  auto* sorted_keys = reinterpret_cast<Bits*>(
+      sorted_keys_t.mutable_data<uint8_t>(key_dims, dev_ctx.GetPlace()));
+  auto* unsorted_indices = indices_t.mutable_data<int64_t>(
+      framework::make_ddim({num_out}), dev_ctx.GetPlace());
+
+  KeRadixSelectTopK<T, kRadixTopKBlockDim><<<num_segments, kRadixTopKBlockDim,
+                                             0, dev_ctx.stream()>>>(
+      in, in_offsets, width, k, out_offsets, keys, unsorted_indices);
+  SegmentedSortPairs(dev_ctx, keys, sorted_keys, unsorted_indices, indices,
+                     num_out, num_segments, out_offsets, true);
+
+  int threads = 256;
+  int grids = std::min((num_out + threads - 1) / threads, 4096);
+  KeDecodeRadixKeys<T><<<grids, threads, 0, dev_ctx.stream()>>>(
+      sorted_keys, num_out, out);
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -13,15 +13,86 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include <algorithm>
-#include <set>
-#include <unordered_map>
-
+#include <cstring>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <utility>
+
+#include "gflags/gflags.h"
+#include "paddle/fluid/framework/compute_pool.h"
+#include "paddle/fluid/framework/concurrent_id_index.h"
+#include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/operators/math/blas.h"
 #include "paddle/fluid/operators/math/selected_rows_functor.h"
 
+DEFINE_int32(sparse_update_threads, 1,
+             "The number of the threads which update the rows of a sparse "
+             "gradient in the CPU optimizers, such as the large tables on "
+             "the pserver.");
+
 namespace paddle {
 namespace operators {
 namespace math {
+
+// A shard should have enough rows to be worth a thread.
+static constexpr size_t kMinRowsPerShard = 1024;
+
+static framework::ThreadPool* SparseUpdateThreadPool() {
+  static std::unique_ptr<framework::ThreadPool> pool;
+  static std::once_flag init_flag;
+  // The calling thread updates one of the shards itself.
+  std::call_once(init_flag, [] {
+    pool.reset(new framework::ThreadPool(FLAGS_sparse_update_threads - 1));
+  });
+  return pool.get();
+}
+
+void ShardedRowsUpdate(const int64_t* rows, size_t row_count,
+                       const std::function<void(size_t i)>& update) {
+  size_t num_shards = 1;
+  while (num_shards * 2 <= static_cast<size_t>(FLAGS_sparse_update_threads) &&
+         num_shards * 2 * kMinRowsPerShard <= row_count) {
+    num_shards *= 2;
+  }
+  if (num_shards == 1) {
+    for (size_t i = 0; i < row_count; ++i) {
+      update(i);
+    }
+    return;
+  }
+
+  std::vector<std::vector<size_t>> shards(num_shards);
+  for (auto& shard : shards) {
+    shard.reserve(row_count / num_shards * 2);
+  }
+  for (size_t i = 0; i < row_count; ++i) {
+    shards[framework::ConcurrentIdIndex::ShardOf(rows[i], num_shards)]
+        .push_back(i);
+  }
+
+  auto update_shard = [&](size_t shard_id) {
+    for (auto i : shards[shard_id]) {
+      update(i);
+    }
+  };
+  std::vector<std::future<void>> futures;
+  futures.reserve(num_shards - 1);
+  for (size_t shard_id = 1; shard_id < num_shards; ++shard_id) {
+    futures.push_back(SparseUpdateThreadPool()->Run(
+        [&update_shard, shard_id] { update_shard(shard_id); }));
+  }
+  // The shards refer to this frame, wait for all of them before throwing.
+  try {
+    update_shard(0);
+  } catch (...) {
+    for (auto& f : futures) f.wait();
+    throw;
+  }
+  for (auto& f : futures) f.wait();
+  for (auto& f : futures) f.get();
+}
 template <typename T>
 struct SelectedRowsAdd<platform::CPUDeviceContext, T> {
   void operator()(const platform::CPUDeviceContext& context,
@@ -138,11 +209,12 @@ struct SelectedRowsAddTo<platform::CPUDeviceContext, T> {
     PADDLE_ENFORCE(platform::is_cpu_place(in2_place));
 
     auto* in1_data = in1_value.data<T>();
-    auto* in2_data = in2_value->data<T>();
-    memory::Copy(boost::get<platform::CPUPlace>(in2_place),
-                 in2_data + input2_offset,
-                 boost::get<platform::CPUPlace>(in1_place), in1_data,
-                 in1_value.numel() * sizeof(T));
+    auto* in2_data = in2_value->data<T>() + input2_offset;
+    framework::ParallelFor(0, in1_value.numel(), framework::GrainSize(1),
+                           [&](int64_t begin, int64_t end) {
+                             std::copy(in1_data + begin, in1_data + end,
+                                       in2_data + begin);
+                           });
   }
 };
 
@@ -212,12 +284,20 @@ struct SelectedRowsAddToTensor<platform::CPUDeviceContext, T> {
     auto* in1_data = in1_value.data<T>();
     auto* input2_data = input2->data<T>();
 
-    for (size_t i = 0; i < in1_rows.size(); i++) {
-      for (int64_t j = 0; j < in1_row_numel; j++) {
-        input2_data[in1_rows[i] * in1_row_numel + j] +=
-            in1_data[i * in1_row_numel + j];
-      }
-    }
+    // The rows may be duplicated, so the columns are split instead.
+    const int64_t* rows = in1_rows.data();
+    size_t num_rows = in1_rows.size();
+    framework::ParallelFor(
+        0, in1_row_numel, framework::GrainSize(num_rows),
+        [&](int64_t begin, int64_t end) {
+          for (size_t i = 0; i < num_rows; i++) {
+            T* out = input2_data + rows[i] * in1_row_numel;
+            const T* in = in1_data + i * in1_row_numel;
+            for (int64_t j = begin; j < end; j++) {
+              out[j] += in[j];
+            }
+          }
+        });
   }
 };
 
@@ -234,25 +314,34 @@ template struct SelectedRowsAddToTensor<platform::CPUDeviceContext, int64_t>;
 // add or mul.
 namespace scatter {
 
-template <typename DeviceContext, typename T>
-typename std::enable_if<
-    std::is_floating_point<T>::value &&
-    std::is_same<DeviceContext, platform::CPUDeviceContext>::value>::type
-elementwise_add_to(const DeviceContext& ctx, BlasT<DeviceContext, T>* blas,
-                   size_t data_len, const T* in, T* out) {
-  blas->AXPY(data_len, 1., in, out);
-}
+// out += in of the rows of width, by the jit kVAdd of the floats.
+template <typename T, bool = std::is_floating_point<T>::value>
+struct RowAdder {
+  explicit RowAdder(int64_t width)
+      : width_(width),
+        vadd_(jit::Get<jit::kVAdd, jit::XYZNTuples<T>, platform::CPUPlace>(
+            static_cast<int>(width))) {}
 
-template <typename DeviceContext, typename T>
-typename std::enable_if<
-    !std::is_floating_point<T>::value &&
-    std::is_same<DeviceContext, platform::CPUDeviceContext>::value>::type
-elementwise_add_to(const DeviceContext& ctx, BlasT<DeviceContext, T>* blas,
-                   size_t data_len, const T* in, T* out) {
-  for (size_t i = 0; i < data_len; i++) {
-    out[i] += in[i];
+  void operator()(const T* in, T* out) const {
+    vadd_(in, out, out, static_cast<int>(width_));
   }
-}
+
+  int64_t width_;
+  typename jit::XYZNTuples<T>::func_type vadd_;
+};
+
+template <typename T>
+struct RowAdder<T, false> {
+  explicit RowAdder(int64_t width) : width_(width) {}
+
+  void operator()(const T* in, T* out) const {
+    for (int64_t i = 0; i < width_; ++i) {
+      out[i] += in[i];
+    }
+  }
+
+  int64_t width_;
+};
 
 template <typename T>
 struct MergeAdd<platform::CPUDeviceContext, T> {
@@ -295,7 +384,7 @@ struct MergeAdd<platform::CPUDeviceContext, T> {
     auto input_width = has_value_input->value().dims()[1];
     auto input_height = has_value_input->height();
     framework::SelectedRows& out = *output;
-    std::set<int64_t> merged_row_set;
+    size_t num_rows = 0;
     for (auto* input : inputs) {
       if (input->rows().size() == 0) {
         continue;
@@ -305,44 +394,59 @@ struct MergeAdd<platform::CPUDeviceContext, T> {
                         "dimension except for the first one");
       PADDLE_ENFORCE_EQ(input_height, input->height(),
                         "all input should have same height");
-      merged_row_set.insert(input->rows().begin(), input->rows().end());
+      num_rows += input->rows().size();
     }
-    std::vector<int64_t> merge_rows(merged_row_set.begin(),
-                                    merged_row_set.end());
-    if (sorted_result) {
-      std::sort(merge_rows.begin(), merge_rows.end());
-    }
-    std::unordered_map<int64_t, size_t> rows_to_id;
-    for (size_t i = 0; i < merge_rows.size(); ++i) {
-      rows_to_id[merge_rows[i]] = i;
-    }
-    out.set_rows(merge_rows);
-    out.set_height(input_height);
-    out.mutable_value()->mutable_data<T>(
-        framework::make_ddim(
-            {static_cast<int64_t>(merge_rows.size()), input_width}),
-        context.GetPlace());
 
-    math::SetConstant<platform::CPUDeviceContext, T> constant_functor;
-    constant_functor(context, out.mutable_value(), 0.0);
-
-    auto* out_data = out.mutable_value()->data<T>();
-
-    auto blas = math::GetBlas<platform::CPUDeviceContext, T>(context);
+    // The rows of all the inputs are merged by sorting them with their
+    // data, stably, so that the rows of an id are added in the order of the
+    // inputs, and the merged rows are in the ascending order whether
+    // sorted_result or not.
+    std::vector<std::pair<int64_t, const T*>> sorted_rows;
+    sorted_rows.reserve(num_rows);
     for (auto* input : inputs) {
       if (input->rows().size() == 0) {
         continue;
       }
       auto* input_data = input->value().data<T>();
       auto& input_rows = input->rows();
-
-      for (size_t i = 0; i < input_rows.size(); i++) {
-        size_t out_i = rows_to_id[input_rows[i]];
-        elementwise_add_to<platform::CPUDeviceContext, T>(
-            context, &blas, static_cast<size_t>(input_width),
-            &input_data[i * input_width], &out_data[out_i * input_width]);
+      for (size_t i = 0; i < input_rows.size(); ++i) {
+        sorted_rows.emplace_back(input_rows[i],
+                                 input_data + i * input_width);
       }
     }
+    std::stable_sort(sorted_rows.begin(), sorted_rows.end(),
+                     [](const std::pair<int64_t, const T*>& a,
+                        const std::pair<int64_t, const T*>& b) {
+                       return a.first < b.first;
+                     });
+    std::vector<int64_t> merge_rows;
+    std::vector<size_t> starts;
+    for (size_t i = 0; i < sorted_rows.size(); ++i) {
+      if (i == 0 || sorted_rows[i].first != sorted_rows[i - 1].first) {
+        merge_rows.push_back(sorted_rows[i].first);
+        starts.push_back(i);
+      }
+    }
+    starts.push_back(sorted_rows.size());
+
+    out.set_rows(merge_rows);
+    out.set_height(input_height);
+    auto* out_data = out.mutable_value()->mutable_data<T>(
+        framework::make_ddim(
+            {static_cast<int64_t>(merge_rows.size()), input_width}),
+        context.GetPlace());
+
+    // Every merged row is the copy of its first row plus the others, the
+    // merged rows are independent, and are sharded by id.
+    RowAdder<T> add(input_width);
+    ShardedRowsUpdate(merge_rows.data(), merge_rows.size(), [&](size_t i) {
+      T* out_row = out_data + i * input_width;
+      std::memcpy(out_row, sorted_rows[starts[i]].second,
+                  input_width * sizeof(T));
+      for (size_t k = starts[i] + 1; k < starts[i + 1]; ++k) {
+        add(sorted_rows[k].second, out_row);
+      }
+    });
   }
 };
 
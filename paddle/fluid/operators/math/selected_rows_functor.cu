@@ -15,6 +15,7 @@ limitations under the License. */
 #include <set>
 #include <vector>
 
+#include "paddle/fluid/operators/math/algorithm.h"
 #include "paddle/fluid/operators/math/math_function.h"
 #include "paddle/fluid/operators/math/selected_rows_functor.h"
 #include "paddle/fluid/platform/cuda_primitives.h"
@@ -246,12 +247,9 @@ __global__ void MergeAddKernel(const T* input, const int64_t* input_rows,
   int tid = threadIdx.x;
   __shared__ size_t out_idx;
 
+  // The out rows are sorted.
   if (tid == 0) {
-    for (size_t i = 0; i < out_rows_size; i++) {
-      if (input_rows[ty] == out_rows[i]) {
-        out_idx = i;
-      }
-    }
+    out_idx = BinarySearch<int64_t>(out_rows, out_rows_size, input_rows[ty]);
   }
 
   __syncthreads();
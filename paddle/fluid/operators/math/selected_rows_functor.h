@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 #pragma once
 
+#include <functional>
 #include <map>
 #include <vector>
 
@@ -74,6 +75,16 @@ struct SelectedRowsAddToTensor {
                   framework::Tensor* input2);
 };
 
+/*
+ * Call update(i) for every i in [0, row_count) on the CPU. The indices are
+ * spread over at most FLAGS_sparse_update_threads shards by the ids in rows,
+ * the same way as the shards of framework::ConcurrentIdIndex, and the shards
+ * are updated in parallel. The indices of the same id are in the same shard,
+ * so an update which only writes the row of rows[i] needs no lock.
+ */
+void ShardedRowsUpdate(const int64_t* rows, size_t row_count,
+                       const std::function<void(size_t i)>& update);
+
 namespace scatter {
 // functors for manuplating SelectedRows data
 template <typename DeviceContext, typename T>
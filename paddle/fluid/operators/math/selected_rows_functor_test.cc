@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/math/selected_rows_functor.h"
 #include <vector>
+#include "gflags/gflags.h"
 #include "gtest/gtest.h"
 #include "paddle/fluid/operators/math/math_function.h"
 
@@ -450,3 +451,86 @@ TEST(selected_rows_functor, cpu_sum_to) {
   // row9: 2.0 + 3.0
   EXPECT_EQ(tensor1_data[9 * row_numel + 6], 5.0);
 }
+
+DECLARE_int32(sparse_update_threads);
+
+TEST(selected_rows_functor, cpu_sharded_rows_update) {
+  FLAGS_sparse_update_threads = 4;
+  // Every id is repeated, the repeated ids are updated in the same thread.
+  std::vector<int64_t> rows;
+  for (int64_t i = 0; i < 8192; ++i) {
+    rows.push_back(i % 3000);
+  }
+  std::vector<int64_t> sums(3000, 0);
+  std::vector<int> counts(rows.size(), 0);
+  paddle::operators::math::ShardedRowsUpdate(
+      rows.data(), rows.size(), [&](size_t i) {
+        ++counts[i];
+        sums[rows[i]] += static_cast<int64_t>(i);
+      });
+  for (size_t i = 0; i < rows.size(); ++i) {
+    EXPECT_EQ(counts[i], 1);
+  }
+  for (int64_t id = 0; id < 3000; ++id) {
+    int64_t expected = 0;
+    for (int64_t i = id; i < 8192; i += 3000) expected += i;
+    EXPECT_EQ(sums[id], expected);
+  }
+  FLAGS_sparse_update_threads = 1;
+}
+
+TEST(selected_rows_functor, cpu_merge_add_many_inputs) {
+  FLAGS_sparse_update_threads = 4;
+  paddle::platform::CPUPlace cpu_place;
+  paddle::platform::CPUDeviceContext ctx(cpu_place);
+  // The gradients of many trainers, whose rows overlap, are merged at once.
+  int64_t height = 5000;
+  int64_t row_numel = 19;
+  int num_inputs = 20;
+  std::vector<std::unique_ptr<paddle::framework::SelectedRows>> grads;
+  std::vector<const paddle::framework::SelectedRows*> inputs;
+  std::vector<float> expected(height * row_numel, 0);
+  std::vector<bool> used(height, false);
+  for (int k = 0; k < num_inputs; ++k) {
+    std::vector<int64_t> rows;
+    for (int64_t i = 0; i < 500; ++i) {
+      rows.push_back((i * 7 + k * 131) % height);
+    }
+    grads.emplace_back(new paddle::framework::SelectedRows(rows, height));
+    auto* data = grads.back()->mutable_value()->mutable_data<float>(
+        paddle::framework::make_ddim(
+            {static_cast<int64_t>(rows.size()), row_numel}),
+        cpu_place);
+    for (size_t i = 0; i < rows.size(); ++i) {
+      used[rows[i]] = true;
+      for (int64_t j = 0; j < row_numel; ++j) {
+        data[i * row_numel + j] = static_cast<float>(k + j);
+        expected[rows[i] * row_numel + j] += static_cast<float>(k + j);
+      }
+    }
+    inputs.push_back(grads.back().get());
+  }
+
+  paddle::framework::SelectedRows output;
+  paddle::operators::math::scatter::MergeAdd<paddle::platform::CPUDeviceContext,
+                                             float>
+      merge_add_functor;
+  merge_add_functor(ctx, inputs, &output);
+
+  std::vector<int64_t> ret_rows;
+  for (int64_t id = 0; id < height; ++id) {
+    if (used[id]) ret_rows.push_back(id);
+  }
+  EXPECT_EQ(output.rows(), ret_rows);
+  EXPECT_EQ(output.value().dims(),
+            paddle::framework::make_ddim(
+                {static_cast<int64_t>(ret_rows.size()), row_numel}));
+  auto* out_data = output.value().data<float>();
+  for (size_t i = 0; i < ret_rows.size(); ++i) {
+    for (int64_t j = 0; j < row_numel; ++j) {
+      EXPECT_EQ(out_data[i * row_numel + j],
+                expected[ret_rows[i] * row_numel + j]);
+    }
+  }
+  FLAGS_sparse_update_threads = 1;
+}
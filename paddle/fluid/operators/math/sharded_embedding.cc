@@ -0,0 +1,48 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/sharded_embedding.h"
+
+#include <cstring>
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+template <typename T>
+class ShardedLookupFunctor<platform::CPUDeviceContext, T> {
+ public:
+  void operator()(const platform::CPUDeviceContext& context,
+                  const framework::Tensor& table, const int64_t* ids,
+                  int64_t num_ids, int64_t start, int64_t padding_idx,
+                  T* out) {
+    int64_t rows = table.dims()[0];
+    if (rows == 0) return;
+    int64_t width = table.dims()[1];
+    const T* table_data = table.data<T>();
+    for (int64_t i = 0; i < num_ids; ++i) {
+      int64_t row = ids[i] - start;
+      if (ids[i] == padding_idx || row < 0 || row >= rows) continue;
+      std::memcpy(out + i * width, table_data + row * width,
+                  width * sizeof(T));
+    }
+  }
+};
+
+template class ShardedLookupFunctor<platform::CPUDeviceContext, float>;
+template class ShardedLookupFunctor<platform::CPUDeviceContext, double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,65 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/sharded_embedding.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+template <typename T, int BlockDimX, int BlockDimY, int GridDimX>
+__global__ void ShardedLookup(T* out, const T* table, const int64_t* ids,
+                              const int64_t rows, const int64_t num_ids,
+                              const int64_t width, const int64_t start,
+                              const int64_t padding_idx) {
+  int idx = threadIdx.x;
+  int idy = blockIdx.x + threadIdx.y * GridDimX;
+
+  while (idy < num_ids) {
+    int64_t row = ids[idy] - start;
+    if (ids[idy] != padding_idx && row >= 0 && row < rows) {
+      T* dst = out + idy * width;
+      const T* src = table + row * width;
+      for (int i = idx; i < width; i += BlockDimX) {
+        dst[i] = src[i];
+      }
+    }
+    idy += BlockDimY * GridDimX;
+  }
+}
+
+template <typename T>
+class ShardedLookupFunctor<platform::CUDADeviceContext, T> {
+ public:
+  void operator()(const platform::CUDADeviceContext& context,
+                  const framework::Tensor& table, const int64_t* ids,
+                  int64_t num_ids, int64_t start, int64_t padding_idx,
+                  T* out) {
+    int64_t rows = table.dims()[0];
+    if (num_ids == 0 || rows == 0) return;
+    int64_t width = table.dims()[1];
+    dim3 threads(128, 8);
+    dim3 grids(8, 1);
+    ShardedLookup<T, 128, 8, 8><<<grids, threads, 0, context.stream()>>>(
+        out, table.data<T>(), ids, rows, num_ids, width, start, padding_idx);
+  }
+};
+
+template class ShardedLookupFunctor<platform::CUDADeviceContext, float>;
+template class ShardedLookupFunctor<platform::CUDADeviceContext, double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,51 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+/*
+ * \brief   Look up the ids in a shard of the embedding table.
+ *
+ *  The shard holds the rows [start, start + table rows) of the whole table.
+ *  The rows of the ids in the shard are copied to out, the rows of the other
+ *  ids and of padding_idx are left untouched, so the rows of all the shards
+ *  can be summed.
+ *
+ * \param context       Device context of this functor.
+ * \param table         The shard of shape [rows, width].
+ * \param ids           The ids on the place of the context.
+ * \param num_ids       The number of the ids.
+ * \param start         The id of the first row of the shard.
+ * \param padding_idx   The id of the padding, -1 if there is no padding.
+ * \param out           The output of shape [num_ids, width].
+ *
+ */
+template <typename DeviceContext, typename T>
+class ShardedLookupFunctor {
+ public:
+  void operator()(const DeviceContext& context, const framework::Tensor& table,
+                  const int64_t* ids, int64_t num_ids, int64_t start,
+                  int64_t padding_idx, T* out);
+};
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,87 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+
+#include "paddle/fluid/operators/math/sparse_matmul.h"
+#include <algorithm>
+#include "paddle/fluid/framework/compute_pool.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+template <typename T>
+void DenseToCSC(const T* w, int K, int N, std::vector<int>* offsets,
+                std::vector<int>* indices, std::vector<T>* values) {
+  offsets->assign(N + 1, 0);
+  indices->clear();
+  values->clear();
+  for (int n = 0; n < N; ++n) {
+    for (int k = 0; k < K; ++k) {
+      T v = w[static_cast<int64_t>(k) * N + n];
+      if (v != static_cast<T>(0)) {
+        indices->push_back(k);
+        values->push_back(v);
+      }
+    }
+    (*offsets)[n + 1] = static_cast<int>(indices->size());
+  }
+}
+
+template <typename T>
+void CSCMatMul(int M, int N, int K, const T* X, const int* offsets,
+               const int* indices, const T* values, T* Y, const T* B) {
+  constexpr int kRowBlock = 4;
+  int64_t nnz = offsets[N];
+  int64_t column_cost = std::max<int64_t>(
+      static_cast<int64_t>(M) * nnz / std::max(N, 1), 1);
+  framework::ParallelFor(
+      0, N, framework::GrainSize(column_cost),
+      [&](int64_t begin, int64_t end) {
+        for (int m0 = 0; m0 < M; m0 += kRowBlock) {
+          int rows = std::min(kRowBlock, M - m0);
+          const T* x = X + static_cast<int64_t>(m0) * K;
+          T* y = Y + static_cast<int64_t>(m0) * N;
+          for (int64_t n = begin; n < end; ++n) {
+            T sum[kRowBlock];
+            std::fill(sum, sum + kRowBlock, B ? B[n] : static_cast<T>(0));
+            for (int j = offsets[n]; j < offsets[n + 1]; ++j) {
+              T v = values[j];
+              const T* xk = x + indices[j];
+              for (int r = 0; r < rows; ++r) {
+                sum[r] += v * xk[static_cast<int64_t>(r) * K];
+              }
+            }
+            for (int r = 0; r < rows; ++r) {
+              y[static_cast<int64_t>(r) * N + n] = sum[r];
+            }
+          }
+        }
+      });
+}
+
+template void DenseToCSC<float>(const float*, int, int, std::vector<int>*,
+                                std::vector<int>*, std::vector<float>*);
+template void DenseToCSC<double>(const double*, int, int, std::vector<int>*,
+                                 std::vector<int>*, std::vector<double>*);
+template void CSCMatMul<float>(int, int, int, const float*, const int*,
+                               const int*, const float*, float*,
+                               const float*);
+template void CSCMatMul<double>(int, int, int, const double*, const int*,
+                                const int*, const double*, double*,
+                                const double*);
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
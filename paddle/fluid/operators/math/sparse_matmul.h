@@ -0,0 +1,53 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+
+#pragma once
+
+#include <vector>
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+/*
+ * \brief The pruned weights W [K, N] of the fc and mul ops in the CSC
+ *        format: the nonzeros of the column n of W are
+ *        values[offsets[n]:offsets[n + 1]], in the rows
+ *        indices[offsets[n]:offsets[n + 1]], in the ascending order.
+ *
+ * The columns are the output features, so that every element of the output
+ * is a gather of its input row by the nonzeros of one column, and the
+ * columns are split among the threads without any scatter conflict.
+ */
+template <typename T>
+void DenseToCSC(const T* w, int K, int N, std::vector<int>* offsets,
+                std::vector<int>* indices, std::vector<T>* values);
+
+/*
+ * \brief Y [M, N] = X [M, K] * W + B, where W is in the CSC format of
+ *        DenseToCSC, and B [N] is optional.
+ *
+ * The rows of X are taken a block at a time, so that the nonzeros of a
+ * column are read once for the block, and the time is proportional to the
+ * nonzeros instead of K * N.
+ */
+template <typename T>
+void CSCMatMul(int M, int N, int K, const T* X, const int* offsets,
+               const int* indices, const T* values, T* Y,
+               const T* B = nullptr);
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
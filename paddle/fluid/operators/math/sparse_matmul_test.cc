@@ -0,0 +1,72 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+
+#include "paddle/fluid/operators/math/sparse_matmul.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+namespace math = paddle::operators::math;
+
+// A [K, N] weight with about `sparsity` of zeros.
+static std::vector<float> PrunedWeight(int K, int N, float sparsity) {
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  std::vector<float> w(K * N);
+  for (auto& v : w) {
+    v = (dist(rng) + 1.f) / 2.f < sparsity ? 0.f : dist(rng);
+  }
+  return w;
+}
+
+TEST(SparseMatMul, dense_to_csc) {
+  // 1 0 2
+  // 0 0 3
+  std::vector<float> w = {1, 0, 2, 0, 0, 3};
+  std::vector<int> offsets, indices;
+  std::vector<float> values;
+  math::DenseToCSC(w.data(), 2, 3, &offsets, &indices, &values);
+  EXPECT_EQ(offsets, std::vector<int>({0, 1, 1, 3}));
+  EXPECT_EQ(indices, std::vector<int>({0, 0, 1}));
+  EXPECT_EQ(values, std::vector<float>({1, 2, 3}));
+}
+
+TEST(SparseMatMul, csc_matmul) {
+  const int M = 7, K = 37, N = 19;
+  std::vector<float> w = PrunedWeight(K, N, 0.8f);
+  std::vector<float> x(M * K), b(N);
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  for (auto& v : x) v = dist(rng);
+  for (auto& v : b) v = dist(rng);
+
+  std::vector<int> offsets, indices;
+  std::vector<float> values;
+  math::DenseToCSC(w.data(), K, N, &offsets, &indices, &values);
+  EXPECT_LT(values.size(), w.size() / 2);
+
+  for (bool with_bias : {false, true}) {
+    std::vector<float> y(M * N);
+    math::CSCMatMul(M, N, K, x.data(), offsets.data(), indices.data(),
+                    values.data(), y.data(), with_bias ? b.data() : nullptr);
+    for (int m = 0; m < M; ++m) {
+      for (int n = 0; n < N; ++n) {
+        float expected = with_bias ? b[n] : 0.f;
+        for (int k = 0; k < K; ++k) expected += x[m * K + k] * w[k * N + n];
+        EXPECT_NEAR(y[m * N + n], expected, 1e-5);
+      }
+    }
+  }
+}
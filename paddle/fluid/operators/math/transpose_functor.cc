@@ -0,0 +1,212 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/transpose_functor.h"
+#include <algorithm>
+#include "paddle/fluid/framework/compute_pool.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/float16.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+TransposeLayout SimplifyTranspose(const framework::DDim& in_dims,
+                                  const std::vector<int>& axis,
+                                  const std::vector<int64_t>& out_strides) {
+  int rank = in_dims.size();
+  PADDLE_ENFORCE_EQ(static_cast<int>(axis.size()), rank,
+                    "The axis of transpose should be of the rank of input.");
+  PADDLE_ENFORCE_LE(rank, kMaxTransposeRank,
+                    "Tensors with rank at most %d are supported.",
+                    kMaxTransposeRank);
+  PADDLE_ENFORCE(out_strides.empty() ||
+                     static_cast<int>(out_strides.size()) == rank,
+                 "The strides of the output should be of the rank of input.");
+  std::vector<int64_t> in_strides(rank, 1);
+  for (int d = rank - 2; d >= 0; --d) {
+    in_strides[d] = in_strides[d + 1] * in_dims[d + 1];
+  }
+  std::vector<int64_t> dense_out_strides(rank, 1);
+  for (int d = rank - 2; d >= 0; --d) {
+    dense_out_strides[d] = dense_out_strides[d + 1] * in_dims[axis[d + 1]];
+  }
+  const auto& strides = out_strides.empty() ? dense_out_strides : out_strides;
+
+  TransposeLayout layout;
+  layout.rank = 0;
+  for (int d = 0; d < rank; ++d) {
+    PADDLE_ENFORCE(axis[d] >= 0 && axis[d] < rank,
+                   "The axis of transpose should be in [0, %d).", rank);
+    int64_t size = in_dims[axis[d]];
+    if (size == 1) continue;
+    int64_t in_stride = in_strides[axis[d]];
+    int64_t out_stride = strides[d];
+    int last = layout.rank - 1;
+    // The dim continues the last one in both the input and the output.
+    if (last >= 0 && layout.in_strides[last] == size * in_stride &&
+        layout.out_strides[last] == size * out_stride) {
+      layout.dims[last] *= size;
+      layout.in_strides[last] = in_stride;
+      layout.out_strides[last] = out_stride;
+      continue;
+    }
+    layout.dims[layout.rank] = size;
+    layout.in_strides[layout.rank] = in_stride;
+    layout.out_strides[layout.rank] = out_stride;
+    ++layout.rank;
+  }
+  if (layout.rank == 0) {
+    layout.rank = 1;
+    layout.dims[0] = 1;
+    layout.in_strides[0] = 1;
+    layout.out_strides[0] = 1;
+  }
+  return layout;
+}
+
+int TransposeTileDim(const TransposeLayout& layout) {
+  int inner = layout.rank - 1;
+  if (layout.out_strides[inner] != 1 || layout.in_strides[inner] == 1) {
+    return -1;
+  }
+  for (int d = 0; d < inner; ++d) {
+    if (layout.in_strides[d] == 1) return d;
+  }
+  return -1;
+}
+
+TransposeLayout RemoveTransposeDims(const TransposeLayout& layout, int a,
+                                    int b) {
+  TransposeLayout batch;
+  batch.rank = 0;
+  for (int d = 0; d < layout.rank; ++d) {
+    if (d == a || d == b) continue;
+    batch.dims[batch.rank] = layout.dims[d];
+    batch.in_strides[batch.rank] = layout.in_strides[d];
+    batch.out_strides[batch.rank] = layout.out_strides[d];
+    ++batch.rank;
+  }
+  return batch;
+}
+
+// The tiles of the transpose on CPU, whose rows of the input and the output
+// stay in L1.
+static constexpr int64_t kTransposeTile = 32;
+
+template <typename T>
+static void TransposeOnCPU(const TransposeLayout& layout, const T* in,
+                           T* out) {
+  int inner = layout.rank - 1;
+  int64_t inner_size = layout.dims[inner];
+  int64_t outer_size = 1;
+  for (int d = 0; d < inner; ++d) outer_size *= layout.dims[d];
+
+  if (layout.in_strides[inner] == 1 && layout.out_strides[inner] == 1) {
+    framework::ParallelFor(0, outer_size, framework::GrainSize(inner_size),
+                           [&](int64_t begin, int64_t end) {
+                             for (int64_t i = begin; i < end; ++i) {
+                               int64_t in_offset, out_offset;
+                               TransposeOffsets(layout, inner, i, &in_offset,
+                                                &out_offset);
+                               std::copy(in + in_offset,
+                                         in + in_offset + inner_size,
+                                         out + out_offset);
+                             }
+                           });
+    return;
+  }
+
+  int a = TransposeTileDim(layout);
+  if (a >= 0) {
+    // out[.., a, .., b] = in[.., b, .., a], the rows of a are contiguous in
+    // the input, the rows of b in the output.
+    auto batch = RemoveTransposeDims(layout, a, inner);
+    int64_t batch_size = 1;
+    for (int d = 0; d < batch.rank; ++d) batch_size *= batch.dims[d];
+    int64_t size_a = layout.dims[a];
+    int64_t out_stride_a = layout.out_strides[a];
+    int64_t in_stride_b = layout.in_strides[inner];
+    int64_t tiles_a = (size_a + kTransposeTile - 1) / kTransposeTile;
+    framework::ParallelFor(
+        0, batch_size * tiles_a,
+        framework::GrainSize(kTransposeTile * inner_size),
+        [&](int64_t begin, int64_t end) {
+          for (int64_t t = begin; t < end; ++t) {
+            int64_t in_offset, out_offset;
+            TransposeOffsets(batch, batch.rank, t / tiles_a, &in_offset,
+                             &out_offset);
+            int64_t a0 = t % tiles_a * kTransposeTile;
+            int64_t a1 = std::min(a0 + kTransposeTile, size_a);
+            for (int64_t b0 = 0; b0 < inner_size; b0 += kTransposeTile) {
+              int64_t b1 = std::min(b0 + kTransposeTile, inner_size);
+              for (int64_t i = a0; i < a1; ++i) {
+                const T* src = in + in_offset + i;
+                T* dst = out + out_offset + i * out_stride_a;
+                for (int64_t j = b0; j < b1; ++j) {
+                  dst[j] = src[j * in_stride_b];
+                }
+              }
+            }
+          }
+        });
+    return;
+  }
+
+  int64_t in_stride = layout.in_strides[inner];
+  int64_t out_stride = layout.out_strides[inner];
+  framework::ParallelFor(0, outer_size, framework::GrainSize(inner_size),
+                         [&](int64_t begin, int64_t end) {
+                           for (int64_t i = begin; i < end; ++i) {
+                             int64_t in_offset, out_offset;
+                             TransposeOffsets(layout, inner, i, &in_offset,
+                                              &out_offset);
+                             for (int64_t j = 0; j < inner_size; ++j) {
+                               out[out_offset + j * out_stride] =
+                                   in[in_offset + j * in_stride];
+                             }
+                           }
+                         });
+}
+
+template <typename T>
+struct TransposeNormal<platform::CPUDeviceContext, T> {
+  void operator()(const platform::CPUDeviceContext& context,
+                  const framework::Tensor& in, framework::Tensor* out,
+                  const std::vector<int>& axis) {
+    (*this)(context, in.data<T>(), in.dims(), axis, out->data<T>(), {});
+  }
+
+  void operator()(const platform::CPUDeviceContext& context, const T* in,
+                  const framework::DDim& in_dims, const std::vector<int>& axis,
+                  T* out, const std::vector<int64_t>& out_strides) {
+    if (framework::product(in_dims) == 0) return;
+    TransposeOnCPU(SimplifyTranspose(in_dims, axis, out_strides), in, out);
+  }
+};
+
+template struct TransposeNormal<platform::CPUDeviceContext, float>;
+template struct TransposeNormal<platform::CPUDeviceContext, double>;
+template struct TransposeNormal<platform::CPUDeviceContext, int>;
+template struct TransposeNormal<platform::CPUDeviceContext, int64_t>;
+template struct TransposeNormal<platform::CPUDeviceContext, bool>;
+template struct TransposeNormal<platform::CPUDeviceContext, int16_t>;
+template struct TransposeNormal<platform::CPUDeviceContext, uint8_t>;
+template struct TransposeNormal<platform::CPUDeviceContext, int8_t>;
+template struct TransposeNormal<platform::CPUDeviceContext,
+                                platform::float16>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
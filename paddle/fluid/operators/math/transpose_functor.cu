@@ -0,0 +1,207 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <cstdint>
+#include "paddle/fluid/operators/math/transpose_functor.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+#include "paddle/fluid/platform/float16.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+constexpr int kTileDim = 32;
+constexpr int kTileRows = 8;
+
+// The runs of the innermost dim, which is kept, are copied by VecT, of the
+// strides of the layout in VecT.
+template <typename VecT>
+__global__ void KeTransposeRuns(const VecT* in, VecT* out,
+                                TransposeLayout layout, int64_t numel) {
+  int inner = layout.rank - 1;
+  int64_t run = layout.dims[inner];
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < numel;
+       i += blockDim.x * gridDim.x) {
+    int64_t in_offset, out_offset;
+    TransposeOffsets(layout, inner, i / run, &in_offset, &out_offset);
+    int64_t j = i % run;
+    out[out_offset + j] = in[in_offset + j];
+  }
+}
+
+// Every block transposes a tile of [kTileDim, kTileDim] of the dims a of
+// the input rows and b of the output rows through the shared memory, so
+// that both the reads and the writes are coalesced.
+template <typename T>
+__global__ void KeTransposeTiled(const T* in, T* out, TransposeLayout batch,
+                                 int64_t batch_size, int64_t size_a,
+                                 int64_t size_b, int64_t out_stride_a,
+                                 int64_t in_stride_b) {
+  __shared__ T tile[kTileDim][kTileDim + 1];
+  int64_t tiles_a = (size_a + kTileDim - 1) / kTileDim;
+  int64_t tiles_b = (size_b + kTileDim - 1) / kTileDim;
+  for (int64_t t = blockIdx.x; t < batch_size * tiles_a * tiles_b;
+       t += gridDim.x) {
+    int64_t a0 = t % tiles_a * kTileDim;
+    int64_t b0 = t / tiles_a % tiles_b * kTileDim;
+    int64_t in_offset, out_offset;
+    TransposeOffsets(batch, batch.rank, t / (tiles_a * tiles_b), &in_offset,
+                     &out_offset);
+    int64_t a = a0 + threadIdx.x;
+    for (int k = threadIdx.y; k < kTileDim; k += kTileRows) {
+      int64_t b = b0 + k;
+      if (a < size_a && b < size_b) {
+        tile[k][threadIdx.x] = in[in_offset + a + b * in_stride_b];
+      }
+    }
+    __syncthreads();
+    int64_t b = b0 + threadIdx.x;
+    for (int k = threadIdx.y; k < kTileDim; k += kTileRows) {
+      int64_t a = a0 + k;
+      if (a < size_a && b < size_b) {
+        out[out_offset + a * out_stride_a + b] = tile[threadIdx.x][k];
+      }
+    }
+    __syncthreads();
+  }
+}
+
+template <typename T>
+__global__ void KeTransposeElements(const T* in, T* out,
+                                    TransposeLayout layout, int64_t numel) {
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < numel;
+       i += blockDim.x * gridDim.x) {
+    int64_t in_offset, out_offset;
+    TransposeOffsets(layout, layout.rank, i, &in_offset, &out_offset);
+    out[out_offset] = in[in_offset];
+  }
+}
+
+static int TransposeGrids(int64_t n, int threads) {
+  return static_cast<int>(
+      std::min<int64_t>((n + threads - 1) / threads, 65536));
+}
+
+// Whether the runs of the layout can be copied by the vectors of width
+// elements.
+static bool CanCopyRunsBy(const TransposeLayout& layout, const void* in,
+                          const void* out, int64_t width, size_t bytes) {
+  if (reinterpret_cast<uintptr_t>(in) % bytes != 0 ||
+      reinterpret_cast<uintptr_t>(out) % bytes != 0) {
+    return false;
+  }
+  int inner = layout.rank - 1;
+  if (layout.dims[inner] % width != 0) return false;
+  for (int d = 0; d < inner; ++d) {
+    if (layout.in_strides[d] % width != 0 ||
+        layout.out_strides[d] % width != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename VecT, typename T>
+static void CopyRuns(const platform::CUDADeviceContext& context,
+                     TransposeLayout layout, const T* in, T* out,
+                     int64_t numel) {
+  int64_t width = sizeof(VecT) / sizeof(T);
+  int inner = layout.rank - 1;
+  layout.dims[inner] /= width;
+  for (int d = 0; d < inner; ++d) {
+    layout.in_strides[d] /= width;
+    layout.out_strides[d] /= width;
+  }
+  int threads = 512;
+  int64_t n = numel / width;
+  KeTransposeRuns<VecT><<<TransposeGrids(n, threads), threads, 0,
+                          context.stream()>>>(
+      reinterpret_cast<const VecT*>(in), reinterpret_cast<VecT*>(out), layout,
+      n);
+}
+
+template <typename T>
+static void TransposeOnGPU(const platform::CUDADeviceContext& context,
+                           const TransposeLayout& layout, const T* in, T* out,
+                           int64_t numel) {
+  int inner = layout.rank - 1;
+  if (layout.in_strides[inner] == 1 && layout.out_strides[inner] == 1) {
+    // The runs are copied by 16 bytes if they are aligned.
+    if (sizeof(T) <= 16 && 16 % sizeof(T) == 0 &&
+        CanCopyRunsBy(layout, in, out, 16 / sizeof(T), 16)) {
+      CopyRuns<int4>(context, layout, in, out, numel);
+    } else if (sizeof(T) <= 4 && 4 % sizeof(T) == 0 &&
+               CanCopyRunsBy(layout, in, out, 4 / sizeof(T), 4)) {
+      CopyRuns<int>(context, layout, in, out, numel);
+    } else {
+      CopyRuns<T>(context, layout, in, out, numel);
+    }
+    return;
+  }
+
+  int a = TransposeTileDim(layout);
+  if (a >= 0) {
+    auto batch = RemoveTransposeDims(layout, a, inner);
+    int64_t batch_size = 1;
+    for (int d = 0; d < batch.rank; ++d) batch_size *= batch.dims[d];
+    int64_t size_a = layout.dims[a];
+    int64_t size_b = layout.dims[inner];
+    int64_t tiles = batch_size * ((size_a + kTileDim - 1) / kTileDim) *
+                    ((size_b + kTileDim - 1) / kTileDim);
+    dim3 threads(kTileDim, kTileRows);
+    int grids = static_cast<int>(std::min<int64_t>(tiles, 65536));
+    KeTransposeTiled<T><<<grids, threads, 0, context.stream()>>>(
+        in, out, batch, batch_size, size_a, size_b, layout.out_strides[a],
+        layout.in_strides[inner]);
+    return;
+  }
+
+  int threads = 512;
+  KeTransposeElements<T><<<TransposeGrids(numel, threads), threads, 0,
+                           context.stream()>>>(in, out, layout, numel);
+}
+
+template <typename T>
+struct TransposeNormal<platform::CUDADeviceContext, T> {
+  void operator()(const platform::CUDADeviceContext& context,
+                  const framework::Tensor& in, framework::Tensor* out,
+                  const std::vector<int>& axis) {
+    (*this)(context, in.data<T>(), in.dims(), axis, out->data<T>(), {});
+  }
+
+  void operator()(const platform::CUDADeviceContext& context, const T* in,
+                  const framework::DDim& in_dims, const std::vector<int>& axis,
+                  T* out, const std::vector<int64_t>& out_strides) {
+    int64_t numel = framework::product(in_dims);
+    if (numel == 0) return;
+    TransposeOnGPU(context, SimplifyTranspose(in_dims, axis, out_strides), in,
+                   out, numel);
+  }
+};
+
+template struct TransposeNormal<platform::CUDADeviceContext, float>;
+template struct TransposeNormal<platform::CUDADeviceContext, double>;
+template struct TransposeNormal<platform::CUDADeviceContext, int>;
+template struct TransposeNormal<platform::CUDADeviceContext, int64_t>;
+template struct TransposeNormal<platform::CUDADeviceContext, bool>;
+template struct TransposeNormal<platform::CUDADeviceContext, int16_t>;
+template struct TransposeNormal<platform::CUDADeviceContext, uint8_t>;
+template struct TransposeNormal<platform::CUDADeviceContext, int8_t>;
+template struct TransposeNormal<platform::CUDADeviceContext,
+                                platform::float16>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
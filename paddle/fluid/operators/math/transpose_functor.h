@@ -0,0 +1,103 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "paddle/fluid/framework/ddim.h"
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/hostdevice.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+/*
+ * The transpose of any rank as a strided copy, out[o] = in[i], where the
+ * offsets are sum(index[d] * out_strides[d]) and sum(index[d] *
+ * in_strides[d]) over the dims of the output.
+ *
+ * The dims of 1 are dropped and the dims adjacent in both the input and the
+ * output are merged, so that most of the permutations are reduced to the rank
+ * 2 or 3, e.g. [N, C, H, W] -> [N, H, W, C] is [N, C, H * W] -> [N, H * W,
+ * C]. The copy is then
+ *  - the copy of the runs, if the innermost dim is kept, e.g. [B, S, H, D]
+ *    -> [B, H, S, D] of the attention;
+ *  - the tiled transpose of the innermost dims of the input and the output,
+ *    batched over the other dims, which reads and writes both in the tiles
+ *    (of the cache on CPU, of the shared memory on GPU);
+ *  - the copy by element, for the rest.
+ */
+constexpr int kMaxTransposeRank = 9;
+
+struct TransposeLayout {
+  int rank;
+  int64_t dims[kMaxTransposeRank];
+  int64_t in_strides[kMaxTransposeRank];
+  int64_t out_strides[kMaxTransposeRank];
+};
+
+// The simplified layout of the transpose of in_dims by axis, into the output
+// whose dim d has the stride out_strides[d], or is contiguous if out_strides
+// is empty.
+TransposeLayout SimplifyTranspose(const framework::DDim& in_dims,
+                                  const std::vector<int>& axis,
+                                  const std::vector<int64_t>& out_strides);
+
+// The dim of the output which is the innermost dim of the input, if the
+// innermost dim of the output is contiguous and another one, so that the
+// copy is the tiled transpose of the two; otherwise -1.
+int TransposeTileDim(const TransposeLayout& layout);
+
+// The layout of the dims of layout except the dims a and b, over which the
+// tiled transpose of a and b is batched.
+TransposeLayout RemoveTransposeDims(const TransposeLayout& layout, int a,
+                                    int b);
+
+// The offsets of the index-th element, in the order of the output, of the
+// first rank dims of layout.
+HOSTDEVICE inline void TransposeOffsets(const TransposeLayout& layout,
+                                        int rank, int64_t index,
+                                        int64_t* in_offset,
+                                        int64_t* out_offset) {
+  int64_t in = 0;
+  int64_t out = 0;
+  for (int d = rank - 1; d >= 0; --d) {
+    int64_t i = index % layout.dims[d];
+    index /= layout.dims[d];
+    in += i * layout.in_strides[d];
+    out += i * layout.out_strides[d];
+  }
+  *in_offset = in;
+  *out_offset = out;
+}
+
+// out = transpose(in, axis), out is of the transposed dims.
+template <typename DeviceContext, typename T>
+struct TransposeNormal {
+  void operator()(const DeviceContext& context, const framework::Tensor& in,
+                  framework::Tensor* out, const std::vector<int>& axis);
+
+  // The transpose of in of in_dims into out of the strides out_strides of the
+  // transposed dims, e.g. a slice of a bigger tensor.
+  void operator()(const DeviceContext& context, const T* in,
+                  const framework::DDim& in_dims, const std::vector<int>& axis,
+                  T* out, const std::vector<int64_t>& out_strides);
+};
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,133 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/transpose_functor.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+namespace math = paddle::operators::math;
+
+// The transpose of in of dims by axis into out of out_strides, by element.
+static void NaiveTranspose(const std::vector<float>& in,
+                           const std::vector<int64_t>& dims,
+                           const std::vector<int>& axis,
+                           const std::vector<int64_t>& out_strides,
+                           std::vector<float>* out) {
+  int rank = dims.size();
+  std::vector<int64_t> in_strides(rank, 1);
+  for (int d = rank - 2; d >= 0; --d) {
+    in_strides[d] = in_strides[d + 1] * dims[d + 1];
+  }
+  for (size_t i = 0; i < in.size(); ++i) {
+    // The index of the output in the order of the output.
+    int64_t rest = i;
+    int64_t in_offset = 0;
+    int64_t out_offset = 0;
+    for (int d = rank - 1; d >= 0; --d) {
+      int64_t index = rest % dims[axis[d]];
+      rest /= dims[axis[d]];
+      in_offset += index * in_strides[axis[d]];
+      out_offset += index * out_strides[d];
+    }
+    (*out)[out_offset] = in[in_offset];
+  }
+}
+
+static void TestTranspose(const std::vector<int64_t>& dims,
+                          const std::vector<int>& axis,
+                          int64_t pad_inner = 0) {
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceContext context(place);
+  int rank = dims.size();
+  int64_t numel = 1;
+  for (auto d : dims) numel *= d;
+  std::vector<float> in(numel);
+  for (int64_t i = 0; i < numel; ++i) in[i] = static_cast<float>(i);
+
+  // The output rows are padded by pad_inner, as a slice of a bigger tensor.
+  std::vector<int64_t> out_strides(rank, 1);
+  for (int d = rank - 2; d >= 0; --d) {
+    out_strides[d] = out_strides[d + 1] * dims[axis[d + 1]] +
+                     (d == rank - 2 ? pad_inner : 0);
+  }
+  int64_t out_size = out_strides[0] * dims[axis[0]];
+  std::vector<float> expected(out_size, -1);
+  NaiveTranspose(in, dims, axis, out_strides, &expected);
+
+  std::vector<float> out(out_size, -1);
+  math::TransposeNormal<paddle::platform::CPUDeviceContext, float> trans;
+  trans(context, in.data(), paddle::framework::make_ddim(dims), axis,
+        out.data(), pad_inner == 0 ? std::vector<int64_t>() : out_strides);
+  for (int64_t i = 0; i < out_size; ++i) {
+    ASSERT_EQ(out[i], expected[i]) << "at " << i;
+  }
+
+  if (pad_inner == 0) {
+    paddle::framework::Tensor in_t, out_t;
+    std::vector<int64_t> out_dims(rank);
+    for (int d = 0; d < rank; ++d) out_dims[d] = dims[axis[d]];
+    float* in_data =
+        in_t.mutable_data<float>(paddle::framework::make_ddim(dims), place);
+    std::copy(in.begin(), in.end(), in_data);
+    float* out_data = out_t.mutable_data<float>(
+        paddle::framework::make_ddim(out_dims), place);
+    trans(context, in_t, &out_t, axis);
+    for (int64_t i = 0; i < numel; ++i) {
+      ASSERT_EQ(out_data[i], expected[i]) << "at " << i;
+    }
+  }
+}
+
+TEST(transpose_functor, simplify) {
+  // [B, S, H, D] -> [B, H, S, D] copies the runs of D.
+  auto layout = math::SimplifyTranspose(
+      paddle::framework::make_ddim({2, 5, 4, 8}), {0, 2, 1, 3}, {});
+  ASSERT_EQ(layout.rank, 4);
+  EXPECT_EQ(layout.in_strides[3], 1);
+  EXPECT_EQ(layout.out_strides[3], 1);
+
+  // The dims of 1 are dropped and the adjacent dims are merged.
+  layout = math::SimplifyTranspose(
+      paddle::framework::make_ddim({2, 1, 3, 4, 5}), {0, 1, 4, 2, 3}, {});
+  ASSERT_EQ(layout.rank, 3);
+  EXPECT_EQ(layout.dims[0], 2);
+  EXPECT_EQ(layout.dims[1], 5);
+  EXPECT_EQ(layout.dims[2], 12);
+  EXPECT_EQ(math::TransposeTileDim(layout), 1);
+
+  layout = math::SimplifyTranspose(paddle::framework::make_ddim({3, 4, 5}),
+                                   {0, 1, 2}, {});
+  ASSERT_EQ(layout.rank, 1);
+  EXPECT_EQ(layout.dims[0], 60);
+}
+
+TEST(transpose_functor, cpu) {
+  TestTranspose({7}, {0});
+  TestTranspose({70, 45}, {1, 0});
+  TestTranspose({1, 1}, {1, 0});
+  TestTranspose({2, 5, 4, 8}, {0, 2, 1, 3});
+  TestTranspose({2, 5, 4, 3}, {0, 2, 3, 1});
+  TestTranspose({2, 3, 4, 5}, {3, 2, 1, 0});
+  TestTranspose({2, 1, 3, 4, 5}, {0, 1, 4, 2, 3});
+  TestTranspose({3, 2, 4, 1, 3, 2}, {5, 0, 3, 2, 4, 1});
+  TestTranspose({40, 3, 33}, {2, 1, 0});
+}
+
+TEST(transpose_functor, cpu_strided_output) {
+  TestTranspose({3, 4, 5}, {0, 2, 1}, 3);
+  TestTranspose({3, 4, 5}, {2, 0, 1}, 2);
+  TestTranspose({2, 3, 4, 5}, {0, 1, 2, 3}, 4);
+  TestTranspose({6, 5}, {1, 0}, 1);
+}
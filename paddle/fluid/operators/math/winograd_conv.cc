@@ -0,0 +1,284 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/winograd_conv.h"
+#include <algorithm>
+#include <vector>
+#include "paddle/fluid/operators/math/blas.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The transforms of F(m x m, 3 x 3) from "Fast Algorithms for Convolutional
+// Neural Networks", Lavin and Gray: Y = AT [(G g GT) * (BT d B)] A.
+template <int M>
+struct WinogradMatrices;
+
+template <>
+struct WinogradMatrices<2> {
+  static constexpr int kAlpha = 4;
+  static constexpr double kBT[4][4] = {
+      {1, 0, -1, 0}, {0, 1, 1, 0}, {0, -1, 1, 0}, {0, 1, 0, -1}};
+  static constexpr double kG[4][3] = {
+      {1, 0, 0}, {0.5, 0.5, 0.5}, {0.5, -0.5, 0.5}, {0, 0, 1}};
+  static constexpr double kAT[2][4] = {{1, 1, 1, 0}, {0, 1, -1, -1}};
+};
+
+template <>
+struct WinogradMatrices<4> {
+  static constexpr int kAlpha = 6;
+  static constexpr double kBT[6][6] = {
+      {4, 0, -5, 0, 1, 0},  {0, -4, -4, 1, 1, 0}, {0, 4, -4, -1, 1, 0},
+      {0, -2, -1, 2, 1, 0}, {0, 2, -1, -2, 1, 0}, {0, 4, 0, -5, 0, 1}};
+  static constexpr double kG[6][3] = {{1.0 / 4, 0, 0},
+                                      {-1.0 / 6, -1.0 / 6, -1.0 / 6},
+                                      {-1.0 / 6, 1.0 / 6, -1.0 / 6},
+                                      {1.0 / 24, 1.0 / 12, 1.0 / 6},
+                                      {1.0 / 24, -1.0 / 12, 1.0 / 6},
+                                      {0, 0, 1}};
+  static constexpr double kAT[4][6] = {{1, 1, 1, 1, 1, 0},
+                                       {0, 1, -1, 2, -2, 0},
+                                       {0, 1, 1, 4, 4, 0},
+                                       {0, 1, -1, 8, -8, 1}};
+};
+
+constexpr double WinogradMatrices<2>::kBT[4][4];
+constexpr double WinogradMatrices<2>::kG[4][3];
+constexpr double WinogradMatrices<2>::kAT[2][4];
+constexpr double WinogradMatrices<4>::kBT[6][6];
+constexpr double WinogradMatrices<4>::kG[6][3];
+constexpr double WinogradMatrices<4>::kAT[4][6];
+
+// The size of the transformed inputs and outputs of a block of tiles, which
+// are kept in the L2 cache between the transforms and the GEMMs.
+static constexpr size_t kTileBlockBytes = 512 * 1024;
+
+template <typename T, int M>
+class WinogradConv3x3 {
+  using Matrices = WinogradMatrices<M>;
+  static constexpr int kAlpha = Matrices::kAlpha;
+
+ public:
+  // u = G g GT
+  static void TransformFilter(const T* g, T* u) {
+    T tmp[kAlpha][3];
+    for (int i = 0; i < kAlpha; ++i) {
+      for (int j = 0; j < 3; ++j) {
+        T sum = 0;
+        for (int k = 0; k < 3; ++k) {
+          sum += static_cast<T>(Matrices::kG[i][k]) * g[k * 3 + j];
+        }
+        tmp[i][j] = sum;
+      }
+    }
+    for (int i = 0; i < kAlpha; ++i) {
+      for (int j = 0; j < kAlpha; ++j) {
+        T sum = 0;
+        for (int k = 0; k < 3; ++k) {
+          sum += tmp[i][k] * static_cast<T>(Matrices::kG[j][k]);
+        }
+        u[i * kAlpha + j] = sum;
+      }
+    }
+  }
+
+  // v = BT d B
+  static void TransformInput(const T (&d)[kAlpha][kAlpha], T* v) {
+    T tmp[kAlpha][kAlpha];
+    for (int i = 0; i < kAlpha; ++i) {
+      for (int j = 0; j < kAlpha; ++j) {
+        T sum = 0;
+        for (int k = 0; k < kAlpha; ++k) {
+          sum += static_cast<T>(Matrices::kBT[i][k]) * d[k][j];
+        }
+        tmp[i][j] = sum;
+      }
+    }
+    for (int i = 0; i < kAlpha; ++i) {
+      for (int j = 0; j < kAlpha; ++j) {
+        T sum = 0;
+        for (int k = 0; k < kAlpha; ++k) {
+          sum += tmp[i][k] * static_cast<T>(Matrices::kBT[j][k]);
+        }
+        v[i * kAlpha + j] = sum;
+      }
+    }
+  }
+
+  // y = AT m A
+  static void TransformOutput(const T* m, T (&y)[M][M]) {
+    T tmp[M][kAlpha];
+    for (int i = 0; i < M; ++i) {
+      for (int j = 0; j < kAlpha; ++j) {
+        T sum = 0;
+        for (int k = 0; k < kAlpha; ++k) {
+          sum += static_cast<T>(Matrices::kAT[i][k]) * m[k * kAlpha + j];
+        }
+        tmp[i][j] = sum;
+      }
+    }
+    for (int i = 0; i < M; ++i) {
+      for (int j = 0; j < M; ++j) {
+        T sum = 0;
+        for (int k = 0; k < kAlpha; ++k) {
+          sum += tmp[i][k] * static_cast<T>(Matrices::kAT[j][k]);
+        }
+        y[i][j] = sum;
+      }
+    }
+  }
+
+  static void Run(const platform::CPUDeviceContext& context,
+                  const framework::Tensor& input,
+                  const framework::Tensor& filter,
+                  const std::vector<int>& paddings,
+                  framework::Tensor* output) {
+    constexpr int kTileElems = kAlpha * kAlpha;
+    const int batch_size = input.dims()[0];
+    const int input_channels = input.dims()[1];
+    const int input_height = input.dims()[2];
+    const int input_width = input.dims()[3];
+    const int output_channels = output->dims()[1];
+    const int output_height = output->dims()[2];
+    const int output_width = output->dims()[3];
+    const int padding_height = paddings[0];
+    const int padding_width = paddings[1];
+    const int tiles_height = (output_height + M - 1) / M;
+    const int tiles_width = (output_width + M - 1) / M;
+    const int num_tiles = tiles_height * tiles_width;
+
+    const T* input_data = input.data<T>();
+    const T* filter_data = filter.data<T>();
+    T* output_data = output->mutable_data<T>(context.GetPlace());
+
+    // U: [kTileElems, K, C]
+    std::vector<T> u(kTileElems * output_channels * input_channels);
+    T ut[kTileElems];
+    for (int k = 0; k < output_channels; ++k) {
+      for (int c = 0; c < input_channels; ++c) {
+        TransformFilter(filter_data + (k * input_channels + c) * 9, ut);
+        for (int xi = 0; xi < kTileElems; ++xi) {
+          u[(xi * output_channels + k) * input_channels + c] = ut[xi];
+        }
+      }
+    }
+
+    const size_t tile_bytes =
+        kTileElems * (input_channels + output_channels) * sizeof(T);
+    const int block = std::max(
+        1, std::min(num_tiles, static_cast<int>(kTileBlockBytes / tile_bytes)));
+    // The transformed data are stored by the position in the tile first, so
+    // each position is a GEMM of U [K, C] and V [C, block].
+    // V: [kTileElems, C, block], the products: [kTileElems, K, block]
+    std::vector<T> v(kTileElems * input_channels * block);
+    std::vector<T> products(kTileElems * output_channels * block);
+
+    auto blas = GetBlas<platform::CPUDeviceContext, T>(context);
+    const int input_size = input_height * input_width;
+    const int output_size = output_height * output_width;
+    T d[kAlpha][kAlpha];
+    T vt[kTileElems];
+    T mt[kTileElems];
+    T y[M][M];
+    for (int n = 0; n < batch_size; ++n) {
+      const T* in = input_data + n * input_channels * input_size;
+      T* out = output_data + n * output_channels * output_size;
+      for (int t0 = 0; t0 < num_tiles; t0 += block) {
+        const int nb = std::min(block, num_tiles - t0);
+
+        for (int c = 0; c < input_channels; ++c) {
+          const T* in_c = in + c * input_size;
+          for (int t = 0; t < nb; ++t) {
+            const int h0 = (t0 + t) / tiles_width * M - padding_height;
+            const int w0 = (t0 + t) % tiles_width * M - padding_width;
+            for (int i = 0; i < kAlpha; ++i) {
+              const int h = h0 + i;
+              for (int j = 0; j < kAlpha; ++j) {
+                const int w = w0 + j;
+                d[i][j] = (h >= 0 && h < input_height && w >= 0 &&
+                           w < input_width)
+                              ? in_c[h * input_width + w]
+                              : static_cast<T>(0);
+              }
+            }
+            TransformInput(d, vt);
+            for (int xi = 0; xi < kTileElems; ++xi) {
+              v[(xi * input_channels + c) * nb + t] = vt[xi];
+            }
+          }
+        }
+
+        for (int xi = 0; xi < kTileElems; ++xi) {
+          blas.GEMM(CblasNoTrans, CblasNoTrans, output_channels, nb,
+                    input_channels, static_cast<T>(1),
+                    u.data() + xi * output_channels * input_channels,
+                    v.data() + xi * input_channels * nb, static_cast<T>(0),
+                    products.data() + xi * output_channels * nb);
+        }
+
+        for (int k = 0; k < output_channels; ++k) {
+          T* out_k = out + k * output_size;
+          for (int t = 0; t < nb; ++t) {
+            for (int xi = 0; xi < kTileElems; ++xi) {
+              mt[xi] = products[(xi * output_channels + k) * nb + t];
+            }
+            TransformOutput(mt, y);
+            const int h0 = (t0 + t) / tiles_width * M;
+            const int w0 = (t0 + t) % tiles_width * M;
+            const int rows = std::min(M, output_height - h0);
+            const int cols = std::min(M, output_width - w0);
+            for (int i = 0; i < rows; ++i) {
+              for (int j = 0; j < cols; ++j) {
+                out_k[(h0 + i) * output_width + w0 + j] = y[i][j];
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+};
+
+template <typename T>
+class WinogradConv3x3Functor<platform::CPUDeviceContext, T> {
+ public:
+  void operator()(const platform::CPUDeviceContext& context,
+                  const framework::Tensor& input,
+                  const framework::Tensor& filter,
+                  const std::vector<int>& paddings, int tile_size,
+                  framework::Tensor* output) {
+    PADDLE_ENFORCE_EQ(input.dims().size(), 4, "The input should be NCHW.");
+    PADDLE_ENFORCE(filter.dims()[2] == 3 && filter.dims()[3] == 3,
+                   "The filter of the Winograd convolution should be 3x3.");
+    PADDLE_ENFORCE_EQ(filter.dims()[1], input.dims()[1],
+                      "The Winograd convolution has only one group.");
+    if (tile_size == 2) {
+      WinogradConv3x3<T, 2>::Run(context, input, filter, paddings, output);
+    } else if (tile_size == 4) {
+      WinogradConv3x3<T, 4>::Run(context, input, filter, paddings, output);
+    } else {
+      PADDLE_THROW("The tile size of the Winograd convolution should be 2 or "
+                   "4, but received %d.",
+                   tile_size);
+    }
+  }
+};
+
+template class WinogradConv3x3Functor<platform::CPUDeviceContext, float>;
+template class WinogradConv3x3Functor<platform::CPUDeviceContext, double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,50 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <vector>
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+/*
+ * \brief Compute the 3x3 convolution of stride 1, dilation 1 and group 1 by
+ * the Winograd minimal filtering F(m x m, 3 x 3), where m, the size of the
+ * output tiles, is 2 or 4.
+ *
+ * The input is split into the overlapped tiles of (m + 2) x (m + 2), the
+ * transformed tiles and filters are multiplied by (m + 2)^2 GEMMs over the
+ * channels, and the products are transformed back to the m x m outputs. The
+ * multiplications are 2.25x (m = 2) or 4x (m = 4) fewer than the direct
+ * convolution, and no column buffer of im2col is needed. The tiles are
+ * processed in blocks that keep the transformed data in the cache.
+ *
+ * input: [N, C, H, W], filter: [K, C, 3, 3], output: [N, K, OH, OW] with
+ * OH = H + 2 * paddings[0] - 2 and OW = W + 2 * paddings[1] - 2.
+ */
+template <typename DeviceContext, typename T>
+class WinogradConv3x3Functor {
+ public:
+  void operator()(const DeviceContext& context, const framework::Tensor& input,
+                  const framework::Tensor& filter,
+                  const std::vector<int>& paddings, int tile_size,
+                  framework::Tensor* output);
+};
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,159 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/winograd_conv.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "paddle/fluid/operators/math/depthwise_conv.h"
+
+namespace {
+
+using paddle::framework::Tensor;
+using paddle::framework::make_ddim;
+
+void RandomFill(Tensor* t, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  float* data = t->data<float>();
+  for (int64_t i = 0; i < t->numel(); ++i) {
+    data[i] = dist(rng);
+  }
+}
+
+// The direct convolution of NCHW as the reference.
+void ReferenceConv(const Tensor& input, const Tensor& filter, int groups,
+                   const std::vector<int>& strides,
+                   const std::vector<int>& paddings,
+                   const std::vector<int>& dilations, Tensor* output) {
+  const int n = input.dims()[0], c = input.dims()[1];
+  const int h = input.dims()[2], w = input.dims()[3];
+  const int k = output->dims()[1];
+  const int oh = output->dims()[2], ow = output->dims()[3];
+  const int kh = filter.dims()[2], kw = filter.dims()[3];
+  const int cg = c / groups, kg = k / groups;
+  const float* in = input.data<float>();
+  const float* f = filter.data<float>();
+  float* out = output->data<float>();
+  for (int b = 0; b < n; ++b) {
+    for (int o = 0; o < k; ++o) {
+      const int g = o / kg;
+      for (int y = 0; y < oh; ++y) {
+        for (int x = 0; x < ow; ++x) {
+          float sum = 0.f;
+          for (int i = 0; i < cg; ++i) {
+            for (int p = 0; p < kh; ++p) {
+              for (int q = 0; q < kw; ++q) {
+                int iy = y * strides[0] - paddings[0] + p * dilations[0];
+                int ix = x * strides[1] - paddings[1] + q * dilations[1];
+                if (iy < 0 || iy >= h || ix < 0 || ix >= w) continue;
+                sum += in[((b * c + g * cg + i) * h + iy) * w + ix] *
+                       f[((o * cg + i) * kh + p) * kw + q];
+              }
+            }
+          }
+          out[((b * k + o) * oh + y) * ow + x] = sum;
+        }
+      }
+    }
+  }
+}
+
+void ExpectNear(const Tensor& expected, const Tensor& actual, float eps) {
+  ASSERT_EQ(expected.numel(), actual.numel());
+  for (int64_t i = 0; i < expected.numel(); ++i) {
+    ASSERT_NEAR(expected.data<float>()[i], actual.data<float>()[i], eps)
+        << "at " << i;
+  }
+}
+
+void TestWinograd(int tile_size, int height, int width, int padding) {
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceContext context(place);
+  const int n = 2, c = 5, k = 7;
+  const int oh = height + 2 * padding - 2, ow = width + 2 * padding - 2;
+  Tensor input, filter, expected, output;
+  input.mutable_data<float>(make_ddim({n, c, height, width}), place);
+  filter.mutable_data<float>(make_ddim({k, c, 3, 3}), place);
+  expected.mutable_data<float>(make_ddim({n, k, oh, ow}), place);
+  output.mutable_data<float>(make_ddim({n, k, oh, ow}), place);
+  RandomFill(&input, 1);
+  RandomFill(&filter, 2);
+
+  std::vector<int> ones({1, 1});
+  std::vector<int> paddings({padding, padding});
+  ReferenceConv(input, filter, 1, ones, paddings, ones, &expected);
+  paddle::operators::math::WinogradConv3x3Functor<
+      paddle::platform::CPUDeviceContext, float>
+      conv;
+  conv(context, input, filter, paddings, tile_size, &output);
+  ExpectNear(expected, output, 1e-4f);
+}
+
+}  // namespace
+
+TEST(WinogradConv3x3, F2x2) {
+  TestWinograd(2, 8, 8, 1);
+  TestWinograd(2, 7, 9, 0);
+}
+
+TEST(WinogradConv3x3, F4x4) {
+  TestWinograd(4, 12, 12, 1);
+  TestWinograd(4, 11, 6, 1);
+}
+
+TEST(DepthwiseConvCPU, StridesDilationsAndEpilogue) {
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceContext context(place);
+  const int n = 2, c = 3, multiplier = 2, h = 9, w = 10;
+  for (int stride : {1, 2}) {
+    for (int dilation : {1, 2}) {
+      std::vector<int> strides({stride, stride});
+      std::vector<int> paddings({1, 2});
+      std::vector<int> dilations({dilation, dilation});
+      const int oh = (h + 2 * paddings[0] - (dilation * 2 + 1)) / stride + 1;
+      const int ow = (w + 2 * paddings[1] - (dilation * 2 + 1)) / stride + 1;
+      Tensor input, filter, bias, expected, output;
+      input.mutable_data<float>(make_ddim({n, c, h, w}), place);
+      filter.mutable_data<float>(make_ddim({c * multiplier, 1, 3, 3}), place);
+      bias.mutable_data<float>(make_ddim({c * multiplier}), place);
+      expected.mutable_data<float>(make_ddim({n, c * multiplier, oh, ow}),
+                                   place);
+      output.mutable_data<float>(make_ddim({n, c * multiplier, oh, ow}),
+                                 place);
+      RandomFill(&input, 3);
+      RandomFill(&filter, 4);
+      RandomFill(&bias, 5);
+
+      ReferenceConv(input, filter, c, strides, paddings, dilations, &expected);
+      float* expected_data = expected.data<float>();
+      const int size = oh * ow;
+      for (int64_t i = 0; i < expected.numel(); ++i) {
+        float x = expected_data[i] + bias.data<float>()[i / size % (c * 2)];
+        expected_data[i] = x > 0.f ? x : 0.f;
+      }
+
+      paddle::operators::math::ConvEpilogue<float> epilogue;
+      epilogue.bias = bias.data<float>();
+      epilogue.act = paddle::operators::math::ConvActivation::kRelu;
+      paddle::operators::math::DepthwiseConvFunctor<
+          paddle::platform::CPUDeviceContext, float>
+          conv;
+      conv(context, input, filter, strides, paddings, dilations, &output,
+           epilogue);
+      ExpectNear(expected, output, 1e-5f);
+    }
+  }
+}
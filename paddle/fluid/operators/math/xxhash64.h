@@ -0,0 +1,146 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include "paddle/fluid/platform/hostdevice.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The XXH64 of xxhash, on the host and the device. XXHash64 returns what
+// XXH64 does on a little endian machine.
+//
+// XXHash64Lanes hashes an input with kLanes seeds at once. The rounds of
+// the input, which do not depend on the seed, are computed once for the
+// lanes, and the lanes are updated in independent registers, so that the
+// multiplications of the lanes pipeline and vectorize.
+
+constexpr uint64_t kXXPrime64_1 = 11400714785074694791ULL;
+constexpr uint64_t kXXPrime64_2 = 14029467366897019727ULL;
+constexpr uint64_t kXXPrime64_3 = 1609587929392839161ULL;
+constexpr uint64_t kXXPrime64_4 = 9650029242287828579ULL;
+constexpr uint64_t kXXPrime64_5 = 2870177450012600261ULL;
+
+HOSTDEVICE inline uint64_t XXRotl64(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+HOSTDEVICE inline uint64_t XXRead64(const unsigned char* p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+HOSTDEVICE inline uint32_t XXRead32(const unsigned char* p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+HOSTDEVICE inline uint64_t XXRound64(uint64_t acc, uint64_t input) {
+  acc += input * kXXPrime64_2;
+  acc = XXRotl64(acc, 31);
+  return acc * kXXPrime64_1;
+}
+
+HOSTDEVICE inline uint64_t XXMergeRound64(uint64_t acc, uint64_t val) {
+  acc ^= XXRound64(0, val);
+  return acc * kXXPrime64_1 + kXXPrime64_4;
+}
+
+template <int kLanes>
+HOSTDEVICE inline void XXHash64Lanes(const void* input, size_t len,
+                                     const uint64_t* seeds, uint64_t* hashes) {
+  const unsigned char* p = static_cast<const unsigned char*>(input);
+  const unsigned char* end = p + len;
+  uint64_t h[kLanes];
+  if (len >= 32) {
+    uint64_t v1[kLanes], v2[kLanes], v3[kLanes], v4[kLanes];
+    for (int l = 0; l < kLanes; ++l) {
+      v1[l] = seeds[l] + kXXPrime64_1 + kXXPrime64_2;
+      v2[l] = seeds[l] + kXXPrime64_2;
+      v3[l] = seeds[l];
+      v4[l] = seeds[l] - kXXPrime64_1;
+    }
+    const unsigned char* limit = end - 32;
+    do {
+      uint64_t k1 = XXRead64(p);
+      uint64_t k2 = XXRead64(p + 8);
+      uint64_t k3 = XXRead64(p + 16);
+      uint64_t k4 = XXRead64(p + 24);
+      for (int l = 0; l < kLanes; ++l) {
+        v1[l] = XXRound64(v1[l], k1);
+        v2[l] = XXRound64(v2[l], k2);
+        v3[l] = XXRound64(v3[l], k3);
+        v4[l] = XXRound64(v4[l], k4);
+      }
+      p += 32;
+    } while (p <= limit);
+    for (int l = 0; l < kLanes; ++l) {
+      h[l] = XXRotl64(v1[l], 1) + XXRotl64(v2[l], 7) + XXRotl64(v3[l], 12) +
+             XXRotl64(v4[l], 18);
+      h[l] = XXMergeRound64(h[l], v1[l]);
+      h[l] = XXMergeRound64(h[l], v2[l]);
+      h[l] = XXMergeRound64(h[l], v3[l]);
+      h[l] = XXMergeRound64(h[l], v4[l]);
+    }
+  } else {
+    for (int l = 0; l < kLanes; ++l) h[l] = seeds[l] + kXXPrime64_5;
+  }
+  for (int l = 0; l < kLanes; ++l) h[l] += static_cast<uint64_t>(len);
+
+  for (; p + 8 <= end; p += 8) {
+    uint64_t k1 = XXRound64(0, XXRead64(p));
+    for (int l = 0; l < kLanes; ++l) {
+      h[l] = XXRotl64(h[l] ^ k1, 27) * kXXPrime64_1 + kXXPrime64_4;
+    }
+  }
+  if (p + 4 <= end) {
+    uint64_t k1 = static_cast<uint64_t>(XXRead32(p)) * kXXPrime64_1;
+    for (int l = 0; l < kLanes; ++l) {
+      h[l] = XXRotl64(h[l] ^ k1, 23) * kXXPrime64_2 + kXXPrime64_3;
+    }
+    p += 4;
+  }
+  for (; p < end; ++p) {
+    uint64_t k1 = *p * kXXPrime64_5;
+    for (int l = 0; l < kLanes; ++l) {
+      h[l] = XXRotl64(h[l] ^ k1, 11) * kXXPrime64_1;
+    }
+  }
+
+  for (int l = 0; l < kLanes; ++l) {
+    uint64_t x = h[l];
+    x ^= x >> 33;
+    x *= kXXPrime64_2;
+    x ^= x >> 29;
+    x *= kXXPrime64_3;
+    x ^= x >> 32;
+    hashes[l] = x;
+  }
+}
+
+HOSTDEVICE inline uint64_t XXHash64(const void* input, size_t len,
+                                    uint64_t seed) {
+  uint64_t hash;
+  XXHash64Lanes<1>(input, len, &seed, &hash);
+  return hash;
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,56 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/xxhash64.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+extern "C" {
+#include <xxhash.h>
+}
+
+using paddle::operators::math::XXHash64;
+using paddle::operators::math::XXHash64Lanes;
+
+TEST(XXHash64, KnownHashes) {
+  EXPECT_EQ(XXHash64("", 0, 0), 0xEF46DB3751D8E999ULL);
+  EXPECT_EQ(XXHash64("a", 1, 0), 0xD24EC4F1A98C6E5BULL);
+  EXPECT_EQ(XXHash64("abc", 3, 0), 0x44BC2CF5AD770999ULL);
+  std::string s = "Nobody inspects the spammish repetition";
+  EXPECT_EQ(XXHash64(s.data(), s.size(), 0), 0xFBCEA83C8A378BF1ULL);
+}
+
+TEST(XXHash64, SameAsXXH64) {
+  std::vector<unsigned char> data(100);
+  for (size_t i = 0; i < data.size(); ++i) data[i] = i * 37 + 11;
+  for (size_t len = 0; len <= data.size(); ++len) {
+    for (uint64_t seed : {0ULL, 1ULL, 3ULL, 12345678901ULL}) {
+      EXPECT_EQ(XXHash64(data.data(), len, seed),
+                XXH64(data.data(), len, seed));
+    }
+  }
+}
+
+TEST(XXHash64, Lanes) {
+  std::vector<unsigned char> data(70);
+  for (size_t i = 0; i < data.size(); ++i) data[i] = i * 13 + 5;
+  uint64_t seeds[4] = {0, 1, 2, 3};
+  uint64_t hashes[4];
+  for (size_t len : {0, 3, 4, 12, 31, 32, 45, 70}) {
+    XXHash64Lanes<4>(data.data(), len, seeds, hashes);
+    for (int l = 0; l < 4; ++l) {
+      EXPECT_EQ(hashes[l], XXHash64(data.data(), len, seeds[l]));
+    }
+  }
+}
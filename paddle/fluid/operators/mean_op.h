@@ -13,8 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
+#include <numeric>
+#include <vector>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/reduce_ops/cpu_reduce.h"
 
 namespace paddle {
 namespace operators {
@@ -36,6 +39,13 @@ class MeanKernel : public framework::OpKernel<T> {
 
     output->mutable_data<T>(context.GetPlace());
 
+    if (platform::is_cpu_place(context.GetPlace())) {
+      std::vector<int> reduce_dims(input->dims().size());
+      std::iota(reduce_dims.begin(), reduce_dims.end(), 0);
+      CPUReduceSum<T>(*input, reduce_dims, true, output);
+      return;
+    }
+
     auto X = EigenVector<T>::Flatten(*input);
     auto y = EigenScalar<T>::From(*output);
     auto& place =
@@ -43,16 +43,21 @@ class AucOp : public framework::OperatorWithKernel {
 
     ctx->SetOutputDim("AUC", {1});
 
-    slide_steps = slide_steps == 0 ? 1 : slide_steps;
-    ctx->SetOutputDim("StatPosOut", {slide_steps, num_pred_buckets});
-    ctx->SetOutputDim("StatNegOut", {slide_steps, num_pred_buckets});
+    // The ring of the histograms, their sum and the number of the batches,
+    // see AucKernel.
+    framework::DDim stat_dims =
+        slide_steps == 0
+            ? framework::make_ddim({1, num_pred_buckets})
+            : framework::make_ddim({(1 + slide_steps) * num_pred_buckets + 1});
+    ctx->SetOutputDim("StatPosOut", stat_dims);
+    ctx->SetOutputDim("StatNegOut", stat_dims);
   }
 
  protected:
   framework::OpKernelType GetExpectedKernelType(
       const framework::ExecutionContext &ctx) const override {
     return framework::OpKernelType(ctx.Input<Tensor>("Predict")->type(),
-                                   platform::CPUPlace());
+                                   ctx.GetPlace());
   }
 };
 
@@ -85,7 +90,12 @@ class AucOpMaker : public framework::OpProtoAndCheckerMaker {
         "num_thresholds",
         "The number of thresholds to use when discretizing the roc curve.")
         .SetDefault((2 << 12) - 1);
-    AddAttr<int>("slide_steps", "Use slide steps to calc batch auc.")
+    AddAttr<int>("slide_steps",
+                 "Calc the auc of the last slide_steps batches, or of all the "
+                 "batches if it is 0. With slide_steps > 0, the stats hold "
+                 "the histograms of the batches, their sum and the number of "
+                 "the batches, in the shape of "
+                 "[(1 + slide_steps) * (num_thresholds + 1) + 1].")
         .SetDefault(1);
     AddComment(R"DOC(
 Area Under The Curve (AUC) Operator.
@@ -0,0 +1,161 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include "paddle/fluid/operators/metrics/auc_op.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+
+namespace paddle {
+namespace operators {
+
+using platform::PADDLE_CUDA_NUM_THREADS;
+
+#define CUDA_1D_KERNEL_LOOP(i, n)                              \
+  for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < (n); \
+       i += blockDim.x * gridDim.x)
+
+// The offset of the histogram of the current batch, see AucKernel. The
+// number of the batches is read on the device, so the stats never leave it.
+__device__ __forceinline__ int CurStepBegin(const int64_t *stat_pos,
+                                            const int num_pred_buckets,
+                                            const int slide_steps) {
+  if (slide_steps == 0) return 0;
+  int64_t batch_count = stat_pos[(slide_steps + 1) * num_pred_buckets];
+  return static_cast<int>(batch_count % slide_steps) * num_pred_buckets;
+}
+
+// Take the oldest histogram out of the sum and clear it for the batch.
+__global__ void ClearOldestKernel(int64_t *stat_pos, int64_t *stat_neg,
+                                  const int num_pred_buckets,
+                                  const int slide_steps) {
+  int cur_step_begin = CurStepBegin(stat_pos, num_pred_buckets, slide_steps);
+  int sum_step_begin = slide_steps * num_pred_buckets;
+  CUDA_1D_KERNEL_LOOP(i, num_pred_buckets) {
+    stat_pos[sum_step_begin + i] -= stat_pos[cur_step_begin + i];
+    stat_neg[sum_step_begin + i] -= stat_neg[cur_step_begin + i];
+    stat_pos[cur_step_begin + i] = 0;
+    stat_neg[cur_step_begin + i] = 0;
+  }
+}
+
+template <typename T>
+__global__ void AddBatchKernel(const int64_t *label_data, const T *pred_data,
+                               const int num_samples, const int inference_width,
+                               const int num_thresholds, const int slide_steps,
+                               int64_t *stat_pos, int64_t *stat_neg) {
+  int cur_step_begin =
+      CurStepBegin(stat_pos, num_thresholds + 1, slide_steps);
+  CUDA_1D_KERNEL_LOOP(i, num_samples) {
+    double predict_data =
+        static_cast<double>(pred_data[i * inference_width + 1]);
+    // The range of the predictions is enforced by the CPU kernel only, the
+    // ones out of it are counted in the first or the last bucket.
+    predict_data = fmin(fmax(predict_data, 0.0), 1.0);
+    int bin_idx = static_cast<int>(predict_data * num_thresholds);
+    if (label_data[i]) {
+      platform::CudaAtomicAdd(stat_pos + cur_step_begin + bin_idx,
+                              static_cast<int64_t>(1));
+    } else {
+      platform::CudaAtomicAdd(stat_neg + cur_step_begin + bin_idx,
+                              static_cast<int64_t>(1));
+    }
+  }
+}
+
+__global__ void AddToSumKernel(int64_t *stat_pos, int64_t *stat_neg,
+                               const int num_pred_buckets,
+                               const int slide_steps) {
+  int cur_step_begin = CurStepBegin(stat_pos, num_pred_buckets, slide_steps);
+  int sum_step_begin = slide_steps * num_pred_buckets;
+  CUDA_1D_KERNEL_LOOP(i, num_pred_buckets) {
+    stat_pos[sum_step_begin + i] += stat_pos[cur_step_begin + i];
+    stat_neg[sum_step_begin + i] += stat_neg[cur_step_begin + i];
+  }
+}
+
+// Run by one thread after the others have read the number of the batches.
+__global__ void CalcAucKernel(int64_t *stat_pos, int64_t *stat_neg,
+                              const int num_thresholds, const int slide_steps,
+                              double *auc) {
+  int num_pred_buckets = num_thresholds + 1;
+  int sum_step_begin = slide_steps * num_pred_buckets;
+  const int64_t *sum_pos = stat_pos + sum_step_begin;
+  const int64_t *sum_neg = stat_neg + sum_step_begin;
+  double area = 0.0;
+  double tot_pos = 0.0;
+  double tot_neg = 0.0;
+  for (int idx = num_thresholds; idx >= 0; --idx) {
+    double tot_pos_prev = tot_pos;
+    double tot_neg_prev = tot_neg;
+    tot_pos += sum_pos[idx];
+    tot_neg += sum_neg[idx];
+    area += fabs(tot_neg - tot_neg_prev) * (tot_pos + tot_pos_prev) / 2.0;
+  }
+  if (tot_pos > 0.0 && tot_neg > 0.0) {
+    area = area / tot_pos / tot_neg;
+  }
+  *auc = area;
+  if (slide_steps > 0) {
+    int count_idx = (slide_steps + 1) * num_pred_buckets;
+    stat_pos[count_idx] += 1;
+    stat_neg[count_idx] = stat_pos[count_idx];
+  }
+}
+
+template <typename T>
+class AucCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &ctx) const override {
+    auto *predict = ctx.Input<Tensor>("Predict");
+    auto *label = ctx.Input<Tensor>("Label");
+    int num_thresholds = ctx.Attr<int>("num_thresholds");
+    int num_pred_buckets = num_thresholds + 1;
+    int slide_steps = ctx.Attr<int>("slide_steps");
+
+    auto *stat_pos = GetStatOut(ctx, "StatPos", "StatPosOut");
+    auto *stat_neg = GetStatOut(ctx, "StatNeg", "StatNegOut");
+    auto *auc = ctx.Output<Tensor>("AUC")->mutable_data<double>(ctx.GetPlace());
+
+    int num_samples = static_cast<int>(predict->dims()[0]);
+    int inference_width = static_cast<int>(predict->dims()[1]);
+    auto stream = ctx.cuda_device_context().stream();
+    int bucket_blocks = (num_pred_buckets + PADDLE_CUDA_NUM_THREADS - 1) /
+                        PADDLE_CUDA_NUM_THREADS;
+    if (slide_steps > 0) {
+      ClearOldestKernel<<<bucket_blocks, PADDLE_CUDA_NUM_THREADS, 0,
+                          stream>>>(stat_pos, stat_neg, num_pred_buckets,
+                                    slide_steps);
+    }
+    if (num_samples > 0) {
+      int sample_blocks = std::min(
+          (num_samples + PADDLE_CUDA_NUM_THREADS - 1) / PADDLE_CUDA_NUM_THREADS,
+          4096);
+      AddBatchKernel<T><<<sample_blocks, PADDLE_CUDA_NUM_THREADS, 0, stream>>>(
+          label->data<int64_t>(), predict->data<T>(), num_samples,
+          inference_width, num_thresholds, slide_steps, stat_pos, stat_neg);
+    }
+    if (slide_steps > 0) {
+      AddToSumKernel<<<bucket_blocks, PADDLE_CUDA_NUM_THREADS, 0, stream>>>(
+          stat_pos, stat_neg, num_pred_buckets, slide_steps);
+    }
+    CalcAucKernel<<<1, 1, 0, stream>>>(stat_pos, stat_neg, num_thresholds,
+                                       slide_steps, auc);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(auc, ops::AucCUDAKernel<float>);
@@ -14,15 +14,45 @@ limitations under the License. */
 
 #pragma once
 
+#include <cstring>
 #include <string>
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/tensor_util.h"
 
 namespace paddle {
 namespace operators {
 
 using Tensor = framework::Tensor;
 
+// StatPosOut and StatPos are the same variable in the programs, the stats
+// are copied to the output only when they are not, e.g. in the unittests or
+// after they are transformed to another place.
+inline int64_t *GetStatOut(const framework::ExecutionContext &ctx,
+                           const std::string &in, const std::string &out) {
+  auto *stat_in = ctx.Input<Tensor>(in);
+  auto *stat_out = ctx.Output<Tensor>(out);
+  if (stat_in != stat_out) {
+    framework::TensorCopy(*stat_in, ctx.GetPlace(), ctx.device_context(),
+                          stat_out);
+  }
+  int num_pred_buckets = ctx.Attr<int>("num_thresholds") + 1;
+  int slide_steps = ctx.Attr<int>("slide_steps");
+  int64_t numel = slide_steps == 0
+                      ? num_pred_buckets
+                      : (1 + slide_steps) * num_pred_buckets + 1;
+  PADDLE_ENFORCE_EQ(stat_out->numel(), numel,
+                    "The stats of auc should have %d elements", numel);
+  return stat_out->mutable_data<int64_t>(ctx.GetPlace());
+}
+
+/*
+ * With slide_steps > 0, the stats are a ring of the histograms of the last
+ * slide_steps batches, then their sum, then the number of the batches seen,
+ * whose remainder by slide_steps is the slot of the next batch. A batch
+ * replaces the oldest histogram and updates the sum by the difference,
+ * instead of shifting the ring and summing it up every batch.
+ */
 template <typename DeviceContext, typename T>
 class AucKernel : public framework::OpKernel<T> {
  public:
@@ -30,7 +60,6 @@ class AucKernel : public framework::OpKernel<T> {
     auto *predict = ctx.Input<Tensor>("Predict");
     auto *label = ctx.Input<Tensor>("Label");
 
-    std::string curve = ctx.Attr<std::string>("curve");
     int num_thresholds = ctx.Attr<int>("num_thresholds");
     // buckets contain numbers from 0 to num_thresholds
     int num_pred_buckets = num_thresholds + 1;
@@ -39,22 +68,40 @@ class AucKernel : public framework::OpKernel<T> {
     // Only use output var for now, make sure it's persistable and
     // not cleaned up for each batch.
     auto *auc = ctx.Output<Tensor>("AUC");
-    auto *stat_pos = ctx.Output<Tensor>("StatPosOut");
-    auto *stat_neg = ctx.Output<Tensor>("StatNegOut");
-
-    auto *origin_stat_pos = stat_pos->mutable_data<int64_t>(ctx.GetPlace());
-    auto *origin_stat_neg = stat_neg->mutable_data<int64_t>(ctx.GetPlace());
+    auto *origin_stat_pos = GetStatOut(ctx, "StatPos", "StatPosOut");
+    auto *origin_stat_neg = GetStatOut(ctx, "StatNeg", "StatNegOut");
 
-    std::vector<int64_t> stat_pos_data(num_pred_buckets, 0);
-    std::vector<int64_t> stat_neg_data(num_pred_buckets, 0);
-
-    auto stat_pos_calc = stat_pos_data.data();
-    auto stat_neg_calc = stat_neg_data.data();
+    if (slide_steps == 0) {
+      statAuc(label, predict, num_thresholds, origin_stat_pos,
+              origin_stat_neg);
+      calcAuc(ctx, origin_stat_pos, origin_stat_neg, num_thresholds, auc);
+      return;
+    }
 
-    statAuc(label, predict, num_pred_buckets, num_thresholds, slide_steps,
-            origin_stat_pos, origin_stat_neg, &stat_pos_calc, &stat_neg_calc);
+    int64_t *batch_count =
+        origin_stat_pos + (slide_steps + 1) * num_pred_buckets;
+    int cur_step_begin =
+        static_cast<int>(*batch_count % slide_steps) * num_pred_buckets;
+    int sum_step_begin = slide_steps * num_pred_buckets;
+    int64_t *cur_pos = origin_stat_pos + cur_step_begin;
+    int64_t *cur_neg = origin_stat_neg + cur_step_begin;
+    int64_t *sum_pos = origin_stat_pos + sum_step_begin;
+    int64_t *sum_neg = origin_stat_neg + sum_step_begin;
+    for (int i = 0; i < num_pred_buckets; ++i) {
+      sum_pos[i] -= cur_pos[i];
+      sum_neg[i] -= cur_neg[i];
+    }
+    std::memset(cur_pos, 0, num_pred_buckets * sizeof(int64_t));
+    std::memset(cur_neg, 0, num_pred_buckets * sizeof(int64_t));
+    statAuc(label, predict, num_thresholds, cur_pos, cur_neg);
+    for (int i = 0; i < num_pred_buckets; ++i) {
+      sum_pos[i] += cur_pos[i];
+      sum_neg[i] += cur_neg[i];
+    }
+    ++*batch_count;
+    origin_stat_neg[(slide_steps + 1) * num_pred_buckets] = *batch_count;
 
-    calcAuc(ctx, stat_pos_calc, stat_neg_calc, num_thresholds, auc);
+    calcAuc(ctx, sum_pos, sum_neg, num_thresholds, auc);
   }
 
  private:
@@ -65,10 +112,8 @@ class AucKernel : public framework::OpKernel<T> {
 
   inline static void statAuc(const framework::Tensor *label,
                              const framework::Tensor *predict,
-                             const int num_pred_buckets,
-                             const int num_thresholds, const int slide_steps,
-                             int64_t *origin_stat_pos, int64_t *origin_stat_neg,
-                             int64_t **stat_pos, int64_t **stat_neg) {
+                             const int num_thresholds, int64_t *stat_pos,
+                             int64_t *stat_neg) {
     size_t batch_size = predict->dims()[0];
     size_t inference_width = predict->dims()[1];
     const T *inference_data = predict->data<T>();
@@ -83,51 +128,9 @@ class AucKernel : public framework::OpKernel<T> {
 
       uint32_t binIdx = static_cast<uint32_t>(predict_data * num_thresholds);
       if (label_data[i]) {
-        (*stat_pos)[binIdx] += 1.0;
+        stat_pos[binIdx] += 1;
       } else {
-        (*stat_neg)[binIdx] += 1.0;
-      }
-    }
-
-    int bucket_length = num_pred_buckets * sizeof(int64_t);
-
-    // will stat auc unlimited.
-    if (slide_steps == 0) {
-      for (int slide = 0; slide < num_pred_buckets; ++slide) {
-        origin_stat_pos[slide] += (*stat_pos)[slide];
-        origin_stat_neg[slide] += (*stat_neg)[slide];
-      }
-
-      *stat_pos = origin_stat_pos;
-      *stat_neg = origin_stat_neg;
-
-    } else {
-      for (int slide = 1; slide < slide_steps; ++slide) {
-        int dst_idx = (slide - 1) * num_pred_buckets;
-        int src_inx = slide * num_pred_buckets;
-        std::memcpy(origin_stat_pos + dst_idx, origin_stat_pos + src_inx,
-                    bucket_length);
-        std::memcpy(origin_stat_neg + dst_idx, origin_stat_neg + src_inx,
-                    bucket_length);
-      }
-
-      std::memcpy(origin_stat_pos + (slide_steps - 1) * num_pred_buckets,
-                  *stat_pos, bucket_length);
-      std::memcpy(origin_stat_neg + (slide_steps - 1) * num_pred_buckets,
-                  *stat_neg, bucket_length);
-
-      std::memset(*stat_pos, 0, bucket_length);
-      std::memset(*stat_neg, 0, bucket_length);
-
-      for (int slide = 0; slide < num_pred_buckets; ++slide) {
-        int stat_pos_steps = 0;
-        int stat_neg_steps = 0;
-        for (int step = 0; step < slide_steps; ++step) {
-          stat_pos_steps += origin_stat_pos[slide + step * num_pred_buckets];
-          stat_neg_steps += origin_stat_neg[slide + step * num_pred_buckets];
-        }
-        (*stat_pos)[slide] += stat_pos_steps;
-        (*stat_neg)[slide] += stat_neg_steps;
+        stat_neg[binIdx] += 1;
       }
     }
   }
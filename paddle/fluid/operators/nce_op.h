@@ -15,14 +15,15 @@ limitations under the License. */
 #pragma once
 
 #include <math.h>
-#include <iterator>
+#include <algorithm>
 #include <random>
-#include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/operators/math/blas.h"
 #include "paddle/fluid/operators/math/sampler.h"
 #include "unsupported/Eigen/CXX11/Tensor"
 
@@ -78,6 +79,16 @@ void PrepareSamples(const framework::ExecutionContext &context,
   }
 }
 
+// The sorted unique labels, which are the rows of the weight touched by a
+// batch.
+inline std::vector<int64_t> UniqueLabels(const Tensor &sample_labels) {
+  const int64_t *data = sample_labels.data<int64_t>();
+  std::vector<int64_t> labels(data, data + sample_labels.numel());
+  std::sort(labels.begin(), labels.end());
+  labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+  return labels;
+}
+
 template <typename DeviceContext, typename T>
 class NCEKernel : public framework::OpKernel<T> {
  public:
@@ -148,7 +159,10 @@ class NCEKernel : public framework::OpKernel<T> {
       }
     }
     // forward mul
-    auto input_mat = EigenMatrix<T>::From(*(context.Input<Tensor>("Input")));
+    auto *input = context.Input<Tensor>("Input");
+    const T *input_data = input->data<T>();
+    int64_t dim = input->dims()[1];
+    auto blas = math::GetBlas<platform::CPUDeviceContext, T>(context);
 
     // for remote prefetch
     auto epmap = context.Attr<std::vector<std::string>>("epmap");
@@ -158,12 +172,13 @@ class NCEKernel : public framework::OpKernel<T> {
       // parameter
       // server
 
-      std::vector<int64_t> labels;
-      for (int64_t i = 0; i < sample_labels->numel(); ++i) {
-        labels.push_back(sample_labels_data[i]);
+      std::vector<int64_t> labels = UniqueLabels(*sample_labels);
+      // The row of each label in the prefetched weight.
+      std::unordered_map<int64_t, int64_t> label_to_row;
+      label_to_row.reserve(labels.size());
+      for (size_t i = 0; i < labels.size(); ++i) {
+        label_to_row[labels[i]] = static_cast<int64_t>(i);
       }
-      std::set<T> st(labels.begin(), labels.end());
-      labels.assign(st.begin(), st.end());
 
       framework::Scope &local_scope = context.scope().NewScope();
 
@@ -197,30 +212,22 @@ class NCEKernel : public framework::OpKernel<T> {
           "parameter prefetch!");
 #endif
 
-      auto weight_mat = EigenMatrix<T>::From(
-          (local_scope.Var("Weight@Prefetch")->Get<framework::LoDTensor>()));
+      const T *weight_data = local_scope.Var("Weight@Prefetch")
+                                 ->Get<framework::LoDTensor>()
+                                 .data<T>();
       for (int64_t i = 0; i < sample_labels->numel(); ++i) {
-        std::vector<int64_t>::iterator it =
-            std::find(labels.begin(), labels.end(), sample_labels_data[i]);
-        int idx = std::distance(labels.begin(), it);
-
-        Eigen::Tensor<T, 0, Eigen::RowMajor, Eigen::DenseIndex> result =
-            (input_mat.chip(static_cast<int>(i / sample_labels->dims()[1]), 0) *
-             weight_mat.chip(idx, 0))
-                .sum();
-        sample_out_data[i] += result(0);
+        int64_t row = label_to_row[sample_labels_data[i]];
+        const T *input_row = input_data + (i / sampled_labels_num) * dim;
+        sample_out_data[i] += blas.DOT(dim, input_row, weight_data + row * dim);
         sample_out_data[i] = (1. / (1. + exp(-sample_out_data[i])));
       }
       context.scope().DeleteScope(&local_scope);
     } else {
-      auto weight_mat =
-          EigenMatrix<T>::From(*(context.Input<Tensor>("Weight")));
+      const T *weight_data = context.Input<Tensor>("Weight")->data<T>();
       for (int64_t i = 0; i < sample_labels->numel(); ++i) {
-        Eigen::Tensor<T, 0, Eigen::RowMajor, Eigen::DenseIndex> result =
-            (input_mat.chip(static_cast<int>(i / sample_labels->dims()[1]), 0) *
-             weight_mat.chip(sample_labels_data[i], 0))
-                .sum();
-        sample_out_data[i] += result(0);
+        const T *input_row = input_data + (i / sampled_labels_num) * dim;
+        sample_out_data[i] += blas.DOT(
+            dim, input_row, weight_data + sample_labels_data[i] * dim);
         sample_out_data[i] = (1. / (1. + exp(-sample_out_data[i])));
       }
     }
@@ -322,6 +329,12 @@ class NCEGradKernel : public framework::OpKernel<T> {
       }
     }
 
+    auto *input = context.Input<Tensor>("Input");
+    const T *input_data = input->data<T>();
+    int64_t dim = input->dims()[1];
+    int64_t sampled_labels_num = sample_labels->dims()[1];
+    auto blas = math::GetBlas<platform::CPUDeviceContext, T>(context);
+
     bool is_sparse = context.Attr<bool>("is_sparse");
 
     if (!is_sparse) {
@@ -330,21 +343,15 @@ class NCEGradKernel : public framework::OpKernel<T> {
       if (d_w != nullptr) {
         auto d_w_data = d_w->mutable_data<T>(context.GetPlace());
         std::fill(d_w_data, d_w_data + d_w->numel(), 0.0);
-        auto d_w_matrix = EigenMatrix<T>::From(*d_w);
-        auto x_matrix = EigenMatrix<T>::From(*(context.Input<Tensor>("Input")));
         for (int64_t i = 0; i < sample_labels->numel(); ++i) {
-          d_w_matrix.chip(sample_labels_data[i], 0) +=
-              x_matrix.chip(static_cast<int>(i / sample_labels->dims()[1]), 0) *
-              sample_grad_data[i];
+          blas.AXPY(dim, sample_grad_data[i],
+                    input_data + (i / sampled_labels_num) * dim,
+                    d_w_data + sample_labels_data[i] * dim);
         }
       }
     } else {
-      std::vector<int64_t> labels;
-      for (int64_t i = 0; i < sample_labels->numel(); ++i) {
-        labels.push_back(sample_labels_data[i]);
-      }
-      std::set<T> st(labels.begin(), labels.end());
-      labels.assign(st.begin(), st.end());
+      // Only the rows of the sampled labels are in the gradient.
+      std::vector<int64_t> labels = UniqueLabels(*sample_labels);
 
       auto *table_var = context.InputVar("Weight");
       DDim table_dim;
@@ -370,12 +377,10 @@ class NCEGradKernel : public framework::OpKernel<T> {
       auto d_w_data = d_table_value->mutable_data<T>(context.GetPlace());
       std::fill(d_w_data, d_w_data + d_table_value->numel(), 0.0);
 
-      auto d_w_matrix = EigenMatrix<T>::From(*d_table_value);
-      auto x_matrix = EigenMatrix<T>::From(*(context.Input<Tensor>("Input")));
       for (int64_t i = 0; i < sample_labels->numel(); ++i) {
-        d_w_matrix.chip(d_w->Index(sample_labels_data[i]), 0) +=
-            x_matrix.chip(static_cast<int>(i / sample_labels->dims()[1]), 0) *
-            sample_grad_data[i];
+        blas.AXPY(dim, sample_grad_data[i],
+                  input_data + (i / sampled_labels_num) * dim,
+                  d_w_data + d_w->Index(sample_labels_data[i]) * dim);
       }
     }
 
@@ -384,11 +389,11 @@ class NCEGradKernel : public framework::OpKernel<T> {
     if (d_x != nullptr) {
       auto *d_x_data = d_x->mutable_data<T>(context.GetPlace());
       std::fill(d_x_data, d_x_data + d_x->numel(), 0.0);
-      auto d_x_matrix = EigenMatrix<T>::From(*d_x);
-      auto w_matrix = EigenMatrix<T>::From(*(context.Input<Tensor>("Weight")));
+      const T *w_data = context.Input<Tensor>("Weight")->data<T>();
       for (int64_t i = 0; i < sample_labels->numel(); ++i) {
-        d_x_matrix.chip(static_cast<int>(i / sample_labels->dims()[1]), 0) +=
-            w_matrix.chip(sample_labels_data[i], 0) * sample_grad_data[i];
+        blas.AXPY(dim, sample_grad_data[i],
+                  w_data + sample_labels_data[i] * dim,
+                  d_x_data + (i / sampled_labels_num) * dim);
       }
     }
 
@@ -0,0 +1,178 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <algorithm>
+#include "paddle/fluid/platform/cuda_device_function.h"
+
+namespace paddle {
+namespace operators {
+
+// The block dims of the normalization kernels are powers of 2 in
+// [kNormWarpSize, kNormMaxBlockDim], so that the warps are full.
+constexpr int kNormWarpSize = 32;
+constexpr int kNormMaxBlockDim = 512;
+
+inline int NormBlockDim(int size) {
+  int block_dim = kNormWarpSize;
+  while (block_dim < size && block_dim < kNormMaxBlockDim) block_dim *= 2;
+  return block_dim;
+}
+
+// The mean and the sum of the squared deviations m2 of count values, which
+// are updated in one pass by Welford's algorithm, without the cancellation
+// of E[x^2] - E[x]^2.
+template <typename T>
+struct WelfordData {
+  T mean;
+  T m2;
+  T count;
+};
+
+template <typename T>
+__device__ __forceinline__ void WelfordUpdate(T x, WelfordData<T>* data) {
+  data->count += 1;
+  T delta = x - data->mean;
+  data->mean += delta / data->count;
+  data->m2 += delta * (x - data->mean);
+}
+
+template <typename T>
+__device__ __forceinline__ WelfordData<T> WelfordCombine(
+    const WelfordData<T>& a, const WelfordData<T>& b) {
+  T count = a.count + b.count;
+  if (count == 0) return a;
+  T delta = b.mean - a.mean;
+  T ratio = b.count / count;
+  WelfordData<T> data;
+  data.mean = a.mean + delta * ratio;
+  data.m2 = a.m2 + b.m2 + delta * delta * a.count * ratio;
+  data.count = count;
+  return data;
+}
+
+template <typename T>
+__device__ __forceinline__ WelfordData<T> WelfordWarpReduce(
+    WelfordData<T> data) {
+  unsigned mask = 0u;
+  CREATE_SHFL_MASK(mask, true);
+  for (int offset = kNormWarpSize / 2; offset > 0; offset /= 2) {
+    WelfordData<T> other;
+    other.mean = platform::CudaShuffleDownSync(mask, data.mean, offset);
+    other.m2 = platform::CudaShuffleDownSync(mask, data.m2, offset);
+    other.count = platform::CudaShuffleDownSync(mask, data.count, offset);
+    data = WelfordCombine(data, other);
+  }
+  return data;
+}
+
+// Reduces the data of the threads of the block by the warp shuffles, and
+// returns the result to all the threads.
+template <typename T>
+__device__ WelfordData<T> WelfordBlockReduce(WelfordData<T> data) {
+  __shared__ T warp_data[3][kNormWarpSize];
+  __shared__ T result[3];
+  int lane = threadIdx.x % kNormWarpSize;
+  int warp = threadIdx.x / kNormWarpSize;
+  data = WelfordWarpReduce(data);
+  if (lane == 0) {
+    warp_data[0][warp] = data.mean;
+    warp_data[1][warp] = data.m2;
+    warp_data[2][warp] = data.count;
+  }
+  __syncthreads();
+  if (warp == 0) {
+    bool valid = lane < blockDim.x / kNormWarpSize;
+    data.mean = valid ? warp_data[0][lane] : static_cast<T>(0);
+    data.m2 = valid ? warp_data[1][lane] : static_cast<T>(0);
+    data.count = valid ? warp_data[2][lane] : static_cast<T>(0);
+    data = WelfordWarpReduce(data);
+    if (lane == 0) {
+      result[0] = data.mean;
+      result[1] = data.m2;
+      result[2] = data.count;
+    }
+  }
+  __syncthreads();
+  data.mean = result[0];
+  data.m2 = result[1];
+  data.count = result[2];
+  return data;
+}
+
+// Sums a and b of the threads of the block, and returns the sums to all
+// the threads.
+template <typename T>
+__device__ void NormBlockSum2(T* a, T* b) {
+  __shared__ T warp_sums[2][kNormWarpSize];
+  __shared__ T result[2];
+  unsigned mask = 0u;
+  CREATE_SHFL_MASK(mask, true);
+  int lane = threadIdx.x % kNormWarpSize;
+  int warp = threadIdx.x / kNormWarpSize;
+  T x = *a;
+  T y = *b;
+  for (int offset = kNormWarpSize / 2; offset > 0; offset /= 2) {
+    x += platform::CudaShuffleDownSync(mask, x, offset);
+    y += platform::CudaShuffleDownSync(mask, y, offset);
+  }
+  if (lane == 0) {
+    warp_sums[0][warp] = x;
+    warp_sums[1][warp] = y;
+  }
+  __syncthreads();
+  if (warp == 0) {
+    bool valid = lane < blockDim.x / kNormWarpSize;
+    x = valid ? warp_sums[0][lane] : static_cast<T>(0);
+    y = valid ? warp_sums[1][lane] : static_cast<T>(0);
+    for (int offset = kNormWarpSize / 2; offset > 0; offset /= 2) {
+      x += platform::CudaShuffleDownSync(mask, x, offset);
+      y += platform::CudaShuffleDownSync(mask, y, offset);
+    }
+    if (lane == 0) {
+      result[0] = x;
+      result[1] = y;
+    }
+  }
+  __syncthreads();
+  *a = result[0];
+  *b = result[1];
+}
+
+// The second level of the reduction of the gradients of the scale and the
+// bias: the sums of the rows of the partial sums [rows, cols] of the
+// blocks of the first level.
+template <typename T>
+__global__ void NormColumnSum(const T* partial_scale, const T* partial_bias,
+                              int rows, int cols, T* d_scale, T* d_bias) {
+  for (int j = blockIdx.x * blockDim.x + threadIdx.x; j < cols;
+       j += blockDim.x * gridDim.x) {
+    T scale_sum = 0;
+    T bias_sum = 0;
+    for (int i = 0; i < rows; ++i) {
+      if (d_scale) scale_sum += partial_scale[i * cols + j];
+      if (d_bias) bias_sum += partial_bias[i * cols + j];
+    }
+    if (d_scale) d_scale[j] = scale_sum;
+    if (d_bias) d_bias[j] = bias_sum;
+  }
+}
+
+static __device__ __forceinline__ float NormRsqrt(float x) { return rsqrtf(x); }
+static __device__ __forceinline__ double NormRsqrt(double x) {
+  return rsqrt(x);
+}
+
+}  // namespace operators
+}  // namespace paddle
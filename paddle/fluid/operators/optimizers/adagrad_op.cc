@@ -117,25 +117,23 @@ struct SparseAdagradFunctor<platform::CPUDeviceContext, T> {
     auto& merge_rows = grad_merge.rows();
     auto* grad_merge_data = grad_merge.mutable_value()->template data<T>();
 
-    // 2. m += g_m * g_m
-    auto grad_square =
-        SquareSelectedRows<platform::CPUDeviceContext, T>(context, grad_merge);
-
-    math::SelectedRowsAddToTensor<platform::CPUDeviceContext, T> functor;
-    functor(context, grad_square, moment);
-
-    // 3. update parameter
     auto* lr = learning_rate.data<T>();
     auto* param_data = param->data<T>();
     auto* moment_data = moment->data<T>();
 
-    for (size_t i = 0; i < merge_rows.size(); i++) {
-      for (int64_t j = 0; j < grad_width; j++) {
-        param_data[merge_rows[i] * grad_width + j] -=
-            lr[0] * grad_merge_data[i * grad_width + j] /
-            (std::sqrt(moment_data[merge_rows[i] * grad_width + j]) + epsilon);
-      }
-    }
+    // 2. m += g_m * g_m
+    // 3. update parameter
+    // The rows of g_m are unique, so both are done row by row.
+    math::ShardedRowsUpdate(
+        merge_rows.data(), merge_rows.size(), [&](size_t i) {
+          for (int64_t j = 0; j < grad_width; j++) {
+            T g = grad_merge_data[i * grad_width + j];
+            T& m = moment_data[merge_rows[i] * grad_width + j];
+            m += g * g;
+            param_data[merge_rows[i] * grad_width + j] -=
+                lr[0] * g / (std::sqrt(m) + epsilon);
+          }
+        });
   }
 };
 
@@ -90,6 +90,11 @@ class AdamOpMaker : public framework::OpProtoAndCheckerMaker {
     AddInput("Moment2", "(Tensor) Input second moment");
     AddInput("Beta1Pow", "(Tensor) Input beta1 power accumulator");
     AddInput("Beta2Pow", "(Tensor) Input beta2 power accumulator");
+    AddInput("SkipUpdate",
+             "(Tensor<bool>, optional) A scalar, e.g., whether the gradients "
+             "of this step overflow. If it is true, the outputs are the same "
+             "as the inputs.")
+        .AsDispensable();
 
     AddOutput("ParamOut", "(Tensor) Output parameter");
     AddOutput("Moment1Out", "(Tensor) Output first moment");
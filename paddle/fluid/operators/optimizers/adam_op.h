@@ -20,6 +20,7 @@ limitations under the License. */
 #include "paddle/fluid/operators/detail/safe_ref.h"
 #include "paddle/fluid/operators/math/algorithm.h"
 #include "paddle/fluid/operators/math/selected_rows_functor.h"
+#include "paddle/fluid/operators/optimizers/skip_update.h"
 #include "paddle/fluid/platform/for_range.h"
 
 namespace paddle {
@@ -239,6 +240,23 @@ struct SparseAdamFunctor<T, GPUAdam> {
   }
 };
 
+// In the lazy mode only the rows in the merged gradient are updated, so the
+// functor runs over the elements of the gradient instead of the parameter.
+template <typename T>
+struct LazySparseAdamFunctor {
+  SparseAdamFunctor<T, GPUAdam> functor_;
+
+  explicit LazySparseAdamFunctor(const SparseAdamFunctor<T, GPUAdam>& functor)
+      : functor_(functor) {}
+
+  inline HOSTDEVICE void operator()(size_t i) const {
+    int64_t row = functor_.rows_[i / functor_.row_numel_];
+    functor_.adam_update(
+        row * functor_.row_numel_ + i % functor_.row_numel_,
+        functor_.grad_[i]);
+  }
+};
+
 template <typename T>
 struct SparseAdamFunctor<T, CPUAdam> {
   T beta1_;
@@ -353,6 +371,13 @@ class AdamOpKernel : public framework::OpKernel<T> {
     using paddle::framework::LoDTensor;
     using paddle::operators::detail::Ref;
 
+    if (SkipUpdate(ctx)) {
+      KeepInputsAsOutputs(ctx, {{"Param", "ParamOut"},
+                                {"Moment1", "Moment1Out"},
+                                {"Moment2", "Moment2Out"}});
+      return;
+    }
+
     bool lazy_mode = ctx.Attr<bool>("lazy_mode");
     T beta1 = static_cast<T>(ctx.Attr<float>("beta1"));
     T beta2 = static_cast<T>(ctx.Attr<float>("beta2"));
@@ -477,12 +502,14 @@ class AdamOpKernel : public framework::OpKernel<T> {
         if (lazy_mode) {
           size_t row_count = grad_merge.rows().size();
           std::vector<int64_t> cpu_rows(grad_merge.rows());
-          for (size_t row_index = 0; row_index < row_count; ++row_index) {
-            for (size_t offset = 0; offset < row_numel; ++offset) {
-              size_t i = cpu_rows[row_index] * row_numel + offset;
-              functor.adam_update(i, grad_data[row_index * row_numel + offset]);
-            }
-          }
+          math::ShardedRowsUpdate(
+              cpu_rows.data(), row_count, [&](size_t row_index) {
+                for (size_t offset = 0; offset < row_numel; ++offset) {
+                  size_t i = cpu_rows[row_index] * row_numel + offset;
+                  functor.adam_update(
+                      i, grad_data[row_index * row_numel + offset]);
+                }
+              });
         } else {
           functor(param.numel());
         }
@@ -497,11 +524,17 @@ class AdamOpKernel : public framework::OpKernel<T> {
             param_out.template mutable_data<T>(ctx.GetPlace()), rows, row_numel,
             grad_merge.rows().size(), lazy_mode);
 
-        // FIXME(minqiyang): remove BinarySearch in GPU later
-        platform::ForRange<DeviceContext> for_range(
-            static_cast<const DeviceContext&>(ctx.device_context()),
-            param.numel());
-        for_range(functor);
+        auto& dev_ctx =
+            static_cast<const DeviceContext&>(ctx.device_context());
+        if (lazy_mode) {
+          platform::ForRange<DeviceContext> for_range(dev_ctx,
+                                                      grad_tensor.numel());
+          for_range(LazySparseAdamFunctor<T>(functor));
+        } else {
+          // FIXME(minqiyang): remove BinarySearch in GPU later
+          platform::ForRange<DeviceContext> for_range(dev_ctx, param.numel());
+          for_range(functor);
+        }
       }
     } else {
       PADDLE_THROW("Variable type not supported by adam_op");
@@ -0,0 +1,133 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <string>
+#include "paddle/fluid/operators/optimizers/fused_adam_op.h"
+
+namespace paddle {
+namespace operators {
+
+void FusedAdamOp::InferShape(framework::InferShapeContext* ctx) const {
+  for (const char* name : {"Param", "Grad", "LearningRate", "Moment1",
+                           "Moment2", "Beta1Pow", "Beta2Pow"}) {
+    PADDLE_ENFORCE(ctx->HasInputs(name),
+                   "Inputs(%s) of FusedAdamOp should not be null.", name);
+  }
+  for (const char* name : {"ParamOut", "Moment1Out", "Moment2Out"}) {
+    PADDLE_ENFORCE(ctx->HasOutputs(name),
+                   "Outputs(%s) of FusedAdamOp should not be null.", name);
+  }
+
+  for (auto var_type : ctx->GetInputsVarType("Grad")) {
+    PADDLE_ENFORCE(var_type == framework::proto::VarType::LOD_TENSOR,
+                   "FusedAdamOp only supports the dense gradients.");
+  }
+
+  auto param_dims = ctx->GetInputsDim("Param");
+  size_t num = param_dims.size();
+  for (const char* name : {"Grad", "Moment1", "Moment2"}) {
+    auto dims = ctx->GetInputsDim(name);
+    PADDLE_ENFORCE_EQ(dims.size(), num,
+                      "Param and %s of FusedAdamOp should have the same "
+                      "number of tensors.",
+                      name);
+    for (size_t i = 0; i < num; ++i) {
+      PADDLE_ENFORCE_EQ(param_dims[i], dims[i],
+                        "Param and %s input of FusedAdamOp should have same "
+                        "dimension",
+                        name);
+    }
+  }
+  for (const char* name : {"LearningRate", "Beta1Pow", "Beta2Pow"}) {
+    auto dims = ctx->GetInputsDim(name);
+    PADDLE_ENFORCE_EQ(dims.size(), num,
+                      "Param and %s of FusedAdamOp should have the same "
+                      "number of tensors.",
+                      name);
+    for (size_t i = 0; i < num; ++i) {
+      PADDLE_ENFORCE_EQ(framework::product(dims[i]), 1,
+                        "%s of FusedAdamOp should have 1 dimension", name);
+    }
+  }
+
+  ctx->SetOutputsDim("ParamOut", param_dims);
+  ctx->SetOutputsDim("Moment1Out", param_dims);
+  ctx->SetOutputsDim("Moment2Out", param_dims);
+}
+
+class FusedAdamOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Param", "(vector<Tensor>) Input parameters").AsDuplicable();
+    AddInput("Grad", "(vector<Tensor>) Input gradients").AsDuplicable();
+    AddInput("LearningRate", "(vector<Tensor>) Learning rates")
+        .AsDuplicable();
+    AddInput("Moment1", "(vector<Tensor>) Input first moments")
+        .AsDuplicable();
+    AddInput("Moment2", "(vector<Tensor>) Input second moments")
+        .AsDuplicable();
+    AddInput("Beta1Pow", "(vector<Tensor>) Input beta1 power accumulators")
+        .AsDuplicable();
+    AddInput("Beta2Pow", "(vector<Tensor>) Input beta2 power accumulators")
+        .AsDuplicable();
+    AddInput("SkipUpdate",
+             "(Tensor<bool>, optional) A scalar, e.g., whether the gradients "
+             "of this step overflow. If it is true, the outputs are the same "
+             "as the inputs.")
+        .AsDispensable();
+
+    AddOutput("ParamOut", "(vector<Tensor>) Output parameters")
+        .AsDuplicable();
+    AddOutput("Moment1Out", "(vector<Tensor>) Output first moments")
+        .AsDuplicable();
+    AddOutput("Moment2Out", "(vector<Tensor>) Output second moments")
+        .AsDuplicable();
+
+    AddAttr<float>("beta1",
+                   "(float, default 0.9) "
+                   "Exponential decay rate for the "
+                   "first moment estimates.")
+        .SetDefault(0.9f);
+    AddAttr<float>("beta2",
+                   "(float, default 0.999) "
+                   "exponential decay rate for the "
+                   "second moment estimates.")
+        .SetDefault(0.999f);
+    AddAttr<float>("epsilon",
+                   "(float, default 1.0e-8) "
+                   "Constant for numerical stability")
+        .SetDefault(1.0e-8f);
+
+    AddComment(R"DOC(
+Fused Adam Optimizer.
+
+This operator runs the dense update of the adam operator for a list of
+parameters at once, so that the update of all the parameters of a model takes
+a few kernel launches instead of one per parameter. The i-th parameter is
+updated with the i-th tensor of every other input as in the adam operator.
+
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_WITHOUT_GRADIENT(fused_adam, ops::FusedAdamOp,
+                             ops::FusedAdamOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    fused_adam,
+    ops::FusedAdamOpKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::FusedAdamOpKernel<paddle::platform::CPUDeviceContext, double>);
@@ -0,0 +1,124 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <vector>
+#include "paddle/fluid/operators/optimizers/fused_adam_op.h"
+#include "paddle/fluid/operators/optimizers/multi_tensor_apply.cu.h"
+
+namespace paddle {
+namespace operators {
+
+namespace {
+
+// The order of the tensors in the pointer tables.
+enum {
+  kParam,
+  kGrad,
+  kLR,
+  kMoment1,
+  kMoment2,
+  kBeta1Pow,
+  kBeta2Pow,
+  kParamOut,
+  kMoment1Out,
+  kMoment2Out,
+  kDepth
+};
+
+template <typename T>
+struct FusedAdamFunctor {
+  T beta1_;
+  T beta2_;
+  T epsilon_;
+
+  __device__ void operator()(const TensorListMeta<kDepth>& meta, int t,
+                             int64_t i) const {
+    // Merge all memory access together.
+    T g = meta.Get<const T>(kGrad, t)[i];
+    T mom1 = meta.Get<const T>(kMoment1, t)[i];
+    T mom2 = meta.Get<const T>(kMoment2, t)[i];
+    T lr = meta.Get<const T>(kLR, t)[0];
+    T beta1_pow = meta.Get<const T>(kBeta1Pow, t)[0];
+    T beta2_pow = meta.Get<const T>(kBeta2Pow, t)[0];
+    T p = meta.Get<const T>(kParam, t)[i];
+
+    // Calculation
+    lr *= sqrt(1 - beta2_pow) / (1 - beta1_pow);
+
+    mom1 = beta1_ * mom1 + (1 - beta1_) * g;
+    mom2 = beta2_ * mom2 + (1 - beta2_) * g * g;
+    p -= lr * (mom1 / (sqrt(mom2) + epsilon_));
+
+    // Write back to global memory
+    meta.Get<T>(kMoment1Out, t)[i] = mom1;
+    meta.Get<T>(kMoment2Out, t)[i] = mom2;
+    meta.Get<T>(kParamOut, t)[i] = p;
+  }
+};
+
+}  // namespace
+
+template <typename T>
+class FusedAdamOpCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    if (SkipUpdate(ctx)) {
+      KeepInputsAsOutputs(ctx, {{"Param", "ParamOut"},
+                                {"Moment1", "Moment1Out"},
+                                {"Moment2", "Moment2Out"}});
+      return;
+    }
+
+    FusedAdamFunctor<T> functor{static_cast<T>(ctx.Attr<float>("beta1")),
+                                static_cast<T>(ctx.Attr<float>("beta2")),
+                                static_cast<T>(ctx.Attr<float>("epsilon"))};
+
+    std::vector<std::vector<void*>> addresses(kDepth);
+    auto add_inputs = [&](int depth, const char* name) {
+      for (auto* tensor : ctx.MultiInput<framework::Tensor>(name)) {
+        addresses[depth].push_back(const_cast<T*>(tensor->data<T>()));
+      }
+    };
+    auto add_outputs = [&](int depth, const char* name) {
+      for (auto* tensor : ctx.MultiOutput<framework::Tensor>(name)) {
+        addresses[depth].push_back(tensor->mutable_data<T>(ctx.GetPlace()));
+      }
+    };
+    add_inputs(kParam, "Param");
+    add_inputs(kGrad, "Grad");
+    add_inputs(kLR, "LearningRate");
+    add_inputs(kMoment1, "Moment1");
+    add_inputs(kMoment2, "Moment2");
+    add_inputs(kBeta1Pow, "Beta1Pow");
+    add_inputs(kBeta2Pow, "Beta2Pow");
+    add_outputs(kParamOut, "ParamOut");
+    add_outputs(kMoment1Out, "Moment1Out");
+    add_outputs(kMoment2Out, "Moment2Out");
+
+    std::vector<int64_t> numels;
+    for (auto* param : ctx.MultiInput<framework::Tensor>("Param")) {
+      numels.push_back(param->numel());
+    }
+
+    MultiTensorApply<kDepth>(ctx.cuda_device_context(), addresses, numels,
+                             functor);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(fused_adam, ops::FusedAdamOpCUDAKernel<float>,
+                        ops::FusedAdamOpCUDAKernel<double>);
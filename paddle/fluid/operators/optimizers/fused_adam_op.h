@@ -0,0 +1,89 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/optimizers/adam_op.h"
+#include "paddle/fluid/operators/optimizers/skip_update.h"
+
+namespace paddle {
+namespace operators {
+
+class FusedAdamOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+ protected:
+  void InferShape(framework::InferShapeContext* ctx) const override;
+
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    auto input_data_type =
+        framework::GetDataTypeOfVar(ctx.MultiInputVar("Param").front());
+    return framework::OpKernelType(input_data_type, ctx.GetPlace());
+  }
+};
+
+template <typename DeviceContext, typename T>
+class FusedAdamOpKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    if (SkipUpdate(ctx)) {
+      KeepInputsAsOutputs(ctx, {{"Param", "ParamOut"},
+                                {"Moment1", "Moment1Out"},
+                                {"Moment2", "Moment2Out"}});
+      return;
+    }
+
+    T beta1 = static_cast<T>(ctx.Attr<float>("beta1"));
+    T beta2 = static_cast<T>(ctx.Attr<float>("beta2"));
+    T epsilon = static_cast<T>(ctx.Attr<float>("epsilon"));
+
+    auto params = ctx.MultiInput<framework::Tensor>("Param");
+    auto grads = ctx.MultiInput<framework::Tensor>("Grad");
+    auto learning_rates = ctx.MultiInput<framework::Tensor>("LearningRate");
+    auto moment1s = ctx.MultiInput<framework::Tensor>("Moment1");
+    auto moment2s = ctx.MultiInput<framework::Tensor>("Moment2");
+    auto beta1_pows = ctx.MultiInput<framework::Tensor>("Beta1Pow");
+    auto beta2_pows = ctx.MultiInput<framework::Tensor>("Beta2Pow");
+    auto param_outs = ctx.MultiOutput<framework::Tensor>("ParamOut");
+    auto moment1_outs = ctx.MultiOutput<framework::Tensor>("Moment1Out");
+    auto moment2_outs = ctx.MultiOutput<framework::Tensor>("Moment2Out");
+
+    std::vector<AdamFunctor<T, CPUAdam>> functors;
+    functors.reserve(params.size());
+    for (size_t i = 0; i < params.size(); ++i) {
+      functors.emplace_back(
+          beta1, beta2, epsilon, beta1_pows[i]->data<T>(),
+          beta2_pows[i]->data<T>(), moment1s[i]->data<T>(),
+          moment1_outs[i]->mutable_data<T>(ctx.GetPlace()),
+          moment2s[i]->data<T>(),
+          moment2_outs[i]->mutable_data<T>(ctx.GetPlace()),
+          learning_rates[i]->data<T>(), grads[i]->data<T>(),
+          params[i]->data<T>(), param_outs[i]->mutable_data<T>(ctx.GetPlace()));
+    }
+
+    int num = static_cast<int>(params.size());
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < num; ++i) {
+      functors[i](params[i]->numel());
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,123 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/optimizers/fused_momentum_op.h"
+
+namespace paddle {
+namespace operators {
+
+void FusedMomentumOp::InferShape(framework::InferShapeContext* ctx) const {
+  PADDLE_ENFORCE(ctx->HasInputs("Param"),
+                 "Inputs(Param) of FusedMomentum should not be null.");
+  PADDLE_ENFORCE(ctx->HasInputs("Grad"),
+                 "Inputs(Grad) of FusedMomentum should not be null.");
+  PADDLE_ENFORCE(ctx->HasInputs("Velocity"),
+                 "Inputs(Velocity) of FusedMomentum should not be null.");
+  PADDLE_ENFORCE(ctx->HasInputs("LearningRate"),
+                 "Inputs(LearningRate) of FusedMomentum should not be null.");
+  PADDLE_ENFORCE(ctx->HasOutputs("ParamOut"),
+                 "Outputs(ParamOut) of FusedMomentum should not be null.");
+  PADDLE_ENFORCE(ctx->HasOutputs("VelocityOut"),
+                 "Outputs(VelocityOut) of FusedMomentum should not be null.");
+
+  for (auto var_type : ctx->GetInputsVarType("Grad")) {
+    PADDLE_ENFORCE(var_type == framework::proto::VarType::LOD_TENSOR,
+                   "FusedMomentum only supports the dense gradients.");
+  }
+
+  auto param_dims = ctx->GetInputsDim("Param");
+  auto grad_dims = ctx->GetInputsDim("Grad");
+  auto velocity_dims = ctx->GetInputsDim("Velocity");
+  auto lr_dims = ctx->GetInputsDim("LearningRate");
+  size_t num = param_dims.size();
+  PADDLE_ENFORCE_EQ(num, grad_dims.size(),
+                    "Param and Grad of FusedMomentum should have the same "
+                    "number of tensors.");
+  PADDLE_ENFORCE_EQ(num, velocity_dims.size(),
+                    "Param and Velocity of FusedMomentum should have the same "
+                    "number of tensors.");
+  PADDLE_ENFORCE_EQ(num, lr_dims.size(),
+                    "Param and LearningRate of FusedMomentum should have the "
+                    "same number of tensors.");
+  for (size_t i = 0; i < num; ++i) {
+    PADDLE_ENFORCE_EQ(param_dims[i], grad_dims[i],
+                      "Param and Grad input of FusedMomentum should have the "
+                      "same dimension.");
+    PADDLE_ENFORCE_EQ(param_dims[i], velocity_dims[i],
+                      "Param and Velocity of FusedMomentum should have the "
+                      "same dimension.");
+    PADDLE_ENFORCE_EQ(framework::product(lr_dims[i]), 1,
+                      "Learning_rate should be a scalar");
+  }
+
+  ctx->SetOutputsDim("ParamOut", param_dims);
+  ctx->SetOutputsDim("VelocityOut", param_dims);
+}
+
+class FusedMomentumOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Param", "(vector<Tensor>) The parameters to be updated.")
+        .AsDuplicable();
+    AddInput("Grad", "(vector<Tensor>) The gradients of the parameters.")
+        .AsDuplicable();
+    AddInput("Velocity", "(vector<Tensor>) The velocities of the parameters.")
+        .AsDuplicable();
+    AddInput("LearningRate",
+             "(vector<Tensor>) The learning rates of the parameters.")
+        .AsDuplicable();
+    AddInput("SkipUpdate",
+             "(Tensor<bool>, optional) A scalar, e.g., whether the gradients "
+             "of this step overflow. If it is true, the outputs are the same "
+             "as the inputs.")
+        .AsDispensable();
+
+    AddOutput("ParamOut",
+              "(vector<Tensor>) The updated parameters. "
+              "They share memory with Input(Param).")
+        .AsDuplicable();
+    AddOutput("VelocityOut",
+              "(vector<Tensor>) The updated velocities. "
+              "They share memory with Input(Velocity).")
+        .AsDuplicable();
+
+    AddAttr<float>("mu", "(float) Momentum coefficient");
+    AddAttr<bool>("use_nesterov",
+                  "(bool, default false) "
+                  "Use Nesterov Momentum")
+        .SetDefault(false);
+    AddComment(R"DOC(
+Fused Momentum Optimizer.
+
+This operator runs the dense update of the momentum operator for a list of
+parameters at once, so that the update of all the parameters of a model takes
+a few kernel launches instead of one per parameter. The i-th parameter is
+updated with the i-th Grad, Velocity and LearningRate as in the momentum
+operator.
+
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(fused_momentum, ops::FusedMomentumOp,
+                  ops::FusedMomentumOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+REGISTER_OP_CPU_KERNEL(
+    fused_momentum,
+    ops::FusedMomentumOpKernel<paddle::platform::CPUDeviceContext, float>,
+    ops::FusedMomentumOpKernel<paddle::platform::CPUDeviceContext, double>);
@@ -0,0 +1,117 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <vector>
+#include "paddle/fluid/operators/optimizers/fused_momentum_op.h"
+#include "paddle/fluid/operators/optimizers/multi_tensor_apply.cu.h"
+
+namespace paddle {
+namespace operators {
+
+namespace {
+
+// The order of the tensors in the pointer tables.
+enum { kParam, kGrad, kVelocity, kLR, kParamOut, kVelocityOut, kDepth };
+
+template <typename T, typename UpdateMethod>
+struct FusedMomentumFunctor;
+
+template <typename T>
+struct FusedMomentumFunctor<T, UseNesterov> {
+  T mu_;
+
+  __device__ void operator()(const TensorListMeta<kDepth>& meta, int t,
+                             int64_t i) const {
+    const T p = meta.Get<const T>(kParam, t)[i];
+    const T g = meta.Get<const T>(kGrad, t)[i];
+    const T v = meta.Get<const T>(kVelocity, t)[i];
+    const T lr = meta.Get<const T>(kLR, t)[0];
+    T v_out = v * mu_ + g;
+    meta.Get<T>(kVelocityOut, t)[i] = v_out;
+    meta.Get<T>(kParamOut, t)[i] = p - (g + v_out * mu_) * lr;
+  }
+};
+
+template <typename T>
+struct FusedMomentumFunctor<T, NoNesterov> {
+  T mu_;
+
+  __device__ void operator()(const TensorListMeta<kDepth>& meta, int t,
+                             int64_t i) const {
+    const T p = meta.Get<const T>(kParam, t)[i];
+    const T g = meta.Get<const T>(kGrad, t)[i];
+    const T v = meta.Get<const T>(kVelocity, t)[i];
+    const T lr = meta.Get<const T>(kLR, t)[0];
+    T v_out = v * mu_ + g;
+    meta.Get<T>(kVelocityOut, t)[i] = v_out;
+    meta.Get<T>(kParamOut, t)[i] = p - lr * v_out;
+  }
+};
+
+}  // namespace
+
+template <typename T>
+class FusedMomentumOpCUDAKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    if (SkipUpdate(ctx)) {
+      KeepInputsAsOutputs(
+          ctx, {{"Param", "ParamOut"}, {"Velocity", "VelocityOut"}});
+      return;
+    }
+
+    T mu = static_cast<T>(ctx.Attr<float>("mu"));
+    bool use_nesterov = ctx.Attr<bool>("use_nesterov");
+
+    auto params = ctx.MultiInput<framework::Tensor>("Param");
+    auto grads = ctx.MultiInput<framework::Tensor>("Grad");
+    auto velocities = ctx.MultiInput<framework::Tensor>("Velocity");
+    auto learning_rates = ctx.MultiInput<framework::Tensor>("LearningRate");
+    auto param_outs = ctx.MultiOutput<framework::Tensor>("ParamOut");
+    auto velocity_outs = ctx.MultiOutput<framework::Tensor>("VelocityOut");
+
+    std::vector<std::vector<void*>> addresses(kDepth);
+    std::vector<int64_t> numels;
+    numels.reserve(params.size());
+    for (size_t i = 0; i < params.size(); ++i) {
+      addresses[kParam].push_back(const_cast<T*>(params[i]->data<T>()));
+      addresses[kGrad].push_back(const_cast<T*>(grads[i]->data<T>()));
+      addresses[kVelocity].push_back(
+          const_cast<T*>(velocities[i]->data<T>()));
+      addresses[kLR].push_back(const_cast<T*>(learning_rates[i]->data<T>()));
+      addresses[kParamOut].push_back(
+          param_outs[i]->mutable_data<T>(ctx.GetPlace()));
+      addresses[kVelocityOut].push_back(
+          velocity_outs[i]->mutable_data<T>(ctx.GetPlace()));
+      numels.push_back(params[i]->numel());
+    }
+
+    auto& dev_ctx = ctx.cuda_device_context();
+    if (use_nesterov) {
+      MultiTensorApply<kDepth>(dev_ctx, addresses, numels,
+                               FusedMomentumFunctor<T, UseNesterov>{mu});
+    } else {
+      MultiTensorApply<kDepth>(dev_ctx, addresses, numels,
+                               FusedMomentumFunctor<T, NoNesterov>{mu});
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OP_CUDA_KERNEL(fused_momentum,
+                        ops::FusedMomentumOpCUDAKernel<float>,
+                        ops::FusedMomentumOpCUDAKernel<double>);
@@ -0,0 +1,80 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/optimizers/momentum_op.h"
+#include "paddle/fluid/operators/optimizers/skip_update.h"
+
+namespace paddle {
+namespace operators {
+
+class FusedMomentumOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+ protected:
+  void InferShape(framework::InferShapeContext* ctx) const override;
+
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    auto input_data_type =
+        framework::GetDataTypeOfVar(ctx.MultiInputVar("Param").front());
+    return framework::OpKernelType(input_data_type, ctx.GetPlace());
+  }
+};
+
+template <typename DeviceContext, typename T>
+class FusedMomentumOpKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    if (SkipUpdate(ctx)) {
+      KeepInputsAsOutputs(
+          ctx, {{"Param", "ParamOut"}, {"Velocity", "VelocityOut"}});
+      return;
+    }
+
+    T mu = static_cast<T>(ctx.Attr<float>("mu"));
+    bool use_nesterov = ctx.Attr<bool>("use_nesterov");
+
+    auto params = ctx.MultiInput<framework::Tensor>("Param");
+    auto grads = ctx.MultiInput<framework::Tensor>("Grad");
+    auto velocities = ctx.MultiInput<framework::Tensor>("Velocity");
+    auto learning_rates = ctx.MultiInput<framework::Tensor>("LearningRate");
+    auto param_outs = ctx.MultiOutput<framework::Tensor>("ParamOut");
+    auto velocity_outs = ctx.MultiOutput<framework::Tensor>("VelocityOut");
+
+    for (auto* param_out : param_outs) {
+      param_out->mutable_data<T>(ctx.GetPlace());
+    }
+    for (auto* velocity_out : velocity_outs) {
+      velocity_out->mutable_data<T>(ctx.GetPlace());
+    }
+
+    int num = static_cast<int>(params.size());
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < num; ++i) {
+      CPUDenseMomentumFunctor<T> functor(
+          params[i], grads[i], velocities[i], learning_rates[i], mu,
+          use_nesterov, param_outs[i], velocity_outs[i]);
+      functor();
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -57,6 +57,11 @@ class MomentumOpMaker : public framework::OpProtoAndCheckerMaker {
     AddInput("LearningRate",
              "(Tensor, default Tensor<float>) "
              "Input learning rate");
+    AddInput("SkipUpdate",
+             "(Tensor<bool>, optional) A scalar, e.g., whether the gradients "
+             "of this step overflow. If it is true, the outputs are the same "
+             "as the inputs.")
+        .AsDispensable();
 
     AddOutput("ParamOut",
               "(Tensor) This output is updated parameter. "
@@ -18,6 +18,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/math/algorithm.h"
 #include "paddle/fluid/operators/math/selected_rows_functor.h"
+#include "paddle/fluid/operators/optimizers/skip_update.h"
 #include "paddle/fluid/platform/for_range.h"
 
 namespace paddle {
@@ -301,6 +302,12 @@ template <typename DeviceContext, typename T>
 class MomentumOpKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext& ctx) const override {
+    if (SkipUpdate(ctx)) {
+      KeepInputsAsOutputs(
+          ctx, {{"Param", "ParamOut"}, {"Velocity", "VelocityOut"}});
+      return;
+    }
+
     T mu = static_cast<T>(ctx.Attr<float>("mu"));
     bool use_nesterov = ctx.Attr<bool>("use_nesterov");
 
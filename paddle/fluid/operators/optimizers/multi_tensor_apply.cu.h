@@ -0,0 +1,124 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+
+constexpr int kMultiTensorChunkSize = 65536;
+constexpr int kMultiTensorMaxBlocks = 320;
+constexpr int kMultiTensorThreads = 512;
+
+// The pointer tables of one launch, passed by value as the kernel parameter,
+// which is limited to 4KB. Every block updates one chunk of one tensor.
+// kDepth is the number of tensors, i.e. Param, Grad, ParamOut ..., of every
+// updated parameter. One element tensors, like the learning rate, are read at
+// index 0 by the functors.
+template <int kDepth>
+struct TensorListMeta {
+  static constexpr int kMaxTensors = kDepth <= 6 ? 36 : 24;
+
+  void* addresses[kDepth][kMaxTensors];
+  int64_t numels[kMaxTensors];
+  unsigned char block_to_tensor[kMultiTensorMaxBlocks];
+  int block_to_chunk[kMultiTensorMaxBlocks];
+
+  template <typename T>
+  __device__ __forceinline__ T* Get(int depth, int tensor) const {
+    return static_cast<T*>(addresses[depth][tensor]);
+  }
+};
+
+template <int kDepth, typename Functor>
+__global__ void MultiTensorApplyKernel(TensorListMeta<kDepth> meta,
+                                       Functor functor) {
+  int tensor = meta.block_to_tensor[blockIdx.x];
+  int64_t begin =
+      static_cast<int64_t>(meta.block_to_chunk[blockIdx.x]) *
+      kMultiTensorChunkSize;
+  int64_t end = begin + kMultiTensorChunkSize;
+  if (end > meta.numels[tensor]) end = meta.numels[tensor];
+  for (int64_t i = begin + threadIdx.x; i < end; i += blockDim.x) {
+    functor(meta, tensor, i);
+  }
+}
+
+// Run functor(meta, tensor, i) for every element i of every tensor in as few
+// launches as the pointer tables allow. addresses[d][t] is the data of the
+// d-th tensor of the t-th parameter, and numels[t] is the number of the
+// elements of the t-th parameter.
+template <int kDepth, typename Functor>
+void MultiTensorApply(const platform::CUDADeviceContext& dev_ctx,
+                      const std::vector<std::vector<void*>>& addresses,
+                      const std::vector<int64_t>& numels,
+                      const Functor& functor) {
+  using Meta = TensorListMeta<kDepth>;
+  PADDLE_ENFORCE_EQ(addresses.size(), static_cast<size_t>(kDepth));
+  for (auto& tensor_addresses : addresses) {
+    PADDLE_ENFORCE_EQ(tensor_addresses.size(), numels.size());
+  }
+
+  Meta meta;
+  int num_tensors = 0;
+  int num_blocks = 0;
+  auto launch = [&] {
+    MultiTensorApplyKernel<kDepth, Functor><<<num_blocks, kMultiTensorThreads,
+                                              0, dev_ctx.stream()>>>(meta,
+                                                                     functor);
+    num_blocks = 0;
+  };
+
+  for (size_t t = 0; t < numels.size(); ++t) {
+    if (numels[t] == 0) continue;
+    for (int d = 0; d < kDepth; ++d) {
+      meta.addresses[d][num_tensors] = addresses[d][t];
+    }
+    meta.numels[num_tensors] = numels[t];
+    ++num_tensors;
+
+    int64_t num_chunks =
+        (numels[t] + kMultiTensorChunkSize - 1) / kMultiTensorChunkSize;
+    for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+      meta.block_to_tensor[num_blocks] = num_tensors - 1;
+      meta.block_to_chunk[num_blocks] = static_cast<int>(chunk);
+      ++num_blocks;
+
+      bool last_chunk = chunk == num_chunks - 1;
+      bool tensors_full = num_tensors == Meta::kMaxTensors && last_chunk;
+      if (num_blocks < kMultiTensorMaxBlocks && !tensors_full) continue;
+
+      launch();
+      if (last_chunk) {
+        num_tensors = 0;
+      } else {
+        // The rest chunks of the current tensor go to the next launch.
+        for (int d = 0; d < kDepth; ++d) {
+          meta.addresses[d][0] = meta.addresses[d][num_tensors - 1];
+        }
+        meta.numels[0] = meta.numels[num_tensors - 1];
+        num_tensors = 1;
+      }
+    }
+  }
+  if (num_blocks > 0) launch();
+}
+
+}  // namespace operators
+}  // namespace paddle
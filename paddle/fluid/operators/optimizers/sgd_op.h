@@ -16,6 +16,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/operators/math/selected_rows_functor.h"
 
 namespace paddle {
 namespace operators {
@@ -71,14 +72,15 @@ class SGDOpKernel : public framework::OpKernel<T> {
         auto *grad_data = grad_value.data<T>();
         auto *out_data = param_out->data<T>();
         auto *lr = learning_rate->data<T>();
-        for (size_t i = 0; i < grad_rows.size(); i++) {
-          PADDLE_ENFORCE(grad_rows[i] < grad_height,
-                         "Input rows index should less than height");
-          for (size_t j = 0; j < grad_row_numel; j++) {
-            out_data[grad_rows[i] * grad_row_numel + j] -=
-                lr[0] * grad_data[i * grad_row_numel + j];
-          }
-        }
+        math::ShardedRowsUpdate(
+            grad_rows.data(), grad_rows.size(), [&](size_t i) {
+              PADDLE_ENFORCE(grad_rows[i] < grad_height,
+                             "Input rows index should less than height");
+              for (size_t j = 0; j < grad_row_numel; j++) {
+                out_data[grad_rows[i] * grad_row_numel + j] -=
+                    lr[0] * grad_data[i * grad_row_numel + j];
+              }
+            });
       } else {
         PADDLE_THROW("Unsupported Variable Type of Grad");
       }
@@ -108,15 +110,27 @@ class SGDOpKernel : public framework::OpKernel<T> {
       const auto *lr = learning_rate->data<T>();
       const auto *grad_data = grad.value().data<T>();
       auto *out_data = param_out->mutable_value()->data<T>();
-      for (size_t i = 0; i < grad.rows().size(); i++) {
-        int64_t id_index = param_out->AutoGrownIndex(grad.rows()[i], false);
-        PADDLE_ENFORCE_GE(id_index, static_cast<int64_t>(0),
-                          "id should be in the table");
-        for (int64_t j = 0; j < grad_row_width; j++) {
-          out_data[id_index * grad_row_width + j] -=
-              lr[0] * grad_data[i * grad_row_width + j];
-        }
-      }
+      auto &grad_rows = grad.rows();
+      // Keeps the rows of the gradient in the table if it spills.
+      auto pin = param_out->PinRows(grad_rows.data(), grad_rows.size(), false);
+      // The ids not admitted to the table are not updated.
+      bool skip_missing = param_out->HasLifecycle();
+      // The lookups of the ids only take the read locks of their shards.
+      math::ShardedRowsUpdate(
+          grad_rows.data(), grad_rows.size(), [&](size_t i) {
+            int64_t id_index =
+                skip_missing ? param_out->GetIndexFromId(grad_rows[i])
+                             : param_out->AutoGrownIndex(grad_rows[i], false);
+            if (skip_missing && id_index < 0) return;
+            PADDLE_ENFORCE_GE(id_index, static_cast<int64_t>(0),
+                              "id should be in the table");
+            for (int64_t j = 0; j < grad_row_width; j++) {
+              out_data[id_index * grad_row_width + j] -=
+                  lr[0] * grad_data[i * grad_row_width + j];
+            }
+          });
+      // The updated rows go to the next incremental checkpoint.
+      param_out->MarkDirty(grad_rows.data(), grad_rows.size());
     } else {
       PADDLE_THROW("Unsupported Variable Type of Parameter");
     }
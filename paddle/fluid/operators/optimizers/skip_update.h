@@ -0,0 +1,54 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/operators/amp/loss_scaling.h"
+
+namespace paddle {
+namespace operators {
+
+// Whether an optimizer op skips the update of this step by its optional
+// input SkipUpdate, a bool scalar, e.g., FoundInfinite of the mixed precision
+// training, which is set in the steps whose gradients overflow.
+inline bool SkipUpdate(const framework::ExecutionContext& ctx) {
+  return GetScalar<bool>(ctx.Input<framework::Tensor>("SkipUpdate"), false);
+}
+
+// A skipped op keeps every output the same as its input, the pairs of whose
+// slots are given, e.g., {"Moment1", "Moment1Out"}. Nothing is copied for the
+// outputs updated in place.
+inline void KeepInputsAsOutputs(
+    const framework::ExecutionContext& ctx,
+    const std::vector<std::pair<std::string, std::string>>& slots) {
+  for (auto& slot : slots) {
+    auto ins = ctx.MultiInput<framework::Tensor>(slot.first);
+    auto outs = ctx.MultiOutput<framework::Tensor>(slot.second);
+    PADDLE_ENFORCE_EQ(ins.size(), outs.size(),
+                      "%s and %s should have the same number of variables.",
+                      slot.first, slot.second);
+    for (size_t i = 0; i < ins.size(); ++i) {
+      if (ins[i] == outs[i]) continue;
+      framework::TensorCopy(*ins[i], ctx.GetPlace(), ctx.device_context(),
+                            outs[i]);
+    }
+  }
+}
+
+}  // namespace operators
+}  // namespace paddle
@@ -56,12 +56,16 @@ void PoolOp::InferShape(framework::InferShapeContext* ctx) const {
 
   PADDLE_ENFORCE(in_x_dims.size() == 4 || in_x_dims.size() == 5,
                  "Pooling intput should be 4-D or 5-D tensor.");
+  // The channels of NHWC are the last, after the spatial dims.
+  bool channel_last = in_x_dims.size() == 4 &&
+                      ctx->Attrs().Get<std::string>("data_format") == "NHWC";
+  int spatial_begin = channel_last ? 1 : 2;
 
   if (ctx->Attrs().Get<bool>("global_pooling")) {
     ksize.resize(static_cast<size_t>(in_x_dims.size()) - 2);
     for (size_t i = 0; i < ksize.size(); ++i) {
       paddings[i] = 0;
-      ksize[i] = static_cast<int>(in_x_dims[i + 2]);
+      ksize[i] = static_cast<int>(in_x_dims[i + spatial_begin]);
     }
   }
 
@@ -72,15 +76,18 @@ void PoolOp::InferShape(framework::InferShapeContext* ctx) const {
   PADDLE_ENFORCE_EQ(ksize.size(), paddings.size(),
                     "Paddings size and pooling size should be the same.");
 
-  std::vector<int64_t> output_shape({in_x_dims[0], in_x_dims[1]});
+  std::vector<int64_t> output_shape({in_x_dims[0]});
+  if (!channel_last) output_shape.push_back(in_x_dims[1]);
   if (adaptive) {
     output_shape.insert(output_shape.end(), ksize.begin(), ksize.end());
   } else {
     for (size_t i = 0; i < ksize.size(); ++i) {
-      output_shape.push_back(PoolOutputSize(
-          in_x_dims[i + 2], ksize[i], paddings[i], strides[i], ceil_mode));
+      output_shape.push_back(
+          PoolOutputSize(in_x_dims[i + spatial_begin], ksize[i], paddings[i],
+                         strides[i], ceil_mode));
     }
   }
+  if (channel_last) output_shape.push_back(in_x_dims[3]);
   ctx->SetOutputDim("Out", framework::make_ddim(output_shape));
   ctx->ShareLoD("X", "Out");
 }
@@ -89,10 +96,12 @@ framework::OpKernelType PoolOp::GetExpectedKernelType(
     const framework::ExecutionContext& ctx) const {
   framework::LibraryType library_{framework::LibraryType::kPlain};
   std::string data_format = ctx.Attr<std::string>("data_format");
-  framework::DataLayout layout_ = framework::StringToDataLayout(data_format);
+  // The plain kernels pool the tensors of either NCHW or NHWC in place, so
+  // that the layout is not transformed.
+  framework::DataLayout layout_ = framework::DataLayout::kAnyLayout;
 
 #ifdef PADDLE_WITH_CUDA
-  if (platform::CanCUDNNBeUsed(ctx)) {
+  if (platform::CanCUDNNBeUsed(ctx) && data_format != "NHWC") {
     library_ = framework::LibraryType::kCUDNN;
   }
 #endif
@@ -119,10 +128,12 @@ framework::OpKernelType PoolOpGrad::GetExpectedKernelType(
     const framework::ExecutionContext& ctx) const {
   framework::LibraryType library_{framework::LibraryType::kPlain};
   std::string data_format = ctx.Attr<std::string>("data_format");
-  framework::DataLayout layout_ = framework::StringToDataLayout(data_format);
+  // The plain kernels pool the tensors of either NCHW or NHWC in place, so
+  // that the layout is not transformed.
+  framework::DataLayout layout_ = framework::DataLayout::kAnyLayout;
 
 #ifdef PADDLE_WITH_CUDA
-  if (platform::CanCUDNNBeUsed(ctx)) {
+  if (platform::CanCUDNNBeUsed(ctx) && data_format != "NHWC") {
     library_ = framework::LibraryType::kCUDNN;
   }
 #endif
@@ -213,10 +224,10 @@ void Pool2dOpMaker::Make() {
       .SetDefault(false);
   AddAttr<std::string>(
       "data_format",
-      "(string, default NCHW) Only used in "
-      "An optional string from: \"NHWC\", \"NCHW\". "
-      "Defaults to \"NHWC\". Specify the data format of the output data, "
-      "the input will be transformed automatically. ")
+      "(string, default NCHW) An optional string from: \"NHWC\", "
+      "\"NCHW\". Specify the data format of the input and the output data. "
+      "The 4-D tensors of NHWC are pooled over the contiguous channels, "
+      "without cuDNN.")
       .SetDefault("AnyLayout");
   AddAttr<bool>("is_test",
                 "(bool, default false) Set to true for inference only, false "
@@ -71,10 +71,12 @@ class PoolKernel : public framework::OpKernel<T> {
     std::vector<int> paddings = context.Attr<std::vector<int>>("paddings");
     bool exclusive = context.Attr<bool>("exclusive");
     bool adaptive = context.Attr<bool>("adaptive");
+    std::string data_format = context.Attr<std::string>("data_format");
     if (context.Attr<bool>("global_pooling")) {
+      int spatial_begin = ksize.size() == 2 && data_format == "NHWC" ? 1 : 2;
       for (size_t i = 0; i < ksize.size(); ++i) {
         paddings[i] = 0;
-        ksize[i] = static_cast<int>(in_x->dims()[i + 2]);
+        ksize[i] = static_cast<int>(in_x->dims()[i + spatial_begin]);
       }
     }
     auto& dev_ctx = context.template device_context<DeviceContext>();
@@ -85,16 +87,16 @@ class PoolKernel : public framework::OpKernel<T> {
               DeviceContext, paddle::operators::math::MaxPool<T>, T>
               pool2d_forward;
           paddle::operators::math::MaxPool<T> pool_process;
-          pool2d_forward(dev_ctx, *in_x, ksize, strides, paddings, pool_process,
-                         true, false, out);
+          pool2d_forward(dev_ctx, *in_x, ksize, strides, paddings,
+                         data_format, pool_process, true, false, out);
 
         } else if (pooling_type == "avg") {
           paddle::operators::math::Pool2dFunctor<
               DeviceContext, paddle::operators::math::AvgPool<T>, T>
               pool2d_forward;
           paddle::operators::math::AvgPool<T> pool_process;
-          pool2d_forward(dev_ctx, *in_x, ksize, strides, paddings, pool_process,
-                         exclusive, adaptive, out);
+          pool2d_forward(dev_ctx, *in_x, ksize, strides, paddings,
+                         data_format, pool_process, exclusive, adaptive, out);
         }
       } break;
       case 3: {
@@ -136,10 +138,12 @@ class PoolGradKernel : public framework::OpKernel<T> {
     bool exclusive = context.Attr<bool>("exclusive");
     bool adaptive = context.Attr<bool>("adaptive");
 
+    std::string data_format = context.Attr<std::string>("data_format");
     if (context.Attr<bool>("global_pooling")) {
+      int spatial_begin = ksize.size() == 2 && data_format == "NHWC" ? 1 : 2;
       for (size_t i = 0; i < ksize.size(); ++i) {
         paddings[i] = 0;
-        ksize[i] = static_cast<int>(in_x->dims()[i + 2]);
+        ksize[i] = static_cast<int>(in_x->dims()[i + spatial_begin]);
       }
     }
     auto& dev_ctx = context.template device_context<DeviceContext>();
@@ -154,15 +158,15 @@ class PoolGradKernel : public framework::OpKernel<T> {
             paddle::operators::math::MaxPool2dGradFunctor<DeviceContext, T>
                 pool2d_backward;
             pool2d_backward(dev_ctx, *in_x, *out, *out_grad, ksize, strides,
-                            paddings, in_x_grad);
+                            paddings, data_format, in_x_grad);
           } else if (pooling_type == "avg") {
             paddle::operators::math::Pool2dGradFunctor<
                 DeviceContext, paddle::operators::math::AvgPoolGrad<T>, T>
                 pool2d_backward;
             paddle::operators::math::AvgPoolGrad<T> pool_process;
             pool2d_backward(dev_ctx, *in_x, *out, *out_grad, ksize, strides,
-                            paddings, pool_process, exclusive, adaptive,
-                            in_x_grad);
+                            paddings, data_format, pool_process, exclusive,
+                            adaptive, in_x_grad);
           }
         } break;
         case 3: {
@@ -14,11 +14,23 @@
 
 #include "paddle/fluid/operators/py_func_op.h"
 
+#include <algorithm>
+#include <condition_variable>  // NOLINT
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>  // NOLINT
 #include <set>
 #include <string>
+#include <thread>  // NOLINT
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
 
+DEFINE_int32(py_func_async_max_inflight, 8,
+             "the max number of the calls of the asynchronous py_func ops "
+             "queued on the Python thread, the op waits for the oldest one "
+             "beyond it");
+
 namespace paddle {
 namespace operators {
 
@@ -29,6 +41,8 @@ static std::vector<py::object> g_py_callables;
 const char kForwardPythonCallableId[] = "forward_callable_id";
 const char kBackwardPythonCallableId[] = "backward_callable_id";
 const char kPyFuncBackwardSkipVars[] = "backward_skip_vars";
+const char kPyFuncZeroCopy[] = "zero_copy";
+const char kPyFuncRunAsync[] = "run_async";
 
 size_t AppendPythonCallableObjectAndReturnId(const py::object &py_obj) {
   g_py_callables.emplace_back(py_obj);
@@ -51,13 +65,106 @@ static std::string PythonFuncDebugString(const py::object &py_callable) {
   return inner_func_str + " wrapped by " + wrapper_func_str;
 }
 
+// The numpy dtype of the tensors of type, by the format of the buffer
+// protocol.
+static py::dtype NumpyDtype(framework::proto::VarType::Type type) {
+  switch (type) {
+    case framework::proto::VarType::FP32:
+      return py::dtype("f");
+    case framework::proto::VarType::FP64:
+      return py::dtype("d");
+    case framework::proto::VarType::FP16:
+      return py::dtype("e");
+    case framework::proto::VarType::INT32:
+      return py::dtype("i");
+    case framework::proto::VarType::INT64:
+      return py::dtype("q");
+    case framework::proto::VarType::INT16:
+      return py::dtype("h");
+    case framework::proto::VarType::INT8:
+      return py::dtype("b");
+    case framework::proto::VarType::UINT8:
+      return py::dtype("B");
+    case framework::proto::VarType::BOOL:
+      return py::dtype("?");
+    default:
+      PADDLE_THROW("The tensor of type %d cannot be passed to numpy", type);
+      return py::dtype("f");
+  }
+}
+
+static framework::proto::VarType::Type TensorTypeOf(const py::dtype &dtype) {
+  char kind = dtype.kind();
+  size_t size = dtype.itemsize();
+  if (kind == 'f' && size == 4) return framework::proto::VarType::FP32;
+  if (kind == 'f' && size == 8) return framework::proto::VarType::FP64;
+  if (kind == 'f' && size == 2) return framework::proto::VarType::FP16;
+  if (kind == 'i' && size == 4) return framework::proto::VarType::INT32;
+  if (kind == 'i' && size == 8) return framework::proto::VarType::INT64;
+  if (kind == 'i' && size == 2) return framework::proto::VarType::INT16;
+  if (kind == 'i' && size == 1) return framework::proto::VarType::INT8;
+  if (kind == 'u' && size == 1) return framework::proto::VarType::UINT8;
+  if (kind == 'b' && size == 1) return framework::proto::VarType::BOOL;
+  PADDLE_THROW("The numpy array of kind %c and item size %d is not supported",
+               kind, size);
+  return framework::proto::VarType::FP32;
+}
+
+// A read-only numpy array on the memory of the CPU tensor, which keeps the
+// memory alive as long as the array.
+static py::object NumpyView(const framework::LoDTensor &tensor) {
+  auto dtype = NumpyDtype(tensor.type());
+  std::vector<size_t> shape;
+  std::vector<size_t> strides(tensor.dims().size());
+  for (int i = 0; i < tensor.dims().size(); ++i) {
+    shape.push_back(static_cast<size_t>(tensor.dims()[i]));
+  }
+  size_t stride = dtype.itemsize();
+  for (size_t i = strides.size(); i > 0; --i) {
+    strides[i - 1] = stride;
+    stride *= shape[i - 1];
+  }
+  auto *holder = new framework::LoDTensor(tensor);
+  py::capsule base(holder, [](void *ptr) {
+    delete static_cast<framework::LoDTensor *>(ptr);
+  });
+  py::array array(dtype, shape, strides, holder->data<void>(), base);
+  array.attr("setflags")(py::arg("write") = false);
+  return std::move(array);
+}
+
+// Copies the array into the buffer of out, which is reused if it is large
+// enough, instead of a tensor allocated by Python for every call.
+static void CopyNumpyToTensor(const py::array &array,
+                              framework::LoDTensor *out) {
+  auto contiguous = py::array::ensure(array, py::array::c_style);
+  PADDLE_ENFORCE(static_cast<bool>(contiguous),
+                 "The output cannot be converted to a contiguous array");
+  std::vector<int64_t> dims;
+  for (int i = 0; i < contiguous.ndim(); ++i) {
+    dims.push_back(static_cast<int64_t>(contiguous.shape(i)));
+  }
+  out->Resize(framework::make_ddim(dims));
+  out->set_lod(framework::LoD());
+  void *dst = out->mutable_data(platform::CPUPlace(),
+                                TensorTypeOf(contiguous.dtype()));
+  std::memcpy(dst, contiguous.data(), contiguous.nbytes());
+}
+
 static void CallPythonFunc(py::object *callable,
                            const std::vector<framework::LoDTensor> &ins,
-                           std::vector<framework::LoDTensor *> *outs) {
+                           std::vector<framework::LoDTensor *> *outs,
+                           bool zero_copy) {
   py::gil_scoped_acquire guard;
   py::tuple in_args(ins.size());
   for (size_t i = 0; i < ins.size(); ++i) {
-    in_args[i] = ins[i].IsInitialized() ? py::cast(ins[i]) : py::cast(nullptr);
+    if (!ins[i].IsInitialized()) {
+      in_args[i] = py::cast(nullptr);
+    } else if (zero_copy) {
+      in_args[i] = NumpyView(ins[i]);
+    } else {
+      in_args[i] = py::cast(ins[i]);
+    }
   }
 
   auto ret = (*callable)(*in_args);
@@ -68,10 +175,9 @@ static void CallPythonFunc(py::object *callable,
     // Python function has no return values or returns None
     // In this case, ret_num = 1 && ret[0] == None && out_num should be 0
     // Otherwise, ret_num must be equal to out_num
-    PADDLE_ENFORCE(
-        ret_num == 1 && out_num == 0 &&
-            py::cast<framework::LoDTensor *>(ret_tuple[0]) == nullptr,
-        "Output number not match. Expected %d, actual %d", out_num, ret_num);
+    PADDLE_ENFORCE(ret_num == 1 && out_num == 0 && ret_tuple[0].is_none(),
+                   "Output number not match. Expected %d, actual %d", out_num,
+                   ret_num);
   }
 
   for (size_t i = 0; i < out_num; ++i) {
@@ -79,18 +185,115 @@ static void CallPythonFunc(py::object *callable,
     if (out == nullptr) {
       continue;
     }
+    py::object py_out = ret_tuple[i];
+    if (py::isinstance<py::array>(py_out)) {
+      CopyNumpyToTensor(py::reinterpret_borrow<py::array>(py_out), out);
+      continue;
+    }
     try {
-      auto *py_out_tensor = py::cast<framework::LoDTensor *>(ret_tuple[i]);
+      auto *py_out_tensor = py::cast<framework::LoDTensor *>(py_out);
       PADDLE_ENFORCE_NOT_NULL(py_out_tensor,
                               "Output tensor %d should not be nullptr", i);
       out->set_lod(py_out_tensor->lod());
       out->ShareDataWith(*py_out_tensor);
     } catch (py::cast_error &) {
-      PADDLE_THROW("The %d-th output must be LoDTensor", i);
+      PADDLE_THROW("The %d-th output must be LoDTensor or numpy array", i);
     }
   }
 }
 
+// The calls of the asynchronous py_func ops, which have no outputs, e.g.
+// the metrics and the logging. They run in order on a dedicated thread while
+// the step goes on, and the thread runs all the calls queued under one
+// acquisition of the GIL. The runner and its thread are never destroyed,
+// since the thread may not take the GIL when the interpreter exits, the
+// Python side waits for the calls at exit instead.
+class PyFuncAsyncRunner {
+ public:
+  using Call = std::function<void()>;
+
+  static PyFuncAsyncRunner &Instance() {
+    static auto *runner = new PyFuncAsyncRunner;
+    return *runner;
+  }
+
+  // Queues the call, and throws the first error of the calls since the last
+  // Wait, if any.
+  void Push(Call call) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ThrowError(&lock);
+    size_t max_in_flight =
+        static_cast<size_t>(std::max(FLAGS_py_func_async_max_inflight, 1));
+    finished_.wait(lock, [&] { return in_flight_ < max_in_flight; });
+    if (!started_) {
+      std::thread([this] { Loop(); }).detach();
+      started_ = true;
+    }
+    queue_.push_back(std::move(call));
+    ++in_flight_;
+    scheduled_.notify_one();
+  }
+
+  // Waits for all the queued calls, and throws the first error of them.
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    finished_.wait(lock, [&] { return in_flight_ == 0; });
+    ThrowError(&lock);
+  }
+
+ private:
+  PyFuncAsyncRunner() = default;
+
+  void ThrowError(std::unique_lock<std::mutex> *lock) {
+    if (error_.empty()) return;
+    std::string error;
+    error.swap(error_);
+    lock->unlock();
+    PADDLE_THROW("An asynchronous py_func call failed: %s", error);
+  }
+
+  void Loop() {
+    while (true) {
+      std::deque<Call> calls;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        scheduled_.wait(lock, [&] { return !queue_.empty(); });
+        calls.swap(queue_);
+      }
+      std::string error;
+      {
+        py::gil_scoped_acquire guard;
+        for (auto &call : calls) {
+          try {
+            call();
+          } catch (std::exception &e) {
+            if (error.empty()) error = e.what();
+          }
+        }
+      }
+      // The inputs of the calls are released without the GIL.
+      size_t num_calls = calls.size();
+      calls.clear();
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        in_flight_ -= num_calls;
+        if (error_.empty()) error_ = error;
+      }
+      finished_.notify_all();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable scheduled_;
+  std::condition_variable finished_;
+  std::deque<Call> queue_;
+  size_t in_flight_{0};
+  std::string error_;
+  bool started_{false};
+};
+
+void WaitPyFuncAsyncCalls() { PyFuncAsyncRunner::Instance().Wait(); }
+
 class PyFuncOpVarTypInference : public framework::VarTypeInference {
  public:
   void operator()(const framework::OpDesc &op,
@@ -167,6 +370,14 @@ class PyFuncOpMaker : public framework::OpProtoAndCheckerMaker {
     AddAttr<std::vector<std::string>>(kPyFuncBackwardSkipVars,
                                       "Unused forward in/out in backward op")
         .SetDefault(std::vector<std::string>());
+    AddAttr<bool>(kPyFuncZeroCopy,
+                  "Pass the inputs as read-only numpy arrays on the memory of "
+                  "the CPU tensors, without the LoD, instead of LoDTensors.")
+        .SetDefault(false);
+    AddAttr<bool>(kPyFuncRunAsync,
+                  "Call the Python function of the op without outputs on the "
+                  "dedicated Python thread, without waiting for it.")
+        .SetDefault(false);
     AddComment(R"DOC("PyFunc Op")DOC");
   }
 };
@@ -210,6 +421,7 @@ class PyFuncOpGradDescMaker : public framework::GradOpDescMakerBase {
     bwd_attrs[kForwardPythonCallableId] =
         fwd_attrs.at(kBackwardPythonCallableId);
     bwd_attrs[kBackwardPythonCallableId] = -1;
+    bwd_attrs[kPyFuncZeroCopy] = fwd_attrs.at(kPyFuncZeroCopy);
     grad_op->SetAttrMap(bwd_attrs);
 
     // All forward inputs
@@ -268,6 +480,9 @@ class PyFuncOp : public framework::OperatorBase {
                const platform::Place &place) const override {
     auto &in_arg_names = Inputs("X");
     auto &out_arg_names = Outputs("Out");
+    bool run_async = Attr<bool>(kPyFuncRunAsync);
+    PADDLE_ENFORCE(!run_async || out_arg_names.empty(),
+                   "Only the py_func ops without outputs run asynchronously");
 
     std::vector<framework::LoDTensor> inputs(in_arg_names.size());
     for (size_t i = 0; i < in_arg_names.size(); ++i) {
@@ -280,7 +495,9 @@ class PyFuncOp : public framework::OperatorBase {
       if (!in_tensor.IsInitialized()) {
         continue;
       }
-      if (platform::is_gpu_place(in_tensor.place())) {
+      // The later ops may write the buffers of the inputs before an
+      // asynchronous call, which takes a copy of them.
+      if (platform::is_gpu_place(in_tensor.place()) || run_async) {
         framework::TensorCopySync(in_tensor, platform::CPUPlace(), &inputs[i]);
       } else {
         inputs[i].ShareDataWith(in_tensor);
@@ -296,10 +513,22 @@ class PyFuncOp : public framework::OperatorBase {
     }
 
     auto callable_id = static_cast<size_t>(Attr<int>(kForwardPythonCallableId));
+    bool zero_copy = Attr<bool>(kPyFuncZeroCopy);
+    if (run_async) {
+      VLOG(10) << "Queue the call of Python function with id " << callable_id;
+      // The callable is looked up when it is called with the GIL, the
+      // callables may be reallocated by the registration of new ones.
+      PyFuncAsyncRunner::Instance().Push([callable_id, inputs, zero_copy] {
+        std::vector<framework::LoDTensor *> no_outputs;
+        CallPythonFunc(GetPythonCallableObject(callable_id), inputs,
+                       &no_outputs, zero_copy);
+      });
+      return;
+    }
     auto *py_callable = GetPythonCallableObject(callable_id);
     VLOG(10) << "Call Python function with id " << callable_id << ": "
              << PythonFuncDebugString(*py_callable);
-    CallPythonFunc(py_callable, inputs, &outputs);
+    CallPythonFunc(py_callable, inputs, &outputs, zero_copy);
   }
 };
 
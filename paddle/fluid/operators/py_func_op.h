@@ -20,5 +20,9 @@ namespace operators {
 
 size_t AppendPythonCallableObjectAndReturnId(const ::pybind11::object &py_obj);
 
+// Waits for the calls of the asynchronous py_func ops, and throws the first
+// error of them. It is called without the GIL.
+void WaitPyFuncAsyncCalls();
+
 }  // namespace operators
 }  // namespace paddle
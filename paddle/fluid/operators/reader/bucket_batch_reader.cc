@@ -0,0 +1,131 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/reader/bucket_batch_reader.h"
+#include <algorithm>
+#include <random>
+#include <utility>
+#include "glog/logging.h"
+#include "paddle/fluid/operators/reader/merge_instances.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+BucketBatchReader::BucketBatchReader(const std::shared_ptr<ReaderBase>& reader,
+                                     size_t batch_size, size_t pool_size,
+                                     int64_t max_tokens, size_t length_slot,
+                                     bool discard_leftover, size_t seed)
+    : DecoratedReader(reader),
+      batch_size_(batch_size),
+      pool_size_(pool_size),
+      max_tokens_(max_tokens),
+      length_slot_(length_slot),
+      discard_leftover_(discard_leftover),
+      seed_(seed) {
+  PADDLE_ENFORCE_GT(batch_size_, 0UL);
+  PADDLE_ENFORCE_GE(pool_size_, batch_size_,
+                    "The pool should hold a batch at least.");
+  if (seed_ == 0) {
+    std::random_device device;
+    seed_ = device();
+  }
+}
+
+void BucketBatchReader::ReadNextImpl(std::vector<framework::LoDTensor>* out) {
+  if (batch_pos_ >= batches_.size()) {
+    ReloadPool();
+  }
+  if (batch_pos_ >= batches_.size()) {
+    out->clear();
+    return;
+  }
+  MergeInstances(batches_[batch_pos_], out);
+  batches_[batch_pos_++].clear();
+}
+
+void BucketBatchReader::ShutdownImpl() {
+  reader_->Shutdown();
+  leftover_.clear();
+  batches_.clear();
+  batch_pos_ = 0;
+}
+
+void BucketBatchReader::StartImpl() { reader_->Start(); }
+
+int64_t BucketBatchReader::LengthOf(const Instance& instance) const {
+  PADDLE_ENFORCE_LT(length_slot_, instance.size(),
+                    "The length_slot is out of the slots of the instance.");
+  auto& dims = instance[length_slot_].dims();
+  return dims.size() > 0 ? dims[0] : 1;
+}
+
+void BucketBatchReader::ReloadPool() {
+  batches_.clear();
+  batch_pos_ = 0;
+  std::vector<Instance> pool = std::move(leftover_);
+  leftover_.clear();
+  pool.reserve(pool_size_);
+  bool end_of_data = false;
+  while (pool.size() < pool_size_) {
+    Instance ins;
+    reader_->ReadNext(&ins);
+    if (ins.empty()) {
+      end_of_data = true;
+      break;
+    }
+    pool.emplace_back(std::move(ins));
+  }
+
+  std::mt19937 g(seed_);
+  std::shuffle(pool.begin(), pool.end(), g);
+  std::vector<std::pair<int64_t, size_t>> order;
+  order.reserve(pool.size());
+  for (size_t i = 0; i < pool.size(); ++i) {
+    order.emplace_back(LengthOf(pool[i]), i);
+  }
+  std::sort(order.begin(), order.end());
+
+  std::vector<Instance> batch;
+  // The lengths are ascending, so the instance added is the longest of the
+  // batch.
+  for (auto& item : order) {
+    bool over_budget =
+        max_tokens_ > 0 &&
+        static_cast<int64_t>(batch.size() + 1) * item.first > max_tokens_;
+    if (!batch.empty() && (batch.size() == batch_size_ || over_budget)) {
+      batches_.emplace_back(std::move(batch));
+      batch.clear();
+    }
+    batch.emplace_back(std::move(pool[item.second]));
+  }
+  if (!batch.empty()) {
+    if (batch.size() == batch_size_) {
+      batches_.emplace_back(std::move(batch));
+    } else if (!end_of_data) {
+      leftover_ = std::move(batch);
+    } else if (!discard_leftover_) {
+      batches_.emplace_back(std::move(batch));
+    }
+  }
+
+  std::shuffle(batches_.begin(), batches_.end(), g);
+  seed_ = g();  // update seed_;
+  VLOG(10) << "Bucketed " << pool.size() << " instances into "
+           << batches_.size() << " batches";
+}
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,77 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "paddle/fluid/framework/reader.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+/*
+ * Batches the instances of the underlying reader by their lengths, so that
+ * the instances padded together have close lengths.
+ *
+ * The reader fills a pool of pool_size instances, sorts them by length, and
+ * cuts the sorted pool into batches of at most batch_size instances. With
+ * max_tokens > 0, a batch is also cut before its padded size, its count
+ * times its longest length, exceeds max_tokens, so that the batches of the
+ * long instances are smaller. The batches of the pool are yielded in a
+ * shuffled order, and the instances of the same length are shuffled before
+ * the sort, so the training stays randomized across the buckets.
+ *
+ * The length of an instance is the first dim of its length_slot-th tensor,
+ * which is the sequence length of an instance of a LoDTensor. The last,
+ * unfilled batch of a pool is moved to the next pool, and is yielded at the
+ * end of the data unless discard_leftover.
+ */
+class BucketBatchReader : public framework::DecoratedReader {
+ public:
+  BucketBatchReader(const std::shared_ptr<ReaderBase>& reader,
+                    size_t batch_size, size_t pool_size, int64_t max_tokens,
+                    size_t length_slot, bool discard_leftover,
+                    size_t seed = 0);
+
+  void ReadNextImpl(std::vector<framework::LoDTensor>* out) override;
+
+ private:
+  using Instance = std::vector<framework::LoDTensor>;
+
+  void ShutdownImpl() override;
+
+  void StartImpl() override;
+
+  int64_t LengthOf(const Instance& instance) const;
+
+  void ReloadPool();
+
+  size_t batch_size_;
+  size_t pool_size_;
+  int64_t max_tokens_;
+  size_t length_slot_;
+  bool discard_leftover_;
+  size_t seed_;
+
+  // The instances of the unfilled batch of the last pool.
+  std::vector<Instance> leftover_;
+  std::vector<std::vector<Instance>> batches_;
+  size_t batch_pos_{0};
+};
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,111 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/reader/bucket_batch_reader.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+
+using paddle::framework::LoD;
+using paddle::framework::LoDTensor;
+using paddle::framework::make_ddim;
+using paddle::operators::reader::BucketBatchReader;
+
+// Yields an instance of a sequence of the length i % 37 + 1 and the value i
+// for the i in [0, num).
+class StubSequenceReader : public paddle::framework::ReaderBase {
+ public:
+  explicit StubSequenceReader(int num) : num_(num) {}
+
+  void ReadNextImpl(std::vector<LoDTensor>* out) override {
+    out->clear();
+    if (next_ >= num_) return;
+    int length = next_ % 37 + 1;
+    LoDTensor seq;
+    float* data = seq.mutable_data<float>(make_ddim({length, 1}),
+                                          paddle::platform::CPUPlace());
+    std::fill(data, data + length, static_cast<float>(next_));
+    seq.set_lod(LoD({{0, static_cast<size_t>(length)}}));
+    out->push_back(seq);
+    ++next_;
+  }
+
+  void StartImpl() override { next_ = 0; }
+
+ private:
+  int num_;
+  int next_{0};
+};
+
+// Reads the batches of the reader, and returns the sequence lengths of them.
+static std::vector<std::vector<int64_t>> ReadBatches(
+    const std::shared_ptr<paddle::framework::DecoratedReader>& reader) {
+  std::vector<std::vector<int64_t>> batches;
+  while (true) {
+    std::vector<LoDTensor> out;
+    reader->ReadNext(&out);
+    if (out.empty()) break;
+    EXPECT_EQ(out.size(), 1UL);
+    auto& lod = out[0].lod()[0];
+    batches.emplace_back();
+    for (size_t i = 0; i + 1 < lod.size(); ++i) {
+      batches.back().push_back(lod[i + 1] - lod[i]);
+    }
+    EXPECT_EQ(static_cast<int64_t>(lod.back()), out[0].dims()[0]);
+  }
+  return batches;
+}
+
+TEST(BucketBatchReader, BatchSize) {
+  auto root = std::make_shared<StubSequenceReader>(1000);
+  auto reader = paddle::framework::MakeDecoratedReader<BucketBatchReader>(
+      root, 8, 256, 0, 0, false, 1);
+  auto batches = ReadBatches(reader);
+  size_t num = 0;
+  int64_t padded = 0;
+  for (auto& lengths : batches) {
+    EXPECT_LE(lengths.size(), 8UL);
+    num += lengths.size();
+    auto range = std::minmax_element(lengths.begin(), lengths.end());
+    // A pool of 256 has about 7 instances of a length.
+    EXPECT_LE(*range.second - *range.first, 2);
+    padded += *range.second * lengths.size();
+  }
+  EXPECT_EQ(num, 1000UL);
+  // The lengths sum to 18982.
+  EXPECT_LT(padded, 18982 * 11 / 10);
+}
+
+TEST(BucketBatchReader, MaxTokens) {
+  auto root = std::make_shared<StubSequenceReader>(1000);
+  auto reader = paddle::framework::MakeDecoratedReader<BucketBatchReader>(
+      root, 32, 256, 64, 0, true, 1);
+  auto batches = ReadBatches(reader);
+  size_t num = 0;
+  for (auto& lengths : batches) {
+    int64_t longest = *std::max_element(lengths.begin(), lengths.end());
+    EXPECT_LE(longest * static_cast<int64_t>(lengths.size()), 64);
+    num += lengths.size();
+  }
+  EXPECT_LE(num, 1000UL);
+  EXPECT_GT(num, 1000UL - 32);
+
+  // The batches are shuffled, so they are not in the order of length.
+  bool sorted = true;
+  for (size_t i = 1; i < batches.size(); ++i) {
+    sorted = sorted && batches[i - 1][0] <= batches[i][0];
+  }
+  EXPECT_FALSE(sorted);
+}
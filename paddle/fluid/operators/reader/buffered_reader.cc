@@ -13,7 +13,10 @@
 // limitations under the License.
 
 #include "paddle/fluid/operators/reader/buffered_reader.h"
+#include <cstring>
 #include <vector>
+#include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/platform/device_context.h"
 
 namespace paddle {
 namespace operators {
@@ -24,6 +27,17 @@ BufferedReader::~BufferedReader() {
     position_.front().wait();
     position_.pop();
   }
+#ifdef PADDLE_WITH_CUDA
+  if (platform::is_gpu_place(place_)) {
+    platform::SetDeviceId(boost::get<platform::CUDAPlace>(place_).device);
+    PADDLE_ENFORCE(cudaStreamSynchronize(stream_));
+    for (size_t i = 0; i < buffer_size_; ++i) {
+      PADDLE_ENFORCE(cudaEventDestroy(copied_events_[i]));
+      PADDLE_ENFORCE(cudaEventDestroy(consumed_events_[i]));
+    }
+    PADDLE_ENFORCE(cudaStreamDestroy(stream_));
+  }
+#endif
 }
 
 BufferedReader::BufferedReader(
@@ -32,7 +46,29 @@ BufferedReader::BufferedReader(
     : framework::DecoratedReader(reader),
       thread_pool_(1),
       place_(place),
-      buffer_size_(buffer_size) {
+      buffer_size_(buffer_size),
+      monitor_(framework::GetReaderMonitor("buffered_reader")) {
+  PADDLE_ENFORCE_GT(buffer_size_, 1UL,
+                    "The buffer size should be larger than 1, since a slot is "
+                    "held by the batch being computed.");
+#ifdef PADDLE_WITH_CUDA
+  if (platform::is_gpu_place(place_)) {
+    platform::SetDeviceId(boost::get<platform::CUDAPlace>(place_).device);
+    compute_stream_ = static_cast<platform::CUDADeviceContext *>(
+                          platform::DeviceContextPool::Instance().Get(place_))
+                          ->stream();
+    PADDLE_ENFORCE(cudaStreamCreateWithFlags(&stream_, cudaStreamNonBlocking));
+    copied_events_.resize(buffer_size);
+    consumed_events_.resize(buffer_size);
+    for (size_t i = 0; i < buffer_size; ++i) {
+      PADDLE_ENFORCE(
+          cudaEventCreateWithFlags(&copied_events_[i], cudaEventDisableTiming));
+      PADDLE_ENFORCE(cudaEventCreateWithFlags(&consumed_events_[i],
+                                              cudaEventDisableTiming));
+    }
+    pinned_buffer_.resize(buffer_size);
+  }
+#endif
   cpu_buffer_.resize(buffer_size);
   gpu_buffer_.resize(buffer_size);
   ReadTillBufferFullAsync();
@@ -47,31 +83,89 @@ void BufferedReader::ReadTillBufferFullAsync() {
 
 void BufferedReader::ReadAsync(size_t i) {
   position_.emplace(thread_pool_.enqueue([this, i]() -> size_t {
+#ifdef PADDLE_WITH_CUDA
+    if (platform::is_gpu_place(place_)) {
+      // The last copy of the slot may still read its host buffers.
+      PADDLE_ENFORCE(cudaEventSynchronize(copied_events_[i]));
+    }
+#endif
     TensorVec &cpu = cpu_buffer_[i];
-    reader_->ReadNext(&cpu);
+    {
+      framework::ReaderTimer timer(monitor_, framework::ReaderMonitor::kParse);
+      reader_->ReadNext(&cpu);
+    }
 
     if (cpu.empty()) {
+      ++num_ready_;
       return -1UL;
     }
+    uint64_t bytes = 0;
+    for (auto &tensor : cpu) {
+      if (tensor.IsInitialized()) bytes += tensor.memory_size();
+    }
+    monitor_->RecordProduced(bytes);
 
+#ifdef PADDLE_WITH_CUDA
     if (platform::is_gpu_place(place_)) {
-      TensorVec &gpu = gpu_buffer_[i];
-      gpu.resize(cpu.size());
-      for (size_t i = 0; i < cpu.size(); ++i) {
-        framework::TensorCopySync(cpu[i], place_, &gpu[i]);
-        gpu[i].set_lod(cpu[i].lod());
-      }
+      CopyToDeviceAsync(i);
     }
+#endif
+    ++num_ready_;
     return i;
   }));
 }
 
+#ifdef PADDLE_WITH_CUDA
+void BufferedReader::CopyToDeviceAsync(size_t i) {
+  auto gpu_place = boost::get<platform::CUDAPlace>(place_);
+  platform::SetDeviceId(gpu_place.device);
+  TensorVec &cpu = cpu_buffer_[i];
+  TensorVec &pinned = pinned_buffer_[i];
+  TensorVec &gpu = gpu_buffer_[i];
+  pinned.resize(cpu.size());
+  gpu.resize(cpu.size());
+  // The ops of the batch which used the slot may still read its device
+  // buffers.
+  PADDLE_ENFORCE(cudaStreamWaitEvent(stream_, consumed_events_[i], 0));
+  for (size_t j = 0; j < cpu.size(); ++j) {
+    auto &src = cpu[j];
+    if (!src.IsInitialized()) {
+      gpu[j] = src;
+      continue;
+    }
+    size_t size = src.numel() * framework::SizeOfType(src.type());
+    gpu[j].Resize(src.dims());
+    void *dst = gpu[j].mutable_data(place_, src.type());
+    gpu[j].set_lod(src.lod());
+    gpu[j].set_layout(src.layout());
+    const void *src_ptr = src.data<void>();
+    if (platform::is_cuda_pinned_place(src.place())) {
+      memory::Copy(gpu_place, dst, platform::CUDAPinnedPlace(), src_ptr, size,
+                   stream_);
+    } else if (platform::is_gpu_place(src.place())) {
+      memory::Copy(gpu_place, dst, boost::get<platform::CUDAPlace>(src.place()),
+                   src_ptr, size, stream_);
+    } else {
+      // The copies from the pageable memory are not asynchronous.
+      pinned[j].Resize(src.dims());
+      void *staging = pinned[j].mutable_data(platform::CUDAPinnedPlace(),
+                                             src.type());
+      std::memcpy(staging, src_ptr, size);
+      memory::Copy(gpu_place, dst, platform::CUDAPinnedPlace(), staging, size,
+                   stream_);
+    }
+  }
+  PADDLE_ENFORCE(cudaEventRecord(copied_events_[i], stream_));
+}
+#endif
+
 void BufferedReader::ShutdownImpl() {
   reader_->Shutdown();
   while (!position_.empty()) {
     position_.pop();
   }
   prev_pos_ = -1UL;
+  num_ready_ = 0;
 }
 
 void BufferedReader::StartImpl() {
@@ -84,20 +178,42 @@ void BufferedReader::ReadNextImpl(std::vector<framework::LoDTensor> *out) {
     out->clear();
     return;
   }
-  size_t i = position_.front().get();
+  size_t i;
+  {
+    framework::ReaderTimer timer(monitor_,
+                                 framework::ReaderMonitor::kConsumerWait);
+    i = position_.front().get();
+  }
   position_.pop();
+  monitor_->RecordQueueSize(--num_ready_, buffer_size_);
 
   if (i == -1UL) {
     ReadNextImpl(out);
     return;
   }
+  monitor_->RecordConsumed();
 
-  *out = platform::is_gpu_place(place_) ? gpu_buffer_[i] : cpu_buffer_[i];
+  if (platform::is_gpu_place(place_)) {
+#ifdef PADDLE_WITH_CUDA
+    // The ops of the batch wait for its copy on the device, not on the host.
+    PADDLE_ENFORCE(cudaStreamWaitEvent(compute_stream_, copied_events_[i], 0));
+#endif
+    *out = gpu_buffer_[i];
+  } else {
+    *out = cpu_buffer_[i];
+  }
 
   // Do not push current position into ReadAsync. Push the previous position
   // Since all computation in fluid are async, change the data of
   // current position may cause data error.
   if (prev_pos_ != -1Ul) {
+#ifdef PADDLE_WITH_CUDA
+    if (platform::is_gpu_place(place_)) {
+      // The ops of the previous batch are enqueued before this read.
+      PADDLE_ENFORCE(
+          cudaEventRecord(consumed_events_[prev_pos_], compute_stream_));
+    }
+#endif
     ReadAsync(prev_pos_);
   }
   prev_pos_ = i;
@@ -14,16 +14,32 @@
 
 #pragma once
 
+#include <atomic>
 #include <list>
 #include <queue>
 #include <vector>
 #include "ThreadPool.h"
 #include "paddle/fluid/framework/reader.h"
+#include "paddle/fluid/framework/reader_stats.h"
+#ifdef PADDLE_WITH_CUDA
+#include <cuda_runtime.h>
+#endif
 
 namespace paddle {
 namespace operators {
 namespace reader {
 
+/*
+ * Read the batches of the underlying reader ahead into buffer_size slots, and
+ * copy them to the place.
+ *
+ * On GPU, the batches are staged into the pinned memory of the slot, unless
+ * they are already pinned, and copied on a stream of the reader, which the
+ * compute stream waits for by an event. So with 3 slots, the batch N + 2 is
+ * parsed while N + 1 is copied and N is computed. The pinned and the device
+ * buffers of the slots are reused, so there is no allocation once the sizes
+ * of the batches stop growing.
+ */
 class BufferedReader : public framework::DecoratedReader {
   using TensorVec = std::vector<framework::LoDTensor>;
   using VecFuture = std::future<TensorVec>;
@@ -39,6 +55,11 @@ class BufferedReader : public framework::DecoratedReader {
 
   void ReadAsync(size_t i);
 
+#ifdef PADDLE_WITH_CUDA
+  // Enqueue the copy of slot i to the device on stream_.
+  void CopyToDeviceAsync(size_t i);
+#endif
+
  protected:
   void ShutdownImpl() override;
   void StartImpl() override;
@@ -58,7 +79,19 @@ class BufferedReader : public framework::DecoratedReader {
   // buffers and prevent alloc every time.
   std::vector<TensorVec> cpu_buffer_;
   std::vector<TensorVec> gpu_buffer_;
+#ifdef PADDLE_WITH_CUDA
+  std::vector<TensorVec> pinned_buffer_;
+  cudaStream_t stream_{nullptr};
+  cudaStream_t compute_stream_{nullptr};
+  // Recorded on stream_ after the copy of a slot, and on the compute stream
+  // after the ops which read the device buffer of a slot.
+  std::vector<cudaEvent_t> copied_events_;
+  std::vector<cudaEvent_t> consumed_events_;
+#endif
   size_t prev_pos_{-1UL};
+  framework::ReaderMonitor* monitor_;
+  // The number of the buffers read, which is the occupancy of the buffer.
+  std::atomic<size_t> num_ready_{0};
 };
 
 }  // namespace reader
@@ -0,0 +1,88 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/detail/safe_ref.h"
+#include "paddle/fluid/operators/reader/bucket_batch_reader.h"
+#include "paddle/fluid/operators/reader/reader_op_registry.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+class CreateBucketBatchReaderOp : public framework::OperatorBase {
+ public:
+  using framework::OperatorBase::OperatorBase;
+
+ private:
+  void RunImpl(const framework::Scope& scope,
+               const platform::Place& dev_place) const override {
+    auto* out = detail::Ref(scope.FindVar(Output("Out")))
+                    .GetMutable<framework::ReaderHolder>();
+    if (out->Get() != nullptr) {
+      return;
+    }
+    const auto& underlying_reader = scope.FindVar(Input("UnderlyingReader"))
+                                        ->Get<framework::ReaderHolder>();
+    out->Reset(framework::MakeDecoratedReader<BucketBatchReader>(
+        underlying_reader, static_cast<size_t>(Attr<int>("batch_size")),
+        static_cast<size_t>(Attr<int>("pool_size")),
+        static_cast<int64_t>(Attr<int>("max_tokens")),
+        static_cast<size_t>(Attr<int>("length_slot")),
+        Attr<bool>("discard_leftover")));
+  }
+};
+
+class CreateBucketBatchReaderOpMaker : public DecoratedReaderMakerBase {
+ protected:
+  void Apply() override {
+    AddAttr<int>("batch_size",
+                 "The most instances the reader yields each time.")
+        .GreaterThan(0);
+    AddAttr<int>("pool_size",
+                 "How many instances are sorted by length together. It "
+                 "should not be less than batch_size.")
+        .GreaterThan(0);
+    AddAttr<int>("max_tokens",
+                 "If positive, the most instances times the longest length "
+                 "of a batch, which bounds the padded size of the batches.")
+        .SetDefault(0)
+        .GreaterThan(-1);
+    AddAttr<int>("length_slot",
+                 "The slot whose first dim is the length of an instance.")
+        .SetDefault(0)
+        .GreaterThan(-1);
+    AddAttr<bool>("discard_leftover",
+                  "If true, the leftover instances that are not enough for a "
+                  "new batch at the end of the data will be discarded.")
+        .SetDefault(true);
+    AddComment(R"DOC(
+      CreateBucketBatchReader Operator
+
+      A bucket batch reader takes another reader as its 'underlying reader',
+      sorts a pool of the underlying reader's outputs by length, and yields
+      them in batches of close lengths, in a shuffled order. It bounds the
+      padding of the sequence models, which pad a batch to its longest
+      instance.
+    )DOC");
+  }
+};
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators::reader;
+REGISTER_DECORATED_READER_OPERATOR(create_bucket_batch_reader,
+                                   ops::CreateBucketBatchReaderOp,
+                                   ops::CreateBucketBatchReaderOpMaker);
@@ -46,8 +46,17 @@ class CreateCTRReaderOp : public framework::OperatorBase {
     int batch_size = Attr<int>("batch_size");
     std::vector<std::string> file_list =
         Attr<std::vector<std::string>>("file_list");
-    out->Reset(std::make_shared<CTRReader>(queue_holder->GetQueue(), batch_size,
-                                           thread_num, slots, file_list));
+    bool cache_samples = Attr<bool>("cache_samples");
+    std::string cache_dir = Attr<std::string>("cache_dir");
+    size_t cache_memory_limit =
+        static_cast<size_t>(Attr<int>("cache_memory_limit")) << 20;
+    std::vector<std::string> dense_slots =
+        Attr<std::vector<std::string>>("dense_slots");
+    std::vector<int> dense_slot_dims = Attr<std::vector<int>>("dense_slot_dims");
+    out->Reset(std::make_shared<CTRReader>(
+        queue_holder->GetQueue(), batch_size, thread_num, slots, file_list,
+        cache_samples, cache_dir, cache_memory_limit, dense_slots,
+        dense_slot_dims));
   }
 };
 
@@ -62,6 +71,26 @@ class CreateCTRReaderOpMaker : public FileReaderMakerBase {
                                       "The list of files that need to read");
     AddAttr<std::vector<std::string>>(
         "slots", "the slots that should be extract from file");
+    AddAttr<std::vector<std::string>>(
+        "dense_slots",
+        "the slots of float values that are read into the tensors of shape "
+        "[batch_size, dim] after the slots, the missing values are 0")
+        .SetDefault({});
+    AddAttr<std::vector<int>>("dense_slot_dims", "the dims of the dense slots")
+        .SetDefault({});
+    AddAttr<bool>("cache_samples",
+                  "cache the parsed batches of the first epoch, and read the "
+                  "later epochs from the cache instead of the files")
+        .SetDefault(false);
+    AddAttr<std::string>("cache_dir",
+                         "the directory of the cache files of the threads "
+                         "whose cache exceeds cache_memory_limit, the cache "
+                         "stays in memory if it is empty")
+        .SetDefault("");
+    AddAttr<int>("cache_memory_limit",
+                 "the MB of the cache of a thread kept in memory")
+        .SetDefault(1024)
+        .EqualGreaterThan(0);
 
     AddComment(R"DOC(
 			Create CTRReader to support read ctr data with cpp.
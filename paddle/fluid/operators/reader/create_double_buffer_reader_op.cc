@@ -47,8 +47,9 @@ class CreateDoubleBufferReaderOp : public framework::OperatorBase {
       place = platform::CUDAPlace(static_cast<int>(num));
     }
 
-    out->Reset(framework::MakeDecoratedReader<BufferedReader>(underlying_reader,
-                                                              place, 2));
+    size_t buffer_size = static_cast<size_t>(Attr<int>("buffer_size"));
+    out->Reset(framework::MakeDecoratedReader<BufferedReader>(
+        underlying_reader, place, buffer_size));
   }
 };
 
@@ -72,6 +73,12 @@ class CreateDoubleBufferReaderOpMaker : public DecoratedReaderMakerBase {
     AddAttr<std::string>("place", "The double buffer place")
         .SetDefault("AUTO")
         .InEnum({enum_range});
+    AddAttr<int>("buffer_size",
+                 "The number of the batches buffered, including the one being "
+                 "computed. With 3 buffers, the next batch is copied to the "
+                 "device while the one after it is read.")
+        .SetDefault(3)
+        .GreaterThan(1);
   }
 };
 
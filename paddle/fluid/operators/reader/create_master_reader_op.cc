@@ -0,0 +1,153 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <vector>
+#include "paddle/fluid/operators/reader/reader_op_registry.h"
+#include "paddle/fluid/platform/dynload/paddle_master.h"
+#include "paddle/fluid/recordio/piece_stream.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+// The reader of the records of the tasks dispatched by the Go master. The
+// client of the master fetches the tasks and buffers their records in the
+// background, so the records are read ahead of use, and a trainer asks for
+// a new task only when it has read the last one: the slow trainers train
+// less tasks instead of stalling the pass.
+class MasterReader : public framework::FileReader {
+ public:
+  MasterReader(const std::string& master_addr,
+               const std::string& etcd_endpoints, int etcd_timeout,
+               const std::vector<std::string>& filenames, int buf_size)
+      : dev_ctx_(*platform::DeviceContextPool::Instance().Get(
+            platform::CPUPlace())) {
+    if (!master_addr.empty()) {
+      client_ = platform::dynload::paddle_new_master_client(
+          const_cast<char*>(master_addr.c_str()), buf_size);
+    } else {
+      client_ = platform::dynload::paddle_new_etcd_master_client(
+          const_cast<char*>(etcd_endpoints.c_str()), etcd_timeout, buf_size);
+    }
+    std::vector<char*> paths;
+    for (auto& filename : filenames) {
+      paths.push_back(const_cast<char*>(filename.c_str()));
+    }
+    PADDLE_ENFORCE_EQ(
+        platform::dynload::paddle_set_dataset(client_, paths.data(),
+                                              static_cast<int>(paths.size())),
+        0, "Failed to set the dataset of the master.");
+    platform::dynload::paddle_start_get_records(client_, pass_);
+  }
+
+  ~MasterReader() { platform::dynload::paddle_release_master_client(client_); }
+
+ protected:
+  void ReadNextImpl(std::vector<framework::LoDTensor>* out) override {
+    unsigned char* record = nullptr;
+    int size = platform::dynload::paddle_next_record(client_, &record);
+    if (size == -2) {
+      // The pass ends.
+      out->clear();
+      return;
+    }
+    PADDLE_ENFORCE_GE(size, 0, "Failed to read the next record of the master.");
+    PADDLE_ENFORCE_GT(size, 0, "The record of the master is empty.");
+    recordio::PieceStream sin(
+        string::Piece(reinterpret_cast<const char*>(record), size));
+    uint32_t num_tensors;
+    sin.read(reinterpret_cast<char*>(&num_tensors), sizeof(uint32_t));
+    out->resize(num_tensors);
+    for (uint32_t i = 0; i < num_tensors; ++i) {
+      framework::DeserializeFromStream(sin, &(*out)[i], dev_ctx_);
+    }
+    platform::dynload::mem_free(record);
+  }
+
+  void StartImpl() override {
+    platform::dynload::paddle_start_get_records(client_, ++pass_);
+  }
+
+ private:
+  const platform::DeviceContext& dev_ctx_;
+  paddle_master_client client_;
+  int pass_{0};
+};
+
+class CreateMasterReaderOp : public framework::OperatorBase {
+ public:
+  using framework::OperatorBase::OperatorBase;
+
+ private:
+  void RunImpl(const framework::Scope& scope,
+               const platform::Place& dev_place) const override {
+    auto* out = scope.FindVar(Output("Out"))
+                    ->template GetMutable<framework::ReaderHolder>();
+    if (out->Get() != nullptr) {
+      return;
+    }
+    auto master_addr = Attr<std::string>("master_addr");
+    auto etcd_endpoints = Attr<std::string>("etcd_endpoints");
+    PADDLE_ENFORCE(!master_addr.empty() || !etcd_endpoints.empty(),
+                   "Either master_addr or etcd_endpoints should be set.");
+    out->Reset(std::make_shared<MasterReader>(
+        master_addr, etcd_endpoints, Attr<int>("etcd_timeout"),
+        Attr<std::vector<std::string>>("file_names"),
+        Attr<int>("buf_size")));
+  }
+};
+
+class CreateMasterReaderOpMaker : public FileReaderMakerBase {
+ protected:
+  void Apply() override {
+    AddAttr<std::vector<std::string>>(
+        "file_names",
+        "The glob patterns of the RecordIO files of the dataset, which are "
+        "split into the tasks by the master.");
+    AddAttr<std::string>("master_addr",
+                         "The address of the master, or empty if the master "
+                         "is found by etcd.")
+        .SetDefault("");
+    AddAttr<std::string>("etcd_endpoints",
+                         "The comma separated etcd endpoints to find the "
+                         "master when master_addr is empty.")
+        .SetDefault("");
+    AddAttr<int>("etcd_timeout", "The timeout in seconds to dial etcd.")
+        .SetDefault(5)
+        .GreaterThan(0);
+    AddAttr<int>("buf_size",
+                 "The number of the records read ahead from the tasks.")
+        .SetDefault(1024)
+        .GreaterThan(0);
+    AddComment(R"DOC(
+      CreateMasterReader Operator
+
+      Create a reader of the records of the RecordIO files, in the tasks
+      dispatched by the Go master. The trainers fetch the tasks from the
+      master one by one, and a task which is not finished in time is
+      dispatched to another trainer.
+    )DOC");
+  }
+};
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
+
+namespace reader = paddle::operators::reader;
+
+REGISTER_FILE_READER_OPERATOR(create_master_reader,
+                              reader::CreateMasterReaderOp,
+                              reader::CreateMasterReaderOpMaker);
@@ -13,42 +13,11 @@
 // limitations under the License.
 
 #include "paddle/fluid/operators/reader/reader_op_registry.h"
-#include "paddle/fluid/platform/lock_guard_ptr.h"
-#include "paddle/fluid/recordio/scanner.h"
+#include "paddle/fluid/operators/reader/recordio_file_reader.h"
 
 namespace paddle {
 namespace operators {
 namespace reader {
-template <bool ThreadSafe>
-class RecordIOFileReader : public framework::FileReader {
- public:
-  explicit RecordIOFileReader(const std::string& filename)
-      : scanner_(filename),
-        dev_ctx_(*platform::DeviceContextPool::Instance().Get(
-            platform::CPUPlace())) {
-    if (ThreadSafe) {
-      mutex_.reset(new std::mutex());
-    }
-    LOG(INFO) << "Creating file reader" << filename;
-  }
-
- protected:
-  void ReadNextImpl(std::vector<framework::LoDTensor>* out) override {
-    platform::LockGuardPtr<std::mutex> guard(mutex_);
-    bool ok = framework::ReadFromRecordIO(&scanner_, dev_ctx_, out);
-    if (!ok) {
-      out->clear();
-    }
-  }
-
-  void StartImpl() override { scanner_.Reset(); }
-
- private:
-  std::unique_ptr<std::mutex> mutex_;
-  recordio::Scanner scanner_;
-  const platform::DeviceContext& dev_ctx_;
-};
-
 class CreateRecordIOReaderOp : public framework::OperatorBase {
  public:
   using framework::OperatorBase::OperatorBase;
@@ -60,7 +29,11 @@ class CreateRecordIOReaderOp : public framework::OperatorBase {
     auto* out = scope.FindVar(Output("Out"))
                     ->template GetMutable<framework::ReaderHolder>();
 
-    out->Reset(std::make_shared<RecordIOFileReader<true>>(filename));
+    int num_threads = Attr<int>("num_threads");
+    int lookahead = Attr<int>("lookahead");
+    bool ordered = Attr<bool>("ordered");
+    out->Reset(std::make_shared<RecordIOFileReader<true>>(
+        filename, num_threads, static_cast<size_t>(lookahead), ordered));
   }
 };
 
@@ -70,6 +43,22 @@ class CreateRecordIOReaderOpMaker : public FileReaderMakerBase {
     AddAttr<std::string>(
         "filename",
         "The filename of record file. This file will given to reader.");
+    AddAttr<int>("num_threads",
+                 "The number of threads to decompress and parse the chunks "
+                 "of the file. 0 means the chunks are parsed by the thread "
+                 "reading the records.")
+        .SetDefault(0)
+        .EqualGreaterThan(0);
+    AddAttr<int>("lookahead",
+                 "The max number of chunks read ahead when num_threads > 0. "
+                 "0 means 2 * num_threads.")
+        .SetDefault(0)
+        .EqualGreaterThan(0);
+    AddAttr<bool>("ordered",
+                  "Whether the records are read in the order of the file "
+                  "when num_threads > 0. If false, the chunk parsed first is "
+                  "read first.")
+        .SetDefault(true);
     AddComment(R"DOC(
 Open a recordio file and return the reader object. The returned reader object
 is thread-safe.
@@ -0,0 +1,73 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/detail/safe_ref.h"
+#include "paddle/fluid/operators/reader/reader_op_registry.h"
+#include "paddle/fluid/operators/reader/work_stealing_reader.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+class CreateWorkStealingReaderOp : public framework::OperatorBase {
+ public:
+  using framework::OperatorBase::OperatorBase;
+
+ private:
+  void RunImpl(const framework::Scope& scope,
+               const platform::Place& dev_place) const override {
+    auto* out = detail::Ref(scope.FindVar(Output("Out")))
+                    .GetMutable<framework::ReaderHolder>();
+    if (out->Get() != nullptr) {
+      return;
+    }
+    const auto& underlying_reader = scope.FindVar(Input("UnderlyingReader"))
+                                        ->Get<framework::ReaderHolder>();
+    out->Reset(framework::MakeDecoratedReader<WorkStealingReader>(
+        underlying_reader, static_cast<size_t>(Attr<int>("place_num")),
+        static_cast<size_t>(Attr<int>("buffer_size"))));
+  }
+};
+
+class CreateWorkStealingReaderOpMaker : public DecoratedReaderMakerBase {
+ protected:
+  void Apply() override {
+    AddAttr<int>("place_num",
+                 "The number of the places of ParallelExecutor which read "
+                 "the reader.")
+        .GreaterThan(0);
+    AddAttr<int>("buffer_size",
+                 "The number of the batches prefetched for each place.")
+        .SetDefault(2)
+        .GreaterThan(0);
+    AddComment(R"DOC(
+      CreateWorkStealingReader Operator
+
+      A work stealing reader takes another reader as its 'underlying reader',
+      and prefetches its outputs into a queue per place of ParallelExecutor.
+      Each place reads the batches of its own queue, and steals whole batches
+      from the queues of the other places when its own one is empty, so the
+      places never wait for each other to balance the data.
+    )DOC");
+  }
+};
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators::reader;
+REGISTER_DECORATED_READER_OPERATOR(create_work_stealing_reader,
+                                   ops::CreateWorkStealingReaderOp,
+                                   ops::CreateWorkStealingReaderOpMaker);
@@ -14,9 +14,14 @@
 
 #include "paddle/fluid/operators/reader/ctr_reader.h"
 
+#include <fcntl.h>
 #include <gzstream.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
+#include <cerrno>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -26,52 +31,179 @@
 #include <algorithm>
 #include <random>
 
+#include "paddle/fluid/framework/data_type.h"
+
 namespace paddle {
 namespace operators {
 namespace reader {
 
-static inline void string_split(const std::string& s, const char delimiter,
-                                std::vector<std::string>* output) {
-  size_t start = 0;
-  size_t end = s.find_first_of(delimiter);
+// Build a batch in the columnar layout. The feasigns of each sparse slot and
+// the values of each dense slot are appended to the memory of their tensors
+// directly, which is reserved as large as the largest batch so far, and the
+// LoD of the sparse slots is built along with the instances.
+class BatchBuilder {
+ public:
+  BatchBuilder(const std::vector<std::string>& slots,
+               const std::vector<std::string>& dense_slots,
+               const std::vector<int>& dense_slot_dims, int batch_size)
+      : batch_size_(batch_size),
+        sparse_(slots.size()),
+        dense_(dense_slots.size()) {
+    PADDLE_ENFORCE_GT(batch_size, 0, "batch size should be positive.");
+    PADDLE_ENFORCE_EQ(dense_slots.size(), dense_slot_dims.size(),
+                      "Each dense slot should have a dim.");
+    for (size_t i = 0; i < slots.size(); ++i) {
+      slot_to_column_[slots[i]] = {false, i};
+      sparse_[i].capacity = batch_size;
+    }
+    for (size_t i = 0; i < dense_slots.size(); ++i) {
+      PADDLE_ENFORCE_GT(dense_slot_dims[i], 0,
+                        "The dim of dense slot %s should be positive.",
+                        dense_slots[i]);
+      slot_to_column_[dense_slots[i]] = {true, i};
+      dense_[i].dim = dense_slot_dims[i];
+    }
+  }
 
-  while (end <= std::string::npos) {
-    output->emplace_back(s.substr(start, end - start));
-    if (end == std::string::npos) {
-      break;
+  // Start a new batch in new tensors, since the tensors of the last batch are
+  // shared with the queue.
+  void Reset() {
+    size_ = 0;
+    label_tensor_ = framework::LoDTensor();
+    labels_ = label_tensor_.mutable_data<int64_t>(
+        framework::make_ddim({1, batch_size_}), platform::CPUPlace());
+    for (auto& column : sparse_) {
+      column.tensor = framework::LoDTensor();
+      column.data = column.tensor.mutable_data<int64_t>(
+          framework::make_ddim({1, static_cast<int64_t>(column.capacity)}),
+          platform::CPUPlace());
+      column.size = 0;
+      column.lod.clear();
+      column.lod.reserve(batch_size_ + 1);
+      column.lod.push_back(0);
+    }
+    for (auto& column : dense_) {
+      column.tensor = framework::LoDTensor();
+      column.data = column.tensor.mutable_data<float>(
+          framework::make_ddim({batch_size_, column.dim}),
+          platform::CPUPlace());
     }
-    start = end + 1;
-    end = s.find_first_of(delimiter, start);
   }
-}
 
-static inline void parse_line(
-    const std::string& line,
-    const std::unordered_map<std::string, size_t>& slot_to_index,
-    int64_t* label,
-    std::unordered_map<std::string, std::vector<int64_t>>* slot_to_data) {
-  std::vector<std::string> ret;
-  string_split(line, ' ', &ret);
-  *label = std::stoi(ret[2]) > 0;
+  // Parse a line of "show click label feasign:slot ...", where the feasigns
+  // of the dense slots are their float values.
+  void AddInstance(const std::string& line) {
+    for (auto& column : dense_) {
+      float* row = column.data + size_ * column.dim;
+      std::fill(row, row + column.dim, 0.0f);
+      column.filled = 0;
+    }
+    labels_[size_] = 0;
+    size_t start = 0;
+    for (size_t i = 0; start <= line.size(); ++i) {
+      size_t end = line.find(' ', start);
+      if (end == std::string::npos) end = line.size();
+      if (i == 2) {
+        labels_[size_] = std::strtol(line.c_str() + start, nullptr, 10) > 0;
+      } else if (i > 2) {
+        AddFeasign(line, start, end);
+      }
+      start = end + 1;
+    }
 
-  for (size_t i = 3; i < ret.size(); ++i) {
-    const std::string& item = ret[i];
-    std::vector<std::string> feasign_and_slot;
-    string_split(item, ':', &feasign_and_slot);
-    if (feasign_and_slot.size() == 2 &&
-        slot_to_index.find(feasign_and_slot[1]) != slot_to_index.end()) {
-      int64_t feasign = std::strtoll(feasign_and_slot[0].c_str(), NULL, 10);
-      (*slot_to_data)[feasign_and_slot[1]].push_back(feasign);
+    // NOTE:: if the slot has no value, then fill [0] as it's data.
+    for (auto& column : sparse_) {
+      if (column.size == column.lod.back()) {
+        Append(&column, 0);
+      }
+      column.lod.push_back(column.size);
     }
+    ++size_;
   }
 
-  // NOTE:: if the slot has no value, then fill [0] as it's data.
-  for (auto& item : slot_to_index) {
-    if (slot_to_data->find(item.first) == slot_to_data->end()) {
-      (*slot_to_data)[item.first].push_back(0);
+  int Size() const { return size_; }
+
+  // The tensors of the sparse slots, the dense slots and the label.
+  void Finish(std::vector<framework::LoDTensor>* batch) {
+    batch->clear();
+    batch->reserve(sparse_.size() + dense_.size() + 1);
+    for (auto& column : sparse_) {
+      column.tensor.Resize(
+          framework::make_ddim({1, static_cast<int64_t>(column.size)}));
+      column.tensor.set_lod({column.lod});
+      batch->push_back(column.tensor);
+    }
+    for (auto& column : dense_) {
+      column.tensor.Resize(framework::make_ddim({size_, column.dim}));
+      batch->push_back(column.tensor);
     }
+    label_tensor_.Resize(framework::make_ddim({1, size_}));
+    batch->push_back(label_tensor_);
   }
-}
+
+ private:
+  struct SparseColumn {
+    framework::LoDTensor tensor;
+    int64_t* data;
+    size_t size;
+    size_t capacity;
+    std::vector<size_t> lod;
+  };
+
+  struct DenseColumn {
+    framework::LoDTensor tensor;
+    float* data;
+    int dim;
+    int filled;
+  };
+
+  struct Column {
+    bool dense;
+    size_t index;
+  };
+
+  void AddFeasign(const std::string& line, size_t start, size_t end) {
+    size_t colon = line.find(':', start);
+    if (colon >= end || line.find(':', colon + 1) < end) return;
+    slot_.assign(line, colon + 1, end - colon - 1);
+    auto it = slot_to_column_.find(slot_);
+    if (it == slot_to_column_.end()) return;
+    const char* value = line.c_str() + start;
+    if (it->second.dense) {
+      auto& column = dense_[it->second.index];
+      PADDLE_ENFORCE_LT(column.filled, column.dim,
+                        "Dense slot %s has more values than its dim.", slot_);
+      column.data[size_ * column.dim + column.filled++] =
+          std::strtof(value, nullptr);
+    } else {
+      Append(&sparse_[it->second.index], std::strtoll(value, nullptr, 10));
+    }
+  }
+
+  static void Append(SparseColumn* column, int64_t feasign) {
+    if (column->size == column->capacity) {
+      column->capacity *= 2;
+      framework::LoDTensor tensor;
+      int64_t* data = tensor.mutable_data<int64_t>(
+          framework::make_ddim({1, static_cast<int64_t>(column->capacity)}),
+          platform::CPUPlace());
+      memcpy(data, column->data, column->size * sizeof(int64_t));
+      column->tensor = tensor;
+      column->data = data;
+    }
+    column->data[column->size++] = feasign;
+  }
+
+  const int batch_size_;
+  std::unordered_map<std::string, Column> slot_to_column_;
+  std::vector<SparseColumn> sparse_;
+  std::vector<DenseColumn> dense_;
+  framework::LoDTensor label_tensor_;
+  int64_t* labels_;
+  int size_ = 0;
+  // The slot being parsed, which is reused to not allocate for each feasign.
+  std::string slot_;
+};
 
 class Reader {
  public:
@@ -123,6 +255,123 @@ class MultiGzipReader : public Reader {
   size_t current_reader_index_ = 0;
 };
 
+SampleCache::~SampleCache() {
+  if (mapped_ != nullptr) {
+    munmap(mapped_, size_);
+  }
+}
+
+void SampleCache::Append(const std::vector<framework::LoDTensor>& batch) {
+  PADDLE_ENFORCE(!ready_, "The cache is read only after Finish.");
+  size_t begin = buffer_.size();
+  buffer_.push_back(static_cast<int64_t>(batch.size()));
+  for (auto& tensor : batch) {
+    auto type = tensor.type();
+    PADDLE_ENFORCE(type == framework::proto::VarType::INT64 ||
+                       type == framework::proto::VarType::FP32,
+                   "Only the int64 and float tensors can be cached.");
+    buffer_.push_back(static_cast<int64_t>(type));
+    auto& dims = tensor.dims();
+    buffer_.push_back(dims.size());
+    for (int i = 0; i < dims.size(); ++i) {
+      buffer_.push_back(dims[i]);
+    }
+    auto& lod = tensor.lod();
+    buffer_.push_back(static_cast<int64_t>(lod.size()));
+    for (auto& level : lod) {
+      buffer_.push_back(static_cast<int64_t>(level.size()));
+      buffer_.insert(buffer_.end(), level.begin(), level.end());
+    }
+    // The data is padded to the words of the cache.
+    size_t bytes = tensor.numel() * framework::SizeOfType(type);
+    size_t offset = buffer_.size();
+    buffer_.resize(offset + (bytes + sizeof(int64_t) - 1) / sizeof(int64_t));
+    memcpy(buffer_.data() + offset, tensor.data<void>(), bytes);
+  }
+  size_ += (buffer_.size() - begin) * sizeof(int64_t);
+
+  if (spill_ == nullptr && size_ > memory_limit_ && !file_path_.empty()) {
+    Spill();
+  } else if (spill_ != nullptr) {
+    spill_->write(reinterpret_cast<const char*>(buffer_.data()),
+                  buffer_.size() * sizeof(int64_t));
+    PADDLE_ENFORCE(spill_->good(), "Writing the cache %s failed.", file_path_);
+    buffer_.clear();
+  }
+}
+
+void SampleCache::Spill() {
+  VLOG(3) << "spill the sample cache to " << file_path_;
+  spill_.reset(new std::ofstream(file_path_.c_str(), std::ios::binary));
+  PADDLE_ENFORCE(spill_->good(), "Opening the cache %s failed.", file_path_);
+  spill_->write(reinterpret_cast<const char*>(buffer_.data()),
+                buffer_.size() * sizeof(int64_t));
+  PADDLE_ENFORCE(spill_->good(), "Writing the cache %s failed.", file_path_);
+  std::vector<int64_t>().swap(buffer_);
+}
+
+void SampleCache::Finish() {
+  if (ready_) return;
+  if (spill_ != nullptr) {
+    spill_->close();
+    PADDLE_ENFORCE(spill_->good(), "Closing the cache %s failed.", file_path_);
+    spill_.reset();
+    int fd = open(file_path_.c_str(), O_RDONLY);
+    PADDLE_ENFORCE_GE(fd, 0, "Opening the cache %s failed.", file_path_);
+    mapped_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    PADDLE_ENFORCE(mapped_ != MAP_FAILED, "Mapping the cache %s failed: %s",
+                   file_path_, std::strerror(errno));
+    // The mapping stays valid after the file is unlinked, so that no cache
+    // file is left behind.
+    unlink(file_path_.c_str());
+    data_ = static_cast<const int64_t*>(mapped_);
+  } else {
+    buffer_.shrink_to_fit();
+    data_ = buffer_.data();
+  }
+  ready_ = true;
+}
+
+bool SampleCache::Read(size_t* pos,
+                       std::vector<framework::LoDTensor>* batch) const {
+  PADDLE_ENFORCE(ready_, "The cache can not be read before Finish.");
+  if (*pos >= size_ / sizeof(int64_t)) {
+    return false;
+  }
+  const int64_t* data = data_ + *pos;
+  batch->resize(static_cast<size_t>(*data++));
+  for (auto& tensor : *batch) {
+    auto type = static_cast<framework::proto::VarType::Type>(*data++);
+    std::vector<int64_t> dims(static_cast<size_t>(*data++));
+    for (auto& dim : dims) {
+      dim = *data++;
+    }
+    framework::LoD lod(static_cast<size_t>(*data++));
+    for (auto& level : lod) {
+      size_t level_size = static_cast<size_t>(*data++);
+      level.reserve(level_size);
+      for (size_t i = 0; i < level_size; ++i) {
+        level.push_back(static_cast<size_t>(*data++));
+      }
+    }
+    tensor.set_lod(lod);
+    tensor.Resize(framework::make_ddim(dims));
+    void* tensor_data = tensor.mutable_data(platform::CPUPlace(), type);
+    size_t bytes = tensor.numel() * framework::SizeOfType(type);
+    memcpy(tensor_data, data, bytes);
+    data += (bytes + sizeof(int64_t) - 1) / sizeof(int64_t);
+  }
+  *pos = data - data_;
+  return true;
+}
+
+static framework::ReaderMonitor* CTRReaderMonitor() {
+  static framework::ReaderMonitor* monitor =
+      framework::GetReaderMonitor("ctr_reader");
+  return monitor;
+}
+
 void MonitorThread(std::vector<ReaderThreadStatus>* thread_status,
                    std::shared_ptr<LoDTensorBlockingQueue> queue) {
   VLOG(30) << "monitor thread in";
@@ -136,6 +385,7 @@ void MonitorThread(std::vector<ReaderThreadStatus>* thread_status,
         reader_thread_is_running = true;
       }
     }
+    CTRReaderMonitor()->RecordQueueSize(queue->Size(), queue->Cap());
     std::this_thread::sleep_for(std::chrono::milliseconds(1000));
   }
   VLOG(30) << "all reader thread is stopped, push empty data into queue";
@@ -144,9 +394,12 @@ void MonitorThread(std::vector<ReaderThreadStatus>* thread_status,
 }
 
 void ReadThread(const std::vector<std::string>& file_list,
-                const std::vector<std::string>& slots, int batch_size,
+                const std::vector<std::string>& slots,
+                const std::vector<std::string>& dense_slots,
+                const std::vector<int>& dense_slot_dims, int batch_size,
                 int thread_id, std::vector<ReaderThreadStatus>* thread_status,
-                std::shared_ptr<LoDTensorBlockingQueue> queue) {
+                std::shared_ptr<LoDTensorBlockingQueue> queue,
+                SampleCache* cache) {
   VLOG(30) << "[" << thread_id << "]"
            << " reader thread start! thread_id = " << thread_id;
   for (auto& file : file_list) {
@@ -156,78 +409,55 @@ void ReadThread(const std::vector<std::string>& file_list,
   (*thread_status)[thread_id] = Running;
   VLOG(30) << "set status to running";
 
-  std::unordered_map<std::string, size_t> slot_to_index;
-  for (size_t i = 0; i < slots.size(); ++i) {
-    slot_to_index[slots[i]] = i;
+  if (cache != nullptr && cache->Ready()) {
+    VLOG(30) << "[" << thread_id << "]"
+             << " read " << cache->Bytes() << " bytes of the sample cache";
+    size_t pos = 0;
+    while (true) {
+      framework::ReaderTimer parse_timer(CTRReaderMonitor(),
+                                         framework::ReaderMonitor::kParse);
+      // The tensors of a batch are shared with the queue, so each batch is
+      // read into new ones.
+      std::vector<framework::LoDTensor> lod_datas;
+      if (!cache->Read(&pos, &lod_datas)) break;
+      parse_timer.Stop();
+      queue->Push(std::move(lod_datas));
+    }
+    (*thread_status)[thread_id] = Stopped;
+    VLOG(30) << "set status to stopped, thread " << thread_id << " exited";
+    return;
   }
 
+  BatchBuilder builder(slots, dense_slots, dense_slot_dims, batch_size);
   std::string line;
 
-  std::vector<std::unordered_map<std::string, std::vector<int64_t>>> batch_data;
-  std::vector<int64_t> batch_label;
-
   MultiGzipReader reader(file_list);
 
   VLOG(30) << "reader inited";
 
   while (reader.HasNext()) {
-    batch_data.clear();
-    batch_data.reserve(batch_size);
-
-    batch_label.clear();
-    batch_label.reserve(batch_size);
-
+    framework::ReaderTimer parse_timer(CTRReaderMonitor(),
+                                       framework::ReaderMonitor::kParse);
+    builder.Reset();
     // read batch_size data
-    for (int i = 0; i < batch_size; ++i) {
-      if (reader.HasNext()) {
-        reader.NextLine(&line);
-        std::unordered_map<std::string, std::vector<int64_t>> slot_to_data;
-        int64_t label;
-        parse_line(line, slot_to_index, &label, &slot_to_data);
-        batch_data.push_back(slot_to_data);
-        batch_label.push_back(label);
-      } else {
-        break;
-      }
+    while (builder.Size() < batch_size && reader.HasNext()) {
+      reader.NextLine(&line);
+      builder.AddInstance(line);
     }
 
     std::vector<framework::LoDTensor> lod_datas;
+    builder.Finish(&lod_datas);
 
-    // first insert tensor for each slots
-    for (auto& slot : slots) {
-      std::vector<size_t> lod_data{0};
-      std::vector<int64_t> batch_feasign;
-
-      for (size_t i = 0; i < batch_data.size(); ++i) {
-        auto& feasign = batch_data[i][slot];
-        lod_data.push_back(lod_data.back() + feasign.size());
-        batch_feasign.insert(batch_feasign.end(), feasign.begin(),
-                             feasign.end());
-      }
-
-      framework::LoDTensor lod_tensor;
-      framework::LoD lod{lod_data};
-      lod_tensor.set_lod(lod);
-      int64_t* tensor_data = lod_tensor.mutable_data<int64_t>(
-          framework::make_ddim({1, static_cast<int64_t>(batch_feasign.size())}),
-          platform::CPUPlace());
-      memcpy(tensor_data, batch_feasign.data(),
-             batch_feasign.size() * sizeof(int64_t));
-      lod_datas.push_back(lod_tensor);
+    if (cache != nullptr) {
+      cache->Append(lod_datas);
     }
-
-    // insert label tensor
-    framework::LoDTensor label_tensor;
-    auto* label_tensor_data = label_tensor.mutable_data<int64_t>(
-        framework::make_ddim({1, static_cast<int64_t>(batch_label.size())}),
-        platform::CPUPlace());
-    memcpy(label_tensor_data, batch_label.data(),
-           batch_label.size() * sizeof(int64_t));
-    lod_datas.push_back(label_tensor);
-
+    parse_timer.Stop();
     queue->Push(lod_datas);
     VLOG(40) << "push one data, queue_size=" << queue->Size();
   }
+  if (cache != nullptr) {
+    cache->Finish();
+  }
 
   (*thread_status)[thread_id] = Stopped;
   VLOG(30) << "set status to stopped, thread " << thread_id << " exited";
@@ -15,15 +15,19 @@
 #pragma once
 
 #include <sys/time.h>
+#include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "paddle/fluid/framework/reader.h"
@@ -36,10 +40,57 @@ namespace reader {
 
 enum ReaderThreadStatus { Running, Stopped };
 
+// The batches parsed by a reader thread in the first epoch, which are replayed
+// in the later ones instead of reopening and parsing the gzip files again.
+// A batch is stored as the LoD and the data of its int64 or float tensors one
+// by one. The
+// cache stays in memory until it is larger than memory_limit bytes, and then
+// spills to file_path, which is mapped into memory when the epoch ends. The
+// cache without file_path always stays in memory.
+class SampleCache {
+ public:
+  SampleCache(const std::string& file_path, size_t memory_limit)
+      : file_path_(file_path), memory_limit_(memory_limit) {}
+
+  ~SampleCache();
+
+  // Append a batch of the first epoch.
+  void Append(const std::vector<framework::LoDTensor>& batch);
+
+  // End the first epoch. The cache is read only after that.
+  void Finish();
+
+  bool Ready() const { return ready_; }
+
+  // Read the batch at *pos, and move *pos to the next one. Return false at
+  // the end of the cache.
+  bool Read(size_t* pos, std::vector<framework::LoDTensor>* batch) const;
+
+  size_t Bytes() const { return size_; }
+
+  bool Spilled() const { return spill_ != nullptr || mapped_ != nullptr; }
+
+ private:
+  void Spill();
+
+  const std::string file_path_;
+  const size_t memory_limit_;
+  std::vector<int64_t> buffer_;
+  std::unique_ptr<std::ofstream> spill_;
+  void* mapped_ = nullptr;
+  // The bytes of the cache.
+  size_t size_ = 0;
+  const int64_t* data_ = nullptr;
+  bool ready_ = false;
+};
+
 void ReadThread(const std::vector<std::string>& file_list,
-                const std::vector<std::string>& slots, int batch_size,
+                const std::vector<std::string>& slots,
+                const std::vector<std::string>& dense_slots,
+                const std::vector<int>& dense_slot_dims, int batch_size,
                 int thread_id, std::vector<ReaderThreadStatus>* thread_status,
-                std::shared_ptr<LoDTensorBlockingQueue> queue);
+                std::shared_ptr<LoDTensorBlockingQueue> queue,
+                SampleCache* cache = nullptr);
 
 // monitor all running thread, if they are all stopped,
 // then push an empty data into LoDTensorBlockingQueue
@@ -51,17 +102,41 @@ class CTRReader : public framework::FileReader {
   explicit CTRReader(const std::shared_ptr<LoDTensorBlockingQueue>& queue,
                      int batch_size, size_t thread_num,
                      const std::vector<std::string>& slots,
-                     const std::vector<std::string>& file_list)
-      : batch_size_(batch_size), slots_(slots), file_list_(file_list) {
+                     const std::vector<std::string>& file_list,
+                     bool cache_samples = false,
+                     const std::string& cache_dir = "",
+                     size_t cache_memory_limit = 0,
+                     const std::vector<std::string>& dense_slots = {},
+                     const std::vector<int>& dense_slot_dims = {})
+      : batch_size_(batch_size),
+        slots_(slots),
+        dense_slots_(dense_slots),
+        dense_slot_dims_(dense_slot_dims),
+        file_list_(file_list) {
     PADDLE_ENFORCE_GT(thread_num, 0, "thread num should be larger then 0!");
     PADDLE_ENFORCE(queue != nullptr, "LoDTensorBlockingQueue must not be null");
     PADDLE_ENFORCE_GT(file_list.size(), 0, "file list should not be empty");
+    PADDLE_ENFORCE_EQ(dense_slots.size(), dense_slot_dims.size(),
+                      "each dense slot should have a dim");
     thread_num_ = std::min<size_t>(file_list_.size(), thread_num);
     queue_ = queue;
     SplitFiles();
     for (size_t i = 0; i < thread_num_; ++i) {
       read_thread_status_.push_back(Stopped);
     }
+    if (cache_samples) {
+      static std::atomic<int> reader_id(0);
+      std::string prefix;
+      if (!cache_dir.empty()) {
+        prefix = cache_dir + "/ctr_reader_cache_" + std::to_string(getpid()) +
+                 "_" + std::to_string(reader_id++) + "_";
+      }
+      for (size_t i = 0; i < thread_num_; ++i) {
+        caches_.emplace_back(new SampleCache(
+            prefix.empty() ? "" : prefix + std::to_string(i),
+            cache_memory_limit));
+      }
+    }
   }
 
   ~CTRReader() {}
@@ -97,8 +172,10 @@ class CTRReader : public framework::FileReader {
     VLOG(3) << "thread_num " << thread_num_;
     for (size_t thread_id = 0; thread_id < thread_num_; thread_id++) {
       read_threads_.emplace_back(new std::thread(std::bind(
-          &ReadThread, file_groups_[thread_id], slots_, batch_size_,
-          static_cast<int>(thread_id), &read_thread_status_, queue_)));
+          &ReadThread, file_groups_[thread_id], slots_, dense_slots_,
+          dense_slot_dims_, batch_size_,
+          static_cast<int>(thread_id), &read_thread_status_, queue_,
+          caches_.empty() ? nullptr : caches_[thread_id].get())));
     }
     monitor_thread_.reset(new std::thread(
         std::bind(&MonitorThread, &read_thread_status_, queue_)));
@@ -106,13 +183,28 @@ class CTRReader : public framework::FileReader {
   }
 
  private:
+  // Assign the largest files first, each to the thread with the fewest bytes
+  // so far, so that the threads finish the epoch at about the same time.
   void SplitFiles() {
     file_groups_.resize(thread_num_);
+    std::vector<std::pair<int64_t, size_t>> file_sizes;
     for (size_t i = 0; i < file_list_.size(); ++i) {
       auto& file_name = file_list_[i];
-      std::ifstream f(file_name.c_str());
+      std::ifstream f(file_name.c_str(), std::ios::binary | std::ios::ate);
       PADDLE_ENFORCE(f.good(), "file %s not exist!", file_name);
-      file_groups_[i % thread_num_].push_back(file_name);
+      file_sizes.emplace_back(static_cast<int64_t>(f.tellg()), i);
+    }
+    std::stable_sort(file_sizes.begin(), file_sizes.end(),
+                     [](const std::pair<int64_t, size_t>& a,
+                        const std::pair<int64_t, size_t>& b) {
+                       return a.first > b.first;
+                     });
+    std::vector<int64_t> group_sizes(thread_num_, 0);
+    for (auto& file_size : file_sizes) {
+      size_t group = std::min_element(group_sizes.begin(), group_sizes.end()) -
+                     group_sizes.begin();
+      group_sizes[group] += file_size.first;
+      file_groups_[group].push_back(file_list_[file_size.second]);
     }
   }
 
@@ -120,12 +212,15 @@ class CTRReader : public framework::FileReader {
   size_t thread_num_;
   const int batch_size_;
   const std::vector<std::string> slots_;
+  const std::vector<std::string> dense_slots_;
+  const std::vector<int> dense_slot_dims_;
   const std::vector<std::string> file_list_;
   std::shared_ptr<LoDTensorBlockingQueue> queue_;
   std::vector<std::unique_ptr<std::thread>> read_threads_;
   std::unique_ptr<std::thread> monitor_thread_;
   std::vector<ReaderThreadStatus> read_thread_status_;
   std::vector<std::vector<std::string>> file_groups_;
+  std::vector<std::unique_ptr<SampleCache>> caches_;
 };
 
 }  // namespace reader
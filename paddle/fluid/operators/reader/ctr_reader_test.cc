@@ -88,7 +88,8 @@ static inline void check_all_data(
   ASSERT_EQ(queue->Size(), 0);
 }
 
-TEST(CTR_READER, read_data) {
+static void check_reader(bool cache_samples, const std::string& cache_dir,
+                         size_t cache_memory_limit) {
   const std::vector<std::string> ctr_data = {
       "aaaa 1 0 0:6002 1:6003 2:6004 3:6005 4:6006 -1\n",
       "bbbb 1 0 5:6003 6:6003 7:6003 8:6004 9:6004 -1\n",
@@ -138,7 +139,8 @@ TEST(CTR_READER, read_data) {
     file_list.push_back(gz_file_name);
   }
 
-  CTRReader reader(queue, batch_size, thread_num, slots, file_list);
+  CTRReader reader(queue, batch_size, thread_num, slots, file_list,
+                   cache_samples, cache_dir, cache_memory_limit);
 
   reader.Start();
   size_t batch_num =
@@ -152,4 +154,105 @@ TEST(CTR_READER, read_data) {
   check_all_data(ctr_data, slots, label_dims, label_value, data_slot_6002,
                  data_slot_6003, batch_num, batch_size, queue, &reader);
   reader.Shutdown();
+
+  // The batches are read from the cache from the second epoch, even if the
+  // file is removed.
+  if (cache_samples) {
+    remove(gz_file_name.c_str());
+    reader.Start();
+    check_all_data(ctr_data, slots, label_dims, label_value, data_slot_6002,
+                   data_slot_6003, batch_num, batch_size, queue, &reader);
+    reader.Shutdown();
+  }
+}
+
+TEST(CTR_READER, read_data) { check_reader(false, "", 0); }
+
+TEST(CTR_READER, read_data_from_memory_cache) {
+  check_reader(true, "", 0);
+}
+
+TEST(CTR_READER, read_data_from_file_cache) { check_reader(true, ".", 0); }
+
+TEST(CTR_READER, sample_cache) {
+  using paddle::operators::reader::SampleCache;
+  std::string file_name = "test_ctr_reader_sample_cache";
+  SampleCache cache(file_name, 16);
+
+  std::vector<LoDTensor> batch(2);
+  for (int64_t n = 1; n <= 4; ++n) {
+    int64_t* data =
+        batch[0].mutable_data<int64_t>(make_ddim({1, n}), CPUPlace());
+    for (int64_t i = 0; i < n; ++i) {
+      data[i] = n * 10 + i;
+    }
+    batch[0].set_lod({{0, 0, static_cast<size_t>(n)}});
+    *batch[1].mutable_data<int64_t>(make_ddim({1}), CPUPlace()) = -n;
+    cache.Append(batch);
+  }
+  ASSERT_TRUE(cache.Spilled());
+  cache.Finish();
+  ASSERT_TRUE(cache.Ready());
+  ASSERT_FALSE(std::ifstream(file_name.c_str()).good());
+
+  size_t pos = 0;
+  for (int64_t n = 1; n <= 4; ++n) {
+    ASSERT_TRUE(cache.Read(&pos, &batch));
+    ASSERT_EQ(batch.size(), 2UL);
+    ASSERT_EQ(batch[0].dims(), make_ddim({1, n}));
+    ASSERT_EQ(batch[0].lod(), LoD({{0, 0, static_cast<size_t>(n)}}));
+    for (int64_t i = 0; i < n; ++i) {
+      ASSERT_EQ(batch[0].data<int64_t>()[i], n * 10 + i);
+    }
+    ASSERT_EQ(batch[1].dims(), make_ddim({1}));
+    ASSERT_EQ(*batch[1].data<int64_t>(), -n);
+  }
+  ASSERT_FALSE(cache.Read(&pos, &batch));
+}
+
+TEST(CTR_READER, read_dense_slots) {
+  const std::vector<std::string> ctr_data = {
+      "aaaa 1 0 0:6002 1:6003 2:6004 3.5:6005 4:6006 -1\n",
+      "bbbb 1 1 5:6003 6:6003 7:6003 8:6004 9:6004 -1\n",
+      "cccc 1 0 10:6002 11:6005 12:6005 13:6002 14:6002 -2\n",
+      "dddd 1 1 15:6003 16:6003 17:6003 18:6003 19:6004 -3\n",
+  };
+  std::string gz_file_name = "test_ctr_reader_dense_data.gz";
+  generatedata(ctr_data, gz_file_name);
+
+  LoDTensorBlockingQueueHolder queue_holder;
+  queue_holder.InitOnce(64, {}, false);
+  std::shared_ptr<LoDTensorBlockingQueue> queue = queue_holder.GetQueue();
+
+  CTRReader reader(queue, 3, 1, {"6002"}, {gz_file_name}, false, "", 0,
+                   {"6005"}, {2});
+  reader.Start();
+
+  std::vector<LoDTensor> out;
+  reader.ReadNext(&out);
+  ASSERT_EQ(out.size(), 3UL);
+  ASSERT_EQ(out[0].lod(), LoD({{0, 1, 2, 5}}));
+  std::vector<int64_t> sparse = {0, 0, 10, 13, 14};
+  ASSERT_EQ(out[0].dims(), make_ddim({1, 5}));
+  ASSERT_EQ(std::memcmp(sparse.data(), out[0].data<int64_t>(),
+                        sparse.size() * sizeof(int64_t)),
+            0);
+  ASSERT_EQ(out[1].dims(), make_ddim({3, 2}));
+  std::vector<float> dense = {3.5, 0, 0, 0, 11, 12};
+  for (size_t i = 0; i < dense.size(); ++i) {
+    ASSERT_EQ(out[1].data<float>()[i], dense[i]);
+  }
+  ASSERT_EQ(out[2].dims(), make_ddim({1, 3}));
+  ASSERT_EQ(out[2].data<int64_t>()[1], 1);
+
+  reader.ReadNext(&out);
+  ASSERT_EQ(out.size(), 3UL);
+  ASSERT_EQ(out[0].lod(), LoD({{0, 1}}));
+  ASSERT_EQ(out[1].dims(), make_ddim({1, 2}));
+  ASSERT_EQ(out[1].data<float>()[0], 0);
+  ASSERT_EQ(out[2].data<int64_t>()[0], 1);
+
+  reader.ReadNext(&out);
+  ASSERT_EQ(out.size(), 0UL);
+  reader.Shutdown();
 }
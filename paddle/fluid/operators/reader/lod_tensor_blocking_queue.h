@@ -19,7 +19,8 @@
 
 #include "paddle/fluid/framework/ddim.h"
 #include "paddle/fluid/framework/lod_tensor.h"
-#include "paddle/fluid/operators/reader/blocking_queue.h"
+#include "paddle/fluid/framework/reader_stats.h"
+#include "paddle/fluid/operators/reader/ring_blocking_queue.h"
 #include "paddle/fluid/platform/place.h"
 
 namespace paddle {
@@ -35,20 +36,42 @@ class LoDTensorBlockingQueue {
   LoDTensorBlockingQueue(size_t capacity,
                          const std::vector<framework::DDim>& dims,
                          bool speed_test_mode = false)
-      : queue_(capacity, speed_test_mode), dims_(dims) {}
+      : queue_(capacity, speed_test_mode),
+        dims_(dims),
+        monitor_(framework::GetReaderMonitor("lod_tensor_queue")) {}
 
  public:
   bool Push(const std::vector<framework::LoDTensor>& lod_tensor_vec) {
-    return queue_.Send(lod_tensor_vec);
+    std::vector<framework::LoDTensor> copy(lod_tensor_vec);
+    return Push(std::move(copy));
   }
 
   bool Push(std::vector<framework::LoDTensor>&& lod_tensor_vec) {
-    return queue_.Send(std::move(lod_tensor_vec));
+    uint64_t bytes = 0;
+    for (auto& tensor : lod_tensor_vec) {
+      if (tensor.IsInitialized()) bytes += tensor.memory_size();
+    }
+    bool success;
+    {
+      framework::ReaderTimer timer(monitor_,
+                                   framework::ReaderMonitor::kProducerWait);
+      success = queue_.Send(std::move(lod_tensor_vec));
+    }
+    if (success) monitor_->RecordProduced(bytes);
+    monitor_->RecordQueueSize(queue_.Size(), queue_.Cap());
+    return success;
   }
 
   std::vector<framework::LoDTensor> Pop(bool* ok = nullptr) {
     std::vector<framework::LoDTensor> lod_tensor_vec;
-    bool success = queue_.Receive(&lod_tensor_vec);
+    bool success;
+    {
+      framework::ReaderTimer timer(monitor_,
+                                   framework::ReaderMonitor::kConsumerWait);
+      success = queue_.Receive(&lod_tensor_vec);
+    }
+    if (success) monitor_->RecordConsumed();
+    monitor_->RecordQueueSize(queue_.Size(), queue_.Cap());
     if (ok != nullptr) *ok = success;
     return lod_tensor_vec;
   }
@@ -64,8 +87,9 @@ class LoDTensorBlockingQueue {
   inline bool IsClosed() const { return queue_.IsClosed(); }
 
  private:
-  BlockingQueue<std::vector<framework::LoDTensor>> queue_;
+  RingBlockingQueue<std::vector<framework::LoDTensor>> queue_;
   std::vector<framework::DDim> dims_;
+  framework::ReaderMonitor* monitor_;
 };
 
 class LoDTensorBlockingQueueHolder {
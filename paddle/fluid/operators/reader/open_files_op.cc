@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <cmath>
+#include <random>
 #include <stdexcept>
 #include <thread>  // NOLINT
 #include "ThreadPool.h"
@@ -20,6 +21,8 @@
 #include "paddle/fluid/operators/reader/blocking_queue.h"
 #include "paddle/fluid/operators/reader/buffered_reader.h"
 #include "paddle/fluid/operators/reader/reader_op_registry.h"
+#include "paddle/fluid/operators/reader/recordio_file_reader.h"
+#include "paddle/fluid/recordio/chunk_index.h"
 
 namespace paddle {
 namespace operators {
@@ -194,6 +197,14 @@ class MultiFileReader : public framework::ReaderBase {
     }
   }
 
+  MultiFileReader(std::vector<std::unique_ptr<framework::ReaderBase>>&& readers,
+                  std::unique_ptr<IReaderContainer>&& container)
+      : container_(std::move(container)) {
+    for (auto& reader : readers) {
+      container_->AppendReader(std::move(reader));
+    }
+  }
+
   ~MultiFileReader() { container_->Stop(); }
 
  protected:
@@ -207,6 +218,68 @@ class MultiFileReader : public framework::ReaderBase {
   std::unique_ptr<IReaderContainer> container_;
 };
 
+static uint64_t NumRecordsOfChunks(const recordio::ChunkIndex& index,
+                                   const std::vector<size_t>& chunks) {
+  uint64_t num_records = 0;
+  for (auto i : chunks) {
+    num_records += index.Chunk(i).num_records;
+  }
+  return num_records;
+}
+
+// Create the readers of the trainer_id-th shard of the chunks of every file,
+// which needs the files to have the chunk index. If num_splits > 0, the files
+// are split into about num_splits readers of the same number of records, so
+// that the reading threads are balanced however the file sizes differ.
+static std::vector<std::unique_ptr<framework::ReaderBase>> CreateChunkReaders(
+    const std::vector<std::string>& file_names, size_t trainer_id,
+    size_t num_trainers, size_t num_splits, bool shuffle, size_t seed) {
+  std::vector<recordio::ChunkIndex> indices(file_names.size());
+  std::vector<std::vector<size_t>> shards(file_names.size());
+  uint64_t total_records = 0;
+  for (size_t i = 0; i < file_names.size(); ++i) {
+    PADDLE_ENFORCE(recordio::LoadChunkIndex(file_names[i], &indices[i]),
+                   "%s has no chunk index, which is needed to shard or "
+                   "shuffle the chunks",
+                   file_names[i]);
+    shards[i] = indices[i].Shard(indices[i].AllChunks(), trainer_id,
+                                 num_trainers);
+    total_records += NumRecordsOfChunks(indices[i], shards[i]);
+  }
+
+  if (seed == 0) {
+    std::random_device device;
+    seed = device();
+  }
+  std::vector<std::unique_ptr<framework::ReaderBase>> readers;
+  for (size_t i = 0; i < file_names.size(); ++i) {
+    if (shards[i].empty()) {
+      continue;
+    }
+    size_t num_parts = 1;
+    if (num_splits > 0 && total_records > 0) {
+      double records_per_split =
+          static_cast<double>(total_records) / num_splits;
+      num_parts = static_cast<size_t>(std::round(
+          NumRecordsOfChunks(indices[i], shards[i]) / records_per_split));
+      num_parts = std::min(std::max(num_parts, static_cast<size_t>(1)),
+                           shards[i].size());
+    }
+    for (size_t part = 0; part < num_parts; ++part) {
+      auto chunks = indices[i].Shard(shards[i], part, num_parts);
+      if (chunks.empty()) {
+        continue;
+      }
+      auto* reader = new RecordIOFileReader<false>(file_names[i]);
+      reader->SelectChunks(chunks, shuffle, seed + readers.size());
+      readers.emplace_back(reader);
+    }
+  }
+  PADDLE_ENFORCE(!readers.empty(), "No chunk to be read by trainer %d",
+                 trainer_id);
+  return readers;
+}
+
 class OpenFilesOp : public framework::OperatorBase {
  public:
   using framework::OperatorBase::OperatorBase;
@@ -236,8 +309,24 @@ class OpenFilesOp : public framework::OperatorBase {
           static_cast<size_t>(Attr<int>("thread_num"))));
     }
 
-    std::shared_ptr<framework::ReaderBase> reader(
-        new MultiFileReader(file_names, std::move(container)));
+    auto trainer_id = static_cast<size_t>(Attr<int>("trainer_id"));
+    auto num_trainers = static_cast<size_t>(Attr<int>("num_trainers"));
+    bool split_files = Attr<bool>("split_files");
+    bool shuffle_chunks = Attr<bool>("shuffle_chunks");
+    PADDLE_ENFORCE_LT(trainer_id, num_trainers);
+
+    std::shared_ptr<framework::ReaderBase> reader;
+    if (num_trainers > 1 || split_files || shuffle_chunks) {
+      size_t num_splits =
+          split_files ? static_cast<size_t>(Attr<int>("thread_num")) : 0;
+      reader.reset(new MultiFileReader(
+          CreateChunkReaders(file_names, trainer_id, num_trainers, num_splits,
+                             shuffle_chunks,
+                             static_cast<size_t>(Attr<int>("seed"))),
+          std::move(container)));
+    } else {
+      reader.reset(new MultiFileReader(file_names, std::move(container)));
+    }
     auto buffer_size = Attr<int>("buffer_size");
     if (buffer_size > 1) {
       reader = framework::MakeDecoratedReader<BufferedReader>(
@@ -258,12 +347,37 @@ class OpenFilesOpMaker : public FileReaderMakerBase {
 
       An OpenFilesOp creates a MultiFileReader, which is able to
       read data multi-threaded from multiple files.
+
+      The chunks of the files can be sharded by trainers, split into
+      balanced readers or shuffled. That needs the recordio files to be
+      written with the chunk index.
     )DOC");
     AddAttr<int>("thread_num",
                  "The maximal concurrent prefetch thread number. Used only "
                  "when is_test = False");
     AddAttr<int>("buffer_size", "The reading buffer of these files.")
         .GreaterThan(0);
+    AddAttr<int>("trainer_id",
+                 "The id of this trainer. The trainer reads only its shard "
+                 "of the chunks of each file.")
+        .SetDefault(0)
+        .EqualGreaterThan(0);
+    AddAttr<int>("num_trainers",
+                 "The number of trainers sharding the chunks of the files.")
+        .SetDefault(1)
+        .GreaterThan(0);
+    AddAttr<bool>("split_files",
+                  "Whether to split the files into thread_num readers of "
+                  "about the same number of records.")
+        .SetDefault(false);
+    AddAttr<bool>("shuffle_chunks",
+                  "Whether to read the chunks of each file in a random order "
+                  "every pass.")
+        .SetDefault(false);
+    AddAttr<int>("seed",
+                 "The random seed of shuffling the chunks. 0 means a random "
+                 "seed.")
+        .SetDefault(0);
   }
 };
 
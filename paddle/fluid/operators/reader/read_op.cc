@@ -85,14 +85,20 @@ class ReadOp : public framework::OperatorBase {
     auto& ctx = *pool.Get(dev_place);
     platform::RecordEvent record_event(Type(), &ctx);
 
-    reader->ReadNext(&ins);
+    int device_id = Attr<int>("device_id");
+    if (device_id >= 0) {
+      reader->ReadNextForDevice(&ins, static_cast<size_t>(device_id));
+    } else {
+      reader->ReadNext(&ins);
+    }
     if (ins.empty()) {
       if (Attr<bool>("throw_eof_exp")) {
         PADDLE_THROW_EOF();
       } else {
         ins.resize(out_arg_names.size());
         for (auto& tensor : ins) {
-          // data type is not important for subsequent DataBalanceOpHandle
+          // The empty batches tell the ops that the reader runs dry, their
+          // data type is not important.
           tensor.mutable_data<float>(framework::make_ddim({0}), dev_place);
         }
       }
@@ -115,11 +121,18 @@ class ReadOpMaker : public framework::OpProtoAndCheckerMaker {
     AddAttr<bool>(
         "throw_eof_exp",
         "If set true, an exception will be thrown when the Reader "
-        "yields empty (which means there is no next data).\n"
-        "NOTES: This flag must be true always. It will be set to false"
-        " only when the data-balance is enabled in ParallelExecutor"
-        " and it is set by ParallelExecutor instance, not users.")
+        "yields empty (which means there is no next data), else the "
+        "outputs are empty tensors.\n"
+        "NOTES: The places of ParallelExecutor read whole batches from the "
+        "shared reader when they are ready, so there is no balancing of "
+        "the batches between the places and this flag should be true.")
         .SetDefault(true);
+    AddAttr<int>("device_id",
+                 "The place of ParallelExecutor which runs the op, which is "
+                 "set by ParallelExecutor, not users. The readers which keep "
+                 "the batches by place, e.g., the work stealing reader, read "
+                 "the batches of the place. -1 if not run by it.")
+        .SetDefault(-1);
     AddComment(R"DOC(
       Read Operator
 
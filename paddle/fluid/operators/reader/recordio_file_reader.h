@@ -0,0 +1,94 @@
+// Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <random>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/reader.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/lock_guard_ptr.h"
+#include "paddle/fluid/recordio/scanner.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+template <bool ThreadSafe>
+class RecordIOFileReader : public framework::FileReader {
+ public:
+  explicit RecordIOFileReader(const std::string& filename, int num_threads = 0,
+                              size_t lookahead = 0, bool ordered = true)
+      : scanner_(filename, num_threads, lookahead, ordered),
+        dev_ctx_(*platform::DeviceContextPool::Instance().Get(
+            platform::CPUPlace())) {
+    if (ThreadSafe) {
+      mutex_.reset(new std::mutex());
+    }
+    LOG(INFO) << "Creating file reader" << filename;
+  }
+
+  // Read only the given chunks of the file, which needs the chunk index. If
+  // shuffle is true, the chunks are read in a new random order every pass.
+  void SelectChunks(const std::vector<size_t>& chunks, bool shuffle,
+                    unsigned int seed) {
+    chunks_ = chunks;
+    shuffle_ = shuffle;
+    engine_.seed(seed);
+    ShuffleAndSelect();
+  }
+
+ protected:
+  void ReadNextImpl(std::vector<framework::LoDTensor>* out) override {
+    platform::LockGuardPtr<std::mutex> guard(mutex_);
+    bool ok = framework::ReadFromRecordIO(&scanner_, dev_ctx_, out);
+    if (!ok) {
+      out->clear();
+    }
+  }
+
+  void StartImpl() override {
+    if (shuffle_) {
+      ShuffleAndSelect();
+    } else {
+      scanner_.Reset();
+    }
+  }
+
+ private:
+  void ShuffleAndSelect() {
+    if (shuffle_) {
+      std::shuffle(chunks_.begin(), chunks_.end(), engine_);
+    }
+    scanner_.SelectChunks(chunks_);
+  }
+
+  std::unique_ptr<std::mutex> mutex_;
+  recordio::Scanner scanner_;
+  const platform::DeviceContext& dev_ctx_;
+
+  std::vector<size_t> chunks_;
+  bool shuffle_{false};
+  std::mt19937 engine_;
+};
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
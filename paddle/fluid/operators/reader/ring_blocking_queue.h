@@ -0,0 +1,265 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <thread>              // NOLINT
+#include <utility>
+#include <vector>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+template <typename T>
+class RingBlockingQueue {
+  // RingBlockingQueue is a bounded multi-producer multi-consumer queue with
+  // the same interface as BlockingQueue. The elements are stored in a ring
+  // buffer whose slots carry a turn number, so that Send and Receive
+  // only need a CAS on the enqueue/dequeue position instead of a mutex.
+  // A thread which cannot make progress spins for a while and then parks on
+  // a condition variable, which is only signaled when there are waiters.
+  //
+  // ReOpen() must not be called concurrently with Send() or Receive().
+ public:
+  explicit RingBlockingQueue(size_t capacity, bool speed_test_mode = false)
+      : capacity_(capacity),
+        speed_test_mode_(speed_test_mode),
+        slots_(capacity),
+        enqueue_pos_(0),
+        dequeue_pos_(0),
+        closed_(false),
+        send_waiters_(0),
+        receive_waiters_(0) {
+    PADDLE_ENFORCE_GT(
+        capacity_, 0,
+        "The capacity of a reader::RingBlockingQueue must be greater than 0.");
+  }
+
+  bool Send(const T& elem) {
+    T copy(elem);
+    return Send(std::move(copy));
+  }
+
+  bool Send(T&& elem) {
+    if (!Wait(&send_waiters_, &send_cv_, [this] { return !Full(); })) {
+      VLOG(5) << "WARNING: Sending an element to a closed "
+                 "reader::RingBlockingQueue.";
+      return false;
+    }
+    while (!TrySend(&elem)) {
+      if (!Wait(&send_waiters_, &send_cv_, [this] { return !Full(); })) {
+        VLOG(5) << "WARNING: Sending an element to a closed "
+                   "reader::RingBlockingQueue.";
+        return false;
+      }
+    }
+    Notify(&receive_waiters_, &receive_cv_);
+    return true;
+  }
+
+  bool Receive(T* elem) {
+    PADDLE_ENFORCE_NOT_NULL(elem);
+    while (true) {
+      if (UNLIKELY(speed_test_mode_)) {
+        if (TryPeek(elem)) return true;
+      } else if (TryReceive(elem)) {
+        Notify(&send_waiters_, &send_cv_);
+        return true;
+      }
+      if (!Wait(&receive_waiters_, &receive_cv_,
+                [this] { return !Empty(); })) {
+        // The queue is closed, but the remaining elements can still be read.
+        if (UNLIKELY(speed_test_mode_)) return TryPeek(elem);
+        if (TryReceive(elem)) {
+          Notify(&send_waiters_, &send_cv_);
+          return true;
+        }
+        return false;
+      }
+    }
+  }
+
+  void ReOpen() {
+    T elem;
+    while (TryReceive(&elem)) {
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_.store(false);
+    }
+    send_cv_.notify_all();
+    receive_cv_.notify_all();
+  }
+
+  void Close() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_.store(true);
+    }
+    send_cv_.notify_all();
+    receive_cv_.notify_all();
+  }
+
+  bool IsClosed() const { return closed_.load(); }
+
+  size_t Cap() const { return capacity_; }
+
+  size_t Size() const {
+    size_t dequeue_pos = dequeue_pos_.load();
+    size_t enqueue_pos = enqueue_pos_.load();
+    if (enqueue_pos <= dequeue_pos) return 0;
+    size_t size = enqueue_pos - dequeue_pos;
+    return size > capacity_ ? capacity_ : size;
+  }
+
+ private:
+  struct Slot {
+    std::atomic<size_t> turn{0};
+    T data;
+  };
+
+  // The position pos goes to the slot pos % capacity_ in the round
+  // pos / capacity_. A slot is writable in round r when its turn equals 2 * r,
+  // and is readable when its turn equals 2 * r + 1. Every write or read
+  // increases the turn by one.
+  size_t WriteTurn(size_t pos) const { return 2 * (pos / capacity_); }
+
+  size_t ReadTurn(size_t pos) const { return 2 * (pos / capacity_) + 1; }
+
+  bool TrySend(T* elem) {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot& slot = slots_[pos % capacity_];
+      size_t turn = slot.turn.load(std::memory_order_acquire);
+      if (turn == WriteTurn(pos)) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          slot.data = std::move(*elem);
+          slot.turn.store(turn + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (turn < WriteTurn(pos)) {
+        return false;  // full
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool TryReceive(T* elem) {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot& slot = slots_[pos % capacity_];
+      size_t turn = slot.turn.load(std::memory_order_acquire);
+      if (turn == ReadTurn(pos)) {
+        if (dequeue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          *elem = std::move(slot.data);
+          slot.data = T();
+          slot.turn.store(turn + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (turn < ReadTurn(pos)) {
+        return false;  // empty
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // In speed test mode no element is popped, so the front slot can not be
+  // overwritten while it is being read.
+  bool TryPeek(T* elem) {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    Slot& slot = slots_[pos % capacity_];
+    if (slot.turn.load(std::memory_order_acquire) != ReadTurn(pos)) {
+      return false;
+    }
+    *elem = slot.data;
+    return true;
+  }
+
+  bool Full() const {
+    size_t pos = enqueue_pos_.load();
+    return slots_[pos % capacity_].turn.load() < WriteTurn(pos);
+  }
+
+  bool Empty() const {
+    size_t pos = dequeue_pos_.load();
+    return slots_[pos % capacity_].turn.load() < ReadTurn(pos);
+  }
+
+  // Wait until ready() or the queue is closed. Return false if closed.
+  template <typename Predicate>
+  bool Wait(std::atomic<int>* waiters, std::condition_variable* cv,
+            Predicate ready) {
+    for (int i = 0; i < kSpinCount; ++i) {
+      if (closed_.load()) return false;
+      if (ready()) return true;
+      if (i >= kSpinCount / 2) std::this_thread::yield();
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++(*waiters);
+    cv->wait(lock, [&] { return closed_.load() || ready(); });
+    --(*waiters);
+    return !closed_.load();
+  }
+
+  void Notify(std::atomic<int>* waiters, std::condition_variable* cv) {
+    // The waiter increases waiters before checking the predicate under the
+    // mutex, so taking the mutex here makes sure it is not missed. The fence
+    // keeps the load of waiters from being reordered before the publishing
+    // of the slot.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters->load() > 0) {
+      { std::lock_guard<std::mutex> lock(mutex_); }
+      cv->notify_one();
+    }
+  }
+
+  static constexpr int kSpinCount = 128;
+
+  const size_t capacity_;
+  const bool speed_test_mode_;
+  std::vector<Slot> slots_;
+
+  // Put the positions in different cache lines to avoid false sharing
+  // between producers and consumers.
+  char pad0_[64];
+  std::atomic<size_t> enqueue_pos_;
+  char pad1_[64];
+  std::atomic<size_t> dequeue_pos_;
+  char pad2_[64];
+
+  std::atomic<bool> closed_;
+  std::atomic<int> send_waiters_;
+  std::atomic<int> receive_waiters_;
+
+  std::mutex mutex_;
+  std::condition_variable send_cv_;
+  std::condition_variable receive_cv_;
+};
+
+template <typename T>
+constexpr int RingBlockingQueue<T>::kSpinCount;
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,155 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>  // NOLINT
+#include <mutex>   // NOLINT
+#include <set>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+
+#include "paddle/fluid/operators/reader/blocking_queue.h"
+#include "paddle/fluid/operators/reader/ring_blocking_queue.h"
+
+using paddle::operators::reader::BlockingQueue;
+using paddle::operators::reader::RingBlockingQueue;
+
+TEST(RingBlockingQueue, FirstInFirstOutTest) {
+  RingBlockingQueue<size_t> q(3);
+  EXPECT_EQ(q.Cap(), 3UL);
+  const size_t elem_num = 100;
+  std::thread sender([&]() {
+    for (size_t i = 0; i < elem_num; ++i) {
+      EXPECT_TRUE(q.Send(i));
+    }
+    q.Close();
+  });
+  size_t count = 0;
+  size_t elem;
+  while (q.Receive(&elem)) {
+    EXPECT_EQ(elem, count++);
+  }
+  sender.join();
+  EXPECT_EQ(count, elem_num);
+  EXPECT_TRUE(q.IsClosed());
+}
+
+TEST(RingBlockingQueue, CloseAndReOpenTest) {
+  const size_t queue_cap = 2;
+  RingBlockingQueue<size_t> q(queue_cap);
+  size_t send_count = 0;
+  std::thread sender([&]() {
+    for (size_t i = 0; i < 5; ++i) {
+      if (!q.Send(i)) {
+        break;
+      }
+      ++send_count;
+    }
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  EXPECT_EQ(q.Size(), queue_cap);
+  q.Close();
+  sender.join();
+  EXPECT_EQ(send_count, queue_cap);
+  EXPECT_FALSE(q.Send(10));
+
+  // The remaining elements can be received after closing.
+  size_t elem;
+  EXPECT_TRUE(q.Receive(&elem));
+  EXPECT_EQ(elem, 0UL);
+
+  q.ReOpen();
+  EXPECT_FALSE(q.IsClosed());
+  EXPECT_EQ(q.Size(), 0UL);
+  EXPECT_TRUE(q.Send(3));
+  EXPECT_TRUE(q.Receive(&elem));
+  EXPECT_EQ(elem, 3UL);
+}
+
+TEST(RingBlockingQueue, speed_test_mode) {
+  size_t queue_size = 10;
+  RingBlockingQueue<size_t> q(queue_size, true);
+  for (size_t i = 0; i < queue_size; ++i) {
+    q.Send(i);
+  }
+  size_t b;
+  for (size_t i = 0; i < queue_size; ++i) {
+    q.Receive(&b);
+    EXPECT_EQ(b, 0UL);
+  }
+  EXPECT_EQ(q.Size(), queue_size);
+}
+
+// Send elem_num elements with each of the sender_num threads, and receive
+// them with receiver_num threads. Return the elapsed time in milliseconds.
+template <typename QueueType>
+double MultiSenderMultiReceiver(size_t queue_cap, size_t sender_num,
+                                size_t receiver_num, size_t elem_num) {
+  QueueType q(queue_cap);
+  std::mutex mu;
+  std::set<size_t> received;
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> senders;
+  for (size_t s_idx = 0; s_idx < sender_num; ++s_idx) {
+    senders.emplace_back([&, s_idx] {
+      for (size_t i = 0; i < elem_num; ++i) {
+        EXPECT_TRUE(q.Send(s_idx * elem_num + i));
+      }
+    });
+  }
+  std::vector<std::thread> receivers;
+  for (size_t r_idx = 0; r_idx < receiver_num; ++r_idx) {
+    receivers.emplace_back([&] {
+      std::vector<size_t> res;
+      size_t elem;
+      while (q.Receive(&elem)) {
+        res.push_back(elem);
+      }
+      std::lock_guard<std::mutex> lock(mu);
+      received.insert(res.begin(), res.end());
+    });
+  }
+  for (auto& t : senders) {
+    t.join();
+  }
+  q.Close();
+  for (auto& t : receivers) {
+    t.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  EXPECT_EQ(received.size(), sender_num * elem_num);
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+TEST(RingBlockingQueue, MultiSenderMultiReceiverTest) {
+  MultiSenderMultiReceiver<RingBlockingQueue<size_t>>(1, 3, 2, 1000);
+  MultiSenderMultiReceiver<RingBlockingQueue<size_t>>(2, 1, 8, 1000);
+  MultiSenderMultiReceiver<RingBlockingQueue<size_t>>(16, 8, 1, 1000);
+}
+
+TEST(RingBlockingQueue, ThroughputBenchmark) {
+  const size_t queue_cap = 64;
+  const size_t elem_num = 100000;
+  for (size_t thread_num : {1, 2, 4, 8}) {
+    double deque_ms = MultiSenderMultiReceiver<BlockingQueue<size_t>>(
+        queue_cap, thread_num, thread_num, elem_num);
+    double ring_ms = MultiSenderMultiReceiver<RingBlockingQueue<size_t>>(
+        queue_cap, thread_num, thread_num, elem_num);
+    LOG(INFO) << thread_num << " senders, " << thread_num
+              << " receivers: BlockingQueue " << deque_ms
+              << " ms, RingBlockingQueue " << ring_ms << " ms";
+  }
+}
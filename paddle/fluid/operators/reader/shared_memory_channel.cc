@@ -0,0 +1,398 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/reader/shared_memory_channel.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include "paddle/fluid/memory/allocation/allocator.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+namespace {
+
+// The messages of the ready pipe other than the segment indices.
+constexpr int32_t kSenderClosed = -1;
+constexpr int32_t kReceiverStopped = -2;
+
+constexpr size_t kAlignment = 64;
+
+size_t AlignUp(size_t offset) {
+  return (offset + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+void WriteIndex(int fd, int32_t index) {
+  ssize_t ret;
+  do {
+    ret = write(fd, &index, sizeof(index));
+  } while (ret < 0 && errno == EINTR);
+  PADDLE_ENFORCE_EQ(ret, static_cast<ssize_t>(sizeof(index)),
+                    "Write to the pipe failed: %s", std::strerror(errno));
+}
+
+int32_t ReadIndex(int fd) {
+  int32_t index;
+  ssize_t ret;
+  do {
+    ret = read(fd, &index, sizeof(index));
+  } while (ret < 0 && errno == EINTR);
+  PADDLE_ENFORCE_EQ(ret, static_cast<ssize_t>(sizeof(index)),
+                    "Read from the pipe failed: %s", std::strerror(errno));
+  return index;
+}
+
+class BufferWriter {
+ public:
+  BufferWriter(void* buffer, size_t size)
+      : buffer_(static_cast<char*>(buffer)), size_(size) {}
+
+  template <typename T>
+  void Write(const T& value) {
+    Write(&value, sizeof(T));
+  }
+
+  // Only counts the size if the buffer is nullptr.
+  void Write(const void* data, size_t size) {
+    if (buffer_ != nullptr) {
+      PADDLE_ENFORCE_LE(offset_ + size, size_,
+                        "The batch is larger than the segment of %d bytes",
+                        size_);
+      std::memcpy(buffer_ + offset_, data, size);
+    }
+    offset_ += size;
+  }
+
+  void Align() { offset_ = AlignUp(offset_); }
+
+  size_t offset() const { return offset_; }
+
+ private:
+  char* buffer_;
+  size_t size_;
+  size_t offset_{0};
+};
+
+class BufferReader {
+ public:
+  BufferReader(const void* buffer, size_t size)
+      : buffer_(static_cast<const char*>(buffer)), size_(size) {}
+
+  template <typename T>
+  T Read() {
+    T value;
+    std::memcpy(&value, Skip(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  // Returns the data skipped.
+  const char* Skip(size_t size) {
+    PADDLE_ENFORCE_LE(offset_ + size, size_, "The segment is corrupted");
+    const char* data = buffer_ + offset_;
+    offset_ += size;
+    return data;
+  }
+
+  void Align() { offset_ = AlignUp(offset_); }
+
+ private:
+  const char* buffer_;
+  size_t size_;
+  size_t offset_{0};
+};
+
+}  // namespace
+
+SharedMemorySegment::SharedMemorySegment(const std::string& name, size_t size,
+                                         bool create)
+    : name_(name), size_(size), owned_(create) {
+  int fd = create ? shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600)
+                  : shm_open(name.c_str(), O_RDWR, 0600);
+  PADDLE_ENFORCE_GE(fd, 0, "shm_open %s failed: %s", name,
+                    std::strerror(errno));
+  if (create && ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    int err = errno;
+    close(fd);
+    shm_unlink(name.c_str());
+    PADDLE_THROW("ftruncate %s failed: %s", name, std::strerror(err));
+  }
+  data_ = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  int err = errno;
+  close(fd);
+  if (data_ == MAP_FAILED) {
+    if (create) shm_unlink(name.c_str());
+    PADDLE_THROW("mmap %s failed: %s", name, std::strerror(err));
+  }
+}
+
+SharedMemorySegment::~SharedMemorySegment() {
+  munmap(data_, size_);
+  if (owned_) shm_unlink(name_.c_str());
+}
+
+size_t SerializeToBuffer(const std::vector<framework::LoDTensor>& tensors,
+                         void* buffer, size_t size) {
+  BufferWriter writer(buffer, size);
+  writer.Write(static_cast<uint32_t>(tensors.size()));
+  for (auto& tensor : tensors) {
+    PADDLE_ENFORCE(tensor.IsInitialized(), "The tensor is not initialized");
+    PADDLE_ENFORCE(platform::is_cpu_place(tensor.place()),
+                   "Only the CPU tensors can be sent");
+    writer.Write(static_cast<int32_t>(tensor.type()));
+    writer.Write(static_cast<int32_t>(tensor.dims().size()));
+    for (int i = 0; i < tensor.dims().size(); ++i) {
+      writer.Write(static_cast<int64_t>(tensor.dims()[i]));
+    }
+    writer.Write(static_cast<uint32_t>(tensor.lod().size()));
+    for (auto& level : tensor.lod()) {
+      writer.Write(static_cast<uint64_t>(level.size()));
+      for (size_t offset : level) {
+        writer.Write(static_cast<uint64_t>(offset));
+      }
+    }
+    size_t bytes = tensor.numel() * framework::SizeOfType(tensor.type());
+    writer.Write(static_cast<uint64_t>(bytes));
+    writer.Align();
+    writer.Write(tensor.data<void>(), bytes);
+    writer.Align();
+  }
+  return writer.offset();
+}
+
+struct SharedMemoryReceiver::State {
+  ~State() {
+    close(free_fds[0]);
+    close(free_fds[1]);
+    close(ready_fds[0]);
+    close(ready_fds[1]);
+  }
+
+  std::vector<std::unique_ptr<SharedMemorySegment>> segments;
+  int free_fds[2];
+  int ready_fds[2];
+};
+
+namespace {
+
+// A segment taken by a batch, which is freed with the last tensor.
+class SegmentLease {
+ public:
+  SegmentLease(std::shared_ptr<void> state, int free_fd, int32_t index)
+      : state_(std::move(state)), free_fd_(free_fd), index_(index) {}
+
+  ~SegmentLease() {
+    try {
+      WriteIndex(free_fd_, index_);
+    } catch (platform::EnforceNotMet& e) {
+      LOG(ERROR) << e.what();
+    }
+  }
+
+ private:
+  // Keeps the segments and the pipes alive.
+  std::shared_ptr<void> state_;
+  int free_fd_;
+  int32_t index_;
+};
+
+class SegmentAllocation : public memory::Allocation {
+ public:
+  SegmentAllocation(void* ptr, size_t size,
+                    std::shared_ptr<SegmentLease> lease)
+      : Allocation(ptr, size, platform::CPUPlace()), lease_(std::move(lease)) {}
+
+ private:
+  std::shared_ptr<SegmentLease> lease_;
+};
+
+std::vector<framework::LoDTensor> DeserializeFromSegment(
+    const SharedMemorySegment& segment,
+    const std::shared_ptr<SegmentLease>& lease) {
+  BufferReader reader(segment.data(), segment.size());
+  std::vector<framework::LoDTensor> tensors(reader.Read<uint32_t>());
+  for (auto& tensor : tensors) {
+    auto type =
+        static_cast<framework::proto::VarType::Type>(reader.Read<int32_t>());
+    std::vector<int64_t> dims(reader.Read<int32_t>());
+    for (auto& dim : dims) {
+      dim = reader.Read<int64_t>();
+    }
+    framework::LoD lod(reader.Read<uint32_t>());
+    for (auto& level : lod) {
+      level.resize(reader.Read<uint64_t>());
+      for (auto& offset : level) {
+        offset = static_cast<size_t>(reader.Read<uint64_t>());
+      }
+    }
+    size_t bytes = static_cast<size_t>(reader.Read<uint64_t>());
+    reader.Align();
+    void* data = const_cast<char*>(reader.Skip(bytes));
+    reader.Align();
+
+    tensor.Resize(framework::make_ddim(dims));
+    tensor.set_lod(lod);
+    tensor.ResetHolderWithType(
+        std::make_shared<SegmentAllocation>(data, bytes, lease), type);
+  }
+  return tensors;
+}
+
+}  // namespace
+
+SharedMemoryReceiver::SharedMemoryReceiver(
+    const std::shared_ptr<LoDTensorBlockingQueue>& queue, size_t num_segments,
+    size_t segment_size, size_t num_senders)
+    : state_(new State),
+      queue_(queue),
+      num_senders_(num_senders),
+      owner_pid_(getpid()) {
+  PADDLE_ENFORCE(queue_ != nullptr, "LoDTensorBlockingQueue must not be null");
+  PADDLE_ENFORCE_GT(num_segments, 0, "There should be at least one segment");
+  PADDLE_ENFORCE_GT(num_senders_, 0, "There should be at least one sender");
+  PADDLE_ENFORCE_EQ(pipe(state_->free_fds), 0, "pipe failed: %s",
+                    std::strerror(errno));
+  if (pipe(state_->ready_fds) != 0) {
+    int err = errno;
+    close(state_->free_fds[0]);
+    close(state_->free_fds[1]);
+    PADDLE_THROW("pipe failed: %s", std::strerror(err));
+  }
+
+  // The names are unique among the receivers of all the processes.
+  static std::atomic<int> receiver_id{0};
+  std::string prefix = "/paddle_reader_" + std::to_string(owner_pid_) + "_" +
+                       std::to_string(receiver_id++) + "_";
+  for (size_t i = 0; i < num_segments; ++i) {
+    state_->segments.emplace_back(new SharedMemorySegment(
+        prefix + std::to_string(i), segment_size, true));
+    WriteIndex(state_->free_fds[1], static_cast<int32_t>(i));
+  }
+}
+
+SharedMemoryReceiver::~SharedMemoryReceiver() {
+  if (getpid() != owner_pid_) {
+    // The thread and the segments belong to the parent process.
+    thread_.release();
+    new std::shared_ptr<State>(std::move(state_));
+    return;
+  }
+  Stop();
+}
+
+std::vector<std::string> SharedMemoryReceiver::SegmentNames() const {
+  std::vector<std::string> names;
+  for (auto& segment : state_->segments) {
+    names.push_back(segment->name());
+  }
+  return names;
+}
+
+size_t SharedMemoryReceiver::SegmentSize() const {
+  return state_->segments[0]->size();
+}
+
+int SharedMemoryReceiver::FreeFd() const { return state_->free_fds[0]; }
+
+int SharedMemoryReceiver::ReadyFd() const { return state_->ready_fds[1]; }
+
+void SharedMemoryReceiver::Start() {
+  PADDLE_ENFORCE(thread_ == nullptr, "The receiver is started");
+  thread_.reset(new std::thread([this] { ReceiveLoop(); }));
+}
+
+void SharedMemoryReceiver::Stop() {
+  if (thread_ == nullptr) return;
+  queue_->Close();
+  WriteIndex(state_->ready_fds[1], kReceiverStopped);
+  thread_->join();
+  thread_.reset();
+}
+
+void SharedMemoryReceiver::ReceiveLoop() {
+  try {
+    Receive();
+  } catch (platform::EnforceNotMet& e) {
+    LOG(ERROR) << e.what();
+    queue_->Close();
+  }
+  VLOG(3) << "The shared memory receiver exits";
+}
+
+void SharedMemoryReceiver::Receive() {
+  int32_t num_segments = static_cast<int32_t>(state_->segments.size());
+  size_t num_closed = 0;
+  while (true) {
+    int32_t index = ReadIndex(state_->ready_fds[0]);
+    if (index == kReceiverStopped) break;
+    if (index == kSenderClosed) {
+      if (++num_closed == num_senders_) {
+        queue_->Close();
+        break;
+      }
+      continue;
+    }
+    PADDLE_ENFORCE(index >= 0 && index < num_segments,
+                   "Invalid segment index %d", index);
+    auto lease = std::make_shared<SegmentLease>(state_, state_->free_fds[1],
+                                                index);
+    auto tensors = DeserializeFromSegment(*state_->segments[index], lease);
+    lease.reset();
+    // If the queue is closed, the tensors free the segment here.
+    queue_->Push(std::move(tensors));
+  }
+}
+
+SharedMemorySender::SharedMemorySender(
+    const std::vector<std::string>& segment_names, size_t segment_size,
+    int free_fd, int ready_fd)
+    : free_fd_(free_fd), ready_fd_(ready_fd) {
+  for (auto& name : segment_names) {
+    segments_.emplace_back(new SharedMemorySegment(name, segment_size, false));
+  }
+}
+
+void SharedMemorySender::Send(
+    const std::vector<framework::LoDTensor>& tensors) {
+  PADDLE_ENFORCE(!closed_, "The sender is closed");
+  // Check the tensors before taking a segment, which can not be given back by
+  // the sender.
+  size_t size = SerializeToBuffer(tensors, nullptr, 0);
+  PADDLE_ENFORCE_LE(size, segments_[0]->size(),
+                    "The batch of %d bytes is larger than the segment", size);
+  int32_t index = ReadIndex(free_fd_);
+  PADDLE_ENFORCE(index >= 0 && index < static_cast<int32_t>(segments_.size()),
+                 "Invalid segment index %d", index);
+  auto& segment = segments_[index];
+  SerializeToBuffer(tensors, segment->data(), segment->size());
+  WriteIndex(ready_fd_, index);
+}
+
+void SharedMemorySender::Close() {
+  if (closed_) return;
+  closed_ = true;
+  WriteIndex(ready_fd_, kSenderClosed);
+}
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
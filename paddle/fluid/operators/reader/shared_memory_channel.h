@@ -0,0 +1,121 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/operators/reader/lod_tensor_blocking_queue.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+/* Feed a LoDTensorBlockingQueue from the worker processes.
+ *
+ * The receiver creates a fixed number of POSIX shared memory segments and two
+ * pipes. The worker processes, forked after the receiver is created, take the
+ * index of a free segment from the free pipe, serialize a batch of LoDTensors
+ * into it, and write the index into the ready pipe. The receiver thread pushes
+ * the tensors, which share the memory of the segment, into the queue, and the
+ * index goes back to the free pipe when the last of them is released. So no
+ * memory is allocated per batch, and the batch is copied only once, by the
+ * worker.
+ *
+ * The writes of an index are atomic, so the workers share the pipes. The
+ * workers should be terminated after the receiver is stopped.
+ */
+
+class SharedMemorySegment {
+ public:
+  // Create a segment if create is true, or open a created one.
+  SharedMemorySegment(const std::string& name, size_t size, bool create);
+
+  ~SharedMemorySegment();
+
+  const std::string& name() const { return name_; }
+  size_t size() const { return size_; }
+  void* data() const { return data_; }
+
+ private:
+  std::string name_;
+  size_t size_;
+  bool owned_;
+  void* data_;
+};
+
+// Write the tensors into the buffer, returns the size written. Only the size
+// is computed if the buffer is nullptr.
+size_t SerializeToBuffer(const std::vector<framework::LoDTensor>& tensors,
+                         void* buffer, size_t size);
+
+class SharedMemoryReceiver {
+ public:
+  SharedMemoryReceiver(const std::shared_ptr<LoDTensorBlockingQueue>& queue,
+                       size_t num_segments, size_t segment_size,
+                       size_t num_senders);
+
+  ~SharedMemoryReceiver();
+
+  // The arguments of the SharedMemorySender of the workers.
+  std::vector<std::string> SegmentNames() const;
+  size_t SegmentSize() const;
+  int FreeFd() const;
+  int ReadyFd() const;
+
+  void Start();
+  // Close the queue and stop the thread, the batches in the queue are kept.
+  void Stop();
+
+ private:
+  struct State;
+
+  void ReceiveLoop();
+  void Receive();
+
+  std::shared_ptr<State> state_;
+  std::shared_ptr<LoDTensorBlockingQueue> queue_;
+  size_t num_senders_;
+  // The forked workers must not clean up the segments of the receiver.
+  pid_t owner_pid_;
+  std::unique_ptr<std::thread> thread_;
+};
+
+class SharedMemorySender {
+ public:
+  SharedMemorySender(const std::vector<std::string>& segment_names,
+                     size_t segment_size, int free_fd, int ready_fd);
+
+  // Block until a segment is free.
+  void Send(const std::vector<framework::LoDTensor>& tensors);
+
+  // Tell the receiver this worker has no more batches.
+  void Close();
+
+ private:
+  std::vector<std::unique_ptr<SharedMemorySegment>> segments_;
+  int free_fd_;
+  int ready_fd_;
+  bool closed_{false};
+};
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,94 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/reader/shared_memory_channel.h"
+
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+namespace {
+
+std::vector<framework::LoDTensor> MakeBatch(int step) {
+  std::vector<framework::LoDTensor> batch(2);
+  float* x = batch[0].mutable_data<float>(framework::make_ddim({2, 3}),
+                                          platform::CPUPlace());
+  for (int i = 0; i < 6; ++i) x[i] = step * 10 + i;
+  int64_t* y = batch[1].mutable_data<int64_t>(framework::make_ddim({3, 1}),
+                                              platform::CPUPlace());
+  for (int i = 0; i < 3; ++i) y[i] = step + i;
+  batch[1].set_lod({{0, 1, 3}});
+  return batch;
+}
+
+std::shared_ptr<LoDTensorBlockingQueue> MakeQueue(size_t capacity) {
+  LoDTensorBlockingQueueHolder holder;
+  holder.InitOnce(capacity, {});
+  return holder.GetQueue();
+}
+
+}  // namespace
+
+TEST(SharedMemoryChannel, send_and_receive) {
+  auto queue = MakeQueue(2);
+  // A single segment is reused by all the batches.
+  SharedMemoryReceiver receiver(queue, 1, 4096, 1);
+  receiver.Start();
+
+  constexpr int kSteps = 5;
+  std::thread worker([&] {
+    SharedMemorySender sender(receiver.SegmentNames(), receiver.SegmentSize(),
+                              receiver.FreeFd(), receiver.ReadyFd());
+    for (int step = 0; step < kSteps; ++step) {
+      sender.Send(MakeBatch(step));
+    }
+    sender.Close();
+  });
+
+  for (int step = 0; step < kSteps; ++step) {
+    bool ok;
+    auto batch = queue->Pop(&ok);
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(batch.size(), 2UL);
+    EXPECT_EQ(batch[0].dims(), framework::make_ddim({2, 3}));
+    EXPECT_EQ(batch[0].type(), framework::proto::VarType::FP32);
+    EXPECT_EQ(batch[0].data<float>()[5], step * 10 + 5);
+    EXPECT_EQ(batch[1].dims(), framework::make_ddim({3, 1}));
+    EXPECT_EQ(batch[1].data<int64_t>()[2], step + 2);
+    EXPECT_EQ(batch[1].lod(), framework::LoD({{0, 1, 3}}));
+  }
+  worker.join();
+
+  bool ok;
+  queue->Pop(&ok);
+  EXPECT_FALSE(ok);
+  receiver.Stop();
+}
+
+TEST(SharedMemoryChannel, batch_too_large) {
+  auto queue = MakeQueue(2);
+  SharedMemoryReceiver receiver(queue, 1, 64, 1);
+  SharedMemorySender sender(receiver.SegmentNames(), receiver.SegmentSize(),
+                            receiver.FreeFd(), receiver.ReadyFd());
+  EXPECT_THROW(sender.Send(MakeBatch(0)), platform::EnforceNotMet);
+}
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
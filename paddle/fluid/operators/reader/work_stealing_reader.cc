@@ -0,0 +1,159 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/reader/work_stealing_reader.h"
+#include <utility>
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+WorkStealingReader::WorkStealingReader(
+    const std::shared_ptr<ReaderBase>& reader, size_t place_num,
+    size_t buffer_size)
+    : framework::DecoratedReader(reader),
+      buffer_size_(buffer_size),
+      queues_(place_num) {
+  PADDLE_ENFORCE_GT(place_num, 0UL, "There should be at least one place.");
+  PADDLE_ENFORCE_GT(buffer_size, 0UL,
+                    "Each place should buffer at least one batch.");
+  prefetch_thread_ = std::thread([this] { PrefetchThreadFunc(); });
+}
+
+WorkStealingReader::~WorkStealingReader() { Shutdown(); }
+
+void WorkStealingReader::ReadNextForDevice(
+    std::vector<framework::LoDTensor>* out, size_t device_id) {
+  PADDLE_ENFORCE_LT(device_id, queues_.size(),
+                    "The reader is prefetched for %d places only.",
+                    queues_.size());
+  std::unique_lock<std::mutex> lock(queue_mu_);
+  PADDLE_ENFORCE(!closed_, "The reader is shut down.");
+  while (true) {
+    auto& own = queues_[device_id];
+    if (!own.empty()) {
+      *out = std::move(own.front());
+      own.pop_front();
+      break;
+    }
+    auto& victim = queues_[LongestQueue()];
+    if (!victim.empty()) {
+      *out = std::move(victim.back());
+      victim.pop_back();
+      ++stolen_num_;
+      break;
+    }
+    if (closed_ || eof_) {
+      if (!closed_ && exception_) {
+        std::rethrow_exception(exception_);
+      }
+      out->clear();
+      return;
+    }
+    not_empty_.wait(lock);
+  }
+  not_full_.notify_one();
+}
+
+size_t WorkStealingReader::StolenNum() const {
+  std::lock_guard<std::mutex> lock(queue_mu_);
+  return stolen_num_;
+}
+
+void WorkStealingReader::ReadNextImpl(std::vector<framework::LoDTensor>* out) {
+  ReadNextForDevice(out, 0);
+}
+
+void WorkStealingReader::ShutdownImpl() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mu_);
+    closed_ = true;
+  }
+  not_full_.notify_all();
+  not_empty_.notify_all();
+  // Unblock the prefetch thread if it waits for the underlying reader.
+  reader_->Shutdown();
+  if (prefetch_thread_.joinable()) {
+    prefetch_thread_.join();
+  }
+  std::lock_guard<std::mutex> lock(queue_mu_);
+  for (auto& queue : queues_) {
+    queue.clear();
+  }
+  eof_ = false;
+  exception_ = nullptr;
+}
+
+void WorkStealingReader::StartImpl() {
+  reader_->Start();
+  {
+    std::lock_guard<std::mutex> lock(queue_mu_);
+    closed_ = false;
+  }
+  prefetch_thread_ = std::thread([this] { PrefetchThreadFunc(); });
+}
+
+void WorkStealingReader::PrefetchThreadFunc() {
+  std::exception_ptr exception;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(queue_mu_);
+      not_full_.wait(lock, [this] {
+        return closed_ || queues_[ShortestQueue()].size() < buffer_size_;
+      });
+      if (closed_) return;
+    }
+    Batch batch;
+    try {
+      reader_->ReadNext(&batch);
+    } catch (...) {
+      exception = std::current_exception();
+    }
+    std::lock_guard<std::mutex> lock(queue_mu_);
+    if (closed_) return;
+    if (exception || batch.empty()) {
+      eof_ = true;
+      exception_ = exception;
+      not_empty_.notify_all();
+      return;
+    }
+    last_push_ = ShortestQueue();
+    queues_[last_push_].push_back(std::move(batch));
+    not_empty_.notify_all();
+  }
+}
+
+size_t WorkStealingReader::ShortestQueue() const {
+  size_t first = (last_push_ + 1) % queues_.size();
+  size_t best = first;
+  for (size_t i = 1; i < queues_.size(); ++i) {
+    size_t j = (first + i) % queues_.size();
+    if (queues_[j].size() < queues_[best].size()) best = j;
+  }
+  return best;
+}
+
+size_t WorkStealingReader::LongestQueue() const {
+  size_t first = (last_push_ + 1) % queues_.size();
+  size_t best = first;
+  for (size_t i = 1; i < queues_.size(); ++i) {
+    size_t j = (first + i) % queues_.size();
+    if (queues_[j].size() > queues_[best].size()) best = j;
+  }
+  return best;
+}
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
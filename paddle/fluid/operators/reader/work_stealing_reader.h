@@ -0,0 +1,95 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+#include "paddle/fluid/framework/reader.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+/*
+ * Prefetch the batches of the underlying reader into a queue per place of
+ * ParallelExecutor, so that the places do not wait for each other to read.
+ *
+ * A thread reads the batches ahead, and pushes each of them to the shortest
+ * queue, until every queue holds buffer_size batches. A place pops the
+ * oldest batch of its own queue, and only if that is empty, it steals the
+ * newest batch of the longest queue of the other places. So the places
+ * which run faster, or read less data, take whole batches from the others
+ * without a barrier, and there is nothing to balance when the queues are
+ * balanced. The places read empty batches once the data and all the queues
+ * run dry.
+ *
+ * The batches are held in the queues until they are read, so the underlying
+ * reader should not reuse the memory of the batches it yields, as the
+ * double buffer reader does.
+ */
+class WorkStealingReader : public framework::DecoratedReader {
+ public:
+  WorkStealingReader(const std::shared_ptr<ReaderBase>& reader,
+                     size_t place_num, size_t buffer_size);
+
+  ~WorkStealingReader() override;
+
+  void ReadNextForDevice(std::vector<framework::LoDTensor>* out,
+                         size_t device_id) override;
+
+  // The number of the batches stolen from the queues of the other places.
+  size_t StolenNum() const;
+
+ private:
+  using Batch = std::vector<framework::LoDTensor>;
+
+  void ReadNextImpl(std::vector<framework::LoDTensor>* out) override;
+
+  void ShutdownImpl() override;
+
+  void StartImpl() override;
+
+  void PrefetchThreadFunc();
+
+  // The index of the shortest queue, or of the longest one. The ties are
+  // broken by the place of the last push, so that the pushes go round the
+  // places when the queues are balanced.
+  size_t ShortestQueue() const;
+  size_t LongestQueue() const;
+
+  const size_t buffer_size_;
+
+  mutable std::mutex queue_mu_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
+  std::vector<std::deque<Batch>> queues_;
+  size_t last_push_{0};
+  size_t stolen_num_{0};
+  // Whether the prefetch thread has finished, and why if it failed.
+  bool eof_{false};
+  std::exception_ptr exception_;
+  bool closed_{false};
+
+  std::thread prefetch_thread_;
+};
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
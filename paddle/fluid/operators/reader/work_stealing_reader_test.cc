@@ -0,0 +1,116 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/reader/work_stealing_reader.h"
+#include <algorithm>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+
+using paddle::framework::LoDTensor;
+using paddle::framework::make_ddim;
+using paddle::operators::reader::WorkStealingReader;
+
+// Yields a batch of the value i for the i in [0, num).
+class StubBatchReader : public paddle::framework::ReaderBase {
+ public:
+  explicit StubBatchReader(int num) : num_(num) {}
+
+  void ReadNextImpl(std::vector<LoDTensor>* out) override {
+    out->clear();
+    if (next_ >= num_) return;
+    LoDTensor batch;
+    *batch.mutable_data<int>(make_ddim({1}), paddle::platform::CPUPlace()) =
+        next_++;
+    out->push_back(batch);
+  }
+
+  void StartImpl() override { next_ = 0; }
+
+ private:
+  int num_;
+  int next_{0};
+};
+
+// Reads the batches of the device till the reader runs dry.
+static std::vector<int> ReadBatches(WorkStealingReader* reader,
+                                    size_t device_id) {
+  std::vector<int> values;
+  while (true) {
+    std::vector<LoDTensor> out;
+    reader->ReadNextForDevice(&out, device_id);
+    if (out.empty()) break;
+    EXPECT_EQ(out.size(), 1UL);
+    values.push_back(out[0].data<int>()[0]);
+  }
+  return values;
+}
+
+static std::shared_ptr<WorkStealingReader> MakeReader(int num,
+                                                      size_t place_num,
+                                                      size_t buffer_size) {
+  auto root = std::make_shared<StubBatchReader>(num);
+  return std::dynamic_pointer_cast<WorkStealingReader>(
+      paddle::framework::MakeDecoratedReader<WorkStealingReader>(
+          root, place_num, buffer_size));
+}
+
+TEST(WorkStealingReader, ReadEveryBatchOnce) {
+  auto reader = MakeReader(1000, 4, 2);
+  std::vector<std::vector<int>> values(4);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 4; ++i) {
+    threads.emplace_back(
+        [&reader, &values, i] { values[i] = ReadBatches(reader.get(), i); });
+  }
+  for (auto& thread : threads) thread.join();
+
+  std::vector<int> all;
+  for (auto& place_values : values) {
+    all.insert(all.end(), place_values.begin(), place_values.end());
+  }
+  std::sort(all.begin(), all.end());
+  ASSERT_EQ(all.size(), 1000UL);
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(all[i], i);
+  }
+}
+
+TEST(WorkStealingReader, StealFromIdlePlaces) {
+  // Only the place 0 reads, so it steals the batches pushed to the others.
+  auto reader = MakeReader(100, 3, 4);
+  auto values = ReadBatches(reader.get(), 0);
+  ASSERT_EQ(values.size(), 100UL);
+  std::sort(values.begin(), values.end());
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(values[i], i);
+  }
+  EXPECT_GT(reader->StolenNum(), 0UL);
+  EXPECT_LT(reader->StolenNum(), 100UL);
+}
+
+TEST(WorkStealingReader, Restart) {
+  auto reader = MakeReader(10, 2, 2);
+  std::vector<LoDTensor> out;
+  reader->ReadNext(&out);
+  ASSERT_EQ(out.size(), 1UL);
+  reader->Shutdown();
+  reader->Start();
+  std::vector<int> values = ReadBatches(reader.get(), 1);
+  EXPECT_EQ(values.size(), 10UL);
+  out.clear();
+  reader->ReadNext(&out);
+  EXPECT_TRUE(out.empty());
+}
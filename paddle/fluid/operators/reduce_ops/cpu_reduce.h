@@ -0,0 +1,152 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "paddle/fluid/framework/compute_pool.h"
+#include "paddle/fluid/framework/tensor.h"
+
+namespace paddle {
+namespace operators {
+
+namespace detail {
+
+// Sum a contiguous row by several accumulators, so that the loop is
+// vectorized without reordering a single sum.
+template <typename T>
+inline T SumRow(const T* x, int64_t n) {
+  constexpr int kLanes = 8;
+  T acc[kLanes];
+  std::fill(acc, acc + kLanes, static_cast<T>(0));
+  int64_t i = 0;
+  for (; i + kLanes <= n; i += kLanes) {
+    for (int k = 0; k < kLanes; ++k) acc[k] += x[i + k];
+  }
+  T sum = static_cast<T>(0);
+  for (; i < n; ++i) sum += x[i];
+  for (int k = 0; k < kLanes; ++k) sum += acc[k];
+  return sum;
+}
+
+// y[0 : n] += x[0 : n]
+template <typename T>
+inline void AddRow(const T* x, int64_t n, T* y) {
+  for (int64_t i = 0; i < n; ++i) y[i] += x[i];
+}
+
+}  // namespace detail
+
+// Sum X over reduce_dims into Y, and divide the sums by the number of the
+// reduced elements if mean. The adjacent dims which are both reduced or
+// both kept are merged first, and
+//  - (outer, reduce) is summed by rows,
+//  - (outer, reduce, inner) is summed by adding the rows of inner,
+//  - the other patterns are walked in the memory order of X,
+// so that X is read contiguously without a transpose.
+template <typename T>
+void CPUReduceSum(const framework::Tensor& x,
+                  const std::vector<int>& reduce_dims, bool mean,
+                  framework::Tensor* y) {
+  auto x_dims = framework::vectorize(x.dims());
+  int rank = static_cast<int>(x_dims.size());
+  std::vector<bool> is_reduced(rank, false);
+  for (auto d : reduce_dims) {
+    is_reduced[d >= 0 ? d : d + rank] = true;
+  }
+
+  std::vector<int64_t> dims;
+  std::vector<bool> reduced;
+  int64_t reduce_num = 1;
+  for (int i = 0; i < rank; ++i) {
+    if (is_reduced[i]) reduce_num *= x_dims[i];
+    if (x_dims[i] == 1) continue;
+    if (!dims.empty() && reduced.back() == is_reduced[i]) {
+      dims.back() *= x_dims[i];
+    } else {
+      dims.push_back(x_dims[i]);
+      reduced.push_back(is_reduced[i]);
+    }
+  }
+
+  const T* x_data = x.data<T>();
+  T* y_data = y->mutable_data<T>(platform::CPUPlace());
+  int64_t y_num = y->numel();
+  int merged_rank = static_cast<int>(dims.size());
+
+  if (merged_rank == 0 || (merged_rank == 1 && reduced[0])) {
+    y_data[0] = detail::SumRow(x_data, x.numel());
+  } else if (merged_rank == 1) {
+    std::copy(x_data, x_data + y_num, y_data);
+  } else if (merged_rank == 2 && reduced[1]) {
+    int64_t n = dims[1];
+    framework::ParallelForEach(y_num, framework::GrainSize(n), [&](int64_t i) {
+      y_data[i] = detail::SumRow(x_data + i * n, n);
+    });
+  } else if (merged_rank <= 3 && reduced[merged_rank - 2]) {
+    int64_t outer_num = merged_rank == 3 ? dims[0] : 1;
+    int64_t n = dims[merged_rank - 2];
+    int64_t inner_num = dims[merged_rank - 1];
+    framework::ParallelForEach(
+        outer_num, framework::GrainSize(n * inner_num), [&](int64_t i) {
+          T* y_row = y_data + i * inner_num;
+          std::fill(y_row, y_row + inner_num, static_cast<T>(0));
+          for (int64_t j = 0; j < n; ++j) {
+            detail::AddRow(x_data + (i * n + j) * inner_num, inner_num,
+                           y_row);
+          }
+        });
+  } else {
+    // Walk the rows of the last dim in the memory order of X, and keep the
+    // offset of Y of the current row of X.
+    std::vector<int64_t> y_strides(merged_rank, 0);
+    int64_t y_stride = 1;
+    for (int i = merged_rank - 1; i >= 0; --i) {
+      if (!reduced[i]) {
+        y_strides[i] = y_stride;
+        y_stride *= dims[i];
+      }
+    }
+    std::fill(y_data, y_data + y_num, static_cast<T>(0));
+    int64_t row_numel = dims.back();
+    int64_t num_rows = x.numel() / row_numel;
+    std::vector<int64_t> index(merged_rank, 0);
+    int64_t y_offset = 0;
+    for (int64_t row = 0; row < num_rows; ++row) {
+      const T* x_row = x_data + row * row_numel;
+      if (reduced.back()) {
+        y_data[y_offset] += detail::SumRow(x_row, row_numel);
+      } else {
+        detail::AddRow(x_row, row_numel, y_data + y_offset);
+      }
+      for (int d = merged_rank - 2; d >= 0; --d) {
+        y_offset += y_strides[d];
+        if (++index[d] < dims[d]) break;
+        y_offset -= y_strides[d] * dims[d];
+        index[d] = 0;
+      }
+    }
+  }
+
+  if (mean) {
+    for (int64_t i = 0; i < y_num; ++i) {
+      y_data[i] /= static_cast<T>(reduce_num);
+    }
+  }
+}
+
+}  // namespace operators
+}  // namespace paddle
@@ -18,6 +18,7 @@
 #include <cmath>
 #include <numeric>
 #include <set>
+#include <type_traits>
 #include <vector>
 
 #include <cub/cub.cuh>  // NOLINT
@@ -27,6 +28,23 @@
 namespace paddle {
 namespace operators {
 
+template <typename T>
+struct IdentityFunctor {
+  HOSTDEVICE explicit inline IdentityFunctor() {}
+
+  HOSTDEVICE inline T operator()(const T& x) const { return x; }
+};
+
+template <typename T>
+struct DivideFunctor {
+  HOSTDEVICE explicit inline DivideFunctor(int n) : n_inv((T)(1.0 / n)) {}
+
+  HOSTDEVICE inline T operator()(const T& x) const { return x * n_inv; }
+
+ private:
+  T n_inv;
+};
+
 namespace detail {
 template <typename T, size_t ElementCount>
 struct Array {
@@ -54,6 +72,11 @@ struct Array {
   T data_[ElementCount];
 };
 
+constexpr int kWarpReduceBlockDim = 128;
+constexpr int kWarpReduceMaxNum = 256;
+constexpr int kColumnReduceBlockDim = 256;
+constexpr int kMaxGridDimY = 65535;
+
 // reduce the last axis of 2d array
 template <typename Tx, typename Ty, typename ReduceOp, typename TransformOp,
           int BlockDim>
@@ -122,6 +145,72 @@ __global__ void ReduceKernel(const Tx* x, Ty* y, ReduceOp reducer,
   }
 }
 
+// reduce the last axis of 2d array by a warp per row, for the short rows
+template <typename Tx, typename Ty, typename ReduceOp, typename TransformOp>
+__global__ void ReduceLastDimWarpKernel(const Tx* x, Ty* y, ReduceOp reducer,
+                                        TransformOp transformer, Ty init,
+                                        int left_num, int reduce_num) {
+  constexpr int kWarpsPerBlock = kWarpReduceBlockDim / 32;
+  __shared__ typename cub::WarpReduce<Ty>::TempStorage
+      temp_storage[kWarpsPerBlock];
+  int warp_id = threadIdx.x / 32;
+  int lane = threadIdx.x % 32;
+  for (int row = blockIdx.x * kWarpsPerBlock + warp_id; row < left_num;
+       row += gridDim.x * kWarpsPerBlock) {
+    const Tx* x_row = x + static_cast<int64_t>(row) * reduce_num;
+    Ty reduce_var = init;
+    for (int i = lane; i < reduce_num; i += 32) {
+      reduce_var = reducer(reduce_var, transformer(x_row[i]));
+    }
+    reduce_var = cub::WarpReduce<Ty>(temp_storage[warp_id])
+                     .Reduce(reduce_var, reducer);
+    if (lane == 0) y[row] = reduce_var;
+  }
+}
+
+// reduce the middle axis of 3d array (outer, reduce, inner). The threads of
+// a block run along the inner axis, so that the loads are coalesced, and
+// split the reduce axis by blockDim.y.
+template <typename Tx, typename Ty, typename ReduceOp, typename TransformOp>
+__global__ void ReduceMiddleDimKernel(const Tx* x, Ty* y, ReduceOp reducer,
+                                      TransformOp transformer, Ty init,
+                                      int outer_num, int reduce_num,
+                                      int inner_num) {
+  __shared__ typename std::aligned_storage<
+      sizeof(Ty) * kColumnReduceBlockDim, alignof(Ty)>::type smem_storage;
+  Ty* smem = reinterpret_cast<Ty*>(&smem_storage);
+  int inner_idx = blockIdx.x * blockDim.x + threadIdx.x;
+  int smem_idx = threadIdx.y * blockDim.x + threadIdx.x;
+  for (int outer_idx = blockIdx.y; outer_idx < outer_num;
+       outer_idx += gridDim.y) {
+    Ty reduce_var = init;
+    if (inner_idx < inner_num) {
+      const Tx* x_col =
+          x + static_cast<int64_t>(outer_idx) * reduce_num * inner_num +
+          inner_idx;
+      for (int i = threadIdx.y; i < reduce_num; i += blockDim.y) {
+        reduce_var = reducer(
+            reduce_var,
+            transformer(x_col[static_cast<int64_t>(i) * inner_num]));
+      }
+    }
+    smem[smem_idx] = reduce_var;
+    __syncthreads();
+    for (int stride = blockDim.y / 2; stride > 0; stride >>= 1) {
+      if (threadIdx.y < stride) {
+        smem[smem_idx] =
+            reducer(smem[smem_idx], smem[smem_idx + stride * blockDim.x]);
+      }
+      __syncthreads();
+    }
+    if (threadIdx.y == 0 && inner_idx < inner_num) {
+      y[static_cast<int64_t>(outer_idx) * inner_num + inner_idx] =
+          smem[threadIdx.x];
+    }
+    __syncthreads();
+  }
+}
+
 static inline std::vector<int> GetStrides(const std::vector<int>& dims) {
   int n = static_cast<int>(dims.size());
   if (n == 0) return std::vector<int>();
@@ -197,19 +286,34 @@ static void TensorReduceImpl(
                               reduce_num, reducer, init, stream);
     return;
   }
-  if (rank == 2 && reduce_rank == 1 && reduce_dim[0] == 1) {
-    ReduceKernel2D<Tx, Ty, ReduceOp, TransformOp,
-                   BlockDim><<<left_num, BlockDim, 0, stream>>>(
-        x_data, y_data, reducer, transformer, init, reduce_num);
-    return;
-  }
-  /*
-  if (rank == 3 && reduce_rank == 1 && reduce_dim[0] == 1) {
-    // TODO(liangdun): we can optimize 3d case which the 2nd axis is reduced.
-    // Currently, it is handled by code below, but inefficient
+  if (reduce_rank == 1) {
+    // The adjacent axes are merged, so x is (outer, reduce, inner) here.
+    int inner_num = x_strides[reduce_dim[0]];
+    int outer_num = left_num / inner_num;
+    if (inner_num == 1 && reduce_num <= kWarpReduceMaxNum) {
+      constexpr int kWarpsPerBlock = kWarpReduceBlockDim / 32;
+      int grid_dim = (left_num + kWarpsPerBlock - 1) / kWarpsPerBlock;
+      ReduceLastDimWarpKernel<Tx, Ty, ReduceOp,
+                              TransformOp><<<grid_dim, kWarpReduceBlockDim, 0,
+                                             stream>>>(
+          x_data, y_data, reducer, transformer, init, left_num, reduce_num);
+    } else if (inner_num == 1) {
+      ReduceKernel2D<Tx, Ty, ReduceOp, TransformOp,
+                     BlockDim><<<left_num, BlockDim, 0, stream>>>(
+          x_data, y_data, reducer, transformer, init, reduce_num);
+    } else {
+      int block_x = std::min(32, 1 << static_cast<int>(
+                                     std::ceil(std::log2(inner_num))));
+      dim3 block(block_x, kColumnReduceBlockDim / block_x);
+      dim3 grid((inner_num + block_x - 1) / block_x,
+                std::min(outer_num, kMaxGridDimY));
+      ReduceMiddleDimKernel<Tx, Ty, ReduceOp,
+                            TransformOp><<<grid, block, 0, stream>>>(
+          x_data, y_data, reducer, transformer, init, outer_num, reduce_num,
+          inner_num);
+    }
     return;
   }
-  */
 
   switch (rank) {
     CUB_RANK_CASE(2, CUB_REDUCE_RANK_CASE(1););
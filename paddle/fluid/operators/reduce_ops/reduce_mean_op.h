@@ -26,6 +26,12 @@ struct MeanFunctor {
   }
 };
 
+template <>
+struct CPUReduceSumTraits<MeanFunctor> {
+  static constexpr bool kSum = true;
+  static constexpr bool kMean = true;
+};
+
 struct MeanGradFunctor {
   template <typename DeviceContext, typename X, typename Y, typename DX,
             typename DY, typename Dim>
@@ -15,14 +15,24 @@ limitations under the License. */
 #pragma once
 
 #include <algorithm>
+#include <numeric>
 #include <string>
 #include <vector>
 
+#include "paddle/fluid/operators/reduce_ops/cpu_reduce.h"
 #include "paddle/fluid/operators/reduce_ops/reduce_op_function.h"
 
 namespace paddle {
 namespace operators {
 
+// The reduce functors which sum, i.e. sum and mean, are reduced by
+// CPUReduceSum instead of Eigen on CPU.
+template <typename Functor>
+struct CPUReduceSumTraits {
+  static constexpr bool kSum = false;
+  static constexpr bool kMean = false;
+};
+
 #define HANDLE_DIM(NDIM, RDIM)                                            \
   if (ndim == NDIM && rdim == RDIM) {                                     \
     ReduceFunctor<DeviceContext, T, NDIM, RDIM, Functor>(                 \
@@ -42,6 +52,18 @@ class ReduceKernel : public framework::OpKernel<T> {
     auto dims = context.Attr<std::vector<int>>("dim");
     bool keep_dim = context.Attr<bool>("keep_dim");
 
+    if (CPUReduceSumTraits<Functor>::kSum &&
+        platform::is_cpu_place(context.GetPlace())) {
+      std::vector<int> reduce_dims = dims;
+      if (reduce_all) {
+        reduce_dims.resize(input->dims().size());
+        std::iota(reduce_dims.begin(), reduce_dims.end(), 0);
+      }
+      CPUReduceSum<T>(*input, reduce_dims, CPUReduceSumTraits<Functor>::kMean,
+                      output);
+      return;
+    }
+
     if (reduce_all) {
       // Flatten and reduce 1-D tensor
       auto x = EigenVector<T>::Flatten(*input);
@@ -18,13 +18,6 @@
 namespace paddle {
 namespace operators {
 
-template <typename T>
-struct IdentityFunctor {
-  HOSTDEVICE explicit inline IdentityFunctor() {}
-
-  HOSTDEVICE inline T operator()(const T& x) const { return x; }
-};
-
 template <typename T>
 class ReduceSumKernel : public framework::OpKernel<T> {
  public:
@@ -84,6 +84,12 @@ struct SumFunctor {
   }
 };
 
+template <>
+struct CPUReduceSumTraits<SumFunctor> {
+  static constexpr bool kSum = true;
+  static constexpr bool kMean = false;
+};
+
 struct SumGradFunctor {
   template <typename DeviceContext, typename X, typename Y, typename DX,
             typename DY, typename Dim>
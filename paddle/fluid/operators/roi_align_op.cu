@@ -33,43 +33,6 @@ static inline int NumBlocks(const int N) {
   for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < (n); \
        i += blockDim.x * gridDim.x)
 
-template <class T>
-__device__ T BilinearInterpolate(const T* input_data, const int height,
-                                 const int width, T y, T x) {
-  if (y < -1.0 || y > height || x < -1.0 || x > width) {
-    return 0;
-  }
-  y = y <= 0 ? 0 : y;
-  x = x <= 0 ? 0 : x;
-  int y_low = static_cast<int>(y);
-  int x_low = static_cast<int>(x);
-  int y_high;
-  int x_high;
-  if (y_low >= height - 1) {
-    y_high = y_low = height - 1;
-    y = static_cast<T>(y_low);
-  } else {
-    y_high = y_low + 1;
-  }
-  if (x_low >= width - 1) {
-    x_high = x_low = width - 1;
-    x = static_cast<T>(x_low);
-  } else {
-    x_high = x_low + 1;
-  }
-  T ly = y - y_low, lx = x - x_low;
-  T hy = 1. - ly, hx = 1. - lx;
-
-  T v1 = input_data[y_low * width + x_low];
-  T v2 = input_data[y_low * width + x_high];
-  T v3 = input_data[y_high * width + x_low];
-  T v4 = input_data[y_high * width + x_high];
-  T w1 = hy * hx, w2 = hy * lx, w3 = ly * hx, w4 = ly * lx;
-
-  T val = (w1 * v1 + w2 * v2 + w3 * v3 + w4 * v4);
-  return val;
-}
-
 template <class T>
 __device__ void BilinearInterpolateGradient(const int height, const int width,
                                             T y, T x, T* w1, T* w2, T* w3,
@@ -102,55 +65,145 @@ __device__ void BilinearInterpolateGradient(const int height, const int width,
   return;
 }
 
-template <class T>
-__global__ void GPUROIAlignForward(
-    const int nthreads, const T* input_data, const T* input_rois,
-    const float spatial_scale, const int channels, const int height,
-    const int width, const int pooled_height, const int pooled_width,
-    const int sampling_ratio, int* roi_batch_id_data, T* output_data) {
-  CUDA_1D_KERNEL_LOOP(i, nthreads) {
-    int pw = i % pooled_width;
-    int ph = (i / pooled_width) % pooled_height;
-    int c = (i / pooled_width / pooled_height) % channels;
-    int n = i / pooled_width / pooled_height / channels;
+// The max number of the elements of the feature tile staged in the shared
+// memory by GPUROIAlignForward, a RoI whose tile is larger reads the feature
+// map in the global memory directly.
+static constexpr int kROIAlignTileSize = 1024;
+static constexpr int kROIAlignThreads = 64;
 
-    const T* offset_input_rois = input_rois + n * kROISize;
-    int roi_batch_ind = roi_batch_id_data[n];
+// The bilinear interpolation of the point (y, x) of the feature map of
+// [height, width], whose rows [y0, ...) and columns [x0, ...) are stored in
+// data with the row stride of stride.
+template <class T>
+__device__ T BilinearInterpolateTile(const T* data, const int height,
+                                     const int width, const int y0,
+                                     const int x0, const int stride, T y,
+                                     T x) {
+  if (y < -1.0 || y > height || x < -1.0 || x > width) {
+    return 0;
+  }
+  y = y <= 0 ? 0 : y;
+  x = x <= 0 ? 0 : x;
+  int y_low = static_cast<int>(y);
+  int x_low = static_cast<int>(x);
+  int y_high;
+  int x_high;
+  if (y_low >= height - 1) {
+    y_high = y_low = height - 1;
+    y = static_cast<T>(y_low);
+  } else {
+    y_high = y_low + 1;
+  }
+  if (x_low >= width - 1) {
+    x_high = x_low = width - 1;
+    x = static_cast<T>(x_low);
+  } else {
+    x_high = x_low + 1;
+  }
+  T ly = y - y_low, lx = x - x_low;
+  T hy = 1. - ly, hx = 1. - lx;
 
-    T roi_xmin = offset_input_rois[0] * spatial_scale;
-    T roi_ymin = offset_input_rois[1] * spatial_scale;
-    T roi_xmax = offset_input_rois[2] * spatial_scale;
-    T roi_ymax = offset_input_rois[3] * spatial_scale;
+  y_low -= y0, y_high -= y0, x_low -= x0, x_high -= x0;
+  T v1 = data[y_low * stride + x_low];
+  T v2 = data[y_low * stride + x_high];
+  T v3 = data[y_high * stride + x_low];
+  T v4 = data[y_high * stride + x_high];
+  T w1 = hy * hx, w2 = hy * lx, w3 = ly * hx, w4 = ly * lx;
 
-    T roi_width = max(roi_xmax - roi_xmin, static_cast<T>(1.));
-    T roi_height = max(roi_ymax - roi_ymin, static_cast<T>(1.));
-    T bin_size_h = static_cast<T>(roi_height) / static_cast<T>(pooled_height);
-    T bin_size_w = static_cast<T>(roi_width) / static_cast<T>(pooled_width);
+  T val = (w1 * v1 + w2 * v2 + w3 * v3 + w4 * v4);
+  return val;
+}
 
+// Every block pools the channels [blockIdx.y, ...) of the RoI blockIdx.x, and
+// the part of the feature map the samples of the RoI interpolate, which is
+// shared by the neighboring bins, is staged in the shared memory once for
+// every channel. The image of the RoI is searched in the LoD of the RoIs.
+template <class T>
+__global__ void GPUROIAlignForward(
+    const T* input_data, const T* input_rois, const size_t* rois_lod,
+    const int batch_size, const float spatial_scale, const int channels,
+    const int height, const int width, const int pooled_height,
+    const int pooled_width, const int sampling_ratio, T* output_data) {
+  __shared__ T tile[kROIAlignTileSize];
+  const int n = blockIdx.x;
+  int low = 0, high = batch_size;
+  while (high - low > 1) {
+    int mid = (low + high) / 2;
+    if (rois_lod[mid] <= n) {
+      low = mid;
+    } else {
+      high = mid;
+    }
+  }
+  const int roi_batch_ind = low;
+
+  const T* offset_input_rois = input_rois + n * kROISize;
+  T roi_xmin = offset_input_rois[0] * spatial_scale;
+  T roi_ymin = offset_input_rois[1] * spatial_scale;
+  T roi_xmax = offset_input_rois[2] * spatial_scale;
+  T roi_ymax = offset_input_rois[3] * spatial_scale;
+
+  T roi_width = max(roi_xmax - roi_xmin, static_cast<T>(1.));
+  T roi_height = max(roi_ymax - roi_ymin, static_cast<T>(1.));
+  T bin_size_h = static_cast<T>(roi_height) / static_cast<T>(pooled_height);
+  T bin_size_w = static_cast<T>(roi_width) / static_cast<T>(pooled_width);
+
+  int roi_bin_grid_h = (sampling_ratio > 0) ? sampling_ratio
+                                            : ceil(roi_height / pooled_height);
+  int roi_bin_grid_w =
+      (sampling_ratio > 0) ? sampling_ratio : ceil(roi_width / pooled_width);
+  const T count = roi_bin_grid_h * roi_bin_grid_w;
+
+  // All the samples are in [roi_ymin, roi_ymin + roi_height) and
+  // [roi_xmin, roi_xmin + roi_width), so they only interpolate the rows
+  // [y0, y1] and the columns [x0, x1], with one more row and column for the
+  // rounding of the samples.
+  int y0 = min(max(static_cast<int>(floor(roi_ymin)), 0), height - 1);
+  int x0 = min(max(static_cast<int>(floor(roi_xmin)), 0), width - 1);
+  int y1 = max(
+      min(static_cast<int>(floor(roi_ymin + roi_height)) + 2, height - 1), y0);
+  int x1 = max(
+      min(static_cast<int>(floor(roi_xmin + roi_width)) + 2, width - 1), x0);
+  const int tile_h = y1 - y0 + 1;
+  const int tile_w = x1 - x0 + 1;
+  const bool use_tile = tile_h * tile_w <= kROIAlignTileSize;
+
+  const int pooled_size = pooled_height * pooled_width;
+  for (int c = blockIdx.y; c < channels; c += gridDim.y) {
     const T* offset_input_data =
         input_data + (roi_batch_ind * channels + c) * height * width;
+    const T* data = offset_input_data;
+    int data_y0 = 0, data_x0 = 0, stride = width;
+    if (use_tile) {
+      __syncthreads();
+      for (int i = threadIdx.x; i < tile_h * tile_w; i += blockDim.x) {
+        int ty = i / tile_w;
+        int tx = i % tile_w;
+        tile[i] = offset_input_data[(y0 + ty) * width + x0 + tx];
+      }
+      __syncthreads();
+      data = tile, data_y0 = y0, data_x0 = x0, stride = tile_w;
+    }
 
-    int roi_bin_grid_h = (sampling_ratio > 0)
-                             ? sampling_ratio
-                             : ceil(roi_height / pooled_height);
-    int roi_bin_grid_w =
-        (sampling_ratio > 0) ? sampling_ratio : ceil(roi_width / pooled_width);
-    const T count = roi_bin_grid_h * roi_bin_grid_w;
-    T output_val = 0;
-    for (int iy = 0; iy < roi_bin_grid_h; iy++) {
-      const T y = roi_ymin + ph * bin_size_h +
-                  static_cast<T>(iy + .5f) * bin_size_h /
-                      static_cast<T>(roi_bin_grid_h);
-      for (int ix = 0; ix < roi_bin_grid_w; ix++) {
-        const T x = roi_xmin + pw * bin_size_w +
-                    static_cast<T>(ix + .5f) * bin_size_w /
-                        static_cast<T>(roi_bin_grid_w);
-        T val = BilinearInterpolate(offset_input_data, height, width, y, x);
-        output_val += val;
+    T* offset_output_data = output_data + (n * channels + c) * pooled_size;
+    for (int i = threadIdx.x; i < pooled_size; i += blockDim.x) {
+      int pw = i % pooled_width;
+      int ph = i / pooled_width;
+      T output_val = 0;
+      for (int iy = 0; iy < roi_bin_grid_h; iy++) {
+        const T y = roi_ymin + ph * bin_size_h +
+                    static_cast<T>(iy + .5f) * bin_size_h /
+                        static_cast<T>(roi_bin_grid_h);
+        for (int ix = 0; ix < roi_bin_grid_w; ix++) {
+          const T x = roi_xmin + pw * bin_size_w +
+                      static_cast<T>(ix + .5f) * bin_size_w /
+                          static_cast<T>(roi_bin_grid_w);
+          output_val += BilinearInterpolateTile(data, height, width, data_y0,
+                                                data_x0, stride, y, x);
+        }
       }
+      offset_output_data[i] = output_val / count;
     }
-    output_val /= count;
-    output_data[i] = output_val;
   }
 }
 
@@ -249,14 +302,6 @@ class GPUROIAlignOpKernel : public framework::OpKernel<T> {
 
     if (rois_num == 0) return;
 
-    int output_size = out->numel();
-    int blocks = NumBlocks(output_size);
-    int threads = kNumCUDAThreads;
-
-    Tensor roi_batch_id_list;
-    roi_batch_id_list.Resize({rois_num});
-    int* roi_batch_id_data =
-        roi_batch_id_list.mutable_data<int>(platform::CPUPlace());
     auto rois_lod = rois->lod().back();
     int rois_batch_size = rois_lod.size() - 1;
     PADDLE_ENFORCE_EQ(
@@ -265,19 +310,13 @@ class GPUROIAlignOpKernel : public framework::OpKernel<T> {
     int rois_num_with_lod = rois_lod[rois_batch_size];
     PADDLE_ENFORCE_EQ(rois_num, rois_num_with_lod,
                       "The rois_num from input and lod must be the same.");
-    for (int n = 0; n < rois_batch_size; ++n) {
-      for (size_t i = rois_lod[n]; i < rois_lod[n + 1]; ++i) {
-        roi_batch_id_data[i] = n;
-      }
-    }
-    Tensor roi_batch_id_list_gpu;
-    framework::TensorCopySync(roi_batch_id_list, ctx.GetPlace(),
-                              &roi_batch_id_list_gpu);
-    GPUROIAlignForward<
-        T><<<blocks, threads, 0, ctx.cuda_device_context().stream()>>>(
-        output_size, in->data<T>(), rois->data<T>(), spatial_scale, channels,
-        height, width, pooled_height, pooled_width, sampling_ratio,
-        roi_batch_id_list_gpu.data<int>(),
+
+    dim3 blocks(rois_num, std::min(channels, 65535));
+    GPUROIAlignForward<T><<<blocks, kROIAlignThreads, 0,
+                            ctx.cuda_device_context().stream()>>>(
+        in->data<T>(), rois->data<T>(), rois_lod.CUDAData(ctx.GetPlace()),
+        rois_batch_size, spatial_scale, channels, height, width,
+        pooled_height, pooled_width, sampling_ratio,
         out->mutable_data<T>(ctx.GetPlace()));
   }
 };
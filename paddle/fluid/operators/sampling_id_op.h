@@ -17,11 +17,12 @@
 #include <algorithm>
 #include <iostream>
 #include <iterator>
-#include <random>
 #include <sstream>
 #include <vector>
 
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/platform/philox.h"
+#include "paddle/fluid/platform/philox_state.h"
 
 namespace paddle {
 namespace operators {
@@ -43,19 +44,24 @@ class SamplingIdKernel : public framework::OpKernel<T> {
     std::vector<T> ins_vector;
     framework::TensorToVector(*input, context.device_context(), &ins_vector);
 
-    unsigned int seed = static_cast<unsigned int>(context.Attr<int>("seed"));
-    std::minstd_rand engine;
-    if (seed == 0) {
-      seed = std::random_device()();
+    // The random values of the rows are drawn from the Philox stream of the
+    // device, which gives the same ids on the CPU and the GPU of a seed.
+    auto seed =
+        platform::GetPhiloxSeed(context.GetPlace(), context.Attr<int>("seed"));
+    using Distribution = platform::PhiloxUniformDistribution<T>;
+    std::vector<T> randoms(batch_size);
+    platform::PhiloxFillFunctor<T, Distribution> fill(
+        seed.seed, seed.offset,
+        Distribution(static_cast<T>(context.Attr<float>("min")),
+                     static_cast<T>(context.Attr<float>("max"))),
+        randoms.data(), randoms.size());
+    for (size_t group = 0; group < fill.NumGroups(); ++group) {
+      fill(group);
     }
-    engine.seed(seed);
-    std::uniform_real_distribution<T> dist(
-        static_cast<T>(context.Attr<float>("min")),
-        static_cast<T>(context.Attr<float>("max")));
 
     std::vector<int64_t> ids(batch_size);
     for (int i = 0; i < batch_size; ++i) {
-      T r = dist(engine);
+      T r = randoms[i];
       int idx = width - 1;
       for (int j = 0; j < width; ++j) {
         if ((r -= ins_vector[i * width + j]) < 0) {
@@ -16,9 +16,11 @@ limitations under the License. */
 #include <fstream>
 #include <numeric>
 #include <sstream>
+#include "paddle/fluid/framework/async_tensor_saver.h"
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/data_type_transform.h"
 #include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/framework/indexed_params.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/platform/device_context.h"
@@ -41,6 +43,7 @@ class SaveCombineOp : public framework::OperatorBase {
     auto filename = Attr<std::string>("file_path");
     auto overwrite = Attr<bool>("overwrite");
     auto save_as_fp16 = Attr<bool>("save_as_fp16");
+    auto indexed_format = Attr<bool>("indexed_format");
 
     bool is_present = FileExists(filename);
     if (is_present && !overwrite) {
@@ -49,14 +52,26 @@ class SaveCombineOp : public framework::OperatorBase {
     }
 
     MkDirRecursively(DirName(filename).c_str());
-    std::ofstream fout(filename, std::ios::binary);
-    PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot open %s to write",
-                   filename);
 
     auto inp_var_names = Inputs("X");
     PADDLE_ENFORCE_GT(static_cast<int>(inp_var_names.size()), 0,
                       "The number of input variables should be greater than 0");
 
+    if (Attr<bool>("async_save")) {
+      SaveAsync(scope, place, filename, inp_var_names, save_as_fp16,
+                indexed_format);
+      return;
+    }
+
+    if (indexed_format) {
+      SaveIndexed(scope, place, filename, inp_var_names, save_as_fp16);
+      return;
+    }
+
+    std::ofstream fout(filename, std::ios::binary);
+    PADDLE_ENFORCE(static_cast<bool>(fout), "Cannot open %s to write",
+                   filename);
+
     // get device context from pool
     platform::DeviceContextPool &pool = platform::DeviceContextPool::Instance();
     auto &dev_ctx = *pool.Get(place);
@@ -93,6 +108,65 @@ class SaveCombineOp : public framework::OperatorBase {
     }
     fout.close();
   }
+
+  void SaveIndexed(const framework::Scope &scope, const platform::Place &place,
+                   const std::string &filename,
+                   const std::vector<std::string> &inp_var_names,
+                   bool save_as_fp16) const {
+    // Keep the converted tensors alive until they are saved.
+    std::vector<framework::LoDTensor> fp16_tensors(inp_var_names.size());
+    auto tensors = GetTensors(scope, place, inp_var_names, save_as_fp16,
+                              &fp16_tensors);
+    framework::SaveIndexedParams(filename, inp_var_names, tensors);
+  }
+
+  // Snapshot the tensors here, and write them in the background.
+  void SaveAsync(const framework::Scope &scope, const platform::Place &place,
+                 const std::string &filename,
+                 const std::vector<std::string> &inp_var_names,
+                 bool save_as_fp16, bool indexed_format) const {
+    std::vector<framework::LoDTensor> fp16_tensors(inp_var_names.size());
+    auto tensors = GetTensors(scope, place, inp_var_names, save_as_fp16,
+                              &fp16_tensors);
+    auto &dev_ctx = *platform::DeviceContextPool::Instance().Get(place);
+    framework::AsyncTensorSaver::Instance().Save(
+        filename, inp_var_names, tensors, dev_ctx, indexed_format);
+    // The converted tensors are freed here, after they are copied.
+    if (save_as_fp16 && platform::is_gpu_place(place)) {
+      dev_ctx.Wait();
+    }
+  }
+
+  std::vector<const framework::LoDTensor *> GetTensors(
+      const framework::Scope &scope, const platform::Place &place,
+      const std::vector<std::string> &inp_var_names, bool save_as_fp16,
+      std::vector<framework::LoDTensor> *fp16_tensors) const {
+    std::vector<const framework::LoDTensor *> tensors;
+    for (size_t i = 0; i < inp_var_names.size(); i++) {
+      auto *var = scope.FindVar(inp_var_names[i]);
+
+      PADDLE_ENFORCE(var != nullptr,
+                     "Cannot find variable %s for save_combine_op",
+                     inp_var_names[i]);
+      PADDLE_ENFORCE(var->IsType<framework::LoDTensor>(),
+                     "SaveCombineOp only supports LoDTensor, %s has wrong type",
+                     inp_var_names[i]);
+
+      auto &tensor = var->Get<framework::LoDTensor>();
+      if (save_as_fp16 && tensor.type() != framework::proto::VarType::FP16) {
+        auto in_kernel_type = framework::OpKernelType(tensor.type(), place);
+        auto out_kernel_type =
+            framework::OpKernelType(framework::proto::VarType::FP16, place);
+        (*fp16_tensors)[i].set_lod(tensor.lod());
+        framework::TransDataType(in_kernel_type, out_kernel_type, tensor,
+                                 &(*fp16_tensors)[i]);
+        tensors.push_back(&(*fp16_tensors)[i]);
+      } else {
+        tensors.push_back(&tensor);
+      }
+    }
+    return tensors;
+  }
 };
 
 class SaveCombineOpProtoMaker : public framework::OpProtoAndCheckerMaker {
@@ -118,6 +192,19 @@ to a file on disk.
                   "type and then saved. Otherwise, the tensor will be "
                   "directly saved without data type conversion.")
         .SetDefault(false);
+    AddAttr<bool>("indexed_format",
+                  "(boolean, default false)"
+                  "If true, the file is saved in the indexed format, which "
+                  "starts with an index of the tensors by name and aligns "
+                  "their data, so that they can be loaded in any order, in "
+                  "parallel, or partially.")
+        .SetDefault(false);
+    AddAttr<bool>("async_save",
+                  "(boolean, default false)"
+                  "If true, the tensors are snapshotted and the file is "
+                  "written in the background, see "
+                  "fluid.io.wait_async_save.")
+        .SetDefault(false);
     AddAttr<std::string>(
         "file_path",
         "(string)"
@@ -16,6 +16,7 @@ limitations under the License. */
 #include <string>
 #include <vector>
 #include "gtest/gtest.h"
+#include "paddle/fluid/framework/async_tensor_saver.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/platform/float16.h"
 
@@ -344,3 +345,231 @@ TEST(SaveLoadTestWithCombineOp, CPU) {
     }
   }
 }
+
+// Map the file instead of reading it, the loaded tensors should be the same
+// and writable without changing the file.
+TEST(LoadCombineMmapOp, CPU) {
+  paddle::framework::Scope scope;
+  paddle::platform::CPUPlace place;
+
+  std::vector<int> lod1 = {0, 1, 2, 3, 10};
+  int numel1 = 100;
+  paddle::framework::LoD expect_lod1;
+  int* expect1 = CreateForSaveCombineOp<int, int>(10, 10, lod1, "test_var1",
+                                                  place, &scope, &expect_lod1);
+
+  std::vector<int> lod2 = {0, 2, 5, 10};
+  int numel2 = 200;
+  paddle::framework::LoD expect_lod2;
+  int* expect2 = CreateForSaveCombineOp<int, int>(10, 20, lod2, "test_var2",
+                                                  place, &scope, &expect_lod2);
+
+  // Set attributes
+  std::string filename = "check_tensor_mmap.ls";
+  paddle::framework::AttributeMap attrs;
+  attrs.insert({"file_path", std::string(filename)});
+
+  // Run the save_combine_op
+  auto save_combine_op = paddle::framework::OpRegistry::CreateOp(
+      "save_combine", {{"X", {"test_var1", "test_var2"}}}, {}, attrs);
+  save_combine_op->Run(scope, place);
+
+  // Set up output vars
+  auto target1 = GeneratePlaceholderBeforeLoad("out_var1", &scope);
+  auto target2 = GeneratePlaceholderBeforeLoad("out_var2", &scope);
+
+  // Run the load_combine_op
+  attrs.insert({"use_mmap", true});
+  auto load_combine_op = paddle::framework::OpRegistry::CreateOp(
+      "load_combine", {}, {{"Out", {"out_var1", "out_var2"}}}, attrs);
+  load_combine_op->Run(scope, place);
+
+  paddle::framework::LoD actual_lod1, actual_lod2;
+  int* actual1 = GetValuesAfterLoadCombineOp<int>(target1, scope, &actual_lod1);
+  int* actual2 = GetValuesAfterLoadCombineOp<int>(target2, scope, &actual_lod2);
+
+  CheckValues<int, int>(expect1, actual1, expect_lod1, actual_lod1, numel1);
+  CheckValues<int, int>(expect2, actual2, expect_lod2, actual_lod2, numel2);
+
+  // Writing to the mapped tensor must not change the file.
+  target1->mutable_data<int>(place)[0] = -1;
+  auto target3 = GeneratePlaceholderBeforeLoad("out_var3", &scope);
+  auto target4 = GeneratePlaceholderBeforeLoad("out_var4", &scope);
+  auto reload_combine_op = paddle::framework::OpRegistry::CreateOp(
+      "load_combine", {}, {{"Out", {"out_var3", "out_var4"}}}, attrs);
+  reload_combine_op->Run(scope, place);
+
+  paddle::framework::LoD actual_lod3;
+  int* actual3 = GetValuesAfterLoadCombineOp<int>(target3, scope, &actual_lod3);
+  CheckValues<int, int>(expect1, actual3, expect_lod1, actual_lod3, numel1);
+  EXPECT_EQ(target4->numel(), numel2);
+}
+
+// Save in the indexed format, and load a part of the tensors by name in
+// another order.
+TEST(SaveLoadCombineIndexedOp, CPU) {
+  paddle::framework::Scope scope;
+  paddle::platform::CPUPlace place;
+
+  std::vector<int> lod1 = {0, 1, 2, 3, 10};
+  int numel1 = 100;
+  paddle::framework::LoD expect_lod1;
+  int* expect1 = CreateForSaveCombineOp<int, int>(10, 10, lod1, "test_var1",
+                                                  place, &scope, &expect_lod1);
+
+  std::vector<int> lod2 = {0, 2, 5, 10};
+  paddle::framework::LoD expect_lod2;
+  CreateForSaveCombineOp<int, int>(10, 20, lod2, "test_var2", place, &scope,
+                                   &expect_lod2);
+
+  std::vector<int> lod3 = {0, 2, 3, 20};
+  int numel3 = 4000;
+  paddle::framework::LoD expect_lod3;
+  int* expect3 = CreateForSaveCombineOp<int, int>(20, 200, lod3, "test_var3",
+                                                  place, &scope, &expect_lod3);
+
+  // Set attributes
+  std::string filename = "check_tensor_indexed.ls";
+  paddle::framework::AttributeMap attrs;
+  attrs.insert({"file_path", std::string(filename)});
+  attrs.insert({"indexed_format", true});
+
+  // Run the save_combine_op
+  auto save_combine_op = paddle::framework::OpRegistry::CreateOp(
+      "save_combine", {{"X", {"test_var1", "test_var2", "test_var3"}}}, {},
+      attrs);
+  save_combine_op->Run(scope, place);
+
+  // Load into the new scope, where the outputs are named as the saved ones.
+  paddle::framework::Scope load_scope;
+  auto target3 = GeneratePlaceholderBeforeLoad("test_var3", &load_scope);
+  auto target1 = GeneratePlaceholderBeforeLoad("test_var1", &load_scope);
+
+  paddle::framework::AttributeMap load_attrs;
+  load_attrs.insert({"file_path", std::string(filename)});
+  load_attrs.insert({"num_threads", 2});
+  auto load_combine_op = paddle::framework::OpRegistry::CreateOp(
+      "load_combine", {}, {{"Out", {"test_var3", "test_var1"}}}, load_attrs);
+  load_combine_op->Run(load_scope, place);
+
+  paddle::framework::LoD actual_lod1, actual_lod3;
+  int* actual1 =
+      GetValuesAfterLoadCombineOp<int>(target1, load_scope, &actual_lod1);
+  int* actual3 =
+      GetValuesAfterLoadCombineOp<int>(target3, load_scope, &actual_lod3);
+
+  CheckValues<int, int>(expect1, actual1, expect_lod1, actual_lod1, numel1);
+  CheckValues<int, int>(expect3, actual3, expect_lod3, actual_lod3, numel3);
+}
+
+// Load the tensors saved by save_combine on the IO thread pool.
+TEST(LoadCombineParallelOp, CPU) {
+  paddle::framework::Scope scope;
+  paddle::platform::CPUPlace place;
+
+  std::vector<int> lod1 = {0, 1, 2, 3, 10};
+  int numel1 = 100;
+  paddle::framework::LoD expect_lod1;
+  int* expect1 = CreateForSaveCombineOp<int, int>(10, 10, lod1, "test_var1",
+                                                  place, &scope, &expect_lod1);
+
+  std::vector<int> lod2 = {0, 2, 5, 10};
+  int numel2 = 200;
+  paddle::framework::LoD expect_lod2;
+  int* expect2 = CreateForSaveCombineOp<int, int>(10, 20, lod2, "test_var2",
+                                                  place, &scope, &expect_lod2);
+
+  std::vector<int> lod3 = {0, 2, 3, 20};
+  int numel3 = 4000;
+  paddle::framework::LoD expect_lod3;
+  int* expect3 = CreateForSaveCombineOp<int, int>(20, 200, lod3, "test_var3",
+                                                  place, &scope, &expect_lod3);
+
+  // Set attributes
+  std::string filename = "check_tensor_parallel.ls";
+  paddle::framework::AttributeMap attrs;
+  attrs.insert({"file_path", std::string(filename)});
+
+  // Run the save_combine_op
+  auto save_combine_op = paddle::framework::OpRegistry::CreateOp(
+      "save_combine", {{"X", {"test_var1", "test_var2", "test_var3"}}}, {},
+      attrs);
+  save_combine_op->Run(scope, place);
+
+  // Set up output vars
+  auto target1 = GeneratePlaceholderBeforeLoad("out_var1", &scope);
+  auto target2 = GeneratePlaceholderBeforeLoad("out_var2", &scope);
+  auto target3 = GeneratePlaceholderBeforeLoad("out_var3", &scope);
+
+  // Run the load_combine_op
+  attrs.insert({"num_threads", 3});
+  auto load_combine_op = paddle::framework::OpRegistry::CreateOp(
+      "load_combine", {}, {{"Out", {"out_var1", "out_var2", "out_var3"}}},
+      attrs);
+  load_combine_op->Run(scope, place);
+
+  paddle::framework::LoD actual_lod1, actual_lod2, actual_lod3;
+  int* actual1 = GetValuesAfterLoadCombineOp<int>(target1, scope, &actual_lod1);
+  int* actual2 = GetValuesAfterLoadCombineOp<int>(target2, scope, &actual_lod2);
+  int* actual3 = GetValuesAfterLoadCombineOp<int>(target3, scope, &actual_lod3);
+
+  CheckValues<int, int>(expect1, actual1, expect_lod1, actual_lod1, numel1);
+  CheckValues<int, int>(expect2, actual2, expect_lod2, actual_lod2, numel2);
+  CheckValues<int, int>(expect3, actual3, expect_lod3, actual_lod3, numel3);
+}
+
+// The asynchronous save writes the snapshot taken when save_combine runs.
+TEST(SaveLoadCombineAsyncOp, CPU) {
+  paddle::framework::Scope scope;
+  paddle::platform::CPUPlace place;
+
+  std::vector<int> lod1 = {0, 1, 2, 3, 10};
+  int numel1 = 100;
+  paddle::framework::LoD expect_lod1;
+  int* expect1 = CreateForSaveCombineOp<int, int>(10, 10, lod1, "test_var1",
+                                                  place, &scope, &expect_lod1);
+
+  std::vector<int> lod2 = {0, 2, 5, 10};
+  int numel2 = 200;
+  paddle::framework::LoD expect_lod2;
+  int* expect2 = CreateForSaveCombineOp<int, int>(10, 20, lod2, "test_var2",
+                                                  place, &scope, &expect_lod2);
+  std::vector<int> expect_values1(expect1, expect1 + numel1);
+
+  std::string filename = "check_tensor_async.ls";
+  paddle::framework::AttributeMap attrs;
+  attrs.insert({"file_path", std::string(filename)});
+  attrs.insert({"async_save", true});
+  auto save_combine_op = paddle::framework::OpRegistry::CreateOp(
+      "save_combine", {{"X", {"test_var1", "test_var2"}}}, {}, attrs);
+  save_combine_op->Run(scope, place);
+  // The updates after the save are not in the file.
+  std::fill(expect1, expect1 + numel1, -1);
+  paddle::framework::AsyncTensorSaver::Instance().Wait();
+  ASSERT_EQ(paddle::framework::AsyncTensorSaver::Instance().InFlight(), 0UL);
+
+  auto target1 = GeneratePlaceholderBeforeLoad("out_var1", &scope);
+  auto target2 = GeneratePlaceholderBeforeLoad("out_var2", &scope);
+  paddle::framework::AttributeMap load_attrs;
+  load_attrs.insert({"file_path", std::string(filename)});
+  auto load_combine_op = paddle::framework::OpRegistry::CreateOp(
+      "load_combine", {}, {{"Out", {"out_var1", "out_var2"}}}, load_attrs);
+  load_combine_op->Run(scope, place);
+
+  paddle::framework::LoD actual_lod1, actual_lod2;
+  int* actual1 = GetValuesAfterLoadCombineOp<int>(target1, scope, &actual_lod1);
+  int* actual2 = GetValuesAfterLoadCombineOp<int>(target2, scope, &actual_lod2);
+  CheckValues<int, int>(expect_values1.data(), actual1, expect_lod1,
+                        actual_lod1, numel1);
+  CheckValues<int, int>(expect2, actual2, expect_lod2, actual_lod2, numel2);
+
+  // The failure of a save is thrown by the next wait.
+  attrs["file_path"] = std::string("check_tensor_async.ls/not_a_dir/file");
+  attrs["overwrite"] = true;
+  save_combine_op = paddle::framework::OpRegistry::CreateOp(
+      "save_combine", {{"X", {"test_var1"}}}, {}, attrs);
+  ASSERT_ANY_THROW({
+    save_combine_op->Run(scope, place);
+    paddle::framework::AsyncTensorSaver::Instance().Wait();
+  });
+}
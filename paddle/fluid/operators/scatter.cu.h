@@ -13,7 +13,12 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
+#include <algorithm>
+#include <cub/cub.cuh>  // NOLINT
 #include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/platform/cuda_primitives.h"
+#include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/place.h"
 
 namespace paddle {
@@ -77,5 +82,248 @@ void GPUScatterAssign(const platform::DeviceContext& ctx, const Tensor& src,
       p_src, p_index, p_output, index_size, slice_size);
 }
 
+/*
+ * The scatter add of the gradients of gather and lookup_table, which add the
+ * rows src[i] to the rows index[i] of the output.
+ *
+ * The atomicAdd of the rows is slow for the repeated indices, the hot ids,
+ * whose adds are serialized, and its sums are in any order. The sorted
+ * scatter add sorts the indices with their positions, sums the rows of the
+ * equal indices by the chunks of at most kScatterAddChunk rows, then the
+ * chunks of every index, in the order of position, so that it is atomic free
+ * and deterministic. GPUScatterAdd counts the unique indices, and takes the
+ * sorted scatter add if the indices repeat kSortedScatterAddMinRatio times on
+ * average.
+ */
+constexpr int kScatterAddChunk = 256;
+constexpr int kSortedScatterAddMinRatio = 2;
+
+template <typename T, typename IndexT>
+__global__ void ScatterAddCUDAKernel(const T* src, const IndexT* index,
+                                     T* output, size_t index_size,
+                                     size_t slice_size) {
+  CUDA_1D_KERNEL_LOOP(i, index_size * slice_size) {
+    int indices_i = i / slice_size;
+    int slice_i = i - indices_i * slice_size;
+    platform::CudaAtomicAdd(output + index[indices_i] * slice_size + slice_i,
+                            src[i]);
+  }
+}
+
+template <typename IndexT>
+__global__ void MarkUniqueIndexCUDAKernel(const IndexT* index, int n,
+                                          unsigned int* bitmap, int* unique) {
+  CUDA_1D_KERNEL_LOOP(i, n) {
+    IndexT id = index[i];
+    unsigned int bit = 1u << (id & 31);
+    if (!(atomicOr(&bitmap[id >> 5], bit) & bit)) atomicAdd(unique, 1);
+  }
+}
+
+// Returns the number of the unique indices of index[0, n), which are in
+// [0, height), by a bitmap of height bits. It waits for the stream.
+template <typename IndexT>
+int CountUniqueIndex(const platform::CUDADeviceContext& ctx,
+                     const IndexT* index, int n, int64_t height) {
+  if (n == 0) return 0;
+  Tensor bitmap;
+  int64_t words = (height + 31) / 32 + 1;
+  int* data =
+      bitmap.mutable_data<int>(framework::make_ddim({words}), ctx.GetPlace());
+  PADDLE_ENFORCE(
+      cudaMemsetAsync(data, 0, words * sizeof(int), ctx.stream()));
+  int block = 512;
+  int grid = std::min((n + block - 1) / block, 4096);
+  MarkUniqueIndexCUDAKernel<IndexT><<<grid, block, 0, ctx.stream()>>>(
+      index, n, reinterpret_cast<unsigned int*>(data + 1), data);
+  int unique = 0;
+  memory::Copy(platform::CPUPlace(), &unique,
+               boost::get<platform::CUDAPlace>(ctx.GetPlace()), data,
+               sizeof(int), ctx.stream());
+  ctx.Wait();
+  return unique;
+}
+
+inline bool UseSortedScatterAdd(int n, int unique) {
+  return n >= kSortedScatterAddMinRatio * static_cast<int64_t>(unique);
+}
+
+template <typename IndexT>
+__global__ void IotaCUDAKernel(IndexT n, IndexT* out) {
+  CUDA_1D_KERNEL_LOOP(i, n) { out[i] = i; }
+}
+
+// The flags of the positions of the sorted index which start an index, and
+// which start a chunk.
+template <typename IndexT>
+__global__ void SortedIndexFlagsCUDAKernel(const IndexT* sorted_index, int n,
+                                           int* segment_flags,
+                                           int* chunk_flags) {
+  CUDA_1D_KERNEL_LOOP(r, n) {
+    bool segment = r == 0 || sorted_index[r] != sorted_index[r - 1];
+    segment_flags[r] = segment;
+    chunk_flags[r] = segment || r % kScatterAddChunk == 0;
+  }
+}
+
+// Every warp sums the rows of a chunk, the positions of the sorted index of
+// the same chunk_no, into the row of partial of the chunk.
+template <typename T, typename IndexT, int BlockDimX, int BlockDimY>
+__global__ void SumChunksCUDAKernel(const T* src, const IndexT* sorted_index,
+                                    const int* positions, const int* chunk_no,
+                                    const int* segment_no, int n,
+                                    int64_t slice_size, T* partial,
+                                    IndexT* chunk_index, int* chunk_segment) {
+  for (int r = blockIdx.x * BlockDimY + threadIdx.y; r < n;
+       r += gridDim.x * BlockDimY) {
+    if (r > 0 && chunk_no[r] == chunk_no[r - 1]) continue;
+    int c = chunk_no[r] - 1;
+    if (threadIdx.x == 0) {
+      chunk_index[c] = sorted_index[r];
+      chunk_segment[c] = segment_no[r] - 1;
+    }
+    for (int64_t d = threadIdx.x; d < slice_size; d += BlockDimX) {
+      T sum = static_cast<T>(0);
+      for (int e = r; e < n && chunk_no[e] == c + 1; ++e) {
+        sum += src[positions[e] * slice_size + d];
+      }
+      partial[c * slice_size + d] = sum;
+    }
+  }
+}
+
+// Every warp sums the chunks of an index into its row of output, or into
+// the row of the index in rows if rows is not null.
+template <typename T, typename IndexT, int BlockDimX, int BlockDimY>
+__global__ void SumSegmentsCUDAKernel(const T* partial,
+                                      const IndexT* chunk_index,
+                                      const int* chunk_segment,
+                                      const int* num_chunks,
+                                      int64_t slice_size, T* output,
+                                      int64_t* rows) {
+  int chunks = *num_chunks;
+  for (int c = blockIdx.x * BlockDimY + threadIdx.y; c < chunks;
+       c += gridDim.x * BlockDimY) {
+    IndexT id = chunk_index[c];
+    if (c > 0 && chunk_index[c - 1] == id) continue;
+    int64_t row = rows ? chunk_segment[c] : id;
+    if (rows && threadIdx.x == 0) rows[row] = id;
+    T* out = output + row * slice_size;
+    for (int64_t d = threadIdx.x; d < slice_size; d += BlockDimX) {
+      T sum = static_cast<T>(0);
+      for (int e = c; e < chunks && chunk_index[e] == id; ++e) {
+        sum += partial[e * slice_size + d];
+      }
+      out[d] = rows ? sum : out[d] + sum;
+    }
+  }
+}
+
+// Adds the n rows of src [n, slice_size] to the rows index[i] of output
+// [height, slice_size] by the sorted scatter add, unique is the number of
+// the unique indices. If rows is not null, output is the [unique,
+// slice_size] sums of the unique indices instead, which are written in rows
+// in the ascending order.
+template <typename T, typename IndexT>
+void GPUSortedScatterAdd(const platform::CUDADeviceContext& ctx, const T* src,
+                         const IndexT* index, int n, int64_t slice_size,
+                         int64_t height, int unique, T* output,
+                         int64_t* rows) {
+  if (n == 0) return;
+  auto place = ctx.GetPlace();
+  auto stream = ctx.stream();
+  int block = 512;
+  int grid = std::min((n + block - 1) / block, 4096);
+
+  Tensor sorted_index_t, positions_t, sorted_positions_t;
+  auto* sorted_index = sorted_index_t.mutable_data<IndexT>(
+      framework::make_ddim({n}), place);
+  auto* positions =
+      positions_t.mutable_data<int>(framework::make_ddim({n}), place);
+  auto* sorted_positions =
+      sorted_positions_t.mutable_data<int>(framework::make_ddim({n}), place);
+  IotaCUDAKernel<int><<<grid, block, 0, stream>>>(n, positions);
+  int end_bit = 1;
+  while (end_bit < static_cast<int>(sizeof(IndexT) * 8) &&
+         (static_cast<int64_t>(1) << end_bit) < height) {
+    ++end_bit;
+  }
+  size_t temp_bytes = 0;
+  PADDLE_ENFORCE(cub::DeviceRadixSort::SortPairs(
+      nullptr, temp_bytes, index, sorted_index, positions, sorted_positions, n,
+      0, end_bit, stream));
+  Tensor temp;
+  PADDLE_ENFORCE(cub::DeviceRadixSort::SortPairs(
+      temp.mutable_data<uint8_t>(
+          framework::make_ddim({static_cast<int64_t>(temp_bytes)}), place),
+      temp_bytes, index, sorted_index, positions, sorted_positions, n, 0,
+      end_bit, stream));
+
+  // The 1-based numbers of the index and the chunk of the sorted positions.
+  Tensor segment_no_t, chunk_no_t;
+  auto* segment_no =
+      segment_no_t.mutable_data<int>(framework::make_ddim({n}), place);
+  auto* chunk_no =
+      chunk_no_t.mutable_data<int>(framework::make_ddim({n}), place);
+  // The flags are scanned in place of the positions, which are sorted.
+  auto* segment_flags = positions;
+  auto* chunk_flags = segment_no;
+  SortedIndexFlagsCUDAKernel<IndexT><<<grid, block, 0, stream>>>(
+      sorted_index, n, segment_flags, chunk_flags);
+  PADDLE_ENFORCE(cub::DeviceScan::InclusiveSum(nullptr, temp_bytes,
+                                               chunk_flags, chunk_no, n,
+                                               stream));
+  Tensor scan_temp;
+  void* scan_storage = scan_temp.mutable_data<uint8_t>(
+      framework::make_ddim({static_cast<int64_t>(temp_bytes)}), place);
+  PADDLE_ENFORCE(cub::DeviceScan::InclusiveSum(
+      scan_storage, temp_bytes, chunk_flags, chunk_no, n, stream));
+  PADDLE_ENFORCE(cub::DeviceScan::InclusiveSum(
+      scan_storage, temp_bytes, segment_flags, segment_no, n, stream));
+
+  // There are at most unique + n / kScatterAddChunk chunks.
+  int max_chunks = unique + n / kScatterAddChunk + 1;
+  Tensor partial_t, chunk_index_t, chunk_segment_t;
+  auto* partial = partial_t.mutable_data<T>(
+      framework::make_ddim({max_chunks, slice_size}), place);
+  auto* chunk_index = chunk_index_t.mutable_data<IndexT>(
+      framework::make_ddim({max_chunks}), place);
+  auto* chunk_segment = chunk_segment_t.mutable_data<int>(
+      framework::make_ddim({max_chunks}), place);
+
+  dim3 threads(32, 8);
+  SumChunksCUDAKernel<T, IndexT, 32, 8><<<std::min((n + 7) / 8, 4096),
+                                          threads, 0, stream>>>(
+      src, sorted_index, sorted_positions, chunk_no, segment_no, n,
+      slice_size, partial, chunk_index, chunk_segment);
+  SumSegmentsCUDAKernel<T, IndexT, 32, 8><<<std::min((max_chunks + 7) / 8,
+                                                      4096),
+                                            threads, 0, stream>>>(
+      partial, chunk_index, chunk_segment, chunk_no + n - 1, slice_size,
+      output, rows);
+}
+
+// Adds the n rows of src [n, slice_size] to the rows index[i] of output
+// [height, slice_size], by the sorted scatter add if the indices repeat,
+// otherwise by atomicAdd.
+template <typename T, typename IndexT>
+void GPUScatterAdd(const platform::CUDADeviceContext& ctx, const T* src,
+                   const IndexT* index, int n, int64_t slice_size,
+                   int64_t height, T* output) {
+  int unique = CountUniqueIndex(ctx, index, n, height);
+  if (UseSortedScatterAdd(n, unique)) {
+    GPUSortedScatterAdd(ctx, src, index, n, slice_size, height, unique,
+                        output, static_cast<int64_t*>(nullptr));
+    return;
+  }
+  int block = 512;
+  int64_t numel = n * slice_size;
+  int grid = static_cast<int>(
+      std::min<int64_t>((numel + block - 1) / block, 65536));
+  if (numel == 0) return;
+  ScatterAddCUDAKernel<T, IndexT><<<grid, block, 0, ctx.stream()>>>(
+      src, index, output, n, slice_size);
+}
+
 }  // namespace operators
 }  // namespace paddle
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 #include <algorithm>
+#include <vector>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/math/context_project.h"
 #include "paddle/fluid/operators/math/math_function.h"
@@ -51,14 +52,54 @@ class SequenceConvKernel : public framework::OpKernel<T> {
     int down_pad = std::max(0, context_start + context_length - 1);
     int sequence_width = static_cast<int>(in->dims()[1]);
 
+    math::SetConstant<DeviceContext, T> set_zero;
+    auto& dev_ctx = context.template device_context<DeviceContext>();
+    auto blas = math::GetBlas<DeviceContext, T>(dev_ctx);
+
+    if (!padding_trainable) {
+      // The padding is zeros, so Out is the sum over the context positions k
+      // of the rows of every sequence shifted by context_start + k times the
+      // k-th block of Filter. The sequences are multiplied in place by one
+      // batched GEMM of every k, without the im2col of the whole batch.
+      auto lod_level_0 = in->lod()[0];
+      size_t num_seqs = lod_level_0.size() - 1;
+      int out_width = static_cast<int>(filter.dims()[1]);
+      const T* in_data = in->data<T>();
+      const T* filter_data = filter.data<T>();
+      T* out_data = out->data<T>();
+      set_zero(dev_ctx, out, static_cast<T>(0));
+
+      std::vector<int> rows(num_seqs);
+      std::vector<const T*> in_rows(num_seqs);
+      std::vector<const T*> filter_rows(num_seqs);
+      std::vector<T*> out_rows(num_seqs);
+      for (int k = 0; k < context_length; ++k) {
+        int offset = context_start + k;
+        const T* filter_k = filter_data + k * sequence_width * out_width;
+        for (size_t i = 0; i < num_seqs; ++i) {
+          int begin = static_cast<int>(lod_level_0[i]) + std::max(0, -offset);
+          int end = static_cast<int>(lod_level_0[i + 1]) - std::max(0, offset);
+          rows[i] = end - begin;
+          bool empty = rows[i] <= 0;
+          in_rows[i] =
+              empty ? nullptr : in_data + (begin + offset) * sequence_width;
+          filter_rows[i] = filter_k;
+          out_rows[i] = empty ? nullptr : out_data + begin * out_width;
+        }
+        // The GEMMs of the different k accumulate to the same rows of Out,
+        // so they are not in one batch.
+        blas.VarLenBatchedGEMM(CblasNoTrans, CblasNoTrans, rows, out_width,
+                               sequence_width, static_cast<T>(1), in_rows,
+                               sequence_width, filter_rows, out_width,
+                               static_cast<T>(1), out_rows, out_width);
+      }
+      return;
+    }
+
     framework::DDim col_shape = {in->dims()[0],
                                  context_length * sequence_width};
     Tensor col;
     col.mutable_data<T>(col_shape, context.GetPlace());
-    // Because if padding_trainable is false, padding data should be zeros.
-    math::SetConstant<DeviceContext, T> set_zero;
-    auto& dev_ctx = context.template device_context<DeviceContext>();
-    auto blas = math::GetBlas<DeviceContext, T>(dev_ctx);
     set_zero(dev_ctx, &col, static_cast<T>(0));
     math::ContextProjectFunctor<DeviceContext, T> seq_project_functor;
 
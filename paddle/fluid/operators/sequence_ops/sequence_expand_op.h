@@ -13,8 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
+#include <algorithm>
 #include <numeric>  // std::iota
+#include <vector>
 
+#include "paddle/fluid/framework/compute_pool.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/memory/memcpy.h"
 #include "paddle/fluid/operators/math/math_function.h"
@@ -52,31 +55,42 @@ struct SequenceExpandFunctor<platform::CPUDeviceContext, T> {
       const framework::Vector<size_t>& x_lod,   /*expand source lod*/
       const framework::Vector<size_t>& ref_lod, /*expand referenced lod*/
       LoDTensor* out) {
-    int out_offset = 0;
     int x_item_length = x.numel() / x.dims()[0];
     auto out_data = out->data<T>();
     auto x_data = x.data<T>();
-    for (size_t i = 1; i < ref_lod.size(); ++i) {
-      int repeat_num = ref_lod[i] - ref_lod[i - 1];
-      int x_start = x_lod[i - 1];
-      int x_end = x_lod[i];
-      int x_seq_len = x_end - x_start;
-      if (repeat_num > 0) {
-        int out_start = out_offset;
-        if (out->lod().size() == 1) {
-          out_start = out->lod()[0][out_offset];
-        }
-        for (int j = 0; j < repeat_num; j++) {
-          for (int k = 0; k < x_seq_len; k++) {
-            for (int l = 0; l < x_item_length; l++) {
-              out_data[(out_start + j * x_seq_len + k) * x_item_length + l] =
-                  x_data[(x_start + k) * x_item_length + l];
+    const size_t* out_lod =
+        out->lod().size() == 1 ? out->lod()[0].data() : nullptr;
+    // The sequences are expanded to their own rows of out, each one repeated
+    // ref_lod[i] - ref_lod[i - 1] times.
+    const size_t* x_offsets = x_lod.data();
+    const size_t* ref_offsets = ref_lod.data();
+    int64_t num_seq = static_cast<int64_t>(ref_lod.size()) - 1;
+    int64_t seq_numel = out->numel() / std::max<int64_t>(num_seq, 1);
+    framework::ParallelFor(
+        0, num_seq, framework::GrainSize(seq_numel),
+        [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin + 1; i < end + 1; ++i) {
+            int repeat_num = ref_offsets[i] - ref_offsets[i - 1];
+            int x_start = x_offsets[i - 1];
+            int x_end = x_offsets[i];
+            int x_seq_len = x_end - x_start;
+            if (repeat_num <= 0) continue;
+            int out_offset = ref_offsets[i - 1] - ref_offsets[0];
+            int out_start = out_lod ? out_lod[out_offset] : out_offset;
+            // The repeats are contiguous, so the ones copied are copied
+            // again as one block, doubling the run each time.
+            T* dst = out_data + out_start * x_item_length;
+            int64_t run = static_cast<int64_t>(x_seq_len) * x_item_length;
+            int64_t total = run * repeat_num;
+            std::copy(x_data + x_start * x_item_length,
+                      x_data + x_end * x_item_length, dst);
+            for (int64_t copied = run; copied < total;) {
+              int64_t n = std::min(copied, total - copied);
+              std::copy(dst, dst + n, dst + copied);
+              copied += n;
             }
           }
-        }
-      }
-      out_offset += repeat_num;
-    }
+        });
   }
 };
 
@@ -153,23 +167,38 @@ struct SequenceExpandGradFunctor<platform::CPUDeviceContext, T> {
       const framework::Vector<size_t>& x_lod,   /*expand source lod*/
       const framework::Vector<size_t>& ref_lod, /*expand referenced lod*/
       LoDTensor* dx) {
-    int dout_offset = 0;
-    for (size_t i = 1; i < ref_lod.size(); ++i) {
-      int repeat_num = ref_lod[i] - ref_lod[i - 1];
-      if (repeat_num > 0) {
-        int x_start = x_lod[i - 1];
-        int x_end = x_lod[i];
-        int x_seq_len = x_end - x_start;
-        auto dx_sub = dx->Slice(x_start, x_end);
-        dx_sub.Resize(flatten_to_1d(dx_sub.dims()));
-        int dout_end = dout_offset + repeat_num * x_seq_len;
-        auto dout_sub = dout.Slice(dout_offset, dout_end);
-        dout_sub.Resize({repeat_num, dx_sub.dims()[0]});
-        math::ColwiseSum<platform::CPUDeviceContext, T> col_sum;
-        col_sum(context, dout_sub, &dx_sub);
-        dout_offset += repeat_num * x_seq_len;
-      }
+    int64_t x_item_length = dx->numel() / std::max<int64_t>(dx->dims()[0], 1);
+    const T* dout_data = dout.data<T>();
+    T* dx_data = dx->data<T>();
+    const size_t* x_offsets = x_lod.data();
+    const size_t* ref_offsets = ref_lod.data();
+    int64_t num_seq = static_cast<int64_t>(ref_lod.size()) - 1;
+    // The rows of dout the repeats of every sequence start at.
+    std::vector<int64_t> dout_offsets(num_seq + 1, 0);
+    for (int64_t i = 0; i < num_seq; ++i) {
+      int64_t repeat_num = ref_offsets[i + 1] - ref_offsets[i];
+      dout_offsets[i + 1] =
+          dout_offsets[i] + repeat_num * (x_offsets[i + 1] - x_offsets[i]);
     }
+    int64_t seq_numel = dout.numel() / std::max<int64_t>(num_seq, 1);
+    framework::ParallelFor(
+        0, num_seq, framework::GrainSize(seq_numel),
+        [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            int64_t repeat_num = ref_offsets[i + 1] - ref_offsets[i];
+            if (repeat_num <= 0) continue;
+            int64_t run = (x_offsets[i + 1] - x_offsets[i]) * x_item_length;
+            const T* src = dout_data + dout_offsets[i] * x_item_length;
+            T* dst = dx_data + x_offsets[i] * x_item_length;
+            std::copy(src, src + run, dst);
+            for (int64_t j = 1; j < repeat_num; ++j) {
+              const T* repeat = src + j * run;
+              for (int64_t k = 0; k < run; ++k) {
+                dst[k] += repeat[k];
+              }
+            }
+          }
+        });
   }
 };
 
@@ -14,7 +14,10 @@ limitations under the License. */
 
 #pragma once
 
+#include <algorithm>
+#include "paddle/fluid/framework/compute_pool.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/jit/kernels.h"
 
 namespace paddle {
 namespace operators {
@@ -38,24 +41,68 @@ struct SequenceSoftmaxGradFunctor {
                   LoDTensor *dx);
 };
 
+// y = exp(x) of n elements by the VExp kernels of kExpBlock elements, so
+// that the kernels of the segments of any length are at most kExpBlock.
+template <typename T>
+void SegmentsExp(const T *x, T *y, size_t n) {
+  constexpr int kExpBlock = 256;
+  auto vexp = jit::Get<jit::kVExp, jit::XYNTuples<T>, platform::CPUPlace>(
+      kExpBlock);
+  size_t i = 0;
+  for (; i + kExpBlock <= n; i += kExpBlock) {
+    vexp(x + i, y + i, kExpBlock);
+  }
+  if (i < n) {
+    int rest = static_cast<int>(n - i);
+    jit::Get<jit::kVExp, jit::XYNTuples<T>, platform::CPUPlace>(rest)(
+        x + i, y + i, rest);
+  }
+}
+
+// The segments of a chunk are shifted by their max values at first, then the
+// exp of the whole chunk is taken at once, and every segment is normalized
+// by its sum at last.
 template <typename T>
 struct SequenceSoftmaxFunctor<platform::CPUDeviceContext, T> {
   void operator()(const platform::CPUDeviceContext &ctx, const LoDTensor &x,
                   const framework::Vector<size_t> &ref_lod, /*referenced lod*/
                   LoDTensor *out) {
-    size_t hight = ref_lod.size() - 1;
+    int64_t num_seq = static_cast<int64_t>(ref_lod.size()) - 1;
+    const size_t *offsets = ref_lod.data();
     const T *in_data = x.data<T>();
     T *out_data = out->mutable_data<T>(ctx.GetPlace());
-    for (size_t i = 0; i < hight; ++i) {
-      size_t span = ref_lod[i + 1] - ref_lod[i];
-      T result = 0;
-      for (size_t j = 0; j < span; ++j) {
-        result += exp(in_data[ref_lod[i] + j]);
-      }
-      for (size_t j = 0; j < span; ++j) {
-        out_data[ref_lod[i] + j] = exp(in_data[ref_lod[i] + j]) / result;
-      }
-    }
+    int64_t seq_numel = x.numel() / std::max<int64_t>(num_seq, 1);
+    framework::ParallelFor(
+        0, num_seq, framework::GrainSize(seq_numel),
+        [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            const T *src = in_data + offsets[i];
+            T *dst = out_data + offsets[i];
+            size_t span = offsets[i + 1] - offsets[i];
+            T max = span > 0 ? src[0] : static_cast<T>(0);
+            for (size_t j = 1; j < span; ++j) {
+              max = src[j] > max ? src[j] : max;
+            }
+            for (size_t j = 0; j < span; ++j) {
+              dst[j] = src[j] - max;
+            }
+          }
+          size_t chunk_begin = offsets[begin];
+          SegmentsExp<T>(out_data + chunk_begin, out_data + chunk_begin,
+                         offsets[end] - chunk_begin);
+          for (int64_t i = begin; i < end; ++i) {
+            T *dst = out_data + offsets[i];
+            size_t span = offsets[i + 1] - offsets[i];
+            T sum = static_cast<T>(0);
+            for (size_t j = 0; j < span; ++j) {
+              sum += dst[j];
+            }
+            T scale = static_cast<T>(1) / sum;
+            for (size_t j = 0; j < span; ++j) {
+              dst[j] *= scale;
+            }
+          }
+        });
   }
 };
 
@@ -65,24 +112,29 @@ struct SequenceSoftmaxGradFunctor<platform::CPUDeviceContext, T> {
                   const LoDTensor &out,
                   const framework::Vector<size_t> &ref_lod, /*referenced lod*/
                   LoDTensor *dx) {
-    size_t hight = ref_lod.size() - 1;
-
+    int64_t num_seq = static_cast<int64_t>(ref_lod.size()) - 1;
+    const size_t *offsets = ref_lod.data();
     const T *softmax_grad_data = dout.data<T>();
     const T *softmax = out.data<T>();
     T *dx_data = dx->mutable_data<T>(ctx.GetPlace());
-
-    for (size_t i = 0; i < hight; ++i) {
-      size_t span = ref_lod[i + 1] - ref_lod[i];
-      T result = 0;
-      for (size_t j = 0; j < span; ++j) {
-        result += softmax_grad_data[ref_lod[i] + j] * softmax[ref_lod[i] + j];
-      }
-
-      for (size_t j = 0; j < span; ++j) {
-        dx_data[ref_lod[i] + j] = (softmax_grad_data[ref_lod[i] + j] - result) *
-                                  softmax[ref_lod[i] + j];
-      }
-    }
+    int64_t seq_numel = out.numel() / std::max<int64_t>(num_seq, 1);
+    framework::ParallelFor(
+        0, num_seq, framework::GrainSize(seq_numel),
+        [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            const T *dy = softmax_grad_data + offsets[i];
+            const T *y = softmax + offsets[i];
+            T *dst = dx_data + offsets[i];
+            size_t span = offsets[i + 1] - offsets[i];
+            T result = static_cast<T>(0);
+            for (size_t j = 0; j < span; ++j) {
+              result += dy[j] * y[j];
+            }
+            for (size_t j = 0; j < span; ++j) {
+              dst[j] = (dy[j] - result) * y[j];
+            }
+          }
+        });
   }
 };
 
@@ -15,6 +15,7 @@ limitations under the License. */
 #pragma once
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/operators/math/cross_entropy.h"
 #include "paddle/fluid/operators/math/softmax.h"
 
@@ -40,13 +41,35 @@ class SoftmaxWithCrossEntropyKernel : public framework::OpKernel<T> {
     softmax->mutable_data<T>(context.GetPlace());
     loss->mutable_data<T>(context.GetPlace());
 
+    const bool soft_label = context.Attr<bool>("soft_label");
+    const int ignore_index = context.Attr<int>("ignore_index");
+    if (!soft_label) {
+      // compute softmax and loss of each row in one fused kernel
+      const int batch_size = logits->dims()[0];
+      const int class_num = logits->dims()[1];
+      const int64_t* label_data = labels->data<int64_t>();
+      for (int i = 0; i < batch_size; ++i) {
+        PADDLE_ENFORCE((label_data[i] >= 0 && label_data[i] < class_num) ||
+                           label_data[i] == ignore_index,
+                       "The label %d should be in [0, %d) or equal to "
+                       "ignore_index %d.",
+                       label_data[i], class_num, ignore_index);
+      }
+      auto compute_softmax_ce =
+          jit::Get<jit::kSoftmaxCrossEntropy,
+                   jit::SoftmaxCrossEntropyTuples<T>, platform::CPUPlace>(
+              class_num);
+      compute_softmax_ce(logits->data<T>(), label_data, softmax->data<T>(),
+                         loss->data<T>(), class_num, batch_size, ignore_index);
+      return;
+    }
+
     auto& dev_ctx =
         context.template device_context<platform::CPUDeviceContext>();
     math::SoftmaxFunctor<platform::CPUDeviceContext, T, false>()(
         dev_ctx, logits, softmax);
     math::CrossEntropyFunctor<platform::CPUDeviceContext, T>()(
-        dev_ctx, loss, softmax, labels, context.Attr<bool>("soft_label"),
-        context.Attr<int>("ignore_index"));
+        dev_ctx, loss, softmax, labels, soft_label, ignore_index);
   }
 };
 
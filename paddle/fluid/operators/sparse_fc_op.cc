@@ -0,0 +1,138 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+
+#include <vector>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/sparse_matmul.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+
+class SparseFCOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    for (auto& input : {"Input", "WOffsets", "WIndices", "WValues"}) {
+      PADDLE_ENFORCE(ctx->HasInput(input),
+                     "Input(%s) of SparseFCOp should not be null.", input);
+    }
+    PADDLE_ENFORCE(ctx->HasOutput("Out"),
+                   "Output(Out) of SparseFCOp should not be null.");
+    auto w_dims = ctx->Attrs().Get<std::vector<int>>("weight_dims");
+    PADDLE_ENFORCE_EQ(w_dims.size(), 2UL,
+                      "The weight of SparseFCOp should be 2-D.");
+    PADDLE_ENFORCE_EQ(ctx->GetInputDim("WOffsets")[0], w_dims[1] + 1,
+                      "WOffsets should have a value a column of W and one.");
+    if (ctx->HasInput("Bias")) {
+      PADDLE_ENFORCE_EQ(framework::product(ctx->GetInputDim("Bias")),
+                        w_dims[1], "The shape of Bias must be [1, dim].");
+    }
+
+    auto in_dims = ctx->GetInputDim("Input");
+    int in_num_col_dims = ctx->Attrs().Get<int>("in_num_col_dims");
+    PADDLE_ENFORCE_GT(
+        in_dims.size(), in_num_col_dims,
+        "The input tensor Input's rank of SparseFCOp should be larger than "
+        "in_num_col_dims.");
+    auto in_mat_dims = framework::flatten_to_2d(in_dims, in_num_col_dims);
+    PADDLE_ENFORCE_EQ(in_mat_dims[1], w_dims[0],
+                      "Fully Connected input and weigth size do not match.");
+
+    std::vector<int64_t> output_dims;
+    output_dims.reserve(static_cast<size_t>(in_num_col_dims + 1));
+    for (int i = 0; i < in_num_col_dims; ++i) {
+      output_dims.push_back(in_dims[i]);
+    }
+    output_dims.push_back(w_dims[1]);
+    ctx->SetOutputDim("Out", framework::make_ddim(output_dims));
+    ctx->ShareLoD("Input", "Out");
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    return framework::OpKernelType(ctx.Input<Tensor>("Input")->type(),
+                                   ctx.GetPlace());
+  }
+};
+
+class SparseFCOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Input",
+             "(Tensor), The input tensor of fully connected operator.");
+    AddInput("WOffsets",
+             "(Tensor<int>) The offsets [O + 1] of the nonzeros of the "
+             "columns of the weight in the CSC format.");
+    AddInput("WIndices",
+             "(Tensor<int>) The row indices of the nonzeros of the weight.");
+    AddInput("WValues", "(Tensor) The nonzeros of the weight.");
+    AddInput("Bias", "(Tensor, optional) Bias vector with shape (1 x O")
+        .AsDispensable();
+    AddOutput("Out", "(Tensor) The output tensor of fully connected operator.");
+    AddAttr<int>("in_num_col_dims",
+                 "(int, default 1), The fc op can take tensors with more than "
+                 "two dimensions as its inputs.")
+        .SetDefault(1)
+        .EqualGreaterThan(1);
+    AddAttr<std::vector<int>>("weight_dims",
+                              "The dims (I, O) of the dense weight.");
+    AddComment(R"DOC(
+SparseFC Operator.
+
+The fully connected operator of a pruned weight, which is stored by the
+nonzeros of its columns in the CSC format. It computes Out = Input * W + Bias
+as fc does, in the time of the nonzeros of W instead of I * O. The fc and mul
+ops of the sparse weights are replaced by it in the inference by
+sparse_weight_pass.
+)DOC");
+  }
+};
+
+template <typename T>
+class SparseFCKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    PADDLE_ENFORCE(platform::is_cpu_place(ctx.GetPlace()),
+                   "It must use CPUPlace.");
+    auto* input = ctx.Input<Tensor>("Input");
+    auto* offsets = ctx.Input<Tensor>("WOffsets");
+    auto* indices = ctx.Input<Tensor>("WIndices");
+    auto* values = ctx.Input<Tensor>("WValues");
+    auto* bias = ctx.Input<Tensor>("Bias");
+    auto* output = ctx.Output<Tensor>("Out");
+    auto w_dims = ctx.Attr<std::vector<int>>("weight_dims");
+    auto out_dims = output->dims();
+    int M = framework::product(out_dims) / out_dims[out_dims.size() - 1];
+
+    math::CSCMatMul(M, w_dims[1], w_dims[0], input->data<T>(),
+                    offsets->data<int>(), indices->data<int>(),
+                    values->data<T>(),
+                    output->mutable_data<T>(ctx.GetPlace()),
+                    bias ? bias->data<T>() : nullptr);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(sparse_fc, ops::SparseFCOp, ops::SparseFCOpMaker,
+                  paddle::framework::EmptyGradOpMaker);
+REGISTER_OP_CPU_KERNEL(sparse_fc, ops::SparseFCKernel<float>,
+                       ops::SparseFCKernel<double>);
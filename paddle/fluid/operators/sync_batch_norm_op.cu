@@ -0,0 +1,453 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <string>
+#include "cub/cub.cuh"
+#include "paddle/fluid/framework/data_layout.h"
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/operators/batch_norm_op.h"
+#include "paddle/fluid/platform/cudnn_helper.h"
+#include "paddle/fluid/platform/float16.h"
+#include "paddle/fluid/platform/nccl_helper.h"
+
+namespace paddle {
+namespace operators {
+
+using Tensor = framework::Tensor;
+using DataLayout = framework::DataLayout;
+template <typename T>
+using BatchNormParamType =
+    typename platform::CudnnDataType<T>::BatchNormParamType;
+
+// The count, mean and sum of the squared deviations from the mean of the
+// values of a channel. The ones of the threads, the blocks and the devices
+// are merged by the parallel algorithm of Chan et al., which, unlike the sums
+// of the values and their squares, does not lose the variance of the values
+// far from 0.
+template <typename U>
+struct WelfordStats {
+  U count;
+  U mean;
+  U m2;
+};
+
+template <typename U>
+struct WelfordMerge {
+  __device__ __forceinline__ WelfordStats<U> operator()(
+      const WelfordStats<U> &a, const WelfordStats<U> &b) const {
+    U count = a.count + b.count;
+    if (count == static_cast<U>(0)) return a;
+    U delta = b.mean - a.mean;
+    U ratio = b.count / count;
+    WelfordStats<U> merged;
+    merged.count = count;
+    merged.mean = a.mean + delta * ratio;
+    merged.m2 = a.m2 + b.m2 + delta * delta * a.count * ratio;
+    return merged;
+  }
+};
+
+// stats[3][C] = the count, mean and m2 of the M values of each channel of the
+// device, of one pass over x.
+template <typename T, int BlockDim, DataLayout layout>
+static __global__ void KeLocalStats(const T *x, const int C, const int HxW,
+                                    const int M,
+                                    BatchNormParamType<T> *stats) {
+  using U = BatchNormParamType<T>;
+  typedef cub::BlockReduce<WelfordStats<U>, BlockDim> BlockReduce;
+  __shared__ typename BlockReduce::TempStorage storage;
+
+  for (int c = blockIdx.x; c < C; c += gridDim.x) {
+    WelfordStats<U> s = {0, 0, 0};
+    for (int j = threadIdx.x; j < M; j += BlockDim) {
+      const int index = layout == DataLayout::kNCHW
+                            ? (j / HxW * C + c) * HxW + j % HxW
+                            : j * C + c;
+      U value = static_cast<U>(x[index]);
+      s.count += static_cast<U>(1);
+      U delta = value - s.mean;
+      s.mean += delta / s.count;
+      s.m2 += delta * (value - s.mean);
+    }
+    s = BlockReduce(storage).Reduce(s, WelfordMerge<U>());
+    if (threadIdx.x == 0) {
+      stats[c] = s.count;
+      stats[C + c] = s.mean;
+      stats[2 * C + c] = s.m2;
+    }
+    __syncthreads();
+  }
+}
+
+// Merges the stats[nranks][3][C] of all the devices into the mean and the
+// inverse std of the mini-batch, and updates the running mean and variance
+// by the unbiased variance, as cudnn does.
+template <typename U>
+static __global__ void KeMergeStats(const U *stats, const int nranks,
+                                    const int C, const double epsilon,
+                                    const float momentum, U *mean_out,
+                                    U *variance_out, U *saved_mean,
+                                    U *saved_inv_std) {
+  WelfordMerge<U> merge;
+  int gid = blockIdx.x * blockDim.x + threadIdx.x;
+  int stride = blockDim.x * gridDim.x;
+  for (int c = gid; c < C; c += stride) {
+    WelfordStats<U> s = {0, 0, 0};
+    for (int r = 0; r < nranks; ++r) {
+      const U *rank_stats = stats + r * 3 * C;
+      WelfordStats<U> t = {rank_stats[c], rank_stats[C + c],
+                           rank_stats[2 * C + c]};
+      s = merge(s, t);
+    }
+    U variance = s.count > static_cast<U>(0) ? s.m2 / s.count : 0;
+    U unbiased =
+        s.count > static_cast<U>(1) ? s.m2 / (s.count - 1) : variance;
+    saved_mean[c] = s.mean;
+    saved_inv_std[c] = 1.0 / sqrt(variance + epsilon);
+    mean_out[c] = momentum * mean_out[c] + (1 - momentum) * s.mean;
+    variance_out[c] = momentum * variance_out[c] + (1 - momentum) * unbiased;
+  }
+}
+
+template <typename U>
+static __global__ void KeInvStd(const U *variance, const double epsilon,
+                                const int C, U *inv_std) {
+  int gid = blockIdx.x * blockDim.x + threadIdx.x;
+  int stride = blockDim.x * gridDim.x;
+  for (int c = gid; c < C; c += stride) {
+    inv_std[c] = 1.0 / sqrt(variance[c] + epsilon);
+  }
+}
+
+template <typename T, DataLayout layout>
+static __global__ void KeNormalize(const T *x,
+                                   const BatchNormParamType<T> *scale,
+                                   const BatchNormParamType<T> *bias,
+                                   const BatchNormParamType<T> *mean,
+                                   const BatchNormParamType<T> *inv_std,
+                                   const int C, const int HxW, const int num,
+                                   T *y) {
+  using U = BatchNormParamType<T>;
+  int gid = blockIdx.x * blockDim.x + threadIdx.x;
+  int stride = blockDim.x * gridDim.x;
+  for (int i = gid; i < num; i += stride) {
+    const int c = layout == DataLayout::kNCHW ? i / HxW % C : i % C;
+    U x_hat = (static_cast<U>(x[i]) - mean[c]) * inv_std[c];
+    y[i] = static_cast<T>(scale[c] * x_hat + bias[c]);
+  }
+}
+
+// sums[2 * C + 1] = the sums of dy and of dy * (x - mean) of each channel of
+// the device, and the count M of the values of a channel. dscale and dbias,
+// if not null, are the ones of the device, which the all-reduce of the
+// gradients of the parameters sums up.
+template <typename T, int BlockDim, DataLayout layout>
+static __global__ void KeLocalGradSums(
+    const T *dy, const T *x, const BatchNormParamType<T> *mean,
+    const BatchNormParamType<T> *inv_std, const int C, const int HxW,
+    const int M, BatchNormParamType<T> *sums, BatchNormParamType<T> *dscale,
+    BatchNormParamType<T> *dbias) {
+  using U = BatchNormParamType<T>;
+  typedef cub::BlockReduce<U, BlockDim> BlockReduce;
+  __shared__ typename BlockReduce::TempStorage ds_storage;
+  __shared__ typename BlockReduce::TempStorage db_storage;
+
+  if (blockIdx.x == 0 && threadIdx.x == 0) {
+    sums[2 * C] = static_cast<U>(M);
+  }
+  for (int c = blockIdx.x; c < C; c += gridDim.x) {
+    U ds_sum = static_cast<U>(0);
+    U db_sum = static_cast<U>(0);
+    U mean_c = mean[c];
+    for (int j = threadIdx.x; j < M; j += BlockDim) {
+      const int index = layout == DataLayout::kNCHW
+                            ? (j / HxW * C + c) * HxW + j % HxW
+                            : j * C + c;
+      U dy_j = static_cast<U>(dy[index]);
+      ds_sum += dy_j * (static_cast<U>(x[index]) - mean_c);
+      db_sum += dy_j;
+    }
+    ds_sum = BlockReduce(ds_storage).Reduce(ds_sum, cub::Sum());
+    db_sum = BlockReduce(db_storage).Reduce(db_sum, cub::Sum());
+    if (threadIdx.x == 0) {
+      sums[c] = db_sum;
+      sums[C + c] = ds_sum;
+      if (dscale != nullptr) {
+        dscale[c] = ds_sum * inv_std[c];
+        dbias[c] = db_sum;
+      }
+    }
+    __syncthreads();
+  }
+}
+
+// dx of the sums of all the devices, or of the fixed mean and variance if
+// sums is null, i.e. with use_global_stats.
+template <typename T, DataLayout layout>
+static __global__ void KeBackwardData(const T *dy, const T *x,
+                                      const BatchNormParamType<T> *scale,
+                                      const BatchNormParamType<T> *mean,
+                                      const BatchNormParamType<T> *inv_std,
+                                      const BatchNormParamType<T> *sums,
+                                      const int C, const int HxW,
+                                      const int num, T *dx) {
+  using U = BatchNormParamType<T>;
+  int gid = blockIdx.x * blockDim.x + threadIdx.x;
+  int stride = blockDim.x * gridDim.x;
+  for (int i = gid; i < num; i += stride) {
+    const int c = layout == DataLayout::kNCHW ? i / HxW % C : i % C;
+    U inv_std_c = inv_std[c];
+    U value = static_cast<U>(dy[i]);
+    if (sums != nullptr) {
+      U count = sums[2 * C];
+      U x_hat = (static_cast<U>(x[i]) - mean[c]) * inv_std_c;
+      value -= (sums[c] + x_hat * sums[C + c] * inv_std_c) / count;
+    }
+    dx[i] = static_cast<T>(scale[c] * inv_std_c * value);
+  }
+}
+
+// The NCCL communicator of the devices sharing the statistics, and its
+// number of ranks, which is 1 if the device context has none, e.g. with the
+// Executor, so that the statistics are the ones of the device.
+static ncclComm_t GetComm(const platform::CUDADeviceContext &dev_ctx,
+                          int *nranks) {
+  ncclComm_t comm = dev_ctx.nccl_comm();
+  *nranks = 1;
+  if (comm != nullptr) {
+    PADDLE_ENFORCE(platform::dynload::ncclCommCount(comm, nranks));
+  }
+  return comm;
+}
+
+template <typename DeviceContext, typename T>
+class SyncBatchNormKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &ctx) const override {
+    using U = BatchNormParamType<T>;
+    PADDLE_ENFORCE(platform::is_gpu_place(ctx.GetPlace()),
+                   "It must use CUDAPlace.");
+    double epsilon = static_cast<double>(ctx.Attr<float>("epsilon"));
+    const float momentum = ctx.Attr<float>("momentum");
+    const bool is_test = ctx.Attr<bool>("is_test");
+    const bool use_global_stats = ctx.Attr<bool>("use_global_stats");
+    const DataLayout layout =
+        framework::StringToDataLayout(ctx.Attr<std::string>("data_layout"));
+
+    const auto *x = ctx.Input<Tensor>("X");
+    const auto &x_dims = x->dims();
+    PADDLE_ENFORCE(x_dims.size() >= 2 && x_dims.size() <= 5,
+                   "The Input dim size should be between 2 and 5");
+    const int N = x_dims[0];
+    const int C = layout == DataLayout::kNCHW ? x_dims[1]
+                                              : x_dims[x_dims.size() - 1];
+    const int num = x->numel();
+    const int M = num / C;
+    const int HxW = M / N;
+
+    const auto *scale = ctx.Input<Tensor>("Scale");
+    const auto *bias = ctx.Input<Tensor>("Bias");
+    auto *y = ctx.Output<Tensor>("Y");
+    y->mutable_data<T>(ctx.GetPlace());
+
+    auto &dev_ctx = ctx.template device_context<DeviceContext>();
+    const int block = 512;
+    const int max_blocks =
+        std::max(dev_ctx.GetMaxPhysicalThreadCount() / block, 1);
+
+    const U *mean_data = nullptr;
+    const U *inv_std_data = nullptr;
+    Tensor inv_std;
+    if (is_test || use_global_stats) {
+      const auto *est_mean = ctx.Input<Tensor>("Mean");
+      const auto *est_var = ctx.Input<Tensor>("Variance");
+      inv_std = ctx.AllocateTmpTensor<U, DeviceContext>({C}, dev_ctx);
+      KeInvStd<U><<<(C + block - 1) / block, block, 0, dev_ctx.stream()>>>(
+          est_var->data<U>(), epsilon, C, inv_std.data<U>());
+      mean_data = est_mean->data<U>();
+      inv_std_data = inv_std.data<U>();
+    } else {
+      auto *mean_out = ctx.Output<Tensor>("MeanOut");
+      auto *variance_out = ctx.Output<Tensor>("VarianceOut");
+      auto *saved_mean = ctx.Output<Tensor>("SavedMean");
+      auto *saved_inv_std = ctx.Output<Tensor>("SavedVariance");
+
+      Tensor local_stats =
+          ctx.AllocateTmpTensor<U, DeviceContext>({3 * C}, dev_ctx);
+      int grid = std::min(C, max_blocks);
+      if (layout == DataLayout::kNCHW) {
+        KeLocalStats<T, block, DataLayout::kNCHW><<<grid, block, 0,
+                                                    dev_ctx.stream()>>>(
+            x->data<T>(), C, HxW, M, local_stats.data<U>());
+      } else {
+        KeLocalStats<T, block, DataLayout::kNHWC><<<grid, block, 0,
+                                                    dev_ctx.stream()>>>(
+            x->data<T>(), C, HxW, M, local_stats.data<U>());
+      }
+
+      int nranks;
+      ncclComm_t comm = GetComm(dev_ctx, &nranks);
+      const U *stats = local_stats.data<U>();
+      Tensor all_stats;
+      if (nranks > 1) {
+        all_stats =
+            ctx.AllocateTmpTensor<U, DeviceContext>({nranks * 3 * C}, dev_ctx);
+        PADDLE_ENFORCE(platform::dynload::ncclAllGather(
+            local_stats.data<U>(), all_stats.data<U>(), 3 * C,
+            platform::ToNCCLDataType(framework::ToDataType(typeid(U))), comm,
+            dev_ctx.stream()));
+        stats = all_stats.data<U>();
+      }
+
+      KeMergeStats<U><<<(C + block - 1) / block, block, 0, dev_ctx.stream()>>>(
+          stats, nranks, C, epsilon, momentum,
+          mean_out->mutable_data<U>(ctx.GetPlace()),
+          variance_out->mutable_data<U>(ctx.GetPlace()),
+          saved_mean->mutable_data<U>(ctx.GetPlace()),
+          saved_inv_std->mutable_data<U>(ctx.GetPlace()));
+      mean_data = saved_mean->data<U>();
+      inv_std_data = saved_inv_std->data<U>();
+    }
+
+    int grid = (num + block - 1) / block;
+    if (layout == DataLayout::kNCHW) {
+      KeNormalize<T, DataLayout::kNCHW><<<grid, block, 0, dev_ctx.stream()>>>(
+          x->data<T>(), scale->data<U>(), bias->data<U>(), mean_data,
+          inv_std_data, C, HxW, num, y->data<T>());
+    } else {
+      KeNormalize<T, DataLayout::kNHWC><<<grid, block, 0, dev_ctx.stream()>>>(
+          x->data<T>(), scale->data<U>(), bias->data<U>(), mean_data,
+          inv_std_data, C, HxW, num, y->data<T>());
+    }
+  }
+};
+
+template <typename DeviceContext, typename T>
+class SyncBatchNormGradKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &ctx) const override {
+    using U = BatchNormParamType<T>;
+    PADDLE_ENFORCE(platform::is_gpu_place(ctx.GetPlace()),
+                   "It must use CUDAPlace.");
+    double epsilon = static_cast<double>(ctx.Attr<float>("epsilon"));
+    const bool use_global_stats = ctx.Attr<bool>("use_global_stats");
+    const DataLayout layout =
+        framework::StringToDataLayout(ctx.Attr<std::string>("data_layout"));
+
+    const auto *x = ctx.Input<Tensor>("X");
+    const auto *d_y = ctx.Input<Tensor>(framework::GradVarName("Y"));
+    const auto *scale = ctx.Input<Tensor>("Scale");
+    const auto &x_dims = x->dims();
+    PADDLE_ENFORCE(x_dims.size() >= 2 && x_dims.size() <= 5,
+                   "The Input dim size should be between 2 and 5");
+    const int N = x_dims[0];
+    const int C = layout == DataLayout::kNCHW ? x_dims[1]
+                                              : x_dims[x_dims.size() - 1];
+    const int num = x->numel();
+    const int M = num / C;
+    const int HxW = M / N;
+    PADDLE_ENFORCE_EQ(scale->dims().size(), 1UL);
+    PADDLE_ENFORCE_EQ(scale->dims()[0], C);
+
+    auto *d_x = ctx.Output<Tensor>(framework::GradVarName("X"));
+    auto *d_scale = ctx.Output<Tensor>(framework::GradVarName("Scale"));
+    auto *d_bias = ctx.Output<Tensor>(framework::GradVarName("Bias"));
+    d_x->mutable_data<T>(ctx.GetPlace());
+    U *d_scale_data = nullptr;
+    U *d_bias_data = nullptr;
+    if (d_scale && d_bias) {
+      d_scale_data = d_scale->mutable_data<U>(ctx.GetPlace());
+      d_bias_data = d_bias->mutable_data<U>(ctx.GetPlace());
+    }
+
+    auto &dev_ctx = ctx.template device_context<DeviceContext>();
+    const int block = 512;
+    const int max_blocks =
+        std::max(dev_ctx.GetMaxPhysicalThreadCount() / block, 1);
+
+    const U *mean_data = nullptr;
+    const U *inv_std_data = nullptr;
+    Tensor inv_std;
+    if (use_global_stats) {
+      const auto *running_mean = ctx.Input<Tensor>("Mean");
+      const auto *running_var = ctx.Input<Tensor>("Variance");
+      inv_std = ctx.AllocateTmpTensor<U, DeviceContext>({C}, dev_ctx);
+      KeInvStd<U><<<(C + block - 1) / block, block, 0, dev_ctx.stream()>>>(
+          running_var->data<U>(), epsilon, C, inv_std.data<U>());
+      mean_data = running_mean->data<U>();
+      inv_std_data = inv_std.data<U>();
+    } else {
+      mean_data = ctx.Input<Tensor>("SavedMean")->data<U>();
+      inv_std_data = ctx.Input<Tensor>("SavedVariance")->data<U>();
+    }
+
+    Tensor sums =
+        ctx.AllocateTmpTensor<U, DeviceContext>({2 * C + 1}, dev_ctx);
+    int grid = std::min(C, max_blocks);
+    if (layout == DataLayout::kNCHW) {
+      KeLocalGradSums<T, block, DataLayout::kNCHW><<<grid, block, 0,
+                                                     dev_ctx.stream()>>>(
+          d_y->data<T>(), x->data<T>(), mean_data, inv_std_data, C, HxW, M,
+          sums.data<U>(), d_scale_data, d_bias_data);
+    } else {
+      KeLocalGradSums<T, block, DataLayout::kNHWC><<<grid, block, 0,
+                                                     dev_ctx.stream()>>>(
+          d_y->data<T>(), x->data<T>(), mean_data, inv_std_data, C, HxW, M,
+          sums.data<U>(), d_scale_data, d_bias_data);
+    }
+
+    const U *sums_data = nullptr;
+    if (!use_global_stats) {
+      int nranks;
+      ncclComm_t comm = GetComm(dev_ctx, &nranks);
+      if (nranks > 1) {
+        PADDLE_ENFORCE(platform::dynload::ncclAllReduce(
+            sums.data<U>(), sums.data<U>(), 2 * C + 1,
+            platform::ToNCCLDataType(framework::ToDataType(typeid(U))),
+            ncclSum, comm, dev_ctx.stream()));
+      }
+      sums_data = sums.data<U>();
+    }
+
+    grid = (num + block - 1) / block;
+    if (layout == DataLayout::kNCHW) {
+      KeBackwardData<T, DataLayout::kNCHW><<<grid, block, 0,
+                                             dev_ctx.stream()>>>(
+          d_y->data<T>(), x->data<T>(), scale->data<U>(), mean_data,
+          inv_std_data, sums_data, C, HxW, num, d_x->data<T>());
+    } else {
+      KeBackwardData<T, DataLayout::kNHWC><<<grid, block, 0,
+                                             dev_ctx.stream()>>>(
+          d_y->data<T>(), x->data<T>(), scale->data<U>(), mean_data,
+          inv_std_data, sums_data, C, HxW, num, d_x->data<T>());
+    }
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+namespace plat = paddle::platform;
+REGISTER_OP_CUDA_KERNEL(
+    sync_batch_norm,
+    ops::SyncBatchNormKernel<plat::CUDADeviceContext, float>,
+    ops::SyncBatchNormKernel<plat::CUDADeviceContext, double>,
+    ops::SyncBatchNormKernel<plat::CUDADeviceContext, plat::float16>);
+REGISTER_OP_CUDA_KERNEL(
+    sync_batch_norm_grad,
+    ops::SyncBatchNormGradKernel<plat::CUDADeviceContext, float>,
+    ops::SyncBatchNormGradKernel<plat::CUDADeviceContext, double>,
+    ops::SyncBatchNormGradKernel<plat::CUDADeviceContext, plat::float16>);
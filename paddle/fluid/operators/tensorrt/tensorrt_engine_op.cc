@@ -31,6 +31,25 @@ class TensorRTEngineOpMaker : public framework::OpProtoAndCheckerMaker {
     AddAttr<std::string>("subgraph", "the subgraph.");
     AddAttr<int>("max_batch_size", "the maximum batch size.");
     AddAttr<int>("workspace_size", "the workspace size.");
+    AddAttr<int>("precision_mode",
+                 "the precision of the engine, 0 for FP32, 1 for FP16 and 2 "
+                 "for INT8.")
+        .SetDefault(0);
+    AddAttr<int>("calibration_batch_num",
+                 "the number of batches to calibrate the INT8 engine.")
+        .SetDefault(10);
+    AddAttr<int>("max_shape_engines",
+                 "the max number of the engines kept for the different "
+                 "shapes of the inputs except the batch, the least recently "
+                 "used one is dropped for a new shape.")
+        .SetDefault(1);
+    AddAttr<std::string>("engine_key",
+                         "the key of the subgraph to cache the engine.")
+        .SetDefault("");
+    AddAttr<std::string>("engine_cache_dir",
+                         "the directory to cache the serialized engine, the "
+                         "cache is disabled if empty.")
+        .SetDefault("");
     AddComment("TensorRT engine operator.");
   }
 };
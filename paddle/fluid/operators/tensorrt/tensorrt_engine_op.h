@@ -16,14 +16,24 @@
 
 #ifdef PADDLE_WITH_CUDA
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <list>
+#include <sstream>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/run_context.h"
+#include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/inference/analysis/helper.h"
 #include "paddle/fluid/inference/tensorrt/convert/op_converter.h"
 #include "paddle/fluid/inference/tensorrt/engine.h"
+#include "paddle/fluid/platform/gpu_info.h"
 
 namespace paddle {
 
@@ -62,14 +72,35 @@ nvinfer1::Dims Vec2TRT_Dims(const std::vector<int64_t> &shape) {
 
 using inference::Singleton;
 using inference::tensorrt::TensorRTEngine;
+using inference::tensorrt::TRTInt8Calibrator;
 
 class TensorRTEngineOp : public framework::OperatorBase {
  private:
+  // The engine built for the shapes of the inputs except the batch, since
+  // the TensorRT engine takes the fixed shapes of a sample.
+  struct ShapeEngine {
+    std::unique_ptr<TensorRTEngine> engine;
+    // The key to cache the engine, empty if the cache is not enabled.
+    std::string key;
+    // Without a calibration table, the INT8 engine is built after the
+    // inputs of the first calibration_batch_num_ runs are collected, and an
+    // FP32 engine is used in these runs.
+    bool calibrating{false};
+    std::vector<std::unordered_map<std::string, framework::LoDTensor>>
+        calib_data;
+  };
+
   std::vector<std::string> input_names_;
   std::unordered_set<std::string> param_names_;
-  mutable std::unique_ptr<TensorRTEngine> trt_engine_;
   int max_batch_size_;
   int workspace_size_;
+  inference::tensorrt::Precision precision_;
+  int calibration_batch_num_;
+  int max_shape_engines_;
+
+  // The engines of the input shapes, the most recently used first. The
+  // least recently used one is dropped if there are max_shape_engines_.
+  mutable std::list<std::pair<std::string, ShapeEngine>> engines_;
 
  public:
   TensorRTEngineOp(const std::string &type,
@@ -80,6 +111,10 @@ class TensorRTEngineOp : public framework::OperatorBase {
     input_names_ = Inputs("Xs");
     max_batch_size_ = Attr<int>("max_batch_size");
     workspace_size_ = Attr<int>("workspace_size");
+    precision_ = static_cast<inference::tensorrt::Precision>(
+        Attr<int>("precision_mode"));
+    calibration_batch_num_ = Attr<int>("calibration_batch_num");
+    max_shape_engines_ = std::max(Attr<int>("max_shape_engines"), 1);
 
     auto params = Attr<std::vector<std::string>>("parameters");
     for (const auto &param : params) {
@@ -93,51 +128,87 @@ class TensorRTEngineOp : public framework::OperatorBase {
     RunTrt(scope, dev_place);
   }
 
+  // The shapes of the inputs except the batch.
+  std::string ShapeKey(const framework::Scope &scope) const {
+    std::stringstream ss;
+    for (const auto &x : input_names_) {
+      if (param_names_.count(x)) continue;
+      auto &t =
+          inference::analysis::GetFromScope<framework::LoDTensor>(scope, x);
+      ss << framework::slice_ddim(t.dims(), 1, t.dims().size()) << ";";
+    }
+    return ss.str();
+  }
+
+  // The engine of the input shapes of this run, which is loaded or built if
+  // it is a new shape.
+  ShapeEngine *GetShapeEngine(const framework::Scope &scope,
+                              const platform::Place &dev_place) const {
+    std::string shape_key = ShapeKey(scope);
+    for (auto it = engines_.begin(); it != engines_.end(); ++it) {
+      if (it->first == shape_key) {
+        engines_.splice(engines_.begin(), engines_, it);
+        return &engines_.front().second;
+      }
+    }
+    if (static_cast<int>(engines_.size()) >= max_shape_engines_) {
+      VLOG(3) << "Drop the TensorRT engine of the input shapes "
+              << engines_.back().first;
+      engines_.pop_back();
+    }
+    VLOG(3) << "Prepare the TensorRT engine of the input shapes "
+            << shape_key;
+    engines_.emplace_front(shape_key, ShapeEngine());
+    auto *slot = &engines_.front().second;
+    PrepareEngine(scope, dev_place, slot);
+    return slot;
+  }
+
   void RunTrt(const framework::Scope &scope,
               const platform::Place &dev_place) const {
     int runtime_batch = 1;
-    if (trt_engine_.get() == nullptr) {
-      trt_engine_.reset(new TensorRTEngine(
-          max_batch_size_, workspace_size_, nullptr,
-          boost::get<platform::CUDAPlace>(dev_place).device));
-      Prepare(scope, dev_place, trt_engine_.get());
+    PADDLE_ENFORCE(!input_names_.empty(), "should pass more than one inputs");
+    // The run is checked at the boundary of the subgraph, for the executors
+    // not checking it between the ops, and again after the engine is
+    // prepared, which takes long for a new shape.
+    framework::CheckRunContext();
+    auto *slot = GetShapeEngine(scope, dev_place);
+    framework::CheckRunContext();
+    if (slot->calibrating) {
+      CollectCalibrationBatch(scope, dev_place, slot);
     }
 
-    auto *engine = trt_engine_.get();
-    PADDLE_ENFORCE(!input_names_.empty(), "should pass more than one inputs");
+    auto *engine = slot->engine.get();
 
     std::vector<std::string> output_maps =
         Attr<std::vector<std::string>>("output_name_mapping");
 
-    // Convert input tensor from fluid to engine.
+    // The engine runs on the memory of the fluid tensors, except the inputs
+    // on CPU, which are copied to the buffers of the engine.
+    std::vector<void *> buffers(engine->GetNbBindings(), nullptr);
     for (const auto &x : Inputs("Xs")) {
       if (param_names_.count(x)) continue;
-      // convert input and copy to TRT engine's buffer
       auto &t =
           inference::analysis::GetFromScope<framework::LoDTensor>(scope, x);
       auto t_shape = framework::vectorize(t.dims());
       runtime_batch = t_shape[0];
+      int bind_index = engine->GetBindingIndex(x);
       if (platform::is_cpu_place(t.place())) {
         engine->SetInputFromCPU(x, static_cast<const void *>(t.data<void>()),
                                 t.memory_size());
+        buffers[bind_index] = engine->buffer(x).buffer;
       } else {
-        engine->SetInputFromGPU(x, static_cast<const void *>(t.data<void>()),
-                                t.memory_size());
+        buffers[bind_index] = const_cast<void *>(t.data<void>());
       }
     }
 
     PADDLE_ENFORCE_LE(runtime_batch, max_batch_size_);
-    // Execute the engine.
-    engine->Execute(runtime_batch);
-
-    // Convert output tensor from engine to fluid
+    // The outputs are written to the fluid tensors by the engine.
     int output_index = 0;
     VLOG(4) << "TensorRT Engine Op Outputs:";
     for (const auto &y : Outputs("Ys")) {
       VLOG(4) << y;
-      // convert output and copy to fluid.
-      nvinfer1::ITensor *trt_t = engine->GetITensor(output_maps[output_index]);
-      auto dims = trt_t->getDimensions();
+      auto dims = engine->GetBindingDims(output_maps[output_index]);
       // Use the output ITensor's dims to reshape the Fluid Tensor.
       // The ITensor doesn't contain the batch size dim.
       std::vector<int> ddim;
@@ -153,17 +224,103 @@ class TensorRTEngineOp : public framework::OperatorBase {
       fluid_t->Resize(framework::make_ddim(ddim));
 
       // TODO(Superjomn) change this float to dtype size.
-      auto size =
-          inference::analysis::AccuDims(dims.d, dims.nbDims) * runtime_batch;
-      engine->GetOutputInGPU(
-          output_maps[output_index],
-          fluid_t->mutable_data<float>(platform::CUDAPlace(
-              boost::get<platform::CUDAPlace>(dev_place).device)),
-          size * sizeof(float));
+      int bind_index = engine->GetBindingIndex(output_maps[output_index]);
+      buffers[bind_index] = fluid_t->mutable_data<float>(platform::CUDAPlace(
+          boost::get<platform::CUDAPlace>(dev_place).device));
       output_index += 1;
     }
 
+    // Execute the engine.
+    engine->Execute(runtime_batch, &buffers);
+
     cudaStreamSynchronize(*engine->stream());
+
+    if (slot->calibrating &&
+        static_cast<int>(slot->calib_data.size()) >= calibration_batch_num_) {
+      BuildInt8Engine(scope, dev_place, slot);
+    }
+  }
+
+  TensorRTEngine *NewEngine(const platform::Place &dev_place) const {
+    auto *engine = new TensorRTEngine(
+        max_batch_size_, workspace_size_, nullptr,
+        boost::get<platform::CUDAPlace>(dev_place).device);
+    engine->SetPrecision(precision_);
+    return engine;
+  }
+
+  // Load the engine from the cache, or build it.
+  void PrepareEngine(const framework::Scope &scope,
+                     const platform::Place &dev_place,
+                     ShapeEngine *slot) const {
+    slot->engine.reset(NewEngine(dev_place));
+    slot->key = EngineKey(scope, dev_place);
+    auto *engine = slot->engine.get();
+    if (!slot->key.empty() && LoadEngine(engine, slot->key)) return;
+
+    std::unique_ptr<TRTInt8Calibrator> calibrator;
+    if (precision_ == inference::tensorrt::Precision::kInt8) {
+      std::string table_path = CachePath("trt_calib_", slot->key, ".table");
+      if (TRTInt8Calibrator::ReadTable(table_path).empty()) {
+        PADDLE_ENFORCE_GT(calibration_batch_num_, 0,
+                          "INT8 engine needs calibration batches");
+        VLOG(3) << "Run FP32 engine to collect the INT8 calibration batches";
+        slot->calibrating = true;
+        engine->SetPrecision(inference::tensorrt::Precision::kFloat32);
+        Prepare(scope, dev_place, engine);
+        return;
+      }
+      calibrator.reset(new TRTInt8Calibrator(table_path));
+      engine->SetInt8Calibrator(calibrator.get());
+    }
+    Prepare(scope, dev_place, engine);
+    engine->SetInt8Calibrator(nullptr);
+    SaveEngine(engine, slot->key);
+  }
+
+  void CollectCalibrationBatch(const framework::Scope &scope,
+                               const platform::Place &dev_place,
+                               ShapeEngine *slot) const {
+    std::unordered_map<std::string, framework::LoDTensor> batch;
+    for (const auto &x : input_names_) {
+      if (param_names_.count(x)) continue;
+      auto &t =
+          inference::analysis::GetFromScope<framework::LoDTensor>(scope, x);
+      if (!slot->calib_data.empty() &&
+          slot->calib_data.front().at(x).dims() != t.dims()) {
+        LOG(WARNING) << "Skip the INT8 calibration batch of a different shape";
+        return;
+      }
+      framework::TensorCopySync(t, dev_place, &batch[x]);
+    }
+    slot->calib_data.push_back(std::move(batch));
+  }
+
+  void BuildInt8Engine(const framework::Scope &scope,
+                       const platform::Place &dev_place,
+                       ShapeEngine *slot) const {
+    VLOG(3) << "Build INT8 engine with " << slot->calib_data.size()
+            << " calibration batches";
+    std::vector<TRTInt8Calibrator::Batch> batches;
+    for (auto &data : slot->calib_data) {
+      TRTInt8Calibrator::Batch batch;
+      for (auto &item : data) {
+        batch[item.first] = item.second.data<void>();
+      }
+      batches.push_back(std::move(batch));
+    }
+    int batch_size = slot->calib_data.front().begin()->second.dims()[0];
+    TRTInt8Calibrator calibrator(batch_size, batches,
+                                 CachePath("trt_calib_", slot->key, ".table"));
+    std::unique_ptr<TensorRTEngine> engine(NewEngine(dev_place));
+    engine->SetInt8Calibrator(&calibrator);
+    Prepare(scope, dev_place, engine.get());
+    engine->SetInt8Calibrator(nullptr);
+
+    slot->engine = std::move(engine);
+    slot->calibrating = false;
+    slot->calib_data.clear();
+    SaveEngine(slot->engine.get(), slot->key);
   }
 
   void Prepare(const framework::Scope &scope, const platform::Place &dev_place,
@@ -210,6 +367,86 @@ class TensorRTEngineOp : public framework::OperatorBase {
     }
     engine->FreezeNetwork();
   }
+
+  // The key to cache the engine, or empty if the cache is not enabled.
+  // Besides the subgraph, the engine depends on the input shapes, the
+  // parameters, the GPU model and the TensorRT version.
+  std::string EngineKey(const framework::Scope &scope,
+                        const platform::Place &dev_place) const {
+    if (Attr<std::string>("engine_cache_dir").empty()) return "";
+
+    std::stringstream ss;
+    ss << Attr<std::string>("engine_key");
+    std::hash<std::string> hash_fn;
+    framework::Tensor cpu_t;
+    // The order of the inputs is not stable between runs.
+    std::vector<std::string> input_names(input_names_);
+    std::sort(input_names.begin(), input_names.end());
+    for (const auto &x : input_names) {
+      auto &t =
+          inference::analysis::GetFromScope<framework::LoDTensor>(scope, x);
+      if (param_names_.count(x)) {
+        // The weights are built into the engine.
+        framework::TensorCopySync(t, platform::CPUPlace(), &cpu_t);
+        ss << ";" << x << ":"
+           << hash_fn(std::string(static_cast<const char *>(cpu_t.data<void>()),
+                                  cpu_t.memory_size()));
+      } else {
+        ss << ";" << x << ":"
+           << framework::slice_ddim(t.dims(), 1, t.dims().size());
+      }
+    }
+    int device = boost::get<platform::CUDAPlace>(dev_place).device;
+    ss << ";gpu=" << platform::GetCUDADeviceName(device)
+       << ";trt=" << NV_TENSORRT_VERSION;
+    return std::to_string(hash_fn(ss.str()));
+  }
+
+  // The file of the engine key in the cache directory, or empty if the
+  // cache is not enabled.
+  std::string CachePath(const std::string &prefix, const std::string &key,
+                        const std::string &suffix) const {
+    if (key.empty()) return "";
+    return Attr<std::string>("engine_cache_dir") + "/" + prefix + key + suffix;
+  }
+
+  bool LoadEngine(TensorRTEngine *engine, const std::string &key) const {
+    auto path = CachePath("trt_engine_", key, ".engine");
+    std::ifstream fin(path, std::ios::in | std::ios::binary);
+    if (!fin.is_open()) return false;
+    std::string engine_data((std::istreambuf_iterator<char>(fin)),
+                            std::istreambuf_iterator<char>());
+    VLOG(3) << "Deserialize TensorRT engine from " << path;
+    engine->Deserialize(engine_data);
+    return true;
+  }
+
+  void SaveEngine(TensorRTEngine *engine, const std::string &key) const {
+    if (key.empty()) return;
+    if (engine->HasPlugin()) {
+      VLOG(3) << "TensorRT engine with plugins is not cached";
+      return;
+    }
+    auto path = CachePath("trt_engine_", key, ".engine");
+    std::string engine_data = engine->Serialize();
+    // Write to a temporary file first, so that the predictors starting
+    // concurrently never load a partial engine.
+    std::string tmp_path = path + ".tmp";
+    {
+      std::ofstream fout(tmp_path, std::ios::out | std::ios::binary);
+      fout.write(engine_data.data(), engine_data.size());
+      if (!fout.good()) {
+        LOG(WARNING) << "Failed to cache the TensorRT engine to " << path;
+        return;
+      }
+    }
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+      LOG(WARNING) << "Failed to cache the TensorRT engine to " << path;
+      std::remove(tmp_path.c_str());
+      return;
+    }
+    VLOG(3) << "Serialize TensorRT engine to " << path;
+  }
 };
 
 }  // namespace operators
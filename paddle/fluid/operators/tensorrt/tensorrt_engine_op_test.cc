@@ -212,7 +212,52 @@ void Execute(int batch_size, int input_dim, int output_dim, int nlayers = 1) {
 // Test with a larger FC layer.
 TEST(TensorRTEngineOp, fc) { Execute(40, 28, 28); }
 
+// The engines of the different input shapes are kept, and the least
+// recently used one is dropped for a new shape.
+TEST(TensorRTEngineOp, shape_engines) {
+  framework::ProgramDesc program;
+  auto* block_ = program.Proto()->add_blocks();
+  block_->set_idx(0);
+  block_->set_parent_idx(-1);
+  framework::BlockDesc block_desc(&program, block_);
+  auto* relu = block_desc.AppendOp();
+  relu->SetType("relu");
+  relu->SetInput("X", std::vector<std::string>({"x"}));
+  relu->SetOutput("Out", std::vector<std::string>({"y"}));
+  AddTensorToBlockDesc(block_, "x", std::vector<int64_t>({2, 3, 4, 4}));
+  AddTensorToBlockDesc(block_, "y", std::vector<int64_t>({2, 3, 4, 4}));
+  *block_->add_ops() = *relu->Proto();
+
+  framework::OpDesc engine_op_desc(nullptr);
+  engine_op_desc.SetType("tensorrt_engine");
+  engine_op_desc.SetInput("Xs", std::vector<std::string>({"x"}));
+  engine_op_desc.SetOutput("Ys", std::vector<std::string>({"y"}));
+  SetAttr<std::string>(engine_op_desc.Proto(), "subgraph",
+                       block_->SerializeAsString());
+  SetAttr<int>(engine_op_desc.Proto(), "max_batch_size", 2);
+  SetAttr<int>(engine_op_desc.Proto(), "workspace_size", 2 << 10);
+  SetAttr<int>(engine_op_desc.Proto(), "max_shape_engines", 2);
+  SetAttr<std::vector<std::string>>(engine_op_desc.Proto(), "parameters",
+                                    std::vector<std::string>({}));
+  SetAttr<std::vector<std::string>>(engine_op_desc.Proto(),
+                                    "output_name_mapping",
+                                    std::vector<std::string>({"y"}));
+  auto engine_op = framework::OpRegistry::CreateOp(*engine_op_desc.Proto());
+
+  framework::Scope scope;
+  platform::CUDAPlace place;
+  scope.Var("y")->GetMutable<framework::LoDTensor>();
+  for (auto shape : std::vector<std::vector<int64_t>>(
+           {{2, 3, 4, 4}, {2, 3, 6, 5}, {1, 3, 4, 4}, {1, 3, 2, 2}})) {
+    CreateCUDATensor(&scope, "x", shape);
+    engine_op->Run(scope, place);
+    auto& y = scope.FindVar("y")->Get<framework::LoDTensor>();
+    ASSERT_EQ(y.dims(), framework::make_ddim(shape));
+  }
+}
+
 }  // namespace operators
 }  // namespace paddle
 
 USE_TRT_CONVERTER(fc)
+USE_TRT_CONVERTER(relu)
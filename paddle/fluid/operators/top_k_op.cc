@@ -34,6 +34,14 @@ class TopkOp : public framework::OperatorWithKernel {
 
     PADDLE_ENFORCE_GE(k, 1, "k must >= 1");
     PADDLE_ENFORCE_GE(input_dims.size(), 1, "input must have >= 1d shape");
+    if (ctx->Attrs().Get<bool>("segmented")) {
+      PADDLE_ENFORCE(input_dims.size() == 2 && input_dims[1] == 1,
+                     "The segmented input must be a [N, 1] LoDTensor.");
+      // The LoD and the height of the outputs are set by the kernels.
+      ctx->SetOutputDim("Out", {-1, 1});
+      ctx->SetOutputDim("Indices", {-1, 1});
+      return;
+    }
     PADDLE_ENFORCE_GE(input_dims[input_dims.size() - 1], k,
                       "input must have >= k columns");
 
@@ -72,11 +80,20 @@ If the input is a vector (1d tensor), this operator finds the k largest
 entries in the vector and outputs their values and indices as vectors. 
 Thus values[j] is the j-th largest entry in input, and its index is indices[j].
 
-For matrices, this operator computes the top k entries in each row. )DOC");
+For matrices, this operator computes the top k entries in each row.
+
+If segmented is true, the input is a [N, 1] LoDTensor, and this operator
+computes the top min(k, length) entries of each sequence, whose indices are
+the ones in the sequence; the outputs are [M, 1] LoDTensors of the LoD of
+the top entries of the sequences. )DOC");
     AddAttr<int>("k",
                  "(int, default 1) Number of top elements to look for along "
                  "the last dimension (along each row for matrices).")
         .SetDefault(1);
+    AddAttr<bool>("segmented",
+                  "(bool, default false) Look for the top elements of each "
+                  "sequence of the [N, 1] input of LoD level 1.")
+        .SetDefault(false);
   }
 };
 
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/segmented_topk.cu.h"
 #include "paddle/fluid/operators/top_k_op.h"
 #include "paddle/fluid/platform/assert.h"
 #include "paddle/fluid/platform/cuda_device_function.h"
@@ -304,6 +305,14 @@ inline static int GetDesiredBlockDim(int dim) {
   }
 }
 
+// The max extraction of KeMatrixTopK takes k / MaxLength rounds of the
+// reduction of the block, and a block of at most 256 threads a row, the radix
+// select is faster for the large k and the long rows, and for the few rows,
+// which are too few blocks.
+inline static bool UseRadixTopK(int64_t rows, int64_t cols, int64_t k) {
+  return k > 64 || cols > 16384 || (rows < 64 && cols > 4096);
+}
+
 #define FIXED_BLOCK_DIM_BASE(dim, ...) \
   case (dim): {                        \
     constexpr auto kBlockDim = (dim);  \
@@ -332,6 +341,12 @@ class TopkOpCUDAKernel : public framework::OpKernel<T> {
       Tensor k_host;
       framework::TensorCopySync(*k_t, platform::CPUPlace(), &k_host);
       k = k_host.data<int>()[0];
+    }
+    if (ctx.Attr<bool>("segmented")) {
+      SegmentedTopK(ctx, k);
+      return;
+    }
+    if (k_t) {
       framework::DDim output_dims = output->dims();
       output_dims[output_dims.size() - 1] = k;
       output->Resize(output_dims);
@@ -353,9 +368,20 @@ class TopkOpCUDAKernel : public framework::OpKernel<T> {
     // NOTE: pass lds and dim same to input width.
     // NOTE: old matrix implementation of stride is different to eigen.
     // TODO(typhoonzero): refine this kernel.
+    auto& dev_ctx = ctx.cuda_device_context();
+    if (UseRadixTopK(input_height, input_width, k)) {
+      Tensor offsets;
+      const int* out_offsets = math::UniformSegmentOffsets(
+          dev_ctx, input_height, static_cast<int>(k), &offsets);
+      math::RadixTopK<T>(dev_ctx, input_data, nullptr, input_width,
+                         input_height, static_cast<int>(k), out_offsets,
+                         static_cast<int>(input_height * k), output_data,
+                         indices_data);
+      return;
+    }
+
     const int kMaxHeight = 2048;
     int gridx = input_height < kMaxHeight ? input_height : kMaxHeight;
-    auto& dev_ctx = ctx.cuda_device_context();
     switch (GetDesiredBlockDim(input_width)) {
       FIXED_BLOCK_DIM(
           KeMatrixTopK<T, 5,
@@ -366,6 +392,34 @@ class TopkOpCUDAKernel : public framework::OpKernel<T> {
         PADDLE_THROW("Error");
     }
   }
+
+ private:
+  void SegmentedTopK(const framework::ExecutionContext& ctx, size_t k) const {
+    auto* input = ctx.Input<framework::LoDTensor>("X");
+    auto* output = ctx.Output<framework::LoDTensor>("Out");
+    auto* indices = ctx.Output<framework::LoDTensor>("Indices");
+    PADDLE_ENFORCE_EQ(input->lod().size(), 1UL,
+                      "The segmented input should be of LoD level 1.");
+    auto& lod = input->lod()[0];
+    auto out_lod = SegmentedTopKLoD(lod, k);
+    int64_t num_out = static_cast<int64_t>(out_lod.back());
+    output->Resize({num_out, 1});
+    indices->Resize({num_out, 1});
+    output->set_lod({out_lod});
+    indices->set_lod({out_lod});
+    T* output_data = output->mutable_data<T>(ctx.GetPlace());
+    int64_t* indices_data = indices->mutable_data<int64_t>(ctx.GetPlace());
+
+    framework::Vector<int> out_offsets(out_lod.size());
+    for (size_t i = 0; i < out_lod.size(); ++i) {
+      out_offsets[i] = static_cast<int>(out_lod[i]);
+    }
+    math::RadixTopK<T>(ctx.cuda_device_context(), input->data<T>(),
+                       lod.CUDAData(ctx.GetPlace()), 0,
+                       static_cast<int>(lod.size()) - 1, static_cast<int>(k),
+                       out_offsets.CUDAData(ctx.GetPlace()),
+                       static_cast<int>(num_out), output_data, indices_data);
+  }
 };
 
 #undef FIXED_BLOCK_DIM_BASE
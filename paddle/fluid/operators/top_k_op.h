@@ -18,6 +18,7 @@ limitations under the License. */
 #include <utility>
 #include <vector>
 #include "paddle/fluid/framework/eigen.h"
+#include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
 
 namespace paddle {
@@ -29,6 +30,18 @@ template <typename T, int MajorType = Eigen::RowMajor,
           typename IndexType = Eigen::DenseIndex>
 using EigenMatrix = framework::EigenMatrix<T, MajorType, IndexType>;
 
+// The LoD of the segmented top k of the sequences of lod, every sequence
+// has its min(k, length) top entries.
+inline framework::Vector<size_t> SegmentedTopKLoD(
+    const framework::Vector<size_t>& lod, size_t k) {
+  framework::Vector<size_t> out_lod(lod.size());
+  out_lod[0] = 0;
+  for (size_t i = 0; i + 1 < lod.size(); ++i) {
+    out_lod[i + 1] = out_lod[i] + std::min(k, lod[i + 1] - lod[i]);
+  }
+  return out_lod;
+}
+
 template <typename DeviceContext, typename T>
 class TopkKernel : public framework::OpKernel<T> {
  public:
@@ -40,6 +53,11 @@ class TopkKernel : public framework::OpKernel<T> {
 
     size_t k = static_cast<int>(ctx.Attr<int>("k"));
     auto* k_t = ctx.Input<Tensor>("K");
+    if (ctx.Attr<bool>("segmented")) {
+      if (k_t) k = k_t->data<int>()[0];
+      SegmentedTopK(ctx, k);
+      return;
+    }
     if (k_t) {
       k = k_t->data<int>()[0];
       framework::DDim output_dims = output->dims();
@@ -81,6 +99,43 @@ class TopkKernel : public framework::OpKernel<T> {
       }
     }
   }
+
+ private:
+  void SegmentedTopK(const framework::ExecutionContext& ctx, size_t k) const {
+    auto* input = ctx.Input<framework::LoDTensor>("X");
+    auto* output = ctx.Output<framework::LoDTensor>("Out");
+    auto* indices = ctx.Output<framework::LoDTensor>("Indices");
+    PADDLE_ENFORCE_EQ(input->lod().size(), 1UL,
+                      "The segmented input should be of LoD level 1.");
+    auto& lod = input->lod()[0];
+    auto out_lod = SegmentedTopKLoD(lod, k);
+    int64_t num_out = static_cast<int64_t>(out_lod.back());
+    output->Resize({num_out, 1});
+    indices->Resize({num_out, 1});
+    output->set_lod({out_lod});
+    indices->set_lod({out_lod});
+
+    const T* input_data = input->data<T>();
+    T* output_data = output->mutable_data<T>(ctx.GetPlace());
+    int64_t* indices_data = indices->mutable_data<int64_t>(ctx.GetPlace());
+    for (size_t i = 0; i + 1 < lod.size(); ++i) {
+      std::vector<std::pair<T, size_t>> vec;
+      vec.reserve(lod[i + 1] - lod[i]);
+      for (size_t j = lod[i]; j < lod[i + 1]; ++j) {
+        vec.push_back(std::pair<T, size_t>(input_data[j], j - lod[i]));
+      }
+      size_t count = out_lod[i + 1] - out_lod[i];
+      std::partial_sort(
+          vec.begin(), vec.begin() + count, vec.end(),
+          [](const std::pair<T, size_t>& l, const std::pair<T, size_t>& r) {
+            return l.first > r.first;
+          });
+      for (size_t j = 0; j < count; ++j) {
+        output_data[out_lod[i] + j] = vec[j].first;
+        indices_data[out_lod[i] + j] = static_cast<int64_t>(vec[j].second);
+      }
+    }
+  }
 };
 
 }  // namespace operators
@@ -80,7 +80,8 @@ class WarpCTCOpMaker : public framework::OpProtoAndCheckerMaker {
               "(Tensor, default: Tensor<float>), a temporary "
               "output Tensor to store the gradients of warp-ctc, which is "
               "computed with loss together in one call. It is a 3-D Tensor of "
-              "the shape [max_sequence_length, batch_size, num_classes + 1].")
+              "the shape [max_sequence_length, batch_size, num_classes + 1], "
+              "or [Lp, num_classes + 1] if Attr(use_native) is true.")
         .AsIntermediate();
     AddOutput("Loss",
               "(Tensor, default: Tensor<float>), the Connectionist "
@@ -100,6 +101,13 @@ class WarpCTCOpMaker : public framework::OpProtoAndCheckerMaker {
                   "(bool, default: false), whether to "
                   "use cudnn kernel.")
         .SetDefault(false);
+    AddAttr<bool>("use_native",
+                  "(bool, default: false), whether to compute the loss by "
+                  "the native CTC of the sequences of the LoD instead of "
+                  "warp-ctc, which needs no padding of the logits to the max "
+                  "length, and whose Output(WarpCTCGrad) is of the shape of "
+                  "Input(Logits). The cudnn kernel ignores it.")
+        .SetDefault(false);
     AddComment(R"DOC(
 An operator integrating the open-source
 [warp-ctc](https://github.com/baidu-research/warp-ctc) library, which is used in
@@ -16,6 +16,7 @@ limitations under the License. */
 
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/ctc_loss.h"
 #include "paddle/fluid/operators/math/math_function.h"
 #include "paddle/fluid/operators/math/sequence_padding.h"
 #include "paddle/fluid/operators/math/sequence_scale.h"
@@ -152,6 +153,16 @@ class WarpCTCKernel : public framework::OpKernel<T> {
     auto loss_dims =
         framework::make_ddim({static_cast<int64_t>(num_sequences), 1});
 
+    if (ctx.Attr<bool>("use_native")) {
+      // The loss and the gradient are computed on the sequences of the LoD,
+      // the gradient is of the shape of the logits.
+      math::CTCLossFunctor<DeviceContext, T>()(
+          ctx.template device_context<DeviceContext>(), *logits,
+          logits_lod[level], *label, label_lod[level], ctx.Attr<int>("blank"),
+          ctx.Attr<bool>("norm_by_times"), loss, warpctc_grad);
+      return;
+    }
+
     // warpctc needs sequences data stored in transposed padding format
     LoDTensor warpctc_logits;
     const size_t max_sequence_length =
@@ -226,10 +237,16 @@ class WarpCTCGradKernel : public framework::OpKernel<T> {
     const Tensor* loss_grad = ctx.Input<Tensor>(framework::GradVarName("Loss"));
 
     logits_grad->mutable_data<T>(ctx.GetPlace());
-    bool norm_by_times = ctx.Attr<bool>("norm_by_times");
-    math::UnpaddingLoDTensorFunctor<DeviceContext, T>()(
-        ctx.template device_context<DeviceContext>(), *warpctc_grad,
-        logits_grad, -1, 0, norm_by_times, math::kLengthBatchWidth);
+    if (ctx.Attr<bool>("use_native")) {
+      // The native gradient is unpadded and normalized by times already.
+      framework::TensorCopy(*warpctc_grad, ctx.GetPlace(), ctx.device_context(),
+                            logits_grad);
+    } else {
+      bool norm_by_times = ctx.Attr<bool>("norm_by_times");
+      math::UnpaddingLoDTensorFunctor<DeviceContext, T>()(
+          ctx.template device_context<DeviceContext>(), *warpctc_grad,
+          logits_grad, -1, 0, norm_by_times, math::kLengthBatchWidth);
+    }
 
     const T* loss_grad_data = loss_grad->data<T>();
     math::ScaleLoDTensorFunctor<DeviceContext, T>()(
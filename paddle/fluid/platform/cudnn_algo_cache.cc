@@ -0,0 +1,117 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/cudnn_algo_cache.h"
+#include <cstdio>
+#include <fstream>
+#include "glog/logging.h"
+
+namespace paddle {
+namespace platform {
+
+// The first line of the file, bumped when the format changes.
+static constexpr char kCudnnAlgoCacheHeader[] = "paddle_cudnn_algo_cache 1";
+
+CudnnAlgoCache& CudnnAlgoCache::Instance() {
+  static CudnnAlgoCache cache;
+  return cache;
+}
+
+bool CudnnAlgoCache::Find(const std::string& key, int* algo) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = algos_.find(key);
+  if (it == algos_.end()) return false;
+  *algo = it->second;
+  return true;
+}
+
+void CudnnAlgoCache::Insert(const std::string& key, int algo) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = algos_.find(key);
+  if (it != algos_.end() && it->second == algo) return;
+  algos_[key] = algo;
+  dirty_ = true;
+}
+
+void CudnnAlgoCache::Load(const std::string& path) {
+  std::ifstream fin(path);
+  if (!fin.is_open()) {
+    VLOG(3) << "cuDNN algorithm cache " << path << " does not exist";
+    return;
+  }
+  std::string line;
+  if (!std::getline(fin, line) || line != kCudnnAlgoCacheHeader) {
+    LOG(WARNING) << "Ignore the cuDNN algorithm cache " << path
+                 << " of unknown format";
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t num_loaded = 0;
+  // Each line is the key and the algorithm separated by a tab.
+  while (std::getline(fin, line)) {
+    auto pos = line.rfind('\t');
+    if (pos == std::string::npos || pos == 0) continue;
+    try {
+      algos_[line.substr(0, pos)] = std::stoi(line.substr(pos + 1));
+      ++num_loaded;
+    } catch (const std::exception&) {
+      LOG(WARNING) << "Skip the invalid line in " << path << ": " << line;
+    }
+  }
+  VLOG(3) << "Load " << num_loaded << " cuDNN algorithms from " << path;
+}
+
+void CudnnAlgoCache::Save(const std::string& path) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!dirty_) return;
+  // Write to a temporary file first, so that the processes loading the
+  // cache concurrently never see a partial file.
+  std::string tmp_path = path + ".tmp";
+  {
+    std::ofstream fout(tmp_path);
+    if (!fout.is_open()) {
+      LOG(WARNING) << "Failed to save the cuDNN algorithm cache to " << path;
+      return;
+    }
+    fout << kCudnnAlgoCacheHeader << "\n";
+    for (auto& item : algos_) {
+      fout << item.first << "\t" << item.second << "\n";
+    }
+    if (!fout.good()) {
+      LOG(WARNING) << "Failed to save the cuDNN algorithm cache to " << path;
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    LOG(WARNING) << "Failed to save the cuDNN algorithm cache to " << path;
+    std::remove(tmp_path.c_str());
+    return;
+  }
+  dirty_ = false;
+  VLOG(3) << "Save " << algos_.size() << " cuDNN algorithms to " << path;
+}
+
+size_t CudnnAlgoCache::Size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return algos_.size();
+}
+
+void CudnnAlgoCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  algos_.clear();
+  dirty_ = false;
+}
+
+}  // namespace platform
+}  // namespace paddle
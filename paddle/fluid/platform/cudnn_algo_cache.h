@@ -0,0 +1,59 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+
+namespace paddle {
+namespace platform {
+
+/*
+ * CudnnAlgoCache keeps the cuDNN algorithms found by exhaustive search for
+ * the whole process, so that they can be saved to a file and loaded by the
+ * next process instead of being searched again.
+ *
+ * The key is built by the operator and must describe everything the best
+ * algorithm depends on, e.g. the GPU model, the cuDNN version, the shapes,
+ * the data type and the workspace limit. The value is the algorithm enum.
+ */
+class CudnnAlgoCache {
+ public:
+  static CudnnAlgoCache& Instance();
+
+  bool Find(const std::string& key, int* algo) const;
+  void Insert(const std::string& key, int algo);
+
+  // Merge the algorithms saved in the file into the cache. It is not an
+  // error if the file does not exist, which is the case of the first run.
+  void Load(const std::string& path);
+  // Write all the algorithms to the file if new ones were inserted since the
+  // last Load or Save.
+  void Save(const std::string& path);
+
+  size_t Size() const;
+  void Clear();
+
+ private:
+  CudnnAlgoCache() = default;
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, int> algos_;
+  bool dirty_{false};
+};
+
+}  // namespace platform
+}  // namespace paddle
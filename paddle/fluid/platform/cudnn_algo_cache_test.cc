@@ -0,0 +1,62 @@
+//  Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "paddle/fluid/platform/cudnn_algo_cache.h"
+#include <cstdio>
+#include <fstream>
+#include "gtest/gtest.h"
+
+using paddle::platform::CudnnAlgoCache;
+
+TEST(CudnnAlgoCache, SaveAndLoad) {
+  const std::string path = "cudnn_algo_cache_test.txt";
+  std::remove(path.c_str());
+  auto& cache = CudnnAlgoCache::Instance();
+  cache.Clear();
+
+  // Loading a file that does not exist leaves the cache empty.
+  cache.Load(path);
+  EXPECT_EQ(cache.Size(), 0UL);
+
+  cache.Insert("conv2d_fwd;x=1,3,224,224", 1);
+  cache.Insert("conv2d_bwd_data;x=1,3,224,224", 4);
+  cache.Save(path);
+
+  cache.Clear();
+  int algo = -1;
+  EXPECT_FALSE(cache.Find("conv2d_fwd;x=1,3,224,224", &algo));
+  cache.Load(path);
+  EXPECT_EQ(cache.Size(), 2UL);
+  EXPECT_TRUE(cache.Find("conv2d_fwd;x=1,3,224,224", &algo));
+  EXPECT_EQ(algo, 1);
+  EXPECT_TRUE(cache.Find("conv2d_bwd_data;x=1,3,224,224", &algo));
+  EXPECT_EQ(algo, 4);
+  std::remove(path.c_str());
+
+  // Nothing new is found after loading, so nothing is written.
+  cache.Save(path);
+  EXPECT_FALSE(std::ifstream(path).is_open());
+}
+
+TEST(CudnnAlgoCache, UnknownFormat) {
+  const std::string path = "cudnn_algo_cache_bad.txt";
+  {
+    std::ofstream fout(path);
+    fout << "some other file\nkey\t1\n";
+  }
+  auto& cache = CudnnAlgoCache::Instance();
+  cache.Clear();
+  cache.Load(path);
+  EXPECT_EQ(cache.Size(), 0UL);
+  std::remove(path.c_str());
+}
@@ -12,12 +12,15 @@ limitations under the License. */
 #include "paddle/fluid/platform/device_context.h"
 #include <set>
 #include <string>
+#include <thread>  // NOLINT
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "paddle/fluid/memory/memory.h"
 #ifdef PADDLE_WITH_CUDA
 #include "paddle/fluid/framework/rw_lock.h"
+#include "paddle/fluid/memory/allocation/stream_safe_cuda_allocator.h"
 #include "paddle/fluid/platform/cuda_device_guard.h"
 #endif
 
@@ -26,31 +29,140 @@ namespace platform {
 
 DeviceContextPool* DeviceContextPool::pool = nullptr;
 
+static thread_local DeviceContext* tls_dev_ctx = nullptr;
+static thread_local Place tls_dev_ctx_place;
+
 platform::DeviceContext* DeviceContextPool::Get(const platform::Place& place) {
+  if (UNLIKELY(tls_dev_ctx != nullptr) && tls_dev_ctx_place == place) {
+    return tls_dev_ctx;
+  }
   auto it = device_contexts_.find(place);
   if (it == device_contexts_.end()) {
     PADDLE_THROW(
         "'Place' is not supported, Please re-compile with WITH_GPU "
         "option");
   }
-  return it->second.get().get();
+  return it->second->Get();
+}
+
+platform::DeviceContext* DeviceContextPool::GetStreamContext(
+    const platform::Place& place, size_t stream_id) {
+  auto it = device_contexts_.find(place);
+  PADDLE_ENFORCE(it != device_contexts_.end(),
+                 "'Place' is not supported, Please re-compile with WITH_GPU "
+                 "option");
+  if (stream_id == 0 || !platform::is_gpu_place(place)) {
+    return it->second->Get();
+  }
+#ifdef PADDLE_WITH_CUDA
+  std::lock_guard<std::mutex> guard(stream_contexts_mutex_);
+  auto& contexts = stream_contexts_[place];
+  while (contexts.size() < stream_id) {
+    contexts.emplace_back(new CUDADeviceContext(boost::get<CUDAPlace>(place)));
+  }
+  return contexts[stream_id - 1].get();
+#else
+  PADDLE_THROW("Unexpected branch");
+#endif
+}
+
+void DeviceContextPool::WaitAllStreams(const platform::Place& place) {
+  GetStreamContext(place, 0)->Wait();
+  std::lock_guard<std::mutex> guard(stream_contexts_mutex_);
+  auto it = stream_contexts_.find(place);
+  if (it != stream_contexts_.end()) {
+    for (auto& dev_ctx : it->second) {
+      dev_ctx->Wait();
+    }
+  }
+}
+
+void DeviceContextPool::WarmUp(const std::vector<platform::Place>& places) {
+  // The pool is never destroyed, so the thread is detached.
+  std::thread([this, places] {
+    try {
+      for (auto& place : places) {
+        auto* dev_ctx = GetStreamContext(place, 0);
+#ifdef PADDLE_WITH_CUDA
+        if (platform::is_gpu_place(place)) {
+          static_cast<CUDADeviceContext*>(dev_ctx)->WarmUp();
+        }
+#endif
+        VLOG(3) << "The device context of " << place << " is warmed up";
+      }
+    } catch (std::exception& e) {
+      LOG(WARNING) << "Failed to warm up the device contexts: " << e.what();
+    }
+  }).detach();
+}
+
+void DeviceContextPool::EnablePeerAccess(int device) {
+#ifdef PADDLE_WITH_CUDA
+  std::lock_guard<std::mutex> guard(p2p_mutex_);
+  for (int peer : p2p_devices_) {
+    for (auto& pair :
+         {std::make_pair(device, peer), std::make_pair(peer, device)}) {
+      int can_access = -1;
+      PADDLE_ENFORCE(
+          cudaDeviceCanAccessPeer(&can_access, pair.first, pair.second),
+          "Failed to test P2P access.");
+      if (can_access != 1) {
+        LOG(WARNING) << "Cannot enable P2P access from " << pair.first
+                     << " to " << pair.second;
+      } else {
+        CUDADeviceGuard device_guard(pair.first);
+        cudaDeviceEnablePeerAccess(pair.second, 0);
+      }
+    }
+  }
+  p2p_devices_.push_back(device);
+#endif
+}
+
+DeviceContextGuard::DeviceContextGuard(DeviceContext* dev_ctx)
+    : prev_ctx_(tls_dev_ctx), prev_place_(tls_dev_ctx_place) {
+  PADDLE_ENFORCE_NOT_NULL(dev_ctx);
+  tls_dev_ctx = dev_ctx;
+  tls_dev_ctx_place = dev_ctx->GetPlace();
+}
+
+DeviceContextGuard::~DeviceContextGuard() {
+  tls_dev_ctx = prev_ctx_;
+  tls_dev_ctx_place = prev_place_;
+}
+
+// The GPU memory allocated by the operators is used on the stream of the
+// device context in the pool.
+static void SetAllocationStream(DeviceContext* dev_ctx) {
+#ifdef PADDLE_WITH_CUDA
+  auto* cuda_ctx = dynamic_cast<CUDADeviceContext*>(dev_ctx);
+  if (cuda_ctx != nullptr) {
+    memory::allocation::SetDefaultCUDAAllocationStream(
+        boost::get<CUDAPlace>(cuda_ctx->GetPlace()).device,
+        cuda_ctx->stream());
+  }
+#endif
 }
 
 template <typename DevCtx, typename PlaceType>
-inline void EmplaceDeviceContext(
-    std::map<Place, std::shared_future<std::unique_ptr<DeviceContext>>>*
-        map_ptr,
-    platform::Place p) {
-  using PtrType = std::unique_ptr<DeviceContext>;
-  map_ptr->emplace(p, std::async(std::launch::deferred, [=] {
-                     // lazy evaluation. i.e., only create device context at
-                     // first `Get`
-                     return PtrType(new DevCtx(boost::get<PlaceType>(p)));
-                   }));
+void DeviceContextPool::EmplaceDeviceContext(const platform::Place& place) {
+  auto* lazy_ctx = new LazyDeviceContext();
+  // Only create the device context at the first Get, so that no CUDA
+  // context is created on the visible GPUs which are not used.
+  lazy_ctx->create = [this, place]() -> DeviceContext* {
+    auto* dev_ctx = new DevCtx(boost::get<PlaceType>(place));
+    SetAllocationStream(dev_ctx);
+    if (init_p2p_ && platform::is_gpu_place(place)) {
+      EnablePeerAccess(boost::get<CUDAPlace>(place).device);
+    }
+    return dev_ctx;
+  };
+  device_contexts_[place].reset(lazy_ctx);
 }
 
 DeviceContextPool::DeviceContextPool(
-    const std::vector<platform::Place>& places) {
+    const std::vector<platform::Place>& places, bool init_p2p)
+    : init_p2p_(init_p2p) {
   PADDLE_ENFORCE_GT(places.size(), 0);
   std::set<Place> set;
   for (auto& p : places) {
@@ -60,13 +172,13 @@ DeviceContextPool::DeviceContextPool(
   for (auto& p : set) {
     if (platform::is_cpu_place(p)) {
 #ifdef PADDLE_WITH_MKLDNN
-      EmplaceDeviceContext<MKLDNNDeviceContext, CPUPlace>(&device_contexts_, p);
+      EmplaceDeviceContext<MKLDNNDeviceContext, CPUPlace>(p);
 #else
-      EmplaceDeviceContext<CPUDeviceContext, CPUPlace>(&device_contexts_, p);
+      EmplaceDeviceContext<CPUDeviceContext, CPUPlace>(p);
 #endif
     } else if (platform::is_gpu_place(p)) {
 #ifdef PADDLE_WITH_CUDA
-      EmplaceDeviceContext<CUDADeviceContext, CUDAPlace>(&device_contexts_, p);
+      EmplaceDeviceContext<CUDADeviceContext, CUDAPlace>(p);
 #else
       PADDLE_THROW(
           "'CUDAPlace' is not supported, Please re-compile with WITH_GPU "
@@ -74,8 +186,7 @@ DeviceContextPool::DeviceContextPool(
 #endif
     } else if (platform::is_cuda_pinned_place(p)) {
 #ifdef PADDLE_WITH_CUDA
-      EmplaceDeviceContext<CUDAPinnedDeviceContext, CUDAPinnedPlace>(
-          &device_contexts_, p);
+      EmplaceDeviceContext<CUDAPinnedDeviceContext, CUDAPinnedPlace>(p);
 #else
       PADDLE_THROW(
           "'CUDAPlace' is not supported, Please re-compile with WITH_GPU "
@@ -95,7 +206,7 @@ platform::TemporaryAllocator& DeviceTemporaryAllocator::Get(
   std::unique_lock<std::mutex> lock(mtx_);
   auto it = device_allocator_.find(place_stream);
   if (it == device_allocator_.end()) {
-    auto tmp_allocator = new TemporaryAllocator(place);
+    auto tmp_allocator = new TemporaryAllocator(place, stream);
     tmp_allocator->SetCallback([stream]() {
       PADDLE_ENFORCE(cudaStreamSynchronize(stream));
       PADDLE_ENFORCE(cudaGetLastError());
@@ -233,29 +344,27 @@ void CudnnHolder::ReallocateWorkspace(size_t required_workspace_len) {
                                      paddle::memory::Allocator::kScratchpad);
 }
 
+static cudaStream_t CreateStream(CUDAPlace place) {
+  CUDADeviceGuard guard(place.device);
+  cudaStream_t stream;
+  PADDLE_ENFORCE(cudaStreamCreate(&stream));
+  return stream;
+}
+
 CUDADeviceContext::CUDADeviceContext(CUDAPlace place)
-    : place_(place), cudnn_holder_(nullptr) {
+    : CUDADeviceContext(place, CreateStream(place)) {
+  owns_stream_ = true;
+}
+
+CUDADeviceContext::CUDADeviceContext(CUDAPlace place, cudaStream_t stream)
+    : place_(place),
+      cudnn_holder_(nullptr),
+      stream_(stream),
+      owns_stream_(false) {
   CUDADeviceGuard guard(place_.device);
   compute_capability_ = GetCUDAComputeCapability(place_.device);
   multi_process_ = GetCUDAMultiProcessors(place_.device);
   max_threads_per_mp_ = GetCUDAMaxThreadsPerMultiProcessor(place_.device);
-  PADDLE_ENFORCE(cudaStreamCreate(&stream_));
-  eigen_stream_.reset(new EigenCudaStreamDevice());
-  eigen_stream_->Reinitialize(&stream_, place);
-  eigen_device_.reset(new Eigen::GpuDevice(eigen_stream_.get()));
-  cublas_handle_.reset(new CublasHandleHolder(stream_, CUBLAS_DEFAULT_MATH));
-
-  if (TensorCoreAvailable()) {
-#if CUDA_VERSION >= 9000
-    cublas_tensor_core_handle_.reset(
-        new CublasHandleHolder(stream_, CUBLAS_TENSOR_OP_MATH));
-#endif
-  }
-
-  if (dynload::HasCUDNN()) {
-    cudnn_holder_.reset(new CudnnHolder(&stream_, place));
-  }
-
   driver_version_ = GetCUDADriverVersion(place_.device);
   runtime_version_ = GetCUDARuntimeVersion(place_.device);
 
@@ -266,13 +375,9 @@ CUDADeviceContext::CUDADeviceContext(CUDAPlace place)
                           << ", Runtime API Version: "
                           << runtime_version_ / 1000 << "."
                           << (runtime_version_ % 100) / 10;
-  size_t cudnn_dso_ver = dynload::cudnnGetVersion();
-  LOG_FIRST_N(WARNING, 1) << "device: " << place_.device
-                          << ", cuDNN Version: " << cudnn_dso_ver / 1000 << "."
-                          << (cudnn_dso_ver % 100) / 10 << ".";
 
   {
-    // Check CUDA/CUDNN version compatiblity
+    // Check CUDA version compatiblity
     auto local_cuda_version = runtime_version_ / 100;
     auto compile_cuda_version = CUDA_VERSION / 100;
     if (local_cuda_version < compile_cuda_version) {
@@ -286,27 +391,67 @@ CUDADeviceContext::CUDADeviceContext(CUDAPlace place)
           << "Please recompile or reinstall Paddle with compatible CUDA "
              "version.";
     }
-
-    if (dynload::HasCUDNN()) {
-      auto local_cudnn_version = cudnn_dso_ver / 100;
-      auto compile_cudnn_version = CUDNN_VERSION / 100;
-      if (local_cudnn_version < compile_cudnn_version) {
-        LOG_FIRST_N(WARNING, 1)
-            << "WARNING: device: " << place_.device
-            << ". The installed Paddle is compiled with CUDNN "
-            << compile_cudnn_version / 10 << "." << compile_cudnn_version % 10
-            << ", but CUDNN version in your machine is "
-            << local_cudnn_version / 10 << "." << local_cudnn_version % 10
-            << ", which may cause serious incompatible bug. "
-            << "Please recompile or reinstall Paddle with compatible CUDNN "
-               "version.";
-      }
-    }
   }
 
   callback_manager_.reset(new StreamCallbackManager(stream_));
 }
 
+void CUDADeviceContext::InitEigenDevice() const {
+  std::call_once(eigen_once_, [this] {
+    CUDADeviceGuard guard(place_.device);
+    eigen_stream_.reset(new EigenCudaStreamDevice());
+    eigen_stream_->Reinitialize(&stream_, place_);
+    eigen_device_.reset(new Eigen::GpuDevice(eigen_stream_.get()));
+  });
+}
+
+void CUDADeviceContext::InitCublasHandles() const {
+  std::call_once(cublas_once_, [this] {
+    CUDADeviceGuard guard(place_.device);
+    cublas_handle_.reset(new CublasHandleHolder(stream_, CUBLAS_DEFAULT_MATH));
+    if (TensorCoreAvailable()) {
+#if CUDA_VERSION >= 9000
+      cublas_tensor_core_handle_.reset(
+          new CublasHandleHolder(stream_, CUBLAS_TENSOR_OP_MATH));
+#endif
+    }
+  });
+}
+
+void CUDADeviceContext::InitCudnnHolder() const {
+  std::call_once(cudnn_once_, [this] {
+    // The cudnn library is also loaded at the first use.
+    if (!dynload::HasCUDNN()) return;
+    CUDADeviceGuard guard(place_.device);
+    cudnn_holder_.reset(new CudnnHolder(&stream_, place_));
+
+    size_t cudnn_dso_ver = dynload::cudnnGetVersion();
+    LOG_FIRST_N(WARNING, 1) << "device: " << place_.device
+                            << ", cuDNN Version: " << cudnn_dso_ver / 1000
+                            << "." << (cudnn_dso_ver % 100) / 10 << ".";
+    // Check CUDNN version compatiblity
+    auto local_cudnn_version = cudnn_dso_ver / 100;
+    auto compile_cudnn_version = CUDNN_VERSION / 100;
+    if (local_cudnn_version < compile_cudnn_version) {
+      LOG_FIRST_N(WARNING, 1)
+          << "WARNING: device: " << place_.device
+          << ". The installed Paddle is compiled with CUDNN "
+          << compile_cudnn_version / 10 << "." << compile_cudnn_version % 10
+          << ", but CUDNN version in your machine is "
+          << local_cudnn_version / 10 << "." << local_cudnn_version % 10
+          << ", which may cause serious incompatible bug. "
+          << "Please recompile or reinstall Paddle with compatible CUDNN "
+             "version.";
+    }
+  });
+}
+
+void CUDADeviceContext::WarmUp() const {
+  InitEigenDevice();
+  InitCublasHandles();
+  InitCudnnHolder();
+}
+
 CUDADeviceContext::~CUDADeviceContext() {
   SetDeviceId(place_.device);
   Wait();
@@ -315,7 +460,9 @@ CUDADeviceContext::~CUDADeviceContext() {
   cublas_tensor_core_handle_.reset();
   eigen_stream_.reset();
   eigen_device_.reset();
-  PADDLE_ENFORCE(cudaStreamDestroy(stream_));
+  if (owns_stream_) {
+    PADDLE_ENFORCE(cudaStreamDestroy(stream_));
+  }
 }
 
 Place CUDADeviceContext::GetPlace() const { return place_; }
@@ -338,18 +485,22 @@ int CUDADeviceContext::GetMaxPhysicalThreadCount() const {
 }
 
 Eigen::GpuDevice* CUDADeviceContext::eigen_device() const {
+  InitEigenDevice();
   return eigen_device_.get();
 }
 
 bool CUDADeviceContext::tensor_core_available() const {
+  InitCublasHandles();
   return cublas_tensor_core_handle_ != nullptr;
 }
 
 cudnnHandle_t CUDADeviceContext::cudnn_handle() const {
+  InitCudnnHolder();
   return cudnn_holder_->cudnn_handle();
 }
 
 CudnnWorkspaceHandle CUDADeviceContext::cudnn_workspace_handle() const {
+  InitCudnnHolder();
   return CudnnWorkspaceHandle(cudnn_holder_.get());
 }
 
@@ -381,39 +532,66 @@ MKLDNNDeviceContext::MKLDNNDeviceContext(CPUPlace place)
 namespace {
 // Current thread's id.
 thread_local int cur_thread_id = 0;
+// The input shapes of the current thread, see set_cur_input_shape_str.
+thread_local std::string cur_input_shape_str = "";
+thread_local int cur_input_shape_cache_capacity = 0;
+
+// Find the blobs of the current input shape, and mark them as the most
+// recently used. They are created if `create` is true, after dropping the
+// least recently used shapes over the capacity.
+KeyBlob* AcquireKeyBlob(ShapeBlob* shape_blob, bool create,
+                        int64_t* evictions) {
+  auto it = shape_blob->blobs.find(cur_input_shape_str);
+  if (it != shape_blob->blobs.end()) {
+    shape_blob->lru.splice(shape_blob->lru.begin(), shape_blob->lru,
+                           it->second.second);
+    return &it->second.first;
+  }
+  if (!create) return nullptr;
+
+  size_t capacity = static_cast<size_t>(cur_input_shape_cache_capacity);
+  while (capacity > 0 && shape_blob->blobs.size() >= capacity) {
+    VLOG(3) << "Drop the MKLDNN blobs of the input shape "
+            << shape_blob->lru.back();
+    shape_blob->blobs.erase(shape_blob->lru.back());
+    shape_blob->lru.pop_back();
+    ++*evictions;
+  }
+  shape_blob->lru.push_front(cur_input_shape_str);
+  auto& entry = shape_blob->blobs[cur_input_shape_str];
+  entry.second = shape_blob->lru.begin();
+  return &entry.first;
 }
+}  // namespace
 
 void set_cur_thread_id(int tid) { cur_thread_id = tid; }
 int get_cur_thread_id(void) { return cur_thread_id; }
 
+void set_cur_input_shape_str(std::string input_shape_str) {
+  cur_input_shape_str = std::move(input_shape_str);
+}
+
+void set_cur_input_shape_cache_capacity(int capacity) {
+  PADDLE_ENFORCE_GE(capacity, 0);
+  cur_input_shape_cache_capacity = capacity;
+}
+
 void MKLDNNDeviceContext::SetBlob(const std::string& name,
                                   std::shared_ptr<void> data) const {
-  BlobMap* pMap = p_blobmap_.get();
-  std::shared_ptr<KeyBlob> pBlob = nullptr;
-
   int tid = platform::get_cur_thread_id();
 
   std::lock_guard<std::mutex> lock(*p_mutex_.get());
 
-  // Find KeyBlob for current thread
-  auto map_it = pMap->find(tid);
-
-  if (map_it == pMap->end()) {
-    // 1st time to set blob in current thread
-    pBlob = std::shared_ptr<KeyBlob>(new KeyBlob());
-    (*pMap)[tid] = pBlob;
-  } else {
-    pBlob = map_it->second;
+  // Find ShapeBlob for current thread, 1st time to set blob in current thread
+  // creates it.
+  auto& shape_blob = (*p_blobmap_)[tid];
+  if (shape_blob == nullptr) {
+    shape_blob.reset(new ShapeBlob());
   }
 
-  // Find Key in found (or newly created) KeyBlob
-  auto key_it = pBlob->find(name);
-
-  if (key_it == pBlob->end()) {
-    (*pBlob)[name] = data;  // create new blob
-  } else {
-    key_it->second = data;  // set data to existing blob
-  }
+  KeyBlob* key_blob =
+      AcquireKeyBlob(shape_blob.get(), true, &stat_.evictions);
+  (*key_blob)[name] = std::move(data);
 
   // lock will be automatically released when out of scope
   return;
@@ -421,27 +599,44 @@ void MKLDNNDeviceContext::SetBlob(const std::string& name,
 
 std::shared_ptr<void> MKLDNNDeviceContext::GetBlob(
     const std::string& name) const {
-  BlobMap* pMap = p_blobmap_.get();
-  std::shared_ptr<KeyBlob> pBlob = nullptr;
-
   int tid = platform::get_cur_thread_id();
 
   std::lock_guard<std::mutex> lock(*p_mutex_.get());
 
-  // Find KeyBlob for current thread firstly
-  auto map_it = pMap->find(tid);
-  if (map_it == pMap->end()) return nullptr;
-  pBlob = map_it->second;
+  // Find ShapeBlob for current thread firstly
+  auto map_it = p_blobmap_->find(tid);
+  KeyBlob* key_blob =
+      map_it == p_blobmap_->end()
+          ? nullptr
+          : AcquireKeyBlob(map_it->second.get(), false, &stat_.evictions);
+  if (key_blob == nullptr) {
+    ++stat_.misses;
+    return nullptr;
+  }
 
   // Find Blob via name
-  auto key_it = pBlob->find(name);
-
-  if (key_it == pBlob->end()) return nullptr;
+  auto key_it = key_blob->find(name);
+  if (key_it == key_blob->end()) {
+    ++stat_.misses;
+    return nullptr;
+  }
+  ++stat_.hits;
 
   // lock will be automatically released when out of scope
   return key_it->second;
 }
 
+MKLDNNDeviceContext::CacheStat MKLDNNDeviceContext::GetCacheStat() const {
+  std::lock_guard<std::mutex> lock(*p_mutex_.get());
+  return stat_;
+}
+
+size_t MKLDNNDeviceContext::GetShapeBlobSize() const {
+  std::lock_guard<std::mutex> lock(*p_mutex_.get());
+  auto map_it = p_blobmap_->find(platform::get_cur_thread_id());
+  return map_it == p_blobmap_->end() ? 0 : map_it->second->blobs.size();
+}
+
 #endif
 
 }  // namespace platform
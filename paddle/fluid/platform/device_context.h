@@ -10,7 +10,9 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 #pragma once
 
+#include <functional>
 #include <future>  // NOLINT
+#include <list>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <string>
@@ -24,6 +26,9 @@ limitations under the License. */
 #include "paddle/fluid/platform/dynload/cublas.h"
 #include "paddle/fluid/platform/dynload/cudnn.h"
 #include "paddle/fluid/platform/gpu_info.h"
+#ifndef _WIN32
+#include "paddle/fluid/platform/dynload/nccl.h"
+#endif
 #endif
 
 #ifdef PADDLE_WITH_MKLDNN
@@ -213,6 +218,11 @@ class CudnnWorkspaceHandle {
 class CUDADeviceContext : public DeviceContext {
  public:
   explicit CUDADeviceContext(CUDAPlace place);
+
+  /*! \brief  Use the stream created outside, which is not destroyed by the
+   *  context. */
+  CUDADeviceContext(CUDAPlace place, cudaStream_t stream);
+
   virtual ~CUDADeviceContext();
 
   /*! \brief  Wait for all operations completion in the stream. */
@@ -233,6 +243,7 @@ class CUDADeviceContext : public DeviceContext {
   /*! \brief  Call cublas function safely. */
   template <typename Callback>
   inline void CublasCall(Callback&& callback) const {
+    InitCublasHandles();
     cublas_handle_->Call(std::forward<Callback>(callback));
   }
 
@@ -243,6 +254,7 @@ class CUDADeviceContext : public DeviceContext {
       Tensor Core is not available, use DEFAULT_MATH instead. */
   template <typename Callback>
   inline void TensorCoreCublasCallIfAvailable(Callback&& callback) const {
+    InitCublasHandles();
     if (cublas_tensor_core_handle_) {
       cublas_tensor_core_handle_->Call(std::forward<Callback>(callback));
     } else {
@@ -262,9 +274,23 @@ class CUDADeviceContext : public DeviceContext {
    *  sequential cudnn function calls. */
   CudnnWorkspaceHandle cudnn_workspace_handle() const;
 
+  /*! \brief  Create the Eigen device and the cublas and cudnn handles now,
+   *  which are created at their first use otherwise. */
+  void WarmUp() const;
+
   /*! \brief  Return cuda stream in the device context. */
   cudaStream_t stream() const;
 
+#ifndef _WIN32
+  /*! \brief  Return the nccl communicator of the devices of the
+   *  ParallelExecutor, which the collective ops such as sync_batch_norm
+   *  call on the stream of the context, nullptr if there is none. */
+  ncclComm_t nccl_comm() const { return nccl_comm_; }
+
+  /*! \brief  Set the nccl communicator, which is not owned. */
+  void set_nccl_comm(ncclComm_t comm) { nccl_comm_ = comm; }
+#endif
+
   template <typename Callback>
   void RecordEvent(cudaEvent_t ev, Callback callback) {
     callback();
@@ -278,16 +304,35 @@ class CUDADeviceContext : public DeviceContext {
 
   void WaitStreamCallback() const { callback_manager_->Wait(); }
 
+  StreamCallbackManager::CallbackStat GetStreamCallbackStat() const {
+    return callback_manager_->GetCallbackStat();
+  }
+
  private:
+  // The library handles of a context are created at their first use, so
+  // that the contexts of the extra streams and of the devices which only
+  // copy data do not pay for them.
+  void InitEigenDevice() const;
+  void InitCublasHandles() const;
+  void InitCudnnHolder() const;
+
   CUDAPlace place_;
 
-  std::unique_ptr<Eigen::GpuDevice> eigen_device_;
-  std::unique_ptr<EigenCudaStreamDevice> eigen_stream_;
-  std::unique_ptr<CudnnHolder> cudnn_holder_;
+  mutable std::once_flag eigen_once_;
+  mutable std::unique_ptr<Eigen::GpuDevice> eigen_device_;
+  mutable std::unique_ptr<EigenCudaStreamDevice> eigen_stream_;
+  mutable std::once_flag cudnn_once_;
+  mutable std::unique_ptr<CudnnHolder> cudnn_holder_;
   cudaStream_t stream_;
+  bool owns_stream_;
 
-  std::unique_ptr<CublasHandleHolder> cublas_handle_;
-  std::unique_ptr<CublasHandleHolder> cublas_tensor_core_handle_;
+  mutable std::once_flag cublas_once_;
+  mutable std::unique_ptr<CublasHandleHolder> cublas_handle_;
+  mutable std::unique_ptr<CublasHandleHolder> cublas_tensor_core_handle_;
+
+#ifndef _WIN32
+  ncclComm_t nccl_comm_{nullptr};
+#endif
 
   int compute_capability_;
   int runtime_version_;
@@ -329,10 +374,28 @@ struct DefaultDeviceContextType<platform::CUDAPinnedPlace> {
 
 #ifdef PADDLE_WITH_MKLDNN
 using KeyBlob = std::unordered_map<std::string, std::shared_ptr<void>>;
-using BlobMap = std::unordered_map<int, std::shared_ptr<KeyBlob>>;
+
+// The blobs of a thread, grouped by the shapes of the inputs the thread runs
+// on. The groups are ordered from the most recently used one.
+struct ShapeBlob {
+  std::list<std::string> lru;
+  std::unordered_map<std::string,
+                     std::pair<KeyBlob, std::list<std::string>::iterator>>
+      blobs;
+};
+using BlobMap = std::unordered_map<int, std::shared_ptr<ShapeBlob>>;
 
 void set_cur_thread_id(int);
 int get_cur_thread_id(void);
+// The shapes of the inputs which the current thread runs on, e.g. set by the
+// predictor for each batch. The blobs created under other shapes are not
+// visible. It is empty by default.
+void set_cur_input_shape_str(std::string input_shape_str);
+// The number of the input shapes whose blobs are kept for the current thread,
+// the blobs of the least recently used shape are dropped together when it is
+// exceeded, so a primitive never outlives the memories it is created with.
+// 0 means no limit, which is the default.
+void set_cur_input_shape_cache_capacity(int capacity);
 
 class MKLDNNDeviceContext : public CPUDeviceContext {
  public:
@@ -347,17 +410,34 @@ class MKLDNNDeviceContext : public CPUDeviceContext {
   // Find a saved blob. Return nullptr if not found
   std::shared_ptr<void> GetBlob(const std::string& name) const;
 
+  struct CacheStat {
+    int64_t hits{0};
+    int64_t misses{0};
+    // The number of the input shapes whose blobs are dropped.
+    int64_t evictions{0};
+  };
+  // The statistics of GetBlob of all the threads.
+  CacheStat GetCacheStat() const;
+
+  // The number of the input shapes cached for the current thread.
+  size_t GetShapeBlobSize() const;
+
  private:
   mkldnn::engine engine_;
   std::shared_ptr<BlobMap> p_blobmap_;
   std::shared_ptr<std::mutex> p_mutex_;
+  mutable CacheStat stat_;
 };
 #endif
 
 /*! \brief device context pool singleton */
 class DeviceContextPool {
  public:
-  explicit DeviceContextPool(const std::vector<platform::Place>& places);
+  /*! \brief  The contexts of the places are created at their first Get. If
+   *  init_p2p, the peer access between two GPUs is enabled when the contexts
+   *  of both of them are created. */
+  explicit DeviceContextPool(const std::vector<platform::Place>& places,
+                             bool init_p2p = false);
 
   static DeviceContextPool& Instance() {
     PADDLE_ENFORCE_NOT_NULL(pool, "Need to Create DeviceContextPool first!");
@@ -365,9 +445,10 @@ class DeviceContextPool {
   }
 
   /*! \brief  Create should only called by Init function */
-  static DeviceContextPool& Init(const std::vector<platform::Place>& places) {
+  static DeviceContextPool& Init(const std::vector<platform::Place>& places,
+                                 bool init_p2p = false) {
     if (pool == nullptr) {
-      pool = new DeviceContextPool(places);
+      pool = new DeviceContextPool(places, init_p2p);
     }
     return *pool;
   }
@@ -384,12 +465,66 @@ class DeviceContextPool {
 
   size_t size() const { return device_contexts_.size(); }
 
+  /*! \brief  Return the device context on the stream_id-th stream of a GPU,
+   *  for running the independent operators concurrently, see
+   *  multi_stream_pass. The 0-th one is the context returned by Get, the
+   *  others are created at the first call. Other places have only one. */
+  platform::DeviceContext* GetStreamContext(const platform::Place& place,
+                                            size_t stream_id);
+
+  /*! \brief  Wait for the context of the place and the ones of its other
+   *  streams. */
+  void WaitAllStreams(const platform::Place& place);
+
+  /*! \brief  Create the contexts of the places and their library handles on
+   *  a background thread, e.g., while a model is loaded, so that the first
+   *  run does not wait for them. */
+  void WarmUp(const std::vector<platform::Place>& places);
+
  private:
+  struct LazyDeviceContext {
+    std::once_flag once;
+    std::function<DeviceContext*()> create;
+    std::unique_ptr<DeviceContext> dev_ctx;
+
+    DeviceContext* Get() {
+      std::call_once(once, [this] { dev_ctx.reset(create()); });
+      return dev_ctx.get();
+    }
+  };
+
+  template <typename DevCtx, typename PlaceType>
+  void EmplaceDeviceContext(const platform::Place& place);
+
+  void EnablePeerAccess(int device);
+
   static DeviceContextPool* pool;
-  std::map<Place, std::shared_future<std::unique_ptr<DeviceContext>>>
-      device_contexts_;
+  std::map<Place, std::unique_ptr<LazyDeviceContext>> device_contexts_;
+  bool init_p2p_;
+  std::mutex p2p_mutex_;
+  // The GPUs whose contexts are created, if init_p2p_.
+  std::vector<int> p2p_devices_;
+  std::mutex stream_contexts_mutex_;
+  // The contexts of the other streams, the i-th is on the (i+1)-th stream.
+  std::map<Place, std::vector<std::unique_ptr<DeviceContext>>>
+      stream_contexts_;
   DISABLE_COPY_AND_ASSIGN(DeviceContextPool);
 };
 
+// In the scope of this guard, DeviceContextPool::Get returns dev_ctx for the
+// place of it on the current thread, so that the operators run by the thread
+// use it instead of the one in the pool, e.g., a CUDADeviceContext on the
+// stream of the caller.
+class DeviceContextGuard {
+ public:
+  explicit DeviceContextGuard(DeviceContext* dev_ctx);
+
+  ~DeviceContextGuard();
+
+ private:
+  DeviceContext* prev_ctx_;
+  Place prev_place_;
+};
+
 }  // namespace platform
 }  // namespace paddle
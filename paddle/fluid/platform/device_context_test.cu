@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 #include "paddle/fluid/platform/device_context.h"
 
+#include <thread>  // NOLINT
 #include <vector>
 
 #include "glog/logging.h"
@@ -66,3 +67,30 @@ TEST(Device, DeviceContextPool) {
     ASSERT_NE(dev_ctx, nullptr);
   }
 }
+
+TEST(Device, DeviceContextPoolConcurrentGet) {
+  using paddle::platform::DeviceContext;
+  using paddle::platform::DeviceContextPool;
+  using paddle::platform::CUDADeviceContext;
+  using paddle::platform::CUDAPlace;
+
+  DeviceContextPool& pool = DeviceContextPool::Instance();
+  int count = paddle::platform::GetCUDADeviceCount();
+  for (int i = 0; i < count; ++i) {
+    pool.WarmUp({CUDAPlace(i)});
+    // The context is created once, by the warm up or by one of the threads.
+    std::vector<DeviceContext*> dev_ctxs(4, nullptr);
+    std::vector<std::thread> threads;
+    for (size_t j = 0; j < dev_ctxs.size(); ++j) {
+      threads.emplace_back(
+          [&, i, j] { dev_ctxs[j] = pool.Get(CUDAPlace(i)); });
+    }
+    for (auto& thread : threads) thread.join();
+    for (auto* dev_ctx : dev_ctxs) {
+      ASSERT_EQ(dev_ctx, dev_ctxs[0]);
+    }
+    auto* cuda_ctx = static_cast<CUDADeviceContext*>(dev_ctxs[0]);
+    ASSERT_NE(nullptr, cuda_ctx->eigen_device());
+    ASSERT_NE(nullptr, cuda_ctx->cudnn_handle());
+  }
+}
@@ -20,11 +20,13 @@ limitations under the License. */
 #include <numeric>
 #include <string>
 #include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
 #include "glog/logging.h"
 #include "google/protobuf/text_format.h"
 #include "paddle/fluid/framework/block_desc.h"
+#include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/string/printf.h"
 
 namespace paddle {
@@ -37,6 +39,31 @@ thread_local std::deque<std::string> annotation_stack;
 
 std::once_flag tracer_once_flag;
 DeviceTracer *tracer = nullptr;
+
+// The pids of the processes of a trainer in the Chrome trace, one for the
+// CPU threads and one for each GPU.
+constexpr int kTracePidsPerTrainer = 100;
+
+std::string EscapeJson(const std::string &str) {
+  std::string ret;
+  ret.reserve(str.size());
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      ret.push_back('\\');
+      ret.push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      ret += string::Sprintf("\\u%04x", static_cast<int>(c));
+    } else {
+      ret.push_back(c);
+    }
+  }
+  return ret;
+}
+
+// The timestamp in us of the Chrome trace.
+std::string TraceTime(uint64_t ns) {
+  return string::Sprintf("%d.%03d", ns / 1000, ns % 1000);
+}
 }  // namespace
 #ifdef PADDLE_WITH_CUPTI
 
@@ -193,7 +220,8 @@ void CUPTIAPI bufferCompleted(CUcontext ctx, uint32_t streamId, uint8_t *buffer,
 
 class DeviceTracerImpl : public DeviceTracer {
  public:
-  DeviceTracerImpl() : enabled_(false) {}
+  DeviceTracerImpl()
+      : enabled_(false), start_ns_(0), end_ns_(0), cuda_to_host_ns_(0) {}
 
   void AddAnnotation(uint64_t id, const std::string &anno) {
     std::lock_guard<std::mutex> l(trace_mu_);
@@ -237,6 +265,12 @@ class DeviceTracerImpl : public DeviceTracer {
         KernelRecord{name, start, end, device_id, stream_id, correlation_id});
   }
 
+  void AddCounterRecord(const std::string &name, uint64_t timestamp_ns,
+                        int64_t value) {
+    std::lock_guard<std::mutex> l(trace_mu_);
+    counter_records_.push_back(CounterRecord{name, timestamp_ns, value});
+  }
+
   bool IsEnabled() {
     std::lock_guard<std::mutex> l(trace_mu_);
     return enabled_;
@@ -266,7 +300,14 @@ class DeviceTracerImpl : public DeviceTracer {
     CUPTI_CALL(
         dynload::cuptiEnableCallback(1, subscriber_, CUPTI_CB_DOMAIN_DRIVER_API,
                                      CUPTI_DRIVER_TRACE_CBID_cuLaunchKernel));
+    // The cuda records are timed by the GPU clock, whose offset to the host
+    // clock of the CPU records is taken around reading the timestamp.
+    uint64_t host_begin_ns = PosixInNsec();
     CUPTI_CALL(dynload::cuptiGetTimestamp(&start_ns_));
+    uint64_t host_end_ns = PosixInNsec();
+    cuda_to_host_ns_ =
+        static_cast<int64_t>(host_begin_ns / 2 + host_end_ns / 2) -
+        static_cast<int64_t>(start_ns_);
 #endif  // PADDLE_WITH_CUPTI
     enabled_ = true;
   }
@@ -318,6 +359,91 @@ class DeviceTracerImpl : public DeviceTracer {
     return profile_pb;
   }
 
+  void GenChromeTrace(const std::string &trace_path, int trainer_id) {
+    std::lock_guard<std::mutex> l(trace_mu_);
+    const int cpu_pid = trainer_id * kTracePidsPerTrainer;
+    std::vector<std::string> events;
+    std::map<int, std::string> process_names;
+    std::map<std::pair<int, int64_t>, std::string> thread_names;
+    process_names[cpu_pid] = string::Sprintf("trainer %d: CPU", trainer_id);
+
+    auto add_span = [&](const std::string &name, const std::string &cat,
+                        int pid, int64_t tid, uint64_t start_ns,
+                        uint64_t end_ns, const std::string &args) {
+      events.emplace_back(string::Sprintf(
+          "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,"
+          "\"tid\":%d,\"ts\":%s,\"dur\":%s,\"args\":{%s}}",
+          EscapeJson(name), cat, pid, tid, TraceTime(start_ns),
+          TraceTime(end_ns > start_ns ? end_ns - start_ns : 0), args));
+    };
+    auto gpu_pid = [&](int64_t device_id, int64_t stream_id) {
+      int pid = cpu_pid + 1 + static_cast<int>(device_id);
+      process_names[pid] =
+          string::Sprintf("trainer %d: GPU %d", trainer_id, device_id);
+      thread_names[std::make_pair(pid, stream_id)] =
+          string::Sprintf("stream %d", stream_id);
+      return pid;
+    };
+    auto to_host = [&](uint64_t ns) {
+      return static_cast<uint64_t>(static_cast<int64_t>(ns) +
+                                   cuda_to_host_ns_);
+    };
+
+    for (const CPURecord &r : cpu_records_) {
+      thread_names[std::make_pair(cpu_pid, r.thread_id)] =
+          string::Sprintf("thread %d", r.thread_id);
+      add_span(r.name, "cpu", cpu_pid, r.thread_id, r.start_ns, r.end_ns, "");
+    }
+    for (const KernelRecord &r : kernel_records_) {
+      auto it = correlations_.find(r.correlation_id);
+      const std::string &name = it != correlations_.end() ? it->second : r.name;
+      add_span(name, "kernel", gpu_pid(r.device_id, r.stream_id), r.stream_id,
+               to_host(r.start_ns), to_host(r.end_ns),
+               string::Sprintf("\"kernel\":\"%s\",\"correlation_id\":%d",
+                               EscapeJson(r.name), r.correlation_id));
+    }
+    for (const MemRecord &r : mem_records_) {
+      add_span(r.name, "memcpy", gpu_pid(r.device_id, r.stream_id),
+               r.stream_id, to_host(r.start_ns), to_host(r.end_ns),
+               string::Sprintf("\"bytes\":%d", r.bytes));
+    }
+    for (const CounterRecord &r : counter_records_) {
+      events.emplace_back(string::Sprintf(
+          "{\"name\":\"%s\",\"ph\":\"C\",\"pid\":%d,\"ts\":%s,"
+          "\"args\":{\"value\":%d}}",
+          EscapeJson(r.name), cpu_pid, TraceTime(r.timestamp_ns), r.value));
+    }
+    for (auto &item : process_names) {
+      events.emplace_back(string::Sprintf(
+          "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+          "\"args\":{\"name\":\"%s\"}}",
+          item.first, item.second));
+      events.emplace_back(string::Sprintf(
+          "{\"name\":\"process_sort_index\",\"ph\":\"M\",\"pid\":%d,"
+          "\"args\":{\"sort_index\":%d}}",
+          item.first, item.first));
+    }
+    for (auto &item : thread_names) {
+      events.emplace_back(string::Sprintf(
+          "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,"
+          "\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+          item.first.first, item.first.second, item.second));
+    }
+
+    std::ofstream trace_f;
+    trace_f.open(trace_path, std::ios::out | std::ios::trunc);
+    PADDLE_ENFORCE(trace_f.is_open(), "Cannot open %s to write the trace.",
+                   trace_path);
+    trace_f << "{\"displayTimeUnit\":\"ns\","
+            << "\"otherData\":{\"trainer_id\":" << trainer_id << "},"
+            << "\"traceEvents\":[\n";
+    for (size_t i = 0; i < events.size(); ++i) {
+      trace_f << events[i] << (i + 1 < events.size() ? ",\n" : "\n");
+    }
+    trace_f << "]}\n";
+    trace_f.close();
+  }
+
   void Disable() {
 #ifdef PADDLE_WITH_CUPTI
     // flush might cause additional calls to DeviceTracker.
@@ -357,9 +483,12 @@ class DeviceTracerImpl : public DeviceTracer {
   bool enabled_;
   uint64_t start_ns_;
   uint64_t end_ns_;
+  // Add to the timestamps of the cuda records to get the host time.
+  int64_t cuda_to_host_ns_;
   std::vector<KernelRecord> kernel_records_;
   std::vector<MemRecord> mem_records_;
   std::vector<CPURecord> cpu_records_;
+  std::vector<CounterRecord> counter_records_;
   std::unordered_map<uint32_t, std::string> correlations_;
 };
 
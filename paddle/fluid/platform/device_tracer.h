@@ -35,7 +35,9 @@ inline uint64_t PosixInNsec() {
 // DeviceTracer performs the following tasks:
 // 1. Register cuda callbacks for various events: kernel, memcpy, etc.
 // 2. Collect cuda statistics: start/end ts, memory, etc.
-// 3. Generate a protobuf for further analysis.
+// 3. Generate a protobuf for further analysis, or a Chrome trace file, in
+//    which the timestamps of the cuda records are converted to the host
+//    clock of the CPU records.
 class DeviceTracer {
  public:
   struct KernelRecord {
@@ -62,6 +64,12 @@ class DeviceTracer {
     uint32_t correlation_id;
     uint64_t bytes;
   };
+  // The value of a counter, e.g. the size of the reader queue, at a time.
+  struct CounterRecord {
+    std::string name;
+    uint64_t timestamp_ns;
+    int64_t value;
+  };
 
   virtual ~DeviceTracer() {}
   // Needs to be called once before use.
@@ -89,9 +97,19 @@ class DeviceTracer {
                                 int64_t device_id, int64_t stream_id,
                                 uint32_t correlation_id) = 0;
 
+  virtual void AddCounterRecord(const std::string& name, uint64_t timestamp_ns,
+                                int64_t value) = 0;
+
   // Generate a proto after done (Disabled).
   virtual proto::Profile GenProfile(const std::string& profile_path) = 0;
 
+  // Generate a Chrome trace file after done (Disabled), which can be viewed
+  // by chrome://tracing or Perfetto. The processes in the trace are numbered
+  // by the trainer_id, so that the traces of all the trainers can be merged
+  // into one.
+  virtual void GenChromeTrace(const std::string& trace_path,
+                              int trainer_id) = 0;
+
   virtual bool IsEnabled() = 0;
 };
 
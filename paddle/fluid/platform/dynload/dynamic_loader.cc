@@ -48,6 +48,13 @@ DEFINE_string(
 
 DEFINE_string(mklml_dir, "", "Specify path for loading libmklml_intel.so.");
 
+DEFINE_string(turbojpeg_dir, "",
+              "Specify path for loading libturbojpeg.so of libjpeg-turbo.");
+
+DEFINE_string(paddle_master_dir, "",
+              "Specify path for loading libpaddle_master.so, the C client of "
+              "the Go master.");
+
 namespace paddle {
 namespace platform {
 namespace dynload {
@@ -246,6 +253,29 @@ void* GetMKLMLDsoHandle() {
 #endif
 }
 
+void* GetTurboJPEGDsoHandle() {
+#if defined(__APPLE__) || defined(__OSX__)
+  return GetDsoHandleFromSearchPath(FLAGS_turbojpeg_dir, "libturbojpeg.dylib");
+#elif defined(_WIN32)
+  return GetDsoHandleFromSearchPath(FLAGS_turbojpeg_dir, "turbojpeg.dll");
+#else
+  return GetDsoHandleFromSearchPath(FLAGS_turbojpeg_dir, "libturbojpeg.so");
+#endif
+}
+
+void* GetPaddleMasterDsoHandle() {
+#if defined(__APPLE__) || defined(__OSX__)
+  return GetDsoHandleFromSearchPath(FLAGS_paddle_master_dir,
+                                    "libpaddle_master.dylib");
+#elif defined(_WIN32)
+  return GetDsoHandleFromSearchPath(FLAGS_paddle_master_dir,
+                                    "paddle_master.dll");
+#else
+  return GetDsoHandleFromSearchPath(FLAGS_paddle_master_dir,
+                                    "libpaddle_master.so");
+#endif
+}
+
 }  // namespace dynload
 }  // namespace platform
 }  // namespace paddle
@@ -32,6 +32,8 @@ void* GetWarpCTCDsoHandle();
 void* GetNCCLDsoHandle();
 void* GetTensorRtDsoHandle();
 void* GetMKLMLDsoHandle();
+void* GetTurboJPEGDsoHandle();
+void* GetPaddleMasterDsoHandle();
 
 }  // namespace dynload
 }  // namespace platform
@@ -25,6 +25,10 @@ void *nccl_dso_handle;
 
 NCCL_RAND_ROUTINE_EACH(DEFINE_WRAP);
 
+#if NCCL_VERSION_CODE >= 2400
+NCCL_RAND_ROUTINE_EACH_AFTER_2400(DEFINE_WRAP)
+#endif
+
 }  // namespace dynload
 }  // namespace platform
 }  // namespace paddle
@@ -63,6 +63,7 @@ extern void* nccl_dso_handle;
   __macro(ncclAllReduce);               \
   __macro(ncclBcast);                   \
   __macro(ncclAllGather);               \
+  __macro(ncclReduceScatter);           \
   __macro(ncclGroupStart);              \
   __macro(ncclGroupEnd);                \
   __macro(ncclReduce);                  \
@@ -70,6 +71,12 @@ extern void* nccl_dso_handle;
 
 NCCL_RAND_ROUTINE_EACH(DECLARE_DYNAMIC_LOAD_NCCL_WRAP)
 
+#if NCCL_VERSION_CODE >= 2400
+#define NCCL_RAND_ROUTINE_EACH_AFTER_2400(__macro) __macro(ncclCommAbort);
+
+NCCL_RAND_ROUTINE_EACH_AFTER_2400(DECLARE_DYNAMIC_LOAD_NCCL_WRAP)
+#endif
+
 }  // namespace dynload
 }  // namespace platform
 }  // namespace paddle
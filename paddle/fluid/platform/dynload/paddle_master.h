@@ -0,0 +1,89 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include "paddle/fluid/platform/dynload/dynamic_loader.h"
+#include "paddle/fluid/platform/port.h"
+
+/**
+ * The routines of the C client of the Go master (go/master/c), which
+ * dispatches the tasks of the chunks of the RecordIO files to the trainers.
+ * They are declared here as cgo exports them, the client library is loaded
+ * at runtime so that Paddle is built without Go.
+ */
+extern "C" {
+typedef int paddle_master_client;
+
+// The timeout and buf_size are the GoInt of cgo.
+typedef long long paddle_master_go_int;  // NOLINT
+paddle_master_client paddle_new_etcd_master_client(
+    char* etcd_endpoints, paddle_master_go_int timeout,
+    paddle_master_go_int buf_size);
+paddle_master_client paddle_new_master_client(char* addr,
+                                              paddle_master_go_int buf_size);
+void paddle_release_master_client(paddle_master_client client);
+void paddle_start_get_records(paddle_master_client client, int pass);
+int paddle_set_dataset(paddle_master_client client, char** paths, int size);
+int paddle_next_record(paddle_master_client client, unsigned char** record);
+void mem_free(void* p);
+}
+
+namespace paddle {
+namespace platform {
+namespace dynload {
+
+extern std::once_flag paddle_master_dso_flag;
+extern void* paddle_master_dso_handle;
+
+/**
+ * The following macro definition can generate structs
+ * (for each function) to dynamic load paddle_master routine
+ * via operator overloading.
+ */
+#define DYNAMIC_LOAD_PADDLE_MASTER_WRAP(__name)                           \
+  struct DynLoad__##__name {                                              \
+    template <typename... Args>                                           \
+    auto operator()(Args... args) -> DECLARE_TYPE(__name, args...) {      \
+      using paddle_masterFunc = decltype(&::__name);                      \
+      std::call_once(paddle_master_dso_flag, []() {                       \
+        paddle_master_dso_handle =                                        \
+            paddle::platform::dynload::GetPaddleMasterDsoHandle();        \
+      });                                                                 \
+      static void* p_##_name = dlsym(paddle_master_dso_handle, #__name);  \
+      return reinterpret_cast<paddle_masterFunc>(p_##_name)(args...);     \
+    }                                                                     \
+  };                                                                      \
+  extern DynLoad__##__name __name
+
+#define DECLARE_DYNAMIC_LOAD_PADDLE_MASTER_WRAP(__name) \
+  DYNAMIC_LOAD_PADDLE_MASTER_WRAP(__name)
+
+#define PADDLE_MASTER_ROUTINE_EACH(__macro) \
+  __macro(paddle_new_etcd_master_client);   \
+  __macro(paddle_new_master_client);        \
+  __macro(paddle_release_master_client);    \
+  __macro(paddle_start_get_records);        \
+  __macro(paddle_set_dataset);              \
+  __macro(paddle_next_record);              \
+  __macro(mem_free)
+
+PADDLE_MASTER_ROUTINE_EACH(DECLARE_DYNAMIC_LOAD_PADDLE_MASTER_WRAP);
+
+#undef DYNAMIC_LOAD_PADDLE_MASTER_WRAP
+
+}  // namespace dynload
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,87 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include "paddle/fluid/platform/dynload/dynamic_loader.h"
+#include "paddle/fluid/platform/port.h"
+
+/**
+ * The routines of the TurboJPEG API of libjpeg-turbo used by Paddle. They are
+ * declared here since the library is loaded at runtime and its headers are not
+ * required to build Paddle, the API is stable since libjpeg-turbo 1.2.
+ */
+extern "C" {
+typedef void* tjhandle;
+
+#define TJPF_RGB 0
+#define TJPF_GRAY 6
+#define TJFLAG_FASTDCT 2048
+
+tjhandle tjInitDecompress(void);
+int tjDecompressHeader3(tjhandle handle, const unsigned char* jpegBuf,
+                        unsigned long jpegSize, int* width,  // NOLINT
+                        int* height, int* jpegSubsamp, int* jpegColorspace);
+int tjDecompress2(tjhandle handle, const unsigned char* jpegBuf,
+                  unsigned long jpegSize, unsigned char* dstBuf,  // NOLINT
+                  int width, int pitch, int height, int pixelFormat, int flags);
+int tjDestroy(tjhandle handle);
+char* tjGetErrorStr(void);
+}
+
+namespace paddle {
+namespace platform {
+namespace dynload {
+
+extern std::once_flag turbojpeg_dso_flag;
+extern void* turbojpeg_dso_handle;
+
+/**
+ * The following macro definition can generate structs
+ * (for each function) to dynamic load turbojpeg routine
+ * via operator overloading.
+ */
+#define DYNAMIC_LOAD_TURBOJPEG_WRAP(__name)                            \
+  struct DynLoad__##__name {                                           \
+    template <typename... Args>                                        \
+    auto operator()(Args... args) -> DECLARE_TYPE(__name, args...) {   \
+      using turbojpegFunc = decltype(&::__name);                       \
+      std::call_once(turbojpeg_dso_flag, []() {                        \
+        turbojpeg_dso_handle =                                         \
+            paddle::platform::dynload::GetTurboJPEGDsoHandle();        \
+      });                                                              \
+      static void* p_##_name = dlsym(turbojpeg_dso_handle, #__name);   \
+      return reinterpret_cast<turbojpegFunc>(p_##_name)(args...);      \
+    }                                                                  \
+  };                                                                   \
+  extern DynLoad__##__name __name
+
+#define DECLARE_DYNAMIC_LOAD_TURBOJPEG_WRAP(__name) \
+  DYNAMIC_LOAD_TURBOJPEG_WRAP(__name)
+
+#define TURBOJPEG_ROUTINE_EACH(__macro) \
+  __macro(tjInitDecompress);            \
+  __macro(tjDecompressHeader3);         \
+  __macro(tjDecompress2);               \
+  __macro(tjDestroy);                   \
+  __macro(tjGetErrorStr)
+
+TURBOJPEG_ROUTINE_EACH(DECLARE_DYNAMIC_LOAD_TURBOJPEG_WRAP);
+
+#undef DYNAMIC_LOAD_TURBOJPEG_WRAP
+
+}  // namespace dynload
+}  // namespace platform
+}  // namespace paddle
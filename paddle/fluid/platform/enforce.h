@@ -255,24 +255,80 @@ inline void throw_on_error(T e) {
   throw_on_error(e, "");
 }
 
+// The enforces fail through the functions below, which build the error
+// messages out of line. They are noinline and cold, so that an enforce on a
+// hot path compiles to a compare, a branch and a call, and the formatting
+// code of its arguments neither bloats nor blocks the optimization of the
+// caller.
+#ifdef __GNUC__
+#define PADDLE_ENFORCE_COLD __attribute__((noinline, cold))
+#else
+#define PADDLE_ENFORCE_COLD
+#endif
+
+template <typename... Args>
+[[noreturn]] PADDLE_ENFORCE_COLD void ThrowEnforceNotMet(const char* f, int l,
+                                                         const Args&... args) {
+  throw EnforceNotMet(f, l, args...);
+}
+
+[[noreturn]] PADDLE_ENFORCE_COLD inline void RethrowEnforceNotMet(
+    const char* f, int l) {
+  throw EnforceNotMet(std::current_exception(), f, l);
+}
+
+template <typename T, typename... Args>
+PADDLE_ENFORCE_COLD void ThrowOnEnforceError(T stat, const Args&... args) {
+  throw_on_error(stat, args...);
+}
+
+// The message of an enforce of one argument, or of none.
+inline const char* EnforceOneArg() { return ""; }
+
+template <typename T>
+inline const T& EnforceOneArg(const T& arg) {
+  return arg;
+}
+
+template <typename T0, typename T1, typename... Args>
+[[noreturn]] PADDLE_ENFORCE_COLD void ThrowCompareFailed(
+    const char* f, int l, const char* name0, const char* cmp,
+    const char* name1, const char* inv_cmp, const T0& val0, const T1& val1,
+    const Args&... args) {
+  throw EnforceNotMet(
+      f, l,
+      "Enforce failed. Expected %s %s %s, but received %s:%s %s %s:%s.\n%s",
+      name0, cmp, name1, name0, string::to_string(val0), inv_cmp, name1,
+      string::to_string(val1), string::Sprintf(args...));
+}
+
+template <typename... Args>
+[[noreturn]] PADDLE_ENFORCE_COLD void ThrowNullFailed(const char* f, int l,
+                                                      const char* name,
+                                                      const Args&... args) {
+  throw EnforceNotMet(f, l, "%s should not be null\n%s", name,
+                      string::Sprintf(args...));
+}
+
 #define PADDLE_THROW(...) \
-  throw ::paddle::platform::EnforceNotMet(__FILE__, __LINE__, __VA_ARGS__)
+  ::paddle::platform::ThrowEnforceNotMet(__FILE__, __LINE__, __VA_ARGS__)
 
 #define __PADDLE_THROW_ERROR_I(_, _9, _8, _7, _6, _5, _4, _3, _2, X_, ...) X_;
 
 #define __THROW_ON_ERROR_ONE_ARG(COND, ARG) \
-  ::paddle::platform::throw_on_error(COND, ::paddle::string::Sprintf(ARG));
-
-#define __PADDLE_THROW_ON_ERROR(COND, ...)                                \
-  __PADDLE_THROW_ERROR_I(                                                 \
-      __VA_ARGS__, ::paddle::platform::throw_on_error(COND, __VA_ARGS__), \
-      ::paddle::platform::throw_on_error(COND, __VA_ARGS__),              \
-      ::paddle::platform::throw_on_error(COND, __VA_ARGS__),              \
-      ::paddle::platform::throw_on_error(COND, __VA_ARGS__),              \
-      ::paddle::platform::throw_on_error(COND, __VA_ARGS__),              \
-      ::paddle::platform::throw_on_error(COND, __VA_ARGS__),              \
-      ::paddle::platform::throw_on_error(COND, __VA_ARGS__),              \
-      ::paddle::platform::throw_on_error(COND, __VA_ARGS__),              \
+  ::paddle::platform::ThrowOnEnforceError(  \
+      COND, ::paddle::platform::EnforceOneArg(ARG));
+
+#define __PADDLE_THROW_ON_ERROR(COND, ...)                                     \
+  __PADDLE_THROW_ERROR_I(                                                      \
+      __VA_ARGS__, ::paddle::platform::ThrowOnEnforceError(COND, __VA_ARGS__), \
+      ::paddle::platform::ThrowOnEnforceError(COND, __VA_ARGS__),              \
+      ::paddle::platform::ThrowOnEnforceError(COND, __VA_ARGS__),              \
+      ::paddle::platform::ThrowOnEnforceError(COND, __VA_ARGS__),              \
+      ::paddle::platform::ThrowOnEnforceError(COND, __VA_ARGS__),              \
+      ::paddle::platform::ThrowOnEnforceError(COND, __VA_ARGS__),              \
+      ::paddle::platform::ThrowOnEnforceError(COND, __VA_ARGS__),              \
+      ::paddle::platform::ThrowOnEnforceError(COND, __VA_ARGS__),              \
       __THROW_ON_ERROR_ONE_ARG(COND, __VA_ARGS__))
 
 #define __PADDLE_UNARY_COMPARE(COND, ...)                 \
@@ -284,14 +340,13 @@ inline void throw_on_error(T e) {
   } while (0)
 
 #ifndef REPLACE_ENFORCE_GLOG
-#define __PADDLE_ENFORCE_I(COND, ...)                                   \
-  do {                                                                  \
-    try {                                                               \
-      __PADDLE_UNARY_COMPARE(COND, __VA_ARGS__);                        \
-    } catch (...) {                                                     \
-      throw ::paddle::platform::EnforceNotMet(std::current_exception(), \
-                                              __FILE__, __LINE__);      \
-    }                                                                   \
+#define __PADDLE_ENFORCE_I(COND, ...)                               \
+  do {                                                              \
+    try {                                                           \
+      __PADDLE_UNARY_COMPARE(COND, __VA_ARGS__);                    \
+    } catch (...) {                                                 \
+      ::paddle::platform::RethrowEnforceNotMet(__FILE__, __LINE__); \
+    }                                                               \
   } while (0)
 
 #else
@@ -320,24 +375,21 @@ inline void throw_on_error(T e) {
  *    extra messages is also supported, for example:
  *    PADDLE_ENFORCE(a, b, "some simple enforce failed between %d numbers", 2)
  */
-#define PADDLE_ENFORCE_NOT_NULL(__VAL, ...)                  \
-  do {                                                       \
-    if (UNLIKELY(nullptr == (__VAL))) {                      \
-      PADDLE_THROW(#__VAL " should not be null\n%s",         \
-                   paddle::string::Sprintf("" __VA_ARGS__)); \
-    }                                                        \
+#define PADDLE_ENFORCE_NOT_NULL(__VAL, ...)                           \
+  do {                                                                \
+    if (UNLIKELY(nullptr == (__VAL))) {                               \
+      ::paddle::platform::ThrowNullFailed(__FILE__, __LINE__, #__VAL, \
+                                          "" __VA_ARGS__);            \
+    }                                                                 \
   } while (0)
 
-#define __PADDLE_BINARY_COMPARE(__VAL0, __VAL1, __CMP, __INV_CMP, ...)  \
-  do {                                                                  \
-    if (UNLIKELY(!((__VAL0)__CMP(__VAL1)))) {                           \
-      PADDLE_THROW("Enforce failed. Expected %s " #__CMP                \
-                   " %s, but received %s:%s " #__INV_CMP " %s:%s.\n%s", \
-                   #__VAL0, #__VAL1, #__VAL0,                           \
-                   paddle::string::to_string(__VAL0), #__VAL1,          \
-                   paddle::string::to_string(__VAL1),                   \
-                   paddle::string::Sprintf("" __VA_ARGS__));            \
-    }                                                                   \
+#define __PADDLE_BINARY_COMPARE(__VAL0, __VAL1, __CMP, __INV_CMP, ...) \
+  do {                                                                 \
+    if (UNLIKELY(!((__VAL0)__CMP(__VAL1)))) {                          \
+      ::paddle::platform::ThrowCompareFailed(                          \
+          __FILE__, __LINE__, #__VAL0, #__CMP, #__VAL1, #__INV_CMP,    \
+          (__VAL0), (__VAL1), "" __VA_ARGS__);                         \
+    }                                                                  \
   } while (0)
 
 #define PADDLE_ENFORCE_EQ(__VAL0, __VAL1, ...) \
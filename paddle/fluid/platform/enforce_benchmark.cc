@@ -0,0 +1,146 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// Measure the cost of the passing enforces on a hot path, with the failures
+// thrown from the cold functions of enforce.h against the failures thrown
+// inline as the enforces used to do.
+
+#include <chrono>  // NOLINT
+#include <string>
+#include <vector>
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/fluid/platform/enforce.h"
+
+DEFINE_int32(burning, 1000, "Burning times.");
+DEFINE_int32(repeat, 10000000, "Repeat times.");
+
+// The former expansions of the enforces, which format the message and
+// construct EnforceNotMet in the caller.
+#define INLINE_THROW(...) \
+  throw ::paddle::platform::EnforceNotMet(__FILE__, __LINE__, __VA_ARGS__)
+
+#define INLINE_ENFORCE(COND, ...)                                       \
+  do {                                                                  \
+    try {                                                               \
+      auto __cond = COND;                                               \
+      if (UNLIKELY(::paddle::platform::is_error(__cond))) {             \
+        ::paddle::platform::throw_on_error(__cond, __VA_ARGS__);        \
+      }                                                                 \
+    } catch (...) {                                                     \
+      throw ::paddle::platform::EnforceNotMet(std::current_exception(), \
+                                              __FILE__, __LINE__);      \
+    }                                                                   \
+  } while (0)
+
+#define INLINE_ENFORCE_NOT_NULL(__VAL, ...)                           \
+  do {                                                                \
+    if (UNLIKELY(nullptr == (__VAL))) {                               \
+      INLINE_THROW(#__VAL " should not be null\n%s",                  \
+                   paddle::string::Sprintf("" __VA_ARGS__));          \
+    }                                                                 \
+  } while (0)
+
+#define INLINE_BINARY_COMPARE(__VAL0, __VAL1, __CMP, __INV_CMP, ...)    \
+  do {                                                                  \
+    if (UNLIKELY(!((__VAL0)__CMP(__VAL1)))) {                           \
+      INLINE_THROW("Enforce failed. Expected %s " #__CMP                \
+                   " %s, but received %s:%s " #__INV_CMP " %s:%s.\n%s", \
+                   #__VAL0, #__VAL1, #__VAL0,                           \
+                   paddle::string::to_string(__VAL0), #__VAL1,          \
+                   paddle::string::to_string(__VAL1),                   \
+                   paddle::string::Sprintf("" __VA_ARGS__));            \
+    }                                                                   \
+  } while (0)
+
+#define INLINE_ENFORCE_EQ(__VAL0, __VAL1, ...) \
+  INLINE_BINARY_COMPARE(__VAL0, __VAL1, ==, !=, __VA_ARGS__)
+#define INLINE_ENFORCE_LT(__VAL0, __VAL1, ...) \
+  INLINE_BINARY_COMPARE(__VAL0, __VAL1, <, >=, __VA_ARGS__)
+
+// 10 enforces of a tensor access: the holder, the rank, the offset and each
+// of the 7 dims.
+struct Dims {
+  const void* holder;
+  int rank;
+  int64_t offset;
+  int64_t numel;
+  int64_t d[7];
+};
+
+__attribute__((noinline)) int64_t CheckCold(const Dims& dims) {
+  PADDLE_ENFORCE_NOT_NULL(dims.holder, "Tensor holds no memory.");
+  PADDLE_ENFORCE_EQ(dims.rank, 7, "The rank must be 7.");
+  PADDLE_ENFORCE_LT(dims.offset, dims.numel, "The offset %d is out of range.",
+                    dims.offset);
+  int64_t n = 1;
+  for (int i = 0; i < 7; ++i) {
+    PADDLE_ENFORCE(dims.d[i] > 0, "The dim %d must be positive.", i);
+    n *= dims.d[i];
+  }
+  return n;
+}
+
+__attribute__((noinline)) int64_t CheckInline(const Dims& dims) {
+  INLINE_ENFORCE_NOT_NULL(dims.holder, "Tensor holds no memory.");
+  INLINE_ENFORCE_EQ(dims.rank, 7, "The rank must be 7.");
+  INLINE_ENFORCE_LT(dims.offset, dims.numel, "The offset %d is out of range.",
+                    dims.offset);
+  int64_t n = 1;
+  for (int i = 0; i < 7; ++i) {
+    INLINE_ENFORCE(dims.d[i] > 0, "The dim %d must be positive.", i);
+    n *= dims.d[i];
+  }
+  return n;
+}
+
+// The average nanoseconds of a call.
+double Bench(int64_t (*check)(const Dims&), const Dims& dims) {
+  volatile int64_t sink = 0;
+  for (int i = 0; i < FLAGS_burning; ++i) {
+    sink = sink + check(dims);
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < FLAGS_repeat; ++i) {
+    sink = sink + check(dims);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         FLAGS_repeat;
+}
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  LOG(INFO) << "Burning " << FLAGS_burning << " times, Repeat " << FLAGS_repeat
+            << " times.";
+  int holder = 0;
+  Dims dims{&holder, 7, 3, 5040, {1, 2, 3, 4, 5, 6, 7}};
+  // Either one throws the same message, but for the line.
+  dims.rank = 6;
+  std::vector<std::string> errors;
+  for (auto* check : {CheckCold, CheckInline}) {
+    try {
+      check(dims);
+    } catch (paddle::platform::EnforceNotMet& e) {
+      std::string what = e.what();
+      errors.push_back(what.substr(0, what.find(" at [")));
+    }
+  }
+  CHECK_EQ(errors.size(), 2UL);
+  CHECK_EQ(errors[0], errors[1]);
+  dims.rank = 7;
+
+  LOG(INFO) << "cold enforces: " << Bench(CheckCold, dims) << " ns per call";
+  LOG(INFO) << "inline enforces: " << Bench(CheckInline, dims)
+            << " ns per call";
+  return 0;
+}
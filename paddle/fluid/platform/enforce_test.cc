@@ -12,6 +12,7 @@ limitations under the License. */
 #include <array>
 #include <iostream>
 #include <memory>
+#include <string>
 
 #include "gtest/gtest.h"
 #include "paddle/fluid/platform/enforce.h"
@@ -58,6 +59,30 @@ TEST(ENFORCE, FAILED) {
   EXPECT_TRUE(caught_exception);
 }
 
+TEST(ENFORCE, FAILED_WITH_MESSAGE_VARIABLE) {
+  bool caught_exception = false;
+  try {
+    std::string msg = "Enforce is not ok for a message variable";
+    PADDLE_ENFORCE(false, msg);
+  } catch (paddle::platform::EnforceNotMet error) {
+    caught_exception = true;
+    EXPECT_TRUE(HasPrefix(StringPiece(error.what()),
+                          "Enforce is not ok for a message variable"));
+  }
+  EXPECT_TRUE(caught_exception);
+
+  // The exceptions of the condition are thrown as EnforceNotMet too.
+  auto cond = []() -> bool { throw std::runtime_error("cond failed"); };
+  caught_exception = false;
+  try {
+    PADDLE_ENFORCE(cond());
+  } catch (paddle::platform::EnforceNotMet error) {
+    caught_exception = true;
+    EXPECT_TRUE(HasPrefix(StringPiece(error.what()), "cond failed"));
+  }
+  EXPECT_TRUE(caught_exception);
+}
+
 TEST(ENFORCE, NO_ARG_OK) {
   int a = 2;
   int b = 2;
@@ -46,6 +46,12 @@ DEFINE_bool(
     "input and output must be half precision) and recurrent neural networks "
     "(RNNs).");
 
+DEFINE_bool(cublas_fp16_gemm_padding, false,
+            "Whether to pad K and N of the fp16 GEMMs to multiples of 8 "
+            "through temporary workspaces if the Tensor Cores are "
+            "available, so that the GEMMs of the unaligned shapes run on "
+            "the Tensor Cores at the cost of copying the operands.");
+
 DEFINE_string(selected_gpus, "",
               "A list of device ids separated by comma, like: 0,1,2,3. "
               "This option is useful when doing multi process training and "
@@ -84,6 +90,15 @@ int GetCUDARuntimeVersion(int id) {
   return runtime_version;
 }
 
+std::string GetCUDADeviceName(int id) {
+  PADDLE_ENFORCE_LT(id, GetCUDADeviceCount(), "id must less than GPU count");
+  cudaDeviceProp device_prop;
+  PADDLE_ENFORCE(cudaGetDeviceProperties(&device_prop, id),
+                 "cudaGetDeviceProperties failed in "
+                 "paddle::platform::GetCUDADeviceName");
+  return device_prop.name;
+}
+
 int GetCUDADriverVersion(int id) {
   PADDLE_ENFORCE_LT(id, GetCUDADeviceCount(), "id must less than GPU count");
   int driver_version = 0;
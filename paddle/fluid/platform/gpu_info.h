@@ -33,6 +33,9 @@ int GetCUDAComputeCapability(int i);
 //! Get the runtime version of the ith GPU
 int GetCUDARuntimeVersion(int id);
 
+//! Get the name of the ith GPU, e.g. "Tesla V100-SXM2-16GB"
+std::string GetCUDADeviceName(int id);
+
 //! Get the driver version of the ith GPU
 int GetCUDADriverVersion(int id);
 
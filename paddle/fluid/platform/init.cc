@@ -20,9 +20,6 @@ limitations under the License. */
 #include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/platform/cpu_info.h"
 #include "paddle/fluid/string/split.h"
-#ifdef PADDLE_WITH_CUDA
-#include "paddle/fluid/platform/cuda_device_guard.h"
-#endif
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/init.h"
 #include "paddle/fluid/platform/place.h"
@@ -35,7 +32,6 @@ namespace paddle {
 namespace framework {
 
 std::once_flag gflags_init_flag;
-std::once_flag p2p_init_flag;
 
 void InitGflags(std::vector<std::string> argv) {
   std::call_once(gflags_init_flag, [&]() {
@@ -54,30 +50,6 @@ void InitGflags(std::vector<std::string> argv) {
   });
 }
 
-void InitP2P(std::vector<int> devices) {
-#ifdef PADDLE_WITH_CUDA
-  std::call_once(p2p_init_flag, [&]() {
-    int count = devices.size();
-    for (int i = 0; i < count; ++i) {
-      for (int j = 0; j < count; ++j) {
-        if (devices[i] == devices[j]) continue;
-        int can_acess = -1;
-        PADDLE_ENFORCE(
-            cudaDeviceCanAccessPeer(&can_acess, devices[i], devices[j]),
-            "Failed to test P2P access.");
-        if (can_acess != 1) {
-          LOG(WARNING) << "Cannot enable P2P access from " << devices[i]
-                       << " to " << devices[j];
-        } else {
-          platform::CUDADeviceGuard guard(devices[i]);
-          cudaDeviceEnablePeerAccess(devices[j], 0);
-        }
-      }
-    }
-  });
-#endif
-}
-
 void InitDevices(bool init_p2p) {
   /*Init all available devices by default */
   std::vector<int> devices;
@@ -105,11 +77,11 @@ void InitDevices(bool init_p2p, const std::vector<int> devices) {
 
     places.emplace_back(platform::CUDAPlace(devices[i]));
   }
-  if (init_p2p) {
-    InitP2P(devices);
-  }
   places.emplace_back(platform::CPUPlace());
-  platform::DeviceContextPool::Init(places);
+  // The contexts, and the P2P access between the GPUs, are initialized at
+  // the first use of the GPUs, so that a process which uses few of the
+  // visible GPUs does not create a CUDA context on every one of them.
+  platform::DeviceContextPool::Init(places, init_p2p);
   platform::DeviceTemporaryAllocator::Init();
 #ifndef PADDLE_WITH_MKLDNN
   platform::SetNumThreads(FLAGS_paddle_num_threads);
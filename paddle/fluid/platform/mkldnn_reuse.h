@@ -224,25 +224,35 @@ class MKLDNNHandler {
     AppendKeyVec(key, strides);
     AppendKeyVec(key, paddings);
     AppendKeyVec(key, dilations);
-    AppendKey(key, std::to_string(groups));
-    AppendKey(key, std::to_string(srcdt));
-    AppendKey(key, std::to_string(format));
-    AppendKey(key, std::to_string(relu));
-    AppendKey(key, std::to_string(residual));
+    AppendKeyPod(key, groups);
+    AppendKeyPod(key, srcdt);
+    AppendKeyPod(key, format);
+    AppendKeyPod(key, relu);
+    AppendKeyPod(key, residual);
     AppendKey(key, suffix);
   }
 
  protected:
+  // The keys are built from the raw bytes of the numbers, which is cheaper
+  // than formatting them. Each list is prefixed by its size, so the keys of
+  // the different dims never collide.
+  template <typename T>
+  static void AppendKeyPod(std::string* key, const T& value) {
+    key->append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
   static void AppendKeyDims(std::string* key,
                             const mkldnn::memory::dims& dims) {
+    AppendKeyPod(key, dims.size());
     for (unsigned int i = 0; i < dims.size(); i++) {
-      AppendKey(key, std::to_string(dims[i]));
+      AppendKeyPod(key, dims[i]);
     }
   }
 
   static void AppendKeyVec(std::string* key, const std::vector<int>& dims) {
+    AppendKeyPod(key, dims.size());
     for (unsigned int i = 0; i < dims.size(); i++) {
-      AppendKey(key, std::to_string(dims[i]));
+      AppendKeyPod(key, dims[i]);
     }
   }
 
@@ -251,10 +261,9 @@ class MKLDNNHandler {
   }
 
   static std::string dims2str(const mkldnn::memory::dims& operand_dims) {
-    std::string dstr = "";
-    for (size_t i = 0; i < operand_dims.size(); ++i) {
-      dstr += std::to_string(operand_dims[i]) + "-";
-    }
+    std::string dstr;
+    dstr.reserve(sizeof(size_t) + operand_dims.size() * sizeof(int));
+    AppendKeyDims(&dstr, operand_dims);
     return dstr;
   }
 
@@ -625,16 +634,21 @@ class ConvMKLDNNTemplateHandler : public MKLDNNHandler {
   }
 
   // Generate keys for storing/retriving primitives for this operator
-  // TODO(jczaja): Make hashing function more optimial
   static std::string GetHash(mkldnn::memory::dims& input_dims,    // NOLINT
                              mkldnn::memory::dims& weights_dims,  // NOLINT
                              std::vector<int>& strides,           // NOLINT
                              std::vector<int>& paddings,          // NOLINT
                              std::vector<int>& dilations,         // NOLINT
                              int groups, const std::string& suffix) {
-    return dims2str(input_dims) + dims2str(weights_dims) + dims2str(strides) +
-           dims2str(paddings) + dims2str(dilations) + std::to_string(groups) +
-           suffix;
+    std::string key;
+    AppendKeyDims(&key, input_dims);
+    AppendKeyDims(&key, weights_dims);
+    AppendKeyVec(&key, strides);
+    AppendKeyVec(&key, paddings);
+    AppendKeyVec(&key, dilations);
+    AppendKeyPod(&key, groups);
+    AppendKey(&key, suffix);
+    return key;
   }
 
  private:
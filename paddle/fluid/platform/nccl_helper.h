@@ -16,6 +16,7 @@
 #pragma once
 
 #include <stdio.h>
+#include <atomic>
 #include <string>
 #include <thread>  // NOLINT
 #include <typeindex>
@@ -26,10 +27,17 @@
 #include "paddle/fluid/platform/float16.h"
 
 #define NCCL_ID_VARNAME "NCCLID"
+#define NCCL_INTER_ID_VARNAME_PREFIX "NCCLID_INTER_"
 
 namespace paddle {
 namespace platform {
 
+// The name of the id variable used to build the inter-node communicator of
+// the idx-th local device in hierarchical allreduce mode.
+inline std::string InterNCCLIdVarName(size_t idx) {
+  return NCCL_INTER_ID_VARNAME_PREFIX + std::to_string(idx);
+}
+
 inline ncclDataType_t ToNCCLDataType(framework::proto::VarType::Type type) {
   if (type == framework::proto::VarType::FP32) {
     return ncclFloat;
@@ -71,10 +79,21 @@ class NCCLGroupGuard {
 
 struct NCCLContext {
   std::unique_ptr<CUDADeviceContext> ctx_;
+  // The flat communicator over all the devices of all the trainers.
   ncclComm_t comm_;
+  // Only used by hierarchical allreduce: local_comm_ spans the devices of this
+  // node and inter_comm_ spans the devices with the same local rank on every
+  // node.
+  ncclComm_t local_comm_;
+  ncclComm_t inter_comm_;
+  int local_rank_;
 
   explicit NCCLContext(int dev_id)
-      : ctx_(new CUDADeviceContext(CUDAPlace(dev_id))), comm_{nullptr} {}
+      : ctx_(new CUDADeviceContext(CUDAPlace(dev_id))),
+        comm_{nullptr},
+        local_comm_{nullptr},
+        inter_comm_{nullptr},
+        local_rank_{0} {}
 
   cudaStream_t stream() const { return ctx_->stream(); }
 
@@ -86,10 +105,17 @@ struct NCCLContext {
 struct NCCLContextMap {
   std::unordered_map<int, NCCLContext> contexts_;
   std::vector<int> order_;
+  bool hierarchical_{false};
+  std::atomic<bool> aborted_{false};
 
-  explicit NCCLContextMap(const std::vector<platform::Place> &places,
-                          ncclUniqueId *nccl_id = nullptr,
-                          size_t num_trainers = 1, size_t trainer_id = 0) {
+  // If inter_nccl_ids is not empty, it must hold one id per place, and the
+  // communicators needed by hierarchical allreduce are created besides the
+  // flat one.
+  explicit NCCLContextMap(
+      const std::vector<platform::Place> &places,
+      ncclUniqueId *nccl_id = nullptr, size_t num_trainers = 1,
+      size_t trainer_id = 0,
+      const std::vector<ncclUniqueId *> &inter_nccl_ids = {}) {
     PADDLE_ENFORCE(!places.empty());
     order_.reserve(places.size());
     for (auto &p : places) {
@@ -104,6 +130,84 @@ struct NCCLContextMap {
     if (places.size() <= 1 && num_trainers == 1) {
       return;
     }
+    InitFlatComms(nccl_id, num_trainers, trainer_id);
+
+    if (!inter_nccl_ids.empty()) {
+      InitHierarchicalComms(inter_nccl_ids, num_trainers, trainer_id);
+    }
+  }
+
+  NCCLContextMap(const NCCLContextMap &other) = delete;
+  NCCLContextMap &operator=(const NCCLContextMap &other) = delete;
+
+  CUDADeviceContext *DevCtx(int dev_id) const { return at(dev_id).ctx_.get(); }
+
+  CUDADeviceContext *DevCtx(platform::Place p) const {
+    return DevCtx(boost::get<CUDAPlace>(p).device);
+  }
+
+  const NCCLContext &at(platform::Place p) const {
+    return this->at(boost::get<CUDAPlace>(p).device);
+  }
+
+  const NCCLContext &at(int dev_id) const { return contexts_.at(dev_id); }
+
+  // Whether the communicators of hierarchical allreduce are available.
+  bool UseHierarchicalAllReduce() const { return hierarchical_; }
+
+  void WaitAll() {
+    for (auto &p : contexts_) {
+      p.second.ctx_->Wait();
+    }
+  }
+
+  // Abort the flat communicators, so that the collectives blocked on a lost
+  // trainer return. It may be called from another thread while the
+  // communicators are in use, and they must be reset before the next use.
+  void AbortComms() {
+#if NCCL_VERSION_CODE >= 2400
+    bool expected = false;
+    if (!aborted_.compare_exchange_strong(expected, true)) {
+      return;
+    }
+    for (auto &dev_id : order_) {
+      auto comm = contexts_.at(dev_id).comm_;
+      if (comm != nullptr) {
+        PADDLE_ENFORCE(platform::dynload::ncclCommAbort(comm));
+      }
+    }
+#else
+    PADDLE_THROW("Aborting the NCCL communicators requires NCCL 2.4 or later");
+#endif
+  }
+
+  // Rebuild the flat communicators with the ranks of a new membership, e.g.
+  // after some trainers are lost. The device contexts are kept, so that the
+  // op handles built with this map still work.
+  void ResetComms(ncclUniqueId *nccl_id, size_t num_trainers,
+                  size_t trainer_id) {
+    PADDLE_ENFORCE(!hierarchical_,
+                   "Can not reset the communicators of hierarchical "
+                   "allreduce.");
+    WaitAll();
+    if (!aborted_.load()) {
+      for (auto &dev_id : order_) {
+        auto &comm = contexts_.at(dev_id).comm_;
+        if (comm != nullptr) {
+          PADDLE_ENFORCE(platform::dynload::ncclCommDestroy(comm));
+        }
+      }
+    }
+    for (auto &dev_id : order_) {
+      contexts_.at(dev_id).comm_ = nullptr;
+    }
+    InitFlatComms(nccl_id, num_trainers, trainer_id);
+    aborted_.store(false);
+  }
+
+ private:
+  void InitFlatComms(ncclUniqueId *nccl_id, size_t num_trainers,
+                     size_t trainer_id) {
     std::unique_ptr<ncclComm_t[]> comms(new ncclComm_t[order_.size()]);
     // if num_trainers == 1, should create a new nccl id for local comms.
     if (num_trainers == 1 && nccl_id == nullptr) {
@@ -137,25 +241,44 @@ struct NCCLContextMap {
     }
   }
 
-  NCCLContextMap(const NCCLContextMap &other) = delete;
-  NCCLContextMap &operator=(const NCCLContextMap &other) = delete;
-
-  CUDADeviceContext *DevCtx(int dev_id) const { return at(dev_id).ctx_.get(); }
+  void InitHierarchicalComms(const std::vector<ncclUniqueId *> &inter_nccl_ids,
+                             size_t num_trainers, size_t trainer_id) {
+    PADDLE_ENFORCE_EQ(inter_nccl_ids.size(), order_.size(),
+                      "Hierarchical allreduce needs one inter-node NCCL id "
+                      "for each local device.");
+    PADDLE_ENFORCE_GT(num_trainers, 1UL,
+                      "Hierarchical allreduce needs more than one trainer.");
+    PADDLE_ENFORCE_GT(order_.size(), 1UL,
+                      "Hierarchical allreduce needs more than one device.");
 
-  CUDADeviceContext *DevCtx(platform::Place p) const {
-    return DevCtx(boost::get<CUDAPlace>(p).device);
-  }
-
-  const NCCLContext &at(platform::Place p) const {
-    return this->at(boost::get<CUDAPlace>(p).device);
-  }
+    std::unique_ptr<ncclComm_t[]> local_comms(new ncclComm_t[order_.size()]);
+    {
+      std::lock_guard<std::mutex> guard(NCCLGroupGuard::NCCLMutex());
+      PADDLE_ENFORCE(platform::dynload::ncclCommInitAll(
+          local_comms.get(), static_cast<int>(order_.size()), order_.data()));
+    }
 
-  const NCCLContext &at(int dev_id) const { return contexts_.at(dev_id); }
+    std::unique_ptr<ncclComm_t[]> inter_comms(new ncclComm_t[order_.size()]);
+    {
+      NCCLGroupGuard guard;
+      for (size_t i = 0; i < order_.size(); ++i) {
+        PADDLE_ENFORCE_NOT_NULL(inter_nccl_ids[i]);
+        VLOG(30) << "init inter nccl rank: " << trainer_id
+                 << " nranks: " << num_trainers << " gpu id: " << order_[i];
+        PADDLE_ENFORCE(cudaSetDevice(order_[i]));
+        PADDLE_ENFORCE(platform::dynload::ncclCommInitRank(
+            inter_comms.get() + i, static_cast<int>(num_trainers),
+            *inter_nccl_ids[i], static_cast<int>(trainer_id)));
+      }
+    }
 
-  void WaitAll() {
-    for (auto &p : contexts_) {
-      p.second.ctx_->Wait();
+    for (size_t i = 0; i < order_.size(); ++i) {
+      auto &ctx = contexts_.at(order_[i]);
+      ctx.local_comm_ = local_comms[i];
+      ctx.inter_comm_ = inter_comms[i];
+      ctx.local_rank_ = static_cast<int>(i);
     }
+    hierarchical_ = true;
   }
 };
 
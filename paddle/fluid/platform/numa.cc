@@ -0,0 +1,155 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/numa.h"
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <fstream>
+#include <thread>  // NOLINT
+#include "glog/logging.h"
+#include "paddle/fluid/string/split.h"
+
+namespace paddle {
+namespace platform {
+
+#ifdef __linux__
+// The constants of <numaif.h>, which is not installed without libnuma.
+static constexpr int kMpolPreferred = 1;
+static constexpr int kMpolBind = 2;
+static constexpr unsigned kMpolMfMove = 1 << 1;
+
+static constexpr char kNodeDir[] = "/sys/devices/system/node/";
+#endif
+
+thread_local int g_current_thread_numa_node = -1;
+
+std::vector<int> ParseCpuList(const std::string& cpu_list) {
+  std::vector<int> cpus;
+  for (auto& range : string::Split(cpu_list, ',')) {
+    if (range.empty() || range == "\n") continue;
+    auto pos = range.find('-');
+    int begin = std::stoi(range.substr(0, pos));
+    int end =
+        pos == std::string::npos ? begin : std::stoi(range.substr(pos + 1));
+    for (int cpu = begin; cpu <= end; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+#ifdef __linux__
+static bool ReadFirstLine(const std::string& path, std::string* line) {
+  std::ifstream file(path);
+  return file.is_open() && static_cast<bool>(std::getline(file, *line));
+}
+
+// The node mask of the mempolicy syscalls, and the max node they take.
+static std::vector<unsigned long> NodeMask(int node,  // NOLINT
+                                           unsigned long* max_node) {  // NOLINT
+  const int bits = 8 * sizeof(unsigned long);  // NOLINT
+  std::vector<unsigned long> mask(node / bits + 1, 0);  // NOLINT
+  mask[node / bits] |= 1UL << (node % bits);
+  // The kernel takes max_node - 1 bits of the mask, as libnuma passes.
+  *max_node = mask.size() * bits + 1;
+  return mask;
+}
+#endif
+
+int GetNumaNodeCount() {
+#ifdef __linux__
+  std::string online;
+  if (ReadFirstLine(std::string(kNodeDir) + "online", &online)) {
+    auto nodes = ParseCpuList(online);
+    if (!nodes.empty()) {
+      return *std::max_element(nodes.begin(), nodes.end()) + 1;
+    }
+  }
+#endif
+  return 1;
+}
+
+std::vector<int> GetNumaNodeCpus(int node) {
+#ifdef __linux__
+  std::string cpu_list;
+  if (ReadFirstLine(std::string(kNodeDir) + "node" + std::to_string(node) +
+                        "/cpulist",
+                    &cpu_list)) {
+    return ParseCpuList(cpu_list);
+  }
+#endif
+  // Not a NUMA host, all the cpus are on node 0.
+  std::vector<int> cpus;
+  if (node == 0) {
+    for (unsigned cpu = 0; cpu < std::thread::hardware_concurrency(); ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+int GetCurrentThreadNumaNode() { return g_current_thread_numa_node; }
+
+bool BindCurrentThreadToNumaNode(int node) {
+#ifdef __linux__
+  auto cpus = GetNumaNodeCpus(node);
+  if (cpus.empty()) {
+    LOG(WARNING) << "NUMA node " << node << " has no cpu";
+    return false;
+  }
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (int cpu : cpus) {
+    CPU_SET(cpu, &cpu_set);
+  }
+  if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0) {
+    LOG(WARNING) << "Failed to pin the thread to NUMA node " << node;
+    return false;
+  }
+  unsigned long max_node;  // NOLINT
+  auto mask = NodeMask(node, &max_node);
+  if (syscall(SYS_set_mempolicy, kMpolPreferred, mask.data(), max_node) != 0) {
+    LOG(WARNING) << "Failed to prefer the memory of NUMA node " << node;
+  }
+  g_current_thread_numa_node = node;
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool BindMemoryToNumaNode(void* ptr, size_t size, int node) {
+#ifdef __linux__
+  if (size == 0) return true;
+  const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  uintptr_t begin = reinterpret_cast<uintptr_t>(ptr) & ~(page_size - 1);
+  uintptr_t end = reinterpret_cast<uintptr_t>(ptr) + size;
+  end = (end + page_size - 1) & ~(page_size - 1);
+  unsigned long max_node;  // NOLINT
+  auto mask = NodeMask(node, &max_node);
+  return syscall(SYS_mbind, begin, end - begin, kMpolBind, mask.data(),
+                 max_node, kMpolMfMove) == 0;
+#else
+  return false;
+#endif
+}
+
+}  // namespace platform
+}  // namespace paddle
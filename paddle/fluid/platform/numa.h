@@ -0,0 +1,51 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace platform {
+
+//! Parse a Linux cpu list, e.g. "0-3,8-11", to the cpu ids.
+std::vector<int> ParseCpuList(const std::string& cpu_list);
+
+//! Get the number of the NUMA nodes of the host, 1 if not a NUMA host.
+int GetNumaNodeCount();
+
+//! Get the cpu ids of a NUMA node.
+std::vector<int> GetNumaNodeCpus(int node);
+
+//! Get the NUMA node the current thread is bound to, -1 if not bound.
+int GetCurrentThreadNumaNode();
+
+/**
+ * Pin the current thread to the cpus of a NUMA node and prefer the memory of
+ * the node for the pages it touches first. The threads it starts later, e.g.
+ * the OpenMP threads of the math library, inherit the binding. Return false
+ * if the host has no such node or the binding fails.
+ */
+bool BindCurrentThreadToNumaNode(int node);
+
+/**
+ * Move the pages of a memory range to a NUMA node and keep them there. The
+ * pages partially in the range are moved as well. Return false if it fails.
+ */
+bool BindMemoryToNumaNode(void* ptr, size_t size, int node);
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,53 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/numa.h"
+#include <stdlib.h>
+#include <thread>  // NOLINT
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace platform {
+
+TEST(Numa, ParseCpuList) {
+  EXPECT_EQ(ParseCpuList("0-3,8,10-11\n"),
+            std::vector<int>({0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_EQ(ParseCpuList("5"), std::vector<int>({5}));
+  EXPECT_TRUE(ParseCpuList("").empty());
+}
+
+TEST(Numa, Nodes) {
+  int num_nodes = GetNumaNodeCount();
+  ASSERT_GE(num_nodes, 1);
+  EXPECT_FALSE(GetNumaNodeCpus(0).empty());
+}
+
+TEST(Numa, Bind) {
+  std::thread thread([] {
+    EXPECT_EQ(GetCurrentThreadNumaNode(), -1);
+    ASSERT_TRUE(BindCurrentThreadToNumaNode(0));
+    EXPECT_EQ(GetCurrentThreadNumaNode(), 0);
+
+    void* ptr = nullptr;
+    ASSERT_EQ(posix_memalign(&ptr, 64, 1 << 20), 0);
+    // mbind may be disallowed in a container, it must not crash.
+    BindMemoryToNumaNode(ptr, 1 << 20, 0);
+    free(ptr);
+  });
+  thread.join();
+  EXPECT_EQ(GetCurrentThreadNumaNode(), -1);
+}
+
+}  // namespace platform
+}  // namespace paddle
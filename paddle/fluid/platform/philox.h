@@ -0,0 +1,218 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include "paddle/fluid/platform/hostdevice.h"
+
+namespace paddle {
+namespace platform {
+
+/*
+ * Philox4x32-10, the counter-based random number generator of "Parallel
+ * Random Numbers: As Easy as 1, 2, 3" (Salmon et al., SC 2011).
+ *
+ * The 4 random uint32 of a 128-bit counter are a pure function of the counter
+ * and a 64-bit key, so a CUDA thread gets the values of its elements at once,
+ * with no state to carry over and no values to discard. The ops take the seed
+ * as the key, the element, in groups of 4, as the low half of the counter and
+ * the offset of PhiloxState as the high half, so that the ops launched with
+ * one seed never overlap.
+ */
+class Philox4x32 {
+ public:
+  HOSTDEVICE Philox4x32(uint64_t seed, uint64_t offset)
+      : key0_(static_cast<uint32_t>(seed)),
+        key1_(static_cast<uint32_t>(seed >> 32)),
+        offset0_(static_cast<uint32_t>(offset)),
+        offset1_(static_cast<uint32_t>(offset >> 32)) {}
+
+  // The 4 random values of the index-th group of the stream.
+  HOSTDEVICE inline void operator()(uint64_t index, uint32_t out[4]) const {
+    uint32_t ctr[4] = {static_cast<uint32_t>(index),
+                       static_cast<uint32_t>(index >> 32), offset0_, offset1_};
+    Generate(ctr, key0_, key1_, out);
+  }
+
+  // One Philox4x32-10 block of the counter and the key.
+  HOSTDEVICE static inline void Generate(const uint32_t ctr[4], uint32_t key0,
+                                         uint32_t key1, uint32_t out[4]) {
+    uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+    for (int round = 0; round < kRounds; ++round) {
+      uint32_t hi0, hi1;
+      uint32_t lo0 = MulHiLo(kMul0, c0, &hi0);
+      uint32_t lo1 = MulHiLo(kMul1, c2, &hi1);
+      c0 = hi1 ^ c1 ^ key0;
+      c1 = lo1;
+      c2 = hi0 ^ c3 ^ key1;
+      c3 = lo0;
+      key0 += kWeyl0;
+      key1 += kWeyl1;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+  }
+
+ private:
+  static constexpr int kRounds = 10;
+  static constexpr uint32_t kMul0 = 0xD2511F53;
+  static constexpr uint32_t kMul1 = 0xCD9E8D57;
+  static constexpr uint32_t kWeyl0 = 0x9E3779B9;
+  static constexpr uint32_t kWeyl1 = 0xBB67AE85;
+
+  // Returns the low 32 bits of a * b, and sets the high 32 bits to hi.
+  HOSTDEVICE static inline uint32_t MulHiLo(uint32_t a, uint32_t b,
+                                            uint32_t* hi) {
+#ifdef __CUDA_ARCH__
+    *hi = __umulhi(a, b);
+    return a * b;
+#else
+    uint64_t product = static_cast<uint64_t>(a) * b;
+    *hi = static_cast<uint32_t>(product >> 32);
+    return static_cast<uint32_t>(product);
+#endif
+  }
+
+  uint32_t key0_;
+  uint32_t key1_;
+  uint32_t offset0_;
+  uint32_t offset1_;
+};
+
+// The uniform real in [0, 1) of the 24 high bits of a random uint32.
+HOSTDEVICE inline float PhiloxUniform(uint32_t x) {
+  return static_cast<float>(x >> 8) * (1.0f / 16777216.0f);
+}
+
+// The uniform real in [0, 1) of the 53 bits of two random uint32.
+HOSTDEVICE inline double PhiloxUniform(uint32_t x, uint32_t y) {
+  uint64_t bits = (static_cast<uint64_t>(x) << 21) ^ (y >> 11);
+  return static_cast<double>(bits) * (1.0 / 9007199254740992.0);
+}
+
+// The 2 standard normal values of 2 uniform reals by the Box-Muller
+// transform, u1 is taken in (0, 1] as the argument of the log.
+template <typename T>
+HOSTDEVICE inline void PhiloxBoxMuller(T u1, T u2, T* z0, T* z1) {
+  const T kTwoPi = static_cast<T>(6.28318530717958647692);
+  T radius = sqrt(static_cast<T>(-2) * log(static_cast<T>(1) - u1));
+  T theta = kTwoPi * u2;
+  *z0 = radius * cos(theta);
+  *z1 = radius * sin(theta);
+}
+
+// The distributions map the 4 random uint32 of a group to kCount values,
+// i.e. 4 floats or 2 doubles.
+template <typename T>
+struct PhiloxUniformDistribution;
+
+template <>
+struct PhiloxUniformDistribution<float> {
+  static constexpr int kCount = 4;
+
+  HOSTDEVICE PhiloxUniformDistribution(float min, float max)
+      : min_(min), range_(max - min) {}
+
+  HOSTDEVICE inline void operator()(const uint32_t random[4],
+                                    float out[4]) const {
+    for (int i = 0; i < kCount; ++i) {
+      out[i] = min_ + range_ * PhiloxUniform(random[i]);
+    }
+  }
+
+  float min_;
+  float range_;
+};
+
+template <>
+struct PhiloxUniformDistribution<double> {
+  static constexpr int kCount = 2;
+
+  HOSTDEVICE PhiloxUniformDistribution(double min, double max)
+      : min_(min), range_(max - min) {}
+
+  HOSTDEVICE inline void operator()(const uint32_t random[4],
+                                    double out[2]) const {
+    for (int i = 0; i < kCount; ++i) {
+      out[i] = min_ + range_ * PhiloxUniform(random[2 * i], random[2 * i + 1]);
+    }
+  }
+
+  double min_;
+  double range_;
+};
+
+template <typename T>
+struct PhiloxNormalDistribution {
+  static constexpr int kCount = PhiloxUniformDistribution<T>::kCount;
+
+  HOSTDEVICE PhiloxNormalDistribution(T mean, T std)
+      : uniform_(static_cast<T>(0), static_cast<T>(1)),
+        mean_(mean),
+        std_(std) {}
+
+  HOSTDEVICE inline void operator()(const uint32_t random[4],
+                                    T out[kCount]) const {
+    T u[kCount];
+    uniform_(random, u);
+    for (int i = 0; i < kCount; i += 2) {
+      PhiloxBoxMuller(u[i], u[i + 1], &out[i], &out[i + 1]);
+      out[i] = mean_ + std_ * out[i];
+      out[i + 1] = mean_ + std_ * out[i + 1];
+    }
+  }
+
+  PhiloxUniformDistribution<T> uniform_;
+  T mean_;
+  T std_;
+};
+
+// Fills out[0, n) with the values of the distribution, the group-th call
+// writes the kCount values of the group-th group of the stream, e.g. as the
+// function of ForRange over NumGroups().
+template <typename T, typename Distribution>
+struct PhiloxFillFunctor {
+  PhiloxFillFunctor(uint64_t seed, uint64_t offset,
+                    const Distribution& distribution, T* out, size_t n)
+      : rng_(seed, offset), distribution_(distribution), out_(out), n_(n) {}
+
+  size_t NumGroups() const {
+    return (n_ + Distribution::kCount - 1) / Distribution::kCount;
+  }
+
+  HOSTDEVICE inline void operator()(size_t group) const {
+    uint32_t random[4];
+    rng_(group, random);
+    T values[Distribution::kCount];
+    distribution_(random, values);
+    size_t begin = group * Distribution::kCount;
+    for (int i = 0; i < Distribution::kCount; ++i) {
+      if (begin + i < n_) {
+        out_[begin + i] = values[i];
+      }
+    }
+  }
+
+  Philox4x32 rng_;
+  Distribution distribution_;
+  T* out_;
+  size_t n_;
+};
+
+}  // namespace platform
+}  // namespace paddle
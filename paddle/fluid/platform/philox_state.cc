@@ -0,0 +1,64 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/philox_state.h"
+#include <map>
+#include <memory>
+#include <random>
+
+namespace paddle {
+namespace platform {
+
+PhiloxState& PhiloxState::Get(const Place& place) {
+  static std::mutex mutex;
+  static std::map<int, std::unique_ptr<PhiloxState>> states;
+  int device = is_gpu_place(place) ? boost::get<CUDAPlace>(place).device : -1;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& state = states[device];
+  if (!state) {
+    state.reset(new PhiloxState());
+  }
+  return *state;
+}
+
+PhiloxState::PhiloxState() {
+  std::random_device rd;
+  seed_ = (static_cast<uint64_t>(rd()) << 32) | rd();
+}
+
+void PhiloxState::SetSeed(uint64_t seed) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  seed_ = seed;
+  offset_ = 0;
+}
+
+uint64_t PhiloxState::seed() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return seed_;
+}
+
+PhiloxSeed PhiloxState::Next() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return PhiloxSeed{seed_, offset_++};
+}
+
+PhiloxSeed GetPhiloxSeed(const Place& place, int seed_attr) {
+  if (seed_attr != 0) {
+    return FixedPhiloxSeed(seed_attr);
+  }
+  return PhiloxState::Get(place).Next();
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,66 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace platform {
+
+// The key and the offset of the Philox4x32 stream of a kernel.
+struct PhiloxSeed {
+  uint64_t seed;
+  uint64_t offset;
+};
+
+/*
+ * PhiloxState tracks the seed of the random ops of a device and the offset
+ * of their next stream, which is taken by every op launched without a fixed
+ * seed, so that two launches never draw the same numbers.
+ */
+class PhiloxState {
+ public:
+  // The state of the device of the place, all the CPUPlaces share one.
+  static PhiloxState& Get(const Place& place);
+
+  // Restarts the streams of the device from the seed.
+  void SetSeed(uint64_t seed);
+  uint64_t seed() const;
+
+  // Reserves the next stream.
+  PhiloxSeed Next();
+
+ private:
+  PhiloxState();
+
+  mutable std::mutex mutex_;
+  uint64_t seed_;
+  uint64_t offset_{0};
+};
+
+// The stream of a fixed seed, which starts from the offset 0 for the
+// reproducible results of the tests.
+inline PhiloxSeed FixedPhiloxSeed(int seed) {
+  return PhiloxSeed{static_cast<uint32_t>(seed), 0};
+}
+
+// The stream of an op of the seed attribute: the fixed one of the seed, or
+// the next stream of the device when the seed is 0.
+PhiloxSeed GetPhiloxSeed(const Place& place, int seed_attr);
+
+}  // namespace platform
+}  // namespace paddle
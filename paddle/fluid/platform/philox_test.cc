@@ -0,0 +1,95 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/philox.h"
+#include <gtest/gtest.h>
+#include <vector>
+#include "paddle/fluid/platform/philox_state.h"
+
+namespace platform = paddle::platform;
+
+// The known answers of Philox4x32-10 of Random123.
+TEST(Philox4x32, KnownAnswers) {
+  uint32_t out[4];
+  const uint32_t zeros[4] = {0, 0, 0, 0};
+  platform::Philox4x32::Generate(zeros, 0, 0, out);
+  EXPECT_EQ(out[0], 0x6627e8d5U);
+  EXPECT_EQ(out[1], 0xe169c58dU);
+  EXPECT_EQ(out[2], 0xbc57ac4cU);
+  EXPECT_EQ(out[3], 0x9b00dbd8U);
+
+  const uint32_t ones[4] = {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff};
+  platform::Philox4x32::Generate(ones, 0xffffffff, 0xffffffff, out);
+  EXPECT_EQ(out[0], 0x408f276dU);
+  EXPECT_EQ(out[1], 0x41c83b0eU);
+  EXPECT_EQ(out[2], 0xa20bc7c6U);
+  EXPECT_EQ(out[3], 0x6d5451fdU);
+
+  const uint32_t pi[4] = {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344};
+  platform::Philox4x32::Generate(pi, 0xa4093822, 0x299f31d0, out);
+  EXPECT_EQ(out[0], 0xd16cfe09U);
+  EXPECT_EQ(out[1], 0x94fdccebU);
+  EXPECT_EQ(out[2], 0x5001e420U);
+  EXPECT_EQ(out[3], 0x24126ea1U);
+}
+
+TEST(Philox4x32, Uniform) {
+  platform::Philox4x32 rng(2019, 0);
+  double sum = 0;
+  const int kGroups = 1 << 16;
+  for (int i = 0; i < kGroups; ++i) {
+    uint32_t r[4];
+    rng(i, r);
+    for (int j = 0; j < 4; ++j) {
+      float u = platform::PhiloxUniform(r[j]);
+      ASSERT_GE(u, 0.f);
+      ASSERT_LT(u, 1.f);
+      sum += u;
+    }
+  }
+  EXPECT_NEAR(sum / (4 * kGroups), 0.5, 0.01);
+}
+
+TEST(Philox4x32, Normal) {
+  using Normal = platform::PhiloxNormalDistribution<double>;
+  const size_t kNum = 1 << 18;
+  std::vector<double> values(kNum);
+  platform::PhiloxFillFunctor<double, Normal> fill(2019, 3, Normal(1., 2.),
+                                                   values.data(), kNum);
+  for (size_t i = 0; i < fill.NumGroups(); ++i) {
+    fill(i);
+  }
+  double sum = 0, square_sum = 0;
+  for (double v : values) {
+    sum += v;
+    square_sum += v * v;
+  }
+  double mean = sum / kNum;
+  EXPECT_NEAR(mean, 1., 0.02);
+  EXPECT_NEAR(square_sum / kNum - mean * mean, 4., 0.05);
+}
+
+TEST(PhiloxState, Streams) {
+  platform::CPUPlace place;
+  platform::PhiloxState::Get(place).SetSeed(7);
+  auto first = platform::GetPhiloxSeed(place, 0);
+  auto second = platform::GetPhiloxSeed(place, 0);
+  EXPECT_EQ(first.seed, 7UL);
+  EXPECT_EQ(first.offset, 0UL);
+  EXPECT_EQ(second.offset, 1UL);
+
+  auto fixed = platform::GetPhiloxSeed(place, 5);
+  EXPECT_EQ(fixed.seed, 5UL);
+  EXPECT_EQ(fixed.offset, 0UL);
+}
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include <algorithm>
+#include <cstdlib>
 #include <iomanip>
 #include <limits>
 #include <map>
@@ -25,12 +26,21 @@ limitations under the License. */
 
 #include "glog/logging.h"
 #include "paddle/fluid/framework/block_desc.h"
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
 #include "paddle/fluid/platform/device_tracer.h"
 #include "paddle/fluid/platform/port.h"
 #include "paddle/fluid/platform/profiler.h"
 #include "paddle/fluid/string/printf.h"
 
 DEFINE_bool(enable_rpc_profiler, false, "Enable rpc profiler or not.");
+DEFINE_bool(profile_allocator_stats, false,
+            "Print the allocator statistics of each place, e.g., the peak "
+            "bytes and the fragmentation ratio, in the profiling report. "
+            "The usage numbers need FLAGS_enable_allocator_stats.");
+DEFINE_bool(profile_chrome_trace, false,
+            "Also write the timeline of the profiler in the Chrome trace "
+            "format to <profile_path>.<trainer_id>.json, the trainer_id is "
+            "read from the environment variable PADDLE_TRAINER_ID.");
 
 namespace paddle {
 namespace platform {
@@ -66,12 +76,13 @@ struct EventList {
       ((kEventSize + kEventAlign - 1) / kEventAlign * kEventAlign);
 
   template <typename... Args>
-  void Record(Args&&... args) {
+  Event& Record(Args&&... args) {
     if (event_blocks.empty() || event_blocks.front().size() == kNumBlock) {
       event_blocks.emplace_front();
       event_blocks.front().reserve(kNumBlock);
     }
     event_blocks.front().emplace_back(std::forward<Args>(args)...);
+    return event_blocks.front().back();
   }
 
   std::vector<Event> Reduce() {
@@ -189,11 +200,23 @@ RecordEvent::~RecordEvent() {
   std::lock_guard<std::mutex> l(profiler_mu);
   DeviceTracer* tracer = GetDeviceTracer();
   if (tracer) {
-    tracer->AddCPURecords(CurAnnotation(), start_ns_, PosixInNsec(),
-                          BlockDepth(), g_thread_id);
+    uint64_t end_ns = PosixInNsec();
+    tracer->AddCPURecords(CurAnnotation(), start_ns_, end_ns, BlockDepth(),
+                          g_thread_id);
+    if (FLAGS_profile_allocator_stats) {
+      auto all_stats =
+          memory::allocation::AllocatorFacade::Instance().GetAllStats();
+      for (auto& pair : all_stats) {
+        tracer->AddCounterRecord(
+            string::Sprintf("allocated_bytes: %s", pair.first), end_ns,
+            static_cast<int64_t>(pair.second.current_bytes));
+      }
+    }
   }
   ClearCurAnnotation();
-  PopEvent(name_, dev_ctx_);
+  GetEventList()
+      .Record(EventType::kPopRange, name_, g_thread_id, dev_ctx_)
+      .set_cost(flops_, bytes_);
 }
 
 RecordRPCEvent::RecordRPCEvent(const std::string& name,
@@ -203,6 +226,14 @@ RecordRPCEvent::RecordRPCEvent(const std::string& name,
   }
 }
 
+void RecordCounter(const std::string& name, int64_t value) {
+  if (g_state == ProfilerState::kDisabled) return;
+  DeviceTracer* tracer = GetDeviceTracer();
+  if (tracer) {
+    tracer->AddCounterRecord(name, PosixInNsec(), value);
+  }
+}
+
 RecordBlock::RecordBlock(int block_id)
     : is_enabled_(false), start_ns_(PosixInNsec()) {
   std::lock_guard<std::mutex> l(profiler_mu);
@@ -281,12 +312,20 @@ struct EventItem {
   double max_time;
   double ave_time;
   float ratio;
+  double total_flops;
+  double total_bytes;
 };
 
 // Print results
 void PrintProfiler(const std::vector<std::vector<EventItem>>& events_table,
                    const std::string& sorted_domain, const size_t name_width,
                    const size_t data_width, bool merge_thread) {
+  bool has_cost = false;
+  for (auto& items : events_table) {
+    for (auto& item : items) {
+      has_cost = has_cost || item.total_flops > 0 || item.total_bytes > 0;
+    }
+  }
   // Output header information
   std::cout << "\n------------------------->"
             << "     Profiling Report     "
@@ -316,7 +355,12 @@ void PrintProfiler(const std::vector<std::vector<EventItem>>& events_table,
             << "Calls" << std::setw(data_width) << "Total"
             << std::setw(data_width) << "Min." << std::setw(data_width)
             << "Max." << std::setw(data_width) << "Ave."
-            << std::setw(data_width) << "Ratio." << std::endl;
+            << std::setw(data_width) << "Ratio.";
+  if (has_cost) {
+    std::cout << std::setw(data_width) << "GFLOP/s" << std::setw(data_width)
+              << "GB/s";
+  }
+  std::cout << std::endl;
   for (size_t i = 0; i < events_table.size(); ++i) {
     for (size_t j = 0; j < events_table[i].size(); ++j) {
       const EventItem& event_item = events_table[i][j];
@@ -326,7 +370,16 @@ void PrintProfiler(const std::vector<std::vector<EventItem>>& events_table,
                 << std::setw(data_width) << event_item.min_time
                 << std::setw(data_width) << event_item.max_time
                 << std::setw(data_width) << event_item.ave_time
-                << std::setw(data_width) << event_item.ratio << std::endl;
+                << std::setw(data_width) << event_item.ratio;
+      if (has_cost) {
+        // The total time is in ms.
+        double giga_per_ms = event_item.total_time * 1e6;
+        std::cout << std::setw(data_width)
+                  << event_item.total_flops / giga_per_ms
+                  << std::setw(data_width)
+                  << event_item.total_bytes / giga_per_ms;
+      }
+      std::cout << std::endl;
     }
   }
   std::cout << std::endl;
@@ -428,9 +481,15 @@ void ParseEvents(const std::vector<std::vector<Event>>& events,
 
           if (event_idx.find(event_name) == event_idx.end()) {
             event_idx[event_name] = event_items.size();
-            EventItem event_item = {event_name, 1,          event_time,
-                                    event_time, event_time, event_time,
-                                    0.};
+            EventItem event_item = {event_name,
+                                    1,
+                                    event_time,
+                                    event_time,
+                                    event_time,
+                                    event_time,
+                                    0.,
+                                    (*analyze_events)[i][j].flops(),
+                                    (*analyze_events)[i][j].bytes()};
             event_items.push_back(event_item);
           } else {
             int index = event_idx[event_name];
@@ -443,6 +502,8 @@ void ParseEvents(const std::vector<std::vector<Event>>& events,
             // max time
             event_items[index].max_time =
                 std::max(event_time, event_items[index].max_time);
+            event_items[index].total_flops += (*analyze_events)[i][j].flops();
+            event_items[index].total_bytes += (*analyze_events)[i][j].bytes();
           }
 
           // remove the push marker from the list
@@ -479,6 +540,37 @@ void ParseEvents(const std::vector<std::vector<Event>>& events,
                 merge_thread);
 }
 
+// Print the allocator statistics of each place
+void PrintAllocatorStats() {
+  std::cout << "\n------------------------->"
+            << "   Allocator Statistics   "
+            << "<-------------------------\n\n";
+  const size_t place_width = 20;
+  const size_t data_width = 16;
+  std::cout.setf(std::ios::left);
+  std::cout << std::setw(place_width) << "Place" << std::setw(data_width)
+            << "Current(MB)" << std::setw(data_width) << "Peak(MB)"
+            << std::setw(data_width) << "Allocs" << std::setw(data_width)
+            << "Free(MB)" << std::setw(data_width) << "FreeChunks"
+            << std::setw(data_width) << "Largest(MB)"
+            << std::setw(data_width) << "Fragmentation" << std::endl;
+  const double mb = 1 << 20;
+  auto all_stats =
+      memory::allocation::AllocatorFacade::Instance().GetAllStats();
+  for (auto& pair : all_stats) {
+    auto& stats = pair.second;
+    std::cout << std::setw(place_width) << pair.first << std::setw(data_width)
+              << stats.current_bytes / mb << std::setw(data_width)
+              << stats.peak_bytes / mb << std::setw(data_width)
+              << stats.num_allocs << std::setw(data_width)
+              << stats.free_bytes / mb << std::setw(data_width)
+              << stats.num_free_chunks << std::setw(data_width)
+              << stats.largest_free_chunk / mb << std::setw(data_width)
+              << stats.FragmentationRatio() << std::endl;
+  }
+  std::cout << std::endl;
+}
+
 void DisableProfiler(EventSortingKey sorted_key,
                      const std::string& profile_path) {
   std::lock_guard<std::mutex> l(profiler_mu);
@@ -489,11 +581,20 @@ void DisableProfiler(EventSortingKey sorted_key,
   std::vector<std::vector<Event>> all_events = GetAllEvents();
   ParseEvents(all_events, true, sorted_key);
   ParseEvents(all_events, false, sorted_key);
+  if (FLAGS_profile_allocator_stats) {
+    PrintAllocatorStats();
+  }
   ResetProfiler();
   DeviceTracer* tracer = GetDeviceTracer();
   if (tracer->IsEnabled()) {
     tracer->Disable();
     tracer->GenProfile(profile_path);
+    if (FLAGS_profile_chrome_trace) {
+      const char* trainer_id = std::getenv("PADDLE_TRAINER_ID");
+      int id = trainer_id == nullptr ? 0 : std::atoi(trainer_id);
+      tracer->GenChromeTrace(string::Sprintf("%s.%d.json", profile_path, id),
+                             id);
+    }
   }
   g_state = ProfilerState::kDisabled;
   should_send_profile_state = true;
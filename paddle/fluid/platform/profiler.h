@@ -44,12 +44,22 @@ class Event {
   double CpuElapsedMs(const Event& e) const;
   double CudaElapsedMs(const Event& e) const;
 
+  // The flops and the bytes of the range, which are set to its pop event.
+  void set_cost(double flops, double bytes) {
+    flops_ = flops;
+    bytes_ = bytes;
+  }
+  double flops() const { return flops_; }
+  double bytes() const { return bytes_; }
+
  private:
   EventType type_;
   std::string name_;
   uint32_t thread_id_;
   int64_t cpu_ns_;
   bool has_cuda_;
+  double flops_ = 0;
+  double bytes_ = 0;
 #ifdef PADDLE_WITH_CUDA
   cudaEvent_t event_ = nullptr;
   int device_ = -1;
@@ -75,6 +85,13 @@ struct RecordEvent {
 
   ~RecordEvent();
 
+  // Set the cost of the event, so that the achieved GFLOP/s and GB/s are
+  // reported.
+  void SetCost(double flops, double bytes) {
+    flops_ = flops;
+    bytes_ = bytes;
+  }
+
   bool is_enabled_;
   uint64_t start_ns_;
   // The device context is used by Event to get the current cuda stream.
@@ -84,6 +101,8 @@ struct RecordEvent {
   // Need to distinguish name by op type, block_id, program_id and perhaps
   // different kernel invocations within an op.
   std::string full_name_;
+  double flops_ = 0;
+  double bytes_ = 0;
 };
 
 class RecordRPCEvent {
@@ -96,6 +115,10 @@ class RecordRPCEvent {
   std::unique_ptr<RecordEvent> event_;
 };
 
+// Record the value of a counter, e.g. the size of a queue, in the timeline
+// if the profiler is enabled.
+void RecordCounter(const std::string& name, int64_t value);
+
 struct RecordBlock {
   explicit RecordBlock(int block_id);
   ~RecordBlock();
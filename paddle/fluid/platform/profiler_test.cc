@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/platform/profiler.h"
+#include <fstream>
+#include <iterator>
 #include <string>
 #ifdef PADDLE_WITH_CUDA
 #include <cuda_runtime.h>
@@ -162,6 +164,28 @@ TEST(RecordEvent, RecordEvent) {
   DisableProfiler(EventSortingKey::kTotal, "/tmp/profiler");
 }
 
+TEST(DeviceTracer, GenChromeTrace) {
+  using paddle::platform::DeviceTracer;
+  DeviceTracer* tracer = paddle::platform::GetDeviceTracer();
+  tracer->Enable();
+  tracer->AddCPURecords("op\"1", 1000, 3500, 0, 7);
+  tracer->AddCounterRecord("reader_queue_size", 2000, 4);
+  tracer->Disable();
+  tracer->GenChromeTrace("/tmp/profiler.3.json", 3);
+
+  std::ifstream trace_f("/tmp/profiler.3.json");
+  std::string trace((std::istreambuf_iterator<char>(trace_f)),
+                    std::istreambuf_iterator<char>());
+  EXPECT_NE(trace.find("\"name\":\"op\\\"1\",\"cat\":\"cpu\",\"ph\":\"X\","
+                       "\"pid\":300,\"tid\":7,\"ts\":1.000,\"dur\":2.500"),
+            std::string::npos);
+  EXPECT_NE(trace.find("\"name\":\"reader_queue_size\",\"ph\":\"C\","
+                       "\"pid\":300,\"ts\":2.000,\"args\":{\"value\":4}"),
+            std::string::npos);
+  EXPECT_NE(trace.find("\"args\":{\"name\":\"trainer 3: CPU\"}"),
+            std::string::npos);
+}
+
 #ifdef PADDLE_WITH_CUDA
 TEST(TMP, stream_wait) {
   cudaStream_t stream;
@@ -0,0 +1,236 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/sampling_profiler.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace platform {
+
+namespace detail {
+thread_local bool g_run_sampled = false;
+}  // namespace detail
+
+namespace {
+
+// A record packs the event id in the high 16 bits and the latency in ns in
+// the low 48 bits, so that it is written by one atomic store.
+constexpr int kEventIdBits = 16;
+constexpr int kMaxSampledEvents = 1 << kEventIdBits;
+constexpr uint64_t kLatencyMask = (1ULL << (64 - kEventIdBits)) - 1;
+
+// The histogram has 4 buckets for every power of 2 of the latency in ns.
+constexpr int kSubBuckets = 4;
+constexpr int kNumBuckets = 64 * kSubBuckets;
+
+inline int BucketOf(uint64_t ns) {
+  if (ns < kSubBuckets) return static_cast<int>(ns);
+  int e = 63 - __builtin_clzll(ns);
+  return e * kSubBuckets + static_cast<int>((ns >> (e - 2)) & 3);
+}
+
+// The middle of the latencies of the bucket.
+inline double BucketValue(int bucket) {
+  if (bucket < kSubBuckets) return bucket;
+  int e = bucket / kSubBuckets;
+  int sub = bucket % kSubBuckets;
+  double width = static_cast<double>(1ULL << (e - 2));
+  return (kSubBuckets + sub) * width + width / 2;
+}
+
+inline uint64_t NowInNsec() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// The ring buffer of a thread, which is written only by the thread and read
+// by the aggregator. When the reader falls behind by more than kSize
+// records, the oldest ones are dropped.
+struct SampleRing {
+  static constexpr uint64_t kSize = 4096;
+  std::atomic<uint64_t> head{0};
+  std::array<std::atomic<uint64_t>, kSize> records;
+  // Only accessed by the aggregator.
+  uint64_t tail{0};
+
+  void Push(uint64_t record) {
+    uint64_t h = head.load(std::memory_order_relaxed);
+    records[h % kSize].store(record, std::memory_order_relaxed);
+    head.store(h + 1, std::memory_order_release);
+  }
+};
+
+struct EventHistogram {
+  uint64_t count{0};
+  uint64_t total_ns{0};
+  uint64_t max_ns{0};
+  std::array<uint64_t, kNumBuckets> buckets{};
+
+  void Add(uint64_t ns) {
+    ++count;
+    total_ns += ns;
+    max_ns = std::max(max_ns, ns);
+    ++buckets[BucketOf(ns)];
+  }
+
+  double Quantile(double q) const {
+    uint64_t rank = static_cast<uint64_t>(q * (count - 1));
+    uint64_t seen = 0;
+    for (int i = 0; i < kNumBuckets; ++i) {
+      seen += buckets[i];
+      if (seen > rank) {
+        return std::min(BucketValue(i), static_cast<double>(max_ns));
+      }
+    }
+    return static_cast<double>(max_ns);
+  }
+};
+
+std::atomic<int> g_sampling_rate{0};
+std::atomic<uint64_t> g_run_counter{0};
+thread_local int g_run_depth = 0;
+
+std::mutex g_event_names_mutex;
+std::unordered_map<std::string, int> g_event_ids;
+std::vector<std::string> g_event_names;
+
+std::mutex g_rings_mutex;
+std::list<std::shared_ptr<SampleRing>> g_rings;
+thread_local std::shared_ptr<SampleRing> g_ring;
+
+// The histograms of the events, guarded by g_rings_mutex.
+std::unordered_map<int, EventHistogram> g_histograms;
+
+SampleRing* GetSampleRing() {
+  if (!g_ring) {
+    std::lock_guard<std::mutex> guard(g_rings_mutex);
+    g_ring = std::make_shared<SampleRing>();
+    for (auto& record : g_ring->records) record.store(0);
+    g_rings.emplace_back(g_ring);
+  }
+  return g_ring.get();
+}
+
+// Move the records of all the rings into the histograms, g_rings_mutex
+// should be held.
+void DrainRings() {
+  for (auto& ring : g_rings) {
+    uint64_t head = ring->head.load(std::memory_order_acquire);
+    uint64_t begin = head > ring->tail + SampleRing::kSize
+                         ? head - SampleRing::kSize
+                         : ring->tail;
+    for (uint64_t i = begin; i < head; ++i) {
+      uint64_t record =
+          ring->records[i % SampleRing::kSize].load(std::memory_order_relaxed);
+      g_histograms[static_cast<int>(record >> (64 - kEventIdBits))].Add(
+          record & kLatencyMask);
+    }
+    // The records the writer may have overwritten while reading are
+    // already counted, which is tolerable for the stats.
+    ring->tail = head;
+  }
+}
+
+}  // namespace
+
+void SetSamplingProfilerRate(int rate) {
+  PADDLE_ENFORCE_GE(rate, 0, "The sampling rate should not be negative.");
+  g_sampling_rate.store(rate, std::memory_order_relaxed);
+}
+
+int GetSamplingProfilerRate() {
+  return g_sampling_rate.load(std::memory_order_relaxed);
+}
+
+int SampledEventId(const std::string& name) {
+  std::lock_guard<std::mutex> guard(g_event_names_mutex);
+  auto it = g_event_ids.find(name);
+  if (it != g_event_ids.end()) return it->second;
+  int id = static_cast<int>(g_event_names.size());
+  PADDLE_ENFORCE_LT(id, kMaxSampledEvents, "Too many sampled events.");
+  g_event_names.emplace_back(name);
+  g_event_ids.emplace(name, id);
+  return id;
+}
+
+SampledRun::SampledRun() : is_outer_(g_run_depth++ == 0) {
+  if (!is_outer_) return;
+  int rate = g_sampling_rate.load(std::memory_order_relaxed);
+  detail::g_run_sampled =
+      rate > 0 &&
+      g_run_counter.fetch_add(1, std::memory_order_relaxed) % rate == 0;
+}
+
+SampledRun::~SampledRun() {
+  --g_run_depth;
+  if (is_outer_) detail::g_run_sampled = false;
+}
+
+void RecordSampledEvent(int event_id, uint64_t latency_ns) {
+  GetSampleRing()->Push((static_cast<uint64_t>(event_id)
+                         << (64 - kEventIdBits)) |
+                        std::min(latency_ns, kLatencyMask));
+}
+
+SampledEvent::SampledEvent(int event_id)
+    : event_id_(event_id), start_ns_(IsRunSampled() ? NowInNsec() : 0) {}
+
+SampledEvent::~SampledEvent() {
+  if (start_ns_ == 0) return;
+  RecordSampledEvent(event_id_, NowInNsec() - start_ns_);
+}
+
+std::vector<SampledEventStats> GetSampledEventStats() {
+  std::vector<SampledEventStats> stats;
+  {
+    std::lock_guard<std::mutex> guard(g_rings_mutex);
+    DrainRings();
+    std::lock_guard<std::mutex> names_guard(g_event_names_mutex);
+    for (auto& item : g_histograms) {
+      auto& h = item.second;
+      if (h.count == 0) continue;
+      SampledEventStats s;
+      s.name = g_event_names.at(item.first);
+      s.count = h.count;
+      s.total_ms = h.total_ns / 1e6;
+      s.max_ms = h.max_ns / 1e6;
+      s.p50_ms = h.Quantile(0.5) / 1e6;
+      s.p99_ms = h.Quantile(0.99) / 1e6;
+      stats.emplace_back(s);
+    }
+  }
+  std::sort(stats.begin(), stats.end(),
+            [](const SampledEventStats& a, const SampledEventStats& b) {
+              return a.name < b.name;
+            });
+  return stats;
+}
+
+void ResetSampledEventStats() {
+  std::lock_guard<std::mutex> guard(g_rings_mutex);
+  DrainRings();
+  g_histograms.clear();
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,92 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace platform {
+
+/*
+ * The sampling profiler is cheap enough to be always on: it profiles 1 of
+ * every N runs of the executors, the events are identified by the interned
+ * ids, and the latencies are written to the lock-free ring buffer of every
+ * thread. The buffers are only drained, into the latency histograms of the
+ * events, when the stats are read by GetSampledEventStats.
+ */
+
+// The latency stats of one event in the sampled runs, the quantiles are
+// estimated by the histogram, whose relative error is less than 1/8.
+struct SampledEventStats {
+  std::string name;
+  uint64_t count;
+  double total_ms;
+  double max_ms;
+  double p50_ms;
+  double p99_ms;
+};
+
+// Profile 1 of every rate runs, 0 disables the sampling profiler.
+void SetSamplingProfilerRate(int rate);
+int GetSamplingProfilerRate();
+
+// The interned id of the event name, only the first call of a name takes
+// the lock to register it.
+int SampledEventId(const std::string& name);
+
+namespace detail {
+extern thread_local bool g_run_sampled;
+}  // namespace detail
+
+// Whether the current run of this thread is sampled.
+inline bool IsRunSampled() { return detail::g_run_sampled; }
+
+// Mark the scope of a run of the executor on this thread, which is sampled
+// by the rate. The runs nested in a run, e.g. the sub-blocks, follow the
+// outer one.
+class SampledRun {
+ public:
+  SampledRun();
+  ~SampledRun();
+
+ private:
+  bool is_outer_;
+};
+
+// Record the latency of an event in the sampled runs of this thread.
+void RecordSampledEvent(int event_id, uint64_t latency_ns);
+
+// Record the latency of the scope as the event if the run is sampled.
+class SampledEvent {
+ public:
+  explicit SampledEvent(int event_id);
+  ~SampledEvent();
+
+ private:
+  int event_id_;
+  uint64_t start_ns_;
+};
+
+// Drain the ring buffers and return the stats of all the events recorded
+// since the last reset, the events are sorted by the names.
+std::vector<SampledEventStats> GetSampledEventStats();
+
+// Clear the stats of all the events.
+void ResetSampledEventStats();
+
+}  // namespace platform
+}  // namespace paddle
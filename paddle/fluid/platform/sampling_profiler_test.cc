@@ -0,0 +1,84 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/sampling_profiler.h"
+#include <thread>  // NOLINT
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace platform {
+
+TEST(SamplingProfiler, EventId) {
+  int id = SampledEventId("sampling_profiler_test_a");
+  EXPECT_EQ(SampledEventId("sampling_profiler_test_a"), id);
+  EXPECT_NE(SampledEventId("sampling_profiler_test_b"), id);
+}
+
+TEST(SamplingProfiler, SampleRate) {
+  ResetSampledEventStats();
+  SetSamplingProfilerRate(4);
+  int id = SampledEventId("sampled_op");
+  int sampled = 0;
+  for (int i = 0; i < 100; ++i) {
+    SampledRun run;
+    {
+      // The nested runs follow the outer one.
+      SampledRun nested_run;
+      sampled += IsRunSampled();
+    }
+    if (IsRunSampled()) RecordSampledEvent(id, 1000);
+  }
+  EXPECT_FALSE(IsRunSampled());
+  EXPECT_EQ(sampled, 25);
+
+  auto stats = GetSampledEventStats();
+  ASSERT_EQ(stats.size(), 1UL);
+  EXPECT_EQ(stats[0].name, "sampled_op");
+  EXPECT_EQ(stats[0].count, 25UL);
+  EXPECT_NEAR(stats[0].total_ms, 0.025, 1e-9);
+
+  SetSamplingProfilerRate(0);
+  {
+    SampledRun run;
+    EXPECT_FALSE(IsRunSampled());
+  }
+  ResetSampledEventStats();
+  EXPECT_TRUE(GetSampledEventStats().empty());
+}
+
+TEST(SamplingProfiler, Quantile) {
+  ResetSampledEventStats();
+  int id = SampledEventId("quantile_op");
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([id] {
+      // 1us for 98 events of each 100, and 1ms for the others.
+      for (int i = 0; i < 1000; ++i) {
+        RecordSampledEvent(id, i % 100 < 98 ? 1000 : 1000000);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  auto stats = GetSampledEventStats();
+  ASSERT_EQ(stats.size(), 1UL);
+  EXPECT_EQ(stats[0].count, 4000UL);
+  EXPECT_NEAR(stats[0].p50_ms, 0.001, 0.001 / 8);
+  EXPECT_NEAR(stats[0].p99_ms, 1.0, 1.0 / 8);
+  EXPECT_DOUBLE_EQ(stats[0].max_ms, 1.0);
+  ResetSampledEventStats();
+}
+
+}  // namespace platform
+}  // namespace paddle
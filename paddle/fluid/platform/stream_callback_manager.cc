@@ -13,6 +13,9 @@
 // limitations under the License.
 
 #include "paddle/fluid/platform/stream_callback_manager.h"
+#include <algorithm>
+#include <utility>
+#include "glog/logging.h"
 #include "paddle/fluid/platform/enforce.h"
 
 namespace paddle {
@@ -30,33 +33,146 @@ static void CUDART_CB StreamCallbackFunc(cudaStream_t stream,
   (*func)();
 }
 
+static bool IsCapturing(cudaStream_t stream) {
+#if CUDA_VERSION >= 10000
+  cudaStreamCaptureStatus status;
+  PADDLE_ENFORCE(cudaStreamIsCapturing(stream, &status));
+  return status != cudaStreamCaptureStatusNone;
+#else
+  return false;
+#endif
+}
+
 StreamCallbackManager::StreamCallbackManager(const cudaStream_t stream)
-    : stream_(stream), thread_pool_(1) {}
+    : stream_(stream), thread_([this] { Loop(); }) {}
 
-void StreamCallbackManager::AddCallback(std::function<void()> callback) const {
-  auto *callback_func = new std::function<void()>(std::move(callback));
-  auto *func = new std::function<void()>([this, callback_func] {
+StreamCallbackManager::~StreamCallbackManager() {
+  {
     std::lock_guard<std::mutex> lock(mtx_);
-    last_future_ = thread_pool_.enqueue([callback_func] {
-      std::unique_ptr<std::function<void()>> releaser(callback_func);
-      (*callback_func)();
+    stop_ = true;
+  }
+  added_cv_.notify_all();
+  thread_.join();
+  // The runtime may be unloaded at exit, the errors are ignored.
+  for (auto event : free_events_) {
+    cudaEventDestroy(event);
+  }
+}
+
+void StreamCallbackManager::AddCallback(std::function<void()> callback) const {
+  PendingCallback pending{nullptr, std::move(callback), Clock::now()};
+  if (IsCapturing(stream_)) {
+    // The events of a captured stream cannot be queried, the host node of
+    // the graph hands the callback to the callback thread when it runs.
+    auto *func = new std::function<void()>([this, pending]() mutable {
+      pending.added_time = Clock::now();
+      {
+        std::lock_guard<std::mutex> lock(mtx_);
+        pending_.push_back(std::move(pending));
+        ++num_added_;
+      }
+      added_cv_.notify_one();
     });
-  });
 #if CUDA_VERSION >= 10000
-  PADDLE_ENFORCE(cudaLaunchHostFunc(stream_, StreamCallbackFunc, func));
+    PADDLE_ENFORCE(cudaLaunchHostFunc(stream_, StreamCallbackFunc, func));
 #else
-  PADDLE_ENFORCE(cudaStreamAddCallback(stream_, StreamCallbackFunc, func, 0));
+    PADDLE_ENFORCE(
+        cudaStreamAddCallback(stream_, StreamCallbackFunc, func, 0));
 #endif
-}
+    return;
+  }
 
-void StreamCallbackManager::Wait() const {
-  PADDLE_ENFORCE(cudaStreamSynchronize(stream_));
   {
     std::lock_guard<std::mutex> lock(mtx_);
-    if (last_future_.valid()) {
-      last_future_.wait();
+    if (!free_events_.empty()) {
+      pending.event = free_events_.back();
+      free_events_.pop_back();
     }
   }
+  if (pending.event == nullptr) {
+    PADDLE_ENFORCE(cudaEventCreateWithFlags(
+        &pending.event, cudaEventDisableTiming | cudaEventBlockingSync));
+  }
+  // The event is queued after it is recorded, so that the callback thread
+  // never waits for an event which is not recorded yet.
+  PADDLE_ENFORCE(cudaEventRecord(pending.event, stream_));
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    pending_.push_back(std::move(pending));
+    ++num_added_;
+  }
+  added_cv_.notify_one();
+}
+
+void StreamCallbackManager::Loop() const {
+  std::vector<PendingCallback> batch;
+  while (true) {
+    cudaEvent_t first_event;
+    {
+      std::unique_lock<std::mutex> lock(mtx_);
+      added_cv_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+      if (pending_.empty()) return;
+      first_event = pending_.front().event;
+    }
+    // The callbacks of the stream run in order, the thread sleeps until the
+    // first one is ready, and the others completed by then run with it.
+    // The errors of the stream are raised by its synchronizations instead.
+    if (first_event != nullptr) {
+      cudaEventSynchronize(first_event);
+    }
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      while (!pending_.empty()) {
+        auto event = pending_.front().event;
+        if (!batch.empty() && event != nullptr &&
+            cudaEventQuery(event) == cudaErrorNotReady) {
+          break;
+        }
+        if (event != nullptr) free_events_.push_back(event);
+        batch.emplace_back(std::move(pending_.front()));
+        pending_.pop_front();
+      }
+    }
+
+    auto start = Clock::now();
+    double total_latency_ms = 0;
+    double max_latency_ms = 0;
+    for (auto &pending : batch) {
+      double latency_ms = std::chrono::duration<double, std::milli>(
+                              start - pending.added_time)
+                              .count();
+      total_latency_ms += latency_ms;
+      max_latency_ms = std::max(max_latency_ms, latency_ms);
+      try {
+        pending.callback();
+      } catch (std::exception &e) {
+        LOG(ERROR) << "A stream callback failed: " << e.what();
+      }
+    }
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      num_finished_ += batch.size();
+      stat_.callbacks += batch.size();
+      stat_.batches += 1;
+      stat_.total_latency_ms += total_latency_ms;
+      stat_.max_latency_ms = std::max(stat_.max_latency_ms, max_latency_ms);
+    }
+    batch.clear();
+    finished_cv_.notify_all();
+  }
+}
+
+void StreamCallbackManager::Wait() const {
+  PADDLE_ENFORCE(cudaStreamSynchronize(stream_));
+  std::unique_lock<std::mutex> lock(mtx_);
+  int64_t num_added = num_added_;
+  finished_cv_.wait(lock, [&] { return num_finished_ >= num_added; });
+}
+
+StreamCallbackManager::CallbackStat StreamCallbackManager::GetCallbackStat()
+    const {
+  std::lock_guard<std::mutex> lock(mtx_);
+  return stat_;
 }
 
 }  // namespace platform
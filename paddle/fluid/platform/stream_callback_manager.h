@@ -14,13 +14,16 @@
 
 #pragma once
 
-#include <ThreadPool.h>
 #include <cuda.h>
 #include <cuda_runtime.h>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <functional>
-#include <future>  // NOLINT
 #include <memory>
-#include <mutex>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "paddle/fluid/platform/enforce.h"
 
@@ -29,21 +32,59 @@ namespace platform {
 
 // NOTE(zjl): clean StreamCallbackManager to make compilation faster
 // Make StreamCallbackManager thread-safe
+//
+// The callbacks do not stall the stream: AddCallback records an event on
+// the stream, and the callback thread of the manager waits for the events
+// in order and runs the callbacks of all the completed ones as a batch.
+// The callbacks added while the stream is captured into a CUDA graph are
+// host nodes of the graph instead.
 class StreamCallbackManager {
  public:
+  // The statistics of the callbacks since the creation of the manager.
+  struct CallbackStat {
+    int64_t callbacks{0};
+    // The number of the wake-ups of the callback thread, each of which runs
+    // a batch of callbacks.
+    int64_t batches{0};
+    // The time from AddCallback to the start of the callbacks, which
+    // contains the time of the work queued on the stream before them.
+    double total_latency_ms{0};
+    double max_latency_ms{0};
+  };
+
   explicit StreamCallbackManager(const cudaStream_t stream);
 
-  ~StreamCallbackManager() = default;
+  ~StreamCallbackManager();
 
   void AddCallback(std::function<void()> callback) const;
 
   void Wait() const;
 
+  CallbackStat GetCallbackStat() const;
+
  private:
+  using Clock = std::chrono::steady_clock;
+
+  struct PendingCallback {
+    cudaEvent_t event;
+    std::function<void()> callback;
+    Clock::time_point added_time;
+  };
+
+  void Loop() const;
+
   const cudaStream_t stream_;
-  mutable ::ThreadPool thread_pool_;
   mutable std::mutex mtx_;
-  mutable std::future<void> last_future_;
+  mutable std::condition_variable added_cv_;
+  mutable std::condition_variable finished_cv_;
+  mutable std::deque<PendingCallback> pending_;
+  // The events of the run callbacks, which are reused.
+  mutable std::vector<cudaEvent_t> free_events_;
+  mutable int64_t num_added_{0};
+  mutable int64_t num_finished_{0};
+  mutable CallbackStat stat_;
+  bool stop_{false};
+  std::thread thread_;
 };
 
 }  // namespace platform
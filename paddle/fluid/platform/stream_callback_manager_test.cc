@@ -0,0 +1,58 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/platform/stream_callback_manager.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace paddle {
+namespace platform {
+
+TEST(StreamCallbackManager, RunInOrderAfterTheStream) {
+  cudaStream_t stream;
+  PADDLE_ENFORCE(cudaStreamCreate(&stream));
+  const size_t kSize = 16 << 20;
+  std::vector<char> host(kSize, 1);
+  void* device = nullptr;
+  PADDLE_ENFORCE(cudaMalloc(&device, kSize));
+
+  std::vector<int> order;
+  {
+    StreamCallbackManager manager(stream);
+    for (int i = 0; i < 100; ++i) {
+      PADDLE_ENFORCE(cudaMemcpyAsync(device, host.data(), kSize,
+                                     cudaMemcpyHostToDevice, stream));
+      manager.AddCallback([&order, i] { order.push_back(i); });
+    }
+    manager.Wait();
+    ASSERT_EQ(order.size(), 100UL);
+    for (int i = 0; i < 100; ++i) EXPECT_EQ(order[i], i);
+
+    auto stat = manager.GetCallbackStat();
+    EXPECT_EQ(stat.callbacks, 100);
+    EXPECT_GE(stat.batches, 1);
+    EXPECT_LE(stat.batches, 100);
+    EXPECT_GE(stat.max_latency_ms, 0);
+
+    // The callbacks queued at the destruction are run by it.
+    manager.AddCallback([&order] { order.push_back(100); });
+  }
+  EXPECT_EQ(order.size(), 101UL);
+
+  PADDLE_ENFORCE(cudaFree(device));
+  PADDLE_ENFORCE(cudaStreamDestroy(stream));
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -14,6 +14,9 @@
 
 #include "paddle/fluid/platform/temporary_allocator.h"
 #include "paddle/fluid/memory/allocation/allocator_facade.h"
+#ifdef PADDLE_WITH_CUDA
+#include "paddle/fluid/memory/allocation/stream_safe_cuda_allocator.h"
+#endif
 
 DEFINE_double(limit_of_temporary_allocation, -1,
               "The up limit of temporary_allocation size.");
@@ -32,6 +35,14 @@ TemporaryAllocator::TemporaryAllocator(platform::Place place) : place_(place) {
   temp_mem_queue_.reset(new std::deque<TemporaryAllocation *>());
 }
 
+#ifdef PADDLE_WITH_CUDA
+TemporaryAllocator::TemporaryAllocator(platform::Place place,
+                                       cudaStream_t stream)
+    : place_(place), stream_(stream), has_stream_(true) {
+  temp_mem_queue_.reset(new std::deque<TemporaryAllocation *>());
+}
+#endif
+
 bool TemporaryAllocator::IsAllocThreadSafe() const { return true; }
 
 void TemporaryAllocator::Release(const std::function<void()> &callback) {
@@ -53,7 +64,8 @@ void TemporaryAllocator::Release(const std::function<void()> &callback) {
 void TemporaryAllocator::Free(alloc::Allocation *allocation) {
   auto *temp_allocation = dynamic_cast<TemporaryAllocation *>(allocation);
   PADDLE_ENFORCE_NOT_NULL(temp_allocation);
-  if (platform::is_gpu_place(temp_allocation->place())) {
+  if (platform::is_gpu_place(temp_allocation->place()) &&
+      !alloc::AllocatorFacade::IsGPUFreeStreamOrdered()) {
     size_t wait_delete_mem = 0;
     {
       std::unique_lock<std::mutex> lock(mtx_);
@@ -84,6 +96,12 @@ void TemporaryAllocator::SetCallback(const std::function<void()> &callback) {
 
 alloc::Allocation *TemporaryAllocator::AllocateImpl(
     size_t size, alloc::Allocator::Attr attr) {
+#ifdef PADDLE_WITH_CUDA
+  std::unique_ptr<alloc::CUDAAllocationStreamGuard> stream_guard;
+  if (has_stream_) {
+    stream_guard.reset(new alloc::CUDAAllocationStreamGuard(stream_));
+  }
+#endif
   auto raw_allocation =
       alloc::AllocatorFacade::Instance().Alloc(place_, size, attr);
   auto temp_mem = new TemporaryAllocation(std::move(raw_allocation));
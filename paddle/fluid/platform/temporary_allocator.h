@@ -16,6 +16,9 @@
 #include <condition_variable>  // NOLINT
 #include <deque>
 #include <mutex>  // NOLINT
+#ifdef PADDLE_WITH_CUDA
+#include <cuda_runtime.h>
+#endif
 #include "paddle/fluid/memory/allocation/allocator.h"
 #include "paddle/fluid/platform/lock_guard_ptr.h"
 namespace paddle {
@@ -41,11 +44,20 @@ class TemporaryAllocation : public memory::allocation::Allocation {
  *   - when the allocation size of opportunities exceeds a certain threshold
  *     (defined by FLAGS_limit_of_temporary_allocation).
  *
+ * If the GPU memory is freed in the order of the stream, see
+ * AllocatorFacade::IsGPUFreeStreamOrdered, the allocation is freed
+ * immediately instead.
+ *
  * */
 class TemporaryAllocator : public memory::allocation::Allocator {
  public:
   explicit TemporaryAllocator(platform::Place place);
 
+#ifdef PADDLE_WITH_CUDA
+  // The allocations are used on the stream.
+  TemporaryAllocator(platform::Place place, cudaStream_t stream);
+#endif
+
   void Release(const std::function<void()> &callback);
 
   size_t TemporaryAllocationQueueSize();
@@ -63,6 +75,11 @@ class TemporaryAllocator : public memory::allocation::Allocator {
  private:
   platform::Place place_;
 
+#ifdef PADDLE_WITH_CUDA
+  cudaStream_t stream_{nullptr};
+  bool has_stream_{false};
+#endif
+
   // When the allocation is not held by any variable, it should be placed
   // to temp_mem_queue immediately.
   std::shared_ptr<std::deque<TemporaryAllocation *>> temp_mem_queue_{nullptr};
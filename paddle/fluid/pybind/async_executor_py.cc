@@ -41,6 +41,20 @@ namespace pd = paddle::framework;
 namespace paddle {
 namespace pybind {
 using set_name_func = void (pd::DataFeedDesc::*)(const std::string&);
+
+static void BindConvertMultiSlotTextToBinary(py::module* m) {
+  m->def("convert_multi_slot_text_to_binary",
+         [](const std::string& data_feed_desc_str, const std::string& text_file,
+            const std::string& binary_file) {
+           pd::DataFeedDesc data_feed_desc;
+           PADDLE_ENFORCE(google::protobuf::TextFormat::ParseFromString(
+                              data_feed_desc_str, &data_feed_desc),
+                          "Fail to parse the DataFeedDesc.");
+           return pd::ConvertMultiSlotTextToBinary(data_feed_desc, text_file,
+                                                   binary_file);
+         });
+}
+
 #ifdef PADDLE_WITH_PSLIB
 void BindAsyncExecutor(py::module* m) {
   py::class_<framework::AsyncExecutor>(*m, "AsyncExecutor")
@@ -49,6 +63,11 @@ void BindAsyncExecutor(py::module* m) {
             new framework::AsyncExecutor(scope, place));
       }))
       .def("run_from_files", &framework::AsyncExecutor::RunFromFile)
+      .def("load_into_memory", &framework::AsyncExecutor::LoadIntoMemory)
+      .def("local_shuffle", &framework::AsyncExecutor::LocalShuffle)
+      .def("global_shuffle", &framework::AsyncExecutor::GlobalShuffle)
+      .def("release_memory", &framework::AsyncExecutor::ReleaseMemory)
+      .def("run_from_memory", &framework::AsyncExecutor::RunFromMemory)
       .def("init_server", &framework::AsyncExecutor::InitServer)
       .def("init_worker", &framework::AsyncExecutor::InitWorker)
       .def("start_server", &framework::AsyncExecutor::StartServer)
@@ -56,6 +75,7 @@ void BindAsyncExecutor(py::module* m) {
       .def("gather_servers", &framework::AsyncExecutor::GatherServers)
       .def("init_model", &framework::AsyncExecutor::InitModel)
       .def("save_model", &framework::AsyncExecutor::SaveModel);
+  BindConvertMultiSlotTextToBinary(m);
 }  // end BindAsyncExecutor
 #else
 void BindAsyncExecutor(py::module* m) {
@@ -64,7 +84,13 @@ void BindAsyncExecutor(py::module* m) {
         return std::unique_ptr<framework::AsyncExecutor>(
             new framework::AsyncExecutor(scope, place));
       }))
-      .def("run_from_files", &framework::AsyncExecutor::RunFromFile);
+      .def("run_from_files", &framework::AsyncExecutor::RunFromFile)
+      .def("load_into_memory", &framework::AsyncExecutor::LoadIntoMemory)
+      .def("local_shuffle", &framework::AsyncExecutor::LocalShuffle)
+      .def("global_shuffle", &framework::AsyncExecutor::GlobalShuffle)
+      .def("release_memory", &framework::AsyncExecutor::ReleaseMemory)
+      .def("run_from_memory", &framework::AsyncExecutor::RunFromMemory);
+  BindConvertMultiSlotTextToBinary(m);
 }  // end BindAsyncExecutor
 #endif
 }  // end namespace pybind
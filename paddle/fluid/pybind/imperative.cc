@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include "paddle/fluid/pybind/imperative.h"
 #include "paddle/fluid/framework/block_desc.h"
+#include "paddle/fluid/imperative/jit.h"
 #include "paddle/fluid/imperative/tracer.h"
 
 namespace paddle {
@@ -31,5 +32,22 @@ void BindTracer(pybind11::module *m) {
            pybind11::return_value_policy::take_ownership);
 }
 
+void BindTracedLayer(pybind11::module *m) {
+  pybind11::class_<imperative::TracedLayer>(*m, "TracedLayer", "")
+      .def("__init__",
+           [](imperative::TracedLayer &self, imperative::Tracer *tracer,
+              const std::vector<std::string> &passes) {
+             new (&self) imperative::TracedLayer(tracer, passes);
+           },
+           pybind11::keep_alive<1, 2>())
+      .def("begin_trace", &imperative::TracedLayer::BeginTrace)
+      .def("end_trace", &imperative::TracedLayer::EndTrace)
+      .def("abort_trace", &imperative::TracedLayer::AbortTrace)
+      .def("has_program", &imperative::TracedLayer::HasProgram)
+      .def("need_trace", &imperative::TracedLayer::NeedTrace)
+      .def("run", &imperative::TracedLayer::Run,
+           pybind11::return_value_policy::take_ownership);
+}
+
 }  // namespace pybind
 }  // namespace paddle
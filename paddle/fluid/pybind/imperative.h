@@ -45,5 +45,7 @@ class PyVarBase : public imperative::VarBase {
 
 void BindTracer(pybind11::module* m);
 
+void BindTracedLayer(pybind11::module* m);
+
 }  // namespace pybind
 }  // namespace paddle
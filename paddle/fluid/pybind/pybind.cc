@@ -21,6 +21,7 @@ limitations under the License. */
 #include <utility>
 #include <vector>
 
+#include "paddle/fluid/framework/async_tensor_saver.h"
 #include "paddle/fluid/framework/executor.h"
 #include "paddle/fluid/framework/feed_fetch_method.h"
 #include "paddle/fluid/framework/framework.pb.h"
@@ -30,21 +31,29 @@ limitations under the License. */
 #include "paddle/fluid/framework/lod_tensor_array.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/parallel_executor.h"
+#include "paddle/fluid/framework/pipeline_executor.h"
 #include "paddle/fluid/framework/prune.h"
 #include "paddle/fluid/framework/reader.h"
+#include "paddle/fluid/framework/reader_stats.h"
 #include "paddle/fluid/framework/scope_pool.h"
 #include "paddle/fluid/framework/selected_rows.h"
 #include "paddle/fluid/framework/version.h"
+#include "paddle/fluid/imperative/engine.h"
 #include "paddle/fluid/imperative/layer.h"
+#include "paddle/fluid/memory/allocation/allocator_facade.h"
 #include "paddle/fluid/memory/allocation/allocator_strategy.h"
 #include "paddle/fluid/operators/activation_op.h"
 #include "paddle/fluid/operators/py_func_op.h"
 #include "paddle/fluid/operators/reader/lod_tensor_blocking_queue.h"
+#ifndef _WIN32
+#include "paddle/fluid/operators/reader/shared_memory_channel.h"
+#endif
 #include "paddle/fluid/platform/cpu_info.h"
 #include "paddle/fluid/platform/enforce.h"
 #include "paddle/fluid/platform/init.h"
 #include "paddle/fluid/platform/place.h"
 #include "paddle/fluid/platform/profiler.h"
+#include "paddle/fluid/platform/sampling_profiler.h"
 #include "paddle/fluid/pybind/async_executor_py.h"
 #include "paddle/fluid/pybind/const_value.h"
 #include "paddle/fluid/pybind/exception.h"
@@ -89,13 +98,21 @@ bool IsCompiledWithBrpc() {
   return false;
 #endif
 
-#ifdef PADDLE_WITH_GRPC
+#if defined(PADDLE_WITH_GRPC) || defined(PADDLE_WITH_VERBS)
   return false;
 #endif
 
   return true;
 }
 
+bool IsCompiledWithVerbs() {
+#if defined(PADDLE_WITH_DISTRIBUTE) && defined(PADDLE_WITH_VERBS)
+  return true;
+#else
+  return false;
+#endif
+}
+
 bool IsCompiledWithDIST() {
 #ifdef PADDLE_WITH_DISTRIBUTE
   return true;
@@ -122,6 +139,8 @@ PYBIND11_MODULE(core, m) {
       [](py::object py_obj) -> size_t {
         return paddle::operators::AppendPythonCallableObjectAndReturnId(py_obj);
       });
+  m.def("_wait_py_func_calls", paddle::operators::WaitPyFuncAsyncCalls,
+        py::call_guard<py::gil_scoped_release>());
 
   m.add_object("_cleanup",
                py::capsule([]() { ScopePool::Instance().Clear(); }));
@@ -129,14 +148,22 @@ PYBIND11_MODULE(core, m) {
   py::class_<imperative::VarBase>(m, "VarBase", R"DOC()DOC")
       // .def(py::init<>())
       .def(py::init<bool>(), py::arg("stop_gradient") = false)
+      // The grad ops run on the threads of the backward, some of which call
+      // the python functions of the PyLayers.
       .def("_run_backward",
-           [](imperative::VarBase &self) { self.RunBackward(); })
+           [](imperative::VarBase &self) { self.RunBackward(); },
+           py::call_guard<py::gil_scoped_release>())
       .def("_grad_name", &imperative::VarBase::GradName)
       .def("_grad_value", &imperative::VarBase::GradValue)
       .def("_grad_ivar",
            [](const imperative::VarBase &self) { return self.grads_; },
            py::return_value_policy::reference)
-      .def("value", [](const imperative::VarBase &self) { return self.var_; },
+      .def("value",
+           [](const imperative::VarBase &self) {
+             // Wait for the ops writing the value.
+             imperative::GetEngine()->Sync();
+             return self.var_;
+           },
            py::return_value_policy::reference)
       .def_property(
           "desc",
@@ -200,6 +227,7 @@ PYBIND11_MODULE(core, m) {
       .def_static("num_funcs", &imperative::PyLayer::NumFuncs);
 
   BindTracer(&m);
+  BindTracedLayer(&m);
 
   py::class_<Tensor>(m, "Tensor", py::buffer_protocol())
       .def_buffer(
@@ -269,7 +297,28 @@ PYBIND11_MODULE(core, m) {
       .def("_get_float_element", TensorGetElement<float>)
       .def("_set_double_element", TensorSetElement<double>)
       .def("_get_double_element", TensorGetElement<double>)
-      .def("_dtype", [](Tensor &self) { return self.type(); });
+      .def("_dtype", [](Tensor &self) { return self.type(); })
+      .def("_share_data_with_array", TensorShareDataWithArray,
+           R"DOC(
+           Share the memory of a C-contiguous numpy array on CPU without
+           copying, the array is kept alive by the tensor. The writes to
+           either of them are seen by the other.
+           )DOC")
+      .def("_as_array", TensorToArrayView,
+           R"DOC(
+           Return a numpy array which shares the memory of a CPU or CUDA
+           pinned tensor without copying.
+           )DOC")
+      .def("_to_dlpack", TensorToDLPack,
+           R"DOC(
+           Return a DLPack capsule which shares the memory of the tensor
+           without copying. The capsule can be taken only once.
+           )DOC")
+      .def("_from_dlpack", TensorFromDLPack,
+           R"DOC(
+           Share the memory of a DLPack capsule without copying. The capsule
+           is taken, and can not be used again.
+           )DOC");
 
   py::class_<LoDTensor, Tensor>(m, "LoDTensor", R"DOC(
     LoDTensor is a Tensor with optional LoD information.
@@ -502,6 +551,42 @@ All parameter, weight, gradient are variables in Paddle.
             },
         py::return_value_policy::copy);
 
+#ifndef _WIN32
+  using SharedMemoryReceiver =
+      ::paddle::operators::reader::SharedMemoryReceiver;
+  py::class_<SharedMemoryReceiver>(m, "SharedMemoryReceiver", R"DOC(
+    Push the batches sent by the worker processes through the shared memory
+    into a LoDTensorBlockingQueue. The workers should be forked after the
+    receiver is created, and send by SharedMemorySender.
+    )DOC")
+      .def(py::init<const std::shared_ptr<LoDTensorBlockingQueue> &, size_t,
+                    size_t, size_t>(),
+           py::arg("queue"), py::arg("num_segments"), py::arg("segment_size"),
+           py::arg("num_senders"))
+      .def("segment_names", &SharedMemoryReceiver::SegmentNames)
+      .def("segment_size", &SharedMemoryReceiver::SegmentSize)
+      .def("free_fd", &SharedMemoryReceiver::FreeFd)
+      .def("ready_fd", &SharedMemoryReceiver::ReadyFd)
+      .def("start", &SharedMemoryReceiver::Start)
+      .def("stop", [](SharedMemoryReceiver &self) {
+        pybind11::gil_scoped_release release;
+        self.Stop();
+      });
+
+  using SharedMemorySender = ::paddle::operators::reader::SharedMemorySender;
+  py::class_<SharedMemorySender>(m, "SharedMemorySender", "")
+      .def(py::init<const std::vector<std::string> &, size_t, int, int>(),
+           py::arg("segment_names"), py::arg("segment_size"),
+           py::arg("free_fd"), py::arg("ready_fd"))
+      .def("send",
+           [](SharedMemorySender &self,
+              const std::vector<framework::LoDTensor> &lod_tensor_vec) {
+             pybind11::gil_scoped_release release;
+             self.Send(lod_tensor_vec);
+           })
+      .def("close", &SharedMemorySender::Close);
+#endif
+
   py::class_<Scope>(m, "_Scope", R"DOC(
     Scope is an association of a name to Variable. All variables belong to Scope.
 
@@ -650,6 +735,30 @@ All parameter, weight, gradient are variables in Paddle.
         self = cuda_pinned_place;
       });
 
+  using memory::allocation::AllocatorFacade;
+  using memory::allocation::AllocatorStats;
+  py::class_<AllocatorStats>(m, "AllocatorStats")
+      .def_readonly("current_bytes", &AllocatorStats::current_bytes)
+      .def_readonly("peak_bytes", &AllocatorStats::peak_bytes)
+      .def_readonly("num_allocs", &AllocatorStats::num_allocs)
+      .def_readonly("num_frees", &AllocatorStats::num_frees)
+      .def_readonly("size_histogram", &AllocatorStats::size_histogram)
+      .def_readonly("free_bytes", &AllocatorStats::free_bytes)
+      .def_readonly("num_free_chunks", &AllocatorStats::num_free_chunks)
+      .def_readonly("largest_free_chunk", &AllocatorStats::largest_free_chunk)
+      .def("fragmentation_ratio", &AllocatorStats::FragmentationRatio)
+      .def("__str__", &AllocatorStats::DebugString);
+
+  m.def("get_allocator_stats", [](const platform::CPUPlace &place) {
+    return AllocatorFacade::Instance().GetStats(place);
+  });
+  m.def("get_allocator_stats", [](const platform::CUDAPlace &place) {
+    return AllocatorFacade::Instance().GetStats(place);
+  });
+  m.def("get_allocator_stats", [](const platform::CUDAPinnedPlace &place) {
+    return AllocatorFacade::Instance().GetStats(place);
+  });
+
   py::class_<OperatorBase>(m, "Operator")
       .def_static("create",
                   [](py::bytes protobin) {
@@ -688,6 +797,8 @@ All parameter, weight, gradient are variables in Paddle.
            [](const OperatorBase &op) { return op.OutputVars(false); })
       .def("support_gpu", &OperatorBase::SupportGPU);
 
+  py::class_<framework::ExecutorPrepareContext>(m, "ExecutorPrepareContext");
+
   py::class_<framework::Executor>(m, "Executor")
       .def(py::init<const platform::Place &>())
       .def("close", &Executor::Close)
@@ -695,7 +806,20 @@ All parameter, weight, gradient are variables in Paddle.
                      int block_id, bool create_local_scope, bool create_vars) {
         pybind11::gil_scoped_release release;
         self.Run(prog, scope, block_id, create_local_scope, create_vars);
-      });
+      })
+      // The context refers to the program, which is kept alive with it.
+      .def("_prepare",
+           [](Executor &self, const ProgramDesc &prog, int block_id) {
+             return self.PrepareForRun(prog, block_id);
+           },
+           py::keep_alive<0, 2>())
+      .def("run_prepared_ctx",
+           [](Executor &self, framework::ExecutorPrepareContext *ctx,
+              Scope *scope, bool create_local_scope, bool create_vars) {
+             pybind11::gil_scoped_release release;
+             self.RunPreparedContext(ctx, scope, create_local_scope,
+                                     create_vars);
+           });
 
   m.def("init_gflags", framework::InitGflags);
   m.def("init_glog", framework::InitGLOG);
@@ -704,6 +828,7 @@ All parameter, weight, gradient are variables in Paddle.
 
   m.def("is_compiled_with_cuda", IsCompiledWithCUDA);
   m.def("is_compiled_with_brpc", IsCompiledWithBrpc);
+  m.def("is_compiled_with_verbs", IsCompiledWithVerbs);
   m.def("is_compiled_with_dist", IsCompiledWithDIST);
 #ifdef PADDLE_WITH_CUDA
   m.def("is_float16_supported", [](const platform::CUDAPlace &place) -> bool {
@@ -717,6 +842,9 @@ All parameter, weight, gradient are variables in Paddle.
   m.def("get_variable_tensor", framework::GetVariableTensor);
 
   m.def("_is_program_version_supported", IsProgramVersionSupported);
+  m.def("_wait_async_save",
+        [] { framework::AsyncTensorSaver::Instance().Wait(); },
+        py::call_guard<py::gil_scoped_release>());
 
   BindProgramDesc(&m);
   BindBlockDesc(&m);
@@ -760,6 +888,11 @@ All parameter, weight, gradient are variables in Paddle.
   m.def("get_cuda_device_count", platform::GetCUDADeviceCount);
 
 #ifndef _WIN32
+  m.def("gen_nccl_unique_id", []() -> py::bytes {
+    ncclUniqueId id;
+    PADDLE_ENFORCE(platform::dynload::ncclGetUniqueId(&id));
+    return py::bytes(reinterpret_cast<const char *>(&id), sizeof(id));
+  });
   m.def("nvprof_init", platform::CudaProfilerInit);
   m.def("nvprof_start", platform::CudaProfilerStart);
   m.def("nvprof_stop", platform::CudaProfilerStop);
@@ -787,6 +920,40 @@ All parameter, weight, gradient are variables in Paddle.
   m.def("is_profiler_enabled", platform::IsProfileEnabled);
   m.def("reset_profiler", platform::ResetProfiler);
 
+  py::class_<platform::SampledEventStats>(m, "SampledEventStats")
+      .def_readonly("name", &platform::SampledEventStats::name)
+      .def_readonly("count", &platform::SampledEventStats::count)
+      .def_readonly("total_ms", &platform::SampledEventStats::total_ms)
+      .def_readonly("max_ms", &platform::SampledEventStats::max_ms)
+      .def_readonly("p50_ms", &platform::SampledEventStats::p50_ms)
+      .def_readonly("p99_ms", &platform::SampledEventStats::p99_ms);
+  m.def("set_sampling_profiler_rate", platform::SetSamplingProfilerRate);
+  m.def("get_sampling_profiler_rate", platform::GetSamplingProfilerRate);
+  m.def("get_sampled_event_stats", platform::GetSampledEventStats);
+  m.def("reset_sampled_event_stats", platform::ResetSampledEventStats);
+
+  py::class_<framework::ReaderStats>(m, "ReaderStats")
+      .def_readonly("name", &framework::ReaderStats::name)
+      .def_readonly("num_produced", &framework::ReaderStats::num_produced)
+      .def_readonly("num_consumed", &framework::ReaderStats::num_consumed)
+      .def_readonly("bytes", &framework::ReaderStats::bytes)
+      .def_readonly("bytes_per_sec", &framework::ReaderStats::bytes_per_sec)
+      .def_readonly("producer_wait_ms",
+                    &framework::ReaderStats::producer_wait_ms)
+      .def_readonly("consumer_wait_ms",
+                    &framework::ReaderStats::consumer_wait_ms)
+      .def_readonly("parse_ms", &framework::ReaderStats::parse_ms)
+      .def_readonly("queue_size", &framework::ReaderStats::queue_size)
+      .def_readonly("queue_capacity", &framework::ReaderStats::queue_capacity);
+  py::class_<framework::ExecutorStepStats>(m, "ExecutorStepStats")
+      .def_readonly("num_steps", &framework::ExecutorStepStats::num_steps)
+      .def_readonly("step_ms", &framework::ExecutorStepStats::step_ms)
+      .def_readonly("data_wait_ms",
+                    &framework::ExecutorStepStats::data_wait_ms);
+  m.def("get_reader_stats", framework::GetReaderStats);
+  m.def("get_executor_step_stats", framework::GetExecutorStepStats);
+  m.def("reset_reader_stats", framework::ResetReaderStats);
+
   py::class_<ir::Pass, std::shared_ptr<ir::Pass>> pass(m, "Pass");
   pass.def(py::init())
       .def(
@@ -908,6 +1075,33 @@ All parameter, weight, gradient are variables in Paddle.
                                   : ExecutionStrategy::kDefault;
       });
 
+  exec_strategy.def_property(
+      "use_work_stealing",
+      [](const ExecutionStrategy &self) { return self.use_work_stealing_; },
+      [](ExecutionStrategy &self, bool use_work_stealing) {
+        self.use_work_stealing_ = use_work_stealing;
+      },
+      R"DOC(The type is BOOL, use_work_stealing indicates whether the
+                experimental executor runs ops in a work stealing thread pool,
+                where every thread has its own task queue and the ready
+                successors of an op are run by the same thread. It may reduce
+                the scheduling overhead when there are many threads and many
+                small ops. Only takes effect when use_experimental_executor
+                is True. Default False.)DOC");
+
+  exec_strategy.def_property(
+      "fetch_on_device",
+      [](const ExecutionStrategy &self) { return self.fetch_on_device_; },
+      [](ExecutionStrategy &self, bool fetch_on_device) {
+        self.fetch_on_device_ = fetch_on_device;
+      },
+      R"DOC(The type is BOOL, fetch_on_device indicates whether the fetched
+                results on GPUs are returned as the LoDTensors on the device
+                of the first place, where the results of all the devices are
+                merged, instead of being copied to CPU. It saves the copies to
+                CPU when the results are fed to the next run or only some of
+                them are read. Default False.)DOC");
+
   py::class_<BuildStrategy> build_strategy(pe, "BuildStrategy", R"DOC(
     BuildStrategy allows the user to more preciously control how to
     build the SSA Graph in ParallelExecutor by setting the property.
@@ -982,6 +1176,25 @@ All parameter, weight, gradient are variables in Paddle.
             self.enable_sequential_execution_ = b;
           },
           R"DOC(The type is BOOL. If set True, the execution order of ops would be the same as what is in the program. Default False.)DOC")
+      .def_property(
+          "enable_priority_scheduling",
+          [](const BuildStrategy &self) {
+            return self.enable_priority_scheduling_;
+          },
+          [](BuildStrategy &self, bool b) {
+            PADDLE_ENFORCE(!self.IsFinalized(), "BuildStrategy is finlaized.");
+            self.enable_priority_scheduling_ = b;
+          },
+          R"DOC(The type is BOOL. If set True, the ready ops would be scheduled by the longest path from them to the end of the graph, and the communication ops such as all_reduce are weighted up, so that the communication starts as early as possible. Default False.)DOC")
+      .def_property(
+          "num_streams",
+          [](const BuildStrategy &self) { return self.num_streams_; },
+          [](BuildStrategy &self, size_t num_streams) {
+            PADDLE_ENFORCE(!self.IsFinalized(), "BuildStrategy is finlaized.");
+            PADDLE_ENFORCE_GT(num_streams, 0UL);
+            self.num_streams_ = num_streams;
+          },
+          R"DOC(The type is INT. Only works on GPU. If greater than 1, the independent ops of each device would run concurrently on num_streams CUDA streams. It is ignored with the eager deletion. Default 1.)DOC")
       .def_property(
           "remove_unnecessary_lock",
           [](const BuildStrategy &self) {
@@ -992,6 +1205,14 @@ All parameter, weight, gradient are variables in Paddle.
             self.remove_unnecessary_lock_ = b;
           },
           R"DOC(The type is BOOL. If set True, some locks in GPU ops would be released and ParallelExecutor would run faster. Default False.)DOC")
+      .def_property(
+          "async_mode",
+          [](const BuildStrategy &self) { return self.async_mode_; },
+          [](BuildStrategy &self, bool b) {
+            PADDLE_ENFORCE(!self.IsFinalized(), "BuildStrategy is finlaized.");
+            self.async_mode_ = b;
+          },
+          R"DOC(The type is BOOL. If set True, every CPU place runs its own copy of the program on the batches it reads, and updates the parameters shared by all the places without synchronizing with the others (Hogwild!). The gradients are not all-reduced or reduced. It only works on CPU. Default False.)DOC")
       .def_property(
           "num_trainers",
           [](const BuildStrategy &self) { return self.num_trainers_; },
@@ -1010,6 +1231,16 @@ All parameter, weight, gradient are variables in Paddle.
                     [](BuildStrategy &self, int trainer_id) {
                       self.trainer_id_ = trainer_id;
                     })
+      .def_property(
+          "use_hierarchical_allreduce",
+          [](const BuildStrategy &self) {
+            return self.use_hierarchical_allreduce_;
+          },
+          [](BuildStrategy &self, bool b) {
+            PADDLE_ENFORCE(!self.IsFinalized(), "BuildStrategy is finlaized.");
+            self.use_hierarchical_allreduce_ = b;
+          },
+          R"DOC(The type is BOOL. If set True, in nccl2 distributed training with num_trainers > 1, each gradient is reduce-scattered inside the node, allreduced across the nodes by the devices of the same local rank and all-gathered inside the node again, so that only 1/num_devices of it goes through the inter-node links. The startup program must be transpiled with DistributeTranspilerConfig.use_hierarchical_allreduce set. Default False.)DOC")
       .def_property(
           "fuse_elewise_add_act_ops",
           [](const BuildStrategy &self) {
@@ -1022,6 +1253,42 @@ All parameter, weight, gradient are variables in Paddle.
           R"DOC(The type is BOOL, fuse_elewise_add_act_ops indicate whether
                      to fuse elementwise_add_op and activation_op,
                      it may make the execution faster. Default False)DOC")
+      .def_property(
+          "fuse_optimizer_ops",
+          [](const BuildStrategy &self) { return self.fuse_optimizer_ops_; },
+          [](BuildStrategy &self, bool b) {
+            PADDLE_ENFORCE(!self.IsFinalized(), "BuildStrategy is finlaized.");
+            self.fuse_optimizer_ops_ = b;
+          },
+          R"DOC(The type is BOOL, fuse_optimizer_ops indicate whether
+                     to fuse the adam and momentum ops with dense gradients,
+                     so that all the parameters are updated in a few kernel
+                     launches instead of one per parameter. Only works with
+                     the AllReduce strategy. Default False)DOC")
+      .def_property(
+          "fuse_all_reduce_ops",
+          [](const BuildStrategy &self) { return self.fuse_all_reduce_ops_; },
+          [](BuildStrategy &self, bool b) {
+            PADDLE_ENFORCE(!self.IsFinalized(), "BuildStrategy is finlaized.");
+            self.fuse_all_reduce_ops_ = b;
+          },
+          R"DOC(The type is BOOL, fuse_all_reduce_ops indicate whether
+                     to group the dense gradients into buckets and all-reduce
+                     each bucket with one contiguous buffer, which reduces the
+                     launch overhead when there are many small gradients.
+                     Only works with the AllReduce strategy. Default False)DOC")
+      .def_property(
+          "fuse_all_reduce_bucket_size_mb",
+          [](const BuildStrategy &self) {
+            return self.fuse_all_reduce_bucket_size_mb_;
+          },
+          [](BuildStrategy &self, size_t size_mb) {
+            PADDLE_ENFORCE(!self.IsFinalized(), "BuildStrategy is finlaized.");
+            PADDLE_ENFORCE_GT(size_mb, 0UL);
+            self.fuse_all_reduce_bucket_size_mb_ = size_mb;
+          },
+          R"DOC(The type is INT, the size in MB of the gradient buckets
+                     when fuse_all_reduce_ops is True. Default 32)DOC")
       .def_property(
           "memory_optimize",
           [](const BuildStrategy &self) { return self.memory_optimize_; },
@@ -1034,6 +1301,109 @@ All parameter, weight, gradient are variables in Paddle.
           "memory_early_delete",
           [](const BuildStrategy &self) { return self.memory_early_delete_; },
           [](BuildStrategy &self, bool b) { self.memory_early_delete_ = b; })
+      .def_property(
+          "recompute_checkpoints",
+          [](const BuildStrategy &self) { return self.recompute_checkpoints_; },
+          [](BuildStrategy &self, const std::vector<std::string> &vars) {
+            PADDLE_ENFORCE(!self.IsFinalized(), "BuildStrategy is finlaized.");
+            self.recompute_checkpoints_ = vars;
+          },
+          R"DOC(The type is list of STR, the names of the checkpoint
+                     variables. If not empty, the forward activations between
+                     the checkpoints are recomputed before the backward ops
+                     using them instead of being kept alive, which saves
+                     memory with the eager deletion or memory_optimize.
+                     Default empty)DOC")
+      .def_property(
+          "enable_mixed_precision",
+          [](const BuildStrategy &self) {
+            return self.enable_mixed_precision_;
+          },
+          [](BuildStrategy &self, bool b) {
+            PADDLE_ENFORCE(!self.IsFinalized(), "BuildStrategy is finlaized.");
+            self.enable_mixed_precision_ = b;
+          },
+          R"DOC(The type is BOOL, whether to run mul, matmul, the cudnn
+                     conv2d and their grad ops in float16 with the loss
+                     scaling. Only works on GPU with AllReduce. The loss
+                     scaling is the persistable variable @LOSS_SCALING@.
+                     Default False)DOC")
+      .def_property(
+          "init_loss_scaling",
+          [](const BuildStrategy &self) { return self.init_loss_scaling_; },
+          [](BuildStrategy &self, float scaling) {
+            PADDLE_ENFORCE(!self.IsFinalized(), "BuildStrategy is finlaized.");
+            PADDLE_ENFORCE_GT(scaling, 0.0f);
+            self.init_loss_scaling_ = scaling;
+          },
+          R"DOC(The type is FLOAT, the initial loss scaling of
+                     enable_mixed_precision. Default 32768)DOC")
+      .def_property(
+          "use_dynamic_loss_scaling",
+          [](const BuildStrategy &self) {
+            return self.use_dynamic_loss_scaling_;
+          },
+          [](BuildStrategy &self, bool b) {
+            PADDLE_ENFORCE(!self.IsFinalized(), "BuildStrategy is finlaized.");
+            self.use_dynamic_loss_scaling_ = b;
+          },
+          R"DOC(The type is BOOL, whether to double the loss scaling
+                     every 1000 finite steps and halve it every 2 overflowed
+                     steps with enable_mixed_precision. Default True)DOC")
+      .def_property(
+          "enable_inplace",
+          [](const BuildStrategy &self) { return self.enable_inplace_; },
+          [](BuildStrategy &self, bool b) {
+            PADDLE_ENFORCE(!self.IsFinalized(), "BuildStrategy is finlaized.");
+            self.enable_inplace_ = b;
+          },
+          R"DOC(The type is BOOL, enable_inplace indicate whether
+                     to let the ops such as activations, elementwise ops,
+                     scale and reshape write their outputs into the buffers
+                     of their inputs which are not used by other ops.
+                     The fetched variables except the loss should be set
+                     persistable. Default False)DOC")
+      .def_property(
+          "swap_activations",
+          [](const BuildStrategy &self) { return self.swap_activations_; },
+          [](BuildStrategy &self, bool b) {
+            PADDLE_ENFORCE(!self.IsFinalized(), "BuildStrategy is finlaized.");
+            self.swap_activations_ = b;
+          },
+          R"DOC(The type is BOOL, swap_activations indicate whether
+                     to swap the activations used by the backward ops out to
+                     the host memory after the forward ops, and back to the
+                     GPU before the backward ops. The fetched variables
+                     except the loss should be set persistable.
+                     Default False)DOC")
+      .def_property(
+          "sync_batch_norm",
+          [](const BuildStrategy &self) { return self.sync_batch_norm_; },
+          [](BuildStrategy &self, bool b) {
+            PADDLE_ENFORCE(!self.IsFinalized(), "BuildStrategy is finlaized.");
+            self.sync_batch_norm_ = b;
+          },
+          R"DOC(The type is BOOL, sync_batch_norm indicate whether
+                     the batch_norm ops of training normalize the inputs by
+                     the mean and variance of the mini-batches of all the
+                     GPUs, synchronized by NCCL, instead of each one. It
+                     helps the small batch size per GPU. Only works on GPU.
+                     Default False)DOC")
+      .def_property(
+          "fuse_fake_quantize_dequantize_ops",
+          [](const BuildStrategy &self) {
+            return self.fuse_fake_quantize_dequantize_ops_;
+          },
+          [](BuildStrategy &self, bool b) {
+            PADDLE_ENFORCE(!self.IsFinalized(), "BuildStrategy is finlaized.");
+            self.fuse_fake_quantize_dequantize_ops_ = b;
+          },
+          R"DOC(The type is BOOL, fuse_fake_quantize_dequantize_ops indicate
+                     whether to fuse the fake_quantize_abs_max and
+                     fake_dequantize_max_abs pairs inserted by the
+                     quantization-aware training into
+                     fake_quantize_dequantize_abs_max ops, which compute them
+                     in one pass. Default False)DOC")
       .def("_finalize_strategy_and_create_passes",
            [](BuildStrategy &self) -> std::shared_ptr<ir::PassBuilder> {
              return self.CreatePassesFromStrategy(true);
@@ -1064,7 +1434,34 @@ All parameter, weight, gradient are variables in Paddle.
                      const std::string &fetched_var_name) {
         pybind11::gil_scoped_release release;
         self.Run(fetch_tensors, fetched_var_name);
-      });
+      })
+      .def("abort_nccl",
+           [](ParallelExecutor &self) {
+             pybind11::gil_scoped_release release;
+             self.AbortNCCLContexts();
+           })
+      .def("reset_nccl",
+           [](ParallelExecutor &self, const py::bytes &nccl_id,
+              size_t num_trainers, size_t trainer_id) {
+             std::string id = nccl_id;
+             pybind11::gil_scoped_release release;
+             self.ResetNCCLContexts(id, num_trainers, trainer_id);
+           });
+
+  py::class_<PipelineExecutor>(m, "PipelineExecutor")
+      .def(py::init<const ProgramDesc &, const platform::Place &, Scope *,
+                    size_t>())
+      .def("feed_and_split_tensor_into_micro_batches",
+           &PipelineExecutor::FeedAndSplitTensorIntoMicroBatches)
+      .def("run",
+           [](PipelineExecutor &self,
+              const std::vector<std::string> &fetch_tensors,
+              const std::string &fetched_var_name) {
+             pybind11::gil_scoped_release release;
+             self.Run(fetch_tensors, fetched_var_name);
+           })
+      .def("sync_parameters", &PipelineExecutor::SyncParameters)
+      .def("num_stages", &PipelineExecutor::NumStages);
 
   BindRecordIOWriter(&m);
   BindAsyncExecutor(&m);
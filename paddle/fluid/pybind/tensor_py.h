@@ -14,9 +14,11 @@ limitations under the License. */
 
 #pragma once
 #include <Python.h>
+#include <memory>
 #include <string>
 #include <tuple>
 #include <vector>
+#include "paddle/fluid/framework/dlpack_tensor.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/memory/memcpy.h"
 #include "paddle/fluid/platform/device_context.h"
@@ -191,6 +193,149 @@ inline void PyCPUTensorSetFromArray(
   std::memcpy(dst, array.data(), sizeof(uint16_t) * array.size());
 }
 
+namespace details {
+
+// The memory of a numpy array, which holds a reference of the array.
+class PyArrayAllocation : public memory::Allocation {
+ public:
+  explicit PyArrayAllocation(const pybind11::array &array)
+      : Allocation(const_cast<void *>(array.data()),
+                   static_cast<size_t>(array.nbytes()), platform::CPUPlace()),
+        array_(array.ptr()) {
+    Py_INCREF(array_);
+  }
+
+  // The tensor may be released by the threads of the executors.
+  ~PyArrayAllocation() {
+    if (!Py_IsInitialized()) return;
+    pybind11::gil_scoped_acquire gil;
+    Py_DECREF(array_);
+  }
+
+ private:
+  PyObject *array_;
+};
+
+inline framework::proto::VarType::Type PyArrayType(
+    const pybind11::array &array) {
+#define PY_ARRAY_TYPE(cpp_type, proto_type)                       \
+  if (pybind11::isinstance<pybind11::array_t<cpp_type>>(array)) { \
+    return framework::proto::VarType::proto_type;                 \
+  }
+  PY_ARRAY_TYPE(float, FP32);
+  PY_ARRAY_TYPE(double, FP64);
+  PY_ARRAY_TYPE(int, INT32);
+  PY_ARRAY_TYPE(int64_t, INT64);
+  PY_ARRAY_TYPE(bool, BOOL);
+  // float16 is fed as uint16, as PyCPUTensorSetFromArray.
+  PY_ARRAY_TYPE(uint16_t, FP16);
+  PY_ARRAY_TYPE(uint8_t, UINT8);
+  PY_ARRAY_TYPE(int8_t, INT8);
+#undef PY_ARRAY_TYPE
+  PADDLE_THROW("Unsupported data type of the numpy array %s",
+               std::string(pybind11::str(array.dtype())));
+}
+
+inline pybind11::dtype PyArrayDType(framework::proto::VarType::Type type) {
+  switch (type) {
+    case framework::proto::VarType::FP32:
+      return pybind11::dtype::of<float>();
+    case framework::proto::VarType::FP64:
+      return pybind11::dtype::of<double>();
+    case framework::proto::VarType::INT32:
+      return pybind11::dtype::of<int>();
+    case framework::proto::VarType::INT64:
+      return pybind11::dtype::of<int64_t>();
+    case framework::proto::VarType::BOOL:
+      return pybind11::dtype::of<bool>();
+    case framework::proto::VarType::FP16:
+      return pybind11::dtype("e");  // np.dtype('e') == np.float16
+    case framework::proto::VarType::UINT8:
+      return pybind11::dtype::of<uint8_t>();
+    case framework::proto::VarType::INT8:
+      return pybind11::dtype::of<int8_t>();
+    default:
+      PADDLE_THROW("This type of tensor cannot be expose to Python");
+  }
+}
+
+constexpr char kDLPackCapsuleName[] = "dltensor";
+// The name of a capsule after its DLManagedTensor is taken, by the DLPack
+// convention.
+constexpr char kUsedDLPackCapsuleName[] = "used_dltensor";
+
+inline void DeleteDLPackCapsule(PyObject *capsule) {
+  if (!PyCapsule_IsValid(capsule, kDLPackCapsuleName)) return;
+  auto *managed = static_cast<::DLManagedTensor *>(
+      PyCapsule_GetPointer(capsule, kDLPackCapsuleName));
+  if (managed->deleter != nullptr) {
+    managed->deleter(managed);
+  }
+}
+
+}  // namespace details
+
+// Let the tensor share the memory of a C-contiguous numpy array on CPU,
+// without copying. The array is kept alive until the memory is released, and
+// modifying either of them changes the other.
+inline void TensorShareDataWithArray(framework::Tensor *self,
+                                     pybind11::array array) {
+  PADDLE_ENFORCE(array.flags() & pybind11::array::c_style,
+                 "Only the C-contiguous numpy arrays can be shared.");
+  auto type = details::PyArrayType(array);
+  std::vector<int64_t> dims(array.shape(), array.shape() + array.ndim());
+  self->Resize(framework::make_ddim(dims));
+  std::shared_ptr<memory::Allocation> holder(
+      new details::PyArrayAllocation(array));
+  self->ResetHolderWithType(holder, type);
+}
+
+// A numpy array which shares the memory of a CPU or CUDA pinned tensor, without
+// copying. The memory is kept alive until the array is released.
+inline pybind11::array TensorToArrayView(const framework::Tensor &self) {
+  PADDLE_ENFORCE(self.IsInitialized(), "The tensor is not initialized.");
+  PADDLE_ENFORCE(!platform::is_gpu_place(self.place()),
+                 "The GPU tensor can not be viewed as a numpy array, use "
+                 "_to_dlpack instead.");
+  auto dims = framework::vectorize(self.dims());
+  std::vector<size_t> shape(dims.begin(), dims.end());
+  std::vector<size_t> strides(shape.size());
+  size_t stride = framework::SizeOfType(self.type());
+  for (size_t i = shape.size(); i != 0; --i) {
+    strides[i - 1] = stride;
+    stride *= shape[i - 1];
+  }
+  auto *holder = new std::shared_ptr<memory::Allocation>(self.Holder());
+  pybind11::capsule base(holder, [](void *p) {
+    delete static_cast<std::shared_ptr<memory::Allocation> *>(p);
+  });
+  return pybind11::array(details::PyArrayDType(self.type()), shape, strides,
+                         self.data<void>(), base);
+}
+
+// Export the tensor as a DLPack capsule without copying, which can be taken
+// by the other frameworks. The memory is kept alive until the capsule is
+// released or its taker calls the deleter.
+inline pybind11::capsule TensorToDLPack(const framework::Tensor &self) {
+  PADDLE_ENFORCE(self.IsInitialized(), "The tensor is not initialized.");
+  auto *managed = framework::ToDLPack(self);
+  return pybind11::reinterpret_steal<pybind11::capsule>(
+      PyCapsule_New(managed, details::kDLPackCapsuleName,
+                    details::DeleteDLPackCapsule));
+}
+
+// Let the tensor share the memory of a DLPack capsule without copying, and
+// take the capsule, which can not be used again.
+inline void TensorFromDLPack(framework::Tensor *self,
+                             pybind11::capsule capsule) {
+  PADDLE_ENFORCE(PyCapsule_IsValid(capsule.ptr(), details::kDLPackCapsuleName),
+                 "The capsule is not a DLPack tensor or has been used.");
+  auto *managed = static_cast<::DLManagedTensor *>(
+      PyCapsule_GetPointer(capsule.ptr(), details::kDLPackCapsuleName));
+  PyCapsule_SetName(capsule.ptr(), details::kUsedDLPackCapsuleName);
+  framework::FromDLPack(managed, self);
+}
+
 #ifdef PADDLE_WITH_CUDA
 template <typename T>
 void PyCUDATensorSetFromArray(
@@ -0,0 +1,185 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/recordio/block_compressor.h"
+
+#include <lz4.h>
+#include <zstd.h>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace recordio {
+
+namespace {
+
+struct DDictDeleter {
+  void operator()(ZSTD_DDict* ddict) const { ZSTD_freeDDict(ddict); }
+};
+
+// The registered dictionaries. They are never freed, which is fine since
+// there are few of them.
+class ZstdDictionaries {
+ public:
+  static ZstdDictionaries& Instance() {
+    static ZstdDictionaries dicts;
+    return dicts;
+  }
+
+  void Register(const std::string& dict) {
+    unsigned id = ZSTD_getDictID_fromDict(dict.data(), dict.size());
+    PADDLE_ENFORCE_NE(id, 0U, "The zstd dictionary has no id");
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (ddicts_.count(id) == 0) {
+      ddicts_[id].reset(ZSTD_createDDict(dict.data(), dict.size()));
+      PADDLE_ENFORCE_NOT_NULL(ddicts_[id], "Failed to load zstd dictionary");
+    }
+  }
+
+  const ZSTD_DDict* Get(unsigned id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = ddicts_.find(id);
+    PADDLE_ENFORCE(it != ddicts_.end(),
+                   "The zstd dictionary %d is not registered, please call "
+                   "RegisterZstdDictionary first",
+                   id);
+    return it->second.get();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<unsigned, std::unique_ptr<ZSTD_DDict, DDictDeleter>>
+      ddicts_;
+};
+
+void EnforceZstd(size_t code) {
+  PADDLE_ENFORCE(!ZSTD_isError(code), "zstd error: %s",
+                 ZSTD_getErrorName(code));
+}
+
+}  // namespace
+
+BlockCompressor::BlockCompressor(int zstd_level, const std::string& zstd_dict)
+    : zstd_level_(zstd_level) {
+  if (!zstd_dict.empty()) {
+    zstd_cdict_ =
+        ZSTD_createCDict(zstd_dict.data(), zstd_dict.size(), zstd_level);
+    PADDLE_ENFORCE_NOT_NULL(zstd_cdict_, "Failed to load zstd dictionary");
+    // The writer can also read what it wrote.
+    RegisterZstdDictionary(zstd_dict);
+  }
+}
+
+BlockCompressor::~BlockCompressor() {
+  ZSTD_freeCCtx(zstd_cctx_);
+  ZSTD_freeDCtx(zstd_dctx_);
+  ZSTD_freeCDict(zstd_cdict_);
+}
+
+void BlockCompressor::Compress(Compressor ct, const std::string& src,
+                               std::string* dst) {
+  switch (ct) {
+    case Compressor::kZstd: {
+      if (zstd_cctx_ == nullptr) {
+        zstd_cctx_ = ZSTD_createCCtx();
+      }
+      dst->resize(ZSTD_compressBound(src.size()));
+      size_t size =
+          zstd_cdict_ != nullptr
+              ? ZSTD_compress_usingCDict(zstd_cctx_, &(*dst)[0], dst->size(),
+                                         src.data(), src.size(), zstd_cdict_)
+              : ZSTD_compressCCtx(zstd_cctx_, &(*dst)[0], dst->size(),
+                                  src.data(), src.size(), zstd_level_);
+      EnforceZstd(size);
+      dst->resize(size);
+      break;
+    }
+    case Compressor::kLZ4: {
+      // LZ4 blocks do not store the decompressed size, so it is put before
+      // the block.
+      PADDLE_ENFORCE_LE(src.size(),
+                        static_cast<size_t>(std::numeric_limits<int>::max()));
+      uint32_t src_size = static_cast<uint32_t>(src.size());
+      int bound = LZ4_compressBound(static_cast<int>(src_size));
+      dst->resize(sizeof(uint32_t) + bound);
+      std::memcpy(&(*dst)[0], &src_size, sizeof(uint32_t));
+      int size = LZ4_compress_default(src.data(), &(*dst)[sizeof(uint32_t)],
+                                      static_cast<int>(src_size), bound);
+      PADDLE_ENFORCE_GT(size, 0, "LZ4 compression failed");
+      dst->resize(sizeof(uint32_t) + size);
+      break;
+    }
+    default:
+      PADDLE_THROW("Not a block compressor");
+  }
+}
+
+void BlockCompressor::Decompress(Compressor ct, const char* src, size_t size,
+                                 std::string* dst) {
+  switch (ct) {
+    case Compressor::kZstd: {
+      if (zstd_dctx_ == nullptr) {
+        zstd_dctx_ = ZSTD_createDCtx();
+      }
+      auto dst_size = ZSTD_getFrameContentSize(src, size);
+      PADDLE_ENFORCE(dst_size != ZSTD_CONTENTSIZE_UNKNOWN &&
+                         dst_size != ZSTD_CONTENTSIZE_ERROR,
+                     "Invalid zstd chunk");
+      dst->resize(dst_size);
+      unsigned dict_id = ZSTD_getDictID_fromFrame(src, size);
+      size_t decompressed =
+          dict_id != 0
+              ? ZSTD_decompress_usingDDict(
+                    zstd_dctx_, &(*dst)[0], dst->size(), src, size,
+                    ZstdDictionaries::Instance().Get(dict_id))
+              : ZSTD_decompressDCtx(zstd_dctx_, &(*dst)[0], dst->size(), src,
+                                    size);
+      EnforceZstd(decompressed);
+      PADDLE_ENFORCE_EQ(decompressed, dst->size(), "Invalid zstd chunk");
+      break;
+    }
+    case Compressor::kLZ4: {
+      uint32_t dst_size;
+      PADDLE_ENFORCE_GE(size, sizeof(uint32_t), "Invalid LZ4 chunk");
+      std::memcpy(&dst_size, src, sizeof(uint32_t));
+      dst->resize(dst_size);
+      int decompressed =
+          LZ4_decompress_safe(src + sizeof(uint32_t), &(*dst)[0],
+                              static_cast<int>(size - sizeof(uint32_t)),
+                              static_cast<int>(dst_size));
+      PADDLE_ENFORCE_EQ(decompressed, static_cast<int>(dst_size),
+                        "Invalid LZ4 chunk");
+      break;
+    }
+    default:
+      PADDLE_THROW("Not a block compressor");
+  }
+}
+
+BlockCompressor& BlockCompressor::ThreadLocal() {
+  static thread_local BlockCompressor compressor;
+  return compressor;
+}
+
+void RegisterZstdDictionary(const std::string& dict) {
+  ZstdDictionaries::Instance().Register(dict);
+}
+
+}  // namespace recordio
+}  // namespace paddle
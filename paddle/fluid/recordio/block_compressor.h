@@ -0,0 +1,73 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+
+#include "paddle/fluid/platform/macros.h"
+#include "paddle/fluid/recordio/header.h"
+
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+struct ZSTD_CDict_s;
+
+namespace paddle {
+namespace recordio {
+
+// Whether the chunks of the compressor are compressed as a whole by
+// BlockCompressor instead of a compressing stream.
+inline bool IsBlockCompressor(Compressor ct) {
+  return ct == Compressor::kZstd || ct == Compressor::kLZ4;
+}
+
+// BlockCompressor compresses and decompresses a chunk as a whole, which is
+// faster than streams for Zstd and LZ4. It keeps the contexts of the
+// compressors, so it is not thread-safe.
+class BlockCompressor {
+ public:
+  // zstd_level and zstd_dict are only used by Zstd. An empty zstd_dict means
+  // no dictionary.
+  explicit BlockCompressor(int zstd_level = kDefaultZstdLevel,
+                           const std::string& zstd_dict = "");
+  ~BlockCompressor();
+
+  void Compress(Compressor ct, const std::string& src, std::string* dst);
+
+  // The size of dst is set to the decompressed size. Its memory is reused if
+  // it is large enough.
+  void Decompress(Compressor ct, const char* src, size_t size,
+                  std::string* dst);
+
+  // The compressor of the calling thread with the default options.
+  static BlockCompressor& ThreadLocal();
+
+  static constexpr int kDefaultZstdLevel = 3;
+
+ private:
+  int zstd_level_;
+  ZSTD_CCtx_s* zstd_cctx_{nullptr};
+  ZSTD_DCtx_s* zstd_dctx_{nullptr};
+  ZSTD_CDict_s* zstd_cdict_{nullptr};
+
+  DISABLE_COPY_AND_ASSIGN(BlockCompressor);
+};
+
+// Make the Zstd dictionary known to all the readers of the process. The
+// chunks compressed with the dictionary can only be decompressed after it
+// is registered. The dictionary is found by the id in the chunk.
+void RegisterZstdDictionary(const std::string& dict);
+
+}  // namespace recordio
+}  // namespace paddle
@@ -16,10 +16,12 @@
 
 #include <zlib.h>
 #include <algorithm>
+#include <cstring>
 #include <memory>
 #include <sstream>
 
 #include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/recordio/piece_stream.h"
 #include "snappystream.hpp"
 
 namespace paddle {
@@ -76,34 +78,51 @@ static uint32_t Crc32Stream(std::istream& in, size_t limit = 0) {
   return crc;
 }
 
-bool Chunk::Write(std::ostream& os, Compressor ct) const {
+bool Chunk::Write(std::ostream& os, Compressor ct, Header* header,
+                  BlockCompressor* block_compressor) const {
   // NOTE(dzhwinter): don't check records.numBytes instead, because
   // empty records are allowed.
   if (records_.empty()) {
     return false;
   }
   std::stringstream sout;
-  std::unique_ptr<std::ostream> compressed_stream;
-  switch (ct) {
-    case Compressor::kNoCompress:
-      break;
-    case Compressor::kSnappy:
-      compressed_stream.reset(new snappy::oSnappyStream(sout));
-      break;
-    default:
-      PADDLE_THROW("Not implemented");
-  }
+  if (IsBlockCompressor(ct)) {
+    std::string raw;
+    raw.reserve(num_bytes_ + records_.size() * sizeof(uint32_t));
+    for (auto& record : records_) {
+      uint32_t sz = static_cast<uint32_t>(record.size());
+      raw.append(reinterpret_cast<const char*>(&sz), sizeof(uint32_t))
+          .append(record);
+    }
+    std::string compressed;
+    auto& compressor = block_compressor != nullptr
+                           ? *block_compressor
+                           : BlockCompressor::ThreadLocal();
+    compressor.Compress(ct, raw, &compressed);
+    sout.write(compressed.data(), compressed.size());
+  } else {
+    std::unique_ptr<std::ostream> compressed_stream;
+    switch (ct) {
+      case Compressor::kNoCompress:
+        break;
+      case Compressor::kSnappy:
+        compressed_stream.reset(new snappy::oSnappyStream(sout));
+        break;
+      default:
+        PADDLE_THROW("Not implemented");
+    }
 
-  std::ostream& buf_stream = compressed_stream ? *compressed_stream : sout;
+    std::ostream& buf_stream = compressed_stream ? *compressed_stream : sout;
 
-  for (auto& record : records_) {
-    size_t sz = record.size();
-    buf_stream.write(reinterpret_cast<const char*>(&sz), sizeof(uint32_t))
-        .write(record.data(), record.size());
-  }
+    for (auto& record : records_) {
+      size_t sz = record.size();
+      buf_stream.write(reinterpret_cast<const char*>(&sz), sizeof(uint32_t))
+          .write(record.data(), record.size());
+    }
 
-  if (compressed_stream) {
-    compressed_stream.reset();
+    if (compressed_stream) {
+      compressed_stream.reset();
+    }
   }
 
   sout.seekg(0, std::ios::end);
@@ -112,6 +131,9 @@ bool Chunk::Write(std::ostream& os, Compressor ct) const {
   uint32_t crc = Crc32Stream(sout);
   Header hdr(static_cast<uint32_t>(records_.size()), crc, ct, len);
   hdr.Write(os);
+  if (header != nullptr) {
+    *header = hdr;
+  }
   sout.seekg(0, std::ios::beg);
   sout.clear();
   PipeStream(sout, os);
@@ -137,16 +159,47 @@ bool ChunkParser::Init() {
   if (!ok) {
     return ok;
   }
-  auto beg_pos = in_.tellg();
-  uint32_t crc = Crc32Stream(in_, header_.CompressSize());
+  offset_ = 0;
+  if (header_.NumRecords() == 0) {
+    // Keep the buffers for the records of the previous chunks.
+    in_.seekg(header_.CompressSize(), std::ios::cur);
+    return true;
+  }
+  cur_ = 1 - cur_;
+  std::string* buffer = Buffer();
+  // The uncompressed chunk is read into the buffer directly.
+  std::string& compressed =
+      header_.CompressType() == Compressor::kNoCompress ? *buffer
+                                                        : compressed_;
+  compressed.resize(header_.CompressSize());
+  in_.read(&compressed[0], compressed.size());
+  PADDLE_ENFORCE_EQ(static_cast<size_t>(in_.gcount()), compressed.size(),
+                    "The chunk is truncated");
+  uint32_t crc = static_cast<uint32_t>(
+      crc32(crc32(0, nullptr, 0),
+            reinterpret_cast<const Bytef*>(compressed.data()),
+            static_cast<uInt>(compressed.size())));
   PADDLE_ENFORCE_EQ(header_.Checksum(), crc);
-  in_.seekg(beg_pos, in_.beg);
 
   switch (header_.CompressType()) {
     case Compressor::kNoCompress:
       break;
-    case Compressor::kSnappy:
-      compressed_stream_.reset(new snappy::iSnappyStream(in_));
+    case Compressor::kSnappy: {
+      PieceStream sin(compressed);
+      snappy::iSnappyStream snappy_stream(sin);
+      buffer->clear();
+      char buf[kMaxBufSize];
+      while (snappy_stream.read(buf, kMaxBufSize) ||
+             snappy_stream.gcount() > 0) {
+        buffer->append(buf, snappy_stream.gcount());
+      }
+      break;
+    }
+    case Compressor::kZstd:
+    case Compressor::kLZ4:
+      BlockCompressor::ThreadLocal().Decompress(
+          header_.CompressType(), compressed.data(), compressed.size(),
+          buffer);
       break;
     default:
       PADDLE_THROW("Not implemented");
@@ -156,19 +209,23 @@ bool ChunkParser::Init() {
 
 bool ChunkParser::HasNext() const { return pos_ < header_.NumRecords(); }
 
-std::string ChunkParser::Next() {
+std::string ChunkParser::Next() { return NextPiece().ToString(); }
+
+string::Piece ChunkParser::NextPiece() {
   if (!HasNext()) {
-    return "";
+    return string::Piece();
   }
   ++pos_;
-  std::istream& stream = compressed_stream_ ? *compressed_stream_ : in_;
+  const std::string& buffer = *Buffer();
   uint32_t rec_len;
-  stream.read(reinterpret_cast<char*>(&rec_len), sizeof(uint32_t));
-  std::string buf;
-  buf.resize(rec_len);
-  stream.read(&buf[0], rec_len);
-  PADDLE_ENFORCE_EQ(rec_len, stream.gcount());
-  return buf;
+  PADDLE_ENFORCE_LE(offset_ + sizeof(uint32_t), buffer.size(),
+                    "The chunk is corrupted");
+  std::memcpy(&rec_len, buffer.data() + offset_, sizeof(uint32_t));
+  offset_ += sizeof(uint32_t);
+  PADDLE_ENFORCE_LE(offset_ + rec_len, buffer.size(), "The chunk is corrupted");
+  string::Piece record(buffer.data() + offset_, rec_len);
+  offset_ += rec_len;
+  return record;
 }
 }  // namespace recordio
 }  // namespace paddle
@@ -18,7 +18,9 @@
 #include <vector>
 
 #include "paddle/fluid/platform/macros.h"
+#include "paddle/fluid/recordio/block_compressor.h"
 #include "paddle/fluid/recordio/header.h"
+#include "paddle/fluid/string/piece.h"
 
 namespace paddle {
 namespace recordio {
@@ -32,8 +34,11 @@ class Chunk {
     records_.emplace_back(buf);
   }
   // dump the chunk into w, and clears the chunk and makes it ready for
-  // the next add invocation.
-  bool Write(std::ostream& fo, Compressor ct) const;
+  // the next add invocation. The written header is returned by header if it
+  // is not null. The block compressors use block_compressor if it is not
+  // null, otherwise the one of the thread.
+  bool Write(std::ostream& fo, Compressor ct, Header* header = nullptr,
+             BlockCompressor* block_compressor = nullptr) const;
   void Clear() {
     records_.clear();
     num_bytes_ = 0;
@@ -54,19 +59,38 @@ class Chunk {
   DISABLE_COPY_AND_ASSIGN(Chunk);
 };
 
+// ChunkParser decompresses a chunk as a whole into its buffer, and returns
+// the records as pieces of the buffer. It has two buffers used in turn by the
+// chunks, so that the records of a chunk are still valid while the next
+// chunk is read.
 class ChunkParser {
  public:
   explicit ChunkParser(std::istream& sin);
 
   bool Init();
   std::string Next();
+  // The record is valid until Init is called twice.
+  string::Piece NextPiece();
   bool HasNext() const;
 
+  // Decompress into buffer instead of the buffers of the parser, e.g. to
+  // keep the records of the chunk after the parser is destroyed.
+  void SetBuffer(std::string* buffer) { external_buffer_ = buffer; }
+
  private:
+  std::string* Buffer() {
+    return external_buffer_ != nullptr ? external_buffer_ : &buffers_[cur_];
+  }
+
   Header header_;
   uint32_t pos_{0};
   std::istream& in_;
-  std::unique_ptr<std::istream> compressed_stream_;
+
+  std::string compressed_;
+  std::string buffers_[2];
+  int cur_{0};
+  std::string* external_buffer_{nullptr};
+  size_t offset_{0};
 };
 
 }  // namespace recordio
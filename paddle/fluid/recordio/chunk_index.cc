@@ -0,0 +1,145 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/recordio/chunk_index.h"
+
+#include <fstream>
+#include <numeric>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace recordio {
+
+// The size of a chunk header, see Header::Write.
+constexpr uint64_t kHeaderSize = 5 * sizeof(uint32_t);
+constexpr uint64_t kEntrySize =
+    sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint32_t);
+constexpr uint64_t kFooterSize =
+    sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint32_t);
+
+void ChunkIndex::Add(uint64_t offset, const Header& header) {
+  PADDLE_ENFORCE_EQ(offset, data_size_, "The chunks must be contiguous");
+  entries_.push_back({offset, header.NumRecords(), header.Checksum()});
+  data_size_ = offset + kHeaderSize + header.CompressSize();
+}
+
+void ChunkIndex::Clear() {
+  entries_.clear();
+  data_size_ = 0;
+}
+
+void ChunkIndex::Write(std::ostream& os) const {
+  for (auto& entry : entries_) {
+    os.write(reinterpret_cast<const char*>(&entry.offset), sizeof(uint64_t))
+        .write(reinterpret_cast<const char*>(&entry.num_records),
+               sizeof(uint32_t))
+        .write(reinterpret_cast<const char*>(&entry.checksum),
+               sizeof(uint32_t));
+  }
+  uint32_t num_chunks = static_cast<uint32_t>(entries_.size());
+  os.write(reinterpret_cast<const char*>(&data_size_), sizeof(uint64_t))
+      .write(reinterpret_cast<const char*>(&num_chunks), sizeof(uint32_t))
+      .write(reinterpret_cast<const char*>(&kIndexMagicNumber),
+             sizeof(uint32_t));
+}
+
+bool ChunkIndex::Parse(std::istream& is) {
+  Clear();
+  is.clear();
+  is.seekg(0, std::ios::end);
+  auto file_size = static_cast<uint64_t>(is.tellg());
+  if (!is || file_size < kFooterSize) {
+    is.clear();
+    return false;
+  }
+  uint64_t data_size;
+  uint32_t num_chunks;
+  uint32_t magic;
+  is.seekg(file_size - kFooterSize, std::ios::beg);
+  is.read(reinterpret_cast<char*>(&data_size), sizeof(uint64_t))
+      .read(reinterpret_cast<char*>(&num_chunks), sizeof(uint32_t))
+      .read(reinterpret_cast<char*>(&magic), sizeof(uint32_t));
+  // The last bytes of a file without index may equal to the magic number by
+  // chance, so the sizes are checked too.
+  if (!is || magic != kIndexMagicNumber ||
+      data_size + num_chunks * kEntrySize + kFooterSize != file_size) {
+    is.clear();
+    return false;
+  }
+
+  is.seekg(data_size, std::ios::beg);
+  entries_.resize(num_chunks);
+  for (auto& entry : entries_) {
+    is.read(reinterpret_cast<char*>(&entry.offset), sizeof(uint64_t))
+        .read(reinterpret_cast<char*>(&entry.num_records), sizeof(uint32_t))
+        .read(reinterpret_cast<char*>(&entry.checksum), sizeof(uint32_t));
+  }
+  PADDLE_ENFORCE(static_cast<bool>(is), "Failed to read the chunk index");
+  for (size_t i = 1; i < entries_.size(); ++i) {
+    PADDLE_ENFORCE_LT(entries_[i - 1].offset, entries_[i].offset,
+                      "The chunk index is corrupted");
+  }
+  data_size_ = data_size;
+  is.clear();
+  return true;
+}
+
+uint64_t ChunkIndex::NumRecords() const {
+  uint64_t num = 0;
+  for (auto& entry : entries_) {
+    num += entry.num_records;
+  }
+  return num;
+}
+
+std::vector<size_t> ChunkIndex::Shard(const std::vector<size_t>& chunks,
+                                      size_t shard_id,
+                                      size_t num_shards) const {
+  PADDLE_ENFORCE_GT(num_shards, 0UL);
+  PADDLE_ENFORCE_LT(shard_id, num_shards);
+  uint64_t total = 0;
+  for (auto i : chunks) {
+    PADDLE_ENFORCE_LT(i, entries_.size(), "Chunk %d out of range", i);
+    total += entries_[i].num_records;
+  }
+  // The chunk is in the shard where its first record falls, so that every
+  // chunk belongs to exactly one shard.
+  std::vector<size_t> shard;
+  uint64_t begin = 0;
+  for (auto i : chunks) {
+    size_t id =
+        total == 0 ? 0 : static_cast<size_t>(begin * num_shards / total);
+    if (id == shard_id) {
+      shard.push_back(i);
+    }
+    begin += entries_[i].num_records;
+  }
+  return shard;
+}
+
+std::vector<size_t> ChunkIndex::AllChunks() const {
+  std::vector<size_t> chunks(entries_.size());
+  std::iota(chunks.begin(), chunks.end(), 0);
+  return chunks;
+}
+
+bool LoadChunkIndex(const std::string& filename, ChunkIndex* index) {
+  std::ifstream fin(filename, std::ios::binary);
+  PADDLE_ENFORCE(static_cast<bool>(fin), "Cannot open file %s", filename);
+  return index->Parse(fin);
+}
+
+}  // namespace recordio
+}  // namespace paddle
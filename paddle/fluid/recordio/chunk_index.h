@@ -0,0 +1,73 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/recordio/header.h"
+
+namespace paddle {
+namespace recordio {
+
+// MagicNumber of the chunk index block
+constexpr uint32_t kIndexMagicNumber = 0x58444e49;  // "INDX"
+
+struct ChunkIndexEntry {
+  // The offset of the chunk header from the beginning of the file.
+  uint64_t offset;
+  uint32_t num_records;
+  uint32_t checksum;
+};
+
+// ChunkIndex is the optional block at the end of a RecordIO file, which
+// records where each chunk begins. The block is the entries followed by a
+// footer of the block offset, the number of chunks and kIndexMagicNumber, so
+// that it can be found from the end of the file.
+class ChunkIndex {
+ public:
+  void Add(uint64_t offset, const Header& header);
+  void Clear();
+
+  void Write(std::ostream& os) const;
+
+  // returns true if OK, false if the stream has no index
+  bool Parse(std::istream& is);
+
+  size_t NumChunks() const { return entries_.size(); }
+  const ChunkIndexEntry& Chunk(size_t i) const { return entries_[i]; }
+  uint64_t NumRecords() const;
+  // The size of the chunks, which is also the offset of the index block.
+  uint64_t DataSize() const { return data_size_; }
+
+  // Split the given chunks into num_shards contiguous parts with about the
+  // same number of records, and return the shard_id-th part.
+  std::vector<size_t> Shard(const std::vector<size_t>& chunks, size_t shard_id,
+                            size_t num_shards) const;
+  // All the chunks in the order of the file.
+  std::vector<size_t> AllChunks() const;
+
+ private:
+  std::vector<ChunkIndexEntry> entries_;
+  uint64_t data_size_{0};
+};
+
+// Read the index of a RecordIO file. returns false if it has no index.
+bool LoadChunkIndex(const std::string& filename, ChunkIndex* index);
+
+}  // namespace recordio
+}  // namespace paddle
@@ -33,6 +33,12 @@ enum class Compressor : uint32_t {
   // Gzip is a well-known compression algorithm.  It is
   // recommmended only you are looking for compression ratio.
   kGzip = 2,
+  // Zstd compresses much better than snappy and decompresses about as
+  // fast. It supports compression levels and trained dictionaries.
+  kZstd = 3,
+  // LZ4 is the fastest to decompress, with compression ratio close to
+  // snappy.
+  kLZ4 = 4,
 };
 
 // Header is the metadata of Chunk
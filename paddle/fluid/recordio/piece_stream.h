@@ -0,0 +1,65 @@
+//   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <istream>
+#include <streambuf>
+
+#include "paddle/fluid/string/piece.h"
+
+namespace paddle {
+namespace recordio {
+
+// PieceStream reads the memory of a Piece without copying it, e.g. to
+// deserialize a record returned by Scanner::NextPiece. The memory must be
+// valid while the stream is read.
+class PieceStream : public std::istream {
+ public:
+  // The stream buffer is only stored by the base class before it is built.
+  explicit PieceStream(string::Piece piece)
+      : std::istream(&buf_), buf_(piece) {}
+
+ private:
+  class PieceBuf : public std::streambuf {
+   public:
+    explicit PieceBuf(string::Piece piece) {
+      char* begin = const_cast<char*>(piece.data());
+      setg(begin, begin, begin + piece.len());
+    }
+
+   protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                     std::ios_base::openmode which) override {
+      char* pos = dir == std::ios_base::beg
+                      ? eback() + off
+                      : (dir == std::ios_base::cur ? gptr() + off
+                                                   : egptr() + off);
+      if (pos < eback() || pos > egptr()) {
+        return pos_type(off_type(-1));
+      }
+      setg(eback(), pos, egptr());
+      return pos_type(pos - eback());
+    }
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+      return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+  };
+
+  PieceBuf buf_;
+};
+
+}  // namespace recordio
+}  // namespace paddle
@@ -14,42 +14,341 @@
 
 #include "paddle/fluid/recordio/scanner.h"
 
+#include <algorithm>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <mutex>  // NOLINT
+#include <sstream>
 #include <string>
+#include <vector>
 
+#include "paddle/fluid/framework/threadpool.h"
 #include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/recordio/piece_stream.h"
 
 namespace paddle {
 namespace recordio {
 
+static void CheckIndexEntry(const Header& header,
+                            const ChunkIndexEntry& entry) {
+  PADDLE_ENFORCE(header.NumRecords() == entry.num_records &&
+                     header.Checksum() == entry.checksum,
+                 "The chunk at %d does not match the chunk index",
+                 entry.offset);
+}
+
+// Prefetcher reads the raw chunks on the calling thread, which is cheap, and
+// decompresses and parses them on its thread pool.
+class Scanner::Prefetcher {
+ public:
+  // If index is not null, the chunks are read in the order of chunks.
+  Prefetcher(std::istream* stream, const ChunkIndex* index,
+             const std::vector<size_t>* chunks, int num_threads,
+             size_t lookahead, bool ordered)
+      : stream_(stream),
+        index_(index),
+        chunks_(chunks),
+        pool_(num_threads),
+        lookahead_(lookahead > 0 ? lookahead
+                                 : 2 * static_cast<size_t>(num_threads)),
+        ordered_(ordered) {}
+
+  ~Prefetcher() { Drain(); }
+
+  // Continue from the first_chunk-th chunk, which must be 0 without index.
+  void Reset(size_t first_chunk) {
+    Drain();
+    stream_->clear();
+    if (index_ != nullptr) {
+      next_chunk_ = first_chunk;
+    } else {
+      PADDLE_ENFORCE_EQ(first_chunk, 0UL);
+      stream_->seekg(0, std::ios::beg);
+    }
+    eof_ = false;
+    current_.reset();
+    previous_.reset();
+    pos_ = 0;
+    Fill();
+  }
+
+  bool HasNext() {
+    while (!current_ || pos_ >= current_->records.size()) {
+      if (!TakeChunk()) return false;
+    }
+    return true;
+  }
+
+  string::Piece NextPiece() {
+    if (!HasNext()) {
+      return string::Piece();
+    }
+    return current_->records[pos_++];
+  }
+
+ private:
+  struct Result {
+    // The decompressed chunk, which the records point to.
+    std::string data;
+    std::vector<string::Piece> records;
+    std::unique_ptr<platform::EnforceNotMet> error;
+    bool done{false};
+  };
+
+  // Read the next raw chunk and parse it on the pool. Returns false at the
+  // end of the stream.
+  bool Submit() {
+    Header header;
+    if (eof_) {
+      return false;
+    }
+    if (index_ != nullptr) {
+      if (next_chunk_ >= chunks_->size()) {
+        eof_ = true;
+        return false;
+      }
+      auto& entry = index_->Chunk((*chunks_)[next_chunk_++]);
+      stream_->clear();
+      stream_->seekg(entry.offset, std::ios::beg);
+      PADDLE_ENFORCE(header.Parse(*stream_), "Cannot read the chunk at %d",
+                     entry.offset);
+      CheckIndexEntry(header, entry);
+    } else if (!header.Parse(*stream_)) {
+      eof_ = true;
+      return false;
+    }
+    // The parser reads the header again, so it is put before the payload.
+    std::ostringstream header_stream;
+    header.Write(header_stream);
+    auto raw = std::make_shared<std::string>(header_stream.str());
+    size_t header_size = raw->size();
+    raw->resize(header_size + header.CompressSize());
+    stream_->read(&(*raw)[header_size], header.CompressSize());
+    PADDLE_ENFORCE_EQ(static_cast<size_t>(stream_->gcount()),
+                      header.CompressSize(), "The chunk is truncated");
+
+    auto result = std::make_shared<Result>();
+    in_flight_.push_back(result);
+    pool_.RunAndGetException([this, raw, result] {
+      // The result is not read by others until it is done.
+      std::unique_ptr<platform::EnforceNotMet> error;
+      try {
+        PieceStream sin(*raw);
+        ChunkParser parser(sin);
+        parser.SetBuffer(&result->data);
+        parser.Init();
+        while (parser.HasNext()) {
+          result->records.push_back(parser.NextPiece());
+        }
+      } catch (const platform::EnforceNotMet& e) {
+        error.reset(new platform::EnforceNotMet(e));
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      result->error = std::move(error);
+      result->done = true;
+      cv_.notify_all();
+    });
+    return true;
+  }
+
+  void Fill() {
+    while (in_flight_.size() < lookahead_ && Submit()) {
+    }
+  }
+
+  // Take the records of the next parsed chunk. Returns false if all the
+  // chunks are taken.
+  bool TakeChunk() {
+    Fill();
+    if (in_flight_.empty()) {
+      return false;
+    }
+    std::shared_ptr<Result> result;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      auto it = in_flight_.end();
+      cv_.wait(lock, [&] {
+        if (ordered_) {
+          it = in_flight_.front()->done ? in_flight_.begin()
+                                        : in_flight_.end();
+        } else {
+          it = std::find_if(
+              in_flight_.begin(), in_flight_.end(),
+              [](const std::shared_ptr<Result>& r) { return r->done; });
+        }
+        return it != in_flight_.end();
+      });
+      result = *it;
+      in_flight_.erase(it);
+    }
+    if (result->error) {
+      throw *result->error;
+    }
+    // The records of the previous chunk are still valid until the records of
+    // this chunk are returned.
+    previous_ = std::move(current_);
+    current_ = std::move(result);
+    pos_ = 0;
+    // Read ahead while the records of this chunk are consumed.
+    Fill();
+    return true;
+  }
+
+  // Wait for all the chunks in flight, which refer to this prefetcher.
+  void Drain() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] {
+      return std::all_of(
+          in_flight_.begin(), in_flight_.end(),
+          [](const std::shared_ptr<Result>& r) { return r->done; });
+    });
+    in_flight_.clear();
+  }
+
+  std::istream* stream_;
+  const ChunkIndex* index_;
+  const std::vector<size_t>* chunks_;
+  size_t next_chunk_{0};
+  framework::ThreadPool pool_;
+  size_t lookahead_;
+  bool ordered_;
+  bool eof_{false};
+
+  // The chunks submitted to the pool in the order of the file.
+  std::deque<std::shared_ptr<Result>> in_flight_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+
+  // The chunk whose records are being returned.
+  std::shared_ptr<Result> current_;
+  std::shared_ptr<Result> previous_;
+  size_t pos_{0};
+};
+
 Scanner::Scanner(std::unique_ptr<std::istream> &&stream)
+    : Scanner(std::move(stream), 0, 0) {}
+
+Scanner::Scanner(const std::string &filename) : Scanner(filename, 0, 0) {}
+
+Scanner::Scanner(std::unique_ptr<std::istream> &&stream, int num_threads,
+                 size_t lookahead, bool ordered)
     : stream_(std::move(stream)), parser_(*stream_) {
-  Reset();
+  Init(num_threads, lookahead, ordered);
 }
 
-Scanner::Scanner(const std::string &filename)
-    : stream_(new std::ifstream(filename)), parser_(*stream_) {
+Scanner::Scanner(const std::string &filename, int num_threads,
+                 size_t lookahead, bool ordered)
+    : stream_(new std::ifstream(filename, std::ios::binary)),
+      parser_(*stream_) {
   PADDLE_ENFORCE(static_cast<bool>(*stream_), "Cannot open file %s", filename);
+  Init(num_threads, lookahead, ordered);
+}
+
+// The prefetcher must be destroyed before the stream.
+Scanner::~Scanner() { prefetcher_.reset(); }
+
+void Scanner::Init(int num_threads, size_t lookahead, bool ordered) {
+  has_index_ = index_.Parse(*stream_);
+  if (has_index_) {
+    chunks_ = index_.AllChunks();
+  }
+  if (num_threads > 0) {
+    prefetcher_.reset(new Prefetcher(stream_.get(),
+                                     has_index_ ? &index_ : nullptr, &chunks_,
+                                     num_threads, lookahead, ordered));
+  }
   Reset();
 }
 
 void Scanner::Reset() {
+  if (has_index_) {
+    SeekToChunk(0);
+    return;
+  }
+  if (prefetcher_) {
+    prefetcher_->Reset(0);
+    return;
+  }
   stream_->clear();
   stream_->seekg(0, std::ios::beg);
   parser_.Init();
 }
 
-std::string Scanner::Next() {
+std::string Scanner::Next() { return NextPiece().ToString(); }
+
+string::Piece Scanner::NextPiece() {
+  if (prefetcher_) {
+    return prefetcher_->NextPiece();
+  }
+  if (has_index_) {
+    if (!HasNext()) {
+      return string::Piece();
+    }
+    auto res = parser_.NextPiece();
+    if (!parser_.HasNext()) {
+      NextIndexedChunk();
+    }
+    return res;
+  }
   if (stream_->eof()) {
-    return "";
+    return string::Piece();
   }
 
-  auto res = parser_.Next();
+  auto res = parser_.NextPiece();
   if (!parser_.HasNext() && HasNext()) {
     parser_.Init();
   }
   return res;
 }
 
-bool Scanner::HasNext() const { return !stream_->eof(); }
+bool Scanner::HasNext() const {
+  if (prefetcher_) {
+    return prefetcher_->HasNext();
+  }
+  if (has_index_) {
+    return in_chunk_ && parser_.HasNext();
+  }
+  return !stream_->eof();
+}
+
+void Scanner::SelectChunks(const std::vector<size_t> &chunks) {
+  PADDLE_ENFORCE(has_index_, "Selecting chunks needs the chunk index");
+  for (auto i : chunks) {
+    PADDLE_ENFORCE_LT(i, index_.NumChunks(), "Chunk %d out of range", i);
+  }
+  chunks_ = chunks;
+  SeekToChunk(0);
+}
+
+void Scanner::SeekToChunk(size_t i) {
+  PADDLE_ENFORCE(has_index_, "Seeking needs the chunk index");
+  PADDLE_ENFORCE_LE(i, chunks_.size(), "Chunk %d out of range", i);
+  if (prefetcher_) {
+    prefetcher_->Reset(i);
+    return;
+  }
+  next_chunk_ = i;
+  NextIndexedChunk();
+}
+
+bool Scanner::NextIndexedChunk() {
+  while (next_chunk_ < chunks_.size()) {
+    auto &entry = index_.Chunk(chunks_[next_chunk_++]);
+    stream_->clear();
+    stream_->seekg(entry.offset, std::ios::beg);
+    Header header;
+    PADDLE_ENFORCE(header.Parse(*stream_), "Cannot read the chunk at %d",
+                   entry.offset);
+    CheckIndexEntry(header, entry);
+    stream_->seekg(entry.offset, std::ios::beg);
+    parser_.Init();
+    if (parser_.HasNext()) {
+      in_chunk_ = true;
+      return true;
+    }
+  }
+  in_chunk_ = false;
+  return false;
+}
 }  // namespace recordio
 }  // namespace paddle
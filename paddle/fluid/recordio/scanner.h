@@ -17,8 +17,10 @@
 #include <fstream>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "paddle/fluid/recordio/chunk.h"
+#include "paddle/fluid/recordio/chunk_index.h"
 
 namespace paddle {
 namespace recordio {
@@ -29,15 +31,60 @@ class Scanner {
 
   explicit Scanner(const std::string& filename);
 
+  // The prefetching mode. At most lookahead chunks are read ahead of the
+  // records returned, and they are decompressed and parsed by a pool of
+  // num_threads threads. The records are returned in the order of the file
+  // if ordered is true, otherwise the chunks parsed first are returned first.
+  // If num_threads is 0, the chunks are parsed on the calling thread one by
+  // one as the other constructors. If lookahead is 0, it is 2 * num_threads.
+  Scanner(std::unique_ptr<std::istream>&& stream, int num_threads,
+          size_t lookahead, bool ordered = true);
+
+  Scanner(const std::string& filename, int num_threads, size_t lookahead,
+          bool ordered = true);
+
+  ~Scanner();
+
   void Reset();
 
   std::string Next();
 
+  // The record without copy. It is valid until the next call of Next,
+  // NextPiece or Reset.
+  string::Piece NextPiece();
+
   bool HasNext() const;
 
+  // The methods below need the chunk index written by Writer.
+  bool HasIndex() const { return has_index_; }
+  const ChunkIndex& Index() const { return index_; }
+
+  // Read only the given chunks in the given order, e.g. a shard of the file
+  // or a shuffled order, and reset to the first of them.
+  void SelectChunks(const std::vector<size_t>& chunks);
+
+  // Continue from the i-th selected chunk, which is the i-th chunk of the
+  // file if SelectChunks is not called.
+  void SeekToChunk(size_t i);
+
  private:
+  class Prefetcher;
+
+  void Init(int num_threads, size_t lookahead, bool ordered);
+
+  // Move the parser to the next selected chunk. returns false if no more.
+  bool NextIndexedChunk();
+
   std::unique_ptr<std::istream> stream_;
   ChunkParser parser_;
+  std::unique_ptr<Prefetcher> prefetcher_;
+
+  ChunkIndex index_;
+  bool has_index_{false};
+  // The chunks to read, only used if the file has an index.
+  std::vector<size_t> chunks_;
+  size_t next_chunk_{0};
+  bool in_chunk_{false};
 };
 }  // namespace recordio
 }  // namespace paddle
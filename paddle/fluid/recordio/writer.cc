@@ -21,6 +21,7 @@ namespace paddle {
 namespace recordio {
 
 void Writer::Write(const std::string& record) {
+  PADDLE_ENFORCE(!closed_, "Cannot write to a closed writer");
   cur_chunk_.Add(record);
   if (cur_chunk_.NumRecords() >= max_num_records_in_chunk_) {
     Flush();
@@ -28,10 +29,32 @@ void Writer::Write(const std::string& record) {
 }
 
 void Writer::Flush() {
-  cur_chunk_.Write(stream_, compressor_);
+  Header header;
+  if (cur_chunk_.Write(stream_, compressor_, &header,
+                       block_compressor_.get()) &&
+      with_index_) {
+    index_.Add(index_.DataSize(), header);
+  }
   cur_chunk_.Clear();
 }
 
+void Writer::Close() {
+  if (closed_) {
+    return;
+  }
+  Flush();
+  if (with_index_) {
+    index_.Write(stream_);
+  }
+  closed_ = true;
+}
+
+void Writer::SetZstdOptions(int level, const std::string& dict) {
+  PADDLE_ENFORCE(compressor_ == Compressor::kZstd,
+                 "The writer does not use Zstd");
+  block_compressor_.reset(new BlockCompressor(level, dict));
+}
+
 Writer::~Writer() {
   PADDLE_ENFORCE(cur_chunk_.Empty(), "Writer must be flushed when destroy.");
 }
@@ -13,24 +13,39 @@
 // limitations under the License.
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include "paddle/fluid/recordio/chunk.h"
+#include "paddle/fluid/recordio/chunk_index.h"
+
 namespace paddle {
 namespace recordio {
 
 class Writer {
  public:
+  // If with_index is true, the chunk index is written by Close, which makes
+  // Scanner able to seek to, shard and shuffle the chunks. The writer must be
+  // created at the beginning of the stream in that case.
   Writer(std::ostream* sout, Compressor compressor,
-         size_t max_num_records_in_chunk = 1000)
+         size_t max_num_records_in_chunk = 1000, bool with_index = false)
       : stream_(*sout),
         max_num_records_in_chunk_(max_num_records_in_chunk),
-        compressor_(compressor) {}
+        compressor_(compressor),
+        with_index_(with_index) {}
 
   void Write(const std::string& record);
 
   void Flush();
 
+  // Flush and write the chunk index. Nothing can be written after Close.
+  void Close();
+
+  // Set the level and the trained dictionary of Zstd, before any chunk is
+  // written. The readers must call RegisterZstdDictionary with the same
+  // dictionary.
+  void SetZstdOptions(int level, const std::string& dict = "");
+
   ~Writer();
 
  private:
@@ -38,6 +53,10 @@ class Writer {
   size_t max_num_records_in_chunk_;
   Chunk cur_chunk_;
   Compressor compressor_;
+  bool with_index_;
+  bool closed_{false};
+  ChunkIndex index_;
+  std::unique_ptr<BlockCompressor> block_compressor_;
 };
 
 }  // namespace recordio
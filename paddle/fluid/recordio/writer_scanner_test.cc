@@ -12,9 +12,15 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <zdict.h>
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <random>
 #include <sstream>
 #include <string>
+#include <vector>
 
+#include "glog/logging.h"
 #include "gtest/gtest.h"
 #include "paddle/fluid/recordio/scanner.h"
 #include "paddle/fluid/recordio/writer.h"
@@ -68,3 +74,253 @@ TEST(WriterScanner, TinyChunk) {
     ASSERT_FALSE(scanner.HasNext());
   }
 }
+
+TEST(WriterScanner, Prefetch) {
+  std::string data;
+  {
+    std::stringstream* stream = new std::stringstream();
+    paddle::recordio::Writer writer(
+        stream, paddle::recordio::Compressor::kSnappy, 3 /*max chunk num*/);
+    for (int i = 0; i < 100; ++i) {
+      writer.Write(std::to_string(i));
+    }
+    writer.Flush();
+    data = stream->str();
+  }
+
+  for (bool ordered : {true, false}) {
+    std::unique_ptr<std::istream> stream_ptr(new std::stringstream(data));
+    paddle::recordio::Scanner scanner(std::move(stream_ptr), 4, 3, ordered);
+    for (int pass = 0; pass < 2; ++pass) {
+      std::vector<std::string> records;
+      while (scanner.HasNext()) {
+        records.push_back(scanner.Next());
+      }
+      ASSERT_EQ(records.size(), 100UL);
+      if (!ordered) {
+        std::sort(records.begin(), records.end(),
+                  [](const std::string& a, const std::string& b) {
+                    return std::stoi(a) < std::stoi(b);
+                  });
+      }
+      for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(records[i], std::to_string(i));
+      }
+      scanner.Reset();
+    }
+  }
+}
+
+static std::string WriteIndexedFile(int num_records, size_t chunk_size) {
+  std::stringstream stream;
+  paddle::recordio::Writer writer(&stream,
+                                  paddle::recordio::Compressor::kSnappy,
+                                  chunk_size, true /*with index*/);
+  for (int i = 0; i < num_records; ++i) {
+    writer.Write(std::to_string(i));
+  }
+  writer.Close();
+  return stream.str();
+}
+
+TEST(WriterScanner, Index) {
+  std::string data = WriteIndexedFile(10, 3);
+  for (int num_threads : {0, 2}) {
+    std::unique_ptr<std::istream> stream_ptr(new std::stringstream(data));
+    paddle::recordio::Scanner scanner(std::move(stream_ptr), num_threads, 0);
+    ASSERT_TRUE(scanner.HasIndex());
+    auto& index = scanner.Index();
+    ASSERT_EQ(index.NumChunks(), 4UL);
+    ASSERT_EQ(index.NumRecords(), 10UL);
+    ASSERT_EQ(index.Chunk(0).offset, 0UL);
+    ASSERT_EQ(index.Chunk(3).num_records, 1U);
+
+    // The index is not read as a chunk.
+    for (int i = 0; i < 10; ++i) {
+      ASSERT_TRUE(scanner.HasNext());
+      ASSERT_EQ(scanner.Next(), std::to_string(i));
+    }
+    ASSERT_FALSE(scanner.HasNext());
+
+    scanner.SeekToChunk(2);
+    ASSERT_EQ(scanner.Next(), "6");
+
+    scanner.SelectChunks({3, 1});
+    std::vector<std::string> records;
+    while (scanner.HasNext()) {
+      records.push_back(scanner.Next());
+    }
+    ASSERT_EQ(records, std::vector<std::string>({"9", "3", "4", "5"}));
+  }
+
+  // An indexed file without chunks has no record.
+  std::unique_ptr<std::istream> stream_ptr(
+      new std::stringstream(WriteIndexedFile(0, 3)));
+  paddle::recordio::Scanner empty(std::move(stream_ptr));
+  ASSERT_TRUE(empty.HasIndex());
+  ASSERT_FALSE(empty.HasNext());
+}
+
+TEST(WriterScanner, ShardChunks) {
+  std::string data = WriteIndexedFile(100, 10);
+  std::istringstream stream(data);
+  paddle::recordio::ChunkIndex index;
+  ASSERT_TRUE(index.Parse(stream));
+  auto all = index.AllChunks();
+  std::vector<size_t> merged;
+  for (size_t i = 0; i < 3; ++i) {
+    auto shard = index.Shard(all, i, 3);
+    ASSERT_GE(shard.size(), 3UL);
+    ASSERT_LE(shard.size(), 4UL);
+    merged.insert(merged.end(), shard.begin(), shard.end());
+  }
+  ASSERT_EQ(merged, all);
+
+  std::stringstream no_index;
+  {
+    paddle::recordio::Writer writer(&no_index,
+                                    paddle::recordio::Compressor::kSnappy);
+    writer.Write("ABC");
+    writer.Close();
+  }
+  ASSERT_FALSE(index.Parse(no_index));
+}
+
+// The records like the sparse features, the ids of a small vocabulary.
+static std::vector<std::string> FeatureRecords(size_t num, size_t num_ids) {
+  std::mt19937 engine(0);
+  std::geometric_distribution<uint32_t> dist(0.01);
+  std::vector<std::string> records(num);
+  for (auto& record : records) {
+    std::vector<uint32_t> ids(num_ids);
+    for (auto& id : ids) {
+      id = dist(engine);
+    }
+    record.assign(reinterpret_cast<const char*>(ids.data()),
+                  ids.size() * sizeof(uint32_t));
+  }
+  return records;
+}
+
+TEST(WriterScanner, Compressors) {
+  auto records = FeatureRecords(100, 50);
+  for (auto ct : {paddle::recordio::Compressor::kNoCompress,
+                  paddle::recordio::Compressor::kSnappy,
+                  paddle::recordio::Compressor::kZstd,
+                  paddle::recordio::Compressor::kLZ4}) {
+    std::stringstream* stream = new std::stringstream();
+    {
+      paddle::recordio::Writer writer(stream, ct, 30);
+      for (auto& record : records) {
+        writer.Write(record);
+      }
+      writer.Write("");
+      writer.Flush();
+    }
+    std::unique_ptr<std::istream> stream_ptr(stream);
+    paddle::recordio::Scanner scanner(std::move(stream_ptr));
+    for (auto& record : records) {
+      ASSERT_TRUE(scanner.HasNext());
+      ASSERT_EQ(scanner.Next(), record);
+    }
+    ASSERT_EQ(scanner.Next(), "");
+    ASSERT_FALSE(scanner.HasNext());
+  }
+}
+
+TEST(WriterScanner, ZstdDictionary) {
+  auto samples = FeatureRecords(1000, 20);
+  std::string joined;
+  std::vector<size_t> sizes;
+  for (auto& sample : samples) {
+    joined += sample;
+    sizes.push_back(sample.size());
+  }
+  std::string dict(16 * 1024, '\0');
+  size_t dict_size =
+      ZDICT_trainFromBuffer(&dict[0], dict.size(), joined.data(),
+                            sizes.data(), static_cast<unsigned>(sizes.size()));
+  ASSERT_FALSE(ZDICT_isError(dict_size));
+  dict.resize(dict_size);
+
+  auto records = FeatureRecords(10, 20);
+  std::string with_dict;
+  std::string without_dict;
+  for (auto* data : {&with_dict, &without_dict}) {
+    std::stringstream stream;
+    paddle::recordio::Writer writer(&stream,
+                                    paddle::recordio::Compressor::kZstd, 1);
+    writer.SetZstdOptions(19, data == &with_dict ? dict : "");
+    for (auto& record : records) {
+      writer.Write(record);
+    }
+    writer.Flush();
+    *data = stream.str();
+  }
+  ASSERT_LT(with_dict.size(), without_dict.size());
+
+  // The writer registered the dictionary for the readers of the process.
+  std::unique_ptr<std::istream> stream_ptr(new std::stringstream(with_dict));
+  paddle::recordio::Scanner scanner(std::move(stream_ptr));
+  for (auto& record : records) {
+    ASSERT_EQ(scanner.Next(), record);
+  }
+  ASSERT_FALSE(scanner.HasNext());
+}
+
+TEST(WriterScanner, CompressorsBenchmark) {
+  auto records = FeatureRecords(4000, 256);
+  double raw_mb = records.size() * records[0].size() / 1024.0 / 1024.0;
+  for (auto ct : {paddle::recordio::Compressor::kNoCompress,
+                  paddle::recordio::Compressor::kSnappy,
+                  paddle::recordio::Compressor::kZstd,
+                  paddle::recordio::Compressor::kLZ4}) {
+    auto start = std::chrono::steady_clock::now();
+    std::stringstream* stream = new std::stringstream();
+    {
+      paddle::recordio::Writer writer(stream, ct);
+      for (auto& record : records) {
+        writer.Write(record);
+      }
+      writer.Flush();
+    }
+    auto written = std::chrono::steady_clock::now();
+    size_t file_size = stream->str().size();
+    std::unique_ptr<std::istream> stream_ptr(stream);
+    paddle::recordio::Scanner scanner(std::move(stream_ptr));
+    size_t num_records = 0;
+    while (scanner.HasNext()) {
+      num_records += scanner.NextPiece().len() > 0;
+    }
+    auto read = std::chrono::steady_clock::now();
+    ASSERT_EQ(num_records, records.size());
+
+    std::chrono::duration<double> write_s = written - start;
+    std::chrono::duration<double> read_s = read - written;
+    LOG(INFO) << "compressor " << static_cast<int>(ct) << ": ratio "
+              << raw_mb * 1024 * 1024 / file_size << ", write "
+              << raw_mb / write_s.count() << " MB/s, read "
+              << raw_mb / read_s.count() << " MB/s";
+  }
+}
+
+TEST(WriterScanner, NextPiece) {
+  std::string data = WriteIndexedFile(10, 3);
+  for (int num_threads : {0, 2}) {
+    std::unique_ptr<std::istream> stream_ptr(new std::stringstream(data));
+    paddle::recordio::Scanner scanner(std::move(stream_ptr), num_threads, 0);
+    // The record is still valid when the next chunk is read.
+    paddle::string::Piece last;
+    for (int i = 0; i < 10; ++i) {
+      ASSERT_TRUE(scanner.HasNext());
+      auto piece = scanner.NextPiece();
+      if (i > 0) {
+        ASSERT_EQ(last, std::to_string(i - 1));
+      }
+      ASSERT_EQ(piece, std::to_string(i));
+      last = piece;
+    }
+    ASSERT_FALSE(scanner.HasNext());
+    ASSERT_EQ(last, "9");
+  }
+}
@@ -113,6 +113,31 @@ paddle_error paddle_gradient_machine_forward(paddle_gradient_machine machine,
   return kPD_NO_ERROR;
 }
 
+paddle_error paddle_gradient_machine_forward_batches(
+    paddle_gradient_machine machine,
+    paddle_arguments* inArgs,
+    paddle_arguments* outArgs,
+    uint64_t numBatches,
+    bool isTrain) {
+  auto m = cast(machine);
+  if (m == nullptr || m->machine == nullptr ||
+      (numBatches > 0 && (inArgs == nullptr || outArgs == nullptr)))
+    return kPD_NULLPTR;
+  std::vector<paddle::Argument> outputs;
+  for (uint64_t i = 0; i < numBatches; ++i) {
+    auto in = paddle::capi::cast<paddle::capi::CArguments>(inArgs[i]);
+    auto out = paddle::capi::cast<paddle::capi::CArguments>(outArgs[i]);
+    if (in == nullptr || out == nullptr) return kPD_NULLPTR;
+    m->machine->forward(
+        in->args, &outputs, isTrain ? paddle::PASS_TRAIN : paddle::PASS_TEST);
+    out->args.resize(outputs.size());
+    for (size_t j = 0; j < outputs.size(); ++j) {
+      out->args[j].resizeAndCopyFrom(outputs[j]);
+    }
+  }
+  return kPD_NO_ERROR;
+}
+
 paddle_error paddle_gradient_machine_create_shared_param(
     paddle_gradient_machine origin,
     void* modelConfigProtobuf,
@@ -75,6 +75,26 @@ paddle_gradient_machine_forward(paddle_gradient_machine machine,
                                 paddle_arguments outArgs,
                                 bool isTrain);
 
+/**
+ * @brief Forward a gradient machine by several batches in one call.
+ * @param machine Gradient machine
+ * @param inArgs the input arguments of the batches
+ * @param outArgs the output arguments of the batches. Unlike the outputs of
+ *        paddle_gradient_machine_forward, which share the buffers of the
+ *        machine, the outputs are copied into them, so they are kept by the
+ *        next batches. Their buffers are reused when they are large enough,
+ *        so passing the same outArgs to every call does not allocate.
+ * @param numBatches the number of the batches
+ * @param isTrain is train or not
+ * @return paddle_error
+ */
+PD_API paddle_error
+paddle_gradient_machine_forward_batches(paddle_gradient_machine machine,
+                                        paddle_arguments* inArgs,
+                                        paddle_arguments* outArgs,
+                                        uint64_t numBatches,
+                                        bool isTrain);
+
 /**
  * @brief Create a gradient machine, which parameters are shared from another
  *        gradient machine.
@@ -105,6 +105,80 @@ TEST(GradientMachine, testPredict) {
   ASSERT_EQ(kPD_NO_ERROR, paddle_gradient_machine_destroy(machine));
 }
 
+TEST(GradientMachine, testForwardBatches) {
+  paddle::TrainerConfigHelper config("./test_predict_network.py");
+  std::string buffer;
+  ASSERT_TRUE(config.getModelConfig().SerializeToString(&buffer));
+  paddle_gradient_machine machine;
+  ASSERT_EQ(kPD_NO_ERROR,
+            paddle_gradient_machine_create_for_inference(
+                &machine, &buffer[0], (int)buffer.size()));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_gradient_machine_randomize_param(machine));
+
+  constexpr int kNumBatches = 3;
+  paddle_arguments inArgs[kNumBatches];
+  paddle_arguments outArgs[kNumBatches];
+  paddle_matrix mats[kNumBatches];
+  for (int i = 0; i < kNumBatches; ++i) {
+    inArgs[i] = paddle_arguments_create_none();
+    outArgs[i] = paddle_arguments_create_none();
+    ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_resize(inArgs[i], 1));
+    mats[i] = paddle_matrix_create(i + 1, 100, false);
+    auto data = randomBuffer((i + 1) * 100);
+    for (int row = 0; row <= i; ++row) {
+      paddle_real* rowPtr;
+      ASSERT_EQ(kPD_NO_ERROR, paddle_matrix_get_row(mats[i], row, &rowPtr));
+      memcpy(rowPtr, data.data() + row * 100, 100 * sizeof(paddle_real));
+    }
+    ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_set_value(inArgs[i], 0, mats[i]));
+  }
+
+  // The outputs of every batch are kept, and are the ones of forward.
+  for (int pass = 0; pass < 2; ++pass) {
+    ASSERT_EQ(kPD_NO_ERROR,
+              paddle_gradient_machine_forward_batches(
+                  machine, inArgs, outArgs, kNumBatches, false));
+  }
+  paddle_arguments expected = paddle_arguments_create_none();
+  paddle_matrix outMat = paddle_matrix_create_none();
+  paddle_matrix expectedMat = paddle_matrix_create_none();
+  for (int i = 0; i < kNumBatches; ++i) {
+    ASSERT_EQ(kPD_NO_ERROR,
+              paddle_gradient_machine_forward(
+                  machine, inArgs[i], expected, false));
+    ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_get_value(outArgs[i], 0, outMat));
+    ASSERT_EQ(kPD_NO_ERROR,
+              paddle_arguments_get_value(expected, 0, expectedMat));
+    uint64_t height, width, expectedHeight, expectedWidth;
+    ASSERT_EQ(kPD_NO_ERROR, paddle_matrix_get_shape(outMat, &height, &width));
+    ASSERT_EQ(kPD_NO_ERROR,
+              paddle_matrix_get_shape(
+                  expectedMat, &expectedHeight, &expectedWidth));
+    ASSERT_EQ(expectedHeight, height);
+    ASSERT_EQ(expectedWidth, width);
+    ASSERT_EQ((uint64_t)i + 1, height);
+    for (uint64_t row = 0; row < height; ++row) {
+      paddle_real *rowPtr, *expectedPtr;
+      ASSERT_EQ(kPD_NO_ERROR, paddle_matrix_get_row(outMat, row, &rowPtr));
+      ASSERT_EQ(kPD_NO_ERROR,
+                paddle_matrix_get_row(expectedMat, row, &expectedPtr));
+      for (uint64_t col = 0; col < width; ++col) {
+        ASSERT_NEAR(expectedPtr[col], rowPtr[col], 1e-5);
+      }
+    }
+  }
+
+  ASSERT_EQ(kPD_NO_ERROR, paddle_matrix_destroy(outMat));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_matrix_destroy(expectedMat));
+  ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_destroy(expected));
+  for (int i = 0; i < kNumBatches; ++i) {
+    ASSERT_EQ(kPD_NO_ERROR, paddle_matrix_destroy(mats[i]));
+    ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_destroy(inArgs[i]));
+    ASSERT_EQ(kPD_NO_ERROR, paddle_arguments_destroy(outArgs[i]));
+  }
+  ASSERT_EQ(kPD_NO_ERROR, paddle_gradient_machine_destroy(machine));
+}
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   std::vector<char*> argvs;
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include "MultiGradientMachine.h"
 
+#include "paddle/legacy/math/SIMDFunctions.h"
 #include "paddle/legacy/utils/Logging.h"
 
 #include "paddle/legacy/utils/Stat.h"
@@ -862,17 +863,19 @@ void TrainerThread::mergeGradDense(
   size_t startSeq = interval.first;
   size_t copySize = interval.second - interval.first;
 
-  // setup sub bufs
-  CpuVector destGrad(0, nullptr);
-  destGrad.subVecFrom(*para->getBuf(PARAMETER_GRADIENT), startSeq, copySize);
+  if (copySize == 0) return;
 
-  // merge
-  CpuVector slaveGradSub(0, nullptr);
+  // merge the slices of all the slaves in one pass, so that the slice of the
+  // main gradient is loaded and stored once instead of once a slave.
+  real* destGrad = para->getBuf(PARAMETER_GRADIENT)->getData() + startSeq;
+  std::vector<const real*> slaveGrads;
+  slaveGrads.reserve(slaveParameters.size());
   for (auto slaveParams : slaveParameters) {
-    slaveGradSub.subVecFrom(
-        *(*slaveParams)[pid]->getBuf(PARAMETER_GRADIENT), startSeq, copySize);
-    destGrad.add(slaveGradSub);
+    slaveGrads.push_back(
+        (*slaveParams)[pid]->getBuf(PARAMETER_GRADIENT)->getData() + startSeq);
   }
+  simd::batchAddTo(
+      destGrad, slaveGrads.data(), (int)slaveGrads.size(), copySize);
 }
 
 void TrainerThread::copyOutputGrad() {
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "Storage.h"
+#include <algorithm>
 #include "Allocator.h"
 #include "paddle/legacy/utils/StringUtil.h"
 #include "paddle/legacy/utils/Util.h"
@@ -25,6 +26,10 @@ DEFINE_int32(pool_limit_size,
 DEFINE_int32(pool_limit_size, 0, "default is 0");
 #endif
 
+DEFINE_int32(cpu_pool_num,
+             8,
+             "number of the cpu memory pools, which the threads use by turns");
+
 namespace paddle {
 
 // Initialization StorageEngine singleton.
@@ -33,10 +38,12 @@ namespace paddle {
 static InitFunction __init_storage_engine([]() { StorageEngine::singleton(); },
                                           std::numeric_limits<int>::max());
 
-StorageEngine::StorageEngine() : cpuAllocator_(nullptr) {}
+StorageEngine::StorageEngine() {}
 
 StorageEngine::~StorageEngine() {
-  delete cpuAllocator_;
+  for (auto it : cpuAllocator_) {
+    delete it;
+  }
   for (auto it : gpuAllocator_) {
     delete it;
   }
@@ -74,27 +81,40 @@ PoolAllocator* StorageEngine::getGpuAllocator(int deviceId) {
 }
 
 PoolAllocator* StorageEngine::getCpuAllocator() {
-  {
+  // The pool of the thread, which is kept when the thread exits, since the
+  // memory of the pool may be freed by the other threads later.
+  static __thread int poolId = -1;
+  if (poolId >= 0) {
     // if cpuAllocator_ has been constructed
     ReadLockGuard guard(lock_);
-    if (cpuAllocator_ != nullptr) {
-      return cpuAllocator_;
+    if (cpuAllocator_[poolId] != nullptr) {
+      return cpuAllocator_[poolId];
     }
   }
 
   {
-    // Construct cpuAllocator_
+    // Construct cpuAllocator_, after the flags are parsed
     std::lock_guard<RWLock> guard(lock_);
-    if (cpuAllocator_ == nullptr) {
+    if (cpuAllocator_.empty()) {
+      cpuAllocator_.resize(std::max(FLAGS_cpu_pool_num, 1), nullptr);
+    }
+    static size_t numThreads = 0;
+    if (poolId < 0) {
+      poolId = numThreads++ % cpuAllocator_.size();
+    }
+    if (cpuAllocator_[poolId] == nullptr) {
+      std::string id = str::to_string(poolId);
       if (FLAGS_use_gpu) {
-        cpuAllocator_ = new PoolAllocator(
-            new CudaHostAllocator(), FLAGS_pool_limit_size, "cuda_host_pool");
+        cpuAllocator_[poolId] =
+            new PoolAllocator(new CudaHostAllocator(),
+                              FLAGS_pool_limit_size,
+                              "cuda_host_pool" + id);
       } else {
-        cpuAllocator_ = new PoolAllocator(
-            new CpuAllocator(), FLAGS_pool_limit_size, "cpu_pool");
+        cpuAllocator_[poolId] = new PoolAllocator(
+            new CpuAllocator(), FLAGS_pool_limit_size, "cpu_pool" + id);
       }
     }
-    return cpuAllocator_;
+    return cpuAllocator_[poolId];
   }
 }
 
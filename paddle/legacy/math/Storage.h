@@ -37,7 +37,11 @@ class StorageEngine {
   PoolAllocator* getGpuAllocator(int deviceId);
 
   /**
-   * @return return cpu allocator
+   * @return return the cpu allocator of the calling thread
+   *
+   * @note  there are FLAGS_cpu_pool_num cpu allocators, which the threads
+   *        take by turns, so that the threads of the inference or the
+   *        training seldom contend for the lock of one pool.
    */
   PoolAllocator* getCpuAllocator();
 
@@ -46,7 +50,7 @@ class StorageEngine {
   ~StorageEngine();
   RWLock lock_;
   std::vector<PoolAllocator*> gpuAllocator_;
-  PoolAllocator* cpuAllocator_;
+  std::vector<PoolAllocator*> cpuAllocator_;
 };
 
 }  // namespace paddle
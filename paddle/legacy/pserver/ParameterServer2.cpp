@@ -579,7 +579,7 @@ void ParameterServer2::getParameterSparse(const SendParameterRequest& request,
   for (const auto& block : request.blocks()) {
     numReals += getParameterConfig(block).dims(1);
   }
-  buffer.resize(numReals);
+  buffer.growTo(numReals);
 
   VLOG(3) << "pserver: getParameterSparse, numReals=" << numReals;
 
@@ -200,11 +200,22 @@ class ParameterServer2 : public ProtoServer {
      */
     void resizeWithAlignHints(size_t size, size_t alignBlockCount = 1) {
       if (IsTLargerThanAlign) {  //! So, each elements is memory aligned.
-        this->resize(size);
+        growTo(size);
       } else {
         //! at most, we need such elements in buffer to make sure each block is
         //! aligned.
-        this->resize(size + alignBlockCount * (AlignElementCount - 1));
+        growTo(size + alignBlockCount * (AlignElementCount - 1));
+      }
+    }
+
+    /**
+     * @brief Make the buffer hold at least size elements. The buffer never
+     * shrinks, so the buffer reused by the requests of different sizes is
+     * neither reallocated nor filled by zero again once it is large enough.
+     */
+    void growTo(size_t size) {
+      if (this->size() < size) {
+        this->resize(size);
       }
     }
 
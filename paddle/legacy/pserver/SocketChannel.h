@@ -88,6 +88,7 @@ class SocketChannel {
   SocketChannel(int socket, const std::string& peerName)
       : tcpSocket_(socket), peerName_(peerName) {
     tcpRdma_ = F_TCP;
+    enableZeroCopy();
   }
   SocketChannel(struct sxi_sock* socket, const std::string& peerName)
       : rdmaSocket_(socket), peerName_(peerName) {
@@ -144,10 +145,24 @@ class SocketChannel {
     int64_t iovLengths[0];
   };
 
+  /// enable the zero copy sends of the large messages on the tcp socket if
+  /// FLAGS_sock_zerocopy_send_bytes > 0 and the kernel supports them
+  void enableZeroCopy();
+
+  /// write the buffers by MSG_ZEROCOPY, and wait until the kernel does not
+  /// reference them any more, so the caller can reuse them as for writev
+  size_t writevZeroCopy(const std::vector<struct iovec>& iov);
+
   int tcpSocket_;
   struct sxi_sock* rdmaSocket_;
   const std::string peerName_;
   enum ChannelType tcpRdma_;
+
+  bool zeroCopy_ = false;
+  /// the numbers of the zero copy sends, and of the completed ones, which
+  /// the kernel notifies in order
+  uint32_t zeroCopySends_ = 0;
+  uint32_t zeroCopyDone_ = 0;
 };
 
 }  // namespace paddle
@@ -56,13 +56,16 @@ from . import unique_name
 from . import recordio_writer
 from . import parallel_executor
 from .parallel_executor import *
+from . import pipeline_executor
+from .pipeline_executor import *
 from paddle.fluid.layers.math_op_patch import monkey_patch_variable
 
 Tensor = LoDTensor
 
 __all__ = framework.__all__ + executor.__all__ + \
     trainer.__all__ + inferencer.__all__ + transpiler.__all__ + \
-    parallel_executor.__all__ + lod_tensor.__all__ + \
+    parallel_executor.__all__ + pipeline_executor.__all__ + \
+    lod_tensor.__all__ + \
     data_feed_desc.__all__ + async_executor.__all__ + [
         'io',
         'initializer',
@@ -127,9 +130,14 @@ def __bootstrap__():
         'use_ngraph', 'initial_cpu_memory_in_mb', 'init_allocated_mem',
         'free_idle_memory', 'paddle_num_threads', "dist_threadpool_size",
         'eager_delete_tensor_gb', 'fast_eager_deletion_mode',
-        'allocator_strategy', 'reader_queue_speed_test_mode',
-        'print_sub_graph_dir', 'pe_profile_fname', 'warpctc_dir',
-        'enable_parallel_graph'
+        'inline_eager_deletion_mode', 'allocator_strategy',
+        'reader_queue_speed_test_mode', 'print_sub_graph_dir',
+        'pe_profile_fname', 'warpctc_dir', 'enable_parallel_graph',
+        'enable_cache_runtime_context', 'enable_cache_infer_shape',
+        'enable_allocator_stats', 'profile_allocator_stats',
+        'sparse_update_threads', 'profile_chrome_trace',
+        'async_save_max_inflight', 'conv_cpu_winograd', 'compute_pool_threads',
+        'intra_op_threads'
     ]
     if 'Darwin' not in sysstr:
         read_env_flags.append('use_pinned_memory')
@@ -142,20 +150,39 @@ def __bootstrap__():
         read_env_flags.append('rpc_server_profile_path')
         read_env_flags.append('enable_rpc_profiler')
         read_env_flags.append('rpc_send_thread_num')
+        read_env_flags.append('rpc_batch_vars')
         read_env_flags.append('rpc_get_thread_num')
         read_env_flags.append('rpc_prefetch_thread_num')
+        read_env_flags.append('rpc_prefetch_batch')
+        read_env_flags.append('rpc_prefetch_batch_window_us')
+        read_env_flags.append('rpc_prefetch_lookup_shards')
+        read_env_flags.append('prefetch_cache_rows')
+        read_env_flags.append('prefetch_cache_expire_steps')
         read_env_flags.append('rpc_disable_reuse_port')
+        read_env_flags.append('rpc_fp16_compress_vars')
+        read_env_flags.append('rpc_fp16_compress_loss_scale')
+        read_env_flags.append('communicator_enable')
+        read_env_flags.append('communicator_send_queue_size')
+        read_env_flags.append('communicator_max_merge_var_num')
+        read_env_flags.append('communicator_recv_wait_ms')
         if core.is_compiled_with_brpc():
             read_env_flags.append('max_body_size')
             #set brpc max body size
             os.environ['FLAGS_max_body_size'] = "2147483647"
+        if core.is_compiled_with_verbs():
+            read_env_flags += [
+                'rpc_verbs_device', 'rpc_verbs_port', 'rpc_verbs_gid_index',
+                'rpc_verbs_inline_bytes', 'rpc_verbs_queue_depth'
+            ]
 
     if core.is_compiled_with_cuda():
         read_env_flags += [
             'fraction_of_gpu_memory_to_use', 'cudnn_deterministic',
-            'enable_cublas_tensor_op_math', 'conv_workspace_size_limit',
-            'cudnn_exhaustive_search', 'memory_optimize_debug', 'selected_gpus',
-            'sync_nccl_allreduce'
+            'enable_cublas_tensor_op_math', 'cublas_fp16_gemm_padding',
+            'conv_workspace_size_limit', 'cudnn_exhaustive_search',
+            'memory_optimize_debug', 'selected_gpus', 'sync_nccl_allreduce',
+            'allreduce_fp16_compress_vars', 'use_stream_safe_cuda_allocator',
+            'swap_activation_min_mb', 'swap_prefetch_distance'
         ]
 
     core.init_gflags([sys.argv[0]] +
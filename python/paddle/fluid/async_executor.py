@@ -145,22 +145,127 @@ class AsyncExecutor(object):
         if not isinstance(thread_num, int):
             raise TypeError('TypeError: thread_num should be a positive number')
 
-        if fetch is not None:
-            if isinstance(fetch, Variable):
-                fetch = [fetch]
-            fetch_var_names = [var.name for var in fetch]
-            for fetch_var in fetch:
-                shape = fetch_var.shape
-                if shape[len(shape) - 1] != 1:
-                    raise AssertionError(
-                        "%s: Fetch variable has wrong shape. Only varibles "
-                        "with the last dimension size 1 supported." %
-                        (fetch_var.name))
+        fetch_var_names = self._get_fetch_var_names(fetch)
 
         self.executor.run_from_files(program_desc,
                                      data_feed.desc(), filelist, thread_num,
                                      fetch_var_names, mode, debug)
 
+    def load_into_memory(self,
+                         data_feed,
+                         filelist,
+                         thread_num,
+                         trainer_id=0,
+                         trainer_num=1):
+        """
+        Load the training dataset in filelist into memory, so that the later
+        passes can be run by :code:`run_from_memory` without reading the
+        files again.
+
+        Args:
+            data_feed(DataFeedDesc): A DataFeedDesc object
+            filelist(str|list): the training dataset file list
+            thread_num(int): number of concurrent loading threads
+            trainer_id(int): the id of the current trainer
+            trainer_num(int): the number of trainers. If it is greater than 1,
+                              all the trainers should load the same filelist,
+                              and each keeps the instances hashed to it.
+
+        Examples:
+            .. code-block:: python
+
+                async_executor.load_into_memory(data_feed, filelist, 10)
+                for pass_id in range(pass_num):
+                    async_executor.local_shuffle()
+                    async_executor.run_from_memory(main_program, data_feed,
+                                                   10, [loss])
+                async_executor.release_memory()
+        """
+        if data_feed is None:
+            raise ValueError('ValueError: data_feed should be provided')
+
+        if filelist is None:
+            raise ValueError('ValueError: filelist should be provided')
+
+        if isinstance(filelist, str):
+            filelist = [filelist]
+
+        if not isinstance(thread_num, int):
+            raise TypeError('TypeError: thread_num should be a positive number')
+
+        self.executor.load_into_memory(data_feed.desc(), filelist, thread_num,
+                                       trainer_id, trainer_num)
+
+    def local_shuffle(self, seed=None):
+        """
+        Shuffle the instances loaded into memory by each thread among
+        themselves.
+
+        Args:
+            seed(int|None): the random seed, a random one if it is None
+        """
+        if seed is None:
+            seed = np.random.randint(0, 2**31 - 1)
+        self.executor.local_shuffle(seed)
+
+    def global_shuffle(self, seed=None):
+        """
+        Shuffle all the instances loaded into memory.
+
+        Args:
+            seed(int|None): the random seed, a random one if it is None
+        """
+        if seed is None:
+            seed = np.random.randint(0, 2**31 - 1)
+        self.executor.global_shuffle(seed)
+
+    def release_memory(self):
+        """
+        Release the instances loaded into memory.
+        """
+        self.executor.release_memory()
+
+    def run_from_memory(self,
+                        program,
+                        data_feed,
+                        thread_num,
+                        fetch,
+                        mode="",
+                        debug=False):
+        """
+        Run program by this AsyncExecutor with the training dataset loaded by
+        :code:`load_into_memory`. The arguments are the same as :code:`run`.
+        """
+        if program is None:
+            program = default_main_program()
+        program_desc = program.desc
+
+        if data_feed is None:
+            raise ValueError('ValueError: data_feed should be provided')
+
+        if not isinstance(thread_num, int):
+            raise TypeError('TypeError: thread_num should be a positive number')
+
+        fetch_var_names = self._get_fetch_var_names(fetch)
+
+        self.executor.run_from_memory(program_desc,
+                                      data_feed.desc(), thread_num,
+                                      fetch_var_names, mode, debug)
+
+    def _get_fetch_var_names(self, fetch):
+        if fetch is None:
+            return []
+        if isinstance(fetch, Variable):
+            fetch = [fetch]
+        for fetch_var in fetch:
+            shape = fetch_var.shape
+            if shape[len(shape) - 1] != 1:
+                raise AssertionError(
+                    "%s: Fetch variable has wrong shape. Only varibles "
+                    "with the last dimension size 1 supported." %
+                    (fetch_var.name))
+        return [var.name for var in fetch]
+
     def download_data(self,
                       afs_path,
                       local_path,
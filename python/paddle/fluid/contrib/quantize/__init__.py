@@ -16,5 +16,8 @@ from __future__ import print_function
 
 from . import quantize_transpiler
 from .quantize_transpiler import *
+from . import embedding_quantizer
+from .embedding_quantizer import *
 
 __all__ = quantize_transpiler.__all__
+__all__ += embedding_quantizer.__all__
@@ -0,0 +1,124 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import numpy as np
+
+from paddle.fluid import core
+from paddle.fluid.executor import global_scope
+
+__all__ = ['quantize_embedding']
+
+_LOOKUP_OP_TYPES = ['lookup_table', 'fused_embedding_seq_pool']
+
+
+def _quantize_rows(table):
+    """
+    Quantize the float table [N, D] into uint8 by row, returns the uint8
+    table and the [N, 2] scale and bias of the rows.
+    """
+    row_min = table.min(axis=1)
+    scale = (table.max(axis=1) - row_min) / 255.0
+    # The constant rows are all quantized to 0.
+    scale[scale == 0] = 1.0
+    quantized = np.round((table - row_min[:, np.newaxis]) /
+                         scale[:, np.newaxis])
+    scale_bias = np.stack([scale, row_min], axis=1).astype(np.float32)
+    return np.clip(quantized, 0, 255).astype(np.uint8), scale_bias
+
+
+def quantize_embedding(program, place, scope=None, dtype='uint8'):
+    """
+    Quantize the embedding tables of the inference program, i.e. the
+    persistable W of its lookup_table and fused_embedding_seq_pool ops, which
+    are usually the most of the size of the sparse models. The ops look up
+    the quantized tables and dequantize the rows into float.
+
+    With dtype 'uint8', every row of W is quantized by its min and max into
+    uint8, whose scale and bias are the [N, 2] input WScaleBias of the ops,
+    which cuts the table by 4 times. With dtype 'float16', W is stored in
+    float16, by 2 times.
+
+    The quantized tables are the new parameters `W.uint8` (and
+    `W.uint8.scale_bias`) or `W.float16` in the scope, which replace W in the
+    program, so that the inference model saved by the program holds only the
+    quantized tables. The float tables are kept in the scope, and they should
+    be trained in float.
+
+    Args:
+        program(Program): The inference program, e.g. the program cloned
+            for test, or loaded by load_inference_model.
+        place(Place): The place of the quantized tables.
+        scope(Scope|None): The scope of the tables, the global scope if
+            None.
+        dtype(str): 'uint8' or 'float16'.
+
+    Examples:
+        .. code-block:: python
+
+            infer_program = fluid.default_main_program().clone(for_test=True)
+            fluid.contrib.quantize_embedding(infer_program, place)
+            fluid.io.save_inference_model(
+                dirname, ['ids'], [predict], exe, main_program=infer_program)
+    """
+    if dtype not in ['uint8', 'float16']:
+        raise ValueError("The dtype of quantize_embedding should be 'uint8' "
+                         "or 'float16', but got %s." % dtype)
+    scope = global_scope() if scope is None else scope
+    global_block = program.global_block()
+
+    def _set_var(name, value, like, var_dtype):
+        var = global_block.create_parameter(
+            name=name, type=like.type, dtype=var_dtype, shape=value.shape)
+        scope.var(name).get_tensor().set(value, place)
+        return var
+
+    quantized = {}
+    for block in program.blocks:
+        for op in list(block.ops):
+            if op.type not in _LOOKUP_OP_TYPES:
+                continue
+            if 'WScaleBias' in op.input_names and op.input('WScaleBias'):
+                continue
+            name = op.input('W')[0]
+            var = block.var(name)
+            if not var.persistable:
+                continue
+            if name not in quantized:
+                table = np.array(scope.find_var(name).get_tensor())
+                new_name = name + '.' + dtype
+                scale_bias_name = None
+                if dtype == 'uint8':
+                    q, scale_bias = _quantize_rows(table)
+                    _set_var(new_name, q, var, core.VarDesc.VarType.UINT8)
+                    scale_bias_name = new_name + '.scale_bias'
+                    _set_var(scale_bias_name, scale_bias, var,
+                             core.VarDesc.VarType.FP32)
+                else:
+                    # float16 is set as uint16, see tensor_py.h.
+                    _set_var(new_name,
+                             table.astype(np.float16).view(np.uint16), var,
+                             core.VarDesc.VarType.FP16)
+                quantized[name] = (new_name, scale_bias_name)
+            new_name, scale_bias_name = quantized[name]
+            op._rename_input(name, new_name)
+            if scale_bias_name is not None:
+                op.desc.set_input('WScaleBias', [scale_bias_name])
+
+    for name in quantized:
+        used = any(name in op.input_arg_names or name in op.output_arg_names
+                   for block in program.blocks for op in block.ops)
+        if not used:
+            global_block._remove_var(name)
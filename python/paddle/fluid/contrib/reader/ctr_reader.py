@@ -50,7 +50,12 @@ def ctr_reader(feed_data,
                batch_size,
                file_list,
                slots,
-               name=None):
+               name=None,
+               cache_samples=False,
+               cache_dir=None,
+               cache_memory_limit=1024,
+               dense_slots=None,
+               dense_slot_dims=None):
     """
     Create a CTR reader for data feeding in Python
 
@@ -74,6 +79,15 @@ def ctr_reader(feed_data,
        slots(bool): Whether use double buffer or not.
        name(basestring): The prefix Python queue name and Reader name. None will
             be generated automatically.
+       cache_samples(bool): Whether to cache the parsed batches of the first
+            epoch, so that the later epochs do not parse the files again.
+       cache_dir(basestring|None): The directory of the cache files of the
+            threads whose cache exceeds :code:`cache_memory_limit`. None keeps
+            all the cache in memory.
+       cache_memory_limit(int): The MB of the cache of a thread kept in memory.
+       dense_slots(list|tuple|None): The slots of float values, which are read
+            into the tensors of shape [batch_size, dim] after :code:`slots`.
+       dense_slot_dims(list|tuple|None): The dims of :code:`dense_slots`.
 
     Returns:
        Variable: A Reader from which we can get feeding data.
@@ -103,6 +117,11 @@ def ctr_reader(feed_data,
             'batch_size': batch_size,
             'file_list': file_list,
             'slots': slots,
+            'cache_samples': cache_samples,
+            'cache_dir': cache_dir or '',
+            'cache_memory_limit': cache_memory_limit,
+            'dense_slots': dense_slots or [],
+            'dense_slot_dims': dense_slot_dims or [],
         })
 
     reader_var.persistable = True
@@ -0,0 +1,102 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import shutil
+import tempfile
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+from paddle.fluid.contrib.quantize import quantize_embedding
+
+DICT_SIZE = 100
+EMB_SIZE = 16
+
+
+def build_program():
+    main = fluid.Program()
+    startup = fluid.Program()
+    with fluid.program_guard(main, startup):
+        ids = fluid.layers.data(
+            name='ids', shape=[1], dtype='int64', lod_level=1)
+        emb = fluid.layers.embedding(
+            input=ids,
+            size=[DICT_SIZE, EMB_SIZE],
+            param_attr=fluid.ParamAttr(name='emb'))
+        pool = fluid.layers.sequence_pool(input=emb, pool_type='sum')
+        predict = fluid.layers.fc(input=pool, size=2)
+    return main, startup, predict
+
+
+class TestQuantizeEmbedding(unittest.TestCase):
+    dtype = 'uint8'
+    atol = 1e-2
+
+    def setUp(self):
+        self.place = fluid.CPUPlace()
+        ids = np.random.randint(0, DICT_SIZE, (10, 1)).astype('int64')
+        self.ids = fluid.create_lod_tensor(ids, [[4, 6]], self.place)
+
+    def test_quantize_embedding(self):
+        main, startup, predict = build_program()
+        scope = fluid.Scope()
+        exe = fluid.Executor(self.place)
+        with fluid.scope_guard(scope):
+            exe.run(startup)
+            infer_program = main.clone(for_test=True)
+            expected, = exe.run(infer_program,
+                                feed={'ids': self.ids},
+                                fetch_list=[predict])
+
+            quantize_embedding(
+                infer_program, self.place, scope=scope, dtype=self.dtype)
+            block = infer_program.global_block()
+            self.assertFalse(block.has_var('emb'))
+            table = block.var('emb.' + self.dtype)
+            self.assertEqual(table.dtype, {
+                'uint8': core.VarDesc.VarType.UINT8,
+                'float16': core.VarDesc.VarType.FP16
+            }[self.dtype])
+            result, = exe.run(infer_program,
+                              feed={'ids': self.ids},
+                              fetch_list=[predict])
+            self.assertTrue(np.allclose(result, expected, atol=self.atol))
+
+            # The inference model holds only the quantized table.
+            dirname = tempfile.mkdtemp()
+            try:
+                fluid.io.save_inference_model(
+                    dirname, ['ids'], [predict],
+                    exe,
+                    main_program=infer_program)
+                program, _, fetch_targets = fluid.io.load_inference_model(
+                    dirname, exe)
+                self.assertFalse(program.global_block().has_var('emb'))
+                loaded, = exe.run(program,
+                                  feed={'ids': self.ids},
+                                  fetch_list=fetch_targets)
+                self.assertTrue(np.allclose(loaded, result))
+            finally:
+                shutil.rmtree(dirname)
+
+
+class TestQuantizeEmbeddingFloat16(TestQuantizeEmbedding):
+    dtype = 'float16'
+    atol = 1e-3
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,328 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import binascii
+import socket
+import sys
+import threading
+import time
+
+__all__ = ['ElasticMembership', 'ElasticExecutor']
+
+
+def _split_endpoint(endpoint):
+    host, port = endpoint.rsplit(":", 1)
+    return host, int(port)
+
+
+class ElasticMembership(object):
+    """
+    ElasticMembership tracks the alive trainers of nccl2 collective training
+    by heartbeats.
+
+    Trainer 0 runs the coordinator on coordinator_endpoint and the other
+    trainers send it a heartbeat every heartbeat_interval seconds. A trainer
+    whose heartbeat is not seen for heartbeat_timeout seconds is removed: the
+    coordinator starts a new epoch, in which the surviving trainers are
+    ranked by their original trainer ids, and generates a new NCCL id for it.
+    The trainers learn the new epoch from the replies of their heartbeats
+    and on_change(epoch) is called on the heartbeat thread.
+
+    Trainer 0 must survive, and the trainers can only leave the job.
+
+    Args:
+        trainer_id (int): the original id of this trainer.
+        num_trainers (int): the original number of the trainers.
+        coordinator_endpoint (str): ip:port the coordinator listens on.
+        gen_nccl_id (callable): returns the bytes of a new NCCL id, only used
+            by trainer 0, default is core.gen_nccl_unique_id.
+        heartbeat_interval (float): seconds between two heartbeats.
+        heartbeat_timeout (float): seconds after which a silent trainer is
+            removed, also counted from the start of the coordinator.
+        on_change (callable): called with the new epoch.
+
+    Examples:
+        .. code-block:: python
+
+            membership = ElasticMembership(trainer_id, num_trainers,
+                                           "192.168.0.1:6200")
+            membership.start()
+            exe = ElasticExecutor(pe, membership)
+    """
+
+    def __init__(self,
+                 trainer_id,
+                 num_trainers,
+                 coordinator_endpoint,
+                 gen_nccl_id=None,
+                 heartbeat_interval=1.0,
+                 heartbeat_timeout=10.0,
+                 on_change=None):
+        assert heartbeat_timeout > heartbeat_interval
+        self.trainer_id = trainer_id
+        self.on_change = on_change
+        self._coordinator_endpoint = coordinator_endpoint
+        self._gen_nccl_id = gen_nccl_id
+        self._interval = heartbeat_interval
+        self._timeout = heartbeat_timeout
+
+        self._lock = threading.Lock()
+        self._epoch = 0
+        self._num_trainers = num_trainers
+        self._rank = trainer_id
+        self._nccl_id = None
+        self._coordinator_lost = False
+
+        # only used by the coordinator
+        self._alive = list(range(num_trainers))
+        self._last_seen = {}
+
+        self._stopped = threading.Event()
+        self._threads = []
+        self._server = None
+
+    def start(self):
+        if self.trainer_id == 0:
+            if self._gen_nccl_id is None:
+                from .. import core
+                self._gen_nccl_id = core.gen_nccl_unique_id
+            self._start_coordinator()
+        else:
+            self._start_thread(self._heartbeat_loop)
+
+    def stop(self):
+        self._stopped.set()
+        if self._server is not None:
+            self._server.close()
+        for t in self._threads:
+            t.join()
+        self._threads = []
+
+    def membership(self):
+        """
+        Returns:
+            tuple: (epoch, num_trainers, rank, nccl_id) of this trainer in
+                the current epoch. The rank is -1 if this trainer has been
+                removed, and nccl_id is None in epoch 0.
+        """
+        with self._lock:
+            if self._coordinator_lost:
+                raise RuntimeError("lost the elastic coordinator %s" %
+                                   self._coordinator_endpoint)
+            return self._epoch, self._num_trainers, self._rank, self._nccl_id
+
+    def _start_thread(self, target, *args):
+        t = threading.Thread(target=target, args=args)
+        t.daemon = True
+        t.start()
+        self._threads.append(t)
+
+    def _notify(self, epoch):
+        if self.on_change is not None:
+            self.on_change(epoch)
+
+    # The coordinator of trainer 0.
+
+    def _start_coordinator(self):
+        host, port = _split_endpoint(self._coordinator_endpoint)
+        self._server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        self._server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        self._server.bind((host, port))
+        self._server.listen(128)
+        self._server.settimeout(self._interval)
+        now = time.time()
+        for trainer_id in self._alive[1:]:
+            self._last_seen[trainer_id] = now
+        self._start_thread(self._accept_loop)
+        self._start_thread(self._monitor_loop)
+
+    def _accept_loop(self):
+        while not self._stopped.is_set():
+            try:
+                conn, _ = self._server.accept()
+            except socket.timeout:
+                continue
+            except (socket.error, OSError):
+                break
+            self._start_thread(self._serve_loop, conn)
+
+    def _serve_loop(self, conn):
+        conn.settimeout(self._timeout)
+        reader = conn.makefile("r")
+        try:
+            while not self._stopped.is_set():
+                line = reader.readline()
+                if not line:
+                    break
+                trainer_id = int(line.split()[0])
+                conn.sendall(self._reply(trainer_id).encode("ascii"))
+        except (socket.error, OSError, ValueError) as e:
+            print("elastic heartbeat connection error: %s" % e,
+                  file=sys.stderr)
+        finally:
+            reader.close()
+            conn.close()
+
+    def _reply(self, trainer_id):
+        with self._lock:
+            if trainer_id in self._last_seen:
+                self._last_seen[trainer_id] = time.time()
+            rank = self._alive.index(trainer_id) \
+                if trainer_id in self._alive else -1
+            nccl_id = binascii.hexlify(self._nccl_id).decode("ascii") \
+                if self._nccl_id else "-"
+            return "%d %d %d %s\n" % (self._epoch, self._num_trainers, rank,
+                                      nccl_id)
+
+    def _monitor_loop(self):
+        while not self._stopped.wait(self._interval):
+            now = time.time()
+            with self._lock:
+                lost = [
+                    t for t, seen in self._last_seen.items()
+                    if now - seen > self._timeout
+                ]
+                if not lost:
+                    continue
+                for t in lost:
+                    del self._last_seen[t]
+                    self._alive.remove(t)
+                self._epoch += 1
+                self._num_trainers = len(self._alive)
+                self._nccl_id = self._gen_nccl_id()
+                epoch = self._epoch
+            print(
+                "elastic: lost trainers %s, %d trainers left in epoch %d" %
+                (sorted(lost), self._num_trainers, epoch),
+                file=sys.stderr)
+            self._notify(epoch)
+
+    # The heartbeats of the other trainers.
+
+    def _connect(self):
+        deadline = time.time() + self._timeout
+        while True:
+            try:
+                return socket.create_connection(
+                    _split_endpoint(self._coordinator_endpoint),
+                    timeout=self._timeout)
+            except (socket.error, OSError):
+                if time.time() > deadline or self._stopped.is_set():
+                    raise
+                time.sleep(self._interval)
+
+    def _heartbeat_loop(self):
+        conn = None
+        try:
+            conn = self._connect()
+            reader = conn.makefile("r")
+            while not self._stopped.is_set():
+                conn.sendall(("%d\n" % self.trainer_id).encode("ascii"))
+                line = reader.readline()
+                if not line:
+                    raise socket.error("the coordinator closed the connection")
+                self._apply(line.split())
+                self._stopped.wait(self._interval)
+        except (socket.error, OSError, ValueError) as e:
+            if not self._stopped.is_set():
+                print("elastic: lost the coordinator: %s" % e, file=sys.stderr)
+                with self._lock:
+                    self._coordinator_lost = True
+                    epoch = self._epoch
+                self._notify(epoch + 1)
+        finally:
+            if conn is not None:
+                conn.close()
+
+    def _apply(self, fields):
+        epoch = int(fields[0])
+        with self._lock:
+            if epoch <= self._epoch:
+                return
+            self._epoch = epoch
+            self._num_trainers = int(fields[1])
+            self._rank = int(fields[2])
+            self._nccl_id = binascii.unhexlify(fields[3])
+        self._notify(epoch)
+
+
+class ElasticExecutor(object):
+    """
+    ElasticExecutor runs the ParallelExecutor of nccl2 collective training
+    and keeps it running when trainers are lost.
+
+    When ElasticMembership starts a new epoch, the NCCL communicators are
+    aborted, so that a step blocked on a lost trainer returns, and rebuilt
+    with the surviving trainers before the next step. The parameters are then
+    broadcast from the new trainer 0. The step which runs into the change is
+    dropped and run returns None for it.
+
+    The graph still scales the gradients by the original number of the
+    trainers, so the averaged gradients, and in effect the learning rate of
+    SGD like optimizers, are scaled by num_trainers / original num_trainers,
+    which follows the linear scaling of the learning rate with the global
+    batch size.
+
+    It needs NCCL 2.4 or later and does not support hierarchical allreduce.
+
+    Args:
+        parallel_executor (ParallelExecutor): built with num_trainers and
+            trainer_id of the original job.
+        membership (ElasticMembership): the membership of this trainer,
+            whose on_change is set by ElasticExecutor.
+    """
+
+    def __init__(self, parallel_executor, membership):
+        self._pe = parallel_executor
+        self._membership = membership
+        self._lock = threading.Lock()
+        self._epoch = 0
+        membership.on_change = self._on_change
+
+    def run(self, fetch_list, feed=None, return_numpy=True):
+        self._sync()
+        try:
+            result = self._pe.run(
+                fetch_list, feed=feed, return_numpy=return_numpy)
+        except Exception:
+            # an aborted collective may fail the step
+            if self._membership.membership()[0] == self._epoch:
+                raise
+            result = None
+        if self._sync():
+            return None
+        return result
+
+    def _on_change(self, epoch):
+        # abort under the lock, so that the communicators just reset to this
+        # epoch by _sync are never aborted
+        with self._lock:
+            # the communicators may already be reset to this epoch
+            if epoch <= self._epoch:
+                return
+            self._pe.executor.abort_nccl()
+
+    def _sync(self):
+        epoch, num_trainers, rank, nccl_id = self._membership.membership()
+        with self._lock:
+            if epoch == self._epoch:
+                return False
+            if rank < 0:
+                raise RuntimeError("trainer %d has been removed from the job" %
+                                   self._membership.trainer_id)
+            self._epoch = epoch
+        self._pe.executor.reset_nccl(nccl_id, num_trainers, rank)
+        return True
@@ -219,11 +219,11 @@ def _to_name_str(var):
         raise TypeError(str(var) + " should be Variable or str")
 
 
-def _get_program_cache_key(feed, fetch_list):
+def _get_program_cache_key(program, feed, fetch_list):
     feed_var_names = list(feed.keys())
     fetch_var_names = list(map(_to_name_str, fetch_list))
 
-    return str(feed_var_names + fetch_var_names)
+    return str([id(program)] + feed_var_names + fetch_var_names)
 
 
 def _as_lodtensor(data, place):
@@ -303,6 +303,7 @@ class Executor(object):
     def __init__(self, place):
         self.place = place
         self.program_caches = dict()
+        self.ctx_caches = dict()
         self.executor = None
         self._closed = False
 
@@ -312,6 +313,13 @@ class Executor(object):
     def _add_program_cache(self, program_cache_key, program):
         self.program_caches[program_cache_key] = program
 
+    def _get_ctx_cache(self, program_cache_key):
+        return self.ctx_caches.get(program_cache_key, None)
+
+    def _add_ctx_cache(self, program_cache_key, origin_program, ctx):
+        # The origin program is kept, so that its id in the key is not reused.
+        self.ctx_caches[program_cache_key] = (origin_program, ctx)
+
     def _add_feed_fetch_ops(self, program, feed, fetch_list, feed_var_name,
                             fetch_var_name):
         tmp_program = program.clone()
@@ -560,7 +568,8 @@ class Executor(object):
                 "Executor requires Program as its Parameter. But you passed in %s"
                 % (type(program)))
 
-        cache_key = _get_program_cache_key(feed, fetch_list)
+        cache_key = _get_program_cache_key(program, feed, fetch_list)
+        ctx = None
         if use_program_cache:
             cached_program = self._get_program_cache(cache_key)
             if cached_program is None:
@@ -571,9 +580,15 @@ class Executor(object):
                     feed_var_name=feed_var_name,
                     fetch_var_name=fetch_var_name)
                 self._add_program_cache(cache_key, cached_program)
+                # The ops are created once, and reused by the later runs.
+                self._add_ctx_cache(
+                    cache_key, program,
+                    self.executor._prepare(cached_program.desc, 0))
+            ctx = self._get_ctx_cache(cache_key)[1]
             program = cached_program
         else:
             self.program_caches.pop(cache_key, None)
+            self.ctx_caches.pop(cache_key, None)
             program = self._add_feed_fetch_ops(
                 program=program,
                 feed=feed,
@@ -582,7 +597,10 @@ class Executor(object):
                 fetch_var_name=fetch_var_name)
 
         self._feed_data(program, feed, feed_var_name, scope)
-        self.executor.run(program.desc, scope, 0, True, True)
+        if ctx is not None:
+            self.executor.run_prepared_ctx(ctx, scope, True, True)
+        else:
+            self.executor.run(program.desc, scope, 0, True, True)
         outs = self._fetch_data(fetch_list, fetch_var_name, scope)
         if return_numpy:
             outs = as_numpy(outs)
@@ -57,6 +57,7 @@ __all__ = [
     'default_main_program',
     'program_guard',
     'name_scope',
+    'device_guard',
 ]
 
 EMPTY_VAR_NAME = core.kEmptyVarName()
@@ -131,6 +132,36 @@ def name_scope(prefix=None):
     _name_scope = _name_scope.parent()
 
 
+_current_device = None
+
+
+@contextlib.contextmanager
+def device_guard(device=None):
+    """
+    Set the device of the operators created in the guard, which is the stage
+    of the operators in the :code:`fluid.PipelineExecutor`. The operators
+    without the device run on the stage of their inputs.
+
+    Args:
+        device(str): The device, "cpu", "cpu:N" or "gpu:N". None means the
+            device of the outer guard.
+
+    Examples:
+        .. code-block:: python
+
+          with fluid.device_guard("gpu:0"):
+              hidden = fluid.layers.fc(input=image, size=1024, act='relu')
+          with fluid.device_guard("gpu:1"):
+              predict = fluid.layers.fc(input=hidden, size=10, act='softmax')
+    """
+    global _current_device
+    pre_device = _current_device
+    if device is not None:
+        _current_device = device
+    yield
+    _current_device = pre_device
+
+
 def _full_name_scope():
     global _name_scope
     scope = _name_scope
@@ -538,7 +569,8 @@ class OpProtoHolder(object):
         return {
             core.op_proto_and_checker_maker.kOpRoleAttrName(),
             core.op_proto_and_checker_maker.kOpRoleVarAttrName(),
-            core.op_proto_and_checker_maker.kOpNameScopeAttrName()
+            core.op_proto_and_checker_maker.kOpNameScopeAttrName(),
+            core.op_proto_and_checker_maker.kOpDeviceAttrName()
         }
 
 
@@ -630,6 +662,8 @@ class Operator(object):
 
         namescope_var_name = op_maker.kOpNameScopeAttrName()
         op_attrs[namescope_var_name] = _full_name_scope()
+        if _current_device is not None:
+            op_attrs[op_maker.kOpDeviceAttrName()] = _current_device
 
         def find_name(var_list, name):
             for var_name in var_list:
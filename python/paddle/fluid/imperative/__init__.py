@@ -23,7 +23,11 @@ from .layers import *
 from . import nn
 from .nn import *
 
+from . import jit
+from .jit import *
+
 __all__ = []
 __all__ += layers.__all__
 __all__ += base.__all__
 __all__ += nn.__all__
+__all__ += jit.__all__
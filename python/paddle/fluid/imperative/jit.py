@@ -0,0 +1,87 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from paddle.fluid import core
+from paddle.fluid import framework
+
+__all__ = ['TracedLayer']
+
+_DEFAULT_PASSES = ['fc_fuse_pass', 'fuse_elewise_add_act_pass']
+
+
+class TracedLayer(object):
+    """
+    Run a layer as a static program.
+
+    The first call runs the layer in the imperative mode, which builds the
+    parameters. The next call with inputs of new data types, shapes or LoDs
+    records the ops of the layer into a program, which is optimized by the
+    passes, and the later calls with the same kinds of inputs run the program
+    without tracing the ops. The layers calling python layers, or reading the
+    temporary variables created outside, always run in the imperative mode.
+
+    The outputs of the program have no gradients, so the traced layer is
+    for the inference or the evaluation.
+
+    Args:
+        layer(Layer): the layer to run.
+        passes(list of str|None): the IR passes applied to the program.
+    """
+
+    def __init__(self, layer, passes=None):
+        self._layer = layer
+        self._built = False
+        self._return_list = False
+        self._traced = core.TracedLayer(framework._imperative_tracer(),
+                                        _DEFAULT_PASSES
+                                        if passes is None else passes)
+
+    def __call__(self, *inputs):
+        ivars = [x._ivar for x in inputs]
+        if not self._built:
+            self._built = True
+            outputs = self._layer(*inputs)
+            self._return_list = isinstance(outputs, (list, tuple))
+            return outputs
+
+        if self._traced.has_program(ivars):
+            block = framework.default_main_program().current_block()
+            ret = []
+            for ivar in self._traced.run(ivars):
+                tensor = ivar.value().get_tensor()
+                ret.append(
+                    framework.Variable(
+                        block,
+                        type=core.VarDesc.VarType.LOD_TENSOR,
+                        name=None,
+                        shape=tensor.shape(),
+                        dtype=tensor._dtype(),
+                        stop_gradient=True,
+                        ivar=ivar))
+            return ret if self._return_list else ret[0]
+
+        if not self._traced.need_trace(ivars):
+            return self._layer(*inputs)
+
+        self._traced.begin_trace(ivars)
+        try:
+            outputs = self._layer(*inputs)
+        except:
+            self._traced.abort_trace()
+            raise
+        if self._return_list:
+            self._traced.end_trace([x._ivar for x in outputs])
+        else:
+            self._traced.end_trace([outputs._ivar])
+        return outputs
@@ -27,7 +27,8 @@ from . import core
 
 __all__ = [
     'save_vars', 'save_params', 'save_persistables', 'load_vars', 'load_params',
-    'load_persistables', 'save_inference_model', 'load_inference_model'
+    'load_persistables', 'save_inference_model', 'load_inference_model',
+    'wait_async_save'
 ]
 
 
@@ -91,7 +92,8 @@ def save_vars(executor,
               main_program=None,
               vars=None,
               predicate=None,
-              filename=None):
+              filename=None,
+              async_save=False):
     """
     Save variables to the given directory by executor.
 
@@ -125,12 +127,18 @@ def save_vars(executor,
         filename(str|None): The file which to save all variables. If you prefer to save
                             variables separately, set it to None.
                             Default: None
+        async_save(bool): If True, the variables are snapshotted and the file
+                          is written in the background while the training
+                          goes on. It only works with `filename`, call
+                          `wait_async_save()` to wait for the file.
+                          Default: False
 
     Returns:
         None
 
     Raises:
         TypeError: If `main_program` is not an instance of Program nor None.
+        ValueError: If `async_save` is True while `filename` is None.
 
     Examples:
         .. code-block:: python
@@ -157,6 +165,9 @@ def save_vars(executor,
             # var_a, var_b and var_c will be saved. And they are going to be
             # saved in the same file named 'var_file' in the path "./my_paddle_model".
     """
+    if async_save and filename is None:
+        raise ValueError("async_save only works with filename")
+
     if vars is None:
         if main_program is None:
             main_program = default_main_program()
@@ -168,7 +179,8 @@ def save_vars(executor,
             main_program=main_program,
             dirname=dirname,
             vars=list(filter(predicate, main_program.list_vars())),
-            filename=filename)
+            filename=filename,
+            async_save=async_save)
     else:
         save_program = Program()
         save_block = save_program.global_block()
@@ -204,7 +216,10 @@ def save_vars(executor,
                 type='save_combine',
                 inputs={'X': save_var_list},
                 outputs={},
-                attrs={'file_path': os.path.join(dirname, filename)})
+                attrs={
+                    'file_path': os.path.join(dirname, filename),
+                    'async_save': async_save
+                })
 
         # if there is lookup table, the trainer 0 will notify all pserver to save.
         if main_program._is_distributed and main_program._is_chief and main_program._distributed_lookup_table:
@@ -267,7 +282,11 @@ def save_params(executor, dirname, main_program=None, filename=None):
         filename=filename)
 
 
-def save_persistables(executor, dirname, main_program=None, filename=None):
+def save_persistables(executor,
+                      dirname,
+                      main_program=None,
+                      filename=None,
+                      async_save=False):
     """
     This function filters out all variables with `persistable==True` from the
     give `main_program` and then saves these variables to the folder `dirname`
@@ -288,6 +307,10 @@ def save_persistables(executor, dirname, main_program=None, filename=None):
         filename(str|None): The file to saved all variables. If you prefer to
                             save variables in differnet files, set it to None.
                             Default: None
+        async_save(bool): If True, the variables are snapshotted and the file
+                          is written in the background while the training
+                          goes on. It only works with `filename`.
+                          Default: False
 
     Returns:
         None
@@ -307,7 +330,32 @@ def save_persistables(executor, dirname, main_program=None, filename=None):
         main_program=main_program,
         vars=None,
         predicate=is_persistable,
-        filename=filename)
+        filename=filename,
+        async_save=async_save)
+
+
+def wait_async_save():
+    """
+    Wait for the files of the saves with `async_save=True` to be written.
+    At most FLAGS_async_save_max_inflight snapshots are kept in the host
+    memory, a save waits for the oldest one to be written before taking
+    another.
+
+    Raises:
+        EnforceNotMet: If any of the saves since the last wait failed.
+
+    Examples:
+        .. code-block:: python
+
+            exe = fluid.Executor(fluid.CUDAPlace(0))
+            for pass_id in range(10):
+                # train the pass
+                fluid.io.save_persistables(
+                    executor=exe, dirname="./checkpoint_%d" % pass_id,
+                    filename="__params__", async_save=True)
+            fluid.io.wait_async_save()
+    """
+    core._wait_async_save()
 
 
 def load_vars(executor,
@@ -15,6 +15,7 @@
 from __future__ import print_function
 import contextlib
 import multiprocessing
+import numpy as np
 import os
 import six
 import threading
@@ -30,8 +31,9 @@ from ..layer_helper import LayerHelper
 from ..unique_name import generate as unique_name
 
 __all__ = [
-    'data', 'open_files', 'read_file', 'shuffle', 'batch', 'double_buffer',
-    'random_data_generator', 'py_reader', 'create_py_reader_by_data',
+    'data', 'open_files', 'read_file', 'shuffle', 'batch', 'bucket_batch',
+    'double_buffer', 'work_stealing_prefetch', 'random_data_generator',
+    'py_reader', 'create_py_reader_by_data',
     'Preprocessor', 'load'
 ]
 
@@ -353,7 +355,9 @@ def open_recordio_file(filename,
                        lod_levels,
                        dtypes,
                        pass_num=1,
-                       for_parallel=True):
+                       for_parallel=True,
+                       num_threads=0,
+                       ordered=True):
     """
     ${comment}
 
@@ -365,6 +369,8 @@ def open_recordio_file(filename,
        pass_num(int): Number of passes to run.
        for_parallel(Bool): Set it as True if you are going to run
             subsequent operators in parallel.
+       num_threads(${num_threads_type}): ${num_threads_comment}
+       ordered(${ordered_type}): ${ordered_comment}
 
     Returns:
        ${out_comment}.
@@ -399,7 +405,9 @@ def open_recordio_file(filename,
             'shape_concat': shape_concat,
             'lod_levels': lod_levels,
             'filename': filename,
-            'ranks': ranks
+            'ranks': ranks,
+            'num_threads': num_threads,
+            'ordered': ordered
         })
 
     startup_var.desc.set_dtypes(dtypes)
@@ -413,6 +421,72 @@ def open_recordio_file(filename,
     return monkey_patch_reader_methods(main_prog_var)
 
 
+@templatedoc(op_type='create_master_reader')
+def open_master_files(filenames,
+                      shapes,
+                      lod_levels,
+                      dtypes,
+                      master_addr='',
+                      etcd_endpoints='',
+                      buf_size=1024):
+    """
+    ${comment}
+
+    Args:
+       filenames(${file_names_type}): ${file_names_comment}
+       shapes(list): List of tuples which declaring data shapes.
+       lod_levels(${lod_levels_type}): ${lod_levels_comment}.
+       dtypes(list): List of strs which declaring data type.
+       master_addr(${master_addr_type}): ${master_addr_comment}
+       etcd_endpoints(${etcd_endpoints_type}): ${etcd_endpoints_comment}
+       buf_size(${buf_size_type}): ${buf_size_comment}
+
+    Returns:
+       ${out_comment}.
+
+    Examples:
+
+        >>> import paddle.fluid as fluid
+        >>> reader = fluid.layers.io.open_master_files(
+        >>>                               filenames=['./data-*.recordio'],
+        >>>                               shapes=[(3,224,224), (1)],
+        >>>                               lod_levels=[0, 0],
+        >>>                               dtypes=['float32', 'int64'],
+        >>>                               master_addr='127.0.0.1:8080')
+        >>> image, label = fluid.layers.io.read_file(reader)
+    """
+    dtypes = [convert_np_dtype_to_dtype_(dt) for dt in dtypes]
+    shape_concat = []
+    ranks = []
+
+    for shape in shapes:
+        shape_concat.extend(shape)
+        ranks.append(len(shape))
+
+    var_name = unique_name('open_master_files')
+
+    startup_blk = default_startup_program().current_block()
+    startup_var = startup_blk.create_var(name=var_name)
+    startup_blk.append_op(
+        type='create_master_reader',
+        outputs={'Out': [startup_var]},
+        attrs={
+            'shape_concat': shape_concat,
+            'lod_levels': lod_levels,
+            'ranks': ranks,
+            'file_names': filenames,
+            'master_addr': master_addr,
+            'etcd_endpoints': etcd_endpoints,
+            'buf_size': buf_size
+        })
+
+    startup_var.desc.set_dtypes(dtypes)
+    startup_var.persistable = True
+    main_prog_var = _copy_reader_var_(default_main_program().current_block(),
+                                      startup_var)
+    return monkey_patch_reader_methods(main_prog_var)
+
+
 def random_data_generator(low, high, shapes, lod_levels, for_parallel=True):
     """
     Create a uniform random data generator
@@ -477,6 +551,29 @@ def random_data_generator(low, high, shapes, lod_levels, for_parallel=True):
     return monkey_patch_reader_methods(main_prog_var)
 
 
+def _to_lod_tensor_(item):
+    if isinstance(item, core.LoDTensor):
+        return item
+    tensor = core.LoDTensor()
+    if isinstance(item, np.ndarray) and item.flags['C_CONTIGUOUS']:
+        # Sending copies the data into the shared memory, so share the array.
+        tensor._share_data_with_array(item)
+    else:
+        tensor.set(item, core.CPUPlace())
+    return tensor
+
+
+def _multiprocess_provider_worker_(provider, segment_names, segment_size,
+                                   free_fd, ready_fd):
+    sender = core.SharedMemorySender(segment_names, segment_size, free_fd,
+                                     ready_fd)
+    try:
+        for tensors in provider():
+            sender.send([_to_lod_tensor_(item) for item in tensors])
+    finally:
+        sender.close()
+
+
 def _py_reader(capacity,
                shapes,
                dtypes,
@@ -557,6 +654,9 @@ def _py_reader(capacity,
     reader.thread = None
     reader.tensor_provider = None
     reader.exited = False
+    reader.multiprocess_providers = None
+    reader.receiver = None
+    reader.workers = []
 
     def start_provide_thread(func):
         def __provider_thread__():
@@ -581,8 +681,47 @@ def _py_reader(capacity,
         reader.thread.daemon = True
         reader.thread.start()
 
+    def start_provide_processes(providers, num_segments, segment_size):
+        reader.receiver = core.SharedMemoryReceiver(
+            feed_queue, num_segments, segment_size, len(providers))
+        reader.receiver.start()
+        args = (reader.receiver.segment_names(),
+                reader.receiver.segment_size(), reader.receiver.free_fd(),
+                reader.receiver.ready_fd())
+        for provider in providers:
+            worker = multiprocessing.Process(
+                target=_multiprocess_provider_worker_,
+                args=(provider, ) + args)
+            worker.daemon = True
+            worker.start()
+            reader.workers.append(worker)
+
+    def stop_provide_processes():
+        for worker in reader.workers:
+            worker.terminate()
+        for worker in reader.workers:
+            worker.join()
+        reader.workers = []
+        # The batches in the queue keep the shared memory alive.
+        reader.receiver.stop()
+        reader.receiver = None
+
     def __set_tensor_provider__(func):
         reader.tensor_provider = func
+        reader.multiprocess_providers = None
+
+    def __set_multiprocess_tensor_provider__(providers,
+                                             num_segments=None,
+                                             segment_size=64 << 20):
+        if not isinstance(providers, (list, tuple)) or len(providers) == 0:
+            raise TypeError("providers should be a non-empty list of "
+                            "tensor providers")
+        if num_segments is None:
+            # The queue, the double buffer and every worker hold segments.
+            num_segments = capacity + len(providers) + 2
+        reader.multiprocess_providers = (list(providers), num_segments,
+                                         segment_size)
+        reader.tensor_provider = None
 
     def __set_paddle_reader__(paddle_reader):
         with program_guard(Program(), Program()):
@@ -614,16 +753,23 @@ def _py_reader(capacity,
 
     def __reset__():
         current_reset_method()
+        if reader.receiver is not None:
+            stop_provide_processes()
         if reader.thread is not None and reader.tensor_provider is not None:
             reader.exited = True
             reader.thread.join()
             reader.exited = False
 
     def __start__():
-        start_provide_thread(reader.tensor_provider)
+        if reader.multiprocess_providers is not None:
+            start_provide_processes(*reader.multiprocess_providers)
+        else:
+            start_provide_thread(reader.tensor_provider)
 
     reader.reset = __reset__
     reader.decorate_tensor_provider = __set_tensor_provider__
+    reader.decorate_multiprocess_tensor_provider = \
+        __set_multiprocess_tensor_provider__
     reader.decorate_paddle_reader = __set_paddle_reader__
     reader.start = __start__
 
@@ -651,6 +797,15 @@ def py_reader(capacity,
     called when the pass ends and :code:`fluid.core.EOFException` raises.
     Note that :code:`Program.clone()` method cannot clone :code:`py_reader`.
 
+    The generators set by :code:`decorate_tensor_provider()` run in a Python
+    thread, whose preprocessing is bound by the GIL. On Linux and macOS,
+    :code:`decorate_multiprocess_tensor_provider(providers, num_segments=None,
+    segment_size=64 << 20)` runs each of the tensor providers in a forked
+    process instead, which sends the batches to the reader through a pool of
+    :code:`num_segments` shared memory segments of :code:`segment_size` bytes,
+    so a batch must fit in a segment. The batches of all the providers are
+    interleaved, and the pass ends when every provider is exhausted.
+
     Args:
        capacity(int): The buffer capacity maintained by :code:`py_reader`.
        shapes(list|tuple): List of tuples which declaring data shapes.
@@ -829,7 +984,11 @@ def open_files(filenames,
                thread_num=None,
                buffer_size=None,
                pass_num=1,
-               is_test=None):
+               is_test=None,
+               trainer_id=0,
+               num_trainers=1,
+               split_files=False,
+               shuffle_chunks=False):
     """
     Open files
 
@@ -850,6 +1009,17 @@ def open_files(filenames,
             is used for testing, the order of data generated is same as the file
             order. Otherwise, it is not guaranteed the order of data is same
             between every epoch. [Default: False].
+       trainer_id(int): The id of this trainer, which reads only its shard of
+            the chunks of each file. [Default: 0].
+       num_trainers(int): The number of trainers sharding the chunks.
+            [Default: 1].
+       split_files(bool): Whether to split the files into :code:`thread_num`
+            readers of about the same number of records. [Default: False].
+       shuffle_chunks(bool): Whether to read the chunks of each file in a
+            random order every pass. [Default: False].
+
+       Sharding, splitting and shuffling the chunks need the files to be
+       written with :code:`with_index=True`.
 
     Returns:
        Variable: A Reader Variable via which we can get file data.
@@ -895,7 +1065,11 @@ def open_files(filenames,
         'ranks': ranks,
         'file_names': filenames,
         'thread_num': thread_num,
-        'buffer_size': buffer_size
+        'buffer_size': buffer_size,
+        'trainer_id': trainer_id,
+        'num_trainers': num_trainers,
+        'split_files': split_files,
+        'shuffle_chunks': shuffle_chunks
     }
     if is_test is not None:
         attrs['is_test'] = is_test
@@ -999,7 +1173,61 @@ def batch(reader, batch_size):
         'create_batch_reader', reader, {'batch_size': int(batch_size)})
 
 
-def double_buffer(reader, place=None, name=None):
+def bucket_batch(reader,
+                 batch_size,
+                 pool_size,
+                 max_tokens=0,
+                 length_slot=0,
+                 discard_leftover=True):
+    """
+    This layer is a reader decorator. It batches the instances of a reader
+    by their lengths, so that the sequences padded together have close
+    lengths, and the sequence models waste less computation on the padding.
+
+    The decorated reader sorts a pool of :attr:`pool_size` instances by
+    length, and cuts it into batches of at most :attr:`batch_size`
+    instances. If :attr:`max_tokens` is positive, a batch is also cut before
+    its instance number times its longest length exceeds :attr:`max_tokens`.
+    The batches of a pool are yielded in a shuffled order.
+
+    Args:
+        reader(Variable): The reader to be decorated.
+        batch_size(int): The most instances of a batch.
+        pool_size(int): How many instances are sorted by length together.
+            It should not be less than batch_size.
+        max_tokens(int): If positive, the bound of the padded size of the
+            batches. Default 0.
+        length_slot(int): The slot of the instances whose first dim is the
+            length of an instance. Default 0.
+        discard_leftover(bool): Whether to discard the instances that are
+            not enough for a batch at the end of the data. Default True.
+
+    Returns:
+        Variable: The reader which has been decorated with 'bucket batching'.
+
+    Examples:
+        .. code-block:: python
+
+            raw_reader = fluid.layers.io.open_files(
+                filenames=['./data.recordio'],
+                shapes=[(-1, 1), (-1, 1)],
+                lod_levels=[1, 0],
+                dtypes=['int64', 'int64'])
+            batch_reader = fluid.layers.bucket_batch(
+                reader=raw_reader, batch_size=64, pool_size=6400,
+                max_tokens=4096)
+    """
+    return __create_unshared_decorated_reader__(
+        'create_bucket_batch_reader', reader, {
+            'batch_size': int(batch_size),
+            'pool_size': int(pool_size),
+            'max_tokens': int(max_tokens),
+            'length_slot': int(length_slot),
+            'discard_leftover': bool(discard_leftover)
+        })
+
+
+def double_buffer(reader, place=None, name=None, buffer_size=None):
     """
     Wrap a double buffer reader. The data will copy to target place with a
     double buffer queue. If the target place is None, the place that executor
@@ -1011,6 +1239,9 @@ def double_buffer(reader, place=None, name=None):
             executor perform.
 
         name(str): Variable name. None if the user does not care.
+        buffer_size(int|None): The number of the batches buffered, including
+            the one being computed, which is 3 by default. With 3 buffers, the
+            next batch is copied to the GPU while the one after it is read.
 
     Returns:
         wrapped reader with double buffer.
@@ -1026,10 +1257,57 @@ def double_buffer(reader, place=None, name=None):
     attrs = dict()
     if place is not None:
         attrs['place'] = str(place).upper()
+    if buffer_size is not None:
+        attrs['buffer_size'] = int(buffer_size)
     return __create_unshared_decorated_reader__(
         'create_double_buffer_reader', reader, attrs, name=name)
 
 
+def work_stealing_prefetch(reader, place_num, buffer_size=2):
+    """
+    This layer is a reader decorator for ParallelExecutor. It prefetches the
+    batches of a reader into a queue per place, so that the places do not
+    wait for each other to read, when the data or the speeds of the places
+    are uneven.
+
+    Each place reads the batches of its own queue, and only when it is
+    empty, steals a whole batch from the longest queue of the other places.
+    The places read the batches in an order decided at run time, so each
+    batch is read by one place, but not by a fixed one.
+
+    The prefetched batches are held until they are read, so the reader
+    should not be a double buffer reader, which reuses the memory of its
+    batches. The batches are on CPU, and are copied to the places by the
+    ops which read them.
+
+    Args:
+        reader(Variable): The reader to be decorated.
+        place_num(int): The number of the places of ParallelExecutor.
+        buffer_size(int): The number of the batches prefetched for each
+            place. Default 2.
+
+    Returns:
+        Variable: The reader which has been decorated with 'work stealing
+        prefetching'.
+
+    Examples:
+        .. code-block:: python
+
+            py_reader = fluid.layers.py_reader(capacity=64,
+                                               shapes=[(-1, 784), (-1, 1)],
+                                               dtypes=['float32', 'int64'],
+                                               use_double_buffer=False)
+            reader = fluid.layers.work_stealing_prefetch(
+                py_reader, place_num=fluid.core.get_cuda_device_count())
+            img, label = fluid.layers.read_file(reader)
+    """
+    return __create_unshared_decorated_reader__(
+        'create_work_stealing_reader', reader, {
+            'place_num': int(place_num),
+            'buffer_size': int(buffer_size)
+        })
+
+
 def multi_pass(reader, pass_num):
     return __create_shared_decorated_reader__(
         'create_multi_pass_reader', reader, {'pass_num': int(pass_num)})
@@ -128,15 +128,16 @@ def auc(input,
     batch_auc_out = helper.create_variable_for_type_inference(dtype="float64")
     # make tp, tn, fp, fn persistable, so that can accumulate all batches.
 
-    # for batch auc
+    # for batch auc, the histograms of the last slide_steps batches, their
+    # sum and the number of the batches
+    if slide_steps == 0:
+        batch_stat_shape = [1, num_thresholds + 1]
+    else:
+        batch_stat_shape = [(1 + slide_steps) * (num_thresholds + 1) + 1]
     batch_stat_pos = helper.create_global_variable(
-        persistable=True,
-        dtype='int64',
-        shape=[slide_steps, num_thresholds + 1])
+        persistable=True, dtype='int64', shape=batch_stat_shape)
     batch_stat_neg = helper.create_global_variable(
-        persistable=True,
-        dtype='int64',
-        shape=[slide_steps, num_thresholds + 1])
+        persistable=True, dtype='int64', shape=batch_stat_shape)
 
     # for global auc
     stat_pos = helper.create_global_variable(
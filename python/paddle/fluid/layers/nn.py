@@ -21,6 +21,7 @@ import numpy as np
 import six
 import os
 import inspect
+import atexit
 from ..layer_helper import LayerHelper
 from ..initializer import Normal, Constant
 from ..framework import Variable, OpProtoHolder
@@ -116,6 +117,8 @@ __all__ = [
     'scatter',
     'sequence_scatter',
     'random_crop',
+    'decode_jpeg',
+    'crop_resize_normalize',
     'mean_iou',
     'relu',
     'selu',
@@ -172,6 +175,7 @@ __all__ = [
     'affine_channel',
     'similarity_focus',
     'hash',
+    'hash_embedding',
     'grid_sampler',
     'log_loss',
     'add_position_encoding',
@@ -304,7 +308,8 @@ def embedding(input,
               is_distributed=False,
               padding_idx=None,
               param_attr=None,
-              dtype='float32'):
+              dtype='float32',
+              is_sharded=False):
     """
     **Embedding Layer**
 
@@ -329,6 +334,12 @@ def embedding(input,
             :math:`size[0] + dim`.
         param_attr(ParamAttr): Parameters for this layer
         dtype(np.dtype|core.VarDesc.VarType|str): The type of data : float32, float_16, int etc
+        is_sharded(bool): Whether to split the rows of the table between the
+            devices of ParallelExecutor instead of keeping a copy on each
+            device, for the tables too large for one device. The ids and the
+            embeddings are exchanged between the devices, and the update is
+            always sparse. Only the AllReduce strategy of a single trainer is
+            supported.
 
     Returns:
         Variable: The tensor variable storing the embeddings of the \
@@ -343,7 +354,8 @@ def embedding(input,
     """
 
     helper = LayerHelper('embedding', **locals())
-    remote_prefetch = is_sparse and (not is_distributed)
+    remote_prefetch = is_sparse and (not is_distributed) and (not is_sharded)
+    is_sparse = is_sparse or is_sharded
     if remote_prefetch:
         assert is_sparse is True and is_distributed is False
     w = helper.create_parameter(
@@ -360,7 +372,8 @@ def embedding(input,
             'is_sparse': is_sparse,
             'is_distributed': is_distributed,
             'remote_prefetch': remote_prefetch,
-            'padding_idx': padding_idx
+            'padding_idx': padding_idx,
+            'is_sharded': is_sharded
         })
     return tmp
 
@@ -537,7 +550,11 @@ def lstm(input,
 
 
     Args:
-        input (Variable): LSTM input tensor, shape MUST be ( seq_len x batch_size x input_size )
+        input (Variable): LSTM input tensor, shape MUST be ( seq_len x batch_size x input_size ),
+                       or a LoDTensor of shape ( total_len x input_size ) with lod_level 1,
+                       whose sequences are run by the time steps without the padding. The
+                       longest sequence CAN NOT be longer than max_len, and batch_size of
+                       init_h and init_c is the number of the sequences
         init_h(Variable): The initial hidden state of the LSTM
                        This is a tensor with shape ( num_layers x batch_size x hidden_size)
                        if is_bidirec = True, shape should be ( num_layers*2 x batch_size x hidden_size)
@@ -1217,7 +1234,8 @@ def dropout(x,
             is_test=False,
             seed=None,
             name=None,
-            dropout_implementation="downgrade_in_infer"):
+            dropout_implementation="downgrade_in_infer",
+            mask_as_bits=False):
     """
     Computes dropout.
 
@@ -1255,6 +1273,9 @@ def dropout(x,
 
                                            (mask is a tensor same shape with input, value is 0 or 1
                                            ratio of 0 is dropout_prob)
+        mask_as_bits (bool): Whether to keep the mask for the backward pass as
+                             a bit per unit instead of a tensor of the shape
+                             and data type of `x`, which saves memory.
 
 
     Returns:
@@ -1271,7 +1292,8 @@ def dropout(x,
     helper = LayerHelper('dropout', **locals())
     out = helper.create_variable_for_type_inference(dtype=x.dtype)
     mask = helper.create_variable_for_type_inference(
-        dtype=x.dtype, stop_gradient=True)
+        dtype=core.VarDesc.VarType.UINT8 if mask_as_bits else x.dtype,
+        stop_gradient=True)
 
     if (seed is None or seed == 0) and helper.main_program.random_seed != 0:
         seed = helper.main_program.random_seed
@@ -1287,6 +1309,7 @@ def dropout(x,
             'fix_seed': seed is not None,
             'seed': seed if seed is not None else 0,
             'dropout_implementation': dropout_implementation,
+            'mask_as_bits': mask_as_bits,
         })
     return out
 
@@ -2361,7 +2384,8 @@ def pool2d(input,
            use_cudnn=True,
            ceil_mode=False,
            name=None,
-           exclusive=True):
+           exclusive=True,
+           data_format="NCHW"):
     """
     ${comment}
 
@@ -2387,6 +2411,10 @@ def pool2d(input,
                         layer will be named automatically.
         exclusive (bool): Whether to exclude padding points in average pooling
                           mode, default is true
+        data_format (str): The data format of the input and the output,
+                          "NCHW" or "NHWC". The input of "NHWC" is pooled
+                          over its contiguous channels without cuDNN.
+                          Default: "NCHW".
 
     Returns:
         Variable: The pooling result.
@@ -2395,6 +2423,7 @@ def pool2d(input,
         ValueError: If 'pool_type' is not "max" nor "avg"
         ValueError: If 'global_pooling' is False and 'pool_size' is -1
         ValueError: If 'use_cudnn' is not a bool value.
+        ValueError: If 'data_format' is not "NCHW" nor "NHWC".
 
     Examples:
 
@@ -2426,6 +2455,11 @@ def pool2d(input,
     if not isinstance(use_cudnn, bool):
         raise ValueError("use_cudnn should be True or False")
 
+    if data_format not in ["NCHW", "NHWC"]:
+        raise ValueError(
+            "Unknown data_format: '%s'. It can only be 'NCHW' or 'NHWC'." %
+            str(data_format))
+
     l_type = 'pool2d'
 
     helper = LayerHelper(l_type, **locals())
@@ -2446,6 +2480,7 @@ def pool2d(input,
             "ceil_mode": ceil_mode,
             "use_mkldnn": False,
             "exclusive": exclusive,
+            "data_format": data_format,
         })
 
     return pool_out
@@ -4863,7 +4898,12 @@ def ctc_greedy_decoder(input, blank, name=None):
     return ctc_out
 
 
-def warpctc(input, label, blank=0, norm_by_times=False, use_cudnn=False):
+def warpctc(input,
+            label,
+            blank=0,
+            norm_by_times=False,
+            use_cudnn=False,
+            use_native=False):
     """
     An operator integrating the open source Warp-CTC library
     (https://github.com/baidu-research/warp-ctc)
@@ -4889,6 +4929,10 @@ def warpctc(input, label, blank=0, norm_by_times=False, use_cudnn=False):
          There is no need to normalize the gradients if warpctc layer was
          follewed by a mean_op.
        use_cudnn (bool, default false): Whether to use cudnn.
+       use_native (bool, default false): Whether to compute the loss by the
+         native CTC of the variable-length sequences instead of Warp-CTC,
+         which needs no padding of the input to the max sequence length.
+         It is ignored if use_cudnn is True.
 
     Returns:
         Variable: The Connectionist Temporal Classification (CTC) loss,
@@ -4915,7 +4959,8 @@ def warpctc(input, label, blank=0, norm_by_times=False, use_cudnn=False):
         attrs={
             'blank': blank,
             'norm_by_times': norm_by_times,
-            'use_cudnn': use_cudnn
+            'use_cudnn': use_cudnn,
+            'use_native': use_native
         })
     return loss_out
 
@@ -6528,12 +6573,14 @@ def image_resize(input,
                  scale=None,
                  name=None,
                  resample='BILINEAR',
-                 actual_shape=None):
+                 actual_shape=None,
+                 data_format='NCHW'):
     """
     **Resize a Batch of Images**
 
     The input must be a tensor of the shape (num_batches, channels, in_h, in_w),
-    and the resizing only applies on the last two dimensions(hight and width).
+    or (num_batches, in_h, in_w, channels) of the data_format NHWC, and the
+    resizing only applies on the dimensions of the hight and the width.
 
     Supporting resample methods:
 
@@ -6570,10 +6617,15 @@ def image_resize(input,
                                 set, otherwise errors would be occured in graph
                                 constructing stage.
                                 Default: None
+        data_format(str): The data format of the input and the output,
+                          'NCHW' or 'NHWC'. The images of NHWC are resized
+                          over their contiguous channels.
+                          Default: 'NCHW'
 
     Returns:
         Variable: The output is a 4-D tensor of the shape
-        (num_batches, channls, out_h, out_w).
+        (num_batches, channls, out_h, out_w), or (num_batches, out_h, out_w,
+        channels) of the data_format NHWC.
 
     Raises:
         TypeError: out_shape should be a list or tuple or Variable.
@@ -6582,6 +6634,7 @@ def image_resize(input,
                     or 'NEAREST' currently.
         ValueError: One of out_shape and scale must not be None.
         ValueError: out_shape length should be 2.
+        ValueError: data_format can only be 'NCHW' or 'NHWC'.
 
     Examples:
         .. code-block:: python
@@ -6599,6 +6652,8 @@ def image_resize(input,
     resample_type = resample_methods[resample]
     if out_shape is None and scale is None:
         raise ValueError("One of out_shape and scale must not be None.")
+    if data_format not in ['NCHW', 'NHWC']:
+        raise ValueError("data_format can only be 'NCHW' or 'NHWC'.")
     helper = LayerHelper('{}_interp'.format(resample_type), **locals())
     dtype = helper.input_dtype()
 
@@ -6623,8 +6678,9 @@ def image_resize(input,
         out_h = out_shape[0]
         out_w = out_shape[1]
     else:
-        out_h = int(input.shape[2] * scale)
-        out_w = int(input.shape[3] * scale)
+        h_axis = 1 if data_format == 'NHWC' else 2
+        out_h = int(input.shape[h_axis] * scale)
+        out_w = int(input.shape[h_axis + 1] * scale)
 
     if isinstance(actual_shape, Variable):
         inputs["OutSize"] = actual_shape
@@ -6638,7 +6694,8 @@ def image_resize(input,
         outputs={"Out": out},
         attrs={"out_h": out_h,
                "out_w": out_w,
-               "interp_method": resample_type})
+               "interp_method": resample_type,
+               "data_layout": data_format})
     return out
 
 
@@ -6647,7 +6704,8 @@ def resize_bilinear(input,
                     out_shape=None,
                     scale=None,
                     name=None,
-                    actual_shape=None):
+                    actual_shape=None,
+                    data_format='NCHW'):
     """
     Resize input by performing bilinear interpolation based on given
     output shape which specified by actual_shape, out_shape and scale
@@ -6685,6 +6743,8 @@ def resize_bilinear(input,
                                 set, otherwise errors would be occured in graph
                                 constructing stage.
                                 Default: None
+        data_format(str): The data format of the input and the output,
+                          'NCHW' or 'NHWC'. Default: 'NCHW'
 
     Returns:
         ${out_comment}.
@@ -6695,7 +6755,8 @@ def resize_bilinear(input,
             out = fluid.layers.resize_bilinear(input, out_shape=[12, 12])
     """
 
-    return image_resize(input, out_shape, scale, name, 'BILINEAR', actual_shape)
+    return image_resize(input, out_shape, scale, name, 'BILINEAR', actual_shape,
+                        data_format)
 
 
 @templatedoc(op_type="nearest_interp")
@@ -6703,7 +6764,8 @@ def resize_nearest(input,
                    out_shape=None,
                    scale=None,
                    name=None,
-                   actual_shape=None):
+                   actual_shape=None,
+                   data_format='NCHW'):
     """
     Resize input by performing nearest neighbor interpolation in both the
     3rd dimention(in height direction) and the 4th dimention(in width
@@ -6736,6 +6798,8 @@ def resize_nearest(input,
                                 set, otherwise errors would be occured in graph
                                 constructing stage.
                                 Default: None
+        data_format(str): The data format of the input and the output,
+                          'NCHW' or 'NHWC'. Default: 'NCHW'
 
     Returns:
         ${out_comment}.
@@ -6746,7 +6810,8 @@ def resize_nearest(input,
             out = fluid.layers.resize_nearest(input, out_shape=[12, 12])
     """
 
-    return image_resize(input, out_shape, scale, name, 'NEAREST', actual_shape)
+    return image_resize(input, out_shape, scale, name, 'NEAREST', actual_shape,
+                        data_format)
 
 
 def image_resize_short(input, out_short_len, resample='BILINEAR'):
@@ -6982,6 +7047,135 @@ def random_crop(x, shape, seed=None):
     return out
 
 
+def decode_jpeg(x, channels=3, fast_dct=False):
+    """
+    Decode a batch of JPEG files on CPU with libjpeg-turbo, which is loaded
+    at runtime.
+
+    The images may have different sizes, so their pixels are packed into one
+    LoDTensor, which can be cropped and resized by
+    :code:`crop_resize_normalize`.
+
+    Args:
+        x(Variable): The uint8 bytes of the JPEG files, each sequence of the
+            LoD is a file.
+        channels(int): 3 to decode RGB images, 1 for the grayscale ones.
+        fast_dct(bool): Use the fastest inverse DCT, which is less accurate.
+
+    Returns:
+        tuple: The uint8 pixels of shape [total pixels, channels] in the HWC
+        layout, whose sequences are the images, and the int32 height and
+        width of the images, of shape [number of images, 2].
+
+    Examples:
+        .. code-block:: python
+
+            data = fluid.layers.data(
+                name='data', shape=[1], dtype='uint8', lod_level=1)
+            pixels, image_shape = fluid.layers.decode_jpeg(data)
+    """
+    helper = LayerHelper("decode_jpeg", **locals())
+    out = helper.create_variable_for_type_inference('uint8')
+    image_shape = helper.create_variable_for_type_inference('int32')
+    helper.append_op(
+        type="decode_jpeg",
+        inputs={"X": x},
+        outputs={"Out": out,
+                 "ImageShape": image_shape},
+        attrs={"channels": channels,
+               "fast_dct": fast_dct})
+    return out, image_shape
+
+
+def crop_resize_normalize(x,
+                          image_shape,
+                          size,
+                          random_crop=False,
+                          crop_ratio=1.0,
+                          area_range=(0.08, 1.0),
+                          aspect_ratio_range=(3. / 4, 4. / 3),
+                          random_flip=False,
+                          mean=None,
+                          std=None,
+                          seed=None):
+    """
+    Crop the images of different sizes, resize the crops to the same size by
+    the bilinear interpolation, and normalize them in one kernel, which runs
+    on the place of the program, so the uint8 images are copied to the
+    device instead of the float ones.
+
+    Args:
+        x(Variable): The uint8 pixels of the images, as the output of
+            :code:`decode_jpeg`.
+        image_shape(Variable): The height and width of the images.
+        size(list|tuple): The height and width of the output images.
+        random_crop(bool): Crop a random region of the random area and aspect
+            ratio, as the Inception training, otherwise crop the center.
+        crop_ratio(float): The ratio of the sides of the center crop to the
+            image.
+        area_range(list|tuple): The range of the area ratio of the random
+            crops.
+        aspect_ratio_range(list|tuple): The range of the width / height of
+            the random crops.
+        random_flip(bool): Flip the images horizontally at random.
+        mean(list|float|None): The mean of the channels in [0, 255].
+        std(list|float|None): The std of the channels in [0, 255].
+        seed(int|None): The random seed. By default, the seed will get from
+            `random.randint(-65536, 65535)`.
+
+    Returns:
+        Variable: The float32 images of shape [N, C, height, width].
+
+    Examples:
+        .. code-block:: python
+
+            pixels, image_shape = fluid.layers.decode_jpeg(data)
+            image = fluid.layers.crop_resize_normalize(
+                pixels, image_shape, size=[224, 224], random_crop=True,
+                random_flip=True, mean=[123.675, 116.28, 103.53],
+                std=[58.395, 57.12, 57.375])
+    """
+    helper = LayerHelper("crop_resize_normalize", **locals())
+    out = helper.create_variable_for_type_inference('float32')
+
+    def to_list(value):
+        if value is None:
+            return []
+        if isinstance(value, (list, tuple)):
+            return [float(v) for v in value]
+        return [float(value)]
+
+    inputs = {"X": x, "ImageShape": image_shape}
+    outputs = {"Out": out}
+    attrs = {
+        "size": list(size),
+        "random_crop": random_crop,
+        "crop_ratio": float(crop_ratio),
+        "area_range": to_list(area_range),
+        "aspect_ratio_range": to_list(aspect_ratio_range),
+        "random_flip": random_flip,
+        "mean": to_list(mean),
+        "std": to_list(std)
+    }
+    if random_crop or random_flip:
+        if seed is None:
+            seed = np.random.randint(-65536, 65536)
+        attrs["startup_seed"] = seed
+        # The seed is updated by every run, as random_crop.
+        seed_var = helper.create_variable(
+            name=unique_name.generate("crop_resize_normalize_seed"),
+            dtype="int64",
+            persistable=True)
+        inputs["Seed"] = seed_var
+        outputs["SeedOut"] = seed_var
+    helper.append_op(
+        type="crop_resize_normalize",
+        inputs=inputs,
+        outputs=outputs,
+        attrs=attrs)
+    return out
+
+
 def log(x, name=None):
     """
     Calculates the natural log of the given input tensor, element-wise.
@@ -9262,6 +9456,60 @@ def hash(input, hash_size, num_hash=1, name=None):
     return out
 
 
+def hash_embedding(input,
+                   size,
+                   num_hash=1,
+                   is_sparse=False,
+                   param_attr=None,
+                   dtype='float32',
+                   name=None):
+    """
+    Looks up the embeddings of the hashes of the input, which is
+    :code:`embedding(hash(input, size[0], num_hash), size)` computed in one
+    op: the rows of the table are copied as the hashes are computed, and the
+    hashed ids are not written to a tensor in between.
+
+    Args:
+        input (Variable): The int32 or int64 LoDTensor [N, M] to be hashed,
+            whose rows are hashed as :code:`hash` does.
+        size (tuple|list): The shape [hash_size, D] of the table. The
+            hashes are in :math:`[0, hash\_size - 1]`.
+        num_hash (int): The times of hash of a row, default 1.
+        is_sparse (bool): Whether the gradient of the table is sparse,
+            default False.
+        param_attr (ParamAttr): The parameter attribute of the table.
+        dtype (str): The data type of the table, default float32.
+        name (str, default None): The name of this layer.
+
+    Returns:
+        Variable: The LoDTensor [N, num_hash, D] of the embeddings, with the
+        LoD of the input.
+
+    Examples:
+        .. code-block:: python
+
+            x = fluid.layers.data(name='x', shape=[1], dtype='int32',
+                                  lod_level=1)
+            emb = fluid.layers.hash_embedding(
+                input=x, size=[100000, 16], num_hash=4)
+    """
+    helper = LayerHelper('hash_embedding', **locals())
+    w = helper.create_parameter(
+        attr=helper.param_attr, shape=size, dtype=dtype, is_bias=False)
+    out = helper.create_variable_for_type_inference(dtype)
+    helper.append_op(
+        type='fused_hash_embedding',
+        inputs={'X': input,
+                'W': w},
+        outputs={'Out': out},
+        attrs={
+            'num_hash': num_hash,
+            'mod_by': size[0],
+            'is_sparse': is_sparse
+        })
+    return out
+
+
 @templatedoc()
 def grid_sampler(x, grid, name=None):
     """
@@ -9635,24 +9883,30 @@ class PyFuncRegistry(object):
         if not isinstance(func_ret, (list, tuple)):
             func_ret = (func_ret, )
 
+        # The numpy arrays are copied into the output tensors by the op,
+        # which reuses their buffers across the calls.
         ret = []
         for each_ret in func_ret:
-            if each_ret is None or isinstance(each_ret, core.LoDTensor):
+            if each_ret is None or isinstance(each_ret,
+                                              (core.LoDTensor, np.ndarray)):
                 ret.append(each_ret)
-                continue
+            else:
+                ret.append(np.array(each_ret))
 
-            if not isinstance(each_ret, np.ndarray):
-                each_ret = np.array(each_ret)
+        return tuple(ret)
 
-            tensor = core.LoDTensor()
-            tensor.set(each_ret, core.CPUPlace())
-            ret.append(tensor)
 
-        return tuple(ret)
+_py_func_async_exit_registered = False
 
 
 @templatedoc()
-def py_func(func, x, out, backward_func=None, skip_vars_in_backward_input=None):
+def py_func(func,
+            x,
+            out,
+            backward_func=None,
+            skip_vars_in_backward_input=None,
+            zero_copy=False,
+            run_async=False):
     """
     PyFunc Operator.
 
@@ -9674,7 +9928,8 @@ def py_func(func, x, out, backward_func=None, skip_vars_in_backward_input=None):
 
     This function can also be used to debug the running network. User can
     add a :code:`py_func` operator without output, and print input
-    :code:`x` inside :code:`func`.
+    :code:`x` inside :code:`func`. Such an operator can be run with
+    :code:`run_async=True`, so that the step does not wait for :code:`func`.
 
     Args:
         func (callable): forward Python function.
@@ -9689,6 +9944,16 @@ def py_func(func, x, out, backward_func=None, skip_vars_in_backward_input=None):
             These variables must be any of :code:`x` and :code:`out`.
             If set, these vars would not be inputs of :code:`backward_func`,
             Only useful when :code:`backward_func` is not None. Default None.
+        zero_copy (bool): whether to pass the inputs to :code:`func` and
+            :code:`backward_func` as read-only numpy arrays on the memory of
+            the tensors, instead of :code:`LoDTensor`. The LoD of the inputs
+            is not passed. Default False.
+        run_async (bool): whether to call :code:`func` on a dedicated Python
+            thread without waiting for it, which needs :code:`out` and
+            :code:`backward_func` to be None. The calls run in order, and
+            the pending ones can be waited for by
+            :code:`fluid.core._wait_py_func_calls()`, which is also called
+            at exit. Default False.
 
     Returns:
         out (Variable|list(Variable)|tuple(Variable)): input :code:`out`
@@ -9752,6 +10017,15 @@ def py_func(func, x, out, backward_func=None, skip_vars_in_backward_input=None):
         raise TypeError(
             'Output must be Variable/list(Variable)/tuple(Variable)')
 
+    if run_async:
+        if len(out_list) > 0 or backward_func is not None:
+            raise ValueError(
+                'Only py_func without out and backward_func can run_async')
+        global _py_func_async_exit_registered
+        if not _py_func_async_exit_registered:
+            atexit.register(core._wait_py_func_calls)
+            _py_func_async_exit_registered = True
+
     fwd_func_id = PyFuncRegistry(func).id
     bwd_func_id = PyFuncRegistry(
         backward_func).id if backward_func is not None else -1
@@ -9785,7 +10059,9 @@ def py_func(func, x, out, backward_func=None, skip_vars_in_backward_input=None):
         attrs={
             'forward_callable_id': fwd_func_id,
             'backward_callable_id': bwd_func_id,
-            'backward_skip_vars': list(backward_skip_vars)
+            'backward_skip_vars': list(backward_skip_vars),
+            'zero_copy': zero_copy,
+            'run_async': run_async
         })
     return out
 
@@ -0,0 +1,135 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+from . import core
+from . import framework
+from . import executor
+
+__all__ = ['PipelineExecutor']
+
+
+class PipelineExecutor(object):
+    """
+    PipelineExecutor trains a program whose layers are placed on several
+    devices by :code:`fluid.device_guard`, as the pipeline of GPipe. The
+    layers on a device are a stage. Each batch is split into
+    :code:`num_micro_batches` micro-batches, and the stages run on different
+    micro-batches at the same time. The gradients of the micro-batches are
+    averaged before the optimizer updates the parameters once in each batch,
+    so the result is the same as training the whole batch on one device.
+
+    The layers without a device run on the stage of their inputs. A layer can
+    only read the outputs of the previous stages, and the parameters of a
+    stage are only updated by its optimize ops.
+
+    Args:
+        num_micro_batches(int): The number of micro-batches of each batch,
+            which should not be more than the batch size.
+        main_program(Program): The program to run, the default main program
+            if it is None.
+        place(fluid.CPUPlace|fluid.CUDAPlace): The place of the scope, where
+            the startup program has initialized the parameters, also the
+            place of the layers without the device and of the learning rate
+            scheduler. The default is the CPUPlace.
+        scope(Scope): The scope of the parameters, the global scope if it is
+            None.
+
+    Examples:
+        .. code-block:: python
+
+          with fluid.device_guard("gpu:0"):
+              hidden = fluid.layers.fc(input=image, size=1024, act='relu')
+          with fluid.device_guard("gpu:1"):
+              predict = fluid.layers.fc(input=hidden, size=10, act='softmax')
+              cost = fluid.layers.cross_entropy(input=predict, label=label)
+              avg_cost = fluid.layers.mean(cost)
+          fluid.optimizer.SGD(learning_rate=0.01).minimize(avg_cost)
+
+          place = fluid.CUDAPlace(0)
+          fluid.Executor(place).run(fluid.default_startup_program())
+          exe = fluid.PipelineExecutor(num_micro_batches=4, place=place)
+          loss, = exe.run(fetch_list=[avg_cost.name],
+                          feed={'image': image_data, 'label': label_data})
+          exe.sync_parameters()
+    """
+
+    def __init__(self,
+                 num_micro_batches,
+                 main_program=None,
+                 place=None,
+                 scope=None):
+        if num_micro_batches <= 0:
+            raise ValueError("num_micro_batches should be positive.")
+        main = main_program if main_program is not None else \
+            framework.default_main_program()
+        self._scope = scope if scope is not None else executor.global_scope()
+        p = core.Place()
+        p.set_place(place if place is not None else core.CPUPlace())
+        self._executor = core.PipelineExecutor(main.desc, p, self._scope,
+                                               num_micro_batches)
+
+    def run(self, fetch_list, feed=None, return_numpy=True):
+        """
+        Run a batch by the pipeline.
+
+        Args:
+            fetch_list(list): The names of the variables to fetch. The
+                variables of the micro-batches are concatenated along the
+                batch.
+            feed(dict): The name and the value of the inputs, which are
+                split into the micro-batches.
+            return_numpy(bool): Whether to convert the fetched tensors to
+                numpy arrays. Default True.
+
+        Returns:
+            List: The fetched results.
+        """
+        if feed is not None:
+            if not isinstance(feed, dict):
+                raise TypeError("feed should be a dict of the inputs.")
+            feed_tensor_dict = dict()
+            for feed_name in feed:
+                feed_tensor = feed[feed_name]
+                if not isinstance(feed_tensor, core.LoDTensor):
+                    feed_tensor = core.LoDTensor()
+                    # split on CPU, then copy to the places of the stages
+                    feed_tensor.set(feed[feed_name], core.CPUPlace())
+                feed_tensor_dict[feed_name] = feed_tensor
+            self._executor.feed_and_split_tensor_into_micro_batches(
+                feed_tensor_dict)
+
+        fetch_list = [
+            var.name if isinstance(var, framework.Variable) else var
+            for var in fetch_list
+        ]
+        fetch_var_name = 'fetch'
+        self._executor.run(fetch_list, fetch_var_name)
+        arr = self._scope.find_var(fetch_var_name).get_lod_tensor_array()
+
+        if return_numpy:
+            return executor.as_numpy(arr)
+
+        return [arr[i] for i in range(len(arr))]
+
+    def sync_parameters(self):
+        """
+        Copy the parameters updated on other places than the place of the
+        scope back to the scope, e.g. before saving them.
+        """
+        self._executor.sync_parameters()
+
+    @property
+    def num_stages(self):
+        return self._executor.num_stages()
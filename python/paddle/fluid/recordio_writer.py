@@ -25,8 +25,10 @@ __all__ = [
 @contextlib.contextmanager
 def create_recordio_writer(filename,
                            compressor=core.RecordIOWriter.Compressor.Snappy,
-                           max_num_records=1000):
-    writer = core.RecordIOWriter(filename, compressor, max_num_records)
+                           max_num_records=1000,
+                           with_index=False):
+    writer = core.RecordIOWriter(filename, compressor, max_num_records,
+                                 with_index)
     yield writer
     writer.close()
 
@@ -37,7 +39,8 @@ def convert_reader_to_recordio_file(
         feeder,
         compressor=core.RecordIOWriter.Compressor.Snappy,
         max_num_records=1000,
-        feed_order=None):
+        feed_order=None,
+        with_index=False):
     """
     Convert a Python Reader to a recordio file.
 
@@ -70,6 +73,8 @@ def convert_reader_to_recordio_file(
         max_num_records(int): Maximum number of records in one chuck. Each record
             is each return value from reader function
         feed_order(list): The order of variable names that the reader returns
+        with_index(bool): Whether to write the chunk index at the end of the
+            file, which makes the readers able to shard and shuffle the chunks.
 
     Returns:
         int: the number of record that saved.
@@ -77,8 +82,8 @@ def convert_reader_to_recordio_file(
     if feed_order is None:
         feed_order = feeder.feed_names
     counter = 0
-    with create_recordio_writer(filename, compressor,
-                                max_num_records) as writer:
+    with create_recordio_writer(filename, compressor, max_num_records,
+                                with_index) as writer:
         for batch in reader_creator():
             res = feeder.feed(batch)
             for each in feed_order:
@@ -95,7 +100,8 @@ def convert_reader_to_recordio_files(
         feeder,
         compressor=core.RecordIOWriter.Compressor.Snappy,
         max_num_records=1000,
-        feed_order=None):
+        feed_order=None,
+        with_index=False):
     """
     convert a python reader to many recordio files.
 
@@ -119,8 +125,8 @@ def convert_reader_to_recordio_files(
         lines.append(batch)
         if idx >= batch_per_file and idx % batch_per_file == 0:
             filename = "%s-%05d%s" % (f_name, f_idx, f_ext)
-            with create_recordio_writer(filename, compressor,
-                                        max_num_records) as writer:
+            with create_recordio_writer(filename, compressor, max_num_records,
+                                        with_index) as writer:
                 for l in lines:
                     res = feeder.feed(l)
                     for each in feed_order:
@@ -314,7 +314,7 @@ class TestSparseAdamOp(unittest.TestCase):
             np_array = np_array.reshape([np_array.size])
 
             for i in range(np_array.size):
-                self.assertLess((actual[i] - np_array[i]), 0.00001)
+                self.assertLess(abs(actual[i] - np_array[i]), 0.00001)
 
     def test_sparse_adam(self):
         places = [core.CPUPlace()]
@@ -325,5 +325,72 @@ class TestSparseAdamOp(unittest.TestCase):
                 self.check_with_place(place, lazy_mode)
 
 
+class TestSparseAdamOpLazyMode(unittest.TestCase):
+    def check_with_place(self, place):
+        scope = core.Scope()
+        height = 10
+        row_numel = 12
+        # unsorted rows with the duplicated row 7
+        rows = [7, 0, 4, 7]
+        attrs = {'epsilon': 1e-4, 'beta1': 0.78, 'beta2': 0.836}
+        inputs = {
+            "Param": np.random.random((height, row_numel)).astype("float32"),
+            "Moment1": np.random.random((height, row_numel)).astype("float32"),
+            "Moment2": np.random.random((height, row_numel)).astype("float32"),
+            'Beta1Pow': np.array([0.78**10]).astype("float32"),
+            'Beta2Pow': np.array([0.836**10]).astype("float32"),
+            "LearningRate": np.full((1), 2.0).astype("float32")
+        }
+        np_grad = np.random.random((len(rows), row_numel)).astype("float32")
+
+        grad_selected_rows = scope.var('Grad').get_selected_rows()
+        grad_selected_rows.set_height(height)
+        grad_selected_rows.set_rows(rows)
+        grad_selected_rows.get_tensor().set(np_grad, place)
+        for key, np_array in inputs.items():
+            scope.var(key).get_tensor().set(np_array, place)
+
+        # update in place as the optimizer does
+        adam_op = Operator(
+            "adam",
+            Param="Param",
+            Grad="Grad",
+            Moment1="Moment1",
+            Moment2="Moment2",
+            LearningRate="LearningRate",
+            Beta1Pow="Beta1Pow",
+            Beta2Pow="Beta2Pow",
+            ParamOut="Param",
+            Moment1Out="Moment1",
+            Moment2Out="Moment2",
+            lazy_mode=True,
+            **attrs)
+        adam_op.run(scope, place)
+
+        merged_rows = [0, 4, 7]
+        merged_grad = np.array(
+            [np_grad[1], np_grad[2], np_grad[0] + np_grad[3]])
+        param_out, mom1, mom2 = adam_step_sparse(inputs, attrs, height,
+                                                 merged_rows, row_numel,
+                                                 merged_grad, True)
+        for key, expected in [("Param", param_out), ("Moment1", mom1),
+                              ("Moment2", mom2)]:
+            actual = np.array(scope.var(key).get_tensor())
+            for row_id in range(height):
+                if row_id not in merged_rows:
+                    # the rows not in the gradient are not touched
+                    expected[row_id] = inputs[key][row_id]
+            self.assertTrue(
+                np.allclose(
+                    actual, expected, atol=1e-5), key)
+
+    def test_sparse_adam_lazy_mode(self):
+        places = [core.CPUPlace()]
+        if core.is_compiled_with_cuda():
+            places.append(core.CUDAPlace(0))
+        for place in places:
+            self.check_with_place(place)
+
+
 if __name__ == "__main__":
     unittest.main()
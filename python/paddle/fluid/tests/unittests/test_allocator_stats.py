@@ -0,0 +1,49 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import os
+os.environ['FLAGS_enable_allocator_stats'] = '1'
+
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+
+class TestAllocatorStats(unittest.TestCase):
+    def check_place(self, place):
+        before = core.get_allocator_stats(place)
+        tensor = core.LoDTensor()
+        tensor.set(np.ones([1024, 1024], dtype='float32'), place)
+        after = core.get_allocator_stats(place)
+        self.assertGreater(after.num_allocs, before.num_allocs)
+        self.assertGreaterEqual(after.current_bytes, 4 * 1024 * 1024)
+        self.assertGreaterEqual(after.peak_bytes, after.current_bytes)
+        self.assertGreater(sum(after.size_histogram), 0)
+        ratio = after.fragmentation_ratio()
+        self.assertTrue(0 <= ratio <= 1)
+        self.assertTrue(len(str(after)) > 0)
+
+    def test_cpu(self):
+        self.check_place(core.CPUPlace())
+
+    def test_gpu(self):
+        if core.is_compiled_with_cuda():
+            self.check_place(core.CUDAPlace(0))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -27,8 +27,10 @@ class TestAucOp(OpTest):
         labels = np.random.randint(0, 2, (128, 1))
         num_thresholds = 200
 
-        stat_pos = np.zeros((num_thresholds + 1, )).astype("int64")
-        stat_neg = np.zeros((num_thresholds + 1, )).astype("int64")
+        num_pred_buckets = num_thresholds + 1
+        # the histogram of the batch, the sum and the number of the batches
+        stat_pos = np.zeros((2 * num_pred_buckets + 1, )).astype("int64")
+        stat_neg = np.zeros((2 * num_pred_buckets + 1, )).astype("int64")
 
         self.inputs = {
             'Predict': pred,
@@ -49,8 +51,103 @@ class TestAucOp(OpTest):
 
         self.outputs = {
             'AUC': np.array(python_auc.eval()),
-            'StatPosOut': np.array(python_auc._stat_pos),
-            'StatNegOut': np.array(python_auc._stat_neg)
+            'StatPosOut': np.concatenate(
+                [python_auc._stat_pos, python_auc._stat_pos, [1]]),
+            'StatNegOut': np.concatenate(
+                [python_auc._stat_neg, python_auc._stat_neg, [1]])
+        }
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestGlobalAucOp(OpTest):
+    def setUp(self):
+        self.op_type = "auc"
+        pred = np.random.random((128, 2)).astype("float32")
+        labels = np.random.randint(0, 2, (128, 1))
+        num_thresholds = 200
+
+        stat_pos = np.random.randint(0, 10, (1, num_thresholds + 1))
+        stat_neg = np.random.randint(0, 10, (1, num_thresholds + 1))
+
+        self.inputs = {
+            'Predict': pred,
+            'Label': labels,
+            "StatPos": stat_pos,
+            "StatNeg": stat_neg
+        }
+        self.attrs = {
+            'curve': 'ROC',
+            'num_thresholds': num_thresholds,
+            "slide_steps": 0
+        }
+
+        python_auc = metrics.Auc(name="auc",
+                                 curve='ROC',
+                                 num_thresholds=num_thresholds)
+        python_auc._stat_pos = stat_pos.reshape(-1).tolist()
+        python_auc._stat_neg = stat_neg.reshape(-1).tolist()
+        python_auc.update(pred, labels)
+
+        self.outputs = {
+            'AUC': np.array(python_auc.eval()),
+            'StatPosOut': np.array(python_auc._stat_pos).reshape(1, -1),
+            'StatNegOut': np.array(python_auc._stat_neg).reshape(1, -1)
+        }
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestSlideAucOp(OpTest):
+    def setUp(self):
+        self.op_type = "auc"
+        pred = np.random.random((128, 2)).astype("float32")
+        labels = np.random.randint(0, 2, (128, 1))
+        num_thresholds = 200
+        slide_steps = 3
+        num_pred_buckets = num_thresholds + 1
+
+        # 4 batches are seen, the next one replaces the second histogram.
+        ring_pos = np.random.randint(0, 10, (slide_steps, num_pred_buckets))
+        ring_neg = np.random.randint(0, 10, (slide_steps, num_pred_buckets))
+        stat_pos = np.concatenate(
+            [ring_pos.reshape(-1), ring_pos.sum(axis=0), [4]]).astype("int64")
+        stat_neg = np.concatenate(
+            [ring_neg.reshape(-1), ring_neg.sum(axis=0), [4]]).astype("int64")
+
+        self.inputs = {
+            'Predict': pred,
+            'Label': labels,
+            "StatPos": stat_pos,
+            "StatNeg": stat_neg
+        }
+        self.attrs = {
+            'curve': 'ROC',
+            'num_thresholds': num_thresholds,
+            "slide_steps": slide_steps
+        }
+
+        batch_auc = metrics.Auc(name="auc",
+                                curve='ROC',
+                                num_thresholds=num_thresholds)
+        batch_auc.update(pred, labels)
+        ring_pos[1] = batch_auc._stat_pos
+        ring_neg[1] = batch_auc._stat_neg
+
+        python_auc = metrics.Auc(name="auc",
+                                 curve='ROC',
+                                 num_thresholds=num_thresholds)
+        python_auc._stat_pos = ring_pos.sum(axis=0).tolist()
+        python_auc._stat_neg = ring_neg.sum(axis=0).tolist()
+
+        self.outputs = {
+            'AUC': np.array(python_auc.eval()),
+            'StatPosOut': np.concatenate(
+                [ring_pos.reshape(-1), ring_pos.sum(axis=0), [5]]),
+            'StatNegOut': np.concatenate(
+                [ring_neg.reshape(-1), ring_neg.sum(axis=0), [5]])
         }
 
     def test_check_output(self):
@@ -32,6 +32,7 @@ class BeamSearchOpTester(unittest.TestCase):
 
     def setUp(self):
         self.scope = core.Scope()
+        self.place = core.CPUPlace()
         self._create_ids()
         self._create_pre_scores()
         self._create_scores()
@@ -51,7 +52,7 @@ class BeamSearchOpTester(unittest.TestCase):
             level=0,
             beam_size=2,
             end_id=0, )
-        op.run(self.scope, core.CPUPlace())
+        op.run(self.scope, self.place)
         selected_ids = self.scope.find_var("selected_ids").get_tensor()
         selected_scores = self.scope.find_var("selected_scores").get_tensor()
         self.assertTrue(
@@ -91,5 +92,13 @@ class BeamSearchOpTester(unittest.TestCase):
         tensor.set_lod(self.lod)
 
 
+@unittest.skipIf(not core.is_compiled_with_cuda(),
+                 "core is not compiled with CUDA")
+class BeamSearchOpGPUTester(BeamSearchOpTester):
+    def setUp(self):
+        super(BeamSearchOpGPUTester, self).setUp()
+        self.place = core.CUDAPlace(0)
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -61,12 +61,16 @@ class TestBilinearInterpOp(OpTest):
     def setUp(self):
         self.out_size = None
         self.actual_shape = None
+        self.data_layout = 'NCHW'
         self.init_test_case()
         self.op_type = "bilinear_interp"
         input_np = np.random.random(self.input_shape).astype("float32")
 
         output_np = bilinear_interp_np(input_np, self.out_h, self.out_w,
                                        self.out_size, self.actual_shape)
+        if self.data_layout == 'NHWC':
+            input_np = np.transpose(input_np, (0, 2, 3, 1))
+            output_np = np.transpose(output_np, (0, 2, 3, 1))
         self.inputs = {'X': input_np}
         if self.out_size is not None:
             self.inputs['OutSize'] = self.out_size
@@ -75,7 +79,8 @@ class TestBilinearInterpOp(OpTest):
         self.attrs = {
             'out_h': self.out_h,
             'out_w': self.out_w,
-            'interp_method': self.interp_method
+            'interp_method': self.interp_method,
+            'data_layout': self.data_layout
         }
         self.outputs = {'Out': output_np}
 
@@ -153,6 +158,25 @@ class TestBilinearInterpActualShape(TestBilinearInterpOp):
         self.out_size = np.array([66, 40]).astype("int32")
 
 
+class TestBilinearInterpNHWC(TestBilinearInterpOp):
+    def init_test_case(self):
+        self.interp_method = 'bilinear'
+        self.input_shape = [2, 4, 9, 6]
+        self.out_h = 12
+        self.out_w = 5
+        self.data_layout = 'NHWC'
+
+
+class TestBilinearInterpNHWCOutSize(TestBilinearInterpOp):
+    def init_test_case(self):
+        self.interp_method = 'bilinear'
+        self.input_shape = [3, 3, 7, 8]
+        self.out_h = 4
+        self.out_w = 4
+        self.out_size = np.array([14, 16]).astype("int32")
+        self.data_layout = 'NHWC'
+
+
 class TestBilinearInterpOpUint8(OpTest):
     def setUp(self):
         self.out_size = None
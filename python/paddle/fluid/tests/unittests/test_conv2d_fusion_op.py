@@ -30,6 +30,7 @@ class TestConv2dFusionOp(OpTest):
         self.data_format = "AnyLayout"
         self.dtype = np.float32
         self.activation = 'relu'
+        self.activation_alpha = 0.0
         self.add_bias = True
         self.add_residual_data = True
         self.channels = None
@@ -72,9 +73,20 @@ class TestConv2dFusionOp(OpTest):
             self.inputs['Bias'] = OpTest.np_dtype_to_fluid_dtype(bias)
             self.output = self.output + bias.reshape((1, bias.size, 1, 1))
 
-        assert self.activation in ['relu', 'identity']
         if self.activation == 'relu':
             self.output = np.maximum(self.output, 0)
+        elif self.activation == 'relu6':
+            self.output = np.clip(self.output, 0, self.activation_alpha)
+        elif self.activation == 'leaky_relu':
+            self.output = np.where(self.output > 0, self.output,
+                                   self.activation_alpha * self.output)
+        elif self.activation == 'sigmoid':
+            self.output = 1 / (1 + np.exp(-self.output))
+        elif self.activation == 'tanh':
+            self.output = np.tanh(self.output)
+        else:
+            assert self.activation == 'identity'
+        self.output = self.output.astype(self.dtype)
 
         self.attrs = {
             'strides': self.stride,
@@ -84,6 +96,7 @@ class TestConv2dFusionOp(OpTest):
             'data_format': self.data_format,
             'exhaustive_search': self.exhaustive_search,
             'activation': self.activation,
+            'activation_alpha': self.activation_alpha,
             'split_channels': self.channels
         }
         self.outputs = {'Output': self.output}
@@ -165,6 +178,52 @@ class TestWithDilation(TestConv2dFusionOp):
         self.groups = 3
 
 
+class TestRelu6Activation(TestConv2dFusionOp):
+    def init_activation(self):
+        self.activation = 'relu6'
+        self.activation_alpha = 6.0
+
+
+class TestLeakyReluActivation(TestConv2dFusionOp):
+    def init_activation(self):
+        self.activation = 'leaky_relu'
+        self.activation_alpha = 0.1
+
+
+class TestSigmoidActivation(TestConv2dFusionOp):
+    def init_activation(self):
+        self.activation = 'sigmoid'
+
+
+class TestTanhActivation(TestConv2dFusionOp):
+    def init_activation(self):
+        self.activation = 'tanh'
+
+
+class TestDepthwiseConv(TestConv2dFusionOp):
+    def init_test_case(self):
+        self.pad = [1, 1]
+        self.stride = [2, 2]
+        self.input_size = [2, 4, 9, 9]  # NCHW
+        self.filter_size = [8, 1, 3, 3]
+
+    def init_group(self):
+        self.groups = 4
+
+    def init_activation(self):
+        self.activation = 'relu6'
+        self.activation_alpha = 6.0
+
+
+class TestDepthwiseConvWithoutResidual(TestDepthwiseConv):
+    def init_bias_residual(self):
+        self.add_residual_data = False
+
+    def init_activation(self):
+        self.activation = 'leaky_relu'
+        self.activation_alpha = 0.02
+
+
 class TestCUDNNExhaustiveSearch(TestConv2dFusionOp):
     def set_search_method(self):
         self.exhaustive_search = True
@@ -0,0 +1,135 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+def crop_resize_normalize(image, size, crop_ratio, mean, std):
+    height, width, channels = image.shape
+    out_h, out_w = size
+    box_h, box_w = height * crop_ratio, width * crop_ratio
+    box_y, box_x = (height - box_h) / 2, (width - box_w) / 2
+    out = np.zeros([channels, out_h, out_w], dtype='float32')
+    for oy in range(out_h):
+        sy = box_y + (oy + 0.5) * box_h / out_h - 0.5
+        sy = min(max(sy, 0), height - 1)
+        y0 = int(sy)
+        y1 = min(y0 + 1, height - 1)
+        ly = sy - y0
+        for ox in range(out_w):
+            sx = box_x + (ox + 0.5) * box_w / out_w - 0.5
+            sx = min(max(sx, 0), width - 1)
+            x0 = int(sx)
+            x1 = min(x0 + 1, width - 1)
+            lx = sx - x0
+            value = (1 - ly) * ((1 - lx) * image[y0, x0] + lx * image[y0, x1]
+                                ) + ly * ((1 - lx) * image[y1, x0] +
+                                          lx * image[y1, x1])
+            out[:, oy, ox] = (value - mean) / std
+    return out
+
+
+class TestCropResizeNormalizeOp(OpTest):
+    def setUp(self):
+        self.op_type = "crop_resize_normalize"
+        self.init_test_case()
+        images = [
+            np.random.randint(
+                0, 256, size=shape + [self.channels]).astype('uint8')
+            for shape in self.shapes
+        ]
+        pixels = np.concatenate(
+            [image.reshape([-1, self.channels]) for image in images])
+        lod = [[shape[0] * shape[1] for shape in self.shapes]]
+        self.inputs = {
+            'X': (pixels, lod),
+            'ImageShape': np.array(self.shapes).astype('int32')
+        }
+        self.attrs = {
+            'size': self.size,
+            'crop_ratio': self.crop_ratio,
+            'mean': self.mean,
+            'std': self.std
+        }
+        mean = np.array(self.mean or [0.], dtype='float32')
+        std = np.array(self.std or [1.], dtype='float32')
+        out = np.stack([
+            crop_resize_normalize(
+                image.astype('float32'), self.size, self.crop_ratio, mean,
+                std) for image in images
+        ])
+        self.outputs = {'Out': out}
+
+    def init_test_case(self):
+        self.shapes = [[6, 8], [5, 3], [4, 4]]
+        self.channels = 3
+        self.size = [4, 5]
+        self.crop_ratio = 1.0
+        self.mean = [123.675, 116.28, 103.53]
+        self.std = [58.395, 57.12, 57.375]
+
+    def test_check_output(self):
+        self.check_output(atol=1e-4)
+
+
+class TestCropResizeNormalizeOpCenterCrop(TestCropResizeNormalizeOp):
+    def init_test_case(self):
+        self.shapes = [[10, 12], [7, 9]]
+        self.channels = 1
+        self.size = [3, 3]
+        self.crop_ratio = 0.875
+        self.mean = [127.5]
+        self.std = []
+
+
+class TestCropResizeNormalizeOpRandom(OpTest):
+    def setUp(self):
+        self.op_type = "crop_resize_normalize"
+        image = np.tile(
+            np.arange(
+                8, dtype='uint8').reshape([1, 8, 1]), [6, 1, 3])
+        self.inputs = {
+            'X': (image.reshape([-1, 3]), [[48]]),
+            'ImageShape': np.array([[6, 8]]).astype('int32'),
+            'Seed': np.array([10]).astype('int64')
+        }
+        self.attrs = {
+            'size': [6, 8],
+            'random_crop': True,
+            'area_range': [1.0, 1.0],
+            'aspect_ratio_range': [8. / 6, 8. / 6],
+            'random_flip': True
+        }
+        self.outputs = {'Out': np.array([]), 'SeedOut': np.array([])}
+
+    def test_check_output(self):
+        self.check_output_customized(self.verify_output)
+
+    def verify_output(self, outs):
+        # The crop is the whole image, which may be flipped.
+        out = np.array(outs[0]) if np.array(outs[0]).ndim == 4 else np.array(
+            outs[1])
+        row = out[0, 0, 0]
+        expected = np.arange(8, dtype='float32')
+        self.assertTrue(
+            np.allclose(row, expected) or np.allclose(row, expected[::-1]))
+        self.assertTrue(np.allclose(out, row))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,96 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle.fluid.core as core
+from paddle.fluid.op import Operator
+
+
+class TestDGCOp(unittest.TestCase):
+    def setUp(self):
+        self.height = 8
+        self.row_numel = 4
+        self.m = 0.9
+        self.sparsity = [0.5, 0.75]
+        self.step = 3
+        self.rampup_begin_step = 2
+        self.rampup_step = 2
+        # step 3 is the second half of the warm-up
+        self.k = 2
+
+    def set_tensor(self, scope, name, array, place):
+        scope.var(name).get_tensor().set(array, place)
+
+    def check_with_place(self, place):
+        scope = core.Scope()
+        shape = (self.height, self.row_numel)
+        u = np.random.random(shape).astype("float32")
+        v = np.random.random(shape).astype("float32")
+        grad = np.random.random(shape).astype("float32")
+        self.set_tensor(scope, "U", u, place)
+        self.set_tensor(scope, "V", v, place)
+        self.set_tensor(scope, "Grad", grad, place)
+        self.set_tensor(scope, "CurrentStep",
+                        np.array([self.step]).astype("int64"), place)
+        scope.var("EncodeGrad").get_selected_rows()
+
+        op = Operator(
+            "dgc",
+            U="U",
+            V="V",
+            Grad="Grad",
+            CurrentStep="CurrentStep",
+            UOut="U",
+            VOut="V",
+            EncodeGrad="EncodeGrad",
+            m=self.m,
+            sparsity=self.sparsity,
+            rampup_begin_step=self.rampup_begin_step,
+            rampup_step=self.rampup_step)
+        op.run(scope, place)
+
+        u_out = self.m * u + grad
+        v_out = v + u_out
+        norms = np.sum(v_out * v_out, axis=1)
+        rows = sorted(np.argsort(-norms)[:self.k].tolist())
+
+        encode_grad = scope.find_var("EncodeGrad").get_selected_rows()
+        self.assertEqual(encode_grad.height(), self.height)
+        self.assertEqual(list(encode_grad.rows()), rows)
+        self.assertTrue(
+            np.allclose(np.array(encode_grad.get_tensor()), v_out[rows]))
+
+        u_out[rows] = 0
+        v_out[rows] = 0
+        self.assertTrue(
+            np.allclose(np.array(scope.find_var("U").get_tensor()), u_out))
+        self.assertTrue(
+            np.allclose(np.array(scope.find_var("V").get_tensor()), v_out))
+
+    def test_dgc(self):
+        self.check_with_place(core.CPUPlace())
+
+
+class TestDGCOpBeforeRampup(TestDGCOp):
+    def setUp(self):
+        super(TestDGCOpBeforeRampup, self).setUp()
+        self.step = 1
+        self.k = self.height
+
+
+if __name__ == "__main__":
+    unittest.main()
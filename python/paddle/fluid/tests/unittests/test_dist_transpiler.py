@@ -233,6 +233,94 @@ class TestNoSliceVar(TranspilerTest):
         self.assertEqual(fc_w_var.shape, (1000, 1000))
 
 
+class TestDGC(TranspilerTest):
+    def transpiler_test_impl(self):
+        config = fluid.DistributeTranspilerConfig()
+        config.enable_dgc = True
+
+        pserver, startup = self.get_pserver(self.pserver1_ep, config)
+        trainer, trainer_startup = self.get_trainer(config)
+
+        trainer_ops = [op.type for op in trainer.global_block().ops]
+        self.assertEqual(trainer_ops[0], "increment")
+        self.assertEqual(trainer_ops.count("dgc"), 2)
+        self.assertTrue("split_selected_rows" in trainer_ops)
+        self.assertTrue("split_byref" not in trainer_ops)
+
+        block = trainer.global_block()
+        self.assertEqual(block.vars["fc_w@GRAD"].type,
+                         fluid.core.VarDesc.VarType.SELECTED_ROWS)
+        self.assertEqual(block.vars["fc_w@GRAD@DENSE"].type,
+                         fluid.core.VarDesc.VarType.LOD_TENSOR)
+        self.assertTrue("@DGC_COUNTER@" in trainer_startup.global_block().vars)
+
+
+class TestGeoSgd(TranspilerTest):
+    def transpiler_test_impl(self):
+        config = fluid.DistributeTranspilerConfig()
+        config.geo_sgd_mode = True
+        config.geo_sgd_need_push_nums = 10
+
+        pserver, startup = self.get_pserver(self.pserver1_ep, config, False)
+        pserver2, startup2 = self.get_pserver(self.pserver2_ep, config, False)
+        trainer, trainer_startup = self.get_trainer(config)
+
+        # the trainer keeps the optimize ops and sends the deltas at last
+        trainer_ops = [op.type for op in trainer.global_block().ops]
+        self.assertEqual(trainer_ops[0], "increment")
+        self.assertEqual(trainer_ops[-1], "geo_sgd_send")
+        self.assertEqual(trainer_ops.count("sgd"), 2)
+        self.assertTrue("send" not in trainer_ops)
+        self.assertTrue("recv" not in trainer_ops)
+        send_op = trainer.global_block().ops[-1]
+        self.assertEqual(send_op.attr("push_nums"), 10)
+        self.assertEqual(set(send_op.input("X")), set(["fc_w", "fc_b"]))
+
+        startup_ops = [op.type for op in trainer_startup.global_block().ops]
+        self.assertEqual(startup_ops[-5:],
+                         ['recv', 'recv', 'fetch_barrier', 'assign', 'assign'])
+
+        # every pserver adds the delta of its whole parameter
+        params = []
+        for prog in [pserver, pserver2]:
+            self.assertEqual(len(prog.blocks), 2)
+            self.assertEqual([op.type for op in prog.blocks[1].ops], ["sum"])
+            params.extend(prog.blocks[1].ops[0].output("Out"))
+        self.assertEqual(set(params), set(["fc_w", "fc_b"]))
+        self.assertEqual(pserver.global_block().vars["fc_w"].shape,
+                         (1000, 1000))
+
+
+class TestOverlapRecv(TranspilerTest):
+    def transpiler_test_impl(self):
+        config = fluid.DistributeTranspilerConfig()
+        config.overlap_recv = True
+
+        pserver, startup = self.get_pserver(self.pserver1_ep, config)
+        trainer, trainer_startup = self.get_trainer(config)
+
+        # the parameters are received before the forward ops
+        self.assertEqual([op.type for op in trainer.global_block().ops], [
+            'recv', 'recv', 'fetch_barrier', 'concat', 'mul', 'elementwise_add',
+            'elementwise_sub', 'square', 'mean', 'fill_constant', 'mean_grad',
+            'square_grad', 'elementwise_sub_grad', 'elementwise_add_grad',
+            'send', 'mul_grad', 'split_byref', 'send', 'send_barrier'
+        ])
+        for op in trainer.global_block().ops[:2]:
+            self.assertEqual(op.input("X"), [])
+            self.assertEqual(op.attr("sync_mode"), 1)
+        fetch_barrier = trainer.global_block().ops[2]
+        self.assertEqual(
+            set(fetch_barrier.input("X")),
+            set(["fc_w.block0", "fc_w.block1", "fc_b"]))
+        self.assertTrue("fc_w" not in fetch_barrier.output("Out"))
+
+        # the first step receives the parameters
+        self.assertEqual([op.type for op in trainer_startup.global_block().ops],
+                         ['fill_constant', 'fill_constant', 'uniform_random'])
+        self.assertTrue("fc_w.block0" in trainer_startup.global_block().vars)
+
+
 class TestLRDecay(TranspilerTest):
     def net_conf(self):
         x = fluid.layers.data(name='x', shape=[1000], dtype='float32')
@@ -613,6 +701,33 @@ class TestAsyncLocalLookupTable(TestDistLookupTableBase):
         self.assertEqual([op.type for op in trainer.blocks[0].ops], ops)
 
 
+class TestGeoSgdLocalLookupTable(TestDistLookupTableBase):
+    def net_conf(self):
+        self.network_with_table(is_sparse=True, is_distributed=False)
+
+    def transpiler_test_impl(self):
+        config = fluid.DistributeTranspilerConfig()
+        config.geo_sgd_mode = True
+        pserver1, _ = self.get_pserver(self.pserver1_ep, config, False)
+        pserver2, _ = self.get_pserver(self.pserver2_ep, config, False)
+        trainer, _ = self.get_trainer(config)
+
+        send_op = trainer.global_block().ops[-1]
+        self.assertEqual(send_op.type, "geo_sgd_send")
+        self.assertEqual(
+            set(send_op.attr("sparse_params")), set(["shared_w", "profile_emb"]))
+
+        # the deltas of the tables are sent as SelectedRows
+        for prog in [pserver1, pserver2]:
+            for name, var in six.iteritems(prog.global_block().vars):
+                if name in ["shared_w.delta", "profile_emb.delta"]:
+                    self.assertEqual(var.type,
+                                     fluid.core.VarDesc.VarType.SELECTED_ROWS)
+                elif name in ["fc_w.delta", "fc_b.delta"]:
+                    self.assertEqual(var.type,
+                                     fluid.core.VarDesc.VarType.LOD_TENSOR)
+
+
 class TestAsyncDistLookupTable(TestDistLookupTableBase):
     def net_conf(self):
         self.network_with_table(is_sparse=True, is_distributed=True)
@@ -781,6 +896,32 @@ class TestNCCL2Transpile(TranspilerTest):
         else:
             pass
 
+    def test_nccl2_hierarchical_transpile(self):
+        if fluid.core.is_compiled_with_cuda():  #test nccl2 only with cuda
+            main = fluid.Program()
+            startup = fluid.Program()
+            with fluid.program_guard(main, startup):
+                self.net_conf()
+
+            config = fluid.DistributeTranspilerConfig()
+            config.mode = "nccl2"
+            config.wait_port = False
+            config.use_hierarchical_allreduce = True
+            config.hierarchical_allreduce_num_local_devices = 2
+            t = fluid.DistributeTranspiler(config=config)
+            t.transpile(
+                0,
+                trainers="127.0.0.1:6174,127.0.0.1:6175",
+                current_endpoint="127.0.0.1:6174",
+                startup_program=startup)
+            gen_nccl_id_op = startup.global_block().ops[-1]
+            self.assertEqual(gen_nccl_id_op.type, "gen_nccl_id")
+            self.assertEqual(
+                gen_nccl_id_op.output("InterNCCLID"),
+                ["NCCLID_INTER_0", "NCCLID_INTER_1"])
+        else:
+            pass
+
 
 # test for remote prefetch
 class TestRemoteLookupTable(TestDistLookupTableBase):
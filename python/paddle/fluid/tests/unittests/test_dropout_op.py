@@ -148,6 +148,39 @@ class TestDropoutOp9(OpTest):
         self.check_output()
 
 
+class TestDropoutOpMaskAsBits(TestDropoutOp):
+    def setUp(self):
+        self.op_type = "dropout"
+        self.inputs = {'X': np.random.random((5, 5)).astype("float32")}
+        self.attrs = {
+            'dropout_prob': 0.0,
+            'fix_seed': True,
+            'is_test': False,
+            'mask_as_bits': True
+        }
+        self.outputs = {
+            'Out': self.inputs['X'],
+            'Mask': np.array([255, 255, 255, 1]).astype('uint8')
+        }
+
+
+class TestDropoutOpMaskAsBits2(TestDropoutOp):
+    def setUp(self):
+        self.op_type = "dropout"
+        self.inputs = {'X': np.random.random((32, 64)).astype("float32")}
+        self.attrs = {
+            'dropout_prob': 1.0,
+            'fix_seed': True,
+            'is_test': False,
+            'dropout_implementation': 'upscale_in_train',
+            'mask_as_bits': True
+        }
+        self.outputs = {
+            'Out': np.zeros((32, 64)).astype('float32'),
+            'Mask': np.zeros((256, )).astype('uint8')
+        }
+
+
 class TestFP16DropoutOp(OpTest):
     def setUp(self):
         self.op_type = "dropout"
@@ -0,0 +1,152 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import socket
+import time
+import unittest
+
+from paddle.fluid.distributed.elastic import ElasticExecutor, ElasticMembership
+
+
+def find_free_port():
+    s = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    s.bind(('127.0.0.1', 0))
+    port = s.getsockname()[1]
+    s.close()
+    return port
+
+
+class TestElasticMembership(unittest.TestCase):
+    def setUp(self):
+        self.endpoint = "127.0.0.1:%d" % find_free_port()
+        self.changes = {}
+        self.members = []
+        for trainer_id in range(3):
+            self.changes[trainer_id] = []
+            self.members.append(
+                ElasticMembership(
+                    trainer_id,
+                    3,
+                    self.endpoint,
+                    gen_nccl_id=lambda: b"\x01\x02\x03",
+                    heartbeat_interval=0.1,
+                    heartbeat_timeout=1.0,
+                    on_change=self.changes[trainer_id].append))
+        for member in self.members:
+            member.start()
+
+    def tearDown(self):
+        for member in self.members:
+            member.stop()
+
+    def wait_epoch(self, member, epoch):
+        deadline = time.time() + 10
+        while member.membership()[0] < epoch:
+            self.assertLess(time.time(), deadline)
+            time.sleep(0.1)
+
+    def test_no_change(self):
+        time.sleep(1.5)
+        for trainer_id, member in enumerate(self.members):
+            self.assertEqual(member.membership(), (0, 3, trainer_id, None))
+            self.assertEqual(self.changes[trainer_id], [])
+
+    def test_lost_trainer(self):
+        time.sleep(0.3)
+        self.members[1].stop()
+
+        for trainer_id in [0, 2]:
+            self.wait_epoch(self.members[trainer_id], 1)
+        self.assertEqual(self.members[0].membership(),
+                         (1, 2, 0, b"\x01\x02\x03"))
+        self.assertEqual(self.members[2].membership(),
+                         (1, 2, 1, b"\x01\x02\x03"))
+        self.assertEqual(self.changes[0], [1])
+        self.assertEqual(self.changes[2], [1])
+        self.assertEqual(self.changes[1], [])
+
+
+
+class FakeMembership(object):
+    def __init__(self):
+        self.trainer_id = 1
+        self.state = (0, 3, 1, None)
+        self.on_change = None
+
+    def membership(self):
+        return self.state
+
+
+class FakeParallelExecutor(object):
+    """Records the calls of ElasticExecutor, and runs on_run in a step."""
+
+    def __init__(self):
+        self.calls = []
+        self.on_run = None
+        self.executor = self
+
+    def run(self, fetch_list, feed=None, return_numpy=True):
+        self.calls.append("run")
+        if self.on_run is not None:
+            self.on_run()
+        return fetch_list
+
+    def abort_nccl(self):
+        self.calls.append("abort")
+
+    def reset_nccl(self, nccl_id, num_trainers, trainer_id):
+        self.calls.append(("reset", nccl_id, num_trainers, trainer_id))
+
+
+class TestElasticExecutor(unittest.TestCase):
+    def setUp(self):
+        self.membership = FakeMembership()
+        self.pe = FakeParallelExecutor()
+        self.exe = ElasticExecutor(self.pe, self.membership)
+
+    def lose_trainer(self):
+        self.membership.state = (1, 2, 0, b"\x01")
+        self.membership.on_change(1)
+
+    def test_no_change(self):
+        self.assertEqual(self.exe.run(["loss"]), ["loss"])
+        self.assertEqual(self.pe.calls, ["run"])
+
+    def test_change_in_step(self):
+        self.pe.on_run = self.lose_trainer
+        self.assertIsNone(self.exe.run(["loss"]))
+        self.assertEqual(self.pe.calls,
+                         ["run", "abort", ("reset", b"\x01", 2, 0)])
+
+        self.pe.on_run = None
+        self.assertEqual(self.exe.run(["loss"]), ["loss"])
+        self.assertEqual(self.pe.calls[3:], ["run"])
+
+    def test_no_abort_after_reset(self):
+        self.membership.state = (1, 2, 0, b"\x01")
+        self.assertEqual(self.exe.run(["loss"]), ["loss"])
+        # the change is notified after the communicators are reset to it
+        self.membership.on_change(1)
+        self.assertEqual(self.pe.calls, [("reset", b"\x01", 2, 0), "run"])
+
+    def test_removed(self):
+        self.membership.state = (1, 2, -1, None)
+        self.assertRaises(RuntimeError, self.exe.run, ["loss"])
+        self.assertEqual(self.pe.calls, [])
+
+
+if __name__ == '__main__':
+    unittest.main()
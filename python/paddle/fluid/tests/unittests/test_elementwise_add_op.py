@@ -278,5 +278,39 @@ class TestFP16ElementwiseAddOp_channelwise_add(TestFP16ElementwiseAddOp):
         self.axis = -1
 
 
+class TestElementwiseAddOp_odd_numel(TestElementwiseAddOp):
+    def init_input_output(self):
+        self.x = np.random.rand(3, 5, 7).astype(self.dtype)
+        self.y = np.random.rand(3, 5, 7).astype(self.dtype)
+        self.out = self.x + self.y
+
+
+class TestFP16ElementwiseAddOp_odd_numel(TestFP16ElementwiseAddOp):
+    def init_input_output(self):
+        self.x = np.random.rand(3, 5, 7).astype(self.dtype)
+        self.y = np.random.rand(3, 5, 7).astype(self.dtype)
+        self.out = self.x + self.y
+
+
+class TestElementwiseAddOp_broadcast_inner(TestElementwiseAddOp):
+    def init_input_output(self):
+        self.x = np.random.rand(2, 3, 8).astype(self.dtype)
+        self.y = np.random.rand(2, 3).astype(self.dtype)
+        self.out = self.x + self.y.reshape(2, 3, 1)
+
+    def init_axis(self):
+        self.axis = 0
+
+
+class TestFP16ElementwiseAddOp_broadcast_inner(TestFP16ElementwiseAddOp):
+    def init_input_output(self):
+        self.x = np.random.rand(2, 3, 8).astype(self.dtype)
+        self.y = np.random.rand(2, 3).astype(self.dtype)
+        self.out = self.x + self.y.reshape(2, 3, 1)
+
+    def init_axis(self):
+        self.axis = 0
+
+
 if __name__ == '__main__':
     unittest.main()
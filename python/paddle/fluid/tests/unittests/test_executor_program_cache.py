@@ -0,0 +1,60 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+
+import numpy
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+
+def build_program(scale):
+    main = fluid.Program()
+    startup = fluid.Program()
+    with fluid.program_guard(main, startup), fluid.unique_name.guard():
+        x = fluid.layers.data(name='x', shape=[8], dtype='float32')
+        out = fluid.layers.scale(fluid.layers.relu(x), scale=scale)
+    return main, out
+
+
+class TestExecutorProgramCache(unittest.TestCase):
+    def test_program_cache(self):
+        exe = fluid.Executor(core.CPUPlace())
+        main1, out1 = build_program(2.0)
+        main2, out2 = build_program(3.0)
+        self.assertEqual(out1.name, out2.name)
+        for _ in range(3):
+            x_np = numpy.random.random((4, 8)).astype('float32') - 0.5
+            relu = numpy.maximum(x_np, 0)
+            res1, = exe.run(main1,
+                            feed={'x': x_np},
+                            fetch_list=[out1.name],
+                            use_program_cache=True)
+            res2, = exe.run(main2,
+                            feed={'x': x_np},
+                            fetch_list=[out2.name],
+                            use_program_cache=True)
+            self.assertTrue(numpy.allclose(res1, relu * 2.0))
+            self.assertTrue(numpy.allclose(res2, relu * 3.0))
+        self.assertEqual(len(exe.ctx_caches), 2)
+
+        res, = exe.run(main1, feed={'x': x_np}, fetch_list=[out1.name])
+        self.assertTrue(numpy.allclose(res, relu * 2.0))
+        self.assertEqual(len(exe.ctx_caches), 1)
+
+
+if __name__ == '__main__':
+    unittest.main()
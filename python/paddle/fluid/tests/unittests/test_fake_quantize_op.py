@@ -62,5 +62,42 @@ class TestFakeQuantizeOp(OpTest):
         self.check_output()
 
 
+class TestFakeQuantizeDequantizeAbsMaxOp(OpTest):
+    def setUp(self):
+        self.op_type = "fake_quantize_dequantize_abs_max"
+        self.attrs = {'bit_length': 8}
+        self.inputs = {
+            'X': np.random.uniform(-1, 1, (124, 240)).astype("float32")
+        }
+        bin_cnt = (1 << (self.attrs['bit_length'] - 1)) - 1
+        scale = np.max(np.abs(self.inputs['X'])).astype("float32")
+        self.outputs = {
+            'Out': np.round(self.inputs['X'] / scale * bin_cnt) * scale /
+            bin_cnt,
+            'OutScale': np.array([scale]).astype("float32"),
+        }
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestFakeChannelWiseQuantizeDequantizeAbsMaxOp(OpTest):
+    def setUp(self):
+        self.op_type = "fake_quantize_dequantize_abs_max"
+        self.attrs = {'bit_length': 8, 'channel_wise': True}
+        x = np.random.uniform(-1, 1, (16, 8, 3, 3)).astype("float32")
+        self.inputs = {'X': x}
+        bin_cnt = (1 << (self.attrs['bit_length'] - 1)) - 1
+        scales = np.max(np.abs(x.reshape(16, -1)), axis=1).astype("float32")
+        s = scales.reshape(16, 1, 1, 1)
+        self.outputs = {
+            'Out': np.round(x / s * bin_cnt) * s / bin_cnt,
+            'OutScale': scales,
+        }
+
+    def test_check_output(self):
+        self.check_output()
+
+
 if __name__ == "__main__":
     unittest.main()
@@ -0,0 +1,103 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+from parallel_executor_test_base import TestParallelExecutorBase
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+import numpy as np
+import unittest
+import os
+
+
+def fc_with_batchnorm(use_feed):
+    img = fluid.layers.data(name='image', shape=[784], dtype='float32')
+    label = fluid.layers.data(name='label', shape=[1], dtype='int64')
+
+    hidden = img
+    for _ in range(3):
+        hidden = fluid.layers.fc(
+            hidden,
+            size=200,
+            act='relu',
+            bias_attr=fluid.ParamAttr(
+                initializer=fluid.initializer.Constant(value=1.0)))
+
+        hidden = fluid.layers.batch_norm(input=hidden)
+
+    prediction = fluid.layers.fc(hidden, size=10, act='softmax')
+    loss = fluid.layers.cross_entropy(input=prediction, label=label)
+    loss = fluid.layers.mean(loss)
+    return loss
+
+
+class TestFuseOptimizerOps(TestParallelExecutorBase):
+    @classmethod
+    def setUpClass(cls):
+        os.environ['CPU_NUM'] = str(4)
+
+    def _init_data(self):
+        np.random.seed(5)
+        img = np.random.random(size=[32, 784]).astype(np.float32)
+        label = np.ones(shape=[32, 1], dtype='int64')
+        return img, label
+
+    def _compare_fuse_optimizer_ops(self, optimizer, use_cuda):
+        if use_cuda and not core.is_compiled_with_cuda():
+            return
+        img, label = self._init_data()
+
+        not_fuse_first_loss, not_fuse_last_loss = self.check_network_convergence(
+            fc_with_batchnorm,
+            feed_dict={"image": img,
+                       "label": label},
+            use_cuda=use_cuda,
+            fuse_optimizer_ops=False,
+            memory_opt=False,
+            optimizer=optimizer)
+        fuse_first_loss, fuse_last_loss = self.check_network_convergence(
+            fc_with_batchnorm,
+            feed_dict={"image": img,
+                       "label": label},
+            use_cuda=use_cuda,
+            fuse_optimizer_ops=True,
+            memory_opt=False,
+            optimizer=optimizer)
+
+        for loss in zip(not_fuse_first_loss, fuse_first_loss):
+            self.assertAlmostEquals(loss[0], loss[1], delta=1e-6)
+        for loss in zip(not_fuse_last_loss, fuse_last_loss):
+            self.assertAlmostEquals(loss[0], loss[1], delta=1e-6)
+
+    def test_adam(self):
+        def _optimizer(learning_rate=1e-4):
+            return fluid.optimizer.Adam(learning_rate=learning_rate)
+
+        self._compare_fuse_optimizer_ops(_optimizer, True)
+        self._compare_fuse_optimizer_ops(_optimizer, False)
+
+    def test_momentum(self):
+        def _optimizer(learning_rate=1e-4):
+            return fluid.optimizer.Momentum(
+                learning_rate=learning_rate,
+                momentum=0.9,
+                regularization=fluid.regularizer.L2Decay(1e-4))
+
+        self._compare_fuse_optimizer_ops(_optimizer, True)
+        self._compare_fuse_optimizer_ops(_optimizer, False)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,75 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+from test_adam_op import adam_step
+
+
+class TestFusedAdamOp(OpTest):
+    def setUp(self):
+        self.op_type = "fused_adam"
+        self.dtype = np.float32
+        self.init_dtype()
+
+        attrs = {'epsilon': 1e-4, 'beta1': 0.78, 'beta2': 0.836}
+        # More tensors and chunks than one launch of the GPU kernel takes.
+        shapes = [(102, 105), (1, ), (1000, 70)] + [(17, 3)] * 30
+        inputs = {}
+        outputs = {}
+        for i, shape in enumerate(shapes):
+            step_inputs = {
+                'Param': np.random.uniform(-1, 1, shape).astype(self.dtype),
+                'Grad': np.random.uniform(-1, 1, shape).astype(self.dtype),
+                'Moment1':
+                np.random.uniform(-1, 1, shape).astype(self.dtype),
+                'Moment2': np.random.random(shape).astype(self.dtype),
+                'LearningRate': np.array([0.004 / (i + 1)]).astype(self.dtype),
+                'Beta1Pow': np.array([attrs['beta1']**(i + 10)]).astype(
+                    self.dtype),
+                'Beta2Pow': np.array([attrs['beta2']**(i + 10)]).astype(
+                    self.dtype)
+            }
+            param_out, moment1_out, moment2_out = adam_step(step_inputs,
+                                                            attrs)
+            for name, value in step_inputs.items():
+                inputs.setdefault(name, []).append(('%s_%d' % (name, i),
+                                                    value))
+            for name, value in [('ParamOut', param_out),
+                                ('Moment1Out', moment1_out),
+                                ('Moment2Out', moment2_out)]:
+                outputs.setdefault(name, []).append(('%s_%d' % (name, i),
+                                                     value))
+
+        self.inputs = inputs
+        self.outputs = outputs
+        self.attrs = attrs
+
+    def init_dtype(self):
+        pass
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestFusedAdamOpDouble(TestFusedAdamOp):
+    def init_dtype(self):
+        self.dtype = np.float64
+
+
+if __name__ == "__main__":
+    unittest.main()
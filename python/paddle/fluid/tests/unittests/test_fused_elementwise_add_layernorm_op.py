@@ -0,0 +1,88 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+def layer_norm(x, scale, bias, epsilon, begin_norm_axis):
+    shape = x.shape
+    left = int(np.prod(shape[:begin_norm_axis]))
+    x = x.reshape([left, -1])
+    mean = np.mean(x, axis=1, keepdims=True)
+    var = np.var(x, axis=1, keepdims=True)
+    out = (x - mean) / np.sqrt(var + epsilon)
+    if scale is not None:
+        out = out * scale
+    if bias is not None:
+        out = out + bias
+    return out.reshape(shape)
+
+
+class TestFusedElementwiseAddLayerNormOp(OpTest):
+    def setUp(self):
+        self.op_type = 'fused_elementwise_add_layernorm'
+        self.shape = [2, 7, 96]
+        self.begin_norm_axis = 2
+        self.epsilon = 1e-5
+        self.with_scale_bias = True
+        self.with_sum_out = False
+        self.set_conf()
+
+        x = np.random.uniform(-1, 1, self.shape).astype('float32')
+        y = np.random.uniform(-1, 1, self.shape).astype('float32')
+        right = int(np.prod(self.shape[self.begin_norm_axis:]))
+        self.inputs = {'X': x, 'Y': y}
+        scale, bias = None, None
+        if self.with_scale_bias:
+            scale = np.random.uniform(0.5, 1.5, [right]).astype('float32')
+            bias = np.random.uniform(-1, 1, [right]).astype('float32')
+            self.inputs['Scale'] = scale
+            self.inputs['Bias'] = bias
+        self.attrs = {
+            'epsilon': self.epsilon,
+            'begin_norm_axis': self.begin_norm_axis,
+        }
+        out = layer_norm(x + y, scale, bias, self.epsilon,
+                         self.begin_norm_axis)
+        self.outputs = {'Out': out.astype('float32')}
+        if self.with_sum_out:
+            self.outputs['SumOut'] = x + y
+
+    def set_conf(self):
+        pass
+
+    def test_check_output(self):
+        self.check_output(atol=1e-5)
+
+
+class TestFusedElementwiseAddLayerNormOpSumOut(
+        TestFusedElementwiseAddLayerNormOp):
+    def set_conf(self):
+        self.with_sum_out = True
+
+
+class TestFusedElementwiseAddLayerNormOpNoScaleBias(
+        TestFusedElementwiseAddLayerNormOp):
+    def set_conf(self):
+        self.with_scale_bias = False
+        self.shape = [3, 4, 5, 6]
+        self.begin_norm_axis = 1
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,82 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle.fluid.core as core
+from op_test import OpTest
+
+FP16 = int(core.VarDesc.VarType.FP16)
+FP32 = int(core.VarDesc.VarType.FP32)
+
+
+class TestFusedElementwiseChainOp(OpTest):
+    def setUp(self):
+        self.op_type = 'fused_elementwise_chain'
+        self.shape = [2, 3, 4, 5]
+        self.set_conf()
+
+        x = np.random.uniform(-1, 1, self.shape).astype('float32')
+        y0 = np.random.uniform(-1, 1, [3, 4]).astype('float32')
+        y1 = np.random.uniform(0.5, 1.5, self.shape[-1:]).astype('float32')
+        # (relu(2 * x + 1) + y0) * y1, then sigmoid, with y0 at axis 1.
+        out = np.maximum(2 * x + 1, 0) + y0.reshape([1, 3, 4, 1])
+        out = 1 / (1 + np.exp(-out * y1))
+        self.inputs = {'X': x, 'Y': [('y0', y0), ('y1', y1)]}
+        self.attrs = {
+            'functor_list': [
+                'scale', 'relu', 'elementwise_add', 'elementwise_mul',
+                'sigmoid'
+            ],
+            'alpha': [2., 1., 1., 1., 1.],
+            'beta': [1., 0., 0., 0., 0.],
+            'axis': [-1, -1, 1, -1, -1],
+            'cast_dtype': [-1, -1, -1, -1, -1],
+            'out_dtype': FP32,
+        }
+        self.outputs = {'Out': out}
+
+    def set_conf(self):
+        pass
+
+    def test_check_output(self):
+        self.check_output(atol=1e-5)
+
+
+class TestFusedElementwiseChainCastOp(OpTest):
+    def setUp(self):
+        self.op_type = 'fused_elementwise_chain'
+        x = np.random.uniform(-1, 1, [4, 16]).astype('float32')
+        y = np.random.uniform(-1, 1, [4, 16]).astype('float16')
+        # tanh(x) in float16 - y, in float16.
+        out = np.tanh(x).astype('float16') - y
+        self.inputs = {'X': x, 'Y': [('y', y)]}
+        self.attrs = {
+            'functor_list': ['tanh', 'cast', 'elementwise_sub'],
+            'alpha': [1., 1., 1.],
+            'beta': [0., 0., 0.],
+            'axis': [-1, -1, -1],
+            'cast_dtype': [-1, FP16, -1],
+            'out_dtype': FP16,
+        }
+        self.outputs = {'Out': out}
+
+    def test_check_output(self):
+        self.check_output(atol=1e-3)
+
+
+if __name__ == '__main__':
+    unittest.main()
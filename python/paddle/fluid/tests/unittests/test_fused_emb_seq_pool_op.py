@@ -47,5 +47,62 @@ class TestFusedEmbeddingSeqPoolOp(OpTest):
         self.check_output()
 
 
+class TestFusedEmbeddingSeqPoolOpMean(OpTest):
+    def setUp(self):
+        self.op_type = "fused_embedding_seq_pool"
+        self.emb_size = 2
+        table = np.random.random((17, self.emb_size)).astype("float32")
+        ids = np.array([[[4], [3]], [[4], [3]], [[2], [1]],
+                        [[16], [1]]]).astype("int64")
+        ids_expand = np.expand_dims(ids, axis=1)
+        self.lod = [[3, 1]]
+        self.attrs = {'is_sparse': True, 'combiner': 'mean'}
+        self.inputs = {'W': table, 'Ids': (ids_expand, self.lod)}
+        self.outputs = {
+            'Out': np.reshape(
+                np.array([(table[[4, 3]] + table[[4, 3]] + table[[2, 1]]) / 3,
+                          table[[16, 1]]]), [len(self.lod[0]),
+                                             2 * self.emb_size])
+        }
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestFusedEmbeddingSeqPoolQuantizedW(unittest.TestCase):
+    def test_quantized_w(self):
+        ids = np.array([[[4], [3]], [[4], [3]], [[2], [1]],
+                        [[16], [1]]]).astype("int64")
+        lod = [[3, 1]]
+        table = np.random.randint(0, 256, (17, 2)).astype("uint8")
+        scale_bias = np.random.random((17, 2)).astype("float32")
+        w = table.astype("float32") * scale_bias[:, 0:1] + scale_bias[:, 1:2]
+        expected = np.reshape(
+            np.array([w[[4, 3]] + w[[4, 3]] + w[[2, 1]], w[[16, 1]]]),
+            [len(lod[0]), 4])
+
+        places = [core.CPUPlace()]
+        if core.is_compiled_with_cuda():
+            places.append(core.CUDAPlace(0))
+        for place in places:
+            scope = core.Scope()
+            ids_tensor = scope.var('Ids').get_tensor()
+            ids_tensor.set(ids, place)
+            ids_tensor.set_recursive_sequence_lengths(lod)
+            scope.var('W').get_tensor().set(table, place)
+            scope.var('WScaleBias').get_tensor().set(scale_bias, place)
+            out_tensor = scope.var('Out').get_tensor()
+            op = Operator(
+                "fused_embedding_seq_pool",
+                W='W',
+                WScaleBias='WScaleBias',
+                Ids='Ids',
+                Out='Out')
+            op.run(scope, place)
+            self.assertTrue(
+                np.allclose(
+                    np.array(out_tensor), expected, atol=1e-5))
+
+
 if __name__ == "__main__":
     unittest.main()
@@ -0,0 +1,116 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import struct
+import unittest
+import numpy as np
+from op_test import OpTest
+
+_P1 = 11400714785074694791
+_P2 = 14029467366897019727
+_P3 = 1609587929392839161
+_P4 = 9650029242287828579
+_P5 = 2870177450012600261
+_MASK = (1 << 64) - 1
+
+
+def _rotl(x, r):
+    return ((x << r) | (x >> (64 - r))) & _MASK
+
+
+def _round(acc, val):
+    return (_rotl((acc + val * _P2) & _MASK, 31) * _P1) & _MASK
+
+
+def xxh64(data, seed):
+    n = len(data)
+    p = 0
+    if n >= 32:
+        v = [(seed + _P1 + _P2) & _MASK, (seed + _P2) & _MASK, seed,
+             (seed - _P1) & _MASK]
+        while p + 32 <= n:
+            for i in range(4):
+                v[i] = _round(v[i],
+                              struct.unpack('<Q', data[p + 8 * i:p + 8 * i +
+                                                       8])[0])
+            p += 32
+        h = (_rotl(v[0], 1) + _rotl(v[1], 7) + _rotl(v[2], 12) +
+             _rotl(v[3], 18)) & _MASK
+        for i in range(4):
+            h = ((h ^ _round(0, v[i])) * _P1 + _P4) & _MASK
+    else:
+        h = (seed + _P5) & _MASK
+    h = (h + n) & _MASK
+    while p + 8 <= n:
+        k = _round(0, struct.unpack('<Q', data[p:p + 8])[0])
+        h = (_rotl(h ^ k, 27) * _P1 + _P4) & _MASK
+        p += 8
+    if p + 4 <= n:
+        k = (struct.unpack('<I', data[p:p + 4])[0] * _P1) & _MASK
+        h = (_rotl(h ^ k, 23) * _P2 + _P3) & _MASK
+        p += 4
+    while p < n:
+        h = (_rotl(h ^ ((bytearray(data[p:p + 1])[0] * _P5) & _MASK), 11) *
+             _P1) & _MASK
+        p += 1
+    h ^= h >> 33
+    h = (h * _P2) & _MASK
+    h ^= h >> 29
+    h = (h * _P3) & _MASK
+    h ^= h >> 32
+    return h
+
+
+class TestFusedHashEmbeddingOp(OpTest):
+    def setUp(self):
+        self.op_type = "fused_hash_embedding"
+        self.init_test_case()
+        lod = [[3, 7, 2]]
+        x = np.random.randint(0, 1000, (12, self.dim)).astype(self.dtype)
+        w = np.random.random((self.mod_by + 3, 5)).astype("float64")
+        out = np.zeros((12, self.num_hash, 5)).astype("float64")
+        for i in range(12):
+            # The hash op hashes the first 4 * dim bytes of a row.
+            row = x[i].tobytes()[:4 * self.dim]
+            for j in range(self.num_hash):
+                out[i, j] = w[xxh64(row, j) % self.mod_by]
+        self.inputs = {'X': (x, lod), 'W': w}
+        self.attrs = {'num_hash': self.num_hash, 'mod_by': self.mod_by}
+        self.outputs = {'Out': (out, lod)}
+
+    def init_test_case(self):
+        self.dim = 1
+        self.num_hash = 6
+        self.mod_by = 31
+        self.dtype = "int32"
+
+    def test_check_output(self):
+        self.check_output()
+
+    def test_check_grad(self):
+        self.check_grad(['W'], 'Out', no_grad_set=set(['X']))
+
+
+class TestFusedHashEmbeddingOpLongRows(TestFusedHashEmbeddingOp):
+    def init_test_case(self):
+        self.dim = 11
+        self.num_hash = 3
+        self.mod_by = 17
+        self.dtype = "int64"
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,82 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+class TestFusedMomentumOp(OpTest):
+    def setUp(self):
+        self.op_type = "fused_momentum"
+        self.dtype = np.float32
+        self.use_nesterov = False
+        self.init_config()
+
+        mu = 0.0001
+        # More tensors and chunks than one launch of the GPU kernel takes.
+        shapes = [(123, 321), (1, ), (1000, 70)] + [(17, 3)] * 40
+        inputs = {
+            'Param': [],
+            'Grad': [],
+            'Velocity': [],
+            'LearningRate': []
+        }
+        outputs = {'ParamOut': [], 'VelocityOut': []}
+        for i, shape in enumerate(shapes):
+            param = np.random.random(shape).astype(self.dtype)
+            grad = np.random.random(shape).astype(self.dtype)
+            velocity = np.random.random(shape).astype(self.dtype)
+            learning_rate = np.array([0.001 * (i + 1)]).astype(self.dtype)
+
+            velocity_out = mu * velocity + grad
+            if self.use_nesterov:
+                param_out = param - grad * learning_rate - \
+                            velocity_out * mu * learning_rate
+            else:
+                param_out = param - learning_rate * velocity_out
+
+            for name, value in [('Param', param), ('Grad', grad),
+                                ('Velocity', velocity),
+                                ('LearningRate', learning_rate)]:
+                inputs[name].append(('%s_%d' % (name, i), value))
+            outputs['ParamOut'].append(('ParamOut_%d' % i, param_out))
+            outputs['VelocityOut'].append(('VelocityOut_%d' % i,
+                                           velocity_out))
+
+        self.inputs = inputs
+        self.outputs = outputs
+        self.attrs = {'mu': mu, 'use_nesterov': self.use_nesterov}
+
+    def init_config(self):
+        pass
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestFusedMomentumOpNesterov(TestFusedMomentumOp):
+    def init_config(self):
+        self.use_nesterov = True
+
+
+class TestFusedMomentumOpDouble(TestFusedMomentumOp):
+    def init_config(self):
+        self.dtype = np.float64
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,99 @@
+#   Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+from op_test import OpTest
+
+
+def stable_softmax(x):
+    shiftx = x - np.max(x, axis=-1, keepdims=True)
+    exps = np.exp(shiftx)
+    return exps / np.sum(exps, axis=-1, keepdims=True)
+
+
+def multihead_attention(q, k, v, bias_qk, head_number, alpha, out_scale):
+    def split_heads(x):
+        b, s, hidden = x.shape
+        x = x.reshape([b, s, head_number, hidden // head_number])
+        return x.transpose([0, 2, 1, 3])
+
+    q, k, v = split_heads(q), split_heads(k), split_heads(v)
+    qk = np.matmul(q, k.transpose([0, 1, 3, 2])) * alpha
+    if bias_qk is not None:
+        qk = qk + bias_qk
+    out = np.matmul(stable_softmax(qk), v) * out_scale
+    b, h, s, d = out.shape
+    return out.transpose([0, 2, 1, 3]).reshape([b, s, h * d])
+
+
+class TestFusedMultiHeadAttentionOp(OpTest):
+    def setUp(self):
+        self.op_type = 'fused_multihead_attention'
+        self.batch = 2
+        self.seq_q = 5
+        self.seq_k = 7
+        self.head_number = 4
+        self.size_per_head = 8
+        self.with_bias_qk = True
+        self.out_scale = 0.9
+        self.set_conf()
+
+        hidden = self.head_number * self.size_per_head
+        q = np.random.uniform(-1, 1, [self.batch, self.seq_q,
+                                      hidden]).astype('float32')
+        k = np.random.uniform(-1, 1, [self.batch, self.seq_k,
+                                      hidden]).astype('float32')
+        v = np.random.uniform(-1, 1, [self.batch, self.seq_k,
+                                      hidden]).astype('float32')
+        alpha = 1.0 / np.sqrt(self.size_per_head)
+        self.inputs = {'Q': q, 'K': k, 'V': v}
+        bias_qk = None
+        if self.with_bias_qk:
+            bias_qk = np.random.uniform(
+                -1, 1, [self.batch, self.head_number, self.seq_q,
+                        self.seq_k]).astype('float32')
+            self.inputs['BiasQK'] = bias_qk
+        self.attrs = {
+            'head_number': self.head_number,
+            'alpha': alpha,
+            'out_scale': self.out_scale,
+        }
+        out = multihead_attention(q, k, v, bias_qk, self.head_number, alpha,
+                                  self.out_scale)
+        self.outputs = {'Out': out.astype('float32')}
+
+    def set_conf(self):
+        pass
+
+    def test_check_output(self):
+        self.check_output(atol=1e-5)
+
+
+class TestFusedMultiHeadAttentionOpNoBias(TestFusedMultiHeadAttentionOp):
+    def set_conf(self):
+        self.with_bias_qk = False
+        self.out_scale = 1.0
+
+
+class TestFusedMultiHeadAttentionOpOneHead(TestFusedMultiHeadAttentionOp):
+    def set_conf(self):
+        self.head_number = 1
+        self.seq_k = 1
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -44,5 +44,13 @@ class TestCase1(TestGatherOp):
         self.index = [1, 3, 5]
 
 
+class TestCaseRepeatedIndex(TestGatherOp):
+    # The gradients of the repeated indices are added, by the sorted scatter
+    # add on GPU as the indices repeat more than twice on average.
+    def config(self):
+        self.x_shape = (10, 20)
+        self.index = [1, 3, 1, 1, 5, 3, 1, 0, 3, 1]
+
+
 if __name__ == "__main__":
     unittest.main()
@@ -0,0 +1,61 @@
+# Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import unittest
+import numpy as np
+
+import paddle.fluid as fluid
+from paddle.fluid.imperative.nn import FC
+
+
+class MLP(fluid.imperative.Layer):
+    def __init__(self):
+        super(MLP, self).__init__()
+        self._fc1 = FC(3,
+                       fluid.ParamAttr(
+                           initializer=fluid.initializer.Constant(value=0.1)))
+        self._fc2 = FC(4,
+                       fluid.ParamAttr(
+                           initializer=fluid.initializer.Constant(value=0.2)))
+
+    def forward(self, inputs):
+        x = fluid.layers.relu(self._fc1(inputs))
+        x = self._fc2(x)
+        return x
+
+
+class TestTracedLayer(unittest.TestCase):
+    def test_mlp(self):
+        with fluid.imperative.guard():
+            mlp = MLP()
+            traced = fluid.imperative.TracedLayer(mlp)
+            for i in range(4):
+                np_inp = np.random.uniform(
+                    -1, 1, size=[2, 2]).astype('float32')
+                var_inp = fluid.imperative.base.to_variable(np_inp)
+                expected = mlp(var_inp)._numpy()
+                out = traced(var_inp)
+                self.assertTrue(np.allclose(out._numpy(), expected))
+
+            # The inputs of the new shapes are traced again.
+            var_inp = fluid.imperative.base.to_variable(
+                np.ones([3, 2], dtype='float32'))
+            for i in range(2):
+                out = traced(var_inp)
+                self.assertEqual(list(out._numpy().shape), [3, 4])
+                self.assertTrue(np.allclose(out._numpy(), 0.12))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -54,6 +54,21 @@ class TestLookupTableOpWithTensorIds(OpTest):
         self.check_grad(['W'], 'Out', no_grad_set=set('Ids'))
 
 
+class TestLookupTableOpHotIds(TestLookupTableOp):
+    # Few ids repeat a lot, whose gradients are summed by the sorted scatter
+    # add on GPU.
+    def setUp(self):
+        self.op_type = "lookup_table"
+        table = np.random.random((17, 31)).astype("float32")
+        ids = np.random.randint(0, 3, 600).astype("int64")
+        self.inputs = {'W': table, 'Ids': np.expand_dims(ids, axis=1)}
+        self.outputs = {'Out': table[ids]}
+
+    def test_check_grad(self):
+        self.check_grad(
+            ['W'], 'Out', no_grad_set=set('Ids'), max_relative_error=0.01)
+
+
 class TestLookupTableOpWithPadding(TestLookupTableOp):
     def test_check_output(self):
         ids = np.squeeze(self.inputs['Ids'])
@@ -150,5 +165,55 @@ class TestLookupTableWithTensorIdsWIsSelectedRows(
             assert (row == result_array[idx]).all()
 
 
+class TestLookupTableQuantizedW(unittest.TestCase):
+    def setUp(self):
+        self.op_type = "lookup_table"
+        self.padding_idx = -1
+        self.ids = np.random.randint(0, 17, (6, 1)).astype("int64")
+        # The rows of the uint8 table are q * scale + bias.
+        self.table = np.random.randint(0, 256, (17, 31)).astype("uint8")
+        self.scale_bias = np.random.random((17, 2)).astype("float32")
+        self.expected = self.table.astype("float32") * self.scale_bias[:, 0:1]
+        self.expected += self.scale_bias[:, 1:2]
+        self.expected = self.expected[self.ids.flatten()]
+
+    def check_with_place(self, place):
+        scope = core.Scope()
+        scope.var('Ids').get_tensor().set(self.ids, place)
+        scope.var('W').get_tensor().set(self.table, place)
+        inputs = {'W': 'W', 'Ids': 'Ids'}
+        if self.scale_bias is not None:
+            scope.var('WScaleBias').get_tensor().set(self.scale_bias, place)
+            inputs['WScaleBias'] = 'WScaleBias'
+        out_tensor = scope.var('Out').get_tensor()
+
+        op = Operator(
+            self.op_type, Out='Out', padding_idx=self.padding_idx, **inputs)
+        op.run(scope, place)
+        self.assertTrue(
+            np.allclose(
+                np.array(out_tensor), self.expected, atol=1e-5))
+
+    def test_quantized_w(self):
+        places = [core.CPUPlace()]
+        if core.is_compiled_with_cuda():
+            places.append(core.CUDAPlace(0))
+        for place in places:
+            self.check_with_place(place)
+
+
+class TestLookupTableFloat16W(TestLookupTableQuantizedW):
+    def setUp(self):
+        self.op_type = "lookup_table"
+        self.ids = np.random.randint(0, 17, (6, 1)).astype("int64")
+        self.padding_idx = int(self.ids[0, 0])
+        table = np.random.random((17, 31)).astype("float16")
+        # float16 is set as uint16.
+        self.table = table.view(np.uint16)
+        self.scale_bias = None
+        self.expected = table.astype("float32")[self.ids.flatten()]
+        self.expected[self.ids.flatten() == self.padding_idx] = 0
+
+
 if __name__ == "__main__":
     unittest.main()
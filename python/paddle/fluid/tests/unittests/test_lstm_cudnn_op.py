@@ -188,5 +188,68 @@ class TestCUDNNLstmOp(OpTest):
         return core.is_compiled_with_cuda()
 
 
+class TestCUDNNLstmOpLoD(TestCUDNNLstmOp):
+    def setUp(self):
+        self.op_type = "cudnn_lstm"
+        self.dtype = np.float32
+
+        lod = [[3, 5, 2, 5]]
+        hidden_size = 20
+
+        input_weight_size = (hidden_size * hidden_size) * 4
+        hidden_weight_size = (hidden_size * hidden_size) * 4
+        weight_size = input_weight_size + hidden_weight_size
+        weight_size += hidden_size * 8
+
+        input = np.random.uniform(
+            low=-0.1, high=0.1,
+            size=(sum(lod[0]), hidden_size)).astype(self.dtype)
+        flat_w = np.random.uniform(
+            low=-0.1, high=0.1, size=(weight_size)).astype(self.dtype)
+
+        # Each sequence is run alone by the padded lstm.
+        outputs, last_hiddens, last_cells = [], [], []
+        offset = 0
+        for seq_len in lod[0]:
+            seq = input[offset:offset + seq_len].reshape(
+                (seq_len, 1, hidden_size))
+            output, last_hidden, last_cell = lstm_naive(seq, flat_w)
+            outputs.append(output.reshape((seq_len, hidden_size)))
+            last_hiddens.append(last_hidden)
+            last_cells.append(last_cell)
+            offset += seq_len
+
+        batch_size = len(lod[0])
+        init_h = np.zeros((1, batch_size, hidden_size), dtype=np.float32)
+        init_c = np.zeros((1, batch_size, hidden_size), dtype=np.float32)
+        program = fluid.Program()
+        block = program.global_block()
+        block.create_var(
+            name="Cache",
+            persistable=True,
+            type=core.VarDesc.VarType.RAW,
+            stop_gradient=True)
+        self.inputs = {
+            'Input': (OpTest.np_dtype_to_fluid_dtype(input), lod),
+            'W': OpTest.np_dtype_to_fluid_dtype(flat_w),
+            'InitH': OpTest.np_dtype_to_fluid_dtype(init_h),
+            'InitC': OpTest.np_dtype_to_fluid_dtype(init_c),
+        }
+        self.cache_name_list = ['Cache']
+        self.attrs = {
+            'max_len': max(lod[0]),
+            'dropout_prob': 0.0,
+            'is_bidirec': False,
+            'input_size': hidden_size,
+            'hidden_size': hidden_size,
+            'num_layers': 1,
+        }
+        self.outputs = {
+            'Out': (np.concatenate(outputs), lod),
+            'last_h': np.stack(last_hiddens, axis=1).reshape(init_h.shape),
+            'last_c': np.stack(last_cells, axis=1).reshape(init_c.shape)
+        }
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,96 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import os
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+
+DICT_SIZE = 37
+EMB_SIZE = 8
+
+
+def build_program():
+    main = fluid.Program()
+    startup = fluid.Program()
+    startup.random_seed = 1
+    with fluid.program_guard(main, startup):
+        ids = fluid.layers.data(
+            name='ids', shape=[1], dtype='int64', lod_level=1)
+        label = fluid.layers.data(name='label', shape=[1], dtype='int64')
+        emb = fluid.layers.embedding(
+            input=ids,
+            size=[DICT_SIZE, EMB_SIZE],
+            is_sparse=True,
+            param_attr=fluid.ParamAttr(name='emb'))
+        pool = fluid.layers.sequence_pool(input=emb, pool_type='sum')
+        predict = fluid.layers.fc(input=pool, size=2, act='softmax')
+        cost = fluid.layers.cross_entropy(input=predict, label=label)
+        avg_cost = fluid.layers.mean(cost)
+        fluid.optimizer.SGD(learning_rate=0.2).minimize(avg_cost)
+    return main, startup, avg_cost
+
+
+class TestAsyncMode(unittest.TestCase):
+    def setUp(self):
+        np.random.seed(1)
+        self.batches = []
+        for _ in range(8):
+            lod = [np.random.randint(1, 5) for _ in range(8)]
+            ids = np.random.randint(
+                0, DICT_SIZE, size=[sum(lod), 1]).astype('int64')
+            label = (ids[np.cumsum(lod) - 1] % 2).astype('int64')
+            self.batches.append((ids, lod, label))
+
+    def train(self, num_threads, async_mode, passes=1):
+        os.environ['CPU_NUM'] = str(num_threads)
+        main, startup, avg_cost = build_program()
+        place = fluid.CPUPlace()
+        scope = fluid.Scope()
+        with fluid.scope_guard(scope):
+            fluid.Executor(place).run(startup)
+            build_strategy = fluid.BuildStrategy()
+            build_strategy.async_mode = async_mode
+            pe = fluid.ParallelExecutor(
+                use_cuda=False,
+                loss_name=avg_cost.name,
+                main_program=main,
+                build_strategy=build_strategy)
+            losses = []
+            for _ in range(passes):
+                for ids, lod, label in self.batches:
+                    ids_tensor = fluid.create_lod_tensor(ids, [lod], place)
+                    loss, = pe.run(fetch_list=[avg_cost.name],
+                                   feed={'ids': ids_tensor,
+                                         'label': label})
+                    losses.append(np.array(loss))
+        return losses
+
+    def test_one_thread_equals_sync(self):
+        expected = self.train(num_threads=1, async_mode=False)
+        losses = self.train(num_threads=1, async_mode=True)
+        for loss, expect in zip(losses, expected):
+            self.assertTrue(np.allclose(loss, expect, atol=1e-6))
+
+    def test_threads_train_shared_parameters(self):
+        losses = self.train(num_threads=4, async_mode=True, passes=10)
+        # Every thread fetches its own loss.
+        self.assertEqual(losses[0].shape, (4, ))
+        self.assertLess(np.mean(losses[-8:]), np.mean(losses[:8]))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -148,5 +148,42 @@ class TestFeedParallel(unittest.TestCase):
         self.parallel_exe(use_cuda=False, seed=1)
 
 
+class TestFetchOnDevice(unittest.TestCase):
+    def run_pe(self, fetch_on_device):
+        main = fluid.Program()
+        startup = fluid.Program()
+        startup.random_seed = 1
+        with fluid.scope_guard(fluid.core.Scope()):
+            with fluid.program_guard(main, startup):
+                x = fluid.layers.data(name='x', shape=[8], dtype='float32')
+                hidden = fluid.layers.fc(input=x, size=4)
+                loss = fluid.layers.mean(hidden)
+                fluid.optimizer.SGD(learning_rate=0.1).minimize(loss)
+
+            exe = fluid.Executor(fluid.CUDAPlace(0))
+            exe.run(startup)
+            exec_strategy = fluid.ExecutionStrategy()
+            exec_strategy.fetch_on_device = fetch_on_device
+            pe = fluid.ParallelExecutor(
+                use_cuda=True,
+                loss_name=loss.name,
+                main_program=main,
+                exec_strategy=exec_strategy)
+
+            np.random.seed(1)
+            x_np = np.random.random((16, 8)).astype('float32')
+            return pe.run(feed={'x': x_np},
+                          fetch_list=[hidden.name, loss.name])
+
+    def test_fetch_on_device(self):
+        if not core.is_compiled_with_cuda():
+            return
+        expected = self.run_pe(fetch_on_device=False)
+        results = self.run_pe(fetch_on_device=True)
+        for e, r in zip(expected, results):
+            self.assertTrue(np.allclose(e, r))
+        self.assertEqual(expected[0].shape, (16, 4))
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,87 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import os
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+DICT_SIZE = 37
+EMB_SIZE = 8
+
+
+def build_program(is_sharded):
+    main = fluid.Program()
+    startup = fluid.Program()
+    startup.random_seed = 1
+    with fluid.program_guard(main, startup):
+        ids = fluid.layers.data(
+            name='ids', shape=[1], dtype='int64', lod_level=1)
+        label = fluid.layers.data(name='label', shape=[1], dtype='int64')
+        emb = fluid.layers.embedding(
+            input=ids,
+            size=[DICT_SIZE, EMB_SIZE],
+            is_sparse=True,
+            is_sharded=is_sharded,
+            padding_idx=0,
+            param_attr=fluid.ParamAttr(name='emb'))
+        pool = fluid.layers.sequence_pool(input=emb, pool_type='sum')
+        predict = fluid.layers.fc(input=pool, size=2, act='softmax')
+        cost = fluid.layers.cross_entropy(input=predict, label=label)
+        avg_cost = fluid.layers.mean(cost)
+        fluid.optimizer.SGD(learning_rate=0.5).minimize(avg_cost)
+    return main, startup, avg_cost
+
+
+class TestShardedEmbedding(unittest.TestCase):
+    def setUp(self):
+        os.environ['CPU_NUM'] = str(2)
+        np.random.seed(1)
+        self.batches = []
+        for _ in range(4):
+            lod = [np.random.randint(1, 5) for _ in range(8)]
+            ids = np.random.randint(
+                0, DICT_SIZE, size=[sum(lod), 1]).astype('int64')
+            label = np.random.randint(0, 2, size=[8, 1]).astype('int64')
+            self.batches.append((ids, lod, label))
+
+    def train(self, is_sharded):
+        main, startup, avg_cost = build_program(is_sharded)
+        place = fluid.CPUPlace()
+        scope = fluid.Scope()
+        with fluid.scope_guard(scope):
+            fluid.Executor(place).run(startup)
+            pe = fluid.ParallelExecutor(
+                use_cuda=False, loss_name=avg_cost.name, main_program=main)
+            losses = []
+            for ids, lod, label in self.batches:
+                ids_tensor = fluid.create_lod_tensor(ids, [lod], place)
+                loss, = pe.run(fetch_list=[avg_cost.name],
+                               feed={'ids': ids_tensor,
+                                     'label': label})
+                losses.append(np.array(loss))
+        return losses
+
+    def test_sharded_equals_replicated(self):
+        expected = self.train(is_sharded=False)
+        losses = self.train(is_sharded=True)
+        for loss, expect in zip(losses, expected):
+            self.assertTrue(np.allclose(loss, expect, atol=1e-5))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,105 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+
+def build_program(devices):
+    main = fluid.Program()
+    startup = fluid.Program()
+    with fluid.program_guard(main, startup):
+        image = fluid.layers.data(name='image', shape=[16], dtype='float32')
+        label = fluid.layers.data(name='label', shape=[1], dtype='int64')
+        with fluid.device_guard(devices[0]):
+            hidden = fluid.layers.fc(
+                input=image,
+                size=32,
+                act='relu',
+                param_attr=fluid.ParamAttr(name='fc_0.w'),
+                bias_attr=fluid.ParamAttr(name='fc_0.b'))
+        with fluid.device_guard(devices[1]):
+            predict = fluid.layers.fc(
+                input=hidden,
+                size=4,
+                act='softmax',
+                param_attr=fluid.ParamAttr(name='fc_1.w'),
+                bias_attr=fluid.ParamAttr(name='fc_1.b'))
+            cost = fluid.layers.cross_entropy(input=predict, label=label)
+            avg_cost = fluid.layers.mean(cost)
+        fluid.optimizer.SGD(learning_rate=0.1).minimize(avg_cost)
+    return main, startup, avg_cost
+
+
+class TestPipelineExecutor(unittest.TestCase):
+    def setUp(self):
+        np.random.seed(1)
+        self.batches = [{
+            'image': np.random.random([8, 16]).astype('float32'),
+            'label': np.random.randint(
+                0, 4, size=[8, 1]).astype('int64')
+        } for _ in range(3)]
+
+    def run_executor(self):
+        main, startup, avg_cost = build_program([None, None])
+        scope = fluid.Scope()
+        startup.random_seed = 1
+        exe = fluid.Executor(fluid.CPUPlace())
+        exe.run(startup, scope=scope)
+        params = {}
+        for name in ['fc_0.w', 'fc_0.b', 'fc_1.w', 'fc_1.b']:
+            params[name] = np.array(scope.find_var(name).get_tensor())
+        losses = []
+        for batch in self.batches:
+            loss, = exe.run(main,
+                            feed=batch,
+                            fetch_list=[avg_cost.name],
+                            scope=scope)
+            losses.append(loss)
+        return params, losses, np.array(scope.find_var('fc_1.w').get_tensor())
+
+    def test_pipeline(self):
+        params, losses, expected_w = self.run_executor()
+
+        main, startup, avg_cost = build_program(['cpu:0', 'cpu:1'])
+        for op in main.global_block().ops:
+            self.assertTrue(op.has_attr('op_device'))
+        scope = fluid.Scope()
+        exe = fluid.Executor(fluid.CPUPlace())
+        exe.run(startup, scope=scope)
+        for name, value in params.items():
+            scope.find_var(name).get_tensor().set(value, fluid.CPUPlace())
+
+        pipeline = fluid.PipelineExecutor(
+            num_micro_batches=2, main_program=main, scope=scope)
+        self.assertEqual(pipeline.num_stages, 2)
+        for batch, expected in zip(self.batches, losses):
+            loss, = pipeline.run(fetch_list=[avg_cost.name], feed=batch)
+            # The mean of each micro-batch is fetched.
+            self.assertEqual(loss.shape, (2, ))
+            self.assertTrue(np.allclose(loss.mean(), expected, atol=1e-5))
+        pipeline.sync_parameters()
+        self.assertTrue(
+            np.allclose(
+                np.array(scope.find_var('fc_1.w').get_tensor()),
+                expected_w,
+                atol=1e-5))
+
+
+if __name__ == '__main__':
+    unittest.main()
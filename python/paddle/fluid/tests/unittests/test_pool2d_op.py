@@ -123,12 +123,16 @@ class TestPool2D_Op(OpTest):
         self.init_ceil_mode()
         self.init_exclusive()
         self.init_adaptive()
+        self.init_data_format()
         if self.global_pool:
             self.paddings = [0 for _ in range(len(self.paddings))]
         input = np.random.random(self.shape).astype(self.dtype)
         output = self.pool2D_forward_naive(
             input, self.ksize, self.strides, self.paddings, self.global_pool,
             self.ceil_mode, self.exclusive, self.adaptive).astype(self.dtype)
+        if self.data_format == "NHWC":
+            input = input.transpose((0, 2, 3, 1))
+            output = output.transpose((0, 2, 3, 1))
         self.inputs = {'X': OpTest.np_dtype_to_fluid_dtype(input)}
 
         self.attrs = {
@@ -140,8 +144,7 @@ class TestPool2D_Op(OpTest):
             'use_cudnn': self.use_cudnn,
             'use_mkldnn': self.use_mkldnn,
             'ceil_mode': self.ceil_mode,
-            'data_format':
-            'AnyLayout',  # TODO(dzhwinter) : should be fix latter
+            'data_format': self.data_format,
             'exclusive': self.exclusive,
             'adaptive': self.adaptive
         }
@@ -196,6 +199,9 @@ class TestPool2D_Op(OpTest):
     def init_adaptive(self):
         self.adaptive = False
 
+    def init_data_format(self):
+        self.data_format = "AnyLayout"
+
 
 class TestCase1(TestPool2D_Op):
     def init_test_case(self):
@@ -357,5 +363,24 @@ class TestAvgPoolAdaptive(TestCase1):
         self.adaptive = True
 
 
+def create_test_nhwc_class(parent):
+    class TestPool2DNHWCCase(parent):
+        def init_data_format(self):
+            self.data_format = "NHWC"
+
+    cls_name = "{0}_{1}".format(parent.__name__, "NHWC")
+    TestPool2DNHWCCase.__name__ = cls_name
+    globals()[cls_name] = TestPool2DNHWCCase
+
+
+create_test_nhwc_class(TestPool2D_Op)
+create_test_nhwc_class(TestCase1)
+create_test_nhwc_class(TestCase2)
+create_test_nhwc_class(TestCase3)
+create_test_nhwc_class(TestCase5)
+create_test_nhwc_class(TestAvgInclude)
+create_test_nhwc_class(TestAvgPoolAdaptive)
+
+
 if __name__ == '__main__':
     unittest.main()
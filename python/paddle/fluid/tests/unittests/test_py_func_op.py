@@ -179,5 +179,62 @@ class TestPyFuncOpUseParallelExecutor(TestPyFuncOpUseExecutor):
         self.use_parallel_executor = True
 
 
+def zero_copy_tanh(x):
+    assert isinstance(x, np.ndarray) and not x.flags.writeable
+    return np.tanh(x)
+
+
+class TestPyFuncOpZeroCopy(unittest.TestCase):
+    def run_tanh(self, use_py_func_op):
+        with fluid.program_guard(fluid.Program(), fluid.Program()):
+            x = fluid.layers.data(name='x', shape=[32], dtype='float32')
+            if use_py_func_op:
+                out = fluid.default_main_program().current_block().create_var(
+                    name='out', dtype='float32', shape=x.shape)
+                fluid.layers.py_func(
+                    func=zero_copy_tanh, x=x, out=out, zero_copy=True)
+            else:
+                out = fluid.layers.tanh(x)
+            exe = fluid.Executor(fluid.CPUPlace())
+            np.random.seed(1)
+            ret = []
+            for _ in six.moves.range(3):
+                data = np.random.random([8, 32]).astype('float32')
+                L, = exe.run(feed={'x': data}, fetch_list=[out])
+                ret.append(L)
+            return np.array(ret)
+
+    def test_zero_copy(self):
+        expected = self.run_tanh(use_py_func_op=False)
+        actual = self.run_tanh(use_py_func_op=True)
+        self.assertTrue(np.allclose(expected, actual, atol=1e-6))
+
+
+class TestPyFuncOpRunAsync(unittest.TestCase):
+    def test_run_async(self):
+        sums = []
+
+        def collect(x):
+            sums.append(float(np.sum(x)))
+
+        with fluid.program_guard(fluid.Program(), fluid.Program()):
+            x = fluid.layers.data(name='x', shape=[4], dtype='float32')
+            fluid.layers.py_func(
+                func=collect, x=x, out=None, zero_copy=True, run_async=True)
+            exe = fluid.Executor(fluid.CPUPlace())
+            for i in six.moves.range(10):
+                data = np.full([2, 4], i, dtype='float32')
+                exe.run(feed={'x': data}, fetch_list=[])
+            fluid.core._wait_py_func_calls()
+
+        self.assertEqual(sums, [8.0 * i for i in six.moves.range(10)])
+
+    def test_run_async_with_out(self):
+        with fluid.program_guard(fluid.Program(), fluid.Program()):
+            x = fluid.layers.data(name='x', shape=[4], dtype='float32')
+            with self.assertRaises(ValueError):
+                fluid.layers.py_func(func=tanh, x=x, out=x, run_async=True)
+
+
 if __name__ == '__main__':
     unittest.main()
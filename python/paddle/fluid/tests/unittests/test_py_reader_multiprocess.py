@@ -0,0 +1,75 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import functools
+import os
+import unittest
+
+import numpy as np
+import paddle.fluid as fluid
+
+BATCH_NUM = 8
+
+
+def tensor_provider(worker_id):
+    for i in range(BATCH_NUM):
+        value = worker_id * BATCH_NUM + i
+        image = np.full([4, 3], value, dtype='float32')
+        label = np.full([4, 1], value, dtype='int64')
+        yield [image, label]
+
+
+@unittest.skipIf(os.name == 'nt', "shared memory is not supported on Windows")
+class TestMultiprocessPyReader(unittest.TestCase):
+    def setUp(self):
+        self.num_workers = 2
+
+    def test_main(self):
+        with fluid.program_guard(fluid.Program(), fluid.Program()):
+            reader = fluid.layers.py_reader(
+                capacity=4,
+                shapes=[[-1, 3], [-1, 1]],
+                dtypes=['float32', 'int64'],
+                use_double_buffer=False)
+            image, label = fluid.layers.read_file(reader)
+            exe = fluid.Executor(fluid.CPUPlace())
+            exe.run(fluid.default_startup_program())
+
+            reader.decorate_multiprocess_tensor_provider(
+                [
+                    functools.partial(tensor_provider, i)
+                    for i in range(self.num_workers)
+                ],
+                segment_size=1 << 16)
+            for _ in range(2):
+                values = []
+                reader.start()
+                try:
+                    while True:
+                        image_np, label_np = exe.run(
+                            fetch_list=[image, label])
+                        self.assertEqual(image_np.shape, (4, 3))
+                        self.assertTrue((image_np == image_np[0, 0]).all())
+                        self.assertTrue((label_np == label_np[0, 0]).all())
+                        values.append(int(label_np[0, 0]))
+                except fluid.core.EOFException:
+                    reader.reset()
+                self.assertEqual(
+                    sorted(values), list(range(self.num_workers * BATCH_NUM)))
+
+
+if __name__ == '__main__':
+    unittest.main()
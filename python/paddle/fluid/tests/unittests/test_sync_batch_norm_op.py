@@ -0,0 +1,112 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import os
+import unittest
+import numpy as np
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+
+BATCH_SIZE = 8
+
+
+def build_program(data_layout):
+    main = fluid.Program()
+    startup = fluid.Program()
+    startup.random_seed = 1
+    with fluid.program_guard(main, startup):
+        shape = [3, 6, 6] if data_layout == 'NCHW' else [6, 6, 3]
+        image = fluid.layers.data(name='image', shape=shape, dtype='float32')
+        bn = fluid.layers.batch_norm(
+            input=image,
+            data_layout=data_layout,
+            param_attr=fluid.ParamAttr(name='bn_scale'),
+            bias_attr=fluid.ParamAttr(name='bn_bias'),
+            moving_mean_name='bn_mean',
+            moving_variance_name='bn_variance')
+        out = fluid.layers.fc(input=bn, size=1,
+                              param_attr=fluid.ParamAttr(name='fc_w'))
+        avg_cost = fluid.layers.mean(fluid.layers.square(out))
+        fluid.optimizer.SGD(learning_rate=0.1).minimize(avg_cost)
+    return main, startup, avg_cost
+
+
+@unittest.skipIf(not core.is_compiled_with_cuda() or
+                 core.get_cuda_device_count() < 2,
+                 "sync_batch_norm needs at least 2 GPUs")
+class TestSyncBatchNorm(unittest.TestCase):
+    data_layout = 'NCHW'
+
+    def setUp(self):
+        os.environ['FLAGS_selected_gpus'] = '0,1'
+        np.random.seed(1)
+        shape = [BATCH_SIZE, 3, 6, 6] if self.data_layout == 'NCHW' else [
+            BATCH_SIZE, 6, 6, 3
+        ]
+        # The devices see very different mini-batches.
+        self.batches = []
+        for _ in range(3):
+            image = np.random.random(shape).astype('float32')
+            image[BATCH_SIZE // 2:] = image[BATCH_SIZE // 2:] * 4 + 10
+            self.batches.append(image)
+        self.params = ['bn_scale', 'bn_bias', 'bn_mean', 'bn_variance', 'fc_w']
+
+    def train(self, sync):
+        main, startup, avg_cost = build_program(self.data_layout)
+        place = fluid.CUDAPlace(0)
+        scope = fluid.Scope()
+        with fluid.scope_guard(scope):
+            fluid.Executor(place).run(startup)
+            if sync:
+                build_strategy = fluid.BuildStrategy()
+                build_strategy.sync_batch_norm = True
+                exe = fluid.ParallelExecutor(
+                    use_cuda=True,
+                    loss_name=avg_cost.name,
+                    main_program=main,
+                    build_strategy=build_strategy)
+                run = lambda image: exe.run(fetch_list=[avg_cost.name],
+                                            feed={'image': image})
+            else:
+                exe = fluid.Executor(place)
+                run = lambda image: exe.run(main,
+                                            fetch_list=[avg_cost.name],
+                                            feed={'image': image})
+            for image in self.batches:
+                run(image)
+            return [
+                np.array(scope.find_var(name).get_tensor())
+                for name in self.params
+            ]
+
+    def test_equals_the_whole_batch(self):
+        # The statistics of all the devices are the ones of the whole batch,
+        # so the gradients and the running stats are the same as on one GPU.
+        expected = self.train(sync=False)
+        values = self.train(sync=True)
+        for name, value, expect in zip(self.params, values, expected):
+            self.assertTrue(
+                np.allclose(
+                    value, expect, rtol=1e-4, atol=1e-4),
+                "%s: %s vs %s" % (name, value, expect))
+
+
+class TestSyncBatchNormNHWC(TestSyncBatchNorm):
+    data_layout = 'NHWC'
+
+
+if __name__ == '__main__':
+    unittest.main()
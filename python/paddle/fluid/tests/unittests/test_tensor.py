@@ -183,6 +183,37 @@ class TestTensor(unittest.TestCase):
             tensor_array = numpy.array(tensor)
             self.assertEqual((0, 1), tensor_array.shape)
 
+    def test_share_data_with_array(self):
+        array = numpy.random.random((3, 4)).astype('float32')
+        tensor = core.LoDTensor()
+        tensor._share_data_with_array(array)
+        self.assertEqual([3, 4], tensor.shape())
+
+        view = tensor._as_array()
+        self.assertTrue(numpy.array_equal(array, view))
+        view[1, 2] = 10.0
+        self.assertEqual(10.0, array[1, 2])
+
+        # The tensor keeps the array alive.
+        del array
+        self.assertTrue(numpy.array_equal(view, numpy.array(tensor)))
+
+    def test_dlpack(self):
+        array = numpy.arange(6).reshape((2, 3)).astype('int64')
+        src = core.LoDTensor()
+        src.set(array, core.CPUPlace())
+        capsule = src._to_dlpack()
+
+        dst = core.LoDTensor()
+        dst._from_dlpack(capsule)
+        self.assertTrue(numpy.array_equal(array, numpy.array(dst)))
+        src._as_array()[0, 0] = 100
+        self.assertEqual(100, numpy.array(dst)[0, 0])
+
+        # The capsule is taken by dst.
+        self.assertRaises(core.EnforceNotMet, core.LoDTensor()._from_dlpack,
+                          capsule)
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -129,5 +129,60 @@ class TestTopkOp5(TestTopkOp):
         self.variable_k = True
 
 
+class TestTopkOpLargeK(TestTopkOp):
+    # The GPU kernel selects the large k by the radix select.
+    def set_args(self):
+        self.row = 16
+        self.top_k = 200
+
+
+class TestTopkOpLongRow(OpTest):
+    def setUp(self):
+        self.op_type = "top_k"
+        k = 7
+        # Distinct values, so that the indices of the ties are not compared.
+        input = np.random.permutation(3 * 50000).reshape(
+            (3, 50000)).astype("float32")
+        self.inputs = {'X': input}
+        self.attrs = {'k': k}
+        self.outputs = {
+            'Out': -np.sort(-input, axis=1)[:, :k],
+            'Indices': np.argsort(-input, axis=1)[:, :k].astype("int64")
+        }
+
+    def test_check_output(self):
+        self.check_output()
+
+
+class TestTopkOpSegmented(OpTest):
+    def setUp(self):
+        self.op_type = "top_k"
+        k = 4
+        lod = [[3, 7, 0, 5]]
+        input = np.random.permutation(15).reshape((15, 1)).astype("float32")
+        output = []
+        indices = []
+        out_lod = []
+        begin = 0
+        for length in lod[0]:
+            seq = input[begin:begin + length, 0]
+            count = min(k, length)
+            output.extend(-np.sort(-seq)[:count])
+            indices.extend(np.argsort(-seq)[:count])
+            out_lod.append(count)
+            begin += length
+        self.inputs = {'X': (input, lod)}
+        self.attrs = {'k': k, 'segmented': True}
+        self.outputs = {
+            'Out': (np.array(output).reshape((-1, 1)).astype("float32"),
+                    [out_lod]),
+            'Indices': (np.array(indices).reshape((-1, 1)).astype("int64"),
+                        [out_lod])
+        }
+
+    def test_check_output(self):
+        self.check_output()
+
+
 if __name__ == "__main__":
     unittest.main()
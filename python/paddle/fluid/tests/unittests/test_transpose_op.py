@@ -78,5 +78,19 @@ class TestCase4(TestTransposeOp):
         self.axis = (4, 2, 3, 1, 0, 5)
 
 
+class TestCaseKeepInnerDim(TestTransposeOp):
+    # [B, S, H, D] -> [B, H, S, D] of the attention copies the runs of D.
+    def initTestCase(self):
+        self.shape = (2, 5, 4, 8)
+        self.axis = (0, 2, 1, 3)
+
+
+class TestCaseTiled(TestTransposeOp):
+    # [N, C, H, W] -> [N, H, W, C] is the tiled transpose of [C, H * W].
+    def initTestCase(self):
+        self.shape = (2, 40, 6, 7)
+        self.axis = (0, 2, 3, 1)
+
+
 if __name__ == '__main__':
     unittest.main()
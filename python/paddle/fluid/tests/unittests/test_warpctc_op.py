@@ -184,6 +184,7 @@ class TestWarpCTCOp(OpTest):
         self.blank = self.num_classes - 1
         self.norm_by_times = False
         self.use_cudnn = False
+        self.use_native = False
 
     def setUp(self):
         self.op_type = "warpctc"
@@ -207,9 +208,12 @@ class TestWarpCTCOp(OpTest):
         for i in range(self.batch_size):
             max_sequence_length = max(max_sequence_length,
                                       self.logits_lod[0][i])
-        self.gradient = np.zeros(
-            [max_sequence_length, self.batch_size, self.num_classes],
-            dtype="float32")
+        if self.use_native:
+            self.gradient = np.zeros(logits.shape, dtype="float32")
+        else:
+            self.gradient = np.zeros(
+                [max_sequence_length, self.batch_size, self.num_classes],
+                dtype="float32")
 
         self.inputs = {
             "Logits": (logits, self.logits_lod),
@@ -219,7 +223,8 @@ class TestWarpCTCOp(OpTest):
         self.attrs = {
             "blank": self.blank,
             "norm_by_times": self.norm_by_times,
-            "use_cudnn": self.use_cudnn
+            "use_cudnn": self.use_cudnn,
+            "use_native": self.use_native
         }
 
     def test_check_output(self):
@@ -241,6 +246,30 @@ class TestWarpCTCOpCase1(TestWarpCTCOp):
         self.use_cudnn = False
 
 
+class TestNativeCTCOp(TestWarpCTCOp):
+    def config(self):
+        self.batch_size = 4
+        self.num_classes = 8
+        self.logits_lod = [[4, 1, 3, 3]]
+        self.labels_lod = [[3, 1, 4, 4]]
+        self.blank = 0
+        self.norm_by_times = False
+        self.use_cudnn = False
+        self.use_native = True
+
+
+class TestNativeCTCOpNormByTimes(TestWarpCTCOp):
+    def config(self):
+        self.batch_size = 4
+        self.num_classes = CUDA_BLOCK_SIZE + 2
+        self.logits_lod = [[5, 2, 7, 3]]
+        self.labels_lod = [[3, 1, 4, 2]]
+        self.blank = self.num_classes - 1
+        self.norm_by_times = True
+        self.use_cudnn = False
+        self.use_native = True
+
+
 class TestCudnnCTCOp(TestWarpCTCOp):
     def config(self):
         self.batch_size = 4
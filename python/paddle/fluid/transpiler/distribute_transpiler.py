@@ -53,6 +53,11 @@ OPT_OP_ROLE_ATTR_VALUE = core.op_proto_and_checker_maker.OpRole.Optimize
 RPC_OP_ROLE_ATTR_VALUE = core.op_proto_and_checker_maker.OpRole.RPC
 DIST_OP_ROLE_ATTR_VALUE = core.op_proto_and_checker_maker.OpRole.Dist
 LR_SCHED_OP_ROLE_ATTR_VALUE = core.op_proto_and_checker_maker.OpRole.LRSched
+BACKWARD_OP_ROLE_ATTR_VALUE = core.op_proto_and_checker_maker.OpRole.Backward
+DGC_COUNTER_NAME = "@DGC_COUNTER@"
+GEO_SGD_STEP_NAME = "@GEO_SGD_STEP@"
+# NOTE: the suffix is used by geo_sgd_send_op
+GEO_SGD_DELTA_SUFFIX = ".delta"
 
 PRINT_LOG = False
 
@@ -142,6 +147,64 @@ class DistributeTranspilerConfig(object):
           We can use bandwidth effiently when data size is larger than 2MB.If you
           want to change it, please be sure you have read the slice_variable function.
 
+    .. py:attribute:: enable_dgc (bool)
+
+          Only used in pserver mode. Send the dense gradients with deep
+          gradient compression: every trainer accumulates the gradients
+          locally with momentum correction and only sends the rows with the
+          largest norms as SelectedRows, default is False. Since the momentum
+          is applied by the trainers, use SGD as the optimizer.
+
+    .. py:attribute:: dgc_momentum (float)
+
+          The momentum used by the correction of deep gradient compression.
+
+    .. py:attribute:: dgc_sparsity (list)
+
+          The sparsity used during and after the warm-up of deep gradient
+          compression.
+
+    .. py:attribute:: dgc_rampup_begin_step (int)
+
+          The step from which the gradients are compressed.
+
+    .. py:attribute:: dgc_rampup_step (int)
+
+          The number of steps the sparsity goes through dgc_sparsity.
+
+    .. py:attribute:: use_hierarchical_allreduce (bool)
+
+          Only used in nccl2 mode. Generate the extra NCCL ids needed by
+          BuildStrategy.use_hierarchical_allreduce, default is False.
+
+    .. py:attribute:: hierarchical_allreduce_num_local_devices (int)
+
+          The number of devices used by each trainer, must be set when
+          use_hierarchical_allreduce is True.
+
+    .. py:attribute:: geo_sgd_mode (bool)
+
+          Only used in async pserver mode. The trainers run the optimizer on
+          their local parameters and only push the parameter deltas, as
+          SelectedRows of the updated rows for the sparse parameters, every
+          geo_sgd_need_push_nums steps. The pservers add the deltas and
+          return the fresh parameters. The parameters are not sliced in
+          this mode, default is False.
+
+    .. py:attribute:: geo_sgd_need_push_nums (int)
+
+          The number of the local steps between two pushes of geo_sgd_mode.
+
+    .. py:attribute:: overlap_recv (bool)
+
+          Only used in sync pserver mode. Receive the parameters at the
+          beginning of the next step instead of at the end of the current
+          one, and let every forward op start as soon as its own parameters
+          arrive rather than after the fetch barrier. The parameters are
+          not received by the trainer startup program, and the trainer
+          holds the parameters of the previous step when the training
+          ends, default is False.
+
     """
 
     slice_var_up = True
@@ -152,6 +215,16 @@ class DistributeTranspilerConfig(object):
     mode = "pserver"
     print_log = False
     wait_port = True
+    use_hierarchical_allreduce = False
+    hierarchical_allreduce_num_local_devices = 0
+    enable_dgc = False
+    dgc_momentum = 0.9
+    dgc_sparsity = [0.75, 0.9375, 0.984375, 0.996, 0.999]
+    dgc_rampup_begin_step = 0
+    dgc_rampup_step = 1
+    geo_sgd_mode = False
+    geo_sgd_need_push_nums = 100
+    overlap_recv = False
 
 
 class DistributeTranspiler(object):
@@ -236,10 +309,25 @@ class DistributeTranspiler(object):
 
             nccl_id_var = startup_program.global_block().create_var(
                 name="NCCLID", persistable=True, type=core.VarDesc.VarType.RAW)
+            outputs = {"NCCLID": nccl_id_var}
+            if self.config.use_hierarchical_allreduce:
+                num_local_devices = \
+                    self.config.hierarchical_allreduce_num_local_devices
+                if num_local_devices <= 0:
+                    raise ValueError(
+                        "hierarchical_allreduce_num_local_devices must be "
+                        "set when use_hierarchical_allreduce is True")
+                outputs["InterNCCLID"] = [
+                    startup_program.global_block().create_var(
+                        name="NCCLID_INTER_%d" % i,
+                        persistable=True,
+                        type=core.VarDesc.VarType.RAW)
+                    for i in range(num_local_devices)
+                ]
             startup_program.global_block().append_op(
                 type="gen_nccl_id",
                 inputs={},
-                outputs={"NCCLID": nccl_id_var},
+                outputs=outputs,
                 attrs={
                     "endpoint": current_endpoint,
                     "endpoint_list": worker_endpoints,
@@ -249,6 +337,292 @@ class DistributeTranspiler(object):
         else:
             raise ValueError("must set trainer_id > 0")
 
+    def _create_dgc_counter(self):
+        main_block = self.origin_program.global_block()
+        counter = main_block.create_var(
+            name=DGC_COUNTER_NAME,
+            dtype=core.VarDesc.VarType.INT64,
+            shape=[1],
+            persistable=True)
+        startup_block = self.startup_program.global_block()
+        startup_counter = startup_block.create_var(
+            name=DGC_COUNTER_NAME,
+            dtype=core.VarDesc.VarType.INT64,
+            shape=[1],
+            persistable=True)
+        startup_block.append_op(
+            type="fill_constant",
+            outputs={"Out": startup_counter},
+            attrs={
+                "shape": [1],
+                "dtype": startup_counter.dtype,
+                "value": -1.0,
+                "force_cpu": True
+            })
+        main_block._prepend_op(
+            type="increment",
+            inputs={"X": [counter]},
+            outputs={"Out": [counter]},
+            attrs={"step": 1.0})
+        return counter
+
+    def _create_dgc_state(self, param, suffix):
+        name = unique_name.generate("%s_dgc_%s" % (param.name, suffix))
+        var = self.origin_program.global_block().create_var(
+            name=name, dtype=param.dtype, shape=param.shape, persistable=True)
+        startup_block = self.startup_program.global_block()
+        startup_var = startup_block.create_var(
+            name=name, dtype=param.dtype, shape=param.shape, persistable=True)
+        startup_block.append_op(
+            type="fill_constant",
+            outputs={"Out": startup_var},
+            attrs={
+                "shape": param.shape,
+                "dtype": param.dtype,
+                "value": 0.0
+            })
+        return var
+
+    def _insert_dgc_ops(self):
+        """
+        Let the backward ops write the dense gradient to grad@DENSE and
+        insert a dgc op that turns it into the SelectedRows grad, so that
+        the rest of the transpiler sends it like any sparse gradient.
+        """
+        block = self.origin_program.global_block()
+        counter = None
+        for param_var, grad_var in self.params_grads:
+            if grad_var.type != core.VarDesc.VarType.LOD_TENSOR:
+                continue
+            if counter is None:
+                counter = self._create_dgc_counter()
+
+            dense_name = grad_var.name + "@DENSE"
+            dense_var = block.create_var(
+                name=dense_name,
+                dtype=grad_var.dtype,
+                shape=grad_var.shape,
+                type=core.VarDesc.VarType.LOD_TENSOR)
+            for op in block.ops:
+                if self._is_opt_role_op(op):
+                    continue
+                if grad_var.name in op.output_arg_names:
+                    op._rename_output(grad_var.name, dense_name)
+                if grad_var.name in op.input_arg_names:
+                    op._rename_input(grad_var.name, dense_name)
+                if op.has_attr(OP_ROLE_VAR_ATTR_NAME):
+                    role_vars = op.attr(OP_ROLE_VAR_ATTR_NAME)
+                    if grad_var.name in role_vars:
+                        op._set_attr(OP_ROLE_VAR_ATTR_NAME, [
+                            dense_name if v == grad_var.name else v
+                            for v in role_vars
+                        ])
+            grad_var.desc.set_type(core.VarDesc.VarType.SELECTED_ROWS)
+
+            u_var = self._create_dgc_state(param_var, "u")
+            v_var = self._create_dgc_state(param_var, "v")
+            index = find_op_by_output_arg(block, dense_name, reverse=True)
+            block._insert_op(
+                index=index + 1,
+                type="dgc",
+                inputs={
+                    "U": u_var,
+                    "V": v_var,
+                    "Grad": dense_var,
+                    "CurrentStep": counter
+                },
+                outputs={
+                    "UOut": u_var,
+                    "VOut": v_var,
+                    "EncodeGrad": grad_var
+                },
+                attrs={
+                    "m": self.config.dgc_momentum,
+                    "sparsity": self.config.dgc_sparsity,
+                    "rampup_begin_step": self.config.dgc_rampup_begin_step,
+                    "rampup_step": self.config.dgc_rampup_step,
+                    RPC_OP_ROLE_ATTR_NAME: BACKWARD_OP_ROLE_ATTR_VALUE
+                })
+
+    def _transpile_geo_sgd(self):
+        """
+        Keep the optimize ops in the trainer program and append a
+        geo_sgd_send op, which pushes the parameter deltas to the pservers
+        every geo_sgd_need_push_nums steps and gets the fresh parameters.
+        Every parameter is placed on one pserver as a whole.
+        """
+        assert not self.sync_mode, "geo_sgd_mode only supports async training"
+        if find_distributed_lookup_table(self.origin_program) is not None:
+            raise ValueError(
+                "geo_sgd_mode does not support the distributed lookup table")
+        program = self.origin_program
+        block = program.global_block()
+        self.table_name = None
+        self.has_distributed_lookup_table = False
+        program._is_distributed = True
+        program._endpoints = self.pserver_endpoints
+        program._is_chief = self.trainer_id == 0
+        program._distributed_lookup_table = None
+
+        params = []
+        param_names = set()
+        self.geo_sgd_sparse_params = []
+        for param_var, grad_var in self.params_grads:
+            if type(param_var) == Parameter and param_var.trainable == False:
+                continue
+            if param_var.name in param_names:
+                continue
+            params.append(param_var)
+            param_names.add(param_var.name)
+            if grad_var.type == core.VarDesc.VarType.SELECTED_ROWS:
+                self.geo_sgd_sparse_params.append(param_var.name)
+
+        ps_dispatcher = self.config.split_method(self.pserver_endpoints)
+        eplist = ps_dispatcher.dispatch(params)
+        self.param_grad_ep_mapping = collections.OrderedDict()
+        for ep in self.pserver_endpoints:
+            self.param_grad_ep_mapping[ep] = {"params": [], "grads": []}
+        for param, ep in zip(params, eplist):
+            self.param_grad_ep_mapping[ep]["params"].append(param)
+
+        step = self._create_geo_sgd_step()
+        olds = [self._create_geo_sgd_old(param) for param in params]
+        block.append_op(
+            type="geo_sgd_send",
+            inputs={"X": params,
+                    "Old": olds,
+                    "Step": step},
+            outputs={"Out": params,
+                     "OldOut": olds},
+            attrs={
+                "epmap": eplist,
+                "trainer_id": self.trainer_id,
+                "trainers": self.trainer_num,
+                "push_nums": self.config.geo_sgd_need_push_nums,
+                "sparse_params": self.geo_sgd_sparse_params,
+                RPC_OP_ROLE_ATTR_NAME: RPC_OP_ROLE_ATTR_VALUE
+            })
+
+        # all the trainers start from the parameters on the pservers
+        startup_block = self.startup_program.global_block()
+        for param, ep in zip(params, eplist):
+            startup_block.append_op(
+                type="recv",
+                inputs={"X": []},
+                outputs={"Out": [startup_block.vars[param.name]]},
+                attrs={
+                    "epmap": [ep],
+                    RPC_OP_ROLE_ATTR_NAME: RPC_OP_ROLE_ATTR_VALUE
+                })
+        fetch_barrier_out = startup_block.create_var(
+            name=framework.generate_control_dev_var_name())
+        startup_block.append_op(
+            type="fetch_barrier",
+            inputs={},
+            outputs={"Out": fetch_barrier_out},
+            attrs={
+                "endpoints": self.pserver_endpoints,
+                RPC_OP_ROLE_ATTR_NAME: RPC_OP_ROLE_ATTR_VALUE
+            })
+        for param, old in zip(params, olds):
+            startup_block.append_op(
+                type="assign",
+                inputs={"X": startup_block.vars[param.name]},
+                outputs={"Out": startup_block.vars[old.name]})
+
+    def _create_geo_sgd_step(self):
+        main_block = self.origin_program.global_block()
+        step = main_block.create_var(
+            name=GEO_SGD_STEP_NAME,
+            dtype=core.VarDesc.VarType.INT64,
+            shape=[1],
+            persistable=True)
+        startup_block = self.startup_program.global_block()
+        startup_step = startup_block.create_var(
+            name=GEO_SGD_STEP_NAME,
+            dtype=core.VarDesc.VarType.INT64,
+            shape=[1],
+            persistable=True)
+        startup_block.append_op(
+            type="fill_constant",
+            outputs={"Out": startup_step},
+            attrs={
+                "shape": [1],
+                "dtype": startup_step.dtype,
+                "value": 0.0,
+                "force_cpu": True
+            })
+        main_block._prepend_op(
+            type="increment",
+            inputs={"X": [step]},
+            outputs={"Out": [step]},
+            attrs={"step": 1.0})
+        return step
+
+    def _create_geo_sgd_old(self, param):
+        name = unique_name.generate("%s_geo_sgd_old" % param.name)
+        var = self.origin_program.global_block().create_var(
+            name=name, dtype=param.dtype, shape=param.shape, persistable=True)
+        self.startup_program.global_block().create_var(
+            name=name, dtype=param.dtype, shape=param.shape, persistable=True)
+        return var
+
+    def _get_geo_sgd_pserver_program(self, endpoint):
+        """
+        Every optimize block of the pserver adds the delta of a parameter
+        sent by the trainers to the parameter.
+        """
+        pserver_program = Program()
+        pserver_program.random_seed = self.origin_program.random_seed
+        recv_inputs = []
+        optimize_blocks = []
+        grad_to_block_id = []
+        for param in self.param_grad_ep_mapping[endpoint]["params"]:
+            param_var = self._clone_var(pserver_program.global_block(), param)
+            if param.name in self.geo_sgd_sparse_params:
+                delta_type = core.VarDesc.VarType.SELECTED_ROWS
+            else:
+                delta_type = core.VarDesc.VarType.LOD_TENSOR
+            delta_var = pserver_program.global_block().create_var(
+                name=param.name + GEO_SGD_DELTA_SUFFIX,
+                persistable=True,
+                type=delta_type,
+                dtype=param.dtype,
+                shape=param.shape)
+            recv_inputs.append(delta_var)
+
+            per_opt_block = pserver_program._create_block(0)
+            optimize_blocks.append(per_opt_block)
+            per_opt_block.append_op(
+                type="sum",
+                inputs={"X": [param_var, delta_var]},
+                outputs={"Out": param_var})
+            grad_to_block_id.append(delta_var.name + ":" + str(
+                per_opt_block.idx))
+
+        if len(optimize_blocks) == 0:
+            logging.warn("pserver [" + str(endpoint) +
+                         "] has no optimize block!!")
+            empty_block = pserver_program._create_block(0)
+            optimize_blocks.append(empty_block)
+
+        pserver_program.global_block().append_op(
+            type="listen_and_serv",
+            inputs={'X': recv_inputs},
+            outputs={},
+            attrs={
+                "optimize_blocks": optimize_blocks,
+                "endpoint": endpoint,
+                "Fanin": self.trainer_num,
+                "sync_mode": False,
+                "grad_to_block_id": grad_to_block_id,
+            })
+
+        pserver_program._slice_vars_and_attrs = []
+        pserver_program._sync_with_cpp()
+        self.pserver_program = pserver_program
+        return pserver_program
+
     def _get_all_remote_sparse_update_op(self, main_program):
         sparse_update_ops = []
         sparse_update_op_types = ["lookup_table", "nce", "hierarchical_sigmoid"]
@@ -328,6 +702,13 @@ class DistributeTranspiler(object):
         pserver_endpoints = pservers.split(",")
         self.pserver_endpoints = pserver_endpoints
         self.optimize_ops, self.params_grads = self._get_optimize_pass()
+        if self.config.geo_sgd_mode:
+            self._transpile_geo_sgd()
+            return
+        if self.config.overlap_recv:
+            assert self.sync_mode, "overlap_recv only supports sync training"
+        if self.config.enable_dgc:
+            self._insert_dgc_ops()
 
         ps_dispatcher = self.config.split_method(self.pserver_endpoints)
         self.table_name = find_distributed_lookup_table(self.origin_program)
@@ -455,6 +836,20 @@ class DistributeTranspiler(object):
             self.param_grad_ep_mapping[ep]["grads"].append(send_vars[i])
 
         # step4: Concat the parameters splits together after recv.
+        # In overlap_recv mode the recv ops are inserted at the beginning of
+        # the program, so the forward ops only depend on the recv of their
+        # own parameters.
+        overlap_recv = self.sync_mode and self.config.overlap_recv
+        recv_op_num = [0]
+
+        def __append_recv_op__(**kwargs):
+            if overlap_recv:
+                program.global_block()._insert_op(
+                    index=recv_op_num[0], **kwargs)
+                recv_op_num[0] += 1
+            else:
+                program.global_block().append_op(**kwargs)
+
         all_recv_outputs = []
         for param_varname, splited_var in six.iteritems(self.param_var_mapping):
             eps = []
@@ -463,7 +858,9 @@ class DistributeTranspiler(object):
                 index = [v.name for v in recv_vars].index(var.name)
                 eps.append(eplist[index])
                 table_names.append(var.name)
-            if self.sync_mode:
+            if overlap_recv:
+                recv_dep_in = None
+            elif self.sync_mode:
                 recv_dep_in = send_barrier_out
             else:
                 # connect deps to send op in async mode
@@ -486,9 +883,11 @@ class DistributeTranspiler(object):
                     param_varname, height_sections, eps, table_names)
             else:
                 all_recv_outputs.extend(splited_var)
-                program.global_block().append_op(
+                # every recv waits for its own parameters in overlap_recv
+                # mode, since the fetch barrier no longer does.
+                __append_recv_op__(
                     type="recv",
-                    inputs={"X": [recv_dep_in]},
+                    inputs={"X": [recv_dep_in] if recv_dep_in else []},
                     outputs={"Out": splited_var},
                     attrs={
                         "epmap": eps,
@@ -496,10 +895,24 @@ class DistributeTranspiler(object):
                         RPC_OP_ROLE_ATTR_NAME: RPC_OP_ROLE_ATTR_VALUE,
                         OP_ROLE_VAR_ATTR_NAME:
                         [param_varname, recv_op_role_var_name],
-                        "sync_mode": not self.sync_mode
+                        "sync_mode": overlap_recv or not self.sync_mode
                     })
 
-        if self.sync_mode:
+        if overlap_recv:
+            # only read the parameters, so that the forward ops do not
+            # depend on the fetch barrier
+            fetch_barrier_out = program.global_block().create_var(
+                name=framework.generate_control_dev_var_name())
+            __append_recv_op__(
+                type="fetch_barrier",
+                inputs={"X": all_recv_outputs},
+                outputs={"Out": [fetch_barrier_out]},
+                attrs={
+                    "endpoints": pserver_endpoints,
+                    "trainer_id": self.trainer_id,
+                    RPC_OP_ROLE_ATTR_NAME: RPC_OP_ROLE_ATTR_VALUE
+                })
+        elif self.sync_mode:
             # form a WAW dependency
             program.global_block().append_op(
                 type="fetch_barrier",
@@ -516,7 +929,7 @@ class DistributeTranspiler(object):
                 continue
             orig_param = program.global_block().vars[param_varname]
             if param_varname not in self.sparse_param_to_height_sections:
-                program.global_block().append_op(
+                __append_recv_op__(
                     type="concat",
                     inputs={"X": splited_var},
                     outputs={"Out": [orig_param]},
@@ -539,6 +952,12 @@ class DistributeTranspiler(object):
         Returns:
             Program: trainer side program.
         """
+        if self.config.geo_sgd_mode:
+            # the optimize ops run the local steps of the trainer
+            if wait_port:
+                wait_server_ready(self.pserver_endpoints)
+            return self.origin_program
+
         # remove optimize ops and add a send op to main_program
         # FIXME(typhoonzero): Also ops like clip_gradient, lrn_decay?
         lr_ops = self._get_lr_ops()
@@ -607,6 +1026,10 @@ class DistributeTranspiler(object):
                     shape=var.shape,
                     lod_level=var.lod_level)
 
+            # the first step of the trainer receives the parameters
+            if self.config.overlap_recv:
+                continue
+
             op = startup_program.global_block().append_op(
                 type="recv",
                 inputs={"X": []},
@@ -616,6 +1039,9 @@ class DistributeTranspiler(object):
                     RPC_OP_ROLE_ATTR_NAME: RPC_OP_ROLE_ATTR_VALUE
                 })
 
+        if self.config.overlap_recv:
+            return startup_program
+
         fetch_barrier_out = startup_program.global_block().create_var(
             name=framework.generate_control_dev_var_name())
         startup_program.global_block().append_op(
@@ -661,6 +1087,9 @@ class DistributeTranspiler(object):
         Returns:
             Program: the program for current parameter server to run.
         """
+        if self.config.geo_sgd_mode:
+            return self._get_geo_sgd_pserver_program(endpoint)
+
         # TODO(panyx0718): Revisit this assumption. what if #blocks > #pservers.
         # NOTE: assume blocks of the same variable is not distributed
         # on the same pserver, only change param/grad varnames for
@@ -0,0 +1,51 @@
+#   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Merge the Chrome traces written by the trainers with the flag
+FLAGS_profile_chrome_trace into one, which can be viewed by chrome://tracing
+or Perfetto. The processes of the trainers are numbered by the trainer_id,
+and all the timestamps are taken by the host clock."""
+
+import argparse
+import json
+import sys
+
+parser = argparse.ArgumentParser(description=__doc__)
+parser.add_argument(
+    'trace_paths',
+    nargs='+',
+    help='The traces of the trainers, e.g. profile.0.json profile.1.json')
+parser.add_argument(
+    '--output_path', type=str, required=True, help='The merged trace.')
+
+
+def merge_traces(trace_paths):
+    merged_events = []
+    trainer_ids = set()
+    for path in trace_paths:
+        with open(path) as f:
+            trace = json.load(f)
+        trainer_id = trace.get('otherData', {}).get('trainer_id', 0)
+        if trainer_id in trainer_ids:
+            sys.stderr.write('The trace of trainer %d is duplicated in %s.\n' %
+                             (trainer_id, path))
+            continue
+        trainer_ids.add(trainer_id)
+        merged_events.extend(trace['traceEvents'])
+    return {'displayTimeUnit': 'ns', 'traceEvents': merged_events}
+
+
+if __name__ == '__main__':
+    args = parser.parse_args()
+    with open(args.output_path, 'w') as f:
+        json.dump(merge_traces(args.trace_paths), f)